@@ -29,6 +29,7 @@ limitations under the License.
 #include "tensorflow/core/platform/errors.h"
 #include "tensorflow/core/platform/protobuf.h"
 #include "tensorflow/core/platform/test.h"
+#include "tensorflow/core/platform/test_benchmark.h"
 #include "tensorflow/core/protobuf/cluster.pb.h"
 #include "tensorflow/core/protobuf/config.pb.h"
 #include "tensorflow/core/protobuf/tensorflow_server.pb.h"
@@ -137,4 +138,69 @@ TEST(CAPI, RemoteExecuteSilentCopiesLocalAsync) {
   TestRemoteExecuteSilentCopiesOp(/*async=*/true, /*remote=*/false);
 }
 
+// Measures the rate at which ops are enqueued on, and run by, a remote task.
+// The worker server is shared by all runs of the benchmark.
+void BM_RemoteExecute(::testing::benchmark::State& state) {
+  const int async = state.range(0);
+  state.SetLabel(async ? "RemoteExecuteAsync" : "RemoteExecute");
+  static const tensorflow::ServerDef* server_def = []() {
+    auto* server_def = new tensorflow::ServerDef(GetServerDef(2));
+    server_def->set_task_index(1);
+    std::unique_ptr<tensorflow::GrpcServer> worker_server;
+    TF_CHECK_OK(tensorflow::GrpcServer::Create(
+        *server_def, tensorflow::Env::Default(), &worker_server));
+    TF_CHECK_OK(worker_server->Start());
+    // TODO(b/136478427): Figure out how to correctly shut the server down.
+    worker_server.release();
+    server_def->set_task_index(0);
+    return server_def;
+  }();
+  const string serialized = server_def->SerializeAsString();
+
+  TF_Status* status = TF_NewStatus();
+  TFE_ContextOptions* opts = TFE_NewContextOptions();
+  TFE_ContextOptionsSetAsync(opts, static_cast<unsigned char>(async));
+  TFE_ContextOptionsSetDevicePlacementPolicy(opts,
+                                             TFE_DEVICE_PLACEMENT_EXPLICIT);
+  TFE_Context* ctx = TFE_NewContext(opts, status);
+  CHECK_EQ(TF_OK, TF_GetCode(status)) << TF_Message(status);
+  TFE_DeleteContextOptions(opts);
+  TFE_ContextSetServerDef(ctx, 0, serialized.data(), serialized.size(), status);
+  CHECK_EQ(TF_OK, TF_GetCode(status)) << TF_Message(status);
+
+  const char remote_device_name[] =
+      "/job:localhost/replica:0/task:1/device:CPU:0";
+  TFE_TensorHandle* h_task0 = TestMatrixTensorHandle(ctx);
+  TFE_TensorHandle* h_task1 =
+      TFE_TensorHandleCopyToDevice(h_task0, ctx, remote_device_name, status);
+  CHECK_EQ(TF_OK, TF_GetCode(status)) << TF_Message(status);
+  TFE_Executor* executor = TFE_ContextGetExecutorForThread(ctx);
+  TFE_ExecutorWaitForAllPendingNodes(executor, status);
+  CHECK_EQ(TF_OK, TF_GetCode(status)) << TF_Message(status);
+
+  TFE_TensorHandle* retvals[1];
+  int num_retvals = 1;
+  for (auto s : state) {
+    TFE_Op* identity = IdentityOp(ctx, h_task1);
+    TFE_OpSetDevice(identity, remote_device_name, status);
+    CHECK_EQ(TF_OK, TF_GetCode(status)) << TF_Message(status);
+    TFE_Execute(identity, &retvals[0], &num_retvals, status);
+    CHECK_EQ(TF_OK, TF_GetCode(status)) << TF_Message(status);
+    TFE_DeleteOp(identity);
+    TFE_DeleteTensorHandle(retvals[0]);
+    if (state.iterations() >= state.max_iterations && async) {
+      TFE_ExecutorWaitForAllPendingNodes(executor, status);
+      CHECK_EQ(TF_OK, TF_GetCode(status)) << TF_Message(status);
+    }
+  }
+  state.SetItemsProcessed(state.iterations());
+
+  TFE_DeleteTensorHandle(h_task0);
+  TFE_DeleteTensorHandle(h_task1);
+  TFE_DeleteExecutor(executor);
+  TFE_DeleteContext(ctx);
+  TF_DeleteStatus(status);
+}
+BENCHMARK(BM_RemoteExecute)->UseRealTime()->Arg(0)->Arg(1);
+
 }  // namespace
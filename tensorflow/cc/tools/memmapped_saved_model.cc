@@ -0,0 +1,128 @@
+/* Copyright 2024 The TensorFlow Authors. All Rights Reserved.
+
+Licensed under the Apache License, Version 2.0 (the "License");
+you may not use this file except in compliance with the License.
+You may obtain a copy of the License at
+
+    http://www.apache.org/licenses/LICENSE-2.0
+
+Unless required by applicable law or agreed to in writing, software
+distributed under the License is distributed on an "AS IS" BASIS,
+WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+See the License for the specific language governing permissions and
+limitations under the License.
+==============================================================================*/
+
+#include "tensorflow/cc/tools/memmapped_saved_model.h"
+
+#include <memory>
+#include <unordered_set>
+#include <utility>
+
+#include "absl/strings/str_cat.h"
+#include "tensorflow/cc/tools/freeze_saved_model.h"
+#include "tensorflow/core/framework/attr_value_util.h"
+#include "tensorflow/core/framework/graph.pb.h"
+#include "tensorflow/core/framework/node_def.pb.h"
+#include "tensorflow/core/framework/node_def_util.h"
+#include "tensorflow/core/framework/tensor.h"
+#include "tensorflow/core/framework/types.h"
+#include "tensorflow/core/lib/core/errors.h"
+#include "tensorflow/core/util/memmapped_file_system_writer.h"
+
+namespace tensorflow {
+
+const char kMemmappedSavedModelMetaGraphDef[] =
+    "memmapped_package://meta_graph_def";
+
+namespace {
+
+// Replaces `node`, a Const, by an ImmutableConst reading `region_name`.
+void ConvertToImmutableConst(const Tensor& tensor, const string& region_name,
+                             NodeDef* node) {
+  node->set_op("ImmutableConst");
+  node->clear_attr();
+  auto* attr = node->mutable_attr();
+  SetAttrValue(tensor.dtype(), &(*attr)["dtype"]);
+  SetAttrValue(tensor.shape(), &(*attr)["shape"]);
+  SetAttrValue(region_name, &(*attr)["memory_region_name"]);
+}
+
+}  // namespace
+
+Status WriteMemmappedSavedModel(const SavedModelBundle& saved_model_bundle,
+                                const MemmappedSavedModelOptions& options,
+                                Env* env, const string& package_filename) {
+  MetaGraphDef meta_graph_def;
+  std::unordered_set<string> inputs;
+  std::unordered_set<string> outputs;
+  TF_RETURN_IF_ERROR(FreezeSavedModel(saved_model_bundle,
+                                      meta_graph_def.mutable_graph_def(),
+                                      &inputs, &outputs));
+  *meta_graph_def.mutable_meta_info_def() =
+      saved_model_bundle.meta_graph_def.meta_info_def();
+  *meta_graph_def.mutable_signature_def() =
+      saved_model_bundle.meta_graph_def.signature_def();
+
+  MemmappedFileSystemWriter writer;
+  TF_RETURN_IF_ERROR(writer.InitializeToFile(env, package_filename));
+  int num_tensors = 0;
+  for (NodeDef& node : *meta_graph_def.mutable_graph_def()->mutable_node()) {
+    if (node.op() != "Const") continue;
+    Tensor tensor;
+    TF_RETURN_IF_ERROR(GetNodeAttr(node, "value", &tensor));
+    // The string tensors cannot alias a buffer, and empty regions cannot be
+    // saved.
+    const size_t num_bytes = tensor.TotalBytes();
+    if (!DataTypeCanUseMemcpy(tensor.dtype()) || num_bytes == 0 ||
+        num_bytes < static_cast<size_t>(options.min_memmapped_tensor_bytes)) {
+      continue;
+    }
+    // The node names can contain characters that are not valid in region
+    // names.
+    const string region_name = absl::StrCat(
+        MemmappedFileSystem::kMemmappedPackagePrefix, "tensor_", num_tensors++);
+    TF_RETURN_IF_ERROR(writer.SaveTensor(tensor, region_name));
+    ConvertToImmutableConst(tensor, region_name, &node);
+  }
+  TF_RETURN_IF_ERROR(
+      writer.SaveProtobuf(meta_graph_def, kMemmappedSavedModelMetaGraphDef));
+  return writer.FlushAndClose();
+}
+
+MemmappedSavedModelBundle::~MemmappedSavedModelBundle() {
+  if (session_) {
+    session_->Close().IgnoreError();
+    // The kernels of the session hold the memory regions of the package.
+    session_.reset();
+  }
+}
+
+Status LoadMemmappedSavedModel(const SessionOptions& session_options,
+                               const string& package_filename,
+                               MemmappedSavedModelBundle* bundle) {
+  auto env = std::make_unique<MemmappedEnv>(session_options.env);
+  TF_RETURN_IF_ERROR(env->InitializeFromFile(package_filename));
+  MetaGraphDef meta_graph_def;
+  TF_RETURN_IF_ERROR(ReadBinaryProto(env.get(),
+                                     kMemmappedSavedModelMetaGraphDef,
+                                     &meta_graph_def));
+
+  SessionOptions options = session_options;
+  options.env = env.get();
+  Session* session_ptr = nullptr;
+  TF_RETURN_IF_ERROR(NewSession(options, &session_ptr));
+  std::unique_ptr<Session> session(session_ptr);
+  TF_RETURN_IF_ERROR(session->Create(meta_graph_def.graph_def()));
+
+  if (bundle->session_) {
+    bundle->session_->Close().IgnoreError();
+    bundle->session_.reset();
+  }
+  bundle->env_ = std::move(env);
+  bundle->meta_graph_def_ = std::move(meta_graph_def);
+  bundle->session_ = std::move(session);
+  return OkStatus();
+}
+
+}  // namespace tensorflow
@@ -0,0 +1,90 @@
+/* Copyright 2024 The TensorFlow Authors. All Rights Reserved.
+
+Licensed under the Apache License, Version 2.0 (the "License");
+you may not use this file except in compliance with the License.
+You may obtain a copy of the License at
+
+    http://www.apache.org/licenses/LICENSE-2.0
+
+Unless required by applicable law or agreed to in writing, software
+distributed under the License is distributed on an "AS IS" BASIS,
+WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+See the License for the specific language governing permissions and
+limitations under the License.
+==============================================================================*/
+
+#ifndef TENSORFLOW_CC_TOOLS_MEMMAPPED_SAVED_MODEL_H_
+#define TENSORFLOW_CC_TOOLS_MEMMAPPED_SAVED_MODEL_H_
+
+#include <cstdint>
+#include <memory>
+
+#include "tensorflow/cc/saved_model/loader.h"
+#include "tensorflow/core/lib/core/status.h"
+#include "tensorflow/core/platform/env.h"
+#include "tensorflow/core/protobuf/meta_graph.pb.h"
+#include "tensorflow/core/public/session.h"
+#include "tensorflow/core/public/session_options.h"
+#include "tensorflow/core/util/memmapped_file_system.h"
+
+namespace tensorflow {
+
+// The name of the MetaGraphDef in the packages written by
+// WriteMemmappedSavedModel().
+extern const char kMemmappedSavedModelMetaGraphDef[];
+
+struct MemmappedSavedModelOptions {
+  // The constants of at least this many bytes are stored as tensors of the
+  // package, the smaller ones stay in the graph.
+  int64_t min_memmapped_tensor_bytes = 1024;
+};
+
+// Writes the frozen `saved_model_bundle` to the memmapped package
+// `package_filename`: the variables are frozen as with FreezeSavedModel(),
+// and the large constants are replaced by ImmutableConst nodes whose tensors
+// are stored, aligned, in the package.
+// WARNING: As with FreezeSavedModel(), the saved_model assets are ignored.
+Status WriteMemmappedSavedModel(const SavedModelBundle& saved_model_bundle,
+                                const MemmappedSavedModelOptions& options,
+                                Env* env, const string& package_filename);
+
+// A SavedModel loaded from a memmapped package. The tensors of the
+// ImmutableConst nodes alias the read-only mapping of the package, so that
+// the processes loading the same package share one copy of the weights in the
+// page cache.
+class MemmappedSavedModelBundle : public SavedModelBundleInterface {
+ public:
+  MemmappedSavedModelBundle() = default;
+
+  // Closes the session before unmapping the package its tensors alias.
+  ~MemmappedSavedModelBundle() override;
+
+  Session* GetSession() const override { return session_.get(); }
+  const protobuf::Map<string, SignatureDef>& GetSignatures() const override {
+    return meta_graph_def_.signature_def();
+  }
+  const MetaGraphDef& meta_graph_def() const { return meta_graph_def_; }
+
+ private:
+  friend Status LoadMemmappedSavedModel(const SessionOptions& session_options,
+                                        const string& package_filename,
+                                        MemmappedSavedModelBundle* bundle);
+
+  std::unique_ptr<MemmappedEnv> env_;
+  MetaGraphDef meta_graph_def_;
+  std::unique_ptr<Session> session_;
+
+  MemmappedSavedModelBundle(const MemmappedSavedModelBundle&) = delete;
+  void operator=(const MemmappedSavedModelBundle&) = delete;
+};
+
+// Loads the package written by WriteMemmappedSavedModel() into `bundle`.
+// `session_options.env` is used to map the package, and is wrapped by the
+// environment of the session.
+Status LoadMemmappedSavedModel(const SessionOptions& session_options,
+                               const string& package_filename,
+                               MemmappedSavedModelBundle* bundle);
+
+}  // namespace tensorflow
+
+#endif  // TENSORFLOW_CC_TOOLS_MEMMAPPED_SAVED_MODEL_H_
@@ -0,0 +1,128 @@
+/* Copyright 2024 The TensorFlow Authors. All Rights Reserved.
+
+Licensed under the Apache License, Version 2.0 (the "License");
+you may not use this file except in compliance with the License.
+You may obtain a copy of the License at
+
+    http://www.apache.org/licenses/LICENSE-2.0
+
+Unless required by applicable law or agreed to in writing, software
+distributed under the License is distributed on an "AS IS" BASIS,
+WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+See the License for the specific language governing permissions and
+limitations under the License.
+==============================================================================*/
+
+#include "tensorflow/cc/tools/memmapped_saved_model.h"
+
+#include <string>
+#include <vector>
+
+#include "tensorflow/cc/ops/resource_variable_ops.h"
+#include "tensorflow/cc/ops/standard_ops.h"
+#include "tensorflow/core/framework/graph.pb.h"
+#include "tensorflow/core/framework/tensor_testutil.h"
+#include "tensorflow/core/lib/core/status_test_util.h"
+#include "tensorflow/core/platform/path.h"
+#include "tensorflow/core/platform/test.h"
+#include "tensorflow/core/public/session.h"
+#include "tensorflow/core/public/session_options.h"
+
+namespace tensorflow {
+namespace {
+
+constexpr int kNumElements = 1024;
+
+Tensor Filled(float value) {
+  return test::AsTensor<float>(std::vector<float>(kNumElements, value));
+}
+
+// Builds a bundle computing "c" = "a" * "var", with "var" set to "b", where
+// "a" and "b" are constants of kNumElements floats.
+Status BuildSavedModelBundle(SavedModelBundle* saved_model_bundle) {
+  Scope scope = Scope::NewRootScope();
+  Output a = ops::Const(scope.WithOpName("a"), Input::Initializer(Filled(2)));
+  Output b = ops::Const(scope.WithOpName("b"), Input::Initializer(Filled(3)));
+  Output var = ops::VarHandleOp(scope.WithOpName("var"), DT_FLOAT,
+                                TensorShape({kNumElements}));
+  Output read_var = ops::ReadVariableOp(
+      scope.WithOpName("var/Read/ReadVariableOp"), var, DT_FLOAT);
+  auto assign = ops::AssignVariableOp(scope.WithOpName("assign"), var, b);
+  Output c = ops::Mul(scope.WithOpName("c"), a, read_var);
+
+  MetaGraphDef* meta_graph_def = &saved_model_bundle->meta_graph_def;
+  TF_RETURN_IF_ERROR(scope.ToGraphDef(meta_graph_def->mutable_graph_def()));
+  SignatureDef& signature_def =
+      (*meta_graph_def->mutable_signature_def())["serving_default"];
+  (*signature_def.mutable_outputs())["c"].set_name("c:0");
+
+  saved_model_bundle->session.reset(NewSession(SessionOptions()));
+  TF_RETURN_IF_ERROR(
+      saved_model_bundle->session->Create(meta_graph_def->graph_def()));
+  std::vector<Tensor> outputs;
+  return saved_model_bundle->session->Run({}, {}, {"assign"}, &outputs);
+}
+
+int CountNodes(const GraphDef& graph_def, const string& op) {
+  int count = 0;
+  for (const NodeDef& node : graph_def.node()) {
+    if (node.op() == op) ++count;
+  }
+  return count;
+}
+
+TEST(MemmappedSavedModelTest, LoadsTheLargeTensorsFromThePackage) {
+  SavedModelBundle saved_model_bundle;
+  TF_ASSERT_OK(BuildSavedModelBundle(&saved_model_bundle));
+  const string package_filename =
+      io::JoinPath(testing::TmpDir(), "memmapped_saved_model_large");
+  TF_ASSERT_OK(WriteMemmappedSavedModel(saved_model_bundle,
+                                        MemmappedSavedModelOptions(),
+                                        Env::Default(), package_filename));
+
+  MemmappedSavedModelBundle bundle;
+  TF_ASSERT_OK(
+      LoadMemmappedSavedModel(SessionOptions(), package_filename, &bundle));
+  // "a" and the frozen "var".
+  EXPECT_EQ(CountNodes(bundle.meta_graph_def().graph_def(), "ImmutableConst"),
+            2);
+  EXPECT_EQ(CountNodes(bundle.meta_graph_def().graph_def(), "Const"), 0);
+  ASSERT_EQ(bundle.GetSignatures().count("serving_default"), 1);
+
+  std::vector<Tensor> outputs;
+  TF_ASSERT_OK(bundle.GetSession()->Run({}, {"c:0"}, {}, &outputs));
+  test::ExpectTensorEqual<float>(outputs[0], Filled(6));
+}
+
+TEST(MemmappedSavedModelTest, KeepsTheSmallConstantsInTheGraph) {
+  SavedModelBundle saved_model_bundle;
+  TF_ASSERT_OK(BuildSavedModelBundle(&saved_model_bundle));
+  const string package_filename =
+      io::JoinPath(testing::TmpDir(), "memmapped_saved_model_small");
+  MemmappedSavedModelOptions options;
+  options.min_memmapped_tensor_bytes = kNumElements * sizeof(float) + 1;
+  TF_ASSERT_OK(WriteMemmappedSavedModel(saved_model_bundle, options,
+                                        Env::Default(), package_filename));
+
+  MemmappedSavedModelBundle bundle;
+  TF_ASSERT_OK(
+      LoadMemmappedSavedModel(SessionOptions(), package_filename, &bundle));
+  EXPECT_EQ(CountNodes(bundle.meta_graph_def().graph_def(), "ImmutableConst"),
+            0);
+
+  std::vector<Tensor> outputs;
+  TF_ASSERT_OK(bundle.GetSession()->Run({}, {"c:0"}, {}, &outputs));
+  test::ExpectTensorEqual<float>(outputs[0], Filled(6));
+}
+
+TEST(MemmappedSavedModelTest, FailsOnAMissingPackage) {
+  MemmappedSavedModelBundle bundle;
+  EXPECT_FALSE(LoadMemmappedSavedModel(
+                   SessionOptions(),
+                   io::JoinPath(testing::TmpDir(), "no_such_package"), &bundle)
+                   .ok());
+  EXPECT_EQ(bundle.GetSession(), nullptr);
+}
+
+}  // namespace
+}  // namespace tensorflow
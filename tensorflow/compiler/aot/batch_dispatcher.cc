@@ -0,0 +1,76 @@
+/* Copyright 2024 The TensorFlow Authors. All Rights Reserved.
+
+Licensed under the Apache License, Version 2.0 (the "License");
+you may not use this file except in compliance with the License.
+You may obtain a copy of the License at
+
+    http://www.apache.org/licenses/LICENSE-2.0
+
+Unless required by applicable law or agreed to in writing, software
+distributed under the License is distributed on an "AS IS" BASIS,
+WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+See the License for the specific language governing permissions and
+limitations under the License.
+==============================================================================*/
+
+#define EIGEN_USE_THREADS
+
+#include "tensorflow/compiler/aot/batch_dispatcher.h"
+
+#include <algorithm>
+#include <cassert>
+#include <cstdint>
+#include <memory>
+#include <utility>
+
+#include "unsupported/Eigen/CXX11/Tensor"  // from @eigen_archive
+
+namespace tensorflow {
+namespace tfcompile {
+
+struct BatchDispatcher::ThreadPool {
+  explicit ThreadPool(int num_threads)
+      : pool(num_threads), device(&pool, pool.NumThreads()) {}
+
+  Eigen::ThreadPool pool;
+  Eigen::ThreadPoolDevice device;
+};
+
+BatchDispatcher::BatchDispatcher(int num_threads) {
+  if (num_threads > 1) {
+    thread_pool_ = std::make_unique<ThreadPool>(num_threads);
+  }
+}
+
+BatchDispatcher::~BatchDispatcher() {
+  // The variants refer to the thread pool, so they are destroyed first.
+  variants_.clear();
+}
+
+void BatchDispatcher::AddVariant(
+    int64_t batch_size, std::unique_ptr<XlaCompiledCpuFunction> function) {
+  assert(batch_size > 0);
+  function->set_thread_pool(thread_pool());
+  auto it = std::lower_bound(
+      variants_.begin(), variants_.end(), batch_size,
+      [](const auto& variant, int64_t size) { return variant.first < size; });
+  assert(it == variants_.end() || it->first != batch_size);
+  variants_.emplace(it, batch_size, std::move(function));
+}
+
+XlaCompiledCpuFunction* BatchDispatcher::Select(
+    int64_t batch_size, int64_t* variant_batch_size) const {
+  auto it = std::lower_bound(
+      variants_.begin(), variants_.end(), batch_size,
+      [](const auto& variant, int64_t size) { return variant.first < size; });
+  if (it == variants_.end()) return nullptr;
+  if (variant_batch_size != nullptr) *variant_batch_size = it->first;
+  return it->second.get();
+}
+
+const Eigen::ThreadPoolDevice* BatchDispatcher::thread_pool() const {
+  return thread_pool_ ? &thread_pool_->device : nullptr;
+}
+
+}  // namespace tfcompile
+}  // namespace tensorflow
@@ -0,0 +1,82 @@
+/* Copyright 2024 The TensorFlow Authors. All Rights Reserved.
+
+Licensed under the Apache License, Version 2.0 (the "License");
+you may not use this file except in compliance with the License.
+You may obtain a copy of the License at
+
+    http://www.apache.org/licenses/LICENSE-2.0
+
+Unless required by applicable law or agreed to in writing, software
+distributed under the License is distributed on an "AS IS" BASIS,
+WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+See the License for the specific language governing permissions and
+limitations under the License.
+==============================================================================*/
+#ifndef TENSORFLOW_COMPILER_AOT_BATCH_DISPATCHER_H_
+#define TENSORFLOW_COMPILER_AOT_BATCH_DISPATCHER_H_
+
+#include <cstdint>
+#include <memory>
+#include <utility>
+#include <vector>
+
+#include "tensorflow/compiler/tf2xla/xla_compiled_cpu_function.h"
+
+namespace tensorflow {
+namespace tfcompile {
+
+// BatchDispatcher holds the batch size variants of a function compiled by
+// tfcompile, e.g. the classes generated by tf_library with `batch_sizes`, and
+// runs them on a shared intra-op thread pool.
+//
+// For a batch of a given size, Select returns the variant compiled for the
+// smallest batch size that fits it. The caller copies the batch into the
+// arguments of that variant, padding it up to the variant's batch size, and
+// ignores the padded entries of the results.
+//
+// Like XlaCompiledCpuFunction, this class is thread-compatible.
+class BatchDispatcher {
+ public:
+  // Creates a dispatcher that runs its variants on a thread pool with
+  // `num_threads` threads, or on the calling thread if `num_threads` <= 1.
+  explicit BatchDispatcher(int num_threads);
+  ~BatchDispatcher();
+
+  BatchDispatcher(const BatchDispatcher&) = delete;
+  BatchDispatcher& operator=(const BatchDispatcher&) = delete;
+
+  // Adds `function`, compiled for batches of `batch_size`, and sets it up to
+  // run on the thread pool of the dispatcher. Each batch size may only be
+  // added once.
+  void AddVariant(int64_t batch_size,
+                  std::unique_ptr<XlaCompiledCpuFunction> function);
+
+  // Returns the variant with the smallest batch size that is at least
+  // `batch_size`, and sets `*variant_batch_size` to its batch size if it is
+  // not null. Returns nullptr if `batch_size` is larger than the batch sizes
+  // of all variants.
+  XlaCompiledCpuFunction* Select(int64_t batch_size,
+                                 int64_t* variant_batch_size = nullptr) const;
+
+  // Returns the largest batch size of the variants, or 0 if there are none.
+  int64_t max_batch_size() const {
+    return variants_.empty() ? 0 : variants_.back().first;
+  }
+
+  // Returns the intra-op thread pool, or nullptr if the variants run on the
+  // calling thread.
+  const Eigen::ThreadPoolDevice* thread_pool() const;
+
+ private:
+  struct ThreadPool;
+  std::unique_ptr<ThreadPool> thread_pool_;
+
+  // The variants sorted by batch size.
+  std::vector<std::pair<int64_t, std::unique_ptr<XlaCompiledCpuFunction>>>
+      variants_;
+};
+
+}  // namespace tfcompile
+}  // namespace tensorflow
+
+#endif  // TENSORFLOW_COMPILER_AOT_BATCH_DISPATCHER_H_
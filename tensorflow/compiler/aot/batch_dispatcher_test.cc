@@ -0,0 +1,76 @@
+/* Copyright 2024 The TensorFlow Authors. All Rights Reserved.
+
+Licensed under the Apache License, Version 2.0 (the "License");
+you may not use this file except in compliance with the License.
+You may obtain a copy of the License at
+
+    http://www.apache.org/licenses/LICENSE-2.0
+
+Unless required by applicable law or agreed to in writing, software
+distributed under the License is distributed on an "AS IS" BASIS,
+WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+See the License for the specific language governing permissions and
+limitations under the License.
+==============================================================================*/
+
+#include "tensorflow/compiler/aot/batch_dispatcher.h"
+
+#include <cstdint>
+#include <memory>
+
+#include "tensorflow/compiler/aot/test_graph_tfadd_variants_batch1.h"
+#include "tensorflow/compiler/aot/test_graph_tfadd_variants_batch4.h"
+#include "tensorflow/compiler/tf2xla/xla_compiled_cpu_function.h"
+#include "tensorflow/core/platform/test.h"
+
+namespace tensorflow {
+namespace tfcompile {
+namespace {
+
+TEST(BatchDispatcherTest, SelectsSmallestVariantThatFits) {
+  BatchDispatcher dispatcher(/*num_threads=*/2);
+  dispatcher.AddVariant(4, std::make_unique<AddCompBatch4>());
+  dispatcher.AddVariant(1, std::make_unique<AddCompBatch1>());
+  EXPECT_NE(dispatcher.thread_pool(), nullptr);
+  EXPECT_EQ(dispatcher.max_batch_size(), 4);
+
+  int64_t variant_batch_size = 0;
+  ASSERT_NE(dispatcher.Select(1, &variant_batch_size), nullptr);
+  EXPECT_EQ(variant_batch_size, 1);
+  EXPECT_EQ(dispatcher.Select(5), nullptr);
+
+  // Runs a batch of 3, padded up to the variant for 4.
+  XlaCompiledCpuFunction* function = dispatcher.Select(3, &variant_batch_size);
+  ASSERT_NE(function, nullptr);
+  EXPECT_EQ(variant_batch_size, 4);
+  int32_t* x = static_cast<int32_t*>(function->arg_data(0));
+  int32_t* y = static_cast<int32_t*>(function->arg_data(1));
+  for (int i = 0; i < 4; ++i) {
+    x[i] = i < 3 ? i : 0;
+    y[i] = i < 3 ? 10 * i : 0;
+  }
+  ASSERT_TRUE(function->Run());
+  const int32_t* sum = static_cast<const int32_t*>(function->result_data(0));
+  for (int i = 0; i < 3; ++i) {
+    EXPECT_EQ(sum[i], 11 * i);
+  }
+}
+
+TEST(BatchDispatcherTest, SingleThreaded) {
+  BatchDispatcher dispatcher(/*num_threads=*/1);
+  EXPECT_EQ(dispatcher.thread_pool(), nullptr);
+  EXPECT_EQ(dispatcher.max_batch_size(), 0);
+  EXPECT_EQ(dispatcher.Select(1), nullptr);
+
+  dispatcher.AddVariant(1, std::make_unique<AddCompBatch1>());
+  XlaCompiledCpuFunction* function = dispatcher.Select(1);
+  ASSERT_NE(function, nullptr);
+  *static_cast<int32_t*>(function->arg_data(0)) = 1;
+  *static_cast<int32_t*>(function->arg_data(1)) = 2;
+  ASSERT_TRUE(function->Run());
+  EXPECT_EQ(*static_cast<const int32_t*>(function->result_data(0)), 3);
+}
+
+}  // namespace
+}  // namespace tfcompile
+}  // namespace tensorflow
@@ -108,6 +108,26 @@ void DumpStatsToStdout(const Stats& stats) {
   }
 }
 
+void DumpBatchStatsToStdout(const Stats& stats, int64_t batch_size) {
+  if (stats.per_iter_us.empty() || batch_size <= 0) return;
+  std::vector<int64_t> sorted_us(stats.per_iter_us);
+  std::sort(sorted_us.begin(), sorted_us.end());
+  double sum_us = 0;
+  for (const int64_t us : sorted_us) {
+    sum_us += us;
+  }
+  const double mean_us = sum_us / sorted_us.size();
+  const double median_us = sorted_us[sorted_us.size() / 2];
+  // NOLINTNEXTLINE
+  printf("Batch size %lld:\n", static_cast<long long>(batch_size));
+  printf("  Median per example: %.3f us\n", median_us / batch_size);
+  printf("  Mean per example:   %.3f us\n", mean_us / batch_size);
+  if (mean_us > 0) {
+    printf("  Throughput:         %.1f examples/s\n",
+           batch_size * 1e6 / mean_us);
+  }
+}
+
 void Benchmark(const Options& options, const BenchmarkFn& fn, Stats* stats) {
   // If neither max_seconds or max_iters is set, stop at kDefaultMicros.
   const int64_t max_us = (options.max_micros <= 0 && options.max_iters <= 0)
@@ -56,6 +56,11 @@ struct Stats {
 // form.
 void DumpStatsToStdout(const Stats& stats);
 
+// DumpBatchStatsToStdout printfs to stdout the latency per example and the
+// throughput of a function that processes batches of `batch_size` examples,
+// e.g. a batch size variant generated by tf_library with `batch_sizes`.
+void DumpBatchStatsToStdout(const Stats& stats, int64_t batch_size);
+
 // BenchmarkFn is the signature of the function generated by tfcompile.
 typedef std::function<void()> BenchmarkFn;
 
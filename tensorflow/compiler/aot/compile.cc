@@ -16,11 +16,13 @@ limitations under the License.
 #include "tensorflow/compiler/aot/compile.h"
 
 #include <memory>
+#include <set>
 #include <string>
 #include <utility>
 #include <vector>
 
 #include "absl/base/call_once.h"
+#include "absl/strings/str_split.h"
 #include "llvm-c/Target.h"
 #include "llvm/Support/ManagedStatic.h"
 #include "tensorflow/compiler/aot/codegen.h"
@@ -170,6 +172,40 @@ Status CompileGraph(GraphDef graph_def, const tf2xla::Config& config,
   return CompileXla(client, computation, aot_opts, compile_result);
 }
 
+// Sets the leading dimension of the feeds in the comma separated list
+// `batch_feeds`, or of all feeds of rank 1 or more if it is empty, to
+// `batch_size`.
+static Status SetBatchSize(int batch_size, const string& batch_feeds,
+                           tf2xla::Config* config) {
+  const std::set<string> names =
+      absl::StrSplit(batch_feeds, ',', absl::SkipEmpty());
+  std::set<string> found;
+  for (tf2xla::Feed& feed : *config->mutable_feed()) {
+    const string& node_name = feed.id().node_name();
+    if (!names.empty()) {
+      if (names.count(feed.name())) {
+        found.insert(feed.name());
+      } else if (names.count(node_name)) {
+        found.insert(node_name);
+      } else {
+        continue;
+      }
+    }
+    if (feed.shape().dim_size() == 0) {
+      if (names.empty()) continue;
+      return errors::InvalidArgument("Batch feed ", node_name,
+                                     " is a scalar and has no batch dimension");
+    }
+    feed.mutable_shape()->mutable_dim(0)->set_size(batch_size);
+  }
+  for (const string& name : names) {
+    if (!found.count(name)) {
+      return errors::InvalidArgument("Batch feed ", name, " is not fed");
+    }
+  }
+  return absl::OkStatus();
+}
+
 static Status ReadProtoFile(const string& fname, protobuf::Message* proto) {
   if (absl::EndsWith(fname, ".pbtxt")) {
     return ReadTextProto(Env::Default(), fname, proto);
@@ -253,6 +289,10 @@ Status Main(const MainFlags& flags) {
   }
   TF_RETURN_IF_ERROR(ReadProtoFile(flags.config, &config));
   TF_RETURN_IF_ERROR(ValidateConfig(config));
+  if (flags.batch_size > 0) {
+    TF_RETURN_IF_ERROR(
+        SetBatchSize(flags.batch_size, flags.batch_feeds, &config));
+  }
   if (flags.dump_fetch_nodes) {
     std::set<string> nodes;
     for (const tf2xla::Fetch& fetch : config.fetch()) {
@@ -80,6 +80,14 @@ void AppendMainFlags(std::vector<Flag>* flag_list, MainFlags* flags) {
       {"experimental_quantize", &flags->experimental_quantize,
        "If set, quantization passes will run and dump the result before HLO "
        "code generation."},
+      {"batch_size", &flags->batch_size,
+       "If positive, the leading dimension of the fed tensors selected by "
+       "--batch_feeds is set to this value, overriding the shapes in the "
+       "config.  Used to compile a function for several batch sizes."},
+      {"batch_feeds", &flags->batch_feeds,
+       "Comma separated list of the feeds whose leading dimension is the batch "
+       "dimension, named by their Feed.name or node name.  If empty, all feeds "
+       "of rank 1 or more are batched.  Only used with --batch_size."},
       {"sanitize_dataflow", &flags->sanitize_dataflow,
        "Enable DataFlow Sanitizer pass."},
       {"sanitize_abilists_dataflow", &flags->sanitize_abilists_dataflow,
@@ -43,6 +43,8 @@ struct MainFlags {
   string out_session_module;
   string mlir_components;
   bool experimental_quantize = false;
+  int32 batch_size = 0;
+  string batch_feeds;
 
   // Sanitizer pass options
   bool sanitize_dataflow = false;
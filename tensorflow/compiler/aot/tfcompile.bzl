@@ -154,7 +154,9 @@ def _tf_library(
         deps = None,
         tags = [],
         copts = [],
-        xla_flags = None):
+        xla_flags = None,
+        benchmark_num_threads = 1,
+        batch_size = 0):
     if not cpp_class:
         fail("cpp_class must be specified")
 
@@ -412,6 +414,10 @@ def _tf_library(
             testonly = testonly,
             outs = [benchmark_file],
             cmd = ("sed " + sed_replace +
+                   "-e \"s|{{TFCOMPILE_NUM_THREADS}}|" +
+                   str(benchmark_num_threads) + "|g\" " +
+                   "-e \"s|{{TFCOMPILE_BATCH_SIZE}}|" + str(batch_size) +
+                   "|g\" " +
                    " $(location " + benchmark_main + ") " +
                    "> $(OUTS)"),
             tags = tags,
@@ -465,7 +471,10 @@ def tf_library(
         deps = None,
         tags = [],
         copts = [],
-        xla_flags = None):
+        xla_flags = None,
+        batch_sizes = None,
+        batch_feeds = None,
+        benchmark_num_threads = 1):
     """Compiles a TensorFlow graph into an executable with fast math enabled.
 
     Given an invocation of tf_library(name="foo", ...), generates the following
@@ -480,6 +489,14 @@ def tf_library(
                       gen_benchmark=True.
     The output header is called <name>.h.
 
+    If batch_sizes is set, the graph is instead compiled once for each batch
+    size B, and the targets above are generated with the name foo_batchB, the
+    header foo_batchB.h and the class <cpp_class>BatchB. The foo target then
+    depends on all the variants, which can be run with a
+    tensorflow::tfcompile::BatchDispatcher from
+    //tensorflow/compiler/aot:batch_dispatcher. Each foo_batchB_benchmark
+    reports the latency per example of its variant.
+
     Args:
       name: The name of the build rule.
       graph: The TensorFlow GraphDef to compile.  If the file ends in '.pbtxt'
@@ -525,7 +542,62 @@ def tf_library(
         library, added to the standard deps if standard_runtime_deps is True.
       tags: tags to apply to subsidiary build rules.
       copts: list of copts to pass to cc rules.
+      xla_flags: XLA flags to set when compiling the graph.
+      batch_sizes: If set, the list of batch sizes to compile the graph for.
+        The leading dimension of the fed tensors selected by batch_feeds is
+        set to each batch size in turn.
+      batch_feeds: The names of the feeds whose leading dimension is the batch
+        dimension. If None, all feeds of rank 1 or more are batched.
+      benchmark_num_threads: The number of threads of the intra-op thread pool
+        used by the benchmark binaries.
     """
+    if batch_sizes:
+        for batch_size in batch_sizes:
+            batch_flags = ["--batch_size=" + str(batch_size)]
+            if batch_feeds:
+                batch_flags.append("--batch_feeds=" + ",".join(batch_feeds))
+            if type(tfcompile_flags) == type(""):
+                variant_flags = " ".join([tfcompile_flags] + batch_flags)
+            else:
+                variant_flags = (tfcompile_flags or []) + batch_flags
+            _tf_library(
+                name + "_batch" + str(batch_size),
+                graph,
+                config,
+                debug_info,
+                freeze_checkpoint,
+                freeze_saver,
+                cpp_class + "Batch" + str(batch_size),
+                gen_test,
+                gen_benchmark,
+                gen_compiler_log,
+                visibility,
+                testonly,
+                variant_flags,
+                tfcompile_tool,
+                include_standard_runtime_deps,
+                enable_xla_hlo_profiling,
+                enable_tracemes,
+                mlir_components,
+                deps,
+                tags,
+                copts,
+                xla_flags,
+                benchmark_num_threads,
+                batch_size,
+            )
+        native.cc_library(
+            name = name,
+            visibility = visibility,
+            testonly = testonly,
+            deps = [
+                ":" + name + "_batch" + str(batch_size)
+                for batch_size in batch_sizes
+            ],
+            tags = tags,
+        )
+        return
+
     _tf_library(
         name,
         graph,
@@ -549,6 +621,7 @@ def tf_library(
         tags,
         copts,
         xla_flags,
+        benchmark_num_threads,
     )
 
 def target_llvm_triple():
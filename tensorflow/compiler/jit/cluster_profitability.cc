@@ -0,0 +1,142 @@
+/* Copyright 2024 The TensorFlow Authors. All Rights Reserved.
+
+Licensed under the Apache License, Version 2.0 (the "License");
+you may not use this file except in compliance with the License.
+You may obtain a copy of the License at
+
+    http://www.apache.org/licenses/LICENSE-2.0
+
+Unless required by applicable law or agreed to in writing, software
+distributed under the License is distributed on an "AS IS" BASIS,
+WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+See the License for the specific language governing permissions and
+limitations under the License.
+==============================================================================*/
+
+#include "tensorflow/compiler/jit/cluster_profitability.h"
+
+#include <algorithm>
+#include <string>
+
+#include "absl/container/flat_hash_set.h"
+#include "tensorflow/core/framework/types.h"
+#include "tensorflow/core/grappler/costs/utils.h"
+#include "tensorflow/core/platform/logging.h"
+
+namespace tensorflow {
+namespace {
+
+// Returns the size of a tensor, counting unknown dimensions as 1.
+int64_t TensorBytes(const OpInfo::TensorProperties& tensor) {
+  if (tensor.shape().unknown_rank()) return DataTypeSize(tensor.dtype());
+  int64_t num_elements = 1;
+  for (const auto& dim : tensor.shape().dim()) {
+    num_elements *= std::max<int64_t>(dim.size(), 1);
+  }
+  return num_elements * DataTypeSize(tensor.dtype());
+}
+
+}  // namespace
+
+ClusterProfitabilityModel::ClusterProfitabilityModel(
+    const GraphShapeInfo& shape_info, const Options& options)
+    : shape_info_(shape_info), options_(options) {}
+
+bool ClusterProfitabilityModel::IsFusionBarrier(const Node& node) {
+  static const auto* const kFusionBarriers =
+      new absl::flat_hash_set<std::string>({
+          "BatchMatMul",
+          "BatchMatMulV2",
+          "BatchMatMulV3",
+          "Conv2D",
+          "Conv2DBackpropFilter",
+          "Conv2DBackpropInput",
+          "Conv3D",
+          "Conv3DBackpropFilterV2",
+          "Conv3DBackpropInputV2",
+          "DepthwiseConv2dNative",
+          "DepthwiseConv2dNativeBackpropFilter",
+          "DepthwiseConv2dNativeBackpropInput",
+          "Einsum",
+          "FFT",
+          "FFT2D",
+          "FFT3D",
+          "IFFT",
+          "IFFT2D",
+          "IFFT3D",
+          "IRFFT",
+          "MatMul",
+          "RFFT",
+      });
+  return kFusionBarriers->contains(node.type_string());
+}
+
+OpInfo::TensorProperties ClusterProfitabilityModel::GetTensorProperties(
+    const Node& node, int output) const {
+  OpInfo::TensorProperties tensor;
+  tensor.set_dtype(BaseType(node.output_type(output)));
+  auto it = shape_info_.find(node.name());
+  if (it != shape_info_.end() &&
+      output < static_cast<int>(it->second.size())) {
+    it->second[output].shape.AsProto(tensor.mutable_shape());
+  } else {
+    tensor.mutable_shape()->set_unknown_rank(true);
+  }
+  return tensor;
+}
+
+const DeviceProperties& ClusterProfitabilityModel::GetDeviceProperties(
+    const Node& node) {
+  const std::string& device = node.assigned_device_name().empty()
+                                  ? node.requested_device()
+                                  : node.assigned_device_name();
+  auto it = device_properties_.find(device);
+  if (it == device_properties_.end()) {
+    it = device_properties_.emplace(device, grappler::GetDeviceInfo(device))
+             .first;
+  }
+  return it->second;
+}
+
+double ClusterProfitabilityModel::EstimateBenefitUs(
+    absl::Span<const Node* const> nodes) {
+  const absl::flat_hash_set<const Node*> cluster(nodes.begin(), nodes.end());
+  auto is_fused = [&](const Node* node) {
+    return cluster.contains(node) && !IsFusionBarrier(*node);
+  };
+
+  double benefit_us = -options_.cluster_overhead_us;
+  for (const Node* node : nodes) {
+    if (!is_fused(node)) continue;
+    benefit_us += options_.kernel_overhead_us;
+
+    // Each fused consumer of an output of `node` doesn't read it from memory,
+    // and `node` doesn't write it at all if all its consumers are fused.
+    const double gb_per_sec =
+        estimator_.GetDeviceInfo(GetDeviceProperties(*node)).gb_per_sec;
+    for (int output = 0; output < node->num_outputs(); ++output) {
+      int num_fused_reads = 0;
+      bool materialized = false;
+      for (const Edge* edge : node->out_edges()) {
+        if (edge->IsControlEdge() || edge->src_output() != output) continue;
+        if (is_fused(edge->dst())) {
+          ++num_fused_reads;
+        } else {
+          materialized = true;
+        }
+      }
+      if (num_fused_reads == 0) continue;
+      const int64_t num_saved_accesses =
+          num_fused_reads + (materialized ? 0 : 1);
+      // GB/s is 1e3 bytes per microsecond.
+      benefit_us += num_saved_accesses *
+                    TensorBytes(GetTensorProperties(*node, output)) /
+                    (gb_per_sec * 1e3);
+    }
+  }
+  VLOG(3) << "Estimated benefit of a cluster of " << nodes.size()
+          << " nodes: " << benefit_us << "us";
+  return benefit_us;
+}
+
+}  // namespace tensorflow
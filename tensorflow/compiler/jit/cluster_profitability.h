@@ -0,0 +1,76 @@
+/* Copyright 2024 The TensorFlow Authors. All Rights Reserved.
+
+Licensed under the Apache License, Version 2.0 (the "License");
+you may not use this file except in compliance with the License.
+You may obtain a copy of the License at
+
+    http://www.apache.org/licenses/LICENSE-2.0
+
+Unless required by applicable law or agreed to in writing, software
+distributed under the License is distributed on an "AS IS" BASIS,
+WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+See the License for the specific language governing permissions and
+limitations under the License.
+==============================================================================*/
+
+#ifndef TENSORFLOW_COMPILER_JIT_CLUSTER_PROFITABILITY_H_
+#define TENSORFLOW_COMPILER_JIT_CLUSTER_PROFITABILITY_H_
+
+#include <string>
+
+#include "absl/container/flat_hash_map.h"
+#include "absl/types/span.h"
+#include "tensorflow/compiler/jit/shape_inference.h"
+#include "tensorflow/core/graph/graph.h"
+#include "tensorflow/core/grappler/costs/op_level_cost_estimator.h"
+#include "tensorflow/core/protobuf/device_properties.pb.h"
+
+namespace tensorflow {
+
+// Estimates how much time compiling a cluster with XLA saves on each of its
+// executions, compared to running its nodes as TensorFlow kernels.
+//
+// XLA runs the nodes that it can fuse without writing their intermediate
+// results to memory and without the per-kernel overhead of the executor, while
+// the nodes that it lowers to library calls (matrix multiplications,
+// convolutions, ...) cost the same as in TensorFlow. On the other hand, every
+// execution of a cluster pays for the _XlaCompile and _XlaRun ops. The saved
+// memory traffic is computed from the shapes inferred for the graph and the
+// memory bandwidth that grappler's `OpLevelCostEstimator` uses for the device.
+class ClusterProfitabilityModel {
+ public:
+  struct Options {
+    // The overhead of running a node as a TensorFlow kernel, which fusion
+    // saves.
+    double kernel_overhead_us = 2.0;
+
+    // The overhead of running a compiled cluster.
+    double cluster_overhead_us = 10.0;
+  };
+
+  // `shape_info` must outlive the model.
+  ClusterProfitabilityModel(const GraphShapeInfo& shape_info,
+                            const Options& options);
+
+  // Returns the estimated time in microseconds that compiling the cluster made
+  // of `nodes` saves per execution. It is negative if the cluster is expected
+  // to be slower than the TensorFlow kernels it replaces.
+  double EstimateBenefitUs(absl::Span<const Node* const> nodes);
+
+  // Returns true if XLA doesn't fuse `node` with its neighbors.
+  static bool IsFusionBarrier(const Node& node);
+
+ private:
+  OpInfo::TensorProperties GetTensorProperties(const Node& node,
+                                               int output) const;
+  const DeviceProperties& GetDeviceProperties(const Node& node);
+
+  const GraphShapeInfo& shape_info_;
+  const Options options_;
+  grappler::OpLevelCostEstimator estimator_;
+  absl::flat_hash_map<std::string, DeviceProperties> device_properties_;
+};
+
+}  // namespace tensorflow
+
+#endif  // TENSORFLOW_COMPILER_JIT_CLUSTER_PROFITABILITY_H_
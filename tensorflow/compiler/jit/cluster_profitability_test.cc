@@ -0,0 +1,95 @@
+/* Copyright 2024 The TensorFlow Authors. All Rights Reserved.
+
+Licensed under the Apache License, Version 2.0 (the "License");
+you may not use this file except in compliance with the License.
+You may obtain a copy of the License at
+
+    http://www.apache.org/licenses/LICENSE-2.0
+
+Unless required by applicable law or agreed to in writing, software
+distributed under the License is distributed on an "AS IS" BASIS,
+WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+See the License for the specific language governing permissions and
+limitations under the License.
+==============================================================================*/
+
+#include "tensorflow/compiler/jit/cluster_profitability.h"
+
+#include <memory>
+#include <string>
+#include <vector>
+
+#include "absl/algorithm/container.h"
+#include "tensorflow/cc/framework/scope.h"
+#include "tensorflow/cc/ops/standard_ops.h"
+#include "tensorflow/compiler/jit/shape_inference.h"
+#include "tensorflow/core/graph/graph.h"
+#include "tensorflow/core/lib/core/status_test_util.h"
+#include "tensorflow/core/platform/test.h"
+
+namespace tensorflow {
+namespace {
+
+constexpr char kCpu[] = "/job:localhost/replica:0/task:0/device:CPU:0";
+
+class ClusterProfitabilityTest : public ::testing::Test {
+ protected:
+  // Returns the estimated benefit of clustering the nodes of `root` named in
+  // `names`.
+  double EstimateBenefitUs(const Scope& root,
+                           const std::vector<std::string>& names) {
+    graph_ = std::make_unique<Graph>(OpRegistry::Global());
+    TF_CHECK_OK(root.ToGraph(graph_.get()));
+    TF_CHECK_OK(InferShapes(graph_.get(), /*arg_shapes=*/{},
+                            /*fnlib_def=*/nullptr, &shape_info_));
+    std::vector<const Node*> nodes;
+    for (const Node* node : graph_->op_nodes()) {
+      if (absl::c_linear_search(names, node->name())) nodes.push_back(node);
+    }
+    CHECK_EQ(nodes.size(), names.size());
+    ClusterProfitabilityModel model(shape_info_,
+                                    ClusterProfitabilityModel::Options());
+    return model.EstimateBenefitUs(nodes);
+  }
+
+  std::unique_ptr<Graph> graph_;
+  GraphShapeInfo shape_info_;
+};
+
+TEST_F(ClusterProfitabilityTest, FusedElementwiseChainIsProfitable) {
+  Scope root = Scope::NewRootScope().ExitOnError().WithDevice(kCpu);
+  auto a = ops::Placeholder(root.WithOpName("a"), DT_FLOAT,
+                            ops::Placeholder::Shape({1024, 1024}));
+  auto b = ops::Relu(root.WithOpName("b"), a);
+  auto c = ops::Neg(root.WithOpName("c"), b);
+  auto d = ops::Relu(root.WithOpName("d"), c);
+  ops::Identity(root.WithOpName("e"), d);
+
+  EXPECT_GT(EstimateBenefitUs(root, {"b", "c", "d"}), 0);
+}
+
+TEST_F(ClusterProfitabilityTest, MatMulChainIsNotProfitable) {
+  Scope root = Scope::NewRootScope().ExitOnError().WithDevice(kCpu);
+  auto a = ops::Placeholder(root.WithOpName("a"), DT_FLOAT,
+                            ops::Placeholder::Shape({1024, 1024}));
+  auto b = ops::MatMul(root.WithOpName("b"), a, a);
+  auto c = ops::MatMul(root.WithOpName("c"), b, b);
+  auto d = ops::MatMul(root.WithOpName("d"), c, c);
+  ops::Identity(root.WithOpName("e"), d);
+
+  EXPECT_LT(EstimateBenefitUs(root, {"b", "c", "d"}), 0);
+}
+
+TEST_F(ClusterProfitabilityTest, SmallClusterIsNotProfitable) {
+  Scope root = Scope::NewRootScope().ExitOnError().WithDevice(kCpu);
+  auto a = ops::Placeholder(root.WithOpName("a"), DT_FLOAT,
+                            ops::Placeholder::Shape({2}));
+  auto b = ops::Relu(root.WithOpName("b"), a);
+  auto c = ops::Neg(root.WithOpName("c"), b);
+  ops::Identity(root.WithOpName("d"), c);
+
+  EXPECT_LT(EstimateBenefitUs(root, {"b", "c"}), 0);
+}
+
+}  // namespace
+}  // namespace tensorflow
@@ -126,6 +126,11 @@ absl::StatusOr<Signature> Signature::Build(
       case XlaCompiler::Argument::kResource:
         signature.args.push_back(
             TensorTypeAndShape(arg.type, arg.DimensionSizesAsInlinedVector()));
+        // A parameter with dynamic dimensions is compiled differently from
+        // one with the same static shape.
+        if (arg.value_dynamism.has_value()) {
+          signature.args.push_back(*arg.value_dynamism);
+        }
         break;
       default:
         return errors::InvalidArgument(
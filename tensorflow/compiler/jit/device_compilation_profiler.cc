@@ -21,6 +21,7 @@ limitations under the License.
 #include <utility>
 
 #include "absl/strings/str_cat.h"
+#include "tensorflow/compiler/jit/flags.h"
 #include "tensorflow/compiler/jit/xla_activity.pb.h"
 #include "tensorflow/compiler/jit/xla_activity_listener.h"
 #include "tensorflow/core/framework/attr_value.pb.h"
@@ -62,11 +63,12 @@ void RegisterExecutionForCluster(
 // signature before  we attempt to compile it.
 constexpr int64_t kDefaultCompilationThreshold = 2;
 
-// Maximum number of ongoing compilations.
-constexpr int64_t kMaxNumOngoingCompilations = kNumAsyncDeviceCompilerThreads;
-
 }  // namespace
 
+DeviceCompilationProfiler::DeviceCompilationProfiler()
+    : max_num_ongoing_compilations_(
+          GetXlaOpsCommonFlags()->tf_xla_max_concurrent_async_compilations) {}
+
 DeviceCompilationProfiler::~DeviceCompilationProfiler() {
   mutex_lock lock(mu_);
   cluster_compile_stats_.clear();
@@ -170,6 +172,17 @@ bool DeviceCompilationProfiler::ShouldCompileCluster(
   // that we always compile a cluster the first time it is executed (explained
   // below) regardless of compilation mode. If it is not, clean up the related
   // logic.
+  if (compile_mode == DeviceCompileMode::kAsync) {
+    // Asynchronous compilation is enabled. The cluster keeps running in the TF
+    // executor until it is compiled, so it is fine to defer its compilation,
+    // including the first one, until another compilation has finished.
+    if (num_ongoing_compilations_ >= max_num_ongoing_compilations_) {
+      VLOG(2) << "Not asynchronously compiling cluster " << function.name()
+              << " because of too many ongoing compilations.";
+      return false;
+    }
+  }
+
   // We always compile a cluster the very first time it is executed.  This is an
   // optimistic guess that pays off for statically shaped TensorFlow graphs
   // (since they get the benefit of XLA right away without waiting for warmup)
@@ -179,15 +192,6 @@ bool DeviceCompilationProfiler::ShouldCompileCluster(
     return true;
   }
 
-  if (compile_mode == DeviceCompileMode::kAsync) {
-    // Asynchronous compilation is enabled.
-    if (num_ongoing_compilations_ >= kMaxNumOngoingCompilations) {
-      VLOG(2) << "Not asynchronously compiling cluster " << function.name()
-              << " because of too many ongoing compilations.";
-      return false;
-    }
-  }
-
   bool reached_compile_threshold = current_request_count >= *compile_threshold;
   if (!reached_compile_threshold) {
     VLOG(2) << "Not compiling cluster " << function.name()
@@ -28,7 +28,7 @@ namespace tensorflow {
 // the given cluster should be compiled or not.
 class DeviceCompilationProfiler : public ResourceBase {
  public:
-  DeviceCompilationProfiler() = default;
+  DeviceCompilationProfiler();
   ~DeviceCompilationProfiler() override;
 
   struct ClusterCompileStats {
@@ -84,6 +84,10 @@ class DeviceCompilationProfiler : public ResourceBase {
   std::string DebugString() const override;
 
  private:
+  // The maximum number of clusters that are compiled asynchronously at the
+  // same time, from `--tf_xla_max_concurrent_async_compilations`.
+  const int64_t max_num_ongoing_compilations_;
+
   mutable mutex mu_;
 
   // Maps cluster names to compilation statistics for said cluster.
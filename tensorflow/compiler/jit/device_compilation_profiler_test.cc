@@ -21,6 +21,7 @@ limitations under the License.
 
 #include <gmock/gmock.h>
 #include <gtest/gtest.h>
+#include "tensorflow/compiler/jit/flags.h"
 #include "tensorflow/compiler/jit/tests/device_compiler_test_helper.h"
 #include "tensorflow/compiler/jit/xla_activity.pb.h"
 #include "tensorflow/core/framework/attr_value.pb.h"
@@ -194,13 +195,17 @@ TEST(DeviceCompilationProfilerTest, ShouldCompileClusterAsync) {
     profiler->IncrementOngoingAsyncCompilations();
   }
 
-  // Should allow compilation since this is the first execution.
+  // Should not allow compilation, even though this is the first execution,
+  // since we've already reached the maximum number of ongoing compilations
+  // allowed.
   profiler->RegisterExecution(function);
-  EXPECT_TRUE(
+  EXPECT_FALSE(
       profiler->ShouldCompileCluster(function, DeviceCompileMode::kAsync, 0));
 
-  // Should not allow compilation since this is not the first execution and
-  // we've already reached the maximum number of ongoing compilations allowed.
+  // The bound doesn't apply to lazy compilation, which blocks the caller.
+  EXPECT_TRUE(
+      profiler->ShouldCompileCluster(function, DeviceCompileMode::kLazy, 0));
+
   profiler->RegisterExecution(function);
   EXPECT_FALSE(
       profiler->ShouldCompileCluster(function, DeviceCompileMode::kAsync, 0));
@@ -212,6 +217,34 @@ TEST(DeviceCompilationProfilerTest, ShouldCompileClusterAsync) {
       profiler->ShouldCompileCluster(function, DeviceCompileMode::kAsync, 0));
 }
 
+TEST(DeviceCompilationProfilerTest, MaxConcurrentAsyncCompilations) {
+  XlaOpsCommonFlags* flags = GetXlaOpsCommonFlags();
+  const int64_t old_max_concurrent_async_compilations =
+      flags->tf_xla_max_concurrent_async_compilations;
+  flags->tf_xla_max_concurrent_async_compilations = 1;
+  DeviceCompilationProfiler* profiler = new DeviceCompilationProfiler();
+  core::ScopedUnref profiler_ref(profiler);
+  flags->tf_xla_max_concurrent_async_compilations =
+      old_max_concurrent_async_compilations;
+
+  NameAttrList function;
+  function.set_name("TestFunc");
+  profiler->RegisterExecution(function);
+  EXPECT_TRUE(
+      profiler->ShouldCompileCluster(function, DeviceCompileMode::kAsync, 0));
+
+  profiler->IncrementOngoingAsyncCompilations();
+  NameAttrList other_function;
+  other_function.set_name("OtherTestFunc");
+  profiler->RegisterExecution(other_function);
+  EXPECT_FALSE(profiler->ShouldCompileCluster(other_function,
+                                              DeviceCompileMode::kAsync, 0));
+
+  profiler->DecrementOngoingAsyncCompilations();
+  EXPECT_TRUE(profiler->ShouldCompileCluster(other_function,
+                                             DeviceCompileMode::kAsync, 0));
+}
+
 TEST(DeviceCompilationProfilerTest, ShouldCompileClusterLazy) {
   DeviceCompilationProfiler* profiler = new DeviceCompilationProfiler();
   core::ScopedUnref profiler_ref(profiler);
@@ -214,9 +214,12 @@ DeviceCompiler<ExecutableType, ClientType>::DeviceCompiler(
     : persistor_(std::move(persistor)),
       compiler_client_(std::move(compiler_client)) {
   cache_ = std::make_unique<DeviceCompilationCache<ExecutableType>>();
+  // Bounds the number of clusters that are compiled at the same time for this
+  // device.
   async_compiler_threads_ = std::make_unique<tensorflow::thread::ThreadPool>(
       tensorflow::Env::Default(), "async_compiler_threads",
-      kNumAsyncDeviceCompilerThreads);
+      std::max<int64_t>(
+          1, GetXlaOpsCommonFlags()->tf_xla_max_concurrent_async_compilations));
 }
 
 template <typename ExecutableType, typename ClientType>
@@ -16,10 +16,14 @@ limitations under the License.
 #ifndef TENSORFLOW_COMPILER_JIT_DEVICE_EXECUTABLE_PERSISTOR_H_
 #define TENSORFLOW_COMPILER_JIT_DEVICE_EXECUTABLE_PERSISTOR_H_
 
+#include <memory>
 #include <optional>
 #include <string>
+#include <utility>
 
 #include "absl/log/log.h"
+#include "absl/synchronization/notification.h"
+#include "absl/time/time.h"
 #include "tensorflow/compiler/jit/xla_compilation_cache.pb.h"
 #include "tensorflow/compiler/jit/xla_device_compiler_client.h"
 #include "tensorflow/compiler/tf2xla/xla_compiler.h"
@@ -38,6 +42,13 @@ namespace tensorflow {
 // Offers a way to persist and/or load compiled `ExecutableType`s along with the
 // corresponding HLO (`CompilationResult`) to/from `persistent_cache_directory`
 // (if one was provided during construction) on disk  using `ClientType`.
+//
+// Entries can also be shared through a `remote_cache_directory`, e.g. on GCS,
+// by all the hosts that compile the same clusters. Entries are addressed by
+// their content (the signature, the HLO, the device type and the compiler
+// fingerprint), so hosts never need to coordinate. Remote entries are fetched
+// in the background and the executable is compiled locally if the fetch takes
+// too long.
 template <typename ExecutableType, typename ClientType>
 class DeviceExecutablePersistor {
  public:
@@ -74,6 +85,22 @@ class DeviceExecutablePersistor {
 
     // Cache is read-only if set to true.
     bool persistent_cache_directory_read_only = false;
+
+    // If non-empty, entries that are not found in `persistent_cache_directory`
+    // are fetched from this directory, and persisted entries are uploaded to
+    // it too. It can be on any file system supported by `Env`.
+    std::string remote_cache_directory;
+
+    // How long to wait for an entry to be fetched from `remote_cache_directory`
+    // before falling back to compiling locally. A fetched entry is saved to
+    // `persistent_cache_directory`, even if it arrives too late. Waits until
+    // the fetch completes if not positive.
+    int64_t remote_cache_fetch_timeout_ms = 0;
+
+    // Identifies the compiler and the device the executables are built with,
+    // so that hosts with different versions or hardware don't load each
+    // other's entries. Not part of the cache key if zero.
+    uint64 compiler_fingerprint = 0;
   };
 
   DeviceExecutablePersistor(const Config& config,
@@ -109,6 +136,9 @@ class DeviceExecutablePersistor {
   const std::string& persistent_cache_directory() const {
     return persistent_cache_directory_;
   }
+  const std::string& remote_cache_directory() const {
+    return remote_cache_directory_;
+  }
 
  private:
   // Returns a cache key proto that identifies an entry in the compilation
@@ -127,24 +157,31 @@ class DeviceExecutablePersistor {
       const ExecutableType& executable,
       DeviceCompilerClient<ExecutableType, ClientType>* compiler_client) const;
 
-  // Saves the cache entry in the file directory supplied during the
-  // construction of this class. Overwrites existing entries.
-  Status SaveSerializedEntry(const XlaSerializedCacheEntry& entry) const;
+  // Saves the cache entry in `directory`. Overwrites existing entries.
+  static Status SaveSerializedEntry(const std::string& directory,
+                                    const XlaSerializedCacheEntry& entry);
+
+  // Tries to read a cache entry given a `key` by searching `directory`.
+  // Returns std::nullopt if no cache entry is found.
+  static absl::StatusOr<std::optional<XlaSerializedCacheEntry>>
+  TryToReadSerializedEntry(const std::string& directory,
+                           const XlaSerializedCacheKey& key);
 
-  // Tries to read a cache entry given a `key` by searching the file directory
-  // supplied during the construction of this class. Returns std::nullopt if no
-  // cache entry is found.
-  absl::StatusOr<std::optional<XlaSerializedCacheEntry>>
-  TryToReadSerializedEntry(const XlaSerializedCacheKey& key) const;
+  // Reads a cache entry from `remote_cache_directory_` in the background and
+  // waits for it for at most `remote_cache_fetch_timeout_ms_`. Returns
+  // std::nullopt if no cache entry is found in time.
+  absl::StatusOr<std::optional<XlaSerializedCacheEntry>> TryToFetchRemoteEntry(
+      const XlaSerializedCacheKey& key) const;
 
   // Checks if the loaded `entry` matches the expected `key` and `hlo_module`.
   Status VerifyLoadedCacheEntry(const XlaSerializedCacheKey& key,
                                 const xla::HloModuleProto& hlo_module,
                                 const XlaSerializedCacheEntry& entry) const;
 
-  std::string XlaSerializedCacheKeyToString(
-      const XlaSerializedCacheKey& key) const;
-  std::string GetFilePath(const XlaSerializedCacheKey& key) const;
+  static std::string XlaSerializedCacheKeyToString(
+      const XlaSerializedCacheKey& key);
+  static std::string GetFilePath(const std::string& directory,
+                                 const XlaSerializedCacheKey& key);
 
   const DeviceType device_type_;
   const bool disable_strict_signature_checks_;
@@ -157,6 +194,12 @@ class DeviceExecutablePersistor {
   // Cache is read-only if set to true.
   const bool persistent_cache_directory_read_only_;
 
+  // If non-empty, JIT-compiled executables are shared with other hosts through
+  // the specified file system directory path.
+  const std::string remote_cache_directory_;
+  const int64_t remote_cache_fetch_timeout_ms_;
+  const uint64 compiler_fingerprint_;
+
   DeviceExecutablePersistor(const DeviceExecutablePersistor&) = delete;
   void operator=(const DeviceExecutablePersistor&) = delete;
 };
@@ -170,17 +213,24 @@ DeviceExecutablePersistor<ExecutableType, ClientType>::
       persistence_prefix_(config.persistence_prefix),
       persistent_cache_directory_(config.persistent_cache_directory),
       persistent_cache_directory_read_only_(
-          config.persistent_cache_directory_read_only) {}
+          config.persistent_cache_directory_read_only),
+      remote_cache_directory_(config.remote_cache_directory),
+      remote_cache_fetch_timeout_ms_(config.remote_cache_fetch_timeout_ms),
+      compiler_fingerprint_(config.compiler_fingerprint) {}
 
 template <typename ExecutableType, typename ClientType>
 std::string DeviceExecutablePersistor<ExecutableType, ClientType>::
-    XlaSerializedCacheKeyToString(const XlaSerializedCacheKey& key) const {
+    XlaSerializedCacheKeyToString(const XlaSerializedCacheKey& key) {
   static constexpr char kXlaSerializedCacheKeySeparator[] = "__";
   return absl::StrCat(
       key.prefix(), key.prefix().empty() ? "" : kXlaSerializedCacheKeySeparator,
       key.signature_fingerprint(), kXlaSerializedCacheKeySeparator,
       key.cluster_fingerprint(), kXlaSerializedCacheKeySeparator,
       key.device_type(),
+      key.compiler_fingerprint() != 0
+          ? absl::StrCat(kXlaSerializedCacheKeySeparator,
+                         key.compiler_fingerprint())
+          : "",
       key.compiled_using_pjrt()
           ? absl::StrCat(kXlaSerializedCacheKeySeparator, "pjrt")
           : "");
@@ -188,10 +238,10 @@ std::string DeviceExecutablePersistor<ExecutableType, ClientType>::
 
 template <typename ExecutableType, typename ClientType>
 std::string DeviceExecutablePersistor<ExecutableType, ClientType>::GetFilePath(
-    const XlaSerializedCacheKey& key) const {
+    const std::string& directory, const XlaSerializedCacheKey& key) {
   const std::string file_name =
       absl::StrCat(XlaSerializedCacheKeyToString(key), ".pb");
-  return io::JoinPath(persistent_cache_directory_, file_name);
+  return io::JoinPath(directory, file_name);
 }
 
 template <typename ExecutableType, typename ClientType>
@@ -205,6 +255,7 @@ DeviceExecutablePersistor<ExecutableType, ClientType>::BuildSerializedCacheKey(
   key.set_device_type(device_type().type_string());
   key.set_prefix(persistence_prefix());
   key.set_compiled_using_pjrt(compiled_using_pjrt);
+  key.set_compiler_fingerprint(compiler_fingerprint_);
   return key;
 }
 
@@ -228,9 +279,9 @@ DeviceExecutablePersistor<xla::PjRtLoadedExecutable, xla::PjRtClient>::
 template <typename ExecutableType, typename ClientType>
 absl::StatusOr<std::optional<XlaSerializedCacheEntry>>
 DeviceExecutablePersistor<ExecutableType, ClientType>::TryToReadSerializedEntry(
-    const XlaSerializedCacheKey& key) const {
+    const std::string& directory, const XlaSerializedCacheKey& key) {
   Env* env = Env::Default();
-  const std::string file_path = GetFilePath(key);
+  const std::string file_path = GetFilePath(directory, key);
   if (!env->FileExists(file_path).ok()) {
     return absl::StatusOr<std::optional<XlaSerializedCacheEntry>>(std::nullopt);
   }
@@ -240,6 +291,46 @@ DeviceExecutablePersistor<ExecutableType, ClientType>::TryToReadSerializedEntry(
   return std::optional<XlaSerializedCacheEntry>(entry);
 }
 
+template <typename ExecutableType, typename ClientType>
+absl::StatusOr<std::optional<XlaSerializedCacheEntry>>
+DeviceExecutablePersistor<ExecutableType, ClientType>::TryToFetchRemoteEntry(
+    const XlaSerializedCacheKey& key) const {
+  // Shared with the fetching closure, which may outlive this call (and this
+  // persistor) if the fetch times out.
+  struct RemoteFetch {
+    absl::Notification done;
+    absl::StatusOr<std::optional<XlaSerializedCacheEntry>> entry;
+  };
+  auto fetch = std::make_shared<RemoteFetch>();
+  const std::string local_directory = persistent_cache_directory_read_only_
+                                          ? ""
+                                          : persistent_cache_directory_;
+  Env::Default()->SchedClosure([fetch, key, local_directory,
+                                remote_directory = remote_cache_directory_]() {
+    fetch->entry = TryToReadSerializedEntry(remote_directory, key);
+    fetch->done.Notify();
+    // Keep a local copy, so that later loads on this host don't go remote.
+    if (!local_directory.empty() && fetch->entry.ok() &&
+        fetch->entry->has_value()) {
+      Status status = SaveSerializedEntry(local_directory, **fetch->entry);
+      if (!status.ok()) {
+        LOG(WARNING) << "Failed to save a fetched XLA executable to "
+                     << local_directory << ": " << status;
+      }
+    }
+  });
+
+  if (remote_cache_fetch_timeout_ms_ <= 0) {
+    fetch->done.WaitForNotification();
+  } else if (!fetch->done.WaitForNotificationWithTimeout(
+                 absl::Milliseconds(remote_cache_fetch_timeout_ms_))) {
+    VLOG(1) << "Timed out fetching a cache entry from "
+            << remote_cache_directory_ << ", compiling locally.";
+    return absl::StatusOr<std::optional<XlaSerializedCacheEntry>>(std::nullopt);
+  }
+  return fetch->entry;
+}
+
 template <typename ExecutableType, typename ClientType>
 Status
 DeviceExecutablePersistor<ExecutableType, ClientType>::VerifyLoadedCacheEntry(
@@ -277,21 +368,19 @@ DeviceExecutablePersistor<ExecutableType, ClientType>::VerifyLoadedCacheEntry(
 template <typename ExecutableType, typename ClientType>
 Status
 DeviceExecutablePersistor<ExecutableType, ClientType>::SaveSerializedEntry(
-    const XlaSerializedCacheEntry& entry) const {
+    const std::string& directory, const XlaSerializedCacheEntry& entry) {
   Env* env = Env::Default();
-  TF_RETURN_IF_ERROR(env->RecursivelyCreateDir(persistent_cache_directory_));
+  TF_RETURN_IF_ERROR(env->RecursivelyCreateDir(directory));
 
   // The cache on the filesystem can be read while we're writing out the proto.
   // To prevent reads of partially-written files, we write the proto to a temp
   // file, then move it into place once we're done writing.  And we warn the
   // user if these moves are not known to be atomic.
   bool has_atomic_move = false;
-  env->HasAtomicMove(persistent_cache_directory_, &has_atomic_move)
-      .IgnoreError();
+  env->HasAtomicMove(directory, &has_atomic_move).IgnoreError();
   if (!has_atomic_move) {
     LOG_EVERY_POW_2(WARNING)
-        << "Filesystem for XLA persistent cache at "
-        << persistent_cache_directory_
+        << "Filesystem for XLA persistent cache at " << directory
         << " does not support atomic moves.  Therefore the persistent cache is "
            "racy if you have multiple XLA compilations occurring "
            "simultaneously!  You have been warned. :)";
@@ -299,14 +388,14 @@ DeviceExecutablePersistor<ExecutableType, ClientType>::SaveSerializedEntry(
 
   // Write to temp location, then when that completes, atomically move into the
   // final location.
-  std::string temp_path = io::JoinPath(
-      persistent_cache_directory_, XlaSerializedCacheKeyToString(entry.key()));
+  std::string temp_path =
+      io::JoinPath(directory, XlaSerializedCacheKeyToString(entry.key()));
   if (!env->CreateUniqueFileName(&temp_path, ".pb.tmp")) {
-    return absl::UnavailableError(absl::StrCat(
-        "Could not create a unique file inside ", persistent_cache_directory_));
+    return absl::UnavailableError(
+        absl::StrCat("Could not create a unique file inside ", directory));
   }
   TF_RETURN_IF_ERROR(WriteBinaryProto(env, temp_path, entry));
-  return env->RenameFile(temp_path, GetFilePath(entry.key()));
+  return env->RenameFile(temp_path, GetFilePath(directory, entry.key()));
 }
 
 template <typename ExecutableType, typename ClientType>
@@ -351,7 +440,7 @@ DeviceExecutablePersistor<ExecutableType, ClientType>::TryToLoadExecutable(
     const XlaCompiler::Options& options,
     const XlaCompiler::CompilationResult& compilation_result,
     DeviceCompilerClient<ExecutableType, ClientType>* compiler_client) const {
-  if (persistent_cache_directory_.empty()) {
+  if (persistent_cache_directory_.empty() && remote_cache_directory_.empty()) {
     return std::nullopt;
   }
 
@@ -365,7 +454,14 @@ DeviceExecutablePersistor<ExecutableType, ClientType>::TryToLoadExecutable(
   {
     XLA_SCOPED_LOGGING_TIMER(
         absl::StrCat("Try loading serialized cache entry:", signature_str));
-    TF_ASSIGN_OR_RETURN(serialized_entry, TryToReadSerializedEntry(cache_key));
+    if (!persistent_cache_directory_.empty()) {
+      TF_ASSIGN_OR_RETURN(serialized_entry,
+                          TryToReadSerializedEntry(persistent_cache_directory_,
+                                                   cache_key));
+    }
+    if (!serialized_entry.has_value() && !remote_cache_directory_.empty()) {
+      TF_ASSIGN_OR_RETURN(serialized_entry, TryToFetchRemoteEntry(cache_key));
+    }
   }
 
   if (!serialized_entry.has_value()) {
@@ -388,10 +484,11 @@ DeviceExecutablePersistor<ExecutableType, ClientType>::TryToPersistExecutable(
     const XlaCompiler::CompilationResult& compilation_result,
     const ExecutableType& executable,
     DeviceCompilerClient<ExecutableType, ClientType>* client) const {
-  if (persistent_cache_directory_.empty() ||
+  if ((persistent_cache_directory_.empty() &&
+       remote_cache_directory_.empty()) ||
       persistent_cache_directory_read_only_) {
     VLOG(1) << "Not persisting executable. No `persistent_cache_directory` "
-               "provided or cache is read-only.";
+               "or `remote_cache_directory` provided or cache is read-only.";
     return absl::OkStatus();
   }
 
@@ -400,7 +497,23 @@ DeviceExecutablePersistor<ExecutableType, ClientType>::TryToPersistExecutable(
   TF_ASSIGN_OR_RETURN(XlaSerializedCacheEntry serialized_entry,
                       SerializeEntry(signature_hash, options,
                                      compilation_result, executable, client));
-  TF_RETURN_IF_ERROR(SaveSerializedEntry(std::move(serialized_entry)));
+  if (!persistent_cache_directory_.empty()) {
+    TF_RETURN_IF_ERROR(
+        SaveSerializedEntry(persistent_cache_directory_, serialized_entry));
+  }
+  if (!remote_cache_directory_.empty()) {
+    // Upload in the background to not delay the execution of the cluster.
+    auto entry = std::make_shared<const XlaSerializedCacheEntry>(
+        std::move(serialized_entry));
+    Env::Default()->SchedClosure(
+        [entry, remote_directory = remote_cache_directory_]() {
+          Status status = SaveSerializedEntry(remote_directory, *entry);
+          if (!status.ok()) {
+            LOG(WARNING) << "Failed to upload an XLA executable to "
+                         << remote_directory << ": " << status;
+          }
+        });
+  }
   return absl::OkStatus();
 }
 
@@ -428,6 +428,59 @@ TEST_F(DeviceExecutionPersistorTest, LoadFileDoesntExist) {
   EXPECT_FALSE(loaded_executable.has_value());
 }
 
+TEST_F(DeviceExecutionPersistorTest, LoadFromRemoteCache) {
+  const std::string remote_cache_dir = io::JoinPath(cache_dir_, "remote");
+  {
+    // Populate the remote cache as another host would.
+    XlaDeviceExecutablePersistor::Config config(
+        /*persistent_cache_directory=*/remote_cache_dir,
+        /*disable_strict_signature_checks=*/false,
+        /*persistence_prefix=*/"xla");
+    config.compiler_fingerprint = 42;
+    XlaDeviceExecutablePersistor persistor(config,
+                                           DefaultXlaOptions().device_type);
+
+    MockXlaCompilerClient mock_client;
+    EXPECT_CALL(mock_client, SerializeExecutable(_))
+        .WillOnce(
+            Return(absl::StatusOr<std::string>(serialized_xla_executable_)));
+    TF_ASSERT_OK_AND_ASSIGN(auto executable, BuildSampleExecutable());
+    TF_ASSERT_OK(persistor.TryToPersistExecutable(
+        /*signature_hash=*/789, "signature_string", DefaultXlaOptions(),
+        compilation_result_add_, *executable, &mock_client));
+  }
+
+  XlaDeviceExecutablePersistor::Config config(
+      /*persistent_cache_directory=*/io::JoinPath(cache_dir_, "local"),
+      /*disable_strict_signature_checks=*/false,
+      /*persistence_prefix=*/"xla");
+  config.remote_cache_directory = remote_cache_dir;
+  config.compiler_fingerprint = 42;
+  XlaDeviceExecutablePersistor persistor(config,
+                                         DefaultXlaOptions().device_type);
+
+  MockXlaCompilerClient mock_client;
+  TF_ASSERT_OK_AND_ASSIGN(auto executable, BuildSampleExecutable());
+  EXPECT_CALL(mock_client, LoadExecutable(_, _, serialized_xla_executable_))
+      .WillOnce(Return(ByMove(std::move(executable))));
+  auto loaded_executable = persistor.TryToLoadExecutable(
+      /*signature_hash=*/789, "signature_string", DefaultXlaOptions(),
+      compilation_result_add_, &mock_client);
+  ASSERT_TRUE(loaded_executable.has_value());
+  TF_EXPECT_OK(loaded_executable->status());
+
+  // Entries built by a different compiler are not shared.
+  config.compiler_fingerprint = 43;
+  XlaDeviceExecutablePersistor other_persistor(config,
+                                               DefaultXlaOptions().device_type);
+  EXPECT_FALSE(other_persistor
+                   .TryToLoadExecutable(
+                       /*signature_hash=*/789, "signature_string",
+                       DefaultXlaOptions(), compilation_result_add_,
+                       &mock_client)
+                   .has_value());
+}
+
 TEST_F(DeviceExecutionPersistorTest, LoadSerializedKeyMismatch) {
   XlaDeviceExecutablePersistor::Config config(
       /*persistent_cache_directory=*/cache_dir_,
@@ -108,6 +108,11 @@ void AppendMarkForCompilationPassFlagsInternal(std::vector<Flag>* flag_list) {
       Flag("tf_xla_max_cluster_size",
            &mark_for_compilation_flags->tf_xla_max_cluster_size,
            "Maximum number of operators in an XLA compilation."),
+      Flag("tf_xla_check_cluster_profitability",
+           &mark_for_compilation_flags->tf_xla_check_cluster_profitability,
+           "If true, auto-clusters that a cost model predicts to be slower "
+           "than the TensorFlow kernels they replace are not compiled. "
+           "Experimental."),
       Flag(
           "tf_xla_ops_to_cluster",
           &mark_for_compilation_flags->tf_xla_ops_to_cluster,
@@ -175,6 +180,16 @@ void AppendMarkForCompilationPassFlagsInternal(std::vector<Flag>* flag_list) {
            &mark_for_compilation_flags->tf_xla_persistent_cache_prefix,
            "Specifies the persistance cache prefix. Default is "
            "\"xla_compile_cache\""),
+      Flag("tf_xla_remote_cache_directory",
+           &mark_for_compilation_flags->tf_xla_remote_cache_directory,
+           "If non-empty, JIT-compiled executables are shared with other "
+           "hosts through the specified file system directory path, e.g. on "
+           "GCS. Empty by default."),
+      Flag("tf_xla_remote_cache_fetch_timeout_ms",
+           &mark_for_compilation_flags->tf_xla_remote_cache_fetch_timeout_ms,
+           "How long to wait for an executable to be fetched from the remote "
+           "cache before compiling it locally. Waits for the fetch to finish "
+           "if not positive. Defaults to 10000."),
       Flag("tf_xla_sparse_core_disable_table_stacking",
            &sparse_core_flags->tf_xla_sparse_core_disable_table_stacking,
            "Disable table stacking for all the tables passed to the SparseCore"
@@ -228,6 +243,7 @@ void AllocateAndParseFlags() {
       0;
   mark_for_compilation_flags->xla_auto_jit_flag.optimization_level_general = 0;
   mark_for_compilation_flags->tf_xla_min_cluster_size = 4;
+  mark_for_compilation_flags->tf_xla_check_cluster_profitability = false;
   mark_for_compilation_flags->tf_xla_max_cluster_size =
       std::numeric_limits<int32>::max();
   mark_for_compilation_flags->tf_xla_clustering_debug = false;
@@ -245,6 +261,8 @@ void AllocateAndParseFlags() {
   mark_for_compilation_flags->tf_xla_disable_strict_signature_checks = false;
   mark_for_compilation_flags->tf_xla_persistent_cache_prefix =
       "xla_compile_cache";
+  mark_for_compilation_flags->tf_xla_remote_cache_directory = "";
+  mark_for_compilation_flags->tf_xla_remote_cache_fetch_timeout_ms = 10000;
 
   device_flags = new XlaDeviceFlags;
   device_flags->tf_xla_compile_on_demand = false;
@@ -263,6 +281,9 @@ void AllocateAndParseFlags() {
   ops_flags = new XlaOpsCommonFlags;
   ops_flags->tf_xla_always_defer_compilation = false;
   ops_flags->tf_xla_async_compilation = false;
+  ops_flags->tf_xla_max_concurrent_async_compilations = 10;
+  ops_flags->tf_xla_shape_bucketing = false;
+  ops_flags->tf_xla_shape_buckets = "";
   ops_flags->tf_xla_use_device_api.enabled_for_xla_launch_ = true;
   ops_flags->tf_xla_use_device_api.enabled_for_compile_on_demand_ = true;
   ops_flags->tf_xla_use_device_api.enabled_for_compile_and_run_ = true;
@@ -334,6 +355,20 @@ void AllocateAndParseFlags() {
             "When lazy compilation is enabled, asynchronous compilation starts "
             "the cluster compilation in the background, and the fallback path "
             "is executed until the compilation has finished."),
+       Flag("tf_xla_max_concurrent_async_compilations",
+            &ops_flags->tf_xla_max_concurrent_async_compilations,
+            "The maximum number of clusters a device compiles asynchronously "
+            "at the same time. Further clusters run in the TF executor until "
+            "a compilation finishes."),
+       Flag("tf_xla_shape_bucketing", &ops_flags->tf_xla_shape_bucketing,
+            "If true, the dimensions of cluster inputs whose sizes vary "
+            "between executions are padded up to a bucket size, which bounds "
+            "the number of times a cluster is compiled. XLA masks the padding "
+            "and the outputs have their actual sizes."),
+       Flag("tf_xla_shape_buckets", &ops_flags->tf_xla_shape_buckets,
+            "Comma-separated, increasing bucket sizes used by "
+            "--tf_xla_shape_bucketing. If empty, dimensions are padded up to "
+            "the next power of two."),
        Flag("tf_xla_use_device_api_for_xla_launch",
             &ops_flags->tf_xla_use_device_api.enabled_for_xla_launch_,
             "If true, uses Device API (PjRt) for single device compilation and "
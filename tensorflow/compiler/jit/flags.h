@@ -62,6 +62,11 @@ struct MarkForCompilationPassFlags {
   // Maximum number of operators in an XLA compilation.
   int32 tf_xla_max_cluster_size;
 
+  // If true, auto-clusters that a cost model predicts to be slower than the
+  // TensorFlow kernels they replace are not compiled. Ignored for operators
+  // placed on an XLA device or operators explicitly marked for compilation.
+  bool tf_xla_check_cluster_profitability;
+
   // If non-empty, limit XLA clustering to the following TF operations.
   string tf_xla_ops_to_cluster;
 
@@ -111,6 +116,15 @@ struct MarkForCompilationPassFlags {
 
   // Specifies the persistance cache prefix. Default is "xla_compile_cache"
   string tf_xla_persistent_cache_prefix;
+
+  // If non-empty, JIT-compiled executables are shared with other hosts through
+  // the specified file system directory path, e.g. on GCS. Executables missing
+  // from the persistent cache are fetched from it, and new ones are uploaded.
+  std::string tf_xla_remote_cache_directory;
+
+  // How long to wait for an executable to be fetched from the remote cache
+  // before compiling it locally. Waits for the fetch to finish if not positive.
+  int64_t tf_xla_remote_cache_fetch_timeout_ms;
 };
 
 // Flags associated with XLA Sparse Core.
@@ -151,6 +165,17 @@ struct XlaOpsCommonFlags {
   // If true, _XlaCompile compiles the cluster asynchronously with respect to
   // the main execution. The fallback path is taken while compilation happens.
   bool tf_xla_async_compilation;
+  // The maximum number of clusters a device compiles asynchronously at the
+  // same time. Further clusters keep running in the TF executor until a
+  // compilation finishes. Defaults to 10.
+  int64_t tf_xla_max_concurrent_async_compilations;
+  // If true, the dimensions of cluster inputs whose sizes vary between
+  // executions are padded up to a bucket size, so that a cluster is compiled
+  // once per bucket instead of once per shape. Defaults to false.
+  bool tf_xla_shape_bucketing;
+  // Comma-separated, increasing bucket sizes for `tf_xla_shape_bucketing`. If
+  // empty, dimensions are padded up to the next power of two.
+  std::string tf_xla_shape_buckets;
 
   class PjRtForSingleDeviceCompilationRollout {
    public:
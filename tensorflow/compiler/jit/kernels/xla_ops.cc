@@ -30,11 +30,13 @@ limitations under the License.
 #include "absl/status/status.h"
 #include "absl/strings/str_cat.h"
 #include "absl/types/optional.h"
+#include "absl/types/span.h"
 #include "tensorflow/compiler/jit/device_compilation_profiler.h"
 #include "tensorflow/compiler/jit/device_compiler.h"
 #include "tensorflow/compiler/jit/encapsulate_subgraphs_pass.h"
 #include "tensorflow/compiler/jit/flags.h"
 #include "tensorflow/compiler/jit/pjrt_compile_util.h"
+#include "tensorflow/compiler/jit/shape_bucketing.h"
 #include "tensorflow/compiler/jit/variable_info.h"
 #include "tensorflow/compiler/jit/variable_info_util.h"
 #include "tensorflow/compiler/jit/xla_activity_listener.h"
@@ -123,6 +125,9 @@ class ExecutableClosure {
   const ResourceVarsSnapshot& resource_var_snapshots() const {
     return resource_var_snapshots_;
   }
+  ResourceVarsSnapshot& mutable_resource_var_snapshots() {
+    return resource_var_snapshots_;
+  }
   int num_constant_args() const { return num_constant_args_; }
 
  private:
@@ -418,9 +423,30 @@ Status CompileToLocalExecutable(
   XlaCompiler::CompileOptions compile_options =
       GenerateCompileOptions(has_ref_vars, may_alias_resource_update);
 
+  if (!GetXlaOpsCommonFlags()->tf_xla_shape_bucketing) {
+    return xla_device_compiler->CompileIfNeeded(
+        options, function, args, compile_options, compile_mode, profiler,
+        compilation_result, executable);
+  }
+
+  // The inputs of the executable are padded to the bucketed shapes by
+  // `XlaComputationLaunchContext::PopulateInputs`.
+  ShapeBucketing* bucketing;
+  TF_RETURN_IF_ERROR(rm->LookupOrCreate<ShapeBucketing>(
+      rm->default_container(), "xla_shape_bucketing", &bucketing,
+      [](ShapeBucketing** bucketing) -> Status {
+        TF_ASSIGN_OR_RETURN(std::vector<int64_t> bucket_sizes,
+                            ShapeBucketing::ParseBucketSizes(
+                                GetXlaOpsCommonFlags()->tf_xla_shape_buckets));
+        *bucketing = new ShapeBucketing(std::move(bucket_sizes));
+        return absl::OkStatus();
+      }));
+  core::ScopedUnref bucketing_ref(bucketing);
+  std::vector<XlaCompiler::Argument> bucketed_args = args;
+  bucketing->BucketArguments(function, &bucketed_args);
   return xla_device_compiler->CompileIfNeeded(
-      options, function, args, compile_options, compile_mode, profiler,
-      compilation_result, executable);
+      options, function, bucketed_args, compile_options, compile_mode,
+      profiler, compilation_result, executable);
 }
 
 Status GetUpdatedVariables(
@@ -778,20 +804,23 @@ void XlaCompileOp::Compute(OpKernelContext* ctx) {
         args_and_variables_snapshot->first;
     variables_snapshot = std::move(args_and_variables_snapshot->second);
 
-    // Do not alias resource updates as locking variables in XlaCompile and
-    // unlocking them in XlaRun may lead to deadlocks.
+    // Resource updates are aliased with their inputs. The variables are not
+    // locked across XlaCompile and XlaRun as that may lead to deadlocks;
+    // instead XlaRun donates the buffer of an updated variable only if the
+    // variable still holds the snapshot taken here (see
+    // GetVariableSnapshotPtrs).
     Status status;
     if (use_pjrt) {
       VLOG(2) << "Using PJRT for compilation. Function name: "
               << function_.name();
       status = CompileToPjRtLoadedExecutable(
           *ctx, platform_info_, function_, args, compile_mode, has_ref_vars_,
-          /*may_alias_resource_update=*/false, &kernel, &pjrt_client,
+          /*may_alias_resource_update=*/true, &kernel, &pjrt_client,
           &pjrt_executable);
     } else {
       status = CompileToLocalExecutable(
           ctx, function_, has_ref_vars_, platform_info_, args, compile_mode,
-          /*may_alias_resource_update=*/false, &client, &kernel, &executable);
+          /*may_alias_resource_update=*/true, &client, &kernel, &executable);
     }
     if (compile_mode != DeviceCompileMode::kLazy ||
         status.code() != error::UNIMPLEMENTED) {
@@ -879,13 +908,6 @@ void XlaRunOp::Compute(OpKernelContext* ctx) {
     // last input. So the inputs look like: input tensors, resource variables,
     // closure key tensor.
     std::vector<const Tensor*> inputs = InputsFromContext(ctx);
-    absl::flat_hash_map<int, const Tensor*> variable_snapshots;
-    for (const auto& [variable_index, variable_tensor] :
-         closure.resource_var_snapshots()) {
-      variable_snapshots.emplace(variable_index, variable_tensor.has_value()
-                                                     ? &variable_tensor.value()
-                                                     : nullptr);
-    }
 
     {
       absl::StatusOr<std::vector<VariableInfo>> updated_variables =
@@ -893,6 +915,10 @@ void XlaRunOp::Compute(OpKernelContext* ctx) {
                              closure.num_constant_args());
       OP_REQUIRES_OK(ctx, updated_variables.status());
       OP_REQUIRES_OK(ctx, LockVariables(absl::MakeSpan(*updated_variables)));
+      absl::flat_hash_map<int, const Tensor*> variable_snapshots;
+      GetVariableSnapshotPtrs(*updated_variables, closure.num_constant_args(),
+                              closure.mutable_resource_var_snapshots(),
+                              variable_snapshots);
       OP_REQUIRES_OK(
           ctx, RunPjRtExecutable(closure.num_constant_args(), inputs,
                                  variable_snapshots, *updated_variables,
@@ -920,6 +946,13 @@ void XlaRunOp::Compute(OpKernelContext* ctx) {
       closure.executable()->executable()->module().input_output_alias_config();
   absl::StatusOr<std::vector<xla::ExecutionInput>> execution_inputs;
   std::map<int, const Tensor*> snapshot_ptrs;
+
+  // The updated variables are locked for the whole execution, so that the
+  // buffers donated to the executable are not read or replaced concurrently.
+  absl::StatusOr<std::vector<VariableInfo>> variable_infos = GatherVariableInfo(
+      ctx, *closure.compilation_result(), closure.num_constant_args());
+  OP_REQUIRES_OK(ctx, variable_infos.status());
+  OP_REQUIRES_OK(ctx, LockVariables(absl::MakeSpan(*variable_infos)));
   {
     tsl::profiler::TraceMe hlo_module_activity(
         [&] {
@@ -929,12 +962,9 @@ void XlaRunOp::Compute(OpKernelContext* ctx) {
         },
         tsl::profiler::TraceMeLevel::kInfo);
 
-    for (const auto& [variable_index, variable_tensor] :
-         closure.resource_var_snapshots()) {
-      snapshot_ptrs.emplace(variable_index, variable_tensor.has_value()
-                                                ? &variable_tensor.value()
-                                                : nullptr);
-    }
+    GetVariableSnapshotPtrs(*variable_infos, closure.num_constant_args(),
+                            closure.mutable_resource_var_snapshots(),
+                            snapshot_ptrs);
     execution_inputs = launch_context.PopulateInputs(
         ctx, closure.compilation_result(), snapshot_ptrs,
         /*missing_ctx_input_prefix=*/closure.num_constant_args(),
@@ -963,10 +993,6 @@ void XlaRunOp::Compute(OpKernelContext* ctx) {
       },
       tsl::profiler::TraceMeLevel::kInfo);
 
-  absl::StatusOr<std::vector<VariableInfo>> variable_infos = GatherVariableInfo(
-      ctx, *closure.compilation_result(), closure.num_constant_args());
-  OP_REQUIRES_OK(ctx, variable_infos.status());
-  OP_REQUIRES_OK(ctx, LockVariables(absl::MakeSpan(*variable_infos)));
   OP_REQUIRES_OK(
       ctx,
       launch_context.PopulateOutputs(
@@ -18,7 +18,10 @@ limitations under the License.
 
 #include <atomic>
 
+#include "absl/types/span.h"
 #include "tensorflow/compiler/jit/device_compiler.h"
+#include "tensorflow/compiler/jit/variable_info.h"
+#include "tensorflow/compiler/jit/variable_info_util.h"
 #include "tensorflow/compiler/jit/xla_device.h"
 #include "tensorflow/compiler/jit/xla_launch_util.h"
 #include "tensorflow/compiler/jit/xla_platform_info.h"
@@ -32,6 +35,38 @@ limitations under the License.
 
 namespace tensorflow {
 
+// Fills `snapshot_ptrs` with pointers to the variable values in `snapshots`,
+// which were taken by XlaCompile. An updated variable that still holds its
+// snapshot has its own tensor put in `snapshot_ptrs` and its snapshot dropped,
+// so that the variable owns the buffer alone and the buffer can be donated to
+// the executable for the aliased resource update. `updated_variables` must be
+// locked until the outputs have been populated.
+template <typename SnapshotPtrs>
+void GetVariableSnapshotPtrs(absl::Span<const VariableInfo> updated_variables,
+                             int num_constant_args,
+                             ResourceVarsSnapshot& snapshots,
+                             SnapshotPtrs& snapshot_ptrs) {
+  for (const auto& [variable_index, variable_tensor] : snapshots) {
+    snapshot_ptrs.emplace(variable_index, variable_tensor.has_value()
+                                              ? &variable_tensor.value()
+                                              : nullptr);
+  }
+  for (const VariableInfo& variable : updated_variables) {
+    const int variable_index = variable.index() + num_constant_args;
+    auto it = snapshots.find(variable_index);
+    if (it == snapshots.end() || !it->second.has_value()) continue;
+    const Tensor* current = variable.var()->tensor();
+    if (current->dtype() != it->second->dtype() ||
+        current->shape() != it->second->shape() ||
+        !current->SharesBufferWith(*it->second)) {
+      continue;
+    }
+    VLOG(3) << "Variable " << variable.name()
+            << " is unchanged since XlaCompile; using its buffer directly";
+    it->second.reset();
+    snapshot_ptrs[variable_index] = current;
+  }
+}
 
 // XlaLocalLaunchBase is almost the same as XlaLocalLaunchOp.
 // The only difference is that it does not require arguments to follow
@@ -0,0 +1,186 @@
+/* Copyright 2023 The TensorFlow Authors. All Rights Reserved.
+
+Licensed under the Apache License, Version 2.0 (the "License");
+you may not use this file except in compliance with the License.
+You may obtain a copy of the License at
+
+    http://www.apache.org/licenses/LICENSE-2.0
+
+Unless required by applicable law or agreed to in writing, software
+distributed under the License is distributed on an "AS IS" BASIS,
+WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+See the License for the specific language governing permissions and
+limitations under the License.
+==============================================================================*/
+
+#include "tensorflow/compiler/jit/kernels/xla_ops.h"
+
+#include <map>
+#include <memory>
+#include <optional>
+#include <vector>
+
+#include <gtest/gtest.h>
+#include "absl/container/flat_hash_map.h"
+#include "absl/synchronization/notification.h"
+#include "absl/time/time.h"
+#include "absl/types/span.h"
+#include "tensorflow/compiler/jit/variable_info.h"
+#include "tensorflow/compiler/jit/variable_info_util.h"
+#include "tensorflow/core/framework/resource_var.h"
+#include "tensorflow/core/framework/tensor.h"
+#include "tensorflow/core/framework/tensor_testutil.h"
+#include "tensorflow/core/platform/env.h"
+#include "tensorflow/core/platform/mutex.h"
+#include "tensorflow/core/platform/refcount.h"
+#include "tsl/lib/core/status_test_util.h"
+
+namespace tensorflow {
+namespace {
+
+// Returns a new initialized variable holding `value`.
+Var* NewVariable(const Tensor& value) {
+  Var* var = new Var(value.dtype());
+  *var->tensor() = value;
+  var->is_initialized = true;
+  return var;
+}
+
+TEST(XlaOpsTest, UnchangedUpdatedVariableIsPassedDirectly) {
+  Var* var = NewVariable(test::AsTensor<float>({1, 2}));
+  std::vector<VariableInfo> variables;
+  variables.emplace_back(/*index=*/0, "v", var);
+  ResourceVarsSnapshot snapshots;
+  snapshots[1] = *var->tensor();
+
+  absl::flat_hash_map<int, const Tensor*> snapshot_ptrs;
+  GetVariableSnapshotPtrs(variables, /*num_constant_args=*/1, snapshots,
+                          snapshot_ptrs);
+
+  // The snapshot is dropped, so the variable owns its buffer alone and
+  // PopulateInputs donates it to the aliased resource update.
+  EXPECT_FALSE(snapshots[1].has_value());
+  EXPECT_EQ(snapshot_ptrs[1], var->tensor());
+  EXPECT_TRUE(snapshot_ptrs[1]->RefCountIsOne());
+}
+
+TEST(XlaOpsTest, ReassignedVariableKeepsItsSnapshot) {
+  Var* var = NewVariable(test::AsTensor<float>({1, 2}));
+  std::vector<VariableInfo> variables;
+  variables.emplace_back(/*index=*/0, "v", var);
+  ResourceVarsSnapshot snapshots;
+  snapshots[0] = *var->tensor();
+  // Assigned between XlaCompile and XlaRun.
+  *var->tensor() = test::AsTensor<float>({3, 4});
+
+  std::map<int, const Tensor*> snapshot_ptrs;
+  GetVariableSnapshotPtrs(variables, /*num_constant_args=*/0, snapshots,
+                          snapshot_ptrs);
+
+  ASSERT_TRUE(snapshots[0].has_value());
+  EXPECT_EQ(snapshot_ptrs[0], &snapshots[0].value());
+  test::ExpectTensorEqual<float>(*snapshot_ptrs[0],
+                                 test::AsTensor<float>({1, 2}));
+}
+
+TEST(XlaOpsTest, VariableWithNewShapeKeepsItsSnapshot) {
+  Var* var = NewVariable(test::AsTensor<float>({1, 2, 3, 4}));
+  std::vector<VariableInfo> variables;
+  variables.emplace_back(/*index=*/0, "v", var);
+  ResourceVarsSnapshot snapshots;
+  snapshots[0] = *var->tensor();
+  // Same buffer, other shape.
+  Tensor reshaped;
+  ASSERT_TRUE(reshaped.CopyFrom(*var->tensor(), TensorShape({2, 2})));
+  *var->tensor() = reshaped;
+
+  std::map<int, const Tensor*> snapshot_ptrs;
+  GetVariableSnapshotPtrs(variables, /*num_constant_args=*/0, snapshots,
+                          snapshot_ptrs);
+
+  ASSERT_TRUE(snapshots[0].has_value());
+  EXPECT_EQ(snapshot_ptrs[0], &snapshots[0].value());
+}
+
+TEST(XlaOpsTest, VariablesThatAreNotUpdatedKeepTheirSnapshots) {
+  Var* updated = NewVariable(test::AsTensor<float>({1, 2}));
+  Var* read_only = NewVariable(test::AsTensor<float>({3, 4}));
+  core::ScopedUnref read_only_ref(read_only);
+  std::vector<VariableInfo> variables;
+  variables.emplace_back(/*index=*/0, "updated", updated);
+  ResourceVarsSnapshot snapshots;
+  snapshots[0] = *updated->tensor();
+  snapshots[1] = *read_only->tensor();
+  snapshots[2] = std::nullopt;
+
+  std::map<int, const Tensor*> snapshot_ptrs;
+  GetVariableSnapshotPtrs(variables, /*num_constant_args=*/0, snapshots,
+                          snapshot_ptrs);
+
+  EXPECT_EQ(snapshot_ptrs[0], updated->tensor());
+  ASSERT_TRUE(snapshots[1].has_value());
+  EXPECT_EQ(snapshot_ptrs[1], &snapshots[1].value());
+  EXPECT_EQ(snapshot_ptrs[2], nullptr);
+}
+
+// A reader that took the value of the variable before XlaRun shares its
+// buffer, which is then not donated and keeps the old value.
+TEST(XlaOpsTest, BufferOfReadVariableIsNotDonated) {
+  Var* var = NewVariable(test::AsTensor<float>({1, 2}));
+  std::vector<VariableInfo> variables;
+  variables.emplace_back(/*index=*/0, "v", var);
+  ResourceVarsSnapshot snapshots;
+  snapshots[0] = *var->tensor();
+  const Tensor read = *var->tensor();
+
+  std::map<int, const Tensor*> snapshot_ptrs;
+  GetVariableSnapshotPtrs(variables, /*num_constant_args=*/0, snapshots,
+                          snapshot_ptrs);
+
+  EXPECT_EQ(snapshot_ptrs[0], var->tensor());
+  EXPECT_FALSE(snapshot_ptrs[0]->RefCountIsOne());
+  test::ExpectTensorEqual<float>(read, test::AsTensor<float>({1, 2}));
+}
+
+// A reader that runs concurrently with XlaRun blocks on the variable lock
+// until the outputs are populated, so it never reads the donated buffer
+// while the executable updates it.
+TEST(XlaOpsTest, ConcurrentReaderDoesNotSeeDonatedBuffer) {
+  Var* var = NewVariable(test::AsTensor<float>({1, 2}));
+  var->Ref();
+  core::ScopedUnref var_ref(var);
+  std::vector<VariableInfo> variables;
+  variables.emplace_back(/*index=*/0, "v", var);
+  ResourceVarsSnapshot snapshots;
+  snapshots[0] = *var->tensor();
+  TF_ASSERT_OK(LockVariables(absl::MakeSpan(variables)));
+
+  Tensor read;
+  absl::Notification read_done;
+  std::unique_ptr<Thread> reader(
+      Env::Default()->StartThread({}, "reader", [&]() {
+        tf_shared_lock lock(*var->mu());
+        read = *var->tensor();
+        read_done.Notify();
+      }));
+
+  std::map<int, const Tensor*> snapshot_ptrs;
+  GetVariableSnapshotPtrs(variables, /*num_constant_args=*/0, snapshots,
+                          snapshot_ptrs);
+  ASSERT_EQ(snapshot_ptrs[0], var->tensor());
+  EXPECT_TRUE(snapshot_ptrs[0]->RefCountIsOne());
+  EXPECT_FALSE(
+      read_done.WaitForNotificationWithTimeout(absl::Milliseconds(50)));
+
+  // PopulateOutputs assigns the updated value before the variables are
+  // unlocked.
+  *var->tensor() = test::AsTensor<float>({3, 4});
+  variables.clear();
+  reader.reset();
+
+  ASSERT_TRUE(read_done.HasBeenNotified());
+  test::ExpectTensorEqual<float>(read, test::AsTensor<float>({3, 4}));
+}
+
+}  // namespace
+}  // namespace tensorflow
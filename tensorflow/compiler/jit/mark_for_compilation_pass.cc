@@ -34,12 +34,14 @@ limitations under the License.
 #include "absl/container/flat_hash_map.h"
 #include "absl/container/flat_hash_set.h"
 #include "absl/strings/str_join.h"
+#include "tensorflow/compiler/jit/cluster_profitability.h"
 #include "tensorflow/compiler/jit/compilability_check_util.h"
 #include "tensorflow/compiler/jit/deadness_analysis.h"
 #include "tensorflow/compiler/jit/defs.h"
 #include "tensorflow/compiler/jit/device_util.h"
 #include "tensorflow/compiler/jit/flags.h"
 #include "tensorflow/compiler/jit/resource_operation_safety_analysis.h"
+#include "tensorflow/compiler/jit/shape_inference.h"
 #include "tensorflow/compiler/jit/xla_cluster_util.h"
 #include "tensorflow/compiler/tf2xla/const_analysis.h"
 #include "tensorflow/compiler/tf2xla/resource_operation_table.h"
@@ -112,6 +114,10 @@ class MarkForCompilationPassImpl {
     int max_cluster_size;
     int min_cluster_size;
 
+    // If true, do not compile auto-clusters that are estimated to be slower
+    // than the TensorFlow kernels they replace.
+    bool check_cluster_profitability;
+
     // Compiler fuel for the auto-clustering algorithm.
     //
     // We decrement this value by one on every time we choose a compilation
@@ -311,6 +317,12 @@ class MarkForCompilationPassImpl {
   // tf_xla_min_cluster_size, are applied here.
   Status CreateClusters();
 
+  // Returns the clusters that are compiled only because of auto-clustering
+  // but that the cost model estimates to be slower than the TF kernels that
+  // they replace.
+  absl::StatusOr<absl::flat_hash_set<const Cluster*>>
+  FindUnprofitableClusters();
+
   Status DumpDebugInfo();
 
   bool IsCompilationCandidate(Node* n) const {
@@ -333,6 +345,9 @@ class MarkForCompilationPassImpl {
 
   absl::StatusOr<bool> ShouldCompileCluster(const Cluster& cluster);
 
+  // Returns true if `cluster` is placed on a device that requires compilation.
+  absl::StatusOr<bool> RequiresCompilation(const Cluster& cluster);
+
   absl::StatusOr<bool> ClusteringWillIntroduceInterDeviceDependency(
       const Cluster& from, const Cluster& to);
 
@@ -970,6 +985,11 @@ Status MarkForCompilationPassImpl::CreateClusters() {
     DumpGraphToFile("before_mark_for_compilation", *graph_, flib_def_);
   }
 
+  absl::flat_hash_set<const Cluster*> unprofitable_clusters;
+  if (debug_options_.check_cluster_profitability) {
+    TF_ASSIGN_OR_RETURN(unprofitable_clusters, FindUnprofitableClusters());
+  }
+
   // Mark clusters for compilation that:
   // * are placed on a device that requires compilation (an XlaDevice),
   // * are explicitly marked for compilation (_XlaCompile=true), or
@@ -980,7 +1000,8 @@ Status MarkForCompilationPassImpl::CreateClusters() {
     Cluster* cluster = GetClusterForNode(n);
     TF_ASSIGN_OR_RETURN(bool should_compile_cluster,
                         ShouldCompileCluster(*cluster));
-    if (!should_compile_cluster || declustered_nodes_.contains(n)) {
+    if (!should_compile_cluster || declustered_nodes_.contains(n) ||
+        unprofitable_clusters.contains(cluster)) {
       continue;
     }
 
@@ -1016,6 +1037,43 @@ Status MarkForCompilationPassImpl::CreateClusters() {
   return absl::OkStatus();
 }
 
+absl::StatusOr<absl::flat_hash_set<const MarkForCompilationPassImpl::Cluster*>>
+MarkForCompilationPassImpl::FindUnprofitableClusters() {
+  absl::flat_hash_set<const Cluster*> unprofitable_clusters;
+  GraphShapeInfo shape_info;
+  Status status =
+      InferShapes(graph_, /*arg_shapes=*/{}, flib_def_, &shape_info);
+  if (!status.ok()) {
+    VLOG(2) << "Not checking the profitability of clusters: " << status;
+    return unprofitable_clusters;
+  }
+
+  absl::flat_hash_map<const Cluster*, std::vector<const Node*>> cluster_nodes;
+  for (Node* n : compilation_candidates_) {
+    if (!declustered_nodes_.contains(n)) {
+      cluster_nodes[GetClusterForNode(n)].push_back(n);
+    }
+  }
+
+  ClusterProfitabilityModel model(shape_info,
+                                  ClusterProfitabilityModel::Options());
+  for (const auto& [cluster, nodes] : cluster_nodes) {
+    if (cluster->is_xla_compile_attr_true() ||
+        cluster->has_functional_control_flow()) {
+      continue;
+    }
+    TF_ASSIGN_OR_RETURN(bool requires_compilation,
+                        RequiresCompilation(*cluster));
+    if (requires_compilation) continue;
+    if (model.EstimateBenefitUs(nodes) < 0) {
+      VLOG(2) << "Not compiling unprofitable cluster "
+              << cluster->DebugString(*graph_);
+      unprofitable_clusters.insert(cluster);
+    }
+  }
+  return unprofitable_clusters;
+}
+
 Status MarkForCompilationPassImpl::DumpDebugInfo() {
   TF_RET_CHECK(initialized_ && edges_contracted_ && clusters_created_);
 
@@ -1841,6 +1899,19 @@ proper command-line flag, not via TF_XLA_FLAGS).)";
   return should_compile;
 }
 
+absl::StatusOr<bool> MarkForCompilationPassImpl::RequiresCompilation(
+    const Cluster& cluster) {
+  TF_ASSIGN_OR_RETURN(DeviceId chosen_device,
+                      PickDeviceForXla(device_info_cache_, cluster.devices(),
+                                       /*allow_mixing_unknown_and_cpu=*/false));
+  const XlaOpRegistry::DeviceRegistration* registration =
+      device_info_cache_.GetCompilationDevice(chosen_device);
+  TF_RET_CHECK(registration)
+      << "chosen device = " << device_info_cache_.GetNameFor(chosen_device);
+  return registration->autoclustering_policy ==
+         XlaOpRegistry::AutoclusteringPolicy::kAlways;
+}
+
 absl::StatusOr<bool> MarkForCompilationPassImpl::ShouldCompileCluster(
     const Cluster& cluster) {
   auto it = should_compile_cluster_cache_.find(&cluster);
@@ -1922,6 +1993,8 @@ Status MarkForCompilationPass::Run(
       flags->tf_xla_deterministic_cluster_names;
   debug_options.max_cluster_size = flags->tf_xla_max_cluster_size;
   debug_options.min_cluster_size = flags->tf_xla_min_cluster_size;
+  debug_options.check_cluster_profitability =
+      flags->tf_xla_check_cluster_profitability;
   debug_options.fuel = GetPointerToFuel(flags->tf_xla_clustering_fuel);
   debug_options.dump_graphs = flags->tf_xla_clustering_debug;
 
@@ -1941,6 +2014,8 @@ Status MarkForCompilationPass::RunForTest(
   debug_options.deterministic_cluster_names = deterministic_cluster_names;
   debug_options.max_cluster_size = flags->tf_xla_max_cluster_size;
   debug_options.min_cluster_size = flags->tf_xla_min_cluster_size;
+  debug_options.check_cluster_profitability =
+      flags->tf_xla_check_cluster_profitability;
   debug_options.fuel = GetPointerToFuel(flags->tf_xla_clustering_fuel);
   debug_options.dump_graphs = flags->tf_xla_clustering_debug;
 
@@ -39,6 +39,7 @@ limitations under the License.
 #include "tensorflow/cc/ops/sendrecv_ops.h"
 #include "tensorflow/cc/ops/standard_ops.h"
 #include "tensorflow/compiler/jit/defs.h"
+#include "tensorflow/compiler/jit/flags.h"
 #include "tensorflow/compiler/jit/mark_for_compilation_pass_test_helper.h"
 #include "tensorflow/compiler/jit/node_matchers.h"
 #include "tensorflow/compiler/jit/xla_cluster_util.h"
@@ -51,6 +52,7 @@ limitations under the License.
 #include "tensorflow/core/graph/algorithm.h"
 #include "tensorflow/core/graph/graph_def_builder.h"
 #include "tensorflow/core/lib/core/status_test_util.h"
+#include "tensorflow/core/lib/gtl/cleanup.h"
 #include "tensorflow/core/platform/errors.h"
 #include "tensorflow/core/platform/test.h"
 
@@ -2000,5 +2002,38 @@ TEST(XlaCompilationTest, XLALiteAllowlist) {
          "be included in the XLALite allowlist or denylist:\n"
       << absl::StrJoin(unknow_op, "\n");
 }
+
+TEST(XlaCompilationTest, DontClusterUnprofitableOps) {
+  MarkForCompilationPassFlags* flags = GetMarkForCompilationPassFlags();
+  flags->tf_xla_check_cluster_profitability = true;
+  auto restore_flags = gtl::MakeCleanup(
+      [flags] { flags->tf_xla_check_cluster_profitability = false; });
+
+  Scope root = Scope::NewRootScope().ExitOnError();
+  Output a = ops::Placeholder(root.WithOpName("A"), DT_FLOAT,
+                              ops::Placeholder::Shape({1024, 1024}));
+  Output mul0 = ops::MatMul(root.WithOpName("mul0"), a, a);
+  Output mul1 = ops::MatMul(root.WithOpName("mul1"), mul0, mul0);
+  Output mul2 = ops::MatMul(root.WithOpName("mul2"), mul1, mul1);
+  ops::MatMul(root.WithOpName("mul3"), mul2, mul2);
+  Output b = ops::Placeholder(root.WithOpName("B"), DT_FLOAT,
+                              ops::Placeholder::Shape({1024, 1024}));
+  Output relu0 = ops::Relu(root.WithOpName("relu0"), b);
+  Output neg0 = ops::Neg(root.WithOpName("neg0"), relu0);
+  Output relu1 = ops::Relu(root.WithOpName("relu1"), neg0);
+  ops::Neg(root.WithOpName("neg1"), relu1);
+
+  std::unique_ptr<Graph> graph(new Graph(OpRegistry::Global()));
+  TF_ASSERT_OK(root.ToGraph(graph.get()));
+  TF_ASSERT_OK(MarkForCompilationPassTestHelper::MarkForCompilation(&graph));
+
+  // XLA doesn't fuse the matrix multiplications, so compiling them only adds
+  // the overhead of launching the cluster.
+  std::unordered_map<string, string> clusters = GetClusters(*graph);
+  EXPECT_EQ(clusters.size(), 4);
+  EXPECT_EQ(clusters.count("mul0"), 0);
+  EXPECT_FALSE(clusters["relu0"].empty());
+  EXPECT_EQ(clusters["relu0"], clusters["neg1"]);
+}
 }  // namespace
 }  // namespace tensorflow
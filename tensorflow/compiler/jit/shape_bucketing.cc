@@ -0,0 +1,116 @@
+/* Copyright 2024 The TensorFlow Authors. All Rights Reserved.
+
+Licensed under the Apache License, Version 2.0 (the "License");
+you may not use this file except in compliance with the License.
+You may obtain a copy of the License at
+
+    http://www.apache.org/licenses/LICENSE-2.0
+
+Unless required by applicable law or agreed to in writing, software
+distributed under the License is distributed on an "AS IS" BASIS,
+WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+See the License for the specific language governing permissions and
+limitations under the License.
+==============================================================================*/
+#include "tensorflow/compiler/jit/shape_bucketing.h"
+
+#include <cstdint>
+#include <string>
+#include <utility>
+#include <vector>
+
+#include "absl/status/status.h"
+#include "absl/status/statusor.h"
+#include "absl/strings/numbers.h"
+#include "absl/strings/str_cat.h"
+#include "absl/strings/str_join.h"
+#include "absl/strings/str_split.h"
+#include "absl/strings/string_view.h"
+#include "absl/types/variant.h"
+#include "tensorflow/core/framework/function.h"
+#include "tensorflow/core/framework/tensor.h"
+#include "tensorflow/core/framework/tensor_shape.h"
+
+namespace tensorflow {
+namespace {
+
+constexpr int64_t kDynamicDim = -1;
+
+}  // namespace
+
+ShapeBucketing::ShapeBucketing(std::vector<int64_t> bucket_sizes)
+    : bucket_sizes_(std::move(bucket_sizes)) {}
+
+absl::StatusOr<std::vector<int64_t>> ShapeBucketing::ParseBucketSizes(
+    absl::string_view bucket_sizes) {
+  std::vector<int64_t> result;
+  for (absl::string_view size_str :
+       absl::StrSplit(bucket_sizes, ',', absl::SkipWhitespace())) {
+    int64_t size;
+    if (!absl::SimpleAtoi(size_str, &size) || size <= 0 ||
+        (!result.empty() && size <= result.back())) {
+      return absl::InvalidArgumentError(
+          absl::StrCat("Invalid XLA shape bucket sizes \"", bucket_sizes,
+                       "\": expected increasing, positive integers."));
+    }
+    result.push_back(size);
+  }
+  return result;
+}
+
+int64_t ShapeBucketing::GetBucketSize(int64_t size) const {
+  if (bucket_sizes_.empty()) {
+    int64_t bucket_size = 1;
+    while (bucket_size < size) bucket_size *= 2;
+    return bucket_size;
+  }
+  for (int64_t bucket_size : bucket_sizes_) {
+    if (bucket_size >= size) return bucket_size;
+  }
+  return -1;
+}
+
+void ShapeBucketing::BucketArguments(const NameAttrList& function,
+                                     std::vector<XlaArgument>* args) {
+  const std::string name =
+      Canonicalize(function.name(), AttrSlice(&function.attr()));
+  mutex_lock lock(mu_);
+  std::vector<std::vector<int64_t>>& observed_dims = observed_dims_[name];
+  observed_dims.resize(args->size());
+  for (int i = 0; i < args->size(); ++i) {
+    XlaArgument& arg = (*args)[i];
+    if (arg.kind != XlaArgument::kParameter ||
+        !absl::holds_alternative<TensorShape>(arg.shape)) {
+      continue;
+    }
+    TensorShape& shape = absl::get<TensorShape>(arg.shape);
+    std::vector<int64_t>& dims = observed_dims[i];
+    if (dims.size() != shape.dims()) {
+      dims.assign(shape.dim_sizes().begin(), shape.dim_sizes().end());
+      continue;
+    }
+
+    Tensor dynamism(DT_BOOL, TensorShape({shape.dims()}));
+    bool any_dynamic = false;
+    for (int d = 0; d < shape.dims(); ++d) {
+      if (dims[d] != shape.dim_size(d)) dims[d] = kDynamicDim;
+      const int64_t bucket_size =
+          dims[d] == kDynamicDim ? GetBucketSize(shape.dim_size(d)) : -1;
+      dynamism.vec<bool>()(d) = bucket_size >= 0;
+      if (bucket_size >= 0) {
+        shape.set_dim(d, bucket_size);
+        any_dynamic = true;
+      }
+    }
+    if (any_dynamic) {
+      arg.value_dynamism = std::move(dynamism);
+    }
+  }
+}
+
+std::string ShapeBucketing::DebugString() const {
+  return absl::StrCat("ShapeBucketing {bucket_sizes=",
+                      absl::StrJoin(bucket_sizes_, ","), "}");
+}
+
+}  // namespace tensorflow
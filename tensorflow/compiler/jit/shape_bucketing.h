@@ -0,0 +1,78 @@
+/* Copyright 2024 The TensorFlow Authors. All Rights Reserved.
+
+Licensed under the Apache License, Version 2.0 (the "License");
+you may not use this file except in compliance with the License.
+You may obtain a copy of the License at
+
+    http://www.apache.org/licenses/LICENSE-2.0
+
+Unless required by applicable law or agreed to in writing, software
+distributed under the License is distributed on an "AS IS" BASIS,
+WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+See the License for the specific language governing permissions and
+limitations under the License.
+==============================================================================*/
+#ifndef TENSORFLOW_COMPILER_JIT_SHAPE_BUCKETING_H_
+#define TENSORFLOW_COMPILER_JIT_SHAPE_BUCKETING_H_
+
+#include <cstdint>
+#include <string>
+#include <vector>
+
+#include "absl/container/flat_hash_map.h"
+#include "absl/status/statusor.h"
+#include "absl/strings/string_view.h"
+#include "tensorflow/compiler/tf2xla/xla_argument.h"
+#include "tensorflow/core/framework/attr_value.pb.h"
+#include "tensorflow/core/framework/resource_base.h"
+#include "tensorflow/core/platform/mutex.h"
+#include "tensorflow/core/platform/thread_annotations.h"
+
+namespace tensorflow {
+
+// Bounds the number of times a cluster is compiled when the sizes of some
+// dimensions of its inputs vary between executions, e.g. the batch size or the
+// sequence length.
+//
+// A dimension of a parameter is considered dynamic once it has been observed
+// with two different sizes. From then on, it is padded up to the smallest
+// bucket size that holds it and is compiled as a bounded dynamic dimension.
+// XLA masks the padding in the computation and the outputs have their actual
+// sizes, so a cluster is compiled at most once per combination of buckets.
+class ShapeBucketing : public ResourceBase {
+ public:
+  // `bucket_sizes` must be increasing. If it is empty, dimensions are padded up
+  // to the next power of two.
+  explicit ShapeBucketing(std::vector<int64_t> bucket_sizes);
+
+  // Parses a comma-separated list of increasing, positive bucket sizes.
+  static absl::StatusOr<std::vector<int64_t>> ParseBucketSizes(
+      absl::string_view bucket_sizes);
+
+  // Returns the size of the smallest bucket that holds a dimension of size
+  // `size`, or -1 if `size` is larger than all the buckets.
+  int64_t GetBucketSize(int64_t size) const;
+
+  // Records the shapes of the parameters in `args`, which are the arguments of
+  // an execution of `function`, and pads the dimensions that have been
+  // observed to be dynamic. The padded dimensions are marked in the
+  // `value_dynamism` of the arguments.
+  void BucketArguments(const NameAttrList& function,
+                       std::vector<XlaArgument>* args);
+
+  std::string DebugString() const override;
+
+ private:
+  const std::vector<int64_t> bucket_sizes_;
+
+  mutex mu_;
+
+  // Maps cluster names to the dimension sizes of their parameters, indexed by
+  // argument number. Dynamic dimensions have size -1.
+  absl::flat_hash_map<std::string, std::vector<std::vector<int64_t>>>
+      observed_dims_ TF_GUARDED_BY(mu_);
+};
+
+}  // namespace tensorflow
+
+#endif  // TENSORFLOW_COMPILER_JIT_SHAPE_BUCKETING_H_
@@ -0,0 +1,136 @@
+/* Copyright 2024 The TensorFlow Authors. All Rights Reserved.
+
+Licensed under the Apache License, Version 2.0 (the "License");
+you may not use this file except in compliance with the License.
+You may obtain a copy of the License at
+
+    http://www.apache.org/licenses/LICENSE-2.0
+
+Unless required by applicable law or agreed to in writing, software
+distributed under the License is distributed on an "AS IS" BASIS,
+WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+See the License for the specific language governing permissions and
+limitations under the License.
+==============================================================================*/
+#include "tensorflow/compiler/jit/shape_bucketing.h"
+
+#include <cstdint>
+#include <vector>
+
+#include <gmock/gmock.h>
+#include <gtest/gtest.h>
+#include "absl/types/variant.h"
+#include "tensorflow/compiler/tf2xla/xla_argument.h"
+#include "tensorflow/core/framework/attr_value.pb.h"
+#include "tensorflow/core/framework/tensor.h"
+#include "tensorflow/core/framework/tensor_shape.h"
+#include "tensorflow/core/framework/tensor_testutil.h"
+#include "tensorflow/core/platform/refcount.h"
+#include "tsl/platform/statusor.h"
+
+namespace tensorflow {
+namespace {
+
+using ::testing::ElementsAre;
+
+XlaArgument MakeParameter(const TensorShape& shape) {
+  XlaArgument arg;
+  arg.kind = XlaArgument::kParameter;
+  arg.type = DT_FLOAT;
+  arg.shape = shape;
+  return arg;
+}
+
+TensorShape GetShape(const XlaArgument& arg) {
+  return absl::get<TensorShape>(arg.shape);
+}
+
+TEST(ShapeBucketingTest, ParseBucketSizes) {
+  TF_ASSERT_OK_AND_ASSIGN(std::vector<int64_t> bucket_sizes,
+                          ShapeBucketing::ParseBucketSizes("8, 32,128"));
+  EXPECT_THAT(bucket_sizes, ElementsAre(8, 32, 128));
+  TF_ASSERT_OK_AND_ASSIGN(bucket_sizes, ShapeBucketing::ParseBucketSizes(""));
+  EXPECT_TRUE(bucket_sizes.empty());
+
+  EXPECT_FALSE(ShapeBucketing::ParseBucketSizes("8,x").ok());
+  EXPECT_FALSE(ShapeBucketing::ParseBucketSizes("0,8").ok());
+  EXPECT_FALSE(ShapeBucketing::ParseBucketSizes("32,8").ok());
+}
+
+TEST(ShapeBucketingTest, GetBucketSize) {
+  ShapeBucketing* powers_of_two = new ShapeBucketing({});
+  core::ScopedUnref powers_of_two_ref(powers_of_two);
+  EXPECT_EQ(powers_of_two->GetBucketSize(1), 1);
+  EXPECT_EQ(powers_of_two->GetBucketSize(5), 8);
+  EXPECT_EQ(powers_of_two->GetBucketSize(64), 64);
+
+  ShapeBucketing* explicit_buckets = new ShapeBucketing({10, 100});
+  core::ScopedUnref explicit_buckets_ref(explicit_buckets);
+  EXPECT_EQ(explicit_buckets->GetBucketSize(3), 10);
+  EXPECT_EQ(explicit_buckets->GetBucketSize(10), 10);
+  EXPECT_EQ(explicit_buckets->GetBucketSize(11), 100);
+  EXPECT_EQ(explicit_buckets->GetBucketSize(101), -1);
+}
+
+TEST(ShapeBucketingTest, BucketsDimensionsObservedWithDifferentSizes) {
+  ShapeBucketing* bucketing = new ShapeBucketing({16, 64});
+  core::ScopedUnref bucketing_ref(bucketing);
+  NameAttrList function;
+  function.set_name("cluster_0");
+
+  // The first execution is compiled with its actual shapes.
+  std::vector<XlaArgument> args = {MakeParameter(TensorShape({5, 3})),
+                                   MakeParameter(TensorShape({7}))};
+  bucketing->BucketArguments(function, &args);
+  EXPECT_EQ(GetShape(args[0]), TensorShape({5, 3}));
+  EXPECT_FALSE(args[0].value_dynamism.has_value());
+  EXPECT_EQ(GetShape(args[1]), TensorShape({7}));
+
+  // The leading dimension of the first argument changes, so it is bucketed.
+  args = {MakeParameter(TensorShape({9, 3})), MakeParameter(TensorShape({7}))};
+  bucketing->BucketArguments(function, &args);
+  EXPECT_EQ(GetShape(args[0]), TensorShape({16, 3}));
+  ASSERT_TRUE(args[0].value_dynamism.has_value());
+  test::ExpectTensorEqual<bool>(*args[0].value_dynamism,
+                                test::AsTensor<bool>({true, false}));
+  EXPECT_EQ(GetShape(args[1]), TensorShape({7}));
+  EXPECT_FALSE(args[1].value_dynamism.has_value());
+
+  // From then on, the dimension stays bucketed, including for the size that
+  // was observed first.
+  args = {MakeParameter(TensorShape({5, 3})), MakeParameter(TensorShape({7}))};
+  bucketing->BucketArguments(function, &args);
+  EXPECT_EQ(GetShape(args[0]), TensorShape({16, 3}));
+
+  args = {MakeParameter(TensorShape({40, 3})),
+          MakeParameter(TensorShape({7}))};
+  bucketing->BucketArguments(function, &args);
+  EXPECT_EQ(GetShape(args[0]), TensorShape({64, 3}));
+
+  // Sizes larger than all the buckets keep their actual size.
+  args = {MakeParameter(TensorShape({100, 3})),
+          MakeParameter(TensorShape({7}))};
+  bucketing->BucketArguments(function, &args);
+  EXPECT_EQ(GetShape(args[0]), TensorShape({100, 3}));
+  EXPECT_FALSE(args[0].value_dynamism.has_value());
+}
+
+TEST(ShapeBucketingTest, DoesNotBucketConstants) {
+  ShapeBucketing* bucketing = new ShapeBucketing({});
+  core::ScopedUnref bucketing_ref(bucketing);
+  NameAttrList function;
+  function.set_name("cluster_0");
+
+  for (int size : {3, 5}) {
+    std::vector<XlaArgument> args(1);
+    args[0].kind = XlaArgument::kConstant;
+    args[0].type = DT_INT32;
+    args[0].constant_value = test::AsTensor<int32>({size});
+    args[0].shape = TensorShape({1});
+    bucketing->BucketArguments(function, &args);
+    EXPECT_FALSE(args[0].value_dynamism.has_value());
+  }
+}
+
+}  // namespace
+}  // namespace tensorflow
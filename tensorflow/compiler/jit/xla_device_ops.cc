@@ -66,6 +66,7 @@ void XlaAssignVariableOp::Compute(OpKernelContext* context) {
           DataTypeString(variable->tensor()->dtype()), " got ",
           DataTypeString(dtype_)));
   variable->is_initialized = true;
+  variable->MarkAllRowsDirty();
   *variable->tensor() = value;
 }
 
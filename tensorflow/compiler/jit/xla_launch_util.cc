@@ -16,6 +16,7 @@ limitations under the License.
 #include "tensorflow/compiler/jit/xla_launch_util.h"
 
 #include <cstdint>
+#include <cstring>
 #include <memory>
 #include <optional>
 #include <set>
@@ -146,6 +147,49 @@ static void PopulateExecutionInputBuffer(xla::ExecutionInput& execution_input,
   }
 }
 
+// Copies `tensor` to a new buffer for a parameter of shape `device_shape`,
+// which has bounded dynamic dimensions that hold the dimensions of `tensor`.
+// The buffer has the layout the XLA runtime reads dynamic parameters from: the
+// elements of `tensor`, padded up to the static size of `device_shape`, and
+// then the sizes of the dimensions as int32 values.
+static absl::StatusOr<se::OwningDeviceMemory> PadToDynamicShape(
+    OpKernelContext* ctx, const Tensor& tensor, const xla::Shape& device_shape,
+    int device_ordinal, se::DeviceMemoryAllocator* allocator) {
+  TF_RET_CHECK(device_shape.rank() == tensor.dims())
+      << xla::ShapeUtil::HumanString(device_shape) << " vs. "
+      << tensor.shape().DebugString();
+  std::vector<int32_t> dim_sizes(tensor.dims());
+  for (int i = 0; i < tensor.dims(); ++i) {
+    TF_RET_CHECK(tensor.dim_size(i) <= device_shape.dimensions(i));
+    dim_sizes[i] = tensor.dim_size(i);
+  }
+  const int64_t data_size = xla::ShapeUtil::ByteSizeOf(device_shape);
+  const int64_t metadata_size = dim_sizes.size() * sizeof(int32_t);
+  TF_ASSIGN_OR_RETURN(
+      se::OwningDeviceMemory buffer,
+      allocator->Allocate(device_ordinal, data_size + metadata_size));
+  se::DeviceMemoryBase data = buffer->GetByteSlice(0, tensor.TotalBytes());
+  se::DeviceMemoryBase metadata =
+      buffer->GetByteSlice(data_size, metadata_size);
+
+  se::Stream* stream =
+      ctx->op_device_context() ? ctx->op_device_context()->stream() : nullptr;
+  if (stream == nullptr) {
+    std::memcpy(data.opaque(), tensor.tensor_data().data(),
+                tensor.TotalBytes());
+    std::memcpy(metadata.opaque(), dim_sizes.data(), metadata_size);
+    return std::move(buffer);
+  }
+  TF_RETURN_IF_ERROR(stream->MemcpyD2D(
+      &data, XlaTensor::DeviceMemoryFromTensor(tensor), tensor.TotalBytes()));
+  TF_RETURN_IF_ERROR(
+      stream->Memcpy(&metadata, dim_sizes.data(), metadata_size));
+  // Keep the dimension sizes alive until they have been copied.
+  TF_RETURN_IF_ERROR(
+      stream->DoHostCallback([dim_sizes = std::move(dim_sizes)]() {}));
+  return std::move(buffer);
+}
+
 absl::StatusOr<std::vector<xla::ExecutionInput>>
 XlaComputationLaunchContext::PopulateInputs(
     OpKernelContext* ctx,
@@ -198,6 +242,15 @@ XlaComputationLaunchContext::PopulateInputs(
 
     arguments.emplace_back(device_shape, host_shape);
     xla::ExecutionInput& execution_input = arguments.back();
+    if (device_shape.IsArray() && device_shape.is_dynamic()) {
+      // The parameter has been bucketed (see ShapeBucketing), so its
+      // dimensions are padded up to their bounds.
+      TF_ASSIGN_OR_RETURN(se::OwningDeviceMemory padded,
+                          PadToDynamicShape(ctx, *t, device_shape,
+                                            device_ordinal_, xla_allocator_));
+      *execution_input.MutableBuffer(xla::ShapeIndex{}) = std::move(padded);
+      continue;
+    }
     se::DeviceMemoryBase dmem = XlaTensor::DeviceMemoryFromTensor(*t);
     PopulateExecutionInputBuffer(execution_input, xla::ShapeIndex{}, dmem,
                                  donate_buffer, device_ordinal_,
@@ -505,6 +558,7 @@ Status XlaComputationLaunchContext::PopulateOutputs(
                                    allocator, allocate_xla_tensors_, stream,
                                    use_multiple_streams_, definition_event));
     var->is_initialized |= write.modified;
+    if (write.modified) var->MarkAllRowsDirty();
     *var->tensor() = output_tensor;
     ++output_num;
   }
@@ -24,6 +24,7 @@ limitations under the License.
 
 #include "absl/algorithm/container.h"
 #include "absl/status/status.h"
+#include "absl/strings/str_cat.h"
 #include "absl/strings/str_split.h"
 #include "absl/strings/string_view.h"
 #include "tensorflow/compiler/jit/device_executable_persistor.h"
@@ -41,7 +42,9 @@ limitations under the License.
 #include "tensorflow/core/framework/resource_mgr.h"
 #include "tensorflow/core/framework/types.h"
 #include "tensorflow/core/platform/errors.h"
+#include "tensorflow/core/platform/fingerprint.h"
 #include "tensorflow/core/platform/status.h"
+#include "tensorflow/core/public/version.h"
 #include "tensorflow/core/tfrt/common/create_pjrt_client_util.h"
 #include "tensorflow/core/tfrt/common/global_state.h"
 #include "tensorflow/core/tfrt/common/pjrt_util.h"
@@ -59,9 +62,39 @@ using XlaDeviceExecutablePersistor =
 using PjRtDeviceExecutablePersistor =
     DeviceExecutablePersistor<xla::PjRtLoadedExecutable, xla::PjRtClient>;
 
+// Returns a fingerprint of the TensorFlow version and the description of the
+// target platform, so that executables are only shared between hosts running
+// the same compiler on the same hardware.
+uint64 GetCompilerFingerprint(absl::string_view platform_description) {
+  return Fingerprint64(
+      absl::StrCat(TF_VERSION_STRING, "/", platform_description));
+}
+
+// Sets up sharing the executables that target `compilation_device_type` with
+// other hosts, if requested by the flags.
+template <typename Config>
+void SetRemoteCacheOptions(const DeviceType& compilation_device_type,
+                           Config* persistor_config) {
+  persistor_config->remote_cache_directory =
+      GetRemoteCacheDirectory(compilation_device_type);
+  persistor_config->remote_cache_fetch_timeout_ms =
+      GetMarkForCompilationPassFlags()->tf_xla_remote_cache_fetch_timeout_ms;
+}
+
 XlaDeviceCompiler* CreateXlaDeviceCompiler(
-    const XlaDeviceExecutablePersistor::Config& persistor_config,
+    XlaDeviceExecutablePersistor::Config persistor_config,
     DeviceType compilation_device_type, xla::LocalClient* local_client) {
+  std::string platform_description;
+  if (local_client != nullptr) {
+    platform_description = absl::StrCat(
+        local_client->platform()->Name(), "/",
+        local_client->backend()
+            .default_stream_executor()
+            ->GetDeviceDescription()
+            .model_str());
+  }
+  persistor_config.compiler_fingerprint =
+      GetCompilerFingerprint(platform_description);
   return new XlaDeviceCompiler(
       std::make_unique<XlaDeviceExecutablePersistor>(
           std::move(persistor_config), compilation_device_type),
@@ -78,6 +111,12 @@ PjRtDeviceCompiler* CreatePjRtDeviceCompiler(DeviceType compilation_device_type,
       GetMarkForCompilationPassFlags()->tf_xla_disable_strict_signature_checks,
       GetMarkForCompilationPassFlags()->tf_xla_persistent_cache_prefix,
       GetMarkForCompilationPassFlags()->tf_xla_persistent_cache_read_only);
+  SetRemoteCacheOptions(compilation_device_type, &persistor_config);
+  if (pjrt_client != nullptr) {
+    persistor_config.compiler_fingerprint =
+        GetCompilerFingerprint(absl::StrCat(pjrt_client->platform_name(), "/",
+                                            pjrt_client->platform_version()));
+  }
 
   return new PjRtDeviceCompiler(
       std::make_unique<PjRtDeviceExecutablePersistor>(
@@ -151,25 +190,37 @@ Status GetCompilationDeviceTypeAndPjRtClient(
 
   return absl::OkStatus();
 }
+
+// Returns true if the flags allow persisting the executables that target
+// `compilation_device_type`.
+bool IsPersistentCacheDeviceType(const DeviceType& compilation_device_type) {
+  // If a persistent cache device type is specified, ensure it matches
+  // compilation device type.
+  const std::string& device_types =
+      GetMarkForCompilationPassFlags()->tf_xla_persistent_cache_device_types;
+  return device_types.empty() ||
+         absl::c_any_of(absl::StrSplit(device_types, ','),
+                        [&](absl::string_view device) {
+                          return compilation_device_type == DeviceType(device);
+                        });
+}
 }  // namespace
 
 std::string GetPersistentCacheDirectory(
     const DeviceType& compilation_device_type) {
-  // If a persistent cache device type is specified, ensure it matches
-  // compilation device type.
-  if (!GetMarkForCompilationPassFlags()
-           ->tf_xla_persistent_cache_device_types.empty() &&
-      !absl::c_any_of(absl::StrSplit(GetMarkForCompilationPassFlags()
-                                         ->tf_xla_persistent_cache_device_types,
-                                     ','),
-                      [&](absl::string_view device) {
-                        return compilation_device_type == DeviceType(device);
-                      })) {
+  if (!IsPersistentCacheDeviceType(compilation_device_type)) {
     return "";
   }
   return GetMarkForCompilationPassFlags()->tf_xla_persistent_cache_directory;
 }
 
+std::string GetRemoteCacheDirectory(const DeviceType& compilation_device_type) {
+  if (!IsPersistentCacheDeviceType(compilation_device_type)) {
+    return "";
+  }
+  return GetMarkForCompilationPassFlags()->tf_xla_remote_cache_directory;
+}
+
 absl::StatusOr<std::optional<std::set<int>>> ParseVisibleDeviceList(
     absl::string_view visible_device_list) {
   std::set<int> gpu_ids;
@@ -225,6 +276,7 @@ Status BuildXlaDeviceCompiler(DeviceBase* device, FunctionLibraryRuntime* flr,
       GetMarkForCompilationPassFlags()->tf_xla_disable_strict_signature_checks,
       GetMarkForCompilationPassFlags()->tf_xla_persistent_cache_prefix,
       GetMarkForCompilationPassFlags()->tf_xla_persistent_cache_read_only);
+  SetRemoteCacheOptions(platform_info.device_type(), &persistor_config);
 
   if (platform_info.xla_device_metadata()) {
     *xla_device_compiler = CreateXlaDeviceCompiler(
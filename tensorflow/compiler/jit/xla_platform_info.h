@@ -156,6 +156,11 @@ XlaPlatformInfo XlaPlatformInfoFromDevice(DeviceBase* device);
 std::string GetPersistentCacheDirectory(
     const DeviceType& compilation_device_type);
 
+// Obtains the directory through which executables that target a given device
+// are shared with other hosts based off xla flags. If you shouldn't share
+// executables, returns "".
+std::string GetRemoteCacheDirectory(const DeviceType& compilation_device_type);
+
 // Returns allocator from platform info if non-null, or populate and return a
 // pointer to the allocator adapter with allocator from context.
 //
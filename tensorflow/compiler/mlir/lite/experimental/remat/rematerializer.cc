@@ -354,13 +354,17 @@ void Rematerializer::Remat(const RematSpec& remat) {
 
 void Rematerializer::RunGreedyAlgorithm(const int max_cost,
                                         const int max_block_length,
-                                        const SizeT min_savings) {
+                                        const SizeT min_savings,
+                                        const SizeT max_peak_memory) {
   const bool unlimited_cost = (max_cost < 0);
+  const auto fits = [&]() {
+    return max_peak_memory >= 0 && GetPeakMemory().size <= max_peak_memory;
+  };
   for (int min_block_length = 1, cost = 0;
        min_block_length <= max_block_length &&
-       (unlimited_cost || cost <= max_cost);
+       (unlimited_cost || cost <= max_cost) && !fits();
        min_block_length *= 2) {
-    while (unlimited_cost || cost <= max_cost) {
+    while ((unlimited_cost || cost <= max_cost) && !fits()) {
       const auto [peak, remat] = FindBestRemat(
           /*min_savings*/ min_savings,
           /*begin_len=*/min_block_length,
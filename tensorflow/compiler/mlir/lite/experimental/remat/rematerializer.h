@@ -101,8 +101,11 @@ class Rematerializer {
   // operations will be re-inserted. For each rematerialization found,
   // ApplyRemat is invoked (which can be used to apply the rematerialization to
   // the higher- level representation, e.g., MLIR, flatbuffer, ...)
+  // If max_peak_memory >= 0, the algorithm stops as soon as the peak memory
+  // is at most max_peak_memory, so as to re-insert no more operations than
+  // needed to fit a memory budget.
   void RunGreedyAlgorithm(int max_cost, int max_block_length,
-                          SizeT min_savings);
+                          SizeT min_savings, SizeT max_peak_memory = -1);
 
   virtual void ApplyRemat(const RematSpec& remat) {}
 
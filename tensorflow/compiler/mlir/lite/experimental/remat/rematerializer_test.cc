@@ -460,6 +460,18 @@ TEST_F(GreedyRematTest, SimpleCostThreshold) {
               ElementsAreArray({1, 3, 7, 15, 23, 23, 15, 15, 7, 3, 1}));
 }
 
+TEST_F(GreedyRematTest, SimpleMemoryCap) {
+  RainbowRemat remat({{1, 2, 4, 8, 16}});
+  ASSERT_THAT(remat.GetMemProfile(),
+              ElementsAreArray({1, 3, 7, 15, 31, 31, 15, 7, 3, 1}));
+  // Stop as soon as the peak is at most 23 -- a single remat lowering the
+  // profile by 8 does.
+  remat.RunGreedyAlgorithm(/*max_cost=*/-1, /*max_block_length=*/1,
+                           /*min_savings=*/1, /*max_peak_memory=*/23);
+  EXPECT_THAT(remat.GetMemProfile(),
+              ElementsAreArray({1, 3, 7, 15, 23, 23, 15, 15, 7, 3, 1}));
+}
+
 TEST_F(GreedyRematTest, SimpleForbiddenOps) {
   // Operator generating size-4 tensor is stateful, so it won't be materialized.
   RainbowRemat remat({{1, 2, -4, 8, 16}});
@@ -20,7 +20,6 @@ limitations under the License.
 #include <utility>
 #include <vector>
 
-#include "tensorflow/compiler/tf2xla/const_analysis.h"
 #include "tensorflow/compiler/tf2xla/literal_util.h"
 #include "tensorflow/compiler/tf2xla/shape_util.h"
 #include "tensorflow/compiler/tf2xla/side_effect_util.h"
@@ -62,16 +61,17 @@ auto* graph_compiler_failed_compilation_op_count =
         /*metric_label=*/"op_name");
 
 namespace {
-Status PrepareArguments(XlaOpKernelContext* ctx, Graph* graph,
+Status PrepareArguments(XlaOpKernelContext* ctx,
                         const std::vector<const XlaExpression*>& expressions,
                         const NameAttrList& func,
                         std::vector<XlaCompiler::Argument>* args) {
   auto client = ctx->compiler()->client();
-  std::vector<bool> arg_must_be_compile_time_constant(expressions.size());
-
-  TF_RETURN_IF_ERROR(BackwardsConstAnalysis(
-      *graph, &arg_must_be_compile_time_constant,
-      /*compile_time_const_nodes=*/nullptr, ctx->function_library()));
+  const std::vector<bool>* must_be_constant;
+  TF_RETURN_IF_ERROR(
+      ctx->compiler()->FindCompileTimeConstantArgs(func, &must_be_constant));
+  TF_RET_CHECK(must_be_constant->size() == expressions.size());
+  const std::vector<bool>& arg_must_be_compile_time_constant =
+      *must_be_constant;
 
   args->resize(expressions.size());
   for (int i = 0, end = args->size(); i < end; ++i) {
@@ -260,13 +260,8 @@ Status GraphCompiler::CompileFunctionalNode(Node* n,
 
   // Prepare the arguments and compile the function.
   std::vector<XlaCompiler::Argument> arguments;
-  const FunctionBody* fbody;
-  TF_RETURN_IF_ERROR(compiler->FindFunctionBody(func, &fbody));
-
-  auto graph = compiler->GetGraph(fbody);
-
-  TF_RETURN_IF_ERROR(PrepareArguments(&xla_op_context, graph.get(), expressions,
-                                      func, &arguments));
+  TF_RETURN_IF_ERROR(
+      PrepareArguments(&xla_op_context, expressions, func, &arguments));
 
   bool add_token_input_output =
       func.attr().find(kXlaTokenInputNodesAttrName) != func.attr().end();
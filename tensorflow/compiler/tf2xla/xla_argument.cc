@@ -49,6 +49,11 @@ bool XlaArgument::operator==(const XlaArgument& other) const {
   if (is_same_data_across_replicas != other.is_same_data_across_replicas) {
     return false;
   }
+  if (value_dynamism.has_value() != other.value_dynamism.has_value() ||
+      (value_dynamism.has_value() &&
+       value_dynamism->tensor_data() != other.value_dynamism->tensor_data())) {
+    return false;
+  }
   return constant_value.tensor_data() == other.constant_value.tensor_data();
 }
 
@@ -32,6 +32,7 @@ limitations under the License.
 #include "absl/container/flat_hash_map.h"
 #include "absl/memory/memory.h"
 #include "absl/status/status.h"
+#include "absl/strings/str_cat.h"
 #include "absl/strings/string_view.h"
 #include "absl/types/variant.h"
 #include "tensorflow/compiler/jit/defs.h"
@@ -40,6 +41,7 @@ limitations under the License.
 #include "tensorflow/compiler/jit/xla_compile_util.h"
 #include "tensorflow/compiler/mlir/tf2xla/api/v1/compile_mlir_util.h"
 #include "tensorflow/compiler/mlir/utils/array_container_utils.h"
+#include "tensorflow/compiler/tf2xla/const_analysis.h"
 #include "tensorflow/compiler/tf2xla/graph_compiler.h"
 #include "tensorflow/compiler/tf2xla/layout_util.h"
 #include "tensorflow/compiler/tf2xla/rearrange_function_argument.h"
@@ -561,9 +563,41 @@ int64_t XlaCompiler::NextStepId() { return next_step_id_++; }
 
 uint64 XlaCompiler::SignatureHash::operator()(
     const std::pair<string, std::vector<Argument>>& signature) const {
-  return std::hash<string>()(signature.first);
+  // Hashes the parts of the arguments that usually tell apart the calls of a
+  // function, so that a function called with many shapes does not fill a
+  // single bucket.
+  uint64 hash = std::hash<string>()(signature.first);
+  for (const Argument& arg : signature.second) {
+    hash = Hash64Combine(hash, arg.kind);
+    hash = Hash64Combine(hash, arg.type);
+    if (absl::holds_alternative<xla::Shape>(arg.shape)) {
+      const xla::Shape& shape = std::get<xla::Shape>(arg.shape);
+      if (!shape.IsArray()) continue;
+      for (int64_t dim : shape.dimensions()) {
+        hash = Hash64Combine(hash, dim);
+      }
+    } else {
+      for (int64_t dim : std::get<TensorShape>(arg.shape).dim_sizes()) {
+        hash = Hash64Combine(hash, dim);
+      }
+    }
+  }
+  return hash;
 }
 
+namespace {
+
+// Returns a string that tells apart the compile options that change the
+// computation built by CompileFunction.
+string CompileOptionsSignature(const XlaCompiler::CompileOptions& options) {
+  return absl::StrCat(
+      options.use_tuple_arg, options.return_updated_values_for_all_resources,
+      options.always_return_tuple, options.is_entry_computation,
+      options.add_token_input_output, options.alias_resource_update);
+}
+
+}  // namespace
+
 static Status GetFunctionBody(const NameAttrList& function,
                               FunctionLibraryRuntime* flib_runtime,
                               const FunctionBody** fbody) {
@@ -782,9 +816,14 @@ Status XlaCompiler::CompileFunction(
       Canonicalize(fn_name_attrs.name(), AttrSlice(&fn_name_attrs.attr()));
   VLOG(1) << "XlaCompiler::CompileFunction " << function_id;
 
+  // The same function may be compiled with different options, e.g. as the
+  // body of a While and through a call, so the options are part of the key.
+  const string cache_key =
+      absl::StrCat(function_id, ";", CompileOptionsSignature(options));
   const std::vector<XlaCompiler::Argument> arg_vector(args.begin(), args.end());
-  auto it = cache_.find({function_id, arg_vector});
+  auto it = cache_.find({cache_key, arg_vector});
   if (it != cache_.end()) {
+    VLOG(1) << "Reusing the computation of " << function_id;
     *result = it->second;
     return absl::OkStatus();
   }
@@ -908,7 +947,28 @@ Status XlaCompiler::CompileFunction(
       tensorflow::metrics::Phase2XlaCompilerMetric::
           kCompileFunctionXlaBuilderSuccess);
   VLOG(1) << "====================================================";
-  cache_[{function_id, arg_vector}] = *result;
+  cache_[{cache_key, arg_vector}] = *result;
+  return absl::OkStatus();
+}
+
+Status XlaCompiler::FindCompileTimeConstantArgs(
+    const NameAttrList& function, const std::vector<bool>** must_be_constant) {
+  const string function_id =
+      Canonicalize(function.name(), AttrSlice(&function.attr()));
+  auto it = compile_time_constant_args_.find(function_id);
+  if (it == compile_time_constant_args_.end()) {
+    const FunctionBody* fbody;
+    TF_RETURN_IF_ERROR(FindFunctionBody(function, &fbody));
+    std::unique_ptr<Graph> graph = GetGraph(fbody);
+    std::vector<bool> args_must_be_constant(fbody->arg_types.size());
+    TF_RETURN_IF_ERROR(BackwardsConstAnalysis(
+        *graph, &args_must_be_constant,
+        /*compile_time_const_nodes=*/nullptr, flib_runtime_));
+    it = compile_time_constant_args_
+             .emplace(function_id, std::move(args_must_be_constant))
+             .first;
+  }
+  *must_be_constant = &it->second;
   return absl::OkStatus();
 }
 
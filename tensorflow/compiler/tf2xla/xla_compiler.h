@@ -317,6 +317,13 @@ class XlaCompiler {
                           const FunctionBody** fbody,
                           const ConfigProto** config_proto = nullptr);
 
+  // Sets `*must_be_constant` to whether each argument of `function` must be a
+  // compile-time constant. The analysis of the function body is memoized, so
+  // that repeated calls of a function do not optimize and analyze its body
+  // again.
+  Status FindCompileTimeConstantArgs(
+      const NameAttrList& function, const std::vector<bool>** must_be_constant);
+
  private:
   // Returns the optimized graph object in this function body.
   std::unique_ptr<Graph> GetGraph(const FunctionBody* fbody);
@@ -367,10 +374,15 @@ class XlaCompiler {
         const std::pair<string, std::vector<Argument>>& signature) const;
   };
 
+  // Compilation results of CompileFunction, keyed by the function, the compile
+  // options and the arguments.
   std::unordered_map<std::pair<string, std::vector<Argument>>,
                      CompilationResult, SignatureHash>
       cache_;
 
+  // Results of FindCompileTimeConstantArgs, keyed by the function.
+  std::unordered_map<string, std::vector<bool>> compile_time_constant_args_;
+
   std::unordered_map<string, xla::ChannelHandle> channels_;
 
   std::unordered_map<string, tf2xla::HostTransferMetadata> host_compute_sends_;
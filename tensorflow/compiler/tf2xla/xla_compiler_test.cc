@@ -1081,6 +1081,45 @@ TEST_F(XlaCompilerTest, LocalFunctionWithWrongArgumentsFail) {
       << status.message();
 }
 
+// Tests that CompileFunction does not reuse a computation built with different
+// compile options.
+TEST_F(XlaCompilerTest, FunctionCacheDistinguishesCompileOptions) {
+  XlaCompiler compiler(DefaultOptions());
+  TF_ASSERT_OK(flib_def_->AddFunctionDef(test::function::XTimesTwo()));
+
+  NameAttrList name_attr;
+  name_attr.set_name("XTimesTwo");
+  (*name_attr.mutable_attr())["T"].set_type(DT_FLOAT);
+
+  std::vector<XlaCompiler::Argument> args(1);
+  args[0].kind = XlaCompiler::Argument::kParameter;
+  args[0].type = DT_FLOAT;
+  args[0].shape = TensorShape({2});
+
+  XlaCompiler::CompileOptions options;
+  options.is_entry_computation = false;
+  XlaCompiler::CompilationResult result;
+  TF_ASSERT_OK(compiler.CompileFunction(options, name_attr, args, &result));
+  xla::ProgramShape program_shape =
+      result.computation->GetProgramShape().value();
+  ASSERT_EQ(1, program_shape.parameters_size());
+  EXPECT_FALSE(program_shape.parameters(0).IsTuple());
+
+  // A cache hit returns the same computation.
+  XlaCompiler::CompilationResult cached_result;
+  TF_ASSERT_OK(
+      compiler.CompileFunction(options, name_attr, args, &cached_result));
+  EXPECT_EQ(result.computation.get(), cached_result.computation.get());
+
+  options.use_tuple_arg = true;
+  XlaCompiler::CompilationResult tuple_result;
+  TF_ASSERT_OK(
+      compiler.CompileFunction(options, name_attr, args, &tuple_result));
+  program_shape = tuple_result.computation->GetProgramShape().value();
+  ASSERT_EQ(1, program_shape.parameters_size());
+  EXPECT_TRUE(program_shape.parameters(0).IsTuple());
+}
+
 FunctionDef SliceFn() {
   return FunctionDefHelper::Define(
       // Name
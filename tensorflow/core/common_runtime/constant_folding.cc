@@ -39,10 +39,13 @@ limitations under the License.
 #include "tensorflow/core/lib/core/threadpool.h"
 #include "tensorflow/core/lib/gtl/cleanup.h"
 #include "tensorflow/core/lib/gtl/flatset.h"
+#include "tensorflow/core/lib/strings/proto_serialization.h"
 #include "tensorflow/core/lib/strings/strcat.h"
 #include "tensorflow/core/platform/denormal.h"
+#include "tensorflow/core/platform/fingerprint.h"
 #include "tensorflow/core/platform/setround.h"
 #include "tensorflow/core/public/session_options.h"
+#include "tensorflow/core/util/env_var.h"
 
 namespace tensorflow {
 
@@ -613,8 +616,114 @@ bool ReplaceTensorWithConstant(
   return true;
 }
 
+uint64 FingerprintAttrValue(const AttrValue& attr_value) {
+  // Large constants are hashed directly from their contents, to avoid
+  // serializing them.
+  if (attr_value.has_tensor() &&
+      !attr_value.tensor().tensor_content().empty()) {
+    const TensorProto& proto = attr_value.tensor();
+    uint64 h = Fingerprint64(proto.tensor_shape().SerializeAsString());
+    h = FingerprintCat64(h, proto.dtype());
+    return FingerprintCat64(h, Fingerprint64(proto.tensor_content()));
+  }
+  string serialized;
+  SerializeToStringDeterministic(attr_value, &serialized);
+  return Fingerprint64(serialized);
+}
+
+// Computes the key under which the result of fetching `fetch_names` from
+// `constant_graph` is cached. Returns false if the result must not be cached.
+bool GetConstantGraphFingerprint(const Graph& constant_graph,
+                                 const std::vector<string>& fetch_names,
+                                 uint64* fingerprint) {
+  std::vector<const Node*> nodes;
+  nodes.reserve(constant_graph.num_op_nodes());
+  for (const Node* n : constant_graph.op_nodes()) {
+    // The result of calling a function depends on the function library, which
+    // is not part of the key.
+    if (n->IsFunctionCall() ||
+        constant_graph.flib_def().Find(n->type_string()) != nullptr) {
+      return false;
+    }
+    nodes.push_back(n);
+  }
+  std::sort(nodes.begin(), nodes.end(), [](const Node* a, const Node* b) {
+    return a->name() < b->name();
+  });
+
+  uint64 h = Fingerprint64("ConstantFoldingCache");
+  for (const Node* n : nodes) {
+    const NodeDef& def = n->def();
+    h = FingerprintCat64(h, Fingerprint64(def.name()));
+    h = FingerprintCat64(h, Fingerprint64(def.op()));
+    h = FingerprintCat64(h, Fingerprint64(def.device()));
+    for (const string& input : def.input()) {
+      h = FingerprintCat64(h, Fingerprint64(input));
+    }
+    std::vector<std::pair<string, const AttrValue*>> attrs;
+    attrs.reserve(def.attr_size());
+    for (const auto& attr : def.attr()) {
+      if (attr.second.has_func() || attr.second.list().func_size() > 0) {
+        return false;
+      }
+      attrs.emplace_back(attr.first, &attr.second);
+    }
+    std::sort(attrs.begin(), attrs.end());
+    for (const auto& attr : attrs) {
+      h = FingerprintCat64(h, Fingerprint64(attr.first));
+      h = FingerprintCat64(h, FingerprintAttrValue(*attr.second));
+    }
+  }
+  for (const string& name : fetch_names) {
+    h = FingerprintCat64(h, Fingerprint64(name));
+  }
+  *fingerprint = h;
+  return true;
+}
+
 }  // namespace
 
+ConstantFoldingCache* ConstantFoldingCache::Global() {
+  static ConstantFoldingCache* cache = []() -> ConstantFoldingCache* {
+    int64_t capacity_in_bytes;
+    TF_CHECK_OK(ReadInt64FromEnvVar("TF_CONSTANT_FOLDING_CACHE_BYTES",
+                                    /*default_val=*/0, &capacity_in_bytes));
+    if (capacity_in_bytes <= 0) return nullptr;
+    return new ConstantFoldingCache(capacity_in_bytes);
+  }();
+  return cache;
+}
+
+bool ConstantFoldingCache::Lookup(uint64 key, std::vector<Tensor>* tensors) {
+  mutex_lock l(mu_);
+  auto it = index_.find(key);
+  if (it == index_.end()) return false;
+  entries_.splice(entries_.begin(), entries_, it->second);
+  *tensors = it->second->tensors;
+  return true;
+}
+
+void ConstantFoldingCache::Insert(uint64 key,
+                                  const std::vector<Tensor>& tensors) {
+  int64_t size_in_bytes = 0;
+  for (const Tensor& t : tensors) {
+    size_in_bytes += t.TotalBytes();
+  }
+  if (size_in_bytes > capacity_in_bytes_) return;
+
+  mutex_lock l(mu_);
+  if (index_.contains(key)) return;
+  while (size_in_bytes_ + size_in_bytes > capacity_in_bytes_) {
+    const Entry& lru = entries_.back();
+    size_in_bytes_ -= lru.size_in_bytes;
+    index_.erase(lru.key);
+    entries_.pop_back();
+  }
+  entries_.push_front({key, tensors, size_in_bytes});
+  index_[key] = entries_.begin();
+  size_in_bytes_ += size_in_bytes;
+}
+
 Status ConstantFold(const ConstantFoldingOptions& opts,
                     FunctionLibraryRuntime* function_library, Env* env,
                     const Device* partition_device, Graph* graph,
@@ -689,13 +798,25 @@ Status ConstantFold(const ConstantFoldingOptions& opts,
     graph_runner.reset(nullptr);
   });
 
-  Status s =
-      graph_runner->Run(constant_graph.get(), function_library, {} /* inputs*/,
-                        tensors_to_fetch_names, &outputs);
-  if (!s.ok()) {
-    VLOG(1) << "Could not fetch constants: " << s;
-    *was_mutated = false;
-    return s;
+  uint64 cache_key = 0;
+  const bool use_cache =
+      opts.cache != nullptr &&
+      GetConstantGraphFingerprint(*constant_graph, tensors_to_fetch_names,
+                                  &cache_key);
+  if (use_cache && opts.cache->Lookup(cache_key, &outputs)) {
+    VLOG(1) << "Found " << outputs.size() << " folded constants in the cache";
+  } else {
+    Status s = graph_runner->Run(constant_graph.get(), function_library,
+                                 {} /* inputs*/, tensors_to_fetch_names,
+                                 &outputs);
+    if (!s.ok()) {
+      VLOG(1) << "Could not fetch constants: " << s;
+      *was_mutated = false;
+      return s;
+    }
+    // `GraphRunner` copies its outputs, so they do not refer to memory owned
+    // by the runner and may be shared with later calls.
+    if (use_cache) opts.cache->Insert(cache_key, outputs);
   }
 
   // Fetch the constant tensors and replace the corresponding tensors in the
@@ -16,11 +16,17 @@ limitations under the License.
 #ifndef TENSORFLOW_CORE_COMMON_RUNTIME_CONSTANT_FOLDING_H_
 #define TENSORFLOW_CORE_COMMON_RUNTIME_CONSTANT_FOLDING_H_
 
+#include <list>
+#include <vector>
+
+#include "absl/container/flat_hash_map.h"
 #include "tensorflow/core/common_runtime/device.h"
 #include "tensorflow/core/framework/function.h"
 #include "tensorflow/core/framework/tensor.h"
 #include "tensorflow/core/graph/graph.h"
 #include "tensorflow/core/platform/env.h"
+#include "tensorflow/core/platform/mutex.h"
+#include "tensorflow/core/platform/thread_annotations.h"
 
 // TODO(skyewm): can this be combined with EvaluateConstantTensor?
 
@@ -31,6 +37,53 @@ namespace tensorflow {
 using ConstantFoldNameGenerator =
     std::function<string(Graph* graph, string old_name)>;
 
+// A cache of the tensors computed by `ConstantFold()`, keyed by a fingerprint
+// of the constant subgraph that was evaluated and the tensors fetched from it.
+// This allows sessions that load the same model to share the results of
+// folding, instead of each evaluating the same subgraph.
+//
+// The cache is bounded by the total size of the cached tensors, and evicts
+// the least recently used entries first. It is thread-safe.
+class ConstantFoldingCache {
+ public:
+  explicit ConstantFoldingCache(int64_t capacity_in_bytes)
+      : capacity_in_bytes_(capacity_in_bytes) {}
+
+  // Returns the process-wide cache, or nullptr if it is disabled. The cache is
+  // enabled by setting the `TF_CONSTANT_FOLDING_CACHE_BYTES` environment
+  // variable to its capacity.
+  static ConstantFoldingCache* Global();
+
+  // If an entry for `key` exists, copies its tensors into `*tensors` and
+  // returns true.
+  bool Lookup(uint64 key, std::vector<Tensor>* tensors);
+
+  // Adds an entry for `key`, unless the total size of `tensors` exceeds the
+  // capacity of the cache.
+  void Insert(uint64 key, const std::vector<Tensor>& tensors);
+
+  int64_t size_in_bytes() const {
+    mutex_lock l(mu_);
+    return size_in_bytes_;
+  }
+
+ private:
+  struct Entry {
+    uint64 key;
+    std::vector<Tensor> tensors;
+    int64_t size_in_bytes;
+  };
+
+  const int64_t capacity_in_bytes_;
+
+  mutable mutex mu_;
+  // Ordered from the most to the least recently used.
+  std::list<Entry> entries_ TF_GUARDED_BY(mu_);
+  absl::flat_hash_map<uint64, std::list<Entry>::iterator> index_
+      TF_GUARDED_BY(mu_);
+  int64_t size_in_bytes_ TF_GUARDED_BY(mu_) = 0;
+};
+
 // Options specific to constant folding optimizations.
 struct ConstantFoldingOptions {
   // If "consider" is not a nullptr, then only constant fold a node "n" if
@@ -49,6 +102,11 @@ struct ConstantFoldingOptions {
   // default id generator that monotonically increases is used if nullptr is
   // passed.
   ConstantFoldNameGenerator generate_new_name = nullptr;
+
+  // If not nullptr, the results of evaluating constant subgraphs are looked up
+  // in, and added to, this cache. Constant subgraphs that call functions are
+  // never cached. Not owned.
+  ConstantFoldingCache* cache = nullptr;
 };
 
 // Perform constant folding optimization on "graph".
@@ -134,6 +134,64 @@ TEST_F(ConstantFoldingTest, Basic) {
                          {2, 2});
 }
 
+TEST_F(ConstantFoldingTest, Cache) {
+  ConstantFoldingCache cache(/*capacity_in_bytes=*/1024);
+  ConstantFoldingOptions opts;
+  opts.cache = &cache;
+
+  auto fold = [this, &opts](bool change_constant,
+                            gtl::ArraySlice<float> expected) {
+    Scope s = Scope::NewRootScope();
+    auto a = ops::Const<float>(s, {1.0, 0.0, 0.0, change_constant ? 2.0f : 1.0f},
+                               {2, 2});
+    auto b = ops::Const<float>(s, {1.0, 2.0, 3.0, 4.0}, {2, 2});
+    auto m = ops::MatMul(s.WithOpName("m"), a, b);
+    auto send =
+        ops::_Send(s.WithOpName("send"), m, "m", "sender", 0, "receiver");
+    Graph g(OpRegistry::Global());
+    TF_ASSERT_OK(s.ToGraph(&g));
+    bool was_mutated;
+    TF_ASSERT_OK(ConstantFold(opts, nullptr, Env::Default(), nullptr, &g,
+                              &was_mutated));
+    EXPECT_TRUE(was_mutated);
+    Node* send_node = g.BuildNodeNameIndex().at("send");
+    ASSERT_EQ(1, send_node->num_inputs());
+    ExpectNodeEqual<float>(*(send_node->in_nodes().begin()), expected, {2, 2});
+  };
+  const int64_t result_bytes = 4 * sizeof(float);
+
+  fold(/*change_constant=*/false, {1.0, 2.0, 3.0, 4.0});
+  EXPECT_EQ(result_bytes, cache.size_in_bytes());
+
+  // Folding the same constant subgraph again is served from the cache.
+  fold(/*change_constant=*/false, {1.0, 2.0, 3.0, 4.0});
+  EXPECT_EQ(result_bytes, cache.size_in_bytes());
+
+  // A different constant subgraph is not.
+  fold(/*change_constant=*/true, {1.0, 2.0, 6.0, 8.0});
+  EXPECT_EQ(2 * result_bytes, cache.size_in_bytes());
+}
+
+TEST(ConstantFoldingCacheTest, EvictsLeastRecentlyUsed) {
+  Tensor t = test::AsTensor<float>({1.0, 2.0});
+  ConstantFoldingCache cache(/*capacity_in_bytes=*/2 * t.TotalBytes());
+  cache.Insert(1, {t});
+  cache.Insert(2, {t});
+  std::vector<Tensor> tensors;
+  EXPECT_TRUE(cache.Lookup(1, &tensors));
+  cache.Insert(3, {t});
+  EXPECT_TRUE(cache.Lookup(1, &tensors));
+  EXPECT_FALSE(cache.Lookup(2, &tensors));
+  EXPECT_TRUE(cache.Lookup(3, &tensors));
+  ASSERT_EQ(1, tensors.size());
+  test::ExpectTensorEqual<float>(t, tensors[0]);
+
+  // Entries larger than the cache are not added.
+  cache.Insert(4, {t, t, t});
+  EXPECT_FALSE(cache.Lookup(4, &tensors));
+  EXPECT_EQ(2 * t.TotalBytes(), cache.size_in_bytes());
+}
+
 // Tests that different node creation ordering creates same graph after constant
 // folding.
 TEST_F(ConstantFoldingTest, DeterministicFolding) {
@@ -15,7 +15,9 @@ limitations under the License.
 
 #include "tensorflow/core/common_runtime/copy_tensor.h"
 
+#include <algorithm>
 #include <atomic>
+#include <memory>
 #include <utility>
 #include <vector>
 
@@ -26,6 +28,7 @@ limitations under the License.
 #include "tensorflow/core/lib/core/refcount.h"
 #include "tensorflow/core/platform/logging.h"
 #include "tensorflow/core/profiler/lib/scoped_annotation.h"
+#include "tensorflow/core/util/env_var.h"
 #include "tensorflow/core/util/reffed_status_callback.h"
 
 namespace tensorflow {
@@ -196,6 +199,86 @@ void CopyDeviceToDevice(CopyTensor::CopyFunction copy_function,
   }
 }
 
+// The size of the chunks of the copies between devices through the host, see
+// CopyDeviceToDeviceViaHostInChunks. 0 disables the chunking.
+int64_t ViaHostChunkBytes() {
+  static const int64_t chunk_bytes = [] {
+    int64_t chunk_bytes;
+    TF_CHECK_OK(ReadInt64FromEnvVar("TF_COPY_TENSOR_VIA_HOST_CHUNK_BYTES",
+                                    8 << 20, &chunk_bytes));
+    return chunk_bytes;
+  }();
+  return chunk_bytes;
+}
+
+// Returns the number of rows of the chunks if `input` is worth copying through
+// the host in chunks, or 0.
+int64_t ViaHostRowsPerChunk(const Tensor& input) {
+  const int64_t chunk_bytes = ViaHostChunkBytes();
+  if (chunk_bytes <= 0 || input.dtype() == DT_VARIANT ||
+      input.dtype() == DT_RESOURCE || !DMAHelper::CanUseDMA(&input) ||
+      input.dims() == 0 || input.dim_size(0) < 2 ||
+      input.TotalBytes() < 2 * chunk_bytes) {
+    return 0;
+  }
+  const int64_t row_bytes = input.TotalBytes() / input.dim_size(0);
+  const int64_t rows_per_chunk = std::max<int64_t>(chunk_bytes / row_bytes, 1);
+  return rows_per_chunk < input.dim_size(0) ? rows_per_chunk : 0;
+}
+
+// Copies `input` from `src` to `dst` through a host tensor, in chunks of
+// `rows_per_chunk` along the first dimension. Copying the whole tensor to the
+// host before copying it to `dst` takes the sum of the times of the two
+// copies, whereas the copy of a chunk to `dst` here overlaps with the copy of
+// the next chunks to the host.
+void CopyDeviceToDeviceViaHostInChunks(
+    StringPiece edge_name, Allocator* cpu_allocator,
+    DeviceContext* send_dev_context, DeviceContext* recv_dev_context,
+    Device* src, Device* dst, const Tensor* input, Tensor* output,
+    int64_t rows_per_chunk, StatusCallback done, bool sync_dst_compute) {
+  // The slices must outlive the copies that use them.
+  struct Chunks {
+    Tensor cpu_tensor;
+    std::vector<Tensor> inputs;
+    std::vector<Tensor> cpu_tensors;
+    std::vector<Tensor> outputs;
+  };
+  auto chunks = std::make_shared<Chunks>();
+  chunks->cpu_tensor = Tensor(cpu_allocator, input->dtype(), input->shape());
+  const int64_t num_rows = input->dim_size(0);
+  for (int64_t start = 0; start < num_rows; start += rows_per_chunk) {
+    const int64_t limit = std::min(start + rows_per_chunk, num_rows);
+    chunks->inputs.push_back(input->Slice(start, limit));
+    chunks->cpu_tensors.push_back(chunks->cpu_tensor.Slice(start, limit));
+    chunks->outputs.push_back(output->Slice(start, limit));
+  }
+  VLOG(2) << "Copying " << edge_name << " in " << chunks->inputs.size()
+          << " chunks via the host";
+
+  auto* status_cb = new ReffedStatusCallback(std::move(done));
+  core::ScopedUnref status_cb_unref(status_cb);
+  for (size_t i = 0; i < chunks->inputs.size(); ++i) {
+    status_cb->Ref();
+    send_dev_context->CopyDeviceTensorToCPU(
+        &chunks->inputs[i], edge_name, src, &chunks->cpu_tensors[i],
+        [chunks, i, status_cb, recv_dev_context, dst,
+         sync_dst_compute](const Status& status) {
+          if (!status.ok() || !status_cb->ok()) {
+            status_cb->UpdateStatus(status);
+            status_cb->Unref();
+            return;
+          }
+          recv_dev_context->CopyCPUTensorToDevice(
+              &chunks->cpu_tensors[i], dst, &chunks->outputs[i],
+              [chunks, status_cb](const Status& status) {
+                status_cb->UpdateStatus(status);
+                status_cb->Unref();
+              },
+              sync_dst_compute);
+        });
+  }
+}
+
 }  // namespace
 
 // static
@@ -252,6 +335,15 @@ void CopyTensor::ViaDMA(StringPiece edge_name, DeviceContext* send_dev_context,
             << dst_device_type.type()
             << ". Falling back to copying via the host.";
 
+    const int64_t rows_per_chunk = ViaHostRowsPerChunk(*input);
+    if (rows_per_chunk > 0) {
+      CopyDeviceToDeviceViaHostInChunks(
+          edge_name, cpu_allocator, send_dev_context, recv_dev_context, src,
+          dst, input, output, rows_per_chunk, std::move(done),
+          sync_dst_compute);
+      return;
+    }
+
     Tensor* cpu_tensor =
         new Tensor(cpu_allocator, input->dtype(), input->shape());
     auto delete_and_done = [cpu_tensor,
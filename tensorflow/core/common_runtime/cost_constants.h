@@ -22,6 +22,7 @@ namespace tensorflow {
 inline constexpr char kTpuCostName[] = "tpu";
 inline constexpr char kGcuCostName[] = "gcu";
 inline constexpr char kNoOpCostName[] = "no_op";
+inline constexpr char kCpuCostName[] = "cpu";
 
 // Each type of per-request cost could have the following versions.
 //
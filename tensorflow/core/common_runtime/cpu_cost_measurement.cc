@@ -0,0 +1,43 @@
+/* Copyright 2024 The TensorFlow Authors. All Rights Reserved.
+
+Licensed under the Apache License, Version 2.0 (the "License");
+you may not use this file except in compliance with the License.
+You may obtain a copy of the License at
+
+    http://www.apache.org/licenses/LICENSE-2.0
+
+Unless required by applicable law or agreed to in writing, software
+distributed under the License is distributed on an "AS IS" BASIS,
+WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+See the License for the specific language governing permissions and
+limitations under the License.
+==============================================================================*/
+
+#include "tensorflow/core/common_runtime/cpu_cost_measurement.h"
+
+#include <memory>
+
+#include "absl/strings/string_view.h"
+#include "absl/time/time.h"
+#include "tensorflow/core/common_runtime/cost_constants.h"
+
+namespace tensorflow {
+
+CpuCostMeasurement::CpuCostMeasurement(
+    const CostMeasurement::Context& context)
+    : CostMeasurement(context),
+      cpu_time_(std::make_shared<tsl::ContextCpuTime>()) {
+  tsl::ContextCpuTime::AttachToCurrentThread(cpu_time_);
+}
+
+absl::Duration CpuCostMeasurement::GetTotalCost() {
+  return absl::Nanoseconds(cpu_time_->nanos());
+}
+
+absl::string_view CpuCostMeasurement::GetCostType() const {
+  return kCpuCostName;
+}
+
+REGISTER_COST_MEASUREMENT(kCpuCostName, CpuCostMeasurement);
+
+}  // namespace tensorflow
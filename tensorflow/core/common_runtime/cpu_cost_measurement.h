@@ -0,0 +1,49 @@
+/* Copyright 2024 The TensorFlow Authors. All Rights Reserved.
+
+Licensed under the Apache License, Version 2.0 (the "License");
+you may not use this file except in compliance with the License.
+You may obtain a copy of the License at
+
+    http://www.apache.org/licenses/LICENSE-2.0
+
+Unless required by applicable law or agreed to in writing, software
+distributed under the License is distributed on an "AS IS" BASIS,
+WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+See the License for the specific language governing permissions and
+limitations under the License.
+==============================================================================*/
+
+#ifndef TENSORFLOW_CORE_COMMON_RUNTIME_CPU_COST_MEASUREMENT_H_
+#define TENSORFLOW_CORE_COMMON_RUNTIME_CPU_COST_MEASUREMENT_H_
+
+#include <memory>
+
+#include "absl/strings/string_view.h"
+#include "absl/time/time.h"
+#include "tensorflow/core/common_runtime/cost_measurement.h"
+#include "tensorflow/core/common_runtime/cost_measurement_registry.h"
+#include "tensorflow/core/platform/context.h"
+
+namespace tensorflow {
+
+// Measures the CPU time (CLOCK_THREAD_CPUTIME_ID) used on behalf of the work
+// that creates it: it is attached to the context of the current thread until
+// the end of the enclosing WithContext scope, so that the closures scheduled
+// from that thread on the inter-op and intra-op thread pools, and the
+// closures they schedule in turn, are charged to it.
+class CpuCostMeasurement : public CostMeasurement {
+ public:
+  explicit CpuCostMeasurement(const CostMeasurement::Context& context);
+
+  // The CPU time used so far. The closures that are still running are
+  // charged up to their last context switch.
+  absl::Duration GetTotalCost() override;
+  absl::string_view GetCostType() const override;
+
+ private:
+  const std::shared_ptr<tsl::ContextCpuTime> cpu_time_;
+};
+
+}  // namespace tensorflow
+
+#endif  // TENSORFLOW_CORE_COMMON_RUNTIME_CPU_COST_MEASUREMENT_H_
@@ -0,0 +1,79 @@
+/* Copyright 2024 The TensorFlow Authors. All Rights Reserved.
+
+Licensed under the Apache License, Version 2.0 (the "License");
+you may not use this file except in compliance with the License.
+You may obtain a copy of the License at
+
+    http://www.apache.org/licenses/LICENSE-2.0
+
+Unless required by applicable law or agreed to in writing, software
+distributed under the License is distributed on an "AS IS" BASIS,
+WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+See the License for the specific language governing permissions and
+limitations under the License.
+==============================================================================*/
+
+#include "tensorflow/core/common_runtime/cpu_cost_measurement.h"
+
+#include <memory>
+
+#include "absl/time/clock.h"
+#include "absl/time/time.h"
+#include "tensorflow/core/common_runtime/cost_measurement.h"
+#include "tensorflow/core/common_runtime/cost_measurement_registry.h"
+#include "tensorflow/core/lib/core/threadpool.h"
+#include "tensorflow/core/platform/context.h"
+#include "tensorflow/core/platform/env.h"
+#include "tensorflow/core/platform/test.h"
+
+namespace tensorflow {
+namespace {
+
+// Uses about `duration` of CPU time on the current thread.
+void Spin(absl::Duration duration) {
+  const absl::Time deadline = absl::Now() + duration;
+  while (absl::Now() < deadline) {
+  }
+}
+
+TEST(CpuCostMeasurementTest, ChargesTheClosuresOfTheThreadPools) {
+  WithContext scope((Context()));
+  CpuCostMeasurement measurement((CostMeasurement::Context()));
+  EXPECT_EQ(measurement.GetCostType(), "cpu");
+
+  Spin(absl::Milliseconds(20));
+  {
+    thread::ThreadPool thread_pool(Env::Default(), "test", 2);
+    thread_pool.Schedule([] { Spin(absl::Milliseconds(20)); });
+    // Joins the threads, once the closure has been charged.
+  }
+  EXPECT_GE(measurement.GetTotalCost(), absl::Milliseconds(35));
+}
+
+TEST(CpuCostMeasurementTest, DoesNotChargeTheWorkAfterTheScope) {
+  std::unique_ptr<CpuCostMeasurement> measurement;
+  {
+    WithContext scope((Context()));
+    measurement =
+        std::make_unique<CpuCostMeasurement>(CostMeasurement::Context());
+  }
+
+  Spin(absl::Milliseconds(20));
+  {
+    thread::ThreadPool thread_pool(Env::Default(), "test", 2);
+    thread_pool.Schedule([] { Spin(absl::Milliseconds(20)); });
+  }
+  EXPECT_LT(measurement->GetTotalCost(), absl::Milliseconds(10));
+}
+
+TEST(CpuCostMeasurementTest, IsRegistered) {
+  WithContext scope((Context()));
+  std::unique_ptr<CostMeasurement> measurement =
+      CostMeasurementRegistry::CreateByNameOrNull("cpu",
+                                                  CostMeasurement::Context());
+  ASSERT_NE(measurement, nullptr);
+  EXPECT_EQ(measurement->GetCostType(), "cpu");
+}
+
+}  // namespace
+}  // namespace tensorflow
@@ -100,6 +100,8 @@ EventMgr::EventMgr(se::StreamExecutor* se, const GPUOptions& gpu_options)
       polling_active_delay_usecs_(gpu_options.polling_active_delay_usecs()
                                       ? gpu_options.polling_active_delay_usecs()
                                       : 10),
+      polling_spin_usecs_(
+          gpu_options.experimental().event_polling_spin_usecs()),
       threadpool_(Env::Default(), "Device_Event_Manager", kNumThreads) {
   device_event_mgr::InitThreadpoolLabels(&threadpool_);
   StartPollingLoop();
@@ -143,22 +145,41 @@ void EventMgr::StopPollingLoop() {
 //
 // While one or more events is outstanding, poll for completed events.  When no
 // events are outstanding, we sleep until one is enqueued.
+//
+// Sleeping between polls delays each completion by up to the sleep, plus the
+// timer slack of the OS.  So with polling_spin_usecs_, we poll without sleeping
+// while there is activity, i.e. until polling_spin_usecs_ after the last event
+// completed or was enqueued on an idle EventMgr.
 void EventMgr::PollLoop() {
+  uint64 spin_deadline_usecs = 0;
   while (true) {
     bool events_still_pending;
+    bool active;
     {
       mutex_lock l(mu_);
       if (stop_polling_) {
         break;
       }
-      if (callbacks_.empty()) {
+      const bool was_idle = callbacks_.empty();
+      if (was_idle) {
         events_pending_.wait(l);
       }
-      PollEvents(/*stream=*/nullptr);  // poll all streams
+      // poll all streams
+      const int num_completed = PollEvents(/*stream=*/nullptr);
       events_still_pending = !callbacks_.empty();
+      active = was_idle || num_completed > 0;
     }
 
     if (events_still_pending) {
+      if (polling_spin_usecs_ > 0) {
+        const uint64 now_usecs = Env::Default()->NowMicros();
+        if (active) {
+          spin_deadline_usecs = now_usecs + polling_spin_usecs_;
+        }
+        if (now_usecs < spin_deadline_usecs) {
+          continue;
+        }
+      }
       Env::Default()->SleepForMicroseconds(polling_active_delay_usecs_);
     }
   }
@@ -196,10 +217,11 @@ void EventMgr::EnqueueCallback(se::Stream* stream, std::function<void()> func) {
 // spikes of up to several hundred outstanding.  (If GPUKernelTracker
 // is used to cap pending kernels there should never be more than
 // that many.)
-void EventMgr::PollEvents(se::Stream* stream /*=nullptr*/) {
+int EventMgr::PollEvents(se::Stream* stream /*=nullptr*/) {
   VLOG(2) << "PollEvents with one or more callbacks pending on "
           << callbacks_.size() << " streams and " << free_events_.size()
           << " unused event objects.";
+  int num_completed = 0;
 
   // Polls the events for one stream.
   //
@@ -230,6 +252,7 @@ void EventMgr::PollEvents(se::Stream* stream /*=nullptr*/) {
             case se::Event::Status::kComplete:
               free_events_.push_back(std::move(event));
               threadpool_.Schedule(std::move(callback));
+              ++num_completed;
               // std::deque::erase() does invalidate iterators, so we can't
               // erase `it` here.  Instead, we'll wait until the end of the loop
               // over stream_callbacks and erase all of the completed events at
@@ -267,6 +290,7 @@ void EventMgr::PollEvents(se::Stream* stream /*=nullptr*/) {
       poll_events_for_stream_it(stream_it);
     }
   }
+  return num_completed;
 }
 
 EventMgrFactory* EventMgrFactory::Singleton() {
@@ -80,6 +80,7 @@ class EventMgr {
 
   se::StreamExecutor* const exec_;
   const int32 polling_active_delay_usecs_;
+  const int32 polling_spin_usecs_;
   mutex mu_;
   condition_variable events_pending_ TF_GUARDED_BY(mu_);
 
@@ -94,12 +95,12 @@ class EventMgr {
   // to check whether pending events have recorded, and then retire them.
   //
   // If `stream` is not null, we only poll events for that stream.  Otherwise we
-  // poll events for all streams.
-  void PollEvents(se::Stream* stream = nullptr)
+  // poll events for all streams.  Returns the number of completed events.
+  int PollEvents(se::Stream* stream = nullptr)
       TF_EXCLUSIVE_LOCKS_REQUIRED(mu_);
 
   // An internal polling loop that runs at a low frequency to clear straggler
-  // Events.
+  // Events, or continuously for polling_spin_usecs_ after activity.
   void PollLoop();
 
   // Setup/Teardown functions for the polling loop.
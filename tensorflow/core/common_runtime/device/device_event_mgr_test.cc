@@ -134,6 +134,24 @@ TEST(EventMgr, WarnIfInCallback) {
   note.WaitForNotification();
   EXPECT_TRUE(hit);
 }
+
+TEST(EventMgr, SpinPolling) {
+  auto stream_exec = se::GPUMachineManager()->ExecutorForDevice(0).value();
+  GPUOptions gpu_options;
+  gpu_options.mutable_experimental()->set_event_polling_spin_usecs(1000);
+  TEST_EventMgr em(stream_exec, gpu_options);
+  TF_ASSERT_OK_AND_ASSIGN(auto stream, stream_exec->CreateStream());
+  constexpr int kNumCallbacks = 100;
+  std::atomic<int> counter(0);
+  Notification note;
+  for (int i = 0; i < kNumCallbacks; ++i) {
+    em.ThenExecute(stream.get(), [&counter, &note]() {
+      if (++counter == kNumCallbacks) note.Notify();
+    });
+  }
+  note.WaitForNotification();
+  EXPECT_EQ(counter, kNumCallbacks);
+}
 }  // namespace
 
 // Provides access to private resources of BaseGPUDevice.
@@ -47,6 +47,7 @@ limitations under the License.
 #include "tensorflow/core/framework/log_memory.h"
 #include "tensorflow/core/framework/logging.h"
 #include "tensorflow/core/framework/metrics.h"
+#include "tensorflow/core/framework/node_def_util.h"
 #include "tensorflow/core/framework/node_def.pb.h"
 #include "tensorflow/core/framework/run_handler.h"
 #include "tensorflow/core/framework/tensor.h"
@@ -160,6 +161,32 @@ string GetRendezvousKey(const string& tensor_name,
                          frame_iter.frame_id, ":", frame_iter.iter_id);
 }
 
+// Adds the rendezvous keys of the _Send/_Recv nodes of `graph` in the root
+// frame, in the format of the SendOp and RecvOp kernels. Feeds and fetches
+// (client terminated) are skipped.
+Status AddStaticRendezvousKeys(const Graph& graph,
+                               absl::flat_hash_set<string>* keys) {
+  for (const Node* n : graph.op_nodes()) {
+    if (!n->IsSend() && !n->IsRecv()) continue;
+    bool client_terminated = false;
+    TF_RETURN_IF_ERROR(
+        GetNodeAttr(n->attrs(), "client_terminated", &client_terminated));
+    if (client_terminated) continue;
+    string send_device, recv_device, tensor_name;
+    int64_t send_device_incarnation;
+    TF_RETURN_IF_ERROR(GetNodeAttr(n->attrs(), "send_device", &send_device));
+    TF_RETURN_IF_ERROR(GetNodeAttr(n->attrs(), "send_device_incarnation",
+                                   &send_device_incarnation));
+    TF_RETURN_IF_ERROR(GetNodeAttr(n->attrs(), "recv_device", &recv_device));
+    TF_RETURN_IF_ERROR(GetNodeAttr(n->attrs(), "tensor_name", &tensor_name));
+    keys->insert(strings::StrCat(
+        send_device, ";",
+        strings::FpToString(static_cast<uint64>(send_device_incarnation)), ";",
+        recv_device, ";", tensor_name, ";0:0"));
+  }
+  return absl::OkStatus();
+}
+
 }  // namespace
 
 class DirectSessionFactory : public SessionFactory {
@@ -195,6 +222,10 @@ class DirectSessionFactory : public SessionFactory {
     if (options.config.graph_options().build_cost_model() > 0) {
       EnableCPUAllocatorFullStats();
     }
+    if (experimental_config.cpu_huge_page_threshold_bytes() > 0) {
+      SetCPUAllocatorHugePageThreshold(
+          experimental_config.cpu_huge_page_threshold_bytes());
+    }
     std::vector<std::unique_ptr<Device>> devices;
     TF_RETURN_IF_ERROR(DeviceFactory::AddDevices(
         options, "/job:localhost/replica:0/task:0", &devices));
@@ -365,6 +396,10 @@ DirectSession::DirectSession(const SessionOptions& options,
   if (!status.ok()) {
     LOG(ERROR) << status.message();
   }
+  if (options_.config.experimental().step_stats_sample_period() > 0) {
+    sampled_stats_collector_ = std::make_unique<SampledStepStatsCollector>(
+        options_.config.experimental().step_stats_sample_period());
+  }
   session_handle_ =
       strings::StrCat("direct", strings::FpToString(random::New64()));
   if (options.config.log_device_placement()) {
@@ -385,6 +420,13 @@ DirectSession::DirectSession(const SessionOptions& options,
     devices_.push_back(d);
     device_set_.AddDevice(d);
     d->op_segment()->AddHold(session_handle_);
+    auto* bfc_allocator =
+        dynamic_cast<BFCAllocator*>(d->GetAllocator(AllocatorAttributes()));
+    if (bfc_allocator != nullptr &&
+        std::find(bfc_allocators_.begin(), bfc_allocators_.end(),
+                  bfc_allocator) == bfc_allocators_.end()) {
+      bfc_allocators_.push_back(bfc_allocator);
+    }
   }
 }
 
@@ -696,6 +738,11 @@ Status DirectSession::RunInternal(
         new StepStatsCollector(run_metadata->mutable_step_stats()));
     args.stats_collector = run_state.collector.get();
   }
+  std::unique_ptr<StepStatsCollectorInterface> sampled_step_collector;
+  if (args.stats_collector == nullptr && sampled_stats_collector_) {
+    sampled_step_collector = sampled_stats_collector_->MaybeStartStep();
+    args.stats_collector = sampled_step_collector.get();
+  }
 
   std::unique_ptr<DeviceProfilerSession> device_profiler_session;
   if (run_options.trace_level() >= RunOptions::HARDWARE_TRACE) {
@@ -738,6 +785,9 @@ Status DirectSession::RunInternal(
 
   if (can_execute_synchronously) {
     PrivateIntraProcessRendezvous rendezvous(device_mgr_.get());
+    if (executors_and_keys->static_rendezvous_keys != nullptr) {
+      rendezvous.SetStaticKeys(executors_and_keys->static_rendezvous_keys);
+    }
     args.rendezvous = &rendezvous;
 
     const auto& item = executors_and_keys->items[0];
@@ -746,6 +796,9 @@ Status DirectSession::RunInternal(
   } else {
     core::RefCountPtr<RefCountedIntraProcessRendezvous> rendezvous(
         new RefCountedIntraProcessRendezvous(device_mgr_.get()));
+    if (executors_and_keys->static_rendezvous_keys != nullptr) {
+      rendezvous->SetStaticKeys(executors_and_keys->static_rendezvous_keys);
+    }
     args.rendezvous = rendezvous.get();
 
     // `barrier` will delete itself after the final executor finishes.
@@ -838,6 +891,10 @@ Status DirectSession::RunInternal(
   }
   metrics::UpdateGraphExecTime(options_.env->NowMicros() - start_time_usecs);
 
+  for (BFCAllocator* bfc_allocator : bfc_allocators_) {
+    bfc_allocator->OnStepBoundary();
+  }
+
   return absl::OkStatus();
 }
 
@@ -1380,6 +1437,7 @@ Status DirectSession::CreateExecutors(
       }}));
 
   GraphOptimizer optimizer(optimizer_opts);
+  absl::flat_hash_set<string> static_rendezvous_keys;
   for (auto iter = graphs.begin(); iter != graphs.end(); ++iter) {
     const string& partition_name = iter->first;
     std::unique_ptr<Graph>& partition_graph = iter->second;
@@ -1399,6 +1457,10 @@ Status DirectSession::CreateExecutors(
     params.device = device;
     params.session_metadata = session_metadata;
     params.function_library = lib;
+    params.use_step_arena_allocator =
+        options_.config.experimental().use_step_arena_allocator();
+    params.memory_attribution_sample_period =
+        options_.config.experimental().memory_attribution_sample_period();
     auto opseg = device->op_segment();
     params.create_kernel =
         [this, lib, opseg](const std::shared_ptr<const NodeProperties>& props,
@@ -1438,6 +1500,8 @@ Status DirectSession::CreateExecutors(
     TF_RETURN_IF_ERROR(EnsureMemoryTypes(DeviceType(device->device_type()),
                                          device->name(),
                                          partition_graph.get()));
+    TF_RETURN_IF_ERROR(
+        AddStaticRendezvousKeys(*partition_graph, &static_rendezvous_keys));
 
     item->executor = nullptr;
     item->device = device;
@@ -1449,6 +1513,11 @@ Status DirectSession::CreateExecutors(
       item->graph = std::move(partition_graph);
     }
   }
+  if (!static_rendezvous_keys.empty()) {
+    ek->static_rendezvous_keys = std::make_shared<StaticRendezvousKeys>(
+        std::vector<string>(static_rendezvous_keys.begin(),
+                            static_rendezvous_keys.end()));
+  }
 
   // Cache the mapping from input/output names to graph elements to
   // avoid recomputing it every time.
@@ -1877,6 +1946,19 @@ Status DirectSession::MakeCallable(const CallableOptions& callable_options,
   RunStateArgs run_state_args(callable_options.run_options().debug_options());
   TF_RETURN_IF_ERROR(
       CreateExecutors(callable_options, &ek, &func_info, &run_state_args));
+  if (callable_options.fetch_into_caller_buffers()) {
+    ek->fetch_on_host.reserve(callable_options.fetch_size());
+    for (const string& fetch : callable_options.fetch()) {
+      bool on_host = true;
+      auto it = callable_options.fetch_devices().find(fetch);
+      if (it != callable_options.fetch_devices().end()) {
+        Device* device;
+        TF_RETURN_IF_ERROR(device_mgr_->LookupDevice(it->second, &device));
+        on_host = device->device_type() == DEVICE_CPU;
+      }
+      ek->fetch_on_host.push_back(on_host);
+    }
+  }
   {
     mutex_lock l(callables_lock_);
     *out_handle = next_callable_handle_++;
@@ -1890,11 +1972,13 @@ class DirectSession::RunCallableCallFrame : public CallFrameInterface {
   RunCallableCallFrame(DirectSession* session,
                        ExecutorsAndKeys* executors_and_keys,
                        const std::vector<Tensor>* feed_tensors,
-                       std::vector<Tensor>* fetch_tensors)
+                       std::vector<Tensor>* fetch_tensors,
+                       std::vector<Tensor> fetch_buffers = {})
       : session_(session),
         executors_and_keys_(executors_and_keys),
         feed_tensors_(feed_tensors),
-        fetch_tensors_(fetch_tensors) {}
+        fetch_tensors_(fetch_tensors),
+        fetch_buffers_(std::move(fetch_buffers)) {}
 
   size_t num_args() const override {
     return executors_and_keys_->input_types.size();
@@ -1916,15 +2000,43 @@ class DirectSession::RunCallableCallFrame : public CallFrameInterface {
     if (index > fetch_tensors_->size()) {
       return errors::Internal("RetVal index out of bounds: ", index);
     }
+    const Tensor* buffer = GetFetchBuffer(index);
+    if (TF_PREDICT_FALSE(buffer != nullptr) && !val.SharesBufferWith(*buffer) &&
+        executors_and_keys_->fetch_on_host[index] &&
+        val.dtype() == buffer->dtype() && val.shape() == buffer->shape() &&
+        DataTypeCanUseMemcpy(val.dtype())) {
+      // The kernel that produced `val` did not allocate it in the buffer, so
+      // copy it there instead.
+      memcpy(buffer->data(), val.data(), val.TotalBytes());
+      (*fetch_tensors_)[index] = *buffer;
+      return absl::OkStatus();
+    }
     (*fetch_tensors_)[index] = val;
     return absl::OkStatus();
   }
 
+  const Tensor* GetRetvalBuffer(int index, bool* on_host) const override {
+    const Tensor* buffer = GetFetchBuffer(index);
+    if (buffer != nullptr) *on_host = executors_and_keys_->fetch_on_host[index];
+    return buffer;
+  }
+
  private:
+  const Tensor* GetFetchBuffer(int index) const {
+    if (index >= fetch_buffers_.size() ||
+        !fetch_buffers_[index].IsInitialized()) {
+      return nullptr;
+    }
+    return &fetch_buffers_[index];
+  }
+
   DirectSession* const session_;                   // Not owned.
   ExecutorsAndKeys* const executors_and_keys_;     // Not owned.
   const std::vector<Tensor>* const feed_tensors_;  // Not owned.
   std::vector<Tensor>* const fetch_tensors_;       // Not owned.
+  // The caller-provided buffers for each fetch, if
+  // `CallableOptions.fetch_into_caller_buffers` is true.
+  const std::vector<Tensor> fetch_buffers_;
 };
 
 ::tensorflow::Status DirectSession::RunCallable(
@@ -1944,6 +2056,7 @@ class DirectSession::RunCallableCallFrame : public CallFrameInterface {
 
   // Check if we already have an executor for these arguments.
   std::shared_ptr<ExecutorsAndKeys> executors_and_keys;
+  std::shared_ptr<const std::vector<Tensor>> retained_feed_tensors;
   const int64_t step_id = step_id_counter_.fetch_add(1);
 
   {
@@ -1951,7 +2064,9 @@ class DirectSession::RunCallableCallFrame : public CallFrameInterface {
     if (handle >= next_callable_handle_) {
       return errors::InvalidArgument("No such callable handle: ", handle);
     }
-    executors_and_keys = callables_[handle].executors_and_keys;
+    const Callable& callable = callables_[handle];
+    executors_and_keys = callable.executors_and_keys;
+    retained_feed_tensors = callable.retained_feed_tensors;
   }
 
   if (!executors_and_keys) {
@@ -1959,6 +2074,30 @@ class DirectSession::RunCallableCallFrame : public CallFrameInterface {
         "Attempted to run callable after handle was released: ", handle);
   }
 
+  const std::vector<Tensor>* feeds = &feed_tensors;
+  if (executors_and_keys->callable_options.retain_feed_tensors() &&
+      !executors_and_keys->input_types.empty()) {
+    if (feed_tensors.empty()) {
+      if (retained_feed_tensors == nullptr) {
+        return errors::InvalidArgument(
+            "Callable ", handle,
+            " has no retained feed tensors, because it has not been run with "
+            "feeds.");
+      }
+      feeds = retained_feed_tensors.get();
+    } else if (feed_tensors.size() ==
+               executors_and_keys->input_types.size()) {
+      retained_feed_tensors =
+          std::make_shared<const std::vector<Tensor>>(feed_tensors);
+      feeds = retained_feed_tensors.get();
+      mutex_lock l(callables_lock_);
+      auto it = callables_.find(handle);
+      if (it != callables_.end()) {
+        it->second.retained_feed_tensors = retained_feed_tensors;
+      }
+    }
+  }
+
   // NOTE(mrry): Debug options are not currently supported in the
   // callable interface.
   DebugOptions debug_options;
@@ -1966,12 +2105,16 @@ class DirectSession::RunCallableCallFrame : public CallFrameInterface {
 
   // Configure a call frame for the step, which we use to feed and
   // fetch values to and from the executors.
-  if (feed_tensors.size() != executors_and_keys->input_types.size()) {
+  if (feeds->size() != executors_and_keys->input_types.size()) {
     return errors::InvalidArgument(
         "Expected ", executors_and_keys->input_types.size(),
-        " feed tensors, but got ", feed_tensors.size());
+        " feed tensors, but got ", feeds->size());
   }
+  std::vector<Tensor> fetch_buffers;
   if (fetch_tensors != nullptr) {
+    if (executors_and_keys->callable_options.fetch_into_caller_buffers()) {
+      fetch_buffers = *fetch_tensors;
+    }
     fetch_tensors->resize(executors_and_keys->output_types.size());
   } else if (!executors_and_keys->output_types.empty()) {
     return errors::InvalidArgument(
@@ -1981,7 +2124,7 @@ class DirectSession::RunCallableCallFrame : public CallFrameInterface {
 
   size_t input_size = 0;
   bool any_resource_feeds = false;
-  for (auto& tensor : feed_tensors) {
+  for (auto& tensor : *feeds) {
     input_size += tensor.AllocatedBytes();
     any_resource_feeds = any_resource_feeds || tensor.dtype() == DT_RESOURCE;
   }
@@ -1992,8 +2135,8 @@ class DirectSession::RunCallableCallFrame : public CallFrameInterface {
 
   if (TF_PREDICT_FALSE(any_resource_feeds)) {
     converted_feed_tensors = std::make_unique<std::vector<Tensor>>();
-    converted_feed_tensors->reserve(feed_tensors.size());
-    for (const Tensor& t : feed_tensors) {
+    converted_feed_tensors->reserve(feeds->size());
+    for (const Tensor& t : *feeds) {
       if (t.dtype() == DT_RESOURCE) {
         converted_feed_tensors->emplace_back();
         Tensor* tensor_from_handle = &converted_feed_tensors->back();
@@ -2004,13 +2147,14 @@ class DirectSession::RunCallableCallFrame : public CallFrameInterface {
     }
     actual_feed_tensors = converted_feed_tensors.get();
   } else {
-    actual_feed_tensors = &feed_tensors;
+    actual_feed_tensors = feeds;
   }
 
   // A specialized CallFrame implementation that takes advantage of the
   // optimized RunCallable interface.
   RunCallableCallFrame call_frame(this, executors_and_keys.get(),
-                                  actual_feed_tensors, fetch_tensors);
+                                  actual_feed_tensors, fetch_tensors,
+                                  std::move(fetch_buffers));
 
   if (LogMemory::IsEnabled()) {
     LogMemory::RecordStep(step_id, run_state_args.handle);
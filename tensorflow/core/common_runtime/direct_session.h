@@ -23,6 +23,7 @@ limitations under the License.
 #include <unordered_set>
 #include <vector>
 
+#include "tensorflow/core/common_runtime/bfc_allocator.h"
 #include "tensorflow/core/common_runtime/costmodel_manager.h"
 #include "tensorflow/core/common_runtime/debugger_state_interface.h"
 #include "tensorflow/core/common_runtime/device_mgr.h"
@@ -31,10 +32,12 @@ limitations under the License.
 #include "tensorflow/core/common_runtime/graph_execution_state.h"
 #include "tensorflow/core/common_runtime/process_function_library_runtime.h"
 #include "tensorflow/core/common_runtime/rendezvous_mgr.h"
+#include "tensorflow/core/common_runtime/sampled_step_stats_collector.h"
 #include "tensorflow/core/common_runtime/session_factory.h"
 #include "tensorflow/core/framework/cancellation.h"
 #include "tensorflow/core/framework/collective.h"
 #include "tensorflow/core/framework/graph.pb.h"
+#include "tensorflow/core/framework/local_rendezvous.h"
 #include "tensorflow/core/framework/session_state.h"
 #include "tensorflow/core/framework/tensor.h"
 #include "tensorflow/core/lib/core/errors.h"
@@ -118,6 +121,13 @@ class DirectSession : public Session {
     cost_model_manager_.ExportCostModels(cost_models);
   }
 
+  // Appends the node statistics collected from sampled steps since the last
+  // call to `*step_stats`. Has no effect unless
+  // `ConfigProto.Experimental.step_stats_sample_period` is positive.
+  void CollectSampledStepStats(StepStats* step_stats) {
+    if (sampled_stats_collector_) sampled_stats_collector_->Collect(step_stats);
+  }
+
   ::tensorflow::Status MakeCallable(const CallableOptions& callable_options,
                                     CallableHandle* out_handle) override;
 
@@ -175,7 +185,16 @@ class DirectSession : public Session {
 
     CallableOptions callable_options;
 
+    // If `callable_options.fetch_into_caller_buffers()` is true,
+    // `fetch_on_host[i]` is true iff the i-th fetch is returned in host
+    // memory.
+    std::vector<bool> fetch_on_host;
+
     int64_t collective_graph_key = BuildGraphOptions::kNoCollectiveGraphKey;
+
+    // The keys of the Send/Recv pairs between the partitions, which the
+    // rendezvous of each step exchanges without going through its table.
+    std::shared_ptr<const StaticRendezvousKeys> static_rendezvous_keys;
   };
 
   // A FunctionInfo object is created for every unique set of feeds/fetches.
@@ -338,6 +357,9 @@ class DirectSession : public Session {
   // Device structures.
   const std::unique_ptr<const DeviceMgr> device_mgr_;
   std::vector<Device*> devices_;  // not owned
+  // The distinct BFC allocators of `devices_`, which are notified at the end of
+  // each step. Not owned.
+  std::vector<BFCAllocator*> bfc_allocators_;
   DeviceSet device_set_;
 
   // Unique session identifier.
@@ -371,6 +393,9 @@ class DirectSession : public Session {
   struct Callable {
     std::shared_ptr<ExecutorsAndKeys> executors_and_keys;
     std::shared_ptr<FunctionInfo> function_info;
+    // The tensors fed in the most recent call, if
+    // `CallableOptions.retain_feed_tensors` is true.
+    std::shared_ptr<const std::vector<Tensor>> retained_feed_tensors;
     ~Callable();
   };
   mutex callables_lock_;
@@ -422,6 +447,10 @@ class DirectSession : public Session {
   // Manages all the cost models for the graphs executed in this session.
   CostModelManager cost_model_manager_;
 
+  // Collects statistics for a sample of steps, or nullptr if sampling is
+  // disabled.
+  std::unique_ptr<SampledStepStatsCollector> sampled_stats_collector_;
+
   // For testing collective graph key generation.
   mutex collective_graph_key_lock_;
   int64_t collective_graph_key_ TF_GUARDED_BY(collective_graph_key_lock_) = -1;
@@ -157,6 +157,47 @@ TEST_F(DirectSessionMinusAXTest, RunSimpleNetwork) {
   EXPECT_FLOAT_EQ(5.0, mat(0, 0));
 }
 
+TEST_F(DirectSessionMinusAXTest, RunSimpleNetwork_SampledStepStats) {
+  Initialize({3, 2, -1, 0});
+  SessionOptions options = DefaultSessionOptions();
+  options.config.mutable_experimental()->set_step_stats_sample_period(2);
+  std::unique_ptr<Session> session(NewSession(options));
+  ASSERT_TRUE(session != nullptr);
+  TF_ASSERT_OK(session->Create(def_));
+  DirectSession* direct_session = static_cast<DirectSession*>(session.get());
+
+  auto num_node_stats = [direct_session]() {
+    StepStats step_stats;
+    direct_session->CollectSampledStepStats(&step_stats);
+    int num = 0;
+    for (const auto& dev_stats : step_stats.dev_stats()) {
+      for (const auto& node_stats : dev_stats.node_stats()) {
+        EXPECT_FALSE(node_stats.node_name().empty());
+        EXPECT_GE(node_stats.all_end_rel_nanos(), 0);
+        ++num;
+      }
+    }
+    return num;
+  };
+
+  std::vector<Tensor> outputs;
+  // Steps 0 and 2 are sampled.
+  for (int i = 0; i < 4; ++i) {
+    TF_ASSERT_OK(session->Run({}, {y_ + ":0"}, {}, &outputs));
+  }
+  const int num_per_two_steps = num_node_stats();
+  EXPECT_GT(num_per_two_steps, 0);
+  // Records are only returned once.
+  EXPECT_EQ(0, num_node_stats());
+
+  // Step 4 is sampled.
+  TF_ASSERT_OK(session->Run({}, {y_ + ":0"}, {}, &outputs));
+  EXPECT_EQ(num_per_two_steps, 2 * num_node_stats());
+  // Step 5 is not.
+  TF_ASSERT_OK(session->Run({}, {y_ + ":0"}, {}, &outputs));
+  EXPECT_EQ(0, num_node_stats());
+}
+
 TEST_F(DirectSessionMinusAXTest, RunSimpleNetwork_Callable) {
   Initialize({3, 2, -1, 0});
   auto session = CreateSession();
@@ -201,6 +242,76 @@ TEST_F(DirectSessionMinusAXTest, RunSimpleNetwork_Callable) {
   }
 }
 
+TEST_F(DirectSessionMinusAXTest, RunSimpleNetwork_CallableFetchIntoBuffers) {
+  Initialize({3, 2, -1, 0});
+  auto session = CreateSession();
+  ASSERT_TRUE(session != nullptr);
+  TF_ASSERT_OK(session->Create(def_));
+
+  CallableOptions callable_options =
+      MakeCallableOptions({}, {y_ + ":0"}, {y_neg_});
+  callable_options.set_fetch_into_caller_buffers(true);
+  Session::CallableHandle handle;
+  TF_ASSERT_OK(session->MakeCallable(callable_options, &handle));
+
+  // A buffer with the type and shape of the fetch receives its value.
+  Tensor buffer(DT_FLOAT, TensorShape({2, 1}));
+  std::vector<Tensor> outputs = {buffer};
+  TF_ASSERT_OK(session->RunCallable(handle, {}, &outputs, nullptr));
+  ASSERT_EQ(1, outputs.size());
+  EXPECT_TRUE(outputs[0].SharesBufferWith(buffer));
+  EXPECT_FLOAT_EQ(5.0, buffer.matrix<float>()(0, 0));
+
+  // Any other buffer is replaced by a new tensor.
+  Tensor wrong_shape(DT_FLOAT, TensorShape({3}));
+  outputs = {wrong_shape};
+  TF_ASSERT_OK(session->RunCallable(handle, {}, &outputs, nullptr));
+  ASSERT_EQ(1, outputs.size());
+  EXPECT_FALSE(outputs[0].SharesBufferWith(wrong_shape));
+  EXPECT_FLOAT_EQ(5.0, outputs[0].matrix<float>()(0, 0));
+
+  // Without a buffer, the fetch is returned in a new tensor.
+  outputs.clear();
+  TF_ASSERT_OK(session->RunCallable(handle, {}, &outputs, nullptr));
+  ASSERT_EQ(1, outputs.size());
+  EXPECT_FLOAT_EQ(5.0, outputs[0].matrix<float>()(0, 0));
+
+  TF_ASSERT_OK(session->ReleaseCallable(handle));
+}
+
+TEST_F(DirectSessionMinusAXTest, RunSimpleNetwork_CallableRetainFeeds) {
+  Initialize({3, 2, -1, 0});
+  auto session = CreateSession();
+  ASSERT_TRUE(session != nullptr);
+  TF_ASSERT_OK(session->Create(def_));
+
+  CallableOptions callable_options =
+      MakeCallableOptions({x_ + ":0"}, {y_ + ":0"}, {});
+  callable_options.set_retain_feed_tensors(true);
+  Session::CallableHandle handle;
+  TF_ASSERT_OK(session->MakeCallable(callable_options, &handle));
+
+  std::vector<Tensor> outputs;
+  Status s = session->RunCallable(handle, {}, &outputs, nullptr);
+  EXPECT_TRUE(errors::IsInvalidArgument(s));
+  EXPECT_TRUE(absl::StrContains(s.message(), "no retained feed tensors"));
+
+  Tensor x(DT_FLOAT, TensorShape({2, 1}));
+  test::FillValues<float>(&x, {1, 1});
+  TF_ASSERT_OK(session->RunCallable(handle, {x}, &outputs, nullptr));
+  ASSERT_EQ(1, outputs.size());
+  EXPECT_FLOAT_EQ(5.0, outputs[0].matrix<float>()(0, 0));
+
+  // Updating the retained feed in place changes the result of later calls
+  // that do not provide feeds.
+  test::FillValues<float>(&x, {2, 1});
+  TF_ASSERT_OK(session->RunCallable(handle, {}, &outputs, nullptr));
+  ASSERT_EQ(1, outputs.size());
+  EXPECT_FLOAT_EQ(8.0, outputs[0].matrix<float>()(0, 0));
+
+  TF_ASSERT_OK(session->ReleaseCallable(handle));
+}
+
 TEST_F(DirectSessionMinusAXTest, RunSimpleNetwork_OptimizeForStaticGraph) {
   Initialize({3, 2, -1, 0});
   SessionOptions options(DefaultSessionOptions());
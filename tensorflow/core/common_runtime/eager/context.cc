@@ -155,6 +155,7 @@ EagerContext::EagerContext(
                         /*enable_streaming_enqueue=*/!opts.config.experimental()
                             .disable_eager_executor_streaming_enqueue()),
       log_memory_(LogMemory::IsEnabled()),
+      buffer_pool_bytes_(opts.config.experimental().eager_buffer_pool_bytes()),
       env_(opts.env),
       collective_executor_mgr_(collective_executor_mgr, /*owned=*/false),
       use_send_tensor_rpc_(false),
@@ -277,9 +278,15 @@ void EagerContext::InitPrioritizedDeviceTypeList() {
       ds.AddDevice(d);
     }
   }
-  mutex_lock l(device_type_list_mu_);
-  prioritized_device_type_list_ =
-      std::make_shared<std::vector<DeviceType>>(ds.PrioritizedDeviceTypeList());
+  {
+    mutex_lock l(device_type_list_mu_);
+    prioritized_device_type_list_ = std::make_shared<std::vector<DeviceType>>(
+        ds.PrioritizedDeviceTypeList());
+  }
+  // Cached device selections may no longer prefer the right device.
+  mutex_lock dl(device_cache_mu_);
+  device_cache_.clear();
+  placement_cache_.clear();
 }
 
 namespace {
@@ -472,7 +479,7 @@ void EagerContext::ClearCachesAndDefaultExecutor() {
     // during this time as well.
     mutex_lock ml(cache_mu_);
     default_executor_.WaitForAllPendingNodes().IgnoreError();
-    kernel_cache_.clear();
+    kernel_cache_.Clear();
     for (auto& entry : registered_functions_) {
       entry.second->cached_kernel_keys->clear();
     }
@@ -480,6 +487,15 @@ void EagerContext::ClearCachesAndDefaultExecutor() {
   {
     mutex_lock dl(device_cache_mu_);
     device_cache_.clear();
+    placement_cache_.clear();
+  }
+  {
+    absl::flat_hash_map<Fprint128, FusionCandidate, Fprint128Hasher>
+        fused_kernels;
+    {
+      mutex_lock fl(fused_kernels_mu_);
+      fused_kernels.swap(fused_kernels_);
+    }
   }
   {
     mutex_lock ml(metadata_mu_);
@@ -624,6 +640,13 @@ EagerContext::~EagerContext() {
   custom_device_op_handler_.Clear();
 
   ClearCachesAndThreadExecutors();
+  {
+    mutex_lock l(buffer_pools_mu_);
+    for (const auto& entry : buffer_pools_) {
+      if (entry.second != nullptr) entry.second->Release();
+    }
+    buffer_pools_.clear();
+  }
   std::unordered_map<std::thread::id, EagerExecutor*> executors_copy;
   {
     mutex_lock l(executor_map_mu_);
@@ -688,6 +711,21 @@ EagerContext::~EagerContext() {
   }
 }
 
+Allocator* EagerContext::GetBufferPool(Device* device) {
+  if (buffer_pool_bytes_ <= 0) return nullptr;
+  mutex_lock l(buffer_pools_mu_);
+  auto it = buffer_pools_.find(device);
+  if (it != buffer_pools_.end()) return it->second;
+  Allocator* base = device->GetAllocator(AllocatorAttributes());
+  TensorBufferPool* pool = nullptr;
+  // Buffers that are opaque handles can't be recycled by size.
+  if (base != nullptr && !base->AllocatesOpaqueHandle()) {
+    pool = new TensorBufferPool(base, buffer_pool_bytes_);
+  }
+  buffer_pools_[device] = pool;
+  return pool;
+}
+
 bool EagerContext::FindFunctionByName(const string& name) const {
   return func_lib_def_.Find(name) != nullptr;
 }
@@ -1101,7 +1139,7 @@ EagerContext::GetCacheStats() {
   CacheStats stats;
   {
     mutex_lock l(cache_mu_);
-    stats.kernel_cache_size = kernel_cache_.size();
+    stats.kernel_cache_size = kernel_cache_.Size();
     for (const auto& iter : registered_functions_) {
       stats.func_kernel_cache_entries[iter.first] =
           iter.second->cached_kernel_keys->size();
@@ -1132,7 +1170,7 @@ Status EagerContext::RemoveFunction(const string& func) {
     is_last_ref = registered_function->RefCountIsOne();
     if (is_last_ref) {
       for (auto& key : *registered_function->cached_kernel_keys) {
-        kernel_cache_.erase(key);
+        kernel_cache_.Erase(key);
       }
       registered_functions_.erase(func);
     }
@@ -1215,14 +1253,7 @@ Status EagerContext::SyncExecutors() {
 
 core::RefCountPtr<KernelAndDevice> EagerContext::GetCachedKernel(
     Fprint128 cache_key) {
-  tf_shared_lock l(cache_mu_);
-  auto iter = kernel_cache_.find(cache_key);
-  if (iter == kernel_cache_.end()) {
-    return nullptr;
-  }
-  core::RefCountPtr<KernelAndDevice> new_ref(iter->second.get());
-  new_ref->Ref();
-  return new_ref;
+  return kernel_cache_.Lookup(cache_key);
 }
 
 Device* EagerContext::GetCachedDevice(Fprint128 device_cache_key) {
@@ -1235,15 +1266,12 @@ Device* EagerContext::GetCachedDevice(Fprint128 device_cache_key) {
 core::RefCountPtr<KernelAndDevice> EagerContext::AddKernelToCache(
     Fprint128 cache_key, core::RefCountPtr<KernelAndDevice> kernel) {
   mutex_lock ml(cache_mu_);
-  auto iter = kernel_cache_.find(cache_key);
-  if (iter != kernel_cache_.end()) {
-    core::RefCountPtr<KernelAndDevice> new_ref(iter->second.get());
-    new_ref->Ref();
-    return new_ref;
-  }
-  core::RefCountPtr<KernelAndDevice> new_ref(kernel.get());
-  new_ref->Ref();
-  kernel_cache_[cache_key] = std::move(new_ref);
+  bool inserted = false;
+  core::RefCountPtr<KernelAndDevice> cached =
+      kernel_cache_.Insert(cache_key, kernel.get(), &inserted);
+  if (!inserted) {
+    return cached;
+  }
   auto* registered_function =
       gtl::FindPtrOrNull(registered_functions_, kernel->name());
 
@@ -1262,6 +1290,60 @@ void EagerContext::AddDeviceToCache(Fprint128 device_cache_key,
   device_cache_[device_cache_key] = device;
 }
 
+bool EagerContext::GetCachedPlacement(Fprint128 placement_key,
+                                      CachedPlacement* placement) {
+  tf_shared_lock l(device_cache_mu_);
+  auto iter = placement_cache_.find(placement_key);
+  if (iter == placement_cache_.end()) return false;
+  *placement = iter->second;
+  return true;
+}
+
+void EagerContext::AddPlacementToCache(Fprint128 placement_key,
+                                       const CachedPlacement& placement) {
+  mutex_lock l(device_cache_mu_);
+  placement_cache_[placement_key] = placement;
+}
+
+core::RefCountPtr<EagerContext::FusedKernel> EagerContext::GetFusedKernel(
+    const Fprint128& key, absl::Span<KernelAndDevice* const> op_kernels,
+    int64_t* num_uses) {
+  // Bounds the number of op sequences that are tracked, most of which are
+  // never run often enough to be fused.
+  static constexpr int kMaxFusionCandidates = 1024;
+  mutex_lock l(fused_kernels_mu_);
+  auto iter = fused_kernels_.find(key);
+  if (iter == fused_kernels_.end()) {
+    if (fused_kernels_.size() >= kMaxFusionCandidates) {
+      *num_uses = 0;
+      return nullptr;
+    }
+    iter = fused_kernels_.emplace(key, FusionCandidate()).first;
+    for (KernelAndDevice* kernel : op_kernels) {
+      kernel->Ref();
+      iter->second.op_kernels.emplace_back(kernel);
+    }
+  }
+  FusionCandidate& candidate = iter->second;
+  if (candidate.fused != nullptr) {
+    return candidate.fused.GetNewRef();
+  }
+  *num_uses = candidate.num_uses < 0 ? 0 : ++candidate.num_uses;
+  return nullptr;
+}
+
+void EagerContext::AddFusedKernel(const Fprint128& key, FusedKernel* fused) {
+  mutex_lock l(fused_kernels_mu_);
+  auto iter = fused_kernels_.find(key);
+  if (iter == fused_kernels_.end() || iter->second.fused != nullptr) return;
+  if (fused == nullptr) {
+    iter->second.num_uses = -1;
+    return;
+  }
+  fused->Ref();
+  iter->second.fused.reset(fused);
+}
+
 bool EagerContext::ShouldStoreGraphs() { return should_store_graphs_.load(); }
 
 void EagerContext::SetShouldStoreGraphs(bool value) {
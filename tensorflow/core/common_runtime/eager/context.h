@@ -32,6 +32,7 @@ limitations under the License.
 #include "absl/container/flat_hash_map.h"
 #include "absl/container/flat_hash_set.h"
 #include "absl/types/optional.h"
+#include "absl/types/span.h"
 #include "tensorflow/c/eager/immediate_execution_context.h"
 #include "tensorflow/core/common_runtime/composite_device.h"
 #include "tensorflow/core/common_runtime/device_factory.h"
@@ -40,7 +41,9 @@ limitations under the License.
 #include "tensorflow/core/common_runtime/eager/custom_device_op_handler.h"
 #include "tensorflow/core/common_runtime/eager/eager_executor.h"
 #include "tensorflow/core/common_runtime/eager/kernel_and_device.h"
+#include "tensorflow/core/common_runtime/eager/kernel_cache.h"
 #include "tensorflow/core/common_runtime/eager/rendezvous_cache.h"
+#include "tensorflow/core/common_runtime/eager/tensor_buffer_pool.h"
 #include "tensorflow/core/common_runtime/function.h"
 #include "tensorflow/core/common_runtime/process_function_library_runtime.h"
 #include "tensorflow/core/common_runtime/rendezvous_mgr.h"
@@ -297,6 +300,38 @@ class EagerContext : public ImmediateExecutionContext, public core::RefCounted {
       Fprint128 cache_key, core::RefCountPtr<KernelAndDevice> kernel);
   void AddDeviceToCache(Fprint128 device_cache_key, Device* device);
 
+  // The placement decisions of EagerOperation::Execute that only depend on
+  // eager::PlacementCacheKey. Like the device cache, the placement cache is
+  // cleared whenever the set of devices changes.
+  struct CachedPlacement {
+    // The device of the op's resource inputs, if the op is pinned to it.
+    Device* resource_device = nullptr;
+    // Whether the op is pinned to the CPU if its inputs are small integers.
+    bool pinnable_to_cpu = false;
+  };
+  bool GetCachedPlacement(Fprint128 placement_key, CachedPlacement* placement);
+  void AddPlacementToCache(Fprint128 placement_key,
+                           const CachedPlacement& placement);
+
+  // A kernel that runs a sequence of ops as one function, see
+  // AsyncExecuteNode::RunBatch().
+  struct FusedKernel : public core::RefCounted {
+    // The library `kernel` is instantiated from.
+    std::unique_ptr<FunctionLibraryDefinition> lib_def;
+    core::RefCountPtr<KernelAndDevice> kernel;
+  };
+
+  // Returns the fused kernel for the op sequence with signature `key`, made of
+  // the ops run by `op_kernels`. If there is none, returns nullptr and sets
+  // `*num_uses` to the number of times the sequence has been looked up, or to
+  // 0 if it cannot be fused.
+  core::RefCountPtr<FusedKernel> GetFusedKernel(
+      const Fprint128& key, absl::Span<KernelAndDevice* const> op_kernels,
+      int64_t* num_uses);
+  // Caches `fused` as the fused kernel for the op sequence with signature
+  // `key`. If `fused` is nullptr, the sequence is no longer fused.
+  void AddFusedKernel(const Fprint128& key, FusedKernel* fused);
+
   bool LogDevicePlacement() const { return log_device_placement_; }
   void SetLogDevicePlacement(bool enable) override {
     log_device_placement_ = enable;
@@ -308,6 +343,11 @@ class EagerContext : public ImmediateExecutionContext, public core::RefCounted {
   }
   bool LogMemory() const { return log_memory_; }
 
+  // Returns the pool that recycles the buffers of the tensors that eager ops
+  // allocate on the local device `device`, or nullptr if buffer recycling is
+  // disabled. The pool is valid for the lifetime of this context.
+  Allocator* GetBufferPool(Device* device);
+
   // Returns a borrowed pointer to the global rendezvous. The rendezvous may
   // become invalid if this Context is destroyed.
   Rendezvous* GetRendezvous() const { return rendezvous_.get(); }
@@ -783,16 +823,33 @@ class EagerContext : public ImmediateExecutionContext, public core::RefCounted {
 
     std::unique_ptr<std::vector<Fprint128>> cached_kernel_keys;
   };
-  std::unordered_map<Fprint128, core::RefCountPtr<KernelAndDevice>,
-                     Fprint128Hasher>
-      kernel_cache_ TF_GUARDED_BY(cache_mu_);
+  // Lookups do not take `cache_mu_`, which is held while kernels are added
+  // or removed to keep `registered_functions_` consistent with the cache.
+  KernelCache kernel_cache_;
   std::unordered_map<string, RegisteredFunction*> registered_functions_
       TF_GUARDED_BY(cache_mu_);
 
+  // An op sequence that is a candidate for fusion.
+  struct FusionCandidate {
+    // The number of lookups of the sequence, or -1 if it cannot be fused.
+    int64_t num_uses = 0;
+    // The kernels of the sequence, whose addresses are part of its signature.
+    // Holding them keeps the addresses from being reused.
+    std::vector<core::RefCountPtr<KernelAndDevice>> op_kernels;
+    core::RefCountPtr<FusedKernel> fused;
+  };
+  // The fused kernel cache has its own lock, since it is used by the async
+  // executors, which the kernel cache lock waits for.
+  mutex fused_kernels_mu_;
+  absl::flat_hash_map<Fprint128, FusionCandidate, Fprint128Hasher>
+      fused_kernels_ TF_GUARDED_BY(fused_kernels_mu_);
+
   std::unordered_map<string, std::unique_ptr<FunctionLibraryDefinition>>
       component_function_libraries_ TF_GUARDED_BY(cache_mu_);
   absl::flat_hash_map<Fprint128, Device*, Fprint128Hasher> device_cache_
       TF_GUARDED_BY(device_cache_mu_);
+  absl::flat_hash_map<Fprint128, CachedPlacement, Fprint128Hasher>
+      placement_cache_ TF_GUARDED_BY(device_cache_mu_);
   std::unordered_map<std::string, std::vector<std::function<void()>>>
       remove_function_notifiers_ TF_GUARDED_BY(remove_function_notifiers_mu_);
 
@@ -819,6 +876,14 @@ class EagerContext : public ImmediateExecutionContext, public core::RefCounted {
 
   const bool log_memory_;
 
+  // The maximum number of idle bytes held by each buffer pool, or 0 if buffer
+  // recycling is disabled.
+  const int64_t buffer_pool_bytes_;
+  mutex buffer_pools_mu_;
+  // Released when this context is destroyed.
+  absl::flat_hash_map<Device*, TensorBufferPool*> buffer_pools_
+      TF_GUARDED_BY(buffer_pools_mu_);
+
   // The table of local rendezvous instances for intra-process communication.
   // This make sures only one local rendezvous instance exists per step id.
   LocalRendezvousCache local_rendezvous_cache_;
@@ -163,17 +163,28 @@ Status EagerOperation::Execute(absl::Span<AbstractTensorHandle*> retvals,
     }
   }
 
-  // Run eager placement logic.
+  // Run eager placement logic. The decisions that do not depend on the input
+  // values are cached for ops with the same attributes and input devices.
   class Device* device = std::get<class Device*>(Device());
   if (device == nullptr) {
-    TF_RETURN_IF_ERROR(eager::MaybePinToResourceDevice(&device, *this));
-  }
-  if (device == nullptr && ctx_.PinSmallOpsToCPU()) {
-    bool pin_to_cpu;
-    TF_RETURN_IF_ERROR(eager::MaybePinSmallOpsToCpu(
-        &pin_to_cpu, Name(), GetInputs(), ctx_.HostCPU()->name()));
-    if (pin_to_cpu) {
-      device = ctx_.HostCPU();
+    Fprint128 placement_key;
+    TF_RETURN_IF_ERROR(eager::PlacementCacheKey(this, &placement_key));
+    EagerContext::CachedPlacement placement;
+    if (!ctx_.GetCachedPlacement(placement_key, &placement)) {
+      TF_RETURN_IF_ERROR(
+          eager::MaybePinToResourceDevice(&placement.resource_device, *this));
+      placement.pinnable_to_cpu = eager::IsPinnableToCpu(Name());
+      ctx_.AddPlacementToCache(placement_key, placement);
+    }
+    device = placement.resource_device;
+    if (device == nullptr && placement.pinnable_to_cpu &&
+        ctx_.PinSmallOpsToCPU()) {
+      bool pin_to_cpu;
+      TF_RETURN_IF_ERROR(eager::AreSmallCpuIntegers(
+          &pin_to_cpu, Name(), GetInputs(), ctx_.HostCPU()->name()));
+      if (pin_to_cpu) {
+        device = ctx_.HostCPU();
+      }
     }
   }
 
@@ -19,6 +19,7 @@ limitations under the License.
 #include <functional>
 #include <memory>
 #include <utility>
+#include <vector>
 
 #include "tensorflow/core/lib/core/errors.h"
 #include "tensorflow/core/lib/gtl/cleanup.h"
@@ -32,6 +33,13 @@ bool IsAsyncWaitForRemoteFunctionEnabled() {
                                  true, &enabled));
   return enabled;
 }
+
+int64_t MaxBatchSize() {
+  int64_t max_batch_size = 0;
+  TF_CHECK_OK(
+      ReadInt64FromEnvVar("TF_EAGER_MAX_BATCH_SIZE", 0, &max_batch_size));
+  return max_batch_size;
+}
 }  // namespace
 
 EagerExecutor::EagerExecutor(bool async, bool enable_streaming_enqueue,
@@ -46,7 +54,8 @@ EagerExecutor::EagerExecutor(bool async, bool enable_streaming_enqueue,
       enable_async_wait_for_remote_function_(
           IsAsyncWaitForRemoteFunctionEnabled()),
       enable_streaming_enqueue_(enable_streaming_enqueue),
-      in_flight_nodes_limit_(in_flight_nodes_limit) {
+      in_flight_nodes_limit_(in_flight_nodes_limit),
+      max_batch_size_(MaxBatchSize()) {
   if (async && in_flight_nodes_limit_ > 0) {
     VLOG(4) << "EagerExecutor InFlightNodes limit is set to "
             << in_flight_nodes_limit_;
@@ -160,7 +169,7 @@ Status EagerExecutor::AddOrExecute(std::unique_ptr<EagerNode> node) {
     } else {
       status = status_;
       if (status.ok()) {
-        node_queue_.push(std::move(item));
+        node_queue_.push_back(std::move(item));
         // If there were no previous nodes pending, wake the run thread to
         // start processing requests again.
         if (node_queue_.size() == 1) {
@@ -256,7 +265,7 @@ void EagerExecutor::NodeDone(const core::RefCountPtr<NodeItem>& item,
     if (from_queue) {
       // Since this was from the async queue, pop it from the front of the queue
       DCHECK(!node_queue_.empty() && item.get() == node_queue_.front().get());
-      node_queue_.pop();
+      node_queue_.pop_front();
     } else if (async) {
       // If it is an Async node then we will find the node in the unfinished
       // nodes list. However we only notify if we are at the front of the list
@@ -290,7 +299,7 @@ void EagerExecutor::NodeDone(const core::RefCountPtr<NodeItem>& item,
       }
       while (!node_queue_.empty()) {
         items_to_destroy.push_front(std::move(node_queue_.front()));
-        node_queue_.pop();
+        node_queue_.pop_front();
       }
       for (auto& it : unfinished_nodes_) {
         items_to_destroy.push_front(std::move(it.second));
@@ -349,6 +358,7 @@ void EagerExecutor::Run() {
       gtl::MakeCleanup([this] { thread_exited_notification_.Notify(); });
   while (true) {
     core::RefCountPtr<NodeItem> curr_item;
+    std::vector<core::RefCountPtr<NodeItem>> batch;
     {
       tensorflow::mutex_lock l(node_queue_mutex_);
       while (node_queue_.empty() || !status_.ok()) {
@@ -364,7 +374,22 @@ void EagerExecutor::Run() {
       // and register a notification for its completion.
       curr_item.reset(node_queue_.front().get());
       curr_item->Ref();
+      // The nodes queued after the front node that can be run together with
+      // it are run as one batch.
+      const void* batch_key =
+          max_batch_size_ > 1 ? curr_item->node->BatchKey() : nullptr;
+      if (batch_key != nullptr) {
+        for (auto it = node_queue_.begin();
+             it != node_queue_.end() &&
+             static_cast<int64_t>(batch.size()) < max_batch_size_ &&
+             (*it)->node->BatchKey() == batch_key;
+             ++it) {
+          batch.emplace_back(it->get());
+          (*it)->Ref();
+        }
+      }
     }
+    if (batch.size() > 1 && RunBatch(batch) > 0) continue;
     Status status = RunItem(std::move(curr_item), /*from_queue=*/true);
     if (!status.ok()) {
       VLOG(1) << "Failed to run item: " << status;
@@ -425,6 +450,70 @@ Status EagerExecutor::RunItem(core::RefCountPtr<NodeItem> item,
   return status();
 }
 
+int EagerExecutor::RunBatch(
+    absl::Span<const core::RefCountPtr<NodeItem>> items) {
+  if (items[0]->node->AsAsync() != nullptr) {
+    return RunAsyncBatch(items);
+  }
+  std::vector<EagerNode*> nodes;
+  nodes.reserve(items.size());
+  for (const auto& item : items) {
+    nodes.push_back(item->node.get());
+  }
+  Status status;
+  const int num_run = items[0]->node->RunBatch(nodes, &status);
+  DVLOG(3) << "Ran a batch of " << num_run << " nodes starting at [id "
+           << items[0]->id << "] with status: " << status;
+  for (int i = 0; i < num_run; ++i) {
+    NodeDone(items[i], i + 1 < num_run ? absl::OkStatus() : status,
+             /*from_queue=*/true);
+  }
+  if (!status.ok()) {
+    VLOG(1) << "Failed to run batch: " << status;
+  }
+  return num_run;
+}
+
+int EagerExecutor::RunAsyncBatch(
+    absl::Span<const core::RefCountPtr<NodeItem>> items) {
+  AsyncRemoteExecuteNode* async_remote_node =
+      items[0]->node->AsAsyncRemoteExecuteNode();
+  if (enable_async_wait_for_remote_function_ && async_remote_node != nullptr &&
+      last_eager_client_ != nullptr &&
+      last_eager_client_ != async_remote_node->eager_client()) {
+    // RunItem() syncs the executors before switching to another client.
+    return 0;
+  }
+
+  std::vector<AsyncEagerNode*> nodes;
+  nodes.reserve(items.size());
+  auto scheduled = std::make_shared<std::vector<NodeItem*>>();
+  scheduled->reserve(items.size());
+  {
+    tensorflow::mutex_lock l(node_queue_mutex_);
+    if (!status_.ok()) return 0;
+    for (const auto& item : items) {
+      DCHECK(!node_queue_.empty() && item.get() == node_queue_.front().get());
+      item->state = NodeState::kSCHEDULED;
+      nodes.push_back(item->node->AsAsync());
+      // The reference is released by the done callback of the node.
+      item->Ref();
+      scheduled->push_back(item.get());
+      unfinished_nodes_.emplace_hint(unfinished_nodes_.end(), item->id,
+                                     std::move(node_queue_.front()));
+      node_queue_.pop_front();
+    }
+  }
+  DVLOG(3) << "Running a batch of " << nodes.size()
+           << " async nodes starting at [id " << items[0]->id << "]";
+  nodes[0]->RunBatchAsync(nodes, [this, scheduled](int i,
+                                                   const Status& status) {
+    core::RefCountPtr<NodeItem> item((*scheduled)[i]);
+    NodeDone(item, status, /*from_queue=*/false);
+  });
+  return items.size();
+}
+
 Status EagerExecutor::MoveToUnfinished(core::RefCountPtr<NodeItem> item,
                                        bool from_queue) {
   tensorflow::mutex_lock l(node_queue_mutex_);
@@ -434,7 +523,7 @@ Status EagerExecutor::MoveToUnfinished(core::RefCountPtr<NodeItem> item,
 
   if (from_queue) {
     DCHECK(!node_queue_.empty() && item.get() == node_queue_.front().get());
-    node_queue_.pop();
+    node_queue_.pop_front();
   }
 
   DVLOG(3) << "Add Node: [id " << item->id << "] to unfinished map.";
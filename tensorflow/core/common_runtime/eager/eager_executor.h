@@ -19,14 +19,15 @@ limitations under the License.
 #include <atomic>
 #include <cstddef>
 #include <functional>
+#include <deque>
 #include <map>
 #include <memory>
-#include <queue>
 #include <string>
 #include <unordered_map>
 #include <vector>
 
 #include "absl/container/flat_hash_map.h"
+#include "absl/types/span.h"
 #include "tensorflow/core/common_runtime/device_factory.h"
 #include "tensorflow/core/common_runtime/function.h"
 #include "tensorflow/core/common_runtime/rendezvous_mgr.h"
@@ -79,6 +80,20 @@ class EagerNode {
 
   // Indicates whether a node failure should make the executor unusable.
   virtual bool Fatal() const { return true; }
+
+  // Returns a non-null key iff this node can be run together with the nodes
+  // queued right after it that return the same key, see RunBatch(). Nodes
+  // with the same key must be of the same class.
+  virtual const void* BatchKey() const { return nullptr; }
+
+  // Runs a prefix of `batch`, which starts with this node, and returns the
+  // length of the prefix. Returns 0 if this node should be run on its own
+  // instead. `*status` is set to the status of the last node of the prefix;
+  // the nodes before it succeeded. Like Run(), a failing node must abort
+  // itself. Batches of AsyncEagerNodes are run by RunBatchAsync() instead.
+  virtual int RunBatch(absl::Span<EagerNode* const> batch, Status* status) {
+    return 0;
+  }
 };
 
 class AsyncEagerNode : public EagerNode {
@@ -88,6 +103,16 @@ class AsyncEagerNode : public EagerNode {
   // This node will be cleaned up once the done callback is called.
   virtual void RunAsync(StatusCallback done) = 0;
 
+  // Runs all of `batch`, which starts with this node and whose nodes all have
+  // the same BatchKey(). `done` is called once for every node, with its index
+  // in `batch` and its status. By default, the nodes are run one by one.
+  virtual void RunBatchAsync(absl::Span<AsyncEagerNode* const> batch,
+                             std::function<void(int, const Status&)> done) {
+    for (int i = 0; i < batch.size(); ++i) {
+      batch[i]->RunAsync([done, i](const Status& status) { done(i, status); });
+    }
+  }
+
   AsyncEagerNode* AsAsync() final { return this; }
 
   Status Run() final {
@@ -211,6 +236,10 @@ class EagerExecutor {
   void Run();
 
   Status RunItem(core::RefCountPtr<NodeItem> item, bool from_queue);
+  // Runs the queued `items`, which are at the front of the queue, as a
+  // batch. Returns the number of items that were run.
+  int RunBatch(absl::Span<const core::RefCountPtr<NodeItem>> items);
+  int RunAsyncBatch(absl::Span<const core::RefCountPtr<NodeItem>> items);
   Status MoveToUnfinished(core::RefCountPtr<NodeItem> item, bool from_queue);
 
   // The impl of WaitForAllPendingNodes
@@ -230,7 +259,7 @@ class EagerExecutor {
   condition_variable nodes_done_ TF_GUARDED_BY(node_queue_mutex_);
 
   // Queue of pending NodeItems. Ordered by NodeItem::id.
-  std::queue<core::RefCountPtr<NodeItem>> node_queue_
+  std::deque<core::RefCountPtr<NodeItem>> node_queue_
       TF_GUARDED_BY(node_queue_mutex_);
 
   // Ordered by NodeItem::id.
@@ -277,6 +306,10 @@ class EagerExecutor {
   // async nodes reach this number, enqueuing to the eager async queue is
   // blocked.
   const int64_t in_flight_nodes_limit_;
+
+  // The maximum number of queued nodes run as one batch, see
+  // EagerNode::RunBatch(). Batching is disabled if it is less than 2.
+  const int64_t max_batch_size_;
 };
 
 inline bool EagerExecutor::Async() const { return thread_ != nullptr; }
@@ -14,9 +14,13 @@ limitations under the License.
 ==============================================================================*/
 #include "tensorflow/core/common_runtime/eager/eager_executor.h"
 
+#include <cstdlib>
+#include <functional>
 #include <memory>
 #include <utility>
+#include <vector>
 
+#include "tensorflow/core/platform/notification.h"
 #include "tensorflow/core/platform/status.h"
 #include "tensorflow/core/platform/status_matchers.h"
 #include "tensorflow/core/platform/test.h"
@@ -102,6 +106,100 @@ class TestAsyncEagerNode : public AsyncEagerNode {
   Status run_return_status_;
 };
 
+// A node that blocks the executor until `notification` is notified.
+class BlockingEagerNode : public EagerNode {
+ public:
+  explicit BlockingEagerNode(Notification* notification)
+      : notification_(notification) {}
+
+  Status Run() override {
+    notification_->WaitForNotification();
+    return absl::OkStatus();
+  }
+  void Abort(Status status) override {}
+  string DebugString() const override { return "blockingEagerNode"; }
+
+ private:
+  Notification* notification_;
+};
+
+// A node that records how it is run. A batch of nodes fails at the node with
+// a non-OK `run_return_status`.
+class TestBatchEagerNode : public EagerNode {
+ public:
+  TestBatchEagerNode(std::vector<int>* batch_sizes, int* num_aborted,
+                     Status run_return_status = absl::OkStatus())
+      : batch_sizes_(batch_sizes),
+        num_aborted_(num_aborted),
+        run_return_status_(run_return_status) {}
+
+  Status Run() override {
+    batch_sizes_->push_back(1);
+    return run_return_status_;
+  }
+
+  const void* BatchKey() const override { return batch_sizes_; }
+
+  int RunBatch(absl::Span<EagerNode* const> batch, Status* status) override {
+    int num_run = 0;
+    for (EagerNode* node : batch) {
+      ++num_run;
+      *status = static_cast<TestBatchEagerNode*>(node)->run_return_status_;
+      if (!status->ok()) break;
+    }
+    batch_sizes_->push_back(num_run);
+    return num_run;
+  }
+
+  void Abort(Status status) override { ++*num_aborted_; }
+  string DebugString() const override { return "testBatchEagerNode"; }
+
+ private:
+  std::vector<int>* batch_sizes_;
+  int* num_aborted_;
+  Status run_return_status_;
+};
+
+// An async node whose batches complete when they are run.
+class TestAsyncBatchEagerNode : public AsyncEagerNode {
+ public:
+  TestAsyncBatchEagerNode(std::vector<int>* batch_sizes,
+                          Status run_return_status = absl::OkStatus())
+      : batch_sizes_(batch_sizes), run_return_status_(run_return_status) {}
+
+  void RunAsync(StatusCallback done) override {
+    batch_sizes_->push_back(1);
+    done(run_return_status_);
+  }
+
+  const void* BatchKey() const override { return batch_sizes_; }
+
+  void RunBatchAsync(absl::Span<AsyncEagerNode* const> batch,
+                     std::function<void(int, const Status&)> done) override {
+    batch_sizes_->push_back(batch.size());
+    for (int i = 0; i < batch.size(); ++i) {
+      done(i,
+           static_cast<TestAsyncBatchEagerNode*>(batch[i])->run_return_status_);
+    }
+  }
+
+  void Abort(Status status) override {}
+  string DebugString() const override { return "testAsyncBatchEagerNode"; }
+
+ private:
+  std::vector<int>* batch_sizes_;
+  Status run_return_status_;
+};
+
+std::unique_ptr<EagerExecutor> NewBatchingExecutor(int max_batch_size) {
+  setenv("TF_EAGER_MAX_BATCH_SIZE", std::to_string(max_batch_size).c_str(),
+         /*overwrite=*/1);
+  auto executor = std::make_unique<EagerExecutor>(
+      /*async=*/true, /*enable_streaming_enqueue=*/true);
+  unsetenv("TF_EAGER_MAX_BATCH_SIZE");
+  return executor;
+}
+
 TEST(EagerExecutorTest, TestSyncExecutorWithEagerNode) {
   auto sync_executor = std::make_unique<EagerExecutor>(
       /*async=*/false, /*enable_streaming_enqueue=*/true);
@@ -281,5 +379,65 @@ TEST(EagerExecutorTest, TestAsyncExecutorAddNodesAfterShutdown) {
       async_executor->AddOrExecute(std::move(node)),
       tensorflow::testing::StatusIs(tensorflow::error::FAILED_PRECONDITION));
 }
+
+TEST(EagerExecutorTest, TestAsyncExecutorRunsQueuedNodesInBatches) {
+  auto async_executor = NewBatchingExecutor(/*max_batch_size=*/4);
+  Notification notification;
+  std::vector<int> batch_sizes;
+  int num_aborted = 0;
+  TF_ASSERT_OK(async_executor->AddOrExecute(
+      std::make_unique<BlockingEagerNode>(&notification)));
+  for (int i = 0; i < 5; ++i) {
+    TF_ASSERT_OK(async_executor->AddOrExecute(
+        std::make_unique<TestBatchEagerNode>(&batch_sizes, &num_aborted)));
+  }
+  notification.Notify();
+  TF_ASSERT_OK(async_executor->WaitForAllPendingNodes());
+  // The last node is left alone, and is run on its own.
+  EXPECT_EQ(batch_sizes, std::vector<int>({4, 1}));
+  EXPECT_EQ(num_aborted, 0);
+}
+
+TEST(EagerExecutorTest, TestAsyncExecutorFailBatch) {
+  auto async_executor = NewBatchingExecutor(/*max_batch_size=*/8);
+  Notification notification;
+  std::vector<int> batch_sizes;
+  int num_aborted = 0;
+  TF_ASSERT_OK(async_executor->AddOrExecute(
+      std::make_unique<BlockingEagerNode>(&notification)));
+  for (int i = 0; i < 4; ++i) {
+    TF_ASSERT_OK(async_executor->AddOrExecute(
+        std::make_unique<TestBatchEagerNode>(
+            &batch_sizes, &num_aborted,
+            i == 1 ? errors::Internal("test") : absl::OkStatus())));
+  }
+  notification.Notify();
+  auto status = async_executor->WaitForAllPendingNodes();
+  ASSERT_EQ(status.code(), tensorflow::error::INTERNAL);
+  EXPECT_EQ(batch_sizes, std::vector<int>({2}));
+  // The nodes after the failed one are aborted.
+  EXPECT_EQ(num_aborted, 2);
+}
+
+TEST(EagerExecutorTest, TestAsyncExecutorRunsAsyncNodesInBatches) {
+  auto async_executor = NewBatchingExecutor(/*max_batch_size=*/3);
+  Notification notification;
+  std::vector<int> batch_sizes;
+  TF_ASSERT_OK(async_executor->AddOrExecute(
+      std::make_unique<BlockingEagerNode>(&notification)));
+  for (int i = 0; i < 7; ++i) {
+    TF_ASSERT_OK(async_executor->AddOrExecute(
+        std::make_unique<TestAsyncBatchEagerNode>(&batch_sizes)));
+  }
+  notification.Notify();
+  TF_ASSERT_OK(async_executor->WaitForAllPendingNodes());
+  EXPECT_EQ(batch_sizes, std::vector<int>({3, 3, 1}));
+
+  TF_ASSERT_OK(async_executor->AddOrExecute(
+      std::make_unique<TestAsyncBatchEagerNode>(&batch_sizes,
+                                                errors::Internal("test"))));
+  auto status = async_executor->WaitForAllPendingNodes();
+  ASSERT_EQ(status.code(), tensorflow::error::INTERNAL);
+}
 }  // namespace
 }  // namespace tensorflow
@@ -1550,7 +1550,8 @@ Status GetOrCreateKernelAndDevice(
               << ". Full node_def=" << ndef.DebugString();
       kernel.reset(new KernelAndDeviceOp(
           ctx.GetRendezvous(), ctx.LogMemory(), flr, runner,
-          ctx.GetCollectiveExecutorHandle(), ctx.HostCPU()));
+          ctx.GetCollectiveExecutorHandle(), ctx.HostCPU(),
+          device == nullptr ? nullptr : ctx.GetBufferPool(device)));
     }
 
     TF_RETURN_IF_ERROR(kernel->Init(ctx.LogDevicePlacement(), ndef,
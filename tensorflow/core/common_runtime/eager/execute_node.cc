@@ -14,9 +14,16 @@ limitations under the License.
 ==============================================================================*/
 #include "tensorflow/core/common_runtime/eager/execute_node.h"
 
+#include <vector>
+
+#include "absl/strings/str_cat.h"
 #include "xla/tsl/util/env_var.h"
 #include "tensorflow/core/common_runtime/eager/context.h"
+#include "tensorflow/core/framework/function.h"
+#include "tensorflow/core/framework/node_def_util.h"
+#include "tensorflow/core/framework/op.h"
 #include "tensorflow/core/lib/core/errors.h"
+#include "tensorflow/core/platform/fingerprint.h"
 
 namespace tensorflow {
 
@@ -143,4 +150,235 @@ Status ExecuteNodeArgs::GetLocalArg(const FunctionArgIndex& index,
   }
 }
 
+namespace {
+
+// The number of times an op sequence is run one op at a time before it is
+// fused.
+constexpr int64_t kMinUsesToFuse = 3;
+
+// The source of an input of a batch is either the index of an argument of the
+// batch, or `kOutputSource` plus the index of the producing node in the upper
+// half and the index of the output in the lower half.
+constexpr uint64 kOutputSource = uint64{1} << 63;
+
+uint64 OutputSource(int node, int output) {
+  return kOutputSource | (static_cast<uint64>(node) << 32) | output;
+}
+
+bool IsFusableType(DataType dtype) {
+  return !IsRefType(dtype) && dtype != DT_RESOURCE && dtype != DT_VARIANT;
+}
+
+}  // namespace
+
+const void* AsyncExecuteNode::BatchKey() const {
+  if (eager_func_params_.has_value() || graph_collector_ != nullptr ||
+      cancellation_manager_ != nullptr || kernel_->IsFunction() ||
+      kernel_->kernel() == nullptr) {
+    return nullptr;
+  }
+  return kernel_->device();
+}
+
+bool AsyncExecuteNode::IsFusable() const {
+  Device* device = kernel_->device();
+  for (int i = 0; i < inputs_.size(); ++i) {
+    if (!IsFusableType(kernel_->input_dtypes()[i]) ||
+        kernel_->InputDevice(i) != device ||
+        inputs_[i]->Type() != TensorHandle::LOCAL) {
+      return false;
+    }
+  }
+  for (int i = 0; i < retvals_.size(); ++i) {
+    if (!IsFusableType(kernel_->output_dtypes()[i]) ||
+        kernel_->OutputDevice(i) != device) {
+      return false;
+    }
+  }
+  return true;
+}
+
+int AsyncExecuteNode::RunBatch(absl::Span<EagerNode* const> batch,
+                               Status* status) {
+  // The signature of the prefix of `batch` that is fused: its device, and for
+  // every op, its kernel and the sources of its inputs.
+  std::vector<uint64> signature = {
+      reinterpret_cast<uint64>(kernel_->device())};
+  std::vector<AsyncExecuteNode*> nodes;
+  std::vector<KernelAndDevice*> op_kernels;
+  absl::InlinedVector<TensorHandle*, 4> args;
+  absl::flat_hash_map<TensorHandle*, uint64> sources;
+  for (EagerNode* eager_node : batch) {
+    // All nodes of `batch` have the same `BatchKey()`.
+    auto* node = static_cast<AsyncExecuteNode*>(eager_node);
+    if (node->ctx_ != ctx_ || !node->IsFusable()) break;
+    signature.push_back(reinterpret_cast<uint64>(node->kernel_.get()));
+    for (TensorHandle* input : node->inputs_) {
+      auto it = sources.find(input);
+      if (it == sources.end()) {
+        it = sources.emplace(input, args.size()).first;
+        args.push_back(input);
+      }
+      signature.push_back(it->second);
+    }
+    for (int i = 0; i < node->retvals_.size(); ++i) {
+      sources[node->retvals_[i]] = OutputSource(nodes.size(), i);
+    }
+    nodes.push_back(node);
+    op_kernels.push_back(node->kernel_.get());
+  }
+  if (nodes.size() < 2) return 0;
+
+  const Fprint128 key = Fingerprint128(
+      absl::string_view(reinterpret_cast<const char*>(signature.data()),
+                        signature.size() * sizeof(uint64)));
+  int64_t num_uses = 0;
+  core::RefCountPtr<EagerContext::FusedKernel> fused =
+      ctx_->GetFusedKernel(key, op_kernels, &num_uses);
+  if (fused == nullptr && num_uses >= kMinUsesToFuse) {
+    Status s = CreateFusedKernel(nodes, args, sources, key, &fused);
+    if (!s.ok()) {
+      VLOG(1) << "Unable to fuse " << nodes.size() << " ops starting with "
+              << kernel_->name() << ": " << s;
+      fused.reset();
+    }
+    ctx_->AddFusedKernel(key, fused.get());
+  }
+  if (fused == nullptr) {
+    for (int i = 0; i < nodes.size(); ++i) {
+      *status = nodes[i]->Run();
+      if (!status->ok()) return i + 1;
+    }
+    return nodes.size();
+  }
+
+  absl::InlinedVector<TensorHandle*, 4> retvals;
+  for (AsyncExecuteNode* node : nodes) {
+    retvals.insert(retvals.end(), node->retvals_.begin(),
+                   node->retvals_.end());
+  }
+  *status = EagerKernelExecute(ctx_, args, /*eager_func_params=*/std::nullopt,
+                               fused->kernel, /*graph_collector=*/nullptr,
+                               /*cancellation_manager=*/nullptr,
+                               absl::MakeSpan(retvals), stack_trace_);
+  if (!status->ok()) {
+    // The failure is reported for the first node, which aborts the others.
+    Abort(*status);
+    return 1;
+  }
+  return nodes.size();
+}
+
+Status AsyncExecuteNode::CreateFusedKernel(
+    absl::Span<AsyncExecuteNode* const> nodes,
+    absl::Span<TensorHandle* const> args,
+    const absl::flat_hash_map<TensorHandle*, uint64>& sources,
+    const Fprint128& key, core::RefCountPtr<EagerContext::FusedKernel>* fused) {
+  EagerContext* ctx = nodes[0]->ctx_;
+  Device* device = nodes[0]->kernel_->device();
+  FunctionDef fdef;
+  OpDef* signature = fdef.mutable_signature();
+  signature->set_name(absl::StrCat("__eager_fused_", absl::Hex(key.high64),
+                                   "_", absl::Hex(key.low64)));
+  for (int i = 0; i < args.size(); ++i) {
+    OpDef::ArgDef* arg = signature->add_input_arg();
+    arg->set_name(absl::StrCat("arg", i));
+    arg->set_type(args[i]->dtype);
+  }
+  // The names of the outputs of each node in the function body.
+  std::vector<std::vector<string>> output_names;
+  for (int n = 0; n < nodes.size(); ++n) {
+    const KernelAndDevice& kernel = *nodes[n]->kernel_;
+    const OpDef* op_def = nullptr;
+    TF_RETURN_IF_ERROR(
+        OpRegistry::Global()->LookUpOpDef(kernel.kernel()->type_string(),
+                                          &op_def));
+    if (op_def->is_stateful()) {
+      return errors::Unimplemented("Stateful op ", op_def->name(),
+                                   " cannot be fused.");
+    }
+    NodeDef* ndef = fdef.add_node_def();
+    *ndef = kernel.kernel()->def();
+    ndef->set_name(absl::StrCat("op", n));
+    ndef->set_device(device->name());
+    ndef->clear_input();
+    for (TensorHandle* input : nodes[n]->inputs_) {
+      const uint64 source = sources.at(input);
+      if (source & kOutputSource) {
+        ndef->add_input(output_names[(source & ~kOutputSource) >> 32]
+                                    [source & 0xffffffff]);
+      } else {
+        ndef->add_input(absl::StrCat("arg", source));
+      }
+    }
+    NameRangeMap output_ranges;
+    TF_RETURN_IF_ERROR(
+        NameRangesForNode(*ndef, *op_def, nullptr, &output_ranges));
+    std::vector<string>& names =
+        output_names.emplace_back(kernel.num_outputs());
+    for (const auto& range : output_ranges) {
+      for (int i = range.second.first; i < range.second.second; ++i) {
+        names[i] = absl::StrCat(ndef->name(), ":", range.first, ":",
+                                i - range.second.first);
+      }
+    }
+    for (int i = 0; i < names.size(); ++i) {
+      OpDef::ArgDef* ret = signature->add_output_arg();
+      ret->set_name(absl::StrCat("ret", signature->output_arg_size() - 1));
+      ret->set_type(kernel.output_dtypes()[i]);
+      (*fdef.mutable_ret())[ret->name()] = names[i];
+    }
+  }
+
+  core::RefCountPtr<EagerContext::FusedKernel> result(
+      new EagerContext::FusedKernel);
+  // The function is kept out of the context's library, so that it is neither
+  // visible to users nor serialized with the library.
+  result->lib_def = std::make_unique<FunctionLibraryDefinition>(
+      OpRegistry::Global(), FunctionDefLibrary());
+  TF_RETURN_IF_ERROR(result->lib_def->AddFunctionDef(fdef));
+
+  FunctionLibraryRuntime* flr = ctx->func_lib(device);
+  if (flr == nullptr) {
+    return errors::NotFound(
+        "Unable to find a FunctionLibraryRuntime corresponding to device ",
+        device->name());
+  }
+  auto runner = (flr->runner() != nullptr) ? flr->runner() : ctx->runner();
+  std::function<int64_t()> get_op_id = nullptr;
+#if !defined(IS_MOBILE_PLATFORM)
+  get_op_id = [ctx]() { return ctx->RemoteMgr()->NextOpId(); };
+#endif  // IS_MOBILE_PLATFORM
+  result->kernel.reset(new KernelAndDeviceFunc(
+      flr, ctx->pflr(), std::vector<Device*>(args.size(), device),
+      /*composite_devices=*/{}, /*input_resource_dtypes_and_shapes=*/{},
+      runner, ctx->GetCollectiveExecutorHandle(), ctx->HostCPU(),
+      signature->name(), /*outputs_on_op_device=*/false,
+      /*allow_small_function_optimizations=*/true,
+      /*allow_control_flow_sync_execution=*/true,
+      /*shape_inference_on_tfe_dialect_import=*/false,
+      /*int_args_and_retvals_on_device=*/false,
+      /*xla_compile_device_type=*/std::nullopt, ctx->AllowSoftPlacement(),
+      ctx->RendezvousFactory(), get_op_id));
+  NodeDef ndef;
+  ndef.set_name(signature->name());
+  ndef.set_op(signature->name());
+  ndef.set_device(device->name());
+  EagerFunctionParams params;
+  params.is_component_function = false;
+  params.func_lib_def_override = result->lib_def.get();
+  TF_RETURN_IF_ERROR(result->kernel->Init(ctx->LogDevicePlacement(), ndef,
+                                          /*graph_collector=*/nullptr,
+                                          params));
+  // The fused kernel must produce every output where the op did.
+  for (int i = 0; i < signature->output_arg_size(); ++i) {
+    if (result->kernel->OutputDevice(i) != device) {
+      return errors::Unimplemented("Output ", i, " of ", signature->name(),
+                                   " is not produced on ", device->name());
+    }
+  }
+  *fused = std::move(result);
+  return absl::OkStatus();
+}
+
 }  // namespace tensorflow
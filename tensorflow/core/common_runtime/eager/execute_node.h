@@ -233,7 +233,31 @@ class AsyncExecuteNode : public EagerNode {
     return out;
   }
 
+  // Nodes that run an op kernel on the same device can be batched.
+  const void* BatchKey() const override;
+
+  // Runs the longest prefix of `batch` whose ops can be run as one function.
+  // Once an op sequence, including how its ops feed each other, has been run
+  // a few times, it is fused into a function that is instantiated once and
+  // cached by the context. Until then, and for sequences that cannot be
+  // fused, the ops are run one by one.
+  int RunBatch(absl::Span<EagerNode* const> batch, Status* status) override;
+
  private:
+  // Returns true if the op of this node can be part of a fused kernel.
+  bool IsFusable() const;
+
+  // Creates a kernel running the ops of `nodes` as one function on their
+  // device. `args` are the inputs of the ops that are not produced by other
+  // ops of `nodes`. `sources` maps each input of the ops to its source, see
+  // RunBatch().
+  static Status CreateFusedKernel(
+      absl::Span<AsyncExecuteNode* const> nodes,
+      absl::Span<TensorHandle* const> args,
+      const absl::flat_hash_map<TensorHandle*, uint64>& sources,
+      const Fprint128& key,
+      core::RefCountPtr<EagerContext::FusedKernel>* fused);
+
   EagerContext* ctx_;
   absl::InlinedVector<TensorHandle*, 4> inputs_;
   const absl::optional<EagerFunctionParams> eager_func_params_;
@@ -317,6 +317,7 @@ Status KernelAndDeviceOp::Run(
   }
 
   params.log_memory = log_memory_;
+  params.buffer_pool_allocator = buffer_pool_;
 
   params.runner = get_runner();
 
@@ -214,11 +214,12 @@ class KernelAndDeviceOp final : public KernelAndDevice {
       FunctionLibraryRuntime* flr,
       std::function<void(std::function<void()>)>* runner,
       std::unique_ptr<CollectiveExecutor::Handle> collective_executor,
-      Device* host_cpu_device)
+      Device* host_cpu_device, Allocator* buffer_pool = nullptr)
       : KernelAndDevice(flr, runner, std::move(collective_executor),
                         host_cpu_device),
         rendezvous_(rendezvous),
-        log_memory_(log_memory) {}
+        log_memory_(log_memory),
+        buffer_pool_(buffer_pool) {}
 
   ~KernelAndDeviceOp() override = default;
 
@@ -272,6 +273,9 @@ class KernelAndDeviceOp final : public KernelAndDevice {
   Rendezvous* const rendezvous_;
   checkpoint::TensorSliceReaderCacheWrapper slice_reader_cache_;
   const bool log_memory_;
+  // If non-null, serves the allocations of the kernel that use default
+  // allocator attributes. Not owned.
+  Allocator* const buffer_pool_;
 };
 
 // Represents a multi-device function. Functions can also be run using
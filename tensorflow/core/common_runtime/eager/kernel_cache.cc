@@ -0,0 +1,76 @@
+/* Copyright 2024 The TensorFlow Authors. All Rights Reserved.
+
+Licensed under the Apache License, Version 2.0 (the "License");
+you may not use this file except in compliance with the License.
+You may obtain a copy of the License at
+
+    http://www.apache.org/licenses/LICENSE-2.0
+
+Unless required by applicable law or agreed to in writing, software
+distributed under the License is distributed on an "AS IS" BASIS,
+WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+See the License for the specific language governing permissions and
+limitations under the License.
+==============================================================================*/
+#include "tensorflow/core/common_runtime/eager/kernel_cache.h"
+
+#include <utility>
+
+namespace tensorflow {
+
+core::RefCountPtr<KernelAndDevice> KernelCache::Lookup(
+    const Fprint128& key) const {
+  const Shard& shard = ShardFor(key);
+  tf_shared_lock l(shard.mu);
+  auto iter = shard.kernels.find(key);
+  if (iter == shard.kernels.end()) {
+    return nullptr;
+  }
+  return iter->second.GetNewRef();
+}
+
+core::RefCountPtr<KernelAndDevice> KernelCache::Insert(const Fprint128& key,
+                                                       KernelAndDevice* kernel,
+                                                       bool* inserted) {
+  Shard& shard = ShardFor(key);
+  mutex_lock l(shard.mu);
+  auto iter = shard.kernels.find(key);
+  *inserted = iter == shard.kernels.end();
+  if (*inserted) {
+    kernel->Ref();
+    iter = shard.kernels.emplace(key, kernel).first;
+  }
+  return iter->second.GetNewRef();
+}
+
+void KernelCache::Erase(const Fprint128& key) {
+  core::RefCountPtr<KernelAndDevice> kernel;
+  Shard& shard = ShardFor(key);
+  mutex_lock l(shard.mu);
+  auto iter = shard.kernels.find(key);
+  if (iter != shard.kernels.end()) {
+    kernel = std::move(iter->second);
+    shard.kernels.erase(iter);
+  }
+}
+
+void KernelCache::Clear() {
+  for (Shard& shard : shards_) {
+    KernelMap kernels;
+    {
+      mutex_lock l(shard.mu);
+      kernels.swap(shard.kernels);
+    }
+  }
+}
+
+size_t KernelCache::Size() const {
+  size_t size = 0;
+  for (const Shard& shard : shards_) {
+    tf_shared_lock l(shard.mu);
+    size += shard.kernels.size();
+  }
+  return size;
+}
+
+}  // namespace tensorflow
@@ -0,0 +1,82 @@
+/* Copyright 2024 The TensorFlow Authors. All Rights Reserved.
+
+Licensed under the Apache License, Version 2.0 (the "License");
+you may not use this file except in compliance with the License.
+You may obtain a copy of the License at
+
+    http://www.apache.org/licenses/LICENSE-2.0
+
+Unless required by applicable law or agreed to in writing, software
+distributed under the License is distributed on an "AS IS" BASIS,
+WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+See the License for the specific language governing permissions and
+limitations under the License.
+==============================================================================*/
+#ifndef TENSORFLOW_CORE_COMMON_RUNTIME_EAGER_KERNEL_CACHE_H_
+#define TENSORFLOW_CORE_COMMON_RUNTIME_EAGER_KERNEL_CACHE_H_
+
+#include <array>
+#include <cstddef>
+#include <unordered_map>
+
+#include "tensorflow/core/common_runtime/eager/kernel_and_device.h"
+#include "tensorflow/core/platform/fingerprint.h"
+#include "tensorflow/core/platform/mutex.h"
+#include "tensorflow/core/platform/refcount.h"
+#include "tensorflow/core/platform/thread_annotations.h"
+
+namespace tensorflow {
+
+// A map from kernel cache keys to the kernels of an `EagerContext`.
+//
+// Every eager op looks up its kernel, from as many threads as issue ops, while
+// kernels are only added on cache misses. The map is split into shards, each
+// with its own reader lock, so that concurrent lookups of different kernels do
+// not contend on a single lock. Kernels are destroyed outside of the locks.
+class KernelCache {
+ public:
+  KernelCache() = default;
+
+  // Returns a new reference to the kernel cached for `key`, or nullptr.
+  core::RefCountPtr<KernelAndDevice> Lookup(const Fprint128& key) const;
+
+  // Caches `kernel` for `key`, unless a kernel is already cached for it.
+  // Returns a new reference to the cached kernel, and sets `*inserted` to
+  // whether it is `kernel`.
+  core::RefCountPtr<KernelAndDevice> Insert(const Fprint128& key,
+                                            KernelAndDevice* kernel,
+                                            bool* inserted);
+
+  void Erase(const Fprint128& key);
+  void Clear();
+
+  size_t Size() const;
+
+ private:
+  static constexpr int kNumShards = 16;
+
+  using KernelMap =
+      std::unordered_map<Fprint128, core::RefCountPtr<KernelAndDevice>,
+                         Fprint128Hasher>;
+
+  struct alignas(64) Shard {
+    mutable mutex mu;
+    KernelMap kernels TF_GUARDED_BY(mu);
+  };
+
+  const Shard& ShardFor(const Fprint128& key) const {
+    return shards_[key.low64 % kNumShards];
+  }
+  Shard& ShardFor(const Fprint128& key) {
+    return shards_[key.low64 % kNumShards];
+  }
+
+  std::array<Shard, kNumShards> shards_;
+
+  KernelCache(const KernelCache&) = delete;
+  void operator=(const KernelCache&) = delete;
+};
+
+}  // namespace tensorflow
+
+#endif  // TENSORFLOW_CORE_COMMON_RUNTIME_EAGER_KERNEL_CACHE_H_
@@ -0,0 +1,104 @@
+/* Copyright 2024 The TensorFlow Authors. All Rights Reserved.
+
+Licensed under the Apache License, Version 2.0 (the "License");
+you may not use this file except in compliance with the License.
+You may obtain a copy of the License at
+
+    http://www.apache.org/licenses/LICENSE-2.0
+
+Unless required by applicable law or agreed to in writing, software
+distributed under the License is distributed on an "AS IS" BASIS,
+WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+See the License for the specific language governing permissions and
+limitations under the License.
+==============================================================================*/
+#include "tensorflow/core/common_runtime/eager/kernel_cache.h"
+
+#include <vector>
+
+#include "tensorflow/core/common_runtime/eager/kernel_and_device.h"
+#include "tensorflow/core/platform/env.h"
+#include "tensorflow/core/platform/test.h"
+#include "tensorflow/core/platform/threadpool.h"
+
+namespace tensorflow {
+namespace {
+
+core::RefCountPtr<KernelAndDevice> NewKernel() {
+  return core::RefCountPtr<KernelAndDevice>(new KernelAndDeviceOp(
+      /*rendezvous=*/nullptr, /*log_memory=*/false, /*flr=*/nullptr,
+      /*runner=*/nullptr, /*collective_executor=*/nullptr,
+      /*host_cpu_device=*/nullptr));
+}
+
+TEST(KernelCacheTest, InsertLookupErase) {
+  KernelCache cache;
+  const Fprint128 key = {1, 2};
+  EXPECT_EQ(nullptr, cache.Lookup(key));
+
+  core::RefCountPtr<KernelAndDevice> kernel = NewKernel();
+  bool inserted = false;
+  EXPECT_EQ(kernel.get(), cache.Insert(key, kernel.get(), &inserted).get());
+  EXPECT_TRUE(inserted);
+  EXPECT_EQ(kernel.get(), cache.Lookup(key).get());
+
+  // Inserting another kernel for the same key returns the cached one.
+  core::RefCountPtr<KernelAndDevice> other = NewKernel();
+  EXPECT_EQ(kernel.get(), cache.Insert(key, other.get(), &inserted).get());
+  EXPECT_FALSE(inserted);
+  EXPECT_TRUE(other->RefCountIsOne());
+  EXPECT_EQ(1, cache.Size());
+
+  cache.Erase(key);
+  EXPECT_EQ(nullptr, cache.Lookup(key));
+  EXPECT_EQ(0, cache.Size());
+  EXPECT_TRUE(kernel->RefCountIsOne());
+}
+
+TEST(KernelCacheTest, Clear) {
+  KernelCache cache;
+  std::vector<core::RefCountPtr<KernelAndDevice>> kernels;
+  bool inserted = false;
+  for (uint64 i = 0; i < 100; ++i) {
+    kernels.push_back(NewKernel());
+    cache.Insert({i, i}, kernels.back().get(), &inserted);
+  }
+  EXPECT_EQ(100, cache.Size());
+  cache.Clear();
+  EXPECT_EQ(0, cache.Size());
+  for (const auto& kernel : kernels) {
+    EXPECT_TRUE(kernel->RefCountIsOne());
+  }
+}
+
+TEST(KernelCacheTest, ConcurrentLookups) {
+  constexpr int kNumThreads = 8;
+  constexpr int kNumKeys = 64;
+  KernelCache cache;
+  std::vector<core::RefCountPtr<KernelAndDevice>> kernels;
+  for (uint64 i = 0; i < kNumKeys; ++i) {
+    kernels.push_back(NewKernel());
+  }
+  {
+    thread::ThreadPool pool(Env::Default(), "test", kNumThreads);
+    for (int t = 0; t < kNumThreads; ++t) {
+      pool.Schedule([&cache, &kernels]() {
+        for (int round = 0; round < 100; ++round) {
+          for (uint64 i = 0; i < kNumKeys; ++i) {
+            core::RefCountPtr<KernelAndDevice> kernel =
+                cache.Lookup({i, i * 7});
+            if (kernel == nullptr) {
+              bool inserted = false;
+              kernel = cache.Insert({i, i * 7}, kernels[i].get(), &inserted);
+            }
+            EXPECT_EQ(kernels[i].get(), kernel.get());
+          }
+        }
+      });
+    }
+  }
+  EXPECT_EQ(kNumKeys, cache.Size());
+}
+
+}  // namespace
+}  // namespace tensorflow
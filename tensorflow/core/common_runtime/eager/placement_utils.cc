@@ -84,12 +84,22 @@ Status MaybePinSmallOpsToCpu(
     bool* result, StringPiece op_name,
     absl::Span<ImmediateExecutionTensorHandle* const> args,
     StringPiece cpu_device_name) {
-  if (IsFunction(op_name) || IsColocationExempt(op_name) ||
-      !IsPinnableOp(op_name)) {
+  if (!IsPinnableToCpu(op_name)) {
     *result = false;
     return absl::OkStatus();
   }
+  return AreSmallCpuIntegers(result, op_name, args, cpu_device_name);
+}
+
+bool IsPinnableToCpu(StringPiece op_name) {
+  return !IsFunction(op_name) && !IsColocationExempt(op_name) &&
+         IsPinnableOp(op_name);
+}
 
+Status AreSmallCpuIntegers(
+    bool* result, StringPiece op_name,
+    absl::Span<ImmediateExecutionTensorHandle* const> args,
+    StringPiece cpu_device_name) {
   // Ops without inputs are usually ops that generate a tensor in some way and
   // usually require being present on whatever device they are scheduled on
   // - for e.g. VarHandleOp or _Recv).
@@ -180,5 +190,24 @@ Status MaybePinToResourceDevice(Device** device, const EagerOperation& op) {
   return absl::OkStatus();
 }
 
+Status PlacementCacheKey(EagerOperation* op, Fprint128* key) {
+  const absl::InlinedVector<TensorHandle*, 4>* inputs;
+  TF_RETURN_IF_ERROR(op->TensorHandleInputs(&inputs));
+  Fprint128 f = op->MutableAttrs()->CacheKey(op->DeviceName());
+  f = tsl::FingerprintCat128(f, inputs->size());
+  for (TensorHandle* input : *inputs) {
+    f = tsl::FingerprintCat128(f, reinterpret_cast<uintptr_t>(input->device()));
+    f = tsl::FingerprintCat128(f, input->dtype);
+    if (input->dtype == DT_RESOURCE) {
+      f = tsl::FingerprintCat128(
+          f, reinterpret_cast<uintptr_t>(input->resource_device()));
+      f = tsl::FingerprintCat128(f,
+                                 input->resource_remote_device_incarnation());
+    }
+  }
+  *key = f;
+  return absl::OkStatus();
+}
+
 }  // namespace eager
 }  // namespace tensorflow
@@ -18,6 +18,7 @@ limitations under the License.
 
 #include "tensorflow/c/eager/immediate_execution_operation.h"
 #include "tensorflow/core/common_runtime/eager/context.h"
+#include "tensorflow/core/platform/fingerprint.h"
 #include "tensorflow/core/platform/status.h"
 #include "tensorflow/core/platform/stringpiece.h"
 
@@ -38,10 +39,25 @@ Status MaybePinSmallOpsToCpu(
     absl::Span<ImmediateExecutionTensorHandle* const> args,
     StringPiece cpu_device_name);
 
+// The two parts of MaybePinSmallOpsToCpu: whether op `op_name` can be pinned
+// at all, and whether `args` are all small integers on the CPU.
+bool IsPinnableToCpu(StringPiece op_name);
+Status AreSmallCpuIntegers(
+    bool* result, StringPiece op_name,
+    absl::Span<ImmediateExecutionTensorHandle* const> args,
+    StringPiece cpu_device_name);
+
 // If a resource touching input is specified, all resource-touching ops run in
 // the device the resource is, regardless of anything else that has been
 // specified. This is identical to the graph mode behavior.
 Status MaybePinToResourceDevice(Device** device, const EagerOperation& op);
+
+// Computes in `*key` a fingerprint of everything that MaybePinToResourceDevice
+// and IsPinnableToCpu base their decision on for `op`: its name, attributes
+// and requested device, and the devices and dtypes of its inputs. Ops with the
+// same key get the same decisions, which can thus be cached in the
+// EagerContext.
+Status PlacementCacheKey(EagerOperation* op, Fprint128* key);
 }  // namespace eager
 }  // namespace tensorflow
 
@@ -200,6 +200,37 @@ INSTANTIATE_TEST_SUITE_P(
       return info.param.test_name;
     });
 
+TEST(PlacementUtilsTest, PlacementCacheKey) {
+  std::vector<std::unique_ptr<Device>> local_devices;
+  CreateLocalDeviceVector(local_devices);
+  StaticDeviceMgr local_device_mgr(std::move(local_devices));
+  core::RefCountPtr<EagerContext> context(new EagerContext(
+      SessionOptions(),
+      tensorflow::ContextDevicePlacementPolicy::DEVICE_PLACEMENT_EXPLICIT,
+      false, &local_device_mgr, false, nullptr, nullptr, nullptr,
+      /*run_eager_op_as_function=*/true));
+  auto ctx = context.get();
+
+  auto key_for = [ctx](const char* op_name, DataType dtype,
+                       const char* input_device) {
+    auto op = EagerOperation(ctx);
+    TF_CHECK_OK(op.Reset(op_name, DEVICE_CPU0));
+    Tensor input_tensor(dtype, {});
+    auto input = core::RefCountPtr<ImmediateExecutionTensorHandle>(
+        ctx->CreateLocalHandleFromTFTensor(input_tensor, input_device));
+    TF_CHECK_OK(op.AddInput(input.get()));
+    Fprint128 key;
+    TF_CHECK_OK(eager::PlacementCacheKey(&op, &key));
+    return key;
+  };
+
+  const Fprint128 key = key_for("Identity", DT_INT64, DEVICE_CPU0);
+  EXPECT_TRUE(key == key_for("Identity", DT_INT64, DEVICE_CPU0));
+  EXPECT_FALSE(key == key_for("Identity", DT_INT64, DEVICE_GPU0));
+  EXPECT_FALSE(key == key_for("Identity", DT_INT32, DEVICE_CPU0));
+  EXPECT_FALSE(key == key_for("Neg", DT_INT64, DEVICE_CPU0));
+}
+
 TEST(PlacementUtilsTest, MaybePinToResourceDevice_OtherDevice) {
   StaticDeviceMgr device_mgr(
       DeviceFactory::NewDevice("CPU", {}, "/job:localhost/replica:0/task:0"));
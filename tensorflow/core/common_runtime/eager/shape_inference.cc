@@ -20,6 +20,8 @@ limitations under the License.
 #include "tensorflow/core/common_runtime/eager/tensor_handle.h"
 #include "tensorflow/core/framework/op.h"
 #include "tensorflow/core/framework/shape_inference.h"
+#include "tensorflow/core/framework/tensor.h"
+#include "tensorflow/core/framework/types.pb.h"
 #include "tensorflow/core/public/version.h"
 
 namespace tensorflow {
@@ -36,9 +38,17 @@ Status RunShapeInference(const NodeDef& ndef,
   TF_RETURN_IF_ERROR(lib_def.LookUp(ndef.op(), &op_reg_data));
   if (op_reg_data->shape_inference_fn == nullptr) return absl::OkStatus();
 
+  // Input values that are known before the inputs are ready let shape
+  // functions that read them (e.g. the shape argument of Reshape) infer the
+  // output shapes without waiting for the inputs.
+  std::vector<const Tensor*> input_tensors(inputs.size());
+  for (size_t i = 0; i < inputs.size(); i++) {
+    input_tensors[i] = inputs[i]->InferenceValue();
+  }
   shape_inference::InferenceContext ic(
       TF_GRAPH_DEF_VERSION, ndef, op_reg_data->op_def,
-      std::vector<shape_inference::ShapeHandle>(inputs.size()), {}, {}, {});
+      std::vector<shape_inference::ShapeHandle>(inputs.size()), input_tensors,
+      {}, {});
   for (size_t i = 0; i < inputs.size(); i++) {
     shape_inference::ShapeHandle shape;
     TF_RETURN_IF_ERROR(inputs[i]->InferenceShape(&ic, &shape));
@@ -51,6 +61,22 @@ Status RunShapeInference(const NodeDef& ndef,
     shape_inference::ShapeHandle shape_handle = ic.output(i);
     retvals[i]->SetInferenceShape(&ic, shape_handle);
   }
+  // The value of Shape is known as soon as the shape of its input is, so that
+  // e.g. `Reshape(x, Shape(y))` does not need to wait for `y`.
+  if (ndef.op() == "Shape" && ic.num_inputs() == 1 &&
+      ic.FullyDefined(ic.input(0))) {
+    const int rank = ic.Rank(ic.input(0));
+    Tensor value(retvals[0]->dtype, TensorShape({rank}));
+    for (int d = 0; d < rank; d++) {
+      const int64_t dim_size = ic.Value(ic.Dim(ic.input(0), d));
+      if (value.dtype() == DT_INT32) {
+        value.vec<int32>()(d) = static_cast<int32>(dim_size);
+      } else {
+        value.vec<int64_t>()(d) = dim_size;
+      }
+    }
+    retvals[0]->SetInferenceValue(value);
+  }
   // TODO(slebedev): populate TensorHandle::handle_dtypes_and_shapes.
   return absl::OkStatus();
 }
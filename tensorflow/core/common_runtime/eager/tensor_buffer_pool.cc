@@ -0,0 +1,161 @@
+/* Copyright 2024 The TensorFlow Authors. All Rights Reserved.
+
+Licensed under the Apache License, Version 2.0 (the "License");
+you may not use this file except in compliance with the License.
+You may obtain a copy of the License at
+
+    http://www.apache.org/licenses/LICENSE-2.0
+
+Unless required by applicable law or agreed to in writing, software
+distributed under the License is distributed on an "AS IS" BASIS,
+WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+See the License for the specific language governing permissions and
+limitations under the License.
+==============================================================================*/
+#include "tensorflow/core/common_runtime/eager/tensor_buffer_pool.h"
+
+#include "tensorflow/core/lib/core/bits.h"
+
+namespace tensorflow {
+
+namespace {
+
+// The smallest size class.
+constexpr size_t kMinRoundedSize = 256;
+
+}  // namespace
+
+TensorBufferPool::TensorBufferPool(Allocator* base, size_t max_pooled_bytes)
+    : base_(base), max_pooled_bytes_(max_pooled_bytes) {}
+
+TensorBufferPool::~TensorBufferPool() {}
+
+void TensorBufferPool::Release() {
+  std::vector<void*> buffers;
+  {
+    mutex_lock l(mu_);
+    released_ = true;
+    FlushLocked(&buffers);
+  }
+  for (void* ptr : buffers) base_->DeallocateRaw(ptr);
+  Unref();
+}
+
+void TensorBufferPool::Flush() {
+  std::vector<void*> buffers;
+  {
+    mutex_lock l(mu_);
+    FlushLocked(&buffers);
+  }
+  for (void* ptr : buffers) base_->DeallocateRaw(ptr);
+}
+
+void TensorBufferPool::FlushLocked(std::vector<void*>* buffers) {
+  for (auto& it : free_buffers_) {
+    buffers->insert(buffers->end(), it.second.begin(), it.second.end());
+  }
+  free_buffers_.clear();
+  pooled_bytes_ = 0;
+}
+
+void TensorBufferPool::Unref() {
+  if (refs_.fetch_sub(1, std::memory_order_acq_rel) == 1) {
+    delete this;
+  }
+}
+
+size_t TensorBufferPool::RoundedSize(size_t num_bytes) {
+  if (num_bytes <= kMinRoundedSize) return kMinRoundedSize;
+  // Four size classes per power of two.
+  const size_t unit = size_t{1} << (Log2Floor64(num_bytes - 1) - 2);
+  return (num_bytes + unit - 1) & ~(unit - 1);
+}
+
+void* TensorBufferPool::AllocateRaw(size_t alignment, size_t num_bytes) {
+  return AllocateRaw(alignment, num_bytes, AllocationAttributes());
+}
+
+void* TensorBufferPool::AllocateRaw(
+    size_t alignment, size_t num_bytes,
+    const AllocationAttributes& allocation_attr) {
+  if (num_bytes == 0 || num_bytes > max_pooled_bytes_ ||
+      alignment > Allocator::kAllocatorAlignment ||
+      allocation_attr.freed_by_func != nullptr) {
+    void* ptr = AllocateFromBase(alignment, num_bytes, allocation_attr);
+    if (ptr != nullptr) refs_.fetch_add(1, std::memory_order_relaxed);
+    return ptr;
+  }
+
+  const size_t rounded_size = RoundedSize(num_bytes);
+  {
+    mutex_lock l(mu_);
+    auto it = free_buffers_.find(rounded_size);
+    if (it != free_buffers_.end() && !it->second.empty()) {
+      void* ptr = it->second.back();
+      it->second.pop_back();
+      pooled_bytes_ -= rounded_size;
+      live_buffers_[ptr] = rounded_size;
+      ++num_hits_;
+      refs_.fetch_add(1, std::memory_order_relaxed);
+      return ptr;
+    }
+    ++num_misses_;
+  }
+  void* ptr = AllocateFromBase(Allocator::kAllocatorAlignment, rounded_size,
+                               allocation_attr);
+  if (ptr == nullptr) return nullptr;
+  refs_.fetch_add(1, std::memory_order_relaxed);
+  mutex_lock l(mu_);
+  live_buffers_[ptr] = rounded_size;
+  return ptr;
+}
+
+void* TensorBufferPool::AllocateFromBase(
+    size_t alignment, size_t num_bytes,
+    const AllocationAttributes& allocation_attr) {
+  bool has_idle_buffers;
+  {
+    mutex_lock l(mu_);
+    has_idle_buffers = pooled_bytes_ > 0;
+  }
+  if (has_idle_buffers) {
+    // Don't let the base allocator wait for memory that the pool is holding.
+    AllocationAttributes no_retry_attr(
+        /*retry_on_failure=*/false, allocation_attr.allocation_will_be_logged,
+        allocation_attr.freed_by_func);
+    void* ptr = base_->AllocateRaw(alignment, num_bytes, no_retry_attr);
+    if (ptr != nullptr) return ptr;
+    Flush();
+  }
+  return base_->AllocateRaw(alignment, num_bytes, allocation_attr);
+}
+
+void TensorBufferPool::DeallocateRaw(void* ptr) {
+  bool pooled = false;
+  {
+    mutex_lock l(mu_);
+    auto it = live_buffers_.find(ptr);
+    if (it != live_buffers_.end()) {
+      const size_t rounded_size = it->second;
+      live_buffers_.erase(it);
+      if (!released_ && pooled_bytes_ + rounded_size <= max_pooled_bytes_) {
+        free_buffers_[rounded_size].push_back(ptr);
+        pooled_bytes_ += rounded_size;
+        pooled = true;
+      }
+    }
+  }
+  if (!pooled) base_->DeallocateRaw(ptr);
+  Unref();
+}
+
+TensorBufferPool::Stats TensorBufferPool::GetPoolStats() {
+  mutex_lock l(mu_);
+  Stats stats;
+  stats.num_hits = num_hits_;
+  stats.num_misses = num_misses_;
+  stats.pooled_bytes = pooled_bytes_;
+  return stats;
+}
+
+}  // namespace tensorflow
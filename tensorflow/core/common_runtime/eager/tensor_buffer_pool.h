@@ -0,0 +1,135 @@
+/* Copyright 2024 The TensorFlow Authors. All Rights Reserved.
+
+Licensed under the Apache License, Version 2.0 (the "License");
+you may not use this file except in compliance with the License.
+You may obtain a copy of the License at
+
+    http://www.apache.org/licenses/LICENSE-2.0
+
+Unless required by applicable law or agreed to in writing, software
+distributed under the License is distributed on an "AS IS" BASIS,
+WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+See the License for the specific language governing permissions and
+limitations under the License.
+==============================================================================*/
+#ifndef TENSORFLOW_CORE_COMMON_RUNTIME_EAGER_TENSOR_BUFFER_POOL_H_
+#define TENSORFLOW_CORE_COMMON_RUNTIME_EAGER_TENSOR_BUFFER_POOL_H_
+
+#include <atomic>
+#include <string>
+#include <vector>
+
+#include "absl/container/flat_hash_map.h"
+#include "absl/types/optional.h"
+#include "tensorflow/core/framework/allocator.h"
+#include "tensorflow/core/platform/mutex.h"
+#include "tensorflow/core/platform/thread_annotations.h"
+#include "tensorflow/core/platform/types.h"
+
+namespace tensorflow {
+
+// An allocator that recycles the buffers of dead tensors for the next
+// allocations of a similar size, so that eager ops that allocate the same
+// shapes in every step of a training loop do not go through the device
+// allocator each time.
+//
+// Requests are rounded up to one of four size classes per power of two, so
+// buffers of any dtype and shape with the same rounded size are
+// interchangeable. When a buffer is deallocated, it is kept in the free list
+// of its size class as long as the idle bytes held by the pool stay within
+// `max_pooled_bytes`; otherwise it is returned to the base allocator.
+//
+// Requests larger than `max_pooled_bytes`, with an alignment larger than
+// `Allocator::kAllocatorAlignment`, or with a `freed_by_func` bypass the pool.
+// If the base allocator fails while the pool holds idle buffers, they are
+// returned to it and the allocation is retried.
+//
+// A `TensorBufferPool` deletes itself once `Release()` has been called and
+// all of the memory that was allocated through it has been deallocated.
+class TensorBufferPool : public Allocator {
+ public:
+  struct Stats {
+    // The number of allocations served from and not from a free list.
+    int64_t num_hits = 0;
+    int64_t num_misses = 0;
+    // The bytes held in free lists.
+    int64_t pooled_bytes = 0;
+  };
+
+  TensorBufferPool(Allocator* base, size_t max_pooled_bytes);
+
+  // Returns the idle buffers to the base allocator and releases the owner's
+  // reference. `this` must not be used for new allocations after this call.
+  void Release();
+
+  // Returns all idle buffers to the base allocator.
+  void Flush();
+
+  std::string Name() override { return base_->Name(); }
+  void* AllocateRaw(size_t alignment, size_t num_bytes) override;
+  void* AllocateRaw(size_t alignment, size_t num_bytes,
+                    const AllocationAttributes& allocation_attr) override;
+  void DeallocateRaw(void* ptr) override;
+  bool TracksAllocationSizes() const override {
+    return base_->TracksAllocationSizes();
+  }
+  size_t RequestedSize(const void* ptr) const override {
+    return base_->RequestedSize(ptr);
+  }
+  size_t AllocatedSize(const void* ptr) const override {
+    return base_->AllocatedSize(ptr);
+  }
+  int64_t AllocationId(const void* ptr) const override {
+    return base_->AllocationId(ptr);
+  }
+  size_t AllocatedSizeSlow(const void* ptr) const override {
+    return base_->AllocatedSizeSlow(ptr);
+  }
+  absl::optional<AllocatorStats> GetStats() override {
+    return base_->GetStats();
+  }
+  AllocatorMemoryType GetMemoryType() const override {
+    return base_->GetMemoryType();
+  }
+
+  Allocator* base() const { return base_; }
+
+  Stats GetPoolStats();
+
+  // Returns the size class of an allocation of `num_bytes`.
+  static size_t RoundedSize(size_t num_bytes);
+
+ private:
+  ~TensorBufferPool() override;
+
+  void* AllocateFromBase(size_t alignment, size_t num_bytes,
+                         const AllocationAttributes& allocation_attr);
+  // Moves all idle buffers to `*buffers`.
+  void FlushLocked(std::vector<void*>* buffers)
+      TF_EXCLUSIVE_LOCKS_REQUIRED(mu_);
+  void Unref();
+
+  Allocator* const base_;
+  const size_t max_pooled_bytes_;
+
+  // One reference for the owner, plus one for each live allocation.
+  std::atomic<int64_t> refs_{1};
+
+  mutex mu_;
+  // The size class of each live buffer that may be recycled.
+  absl::flat_hash_map<const void*, size_t> live_buffers_ TF_GUARDED_BY(mu_);
+  // The idle buffers of each size class.
+  absl::flat_hash_map<size_t, std::vector<void*>> free_buffers_
+      TF_GUARDED_BY(mu_);
+  size_t pooled_bytes_ TF_GUARDED_BY(mu_) = 0;
+  bool released_ TF_GUARDED_BY(mu_) = false;
+  int64_t num_hits_ TF_GUARDED_BY(mu_) = 0;
+  int64_t num_misses_ TF_GUARDED_BY(mu_) = 0;
+
+  TensorBufferPool(const TensorBufferPool&) = delete;
+  void operator=(const TensorBufferPool&) = delete;
+};
+
+}  // namespace tensorflow
+
+#endif  // TENSORFLOW_CORE_COMMON_RUNTIME_EAGER_TENSOR_BUFFER_POOL_H_
@@ -0,0 +1,83 @@
+/* Copyright 2024 The TensorFlow Authors. All Rights Reserved.
+
+Licensed under the Apache License, Version 2.0 (the "License");
+you may not use this file except in compliance with the License.
+You may obtain a copy of the License at
+
+    http://www.apache.org/licenses/LICENSE-2.0
+
+Unless required by applicable law or agreed to in writing, software
+distributed under the License is distributed on an "AS IS" BASIS,
+WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+See the License for the specific language governing permissions and
+limitations under the License.
+==============================================================================*/
+#include "tensorflow/core/common_runtime/eager/tensor_buffer_pool.h"
+
+#include "tensorflow/core/framework/allocator.h"
+#include "tensorflow/core/framework/tensor.h"
+#include "tensorflow/core/platform/test.h"
+
+namespace tensorflow {
+namespace {
+
+TEST(TensorBufferPoolTest, RoundedSize) {
+  EXPECT_EQ(256, TensorBufferPool::RoundedSize(1));
+  EXPECT_EQ(256, TensorBufferPool::RoundedSize(256));
+  EXPECT_EQ(320, TensorBufferPool::RoundedSize(257));
+  EXPECT_EQ(512, TensorBufferPool::RoundedSize(512));
+  EXPECT_EQ(640, TensorBufferPool::RoundedSize(513));
+  EXPECT_EQ(5 << 20, TensorBufferPool::RoundedSize((4 << 20) + 1));
+}
+
+TEST(TensorBufferPoolTest, RecyclesBuffersOfTheSameSizeClass) {
+  TensorBufferPool* pool = new TensorBufferPool(cpu_allocator(), 1 << 20);
+  void* ptr = pool->AllocateRaw(Allocator::kAllocatorAlignment, 1000);
+  ASSERT_NE(nullptr, ptr);
+  pool->DeallocateRaw(ptr);
+  EXPECT_EQ(1024, pool->GetPoolStats().pooled_bytes);
+
+  // A different size in the same size class gets the same buffer back.
+  EXPECT_EQ(ptr, pool->AllocateRaw(Allocator::kAllocatorAlignment, 1020));
+  TensorBufferPool::Stats stats = pool->GetPoolStats();
+  EXPECT_EQ(1, stats.num_hits);
+  EXPECT_EQ(1, stats.num_misses);
+  EXPECT_EQ(0, stats.pooled_bytes);
+
+  // A different size class does not.
+  void* other = pool->AllocateRaw(Allocator::kAllocatorAlignment, 2000);
+  EXPECT_NE(ptr, other);
+  EXPECT_EQ(2, pool->GetPoolStats().num_misses);
+  pool->DeallocateRaw(ptr);
+  pool->DeallocateRaw(other);
+  pool->Release();
+}
+
+TEST(TensorBufferPoolTest, BoundsPooledBytes) {
+  TensorBufferPool* pool = new TensorBufferPool(cpu_allocator(), 4096);
+  void* a = pool->AllocateRaw(Allocator::kAllocatorAlignment, 3000);
+  void* b = pool->AllocateRaw(Allocator::kAllocatorAlignment, 3000);
+  // Too large to be pooled.
+  void* c = pool->AllocateRaw(Allocator::kAllocatorAlignment, 8192);
+  pool->DeallocateRaw(a);
+  pool->DeallocateRaw(b);
+  pool->DeallocateRaw(c);
+  EXPECT_EQ(3072, pool->GetPoolStats().pooled_bytes);
+  pool->Flush();
+  EXPECT_EQ(0, pool->GetPoolStats().pooled_bytes);
+  pool->Release();
+}
+
+TEST(TensorBufferPoolTest, TensorsOutliveRelease) {
+  TensorBufferPool* pool = new TensorBufferPool(cpu_allocator(), 1 << 20);
+  Tensor t(pool, DT_FLOAT, TensorShape({16, 16}));
+  {
+    Tensor dead(pool, DT_FLOAT, TensorShape({16, 16}));
+  }
+  EXPECT_EQ(1024, pool->GetPoolStats().pooled_bytes);
+  pool->Release();
+  t.flat<float>().setZero();
+}
+
+}  // namespace
+}  // namespace tensorflow
@@ -43,6 +43,7 @@ limitations under the License.
 #endif  // IS_MOBILE_PLATFORM
 #include "tensorflow/core/framework/resource_var.h"
 #include "tensorflow/core/framework/tensor.h"
+#include "tensorflow/core/framework/types.h"
 #include "tensorflow/core/framework/types.pb.h"
 #include "tensorflow/core/lib/core/errors.h"
 #include "tensorflow/core/lib/core/stringpiece.h"
@@ -58,6 +59,15 @@ int64_t GetRemoteDeviceIncarnation(Device* device) {
   return device->attributes().incarnation();
 }
 
+// The largest number of elements of a tensor handle value that is made
+// available to shape inference. Values that describe shapes are small.
+constexpr int64_t kMaxInferenceValueElements = 64;
+
+bool IsInferenceValue(const Tensor& t) {
+  return (t.dtype() == DT_INT32 || t.dtype() == DT_INT64) &&
+         t.dims() <= 1 && t.NumElements() <= kMaxInferenceValueElements;
+}
+
 string SafeDeviceDebugString(Device* device) {
   if (device == nullptr) {
     return "[]";
@@ -603,9 +613,36 @@ Status TensorHandle::CopyInferenceShape(TensorHandle* other) {
   } else {
     inference_shape_ = other->inference_shape_;
   }
+  const tensorflow::Tensor* other_value = other->InferenceValue();
+  if (other_value != nullptr) {
+    SetInferenceValue(*other_value);
+  }
   return absl::OkStatus();
 }
 
+const tensorflow::Tensor* TensorHandle::InferenceValue() const {
+  if (inference_value_ != nullptr) {
+    return inference_value_.get();
+  }
+  // Only a ready local tensor in host memory can be read without copying it.
+  if (Type() != LOCAL || !IsReady() ||
+      (device_ != nullptr && device_->device_type() != DEVICE_CPU)) {
+    return nullptr;
+  }
+  const tensorflow::Tensor* t;
+  if (!Tensor(&t).ok() || !IsInferenceValue(*t)) {
+    return nullptr;
+  }
+  return t;
+}
+
+void TensorHandle::SetInferenceValue(const tensorflow::Tensor& value) {
+  if (IsReady() || value.dtype() != dtype || !IsInferenceValue(value)) {
+    return;
+  }
+  inference_value_ = std::make_unique<tensorflow::Tensor>(value);
+}
+
 Status TensorHandle::Shape(tensorflow::PartialTensorShape* shape) const {
   DCHECK(shape != nullptr);
   if (!IsReady() && !inference_shape_.unknown_rank()) {
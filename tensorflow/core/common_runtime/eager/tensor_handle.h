@@ -246,6 +246,15 @@ class TensorHandle : public ImmediateExecutionTensorHandle {
                          const shape_inference::ShapeHandle& shape_handle);
   Status CopyInferenceShape(TensorHandle* other);
 
+  // Returns the value of this handle if it is available to shape inference
+  // before the handle is ready, or nullptr. That is the case for small int32
+  // and int64 tensors that are either ready in host memory, or whose value was
+  // set by SetInferenceValue or copied by CopyInferenceShape. This lets shape
+  // functions that read their inputs, such as those of Reshape or Fill,
+  // produce known shapes for pending remote handles.
+  const tensorflow::Tensor* InferenceValue() const;
+  void SetInferenceValue(const tensorflow::Tensor& value);
+
   // dtype for the handle. It must be the same as t.dtype() once the handle is
   // ready.
   const tensorflow::DataType dtype;
@@ -391,6 +400,9 @@ class TensorHandle : public ImmediateExecutionTensorHandle {
 #endif
 
   PartialTensorShape inference_shape_;
+  // Only set if InferenceValue() can return it. Like inference_shape_, it is
+  // only accessed by the thread that enqueues operations.
+  std::unique_ptr<tensorflow::Tensor> inference_value_;
 
   FullTypeDef full_type_;
 };
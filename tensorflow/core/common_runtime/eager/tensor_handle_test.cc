@@ -80,6 +80,45 @@ TEST(TensorHandle_ShapeTest, AsyncShape) {
   EXPECT_EQ(num_elements, 4);
 }
 
+TEST(TensorHandle_ShapeTest, InferenceValue) {
+  StaticDeviceMgr device_mgr(DeviceFactory::NewDevice(
+      "CPU", {}, "/job:localhost/replica:0/task:0/device:CPU:0"));
+  auto ctx = new EagerContext(
+      SessionOptions(),
+      tensorflow::ContextDevicePlacementPolicy::DEVICE_PLACEMENT_SILENT, false,
+      &device_mgr, false, nullptr, nullptr, nullptr,
+      /*run_eager_op_as_function=*/true);
+  absl::Cleanup ctx_cleanup = [&]() { ctx->Unref(); };
+
+  Tensor shape(DT_INT32, TensorShape({2}));
+  shape.vec<int32>()(0) = 3;
+  shape.vec<int32>()(1) = 4;
+  TensorHandle* shape_th =
+      TensorHandle::CreateLocalHandle(Tensor(shape), nullptr, nullptr, ctx);
+  absl::Cleanup shape_th_cleanup = [&]() { shape_th->Unref(); };
+  ASSERT_NE(shape_th->InferenceValue(), nullptr);
+  EXPECT_EQ(shape_th->InferenceValue()->vec<int32>()(1), 4);
+
+  // The value is propagated to pending copies of the handle.
+  TensorHandle* async_th = TensorHandle::CreateEmptyLocalHandle(
+      nullptr, nullptr, nullptr, DT_INT32, ctx);
+  absl::Cleanup async_th_cleanup = [&]() { async_th->Unref(); };
+  EXPECT_EQ(async_th->InferenceValue(), nullptr);
+  TF_EXPECT_OK(async_th->CopyInferenceShape(shape_th));
+  ASSERT_NE(async_th->InferenceValue(), nullptr);
+  EXPECT_EQ(async_th->InferenceValue()->vec<int32>()(0), 3);
+
+  // Large or floating point values are not used for shape inference.
+  TensorHandle* float_th = TensorHandle::CreateLocalHandle(
+      Tensor(DT_FLOAT, TensorShape({2})), nullptr, nullptr, ctx);
+  absl::Cleanup float_th_cleanup = [&]() { float_th->Unref(); };
+  EXPECT_EQ(float_th->InferenceValue(), nullptr);
+  TensorHandle* large_th = TensorHandle::CreateLocalHandle(
+      Tensor(DT_INT64, TensorShape({1024})), nullptr, nullptr, ctx);
+  absl::Cleanup large_th_cleanup = [&]() { large_th->Unref(); };
+  EXPECT_EQ(large_th->InferenceValue(), nullptr);
+}
+
 class FakeDevice : public Device {
  public:
   explicit FakeDevice(const DeviceAttributes& attr, bool is_local)
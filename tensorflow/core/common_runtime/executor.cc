@@ -18,6 +18,7 @@ limitations under the License.
 #include <algorithm>
 #include <atomic>
 #include <memory>
+#include <optional>
 #include <utility>
 #include <vector>
 
@@ -31,10 +32,14 @@ limitations under the License.
 #include "tensorflow/core/common_runtime/executor_factory.h"
 #include "tensorflow/core/common_runtime/graph_view.h"
 #include "tensorflow/core/common_runtime/immutable_executor_state.h"
+#include "tensorflow/core/common_runtime/kernel_stats.h"
+#include "tensorflow/core/common_runtime/node_memory_attribution.h"
 #include "tensorflow/core/common_runtime/pending_counts.h"
 #include "tensorflow/core/common_runtime/propagator_state.h"
 #include "tensorflow/core/common_runtime/renamed_device.h"
 #include "tensorflow/core/common_runtime/simple_propagator_state.h"
+#include "tensorflow/core/common_runtime/static_schedule_propagator_state.h"
+#include "tensorflow/core/common_runtime/step_arena_allocator.h"
 #include "tensorflow/core/common_runtime/step_stats_collector.h"
 #include "tensorflow/core/framework/allocator.h"
 #include "tensorflow/core/framework/cancellation.h"
@@ -147,11 +152,31 @@ typedef gtl::InlinedVector<AllocatorAttributes, 4> AllocatorAttributeVec;
 
 class ExecutorImpl : public Executor {
  public:
-  explicit ExecutorImpl(const LocalExecutorParams& p) : immutable_state_(p) {}
+  explicit ExecutorImpl(const LocalExecutorParams& p,
+                        bool use_static_schedule = false)
+      : immutable_state_(p), use_static_schedule_(use_static_schedule) {}
+
+  ~ExecutorImpl() override {
+    if (memory_attribution_ != nullptr) memory_attribution_->Release();
+  }
 
   Status Initialize(const Graph& graph) {
     TF_RETURN_IF_ERROR(immutable_state_.Initialize(graph));
     kernel_stats_.Initialize(immutable_state_.graph_view());
+    if (use_static_schedule_) {
+      if (immutable_state_.requires_control_flow_support()) {
+        VLOG(1) << "Graph requires control flow support; falling back to "
+                   "dynamic scheduling.";
+      } else {
+        TF_RETURN_IF_ERROR(immutable_state_.BuildStaticSchedule());
+      }
+    }
+    if (immutable_state_.params().use_step_arena_allocator) {
+      InitializeStepArena(graph);
+    }
+    if (immutable_state_.params().memory_attribution_sample_period > 0) {
+      InitializeMemoryAttribution(graph);
+    }
     return absl::OkStatus();
   }
 
@@ -161,70 +186,28 @@ class ExecutorImpl : public Executor {
   template <class PropagatorStateType>
   friend class ExecutorState;
 
-  // Stores execution time information about the kernels in an executor's graph.
-  class KernelStats {
-   public:
-    KernelStats() = default;
-
-    void Initialize(const GraphView& gview) {
-      is_expensive_.resize(gview.num_nodes());
-      cost_estimates_ =
-          std::make_unique<std::atomic_uint_fast64_t[]>(gview.num_nodes());
-      for (int32_t i = 0; i < gview.num_nodes(); ++i) {
-        if (gview.node(i)) {
-          is_expensive_[i] =
-              gview.node(i)->kernel && gview.node(i)->kernel->IsExpensive();
-          cost_estimates_[i] = kInitialCostEstimateCycles;
-        }
-      }
-    }
+  // Determines which nodes may allocate from a per-step arena, and creates
+  // `step_arena_planner_` if any node may.
+  void InitializeStepArena(const Graph& graph);
 
-    // Returns true iff the given node is considered "expensive". The
-    // executor uses this flag to optimize graph execution, for example
-    // by "inlining" inexpensive kernels.
-    bool IsExpensive(const NodeItem& node) const {
-      return is_expensive_[node.node_id] &&
-             (cost_estimates_[node.node_id].load(std::memory_order_relaxed) >
-              kOpIsExpensiveThresholdCycles);
-    }
+  // Creates `memory_attribution_` for the nodes of `graph`.
+  void InitializeMemoryAttribution(const Graph& graph);
 
-    // Returns the value of kernel->IsExpensive().
-    bool HasExpensiveMarker(const NodeItem& node) const {
-      return is_expensive_[node.node_id];
-    }
+  ImmutableExecutorState immutable_state_;
+  KernelStats kernel_stats_;
 
-    // Updates the dynamic cost estimate, which is used to determine whether the
-    // given node is expensive. The new cost estimate is a weighted average of
-    // the old cost estimate and the latest cost. We only update cost estimates
-    // for kernels for which IsExpensive() return true.
-    void UpdateCostEstimate(const NodeItem& node, uint64 elapsed_cycles) {
-      // N.B. Updates to `cost_estimate` are atomic but unlocked.  Simultaneous
-      // updates may result in one or more updates being ignored.  This does not
-      // affect correctness but may slow down the update frequency.
-      std::atomic_uint_fast64_t& cost_estimate = cost_estimates_[node.node_id];
-      auto prev_estimate = cost_estimate.load(std::memory_order_relaxed);
-
-      uint64 new_estimate =
-          ((kCostDecay - 1) * prev_estimate + elapsed_cycles) / kCostDecay;
-
-      cost_estimate.store(new_estimate, std::memory_order_relaxed);
-    }
+  // If non-null, plans the per-step arenas used to allocate intermediate
+  // tensors.
+  std::unique_ptr<StepArenaPlanner> step_arena_planner_;
 
-   private:
-    // Initial time (in CPU cycles) we expect an operation to take.  Used to
-    // determine whether an operation should be place in a threadpool.
-    // Operations start out "expensive".
-    static constexpr uint64 kInitialCostEstimateCycles = 100 * 1000 * 1000;
-    static constexpr uint64 kOpIsExpensiveThresholdCycles = 8000;
-    static constexpr uint64 kCostDecay = 10;
-
-    std::vector<bool> is_expensive_;
-    // std::unique_ptr<std::atomic<bool>[]> is_expensive_;
-    std::unique_ptr<std::atomic_uint_fast64_t[]> cost_estimates_;
-  };
+  // If non-null, attributes the memory allocated in sampled steps to nodes.
+  // Released when the executor is destroyed.
+  NodeMemoryAttribution* memory_attribution_ = nullptr;
 
-  ImmutableExecutorState immutable_state_;
-  KernelStats kernel_stats_;
+  // If true, and the graph does not require control flow support, each step
+  // runs the precomputed `ImmutableExecutorState::StaticSchedule` instead of
+  // tracking per-node pending counts.
+  const bool use_static_schedule_;
 
   ExecutorImpl(const ExecutorImpl&) = delete;
   void operator=(const ExecutorImpl&) = delete;
@@ -284,7 +267,9 @@ class ExecutorState {
  public:
   ExecutorState(const Executor::Args& args,
                 const ImmutableExecutorState& immutable_state_,
-                ExecutorImpl::KernelStats* kernel_stats_);
+                KernelStats* kernel_stats_,
+                StepArenaPlanner* step_arena_planner = nullptr,
+                NodeMemoryAttribution* memory_attribution = nullptr);
   ~ExecutorState();
 
   void RunAsync(Executor::DoneCallback done);
@@ -306,6 +291,11 @@ class ExecutorState {
 
   Status ProcessSync(const NodeItem& item, OpKernelContext::Params* params,
                      EntryVector* outputs, NodeExecStatsInterface* stats);
+  // Fills `*buffers` with the caller-provided buffers for the outputs of
+  // `item` that are returned by `_Retval` nodes, and returns a pointer to the
+  // array, or nullptr if there are no such buffers.
+  const Tensor* const* GetRetvalBuffers(
+      const NodeItem& item, gtl::InlinedVector<const Tensor*, 4>* buffers);
   void ProcessAsync(const NodeItem& item, const OpKernelContext::Params& params,
                     const TaggedNode& tagged_node, Entry* first_input,
                     NodeExecStatsInterface* stats,
@@ -389,7 +379,15 @@ class ExecutorState {
   checkpoint::TensorSliceReaderCacheWrapper* slice_reader_cache_;
   CallFrameInterface* call_frame_;
   const ImmutableExecutorState& immutable_state_;
-  ExecutorImpl::KernelStats* const kernel_stats_;
+  KernelStats* const kernel_stats_;
+  // Not owned. If non-null, `step_arena_` is the arena for this step, or
+  // nullptr if the planner did not provide one.
+  StepArenaPlanner* const step_arena_planner_;
+  StepArenaAllocator* step_arena_ = nullptr;
+  // Not owned. Non-null iff this step is sampled for memory attribution.
+  NodeMemoryAttribution* memory_attribution_ = nullptr;
+  // True iff the graph has `_Retval` nodes and the step has a call frame.
+  const bool bind_retval_buffers_;
   CancellationManager* cancellation_manager_;
   tsl::CoordinationServiceAgent* coordination_service_agent_;
   absl::optional<ManagedStackTrace> stack_trace_ = absl::nullopt;
@@ -419,7 +417,9 @@ class ExecutorState {
 template <class PropagatorStateType>
 ExecutorState<PropagatorStateType>::ExecutorState(
     const Executor::Args& args, const ImmutableExecutorState& immutable_state,
-    ExecutorImpl::KernelStats* kernel_stats)
+    KernelStats* kernel_stats,
+    StepArenaPlanner* step_arena_planner,
+    NodeMemoryAttribution* memory_attribution)
     : vlog_(VLOG_IS_ON(1)),
       log_memory_(LogMemory::IsEnabled()),
       step_id_(args.step_id),
@@ -442,6 +442,9 @@ ExecutorState<PropagatorStateType>::ExecutorState(
       call_frame_(args.call_frame),
       immutable_state_(immutable_state),
       kernel_stats_(kernel_stats),
+      step_arena_planner_(step_arena_planner),
+      bind_retval_buffers_(args.call_frame != nullptr &&
+                           immutable_state.has_retval_outputs()),
       cancellation_manager_(args.cancellation_manager),
       coordination_service_agent_(args.coordination_service_agent),
       stack_trace_(args.stack_trace),
@@ -455,6 +458,12 @@ ExecutorState<PropagatorStateType>::ExecutorState(
     user_device_ = RenamedDevice::NewRenamedDevice(
         device->name(), device, false, false, args.user_intra_op_threadpool);
   }
+  if (step_arena_planner_ != nullptr) {
+    step_arena_ = step_arena_planner_->BeginStep();
+  }
+  if (memory_attribution != nullptr && memory_attribution->MaybeStartStep()) {
+    memory_attribution_ = memory_attribution;
+  }
 }
 
 template <class PropagatorStateType>
@@ -463,6 +472,10 @@ ExecutorState<PropagatorStateType>::~ExecutorState() {
     device_context_->Unref();
   }
   delete slice_reader_cache_;
+  if (step_arena_ != nullptr) {
+    mutex_lock l(mu_);
+    step_arena_planner_->EndStep(step_arena_, status_.ok());
+  }
 }
 
 template <class PropagatorStateType>
@@ -586,6 +599,20 @@ Status ExecutorState<PropagatorStateType>::ProcessSync(
     const NodeItem& item, OpKernelContext::Params* params, EntryVector* outputs,
     NodeExecStatsInterface* stats) {
   Status s;
+  std::optional<StepArenaAllocator::ScopedNode> step_arena_scope;
+  if (step_arena_ != nullptr && step_arena_planner_->IsEligible(item.node_id)) {
+    params->step_arena_allocator = step_arena_;
+    step_arena_scope.emplace(step_arena_, item.node_id);
+  }
+  std::optional<NodeMemoryAttribution::ScopedNode> memory_attribution_scope;
+  if (TF_PREDICT_FALSE(memory_attribution_ != nullptr)) {
+    params->memory_attribution_allocator = memory_attribution_;
+    memory_attribution_scope.emplace(memory_attribution_, item.node_id);
+  }
+  gtl::InlinedVector<const Tensor*, 4> retval_buffers;
+  if (TF_PREDICT_FALSE(bind_retval_buffers_)) {
+    params->output_buffers = GetRetvalBuffers(item, &retval_buffers);
+  }
   OpKernelContext ctx(params, item.num_outputs);
   nodestats::SetOpStart(stats);
 
@@ -603,27 +630,48 @@ Status ExecutorState<PropagatorStateType>::ProcessSync(
         },
         profiler::GetTFTraceMeLevel(is_expensive));
     device->Compute(op_kernel, &ctx);
-  } else if (kernel_stats_->HasExpensiveMarker(item)) {
+  } else {
     KernelTimer timer;
     device->Compute(op_kernel, &ctx);
-    // For expensive kernels, always update the cost estimate. For inexpensive
-    // kernels, update the cost estimate with ~1/16 probability. This assumes
-    // that the last 4 bits of the CPU cycle count is uniformly distributed.
-    constexpr int kKernelExecutionTrackingInvocationSkipCount = 16;
-    if (is_expensive ||
-        timer.start_cycles % kKernelExecutionTrackingInvocationSkipCount == 0) {
+    if (kernel_stats_->ShouldSampleCost(item, timer.start_cycles)) {
       kernel_stats_->UpdateCostEstimate(item, timer.ElapsedCycles());
     }
-  } else {
-    device->Compute(op_kernel, &ctx);
   }
   nodestats::SetOpEnd(stats);
   if (outputs->size() < item.num_outputs) outputs->resize(item.num_outputs);
   s = ProcessOutputs(item, &ctx, outputs->data(), stats);
   nodestats::SetMemory(stats, &ctx);
+  // `params` is reused for the next node, which may not be eligible.
+  params->step_arena_allocator = nullptr;
+  params->memory_attribution_allocator = nullptr;
+  params->output_buffers = nullptr;
   return s;
 }
 
+template <class PropagatorStateType>
+const Tensor* const* ExecutorState<PropagatorStateType>::GetRetvalBuffers(
+    const NodeItem& item, gtl::InlinedVector<const Tensor*, 4>* buffers) {
+  absl::Span<const ImmutableExecutorState::RetvalOutput> retval_outputs =
+      immutable_state_.retval_outputs(item.node_id);
+  if (retval_outputs.empty()) return nullptr;
+  const bool is_host_device =
+      immutable_state_.params().device->device_type() == DEVICE_CPU;
+  for (const ImmutableExecutorState::RetvalOutput& output : retval_outputs) {
+    bool buffer_on_host;
+    const Tensor* buffer =
+        call_frame_->GetRetvalBuffer(output.retval_index, &buffer_on_host);
+    if (buffer == nullptr) continue;
+    // The output can only use the buffer if both are backed by the same kind
+    // of memory.
+    const bool output_on_host =
+        is_host_device || item.output_attrs()[output.output_slot].on_host();
+    if (buffer_on_host != output_on_host) continue;
+    if (buffers->empty()) buffers->resize(item.num_outputs, nullptr);
+    (*buffers)[output.output_slot] = buffer;
+  }
+  return buffers->empty() ? nullptr : buffers->data();
+}
+
 template <class PropagatorStateType>
 void ExecutorState<PropagatorStateType>::ProcessAsync(
     const NodeItem& item, const OpKernelContext::Params& params,
@@ -1276,6 +1324,16 @@ void ExecutorState<PropagatorStateType>::ScheduleReady(
       profiler::GetTFTraceMeLevel(/*is_expensive=*/false));
   DCHECK(!ready->empty());
 
+  if (immutable_state_.has_scheduling_priorities() && ready->size() > 1) {
+    // Dispatch the ready nodes with the highest priorities, e.g. those on the
+    // critical path of the graph, first.
+    std::stable_sort(ready->begin(), ready->end(),
+                     [](const TaggedNode& a, const TaggedNode& b) {
+                       return a.node_item->scheduling_priority >
+                              b.node_item->scheduling_priority;
+                     });
+  }
+
   int64_t scheduled_nsec = 0;
   if (stats_collector_) {
     scheduled_nsec = nodestats::NowInNsec();
@@ -1300,6 +1358,7 @@ void ExecutorState<PropagatorStateType>::ScheduleReady(
   } else {
     const TaggedNode* curr_expensive_node = nullptr;
     TaggedNodeSeq expensive_nodes;
+    TaggedNodeSeq overflow_inexpensive_nodes;
     if (inline_ready == nullptr) {
       // Schedule to run all the ready ops in thread pool.
       for (auto& tagged_node : *ready) {
@@ -1307,11 +1366,22 @@ void ExecutorState<PropagatorStateType>::ScheduleReady(
                 /*sample_rate=*/ready->size());
       }
     } else {
+      uint64 inline_cost = 0;
       for (auto& tagged_node : *ready) {
         const NodeItem& item = *tagged_node.node_item;
-        if (tagged_node.get_is_dead() || !kernel_stats_->IsExpensive(item)) {
-          // Inline this inexpensive node.
+        if (tagged_node.get_is_dead()) {
+          // Inline this dead node, which does not run a kernel.
           inline_ready->push_back(tagged_node);
+        } else if (!kernel_stats_->IsExpensive(item)) {
+          // Inline this inexpensive node, unless the inexpensive nodes that
+          // this thread is already going to run add up to an expensive amount
+          // of work.
+          if (kernel_stats_->AddToInlineBatch(item, inline_ready->empty(),
+                                              &inline_cost)) {
+            inline_ready->push_back(tagged_node);
+          } else {
+            overflow_inexpensive_nodes.push_back(tagged_node);
+          }
         } else {
           if (curr_expensive_node) {
             expensive_nodes.push_back(*curr_expensive_node);
@@ -1370,6 +1440,32 @@ void ExecutorState<PropagatorStateType>::ScheduleReady(
         }
       }
     }
+    if (!overflow_inexpensive_nodes.empty()) {
+      // Hand the remaining inexpensive nodes to other threads in batches, so
+      // that each closure runs roughly `kInlineBatchCostBudgetCycles` worth
+      // of work instead of a single tiny kernel.
+      auto it = overflow_inexpensive_nodes.begin();
+      while (it < overflow_inexpensive_nodes.end()) {
+        auto end = it;
+        uint64 batch_cost = 0;
+        while (end < overflow_inexpensive_nodes.end() &&
+               kernel_stats_->AddToInlineBatch(*end->node_item, end == it,
+                                               &batch_cost)) {
+          ++end;
+        }
+        TaggedNodeSeq batch{it, end};
+        RunTask(
+            [this, batch = std::move(batch), scheduled_nsec]() {
+              TaggedNodeReadyQueue batch_ready;
+              for (auto& tagged_node : batch) {
+                batch_ready.push_back(tagged_node);
+              }
+              ProcessInline(&batch_ready, scheduled_nsec);
+            },
+            /*sample_rate=*/overflow_inexpensive_nodes.size());
+        it = end;
+      }
+    }
   }
   ready->clear();
 }
@@ -1510,17 +1606,84 @@ void ExecutorState<PropagatorStateType>::Finish() {
   }
 }
 
+void ExecutorImpl::InitializeStepArena(const Graph& graph) {
+  Device* device = immutable_state_.params().device;
+  if (immutable_state_.requires_control_flow_support() ||
+      device->device_type() != DEVICE_CPU) {
+    VLOG(1) << "Step arena allocation is not supported for this graph on "
+            << device->name();
+    return;
+  }
+
+  // Allocations that outlive a step (for example, fetched tensors and the
+  // contents of resources) pin the whole arena in memory, so only nodes whose
+  // outputs are expected to die within the step may allocate from it.
+  const GraphView& gview = immutable_state_.graph_view();
+  std::vector<bool> eligible_nodes(gview.num_nodes(), false);
+  bool any_eligible = false;
+  for (const Node* n : graph.nodes()) {
+    if (!n->IsOp()) continue;
+    const NodeItem* item = gview.node(n->id());
+    if (item == nullptr || item->kernel == nullptr || item->kernel_is_async ||
+        item->is_transfer_node || item->const_tensor != nullptr ||
+        n->op_def().is_stateful()) {
+      continue;
+    }
+    bool escapes = false;
+    for (const Node* consumer : n->out_nodes()) {
+      if (consumer->IsRetval() || IsTransferNode(consumer) ||
+          consumer->op_def().is_stateful()) {
+        escapes = true;
+        break;
+      }
+    }
+    if (!escapes) {
+      eligible_nodes[n->id()] = true;
+      any_eligible = true;
+    }
+  }
+  if (any_eligible) {
+    step_arena_planner_ = std::make_unique<StepArenaPlanner>(
+        device->GetAllocator(AllocatorAttributes()), std::move(eligible_nodes));
+  }
+}
+
+void ExecutorImpl::InitializeMemoryAttribution(const Graph& graph) {
+  const GraphView& gview = immutable_state_.graph_view();
+  std::vector<string> node_names(gview.num_nodes());
+  std::vector<string> node_ops(gview.num_nodes());
+  for (const Node* n : graph.nodes()) {
+    node_names[n->id()] = n->name();
+    node_ops[n->id()] = n->type_string();
+  }
+  Device* device = immutable_state_.params().device;
+  memory_attribution_ = new NodeMemoryAttribution(
+      device->GetAllocator(AllocatorAttributes()), device->name(),
+      std::move(node_names), std::move(node_ops),
+      immutable_state_.params().memory_attribution_sample_period);
+}
+
 void ExecutorImpl::RunAsyncInternal(const Args& args, DoneCallback done) {
+  StepArenaPlanner* step_arena_planner = step_arena_planner_.get();
   if (OpOrderDeterminismRequired()) {
-    (new ExecutorState<OrderedPropagatorState>(args, immutable_state_,
-                                               &kernel_stats_))
+    (new ExecutorState<OrderedPropagatorState>(
+         args, immutable_state_, &kernel_stats_, step_arena_planner,
+         memory_attribution_))
         ->RunAsync(std::move(done));
   } else if (immutable_state_.requires_control_flow_support()) {
-    (new ExecutorState<PropagatorState>(args, immutable_state_, &kernel_stats_))
+    (new ExecutorState<PropagatorState>(args, immutable_state_, &kernel_stats_,
+                                        step_arena_planner,
+                                        memory_attribution_))
+        ->RunAsync(std::move(done));
+  } else if (immutable_state_.static_schedule() != nullptr) {
+    (new ExecutorState<StaticSchedulePropagatorState>(
+         args, immutable_state_, &kernel_stats_, step_arena_planner,
+         memory_attribution_))
         ->RunAsync(std::move(done));
   } else {
-    (new ExecutorState<SimplePropagatorState>(args, immutable_state_,
-                                              &kernel_stats_))
+    (new ExecutorState<SimplePropagatorState>(
+         args, immutable_state_, &kernel_stats_, step_arena_planner,
+         memory_attribution_))
         ->RunAsync(std::move(done));
   }
 }
@@ -1539,6 +1702,18 @@ Status NewLocalExecutor(const LocalExecutorParams& params, const Graph& graph,
   return s;
 }
 
+Status NewStaticScheduleExecutor(const LocalExecutorParams& params,
+                                 const Graph& graph, Executor** executor) {
+  ExecutorImpl* impl = new ExecutorImpl(params, /*use_static_schedule=*/true);
+  const Status s = impl->Initialize(graph);
+  if (s.ok()) {
+    *executor = impl;
+  } else {
+    delete impl;
+  }
+  return s;
+}
+
 Status CreateNonCachedKernel(Device* device, FunctionLibraryRuntime* flib,
                              const std::shared_ptr<const NodeProperties>& props,
                              int graph_def_version, OpKernel** kernel) {
@@ -1574,6 +1749,25 @@ class DefaultExecutorRegistrar {
 };
 static DefaultExecutorRegistrar registrar;
 
+class StaticScheduleExecutorRegistrar {
+ public:
+  StaticScheduleExecutorRegistrar() {
+    ExecutorFactory::Register("STATIC_SCHEDULE_EXECUTOR", new Factory);
+  }
+
+ private:
+  class Factory : public ExecutorFactory {
+    Status NewExecutor(const LocalExecutorParams& params, const Graph& graph,
+                       std::unique_ptr<Executor>* out_executor) override {
+      Executor* ret = nullptr;
+      TF_RETURN_IF_ERROR(NewStaticScheduleExecutor(params, graph, &ret));
+      out_executor->reset(ret);
+      return absl::OkStatus();
+    }
+  };
+};
+static StaticScheduleExecutorRegistrar static_schedule_registrar;
+
 }  // namespace
 
 }  // namespace tensorflow
@@ -161,6 +161,19 @@ class Executor {
 ::tensorflow::Status NewLocalExecutor(const LocalExecutorParams& params,
                                       const Graph& graph, Executor** executor);
 
+// Creates an Executor like `NewLocalExecutor()` that, if "graph" does not
+// contain any v1-style control flow, computes a fixed topological schedule of
+// "waves" of independent nodes once at construction time. Each step then
+// dispatches the nodes one wave at a time, which avoids the per-edge pending
+// count updates of the default executor. This executor is also registered
+// with `ExecutorFactory` as "STATIC_SCHEDULE_EXECUTOR".
+//
+// Graphs that require control flow support are executed as by
+// `NewLocalExecutor()`.
+::tensorflow::Status NewStaticScheduleExecutor(const LocalExecutorParams& params,
+                                               const Graph& graph,
+                                               Executor** executor);
+
 // A class to help run multiple executors in parallel and wait until
 // all of them are complete.
 //
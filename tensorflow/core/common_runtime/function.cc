@@ -16,10 +16,12 @@ limitations under the License.
 #include "tensorflow/core/common_runtime/function.h"
 
 #include <deque>
+#include <optional>
 #include <utility>
 #include <vector>
 
 #include "absl/algorithm/container.h"
+#include "absl/base/call_once.h"
 #include "absl/memory/memory.h"
 #include "absl/strings/str_cat.h"
 #include "tensorflow/core/common_runtime/arg_ret_placement.h"
@@ -52,6 +54,7 @@ limitations under the License.
 #include "tensorflow/core/lib/core/threadpool.h"
 #include "tensorflow/core/lib/gtl/map_util.h"
 #include "tensorflow/core/platform/macros.h"
+#include "tensorflow/core/platform/random.h"
 #include "tensorflow/core/platform/refcount.h"
 #include "tensorflow/core/platform/str_util.h"
 #include "tensorflow/core/profiler/lib/connected_traceme.h"
@@ -328,6 +331,48 @@ Status FunctionLibraryRuntimeOverlay::Clone(
   return base_flr_->Clone(out_lib_def, out_pflr, out_flr, skip_flib_def);
 }
 
+namespace {
+
+// The rendezvous created for a function call when `Options::create_rendezvous`
+// is set. It creates the underlying `RefCountedIntraProcessRendezvous` the
+// first time it is used, so that calls of functions that do not send or
+// receive tensors, which are most of them, do not pay for creating and
+// destroying the rendezvous tables.
+class LazyIntraProcessRendezvous : public RendezvousInterface {
+ public:
+  explicit LazyIntraProcessRendezvous(const DeviceMgr* device_mgr)
+      : device_mgr_(device_mgr) {}
+
+  Status Send(const ParsedKey& key, const Rendezvous::Args& args,
+              const Tensor& val, const bool is_dead) override {
+    return GetRendezvous()->Send(key, args, val, is_dead);
+  }
+
+  void RecvAsync(const ParsedKey& key, const Rendezvous::Args& args,
+                 DoneCallback done) override {
+    GetRendezvous()->RecvAsync(key, args, std::move(done));
+  }
+
+  void StartAbort(const Status& status) override {
+    GetRendezvous()->StartAbort(status);
+  }
+
+ private:
+  RefCountedIntraProcessRendezvous* GetRendezvous() {
+    absl::call_once(rendezvous_created_, [this]() {
+      rendezvous_ = tsl::core::RefCountPtr<RefCountedIntraProcessRendezvous>(
+          new RefCountedIntraProcessRendezvous(device_mgr_));
+    });
+    return rendezvous_.get();
+  }
+
+  const DeviceMgr* const device_mgr_;  // Not owned.
+  absl::once_flag rendezvous_created_;
+  tsl::core::RefCountPtr<RefCountedIntraProcessRendezvous> rendezvous_;
+};
+
+}  // namespace
+
 class FunctionLibraryRuntimeImpl : public FunctionLibraryRuntime {
  public:
   FunctionLibraryRuntimeImpl(const DeviceMgr* dmgr, Env* env,
@@ -456,11 +501,9 @@ class FunctionLibraryRuntimeImpl : public FunctionLibraryRuntime {
                  gtl::ArraySlice<Tensor> args, std::vector<Tensor>* rets,
                  Item* item, DoneCallback done);
 
-  // TODO(fishx): Avoid using std::unique_ptr for PrivateIntraProcessRendezvous,
-  // since it will allocate the object on heap.
   Status PrepareRunSync(
       Handle handle, Options* run_opts, Item** out_item,
-      std::unique_ptr<PrivateIntraProcessRendezvous>* out_rendezvous);
+      std::optional<LazyIntraProcessRendezvous>* out_rendezvous);
 
   void ExecutorArgsFromOptions(const FunctionLibraryRuntime::Options& run_opts,
                                CallFrameInterface* frame,
@@ -1032,7 +1075,7 @@ void FunctionLibraryRuntimeImpl::ExecutorArgsFromOptions(
     Executor::Args* exec_args) {
   // Inherit the step_id from the caller.
   exec_args->step_id = run_opts.step_id;
-  exec_args->function_trace_id = random::New64();
+  exec_args->function_trace_id = random::ThreadLocalNew64();
   exec_args->rendezvous = run_opts.rendezvous;
   exec_args->stats_collector = run_opts.stats_collector;
   exec_args->cancellation_manager = run_opts.cancellation_manager;
@@ -1151,11 +1194,11 @@ void FunctionLibraryRuntimeImpl::Run(const Options& opts, Handle handle,
   }
   Options run_opts = opts;
   if (opts.create_rendezvous) {
-    auto* rendezvous = new RefCountedIntraProcessRendezvous(device_mgr_);
+    auto* rendezvous = new LazyIntraProcessRendezvous(device_mgr_);
     run_opts.rendezvous = rendezvous;
     run_opts.create_rendezvous = false;
     done = [done = std::move(done), rendezvous](const Status& status) mutable {
-      rendezvous->Unref();
+      delete rendezvous;
       done(status);
     };
   }
@@ -1231,11 +1274,11 @@ void FunctionLibraryRuntimeImpl::Run(const Options& opts, Handle handle,
 
   Options run_opts = opts;
   if (opts.create_rendezvous) {
-    auto* rendezvous = new RefCountedIntraProcessRendezvous(device_mgr_);
+    auto* rendezvous = new LazyIntraProcessRendezvous(device_mgr_);
     run_opts.rendezvous = rendezvous;
     run_opts.create_rendezvous = false;
     done = [done = std::move(done), rendezvous](const Status& status) mutable {
-      rendezvous->Unref();
+      delete rendezvous;
       done(status);
     };
   }
@@ -1283,7 +1326,7 @@ void FunctionLibraryRuntimeImpl::Run(const Options& opts, Handle handle,
 
 Status FunctionLibraryRuntimeImpl::PrepareRunSync(
     Handle handle, Options* run_opts, Item** out_item,
-    std::unique_ptr<PrivateIntraProcessRendezvous>* out_rendezvous) {
+    std::optional<LazyIntraProcessRendezvous>* out_rendezvous) {
   if (run_opts->cancellation_manager &&
       run_opts->cancellation_manager->IsCancelled()) {
     return errors::Cancelled("");
@@ -1298,9 +1341,8 @@ Status FunctionLibraryRuntimeImpl::PrepareRunSync(
   }
 
   if (run_opts->create_rendezvous) {
-    *out_rendezvous =
-        std::make_unique<PrivateIntraProcessRendezvous>(device_mgr_);
-    run_opts->rendezvous = out_rendezvous->get();
+    out_rendezvous->emplace(device_mgr_);
+    run_opts->rendezvous = &**out_rendezvous;
     run_opts->create_rendezvous = false;
   }
 
@@ -1325,7 +1367,7 @@ Status FunctionLibraryRuntimeImpl::RunSync(Options opts, Handle handle,
                                            gtl::ArraySlice<Tensor> args,
                                            std::vector<Tensor>* rets) {
   Item* item = nullptr;
-  std::unique_ptr<PrivateIntraProcessRendezvous> rendezvous;
+  std::optional<LazyIntraProcessRendezvous> rendezvous;
   TF_RETURN_IF_ERROR(PrepareRunSync(handle, &opts, &item, &rendezvous));
   if (item == nullptr) {
     return parent_->RunSync(opts, handle, args, rets);
@@ -1344,7 +1386,7 @@ Status FunctionLibraryRuntimeImpl::RunSync(Options opts, Handle handle,
 Status FunctionLibraryRuntimeImpl::RunSync(Options opts, Handle handle,
                                            CallFrameInterface* call_frame) {
   Item* item = nullptr;
-  std::unique_ptr<PrivateIntraProcessRendezvous> rendezvous;
+  std::optional<LazyIntraProcessRendezvous> rendezvous;
   TF_RETURN_IF_ERROR(PrepareRunSync(handle, &opts, &item, &rendezvous));
   if (item == nullptr) {
     return parent_->RunSync(opts, handle, call_frame);
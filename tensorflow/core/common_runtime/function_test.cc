@@ -1968,6 +1968,57 @@ TEST_F(FunctionLibraryRuntimeTest, CrossDevice) {
                               TensorShape({})));
 }
 
+TEST_F(FunctionLibraryRuntimeTest, CreateRendezvous) {
+  const string device = "/job:localhost/replica:0/task:0/device:CPU:0";
+  auto send_recv = FDH::Create(
+      // Name
+      "SendRecv",
+      // Args
+      {"x: float"},
+      // Return values
+      {"y: float"},
+      // Attrs
+      {},
+      // Nodes
+      {{{"send"},
+        "_Send",
+        {"x"},
+        {{"T", DT_FLOAT},
+         {"tensor_name", "x"},
+         {"send_device", device},
+         {"send_device_incarnation", 1},
+         {"recv_device", device},
+         {"client_terminated", false}}},
+       {{"recv"},
+        "_Recv",
+        {"^send"},
+        {{"tensor_type", DT_FLOAT},
+         {"tensor_name", "x"},
+         {"send_device", device},
+         {"send_device_incarnation", 1},
+         {"recv_device", device},
+         {"client_terminated", false}}}},
+      {{"y", "recv:tensor:0"}});
+
+  Init({send_recv});
+  FunctionLibraryRuntime::Handle handle;
+  TF_CHECK_OK(Instantiate(flr0_, "SendRecv", {}, &handle));
+
+  // The rendezvous created for each call is used by the _Send and _Recv
+  // kernels, both asynchronously and synchronously.
+  auto x = test::AsTensor<float>({1, 2, 3, 4});
+  FunctionLibraryRuntime::Options opts;
+  opts.create_rendezvous = true;
+  Tensor y;
+  TF_CHECK_OK(Run(flr0_, handle, opts, {x}, {&y}));
+  test::ExpectTensorEqual<float>(y, x);
+
+  std::vector<Tensor> rets;
+  TF_CHECK_OK(flr0_->RunSync(opts, handle, {x}, &rets));
+  ASSERT_EQ(rets.size(), 1);
+  test::ExpectTensorEqual<float>(rets[0], x);
+}
+
 class AreAllKernelsInlineOp : public OpKernel {
  public:
   using OpKernel::OpKernel;
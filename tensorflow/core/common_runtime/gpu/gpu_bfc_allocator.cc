@@ -80,6 +80,26 @@ bool GetGarbageCollectionValue() {
       << " Using the default value \"true\".";
   return true;
 }
+
+bool GetCompactFreeRegionsValue(bool orig_value) {
+  const char* compact_free_regions =
+      std::getenv("TF_GPU_BFC_COMPACT_FREE_REGIONS");
+  if (compact_free_regions == nullptr) {
+    return orig_value;
+  }
+  if (strcmp("false", compact_free_regions) == 0) {
+    return false;
+  } else if (strcmp("true", compact_free_regions) == 0) {
+    return true;
+  }
+
+  LOG(ERROR)
+      << "The TF_GPU_BFC_COMPACT_FREE_REGIONS environment variable is set but"
+      << " could not be parsed: \"" << compact_free_regions << "\"."
+      << " Valid values are \"true\" or \"false\". Using original config"
+      << " value of " << orig_value << ".";
+  return orig_value;
+}
 }  // anonymous namespace
 
 GPUBFCAllocator::GPUBFCAllocator(
@@ -95,6 +115,9 @@ GPUBFCAllocator::GPUBFCAllocator(
           o.garbage_collection = GetGarbageCollectionValue();
         }
         o.fragmentation_fraction = opts.fragmentation_fraction;
+        o.thread_local_cache = opts.thread_local_cache;
+        o.compact_free_regions =
+            GetCompactFreeRegionsValue(opts.compact_free_regions);
         return o;
       }()) {}
 
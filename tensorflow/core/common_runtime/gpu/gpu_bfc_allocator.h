@@ -46,6 +46,10 @@ class GPUBFCAllocator : public tsl::BFCAllocator {
 
     double fragmentation_fraction = 0;
     bool allow_retry_on_failure = true;
+    bool thread_local_cache = false;
+
+    // Overridden by TF_GPU_BFC_COMPACT_FREE_REGIONS if that envvar is set.
+    bool compact_free_regions = false;
   };
 
   GPUBFCAllocator(std::unique_ptr<tsl::SubAllocator> sub_allocator,
@@ -19,6 +19,7 @@ limitations under the License.
 #include "tensorflow/core/common_runtime/gpu/gpu_bfc_allocator.h"
 
 #include <algorithm>
+#include <memory>
 #include <optional>
 #include <vector>
 
@@ -32,6 +33,7 @@ limitations under the License.
 #include "tsl/framework/device_id.h"
 #include "tsl/lib/gtl/inlined_vector.h"
 #include "tsl/lib/random/simple_philox.h"
+#include "tsl/platform/path.h"
 #include "tsl/platform/logging.h"
 #include "tsl/platform/strcat.h"
 #include "tsl/platform/test.h"
@@ -202,6 +204,110 @@ TEST_P(GPUBFCAllocatorTest, ExerciseCoalescing) {
   a.DeallocateRaw(first_ptr_after);
 }
 
+TEST_P(GPUBFCAllocatorTest, ThreadLocalCache) {
+  BFCAllocator::Options opts;
+  opts.thread_local_cache = true;
+  BFCAllocator a(GetParam()(1ull << 32), 1 << 30, "GPU_0_bfc", opts);
+
+  // A freed small chunk is reused by the next allocation of the same size.
+  void* p1 = a.AllocateRaw(1, 1000);
+  ASSERT_NE(nullptr, p1);
+  a.DeallocateRaw(p1);
+  CheckStats(&a, 1, 0, 1024, 1024);
+  void* p2 = a.AllocateRaw(1, 1000);
+  EXPECT_EQ(p1, p2);
+  CheckStats(&a, 2, 1024, 1024, 1024);
+  EXPECT_EQ(1024, a.AllocatedSize(p2));
+  a.DeallocateRaw(p2);
+
+  // Large chunks are not cached. The cached chunk counts towards the peak.
+  void* large = a.AllocateRaw(1, 1 << 20);
+  ASSERT_NE(nullptr, large);
+  a.DeallocateRaw(large);
+  CheckStats(&a, 3, 0, (1 << 20) + 1024, 1 << 20);
+
+  // Chunks freed on many threads are all reusable.
+  {
+    thread::ThreadPool pool(Env::Default(), "test", 4);
+    for (int t = 0; t < 4; ++t) {
+      pool.Schedule([&a]() {
+        std::vector<void*> ptrs;
+        for (int i = 0; i < 10000; ++i) {
+          ptrs.push_back(a.AllocateRaw(1, 256 * (1 + i % 16)));
+          if (ptrs.size() > 100) {
+            a.DeallocateRaw(ptrs.front());
+            ptrs.erase(ptrs.begin());
+          }
+        }
+        for (void* p : ptrs) a.DeallocateRaw(p);
+      });
+    }
+  }
+  std::optional<AllocatorStats> stats = a.GetStats();
+  ASSERT_TRUE(stats);
+  EXPECT_EQ(0, stats->bytes_in_use);
+  EXPECT_EQ(3 + 4 * 10000, stats->num_allocs);
+}
+
+TEST_P(GPUBFCAllocatorTest, CompactFreeRegions) {
+  BFCAllocator::Options opts;
+  opts.allow_growth = true;
+  BFCAllocator a(GetParam()(1ull << 32), 1 << 30, "GPU_0_bfc", opts);
+
+  // Allocate two regions, of 2MiB and 4MiB.
+  void* p1 = a.AllocateRaw(1, 1 << 20);
+  void* p2 = a.AllocateRaw(1, 3 << 20);
+  ASSERT_NE(nullptr, p1);
+  ASSERT_NE(nullptr, p2);
+  EXPECT_EQ(6 << 20, *a.GetStats()->pool_bytes);
+  // Regions with live allocations are not compacted.
+  EXPECT_FALSE(a.CompactFreeRegions());
+
+  a.DeallocateRaw(p1);
+  a.DeallocateRaw(p2);
+  EXPECT_TRUE(a.CompactFreeRegions());
+  // The memory is allocated again as one region, which can serve an
+  // allocation larger than either of the original regions.
+  EXPECT_EQ(6 << 20, *a.GetStats()->pool_bytes);
+  void* p3 = a.AllocateRaw(1, 5 << 20);
+  ASSERT_NE(nullptr, p3);
+  EXPECT_EQ(6 << 20, *a.GetStats()->pool_bytes);
+  a.DeallocateRaw(p3);
+
+  // There is only one free region left.
+  EXPECT_FALSE(a.CompactFreeRegions());
+}
+
+TEST_P(GPUBFCAllocatorTest, AllocationProfile) {
+  const std::string prefix = io::JoinPath(testing::TmpDir(), "profile");
+  setenv("TF_BFC_ALLOCATION_PROFILE", prefix.c_str(), 1);
+  BFCAllocator::Options opts;
+  opts.allow_growth = true;
+  {
+    // The pool grows through regions of 2MiB and 4MiB.
+    BFCAllocator a(GetParam()(1ull << 32), 1 << 30, "GPU_0_bfc", opts);
+    void* p1 = a.AllocateRaw(1, 1 << 20);
+    void* p2 = a.AllocateRaw(1, 3 << 20);
+    a.DeallocateRaw(p1);
+    a.DeallocateRaw(p2);
+    MemoryDump profile = a.RecordAllocationProfile();
+    EXPECT_EQ(6 << 20, profile.stats().peak_pool_bytes());
+    EXPECT_EQ(0, profile.chunk_size());
+    a.OnStepBoundary();
+  }
+  {
+    // The first region is sized from the profile.
+    BFCAllocator a(GetParam()(1ull << 32), 1 << 30, "GPU_0_bfc", opts);
+    void* p1 = a.AllocateRaw(1, 1 << 20);
+    EXPECT_EQ(6 << 20, *a.GetStats()->pool_bytes);
+    void* p2 = a.AllocateRaw(1, 3 << 20);
+    EXPECT_EQ(6 << 20, *a.GetStats()->pool_bytes);
+    a.DeallocateRaw(p1);
+    a.DeallocateRaw(p2);
+  }
+  unsetenv("TF_BFC_ALLOCATION_PROFILE");
+}
+
 TEST_P(GPUBFCAllocatorTest, AllocateZeroBufSize) {
   GPUBFCAllocator a(GetParam()(1ull << 32), 1 << 30, "GPU_0_bfc", {});
   float* ptr = TypedAllocator::Allocate<float>(&a, 0, {});
@@ -559,6 +665,37 @@ class GPUBFCAllocatorPrivateMethodsTest
     EXPECT_EQ(GPUBFCAllocator::RoundedBytes(1LL << 31),
               force_no_allow_growth_allocator.curr_region_allocation_bytes_);
   }
+
+  void TestThreadCachesOfExitedThreads() {
+    GPUBFCAllocator::Options opts;
+    opts.thread_local_cache = true;
+    GPUBFCAllocator a(GetParam()(1ull << 32), 1 << 30, "GPU_0_bfc", opts);
+
+    // Each short-lived thread exits with a small chunk in its cache.
+    for (int t = 0; t < 100; ++t) {
+      std::unique_ptr<Thread> thread(Env::Default()->StartThread(
+          ThreadOptions(), "thread_cache_test",
+          [&a]() { a.DeallocateRaw(a.AllocateRaw(1, 256)); }));
+    }
+
+    // The caches of exited threads are reclaimed when the next thread creates
+    // its cache, so only the cache of the last thread is left.
+    {
+      mutex_lock l(a.thread_caches_mu_);
+      EXPECT_EQ(1, a.thread_caches_.size());
+    }
+    EXPECT_EQ(256, a.thread_cached_bytes_.load());
+
+    {
+      mutex_lock l(a.lock_);
+      EXPECT_TRUE(a.FlushThreadCaches());
+    }
+    {
+      mutex_lock l(a.thread_caches_mu_);
+      EXPECT_TRUE(a.thread_caches_.empty());
+    }
+    EXPECT_EQ(0, a.thread_cached_bytes_.load());
+  }
 };
 
 TEST_P(GPUBFCAllocatorPrivateMethodsTest, BinDebugInfo) { TestBinDebugInfo(); }
@@ -571,6 +708,10 @@ TEST_P(GPUBFCAllocatorPrivateMethodsTest, ForceAllowGrowth) {
   TestForceAllowGrowth();
 }
 
+TEST_P(GPUBFCAllocatorPrivateMethodsTest, ThreadCachesOfExitedThreads) {
+  TestThreadCachesOfExitedThreads();
+}
+
 INSTANTIATE_TEST_SUITE_P(GPUBFCAllocatorPrivateMethodTestSuite,
                          GPUBFCAllocatorPrivateMethodsTest, TestSuiteValues());
 
@@ -35,7 +35,8 @@ class GPUDevice : public BaseGPUDevice {
       : BaseGPUDevice(options, name, memory_limit, locality, tf_device_id,
                       physical_device_desc, gpu_allocator, cpu_allocator,
                       false /* sync every op */),
-        gpu_options_(options.config.gpu_options()) {
+        gpu_options_(options.config.gpu_options()),
+        numa_node_(locality.numa_node()) {
     if (options.config.has_gpu_options()) {
       force_gpu_compatible_ =
           options.config.gpu_options().force_gpu_compatible();
@@ -47,7 +48,7 @@ class GPUDevice : public BaseGPUDevice {
     if (attr.on_host()) {
       if (attr.gpu_compatible() || force_gpu_compatible_) {
         GPUProcessState* ps = GPUProcessState::singleton();
-        return ps->GetGpuHostAllocator(gpu_options_, 0);
+        return ps->GetGpuHostAllocator(gpu_options_, numa_node_);
       } else {
         return cpu_allocator_;
       }
@@ -58,6 +59,9 @@ class GPUDevice : public BaseGPUDevice {
 
  private:
   GPUOptions gpu_options_;
+  // The NUMA node closest to this GPU. GPU-compatible host memory is served
+  // from the pinned pool of this node.
+  int numa_node_;
   bool force_gpu_compatible_ = false;
 };
 
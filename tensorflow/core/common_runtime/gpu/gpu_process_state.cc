@@ -295,16 +295,15 @@ Allocator* GPUProcessState::GetGpuHostAllocator(const GPUOptions& options,
     // we take a unique lock and populate these vectors.
     tf_shared_lock lock(mu_);
 
-    if (process_state_->ProcessState::FLAGS_brain_gpu_record_mem_types &&
-        !gpu_host_allocators_.empty() &&
-        gpu_host_allocators_[0].recording_allocator != nullptr) {
-      return gpu_host_allocators_[0].recording_allocator.get();
-    }
     if (static_cast<int>(gpu_host_allocators_.size()) > numa_node) {
+      AllocatorParts& allocator_parts = gpu_host_allocators_[numa_node];
+      if (allocator_parts.recording_allocator != nullptr) {
+        return allocator_parts.recording_allocator.get();
+      }
 #ifdef TF_GPU_USE_PJRT
-      return gpu_host_allocators_[0].allocator_not_owned;
+      return allocator_parts.allocator_not_owned;
 #else
-      return gpu_host_allocators_[0].allocator.get();
+      return allocator_parts.allocator.get();
 #endif  // TF_GPU_USE_PJRT
     }
   }
@@ -346,23 +345,29 @@ Allocator* GPUProcessState::GetGpuHostAllocator(const GPUOptions& options,
     mem_limit_bytes = limit_mb * (1LL << 20);
   }
 
+  // Each NUMA node gets its own pool, whose memory is allocated on that node,
+  // so that host-side copies and the kernels that read pinned buffers do not
+  // cross the socket interconnect.
   while (static_cast<int>(gpu_host_allocators_.size()) <= numa_node) {
-    while (gpu_host_alloc_visitors_.size() <= numa_node) {
+    const int node = gpu_host_allocators_.size();
+    while (gpu_host_alloc_visitors_.size() <= node) {
       gpu_host_alloc_visitors_.push_back({});
     }
-    while (gpu_host_free_visitors_.size() <= numa_node) {
+    while (gpu_host_free_visitors_.size() <= node) {
       gpu_host_free_visitors_.push_back({});
     }
-    SubAllocator* sub_allocator = new DeviceHostAllocator(
-        se, numa_node, gpu_host_alloc_visitors_[numa_node],
-        gpu_host_free_visitors_[numa_node]);
+    SubAllocator* sub_allocator =
+        new DeviceHostAllocator(se, node, gpu_host_alloc_visitors_[node],
+                                gpu_host_free_visitors_[node]);
 
     tsl::BFCAllocator::Options allocator_opts;
     allocator_opts.allow_growth =
         !options.experimental().gpu_host_mem_disallow_growth();
-    tsl::Allocator* allocator =
-        new tsl::BFCAllocator(absl::WrapUnique(sub_allocator), mem_limit_bytes,
-                              /*name=*/"gpu_host_bfc", allocator_opts);
+    tsl::Allocator* allocator = new tsl::BFCAllocator(
+        absl::WrapUnique(sub_allocator), mem_limit_bytes,
+        /*name=*/
+        node == 0 ? "gpu_host_bfc" : strings::StrCat("gpu_host_bfc_numa", node),
+        allocator_opts);
 
     if (LogMemory::IsEnabled() && !allocator->TracksAllocationSizes()) {
       // Wrap the allocator to track allocation ids for better logging
@@ -399,13 +404,14 @@ Allocator* GPUProcessState::GetGpuHostAllocator(const GPUOptions& options,
               md, &mu_);
     }
   }
+  AllocatorParts& allocator_parts = gpu_host_allocators_[numa_node];
   if (process_state_->ProcessState::FLAGS_brain_gpu_record_mem_types) {
-    return gpu_host_allocators_[0].recording_allocator.get();
+    return allocator_parts.recording_allocator.get();
   } else {
 #ifdef TF_GPU_USE_PJRT
-    return gpu_host_allocators_[0].allocator_not_owned;
+    return allocator_parts.allocator_not_owned;
 #else
-    return gpu_host_allocators_[0].allocator.get();
+    return allocator_parts.allocator.get();
 #endif  // TF_GPU_USE_PJRT
   }
 }
@@ -54,6 +54,8 @@ tsl::DeviceReservation GpuServingDeviceSelector::ReserveDevice(
   absl::MutexLock lock(&mu_);
   DeviceStates device_states;
   device_states.states = absl::Span<const DeviceState>(device_states_);
+  device_states.now_ns = NowNs();
+  device_states.min_exec_time_ns = min_exec_time_.value_or(kDefaultEstimateNs);
   auto [it, emplaced] =
       execution_info_.try_emplace(program_fingerprint, ExecutionInfo());
   const int device_index =
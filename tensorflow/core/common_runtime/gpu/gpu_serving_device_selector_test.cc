@@ -18,6 +18,7 @@ limitations under the License.
 #include <memory>
 #include <string>
 #include <utility>
+#include <vector>
 
 #include <gtest/gtest.h>
 #include "absl/time/clock.h"
@@ -135,6 +136,35 @@ TEST(GpuServingDeviceSelector, DefaultPolicyOnlyEnqueueCall) {
       0e6);
 }
 
+TEST(GpuServingDeviceSelector, EarliestCompletionPolicy) {
+  ServingDeviceSelectorTestHelper helper;
+  GpuServingDeviceSelector selector(
+      /*num_devices=*/2, std::make_unique<tsl::EarliestCompletionPolicy>());
+  // Learn the execution times of two programs from back-to-back runs.
+  selector.Enqueue(0, "10ms");
+  selector.Enqueue(0, "10ms");
+  selector.Enqueue(1, "1ms");
+  selector.Enqueue(1, "1ms");
+  helper.ElapseNs(1e6);
+  selector.Completed(1);
+  helper.ElapseNs(1e6);
+  selector.Completed(1);
+  helper.ElapseNs(8e6);
+  selector.Completed(0);
+  helper.ElapseNs(10e6);
+  selector.Completed(0);
+
+  tsl::DeviceReservation slow = selector.ReserveDevice("10ms");
+  const int slow_device = slow.device_index();
+  // Requests avoid the device that is busy with the slow program for as long
+  // as the other device is expected to finish earlier.
+  std::vector<tsl::DeviceReservation> fast;
+  for (int i = 0; i < 9; ++i) {
+    fast.push_back(selector.ReserveDevice("1ms"));
+    EXPECT_NE(fast.back().device_index(), slow_device);
+  }
+}
+
 }  // namespace
 }  // namespace gpu
 }  // namespace tensorflow
@@ -50,9 +50,12 @@ limitations under the License.
 #include "tensorflow/core/lib/gtl/inlined_vector.h"
 #include "tensorflow/core/lib/strings/scanner.h"
 #include "tensorflow/core/lib/strings/str_util.h"
+#include "tensorflow/core/platform/cpu_info.h"
+#include "tensorflow/core/platform/env.h"
 #include "tensorflow/core/platform/errors.h"
 #include "tensorflow/core/platform/logging.h"
 #include "tensorflow/core/platform/macros.h"
+#include "tensorflow/core/platform/threadpool.h"
 #include "tensorflow/core/public/version.h"
 
 namespace tensorflow {
@@ -63,6 +66,22 @@ namespace {
 // can skip expensive duplicates check in 'AddControlEdge'.
 static constexpr const bool kDoNotCheckDuplicates = true;
 
+// Graphs with at least this many nodes validate their NodeDefs in parallel
+// before they are converted.
+static constexpr const int kMinNodesForParallelValidation = 4096;
+
+// Returns true if `node_def` is missing an attr that has a default value in
+// `op_def`.
+bool IsMissingDefaultAttrs(const NodeDef& node_def, const OpDef& op_def) {
+  for (const OpDef::AttrDef& attr_def : op_def.attr()) {
+    if (attr_def.has_default_value() &&
+        node_def.attr().find(attr_def.name()) == node_def.attr().end()) {
+      return true;
+    }
+  }
+  return false;
+}
+
 inline bool IsMerge(const NodeDef& node_def) {
   return node_def.op() == "Merge" || node_def.op() == "RefMerge" ||
          node_def.op() == "_XlaMerge";
@@ -247,6 +266,10 @@ class GraphConstructor {
   Status MakeEdge(Node* src, int output_index, Node* dst, int input_index);
   Status ValidateShape(Node* node);
   Status ModifyNodeDefForImport(NodeDef* node_def);
+  // Runs the checks of `ValidateNodeDef()` on every NodeDef in parallel, and
+  // returns the status for each NodeDef. Must be called before any NodeDef is
+  // consumed, and only when the NodeDefs are converted without modification.
+  std::vector<Status> ValidateNodeDefsInParallel();
   // Modifies node_def's inputs according to opts_.input_map.
   // input_already_exists is a pre-initialized vector of length
   // node_def->input_size(). This function will mark inputs that are remapped to
@@ -863,6 +886,37 @@ Status GraphConstructor::ValidateShape(Node* node) {
   return absl::OkStatus();
 }
 
+std::vector<Status> GraphConstructor::ValidateNodeDefsInParallel() {
+  std::vector<Status> statuses(node_def_count());
+  auto validate = [this, &statuses](int64_t begin, int64_t end) {
+    NodeDef node_def_with_defaults;
+    for (int64_t i = begin; i < end; ++i) {
+      const NodeDef& node_def = get_node_def(i);
+      const OpDef* op_def;
+      statuses[i] = g_->op_registry()->LookUpOpDef(node_def.op(), &op_def);
+      if (!statuses[i].ok()) continue;
+      // Validate the NodeDef as `Convert()` will see it, without mutating the
+      // original, which other threads may be reading.
+      const NodeDef* to_validate = &node_def;
+      if (opts_.add_default_attributes &&
+          IsMissingDefaultAttrs(node_def, *op_def)) {
+        node_def_with_defaults = node_def;
+        AddDefaultsToNodeDef(*op_def, &node_def_with_defaults);
+        to_validate = &node_def_with_defaults;
+      }
+      statuses[i] = ValidateNodeDef(*to_validate, *op_def);
+    }
+  };
+  // NOTE: The pool is only created for large graphs, where the cost of
+  // starting its threads is small compared to the cost of validation. The
+  // cost estimate is the approximate number of cycles required to validate one
+  // NodeDef.
+  thread::ThreadPool pool(Env::Default(), "graph_constructor",
+                          port::MaxParallelism());
+  pool.ParallelFor(node_def_count(), /*cost_per_unit=*/10000, validate);
+  return statuses;
+}
+
 Status GraphConstructor::ModifyNodeDefForImport(NodeDef* node_def) {
   const OpDef* op_def;
   TF_RETURN_IF_ERROR(g_->op_registry()->LookUpOpDef(node_def->op(), &op_def));
@@ -1185,6 +1239,16 @@ Status GraphConstructor::Convert() {
         g_->AddFunctionLibrary(*std::move(library), library_traces));
   }
 
+  // The NodeDefs are converted in topological order, one at a time. When they
+  // are not modified during conversion, validate large graphs ahead of time
+  // in parallel. The status for each NodeDef is still returned in the
+  // sequential order below, so the first error reported does not change.
+  std::vector<Status> prevalidated_statuses;
+  if (!opts_.importing && opts_.validate_nodes &&
+      node_def_count() >= kMinNodesForParallelValidation) {
+    prevalidated_statuses = ValidateNodeDefsInParallel();
+  }
+
   std::vector<InputInfo> inputs;
   int processed = 0;
 
@@ -1304,7 +1368,9 @@ Status GraphConstructor::Convert() {
       if (opts_.add_default_attributes) {
         AddDefaultsToNodeDef(*op_def, &node_def);
       }
-      if (opts_.validate_nodes) {
+      if (!prevalidated_statuses.empty()) {
+        TF_RETURN_IF_ERROR(prevalidated_statuses[o]);
+      } else if (opts_.validate_nodes) {
         TF_RETURN_IF_ERROR(ValidateNodeDef(node_def, *op_def));
       }
     }
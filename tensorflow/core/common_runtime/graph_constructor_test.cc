@@ -1035,6 +1035,34 @@ TEST_F(GraphConstructorTest, ImportGraphDef_DefaultAttrs) {
   EXPECT_EQ(31415, value);
 }
 
+TEST_F(GraphConstructorTest, LargeGraphValidation) {
+  // Large graphs validate their NodeDefs in parallel before conversion.
+  constexpr int kNumNodes = 5000;
+  GraphDef def;
+  for (int i = 0; i < kNumNodes; ++i) {
+    NodeDef* node = def.add_node();
+    node->set_name(strings::StrCat("n", i));
+    node->set_op("TestDefaultAttr");
+  }
+  GraphConstructorOptions opts;
+  TF_ASSERT_OK(ConvertGraphDefToGraph(opts, def, &graph_));
+  EXPECT_EQ(kNumNodes + 2, graph_.num_nodes());
+  for (Node* n : graph_.op_nodes()) {
+    int value = 0;
+    TF_ASSERT_OK(GetNodeAttr(n->attrs(), "default_int", &value));
+    EXPECT_EQ(31415, value);
+  }
+
+  // The error for the first invalid node in topological order is reported.
+  (*def.mutable_node(3000)->mutable_attr())["default_int"].set_s("bad");
+  (*def.mutable_node(4000)->mutable_attr())["default_int"].set_f(1.0);
+  Graph g(OpRegistry::Global());
+  Status s = ConvertGraphDefToGraph(opts, def, &g);
+  EXPECT_FALSE(s.ok());
+  EXPECT_TRUE(absl::StrContains(s.message(), "n3000")) << s;
+  EXPECT_FALSE(absl::StrContains(s.message(), "n4000")) << s;
+}
+
 TEST_F(GraphConstructorTest, ImportGraphDef_Versioning) {
   GraphDef def;
   const ImportGraphDefOptions opts;
@@ -92,6 +92,9 @@ struct NodeItem {
   // If the kernel is a Const op, this containts points to the constant tensor.
   const Tensor* const_tensor = nullptr;
 
+  // The `kSchedulingPriorityAttrName` attribute of the node, or 0.
+  int64_t scheduling_priority = 0;
+
   // Cached values of node->num_inputs() and node->num_outputs(), to
   // avoid levels of indirection.
   int num_inputs;
@@ -0,0 +1,309 @@
+/* Copyright 2024 The TensorFlow Authors. All Rights Reserved.
+
+Licensed under the Apache License, Version 2.0 (the "License");
+you may not use this file except in compliance with the License.
+You may obtain a copy of the License at
+
+    http://www.apache.org/licenses/LICENSE-2.0
+
+Unless required by applicable law or agreed to in writing, software
+distributed under the License is distributed on an "AS IS" BASIS,
+WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+See the License for the specific language governing permissions and
+limitations under the License.
+==============================================================================*/
+#include "tensorflow/core/common_runtime/hierarchical_reducer.h"
+
+#include <algorithm>
+#include <string>
+#include <utility>
+#include <vector>
+
+#include "tensorflow/core/common_runtime/collective_rma_local.h"
+#include "tensorflow/core/common_runtime/collective_util.h"
+#include "tensorflow/core/common_runtime/device.h"
+#include "tensorflow/core/common_runtime/device_mgr.h"
+#include "tensorflow/core/common_runtime/dma_helper.h"
+#include "tensorflow/core/framework/allocator.h"
+#include "tensorflow/core/framework/op_kernel.h"
+#include "tensorflow/core/framework/tensor.h"
+#include "tensorflow/core/lib/core/errors.h"
+#include "tensorflow/core/lib/core/notification.h"
+#include "tensorflow/core/lib/core/status.h"
+#include "tensorflow/core/lib/strings/strcat.h"
+#include "tensorflow/core/platform/blocking_counter.h"
+#include "tensorflow/core/platform/mutex.h"
+#include "tensorflow/core/profiler/lib/traceme.h"
+
+namespace tensorflow {
+
+HierarchicalReducer::HierarchicalReducer()
+    : col_ctx_(nullptr),
+      col_params_(nullptr),
+      num_tasks_(0),
+      num_local_devices_(0),
+      task_index_(-1),
+      local_index_(-1) {}
+
+Status HierarchicalReducer::GroupByTask(
+    const CollGroupParams& group, std::vector<std::vector<int>>* task_ranks) {
+  task_ranks->clear();
+  std::vector<string> tasks;
+  for (int r = 0; r < group.members.size(); ++r) {
+    const string& task = group.members[r].task;
+    auto it = std::find(tasks.begin(), tasks.end(), task);
+    if (it == tasks.end()) {
+      tasks.push_back(task);
+      task_ranks->emplace_back();
+      task_ranks->back().push_back(r);
+    } else {
+      (*task_ranks)[it - tasks.begin()].push_back(r);
+    }
+  }
+  for (const std::vector<int>& ranks : *task_ranks) {
+    if (ranks.size() != task_ranks->front().size()) {
+      return errors::InvalidArgument(
+          "HierarchicalReduce requires the same number of devices on every "
+          "task, but group ",
+          group.group_key, " has ", task_ranks->front().size(),
+          " devices on task ", tasks.front(), " and ", ranks.size(),
+          " devices on task ", tasks[&ranks - task_ranks->data()]);
+    }
+  }
+  return absl::OkStatus();
+}
+
+Status HierarchicalReducer::InitializeCollectiveParams(
+    CollectiveParams* col_params) {
+  DCHECK_EQ(col_params->instance.type, REDUCTION_COLLECTIVE);
+  DCHECK_EQ(col_params->instance.impl_details.collective_name,
+            "HierarchicalReduce");
+  if (col_params->group.device_type != DEVICE_CPU) {
+    return errors::InvalidArgument(
+        "HierarchicalReduce only supports CPU devices, got ",
+        col_params->group.device_type.type_string());
+  }
+  std::vector<std::vector<int>> task_ranks;
+  return GroupByTask(col_params->group, &task_ranks);
+}
+
+Status HierarchicalReducer::InitializeCollectiveContext(
+    std::shared_ptr<CollectiveContext> col_ctx) {
+  DCHECK(col_ctx->dev_mgr);
+  col_ctx_ = col_ctx;
+  col_params_ = col_ctx->col_params.get();
+  TF_RETURN_IF_ERROR(GroupByTask(col_params_->group, &task_ranks_));
+  num_tasks_ = task_ranks_.size();
+  num_local_devices_ = task_ranks_.front().size();
+  for (int ti = 0; ti < num_tasks_; ++ti) {
+    for (int li = 0; li < num_local_devices_; ++li) {
+      if (task_ranks_[ti][li] == col_params_->default_rank) {
+        task_index_ = ti;
+        local_index_ = li;
+      }
+    }
+  }
+  return collective_util::InitializeDeviceAndLocality(
+      col_ctx->dev_mgr, col_ctx->device_name, &col_ctx->device,
+      &col_ctx->device_locality);
+}
+
+void HierarchicalReducer::Run(StatusCallback done) {
+  CHECK(col_ctx_);
+  CHECK(col_params_);
+  // Since `HierarchicalReducer` doesn't require non-overlapping collectives,
+  // unblock any collective that is blocked on this instance.
+  col_ctx_->col_exec->UnblockDependencies(*col_params_);
+
+  // Start by copying input to output if they're not already the same, i.e. if
+  // we're not computing in-place on the input tensor.
+  Status status;
+  if ((col_ctx_->input != col_ctx_->output) &&
+      (DMAHelper::base(col_ctx_->input) != DMAHelper::base(col_ctx_->output))) {
+    Notification note;
+    CollectiveRemoteAccessLocal::MemCpyAsync(
+        col_ctx_->op_ctx->op_device_context(),
+        col_ctx_->op_ctx->op_device_context(), col_ctx_->device,
+        col_ctx_->device, col_ctx_->op_ctx->input_alloc_attr(0),
+        col_ctx_->op_ctx->output_alloc_attr(0), col_ctx_->input,
+        col_ctx_->output, 0 /*dev_to_dev_stream_index*/,
+        [&note, &status](const Status& s) {
+          status.Update(s);
+          note.Notify();
+        });
+    note.WaitForNotification();
+  }
+  if (status.ok()) {
+    ca_.reset(MakeCollectiveAdapter(
+        col_ctx_->output, num_local_devices_ * num_tasks_,
+        col_ctx_->device->GetAllocator(
+            col_ctx_->op_ctx->output_alloc_attr(0))));
+    status = ReduceScatterWithinTask();
+    if (status.ok()) status = AllReduceAcrossTasks();
+    if (status.ok()) status = AllGatherWithinTask();
+    if (status.ok()) ca_->ConsumeFinalValue(col_ctx_->output);
+    ca_.reset();
+  }
+  done(status);
+}
+
+Status HierarchicalReducer::ReduceScatterWithinTask() {
+  if (num_local_devices_ == 1) return absl::OkStatus();
+  tsl::profiler::TraceMe activity("ReduceScatterWithinTask",
+                                  tsl::profiler::TraceMeLevel::kInfo);
+  const std::vector<int>& local_ranks = task_ranks_[task_index_];
+  std::vector<Tensor> chunks(num_local_devices_ * num_tasks_);
+  std::vector<Tensor> temps(num_local_devices_ * num_tasks_);
+  std::vector<Transfer> sends;
+  std::vector<Transfer> recvs;
+  for (int li = 0; li < num_local_devices_; ++li) {
+    if (li == local_index_) continue;
+    for (int ti = 0; ti < num_tasks_; ++ti) {
+      // Chunk `c` of shard `li` goes to its owner, and this device receives
+      // the peer's copy of chunk `mine` of the shard it owns.
+      const int c = li * num_tasks_ + ti;
+      const int mine = local_index_ * num_tasks_ + ti;
+      chunks[c] = ca_->ChunkAlias(c);
+      sends.push_back({local_ranks[li], c, &chunks[c]});
+      temps[li * num_tasks_ + ti] = ca_->TempChunk(mine);
+      recvs.push_back({local_ranks[li], mine, &temps[li * num_tasks_ + ti]});
+    }
+  }
+  TF_RETURN_IF_ERROR(Exchange("rs", std::move(sends), std::move(recvs)));
+  for (int ti = 0; ti < num_tasks_; ++ti) {
+    const int mine = local_index_ * num_tasks_ + ti;
+    Tensor chunk = ca_->ChunkAlias(mine);
+    if (chunk.NumElements() == 0) continue;
+    for (int li = 0; li < num_local_devices_; ++li) {
+      if (li == local_index_) continue;
+      TF_RETURN_IF_ERROR(collective_util::ComputeBinOp(
+          col_ctx_->op_ctx, col_ctx_->op_params, col_ctx_->device,
+          col_params_->merge_op, &chunk, &temps[li * num_tasks_ + ti]));
+    }
+  }
+  return absl::OkStatus();
+}
+
+Status HierarchicalReducer::AllReduceAcrossTasks() {
+  tsl::profiler::TraceMe activity("AllReduceAcrossTasks",
+                                  tsl::profiler::TraceMeLevel::kInfo);
+  const int t = num_tasks_;
+  const int next = task_ranks_[(task_index_ + 1) % t][local_index_];
+  const int prev = task_ranks_[(task_index_ + t - 1) % t][local_index_];
+  auto shard_chunk = [this, t](int ti) {
+    return local_index_ * num_tasks_ + (ti % t + t) % t;
+  };
+  // Reduce-scatter within the ring, after which this device holds the fully
+  // reduced chunk `task_index_ + 1` of its shard.
+  for (int s = 0; s < t - 1; ++s) {
+    const int send_chunk = shard_chunk(task_index_ - s);
+    const int recv_chunk = shard_chunk(task_index_ - s - 1);
+    Tensor to_send = ca_->ChunkAlias(send_chunk);
+    Tensor received = ca_->TempChunk(recv_chunk);
+    TF_RETURN_IF_ERROR(Exchange("ring_rs", {{next, send_chunk, &to_send}},
+                                {{prev, recv_chunk, &received}}));
+    Tensor chunk = ca_->ChunkAlias(recv_chunk);
+    if (chunk.NumElements() > 0) {
+      TF_RETURN_IF_ERROR(collective_util::ComputeBinOp(
+          col_ctx_->op_ctx, col_ctx_->op_params, col_ctx_->device,
+          col_params_->merge_op, &chunk, &received));
+    }
+  }
+  Tensor reduced = ca_->ChunkAlias(shard_chunk(task_index_ + 1));
+  if (col_params_->final_op && reduced.NumElements() > 0) {
+    Tensor group_size = ca_->Scalar(col_params_->group.group_size);
+    TF_RETURN_IF_ERROR(collective_util::ComputeBinOp(
+        col_ctx_->op_ctx, col_ctx_->op_params, col_ctx_->device,
+        col_params_->final_op, &reduced, &group_size));
+  }
+  // All-gather within the ring.
+  for (int s = 0; s < t - 1; ++s) {
+    const int send_chunk = shard_chunk(task_index_ + 1 - s);
+    const int recv_chunk = shard_chunk(task_index_ - s);
+    Tensor to_send = ca_->ChunkAlias(send_chunk);
+    Tensor received = ca_->ChunkAlias(recv_chunk);
+    TF_RETURN_IF_ERROR(Exchange("ring_ag", {{next, send_chunk, &to_send}},
+                                {{prev, recv_chunk, &received}}));
+  }
+  return absl::OkStatus();
+}
+
+Status HierarchicalReducer::AllGatherWithinTask() {
+  if (num_local_devices_ == 1) return absl::OkStatus();
+  tsl::profiler::TraceMe activity("AllGatherWithinTask",
+                                  tsl::profiler::TraceMeLevel::kInfo);
+  const std::vector<int>& local_ranks = task_ranks_[task_index_];
+  std::vector<Tensor> chunks(num_local_devices_ * num_tasks_);
+  for (int c = 0; c < chunks.size(); ++c) chunks[c] = ca_->ChunkAlias(c);
+  std::vector<Transfer> sends;
+  std::vector<Transfer> recvs;
+  for (int li = 0; li < num_local_devices_; ++li) {
+    if (li == local_index_) continue;
+    for (int ti = 0; ti < num_tasks_; ++ti) {
+      const int mine = local_index_ * num_tasks_ + ti;
+      const int theirs = li * num_tasks_ + ti;
+      sends.push_back({local_ranks[li], mine, &chunks[mine]});
+      recvs.push_back({local_ranks[li], theirs, &chunks[theirs]});
+    }
+  }
+  return Exchange("ag", std::move(sends), std::move(recvs));
+}
+
+Status HierarchicalReducer::Exchange(absl::string_view phase,
+                                     std::vector<Transfer> sends,
+                                     std::vector<Transfer> recvs) {
+  // Every device splits the tensor the same way, so the empty tail chunks of
+  // small tensors are skipped on both ends.
+  auto is_empty = [](const Transfer& t) {
+    return t.tensor->NumElements() == 0;
+  };
+  sends.erase(std::remove_if(sends.begin(), sends.end(), is_empty),
+              sends.end());
+  recvs.erase(std::remove_if(recvs.begin(), recvs.end(), is_empty),
+              recvs.end());
+
+  BlockingCounter pending(sends.size() + recvs.size());
+  mutex mu;
+  Status status;
+  auto done = [&pending, &mu, &status](const Status& s) {
+    {
+      mutex_lock l(mu);
+      status.Update(s);
+    }
+    pending.DecrementCount();
+  };
+  OpKernelContext* op_ctx = col_ctx_->op_ctx;
+  const int rank = col_params_->default_rank;
+  for (const Transfer& send : sends) {
+    const CollGroupMember& peer = col_params_->group.members[send.rank];
+    col_ctx_->col_exec->remote_access()->PostToPeer(
+        peer.device.name(), peer.task,
+        BufKey(phase, send.chunk, rank, send.rank), col_ctx_->device,
+        op_ctx->op_device_context(), op_ctx->output_alloc_attr(0), send.tensor,
+        col_ctx_->device_locality, op_ctx->cancellation_manager(), done);
+  }
+  for (const Transfer& recv : recvs) {
+    const CollGroupMember& peer = col_params_->group.members[recv.rank];
+    col_ctx_->col_exec->remote_access()->RecvFromPeer(
+        peer.device.name(), peer.task, peer.is_local,
+        BufKey(phase, recv.chunk, recv.rank, rank), col_ctx_->device,
+        op_ctx->op_device_context(), op_ctx->output_alloc_attr(0), recv.tensor,
+        col_ctx_->device_locality, 0 /*dev_to_dev_stream_index*/,
+        op_ctx->cancellation_manager(), done);
+  }
+  pending.Wait();
+  mutex_lock l(mu);
+  return status;
+}
+
+std::string HierarchicalReducer::BufKey(absl::string_view phase, int chunk,
+                                        int src_rank, int dst_rank) const {
+  return strings::StrCat(col_ctx_->exec_key, ":", phase, ":", chunk, ":",
+                         src_rank, ":", dst_rank);
+}
+
+namespace {
+REGISTER_COLLECTIVE(HierarchicalReduce, HierarchicalReducer);
+}  // namespace
+
+}  // namespace tensorflow
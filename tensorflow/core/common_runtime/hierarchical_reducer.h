@@ -0,0 +1,101 @@
+/* Copyright 2024 The TensorFlow Authors. All Rights Reserved.
+
+Licensed under the Apache License, Version 2.0 (the "License");
+you may not use this file except in compliance with the License.
+You may obtain a copy of the License at
+
+    http://www.apache.org/licenses/LICENSE-2.0
+
+Unless required by applicable law or agreed to in writing, software
+distributed under the License is distributed on an "AS IS" BASIS,
+WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+See the License for the specific language governing permissions and
+limitations under the License.
+==============================================================================*/
+#ifndef TENSORFLOW_CORE_COMMON_RUNTIME_HIERARCHICAL_REDUCER_H_
+#define TENSORFLOW_CORE_COMMON_RUNTIME_HIERARCHICAL_REDUCER_H_
+
+#include <memory>
+#include <string>
+#include <vector>
+
+#include "absl/strings/string_view.h"
+#include "tensorflow/core/common_runtime/base_collective_executor.h"
+#include "tensorflow/core/framework/collective.h"
+
+namespace tensorflow {
+
+// Hierarchical implementation of collective all-reduce for groups that span
+// several tasks with the same number of devices each.
+//
+// The tensor is split into `l * t` chunks, where `l` is the number of devices
+// per task and `t` the number of tasks, and the `i`-th device of every task
+// owns shard `i`, i.e. chunks `[i * t, (i + 1) * t)`. The reduction runs in
+// three phases:
+//   1. Every device sends the shards it does not own to their owners on the
+//      same task and reduces the shard it owns.
+//   2. The owners of the same shard on all tasks run a ring all-reduce over
+//      the `t` chunks of that shard.
+//   3. Every device sends the shard it owns to the other devices of its task.
+// Only the `t - 1` ring steps of phase 2 cross task boundaries, and each of
+// them moves `1 / (l * t)` of the tensor, so the inter-task traffic of a
+// device is `l` times smaller than that of a flat ring over all devices.
+//
+// This implementation is chosen by setting the `communication_hint` of a CPU
+// all-reduce to "hierarchical".
+class HierarchicalReducer : public CollectiveImplementationInterface {
+ public:
+  HierarchicalReducer();
+  ~HierarchicalReducer() override = default;
+
+  // Checks that the group can be reduced hierarchically.
+  Status InitializeCollectiveParams(CollectiveParams* col_params) override;
+
+  // Initializes members of CollectiveContext not yet initialized, i.e. device
+  // and device_locality.  Also saves the CollectiveContext in this object.
+  Status InitializeCollectiveContext(
+      std::shared_ptr<CollectiveContext> col_ctx) override;
+
+  // Begins execution of the hierarchical reduction.  Must be called in a
+  // blockable thread.
+  void Run(StatusCallback done) override;
+
+  // Populates `task_ranks` with the default ranks of the members of each task
+  // in `group`, with tasks in order of their first member.  Returns an error
+  // if the tasks do not all have the same number of devices.
+  static Status GroupByTask(const CollGroupParams& group,
+                            std::vector<std::vector<int>>* task_ranks);
+
+ private:
+  // A chunk of the output sent to, or received from, the device at `rank`.
+  struct Transfer {
+    int rank;
+    int chunk;
+    Tensor* tensor;
+  };
+
+  // Starts `sends` and `recvs` and blocks until all of them are done.
+  Status Exchange(absl::string_view phase, std::vector<Transfer> sends,
+                  std::vector<Transfer> recvs);
+
+  Status ReduceScatterWithinTask();
+  Status AllReduceAcrossTasks();
+  Status AllGatherWithinTask();
+
+  // Returns the buffer key of `chunk` sent from `src_rank` to `dst_rank`.
+  std::string BufKey(absl::string_view phase, int chunk, int src_rank,
+                     int dst_rank) const;
+
+  std::shared_ptr<CollectiveContext> col_ctx_;
+  const CollectiveParams* col_params_;  // Not owned
+  std::unique_ptr<CollectiveAdapter> ca_;
+  std::vector<std::vector<int>> task_ranks_;
+  int num_tasks_;
+  int num_local_devices_;
+  int task_index_;
+  int local_index_;
+};
+
+}  // namespace tensorflow
+
+#endif  // TENSORFLOW_CORE_COMMON_RUNTIME_HIERARCHICAL_REDUCER_H_
@@ -0,0 +1,145 @@
+/* Copyright 2024 The TensorFlow Authors. All Rights Reserved.
+
+Licensed under the Apache License, Version 2.0 (the "License");
+you may not use this file except in compliance with the License.
+You may obtain a copy of the License at
+
+    http://www.apache.org/licenses/LICENSE-2.0
+
+Unless required by applicable law or agreed to in writing, software
+distributed under the License is distributed on an "AS IS" BASIS,
+WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+See the License for the specific language governing permissions and
+limitations under the License.
+==============================================================================*/
+#include "tensorflow/core/common_runtime/hierarchical_reducer.h"
+
+#include <memory>
+#include <tuple>
+#include <vector>
+
+#include "tensorflow/core/common_runtime/collective_test_util.h"
+#include "tensorflow/core/common_runtime/device.h"
+#include "tensorflow/core/common_runtime/device_mgr.h"
+#include "tensorflow/core/common_runtime/process_util.h"
+#include "tensorflow/core/framework/collective.h"
+#include "tensorflow/core/framework/fake_input.h"
+#include "tensorflow/core/framework/node_def.pb.h"
+#include "tensorflow/core/framework/node_def_builder.h"
+#include "tensorflow/core/framework/op_kernel.h"
+#include "tensorflow/core/framework/tensor.h"
+#include "tensorflow/core/framework/tensor_testutil.h"
+#include "tensorflow/core/lib/core/status_test_util.h"
+#include "tensorflow/core/platform/blocking_counter.h"
+#include "tensorflow/core/platform/refcount.h"
+#include "tensorflow/core/platform/test.h"
+#include "tensorflow/core/public/version.h"
+
+namespace tensorflow {
+namespace {
+
+std::unique_ptr<OpKernel> GetBinOp(const string& op, DataType dtype,
+                                   Device* device) {
+  NodeDef node_def;
+  TF_CHECK_OK(NodeDefBuilder(strings::StrCat(op, "_node"), op)
+                  .Attr("T", dtype)
+                  .Input(FakeInput(dtype))
+                  .Input(FakeInput(dtype))
+                  .Finalize(&node_def));
+  Status status;
+  std::unique_ptr<OpKernel> kernel = CreateOpKernel(
+      DEVICE_CPU, device, device->GetAllocator(AllocatorAttributes()),
+      node_def, TF_GRAPH_DEF_VERSION, &status);
+  TF_CHECK_OK(status);
+  return kernel;
+}
+
+class HierarchicalReducerTest
+    : public ::testing::TestWithParam<std::tuple<int, int, int>> {};
+
+TEST_P(HierarchicalReducerTest, AllReduce) {
+  const int num_workers = std::get<0>(GetParam());
+  const int num_devices = std::get<1>(GetParam());
+  const int tensor_len = std::get<2>(GetParam());
+  const int group_size = num_workers * num_devices;
+  std::unique_ptr<CollectiveTestEnv> test_env =
+      CreateCollectiveTestEnv(num_workers, num_devices, DEVICE_CPU);
+
+  std::vector<Tensor> tensors;
+  std::vector<float> expected(tensor_len);
+  for (int r = 0; r < group_size; ++r) {
+    Tensor t(DT_FLOAT, TensorShape({tensor_len}));
+    for (int i = 0; i < tensor_len; ++i) {
+      t.flat<float>()(i) = r * 10 + i;
+      expected[i] += (r * 10 + i) / static_cast<float>(group_size);
+    }
+    tensors.push_back(t);
+  }
+
+  std::vector<Status> statuses(group_size);
+  BlockingCounter counter(group_size);
+  for (int r = 0; r < group_size; ++r) {
+    SchedClosure([&, r]() {
+      auto col_params =
+          CreateCollectiveParams(*test_env, r, "HierarchicalReduce",
+                                 REDUCTION_COLLECTIVE, DT_FLOAT,
+                                 tensors[r].shape());
+      Device* device = nullptr;
+      TF_CHECK_OK(test_env->device_mgr->LookupDevice(
+          col_params->group.members[r].device.name(), &device));
+      std::unique_ptr<OpKernel> merge_op = GetBinOp("Add", DT_FLOAT, device);
+      std::unique_ptr<OpKernel> final_op = GetBinOp("Div", DT_FLOAT, device);
+      col_params->merge_op = merge_op.get();
+      col_params->final_op = final_op.get();
+      statuses[r] = RunCollective(test_env.get(), col_params.get(), device,
+                                  &tensors[r], &tensors[r]);
+      counter.DecrementCount();
+    });
+  }
+  counter.Wait();
+
+  for (int r = 0; r < group_size; ++r) {
+    TF_EXPECT_OK(statuses[r]);
+    test::ExpectTensorNear<float>(tensors[r], test::AsTensor<float>(expected),
+                                  1e-5);
+  }
+}
+
+INSTANTIATE_TEST_SUITE_P(
+    HierarchicalReducerTests, HierarchicalReducerTest,
+    ::testing::Combine(/*num_workers*/ ::testing::Values(1, 2, 3),
+                       /*num_devices*/ ::testing::Values(1, 2, 4),
+                       /*tensor_len*/ ::testing::Values(1, 7, 1001)));
+
+TEST(HierarchicalReducerInitParamsTest, GroupByTask) {
+  CollGroupParams group;
+  for (const char* task : {"/job:worker/task:1", "/job:worker/task:0",
+                           "/job:worker/task:1", "/job:worker/task:0"}) {
+    CollGroupMember member;
+    member.task = task;
+    group.members.push_back(member);
+  }
+  std::vector<std::vector<int>> task_ranks;
+  TF_ASSERT_OK(HierarchicalReducer::GroupByTask(group, &task_ranks));
+  EXPECT_EQ(task_ranks, (std::vector<std::vector<int>>{{0, 2}, {1, 3}}));
+
+  group.members.pop_back();
+  EXPECT_TRUE(errors::IsInvalidArgument(
+      HierarchicalReducer::GroupByTask(group, &task_ranks)));
+}
+
+TEST(HierarchicalReducerInitParamsTest, RejectsNonCpuDevices) {
+  std::unique_ptr<CollectiveTestEnv> test_env =
+      CreateCollectiveTestEnv(/*num_workers*/ 2, /*num_devices*/ 1, DEVICE_CPU);
+  auto col_params =
+      CreateCollectiveParams(*test_env, 0, "HierarchicalReduce",
+                             REDUCTION_COLLECTIVE, DT_FLOAT, TensorShape({4}));
+  core::RefCountPtr<HierarchicalReducer> reducer(new HierarchicalReducer());
+  TF_EXPECT_OK(reducer->InitializeCollectiveParams(col_params.get()));
+  col_params->group.device_type = DEVICE_GPU;
+  EXPECT_TRUE(errors::IsInvalidArgument(
+      reducer->InitializeCollectiveParams(col_params.get())));
+}
+
+}  // namespace
+}  // namespace tensorflow
@@ -15,6 +15,8 @@ limitations under the License.
 
 #include "tensorflow/core/common_runtime/immutable_executor_state.h"
 
+#include <algorithm>
+
 #include "absl/memory/memory.h"
 #include "tensorflow/core/framework/function.h"
 #include "tensorflow/core/framework/metrics.h"
@@ -196,6 +198,11 @@ Status ImmutableExecutorState::Initialize(const Graph& graph) {
     item->is_recv_or_switch = IsRecv(n) || IsSwitch(n);
     item->is_next_iteration = IsNextIteration(n);
     item->is_distributed_communication = IsDistributedCommunication(n);
+    if (TryGetNodeAttr(n->attrs(), kSchedulingPriorityAttrName,
+                       &item->scheduling_priority) &&
+        item->scheduling_priority != 0) {
+      has_scheduling_priorities_ = true;
+    }
 
     // Compute the maximum values we'll store for this node in the
     // pending counts data structure, and allocate a handle in
@@ -242,6 +249,18 @@ Status ImmutableExecutorState::Initialize(const Graph& graph) {
     }
   }
 
+  // Record which outputs are returned by `_Retval` nodes, so that the executor
+  // can ask the call frame for a buffer to hold them.
+  for (const Node* n : graph.nodes()) {
+    if (!n->IsRetval()) continue;
+    int32_t index;
+    TF_RETURN_IF_ERROR(GetNodeAttr(n->attrs(), "index", &index));
+    const Edge* e;
+    TF_RETURN_IF_ERROR(n->input_edge(0, &e));
+    if (retval_outputs_.empty()) retval_outputs_.resize(gview_.num_nodes());
+    retval_outputs_[e->src()->id()].push_back({e->src_output(), index});
+  }
+
   // Rewrite each `EdgeInfo::input_slot` member to refer directly to the input
   // location.
   for (const Node* n : graph.nodes()) {
@@ -350,6 +369,74 @@ Status ImmutableExecutorState::BuildControlFlowInfo(const Graph* g,
   return absl::OkStatus();
 }
 
+Status ImmutableExecutorState::BuildStaticSchedule() {
+  if (requires_control_flow_) {
+    return errors::FailedPrecondition(
+        "Cannot build a static schedule for a graph that requires control flow "
+        "support.");
+  }
+
+  // Assign each node to the wave after the latest wave of any of its inputs,
+  // visiting nodes in topological order (Kahn's algorithm).
+  const int32_t num_nodes = gview_.num_nodes();
+  std::vector<int32> pending(num_nodes, 0);
+  std::vector<int32> wave(num_nodes, 0);
+  int32_t num_scheduled_nodes = 0;
+  for (int32_t i = 0; i < num_nodes; ++i) {
+    const NodeItem* item = gview_.node(i);
+    if (item == nullptr || item->kernel == nullptr) continue;
+    pending[i] = atomic_pending_counts_[i].load(std::memory_order_relaxed);
+    ++num_scheduled_nodes;
+  }
+
+  std::vector<const NodeItem*> topo_order(root_nodes_);
+  topo_order.reserve(num_scheduled_nodes);
+  int32_t num_waves = root_nodes_.empty() ? 0 : 1;
+  for (size_t i = 0; i < topo_order.size(); ++i) {
+    const NodeItem* item = topo_order[i];
+    const int32_t next_wave = wave[item->node_id] + 1;
+    auto visit = [&](int32_t dst_id) {
+      wave[dst_id] = std::max(wave[dst_id], next_wave);
+      if (--pending[dst_id] == 0) {
+        topo_order.push_back(&gview_.node_ref(dst_id));
+        num_waves = std::max(num_waves, wave[dst_id] + 1);
+      }
+    };
+    for (const EdgeInfo& e : item->output_edges()) visit(e.dst_id);
+    for (const ControlEdgeInfo& e : item->output_control_edges()) {
+      visit(e.dst_id);
+    }
+  }
+  if (static_cast<int32_t>(topo_order.size()) != num_scheduled_nodes) {
+    return errors::FailedPrecondition(
+        "Cannot build a static schedule for a graph with a cycle: only ",
+        topo_order.size(), " of ", num_scheduled_nodes,
+        " nodes are reachable in topological order.");
+  }
+
+  // Bucket the nodes by wave, preserving the topological order within each
+  // wave.
+  auto schedule = std::make_unique<StaticSchedule>();
+  schedule->wave_offsets.assign(num_waves + 1, 0);
+  for (const NodeItem* item : topo_order) {
+    ++schedule->wave_offsets[wave[item->node_id] + 1];
+  }
+  for (int32_t i = 0; i < num_waves; ++i) {
+    schedule->wave_offsets[i + 1] += schedule->wave_offsets[i];
+  }
+  std::vector<int32> next_slot(schedule->wave_offsets.begin(),
+                               schedule->wave_offsets.end() - 1);
+  schedule->nodes.resize(topo_order.size());
+  for (const NodeItem* item : topo_order) {
+    schedule->nodes[next_slot[wave[item->node_id]]++] = item;
+  }
+
+  VLOG(1) << "Built static schedule with " << num_waves << " waves for "
+          << topo_order.size() << " nodes.";
+  static_schedule_ = std::move(schedule);
+  return absl::OkStatus();
+}
+
 void ImmutableExecutorState::InitializePending(const Graph* graph,
                                                const ControlFlowInfo& cf_info) {
   for (auto& it : cf_info.unique_frame_names) {
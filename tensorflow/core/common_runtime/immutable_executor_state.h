@@ -21,6 +21,7 @@ limitations under the License.
 #include <vector>
 
 #include "absl/container/flat_hash_map.h"
+#include "absl/types/span.h"
 #include "tensorflow/core/common_runtime/graph_view.h"
 #include "tensorflow/core/common_runtime/local_executor_params.h"
 #include "tensorflow/core/common_runtime/pending_counts.h"
@@ -28,6 +29,7 @@ limitations under the License.
 #include "tensorflow/core/lib/core/status.h"
 #include "tensorflow/core/lib/gtl/flatmap.h"
 #include "tensorflow/core/lib/gtl/flatset.h"
+#include "tensorflow/core/lib/gtl/inlined_vector.h"
 #include "tensorflow/core/platform/macros.h"
 #include "tensorflow/core/platform/types.h"
 
@@ -74,6 +76,34 @@ class ImmutableExecutorState {
     int32 parallel_iterations;
   };
 
+  // A fixed topological order of the nodes in a graph without control flow,
+  // grouped into "waves". Every node in wave `i` depends only on nodes in
+  // waves `0, ..., i - 1`, so all nodes in a wave may run concurrently once
+  // the previous wave has completed.
+  struct StaticSchedule {
+    // The nodes of every wave, concatenated in wave order.
+    std::vector<const NodeItem*> nodes;
+
+    // `wave_offsets[i]` is the index in `nodes` of the first node in wave `i`.
+    // The last element is equal to `nodes.size()`.
+    std::vector<int32> wave_offsets;
+
+    int num_waves() const { return wave_offsets.size() - 1; }
+    int wave_size(int wave) const {
+      return wave_offsets[wave + 1] - wave_offsets[wave];
+    }
+    const NodeItem* const* wave_begin(int wave) const {
+      return nodes.data() + wave_offsets[wave];
+    }
+  };
+
+  // An output of a node that is the input of the `_Retval` node with index
+  // `retval_index`.
+  struct RetvalOutput {
+    int32 output_slot;
+    int32 retval_index;
+  };
+
   explicit ImmutableExecutorState(const LocalExecutorParams& p)
       : params_(p), gview_() {}
   ~ImmutableExecutorState();
@@ -101,6 +131,34 @@ class ImmutableExecutorState {
 
   bool requires_control_flow_support() const { return requires_control_flow_; }
 
+  // Returns true iff any node has a nonzero `NodeItem::scheduling_priority`.
+  bool has_scheduling_priorities() const { return has_scheduling_priorities_; }
+
+  // Computes a `StaticSchedule` for the graph, which can be retrieved using
+  // `static_schedule()`.
+  //
+  // Returns an error if the graph requires control flow support.
+  //
+  // REQUIRES: `Initialize()` has returned OK.
+  Status BuildStaticSchedule();
+
+  // Returns the schedule computed by `BuildStaticSchedule()`, or nullptr if
+  // it has not been built.
+  const StaticSchedule* static_schedule() const {
+    return static_schedule_.get();
+  }
+
+  // Returns true iff the graph contains any `_Retval` nodes.
+  bool has_retval_outputs() const { return !retval_outputs_.empty(); }
+
+  // Returns the outputs of node `node_id` that are returned by `_Retval`
+  // nodes.
+  //
+  // REQUIRES: `has_retval_outputs()`.
+  absl::Span<const RetvalOutput> retval_outputs(int32 node_id) const {
+    return retval_outputs_[node_id];
+  }
+
   // Copies the pending counts for nodes in this graph to the given array.
   //
   // This method provides a more efficient way of initializing
@@ -132,6 +190,7 @@ class ImmutableExecutorState {
   LocalExecutorParams params_;
   GraphView gview_;
   bool requires_control_flow_;
+  bool has_scheduling_priorities_ = false;
   std::vector<PendingCounts::Handle> pending_ids_;
 
   // Root nodes (with no in edges) that should form the initial ready queue
@@ -155,6 +214,14 @@ class ImmutableExecutorState {
   // Shallow copies of the constant tensors used in the graph.
   std::vector<Tensor> const_tensors_;
 
+  // If non-null, a precomputed wave schedule for the graph. See
+  // `BuildStaticSchedule()`.
+  std::unique_ptr<StaticSchedule> static_schedule_;
+
+  // If the graph contains any `_Retval` nodes, this vector maps dense node IDs
+  // to the outputs of the node that are returned.
+  std::vector<gtl::InlinedVector<RetvalOutput, 1>> retval_outputs_;
+
   ImmutableExecutorState(const ImmutableExecutorState&) = delete;
   void operator=(const ImmutableExecutorState&) = delete;
 };
@@ -0,0 +1,150 @@
+/* Copyright 2015 The TensorFlow Authors. All Rights Reserved.
+
+Licensed under the Apache License, Version 2.0 (the "License");
+you may not use this file except in compliance with the License.
+You may obtain a copy of the License at
+
+    http://www.apache.org/licenses/LICENSE-2.0
+
+Unless required by applicable law or agreed to in writing, software
+distributed under the License is distributed on an "AS IS" BASIS,
+WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+See the License for the specific language governing permissions and
+limitations under the License.
+==============================================================================*/
+#ifndef TENSORFLOW_CORE_COMMON_RUNTIME_KERNEL_STATS_H_
+#define TENSORFLOW_CORE_COMMON_RUNTIME_KERNEL_STATS_H_
+
+#include <atomic>
+#include <cstdint>
+#include <memory>
+#include <vector>
+
+#include "tensorflow/core/common_runtime/graph_view.h"
+#include "tensorflow/core/framework/op_kernel.h"
+#include "tensorflow/core/platform/types.h"
+
+namespace tensorflow {
+
+// Stores execution time information about the kernels in an executor's graph.
+//
+// The per-node estimates are indexed by `NodeItem::node_id`, because
+// `NodeItem` is shared, immutable graph state.
+class KernelStats {
+ public:
+  KernelStats() = default;
+
+  void Initialize(const GraphView& gview) {
+    std::vector<bool> has_expensive_marker(gview.num_nodes());
+    for (int32_t i = 0; i < gview.num_nodes(); ++i) {
+      has_expensive_marker[i] = gview.node(i) && gview.node(i)->kernel &&
+                                gview.node(i)->kernel->IsExpensive();
+    }
+    Initialize(has_expensive_marker);
+  }
+
+  // Initializes the estimates for a graph whose node `i` has a kernel for
+  // which `IsExpensive()` returns `has_expensive_marker[i]`.
+  void Initialize(const std::vector<bool>& has_expensive_marker) {
+    const size_t num_nodes = has_expensive_marker.size();
+    is_expensive_ = has_expensive_marker;
+    cost_estimates_ = std::make_unique<std::atomic_uint_fast64_t[]>(num_nodes);
+    for (size_t i = 0; i < num_nodes; ++i) {
+      // Kernels that claim to be expensive start out expensive, and all
+      // other kernels start out inexpensive, until measurements show
+      // otherwise.
+      cost_estimates_[i] = is_expensive_[i] ? kInitialCostEstimateCycles : 0;
+    }
+  }
+
+  // Returns true iff the given node is considered "expensive". The
+  // executor uses this flag to optimize graph execution, for example
+  // by "inlining" inexpensive kernels.
+  bool IsExpensive(const NodeItem& node) const {
+    return CostEstimate(node) > kOpIsExpensiveThresholdCycles;
+  }
+
+  // Returns the current estimate of the cost (in CPU cycles) of running the
+  // given node.
+  uint64 CostEstimate(const NodeItem& node) const {
+    return cost_estimates_[node.node_id].load(std::memory_order_relaxed);
+  }
+
+  // Returns the value of kernel->IsExpensive().
+  bool HasExpensiveMarker(const NodeItem& node) const {
+    return is_expensive_[node.node_id];
+  }
+
+  // Returns true iff the running time of an execution of the given
+  // synchronous node that started at `start_cycles` should be passed to
+  // `UpdateCostEstimate()`.
+  //
+  // Expensive kernels are always sampled. Inexpensive kernels are sampled
+  // with ~1/16 probability, or ~1/64 probability if they do not have the
+  // `IsExpensive()` marker, since those are rarely expensive. This assumes
+  // that the last bits of the CPU cycle count are uniformly distributed.
+  bool ShouldSampleCost(const NodeItem& node, uint64 start_cycles) const {
+    if (IsExpensive(node)) return true;
+    const uint64 skip_count =
+        HasExpensiveMarker(node)
+            ? kKernelExecutionTrackingInvocationSkipCount
+            : kUnmarkedKernelExecutionTrackingInvocationSkipCount;
+    return start_cycles % skip_count == 0;
+  }
+
+  // Updates the dynamic cost estimate, which is used to determine whether the
+  // given node is expensive. The new cost estimate is a weighted average of
+  // the old cost estimate and the latest cost. Estimates are updated for all
+  // synchronous kernels, so that kernels whose `IsExpensive()` marker is
+  // wrong in either direction are eventually classified correctly.
+  void UpdateCostEstimate(const NodeItem& node, uint64 elapsed_cycles) {
+    // N.B. Updates to `cost_estimate` are atomic but unlocked.  Simultaneous
+    // updates may result in one or more updates being ignored.  This does not
+    // affect correctness but may slow down the update frequency.
+    std::atomic_uint_fast64_t& cost_estimate = cost_estimates_[node.node_id];
+    auto prev_estimate = cost_estimate.load(std::memory_order_relaxed);
+
+    uint64 new_estimate =
+        ((kCostDecay - 1) * prev_estimate + elapsed_cycles) / kCostDecay;
+
+    cost_estimate.store(new_estimate, std::memory_order_relaxed);
+  }
+
+  // Returns true iff the given inexpensive node fits in a batch of nodes that
+  // a single thread runs inline, whose estimated cost so far is
+  // `*batch_cost`, and if so adds the node's cost to `*batch_cost`. A node
+  // always fits in an empty batch, so that every batch makes progress.
+  bool AddToInlineBatch(const NodeItem& node, bool batch_is_empty,
+                        uint64* batch_cost) const {
+    const uint64 cost = CostEstimate(node);
+    if (!batch_is_empty && *batch_cost + cost > kInlineBatchCostBudgetCycles) {
+      return false;
+    }
+    *batch_cost += cost;
+    return true;
+  }
+
+  // The maximum total estimated cost (in CPU cycles) of inexpensive nodes
+  // that a single thread will run inline before handing the remaining
+  // inexpensive nodes to the inter-op thread pool in batches.
+  static constexpr uint64 kInlineBatchCostBudgetCycles = 64 * 1000;
+
+  // Initial time (in CPU cycles) we expect an operation to take.  Used to
+  // determine whether an operation should be place in a threadpool.
+  // Operations marked as expensive start out "expensive".
+  static constexpr uint64 kInitialCostEstimateCycles = 100 * 1000 * 1000;
+  static constexpr uint64 kOpIsExpensiveThresholdCycles = 8000;
+
+ private:
+  static constexpr uint64 kCostDecay = 10;
+  static constexpr uint64 kKernelExecutionTrackingInvocationSkipCount = 16;
+  static constexpr uint64 kUnmarkedKernelExecutionTrackingInvocationSkipCount =
+      64;
+
+  std::vector<bool> is_expensive_;
+  std::unique_ptr<std::atomic_uint_fast64_t[]> cost_estimates_;
+};
+
+}  // namespace tensorflow
+
+#endif  // TENSORFLOW_CORE_COMMON_RUNTIME_KERNEL_STATS_H_
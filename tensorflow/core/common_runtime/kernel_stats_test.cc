@@ -0,0 +1,173 @@
+/* Copyright 2015 The TensorFlow Authors. All Rights Reserved.
+
+Licensed under the Apache License, Version 2.0 (the "License");
+you may not use this file except in compliance with the License.
+You may obtain a copy of the License at
+
+    http://www.apache.org/licenses/LICENSE-2.0
+
+Unless required by applicable law or agreed to in writing, software
+distributed under the License is distributed on an "AS IS" BASIS,
+WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+See the License for the specific language governing permissions and
+limitations under the License.
+==============================================================================*/
+
+#include "tensorflow/core/common_runtime/kernel_stats.h"
+
+#include <vector>
+
+#include "tensorflow/core/common_runtime/graph_view.h"
+#include "tensorflow/core/platform/test.h"
+#include "tensorflow/core/platform/types.h"
+
+namespace tensorflow {
+namespace {
+
+std::vector<NodeItem> MakeNodeItems(int num_nodes) {
+  std::vector<NodeItem> items(num_nodes);
+  for (int i = 0; i < num_nodes; ++i) {
+    items[i].node_id = i;
+  }
+  return items;
+}
+
+// Sets the cost estimate of an initially inexpensive, unmarked `node` to
+// `cost` by recording a single sample.
+void SetCostEstimate(KernelStats* stats, const NodeItem& node, uint64 cost) {
+  ASSERT_EQ(stats->CostEstimate(node), 0);
+  stats->UpdateCostEstimate(node, cost * 10);
+  ASSERT_EQ(stats->CostEstimate(node), cost);
+}
+
+// Splits `nodes` into inline batches the way `ExecutorState::ScheduleReady`
+// splits its overflow of inexpensive nodes, and returns the batch sizes.
+std::vector<int> InlineBatchSizes(const KernelStats& stats,
+                                  const std::vector<NodeItem>& nodes) {
+  std::vector<int> sizes;
+  auto it = nodes.begin();
+  while (it < nodes.end()) {
+    auto end = it;
+    uint64 batch_cost = 0;
+    while (end < nodes.end() &&
+           stats.AddToInlineBatch(*end, end == it, &batch_cost)) {
+      ++end;
+    }
+    sizes.push_back(end - it);
+    it = end;
+  }
+  return sizes;
+}
+
+TEST(KernelStatsTest, InitialEstimatesFollowExpensiveMarker) {
+  std::vector<NodeItem> nodes = MakeNodeItems(2);
+  KernelStats stats;
+  stats.Initialize({true, false});
+
+  EXPECT_TRUE(stats.HasExpensiveMarker(nodes[0]));
+  EXPECT_TRUE(stats.IsExpensive(nodes[0]));
+  EXPECT_EQ(stats.CostEstimate(nodes[0]),
+            KernelStats::kInitialCostEstimateCycles);
+
+  EXPECT_FALSE(stats.HasExpensiveMarker(nodes[1]));
+  EXPECT_FALSE(stats.IsExpensive(nodes[1]));
+  EXPECT_EQ(stats.CostEstimate(nodes[1]), 0);
+}
+
+TEST(KernelStatsTest, UnmarkedKernelBecomesExpensiveAfterSampling) {
+  std::vector<NodeItem> nodes = MakeNodeItems(1);
+  KernelStats stats;
+  stats.Initialize({false});
+
+  // A single slow sample is enough to reclassify a kernel that does not
+  // claim to be expensive.
+  stats.UpdateCostEstimate(nodes[0],
+                           20 * KernelStats::kOpIsExpensiveThresholdCycles);
+  EXPECT_TRUE(stats.IsExpensive(nodes[0]));
+
+  // Once expensive, every execution is sampled.
+  EXPECT_TRUE(stats.ShouldSampleCost(nodes[0], /*start_cycles=*/1));
+}
+
+TEST(KernelStatsTest, MarkedKernelBecomesInexpensiveAfterSampling) {
+  std::vector<NodeItem> nodes = MakeNodeItems(1);
+  KernelStats stats;
+  stats.Initialize({true});
+
+  int num_samples = 0;
+  while (stats.IsExpensive(nodes[0])) {
+    ASSERT_LT(num_samples, 1000);
+    stats.UpdateCostEstimate(nodes[0], /*elapsed_cycles=*/100);
+    ++num_samples;
+  }
+  // The initial estimate decays geometrically, so a cheap kernel that claims
+  // to be expensive is reclassified after a bounded number of samples.
+  EXPECT_GT(num_samples, 1);
+  EXPECT_FALSE(stats.IsExpensive(nodes[0]));
+  EXPECT_TRUE(stats.HasExpensiveMarker(nodes[0]));
+}
+
+TEST(KernelStatsTest, InexpensiveKernelsAreSampledByMarker) {
+  std::vector<NodeItem> nodes = MakeNodeItems(2);
+  KernelStats stats;
+  stats.Initialize({true, false});
+  while (stats.IsExpensive(nodes[0])) {
+    stats.UpdateCostEstimate(nodes[0], /*elapsed_cycles=*/0);
+  }
+
+  int marked_samples = 0;
+  int unmarked_samples = 0;
+  for (uint64 start_cycles = 0; start_cycles < 1024; ++start_cycles) {
+    marked_samples += stats.ShouldSampleCost(nodes[0], start_cycles);
+    unmarked_samples += stats.ShouldSampleCost(nodes[1], start_cycles);
+  }
+  EXPECT_EQ(marked_samples, 1024 / 16);
+  EXPECT_EQ(unmarked_samples, 1024 / 64);
+}
+
+TEST(KernelStatsTest, InlineBatchIsSplitOnceBudgetIsExceeded) {
+  constexpr uint64 kCost = 7000;
+  static_assert(kCost <= KernelStats::kOpIsExpensiveThresholdCycles);
+  constexpr int kNodesPerBatch =
+      KernelStats::kInlineBatchCostBudgetCycles / kCost;
+  constexpr int kNumNodes = 2 * kNodesPerBatch + 1;
+
+  std::vector<NodeItem> nodes = MakeNodeItems(kNumNodes);
+  KernelStats stats;
+  stats.Initialize(std::vector<bool>(kNumNodes, false));
+  for (const NodeItem& node : nodes) {
+    SetCostEstimate(&stats, node, kCost);
+    ASSERT_FALSE(stats.IsExpensive(node));
+  }
+
+  EXPECT_EQ(InlineBatchSizes(stats, nodes),
+            std::vector<int>({kNodesPerBatch, kNodesPerBatch, 1}));
+}
+
+TEST(KernelStatsTest, FreeNodesAreNeverSplit) {
+  std::vector<NodeItem> nodes = MakeNodeItems(100);
+  KernelStats stats;
+  stats.Initialize(std::vector<bool>(nodes.size(), false));
+
+  EXPECT_EQ(InlineBatchSizes(stats, nodes), std::vector<int>({100}));
+}
+
+TEST(KernelStatsTest, NodeAlwaysFitsInEmptyBatch) {
+  std::vector<NodeItem> nodes = MakeNodeItems(1);
+  KernelStats stats;
+  stats.Initialize({false});
+  SetCostEstimate(&stats, nodes[0], KernelStats::kOpIsExpensiveThresholdCycles);
+
+  uint64 batch_cost = KernelStats::kInlineBatchCostBudgetCycles;
+  EXPECT_FALSE(
+      stats.AddToInlineBatch(nodes[0], /*batch_is_empty=*/false, &batch_cost));
+  EXPECT_EQ(batch_cost, KernelStats::kInlineBatchCostBudgetCycles);
+
+  EXPECT_TRUE(
+      stats.AddToInlineBatch(nodes[0], /*batch_is_empty=*/true, &batch_cost));
+  EXPECT_EQ(batch_cost, KernelStats::kInlineBatchCostBudgetCycles +
+                            KernelStats::kOpIsExpensiveThresholdCycles);
+}
+
+}  // namespace
+}  // namespace tensorflow
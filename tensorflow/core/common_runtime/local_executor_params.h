@@ -50,6 +50,16 @@ struct LocalExecutorParams {
 
   // Whether control flow nodes are allowed to be executed synchronously.
   bool allow_control_flow_sync_execution = false;
+
+  // Whether intermediate tensors on CPU devices are allocated from a
+  // per-step arena whose layout is planned from a recorded step. Has no effect
+  // on graphs that require control flow support.
+  bool use_step_arena_allocator = false;
+
+  // If positive, the memory that nodes allocate with default allocator
+  // attributes is attributed to them in one in every
+  // `memory_attribution_sample_period` steps (see `NodeMemoryAttribution`).
+  int64_t memory_attribution_sample_period = 0;
 };
 
 }  // end namespace tensorflow
@@ -0,0 +1,212 @@
+/* Copyright 2024 The TensorFlow Authors. All Rights Reserved.
+
+Licensed under the Apache License, Version 2.0 (the "License");
+you may not use this file except in compliance with the License.
+You may obtain a copy of the License at
+
+    http://www.apache.org/licenses/LICENSE-2.0
+
+Unless required by applicable law or agreed to in writing, software
+distributed under the License is distributed on an "AS IS" BASIS,
+WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+See the License for the specific language governing permissions and
+limitations under the License.
+==============================================================================*/
+#include "tensorflow/core/common_runtime/node_memory_attribution.h"
+
+#include <iterator>
+#include <utility>
+
+#include "absl/container/flat_hash_set.h"
+#include "tensorflow/core/platform/logging.h"
+#include "tensorflow/core/profiler/lib/traceme.h"
+#include "tensorflow/core/profiler/lib/traceme_encode.h"
+
+namespace tensorflow {
+
+namespace {
+
+// The attribution and node on whose behalf the current thread is allocating.
+struct ThreadAttributionState {
+  NodeMemoryAttribution* attribution = nullptr;
+  int32 node_id = -1;
+};
+
+thread_local ThreadAttributionState current_attribution_state;
+
+// The live attributions, for `NodeMemoryAttribution::CollectAll()`.
+struct Registry {
+  mutex mu;
+  absl::flat_hash_set<NodeMemoryAttribution*> attributions TF_GUARDED_BY(mu);
+};
+
+Registry* GetRegistry() {
+  static Registry* registry = new Registry;
+  return registry;
+}
+
+}  // namespace
+
+NodeMemoryAttribution::ScopedNode::ScopedNode(
+    NodeMemoryAttribution* attribution, int32 node_id)
+    : saved_attribution_(current_attribution_state.attribution),
+      saved_node_id_(current_attribution_state.node_id) {
+  current_attribution_state.attribution = attribution;
+  current_attribution_state.node_id = node_id;
+}
+
+NodeMemoryAttribution::ScopedNode::~ScopedNode() {
+  current_attribution_state.attribution = saved_attribution_;
+  current_attribution_state.node_id = saved_node_id_;
+}
+
+NodeMemoryAttribution::NodeMemoryAttribution(
+    Allocator* base, std::string device, std::vector<std::string> node_names,
+    std::vector<std::string> node_ops, int64_t sample_period)
+    : base_(base),
+      device_(std::move(device)),
+      node_names_(std::move(node_names)),
+      node_ops_(std::move(node_ops)),
+      sample_period_(sample_period),
+      counters_(new NodeCounters[node_names_.size()]) {
+  DCHECK_EQ(node_names_.size(), node_ops_.size());
+  Registry* registry = GetRegistry();
+  mutex_lock l(registry->mu);
+  registry->attributions.insert(this);
+}
+
+NodeMemoryAttribution::~NodeMemoryAttribution() {}
+
+void NodeMemoryAttribution::Release() {
+  {
+    Registry* registry = GetRegistry();
+    mutex_lock l(registry->mu);
+    registry->attributions.erase(this);
+  }
+  Unref();
+}
+
+void NodeMemoryAttribution::Unref() {
+  if (refs_.fetch_sub(1, std::memory_order_acq_rel) == 1) {
+    delete this;
+  }
+}
+
+bool NodeMemoryAttribution::MaybeStartStep() {
+  if (sample_period_ < 1) return false;
+  return num_steps_.fetch_add(1, std::memory_order_relaxed) % sample_period_ ==
+         0;
+}
+
+int32 NodeMemoryAttribution::CurrentNode() const {
+  return current_attribution_state.attribution == this
+             ? current_attribution_state.node_id
+             : -1;
+}
+
+void* NodeMemoryAttribution::AllocateRaw(size_t alignment, size_t num_bytes) {
+  void* ptr = base_->AllocateRaw(alignment, num_bytes);
+  if (ptr != nullptr) RecordAllocation(ptr, num_bytes);
+  return ptr;
+}
+
+void* NodeMemoryAttribution::AllocateRaw(
+    size_t alignment, size_t num_bytes,
+    const AllocationAttributes& allocation_attr) {
+  void* ptr = base_->AllocateRaw(alignment, num_bytes, allocation_attr);
+  if (ptr != nullptr) RecordAllocation(ptr, num_bytes);
+  return ptr;
+}
+
+void NodeMemoryAttribution::RecordAllocation(void* ptr, size_t num_bytes) {
+  // Every allocation holds a reference, since its buffer will be returned
+  // through `this` even if it was not attributed.
+  refs_.fetch_add(1, std::memory_order_relaxed);
+  const int32 node_id = CurrentNode();
+  if (node_id < 0) return;
+  DCHECK_LT(node_id, node_names_.size());
+  {
+    AllocationShard& shard = ShardFor(ptr);
+    mutex_lock l(shard.mu);
+    shard.allocations[ptr] = {node_id, num_bytes};
+  }
+
+  NodeCounters& counters = counters_[node_id];
+  counters.num_allocs.fetch_add(1, std::memory_order_relaxed);
+  counters.total_bytes.fetch_add(num_bytes, std::memory_order_relaxed);
+  const int64_t live_bytes =
+      counters.live_bytes.fetch_add(num_bytes, std::memory_order_relaxed) +
+      num_bytes;
+  int64_t peak_bytes = counters.peak_bytes.load(std::memory_order_relaxed);
+  while (live_bytes > peak_bytes) {
+    if (counters.peak_bytes.compare_exchange_weak(peak_bytes, live_bytes,
+                                                  std::memory_order_relaxed)) {
+      profiler::TraceMe::InstantActivity(
+          [this, node_id, live_bytes]() {
+            return profiler::TraceMeEncode(
+                "NodeMemoryHighWaterMark",
+                {{"device", device_},
+                 {"node", node_names_[node_id]},
+                 {"op", node_ops_[node_id]},
+                 {"peak_bytes", live_bytes}});
+          },
+          /*level=*/profiler::TraceMeLevel::kInfo);
+      break;
+    }
+  }
+}
+
+void NodeMemoryAttribution::DeallocateRaw(void* ptr) {
+  Allocation allocation;
+  bool attributed = false;
+  {
+    AllocationShard& shard = ShardFor(ptr);
+    mutex_lock l(shard.mu);
+    auto it = shard.allocations.find(ptr);
+    if (it != shard.allocations.end()) {
+      allocation = it->second;
+      shard.allocations.erase(it);
+      attributed = true;
+    }
+  }
+  base_->DeallocateRaw(ptr);
+  if (attributed) {
+    counters_[allocation.node_id].live_bytes.fetch_sub(
+        allocation.num_bytes, std::memory_order_relaxed);
+  }
+  Unref();
+}
+
+std::vector<NodeMemoryAttribution::NodeStats>
+NodeMemoryAttribution::GetNodeStats() const {
+  std::vector<NodeStats> stats;
+  for (int32 i = 0; i < node_names_.size(); ++i) {
+    const NodeCounters& counters = counters_[i];
+    const int64_t num_allocs =
+        counters.num_allocs.load(std::memory_order_relaxed);
+    if (num_allocs == 0) continue;
+    NodeStats node_stats;
+    node_stats.device = device_;
+    node_stats.node_name = node_names_[i];
+    node_stats.op = node_ops_[i];
+    node_stats.live_bytes = counters.live_bytes.load(std::memory_order_relaxed);
+    node_stats.peak_bytes = counters.peak_bytes.load(std::memory_order_relaxed);
+    node_stats.total_bytes =
+        counters.total_bytes.load(std::memory_order_relaxed);
+    node_stats.num_allocs = num_allocs;
+    stats.push_back(std::move(node_stats));
+  }
+  return stats;
+}
+
+void NodeMemoryAttribution::CollectAll(std::vector<NodeStats>* stats) {
+  Registry* registry = GetRegistry();
+  mutex_lock l(registry->mu);
+  for (const NodeMemoryAttribution* attribution : registry->attributions) {
+    std::vector<NodeStats> node_stats = attribution->GetNodeStats();
+    stats->insert(stats->end(), std::make_move_iterator(node_stats.begin()),
+                  std::make_move_iterator(node_stats.end()));
+  }
+}
+
+}  // namespace tensorflow
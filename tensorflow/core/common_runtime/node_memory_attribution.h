@@ -0,0 +1,185 @@
+/* Copyright 2024 The TensorFlow Authors. All Rights Reserved.
+
+Licensed under the Apache License, Version 2.0 (the "License");
+you may not use this file except in compliance with the License.
+You may obtain a copy of the License at
+
+    http://www.apache.org/licenses/LICENSE-2.0
+
+Unless required by applicable law or agreed to in writing, software
+distributed under the License is distributed on an "AS IS" BASIS,
+WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+See the License for the specific language governing permissions and
+limitations under the License.
+==============================================================================*/
+#ifndef TENSORFLOW_CORE_COMMON_RUNTIME_NODE_MEMORY_ATTRIBUTION_H_
+#define TENSORFLOW_CORE_COMMON_RUNTIME_NODE_MEMORY_ATTRIBUTION_H_
+
+#include <array>
+#include <atomic>
+#include <memory>
+#include <string>
+#include <vector>
+
+#include "absl/container/flat_hash_map.h"
+#include "absl/types/optional.h"
+#include "tensorflow/core/framework/allocator.h"
+#include "tensorflow/core/platform/mutex.h"
+#include "tensorflow/core/platform/thread_annotations.h"
+#include "tensorflow/core/platform/types.h"
+
+namespace tensorflow {
+
+// An allocator that attributes the memory allocated by the kernels of one
+// executor to the nodes that allocated it, at low enough cost to stay enabled
+// in production.
+//
+// One in every `sample_period` steps is selected by `MaybeStartStep()`. While
+// a `ScopedNode` is in scope during a selected step, allocations made through
+// this allocator by the current thread are attributed to its node. Other
+// allocations, including those made by intra-op worker threads, are forwarded
+// to the base allocator without any bookkeeping.
+//
+// For every node, the live bytes, their high-water mark, and the total bytes
+// allocated are kept in a table of atomics. The node and size of each
+// attributed allocation are recorded in an address-sharded map, so that
+// deallocations, which often happen on other threads after the step, can be
+// attributed too. When a node reaches a new high-water mark while the
+// profiler is active, a "NodeMemoryHighWaterMark" event is recorded.
+//
+// A `NodeMemoryAttribution` deletes itself once `Release()` has been called
+// and all of the memory that was allocated through it has been deallocated.
+class NodeMemoryAttribution : public Allocator {
+ public:
+  // The memory attributed to one node.
+  struct NodeStats {
+    std::string device;
+    std::string node_name;
+    std::string op;
+    int64_t live_bytes = 0;
+    int64_t peak_bytes = 0;
+    int64_t total_bytes = 0;
+    int64_t num_allocs = 0;
+  };
+
+  // While in scope, attributable allocations made through `attribution` by
+  // the current thread are attributed to node `node_id`.
+  class ScopedNode {
+   public:
+    ScopedNode(NodeMemoryAttribution* attribution, int32 node_id);
+    ~ScopedNode();
+
+   private:
+    NodeMemoryAttribution* const saved_attribution_;
+    const int32 saved_node_id_;
+
+    ScopedNode(const ScopedNode&) = delete;
+    void operator=(const ScopedNode&) = delete;
+  };
+
+  // Attributes the allocations that the nodes named `node_names`, indexed by
+  // node id, make from `base` on `device`. `node_ops[i]` is the op of node
+  // `i`. If `sample_period` is less than 1, no steps are attributed.
+  NodeMemoryAttribution(Allocator* base, std::string device,
+                        std::vector<std::string> node_names,
+                        std::vector<std::string> node_ops,
+                        int64_t sample_period);
+
+  // Releases the owner's reference. `this` must not be used to attribute new
+  // allocations after this call.
+  void Release();
+
+  // Returns true iff the step that is starting is selected for attribution.
+  bool MaybeStartStep();
+
+  std::string Name() override { return base_->Name(); }
+  void* AllocateRaw(size_t alignment, size_t num_bytes) override;
+  void* AllocateRaw(size_t alignment, size_t num_bytes,
+                    const AllocationAttributes& allocation_attr) override;
+  void DeallocateRaw(void* ptr) override;
+  bool TracksAllocationSizes() const override {
+    return base_->TracksAllocationSizes();
+  }
+  bool AllocatesOpaqueHandle() const override {
+    return base_->AllocatesOpaqueHandle();
+  }
+  size_t RequestedSize(const void* ptr) const override {
+    return base_->RequestedSize(ptr);
+  }
+  size_t AllocatedSize(const void* ptr) const override {
+    return base_->AllocatedSize(ptr);
+  }
+  int64_t AllocationId(const void* ptr) const override {
+    return base_->AllocationId(ptr);
+  }
+  size_t AllocatedSizeSlow(const void* ptr) const override {
+    return base_->AllocatedSizeSlow(ptr);
+  }
+  absl::optional<AllocatorStats> GetStats() override {
+    return base_->GetStats();
+  }
+  AllocatorMemoryType GetMemoryType() const override {
+    return base_->GetMemoryType();
+  }
+
+  Allocator* base() const { return base_; }
+
+  // Returns the memory attributed to each node that has allocated memory.
+  std::vector<NodeStats> GetNodeStats() const;
+
+  // Appends the memory attributed to each node by every live
+  // `NodeMemoryAttribution` in the process to `*stats`.
+  static void CollectAll(std::vector<NodeStats>* stats);
+
+ private:
+  // The per-node counters.
+  struct NodeCounters {
+    std::atomic<int64_t> live_bytes{0};
+    std::atomic<int64_t> peak_bytes{0};
+    std::atomic<int64_t> total_bytes{0};
+    std::atomic<int64_t> num_allocs{0};
+  };
+
+  struct Allocation {
+    int32 node_id;
+    size_t num_bytes;
+  };
+
+  struct AllocationShard {
+    mutex mu;
+    absl::flat_hash_map<const void*, Allocation> allocations
+        TF_GUARDED_BY(mu);
+  };
+  static constexpr int kNumShards = 64;
+
+  ~NodeMemoryAttribution() override;
+
+  // Returns the node to which an allocation made now by the calling thread is
+  // attributed, or -1.
+  int32 CurrentNode() const;
+  void RecordAllocation(void* ptr, size_t num_bytes);
+  AllocationShard& ShardFor(const void* ptr) {
+    return shards_[(reinterpret_cast<uintptr_t>(ptr) >> 6) % kNumShards];
+  }
+  void Unref();
+
+  Allocator* const base_;
+  const std::string device_;
+  const std::vector<std::string> node_names_;
+  const std::vector<std::string> node_ops_;
+  const int64_t sample_period_;
+  const std::unique_ptr<NodeCounters[]> counters_;
+
+  std::atomic<int64_t> num_steps_{0};
+  // One reference for the owner, plus one for each live allocation.
+  std::atomic<int64_t> refs_{1};
+
+  std::array<AllocationShard, kNumShards> shards_;
+
+  NodeMemoryAttribution(const NodeMemoryAttribution&) = delete;
+  void operator=(const NodeMemoryAttribution&) = delete;
+};
+
+}  // namespace tensorflow
+
+#endif  // TENSORFLOW_CORE_COMMON_RUNTIME_NODE_MEMORY_ATTRIBUTION_H_
@@ -0,0 +1,123 @@
+/* Copyright 2024 The TensorFlow Authors. All Rights Reserved.
+
+Licensed under the Apache License, Version 2.0 (the "License");
+you may not use this file except in compliance with the License.
+You may obtain a copy of the License at
+
+    http://www.apache.org/licenses/LICENSE-2.0
+
+Unless required by applicable law or agreed to in writing, software
+distributed under the License is distributed on an "AS IS" BASIS,
+WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+See the License for the specific language governing permissions and
+limitations under the License.
+==============================================================================*/
+#include "tensorflow/core/common_runtime/node_memory_attribution.h"
+
+#include <vector>
+
+#include "tensorflow/core/framework/allocator.h"
+#include "tensorflow/core/platform/test.h"
+
+namespace tensorflow {
+namespace {
+
+NodeMemoryAttribution* NewAttribution(int64_t sample_period) {
+  return new NodeMemoryAttribution(cpu_allocator(), "/device:CPU:0",
+                                   {"a", "b", "c"}, {"OpA", "OpB", "OpC"},
+                                   sample_period);
+}
+
+TEST(NodeMemoryAttributionTest, SamplesOneInEveryPeriodSteps) {
+  NodeMemoryAttribution* attribution = NewAttribution(/*sample_period=*/4);
+  int num_sampled = 0;
+  for (int i = 0; i < 12; ++i) {
+    if (attribution->MaybeStartStep()) ++num_sampled;
+  }
+  EXPECT_EQ(3, num_sampled);
+  attribution->Release();
+
+  NodeMemoryAttribution* disabled = NewAttribution(/*sample_period=*/0);
+  EXPECT_FALSE(disabled->MaybeStartStep());
+  disabled->Release();
+}
+
+TEST(NodeMemoryAttributionTest, TracksHighWaterMarksPerNode) {
+  NodeMemoryAttribution* attribution = NewAttribution(/*sample_period=*/1);
+  std::vector<void*> a_ptrs;
+  {
+    NodeMemoryAttribution::ScopedNode scope(attribution, 0);
+    a_ptrs.push_back(attribution->AllocateRaw(64, 100));
+    a_ptrs.push_back(attribution->AllocateRaw(64, 200));
+  }
+  attribution->DeallocateRaw(a_ptrs[0]);
+  void* b_ptr;
+  {
+    NodeMemoryAttribution::ScopedNode scope(attribution, 1);
+    b_ptr = attribution->AllocateRaw(64, 50);
+  }
+  // Allocations outside of a `ScopedNode` are not attributed.
+  void* unattributed = attribution->AllocateRaw(64, 1000);
+  {
+    NodeMemoryAttribution::ScopedNode scope(attribution, 0);
+    a_ptrs.push_back(attribution->AllocateRaw(64, 10));
+  }
+
+  std::vector<NodeMemoryAttribution::NodeStats> stats =
+      attribution->GetNodeStats();
+  ASSERT_EQ(2, stats.size());
+  EXPECT_EQ("/device:CPU:0", stats[0].device);
+  EXPECT_EQ("a", stats[0].node_name);
+  EXPECT_EQ("OpA", stats[0].op);
+  EXPECT_EQ(210, stats[0].live_bytes);
+  EXPECT_EQ(300, stats[0].peak_bytes);
+  EXPECT_EQ(310, stats[0].total_bytes);
+  EXPECT_EQ(3, stats[0].num_allocs);
+  EXPECT_EQ("b", stats[1].node_name);
+  EXPECT_EQ(50, stats[1].live_bytes);
+  EXPECT_EQ(50, stats[1].peak_bytes);
+
+  attribution->DeallocateRaw(a_ptrs[1]);
+  attribution->DeallocateRaw(a_ptrs[2]);
+  attribution->DeallocateRaw(b_ptr);
+  attribution->DeallocateRaw(unattributed);
+  stats = attribution->GetNodeStats();
+  ASSERT_EQ(2, stats.size());
+  EXPECT_EQ(0, stats[0].live_bytes);
+  EXPECT_EQ(300, stats[0].peak_bytes);
+  EXPECT_EQ(0, stats[1].live_bytes);
+  attribution->Release();
+}
+
+TEST(NodeMemoryAttributionTest, AllocationsOutliveRelease) {
+  NodeMemoryAttribution* attribution = NewAttribution(/*sample_period=*/1);
+  void* ptr;
+  {
+    NodeMemoryAttribution::ScopedNode scope(attribution, 2);
+    ptr = attribution->AllocateRaw(64, 128);
+  }
+  std::vector<NodeMemoryAttribution::NodeStats> stats;
+  NodeMemoryAttribution::CollectAll(&stats);
+  bool found = false;
+  for (const auto& node_stats : stats) {
+    if (node_stats.node_name == "c") {
+      found = true;
+      EXPECT_EQ(128, node_stats.live_bytes);
+    }
+  }
+  EXPECT_TRUE(found);
+
+  // Released attributions are no longer collected, but remain valid until
+  // their memory is deallocated.
+  attribution->Release();
+  stats.clear();
+  NodeMemoryAttribution::CollectAll(&stats);
+  for (const auto& node_stats : stats) {
+    EXPECT_NE("c", node_stats.node_name);
+  }
+  static_cast<char*>(ptr)[127] = 1;
+  attribution->DeallocateRaw(ptr);
+}
+
+}  // namespace
+}  // namespace tensorflow
@@ -49,6 +49,7 @@ limitations under the License.
 #include "tensorflow/core/graph/graph.h"
 #include "tensorflow/core/graph/graph_node_util.h"
 #include "tensorflow/core/platform/env.h"
+#include "tensorflow/core/platform/fingerprint.h"
 #include "tensorflow/core/platform/refcount.h"
 #include "tensorflow/core/util/debug_data_dumper.h"
 #include "tsl/platform/env.h"
@@ -232,18 +233,64 @@ absl::StatusOr<OptimizedFunctionGraphInfo> ReadFromCache(
   return optimized_function_graph_info_restored;
 }
 
+// Returns a fingerprint of everything that determines the result of
+// `OptimizeFunctionGraph()` for the given function, other than the process
+// state that cannot be persisted:
+// 1) The function definition (without its name), and the definitions of all
+//    functions reachable from it.
+// 2) The instantiation attrs and options, including the `ConfigProto`.
+// 3) The names and types of the devices in `dev_set`.
+uint64 GetFileCacheFingerprint(
+    const string& plain_func_name, AttrSlice attrs,
+    const FunctionLibraryRuntime::InstantiateOptions& options,
+    const DeviceSet& dev_set, const FunctionLibraryDefinition& lib_def,
+    const FunctionDef& fdef) {
+  FunctionDef unnamed_fdef = fdef;
+  unnamed_fdef.mutable_signature()->clear_name();
+  uint64 fingerprint = FunctionDefHash(unnamed_fdef);
+
+  const FunctionLibraryDefinition reachable = lib_def.ReachableDefinitions(fdef);
+  std::vector<string> reachable_names = reachable.ListFunctionNames();
+  std::sort(reachable_names.begin(), reachable_names.end());
+  for (const string& name : reachable_names) {
+    fingerprint = FingerprintCat64(fingerprint, Fingerprint64(name));
+    fingerprint =
+        FingerprintCat64(fingerprint, FunctionDefHash(*reachable.Find(name)));
+  }
+
+  // The function library and state handle only identify objects in this
+  // process, so they are excluded from the key.
+  FunctionLibraryRuntime::InstantiateOptions key_options = options;
+  key_options.lib_def = nullptr;
+  key_options.state_handle.clear();
+  fingerprint = FingerprintCat64(
+      fingerprint,
+      Fingerprint64(Canonicalize(plain_func_name, attrs, key_options)));
+
+  std::vector<string> devices;
+  devices.reserve(dev_set.devices().size());
+  for (const Device* device : dev_set.devices()) {
+    devices.push_back(absl::StrCat(device->name(), "|", device->device_type()));
+  }
+  std::sort(devices.begin(), devices.end());
+  for (const string& device : devices) {
+    fingerprint = FingerprintCat64(fingerprint, Fingerprint64(device));
+  }
+  return fingerprint;
+}
+
 // Gets the full path name of the file cache.
-// TODO(b/276813768) Include more runtime specific info like env/flag
-// values, or line number. An alternative is to use the fingerprint of the
-// graph once graph building cache is enabled.
 //
 // Current file cache key components:
 // 1) Job name.
 // 2) Task ID.
 // 3) Function name (without UUID suffix).
-// 4) TF graph node count.
-string GetFileCacheName(const string& dir_name, const string& function_name,
-                        const FunctionDef* fdef) {
+// 4) The fingerprint returned by `GetFileCacheFingerprint()`.
+string GetFileCacheName(
+    const string& dir_name, const string& function_name, AttrSlice attrs,
+    const FunctionLibraryRuntime::InstantiateOptions& options,
+    const DeviceSet& dev_set, const FunctionLibraryDefinition& lib_def,
+    const FunctionDef& fdef) {
   string plain_func_name = function_name;
   // Remove the random UUID in the function name.
   if (absl::StrContains(function_name, "_")) {
@@ -252,9 +299,12 @@ string GetFileCacheName(const string& dir_name, const string& function_name,
     plain_func_name = absl::StrJoin(func_name_tokens, "_");
   }
 
-  return absl::StrCat(dir_name, "/", tsl::port::JobName(), "_",
-                      tsl::port::TaskId(), "_", plain_func_name, "_",
-                      fdef->node_def_size());
+  return absl::StrCat(
+      dir_name, "/", tsl::port::JobName(), "_", tsl::port::TaskId(), "_",
+      plain_func_name, "_",
+      absl::Hex(GetFileCacheFingerprint(plain_func_name, attrs, options,
+                                        dev_set, lib_def, fdef),
+                absl::kZeroPad16));
 }
 
 // Generates graph and return information given the input function name,
@@ -686,7 +736,8 @@ OptimizeFunctionGraphOrReadFromFileCache(
         "Failed to find function ", function_name,
         " in function library: ", lib_def->ToProto().DebugString()));
   }
-  const string file_name = GetFileCacheName(dir_name, function_name, fdef);
+  const string file_name = GetFileCacheName(dir_name, function_name, attrs,
+                                            options, dev_set, *lib_def, *fdef);
 
   // Scenario (2): File cache exists for this function; restore from the cache.
   if (env->FileExists(file_name).ok()) {
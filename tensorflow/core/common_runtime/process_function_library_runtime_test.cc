@@ -1360,17 +1360,19 @@ TEST_F(ProcessFunctionLibraryRuntimeTest, SimpleGraphAllowsSync) {
   EXPECT_GT(async_safe.Get(), 0);
 }
 
-TEST_F(ProcessFunctionLibraryRuntimeTest, UnsafeOpRequiresAsync) {
+TEST_F(ProcessFunctionLibraryRuntimeTest, ControlFlowAllowsSync) {
   auto async_safe =
       metrics::TestDelta("subgraph_async_summary", "safe_for_sync");
   auto async_unsafe_op =
       metrics::TestDelta("subgraph_async_summary", "unsafe_op");
+  auto single_threaded = metrics::TestDelta("flr_executor", "single_threaded");
   FunctionLibraryRuntime::InstantiateOptions opts =
       MakeOptions("CPU:0", {"CPU:0"}, {"CPU:0"});
   opts.allow_small_function_optimizations = true;
   TestControlFlow(this, opts);
-  EXPECT_EQ(async_safe.Get(), 0);
-  EXPECT_GT(async_unsafe_op.Get(), 0);
+  EXPECT_GT(async_safe.Get(), 0);
+  EXPECT_EQ(async_unsafe_op.Get(), 0);
+  EXPECT_GT(single_threaded.Get(), 0);
 }
 
 TEST_F(ProcessFunctionLibraryRuntimeTest, PartitionedGraphRequiresAsync) {
@@ -16,8 +16,10 @@ limitations under the License.
 #ifndef TENSORFLOW_CORE_COMMON_RUNTIME_RENDEZVOUS_MGR_H_
 #define TENSORFLOW_CORE_COMMON_RUNTIME_RENDEZVOUS_MGR_H_
 
+#include <memory>
 #include <string>
 #include <unordered_map>
+#include <utility>
 
 #include "tensorflow/core/common_runtime/device_mgr.h"
 #include "tensorflow/core/framework/local_rendezvous.h"
@@ -62,6 +64,11 @@ class RefCountedIntraProcessRendezvous : public Rendezvous {
     device_mgr_ = device_mgr;
   }
 
+  // See LocalRendezvous::SetStaticKeys.
+  void SetStaticKeys(std::shared_ptr<const StaticRendezvousKeys> keys) {
+    local_.SetStaticKeys(std::move(keys));
+  }
+
  private:
   const DeviceMgr* device_mgr_;  // Not owned.
   LocalRendezvous local_;
@@ -93,6 +100,11 @@ class PrivateIntraProcessRendezvous : public RendezvousInterface {
                  DoneCallback done) override;
   void StartAbort(const Status& status) override;
 
+  // See LocalRendezvous::SetStaticKeys.
+  void SetStaticKeys(std::shared_ptr<const StaticRendezvousKeys> keys) {
+    local_.SetStaticKeys(std::move(keys));
+  }
+
  private:
   const DeviceMgr* device_mgr_;
   LocalRendezvous local_;
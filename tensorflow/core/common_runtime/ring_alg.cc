@@ -17,8 +17,10 @@ limitations under the License.
 #include <stdlib.h>
 
 #include <atomic>
+#include <algorithm>
 #include <functional>
 #include <utility>
+#include <vector>
 
 #include "tensorflow/core/common_runtime/collective_rma_local.h"
 #include "tensorflow/core/common_runtime/collective_util.h"
@@ -27,6 +29,7 @@ limitations under the License.
 #include "tensorflow/core/common_runtime/device_mgr.h"
 #include "tensorflow/core/common_runtime/dma_helper.h"
 #include "tensorflow/core/common_runtime/process_util.h"
+#include "tensorflow/core/common_runtime/ring_autotuner.h"
 #include "tensorflow/core/framework/allocator.h"
 #include "tensorflow/core/framework/device_base.h"
 #include "tensorflow/core/framework/op_kernel.h"
@@ -53,6 +56,9 @@ constexpr size_t kMaxChunkSizeBytes = (4 * 1024 * 1024);
 // through the collectives API. A reasonable value would be a small
 // multiple of the number of NICs adjacent to each device.
 constexpr int kMaxSubdivsPerDeviceDefault = 2;
+// When autotuning, subdivisions that would make chunks smaller than this are
+// not tried.
+constexpr size_t kMinAutotuneChunkSizeBytes = (64 * 1024);
 
 namespace tensorflow {
 namespace {
@@ -107,12 +113,37 @@ RingAlg::RingAlg(CollectiveType type, const string& name)
       num_subdivs_(-1) {}
 
 namespace {
+// Returns the number of subdivisions of this execution picked by `autotuner`
+// among the powers of two up to `max_num_subdivs`.
+int AutotunedNumSubdivs(RingAutotuner* autotuner, CollectiveParams* col_params,
+                        size_t tensor_size, int max_num_subdivs) {
+  std::vector<int> candidates;
+  for (int num_subdivs = 1; num_subdivs <= max_num_subdivs; num_subdivs *= 2) {
+    const size_t chunk_size =
+        tensor_size / (col_params->group.group_size * num_subdivs);
+    if (num_subdivs > 1 && chunk_size < kMinAutotuneChunkSizeBytes) break;
+    candidates.push_back(num_subdivs);
+  }
+  return autotuner->NextNumSubdivs(
+      col_params->group.members[col_params->default_rank].device.name(),
+      col_params->group.group_key, tensor_size, candidates,
+      &col_params->instance.impl_details.autotune_trial);
+}
+
 Status GenerateSubdivsInCollectiveParams(CollectiveParams* col_params) {
   // This function generates subdivision_offsets. Expect it to be empty when
   // called.
   DCHECK(col_params->instance.impl_details.subdiv_offsets.empty());
 
-  if (col_params->instance.impl_details.max_subdivs_per_device == -1) {
+  // Autotuning is only done for reductions on CPU, whose trials are reported
+  // by RingReducer.
+  RingAutotuner* autotuner =
+      (col_params->instance.type == REDUCTION_COLLECTIVE &&
+       col_params->group.device_type == DEVICE_CPU)
+          ? RingAutotuner::Global()
+          : nullptr;
+  if (col_params->instance.impl_details.max_subdivs_per_device == -1 &&
+      autotuner == nullptr) {
     col_params->instance.impl_details.subdiv_offsets = {0};
     VLOG(2) << "Limiting to 1 subdivision as max_subdivs_per_device == -1";
     return absl::OkStatus();
@@ -148,6 +179,11 @@ Status GenerateSubdivsInCollectiveParams(CollectiveParams* col_params) {
     VLOG(2) << "num_subdivs " << num_subdivs << " num_chunks " << num_chunks
             << " chunk_size " << chunk_size;
   } while (chunk_size > kMaxChunkSizeBytes && num_subdivs < kMaxNumSubdivs);
+  if (autotuner != nullptr) {
+    num_subdivs = AutotunedNumSubdivs(autotuner, col_params, tensor_size,
+                                      kMaxNumSubdivs);
+    chunk_size = tensor_size / (col_params->group.group_size * num_subdivs);
+  }
   if (num_subdivs <= 0) {
     return errors::Internal("Unexpected num_subdivs ", num_subdivs, " in ",
                             col_params->instance.impl_details.collective_name);
@@ -265,6 +301,85 @@ Status RingAlg::InitializeCollectiveContext(
       &col_ctx->device_locality);
 }
 
+Status RingAlg::FinishAutotuneTrial(int64_t micros) {
+  RingAutotuner* autotuner = RingAutotuner::Global();
+  const int trial = col_params_->instance.impl_details.autotune_trial;
+  if (autotuner == nullptr || trial < 0) return absl::OkStatus();
+  const string& device_name =
+      col_params_->group.members[col_params_->default_rank].device.name();
+  const int32 group_key = col_params_->group.group_key;
+  const int64_t tensor_size = col_params_->instance.shape.num_elements() *
+                              DataTypeSize(col_params_->instance.data_type);
+  std::vector<int64_t> micros_per_candidate;
+  if (!autotuner->RecordTrial(device_name, group_key, tensor_size, trial,
+                              micros, &micros_per_candidate)) {
+    return absl::OkStatus();
+  }
+
+  // The devices of the group may have measured different times, so the group
+  // leader picks the candidate from the times of all devices.
+  const int num_candidates = micros_per_candidate.size();
+  const int rank = col_params_->default_rank;
+  Tensor best(DT_INT32, TensorShape({}));
+  // Sends or recvs `tensor` and waits for it.
+  auto exchange = [this](bool send, int peer, const string& key,
+                         Tensor* tensor) {
+    Notification note;
+    Status status;
+    const CollGroupMember& member = col_params_->group.members[peer];
+    auto done = [&status, &note](const Status& s) {
+      status = s;
+      note.Notify();
+    };
+    if (send) {
+      col_ctx_->col_exec->remote_access()->PostToPeer(
+          member.device.name(), member.task, key, col_ctx_->device,
+          col_ctx_->op_ctx->op_device_context(), AllocatorAttributes(), tensor,
+          col_ctx_->device_locality, col_ctx_->op_ctx->cancellation_manager(),
+          done);
+    } else {
+      col_ctx_->col_exec->remote_access()->RecvFromPeer(
+          member.device.name(), member.task, member.is_local, key,
+          col_ctx_->device, col_ctx_->op_ctx->op_device_context(),
+          AllocatorAttributes(), tensor, col_ctx_->device_locality, 0,
+          col_ctx_->op_ctx->cancellation_manager(), done);
+    }
+    note.WaitForNotification();
+    return status;
+  };
+  Tensor local(DT_INT64, TensorShape({num_candidates}));
+  std::copy(micros_per_candidate.begin(), micros_per_candidate.end(),
+            local.flat<int64_t>().data());
+  if (rank == 0) {
+    std::vector<std::vector<int64_t>> micros_per_device = {
+        micros_per_candidate};
+    for (int r = 1; r < group_size_; ++r) {
+      Tensor remote(DT_INT64, TensorShape({num_candidates}));
+      TF_RETURN_IF_ERROR(exchange(
+          /*send=*/false, r,
+          strings::StrCat(col_ctx_->exec_key, ":autotune:", r), &remote));
+      auto flat = remote.flat<int64_t>();
+      micros_per_device.emplace_back(flat.data(), flat.data() + flat.size());
+    }
+    best.scalar<int32>()() = RingAutotuner::BestCandidate(micros_per_device);
+    for (int r = 1; r < group_size_; ++r) {
+      TF_RETURN_IF_ERROR(exchange(
+          /*send=*/true, r,
+          strings::StrCat(col_ctx_->exec_key, ":autotune_best:", r), &best));
+    }
+  } else {
+    TF_RETURN_IF_ERROR(exchange(
+        /*send=*/true, 0,
+        strings::StrCat(col_ctx_->exec_key, ":autotune:", rank), &local));
+    TF_RETURN_IF_ERROR(exchange(
+        /*send=*/false, 0,
+        strings::StrCat(col_ctx_->exec_key, ":autotune_best:", rank), &best));
+  }
+  autotuner->SetBestCandidate(device_name, group_key, tensor_size,
+                              best.scalar<int32>()());
+  return absl::OkStatus();
+}
+
 string RingAlg::TensorDebugString(const Tensor& tensor) {
   const DeviceBase::AcceleratorDeviceInfo* accelerator_device_info =
       col_ctx_->op_ctx->device()->tensorflow_accelerator_device_info();
@@ -408,7 +523,8 @@ void RingAlg::DispatchSend(RingField* rf, const StatusCallback& done) {
       col_params_->group.members[send_to_dev_idx].device.name(),
       col_params_->group.members[send_to_dev_idx].task, send_buf_key,
       col_ctx_->device, col_ctx_->op_ctx->op_device_context(),
-      col_ctx_->op_ctx->output_alloc_attr(0), &rf->chunk,
+      col_ctx_->op_ctx->output_alloc_attr(0),
+      rf->wire_chunk.IsInitialized() ? &rf->wire_chunk : &rf->chunk,
       col_ctx_->device_locality, col_ctx_->op_ctx->cancellation_manager(),
       done);
 }
@@ -424,6 +540,7 @@ void RingAlg::DispatchRecv(RingField* rf, const StatusCallback& done) {
   Tensor* dst_tensor = (!rf->second_pass && (col_params_->merge_op != nullptr))
                            ? &rf->tmp_chunk
                            : &rf->chunk;
+  if (rf->wire_chunk.IsInitialized()) dst_tensor = &rf->wire_chunk;
   col_ctx_->col_exec->remote_access()->RecvFromPeer(
       col_params_->group.members[rf->recv_dev_idx].device.name(),
       col_params_->group.members[rf->recv_dev_idx].task,
@@ -48,6 +48,10 @@ class RingAlg : public CollectiveImplementationInterface {
   void StartAbort(const Status& s);
   void Finish(bool ok);
 
+  // If this execution is an autotuning trial, records that it took `micros`.
+  // After the last trial, agrees with the group on the subdivisions to use.
+  Status FinishAutotuneTrial(int64_t micros);
+
   // Current status of a RingField
   enum RingFieldAction {
     RF_INIT = 0,    // Just initialized for a pass
@@ -75,6 +79,7 @@ class RingAlg : public CollectiveImplementationInterface {
     bool is_final = false;  // is the last field in the pass for this rank
     Tensor chunk;           // alias to field values
     Tensor tmp_chunk;
+    Tensor wire_chunk;  // if initialized, sent and recv'd instead of chunk
     Status status;
     string DebugString() const;
   };
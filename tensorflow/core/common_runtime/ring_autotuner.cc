@@ -0,0 +1,126 @@
+/* Copyright 2024 The TensorFlow Authors. All Rights Reserved.
+
+Licensed under the Apache License, Version 2.0 (the "License");
+you may not use this file except in compliance with the License.
+You may obtain a copy of the License at
+
+    http://www.apache.org/licenses/LICENSE-2.0
+
+Unless required by applicable law or agreed to in writing, software
+distributed under the License is distributed on an "AS IS" BASIS,
+WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+See the License for the specific language governing permissions and
+limitations under the License.
+==============================================================================*/
+#include "tensorflow/core/common_runtime/ring_autotuner.h"
+
+#include <algorithm>
+#include <cstdint>
+#include <limits>
+#include <string>
+#include <vector>
+
+#include "absl/numeric/bits.h"
+#include "tensorflow/core/platform/logging.h"
+#include "tensorflow/core/util/env_var.h"
+
+namespace tensorflow {
+namespace {
+
+// The number of times each candidate is measured.  The fastest of them is
+// used, which discards executions slowed down by unrelated work.
+constexpr int kTrialsPerCandidate = 3;
+
+}  // namespace
+
+RingAutotuner* RingAutotuner::Global() {
+  static RingAutotuner* autotuner = []() -> RingAutotuner* {
+    bool enabled = false;
+    TF_CHECK_OK(ReadBoolFromEnvVar("TF_RING_ALG_AUTOTUNE", false, &enabled));
+    return enabled ? new RingAutotuner(kTrialsPerCandidate) : nullptr;
+  }();
+  return autotuner;
+}
+
+RingAutotuner::RingAutotuner(int trials_per_candidate)
+    : trials_per_candidate_(trials_per_candidate) {}
+
+RingAutotuner::Key RingAutotuner::MakeKey(const std::string& device,
+                                          int32_t group_key,
+                                          int64_t tensor_bytes) {
+  return Key(device, group_key,
+             absl::bit_width(static_cast<uint64_t>(tensor_bytes)));
+}
+
+int RingAutotuner::NextNumSubdivs(const std::string& device,
+                                  int32_t group_key, int64_t tensor_bytes,
+                                  const std::vector<int>& candidates,
+                                  int* trial) {
+  DCHECK(!candidates.empty());
+  mutex_lock l(mu_);
+  Bucket& bucket = buckets_[MakeKey(device, group_key, tensor_bytes)];
+  *trial = -1;
+  if (bucket.candidates.empty()) {
+    bucket.candidates = candidates;
+    bucket.micros.assign(candidates.size(),
+                         std::numeric_limits<int64_t>::max());
+    if (candidates.size() == 1) bucket.best_num_subdivs = candidates.front();
+  }
+  if (bucket.best_num_subdivs > 0) return bucket.best_num_subdivs;
+  const int num_trials = trials_per_candidate_ * bucket.candidates.size();
+  if (bucket.next_trial >= num_trials) {
+    // The last trial is still running, which only happens if the collectives
+    // of the group are not ordered.
+    return bucket.candidates.front();
+  }
+  *trial = bucket.next_trial++;
+  return bucket.candidates[*trial % bucket.candidates.size()];
+}
+
+bool RingAutotuner::RecordTrial(const std::string& device, int32_t group_key,
+                                int64_t tensor_bytes, int trial,
+                                int64_t micros,
+                                std::vector<int64_t>* micros_per_candidate) {
+  mutex_lock l(mu_);
+  Bucket& bucket = buckets_[MakeKey(device, group_key, tensor_bytes)];
+  DCHECK_LT(trial, bucket.next_trial);
+  int64_t& fastest = bucket.micros[trial % bucket.candidates.size()];
+  fastest = std::min(fastest, micros);
+  ++bucket.num_recorded;
+  if (bucket.num_recorded < trials_per_candidate_ * bucket.candidates.size()) {
+    return false;
+  }
+  *micros_per_candidate = bucket.micros;
+  return true;
+}
+
+void RingAutotuner::SetBestCandidate(const std::string& device,
+                                     int32_t group_key, int64_t tensor_bytes,
+                                     int candidate) {
+  mutex_lock l(mu_);
+  Bucket& bucket = buckets_[MakeKey(device, group_key, tensor_bytes)];
+  DCHECK_LT(candidate, bucket.candidates.size());
+  bucket.best_num_subdivs = bucket.candidates[candidate];
+  VLOG(1) << "Autotuned ring collectives of group " << group_key << " on "
+          << device << " with about " << tensor_bytes << " bytes to "
+          << bucket.best_num_subdivs << " subdivisions";
+}
+
+int RingAutotuner::BestCandidate(
+    const std::vector<std::vector<int64_t>>& micros_per_device) {
+  int best = 0;
+  int64_t best_micros = std::numeric_limits<int64_t>::max();
+  for (int c = 0; c < micros_per_device.front().size(); ++c) {
+    int64_t slowest = 0;
+    for (const std::vector<int64_t>& micros : micros_per_device) {
+      slowest = std::max(slowest, micros[c]);
+    }
+    if (slowest < best_micros) {
+      best = c;
+      best_micros = slowest;
+    }
+  }
+  return best;
+}
+
+}  // namespace tensorflow
@@ -0,0 +1,91 @@
+/* Copyright 2024 The TensorFlow Authors. All Rights Reserved.
+
+Licensed under the Apache License, Version 2.0 (the "License");
+you may not use this file except in compliance with the License.
+You may obtain a copy of the License at
+
+    http://www.apache.org/licenses/LICENSE-2.0
+
+Unless required by applicable law or agreed to in writing, software
+distributed under the License is distributed on an "AS IS" BASIS,
+WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+See the License for the specific language governing permissions and
+limitations under the License.
+==============================================================================*/
+#ifndef TENSORFLOW_CORE_COMMON_RUNTIME_RING_AUTOTUNER_H_
+#define TENSORFLOW_CORE_COMMON_RUNTIME_RING_AUTOTUNER_H_
+
+#include <cstdint>
+#include <string>
+#include <tuple>
+#include <vector>
+
+#include "absl/container/flat_hash_map.h"
+#include "tensorflow/core/platform/mutex.h"
+#include "tensorflow/core/platform/thread_annotations.h"
+
+namespace tensorflow {
+
+// Picks the number of subdivisions of ring collectives by measuring them.
+//
+// The collectives of a group on one device are tuned separately for every
+// power-of-two bucket of tensor sizes.  The first executions in a bucket are
+// trials that cycle through the candidate subdivision counts.  After the last
+// trial, the group agrees on the candidate whose slowest device was fastest,
+// and it is used by all later executions in the bucket.
+//
+// Every device of a group must execute the collectives of the group in the
+// same order, so that the trials are the same on all of them.
+class RingAutotuner {
+ public:
+  // Returns the process-wide autotuner, or nullptr if autotuning is disabled.
+  // It is enabled by setting TF_RING_ALG_AUTOTUNE to true.
+  static RingAutotuner* Global();
+
+  explicit RingAutotuner(int trials_per_candidate);
+
+  // Returns the number of subdivisions of the next execution on `device` of a
+  // collective of `group_key` with tensors of `tensor_bytes`.  `candidates`
+  // must be the same for all executions in a bucket.  Sets `*trial` to the
+  // index of the trial to report to `RecordTrial`, or to -1 if the execution
+  // is not a trial.
+  int NextNumSubdivs(const std::string& device, int32_t group_key,
+                     int64_t tensor_bytes, const std::vector<int>& candidates,
+                     int* trial);
+
+  // Records the time of `trial`.  Returns true if it was the last trial, in
+  // which case the group must agree on a candidate with `SetBestCandidate`.
+  // `*micros_per_candidate` is set to the fastest time of every candidate.
+  bool RecordTrial(const std::string& device, int32_t group_key,
+                   int64_t tensor_bytes, int trial, int64_t micros,
+                   std::vector<int64_t>* micros_per_candidate);
+
+  void SetBestCandidate(const std::string& device, int32_t group_key,
+                        int64_t tensor_bytes, int candidate);
+
+  // Returns the index of the candidate to use given the fastest time of every
+  // candidate on every device of a group.
+  static int BestCandidate(
+      const std::vector<std::vector<int64_t>>& micros_per_device);
+
+ private:
+  struct Bucket {
+    std::vector<int> candidates;
+    int next_trial = 0;
+    int num_recorded = 0;
+    std::vector<int64_t> micros;  // per candidate
+    int best_num_subdivs = -1;
+  };
+  using Key = std::tuple<std::string, int32_t, int>;
+
+  static Key MakeKey(const std::string& device, int32_t group_key,
+                     int64_t tensor_bytes);
+
+  const int trials_per_candidate_;
+  mutex mu_;
+  absl::flat_hash_map<Key, Bucket> buckets_ TF_GUARDED_BY(mu_);
+};
+
+}  // namespace tensorflow
+
+#endif  // TENSORFLOW_CORE_COMMON_RUNTIME_RING_AUTOTUNER_H_
@@ -0,0 +1,89 @@
+/* Copyright 2024 The TensorFlow Authors. All Rights Reserved.
+
+Licensed under the Apache License, Version 2.0 (the "License");
+you may not use this file except in compliance with the License.
+You may obtain a copy of the License at
+
+    http://www.apache.org/licenses/LICENSE-2.0
+
+Unless required by applicable law or agreed to in writing, software
+distributed under the License is distributed on an "AS IS" BASIS,
+WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+See the License for the specific language governing permissions and
+limitations under the License.
+==============================================================================*/
+#include "tensorflow/core/common_runtime/ring_autotuner.h"
+
+#include <cstdint>
+#include <vector>
+
+#include "tensorflow/core/platform/test.h"
+
+namespace tensorflow {
+namespace {
+
+constexpr char kDevice[] = "/job:worker/replica:0/task:0/device:CPU:0";
+constexpr int32_t kGroupKey = 7;
+
+TEST(RingAutotunerTest, TriesEveryCandidateAndKeepsTheBest) {
+  RingAutotuner autotuner(/*trials_per_candidate=*/2);
+  const std::vector<int> candidates = {1, 2, 4};
+  // Candidate 2 is the fastest.
+  const std::vector<int64_t> micros = {300, 100, 200};
+  std::vector<int> tried;
+  std::vector<int64_t> fastest;
+  for (int i = 0; i < 6; ++i) {
+    int trial;
+    tried.push_back(autotuner.NextNumSubdivs(kDevice, kGroupKey, 1 << 20,
+                                             candidates, &trial));
+    EXPECT_EQ(trial, i);
+    EXPECT_EQ(autotuner.RecordTrial(kDevice, kGroupKey, 1 << 20, trial,
+                                    micros[i % 3] + i, &fastest),
+              i == 5);
+  }
+  EXPECT_EQ(tried, (std::vector<int>{1, 2, 4, 1, 2, 4}));
+  EXPECT_EQ(fastest, (std::vector<int64_t>{300, 101, 202}));
+
+  autotuner.SetBestCandidate(kDevice, kGroupKey, 1 << 20, /*candidate=*/1);
+  int trial;
+  EXPECT_EQ(autotuner.NextNumSubdivs(kDevice, kGroupKey, 1 << 20, candidates,
+                                     &trial),
+            2);
+  EXPECT_EQ(trial, -1);
+  // Sizes in the same power-of-two bucket share the result.
+  EXPECT_EQ(autotuner.NextNumSubdivs(kDevice, kGroupKey, (1 << 20) + 1000,
+                                     candidates, &trial),
+            2);
+  EXPECT_EQ(trial, -1);
+}
+
+TEST(RingAutotunerTest, BucketsAreTunedSeparately) {
+  RingAutotuner autotuner(/*trials_per_candidate=*/1);
+  const std::vector<int> candidates = {1, 2};
+  int trial;
+  autotuner.NextNumSubdivs(kDevice, kGroupKey, 1 << 20, candidates, &trial);
+  EXPECT_EQ(trial, 0);
+  autotuner.NextNumSubdivs(kDevice, kGroupKey, 1 << 24, candidates, &trial);
+  EXPECT_EQ(trial, 0);
+  autotuner.NextNumSubdivs(kDevice, kGroupKey + 1, 1 << 20, candidates,
+                           &trial);
+  EXPECT_EQ(trial, 0);
+}
+
+TEST(RingAutotunerTest, SingleCandidateIsNotTuned) {
+  RingAutotuner autotuner(/*trials_per_candidate=*/3);
+  int trial;
+  EXPECT_EQ(autotuner.NextNumSubdivs(kDevice, kGroupKey, 1024, {1}, &trial),
+            1);
+  EXPECT_EQ(trial, -1);
+}
+
+TEST(RingAutotunerTest, BestCandidateMinimizesTheSlowestDevice) {
+  // Candidate 0 is fastest on the first device, but candidate 1 is faster on
+  // the slowest device.
+  EXPECT_EQ(RingAutotuner::BestCandidate({{10, 20, 40}, {50, 30, 45}}), 1);
+  EXPECT_EQ(RingAutotuner::BestCandidate({{10, 20}}), 0);
+}
+
+}  // namespace
+}  // namespace tensorflow
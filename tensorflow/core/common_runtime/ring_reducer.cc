@@ -18,6 +18,7 @@ limitations under the License.
 
 #include <atomic>
 #include <functional>
+#include <memory>
 #include <utility>
 
 #include "tensorflow/core/common_runtime/collective_rma_local.h"
@@ -42,6 +43,27 @@ limitations under the License.
 #include "tensorflow/core/profiler/lib/traceme.h"
 
 namespace tensorflow {
+namespace {
+
+// Casts `chunk` to the type of `wire`.  If `residual` is not null, adds the
+// rounding error to it.
+template <typename T>
+void CompressChunk(const Eigen::ThreadPoolDevice& d, const Tensor& chunk,
+                   Tensor* wire, Tensor* residual) {
+  wire->flat<T>().device(d) = chunk.flat<float>().cast<T>();
+  if (residual != nullptr) {
+    residual->flat<float>().device(d) +=
+        chunk.flat<float>() - wire->flat<T>().template cast<float>();
+  }
+}
+
+template <typename T>
+void DecompressChunk(const Eigen::ThreadPoolDevice& d, const Tensor& wire,
+                     Tensor* chunk) {
+  chunk->flat<float>().device(d) = wire.flat<T>().template cast<float>();
+}
+
+}  // namespace
 
 RingReducer::~RingReducer() { group_size_tensor_ready_.WaitForNotification(); }
 
@@ -49,6 +71,24 @@ Status RingReducer::InitializeCollectiveParams(CollectiveParams* col_params) {
   // TODO(b/113171733): change CHECKs to return errors.
   CHECK_EQ(col_params->instance.type, REDUCTION_COLLECTIVE);
   CHECK_EQ(col_params->instance.impl_details.collective_name, "RingReduce");
+  const string& compression = col_params->instance.impl_details.compression;
+  if (!compression.empty()) {
+    if (compression != "float16" && compression != "bfloat16") {
+      return errors::InvalidArgument("Unsupported RingReduce compression ",
+                                     compression);
+    }
+    if (col_params->group.device_type != DEVICE_CPU ||
+        col_params->instance.data_type != DT_FLOAT) {
+      return errors::InvalidArgument(
+          "RingReduce compression only supports float tensors on CPU, got ",
+          DataTypeString(col_params->instance.data_type), " on ",
+          col_params->group.device_type.type_string());
+    }
+    if (!col_params->compression_state) {
+      col_params->compression_state =
+          std::make_shared<CollectiveCompressionState>();
+    }
+  }
   return RingAlg::InitializeCollectiveParams(col_params);
 }
 
@@ -60,10 +100,17 @@ void RingReducer::Run(StatusCallback done) {
   col_ctx_->col_exec->UnblockDependencies(*col_params_);
 
   done_ = std::move(done);
+  start_micros_ = Env::Default()->NowMicros();
   group_size_ = col_params_->group.group_size;
   num_subdivs_ = static_cast<int>(
       col_params_->instance.impl_details.subdiv_permutations.size());
   CHECK_GT(num_subdivs_, 0);
+  const string& compression = col_params_->instance.impl_details.compression;
+  if (compression == "float16") {
+    wire_dtype_ = DT_HALF;
+  } else if (compression == "bfloat16") {
+    wire_dtype_ = DT_BFLOAT16;
+  }
 
   if (VLOG_IS_ON(1)) {
     string buf;
@@ -118,6 +165,7 @@ void RingReducer::Run(StatusCallback done) {
 // which cannot be blocked.
 void RingReducer::ContinueAfterInputCopy() {
   AllocatorAttributes attr = col_ctx_->op_ctx->output_alloc_attr(0);
+  if (wire_dtype_ != DT_INVALID) StartErrorFeedback();
   ca_.reset(MakeCollectiveAdapter(col_ctx_->output, group_size_ * num_subdivs_,
                                   col_ctx_->device->GetAllocator(attr)));
 
@@ -159,7 +207,78 @@ void RingReducer::ContinueAfterInputCopy() {
     // Value won't be used, so no need to initialize.
     group_size_tensor_ready_.Notify();
   }
-  Finish(RunAsyncParts());
+  const bool ok = RunAsyncParts();
+  if (residual_ca_) FinishErrorFeedback();
+  if (ok) {
+    Status s = FinishAutotuneTrial(Env::Default()->NowMicros() - start_micros_);
+    if (!s.ok()) {
+      mutex_lock l(status_mu_);
+      status_.Update(s);
+    }
+  }
+  Finish(ok);
+}
+
+void RingReducer::StartErrorFeedback() {
+  CollectiveCompressionState* state = col_params_->compression_state.get();
+  DCHECK(state);
+  Tensor residual;
+  {
+    mutex_lock l(state->mu);
+    std::swap(residual, state->residual);
+  }
+  const Eigen::ThreadPoolDevice& d = col_ctx_->op_ctx->eigen_cpu_device();
+  Tensor* output = col_ctx_->output;
+  if (residual.IsInitialized() && residual.shape() == output->shape()) {
+    output->flat<float>().device(d) += residual.flat<float>();
+  } else {
+    residual = Tensor(col_ctx_->device->GetAllocator(AllocatorAttributes()),
+                      DT_FLOAT, output->shape());
+  }
+  residual.flat<float>().setZero();
+  residual_ca_.reset(MakeCollectiveAdapter(
+      &residual, group_size_ * num_subdivs_,
+      col_ctx_->device->GetAllocator(AllocatorAttributes())));
+}
+
+void RingReducer::FinishErrorFeedback() {
+  Tensor residual;
+  residual_ca_->ConsumeFinalValue(&residual);
+  residual_ca_.reset();
+  CollectiveCompressionState* state = col_params_->compression_state.get();
+  mutex_lock l(state->mu);
+  state->residual = std::move(residual);
+}
+
+void RingReducer::CompressForSend(RingField* rf) {
+  const Eigen::ThreadPoolDevice& d = col_ctx_->op_ctx->eigen_cpu_device();
+  Tensor residual;
+  if (!rf->second_pass) residual = residual_ca_->ChunkAlias(rf->sc_idx);
+  Tensor* r = rf->second_pass ? nullptr : &residual;
+  if (wire_dtype_ == DT_HALF) {
+    CompressChunk<Eigen::half>(d, rf->chunk, &rf->wire_chunk, r);
+  } else {
+    CompressChunk<bfloat16>(d, rf->chunk, &rf->wire_chunk, r);
+  }
+  if (rf->second_pass) {
+    // Keep the value that the other devices receive, so that this device,
+    // which may have computed it, ends up with the same result.
+    if (wire_dtype_ == DT_HALF) {
+      DecompressChunk<Eigen::half>(d, rf->wire_chunk, &rf->chunk);
+    } else {
+      DecompressChunk<bfloat16>(d, rf->wire_chunk, &rf->chunk);
+    }
+  }
+}
+
+void RingReducer::DecompressAfterRecv(RingField* rf) {
+  const Eigen::ThreadPoolDevice& d = col_ctx_->op_ctx->eigen_cpu_device();
+  Tensor* dst = rf->second_pass ? &rf->chunk : &rf->tmp_chunk;
+  if (wire_dtype_ == DT_HALF) {
+    DecompressChunk<Eigen::half>(d, rf->wire_chunk, dst);
+  } else {
+    DecompressChunk<bfloat16>(d, rf->wire_chunk, dst);
+  }
 }
 
 void RingReducer::InitRingField(RingField* rf, int chunk_idx, int subdiv_idx,
@@ -168,6 +287,11 @@ void RingReducer::InitRingField(RingField* rf, int chunk_idx, int subdiv_idx,
   if (rf->do_recv) {
     rf->tmp_chunk = ca_->TempChunk(rf->sc_idx);
   }
+  if (wire_dtype_ != DT_INVALID && ca_->ChunkBytes(rf->sc_idx) > 0) {
+    rf->wire_chunk = Tensor(
+        col_ctx_->device->GetAllocator(col_ctx_->op_ctx->output_alloc_attr(0)),
+        wire_dtype_, rf->chunk.shape());
+  }
 }
 
 // At the beginning of the algorithm initialize a RingField struct for
@@ -253,6 +377,7 @@ bool RingReducer::RunAsyncParts() {
           case RF_RECV:
             CHECK_GT(recv_pending_count, 0);
             --recv_pending_count;
+            if (rf->wire_chunk.IsInitialized()) DecompressAfterRecv(rf);
             if (!rf->second_pass) {
               rf->action = RF_REDUCE;
               Status s = collective_util::ComputeBinOp(
@@ -286,6 +411,7 @@ bool RingReducer::RunAsyncParts() {
             break;
           case RF_SEND_READY:
             if (rf->do_send) {
+              if (rf->wire_chunk.IsInitialized()) CompressForSend(rf);
               rf->action = RF_SEND;
               auto send_complete = [this, rf, &ready_queue,
                                     &aborted](Status s) {
@@ -28,6 +28,15 @@ namespace tensorflow {
 class Device;
 
 // Ring-algorithm implementation of collective all-reduce.
+//
+// If `CollImplDetails::compression` is set, the chunks of a float all-reduce
+// on CPU are cast to float16 or bfloat16 before each send and back to float
+// after each recv, which halves the bytes on the ring.  The rounding error of
+// the partial sums that a device sends is kept in the
+// `CollectiveParams::compression_state` of that device and added to its input
+// at the next execution, so that it is not lost over many steps.  The final
+// values are rounded once by their owner, so that all devices end up with the
+// same result.
 class RingReducer : public RingAlg {
  public:
   RingReducer() : RingAlg(REDUCTION_COLLECTIVE, "Reduce") {}
@@ -49,6 +58,21 @@ class RingReducer : public RingAlg {
   void ContinueAfterInputCopy();
   bool RunAsyncParts();
 
+  // Adds the residual of the previous execution to the output and resets it.
+  void StartErrorFeedback();
+  // Saves the residual of this execution for the next one.
+  void FinishErrorFeedback();
+  // Casts rf->chunk to rf->wire_chunk before it is sent.
+  void CompressForSend(RingField* rf);
+  // Casts rf->wire_chunk back after it is recv'd.
+  void DecompressAfterRecv(RingField* rf);
+
+  // The type that chunks are sent as, or DT_INVALID if they are not
+  // compressed.
+  DataType wire_dtype_ = DT_INVALID;
+  std::unique_ptr<CollectiveAdapter> residual_ca_;
+  uint64 start_micros_ = 0;
+
   Tensor group_size_tensor_;
   Notification group_size_tensor_ready_;
 
@@ -219,6 +219,13 @@ class RingReducerInitParamsTest : public ::testing::Test {
     EXPECT_EQ(expected_subdiv_rank, cp->subdiv_rank);
     reducer->group_size_tensor_ready_.Notify();  // To unblock destructor.
   }
+
+  Status InitializeParams(CollectiveParams* cp) {
+    core::RefCountPtr<RingReducer> reducer(new RingReducer());
+    Status status = reducer->InitializeCollectiveParams(cp);
+    reducer->group_size_tensor_ready_.Notify();  // To unblock destructor.
+    return status;
+  }
 };
 
 TEST_F(RingReducerInitParamsTest, SpecifiedSubdivs) {
@@ -427,6 +434,58 @@ DEF_TEST(INT64, CPU, 2, 8, 3, 4095, 0)
 DEF_TEST(FLOAT, CPU, 2, 8, 1, 9408, 1)
 DEF_TEST(FLOAT, CPU, 2, 8, 1, 9408, 7)
 DEF_TEST(FLOAT, CPU, 2, 8, 2, 9408, 11)
+
+TEST_F(RingReducerTest, CompressedReduce) {
+  const int kNumWorkers = 2;
+  const int kNumDevices = 4;
+  const int kTensorLen = 1001;
+  for (const char* compression : {"float16", "bfloat16"}) {
+    instances_.clear();
+    Init(kNumWorkers, kNumDevices, DT_FLOAT, TensorShape({kTensorLen}),
+         DEVICE_CPU, /*num_subdivs*/ 2, /*fail_after*/ 0);
+    for (auto& instance : instances_) {
+      instance->col_params_->instance.impl_details.compression = compression;
+    }
+    std::vector<float> expected(kTensorLen);
+    for (int di = 0; di < instances_.size(); ++di) {
+      instances_[di]->InitTensor([&expected, di](Tensor* t) {
+        for (int i = 0; i < kTensorLen; ++i) {
+          t->flat<float>()(i) = 0.5f * di + 0.01f * i;
+          expected[i] += (0.5f * di + 0.01f * i) / (kNumWorkers * kNumDevices);
+        }
+      });
+    }
+    Reduce(/*fail_after*/ 0);
+    for (int di = 0; di < instances_.size(); ++di) {
+      TF_EXPECT_OK(instances_[di]->status_);
+      // All devices end up with the same rounded values.
+      test::ExpectTensorEqual<float>(instances_[0]->tensor(),
+                                     instances_[di]->tensor());
+      const CollectiveCompressionState* state =
+          instances_[di]->col_params_->compression_state.get();
+      ASSERT_NE(state, nullptr);
+      EXPECT_EQ(state->residual.shape(), TensorShape({kTensorLen}));
+    }
+    const double tolerance = string(compression) == "float16" ? 0.05 : 0.5;
+    test::ExpectTensorNear<float>(instances_[0]->tensor(),
+                                  test::AsTensor<float>(expected), tolerance);
+  }
+}
+
+TEST_F(RingReducerInitParamsTest, UnsupportedCompression) {
+  auto test_env = CreateCollectiveTestEnv(/*num_workers*/ 1,
+                                          /*num_devices*/ 2, DEVICE_CPU);
+  auto cp = CreateCollectiveParams(*test_env, /*rank*/ 0, "RingReduce",
+                                   REDUCTION_COLLECTIVE, DT_DOUBLE,
+                                   TensorShape({8}));
+  cp->instance.impl_details.compression = "float16";
+  EXPECT_TRUE(errors::IsInvalidArgument(InitializeParams(cp.get())));
+  cp->instance.data_type = DT_FLOAT;
+  TF_EXPECT_OK(InitializeParams(cp.get()));
+  EXPECT_NE(cp->compression_state, nullptr);
+  cp->instance.impl_details.compression = "topk";
+  EXPECT_TRUE(errors::IsInvalidArgument(InitializeParams(cp.get())));
+}
 #endif
 
 #if GOOGLE_CUDA || TENSORFLOW_USE_ROCM
@@ -0,0 +1,339 @@
+/* Copyright 2024 The TensorFlow Authors. All Rights Reserved.
+
+Licensed under the Apache License, Version 2.0 (the "License");
+you may not use this file except in compliance with the License.
+You may obtain a copy of the License at
+
+    http://www.apache.org/licenses/LICENSE-2.0
+
+Unless required by applicable law or agreed to in writing, software
+distributed under the License is distributed on an "AS IS" BASIS,
+WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+See the License for the specific language governing permissions and
+limitations under the License.
+==============================================================================*/
+#include "tensorflow/core/common_runtime/sampled_step_stats_collector.h"
+
+#include <algorithm>
+#include <utility>
+
+#include "absl/container/flat_hash_map.h"
+#include "tensorflow/core/framework/node_def.pb.h"
+#include "tensorflow/core/framework/step_stats.pb.h"
+#include "tensorflow/core/platform/env.h"
+#include "tensorflow/core/platform/logging.h"
+
+namespace tensorflow {
+
+namespace {
+
+std::atomic<uint64> next_collector_id{0};
+
+}  // namespace
+
+// A single-producer ring buffer of node records, written by one thread and
+// read by `SampledStepStatsCollector::Collect()`.
+//
+// Each record is protected by a sequence lock: the writer marks a record as
+// being written before updating its fields, and as complete afterwards, so a
+// reader that races with the writer detects the torn record and drops it
+// instead of blocking the writer.
+class SampledStepStatsCollector::ThreadRecords {
+ public:
+  explicit ThreadRecords(int capacity)
+      : capacity_(capacity),
+        records_(new Record[capacity]),
+        thread_id_(Env::Default()->GetCurrentThreadId()) {}
+
+  struct Values {
+    int32 node_name = -1;
+    int32 device = -1;
+    int64_t scheduled_nanos = 0;
+    int64_t all_start_nanos = 0;
+    int64_t op_start_nanos = 0;
+    int64_t op_end_nanos = 0;
+    int64_t all_end_nanos = 0;
+  };
+
+  // Returns the index of `node`'s name in `names_`. Must only be called by the
+  // owning thread.
+  int32 InternNodeName(const NodeDef* node) {
+    // NOTE: A `NodeDef` may be reused at the same address by a different
+    // graph, so the cached name is checked before it is used.
+    auto it = node_names_.find(node);
+    if (it != node_names_.end() && names_[it->second] == node->name()) {
+      return it->second;
+    }
+    const int32 index = AddName(node->name());
+    node_names_[node] = index;
+    return index;
+  }
+
+  // Returns the index of `device` in `names_`. Must only be called by the
+  // owning thread.
+  int32 InternDeviceName(const string& device) {
+    auto it = device_names_.find(device);
+    if (it != device_names_.end()) return it->second;
+    const int32 index = AddName(device);
+    device_names_.emplace(device, index);
+    return index;
+  }
+
+  // Appends a record. Must only be called by the owning thread.
+  void Write(const Values& values) {
+    const uint64 pos = next_.load(std::memory_order_relaxed);
+    Record& record = records_[pos % capacity_];
+    record.seq.store(2 * pos + 1, std::memory_order_relaxed);
+    std::atomic_thread_fence(std::memory_order_release);
+    record.node_name.store(values.node_name, std::memory_order_relaxed);
+    record.device.store(values.device, std::memory_order_relaxed);
+    record.scheduled_nanos.store(values.scheduled_nanos,
+                                 std::memory_order_relaxed);
+    record.all_start_nanos.store(values.all_start_nanos,
+                                 std::memory_order_relaxed);
+    record.op_start_nanos.store(values.op_start_nanos,
+                                std::memory_order_relaxed);
+    record.op_end_nanos.store(values.op_end_nanos, std::memory_order_relaxed);
+    record.all_end_nanos.store(values.all_end_nanos, std::memory_order_relaxed);
+    record.seq.store(2 * pos + 2, std::memory_order_release);
+    next_.store(pos + 1, std::memory_order_release);
+  }
+
+  // Calls `fn(values, node_name, device)` for each complete record written
+  // since the previous call, and returns the number of records that were
+  // overwritten or torn. Must not be called concurrently with itself.
+  template <typename F>
+  int64_t Drain(F fn) {
+    const uint64 end = next_.load(std::memory_order_acquire);
+    const uint64 begin = std::max(collected_, end > capacity_ ? end - capacity_
+                                                              : uint64{0});
+    int64_t num_dropped = begin - collected_;
+    collected_ = end;
+
+    // The names are appended to before the records that refer to them are
+    // written, so every index read below is valid.
+    tf_shared_lock l(names_mu_);
+    for (uint64 pos = begin; pos < end; ++pos) {
+      const Record& record = records_[pos % capacity_];
+      const uint64 seq = record.seq.load(std::memory_order_acquire);
+      if (seq != 2 * pos + 2) {
+        ++num_dropped;
+        continue;
+      }
+      Values values;
+      values.node_name = record.node_name.load(std::memory_order_relaxed);
+      values.device = record.device.load(std::memory_order_relaxed);
+      values.scheduled_nanos =
+          record.scheduled_nanos.load(std::memory_order_relaxed);
+      values.all_start_nanos =
+          record.all_start_nanos.load(std::memory_order_relaxed);
+      values.op_start_nanos =
+          record.op_start_nanos.load(std::memory_order_relaxed);
+      values.op_end_nanos = record.op_end_nanos.load(std::memory_order_relaxed);
+      values.all_end_nanos =
+          record.all_end_nanos.load(std::memory_order_relaxed);
+      std::atomic_thread_fence(std::memory_order_acquire);
+      if (record.seq.load(std::memory_order_relaxed) != seq) {
+        ++num_dropped;
+        continue;
+      }
+      fn(values, names_[values.node_name], names_[values.device]);
+    }
+    return num_dropped;
+  }
+
+  uint64 thread_id() const { return thread_id_; }
+
+ private:
+  struct Record {
+    // `2 * pos + 1` while the record at position `pos` is being written, and
+    // `2 * pos + 2` once it is complete.
+    std::atomic<uint64> seq{0};
+    std::atomic<int32> node_name{-1};
+    std::atomic<int32> device{-1};
+    std::atomic<int64_t> scheduled_nanos{0};
+    std::atomic<int64_t> all_start_nanos{0};
+    std::atomic<int64_t> op_start_nanos{0};
+    std::atomic<int64_t> op_end_nanos{0};
+    std::atomic<int64_t> all_end_nanos{0};
+  };
+
+  int32 AddName(const string& name) {
+    mutex_lock l(names_mu_);
+    names_.push_back(name);
+    return names_.size() - 1;
+  }
+
+  const uint64 capacity_;
+  const std::unique_ptr<Record[]> records_;
+  const uint64 thread_id_;
+
+  // The number of records ever written.
+  std::atomic<uint64> next_{0};
+  // The number of records consumed by `Drain()`.
+  uint64 collected_ = 0;
+
+  // Owned by the writing thread.
+  absl::flat_hash_map<const NodeDef*, int32> node_names_;
+  absl::flat_hash_map<string, int32> device_names_;
+
+  // Only modified by the writing thread, which may read it without holding
+  // `names_mu_`.
+  mutable mutex names_mu_;
+  std::vector<string> names_;
+};
+
+// Per-node statistics for a sampled step. Deletes itself in `Done()`.
+class SampledStepStatsCollector::NodeStats : public NodeExecStatsInterface {
+ public:
+  NodeStats(SampledStepStatsCollector* collector, const NodeDef* node)
+      : collector_(collector), node_(node) {}
+
+  void Done(const string& device) override {
+    ThreadRecords* records = collector_->GetThreadRecords();
+    values_.node_name = records->InternNodeName(node_);
+    values_.device = records->InternDeviceName(device);
+    records->Write(values_);
+    delete this;
+  }
+
+  void RecordExecutorStarted() override {
+    values_.all_start_nanos = Env::Default()->NowNanos();
+  }
+  void RecordComputeStarted() override {
+    values_.op_start_nanos = Env::Default()->NowNanos();
+  }
+  void RecordComputeEnded() override {
+    values_.op_end_nanos = Env::Default()->NowNanos();
+  }
+  void RecordExecutorEnded() override {
+    values_.all_end_nanos = Env::Default()->NowNanos();
+  }
+  bool TrackAllocations() const override { return false; }
+  void SetMemory(OpKernelContext* ctx) override {}
+  void SetOutput(int slot, const Tensor* tensor) override {}
+  void SetScheduled(int64_t nanos) override { values_.scheduled_nanos = nanos; }
+
+ private:
+  SampledStepStatsCollector* const collector_;  // Not owned.
+  const NodeDef* const node_;                   // Not owned.
+  ThreadRecords::Values values_;
+};
+
+class SampledStepStatsCollector::StepCollector
+    : public StepStatsCollectorInterface {
+ public:
+  explicit StepCollector(SampledStepStatsCollector* collector)
+      : collector_(collector) {}
+
+  NodeExecStatsInterface* CreateNodeExecStats(const NodeDef* node) override {
+    return new NodeStats(collector_, node);
+  }
+
+  string ReportAllocsOnResourceExhausted(absl::string_view err) override {
+    return "";
+  }
+
+ private:
+  SampledStepStatsCollector* const collector_;  // Not owned.
+};
+
+SampledStepStatsCollector::SampledStepStatsCollector(int64_t sample_period,
+                                                     int records_per_thread)
+    : sample_period_(sample_period),
+      records_per_thread_(std::max(records_per_thread, 1)),
+      id_(next_collector_id.fetch_add(1, std::memory_order_relaxed)) {}
+
+SampledStepStatsCollector::~SampledStepStatsCollector() {}
+
+std::unique_ptr<StepStatsCollectorInterface>
+SampledStepStatsCollector::MaybeStartStep() {
+  if (sample_period_ < 1) return nullptr;
+  if (num_steps_.fetch_add(1, std::memory_order_relaxed) % sample_period_ !=
+      0) {
+    return nullptr;
+  }
+  return std::make_unique<StepCollector>(this);
+}
+
+SampledStepStatsCollector::ThreadRecords*
+SampledStepStatsCollector::GetThreadRecords() {
+  // NOTE: Collector IDs are never reused, so entries for destroyed collectors
+  // are never looked up again.
+  thread_local absl::flat_hash_map<uint64, ThreadRecords*> thread_records;
+  auto it = thread_records.find(id_);
+  if (it != thread_records.end()) return it->second;
+
+  auto records = std::make_unique<ThreadRecords>(records_per_thread_);
+  ThreadRecords* result = records.get();
+  {
+    mutex_lock l(mu_);
+    thread_records_.push_back(std::move(records));
+  }
+  thread_records.emplace(id_, result);
+  return result;
+}
+
+void SampledStepStatsCollector::Collect(StepStats* step_stats) {
+  absl::flat_hash_map<absl::string_view, DeviceStepStats*> dev_stats;
+  for (DeviceStepStats& ds : *step_stats->mutable_dev_stats()) {
+    dev_stats.emplace(ds.device(), &ds);
+  }
+
+  mutex_lock l(mu_);
+  int64_t num_dropped = 0;
+  for (const auto& records : thread_records_) {
+    const uint64 thread_id = records->thread_id();
+    num_dropped += records->Drain([&](const ThreadRecords::Values& values,
+                                      const string& node_name,
+                                      const string& device) {
+      DeviceStepStats* ds;
+      auto it = dev_stats.find(device);
+      if (it != dev_stats.end()) {
+        ds = it->second;
+      } else {
+        ds = step_stats->add_dev_stats();
+        ds->set_device(device);
+        dev_stats.emplace(ds->device(), ds);
+      }
+      NodeExecStats* ns = ds->add_node_stats();
+      ns->set_node_name(node_name);
+      ns->set_thread_id(thread_id);
+
+      const int64_t all_start_micros =
+          values.all_start_nanos / EnvTime::kMicrosToNanos;
+      ns->set_all_start_nanos(values.all_start_nanos);
+      ns->set_all_start_micros(all_start_micros);
+      if (values.scheduled_nanos > 0) {
+        ns->set_scheduled_nanos(values.scheduled_nanos);
+        ns->set_scheduled_micros(values.scheduled_nanos /
+                                 EnvTime::kMicrosToNanos);
+      }
+      if (values.op_start_nanos > 0) {
+        ns->set_op_start_rel_nanos(values.op_start_nanos -
+                                   values.all_start_nanos);
+        ns->set_op_start_rel_micros(
+            values.op_start_nanos / EnvTime::kMicrosToNanos - all_start_micros);
+      }
+      if (values.op_end_nanos > 0) {
+        ns->set_op_end_rel_nanos(values.op_end_nanos - values.all_start_nanos);
+        ns->set_op_end_rel_micros(values.op_end_nanos / EnvTime::kMicrosToNanos -
+                                  all_start_micros);
+      }
+      if (values.all_end_nanos > 0) {
+        ns->set_all_end_rel_nanos(values.all_end_nanos -
+                                  values.all_start_nanos);
+        ns->set_all_end_rel_micros(
+            values.all_end_nanos / EnvTime::kMicrosToNanos - all_start_micros);
+      }
+    });
+  }
+  if (num_dropped > 0) {
+    num_dropped_records_.fetch_add(num_dropped, std::memory_order_relaxed);
+    VLOG(1) << "Dropped " << num_dropped
+            << " sampled node records that were overwritten before they were "
+               "collected.";
+  }
+}
+
+}  // namespace tensorflow
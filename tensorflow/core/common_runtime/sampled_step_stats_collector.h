@@ -0,0 +1,101 @@
+/* Copyright 2024 The TensorFlow Authors. All Rights Reserved.
+
+Licensed under the Apache License, Version 2.0 (the "License");
+you may not use this file except in compliance with the License.
+You may obtain a copy of the License at
+
+    http://www.apache.org/licenses/LICENSE-2.0
+
+Unless required by applicable law or agreed to in writing, software
+distributed under the License is distributed on an "AS IS" BASIS,
+WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+See the License for the specific language governing permissions and
+limitations under the License.
+==============================================================================*/
+#ifndef TENSORFLOW_CORE_COMMON_RUNTIME_SAMPLED_STEP_STATS_COLLECTOR_H_
+#define TENSORFLOW_CORE_COMMON_RUNTIME_SAMPLED_STEP_STATS_COLLECTOR_H_
+
+#include <atomic>
+#include <memory>
+#include <string>
+#include <vector>
+
+#include "absl/strings/string_view.h"
+#include "tensorflow/core/common_runtime/step_stats_collector.h"
+#include "tensorflow/core/platform/mutex.h"
+#include "tensorflow/core/platform/thread_annotations.h"
+#include "tensorflow/core/platform/types.h"
+
+namespace tensorflow {
+
+class StepStats;
+
+// A low-overhead alternative to `StepStatsCollector` that is intended to stay
+// enabled in production.
+//
+// One `SampledStepStatsCollector` is shared by all steps of a session.
+// `MaybeStartStep()` selects one step in every `sample_period` steps for
+// collection. For a selected step, the timings of each node are written as a
+// compact fixed-size record into a ring buffer owned by the thread that
+// finished the node, without taking a lock or building a `NodeExecStats`
+// proto. The records are only converted to `StepStats` when `Collect()` is
+// called.
+//
+// Each ring buffer holds the `records_per_thread` most recent records of its
+// thread, so older records are overwritten if `Collect()` is not called often
+// enough. Memory allocations and tensor outputs are not recorded.
+class SampledStepStatsCollector {
+ public:
+  static constexpr int kDefaultRecordsPerThread = 4096;
+
+  // Collects statistics for one in every `sample_period` steps. If
+  // `sample_period` is less than 1, no steps are collected.
+  explicit SampledStepStatsCollector(
+      int64_t sample_period, int records_per_thread = kDefaultRecordsPerThread);
+  ~SampledStepStatsCollector();
+
+  // Returns a collector for a new step if the step is selected for
+  // collection, or nullptr otherwise. The returned collector must outlive the
+  // step, and must not outlive `this`.
+  std::unique_ptr<StepStatsCollectorInterface> MaybeStartStep();
+
+  // Converts the records written since the last call into `NodeExecStats` in
+  // `*step_stats`, grouped by device. Records are returned in the order in
+  // which they were written by each thread. May be called concurrently with
+  // running steps.
+  void Collect(StepStats* step_stats);
+
+  // Returns the number of records that were overwritten before they were
+  // collected.
+  int64_t num_dropped_records() const {
+    return num_dropped_records_.load(std::memory_order_relaxed);
+  }
+
+ private:
+  class ThreadRecords;
+  class StepCollector;
+  class NodeStats;
+
+  // Returns the ring buffer for the calling thread, creating it if necessary.
+  ThreadRecords* GetThreadRecords();
+
+  const int64_t sample_period_;
+  const int records_per_thread_;
+  // A process-wide unique identifier for this collector, used to find the
+  // ring buffer of the calling thread.
+  const uint64 id_;
+
+  std::atomic<int64_t> num_steps_{0};
+  std::atomic<int64_t> num_dropped_records_{0};
+
+  mutex mu_;
+  std::vector<std::unique_ptr<ThreadRecords>> thread_records_
+      TF_GUARDED_BY(mu_);
+
+  SampledStepStatsCollector(const SampledStepStatsCollector&) = delete;
+  void operator=(const SampledStepStatsCollector&) = delete;
+};
+
+}  // namespace tensorflow
+
+#endif  // TENSORFLOW_CORE_COMMON_RUNTIME_SAMPLED_STEP_STATS_COLLECTOR_H_
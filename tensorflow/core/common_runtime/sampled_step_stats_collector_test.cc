@@ -0,0 +1,146 @@
+/* Copyright 2024 The TensorFlow Authors. All Rights Reserved.
+
+Licensed under the Apache License, Version 2.0 (the "License");
+you may not use this file except in compliance with the License.
+You may obtain a copy of the License at
+
+    http://www.apache.org/licenses/LICENSE-2.0
+
+Unless required by applicable law or agreed to in writing, software
+distributed under the License is distributed on an "AS IS" BASIS,
+WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+See the License for the specific language governing permissions and
+limitations under the License.
+==============================================================================*/
+#include "tensorflow/core/common_runtime/sampled_step_stats_collector.h"
+
+#include <memory>
+#include <vector>
+
+#include "tensorflow/core/framework/node_def.pb.h"
+#include "tensorflow/core/framework/step_stats.pb.h"
+#include "tensorflow/core/platform/env.h"
+#include "tensorflow/core/platform/test.h"
+#include "tensorflow/core/platform/threadpool.h"
+
+namespace tensorflow {
+namespace {
+
+void RunNode(StepStatsCollectorInterface* step_collector, const NodeDef& node,
+             const string& device) {
+  NodeExecStatsInterface* stats = step_collector->CreateNodeExecStats(&node);
+  ASSERT_NE(nullptr, stats);
+  EXPECT_FALSE(stats->TrackAllocations());
+  stats->SetScheduled(Env::Default()->NowNanos());
+  stats->RecordExecutorStarted();
+  stats->RecordComputeStarted();
+  stats->RecordComputeEnded();
+  stats->RecordExecutorEnded();
+  stats->Done(device);
+}
+
+TEST(SampledStepStatsCollectorTest, SamplesOneInEveryPeriodSteps) {
+  SampledStepStatsCollector collector(/*sample_period=*/3);
+  int num_sampled = 0;
+  for (int i = 0; i < 9; ++i) {
+    if (collector.MaybeStartStep() != nullptr) ++num_sampled;
+  }
+  EXPECT_EQ(3, num_sampled);
+
+  SampledStepStatsCollector disabled(/*sample_period=*/0);
+  EXPECT_EQ(nullptr, disabled.MaybeStartStep());
+}
+
+TEST(SampledStepStatsCollectorTest, CollectsRecordsByDevice) {
+  SampledStepStatsCollector collector(/*sample_period=*/1);
+  NodeDef a;
+  a.set_name("a");
+  NodeDef b;
+  b.set_name("b");
+  {
+    auto step = collector.MaybeStartStep();
+    ASSERT_NE(nullptr, step);
+    RunNode(step.get(), a, "/device:CPU:0");
+    RunNode(step.get(), b, "/device:CPU:1");
+    RunNode(step.get(), a, "/device:CPU:0");
+  }
+
+  StepStats step_stats;
+  collector.Collect(&step_stats);
+  ASSERT_EQ(2, step_stats.dev_stats_size());
+  const DeviceStepStats& cpu0 = step_stats.dev_stats(0);
+  EXPECT_EQ("/device:CPU:0", cpu0.device());
+  ASSERT_EQ(2, cpu0.node_stats_size());
+  for (const NodeExecStats& ns : cpu0.node_stats()) {
+    EXPECT_EQ("a", ns.node_name());
+    EXPECT_GT(ns.all_start_nanos(), 0);
+    EXPECT_GT(ns.scheduled_nanos(), 0);
+    EXPECT_LE(ns.op_start_rel_nanos(), ns.op_end_rel_nanos());
+    EXPECT_LE(ns.op_end_rel_nanos(), ns.all_end_rel_nanos());
+  }
+  const DeviceStepStats& cpu1 = step_stats.dev_stats(1);
+  EXPECT_EQ("/device:CPU:1", cpu1.device());
+  ASSERT_EQ(1, cpu1.node_stats_size());
+  EXPECT_EQ("b", cpu1.node_stats(0).node_name());
+
+  // Records are only collected once, and are appended to existing devices.
+  RunNode(collector.MaybeStartStep().get(), b, "/device:CPU:1");
+  collector.Collect(&step_stats);
+  EXPECT_EQ(2, step_stats.dev_stats_size());
+  EXPECT_EQ(2, step_stats.dev_stats(1).node_stats_size());
+  EXPECT_EQ(0, collector.num_dropped_records());
+}
+
+TEST(SampledStepStatsCollectorTest, DropsOverwrittenRecords) {
+  SampledStepStatsCollector collector(/*sample_period=*/1,
+                                      /*records_per_thread=*/4);
+  NodeDef node;
+  node.set_name("n");
+  auto step = collector.MaybeStartStep();
+  for (int i = 0; i < 10; ++i) {
+    RunNode(step.get(), node, "/device:CPU:0");
+  }
+  StepStats step_stats;
+  collector.Collect(&step_stats);
+  ASSERT_EQ(1, step_stats.dev_stats_size());
+  EXPECT_EQ(4, step_stats.dev_stats(0).node_stats_size());
+  EXPECT_EQ(6, collector.num_dropped_records());
+}
+
+TEST(SampledStepStatsCollectorTest, ConcurrentWritersAndCollector) {
+  constexpr int kNumThreads = 4;
+  constexpr int kNodesPerThread = 1000;
+  SampledStepStatsCollector collector(/*sample_period=*/1);
+  auto step = collector.MaybeStartStep();
+  NodeDef node;
+  node.set_name("n");
+
+  StepStats step_stats;
+  {
+    thread::ThreadPool pool(Env::Default(), "test", kNumThreads);
+    for (int i = 0; i < kNumThreads; ++i) {
+      pool.Schedule([&step, &node]() {
+        for (int j = 0; j < kNodesPerThread; ++j) {
+          RunNode(step.get(), node, "/device:CPU:0");
+        }
+      });
+    }
+    // Collect while the writers are running.
+    collector.Collect(&step_stats);
+  }
+  collector.Collect(&step_stats);
+
+  int num_node_stats = 0;
+  for (const DeviceStepStats& ds : step_stats.dev_stats()) {
+    EXPECT_EQ("/device:CPU:0", ds.device());
+    for (const NodeExecStats& ns : ds.node_stats()) {
+      EXPECT_EQ("n", ns.node_name());
+      ++num_node_stats;
+    }
+  }
+  EXPECT_EQ(kNumThreads * kNodesPerThread,
+            num_node_stats + collector.num_dropped_records());
+}
+
+}  // namespace
+}  // namespace tensorflow
@@ -15,12 +15,17 @@ limitations under the License.
 
 #include "tensorflow/core/common_runtime/single_threaded_executor.h"
 
+#include <deque>
 #include <utility>
 
 #include "tensorflow/core/common_runtime/entry.h"
 #include "tensorflow/core/common_runtime/executor.h"
 #include "tensorflow/core/common_runtime/executor_factory.h"
+#include "tensorflow/core/common_runtime/graph_view.h"
+#include "tensorflow/core/common_runtime/immutable_executor_state.h"
 #include "tensorflow/core/common_runtime/renamed_device.h"
+#include "tensorflow/core/common_runtime/single_threaded_propagator_state.h"
+#include "tensorflow/core/framework/node_def_util.h"
 #include "tensorflow/core/graph/algorithm.h"
 #include "tensorflow/core/lib/core/errors.h"
 #include "tensorflow/core/lib/core/status.h"
@@ -40,23 +45,10 @@ Status ValidateOpIsSafeForSyncExecution(
           DataTypeString(dt), " in outputs of node ", n.name());
     }
   }
-  // Executing Switch nodes requires propagating deadness which is
-  // not currently supported in the SingleThreadedExecutor.
-  if (n.IsSwitch()) {
-    return errors::FailedPrecondition(
-        "Single-threaded executor does not support switch op, but saw node ",
-        n.name(),
-        ". Perhaps your graph contains old-style control flow primitives? "
-        "Try using tf.compat.v1.enable_control_flow_v2().");
-  }
-  if (n.IsControlFlow() && !allow_control_flow_sync_execution) {
-    return errors::FailedPrecondition(
-        "Single-threaded executor does not support low level control flow, "
-        " but saw control flow node ",
-        n.name(),
-        ".  Perhaps your graph contains old-style control flow primitives? "
-        "Try using tf.compat.v1.enable_control_flow_v2().");
-  }
+  // Control flow nodes, including Switch, are supported regardless of
+  // `allow_control_flow_sync_execution`: graphs that contain them are run by
+  // propagating frames, iterations and dead tensors through a
+  // `SingleThreadedPropagatorState`.
   return absl::OkStatus();
 }
 
@@ -83,6 +75,20 @@ class SingleThreadedExecutorImpl : public Executor {
   }
 
   Status Initialize(const Graph& graph) {
+    if (RequiresControlFlowSupport(graph)) {
+      // The flat topological order below cannot represent frames, iterations
+      // or dead tensors, so these graphs are run by propagating the outputs of
+      // each kernel through a `SingleThreadedPropagatorState` instead (see
+      // `RunWithControlFlow()`).
+      for (const Node* n : graph.op_nodes()) {
+        TF_RETURN_IF_ERROR(ValidateOpIsSafeForSyncExecution(
+            *n, params_.allow_control_flow_sync_execution));
+      }
+      total_num_inputs_ = 0;
+      control_flow_state_ = std::make_unique<ImmutableExecutorState>(params_);
+      return control_flow_state_->Initialize(graph);
+    }
+
     // Topologicially sort `graph` to get a sequence of OpKernels.
     std::vector<Node*> ordered_nodes;
     ordered_nodes.reserve(graph.num_nodes());
@@ -331,6 +337,7 @@ class SingleThreadedExecutorImpl : public Executor {
     params.executor_type = &kSingleThreadedExecutor;
 
     // NOTE(mrry): We are assuming that the graph is loopless and condless.
+    // `RunWithControlFlow()` sets the frame and iteration of each kernel.
     params.frame_iter = FrameAndIter(0, 0);
     params.is_input_dead = false;
 
@@ -344,6 +351,10 @@ class SingleThreadedExecutorImpl : public Executor {
     // TODO(mrry): Consider implementing forwarding.
     params.forward_from_array = nullptr;
 
+    if (control_flow_state_ != nullptr) {
+      return RunWithControlFlow(args, &params);
+    }
+
     const size_t received_args =
         args.call_frame ? args.call_frame->num_args() : 0;
     if (TF_PREDICT_FALSE(arg_output_locations_.size() > received_args)) {
@@ -486,6 +497,137 @@ class SingleThreadedExecutorImpl : public Executor {
   }
 
  private:
+  typedef SingleThreadedPropagatorState::TaggedNode TaggedNode;
+
+  // Executes a graph that requires control flow support one kernel at a time,
+  // in the order in which the kernels become ready. `params` holds the
+  // parameters that are the same for all kernels.
+  Status RunWithControlFlow(const Args& args,
+                            OpKernelContext::Params* params) {
+    const ImmutableExecutorState& state = *control_flow_state_;
+    Device* device = params->device;
+    SingleThreadedPropagatorState propagator(state, args.step_id);
+
+    // Kernels are run in FIFO order, which runs the iterations of a loop in
+    // the same order as the default executor does when every kernel is
+    // inline.
+    std::deque<TaggedNode> ready_queue;
+    SingleThreadedPropagatorState::TaggedNodeSeq ready;
+    propagator.ActivateRoots(state.root_nodes(), &ready);
+    ready_queue.insert(ready_queue.end(), ready.begin(), ready.end());
+    ready.clear();
+
+    TensorValueVec node_inputs;
+    AllocatorAttributeVec input_alloc_attrs;
+    EntryVector outputs;
+    while (!ready_queue.empty()) {
+      const TaggedNode tagged_node = ready_queue.front();
+      ready_queue.pop_front();
+      const NodeItem& item = tagged_node.get_node_item();
+      Entry* first_input = propagator.GetInputTensors(tagged_node);
+
+      outputs.clear();
+      outputs.resize(item.num_outputs);
+      if (tagged_node.get_is_dead()) {
+        // A dead node does not run its kernel, and all of its outputs are
+        // dead.
+      } else if (item.const_tensor != nullptr) {
+        Entry& output = outputs[0];
+        output.state = Entry::State::HAS_CONST_TENSOR;
+        output.const_tensor = item.const_tensor;
+        output.alloc_attr = item.output_attrs()[0];
+      } else {
+        node_inputs.clear();
+        node_inputs.resize(item.num_inputs);
+        input_alloc_attrs.clear();
+        input_alloc_attrs.resize(item.num_inputs);
+        for (int i = 0; i < item.num_inputs; ++i) {
+          const Entry& input = first_input[i];
+          input_alloc_attrs[i] = input.alloc_attr;
+          switch (input.state) {
+            case Entry::State::NO_VALUE:
+              // Only merge nodes can run with a dead input.
+              if (!item.is_merge) {
+                return AttachDef(
+                    errors::Internal("Missing ", i, "-th input"),
+                    item.kernel->def());
+              }
+              node_inputs[i].tensor = nullptr;
+              break;
+            case Entry::State::HAS_CONST_TENSOR:
+              // See the NOTE(mrry) about this `const_cast` in `Run()`.
+              node_inputs[i].tensor = const_cast<Tensor*>(input.const_tensor);
+              break;
+            case Entry::State::HAS_VALUE:
+              node_inputs[i].tensor = input.val.get();
+              break;
+            default:
+              return AttachDef(
+                  errors::Internal("Invalid state of the ", i, "-th input"),
+                  item.kernel->def());
+          }
+        }
+        params->inputs = node_inputs;
+        params->input_alloc_attrs = input_alloc_attrs;
+        params->op_kernel = item.kernel;
+        params->output_attr_array = item.output_attrs();
+        params->frame_iter = propagator.GetFrameAndIter(tagged_node);
+        OpKernelContext ctx(params, item.num_outputs);
+
+        // Actually execute the kernel.
+        device->Compute(item.kernel, &ctx);
+        if (!ctx.status().ok()) {
+          return AttachDef(ctx.status(), item.kernel->def());
+        }
+        TF_RETURN_IF_ERROR(ReleaseOutputs(item, &ctx, &outputs));
+      }
+
+      // Free the inputs to the current kernel.
+      for (int i = 0; i < item.num_inputs; ++i) {
+        first_input[i].ClearVal();
+      }
+
+      propagator.PropagateOutputs(tagged_node, &outputs, &ready);
+      ready_queue.insert(ready_queue.end(), ready.begin(), ready.end());
+      ready.clear();
+    }
+    return absl::OkStatus();
+  }
+
+  // Moves the outputs of the kernel of `item` from `ctx` to `*outputs`.
+  static Status ReleaseOutputs(const NodeItem& item, OpKernelContext* ctx,
+                               EntryVector* outputs) {
+    Status s;
+    for (int i = 0; i < item.num_outputs; ++i) {
+      const TensorValue val = ctx->release_output(i);
+      Entry& out = (*outputs)[i];
+      if (val.tensor == nullptr) {
+        // Unless it's a Switch or a Recv, or the executor has marked the output
+        // as not required, the node must produce a tensor value at i-th output.
+        if (!(item.is_recv_or_switch ||
+              (item.outputs_required && !item.outputs_required[i]))) {
+          s.Update(errors::Internal("Missing ", i, "-th output from ",
+                                    FormatNodeDefForError(item.kernel->def())));
+        }
+        continue;
+      }
+      const DataType dtype = val.dtype_safe();
+      if (dtype == item.output_type(i)) {
+        out.state = Entry::State::HAS_VALUE;
+        out.val.Init(std::move(*val.tensor));
+        out.alloc_attr = ctx->output_alloc_attr(i);
+      } else {
+        s.Update(
+            errors::Internal("Output ", i, " of type ", DataTypeString(dtype),
+                             " does not match declared output type ",
+                             DataTypeString(item.output_type(i)), " for node ",
+                             FormatNodeDefForError(item.kernel->def())));
+      }
+      delete val.tensor;
+    }
+    return s;
+  }
+
   // Execute all operations in the calling thread when asynchronous execution
   // is requested. Callers may expect to perform expensive work in the calling
   // thread even when the execution itself is single-threaded.
@@ -495,8 +637,25 @@ class SingleThreadedExecutorImpl : public Executor {
     args.runner([this, args, done]() { done(Run(args)); });
   }
 
+  // Returns true if `graph` contains "v1-style" control flow nodes that this
+  // executor cannot run as ordinary kernels.
+  bool RequiresControlFlowSupport(const Graph& graph) const {
+    for (const Node* n : graph.nodes()) {
+      if (n->IsSwitch() ||
+          (n->IsControlFlow() && !params_.allow_control_flow_sync_execution)) {
+        return true;
+      }
+    }
+    return false;
+  }
+
   const LocalExecutorParams params_;
 
+  // If non-null, the graph requires control flow support, and is executed
+  // using this state instead of the kernels below. Owns the kernels of the
+  // graph.
+  std::unique_ptr<ImmutableExecutorState> control_flow_state_;
+
   // All following members are read-only after Initialize().
 
   // The sum of the number of inputs for each node in the graph. This determines
@@ -34,10 +34,11 @@ namespace tensorflow {
 //
 // 1. Reference-typed tensors are not supported and will not be supported in
 //    future.
-// 2. Graphs with control flow (containing "Switch" and "Merge" nodes) are not
-//    currently supported. The current plan is to extend support to "functional"
-//    control flow after the TensorFlow APIs transition to building graphs in
-//    that form (e.g. `tf.cond_v2()`).
+// 2. Graphs with control flow (containing "Switch" and "Merge" nodes) are
+//    executed in the order in which their kernels become ready, by a
+//    `SingleThreadedPropagatorState` that tracks frames, iterations and dead
+//    tensors without locks or atomic operations. These graphs do not benefit
+//    from the argument forwarding used for other graphs.
 // 3. Partitioned graphs (containing "_Recv" nodes) are not currently supported.
 //    The present implementation executes kernels one at a time in topological
 //    order, and cannot currently distinguish between disconnected subgraphs
@@ -56,8 +57,9 @@ Status NewSingleThreadedExecutor(const LocalExecutorParams& params,
 
 // Returns OkStatus() for ops which are compatible with synchronous execution,
 // and otherwise returns an error message appropriate for propagation if needed.
-// If `allow_control_flow_sync_execution` is set to `true` control
-// nodes are marked as safe for execution on the SingleThreadedExecutor.
+// Control flow nodes are safe for execution on the SingleThreadedExecutor
+// whether or not `allow_control_flow_sync_execution` is set; the flag only
+// determines whether graphs without Switch nodes run them as ordinary kernels.
 Status ValidateOpIsSafeForSyncExecution(const Node& n,
                                         bool allow_control_flow_sync_execution);
 
@@ -26,9 +26,11 @@ limitations under the License.
 #include "tensorflow/core/common_runtime/graph_constructor.h"
 #include "tensorflow/core/common_runtime/kernel_benchmark_testlib.h"
 #include "tensorflow/core/common_runtime/process_util.h"
+#include "tensorflow/core/common_runtime/single_threaded_executor.h"
 #include "tensorflow/core/framework/op.h"
 #include "tensorflow/core/framework/op_kernel.h"
 #include "tensorflow/core/framework/rendezvous.h"
+#include "tensorflow/core/framework/tensor_testutil.h"
 #include "tensorflow/core/framework/versions.pb.h"
 #include "tensorflow/core/graph/algorithm.h"
 #include "tensorflow/core/graph/graph.h"
@@ -171,6 +173,9 @@ float V(const Tensor& tensor) {
   return tensor.scalar<float>()();
 }
 
+// An int32 val -> Tensor<int32>
+Tensor I32(const int32_t val) { return test::AsScalar<int32>(val); }
+
 Rendezvous::ParsedKey Key(const string& sender, const uint64 incarnation,
                           const string& receiver, const string& name) {
   Rendezvous::ParsedKey result;
@@ -357,6 +362,206 @@ TEST_F(ExecutorTest, ControlDependenciesFromSpecialNodes) {
   EXPECT_EQ(3.0, V(retvals[0]));  // out = 1.0 + 2.0 = 3.0
 }
 
+TEST_F(ExecutorTest, SwitchAndMerge) {
+  // out = pred ? (x + 1.0) : (x + x)
+  auto g = std::make_unique<Graph>(OpRegistry::Global());
+  auto in0 = test::graph::Arg(g.get(), 0, DT_FLOAT);
+  auto pred = test::graph::Arg(g.get(), 1, DT_BOOL);
+  auto one = test::graph::Constant(g.get(), V(1.0));
+  auto sw = test::graph::Switch(g.get(), in0, pred);
+  Node* on_false;
+  TF_ASSERT_OK(NodeBuilder(g->NewName("n"), "Add")
+                   .Input(sw, 0)
+                   .Input(sw, 0)
+                   .Finalize(g.get(), &on_false));
+  Node* on_true;
+  TF_ASSERT_OK(NodeBuilder(g->NewName("n"), "Add")
+                   .Input(sw, 1)
+                   .Input(one)
+                   .Finalize(g.get(), &on_true));
+  auto merge = test::graph::Merge(g.get(), on_false, on_true);
+  test::graph::Retval(g.get(), 0, merge);
+  FixupSourceAndSinkEdges(g.get());
+  Create(std::move(g));
+
+  for (bool pred_value : {true, false}) {
+    FunctionCallFrame call_frame({DT_FLOAT, DT_BOOL}, {DT_FLOAT});
+    TF_ASSERT_OK(call_frame.SetArgs({V(3.0), Tensor(pred_value)}));
+    TF_ASSERT_OK(Run(&call_frame));
+    std::vector<Tensor> retvals;
+    TF_ASSERT_OK(call_frame.ConsumeRetvals(&retvals, false));
+    EXPECT_EQ(pred_value ? 4.0 : 6.0, V(retvals[0]));
+  }
+}
+
+// Adds an Enter node for the loop invariant `input` to `g`.
+Node* ConstantEnter(Graph* g, Node* input, const string& frame_name) {
+  Node* ret;
+  TF_CHECK_OK(NodeBuilder(g->NewName("n"), "Enter")
+                  .Input(input)
+                  .Attr("frame_name", frame_name)
+                  .Attr("is_constant", true)
+                  .Finalize(g, &ret));
+  return ret;
+}
+
+// Adds a "v1-style" while loop to `g`, which computes
+// `while (x < limit) x = body(x, invariant)` in the frame `frame_name`, and
+// returns its Exit node. `limit` and `invariant` enter the frame as loop
+// invariants.
+Node* WhileLoop(Graph* g, const string& frame_name, Node* x, Node* limit,
+                Node* invariant,
+                const std::function<Node*(Node*, Node*)>& body) {
+  Node* enter = test::graph::Enter(g, x, frame_name);
+  Node* limit_enter = ConstantEnter(g, limit, frame_name);
+  Node* invariant_enter = ConstantEnter(g, invariant, frame_name);
+  const string next_name = g->NewName("n");
+  Node* merge = test::graph::Merge(g, enter, {next_name});
+  Node* loop_cond =
+      test::graph::LoopCond(g, test::graph::Less(g, merge, limit_enter));
+  Node* sw = test::graph::Switch(g, merge, loop_cond);
+  Node* next = test::graph::Next(
+      g, next_name, body(test::graph::Identity(g, sw, 1), invariant_enter));
+  g->AddEdge(next, 0, merge, 1);
+  return test::graph::Exit(g, sw);
+}
+
+TEST_F(ExecutorTest, WhileLoop) {
+  // while (x < limit) x = x + 1
+  auto g = std::make_unique<Graph>(OpRegistry::Global());
+  auto x = test::graph::Arg(g.get(), 0, DT_INT32);
+  auto limit = test::graph::Arg(g.get(), 1, DT_INT32);
+  auto one = test::graph::Constant(g.get(), I32(1));
+  auto exit = WhileLoop(g.get(), "loop", x, limit, one,
+                        [&g](Node* x, Node* one) {
+                          return test::graph::Add(g.get(), x, one);
+                        });
+  test::graph::Retval(g.get(), 0, exit);
+  FixupSourceAndSinkEdges(g.get());
+  Create(std::move(g));
+
+  for (int32_t limit_value : {0, 1, 2, 100}) {
+    FunctionCallFrame call_frame({DT_INT32, DT_INT32}, {DT_INT32});
+    TF_ASSERT_OK(call_frame.SetArgs({I32(0), I32(limit_value)}));
+    TF_ASSERT_OK(Run(&call_frame));
+    std::vector<Tensor> retvals;
+    TF_ASSERT_OK(call_frame.ConsumeRetvals(&retvals, false));
+    EXPECT_EQ(limit_value, retvals[0].scalar<int32>()());
+  }
+}
+
+TEST_F(ExecutorTest, NestedWhileLoops) {
+  // while (x < limit) {
+  //   y = x
+  //   while (y < x + 2) y = y + 1
+  //   x = y
+  // }
+  auto g = std::make_unique<Graph>(OpRegistry::Global());
+  auto x = test::graph::Arg(g.get(), 0, DT_INT32);
+  auto limit = test::graph::Arg(g.get(), 1, DT_INT32);
+  auto one = test::graph::Constant(g.get(), I32(1));
+  auto exit = WhileLoop(
+      g.get(), "outer", x, limit, one, [&g](Node* x, Node* one) {
+        Node* inner_limit = test::graph::Add(
+            g.get(), test::graph::Add(g.get(), x, one), one);
+        return WhileLoop(g.get(), "inner", x, inner_limit, one,
+                         [&g](Node* y, Node* one) {
+                           return test::graph::Add(g.get(), y, one);
+                         });
+      });
+  test::graph::Retval(g.get(), 0, exit);
+  FixupSourceAndSinkEdges(g.get());
+  Create(std::move(g));
+
+  for (int32_t limit_value : {0, 9, 10}) {
+    FunctionCallFrame call_frame({DT_INT32, DT_INT32}, {DT_INT32});
+    TF_ASSERT_OK(call_frame.SetArgs({I32(0), I32(limit_value)}));
+    TF_ASSERT_OK(Run(&call_frame));
+    std::vector<Tensor> retvals;
+    TF_ASSERT_OK(call_frame.ConsumeRetvals(&retvals, false));
+    EXPECT_EQ((limit_value + 1) / 2 * 2, retvals[0].scalar<int32>()());
+  }
+}
+
+TEST_F(ExecutorTest, SwitchAndMergeInWhileLoop) {
+  // while (x < limit) x = x < 5 ? x + x : x + 5
+  auto g = std::make_unique<Graph>(OpRegistry::Global());
+  auto x = test::graph::Arg(g.get(), 0, DT_INT32);
+  auto limit = test::graph::Arg(g.get(), 1, DT_INT32);
+  auto five = test::graph::Constant(g.get(), I32(5));
+  auto exit = WhileLoop(
+      g.get(), "loop", x, limit, five, [&g](Node* x, Node* five) {
+        Node* sw = test::graph::Switch(g.get(), x,
+                                       test::graph::Less(g.get(), x, five));
+        Node* on_false;
+        TF_CHECK_OK(NodeBuilder(g->NewName("n"), "Add")
+                        .Input(sw, 0)
+                        .Input(five)
+                        .Finalize(g.get(), &on_false));
+        Node* on_true;
+        TF_CHECK_OK(NodeBuilder(g->NewName("n"), "Add")
+                        .Input(sw, 1)
+                        .Input(sw, 1)
+                        .Finalize(g.get(), &on_true));
+        return test::graph::Merge(g.get(), on_false, on_true);
+      });
+  test::graph::Retval(g.get(), 0, exit);
+  FixupSourceAndSinkEdges(g.get());
+  Create(std::move(g));
+
+  FunctionCallFrame call_frame({DT_INT32, DT_INT32}, {DT_INT32});
+  TF_ASSERT_OK(call_frame.SetArgs({I32(1), I32(30)}));
+  TF_ASSERT_OK(Run(&call_frame));
+  std::vector<Tensor> retvals;
+  TF_ASSERT_OK(call_frame.ConsumeRetvals(&retvals, false));
+  EXPECT_EQ(33, retvals[0].scalar<int32>()());  // 1, 2, 4, 8, 13, ..., 33
+}
+
+TEST_F(ExecutorTest, WhileLoopInUntakenBranch) {
+  // out = pred ? while (x < limit) x = x + 1 : x + x
+  auto g = std::make_unique<Graph>(OpRegistry::Global());
+  auto x = test::graph::Arg(g.get(), 0, DT_INT32);
+  auto pred = test::graph::Arg(g.get(), 1, DT_BOOL);
+  auto limit = test::graph::Constant(g.get(), I32(10));
+  auto one = test::graph::Constant(g.get(), I32(1));
+  auto sw = test::graph::Switch(g.get(), x, pred);
+  Node* on_false;
+  TF_ASSERT_OK(NodeBuilder(g->NewName("n"), "Add")
+                   .Input(sw, 0)
+                   .Input(sw, 0)
+                   .Finalize(g.get(), &on_false));
+  Node* on_true = WhileLoop(
+      g.get(), "loop", test::graph::Identity(g.get(), sw, 1), limit, one,
+      [&g](Node* x, Node* one) { return test::graph::Add(g.get(), x, one); });
+  auto merge = test::graph::Merge(g.get(), on_false, on_true);
+  test::graph::Retval(g.get(), 0, merge);
+  FixupSourceAndSinkEdges(g.get());
+  Create(std::move(g));
+
+  for (bool pred_value : {true, false}) {
+    FunctionCallFrame call_frame({DT_INT32, DT_BOOL}, {DT_INT32});
+    TF_ASSERT_OK(call_frame.SetArgs({I32(3), Tensor(pred_value)}));
+    TF_ASSERT_OK(Run(&call_frame));
+    std::vector<Tensor> retvals;
+    TF_ASSERT_OK(call_frame.ConsumeRetvals(&retvals, false));
+    EXPECT_EQ(pred_value ? 10 : 6, retvals[0].scalar<int32>()());
+  }
+}
+
+TEST(SingleThreadedExecutorTest, ControlFlowIsSafeForSyncExecution) {
+  Graph g(OpRegistry::Global());
+  auto x = test::graph::Constant(&g, I32(1));
+  auto pred = test::graph::Constant(&g, Tensor(true));
+  auto sw = test::graph::Switch(&g, x, pred);
+  auto enter = test::graph::Enter(&g, x, "loop");
+  for (bool allow_control_flow_sync_execution : {false, true}) {
+    TF_EXPECT_OK(ValidateOpIsSafeForSyncExecution(
+        *sw, allow_control_flow_sync_execution));
+    TF_EXPECT_OK(ValidateOpIsSafeForSyncExecution(
+        *enter, allow_control_flow_sync_execution));
+  }
+}
+
 void BM_executor(::testing::benchmark::State& state) {
   const int width = state.range(0);
   const int depth = state.range(1);
@@ -436,6 +641,31 @@ BENCHMARK(BM_const_identity)->UseRealTime()->ArgPair(1, 100);
 BENCHMARK(BM_const_identity)->UseRealTime()->ArgPair(100, 1);
 BENCHMARK(BM_const_identity)->UseRealTime()->ArgPair(100, 100);
 
+void BM_WhileLoop(::testing::benchmark::State& state) {
+  const int loop_iters = state.range(0);
+
+  Graph* g = new Graph(OpRegistry::Global());
+  auto x = test::graph::Constant(g, I32(0));
+  auto limit = test::graph::Constant(g, I32(loop_iters));
+  auto one = test::graph::Constant(g, I32(1));
+  WhileLoop(g, "loop", x, limit, one,
+            [g](Node* x, Node* one) { return test::graph::Add(g, x, one); });
+  FixupSourceAndSinkEdges(g);
+  test::Benchmark("cpu", g, nullptr, nullptr, nullptr,
+                  "SINGLE_THREADED_EXECUTOR",
+                  /*old_benchmark_api=*/false)
+      .Run(state);
+  state.SetLabel(strings::StrCat("Iterations = ", loop_iters));
+  state.SetItemsProcessed(loop_iters *
+                          static_cast<int64_t>(state.iterations()));
+}
+
+// "v1-style" control flow, run by the single-threaded propagator.
+BENCHMARK(BM_WhileLoop)->UseRealTime()->Arg(1);
+BENCHMARK(BM_WhileLoop)->UseRealTime()->Arg(10);
+BENCHMARK(BM_WhileLoop)->UseRealTime()->Arg(100);
+BENCHMARK(BM_WhileLoop)->UseRealTime()->Arg(1000);
+
 // TODO(mrry): This benchmark currently crashes with a use-after free, because
 // test::Benchmark::RunWithArgs() assumes that the executor will take ownership
 // of the given graph, *and* keep its nodes (`x`, `y` and `z`) alive for the
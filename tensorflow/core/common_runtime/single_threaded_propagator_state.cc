@@ -0,0 +1,477 @@
+/* Copyright 2020 The TensorFlow Authors. All Rights Reserved.
+
+Licensed under the Apache License, Version 2.0 (the "License");
+you may not use this file except in compliance with the License.
+You may obtain a copy of the License at
+
+    http://www.apache.org/licenses/LICENSE-2.0
+
+Unless required by applicable law or agreed to in writing, software
+distributed under the License is distributed on an "AS IS" BASIS,
+WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+See the License for the specific language governing permissions and
+limitations under the License.
+==============================================================================*/
+#include "tensorflow/core/common_runtime/single_threaded_propagator_state.h"
+
+#include "tensorflow/core/common_runtime/graph_view.h"
+#include "tensorflow/core/lib/hash/hash.h"
+#include "tensorflow/core/platform/hash.h"
+#include "tensorflow/core/platform/logging.h"
+
+namespace tensorflow {
+
+SingleThreadedPropagatorState::FrameState::FrameState(
+    const ImmutableExecutorState::FrameInfo& frame_info, int parallel_iters)
+    : max_parallel_iterations(parallel_iters),
+      num_pending_inputs(frame_info.input_count),
+      iterations(parallel_iters + 1),
+      pending_counts(frame_info.pending_counts.get()),
+      total_input_tensors(frame_info.total_inputs) {
+  // Initialize iteration 0.
+  SetIteration(0, std::make_unique<IterationState>(0, pending_counts,
+                                                   total_input_tensors));
+}
+
+SingleThreadedPropagatorState::SingleThreadedPropagatorState(
+    const ImmutableExecutorState& immutable_state, int64_t step_id)
+    : immutable_state_(immutable_state), step_id_(step_id) {
+  // We start the entire execution in iteration 0 of the root frame.
+  root_frame_ = new FrameState(immutable_state_.get_root_frame_info(), 1);
+  outstanding_frames_.emplace(root_frame_->frame_id, root_frame_);
+}
+
+SingleThreadedPropagatorState::~SingleThreadedPropagatorState() {
+  for (auto id_frame : outstanding_frames_) {
+    delete id_frame.second;
+  }
+}
+
+void SingleThreadedPropagatorState::ActivateRoots(
+    gtl::ArraySlice<const NodeItem*> roots, TaggedNodeSeq* ready) {
+  IterationState* root_iter = root_frame_->GetIteration(0);
+  for (const NodeItem* item : roots) {
+    DCHECK_EQ(item->num_inputs, 0);
+    ready->emplace_back(item, root_frame_, root_iter, false);
+  }
+  root_iter->outstanding_ops = ready->size();
+}
+
+void SingleThreadedPropagatorState::PropagateOutputs(
+    const TaggedNode& tagged_node, EntryVector* outputs,
+    TaggedNodeSeq* ready) {
+  const NodeItem* const item = tagged_node.node_item;
+  FrameState* const input_frame = tagged_node.input_frame;
+  IterationState* const input_iter = tagged_node.input_iter;
+  const bool is_dead = tagged_node.is_dead;
+
+  // Propagates outputs along out edges, and puts newly ready nodes
+  // into the ready queue.
+  DCHECK(ready->empty());
+  bool is_frame_done = false;
+
+  if (!item->is_enter_exit_or_next_iter) {
+    // Fast path for node types that don't need special handling.
+    // This is the case for most nodes.
+    const int activated =
+        ActivateNodes(item, is_dead, input_frame, input_iter, outputs, ready);
+    is_frame_done = AdjustOutstandingOps(input_frame, input_iter,
+                                         activated - 1, ready);
+  } else if (item->is_enter) {
+    FrameState* output_frame =
+        FindOrCreateChildFrame(input_frame, input_iter, *item);
+    IterationState* output_iter = output_frame->GetIteration(0);
+    if (item->is_constant_enter) {
+      // Propagate to all active iterations if this is a loop invariant.
+      AddLoopInv(output_frame, item, (*outputs)[0], ready);
+    } else {
+      const int activated = ActivateNodes(item, is_dead, output_frame,
+                                          output_iter, outputs, ready);
+      AdjustOutstandingOps(output_frame, output_iter, activated, ready);
+    }
+    output_frame->num_pending_inputs--;
+    is_frame_done = AdjustOutstandingOps(input_frame, input_iter, -1, ready);
+  } else if (item->is_exit) {
+    if (is_dead) {
+      // Stop and remember this node if it is a dead exit.
+      if (input_iter->iter_num == input_frame->iteration_count) {
+        input_frame->dead_exits.push_back(item);
+      }
+    } else {
+      FrameState* output_frame = input_frame->parent_frame;
+      IterationState* output_iter = input_frame->parent_iter;
+      const int activated = ActivateNodes(item, is_dead, output_frame,
+                                          output_iter, outputs, ready);
+      AdjustOutstandingOps(output_frame, output_iter, activated, ready);
+    }
+    is_frame_done = AdjustOutstandingOps(input_frame, input_iter, -1, ready);
+  } else {
+    DCHECK(item->is_next_iteration);
+    // A dead NextIteration node stops the deadness propagation.
+    if (!is_dead) {
+      IterationState* output_iter = nullptr;
+      if (input_iter->iter_num < input_frame->iteration_count) {
+        output_iter = input_frame->GetIteration(input_iter->iter_num + 1);
+      } else if (input_frame->num_outstanding_iterations <
+                 input_frame->max_parallel_iterations) {
+        output_iter = IncrementIteration(input_frame, ready);
+      } else {
+        // Reached the maximum for parallel iterations.
+        input_frame->next_iter_roots.push_back({item, (*outputs)[0]});
+      }
+      if (output_iter != nullptr) {
+        const int activated = ActivateNodes(item, is_dead, input_frame,
+                                            output_iter, outputs, ready);
+        AdjustOutstandingOps(input_frame, output_iter, activated, ready);
+      }
+    }
+    is_frame_done = AdjustOutstandingOps(input_frame, input_iter, -1, ready);
+  }
+
+  // At this point, this node is completely done. We also know if the
+  // completion of this node makes its frame completed.
+  if (is_frame_done) {
+    FrameState* parent_frame = input_frame->parent_frame;
+    IterationState* parent_iter = input_frame->parent_iter;
+    DeleteFrame(input_frame, ready);
+    if (parent_frame != nullptr) {
+      // The completion of frame may cause completions in its parent frame.
+      // So clean things up recursively.
+      CleanupFramesIterations(parent_frame, parent_iter, ready);
+    }
+  }
+}
+
+SingleThreadedPropagatorState::FrameState*
+SingleThreadedPropagatorState::FindOrCreateChildFrame(
+    FrameState* frame, IterationState* iter_state, const NodeItem& node_item) {
+  const ImmutableExecutorState::FrameInfo& frame_info =
+      immutable_state_.get_enter_frame_info(node_item);
+
+  const uint64 child_id = Hash64Combine(
+      frame->frame_id,
+      Hash64Combine(iter_state->iter_num, Hash64(frame_info.name)));
+
+  auto it = outstanding_frames_.find(child_id);
+  if (it != outstanding_frames_.end()) {
+    return it->second;
+  }
+
+  VLOG(2) << "Step " << step_id_ << ": create frame " << frame_info.name
+          << " id: " << child_id;
+  FrameState* child =
+      new FrameState(frame_info, frame_info.parallel_iterations);
+  child->frame_id = child_id;
+  child->parent_frame = frame;
+  child->parent_iter = iter_state;
+  iter_state->outstanding_frame_count++;
+  outstanding_frames_[child_id] = child;
+  return child;
+}
+
+void SingleThreadedPropagatorState::DeleteFrame(FrameState* frame,
+                                                TaggedNodeSeq* ready) {
+  // First, propagate dead_exits (if any) to the parent frame.
+  FrameState* parent_frame = frame->parent_frame;
+  IterationState* parent_iter_state = frame->parent_iter;
+  if (parent_frame != nullptr) {
+    const GraphView& gview = immutable_state_.graph_view();
+    PendingCounts& counts = parent_iter_state->counts;
+    for (const NodeItem* item : frame->dead_exits) {
+      auto maybe_add_to_ready = [&](const NodeItem& dst_item, bool dst_ready,
+                                    bool dst_dead) {
+        if (dst_ready) {
+          if (dst_item.is_control_trigger) dst_dead = false;
+          ready->emplace_back(&dst_item, parent_frame, parent_iter_state,
+                              dst_dead);
+          parent_iter_state->outstanding_ops++;
+        }
+      };
+
+      for (const EdgeInfo& e : item->output_edges()) {
+        const NodeItem& dst_item = gview.node_ref(e.dst_id);
+        const auto dst_pending_id = immutable_state_.pending_ids()[e.dst_id];
+
+        bool dst_dead = true;
+        bool dst_ready;
+        // We know this is a dead input to dst.
+        if (dst_item.is_merge) {
+          counts.increment_dead_count(dst_pending_id);
+          dst_dead = counts.dead_count(dst_pending_id) == dst_item.num_inputs;
+          dst_ready = counts.pending(dst_pending_id) == 1 && dst_dead;
+        } else {
+          counts.increment_dead_count(dst_pending_id);
+          dst_ready = counts.decrement_pending(dst_pending_id, 1) == 0;
+        }
+        maybe_add_to_ready(dst_item, dst_ready, dst_dead);
+      }
+
+      for (const ControlEdgeInfo& e : item->output_control_edges()) {
+        const NodeItem& dst_item = gview.node_ref(e.dst_id);
+        const auto dst_pending_id = immutable_state_.pending_ids()[e.dst_id];
+
+        bool dst_dead = true;
+        bool dst_ready;
+        // We know this is a dead input to dst.
+        if (dst_item.is_merge) {
+          counts.decrement_pending(dst_pending_id, 2);
+          const int count = counts.pending(dst_pending_id);
+          dst_dead = counts.dead_count(dst_pending_id) == dst_item.num_inputs;
+          dst_ready = (count == 0) || ((count == 1) && dst_dead);
+        } else {
+          counts.increment_dead_count(dst_pending_id);
+          dst_ready = counts.decrement_pending(dst_pending_id, 1) == 0;
+        }
+        maybe_add_to_ready(dst_item, dst_ready, dst_dead);
+      }
+    }
+  }
+
+  // Delete the frame.
+  VLOG(2) << "Step " << step_id_ << ": delete frame " << frame->frame_id;
+  outstanding_frames_.erase(frame->frame_id);
+  delete frame;
+}
+
+void SingleThreadedPropagatorState::CleanupFramesIterations(
+    FrameState* frame, IterationState* iter_state, TaggedNodeSeq* ready) {
+  iter_state->outstanding_frame_count--;
+  if (CleanupIterations(frame, iter_state, ready)) {
+    FrameState* parent_frame = frame->parent_frame;
+    IterationState* parent_iter = frame->parent_iter;
+    DeleteFrame(frame, ready);
+    if (parent_frame != nullptr) {
+      // The completion of frame may cause completions in its parent frame.
+      // So clean things up recursively.
+      CleanupFramesIterations(parent_frame, parent_iter, ready);
+    }
+  }
+}
+
+int SingleThreadedPropagatorState::ActivateNodes(const NodeItem* item,
+                                                 const bool is_dead,
+                                                 FrameState* frame,
+                                                 IterationState* iter_state,
+                                                 EntryVector* outputs,
+                                                 TaggedNodeSeq* ready) {
+  const GraphView& gview = immutable_state_.graph_view();
+  // If we know that none of the item's edge destinations require special
+  // handling (i.e. none of the nodes is a merge or control trigger node), we
+  // can avoid accessing the destination NodeItem until it becomes ready.
+  const bool check_dst = item->is_any_consumer_merge_or_control_trigger;
+  PendingCounts& counts = iter_state->counts;
+  Entry* input_tensors = iter_state->input_tensors.get();
+  int activated = 0;
+
+  auto maybe_add_to_ready = [&](int dst_id, bool dst_ready, bool dst_dead) {
+    if (dst_ready) {
+      const NodeItem* dst_item = &gview.node_ref(dst_id);
+      if (check_dst && dst_item->is_control_trigger) dst_dead = false;
+      ready->emplace_back(dst_item, frame, iter_state, dst_dead);
+      activated++;
+    }
+  };
+
+  for (const EdgeInfo& e : item->output_edges()) {
+    const int dst_id = e.dst_id;
+    const PendingCounts::Handle dst_pending_id =
+        immutable_state_.pending_ids()[dst_id];
+    const int src_slot = e.output_slot;
+    const bool is_live = (*outputs)[src_slot].state != Entry::State::NO_VALUE;
+
+    bool dst_dead = false;
+    bool dst_ready = false;
+    if (check_dst && gview.node_ref(dst_id).is_merge) {
+      // A merge node is ready if all control inputs have arrived and either
+      // a) a live data input becomes available or b) all data inputs are
+      // dead. For Merge, pending's LSB is set iff a live data input has
+      // arrived.
+      if (is_live) {
+        const int dst_loc = e.input_slot;
+        if (e.is_last) {
+          input_tensors[dst_loc] = std::move((*outputs)[src_slot]);
+        } else {
+          input_tensors[dst_loc] = (*outputs)[src_slot];
+        }
+        // The node should be started if and only if this is the first live
+        // input and there are no pending control edges, i.e. count == 1.
+        dst_ready = counts.adjust_for_mark_live(dst_pending_id).pending_count ==
+                    1;
+      } else {
+        // This is a dead data input. Note that dst_node is dead if node is
+        // a dead enter, to handle a while loop on the untaken branch of a
+        // conditional.
+        const PendingCounts::AdjustResult adjust_result =
+            counts.adjust_for_increment_dead(dst_pending_id);
+        dst_dead =
+            (adjust_result.dead_count == gview.node_ref(dst_id).num_inputs) ||
+            item->is_enter;
+        dst_ready = (adjust_result.pending_count == 1) && dst_dead;
+      }
+    } else {
+      // Handle all other (non-merge) nodes.
+      const int dst_loc = e.input_slot;
+      if (e.is_last) {
+        input_tensors[dst_loc] = std::move((*outputs)[src_slot]);
+      } else {
+        input_tensors[dst_loc] = (*outputs)[src_slot];
+      }
+      const PendingCounts::AdjustResult adjust_result =
+          counts.adjust_for_activation(dst_pending_id, is_dead || !is_live);
+      dst_dead = adjust_result.dead_count > 0;
+      dst_ready = adjust_result.pending_count == 0;
+    }
+    maybe_add_to_ready(dst_id, dst_ready, dst_dead);
+  }
+
+  for (const ControlEdgeInfo& e : item->output_control_edges()) {
+    const int dst_id = e.dst_id;
+    const PendingCounts::Handle dst_pending_id =
+        immutable_state_.pending_ids()[dst_id];
+
+    bool dst_dead;
+    bool dst_ready;
+    if (check_dst && gview.node_ref(dst_id).is_merge) {
+      const PendingCounts::AdjustResult adjust_result =
+          counts.adjust_for_decrement_pending(dst_pending_id,
+                                              /*decrement_pending=*/2);
+      dst_dead = adjust_result.dead_count == gview.node_ref(dst_id).num_inputs;
+      dst_ready = (adjust_result.pending_count == 0) ||
+                  ((adjust_result.pending_count == 1) && dst_dead);
+    } else {
+      const PendingCounts::AdjustResult adjust_result =
+          counts.adjust_for_activation(dst_pending_id, is_dead);
+      dst_dead = adjust_result.dead_count > 0;
+      dst_ready = adjust_result.pending_count == 0;
+    }
+    maybe_add_to_ready(dst_id, dst_ready, dst_dead);
+  }
+
+  return activated;
+}
+
+void SingleThreadedPropagatorState::ActivateNexts(FrameState* frame,
+                                                  IterationState* iter_state,
+                                                  TaggedNodeSeq* ready) {
+  int activated = 0;
+  // Propagate the deferred NextIteration nodes to the new iteration.
+  for (auto& node_entry : frame->next_iter_roots) {
+    const NodeItem* item = node_entry.first;
+    const Entry& entry = node_entry.second;
+    const bool is_dead = entry.state == Entry::State::NO_VALUE;
+    EntryVector outputs{entry};
+    activated += ActivateNodes(item, is_dead, frame, iter_state, &outputs,
+                               ready);
+  }
+  frame->next_iter_roots.clear();
+  AdjustOutstandingOps(frame, iter_state, activated, ready);
+}
+
+void SingleThreadedPropagatorState::ActivateLoopInvs(FrameState* frame,
+                                                     IterationState* iter_state,
+                                                     TaggedNodeSeq* ready) {
+  // Propagate loop invariants to the new iteration.
+  int activated = 0;
+  for (auto& node_entry : frame->inv_values) {
+    const NodeItem* item = node_entry.first;
+    const Entry& entry = node_entry.second;
+    const bool is_dead = entry.state == Entry::State::NO_VALUE;
+    EntryVector outputs{entry};
+    activated += ActivateNodes(item, is_dead, frame, iter_state, &outputs,
+                               ready);
+  }
+  AdjustOutstandingOps(frame, iter_state, activated, ready);
+}
+
+void SingleThreadedPropagatorState::AddLoopInv(FrameState* frame,
+                                               const NodeItem* item,
+                                               const Entry& entry,
+                                               TaggedNodeSeq* ready) {
+  // Store this value.
+  frame->inv_values.push_back({item, entry});
+
+  // Make this value available to all iterations.
+  const bool is_dead = entry.state == Entry::State::NO_VALUE;
+  for (int64_t i = 0; i <= frame->iteration_count; ++i) {
+    EntryVector outputs{entry};
+    IterationState* iter_state = frame->GetIteration(i);
+    const int activated =
+        ActivateNodes(item, is_dead, frame, iter_state, &outputs, ready);
+    AdjustOutstandingOps(frame, iter_state, activated, ready);
+  }
+}
+
+bool SingleThreadedPropagatorState::IsIterationDone(
+    FrameState* frame, IterationState* iter_state) {
+  if (iter_state->outstanding_ops == 0 &&
+      iter_state->outstanding_frame_count == 0) {
+    if (iter_state->iter_num == 0) {
+      // The enclosing frame has no pending input.
+      return frame->num_pending_inputs == 0;
+    } else {
+      // The preceding iteration is deleted (and therefore done).
+      return frame->GetIteration(iter_state->iter_num - 1) == nullptr;
+    }
+  }
+  return false;
+}
+
+SingleThreadedPropagatorState::IterationState*
+SingleThreadedPropagatorState::IncrementIteration(FrameState* frame,
+                                                  TaggedNodeSeq* ready) {
+  frame->iteration_count++;
+
+  // Initialize the next iteration.
+  frame->SetIteration(frame->iteration_count,
+                      std::make_unique<IterationState>(
+                          frame->iteration_count, frame->pending_counts,
+                          frame->total_input_tensors));
+  IterationState* next_iter = frame->GetIteration(frame->iteration_count);
+  frame->num_outstanding_iterations++;
+  frame->dead_exits.clear();
+
+  // Activate the successors of the deferred roots in the new iteration.
+  ActivateNexts(frame, next_iter, ready);
+
+  // Activate the loop invariants in the new iteration.
+  ActivateLoopInvs(frame, next_iter, ready);
+
+  return next_iter;
+}
+
+bool SingleThreadedPropagatorState::AdjustOutstandingOps(
+    FrameState* frame, IterationState* iter_state, int delta,
+    TaggedNodeSeq* ready) {
+  DCHECK(delta >= 0 || iter_state->outstanding_ops >= -delta)
+      << "cannot adjust outstanding_ops by " << delta
+      << " when current value is " << iter_state->outstanding_ops;
+  iter_state->outstanding_ops += delta;
+  if (iter_state->outstanding_ops != 0) {
+    return false;
+  }
+  return CleanupIterations(frame, iter_state, ready);
+}
+
+bool SingleThreadedPropagatorState::CleanupIterations(
+    FrameState* frame, IterationState* iter_state, TaggedNodeSeq* ready) {
+  int64_t curr_iter = iter_state->iter_num;
+  while (curr_iter <= frame->iteration_count &&
+         IsIterationDone(frame, iter_state)) {
+    frame->SetIteration(curr_iter, nullptr);
+    --frame->num_outstanding_iterations;
+    ++curr_iter;
+
+    // When one iteration is completed, we check for deferred iteration,
+    // and start it if there is one.
+    if (!frame->next_iter_roots.empty()) {
+      IncrementIteration(frame, ready);
+    }
+
+    if (curr_iter <= frame->iteration_count) {
+      iter_state = frame->GetIteration(curr_iter);
+    }
+  }
+  return frame->IsFrameDone();
+}
+
+}  // namespace tensorflow
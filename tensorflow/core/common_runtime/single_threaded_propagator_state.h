@@ -0,0 +1,264 @@
+/* Copyright 2020 The TensorFlow Authors. All Rights Reserved.
+
+Licensed under the Apache License, Version 2.0 (the "License");
+you may not use this file except in compliance with the License.
+You may obtain a copy of the License at
+
+    http://www.apache.org/licenses/LICENSE-2.0
+
+Unless required by applicable law or agreed to in writing, software
+distributed under the License is distributed on an "AS IS" BASIS,
+WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+See the License for the specific language governing permissions and
+limitations under the License.
+==============================================================================*/
+#ifndef TENSORFLOW_CORE_COMMON_RUNTIME_SINGLE_THREADED_PROPAGATOR_STATE_H_
+#define TENSORFLOW_CORE_COMMON_RUNTIME_SINGLE_THREADED_PROPAGATOR_STATE_H_
+
+#include <memory>
+#include <utility>
+#include <vector>
+
+#include "tensorflow/core/common_runtime/entry.h"
+#include "tensorflow/core/common_runtime/immutable_executor_state.h"
+#include "tensorflow/core/common_runtime/pending_counts.h"
+#include "tensorflow/core/framework/control_flow.h"
+#include "tensorflow/core/lib/gtl/array_slice.h"
+#include "tensorflow/core/lib/gtl/flatmap.h"
+#include "tensorflow/core/lib/gtl/inlined_vector.h"
+#include "tensorflow/core/platform/types.h"
+
+namespace tensorflow {
+
+// Represents the ephemeral "edge state" associated with one invocation of
+// `Executor::Run()` by an executor that runs every kernel in the calling
+// thread.
+//
+// `SingleThreadedPropagatorState` implements the same frame, iteration and
+// deadness semantics as `PropagatorState`, so it supports graphs with
+// arbitrary (including nested) control flow. Unlike `PropagatorState`, it
+// must only be accessed by one thread at a time: it takes no locks, and it
+// updates the outstanding op counts and the pending counts of each iteration
+// without atomic read-modify-write operations.
+class SingleThreadedPropagatorState {
+ public:
+  SingleThreadedPropagatorState(const ImmutableExecutorState& immutable_state,
+                                int64_t step_id);
+  ~SingleThreadedPropagatorState();
+
+ private:
+  // Forward declaration so that `TaggedNode` can include a `FrameState*` and an
+  // `IterationState*`.
+  struct FrameState;
+  struct IterationState;
+
+ public:
+  // A `TaggedNode` corresponds to a single invocation of a node's kernel,
+  // and it is created when the kernel becomes runnable (in a particular
+  // iteration of a particular frame).
+  struct TaggedNode {
+    const NodeItem* node_item;
+    FrameState* input_frame;
+    IterationState* input_iter;
+    bool is_dead;
+
+    TaggedNode() = default;
+    TaggedNode(const NodeItem* node_item, FrameState* in_frame,
+               IterationState* in_iter, bool dead)
+        : node_item(node_item),
+          input_frame(in_frame),
+          input_iter(in_iter),
+          is_dead(dead) {}
+
+    const NodeItem& get_node_item() const { return *node_item; }
+
+    bool get_is_dead() const { return is_dead; }
+    int64_t get_iter_num() const;
+  };
+
+  typedef gtl::InlinedVector<TaggedNode, 8> TaggedNodeSeq;
+
+  // Creates and adds a `TaggedNode` for each node in `roots` to `*ready`.
+  void ActivateRoots(gtl::ArraySlice<const NodeItem*> roots,
+                     TaggedNodeSeq* ready);
+
+  // After processing the outputs, propagates the outputs to their dsts.
+  // Contents of *outputs are left in an indeterminate state after
+  // returning from this method.
+  void PropagateOutputs(const TaggedNode& tagged_node, EntryVector* outputs,
+                        TaggedNodeSeq* ready);
+
+  // Returns an array of `Entry` objects corresponding to the inputs of
+  // `tagged_node`.
+  Entry* GetInputTensors(const TaggedNode& tagged_node) const {
+    return tagged_node.input_iter->input_tensors.get() +
+           tagged_node.node_item->input_start;
+  }
+
+  // Returns the frame ID and iteration of `tagged_node`, for use in an
+  // `OpKernelContext::Params`.
+  FrameAndIter GetFrameAndIter(const TaggedNode& tagged_node) const {
+    return {tagged_node.input_frame->frame_id,
+            tagged_node.input_iter->iter_num};
+  }
+
+ private:
+  // The state of an iteration in a particular frame.
+  struct IterationState {
+    IterationState(int64_t iter_num, const PendingCounts* pending_counts,
+                   int total_input_tensors)
+        : iter_num(iter_num),
+          input_tensors(new Entry[total_input_tensors]),
+          counts(*pending_counts) {}
+
+    // The index of this iteration in the enclosing loop.
+    const int64_t iter_num;
+
+    // One copy per iteration. For iteration k, i-th node's j-th input is in
+    // input_tensors[k][immutable_state_.nodes[i].input_start + j]. An entry
+    // is either a tensor pointer (pass-by-reference) or a tensor
+    // (pass-by-value).
+    std::unique_ptr<Entry[]> input_tensors;
+
+    // The number of outstanding ops for each iteration.
+    int outstanding_ops = 0;
+
+    // The number of outstanding frames for each iteration.
+    int outstanding_frame_count = 0;
+
+    PendingCounts counts;
+  };
+
+  // The state of a particular frame (a loop or the root of the graph).
+  struct FrameState {
+    FrameState(const ImmutableExecutorState::FrameInfo& frame_info,
+               int parallel_iters);
+
+    // A unique id for this frame, which is 0 for the root frame.
+    uint64 frame_id = 0;
+
+    // The iteration state of the parent frame that this frame was entered
+    // from, or nullptr for the root frame.
+    FrameState* parent_frame = nullptr;
+    IterationState* parent_iter = nullptr;
+
+    // The number of iterations that may run at the same time.
+    const int max_parallel_iterations;
+
+    // The number of inputs this frame is still waiting for.
+    int num_pending_inputs;
+
+    // The highest iteration number we have reached so far in this frame.
+    int64_t iteration_count = 0;
+
+    // The number of outstanding iterations.
+    int num_outstanding_iterations = 1;
+
+    // The active iteration states of this frame, in a ring buffer of
+    // `max_parallel_iterations + 1` slots indexed by iteration number.
+    std::vector<std::unique_ptr<IterationState>> iterations;
+
+    // The NextIteration nodes to enter a new iteration. If the number of
+    // outstanding iterations reaches the limit, we will defer the start of
+    // the next iteration until the number of outstanding iterations falls
+    // below the limit.
+    std::vector<std::pair<const NodeItem*, Entry>> next_iter_roots;
+
+    // The values of the loop invariants for this loop. They are added into
+    // this list as they "enter" the frame. When a loop invariant enters,
+    // we make it available to all active iterations. When the frame starts
+    // a new iteration, we make all the current loop invariants available
+    // to the new iteration.
+    std::vector<std::pair<const NodeItem*, Entry>> inv_values;
+
+    // The list of dead exit node items for the current highest iteration.
+    std::vector<const NodeItem*> dead_exits;
+
+    const PendingCounts* const pending_counts;
+    const int total_input_tensors;
+
+    IterationState* GetIteration(int64_t iter) {
+      return iterations[iter % iterations.size()].get();
+    }
+
+    void SetIteration(int64_t iter, std::unique_ptr<IterationState> state) {
+      iterations[iter % iterations.size()] = std::move(state);
+    }
+
+    // Returns true if the computation in the frame is completed.
+    bool IsFrameDone() const {
+      return num_pending_inputs == 0 && num_outstanding_iterations == 0;
+    }
+  };
+
+  // Finds an existing child frame, or creates a new one if necessary.
+  FrameState* FindOrCreateChildFrame(FrameState* frame,
+                                     IterationState* iter_state,
+                                     const NodeItem& node_item);
+
+  // Deletes a frame. Called when the frame is done.
+  void DeleteFrame(FrameState* frame, TaggedNodeSeq* ready);
+
+  // Cleans up frames and iterations after `iter_state` of `frame` loses a
+  // child frame.
+  void CleanupFramesIterations(FrameState* frame, IterationState* iter_state,
+                               TaggedNodeSeq* ready);
+
+  // Propagates the outputs of `item` to its successors in `iter_state` of
+  // `frame`. Returns the number of successors that became ready.
+  int ActivateNodes(const NodeItem* item, bool is_dead, FrameState* frame,
+                    IterationState* iter_state, EntryVector* outputs,
+                    TaggedNodeSeq* ready);
+
+  // Activates the deferred NextIteration nodes in a new iteration.
+  void ActivateNexts(FrameState* frame, IterationState* iter_state,
+                     TaggedNodeSeq* ready);
+
+  // Activates all the currently known loop invariants in a new iteration.
+  void ActivateLoopInvs(FrameState* frame, IterationState* iter_state,
+                        TaggedNodeSeq* ready);
+
+  // Adds a new loop invariant and makes it available to all active
+  // iterations.
+  void AddLoopInv(FrameState* frame, const NodeItem* item, const Entry& entry,
+                  TaggedNodeSeq* ready);
+
+  // Returns true if the iteration of the frame is completed.
+  bool IsIterationDone(FrameState* frame, IterationState* iter_state);
+
+  // Increments the iteration id. If this is a new iteration, initializes it.
+  IterationState* IncrementIteration(FrameState* frame, TaggedNodeSeq* ready);
+
+  // Adds `delta` to the outstanding op count of `iter_state` in `frame`, and
+  // cleans up the iterations of the frame once there are none left. Returns
+  // true iff the execution of the frame is done.
+  bool AdjustOutstandingOps(FrameState* frame, IterationState* iter_state,
+                            int delta, TaggedNodeSeq* ready);
+
+  // Cleans up the completed iterations of `frame`, starting at `iter_state`.
+  // Returns true iff the execution of the frame is done.
+  bool CleanupIterations(FrameState* frame, IterationState* iter_state,
+                         TaggedNodeSeq* ready);
+
+  const ImmutableExecutorState& immutable_state_;
+  const int64_t step_id_;
+
+  // The root frame in which the execution of this step is started.
+  FrameState* root_frame_;
+
+  // A map from frame id to frames that are currently active. Owns the
+  // frames.
+  gtl::FlatMap<uint64, FrameState*> outstanding_frames_;
+
+  SingleThreadedPropagatorState(const SingleThreadedPropagatorState&) = delete;
+  void operator=(const SingleThreadedPropagatorState&) = delete;
+};
+
+inline int64_t SingleThreadedPropagatorState::TaggedNode::get_iter_num()
+    const {
+  return input_iter->iter_num;
+}
+
+}  // namespace tensorflow
+
+#endif  // TENSORFLOW_CORE_COMMON_RUNTIME_SINGLE_THREADED_PROPAGATOR_STATE_H_
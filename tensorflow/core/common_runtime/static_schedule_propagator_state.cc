@@ -0,0 +1,131 @@
+/* Copyright 2024 The TensorFlow Authors. All Rights Reserved.
+
+Licensed under the Apache License, Version 2.0 (the "License");
+you may not use this file except in compliance with the License.
+You may obtain a copy of the License at
+
+    http://www.apache.org/licenses/LICENSE-2.0
+
+Unless required by applicable law or agreed to in writing, software
+distributed under the License is distributed on an "AS IS" BASIS,
+WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+See the License for the specific language governing permissions and
+limitations under the License.
+==============================================================================*/
+#include "tensorflow/core/common_runtime/static_schedule_propagator_state.h"
+
+#include <atomic>
+
+#include "tensorflow/core/common_runtime/propagator_debug_utils.h"
+#include "tensorflow/core/framework/op_kernel.h"
+#include "tensorflow/core/profiler/lib/traceme.h"
+
+namespace tensorflow {
+
+StaticSchedulePropagatorState::StaticSchedulePropagatorState(
+    const ImmutableExecutorState& immutable_state, int64_t step_id, bool vlog)
+    : schedule_(*immutable_state.static_schedule()),
+      step_id_(step_id),
+      vlog_(vlog || VLOG_IS_ON(1)),
+      input_tensors_(immutable_state.get_root_frame_info().total_inputs),
+      active_(vlog_ ? new std::vector<bool>(
+                          immutable_state.graph_view().num_nodes())
+                    : nullptr) {}
+
+StaticSchedulePropagatorState::~StaticSchedulePropagatorState() {}
+
+void StaticSchedulePropagatorState::ActivateRoots(
+    gtl::ArraySlice<const NodeItem*> roots, TaggedNodeSeq* ready) {
+  if (schedule_.num_waves() == 0) {
+    DCHECK(roots.empty());
+    return;
+  }
+  DCHECK_EQ(roots.size(), schedule_.wave_size(0));
+  ActivateWave(0, ready);
+}
+
+void StaticSchedulePropagatorState::ActivateWave(int wave,
+                                                 TaggedNodeSeq* ready) {
+  current_wave_ = wave;
+  const int wave_size = schedule_.wave_size(wave);
+  // NOTE: The count must be reset before any node of `wave` is dispatched, or
+  // else a fast node could complete before the count is valid.
+  num_pending_in_wave_.store(wave_size, std::memory_order_relaxed);
+  ready->reserve(ready->size() + wave_size);
+  const NodeItem* const* begin = schedule_.wave_begin(wave);
+  for (int i = 0; i < wave_size; ++i) {
+    ready->push_back(TaggedNode(begin[i]));
+  }
+}
+
+void StaticSchedulePropagatorState::PropagateOutputs(
+    const TaggedNode& tagged_node, EntryVector* outputs, TaggedNodeSeq* ready) {
+  tsl::profiler::TraceMe activity(
+      [&]() {
+        return strings::StrCat(
+            "ExecutorPropagateOutputs#", "id=", step_id_,
+            ",kernel_name=", tagged_node.node_item->kernel->name_view(),
+            ",num_output_edges=", tagged_node.node_item->num_output_edges,
+            "#");
+      },
+      tsl::profiler::GetTFTraceMeLevel(/*is_expensive=*/false));
+
+  DCHECK(ready->empty());
+
+  const NodeItem* item = tagged_node.node_item;
+  for (const EdgeInfo& e : item->output_edges()) {
+    if (e.is_last) {
+      input_tensors_[e.input_slot] = std::move((*outputs)[e.output_slot]);
+    } else {
+      input_tensors_[e.input_slot] = (*outputs)[e.output_slot];
+    }
+  }
+
+  // NOTE: The acquire-release ordering makes the writes to `input_tensors_`
+  // from every node in the current wave visible to the thread that activates
+  // the next wave, and hence to the nodes that it dispatches.
+  if (num_pending_in_wave_.fetch_sub(1, std::memory_order_acq_rel) == 1) {
+    const int next_wave = current_wave_ + 1;
+    if (next_wave < schedule_.num_waves()) {
+      ActivateWave(next_wave, ready);
+    }
+  }
+}
+
+void StaticSchedulePropagatorState::DumpState() {
+  mutex_lock l(mu_);
+  LOG(WARNING) << "    Static schedule wave " << current_wave_ << " of "
+               << schedule_.num_waves() << " with "
+               << num_pending_in_wave_.load(std::memory_order_relaxed)
+               << " pending nodes";
+  // Dump any waiting nodes in later waves that are holding on to tensors.
+  for (int wave = current_wave_ + 1; wave < schedule_.num_waves(); ++wave) {
+    const NodeItem* const* begin = schedule_.wave_begin(wave);
+    for (int i = 0; i < schedule_.wave_size(wave); ++i) {
+      DumpPendingNodeState(*begin[i], input_tensors_.data(), false);
+    }
+  }
+  // Then the active nodes.
+  for (const NodeItem* node : schedule_.nodes) {
+    if ((*active_)[node->node_id]) {
+      DumpActiveNodeState(*node, input_tensors_.data());
+    }
+  }
+  // Show all input tensors in use.
+  size_t total_bytes = 0;
+  for (size_t i = 0; i < input_tensors_.size(); ++i) {
+    const Entry& input = input_tensors_[i];
+    const Tensor* tensor = GetTensorValueForDump(input);
+    if (tensor && tensor->IsInitialized()) {
+      LOG(WARNING) << "    Input " << i << ": "
+                   << strings::StrCat(
+                          "Tensor<type: ", DataTypeString(tensor->dtype()),
+                          " shape: ", tensor->shape().DebugString(),
+                          ", bytes: ", tensor->TotalBytes(), ">");
+      total_bytes += tensor->TotalBytes();
+    }
+  }
+  LOG(WARNING) << "    Total bytes " << total_bytes;
+}
+
+}  // namespace tensorflow
@@ -0,0 +1,132 @@
+/* Copyright 2024 The TensorFlow Authors. All Rights Reserved.
+
+Licensed under the Apache License, Version 2.0 (the "License");
+you may not use this file except in compliance with the License.
+You may obtain a copy of the License at
+
+    http://www.apache.org/licenses/LICENSE-2.0
+
+Unless required by applicable law or agreed to in writing, software
+distributed under the License is distributed on an "AS IS" BASIS,
+WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+See the License for the specific language governing permissions and
+limitations under the License.
+==============================================================================*/
+#ifndef TENSORFLOW_CORE_COMMON_RUNTIME_STATIC_SCHEDULE_PROPAGATOR_STATE_H_
+#define TENSORFLOW_CORE_COMMON_RUNTIME_STATIC_SCHEDULE_PROPAGATOR_STATE_H_
+
+#include <atomic>
+#include <memory>
+#include <vector>
+
+#include "tensorflow/core/common_runtime/entry.h"
+#include "tensorflow/core/common_runtime/immutable_executor_state.h"
+#include "tensorflow/core/common_runtime/simple_propagator_state.h"
+#include "tensorflow/core/framework/control_flow.h"
+#include "tensorflow/core/lib/gtl/inlined_vector.h"
+#include "tensorflow/core/platform/logging.h"
+#include "tensorflow/core/platform/macros.h"
+#include "tensorflow/core/platform/mutex.h"
+#include "tensorflow/core/platform/thread_annotations.h"
+#include "tensorflow/core/platform/types.h"
+
+namespace tensorflow {
+
+// Represents the ephemeral "edge state" associated with one invocation of
+// `Executor::Run()`, for executors that run a precomputed
+// `ImmutableExecutorState::StaticSchedule`.
+//
+// Like `SimplePropagatorState`, this class does not support "v1-style" control
+// flow. Instead of tracking a pending count for every node, it releases the
+// nodes of the schedule one wave at a time: `PropagateOutputs()` only writes
+// the outputs of a node to the inputs of its destinations, and the node that
+// completes a wave adds every node of the next wave to the ready list. This
+// replaces one atomic update per edge and one ready-queue push per node with a
+// single atomic update per node and one batched push per wave.
+class StaticSchedulePropagatorState {
+ public:
+  StaticSchedulePropagatorState(const ImmutableExecutorState& immutable_state,
+                                int64_t step_id, bool vlog);
+  ~StaticSchedulePropagatorState();
+
+  using TaggedNode = SimplePropagatorState::TaggedNode;
+  using TaggedNodeReadyQueue = SimplePropagatorState::TaggedNodeReadyQueue;
+  using TaggedNodeSeq = SimplePropagatorState::TaggedNodeSeq;
+
+  // Adds a `TaggedNode` for each node in the first wave of the schedule to
+  // `*ready`. The first wave always consists of exactly the nodes in `roots`.
+  void ActivateRoots(gtl::ArraySlice<const NodeItem*> roots,
+                     TaggedNodeSeq* ready);
+
+  // After processing the outputs, propagates the outputs to their dsts. If
+  // `tagged_node` is the last node of its wave to complete, adds the nodes of
+  // the next wave to `*ready`.
+  //
+  // Contents of *outputs are left in an indeterminate state after
+  // returning from this method.
+  void PropagateOutputs(const TaggedNode& tagged_node, EntryVector* outputs,
+                        TaggedNodeSeq* ready);
+
+  // Returns an array of `Entry` objects corresponding to the inputs of
+  // `tagged_node`.
+  Entry* GetInputTensors(const TaggedNode& tagged_node) {
+    return input_tensors_.data() + tagged_node.node_item->input_start;
+  }
+
+  FrameAndIter GetFrameAndIter(const TaggedNode& tagged_node) const {
+    return {0, 0};
+  }
+
+  // Provide debugging output of the state of the executor.
+  void DumpState();
+
+  // For debugging/logging only.
+  void MaybeMarkStarted(const TaggedNode& tagged_node) {
+    if (TF_PREDICT_FALSE(vlog_) && VLOG_IS_ON(1)) {
+      mutex_lock l(mu_);
+      (*active_)[tagged_node.node_item->node_id] = true;
+    }
+  }
+  void MaybeMarkCompleted(const TaggedNode& tagged_node) {
+    if (TF_PREDICT_FALSE(vlog_) && VLOG_IS_ON(1)) {
+      mutex_lock l(mu_);
+      (*active_)[tagged_node.node_item->node_id] = false;
+    }
+  }
+
+ private:
+  // Adds the nodes of `wave` to `*ready`, and resets the count of outstanding
+  // nodes in the current wave.
+  void ActivateWave(int wave, TaggedNodeSeq* ready);
+
+  const ImmutableExecutorState::StaticSchedule& schedule_;
+  const int64_t step_id_;
+  const bool vlog_;
+
+  // The i-th node's j-th input is stored at
+  // `input_tensors[impl_->nodes[i].input_start + j]`.
+  //
+  // NOTE: No need to protect input_tensors[i] by any locks because it is
+  // resized once. Each element is written once by the source node of an edge
+  // in an earlier wave, and read by the destination node in a later wave. The
+  // acquire-release update of `num_pending_in_wave_` orders the two accesses.
+  std::vector<Entry> input_tensors_;
+
+  // The index of the wave that is currently running. Only written by the node
+  // that completes the previous wave.
+  int current_wave_ = 0;
+
+  // The number of nodes in `current_wave_` that have not yet completed.
+  std::atomic<int32> num_pending_in_wave_{0};
+
+  // If `vlog_` is true, this stores a bit vector of active nodes, indexed by
+  // node ID.
+  mutex mu_;
+  std::unique_ptr<std::vector<bool>> active_ TF_GUARDED_BY(mu_);
+
+  TF_DISALLOW_COPY_AND_ASSIGN(StaticSchedulePropagatorState);
+};
+
+}  // namespace tensorflow
+
+#endif  // TENSORFLOW_CORE_COMMON_RUNTIME_STATIC_SCHEDULE_PROPAGATOR_STATE_H_
@@ -0,0 +1,293 @@
+/* Copyright 2024 The TensorFlow Authors. All Rights Reserved.
+
+Licensed under the Apache License, Version 2.0 (the "License");
+you may not use this file except in compliance with the License.
+You may obtain a copy of the License at
+
+    http://www.apache.org/licenses/LICENSE-2.0
+
+Unless required by applicable law or agreed to in writing, software
+distributed under the License is distributed on an "AS IS" BASIS,
+WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+See the License for the specific language governing permissions and
+limitations under the License.
+==============================================================================*/
+#include "tensorflow/core/common_runtime/step_arena_allocator.h"
+
+#include <algorithm>
+#include <utility>
+
+#include "tensorflow/core/platform/logging.h"
+
+namespace tensorflow {
+
+namespace {
+
+// The allocator and node on whose behalf the current thread is allocating.
+struct ThreadAllocationState {
+  StepArenaAllocator* arena = nullptr;
+  int32 node_id = -1;
+  int32 next_ordinal = 0;
+};
+
+thread_local ThreadAllocationState current_allocation_state;
+
+size_t RoundUpToAlignment(size_t num_bytes) {
+  constexpr size_t kAlignment = Allocator::kAllocatorAlignment;
+  return (num_bytes + kAlignment - 1) / kAlignment * kAlignment;
+}
+
+}  // namespace
+
+std::shared_ptr<const StepArenaAllocator::Plan> StepArenaAllocator::Plan::Build(
+    absl::Span<const AllocationRecord> records) {
+  auto plan = std::make_shared<Plan>();
+
+  std::vector<const AllocationRecord*> candidates;
+  candidates.reserve(records.size());
+  for (const AllocationRecord& record : records) {
+    if (record.free_time >= 0 && record.num_bytes > 0) {
+      candidates.push_back(&record);
+    }
+  }
+  // Place the largest allocations first, which tends to produce the smallest
+  // arena (see also `tflite::GreedyMemoryPlanner`).
+  std::stable_sort(candidates.begin(), candidates.end(),
+                   [](const AllocationRecord* a, const AllocationRecord* b) {
+                     if (a->num_bytes != b->num_bytes) {
+                       return a->num_bytes > b->num_bytes;
+                     }
+                     return a->alloc_time < b->alloc_time;
+                   });
+
+  // The recorded lifetimes of the allocations that back each slot.
+  std::vector<std::pair<int64_t, int64_t>> lifetimes;
+  std::vector<int32> overlapping;
+  for (const AllocationRecord* record : candidates) {
+    const uint64 key = Key(record->node_id, record->ordinal);
+    if (plan->slot_index_.contains(key)) continue;
+    const size_t num_bytes = RoundUpToAlignment(record->num_bytes);
+
+    // Find the lowest offset at which this allocation does not overlap any
+    // already placed allocation whose lifetime overlaps its own.
+    overlapping.clear();
+    for (int32 i = 0; i < plan->slots_.size(); ++i) {
+      if (lifetimes[i].first < record->free_time &&
+          record->alloc_time < lifetimes[i].second) {
+        overlapping.push_back(i);
+      }
+    }
+    std::sort(overlapping.begin(), overlapping.end(),
+              [&plan](int32 a, int32 b) {
+                return plan->slots_[a].offset < plan->slots_[b].offset;
+              });
+    size_t offset = 0;
+    for (int32 i : overlapping) {
+      const Slot& other = plan->slots_[i];
+      if (other.offset >= offset + num_bytes) break;
+      offset = std::max(offset, other.offset + other.num_bytes);
+    }
+
+    plan->slot_index_[key] = plan->slots_.size();
+    plan->slots_.push_back(Slot{offset, num_bytes, {}});
+    lifetimes.emplace_back(record->alloc_time, record->free_time);
+    plan->arena_bytes_ = std::max(plan->arena_bytes_, offset + num_bytes);
+  }
+
+  // Record which slots share memory, so that the allocator can detect when
+  // the execution order of a step differs from the recorded one.
+  std::vector<int32> by_offset(plan->slots_.size());
+  for (int32 i = 0; i < by_offset.size(); ++i) by_offset[i] = i;
+  std::sort(by_offset.begin(), by_offset.end(), [&plan](int32 a, int32 b) {
+    return plan->slots_[a].offset < plan->slots_[b].offset;
+  });
+  for (int32 i = 0; i < by_offset.size(); ++i) {
+    Slot& slot = plan->slots_[by_offset[i]];
+    plan->slots_by_offset_[slot.offset].push_back(by_offset[i]);
+    for (int32 j = i + 1; j < by_offset.size(); ++j) {
+      Slot& other = plan->slots_[by_offset[j]];
+      if (other.offset >= slot.offset + slot.num_bytes) break;
+      slot.conflicts.push_back(by_offset[j]);
+      other.conflicts.push_back(by_offset[i]);
+    }
+  }
+  return plan;
+}
+
+int32 StepArenaAllocator::Plan::FindSlot(int32 node_id, int32 ordinal) const {
+  auto it = slot_index_.find(Key(node_id, ordinal));
+  return it == slot_index_.end() ? -1 : it->second;
+}
+
+StepArenaAllocator::ScopedNode::ScopedNode(StepArenaAllocator* arena,
+                                           int32 node_id)
+    : saved_arena_(current_allocation_state.arena),
+      saved_node_id_(current_allocation_state.node_id),
+      saved_next_ordinal_(current_allocation_state.next_ordinal) {
+  current_allocation_state.arena = arena;
+  current_allocation_state.node_id = node_id;
+  current_allocation_state.next_ordinal = 0;
+}
+
+StepArenaAllocator::ScopedNode::~ScopedNode() {
+  current_allocation_state.arena = saved_arena_;
+  current_allocation_state.node_id = saved_node_id_;
+  current_allocation_state.next_ordinal = saved_next_ordinal_;
+}
+
+StepArenaAllocator::StepArenaAllocator(Allocator* base,
+                                       std::shared_ptr<const Plan> plan)
+    : base_(base), plan_(std::move(plan)) {
+  if (plan_ != nullptr && plan_->arena_bytes() > 0) {
+    arena_ = static_cast<char*>(
+        base_->AllocateRaw(kAllocatorAlignment, plan_->arena_bytes()));
+    if (arena_ != nullptr) {
+      arena_bytes_ = plan_->arena_bytes();
+      slot_in_use_ =
+          std::make_unique<std::atomic<bool>[]>(plan_->num_slots());
+      for (int32 i = 0; i < plan_->num_slots(); ++i) {
+        slot_in_use_[i].store(false, std::memory_order_relaxed);
+      }
+    }
+  }
+}
+
+StepArenaAllocator::~StepArenaAllocator() {
+  DCHECK_EQ(arena_refs_.load(), 0);
+}
+
+bool StepArenaAllocator::TryAcquireSlot(int32 slot) {
+  // NOTE: A slot is only acquired if none of the slots that share its memory
+  // are in use. The sequentially consistent store and loads ensure that, of
+  // two threads concurrently acquiring conflicting slots, at least one will
+  // observe the other and back off to the base allocator.
+  slot_in_use_[slot].store(true, std::memory_order_seq_cst);
+  for (int32 other : plan_->slots_[slot].conflicts) {
+    if (slot_in_use_[other].load(std::memory_order_seq_cst)) {
+      slot_in_use_[slot].store(false, std::memory_order_release);
+      return false;
+    }
+  }
+  return true;
+}
+
+void* StepArenaAllocator::AllocateRaw(size_t alignment, size_t num_bytes) {
+  ThreadAllocationState& state = current_allocation_state;
+  const bool attributed = state.arena == this;
+  int32 ordinal = -1;
+  if (attributed) ordinal = state.next_ordinal++;
+
+  void* ptr = nullptr;
+  if (attributed && arena_ != nullptr && alignment <= kAllocatorAlignment) {
+    const int32 slot = plan_->FindSlot(state.node_id, ordinal);
+    if (slot >= 0 && num_bytes <= plan_->slot_bytes(slot) &&
+        TryAcquireSlot(slot)) {
+      ptr = arena_ + plan_->slot_offset(slot);
+      arena_refs_.fetch_add(1, std::memory_order_relaxed);
+      num_arena_allocations_.fetch_add(1, std::memory_order_relaxed);
+    }
+  }
+  if (ptr == nullptr) {
+    ptr = base_->AllocateRaw(alignment, num_bytes);
+    if (ptr == nullptr) return nullptr;
+    if (attributed && plan_ == nullptr) {
+      mutex_lock l(mu_);
+      if (!step_ended_) {
+        live_records_[ptr] = records_.size();
+        records_.push_back(AllocationRecord{state.node_id, ordinal, num_bytes,
+                                            clock_++, /*free_time=*/-1});
+      }
+    }
+  }
+  refs_.fetch_add(1, std::memory_order_relaxed);
+  return ptr;
+}
+
+void StepArenaAllocator::DeallocateRaw(void* ptr) {
+  char* p = static_cast<char*>(ptr);
+  if (arena_ != nullptr && p >= arena_ && p < arena_ + arena_bytes_) {
+    // At most one of the slots at this offset can be in use, because they
+    // all conflict with each other.
+    auto it = plan_->slots_by_offset_.find(p - arena_);
+    DCHECK(it != plan_->slots_by_offset_.end());
+    for (int32 slot : it->second) {
+      if (slot_in_use_[slot].load(std::memory_order_acquire)) {
+        slot_in_use_[slot].store(false, std::memory_order_release);
+        break;
+      }
+    }
+    ReleaseArenaRef();
+  } else {
+    if (plan_ == nullptr) {
+      mutex_lock l(mu_);
+      if (!step_ended_) {
+        auto it = live_records_.find(ptr);
+        if (it != live_records_.end()) {
+          records_[it->second].free_time = clock_++;
+          live_records_.erase(it);
+        }
+      }
+    }
+    base_->DeallocateRaw(ptr);
+  }
+  Unref();
+}
+
+void StepArenaAllocator::EndStep(std::vector<AllocationRecord>* records) {
+  if (plan_ == nullptr) {
+    mutex_lock l(mu_);
+    step_ended_ = true;
+    if (records != nullptr) *records = std::move(records_);
+    records_.clear();
+    live_records_.clear();
+  }
+  ReleaseArenaRef();
+  Unref();
+}
+
+void StepArenaAllocator::ReleaseArenaRef() {
+  if (arena_refs_.fetch_sub(1, std::memory_order_acq_rel) == 1 &&
+      arena_ != nullptr) {
+    base_->DeallocateRaw(arena_);
+  }
+}
+
+void StepArenaAllocator::Unref() {
+  if (refs_.fetch_sub(1, std::memory_order_acq_rel) == 1) {
+    delete this;
+  }
+}
+
+StepArenaAllocator* StepArenaPlanner::BeginStep() {
+  std::shared_ptr<const StepArenaAllocator::Plan> plan;
+  {
+    mutex_lock l(mu_);
+    if (plan_ == nullptr) {
+      if (recording_) return nullptr;
+      recording_ = true;
+    }
+    plan = plan_;
+  }
+  return new StepArenaAllocator(base_, std::move(plan));
+}
+
+void StepArenaPlanner::EndStep(StepArenaAllocator* arena, bool step_ok) {
+  if (!arena->is_recording()) {
+    arena->EndStep(/*records=*/nullptr);
+    return;
+  }
+  std::vector<StepArenaAllocator::AllocationRecord> records;
+  arena->EndStep(&records);
+  std::shared_ptr<const StepArenaAllocator::Plan> plan;
+  if (step_ok) {
+    plan = StepArenaAllocator::Plan::Build(records);
+    VLOG(1) << "Built step arena plan with " << plan->num_slots()
+            << " slots for " << records.size() << " recorded allocations ("
+            << plan->arena_bytes() << " bytes).";
+  }
+  mutex_lock l(mu_);
+  plan_ = std::move(plan);
+  recording_ = false;
+}
+
+}  // namespace tensorflow
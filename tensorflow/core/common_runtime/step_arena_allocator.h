@@ -0,0 +1,227 @@
+/* Copyright 2024 The TensorFlow Authors. All Rights Reserved.
+
+Licensed under the Apache License, Version 2.0 (the "License");
+you may not use this file except in compliance with the License.
+You may obtain a copy of the License at
+
+    http://www.apache.org/licenses/LICENSE-2.0
+
+Unless required by applicable law or agreed to in writing, software
+distributed under the License is distributed on an "AS IS" BASIS,
+WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+See the License for the specific language governing permissions and
+limitations under the License.
+==============================================================================*/
+#ifndef TENSORFLOW_CORE_COMMON_RUNTIME_STEP_ARENA_ALLOCATOR_H_
+#define TENSORFLOW_CORE_COMMON_RUNTIME_STEP_ARENA_ALLOCATOR_H_
+
+#include <atomic>
+#include <memory>
+#include <string>
+#include <vector>
+
+#include "absl/container/flat_hash_map.h"
+#include "absl/types/span.h"
+#include "tensorflow/core/framework/allocator.h"
+#include "tensorflow/core/platform/mutex.h"
+#include "tensorflow/core/platform/thread_annotations.h"
+#include "tensorflow/core/platform/types.h"
+
+namespace tensorflow {
+
+// An allocator that serves the allocations of one executor step from a single
+// arena, at offsets that were planned ahead of time.
+//
+// Allocations are identified by the node on whose behalf they are made, and by
+// their ordinal among the allocations made while running that node (see
+// `ScopedNode`). A `StepArenaAllocator` runs in one of two modes:
+//
+// * Recording: every allocation is forwarded to the base allocator, and the
+//   size and lifetime of each allocation are recorded. `StepArenaPlanner`
+//   uses these records to build a `Plan`.
+// * Planned: each allocation with a slot in the `Plan` is served from the
+//   arena. Slots whose lifetimes did not overlap in the recorded step share
+//   memory. Because the execution order of a step is not fixed, a slot is only
+//   used if no overlapping slot is in use; otherwise, and for any allocation
+//   without a slot, the base allocator is used.
+//
+// The arena is obtained from the base allocator with a single allocation.
+// It is returned once the step has ended and every tensor backed by the arena
+// has been deallocated, so tensors that outlive the step remain valid.
+//
+// A `StepArenaAllocator` deletes itself when the step has ended (see
+// `StepArenaPlanner::EndStep()`) and all of the memory that it allocated has
+// been deallocated.
+class StepArenaAllocator : public Allocator {
+ public:
+  // The size and lifetime of one allocation made during a recorded step.
+  // Times are ticks of a per-step logical clock that advances on every
+  // allocation and deallocation.
+  struct AllocationRecord {
+    int32 node_id;
+    int32 ordinal;
+    size_t num_bytes;
+    int64_t alloc_time;
+    // -1 if the allocation was still live when the step ended.
+    int64_t free_time;
+  };
+
+  // An assignment of arena offsets to the allocations of a step.
+  class Plan {
+   public:
+    // Builds a plan for the allocations in `records` that were deallocated
+    // before the end of the recorded step, using a greedy-by-size placement.
+    static std::shared_ptr<const Plan> Build(
+        absl::Span<const AllocationRecord> records);
+
+    // The total size of the arena.
+    size_t arena_bytes() const { return arena_bytes_; }
+    int num_slots() const { return slots_.size(); }
+
+    // Returns the index of the slot for the `ordinal`-th allocation made by
+    // node `node_id`, or -1 if there is no such slot.
+    int32 FindSlot(int32 node_id, int32 ordinal) const;
+
+    // Returns the arena offset and size of the given slot.
+    size_t slot_offset(int32 slot) const { return slots_[slot].offset; }
+    size_t slot_bytes(int32 slot) const { return slots_[slot].num_bytes; }
+
+   private:
+    friend class StepArenaAllocator;
+
+    struct Slot {
+      size_t offset;
+      size_t num_bytes;
+      // The slots whose byte ranges overlap this slot.
+      std::vector<int32> conflicts;
+    };
+
+    static uint64 Key(int32 node_id, int32 ordinal) {
+      return (static_cast<uint64>(static_cast<uint32>(node_id)) << 32) |
+             static_cast<uint32>(ordinal);
+    }
+
+    std::vector<Slot> slots_;
+    absl::flat_hash_map<uint64, int32> slot_index_;
+    absl::flat_hash_map<size_t, std::vector<int32>> slots_by_offset_;
+    size_t arena_bytes_ = 0;
+  };
+
+  // While in scope, allocations made through `arena` by the current thread are
+  // attributed to node `node_id`. Allocations made by other threads (for
+  // example, intra-op worker threads) are always forwarded to the base
+  // allocator.
+  class ScopedNode {
+   public:
+    ScopedNode(StepArenaAllocator* arena, int32 node_id);
+    ~ScopedNode();
+
+   private:
+    StepArenaAllocator* const saved_arena_;
+    const int32 saved_node_id_;
+    const int32 saved_next_ordinal_;
+
+    ScopedNode(const ScopedNode&) = delete;
+    void operator=(const ScopedNode&) = delete;
+  };
+
+  // Creates an allocator for one step that allocates from `base`. If `plan`
+  // is nullptr, the allocator records allocations instead.
+  StepArenaAllocator(Allocator* base, std::shared_ptr<const Plan> plan);
+
+  std::string Name() override { return "step_arena"; }
+  void* AllocateRaw(size_t alignment, size_t num_bytes) override;
+  void DeallocateRaw(void* ptr) override;
+  AllocatorMemoryType GetMemoryType() const override {
+    return base_->GetMemoryType();
+  }
+
+  Allocator* base() const { return base_; }
+  bool is_recording() const { return plan_ == nullptr; }
+
+  // Returns the number of allocations served from the arena so far.
+  int64_t num_arena_allocations() const {
+    return num_arena_allocations_.load(std::memory_order_relaxed);
+  }
+
+ private:
+  friend class StepArenaPlanner;
+  ~StepArenaAllocator() override;
+
+  // Ends the step. In recording mode, moves the recorded allocations into
+  // `*records`. May delete `this`.
+  void EndStep(std::vector<AllocationRecord>* records);
+
+  bool TryAcquireSlot(int32 slot);
+  void ReleaseArenaRef();
+  void Unref();
+
+  Allocator* const base_;
+  const std::shared_ptr<const Plan> plan_;
+
+  // The arena, or nullptr if it could not be allocated.
+  char* arena_ = nullptr;
+  size_t arena_bytes_ = 0;
+
+  // In planned mode, `slot_in_use_[i]` is true while slot `i` backs a live
+  // tensor.
+  std::unique_ptr<std::atomic<bool>[]> slot_in_use_;
+
+  // One reference for the step, plus one for each live allocation.
+  std::atomic<int64_t> refs_{1};
+  // One reference for the step, plus one for each live arena allocation.
+  std::atomic<int64_t> arena_refs_{1};
+
+  std::atomic<int64_t> num_arena_allocations_{0};
+
+  // State for recording mode.
+  mutex mu_;
+  int64_t clock_ TF_GUARDED_BY(mu_) = 0;
+  bool step_ended_ TF_GUARDED_BY(mu_) = false;
+  std::vector<AllocationRecord> records_ TF_GUARDED_BY(mu_);
+  absl::flat_hash_map<void*, size_t> live_records_ TF_GUARDED_BY(mu_);
+
+  StepArenaAllocator(const StepArenaAllocator&) = delete;
+  void operator=(const StepArenaAllocator&) = delete;
+};
+
+// Owns the arena plan for the steps of one executor.
+//
+// The first step that starts when no plan exists records its allocations, and
+// the plan built from that recording is used by all later steps.
+class StepArenaPlanner {
+ public:
+  // `eligible_nodes[i]` is true iff the outputs and temporaries of node `i`
+  // may be allocated from the arena.
+  StepArenaPlanner(Allocator* base, std::vector<bool> eligible_nodes)
+      : base_(base), eligible_nodes_(std::move(eligible_nodes)) {}
+
+  bool IsEligible(int32 node_id) const { return eligible_nodes_[node_id]; }
+
+  // Returns a new allocator for a step, or nullptr if another step is
+  // currently recording allocations.
+  StepArenaAllocator* BeginStep();
+
+  // Ends the step that `arena` was created for. If `arena` was recording, and
+  // `step_ok` is true, builds the plan for later steps from its recording.
+  // `arena` must not be used for new allocations after this call.
+  void EndStep(StepArenaAllocator* arena, bool step_ok);
+
+  // Returns the current plan, or nullptr if no plan has been built yet.
+  std::shared_ptr<const StepArenaAllocator::Plan> plan() const {
+    tf_shared_lock l(mu_);
+    return plan_;
+  }
+
+ private:
+  Allocator* const base_;
+  const std::vector<bool> eligible_nodes_;
+
+  mutable mutex mu_;
+  std::shared_ptr<const StepArenaAllocator::Plan> plan_ TF_GUARDED_BY(mu_);
+  bool recording_ TF_GUARDED_BY(mu_) = false;
+};
+
+}  // namespace tensorflow
+
+#endif  // TENSORFLOW_CORE_COMMON_RUNTIME_STEP_ARENA_ALLOCATOR_H_
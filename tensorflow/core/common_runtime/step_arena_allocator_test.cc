@@ -0,0 +1,139 @@
+/* Copyright 2024 The TensorFlow Authors. All Rights Reserved.
+
+Licensed under the Apache License, Version 2.0 (the "License");
+you may not use this file except in compliance with the License.
+You may obtain a copy of the License at
+
+    http://www.apache.org/licenses/LICENSE-2.0
+
+Unless required by applicable law or agreed to in writing, software
+distributed under the License is distributed on an "AS IS" BASIS,
+WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+See the License for the specific language governing permissions and
+limitations under the License.
+==============================================================================*/
+#include "tensorflow/core/common_runtime/step_arena_allocator.h"
+
+#include <vector>
+
+#include "tensorflow/core/framework/allocator.h"
+#include "tensorflow/core/platform/test.h"
+
+namespace tensorflow {
+namespace {
+
+using AllocationRecord = StepArenaAllocator::AllocationRecord;
+
+TEST(StepArenaAllocatorPlanTest, ReusesMemoryForDisjointLifetimes) {
+  std::vector<AllocationRecord> records = {
+      {/*node_id=*/0, /*ordinal=*/0, /*num_bytes=*/100, 0, 2},
+      {/*node_id=*/1, /*ordinal=*/0, /*num_bytes=*/100, 1, 4},
+      {/*node_id=*/2, /*ordinal=*/0, /*num_bytes=*/64, 3, 5},
+  };
+  auto plan = StepArenaAllocator::Plan::Build(records);
+  ASSERT_EQ(3, plan->num_slots());
+  const int32 s0 = plan->FindSlot(0, 0);
+  const int32 s1 = plan->FindSlot(1, 0);
+  const int32 s2 = plan->FindSlot(2, 0);
+  ASSERT_GE(s0, 0);
+  ASSERT_GE(s1, 0);
+  ASSERT_GE(s2, 0);
+  // Sizes are rounded up to the allocator alignment.
+  EXPECT_EQ(128, plan->slot_bytes(s0));
+  EXPECT_NE(plan->slot_offset(s0), plan->slot_offset(s1));
+  // Node 2 is allocated after node 0 is freed, so it can reuse its memory.
+  EXPECT_EQ(plan->slot_offset(s0), plan->slot_offset(s2));
+  EXPECT_EQ(256, plan->arena_bytes());
+}
+
+TEST(StepArenaAllocatorPlanTest, ExcludesEscapedAndEmptyAllocations) {
+  std::vector<AllocationRecord> records = {
+      {/*node_id=*/0, /*ordinal=*/0, /*num_bytes=*/100, 0, /*free_time=*/-1},
+      {/*node_id=*/1, /*ordinal=*/0, /*num_bytes=*/0, 1, 2},
+      {/*node_id=*/1, /*ordinal=*/1, /*num_bytes=*/8, 3, 4},
+  };
+  auto plan = StepArenaAllocator::Plan::Build(records);
+  EXPECT_EQ(1, plan->num_slots());
+  EXPECT_EQ(-1, plan->FindSlot(0, 0));
+  EXPECT_EQ(-1, plan->FindSlot(1, 0));
+  EXPECT_GE(plan->FindSlot(1, 1), 0);
+  EXPECT_EQ(Allocator::kAllocatorAlignment, plan->arena_bytes());
+}
+
+TEST(StepArenaAllocatorTest, RecordsThenServesFromArena) {
+  StepArenaPlanner planner(cpu_allocator(), {true, true});
+
+  // The first step records its allocations.
+  StepArenaAllocator* recording = planner.BeginStep();
+  ASSERT_NE(nullptr, recording);
+  EXPECT_TRUE(recording->is_recording());
+  // Only one step records at a time.
+  EXPECT_EQ(nullptr, planner.BeginStep());
+  {
+    StepArenaAllocator::ScopedNode scope(recording, 0);
+    void* p = recording->AllocateRaw(Allocator::kAllocatorAlignment, 256);
+    ASSERT_NE(nullptr, p);
+    recording->DeallocateRaw(p);
+  }
+  {
+    StepArenaAllocator::ScopedNode scope(recording, 1);
+    void* p = recording->AllocateRaw(Allocator::kAllocatorAlignment, 256);
+    ASSERT_NE(nullptr, p);
+    recording->DeallocateRaw(p);
+  }
+  planner.EndStep(recording, /*step_ok=*/true);
+  auto plan = planner.plan();
+  ASSERT_NE(nullptr, plan);
+  EXPECT_EQ(2, plan->num_slots());
+  EXPECT_EQ(256, plan->arena_bytes());
+
+  // Later steps allocate from the arena.
+  StepArenaAllocator* arena = planner.BeginStep();
+  ASSERT_NE(nullptr, arena);
+  EXPECT_FALSE(arena->is_recording());
+  void* p0;
+  {
+    StepArenaAllocator::ScopedNode scope(arena, 0);
+    p0 = arena->AllocateRaw(Allocator::kAllocatorAlignment, 256);
+  }
+  EXPECT_EQ(1, arena->num_arena_allocations());
+  void* p1;
+  {
+    // Node 1 shares memory with node 0, which is still live, so it falls back
+    // to the base allocator.
+    StepArenaAllocator::ScopedNode scope(arena, 1);
+    p1 = arena->AllocateRaw(Allocator::kAllocatorAlignment, 256);
+  }
+  EXPECT_EQ(1, arena->num_arena_allocations());
+  EXPECT_NE(p0, p1);
+  arena->DeallocateRaw(p1);
+  // Allocations that are not attributed to a node use the base allocator.
+  void* p2 = arena->AllocateRaw(Allocator::kAllocatorAlignment, 256);
+  EXPECT_EQ(1, arena->num_arena_allocations());
+  arena->DeallocateRaw(p2);
+  planner.EndStep(arena, /*step_ok=*/true);
+  // `p0` outlives the step, and remains valid until it is deallocated.
+  static_cast<char*>(p0)[255] = 1;
+  arena->DeallocateRaw(p0);
+}
+
+TEST(StepArenaAllocatorTest, FailedStepDoesNotBuildPlan) {
+  StepArenaPlanner planner(cpu_allocator(), {true});
+  StepArenaAllocator* recording = planner.BeginStep();
+  ASSERT_NE(nullptr, recording);
+  {
+    StepArenaAllocator::ScopedNode scope(recording, 0);
+    void* p = recording->AllocateRaw(Allocator::kAllocatorAlignment, 16);
+    recording->DeallocateRaw(p);
+  }
+  planner.EndStep(recording, /*step_ok=*/false);
+  EXPECT_EQ(nullptr, planner.plan());
+  // The next step records again.
+  StepArenaAllocator* next = planner.BeginStep();
+  ASSERT_NE(nullptr, next);
+  EXPECT_TRUE(next->is_recording());
+  planner.EndStep(next, /*step_ok=*/false);
+}
+
+}  // namespace
+}  // namespace tensorflow
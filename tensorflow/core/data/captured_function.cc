@@ -310,10 +310,12 @@ class OwnedArgsCallFrame : public CallFrameBase {
  public:
   OwnedArgsCallFrame(std::vector<Tensor>&& args,
                      const std::vector<Tensor>* captured_inputs,
-                     DataTypeSlice ret_types)
+                     DataTypeSlice ret_types,
+                     std::shared_ptr<const std::vector<Tensor>> ret_buffers)
       : CallFrameBase(ret_types),
         args_(std::move(args)),
-        captured_inputs_(captured_inputs) {}
+        captured_inputs_(captured_inputs),
+        ret_buffers_(std::move(ret_buffers)) {}
 
   size_t num_args() const override {
     return args_.size() + captured_inputs_->size();
@@ -345,9 +347,20 @@ class OwnedArgsCallFrame : public CallFrameBase {
     return index >= 0 && index < static_cast<int>(args_.size());
   }
 
+  const Tensor* GetRetvalBuffer(int index, bool* on_host) const override {
+    if (ret_buffers_ == nullptr || index >= ret_buffers_->size() ||
+        !(*ret_buffers_)[index].IsInitialized()) {
+      return nullptr;
+    }
+    *on_host = true;
+    return &(*ret_buffers_)[index];
+  }
+
  private:
   std::vector<Tensor> args_;
   const std::vector<Tensor>* const captured_inputs_;  // Not owned.
+  // The buffers that the caller provided for the return values, if any.
+  const std::shared_ptr<const std::vector<Tensor>> ret_buffers_;
 };
 
 class BorrowedArgsCallFrame : public CallFrameBase {
@@ -820,7 +833,7 @@ Status InstantiatedCapturedFunction::Run(
   f_opts.stats_collector = stats_collector.get();
 
   OwnedArgsCallFrame frame(std::move(args), &captured_func_->captured_inputs(),
-                           ret_types_);
+                           ret_types_, /*ret_buffers=*/nullptr);
   tsl::profiler::TraceMe activity(
       [&] {
         return tsl::profiler::TraceMeEncode("InstantiatedCapturedFunction::Run",
@@ -946,6 +959,15 @@ void InstantiatedCapturedFunction::RunAsync(
     IteratorContext* ctx, std::vector<Tensor>&& args, std::vector<Tensor>* rets,
     FunctionLibraryRuntime::DoneCallback done,
     const std::shared_ptr<model::Node>& node) const {
+  RunAsync(ctx, std::move(args), rets, /*ret_buffers=*/nullptr,
+           std::move(done), node);
+}
+
+void InstantiatedCapturedFunction::RunAsync(
+    IteratorContext* ctx, std::vector<Tensor>&& args, std::vector<Tensor>* rets,
+    std::shared_ptr<const std::vector<Tensor>> ret_buffers,
+    FunctionLibraryRuntime::DoneCallback done,
+    const std::shared_ptr<model::Node>& node) const {
   auto& info = captured_func_->short_circuit_info();
   if (!info.indices.empty()) {
     // Run the `done` callback on a threadpool thread, because it will
@@ -961,8 +983,9 @@ void InstantiatedCapturedFunction::RunAsync(
   // NOTE(mrry): This method does not transfer ownership of `ctx`, and it may
   // be deleted before `done` is called. Take care not to capture `ctx` in any
   // code that may execute asynchronously in this function.
-  OwnedArgsCallFrame* frame = new OwnedArgsCallFrame(
-      std::move(args), &captured_func_->captured_inputs(), ret_types_);
+  OwnedArgsCallFrame* frame =
+      new OwnedArgsCallFrame(std::move(args), &captured_func_->captured_inputs(),
+                             ret_types_, std::move(ret_buffers));
 
   FunctionLibraryRuntime::Options f_opts;
   ResourceMgr* resource_mgr = lib_->device()->resource_manager();
@@ -290,6 +290,16 @@ class InstantiatedCapturedFunction {
                 FunctionLibraryRuntime::DoneCallback done,
                 const std::shared_ptr<model::Node>& node) const;
 
+  // Like `RunAsync()` above, but the kernels that produce the return values
+  // may write them into the initialized tensors of `*ret_buffers`, which must
+  // be in host memory. A return value is written into its buffer iff it
+  // shares the buffer's memory; otherwise it is returned in a new tensor.
+  void RunAsync(IteratorContext* ctx, std::vector<Tensor>&& args,
+                std::vector<Tensor>* rets,
+                std::shared_ptr<const std::vector<Tensor>> ret_buffers,
+                FunctionLibraryRuntime::DoneCallback done,
+                const std::shared_ptr<model::Node>& node) const;
+
   std::string func_name() const { return captured_func_->func().name(); }
 
  private:
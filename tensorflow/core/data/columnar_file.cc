@@ -0,0 +1,402 @@
+/* Copyright 2024 The TensorFlow Authors. All Rights Reserved.
+
+Licensed under the Apache License, Version 2.0 (the "License");
+you may not use this file except in compliance with the License.
+You may obtain a copy of the License at
+
+    http://www.apache.org/licenses/LICENSE-2.0
+
+Unless required by applicable law or agreed to in writing, software
+distributed under the License is distributed on an "AS IS" BASIS,
+WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+See the License for the specific language governing permissions and
+limitations under the License.
+==============================================================================*/
+#include "tensorflow/core/data/columnar_file.h"
+
+#include <cstring>
+#include <memory>
+#include <string>
+#include <utility>
+#include <vector>
+
+#include "absl/status/status.h"
+#include "absl/status/statusor.h"
+#include "absl/strings/str_cat.h"
+#include "tensorflow/core/data/mapped_tensor_buffer.h"
+#include "tensorflow/core/framework/allocator.h"
+#include "tensorflow/core/framework/tensor_shape.h"
+#include "tensorflow/core/framework/types.h"
+#include "tensorflow/core/platform/errors.h"
+#include "tensorflow/core/platform/logging.h"
+
+namespace tensorflow {
+namespace data {
+namespace {
+
+constexpr uint64_t kMagic = 0x524e4d554c4f4346;  // "FCOLUMNR"
+constexpr uint64_t kVersion = 1;
+constexpr uint64_t kAlignment = Allocator::kAllocatorAlignment;
+constexpr char kAllocatorName[] = "ColumnarFile";
+
+// The location of a column of a chunk, as `kLocationSize` words: the offsets
+// of its row splits and of its values, the number of values, and for
+// `DT_STRING` columns the offset of the offsets of the values in their bytes.
+constexpr int kRowSplitsOffset = 0;
+constexpr int kValuesOffset = 1;
+constexpr int kNumValues = 2;
+constexpr int kStringOffsetsOffset = 3;
+constexpr int kLocationSize = 4;
+
+struct FileHeader {
+  uint64_t magic;
+  uint64_t version;
+};
+
+struct SchemaEntry {
+  uint32_t dtype;
+  uint32_t name_size;
+};
+
+struct FileFooter {
+  uint64_t schema_offset;
+  uint64_t schema_size;
+  uint64_t index_offset;
+  uint64_t num_chunks;
+  uint64_t num_columns;
+  uint64_t magic;
+};
+
+uint64_t AlignUp(uint64_t offset) {
+  return (offset + kAlignment - 1) / kAlignment * kAlignment;
+}
+
+bool IsSupportedType(DataType dtype) {
+  return dtype == DT_STRING || DataTypeCanUseMemcpy(dtype);
+}
+
+}  // namespace
+
+absl::StatusOr<std::unique_ptr<ColumnarFileWriter>> ColumnarFileWriter::Create(
+    Env* env, const std::string& filename, std::vector<ColumnarColumn> schema) {
+  for (const ColumnarColumn& column : schema) {
+    if (!IsSupportedType(column.dtype)) {
+      return errors::InvalidArgument("Column ", column.name, " has type ",
+                                     DataTypeString(column.dtype),
+                                     ", which is not supported");
+    }
+  }
+  std::unique_ptr<WritableFile> file;
+  TF_RETURN_IF_ERROR(env->NewWritableFile(filename, &file));
+  std::unique_ptr<ColumnarFileWriter> writer(
+      new ColumnarFileWriter(filename, std::move(schema), std::move(file)));
+  FileHeader header = {kMagic, kVersion};
+  TF_RETURN_IF_ERROR(writer->Append(&header, sizeof(header)));
+  return writer;
+}
+
+ColumnarFileWriter::ColumnarFileWriter(std::string filename,
+                                       std::vector<ColumnarColumn> schema,
+                                       std::unique_ptr<WritableFile> file)
+    : filename_(std::move(filename)),
+      schema_(std::move(schema)),
+      file_(std::move(file)) {}
+
+absl::Status ColumnarFileWriter::Append(const void* data, size_t size) {
+  TF_RETURN_IF_ERROR(
+      file_->Append(StringPiece(static_cast<const char*>(data), size)));
+  offset_ += size;
+  return absl::OkStatus();
+}
+
+absl::Status ColumnarFileWriter::Pad() {
+  static const char kZeros[kAlignment] = {};
+  return Append(kZeros, AlignUp(offset_) - offset_);
+}
+
+absl::Status ColumnarFileWriter::ValidateChunk(
+    const std::vector<Tensor>& values, const std::vector<Tensor>& row_splits,
+    int64_t* num_rows) const {
+  if (values.size() != schema_.size() || row_splits.size() != schema_.size()) {
+    return errors::InvalidArgument("Expected ", schema_.size(),
+                                   " columns, got ", values.size(),
+                                   " values and ", row_splits.size(),
+                                   " row splits");
+  }
+  *num_rows = -1;
+  for (int i = 0; i < schema_.size(); ++i) {
+    const std::string& name = schema_[i].name;
+    if (values[i].dtype() != schema_[i].dtype || values[i].dims() != 1) {
+      return errors::InvalidArgument(
+          "The values of column ", name, " must be a vector of type ",
+          DataTypeString(schema_[i].dtype), ", got ",
+          DataTypeString(values[i].dtype()), " with shape ",
+          values[i].shape().DebugString());
+    }
+    if (row_splits[i].dtype() != DT_INT64 || row_splits[i].dims() != 1 ||
+        row_splits[i].NumElements() < 1) {
+      return errors::InvalidArgument("The row splits of column ", name,
+                                     " must be a non-empty int64 vector");
+    }
+    auto splits = row_splits[i].vec<int64_t>();
+    if (*num_rows >= 0 && splits.size() - 1 != *num_rows) {
+      return errors::InvalidArgument("Column ", name, " has ",
+                                     splits.size() - 1, " rows, expected ",
+                                     *num_rows);
+    }
+    *num_rows = splits.size() - 1;
+    if (splits(0) != 0 || splits(*num_rows) != values[i].NumElements()) {
+      return errors::InvalidArgument(
+          "The row splits of column ", name,
+          " must start at 0 and end at the number of values");
+    }
+    for (int64_t r = 0; r < *num_rows; ++r) {
+      if (splits(r) > splits(r + 1)) {
+        return errors::InvalidArgument("The row splits of column ", name,
+                                       " must not decrease");
+      }
+    }
+  }
+  return absl::OkStatus();
+}
+
+absl::Status ColumnarFileWriter::WriteChunk(
+    const std::vector<Tensor>& values, const std::vector<Tensor>& row_splits) {
+  int64_t num_rows;
+  TF_RETURN_IF_ERROR(ValidateChunk(values, row_splits, &num_rows));
+  for (int i = 0; i < schema_.size(); ++i) {
+    uint64_t location[kLocationSize] = {};
+    TF_RETURN_IF_ERROR(Pad());
+    location[kRowSplitsOffset] = offset_;
+    const StringPiece splits_data = row_splits[i].tensor_data();
+    TF_RETURN_IF_ERROR(Append(splits_data.data(), splits_data.size()));
+    const int64_t num_values = values[i].NumElements();
+    location[kNumValues] = num_values;
+    if (schema_[i].dtype == DT_STRING) {
+      auto strings = values[i].vec<tstring>();
+      std::vector<int64_t> offsets(num_values + 1);
+      for (int64_t j = 0; j < num_values; ++j) {
+        offsets[j + 1] = offsets[j] + strings(j).size();
+      }
+      TF_RETURN_IF_ERROR(Pad());
+      location[kStringOffsetsOffset] = offset_;
+      TF_RETURN_IF_ERROR(
+          Append(offsets.data(), offsets.size() * sizeof(int64_t)));
+      TF_RETURN_IF_ERROR(Pad());
+      location[kValuesOffset] = offset_;
+      for (int64_t j = 0; j < num_values; ++j) {
+        TF_RETURN_IF_ERROR(Append(strings(j).data(), strings(j).size()));
+      }
+    } else {
+      TF_RETURN_IF_ERROR(Pad());
+      location[kValuesOffset] = offset_;
+      const StringPiece data = values[i].tensor_data();
+      TF_RETURN_IF_ERROR(Append(data.data(), data.size()));
+    }
+    locations_.insert(locations_.end(), location, location + kLocationSize);
+  }
+  chunk_rows_.push_back(num_rows);
+  return absl::OkStatus();
+}
+
+absl::Status ColumnarFileWriter::Finalize() {
+  FileFooter footer;
+  footer.schema_offset = offset_;
+  for (const ColumnarColumn& column : schema_) {
+    SchemaEntry entry = {static_cast<uint32_t>(column.dtype),
+                         static_cast<uint32_t>(column.name.size())};
+    TF_RETURN_IF_ERROR(Append(&entry, sizeof(entry)));
+    TF_RETURN_IF_ERROR(Append(column.name.data(), column.name.size()));
+  }
+  footer.schema_size = offset_ - footer.schema_offset;
+  TF_RETURN_IF_ERROR(Pad());
+  footer.index_offset = offset_;
+  footer.num_chunks = chunk_rows_.size();
+  footer.num_columns = schema_.size();
+  footer.magic = kMagic;
+  TF_RETURN_IF_ERROR(
+      Append(chunk_rows_.data(), chunk_rows_.size() * sizeof(uint64_t)));
+  TF_RETURN_IF_ERROR(
+      Append(locations_.data(), locations_.size() * sizeof(uint64_t)));
+  TF_RETURN_IF_ERROR(Append(&footer, sizeof(footer)));
+  TF_RETURN_IF_ERROR(file_->Close());
+  file_.reset();
+  VLOG(2) << "Wrote columnar file " << filename_ << " with "
+          << footer.num_chunks << " chunks and " << offset_ << " bytes.";
+  return absl::OkStatus();
+}
+
+absl::StatusOr<std::shared_ptr<const ColumnarFile>> ColumnarFile::Open(
+    Env* env, const std::string& filename) {
+  std::unique_ptr<ReadOnlyMemoryRegion> region;
+  TF_RETURN_IF_ERROR(env->NewReadOnlyMemoryRegionFromFile(filename, &region));
+  std::shared_ptr<ColumnarFile> file(
+      new ColumnarFile(filename, std::move(region)));
+  TF_RETURN_IF_ERROR(file->ReadFooter());
+  return file;
+}
+
+ColumnarFile::ColumnarFile(std::string filename,
+                           std::shared_ptr<ReadOnlyMemoryRegion> region)
+    : filename_(std::move(filename)),
+      region_(std::move(region)),
+      data_(static_cast<const char*>(region_->data())),
+      length_(region_->length()) {}
+
+absl::Status ColumnarFile::Corrupted(absl::string_view reason) const {
+  return errors::DataLoss("Corrupted columnar file ", filename_, ": ", reason);
+}
+
+absl::Status ColumnarFile::ReadFooter() {
+  FileHeader header;
+  FileFooter footer;
+  if (length_ < sizeof(header) + sizeof(footer)) {
+    return Corrupted("the file is too short");
+  }
+  std::memcpy(&header, data_, sizeof(header));
+  std::memcpy(&footer, data_ + length_ - sizeof(footer), sizeof(footer));
+  if (header.magic != kMagic || footer.magic != kMagic) {
+    return Corrupted("bad magic number");
+  }
+  if (header.version != kVersion) {
+    return Corrupted(absl::StrCat("unsupported version ", header.version));
+  }
+  const uint64_t end = length_ - sizeof(footer);
+  if (footer.schema_offset > end ||
+      footer.schema_size > end - footer.schema_offset) {
+    return Corrupted("bad schema");
+  }
+  const char* schema = data_ + footer.schema_offset;
+  const char* const schema_end = schema + footer.schema_size;
+  for (uint64_t i = 0; i < footer.num_columns; ++i) {
+    SchemaEntry entry;
+    if (schema_end - schema < sizeof(entry)) return Corrupted("bad schema");
+    std::memcpy(&entry, schema, sizeof(entry));
+    schema += sizeof(entry);
+    const DataType dtype = static_cast<DataType>(entry.dtype);
+    if (schema_end - schema < entry.name_size || !DataType_IsValid(dtype) ||
+        !IsSupportedType(dtype)) {
+      return Corrupted("bad schema");
+    }
+    schema_.push_back({std::string(schema, entry.name_size), dtype});
+    schema += entry.name_size;
+  }
+  // Each chunk has one word for its number of rows and `kLocationSize` words
+  // for each column.
+  const uint64_t chunk_words = 1 + footer.num_columns * kLocationSize;
+  if (footer.index_offset % sizeof(uint64_t) != 0 ||
+      footer.index_offset > end ||
+      footer.num_chunks >
+          (end - footer.index_offset) / sizeof(uint64_t) / chunk_words) {
+    return Corrupted("bad index");
+  }
+  num_chunks_ = footer.num_chunks;
+  chunk_rows_ = reinterpret_cast<const uint64_t*>(data_ + footer.index_offset);
+  locations_ = chunk_rows_ + num_chunks_;
+  return absl::OkStatus();
+}
+
+int ColumnarFile::FindColumn(absl::string_view name) const {
+  for (int i = 0; i < schema_.size(); ++i) {
+    if (schema_[i].name == name) return i;
+  }
+  return -1;
+}
+
+absl::StatusOr<int64_t> ColumnarFile::NumRows(int64_t chunk) const {
+  if (chunk < 0 || chunk >= num_chunks_) {
+    return errors::OutOfRange("Chunk index out of range [0, ", num_chunks_,
+                              "): ", chunk);
+  }
+  uint64_t num_rows;
+  std::memcpy(&num_rows, &chunk_rows_[chunk], sizeof(num_rows));
+  if (num_rows >= length_) return Corrupted("bad number of rows");
+  return static_cast<int64_t>(num_rows);
+}
+
+absl::Status ColumnarFile::ReadBuffer(uint64_t offset, DataType dtype,
+                                      int64_t num_elements,
+                                      Tensor* tensor) const {
+  const uint64_t element_size = DataTypeSize(dtype);
+  if (offset > length_ ||
+      static_cast<uint64_t>(num_elements) > (length_ - offset) / element_size) {
+    return Corrupted("bad buffer location");
+  }
+  const uint64_t num_bytes = num_elements * element_size;
+  const char* data = data_ + offset;
+  if (num_elements == 0) {
+    *tensor = Tensor(dtype, TensorShape({0}));
+    return absl::OkStatus();
+  }
+  if (reinterpret_cast<uintptr_t>(data) % kAlignment != 0) {
+    // The file system did not map the file at an aligned address, so the data
+    // must be copied to be usable by Eigen.
+    *tensor = Tensor(dtype, TensorShape({num_elements}));
+    std::memcpy(const_cast<char*>(tensor->tensor_data().data()), data,
+                num_bytes);
+    return absl::OkStatus();
+  }
+  auto* buffer =
+      new MappedTensorBuffer(data, num_bytes, region_, kAllocatorName);
+  *tensor = Tensor(dtype, TensorShape({num_elements}), buffer);
+  buffer->Unref();
+  return absl::OkStatus();
+}
+
+absl::Status ColumnarFile::ReadStrings(uint64_t offsets_offset,
+                                       uint64_t data_offset,
+                                       int64_t num_values,
+                                       Tensor* tensor) const {
+  Tensor offsets;
+  TF_RETURN_IF_ERROR(
+      ReadBuffer(offsets_offset, DT_INT64, num_values + 1, &offsets));
+  auto offsets_vec = offsets.vec<int64_t>();
+  if (data_offset > length_ || offsets_vec(0) != 0 ||
+      offsets_vec(num_values) > length_ - data_offset) {
+    return Corrupted("bad string offsets");
+  }
+  const char* data = data_ + data_offset;
+  *tensor = Tensor(DT_STRING, TensorShape({num_values}));
+  auto strings = tensor->vec<tstring>();
+  for (int64_t i = 0; i < num_values; ++i) {
+    if (offsets_vec(i) > offsets_vec(i + 1)) {
+      return Corrupted("bad string offsets");
+    }
+    strings(i).assign(data + offsets_vec(i),
+                      offsets_vec(i + 1) - offsets_vec(i));
+  }
+  return absl::OkStatus();
+}
+
+absl::Status ColumnarFile::ReadColumn(int64_t chunk, int column,
+                                      Tensor* values,
+                                      Tensor* row_splits) const {
+  TF_ASSIGN_OR_RETURN(const int64_t num_rows, NumRows(chunk));
+  if (column < 0 || column >= schema_.size()) {
+    return errors::OutOfRange("Column index out of range [0, ",
+                              schema_.size(), "): ", column);
+  }
+  uint64_t location[kLocationSize];
+  std::memcpy(location,
+              &locations_[(chunk * schema_.size() + column) * kLocationSize],
+              sizeof(location));
+  if (location[kNumValues] >= length_) {
+    return Corrupted("bad number of values");
+  }
+  const int64_t num_values = location[kNumValues];
+  TF_RETURN_IF_ERROR(ReadBuffer(location[kRowSplitsOffset], DT_INT64,
+                                num_rows + 1, row_splits));
+  auto splits = row_splits->vec<int64_t>();
+  if (splits(0) != 0 || splits(num_rows) != num_values) {
+    return Corrupted("bad row splits");
+  }
+  const DataType dtype = schema_[column].dtype;
+  if (dtype == DT_STRING) {
+    return ReadStrings(location[kStringOffsetsOffset], location[kValuesOffset],
+                       num_values, values);
+  }
+  return ReadBuffer(location[kValuesOffset], dtype, num_values, values);
+}
+
+}  // namespace data
+}  // namespace tensorflow
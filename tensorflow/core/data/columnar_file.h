@@ -0,0 +1,142 @@
+/* Copyright 2024 The TensorFlow Authors. All Rights Reserved.
+
+Licensed under the Apache License, Version 2.0 (the "License");
+you may not use this file except in compliance with the License.
+You may obtain a copy of the License at
+
+    http://www.apache.org/licenses/LICENSE-2.0
+
+Unless required by applicable law or agreed to in writing, software
+distributed under the License is distributed on an "AS IS" BASIS,
+WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+See the License for the specific language governing permissions and
+limitations under the License.
+==============================================================================*/
+#ifndef TENSORFLOW_CORE_DATA_COLUMNAR_FILE_H_
+#define TENSORFLOW_CORE_DATA_COLUMNAR_FILE_H_
+
+#include <cstdint>
+#include <memory>
+#include <string>
+#include <vector>
+
+#include "absl/status/status.h"
+#include "absl/status/statusor.h"
+#include "absl/strings/string_view.h"
+#include "tensorflow/core/framework/tensor.h"
+#include "tensorflow/core/framework/types.pb.h"
+#include "tensorflow/core/platform/env.h"
+#include "tensorflow/core/platform/file_system.h"
+
+namespace tensorflow {
+namespace data {
+
+// A file of feature columns, which is read through a memory mapping so that
+// a reader only touches the columns it projects, and gets them without
+// parsing or copying.
+//
+// The rows of the file are stored in chunks. Within a chunk, the values of
+// each column are stored contiguously, with int64 row splits that delimit the
+// values of each row, as in a `RaggedTensor`: the values of row `r` are
+// `values[row_splits[r]:row_splits[r + 1]]`. The file ends with its schema, an
+// index of the columns of every chunk, and a footer that locates them. Buffers
+// are aligned to `Allocator::kAllocatorAlignment`, and files use the byte
+// order of the host that wrote them.
+//
+// Columns of types that can be copied with `memcpy` are returned in place.
+// `DT_STRING` columns are stored as their concatenated bytes and the offsets
+// of each value, and are copied into `tstring`s when read.
+
+// A column of a columnar file.
+struct ColumnarColumn {
+  std::string name;
+  DataType dtype;
+};
+
+// Writes a columnar file. The file is only readable once `Finalize()` has
+// returned.
+class ColumnarFileWriter {
+ public:
+  static absl::StatusOr<std::unique_ptr<ColumnarFileWriter>> Create(
+      Env* env, const std::string& filename,
+      std::vector<ColumnarColumn> schema);
+
+  // Appends a chunk of rows. For every column `i` of the schema, `values[i]`
+  // is a vector of the values of the column in all the rows of the chunk, and
+  // `row_splits[i]` is an int64 vector of the number of rows plus one, which
+  // starts at 0, does not decrease, and ends at the number of values. All the
+  // columns of a chunk must have the same number of rows.
+  absl::Status WriteChunk(const std::vector<Tensor>& values,
+                          const std::vector<Tensor>& row_splits);
+
+  // Writes the schema and the index, and closes the file.
+  absl::Status Finalize();
+
+ private:
+  ColumnarFileWriter(std::string filename, std::vector<ColumnarColumn> schema,
+                     std::unique_ptr<WritableFile> file);
+
+  absl::Status Append(const void* data, size_t size);
+  absl::Status Pad();
+  absl::Status ValidateChunk(const std::vector<Tensor>& values,
+                             const std::vector<Tensor>& row_splits,
+                             int64_t* num_rows) const;
+
+  const std::string filename_;
+  const std::vector<ColumnarColumn> schema_;
+  std::unique_ptr<WritableFile> file_;
+  uint64_t offset_ = 0;
+  std::vector<uint64_t> chunk_rows_;
+  // The locations of the columns of every chunk, `kLocationSize` words per
+  // column.
+  std::vector<uint64_t> locations_;
+};
+
+// A read-only memory mapping of a file written by `ColumnarFileWriter`.
+// Tensors returned by `ReadColumn()` may refer to the mapping and keep it
+// alive.
+class ColumnarFile {
+ public:
+  static absl::StatusOr<std::shared_ptr<const ColumnarFile>> Open(
+      Env* env, const std::string& filename);
+
+  const std::vector<ColumnarColumn>& schema() const { return schema_; }
+  int64_t num_chunks() const { return num_chunks_; }
+
+  // Returns the index of the column named `name` in the schema, or -1.
+  int FindColumn(absl::string_view name) const;
+
+  // Returns the number of rows of chunk `chunk`.
+  absl::StatusOr<int64_t> NumRows(int64_t chunk) const;
+
+  // Reads column `column` of chunk `chunk` into `*values` and `*row_splits`.
+  // Only the first and last row splits are checked, so that reading a column
+  // does not touch its pages.
+  absl::Status ReadColumn(int64_t chunk, int column, Tensor* values,
+                          Tensor* row_splits) const;
+
+ private:
+  ColumnarFile(std::string filename,
+               std::shared_ptr<ReadOnlyMemoryRegion> region);
+
+  absl::Status ReadFooter();
+  absl::Status ReadBuffer(uint64_t offset, DataType dtype, int64_t num_elements,
+                          Tensor* tensor) const;
+  absl::Status ReadStrings(uint64_t offsets_offset, uint64_t data_offset,
+                           int64_t num_values, Tensor* tensor) const;
+  absl::Status Corrupted(absl::string_view reason) const;
+
+  const std::string filename_;
+  const std::shared_ptr<ReadOnlyMemoryRegion> region_;
+  const char* const data_;
+  const uint64_t length_;
+  std::vector<ColumnarColumn> schema_;
+  int64_t num_chunks_ = 0;
+  const uint64_t* chunk_rows_ = nullptr;
+  const uint64_t* locations_ = nullptr;
+};
+
+}  // namespace data
+}  // namespace tensorflow
+
+#endif  // TENSORFLOW_CORE_DATA_COLUMNAR_FILE_H_
@@ -0,0 +1,136 @@
+/* Copyright 2024 The TensorFlow Authors. All Rights Reserved.
+
+Licensed under the Apache License, Version 2.0 (the "License");
+you may not use this file except in compliance with the License.
+You may obtain a copy of the License at
+
+    http://www.apache.org/licenses/LICENSE-2.0
+
+Unless required by applicable law or agreed to in writing, software
+distributed under the License is distributed on an "AS IS" BASIS,
+WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+See the License for the specific language governing permissions and
+limitations under the License.
+==============================================================================*/
+#include "tensorflow/core/data/columnar_file.h"
+
+#include <memory>
+#include <string>
+#include <vector>
+
+#include "tensorflow/core/framework/tensor.h"
+#include "tensorflow/core/framework/tensor_testutil.h"
+#include "tensorflow/core/lib/core/status_test_util.h"
+#include "tensorflow/core/platform/env.h"
+#include "tensorflow/core/platform/path.h"
+#include "tensorflow/core/platform/test.h"
+#include "tsl/platform/status_matchers.h"
+
+namespace tensorflow {
+namespace data {
+namespace {
+
+std::string TestFilename(const std::string& name) {
+  return io::JoinPath(testing::TmpDir(), name);
+}
+
+Tensor Splits(const std::vector<int64_t>& splits) {
+  return test::AsTensor<int64_t>(splits);
+}
+
+TEST(ColumnarFileTest, RoundTrip) {
+  const std::string filename = TestFilename("round_trip");
+  {
+    TF_ASSERT_OK_AND_ASSIGN(
+        auto writer,
+        ColumnarFileWriter::Create(
+            Env::Default(), filename,
+            {{"ids", DT_INT64}, {"weights", DT_FLOAT}, {"query", DT_STRING}}));
+    TF_ASSERT_OK(writer->WriteChunk(
+        {test::AsTensor<int64_t>({1, 2, 3}),
+         test::AsTensor<float>({0.5, 1.5}),
+         test::AsTensor<tstring>({"a", "", "bc"})},
+        {Splits({0, 2, 3}), Splits({0, 0, 2}), Splits({0, 1, 3})}));
+    TF_ASSERT_OK(writer->WriteChunk(
+        {test::AsTensor<int64_t>({4}), test::AsTensor<float>({}),
+         test::AsTensor<tstring>({"d"})},
+        {Splits({0, 1}), Splits({0, 0}), Splits({0, 1})}));
+    TF_ASSERT_OK(writer->Finalize());
+  }
+
+  TF_ASSERT_OK_AND_ASSIGN(auto file,
+                          ColumnarFile::Open(Env::Default(), filename));
+  ASSERT_EQ(3, file->schema().size());
+  EXPECT_EQ("weights", file->schema()[1].name);
+  EXPECT_EQ(DT_FLOAT, file->schema()[1].dtype);
+  EXPECT_EQ(2, file->num_chunks());
+  EXPECT_EQ(2, file->FindColumn("query"));
+  EXPECT_EQ(-1, file->FindColumn("missing"));
+  TF_ASSERT_OK_AND_ASSIGN(int64_t num_rows, file->NumRows(0));
+  EXPECT_EQ(2, num_rows);
+
+  Tensor values, row_splits;
+  TF_ASSERT_OK(file->ReadColumn(0, 0, &values, &row_splits));
+  test::ExpectEqual(values, test::AsTensor<int64_t>({1, 2, 3}));
+  test::ExpectEqual(row_splits, Splits({0, 2, 3}));
+  TF_ASSERT_OK(file->ReadColumn(0, 2, &values, &row_splits));
+  test::ExpectEqual(values, test::AsTensor<tstring>({"a", "", "bc"}));
+  test::ExpectEqual(row_splits, Splits({0, 1, 3}));
+  TF_ASSERT_OK(file->ReadColumn(1, 1, &values, &row_splits));
+  test::ExpectEqual(values, test::AsTensor<float>({}));
+  test::ExpectEqual(row_splits, Splits({0, 0}));
+  TF_ASSERT_OK(file->ReadColumn(1, 0, &values, &row_splits));
+  EXPECT_TRUE(errors::IsOutOfRange(file->ReadColumn(2, 0, &values,
+                                                    &row_splits)));
+
+  // Tensors keep the mapping alive.
+  file.reset();
+  test::ExpectEqual(values, test::AsTensor<int64_t>({4}));
+  test::ExpectEqual(row_splits, Splits({0, 1}));
+}
+
+TEST(ColumnarFileTest, InvalidChunk) {
+  TF_ASSERT_OK_AND_ASSIGN(
+      auto writer,
+      ColumnarFileWriter::Create(Env::Default(), TestFilename("invalid"),
+                                 {{"a", DT_INT64}, {"b", DT_INT64}}));
+  // Wrong number of columns.
+  EXPECT_TRUE(errors::IsInvalidArgument(writer->WriteChunk(
+      {test::AsTensor<int64_t>({1})}, {Splits({0, 1})})));
+  // Wrong type.
+  EXPECT_TRUE(errors::IsInvalidArgument(writer->WriteChunk(
+      {test::AsTensor<float>({1}), test::AsTensor<int64_t>({1})},
+      {Splits({0, 1}), Splits({0, 1})})));
+  // Different numbers of rows.
+  EXPECT_TRUE(errors::IsInvalidArgument(writer->WriteChunk(
+      {test::AsTensor<int64_t>({1}), test::AsTensor<int64_t>({1})},
+      {Splits({0, 1}), Splits({0, 0, 1})})));
+  // Row splits that do not cover the values.
+  EXPECT_TRUE(errors::IsInvalidArgument(writer->WriteChunk(
+      {test::AsTensor<int64_t>({1, 2}), test::AsTensor<int64_t>({1})},
+      {Splits({0, 1}), Splits({0, 1})})));
+  // Decreasing row splits.
+  EXPECT_TRUE(errors::IsInvalidArgument(writer->WriteChunk(
+      {test::AsTensor<int64_t>({1, 2}), test::AsTensor<int64_t>({1})},
+      {Splits({0, 2, 1, 2}), Splits({0, 0, 0, 1})})));
+}
+
+TEST(ColumnarFileTest, UnsupportedType) {
+  EXPECT_TRUE(errors::IsInvalidArgument(
+      ColumnarFileWriter::Create(Env::Default(), TestFilename("unsupported"),
+                                 {{"a", DT_VARIANT}})
+          .status()));
+}
+
+TEST(ColumnarFileTest, CorruptedFile) {
+  const std::string filename = TestFilename("corrupted");
+  TF_ASSERT_OK(WriteStringToFile(Env::Default(), filename,
+                                 std::string(128, 'x')));
+  EXPECT_TRUE(
+      errors::IsDataLoss(ColumnarFile::Open(Env::Default(), filename)
+                             .status()));
+}
+
+}  // namespace
+}  // namespace data
+}  // namespace tensorflow
@@ -0,0 +1,225 @@
+/* Copyright 2024 The TensorFlow Authors. All Rights Reserved.
+
+Licensed under the Apache License, Version 2.0 (the "License");
+you may not use this file except in compliance with the License.
+You may obtain a copy of the License at
+
+    http://www.apache.org/licenses/LICENSE-2.0
+
+Unless required by applicable law or agreed to in writing, software
+distributed under the License is distributed on an "AS IS" BASIS,
+WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+See the License for the specific language governing permissions and
+limitations under the License.
+==============================================================================*/
+#include "tensorflow/core/data/incremental_buffer_checkpoint.h"
+
+#include <algorithm>
+#include <cstdint>
+#include <memory>
+#include <string>
+#include <utility>
+#include <vector>
+
+#include "absl/container/flat_hash_set.h"
+#include "absl/status/status.h"
+#include "absl/strings/str_cat.h"
+#include "tensorflow/core/data/snapshot_utils.h"
+#include "tensorflow/core/framework/dataset.h"
+#include "tensorflow/core/framework/tensor.h"
+#include "tensorflow/core/framework/types.h"
+#include "tensorflow/core/lib/io/compression.h"
+#include "tensorflow/core/lib/random/random.h"
+#include "tensorflow/core/platform/env.h"
+#include "tensorflow/core/platform/errors.h"
+#include "tensorflow/core/platform/logging.h"
+#include "tensorflow/core/platform/path.h"
+
+namespace tensorflow {
+namespace data {
+namespace {
+
+constexpr char kNumSlots[] = "incremental_num_slots";
+constexpr char kNumFiles[] = "incremental_num_files";
+constexpr char kFile[] = "incremental_file";
+constexpr char kClearedIndices[] = "incremental_cleared_indices";
+constexpr int kFileVersion = 2;
+
+// Each record holds the slot index followed by the components of the element.
+DataTypeVector RecordDtypes(const DataTypeVector& dtypes) {
+  DataTypeVector record_dtypes = {DT_INT64};
+  record_dtypes.insert(record_dtypes.end(), dtypes.begin(), dtypes.end());
+  return record_dtypes;
+}
+
+}  // namespace
+
+IncrementalBufferCheckpoint::IncrementalBufferCheckpoint(
+    Env* env, std::string directory, int64_t compaction_interval)
+    : env_(env),
+      directory_(std::move(directory)),
+      compaction_interval_(std::max<int64_t>(compaction_interval, 1)),
+      file_prefix_(absl::StrCat("buffer_", random::New64())) {}
+
+bool IncrementalBufferCheckpoint::Contains(IteratorStateReader* reader,
+                                           StringPiece name) {
+  return reader->Contains(name, kNumFiles);
+}
+
+std::vector<std::string> IncrementalBufferCheckpoint::filenames() const {
+  std::vector<std::string> filenames;
+  for (const File& file : files_) {
+    filenames.push_back(file.filename);
+  }
+  return filenames;
+}
+
+absl::Status IncrementalBufferCheckpoint::Save(
+    IteratorStateWriter* writer, StringPiece name,
+    const DataTypeVector& dtypes,
+    const std::vector<std::vector<Tensor>>& buffer,
+    absl::flat_hash_set<int64_t>& dirty_indices) {
+  const bool compact = files_.empty() || files_.size() >= compaction_interval_;
+  File file;
+  file.filename = io::JoinPath(
+      directory_, absl::StrCat(file_prefix_, "_", next_file_id_++));
+  std::vector<int64_t> indices;
+  if (compact) {
+    for (int64_t i = 0; i < buffer.size(); ++i) {
+      if (!buffer[i].empty()) {
+        indices.push_back(i);
+      }
+    }
+  } else {
+    std::vector<int64_t> sorted_indices(dirty_indices.begin(),
+                                        dirty_indices.end());
+    std::sort(sorted_indices.begin(), sorted_indices.end());
+    for (int64_t i : sorted_indices) {
+      if (i < buffer.size() && !buffer[i].empty()) {
+        indices.push_back(i);
+      } else {
+        file.cleared_indices.push_back(i);
+      }
+    }
+  }
+  TF_RETURN_IF_ERROR(env_->RecursivelyCreateDir(directory_));
+  TF_RETURN_IF_ERROR(WriteFile(file.filename, dtypes, buffer, indices));
+  VLOG(2) << "Wrote " << (compact ? "base" : "delta") << " buffer checkpoint "
+          << file.filename << " with " << indices.size() << " of "
+          << buffer.size() << " slots.";
+
+  if (compact) {
+    for (const std::string& filename : previous_generation_) {
+      env_->DeleteFile(filename).IgnoreError();
+    }
+    previous_generation_ = filenames();
+    files_.clear();
+  }
+  files_.push_back(std::move(file));
+  dirty_indices.clear();
+
+  TF_RETURN_IF_ERROR(writer->WriteScalar(
+      name, kNumSlots, static_cast<int64_t>(buffer.size())));
+  TF_RETURN_IF_ERROR(writer->WriteScalar(
+      name, kNumFiles, static_cast<int64_t>(files_.size())));
+  for (int64_t i = 0; i < files_.size(); ++i) {
+    TF_RETURN_IF_ERROR(writer->WriteScalar(name, absl::StrCat(kFile, "_", i),
+                                           files_[i].filename));
+    const std::vector<int64_t>& cleared = files_[i].cleared_indices;
+    Tensor cleared_tensor(DT_INT64,
+                          TensorShape({static_cast<int64_t>(cleared.size())}));
+    std::copy(cleared.begin(), cleared.end(),
+              cleared_tensor.flat<int64_t>().data());
+    TF_RETURN_IF_ERROR(writer->WriteTensor(
+        name, absl::StrCat(kClearedIndices, "_", i), cleared_tensor));
+  }
+  return absl::OkStatus();
+}
+
+absl::Status IncrementalBufferCheckpoint::Restore(
+    IteratorStateReader* reader, StringPiece name,
+    const DataTypeVector& dtypes, std::vector<std::vector<Tensor>>* buffer) {
+  int64_t num_slots;
+  TF_RETURN_IF_ERROR(reader->ReadScalar(name, kNumSlots, &num_slots));
+  int64_t num_files;
+  TF_RETURN_IF_ERROR(reader->ReadScalar(name, kNumFiles, &num_files));
+  buffer->clear();
+  buffer->resize(num_slots);
+  std::vector<File> files(num_files);
+  for (int64_t i = 0; i < num_files; ++i) {
+    tstring filename;
+    TF_RETURN_IF_ERROR(
+        reader->ReadScalar(name, absl::StrCat(kFile, "_", i), &filename));
+    files[i].filename = filename;
+    Tensor cleared_tensor;
+    TF_RETURN_IF_ERROR(reader->ReadTensor(
+        name, absl::StrCat(kClearedIndices, "_", i), &cleared_tensor));
+    auto cleared = cleared_tensor.flat<int64_t>();
+    files[i].cleared_indices.assign(cleared.data(),
+                                    cleared.data() + cleared.size());
+
+    TF_RETURN_IF_ERROR(ReadFile(files[i].filename, dtypes, buffer));
+    for (int64_t index : files[i].cleared_indices) {
+      if (index >= 0 && index < buffer->size()) {
+        (*buffer)[index].clear();
+      }
+    }
+  }
+  if (buffer->size() != num_slots) {
+    return errors::DataLoss("Buffer checkpoint files under ", name, " hold ",
+                            buffer->size(), " slots, expected ", num_slots);
+  }
+  files_ = std::move(files);
+  previous_generation_.clear();
+  return absl::OkStatus();
+}
+
+absl::Status IncrementalBufferCheckpoint::WriteFile(
+    const std::string& filename, const DataTypeVector& dtypes,
+    const std::vector<std::vector<Tensor>>& buffer,
+    const std::vector<int64_t>& indices) const {
+  std::unique_ptr<snapshot_util::Writer> file_writer;
+  TF_RETURN_IF_ERROR(snapshot_util::Writer::Create(
+      env_, filename, io::compression::kNone, kFileVersion,
+      RecordDtypes(dtypes), &file_writer));
+  std::vector<Tensor> record;
+  for (int64_t index : indices) {
+    record.clear();
+    record.reserve(buffer[index].size() + 1);
+    record.emplace_back(index);
+    record.insert(record.end(), buffer[index].begin(), buffer[index].end());
+    TF_RETURN_IF_ERROR(file_writer->WriteTensors(record));
+  }
+  return file_writer->Close();
+}
+
+absl::Status IncrementalBufferCheckpoint::ReadFile(
+    const std::string& filename, const DataTypeVector& dtypes,
+    std::vector<std::vector<Tensor>>* buffer) const {
+  std::unique_ptr<snapshot_util::Reader> file_reader;
+  TF_RETURN_IF_ERROR(snapshot_util::Reader::Create(
+      env_, filename, io::compression::kNone, kFileVersion,
+      RecordDtypes(dtypes), &file_reader));
+  while (true) {
+    std::vector<Tensor> record;
+    absl::Status s = file_reader->ReadTensors(&record);
+    if (errors::IsOutOfRange(s)) {
+      return absl::OkStatus();
+    }
+    TF_RETURN_IF_ERROR(s);
+    if (record.size() != dtypes.size() + 1 || record[0].dtype() != DT_INT64 ||
+        record[0].NumElements() != 1 || record[0].scalar<int64_t>()() < 0) {
+      return errors::DataLoss("Malformed record in buffer checkpoint file ",
+                              filename);
+    }
+    const int64_t index = record[0].scalar<int64_t>()();
+    if (index >= buffer->size()) {
+      buffer->resize(index + 1);
+    }
+    (*buffer)[index].assign(std::make_move_iterator(record.begin() + 1),
+                            std::make_move_iterator(record.end()));
+  }
+}
+
+}  // namespace data
+}  // namespace tensorflow
@@ -0,0 +1,101 @@
+/* Copyright 2024 The TensorFlow Authors. All Rights Reserved.
+
+Licensed under the Apache License, Version 2.0 (the "License");
+you may not use this file except in compliance with the License.
+You may obtain a copy of the License at
+
+    http://www.apache.org/licenses/LICENSE-2.0
+
+Unless required by applicable law or agreed to in writing, software
+distributed under the License is distributed on an "AS IS" BASIS,
+WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+See the License for the specific language governing permissions and
+limitations under the License.
+==============================================================================*/
+#ifndef TENSORFLOW_CORE_DATA_INCREMENTAL_BUFFER_CHECKPOINT_H_
+#define TENSORFLOW_CORE_DATA_INCREMENTAL_BUFFER_CHECKPOINT_H_
+
+#include <cstdint>
+#include <string>
+#include <vector>
+
+#include "absl/container/flat_hash_set.h"
+#include "absl/status/status.h"
+#include "tensorflow/core/framework/dataset.h"
+#include "tensorflow/core/framework/tensor.h"
+#include "tensorflow/core/framework/types.h"
+#include "tensorflow/core/platform/env.h"
+
+namespace tensorflow {
+namespace data {
+
+// Checkpoints a large buffer of elements, e.g. a shuffle buffer, by writing
+// only the slots that changed since the previous checkpoint.
+//
+// The elements are stored in files under `directory` rather than in the
+// iterator checkpoint itself, because each checkpoint must be restorable on
+// its own and can therefore only refer to earlier deltas that outlive it. The
+// first save writes a base file with the whole buffer. Each subsequent save
+// writes a delta file with the slots in `dirty_indices`, and records the chain
+// of files in the checkpoint. Every `compaction_interval` saves, a new base is
+// written and the files of the generation before the previous one are deleted,
+// so a checkpoint stays restorable until two compactions after it was taken.
+//
+// This class is not thread-safe.
+class IncrementalBufferCheckpoint {
+ public:
+  IncrementalBufferCheckpoint(Env* env, std::string directory,
+                              int64_t compaction_interval);
+
+  // Returns whether `reader` holds a buffer saved by this class under `name`.
+  static bool Contains(IteratorStateReader* reader, StringPiece name);
+
+  // Writes the slots of `buffer` in `dirty_indices` to a new file, or all of
+  // `buffer` when compacting, and records the file chain under `name`. Empty
+  // slots are recorded as cleared. Clears `dirty_indices` on success.
+  absl::Status Save(IteratorStateWriter* writer, StringPiece name,
+                    const DataTypeVector& dtypes,
+                    const std::vector<std::vector<Tensor>>& buffer,
+                    absl::flat_hash_set<int64_t>& dirty_indices);
+
+  // Rebuilds `buffer` by replaying the file chain recorded under `name`. Later
+  // saves add deltas to the restored chain.
+  absl::Status Restore(IteratorStateReader* reader, StringPiece name,
+                       const DataTypeVector& dtypes,
+                       std::vector<std::vector<Tensor>>* buffer);
+
+  // Returns the files of the current chain, oldest first.
+  std::vector<std::string> filenames() const;
+
+ private:
+  struct File {
+    std::string filename;
+    // Slots that became empty since the previous file of the chain.
+    std::vector<int64_t> cleared_indices;
+  };
+
+  absl::Status WriteFile(const std::string& filename,
+                         const DataTypeVector& dtypes,
+                         const std::vector<std::vector<Tensor>>& buffer,
+                         const std::vector<int64_t>& indices) const;
+  absl::Status ReadFile(const std::string& filename,
+                        const DataTypeVector& dtypes,
+                        std::vector<std::vector<Tensor>>* buffer) const;
+
+  Env* const env_;
+  const std::string directory_;
+  const int64_t compaction_interval_;
+  // A random prefix that keeps the files of different iterators that share
+  // `directory_` apart.
+  const std::string file_prefix_;
+  int64_t next_file_id_ = 0;
+  std::vector<File> files_;
+  // The files of the chain that the last compaction replaced. They are kept
+  // until the next compaction for checkpoints that still refer to them.
+  std::vector<std::string> previous_generation_;
+};
+
+}  // namespace data
+}  // namespace tensorflow
+
+#endif  // TENSORFLOW_CORE_DATA_INCREMENTAL_BUFFER_CHECKPOINT_H_
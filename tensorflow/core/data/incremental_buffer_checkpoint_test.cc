@@ -0,0 +1,146 @@
+/* Copyright 2024 The TensorFlow Authors. All Rights Reserved.
+
+Licensed under the Apache License, Version 2.0 (the "License");
+you may not use this file except in compliance with the License.
+You may obtain a copy of the License at
+
+    http://www.apache.org/licenses/LICENSE-2.0
+
+Unless required by applicable law or agreed to in writing, software
+distributed under the License is distributed on an "AS IS" BASIS,
+WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+See the License for the specific language governing permissions and
+limitations under the License.
+==============================================================================*/
+#include "tensorflow/core/data/incremental_buffer_checkpoint.h"
+
+#include <cstdint>
+#include <string>
+#include <vector>
+
+#include "absl/container/flat_hash_set.h"
+#include "tensorflow/core/data/serialization_utils.h"
+#include "tensorflow/core/framework/tensor.h"
+#include "tensorflow/core/framework/tensor_testutil.h"
+#include "tensorflow/core/framework/types.h"
+#include "tensorflow/core/lib/core/status_test_util.h"
+#include "tensorflow/core/platform/env.h"
+#include "tensorflow/core/platform/path.h"
+#include "tensorflow/core/platform/test.h"
+
+namespace tensorflow {
+namespace data {
+namespace {
+
+constexpr char kName[] = "Iterator::Shuffle:buffer";
+
+std::string TestDirectory(const std::string& name) {
+  return io::JoinPath(testing::TmpDir(), name);
+}
+
+std::vector<std::vector<Tensor>> MakeBuffer(
+    const std::vector<int64_t>& values) {
+  std::vector<std::vector<Tensor>> buffer;
+  for (int64_t value : values) {
+    buffer.push_back({test::AsScalar<int64_t>(value)});
+  }
+  return buffer;
+}
+
+void ExpectBuffersEqual(const std::vector<std::vector<Tensor>>& expected,
+                        const std::vector<std::vector<Tensor>>& actual) {
+  ASSERT_EQ(expected.size(), actual.size());
+  for (int64_t i = 0; i < expected.size(); ++i) {
+    ASSERT_EQ(expected[i].size(), actual[i].size()) << "slot " << i;
+    for (int64_t j = 0; j < expected[i].size(); ++j) {
+      test::ExpectEqual(expected[i][j], actual[i][j]);
+    }
+  }
+}
+
+// Saves `buffer` into a fresh checkpoint and restores it with a new
+// `IncrementalBufferCheckpoint`.
+void SaveAndRestore(IncrementalBufferCheckpoint& checkpoint,
+                    const std::vector<std::vector<Tensor>>& buffer,
+                    absl::flat_hash_set<int64_t>& dirty_indices) {
+  VariantTensorDataWriter writer;
+  TF_ASSERT_OK(
+      checkpoint.Save(&writer, kName, {DT_INT64}, buffer, dirty_indices));
+  EXPECT_TRUE(dirty_indices.empty());
+  std::vector<const VariantTensorData*> data;
+  writer.GetData(&data);
+  VariantTensorDataReader reader(data);
+  ASSERT_TRUE(IncrementalBufferCheckpoint::Contains(&reader, kName));
+
+  IncrementalBufferCheckpoint restored(Env::Default(), "", 1);
+  std::vector<std::vector<Tensor>> restored_buffer;
+  TF_ASSERT_OK(
+      restored.Restore(&reader, kName, {DT_INT64}, &restored_buffer));
+  ExpectBuffersEqual(buffer, restored_buffer);
+  EXPECT_EQ(checkpoint.filenames(), restored.filenames());
+}
+
+TEST(IncrementalBufferCheckpointTest, DeltasReplayOnBase) {
+  IncrementalBufferCheckpoint checkpoint(
+      Env::Default(), TestDirectory("deltas"), /*compaction_interval=*/10);
+  std::vector<std::vector<Tensor>> buffer = MakeBuffer({0, 1, 2, 3});
+  absl::flat_hash_set<int64_t> dirty_indices;
+  SaveAndRestore(checkpoint, buffer, dirty_indices);
+  EXPECT_EQ(1, checkpoint.filenames().size());
+
+  buffer[1] = {test::AsScalar<int64_t>(10)};
+  buffer[2].clear();
+  dirty_indices = {1, 2};
+  SaveAndRestore(checkpoint, buffer, dirty_indices);
+
+  buffer[2] = {test::AsScalar<int64_t>(20)};
+  buffer.push_back({test::AsScalar<int64_t>(4)});
+  dirty_indices = {2, 4};
+  SaveAndRestore(checkpoint, buffer, dirty_indices);
+  EXPECT_EQ(3, checkpoint.filenames().size());
+}
+
+TEST(IncrementalBufferCheckpointTest, CompactionDeletesOlderGenerations) {
+  Env* env = Env::Default();
+  IncrementalBufferCheckpoint checkpoint(env, TestDirectory("compaction"),
+                                         /*compaction_interval=*/2);
+  std::vector<std::vector<Tensor>> buffer = MakeBuffer({0, 1, 2});
+  absl::flat_hash_set<int64_t> dirty_indices;
+  SaveAndRestore(checkpoint, buffer, dirty_indices);
+  buffer[0] = {test::AsScalar<int64_t>(5)};
+  dirty_indices = {0};
+  SaveAndRestore(checkpoint, buffer, dirty_indices);
+  const std::vector<std::string> first_generation = checkpoint.filenames();
+  ASSERT_EQ(2, first_generation.size());
+
+  // The third save compacts the chain into a new base, but keeps the first
+  // generation for the checkpoints that refer to it.
+  buffer[1].clear();
+  dirty_indices = {1};
+  SaveAndRestore(checkpoint, buffer, dirty_indices);
+  EXPECT_EQ(1, checkpoint.filenames().size());
+  for (const std::string& filename : first_generation) {
+    TF_EXPECT_OK(env->FileExists(filename));
+  }
+
+  dirty_indices = {2};
+  SaveAndRestore(checkpoint, buffer, dirty_indices);
+  SaveAndRestore(checkpoint, buffer, dirty_indices);
+  EXPECT_EQ(1, checkpoint.filenames().size());
+  for (const std::string& filename : first_generation) {
+    EXPECT_FALSE(env->FileExists(filename).ok());
+  }
+}
+
+TEST(IncrementalBufferCheckpointTest, NotContainedInFullCheckpoint) {
+  VariantTensorDataWriter writer;
+  TF_ASSERT_OK(WriteElementsToCheckpoint(&writer, kName, MakeBuffer({0, 1})));
+  std::vector<const VariantTensorData*> data;
+  writer.GetData(&data);
+  VariantTensorDataReader reader(data);
+  EXPECT_FALSE(IncrementalBufferCheckpoint::Contains(&reader, kName));
+}
+
+}  // namespace
+}  // namespace data
+}  // namespace tensorflow
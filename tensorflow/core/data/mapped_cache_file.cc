@@ -0,0 +1,298 @@
+/* Copyright 2024 The TensorFlow Authors. All Rights Reserved.
+
+Licensed under the Apache License, Version 2.0 (the "License");
+you may not use this file except in compliance with the License.
+You may obtain a copy of the License at
+
+    http://www.apache.org/licenses/LICENSE-2.0
+
+Unless required by applicable law or agreed to in writing, software
+distributed under the License is distributed on an "AS IS" BASIS,
+WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+See the License for the specific language governing permissions and
+limitations under the License.
+==============================================================================*/
+#include "tensorflow/core/data/mapped_cache_file.h"
+
+#include <cstring>
+#include <memory>
+#include <string>
+#include <utility>
+#include <vector>
+
+#include "absl/status/status.h"
+#include "absl/status/statusor.h"
+#include "absl/strings/str_cat.h"
+#include "tensorflow/core/data/mapped_tensor_buffer.h"
+#include "tensorflow/core/framework/allocator.h"
+#include "tensorflow/core/framework/tensor.pb.h"
+#include "tensorflow/core/framework/tensor_shape.h"
+#include "tensorflow/core/framework/types.h"
+#include "tensorflow/core/lib/random/random.h"
+#include "tensorflow/core/platform/errors.h"
+#include "tensorflow/core/platform/logging.h"
+
+namespace tensorflow {
+namespace data {
+namespace {
+
+constexpr uint64_t kMagic = 0x4843414d4d444654;  // "TFDMMACH"
+constexpr uint64_t kVersion = 1;
+constexpr uint64_t kAlignment = Allocator::kAllocatorAlignment;
+
+// The tensor data is stored as is.
+constexpr uint32_t kRawEncoding = 0;
+// The tensor is stored as a serialized `TensorProto`.
+constexpr uint32_t kProtoEncoding = 1;
+
+struct FileHeader {
+  uint64_t magic;
+  uint64_t version;
+};
+
+struct TensorHeader {
+  uint32_t dtype;
+  uint32_t encoding;
+  uint32_t num_dims;
+  uint32_t reserved;
+  // The number of bytes of data, which start at the next aligned offset after
+  // the dimensions.
+  uint64_t num_bytes;
+};
+
+struct FileFooter {
+  uint64_t index_offset;
+  uint64_t num_elements;
+  uint64_t num_components;
+  uint64_t magic;
+};
+
+uint64_t AlignUp(uint64_t offset) {
+  return (offset + kAlignment - 1) / kAlignment * kAlignment;
+}
+
+}  // namespace
+
+absl::StatusOr<std::unique_ptr<MappedCacheFileWriter>>
+MappedCacheFileWriter::Create(Env* env, const std::string& filename,
+                              int64_t num_components) {
+  std::string temp_filename =
+      absl::StrCat(filename, ".tmp.", random::New64());
+  std::unique_ptr<WritableFile> file;
+  TF_RETURN_IF_ERROR(env->NewWritableFile(temp_filename, &file));
+  std::unique_ptr<MappedCacheFileWriter> writer(new MappedCacheFileWriter(
+      env, filename, std::move(temp_filename), num_components,
+      std::move(file)));
+  FileHeader header = {kMagic, kVersion};
+  TF_RETURN_IF_ERROR(writer->Append(&header, sizeof(header)));
+  return writer;
+}
+
+MappedCacheFileWriter::MappedCacheFileWriter(
+    Env* env, std::string filename, std::string temp_filename,
+    int64_t num_components, std::unique_ptr<WritableFile> file)
+    : env_(env),
+      filename_(std::move(filename)),
+      temp_filename_(std::move(temp_filename)),
+      num_components_(num_components),
+      file_(std::move(file)) {}
+
+MappedCacheFileWriter::~MappedCacheFileWriter() {
+  if (!finalized_) {
+    file_.reset();
+    env_->DeleteFile(temp_filename_).IgnoreError();
+  }
+}
+
+absl::Status MappedCacheFileWriter::Append(const void* data, size_t size) {
+  TF_RETURN_IF_ERROR(
+      file_->Append(StringPiece(static_cast<const char*>(data), size)));
+  offset_ += size;
+  return absl::OkStatus();
+}
+
+absl::Status MappedCacheFileWriter::Pad() {
+  static const char kZeros[kAlignment] = {};
+  return Append(kZeros, AlignUp(offset_) - offset_);
+}
+
+absl::Status MappedCacheFileWriter::Write(const std::vector<Tensor>& element) {
+  if (element.size() != num_components_) {
+    return errors::InvalidArgument("Expected an element with ",
+                                   num_components_, " components, got ",
+                                   element.size());
+  }
+  for (const Tensor& tensor : element) {
+    TF_RETURN_IF_ERROR(Pad());
+    index_.push_back(offset_);
+    TensorHeader header = {};
+    header.dtype = tensor.dtype();
+    header.num_dims = tensor.dims();
+    std::string serialized;
+    StringPiece data;
+    if (DataTypeCanUseMemcpy(tensor.dtype())) {
+      header.encoding = kRawEncoding;
+      data = tensor.tensor_data();
+    } else {
+      header.encoding = kProtoEncoding;
+      TensorProto proto;
+      tensor.AsProtoTensorContent(&proto);
+      if (!proto.SerializeToString(&serialized)) {
+        return errors::Internal("Failed to serialize a tensor of type ",
+                                DataTypeString(tensor.dtype()));
+      }
+      data = serialized;
+    }
+    header.num_bytes = data.size();
+    TF_RETURN_IF_ERROR(Append(&header, sizeof(header)));
+    for (int i = 0; i < tensor.dims(); ++i) {
+      const int64_t dim = tensor.dim_size(i);
+      TF_RETURN_IF_ERROR(Append(&dim, sizeof(dim)));
+    }
+    TF_RETURN_IF_ERROR(Pad());
+    TF_RETURN_IF_ERROR(Append(data.data(), data.size()));
+  }
+  return absl::OkStatus();
+}
+
+absl::Status MappedCacheFileWriter::Finalize() {
+  TF_RETURN_IF_ERROR(Pad());
+  FileFooter footer;
+  footer.index_offset = offset_;
+  footer.num_elements = num_components_ > 0 ? index_.size() / num_components_
+                                            : 0;
+  footer.num_components = num_components_;
+  footer.magic = kMagic;
+  TF_RETURN_IF_ERROR(Append(index_.data(), index_.size() * sizeof(uint64_t)));
+  TF_RETURN_IF_ERROR(Append(&footer, sizeof(footer)));
+  TF_RETURN_IF_ERROR(file_->Close());
+  file_.reset();
+  // Readers of `filename_` only ever see a complete file. If another writer
+  // has already finished the same file, it is replaced with identical
+  // contents.
+  TF_RETURN_IF_ERROR(env_->RenameFile(temp_filename_, filename_));
+  finalized_ = true;
+  VLOG(2) << "Wrote memory-mapped cache file " << filename_ << " with "
+          << footer.num_elements << " elements and " << offset_ << " bytes.";
+  return absl::OkStatus();
+}
+
+absl::StatusOr<std::shared_ptr<const MappedCacheFile>> MappedCacheFile::Open(
+    Env* env, const std::string& filename) {
+  std::unique_ptr<ReadOnlyMemoryRegion> region;
+  TF_RETURN_IF_ERROR(env->NewReadOnlyMemoryRegionFromFile(filename, &region));
+  std::shared_ptr<MappedCacheFile> file(
+      new MappedCacheFile(filename, std::move(region)));
+  TF_RETURN_IF_ERROR(file->ReadFooter());
+  return file;
+}
+
+MappedCacheFile::MappedCacheFile(std::string filename,
+                                 std::shared_ptr<ReadOnlyMemoryRegion> region)
+    : filename_(std::move(filename)),
+      region_(std::move(region)),
+      data_(static_cast<const char*>(region_->data())),
+      length_(region_->length()) {}
+
+absl::Status MappedCacheFile::Corrupted(absl::string_view reason) const {
+  return errors::DataLoss("Corrupted memory-mapped cache file ", filename_,
+                          ": ", reason);
+}
+
+absl::Status MappedCacheFile::ReadFooter() {
+  FileHeader header;
+  FileFooter footer;
+  if (length_ < sizeof(header) + sizeof(footer)) {
+    return Corrupted("the file is too short");
+  }
+  std::memcpy(&header, data_, sizeof(header));
+  std::memcpy(&footer, data_ + length_ - sizeof(footer), sizeof(footer));
+  if (header.magic != kMagic || footer.magic != kMagic) {
+    return Corrupted("bad magic number");
+  }
+  if (header.version != kVersion) {
+    return Corrupted(absl::StrCat("unsupported version ", header.version));
+  }
+  const uint64_t num_entries = footer.num_elements * footer.num_components;
+  if (footer.index_offset % sizeof(uint64_t) != 0 ||
+      footer.index_offset > length_ - sizeof(footer) ||
+      num_entries > (length_ - sizeof(footer) - footer.index_offset) /
+                        sizeof(uint64_t)) {
+    return Corrupted("bad index");
+  }
+  num_elements_ = footer.num_elements;
+  num_components_ = footer.num_components;
+  index_ = reinterpret_cast<const uint64_t*>(data_ + footer.index_offset);
+  return absl::OkStatus();
+}
+
+absl::Status MappedCacheFile::Get(int64_t index,
+                                  std::vector<Tensor>* element) const {
+  if (index < 0 || index >= num_elements_) {
+    return errors::OutOfRange("Index out of range [0, ", num_elements_,
+                              "): ", index);
+  }
+  element->clear();
+  element->resize(num_components_);
+  for (int64_t i = 0; i < num_components_; ++i) {
+    uint64_t offset;
+    std::memcpy(&offset, &index_[index * num_components_ + i], sizeof(offset));
+    TF_RETURN_IF_ERROR(ReadTensor(offset, &(*element)[i]));
+  }
+  return absl::OkStatus();
+}
+
+absl::Status MappedCacheFile::ReadTensor(uint64_t offset,
+                                         Tensor* tensor) const {
+  TensorHeader header;
+  if (offset > length_ || length_ - offset < sizeof(header)) {
+    return Corrupted("bad tensor offset");
+  }
+  std::memcpy(&header, data_ + offset, sizeof(header));
+  offset += sizeof(header);
+  if (header.num_dims > TensorShape::MaxDimensions() ||
+      (length_ - offset) / sizeof(int64_t) < header.num_dims) {
+    return Corrupted("bad tensor shape");
+  }
+  std::vector<int64_t> dims(header.num_dims);
+  std::memcpy(dims.data(), data_ + offset, header.num_dims * sizeof(int64_t));
+  offset = AlignUp(offset + header.num_dims * sizeof(int64_t));
+  if (offset > length_ || length_ - offset < header.num_bytes) {
+    return Corrupted("bad tensor size");
+  }
+  const char* data = data_ + offset;
+  const DataType dtype = static_cast<DataType>(header.dtype);
+
+  if (header.encoding == kProtoEncoding) {
+    TensorProto proto;
+    if (!proto.ParseFromArray(data, header.num_bytes) ||
+        !tensor->FromProto(proto)) {
+      return Corrupted("bad tensor proto");
+    }
+    return absl::OkStatus();
+  }
+  if (header.encoding != kRawEncoding || !DataTypeCanUseMemcpy(dtype)) {
+    return Corrupted("bad tensor encoding");
+  }
+  TensorShape shape;
+  TF_RETURN_IF_ERROR(TensorShape::BuildTensorShape(dims, &shape));
+  if (shape.num_elements() * DataTypeSize(dtype) != header.num_bytes) {
+    return Corrupted("tensor size does not match its shape");
+  }
+  if (reinterpret_cast<uintptr_t>(data) % kAlignment != 0) {
+    // The file system did not map the file at an aligned address, so the data
+    // must be copied to be usable by Eigen.
+    *tensor = Tensor(dtype, shape);
+    std::memcpy(const_cast<char*>(tensor->tensor_data().data()), data,
+                header.num_bytes);
+    return absl::OkStatus();
+  }
+  auto* buffer = new MappedTensorBuffer(data, header.num_bytes, region_,
+                                        "MappedCacheFile");
+  *tensor = Tensor(dtype, shape, buffer);
+  buffer->Unref();
+  return absl::OkStatus();
+}
+
+}  // namespace data
+}  // namespace tensorflow
@@ -0,0 +1,110 @@
+/* Copyright 2024 The TensorFlow Authors. All Rights Reserved.
+
+Licensed under the Apache License, Version 2.0 (the "License");
+you may not use this file except in compliance with the License.
+You may obtain a copy of the License at
+
+    http://www.apache.org/licenses/LICENSE-2.0
+
+Unless required by applicable law or agreed to in writing, software
+distributed under the License is distributed on an "AS IS" BASIS,
+WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+See the License for the specific language governing permissions and
+limitations under the License.
+==============================================================================*/
+#ifndef TENSORFLOW_CORE_DATA_MAPPED_CACHE_FILE_H_
+#define TENSORFLOW_CORE_DATA_MAPPED_CACHE_FILE_H_
+
+#include <cstdint>
+#include <memory>
+#include <string>
+#include <vector>
+
+#include "absl/status/status.h"
+#include "absl/status/statusor.h"
+#include "tensorflow/core/framework/tensor.h"
+#include "tensorflow/core/platform/env.h"
+#include "tensorflow/core/platform/file_system.h"
+
+namespace tensorflow {
+namespace data {
+
+// A file of dataset elements in a fixed layout that is read through a memory
+// mapping. The tensors of most types are returned in place, without copying,
+// so that all the processes of a host that read the same file share its pages
+// instead of holding their own copies of the elements.
+//
+// The file consists of a header, the tensors of all elements, an index of the
+// offsets of the tensors, and a footer that locates the index. Each tensor is
+// stored as a small record header, its dimensions, and its data, aligned to
+// `Allocator::kAllocatorAlignment`. Tensors of types that cannot be copied
+// with `memcpy`, e.g. strings, are stored as serialized `TensorProto`s and are
+// parsed when read. Files use the byte order of the host that wrote them.
+
+// Writes elements to a temporary file that is moved to `filename` by
+// `Finalize()`, so that a file at `filename` is always complete. A writer that
+// is destroyed before `Finalize()` deletes its temporary file.
+class MappedCacheFileWriter {
+ public:
+  static absl::StatusOr<std::unique_ptr<MappedCacheFileWriter>> Create(
+      Env* env, const std::string& filename, int64_t num_components);
+  ~MappedCacheFileWriter();
+
+  // Appends an element with `num_components` tensors.
+  absl::Status Write(const std::vector<Tensor>& element);
+
+  // Writes the index and moves the file to `filename`.
+  absl::Status Finalize();
+
+ private:
+  MappedCacheFileWriter(Env* env, std::string filename,
+                        std::string temp_filename, int64_t num_components,
+                        std::unique_ptr<WritableFile> file);
+
+  absl::Status Append(const void* data, size_t size);
+  absl::Status Pad();
+
+  Env* const env_;
+  const std::string filename_;
+  const std::string temp_filename_;
+  const int64_t num_components_;
+  std::unique_ptr<WritableFile> file_;
+  uint64_t offset_ = 0;
+  std::vector<uint64_t> index_;
+  bool finalized_ = false;
+};
+
+// A read-only memory mapping of a file written by `MappedCacheFileWriter`.
+// Tensors returned by `Get()` may refer to the mapping and keep it alive.
+class MappedCacheFile {
+ public:
+  static absl::StatusOr<std::shared_ptr<const MappedCacheFile>> Open(
+      Env* env, const std::string& filename);
+
+  int64_t num_elements() const { return num_elements_; }
+  int64_t num_components() const { return num_components_; }
+
+  // Reads element `index` into `*element`.
+  absl::Status Get(int64_t index, std::vector<Tensor>* element) const;
+
+ private:
+  MappedCacheFile(std::string filename,
+                  std::shared_ptr<ReadOnlyMemoryRegion> region);
+
+  absl::Status ReadFooter();
+  absl::Status ReadTensor(uint64_t offset, Tensor* tensor) const;
+  absl::Status Corrupted(absl::string_view reason) const;
+
+  const std::string filename_;
+  const std::shared_ptr<ReadOnlyMemoryRegion> region_;
+  const char* const data_;
+  const uint64_t length_;
+  int64_t num_elements_ = 0;
+  int64_t num_components_ = 0;
+  const uint64_t* index_ = nullptr;
+};
+
+}  // namespace data
+}  // namespace tensorflow
+
+#endif  // TENSORFLOW_CORE_DATA_MAPPED_CACHE_FILE_H_
@@ -0,0 +1,111 @@
+/* Copyright 2024 The TensorFlow Authors. All Rights Reserved.
+
+Licensed under the Apache License, Version 2.0 (the "License");
+you may not use this file except in compliance with the License.
+You may obtain a copy of the License at
+
+    http://www.apache.org/licenses/LICENSE-2.0
+
+Unless required by applicable law or agreed to in writing, software
+distributed under the License is distributed on an "AS IS" BASIS,
+WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+See the License for the specific language governing permissions and
+limitations under the License.
+==============================================================================*/
+#include "tensorflow/core/data/mapped_cache_file.h"
+
+#include <memory>
+#include <string>
+#include <vector>
+
+#include "absl/strings/str_cat.h"
+#include "tensorflow/core/framework/tensor.h"
+#include "tensorflow/core/framework/tensor_testutil.h"
+#include "tensorflow/core/lib/core/status_test_util.h"
+#include "tensorflow/core/platform/env.h"
+#include "tensorflow/core/platform/path.h"
+#include "tensorflow/core/platform/test.h"
+#include "tsl/platform/status_matchers.h"
+
+namespace tensorflow {
+namespace data {
+namespace {
+
+std::string TestFilename(const std::string& name) {
+  return io::JoinPath(testing::TmpDir(), name);
+}
+
+TEST(MappedCacheFileTest, RoundTrip) {
+  const std::string filename = TestFilename("round_trip");
+  {
+    TF_ASSERT_OK_AND_ASSIGN(
+        auto writer, MappedCacheFileWriter::Create(Env::Default(), filename,
+                                                   /*num_components=*/2));
+    for (int64_t i = 0; i < 3; ++i) {
+      TF_ASSERT_OK(writer->Write(
+          {test::AsTensor<int64_t>({i, i + 1, i + 2}, TensorShape({3})),
+           test::AsScalar<tstring>(absl::StrCat("element ", i))}));
+    }
+    // Nothing is visible until the file is finalized.
+    EXPECT_FALSE(Env::Default()->FileExists(filename).ok());
+    TF_ASSERT_OK(writer->Finalize());
+  }
+
+  TF_ASSERT_OK_AND_ASSIGN(auto file,
+                          MappedCacheFile::Open(Env::Default(), filename));
+  EXPECT_EQ(3, file->num_elements());
+  EXPECT_EQ(2, file->num_components());
+  std::vector<Tensor> element;
+  for (int64_t i = 2; i >= 0; --i) {
+    TF_ASSERT_OK(file->Get(i, &element));
+    ASSERT_EQ(2, element.size());
+    test::ExpectEqual(
+        element[0],
+        test::AsTensor<int64_t>({i, i + 1, i + 2}, TensorShape({3})));
+    test::ExpectEqual(element[1],
+                      test::AsScalar<tstring>(absl::StrCat("element ", i)));
+  }
+  EXPECT_TRUE(errors::IsOutOfRange(file->Get(3, &element)));
+
+  // Tensors keep the mapping alive.
+  file.reset();
+  test::ExpectEqual(
+      element[0], test::AsTensor<int64_t>({0, 1, 2}, TensorShape({3})));
+}
+
+TEST(MappedCacheFileTest, UnfinalizedWriterLeavesNoFile) {
+  const std::string filename = TestFilename("unfinalized");
+  {
+    TF_ASSERT_OK_AND_ASSIGN(
+        auto writer, MappedCacheFileWriter::Create(Env::Default(), filename,
+                                                   /*num_components=*/1));
+    TF_ASSERT_OK(writer->Write({test::AsScalar<float>(1.0)}));
+  }
+  EXPECT_FALSE(Env::Default()->FileExists(filename).ok());
+  std::vector<std::string> matches;
+  TF_ASSERT_OK(Env::Default()->GetMatchingPaths(absl::StrCat(filename, "*"),
+                                                &matches));
+  EXPECT_TRUE(matches.empty());
+}
+
+TEST(MappedCacheFileTest, InvalidElement) {
+  TF_ASSERT_OK_AND_ASSIGN(
+      auto writer,
+      MappedCacheFileWriter::Create(
+          Env::Default(), TestFilename("invalid"), /*num_components=*/2));
+  EXPECT_TRUE(
+      errors::IsInvalidArgument(writer->Write({test::AsScalar<float>(1.0)})));
+}
+
+TEST(MappedCacheFileTest, CorruptedFile) {
+  const std::string filename = TestFilename("corrupted");
+  TF_ASSERT_OK(WriteStringToFile(Env::Default(), filename,
+                                 std::string(128, 'x')));
+  EXPECT_TRUE(
+      errors::IsDataLoss(MappedCacheFile::Open(Env::Default(), filename)
+                             .status()));
+}
+
+}  // namespace
+}  // namespace data
+}  // namespace tensorflow
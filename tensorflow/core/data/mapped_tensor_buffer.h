@@ -0,0 +1,61 @@
+/* Copyright 2024 The TensorFlow Authors. All Rights Reserved.
+
+Licensed under the Apache License, Version 2.0 (the "License");
+you may not use this file except in compliance with the License.
+You may obtain a copy of the License at
+
+    http://www.apache.org/licenses/LICENSE-2.0
+
+Unless required by applicable law or agreed to in writing, software
+distributed under the License is distributed on an "AS IS" BASIS,
+WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+See the License for the specific language governing permissions and
+limitations under the License.
+==============================================================================*/
+#ifndef TENSORFLOW_CORE_DATA_MAPPED_TENSOR_BUFFER_H_
+#define TENSORFLOW_CORE_DATA_MAPPED_TENSOR_BUFFER_H_
+
+#include <cstdint>
+#include <memory>
+#include <utility>
+
+#include "tensorflow/core/framework/allocation_description.pb.h"
+#include "tensorflow/core/framework/tensor.h"
+#include "tensorflow/core/platform/file_system.h"
+
+namespace tensorflow {
+namespace data {
+
+// A buffer of tensor data in a memory-mapped file, which keeps the mapping
+// alive. The memory is read-only, so it must not be forwarded to outputs.
+class MappedTensorBuffer : public TensorBuffer {
+ public:
+  // `allocator_name` names the file format in allocation descriptions, and
+  // must outlive the buffer.
+  MappedTensorBuffer(const void* data, size_t size,
+                     std::shared_ptr<ReadOnlyMemoryRegion> region,
+                     const char* allocator_name)
+      : TensorBuffer(const_cast<void*>(data)),
+        size_(size),
+        region_(std::move(region)),
+        allocator_name_(allocator_name) {}
+
+  size_t size() const override { return size_; }
+  TensorBuffer* root_buffer() override { return this; }
+  bool OwnsMemory() const override { return false; }
+
+  void FillAllocationDescription(AllocationDescription* proto) const override {
+    proto->set_requested_bytes(static_cast<int64_t>(size_));
+    proto->set_allocator_name(allocator_name_);
+  }
+
+ private:
+  const size_t size_;
+  const std::shared_ptr<ReadOnlyMemoryRegion> region_;
+  const char* const allocator_name_;
+};
+
+}  // namespace data
+}  // namespace tensorflow
+
+#endif  // TENSORFLOW_CORE_DATA_MAPPED_TENSOR_BUFFER_H_
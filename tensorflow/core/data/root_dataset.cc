@@ -216,6 +216,9 @@ class RootDataset::Iterator : public DatasetIterator<RootDataset> {
       if (experiments.contains("autotune_buffer_optimization")) {
         model_->AddExperiment("autotune_buffer_optimization");
       }
+      if (experiments.contains("global_ram_budget")) {
+        model_->AddExperiment("global_ram_budget");
+      }
     }
     IteratorContext iter_ctx(CreateParams(ctx));
     if (model_) {
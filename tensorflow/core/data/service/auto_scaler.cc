@@ -263,6 +263,16 @@ std::optional<int64_t> MultipleIterationsAutoScaler::GetOptimalNumberOfWorkers()
     return optimal_number_of_workers;
 }
 
+std::optional<int64_t> MultipleIterationsAutoScaler::GetOptimalNumberOfWorkers(
+    int64_t iteration_id) const TF_LOCKS_EXCLUDED(mu_) {
+  tsl::tf_shared_lock l(mu_);
+  auto it = auto_scalers_.find(iteration_id);
+  if (it == auto_scalers_.end()) {
+    return std::nullopt;
+  }
+  return it->second->GetOptimalNumberOfWorkers();
+}
+
 absl::Status MultipleIterationsAutoScaler::ReportProcessingTime(
     int64_t iteration_id, const std::string& worker_address,
     absl::Duration processing_time) TF_LOCKS_EXCLUDED(mu_) {
@@ -311,5 +321,45 @@ absl::Status MultipleIterationsAutoScaler::RemoveConsumer(int64_t iteration_id,
   return status;
 }
 
+WorkerAssignmentScaler::WorkerAssignmentScaler(double scale_down_margin,
+                                               absl::Duration scale_down_delay)
+    : scale_down_margin_(scale_down_margin),
+      scale_down_delay_(scale_down_delay) {}
+
+int64_t WorkerAssignmentScaler::GetTargetNumberOfWorkers(
+    int64_t iteration_id, int64_t current_number_of_workers,
+    std::optional<int64_t> optimal_number_of_workers,
+    int64_t max_number_of_workers, absl::Time now) {
+  IterationState& state = iterations_[iteration_id];
+  if (!optimal_number_of_workers.has_value()) {
+    state.scale_down_since.reset();
+    return current_number_of_workers;
+  }
+  const int64_t optimal =
+      std::clamp<int64_t>(*optimal_number_of_workers, 1,
+                          std::max<int64_t>(max_number_of_workers, 1));
+  if (optimal >= current_number_of_workers ||
+      optimal > current_number_of_workers * (1.0 - scale_down_margin_)) {
+    state.scale_down_since.reset();
+    return std::max(optimal, current_number_of_workers);
+  }
+  if (!state.scale_down_since.has_value()) {
+    state.scale_down_since = now;
+  }
+  if (now - *state.scale_down_since < scale_down_delay_ ||
+      now - state.last_scale_down < scale_down_delay_) {
+    return current_number_of_workers;
+  }
+  VLOG(1) << "Scaling iteration " << iteration_id << " down from "
+          << current_number_of_workers << " to " << optimal << " workers.";
+  state.scale_down_since.reset();
+  state.last_scale_down = now;
+  return optimal;
+}
+
+void WorkerAssignmentScaler::UnregisterIteration(int64_t iteration_id) {
+  iterations_.erase(iteration_id);
+}
+
 }  // namespace data
 }  // namespace tensorflow
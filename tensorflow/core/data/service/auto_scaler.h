@@ -131,6 +131,11 @@ class MultipleIterationsAutoScaler {
   // target processing times for at least one iteration, returns nullopt.
   std::optional<int64_t> GetOptimalNumberOfWorkers() const
       TF_LOCKS_EXCLUDED(mu_);
+  // Returns the estimated optimal number of workers for iteration with
+  // `iteration_id`. If there are no previously reported processing and target
+  // processing times for the iteration, returns nullopt.
+  std::optional<int64_t> GetOptimalNumberOfWorkers(int64_t iteration_id) const
+      TF_LOCKS_EXCLUDED(mu_);
   // Reports the latest observed processing time from the worker with
   // `worker_address` for iteration with `iteration_id`. Returns an error if
   // `processing_time` is ZeroDuration or negative.
@@ -173,6 +178,44 @@ class MultipleIterationsAutoScaler {
       TF_GUARDED_BY(mu_);
 };
 
+// Decides how many tf.data service workers to assign to an Iteration, so that
+// its consumption rate is met with the fewest workers, from the optimal number
+// of workers estimated by an `AutoScaler`.
+//
+// To prevent thrashing, the number of workers is raised as soon as the
+// estimate exceeds it, but is only lowered once the estimate has stayed below
+// `1 - scale_down_margin` of it for `scale_down_delay`, and at most once per
+// `scale_down_delay`.
+//
+// WorkerAssignmentScaler is not thread-safe.
+class WorkerAssignmentScaler {
+ public:
+  WorkerAssignmentScaler(double scale_down_margin,
+                         absl::Duration scale_down_delay);
+  // Returns the number of workers to assign at time `now` to iteration with
+  // `iteration_id`, which has `current_number_of_workers`, given its estimated
+  // `optimal_number_of_workers`. The result is between 1 and
+  // `max_number_of_workers`, unless `current_number_of_workers` is larger and
+  // the estimate is unknown.
+  int64_t GetTargetNumberOfWorkers(
+      int64_t iteration_id, int64_t current_number_of_workers,
+      std::optional<int64_t> optimal_number_of_workers,
+      int64_t max_number_of_workers, absl::Time now);
+  // Forgets the past decisions for iteration with `iteration_id`.
+  void UnregisterIteration(int64_t iteration_id);
+
+ private:
+  struct IterationState {
+    // Since when the estimate has been low enough to scale down, if it is.
+    std::optional<absl::Time> scale_down_since;
+    absl::Time last_scale_down = absl::InfinitePast();
+  };
+
+  const double scale_down_margin_;
+  const absl::Duration scale_down_delay_;
+  absl::flat_hash_map<int64_t, IterationState> iterations_;
+};
+
 }  // namespace data
 }  // namespace tensorflow
 
@@ -743,6 +743,82 @@ TEST(MultipleIterationsAutoScalerTest, RemoveConsumerAfterNewTPTReported) {
   TF_ASSERT_OK(auto_scaler.RemoveConsumer(0, 0));
 }
 
+TEST(MultipleIterationsAutoScalerTest, GetOptimalNumberOfWorkersForIteration) {
+  MultipleIterationsAutoScaler auto_scaler;
+  TF_ASSERT_OK(auto_scaler.ReportProcessingTime(0, "/worker/task/0:20000",
+                                                absl::Microseconds(10)));
+  TF_ASSERT_OK(
+      auto_scaler.ReportTargetProcessingTime(0, 0, absl::Microseconds(5)));
+  TF_ASSERT_OK(auto_scaler.ReportProcessingTime(1, "/worker/task/0:20000",
+                                                absl::Microseconds(10)));
+  TF_ASSERT_OK(
+      auto_scaler.ReportTargetProcessingTime(1, 0, absl::Microseconds(1)));
+  EXPECT_EQ(auto_scaler.GetOptimalNumberOfWorkers(0), 2);
+  EXPECT_EQ(auto_scaler.GetOptimalNumberOfWorkers(1), 10);
+  EXPECT_EQ(auto_scaler.GetOptimalNumberOfWorkers(2), std::nullopt);
+}
+
+TEST(WorkerAssignmentScalerTest, ScalesUpImmediately) {
+  WorkerAssignmentScaler scaler(/*scale_down_margin=*/0.2,
+                                /*scale_down_delay=*/absl::Minutes(5));
+  const absl::Time now = absl::UnixEpoch();
+  EXPECT_EQ(scaler.GetTargetNumberOfWorkers(0, 2, 5, 10, now), 5);
+  EXPECT_EQ(scaler.GetTargetNumberOfWorkers(0, 5, 20, 10, now), 10);
+}
+
+TEST(WorkerAssignmentScalerTest, KeepsWorkersWithoutEstimate) {
+  WorkerAssignmentScaler scaler(/*scale_down_margin=*/0.2,
+                                /*scale_down_delay=*/absl::Minutes(5));
+  EXPECT_EQ(scaler.GetTargetNumberOfWorkers(0, 4, std::nullopt, 10,
+                                            absl::UnixEpoch()),
+            4);
+}
+
+TEST(WorkerAssignmentScalerTest, ScalesDownAfterDelay) {
+  WorkerAssignmentScaler scaler(/*scale_down_margin=*/0.2,
+                                /*scale_down_delay=*/absl::Minutes(5));
+  absl::Time now = absl::UnixEpoch();
+  // Estimates within the margin do not change the number of workers.
+  EXPECT_EQ(scaler.GetTargetNumberOfWorkers(0, 10, 9, 10, now), 10);
+  EXPECT_EQ(scaler.GetTargetNumberOfWorkers(0, 10, 4, 10, now), 10);
+  now += absl::Minutes(4);
+  EXPECT_EQ(scaler.GetTargetNumberOfWorkers(0, 10, 4, 10, now), 10);
+  now += absl::Minutes(1);
+  EXPECT_EQ(scaler.GetTargetNumberOfWorkers(0, 10, 4, 10, now), 4);
+  // Another reduction has to wait for the delay again.
+  now += absl::Minutes(1);
+  EXPECT_EQ(scaler.GetTargetNumberOfWorkers(0, 4, 1, 10, now), 4);
+  now += absl::Minutes(4);
+  EXPECT_EQ(scaler.GetTargetNumberOfWorkers(0, 4, 1, 10, now), 4);
+  now += absl::Minutes(1);
+  EXPECT_EQ(scaler.GetTargetNumberOfWorkers(0, 4, 1, 10, now), 1);
+}
+
+TEST(WorkerAssignmentScalerTest, HigherEstimateResetsScaleDown) {
+  WorkerAssignmentScaler scaler(/*scale_down_margin=*/0.2,
+                                /*scale_down_delay=*/absl::Minutes(5));
+  absl::Time now = absl::UnixEpoch();
+  EXPECT_EQ(scaler.GetTargetNumberOfWorkers(0, 10, 4, 10, now), 10);
+  now += absl::Minutes(3);
+  EXPECT_EQ(scaler.GetTargetNumberOfWorkers(0, 10, 10, 10, now), 10);
+  now += absl::Minutes(3);
+  EXPECT_EQ(scaler.GetTargetNumberOfWorkers(0, 10, 4, 10, now), 10);
+  now += absl::Minutes(5);
+  EXPECT_EQ(scaler.GetTargetNumberOfWorkers(0, 10, 4, 10, now), 4);
+}
+
+TEST(WorkerAssignmentScalerTest, IterationsAreIndependent) {
+  WorkerAssignmentScaler scaler(/*scale_down_margin=*/0.2,
+                                /*scale_down_delay=*/absl::Minutes(5));
+  absl::Time now = absl::UnixEpoch();
+  EXPECT_EQ(scaler.GetTargetNumberOfWorkers(0, 10, 2, 10, now), 10);
+  now += absl::Minutes(5);
+  EXPECT_EQ(scaler.GetTargetNumberOfWorkers(1, 10, 2, 10, now), 10);
+  EXPECT_EQ(scaler.GetTargetNumberOfWorkers(0, 10, 2, 10, now), 2);
+  scaler.UnregisterIteration(0);
+  EXPECT_EQ(scaler.GetTargetNumberOfWorkers(0, 10, 2, 10, now), 10);
+}
+
 }  // namespace
 
 }  // namespace data
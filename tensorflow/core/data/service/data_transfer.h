@@ -123,6 +123,11 @@ class DataTransferServer {
   // Return the port that this server is listening on.
   virtual int Port() const = 0;
 
+  // Returns the address at which clients reach this server. If empty, clients
+  // use the worker's `data_transfer_address` with the port placeholder
+  // replaced by `Port()`.
+  virtual std::string Address() const { return std::string(); }
+
   // Register a DataTransferServer factory under `name`.
   static void Register(std::string name, ServerFactoryT factory);
 
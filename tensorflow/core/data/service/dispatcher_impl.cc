@@ -91,6 +91,9 @@ using ::tensorflow::protobuf::util::MessageDifferencer;
 // The name of the journal directory inside the dispatcher's working directory.
 // This name is load-bearing; do not change.
 constexpr char kJournalDir[] = "tf_data_dispatcher_journal";
+// The name of the directory of dispatcher state snapshots inside the
+// dispatcher's working directory.
+constexpr char kJournalSnapshotDir[] = "tf_data_dispatcher_journal_snapshots";
 // The name of the datasets directory inside the dispatcher's working directory.
 constexpr char kDatasetsDir[] = "datasets";
 
@@ -104,6 +107,12 @@ constexpr absl::Duration kDefaultIterationGcCheckInterval = absl::Minutes(10);
 constexpr absl::Duration kDefaultIterationGcTimeout = absl::Minutes(5);
 constexpr absl::Duration kDefaultClientTimeout = absl::Minutes(5);
 constexpr absl::Duration kDefaultWorkerTimeout = absl::Minutes(10);
+constexpr int64_t kDefaultJournalSnapshotInterval = 100000;
+constexpr absl::Duration kDefaultWorkerAssignmentScaleDownDelay =
+    absl::Minutes(5);
+// Workers are unassigned from an iteration only if the AutoScaler estimates
+// that it needs at least this fraction fewer workers.
+constexpr double kWorkerAssignmentScaleDownMargin = 0.2;
 
 constexpr std::array<const char*, 8> kNodeNameSharingOps = {
     "HashTable",
@@ -132,6 +141,16 @@ std::string DatasetsDir(const std::string& work_dir) {
   return io::JoinPath(work_dir, kDatasetsDir);
 }
 
+std::string JournalSnapshotDir(const std::string& work_dir) {
+  return io::JoinPath(work_dir, kJournalSnapshotDir);
+}
+
+std::string JournalSnapshotFile(const std::string& work_dir,
+                                int64_t journal_sequence_number) {
+  return io::JoinPath(JournalSnapshotDir(work_dir),
+                      absl::StrCat("snapshot_", journal_sequence_number));
+}
+
 Status CreateWorkerStub(const std::string& address, const std::string& protocol,
                         std::unique_ptr<WorkerService::Stub>& stub) {
   ::grpc::ChannelArguments args;
@@ -183,6 +202,13 @@ DispatcherConfig ApplyConfigDefaults(const DispatcherConfig& config) {
     new_config.set_worker_max_concurrent_snapshots(
         kDefaultWorkerMaxConcurrentSnapshots);
   }
+  if (new_config.journal_snapshot_interval() == 0) {
+    new_config.set_journal_snapshot_interval(kDefaultJournalSnapshotInterval);
+  }
+  if (new_config.worker_assignment_scale_down_delay_ms() == 0) {
+    new_config.set_worker_assignment_scale_down_delay_ms(
+        absl::ToInt64Milliseconds(kDefaultWorkerAssignmentScaleDownDelay));
+  }
   return new_config;
 }
 }  // namespace
@@ -192,7 +218,10 @@ DataServiceDispatcherImpl::DataServiceDispatcherImpl(
     : config_(ApplyConfigDefaults(config)),
       env_(Env::Default()),
       snapshot_assignment_manager_(config_.worker_max_concurrent_snapshots()),
-      state_(config_) {
+      state_(config_),
+      worker_assignment_scaler_(
+          kWorkerAssignmentScaleDownMargin,
+          absl::Milliseconds(config_.worker_assignment_scale_down_delay_ms())) {
   if (config_.work_dir().empty()) {
     dataset_store_ = std::make_unique<MemoryDatasetStore>();
   } else {
@@ -233,24 +262,30 @@ Status DataServiceDispatcherImpl::Start() {
   }
   journal_writer_ =
       std::make_unique<FileJournalWriter>(env_, JournalDir(config_.work_dir()));
+  int64_t journal_sequence_number = 0;
+  TF_RETURN_IF_ERROR(RestoreJournalSnapshot(journal_sequence_number));
   LOG(INFO) << "Attempting to restore dispatcher state from journal in "
             << JournalDir(config_.work_dir());
   Update update;
   bool end_of_journal = false;
-  FileJournalReader reader(env_, JournalDir(config_.work_dir()));
+  FileJournalReader reader(env_, JournalDir(config_.work_dir()),
+                           journal_sequence_number);
   Status s = reader.Read(update, end_of_journal);
   if (errors::IsNotFound(s)) {
-    LOG(INFO) << "No journal found. Starting dispatcher from new state.";
+    LOG(INFO) << "No journal found after journal file "
+              << journal_sequence_number << ".";
   } else if (!s.ok()) {
     return s;
   } else {
     int64_t start = env_->NowMicros();
     while (!end_of_journal) {
       TF_RETURN_IF_ERROR(ApplyWithoutJournaling(update));
+      ++journal_updates_since_snapshot_;
       TF_RETURN_IF_ERROR(reader.Read(update, end_of_journal));
     }
     absl::Duration duration = absl::Microseconds(env_->NowMicros() - start);
-    LOG(INFO) << "Restored from journal in " << duration << ".";
+    LOG(INFO) << "Restored " << journal_updates_since_snapshot_
+              << " updates from journal in " << duration << ".";
   }
   for (const auto& iteration : state_.ListIterations()) {
     if (IsDynamicShard(iteration->job->processing_mode)) {
@@ -912,6 +947,16 @@ Status DataServiceDispatcherImpl::CreateTasksForWorker(
       TF_RETURN_IF_ERROR(CreatePendingTask(iteration, worker_address));
       continue;
     }
+    if (auto it = worker_assignment_targets_.find(iteration->iteration_id);
+        it != worker_assignment_targets_.end()) {
+      std::vector<std::shared_ptr<const Task>> tasks;
+      TF_RETURN_IF_ERROR(
+          state_.TasksForIteration(iteration->iteration_id, tasks));
+      if (static_cast<int64_t>(tasks.size()) >= it->second) {
+        // The iteration already has all the workers that it needs.
+        continue;
+      }
+    }
     std::shared_ptr<const Task> task;
     TF_RETURN_IF_ERROR(CreateTask(iteration, worker_address, task));
   }
@@ -1376,46 +1421,138 @@ Status DataServiceDispatcherImpl::Apply(const Update& update)
     TF_EXCLUSIVE_LOCKS_REQUIRED(mu_) {
   if (journal_writer_.has_value()) {
     TF_RETURN_IF_ERROR(journal_writer_.value()->Write(update));
+    ++journal_updates_since_snapshot_;
   }
   return state_.Apply(update);
 }
 
-void DataServiceDispatcherImpl::MaintenanceThread() {
-  int64_t next_check_micros = 0;
-  while (true) {
+Status DataServiceDispatcherImpl::RestoreJournalSnapshot(
+    int64_t& journal_sequence_number) TF_EXCLUSIVE_LOCKS_REQUIRED(mu_) {
+  const std::string snapshot_dir = JournalSnapshotDir(config_.work_dir());
+  if (!env_->FileExists(snapshot_dir).ok()) {
+    return absl::OkStatus();
+  }
+  TF_ASSIGN_OR_RETURN(std::vector<std::string> snapshot_files,
+                      GetChildren(snapshot_dir, env_));
+  int64_t latest_sequence_number = -1;
+  for (const std::string& file : snapshot_files) {
+    absl::string_view name = file;
+    int64_t sequence_number;
+    if (absl::ConsumePrefix(&name, "snapshot_") &&
+        absl::SimpleAtoi(name, &sequence_number)) {
+      latest_sequence_number =
+          std::max(latest_sequence_number, sequence_number);
+    }
+  }
+  if (latest_sequence_number < 0) {
+    return absl::OkStatus();
+  }
+  const std::string snapshot_file =
+      JournalSnapshotFile(config_.work_dir(), latest_sequence_number);
+  int64_t start = env_->NowMicros();
+  DispatcherStateSnapshot snapshot;
+  TF_RETURN_IF_ERROR(ReadBinaryProto(env_, snapshot_file, &snapshot));
+  TF_RETURN_IF_ERROR(state_.RestoreSnapshot(snapshot));
+  journal_sequence_number = snapshot.journal_sequence_number();
+  absl::Duration duration = absl::Microseconds(env_->NowMicros() - start);
+  LOG(INFO) << "Restored dispatcher state snapshot " << snapshot_file << " in "
+            << duration << ".";
+  return absl::OkStatus();
+}
+
+Status DataServiceDispatcherImpl::MaybeSnapshotJournal()
+    TF_LOCKS_EXCLUDED(mu_) {
+  DispatcherStateSnapshot snapshot;
+  {
     mutex_lock l(mu_);
-    while (!cancelled_ && env_->NowMicros() < next_check_micros) {
-      int64_t remaining_micros = next_check_micros - env_->NowMicros();
-      maintenance_thread_cv_.wait_for(
-          l, std::chrono::microseconds(remaining_micros));
+    if (!journal_writer_.has_value() ||
+        config_.journal_snapshot_interval() < 0 ||
+        journal_updates_since_snapshot_ <
+            config_.journal_snapshot_interval()) {
+      return absl::OkStatus();
     }
-    if (cancelled_) {
-      return;
+    // The snapshot reflects every update in the journal files before the one
+    // that is started here.
+    snapshot = state_.ExportSnapshot();
+    TF_ASSIGN_OR_RETURN(int64_t journal_sequence_number,
+                        journal_writer_.value()->StartNewFile());
+    snapshot.set_journal_sequence_number(journal_sequence_number);
+    journal_updates_since_snapshot_ = 0;
+  }
+
+  // Only the maintenance thread writes snapshots, so it is safe to write and
+  // clean up without holding `mu_`. A failure at any point leaves a journal
+  // from which the state can be restored.
+  const std::string snapshot_dir = JournalSnapshotDir(config_.work_dir());
+  const std::string snapshot_file = JournalSnapshotFile(
+      config_.work_dir(), snapshot.journal_sequence_number());
+  TF_RETURN_IF_ERROR(env_->RecursivelyCreateDir(snapshot_dir));
+  TF_RETURN_IF_ERROR(AtomicallyWriteBinaryProto(snapshot_file, snapshot, env_));
+  TF_ASSIGN_OR_RETURN(std::vector<std::string> snapshot_files,
+                      GetChildren(snapshot_dir, env_));
+  for (const std::string& file : snapshot_files) {
+    const std::string path = io::JoinPath(snapshot_dir, file);
+    if (path != snapshot_file) {
+      TF_RETURN_IF_ERROR(env_->DeleteFile(path));
     }
+  }
+  TF_RETURN_IF_ERROR(TruncateJournal(env_, JournalDir(config_.work_dir()),
+                                     snapshot.journal_sequence_number()));
+  LOG(INFO) << "Wrote dispatcher state snapshot " << snapshot_file
+            << " and truncated the journal before it.";
+  return absl::OkStatus();
+}
+
+void DataServiceDispatcherImpl::MaintenanceThread() {
+  int64_t next_check_micros = 0;
+  while (true) {
     {
-      Status s = ReleaseMissingClients();
-      if (!s.ok()) {
-        LOG(WARNING) << "Error releasing missing clients: " << s;
+      mutex_lock l(mu_);
+      while (!cancelled_ && env_->NowMicros() < next_check_micros) {
+        int64_t remaining_micros = next_check_micros - env_->NowMicros();
+        maintenance_thread_cv_.wait_for(
+            l, std::chrono::microseconds(remaining_micros));
       }
-    }
-    {
-      Status s = auto_scaler_.UpdateOptimalNumberOfWorkersMetric(
-          state_.GetNumberOfRegisteredWorkers());
-      if (!s.ok()) {
-        LOG(WARNING) << "Error updating the optimal number of workers metric "
-                        "in tf.data service AutoScaler: "
-                     << s;
+      if (cancelled_) {
+        return;
       }
-    }
-    {
-      Status s = GcOldIterations();
-      if (!s.ok()) {
-        LOG(WARNING) << "Error garbage collecting old iterations: " << s;
+      {
+        Status s = ReleaseMissingClients();
+        if (!s.ok()) {
+          LOG(WARNING) << "Error releasing missing clients: " << s;
+        }
+      }
+      {
+        Status s = auto_scaler_.UpdateOptimalNumberOfWorkersMetric(
+            state_.GetNumberOfRegisteredWorkers());
+        if (!s.ok()) {
+          LOG(WARNING) << "Error updating the optimal number of workers "
+                          "metric in tf.data service AutoScaler: "
+                       << s;
+        }
+      }
+      {
+        Status s = UpdateWorkerAssignments();
+        if (!s.ok()) {
+          LOG(WARNING) << "Error updating the worker assignments of "
+                          "iterations: "
+                       << s;
+        }
       }
+      {
+        Status s = GcOldIterations();
+        if (!s.ok()) {
+          LOG(WARNING) << "Error garbage collecting old iterations: " << s;
+        }
+      }
+      DetectMissingWorkers();
+      next_check_micros =
+          env_->NowMicros() + (config_.job_gc_check_interval_ms() * 1000);
+    }
+    Status s = MaybeSnapshotJournal();
+    if (!s.ok()) {
+      LOG(WARNING) << "Error snapshotting the dispatcher state: " << s;
     }
-    DetectMissingWorkers();
-    next_check_micros =
-        env_->NowMicros() + (config_.job_gc_check_interval_ms() * 1000);
   }
 }
 
@@ -1521,11 +1658,130 @@ Status DataServiceDispatcherImpl::GcOldIterations()
                    << " with tf.data service AutoScaler: "
                    << auto_scaler_status;
     }
+    worker_assignment_scaler_.UnregisterIteration(iteration->iteration_id);
+    worker_assignment_targets_.erase(iteration->iteration_id);
     LOG(INFO) << "Garbage collected iteration " << iteration->DebugString();
   }
   return absl::OkStatus();
 }
 
+bool DataServiceDispatcherImpl::ShouldAutoscaleWorkerAssignment(
+    const Iteration& iteration) const {
+  return config_.autoscale_worker_assignment() && !iteration.finished &&
+         !iteration.IsRoundRobin() &&
+         IsNoShard(iteration.job->processing_mode) &&
+         iteration.job->target_workers != TARGET_WORKERS_LOCAL;
+}
+
+Status DataServiceDispatcherImpl::UpdateWorkerAssignments()
+    TF_EXCLUSIVE_LOCKS_REQUIRED(mu_) {
+  if (!config_.autoscale_worker_assignment()) {
+    return absl::OkStatus();
+  }
+  const std::vector<std::shared_ptr<const Worker>> workers =
+      state_.ListWorkers();
+  const absl::Time now = absl::FromUnixMicros(env_->NowMicros());
+  for (const auto& iteration : state_.ListIterations()) {
+    if (!ShouldAutoscaleWorkerAssignment(*iteration)) {
+      continue;
+    }
+    std::vector<std::shared_ptr<const Task>> tasks;
+    TF_RETURN_IF_ERROR(
+        state_.TasksForIteration(iteration->iteration_id, tasks));
+    tasks.erase(std::remove_if(tasks.begin(), tasks.end(),
+                               [](const std::shared_ptr<const Task>& task) {
+                                 return task->finished;
+                               }),
+                tasks.end());
+    if (tasks.empty()) {
+      continue;
+    }
+    const int64_t num_tasks = tasks.size();
+    const int64_t target = worker_assignment_scaler_.GetTargetNumberOfWorkers(
+        iteration->iteration_id, num_tasks,
+        auto_scaler_.GetOptimalNumberOfWorkers(iteration->iteration_id),
+        workers.size(), now);
+    worker_assignment_targets_[iteration->iteration_id] = target;
+    if (target > num_tasks) {
+      TF_RETURN_IF_ERROR(
+          AssignWorkers(iteration, tasks, workers, target - num_tasks));
+    } else if (target < num_tasks) {
+      TF_RETURN_IF_ERROR(UnassignWorkers(iteration, tasks, num_tasks - target));
+    }
+  }
+  return absl::OkStatus();
+}
+
+Status DataServiceDispatcherImpl::AssignWorkers(
+    const std::shared_ptr<const Iteration>& iteration,
+    const std::vector<std::shared_ptr<const Task>>& tasks,
+    const std::vector<std::shared_ptr<const Worker>>& workers,
+    int64_t num_workers) TF_EXCLUSIVE_LOCKS_REQUIRED(mu_) {
+  absl::flat_hash_set<std::string> assigned_workers;
+  for (const auto& task : tasks) {
+    assigned_workers.insert(task->worker_address);
+  }
+  // Assigns the least loaded workers first.
+  std::vector<std::pair<int64_t, std::string>> candidates;
+  for (const auto& worker : workers) {
+    if (assigned_workers.contains(worker->address)) {
+      continue;
+    }
+    std::vector<std::shared_ptr<const Task>> worker_tasks;
+    TF_RETURN_IF_ERROR(state_.TasksForWorker(worker->address, worker_tasks));
+    candidates.push_back({worker_tasks.size(), worker->address});
+  }
+  std::sort(candidates.begin(), candidates.end());
+  num_workers = std::min<int64_t>(num_workers, candidates.size());
+  for (int64_t i = 0; i < num_workers; ++i) {
+    std::shared_ptr<const Task> task;
+    TF_RETURN_IF_ERROR(CreateTask(iteration, candidates[i].second, task));
+    VLOG(1) << "Assigned worker " << candidates[i].second << " to iteration "
+            << iteration->iteration_id << " with task " << task->task_id;
+  }
+  return absl::OkStatus();
+}
+
+Status DataServiceDispatcherImpl::UnassignWorkers(
+    const std::shared_ptr<const Iteration>& iteration,
+    const std::vector<std::shared_ptr<const Task>>& tasks,
+    int64_t num_workers) TF_EXCLUSIVE_LOCKS_REQUIRED(mu_) {
+  // Unassigns the most loaded workers first.
+  std::vector<std::pair<int64_t, std::shared_ptr<const Task>>> candidates;
+  for (const auto& task : tasks) {
+    std::vector<std::shared_ptr<const Task>> worker_tasks;
+    TF_RETURN_IF_ERROR(
+        state_.TasksForWorker(task->worker_address, worker_tasks));
+    candidates.push_back({worker_tasks.size(), task});
+  }
+  std::sort(candidates.begin(), candidates.end(),
+            [](const auto& a, const auto& b) {
+              if (a.first != b.first) {
+                return a.first > b.first;
+              }
+              return a.second->worker_address < b.second->worker_address;
+            });
+  num_workers = std::min<int64_t>(num_workers, candidates.size());
+  for (int64_t i = 0; i < num_workers; ++i) {
+    const std::shared_ptr<const Task>& task = candidates[i].second;
+    Update update;
+    update.mutable_remove_task()->set_task_id(task->task_id);
+    TF_RETURN_IF_ERROR(Apply(update));
+    Status auto_scaler_status = auto_scaler_.RemoveWorker(
+        iteration->iteration_id, task->worker_address);
+    if (!auto_scaler_status.ok()) {
+      VLOG(1) << "Failed to remove worker with address "
+              << task->worker_address << " for Iteration "
+              << iteration->iteration_id
+              << " from tf.data service AutoScaler: " << auto_scaler_status;
+    }
+    VLOG(1) << "Unassigned worker " << task->worker_address
+            << " from iteration " << iteration->iteration_id
+            << " by removing task " << task->task_id;
+  }
+  return absl::OkStatus();
+}
+
 bool DataServiceDispatcherImpl::ShouldGcIteration(const Iteration& iteration,
                                                   int64_t now_us) const {
   if (iteration.job->processing_mode.sharding_policy() ==
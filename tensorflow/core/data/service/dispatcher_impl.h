@@ -196,6 +196,15 @@ class DataServiceDispatcherImpl {
   // A thread which periodically checks for iterations to clean up, clients to
   // release, workers to consider missing, and snapshot streams to reassign.
   void MaintenanceThread();
+  // Restores the latest dispatcher state snapshot, if any, and stores the
+  // sequence number of the first journal file to replay after it in
+  // `journal_sequence_number`.
+  Status RestoreJournalSnapshot(int64_t& journal_sequence_number)
+      TF_EXCLUSIVE_LOCKS_REQUIRED(mu_);
+  // If enough updates have been journaled since the last snapshot, writes a
+  // snapshot of the dispatcher state and deletes the journal files and the
+  // snapshots that precede it.
+  Status MaybeSnapshotJournal() TF_LOCKS_EXCLUDED(mu_);
 
   // Restores split providers from the state in `iteration` and stores them in
   // `restored`.
@@ -332,6 +341,28 @@ class DataServiceDispatcherImpl {
   // Checks for workers that haven't heartbeated recently and alerts the
   // snapshot managers.
   void DetectMissingWorkers() TF_EXCLUSIVE_LOCKS_REQUIRED(mu_);
+  // Returns true if the workers of `iteration` are assigned according to the
+  // AutoScaler estimate of the number of workers that it needs.
+  bool ShouldAutoscaleWorkerAssignment(
+      const DispatcherState::Iteration& iteration) const;
+  // Assigns workers to, or unassigns workers from, the iterations for which
+  // `ShouldAutoscaleWorkerAssignment` is true, so that they have the number of
+  // workers decided by `worker_assignment_scaler_`.
+  Status UpdateWorkerAssignments() TF_EXCLUSIVE_LOCKS_REQUIRED(mu_);
+  // Creates tasks for `iteration` on the `num_workers` least loaded of
+  // `workers` that don't have one of its active `tasks`.
+  Status AssignWorkers(
+      const std::shared_ptr<const DispatcherState::Iteration>& iteration,
+      const std::vector<std::shared_ptr<const DispatcherState::Task>>& tasks,
+      const std::vector<std::shared_ptr<const DispatcherState::Worker>>&
+          workers,
+      int64_t num_workers) TF_EXCLUSIVE_LOCKS_REQUIRED(mu_);
+  // Removes `num_workers` of the active `tasks` of `iteration`, starting with
+  // those on the most loaded workers.
+  Status UnassignWorkers(
+      const std::shared_ptr<const DispatcherState::Iteration>& iteration,
+      const std::vector<std::shared_ptr<const DispatcherState::Task>>& tasks,
+      int64_t num_workers) TF_EXCLUSIVE_LOCKS_REQUIRED(mu_);
   // Scans for old iterations and marks them as finished.
   Status GcOldIterations() TF_EXCLUSIVE_LOCKS_REQUIRED(mu_);
   // Returns true if an iteration should be garbage collected.
@@ -391,11 +422,18 @@ class DataServiceDispatcherImpl {
 
   std::optional<std::unique_ptr<JournalWriter>> journal_writer_
       TF_GUARDED_BY(mu_);
+  // The number of updates in the journal files after the latest snapshot.
+  int64_t journal_updates_since_snapshot_ TF_GUARDED_BY(mu_) = 0;
   DispatcherState state_ TF_GUARDED_BY(mu_);
   // Condition variable for waking up the gc thread.
   condition_variable maintenance_thread_cv_;
   std::unique_ptr<Thread> maintenance_thread_;
   MultipleIterationsAutoScaler auto_scaler_;
+  WorkerAssignmentScaler worker_assignment_scaler_ TF_GUARDED_BY(mu_);
+  // The number of workers last decided for each iteration whose worker
+  // assignment is autoscaled.
+  absl::flat_hash_map<int64_t, int64_t> worker_assignment_targets_
+      TF_GUARDED_BY(mu_);
 
   DataServiceDispatcherImpl(const DataServiceDispatcherImpl&) = delete;
   void operator=(const DataServiceDispatcherImpl&) = delete;
@@ -17,6 +17,7 @@ limitations under the License.
 #include <algorithm>
 #include <memory>
 #include <optional>
+#include <queue>
 #include <string>
 #include <vector>
 
@@ -33,6 +34,26 @@ limitations under the License.
 
 namespace tensorflow {
 namespace data {
+namespace {
+
+TaskSnapshot ExportTask(const DispatcherState::Task& task) {
+  TaskSnapshot snapshot;
+  CreateTaskUpdate* create_task = snapshot.mutable_create_task();
+  create_task->set_task_id(task.task_id);
+  create_task->set_iteration_id(task.iteration->iteration_id);
+  create_task->set_worker_address(task.worker_address);
+  *create_task->mutable_transfer_servers() = {task.transfer_servers.begin(),
+                                              task.transfer_servers.end()};
+  *create_task->mutable_worker_tags() = {task.worker_tags.begin(),
+                                         task.worker_tags.end()};
+  create_task->set_worker_uid(task.worker_uid);
+  snapshot.set_starting_round(task.starting_round);
+  snapshot.set_finished(task.finished);
+  snapshot.set_removed(task.removed);
+  return snapshot;
+}
+
+}  // namespace
 
 DispatcherState::DispatcherState()
     : worker_index_resolver_(std::vector<std::string>{}) {}
@@ -110,6 +131,7 @@ void DispatcherState::RegisterWorker(
   std::string address = register_worker.worker_address();
   DCHECK(!workers_.contains(address));
   workers_[address] = std::make_shared<Worker>(register_worker);
+  registered_worker_addresses_.push_back(address);
   tasks_by_worker_[address] =
       absl::flat_hash_map<int64_t, std::shared_ptr<Task>>();
   worker_index_resolver_.AddWorker(address);
@@ -493,5 +515,221 @@ std::optional<bool> DispatcherState::CompressionDisabledAtRuntime(
   return std::nullopt;
 }
 
+DispatcherStateSnapshot DispatcherState::ExportSnapshot() const {
+  DispatcherStateSnapshot snapshot;
+  for (const auto& [dataset_id, dataset] : datasets_by_id_) {
+    RegisterDatasetUpdate* register_dataset = snapshot.add_datasets();
+    register_dataset->set_dataset_id(dataset_id);
+    *register_dataset->mutable_metadata() = dataset->metadata;
+  }
+  for (const std::string& address : registered_worker_addresses_) {
+    const Worker& worker = *workers_.at(address);
+    RegisterWorkerUpdate* register_worker = snapshot.add_workers();
+    register_worker->set_worker_address(worker.address);
+    *register_worker->mutable_transfer_servers() = {
+        worker.transfer_servers.begin(), worker.transfer_servers.end()};
+    *register_worker->mutable_worker_tags() = {worker.tags.begin(),
+                                               worker.tags.end()};
+    register_worker->set_worker_uid(worker.uid);
+  }
+  for (const auto& [job_id, job] : jobs_by_id_) {
+    CreateJobUpdate* create_job = snapshot.add_jobs();
+    create_job->set_job_id(job_id);
+    create_job->set_job_name(job->job_name);
+    create_job->set_dataset_id(job->dataset_id);
+    *create_job->mutable_processing_mode_def() = job->processing_mode;
+    if (job->num_consumers.has_value()) {
+      create_job->set_num_consumers(*job->num_consumers);
+    }
+    create_job->set_target_workers(job->target_workers);
+    create_job->set_use_cross_trainer_cache(job->use_cross_trainer_cache);
+  }
+
+  // Iterations are exported in the order of their ids, so that restoring them
+  // maps each iteration key to its latest iteration.
+  std::vector<std::shared_ptr<Iteration>> iterations;
+  iterations.reserve(iterations_.size());
+  for (const auto& [iteration_id, iteration] : iterations_) {
+    iterations.push_back(iteration);
+  }
+  std::sort(iterations.begin(), iterations.end(),
+            [](const auto& lhs, const auto& rhs) {
+              return lhs->iteration_id < rhs->iteration_id;
+            });
+  for (const std::shared_ptr<Iteration>& iteration : iterations) {
+    IterationSnapshot* iteration_snapshot = snapshot.add_iterations();
+    CreateIterationUpdate* create_iteration =
+        iteration_snapshot->mutable_create_iteration();
+    create_iteration->set_iteration_id(iteration->iteration_id);
+    create_iteration->set_job_id(iteration->job->id);
+    create_iteration->set_repetition(iteration->iteration_key.repetition);
+    if (iteration->distributed_epoch_state.has_value()) {
+      const DistributedEpochState& state = *iteration->distributed_epoch_state;
+      create_iteration->set_num_split_providers(state.repetitions.size());
+      *iteration_snapshot->mutable_split_provider_repetitions() = {
+          state.repetitions.begin(), state.repetitions.end()};
+      *iteration_snapshot->mutable_split_provider_indices() = {
+          state.indices.begin(), state.indices.end()};
+    }
+    iteration_snapshot->set_last_client_released_micros(
+        iteration->last_client_released_micros);
+    iteration_snapshot->set_finished(iteration->finished);
+    iteration_snapshot->set_garbage_collected(iteration->garbage_collected);
+    for (const std::shared_ptr<Task>& task :
+         tasks_by_iteration_.at(iteration->iteration_id)) {
+      *iteration_snapshot->add_tasks() = ExportTask(*task);
+    }
+    std::queue<PendingTask> pending_tasks = iteration->pending_tasks;
+    for (; !pending_tasks.empty(); pending_tasks.pop()) {
+      const PendingTask& pending_task = pending_tasks.front();
+      PendingTaskSnapshot* pending_task_snapshot =
+          iteration_snapshot->add_pending_tasks();
+      *pending_task_snapshot->mutable_task() = ExportTask(*pending_task.task);
+      pending_task_snapshot->set_target_round(pending_task.target_round);
+      *pending_task_snapshot->mutable_ready_consumers() = {
+          pending_task.ready_consumers.begin(),
+          pending_task.ready_consumers.end()};
+      pending_task_snapshot->set_failures(pending_task.failures);
+    }
+  }
+
+  for (const auto& [iteration_client_id, iteration] :
+       iterations_for_client_ids_) {
+    // `IterationForIterationClientId` may leave null entries behind.
+    if (iteration == nullptr) {
+      continue;
+    }
+    AcquireIterationClientUpdate* acquire_iteration_client =
+        snapshot.add_iteration_clients();
+    acquire_iteration_client->set_iteration_id(iteration->iteration_id);
+    acquire_iteration_client->set_iteration_client_id(iteration_client_id);
+  }
+  *snapshot.mutable_snapshot_paths() = {snapshot_paths_.begin(),
+                                        snapshot_paths_.end()};
+  for (const auto& [dataset_id, compression_disabled] :
+       compression_disabled_at_runtime_) {
+    CompressionDisabledAtRuntimeUpdate* update =
+        snapshot.add_compression_disabled_at_runtime();
+    update->set_dataset_id(dataset_id);
+    update->set_compression_disabled(compression_disabled);
+  }
+  snapshot.set_next_available_job_id(next_available_job_id_);
+  snapshot.set_next_available_iteration_id(next_available_iteration_id_);
+  snapshot.set_next_available_iteration_client_id(
+      next_available_iteration_client_id_);
+  snapshot.set_next_available_task_id(next_available_task_id_);
+  return snapshot;
+}
+
+Status DispatcherState::RestoreSnapshot(
+    const DispatcherStateSnapshot& snapshot) {
+  if (!datasets_by_id_.empty() || !workers_.empty() || !jobs_by_id_.empty()) {
+    return errors::FailedPrecondition(
+        "The dispatcher state can only be restored from a snapshot before any "
+        "update is applied.");
+  }
+  for (const RegisterDatasetUpdate& register_dataset : snapshot.datasets()) {
+    RegisterDataset(register_dataset);
+  }
+  for (const RegisterWorkerUpdate& register_worker : snapshot.workers()) {
+    RegisterWorker(register_worker);
+  }
+  for (const CreateJobUpdate& create_job : snapshot.jobs()) {
+    CreateJob(create_job);
+  }
+  for (const IterationSnapshot& iteration_snapshot : snapshot.iterations()) {
+    const CreateIterationUpdate& create_iteration =
+        iteration_snapshot.create_iteration();
+    if (!jobs_by_id_.contains(create_iteration.job_id())) {
+      return errors::DataLoss("Iteration ", create_iteration.iteration_id(),
+                              " refers to unknown job ",
+                              create_iteration.job_id());
+    }
+    CreateIteration(create_iteration);
+    std::shared_ptr<Iteration> iteration =
+        iterations_[create_iteration.iteration_id()];
+    if (iteration->distributed_epoch_state.has_value()) {
+      DistributedEpochState& state = *iteration->distributed_epoch_state;
+      if (iteration_snapshot.split_provider_repetitions_size() !=
+              state.repetitions.size() ||
+          iteration_snapshot.split_provider_indices_size() !=
+              state.indices.size()) {
+        return errors::DataLoss("Bad split provider state for iteration ",
+                                iteration->iteration_id);
+      }
+      state.repetitions.assign(
+          iteration_snapshot.split_provider_repetitions().begin(),
+          iteration_snapshot.split_provider_repetitions().end());
+      state.indices.assign(iteration_snapshot.split_provider_indices().begin(),
+                           iteration_snapshot.split_provider_indices().end());
+    }
+    iteration->last_client_released_micros =
+        iteration_snapshot.last_client_released_micros();
+    iteration->finished = iteration_snapshot.finished();
+    iteration->garbage_collected = iteration_snapshot.garbage_collected();
+    for (const TaskSnapshot& task_snapshot : iteration_snapshot.tasks()) {
+      tasks_by_iteration_[iteration->iteration_id].push_back(
+          RestoreTask(task_snapshot, iteration));
+    }
+    for (const PendingTaskSnapshot& pending_task_snapshot :
+         iteration_snapshot.pending_tasks()) {
+      iteration->pending_tasks.emplace(
+          RestoreTask(pending_task_snapshot.task(), iteration),
+          pending_task_snapshot.target_round());
+      PendingTask& pending_task = iteration->pending_tasks.back();
+      pending_task.ready_consumers.insert(
+          pending_task_snapshot.ready_consumers().begin(),
+          pending_task_snapshot.ready_consumers().end());
+      pending_task.failures = pending_task_snapshot.failures();
+    }
+  }
+  for (const AcquireIterationClientUpdate& acquire_iteration_client :
+       snapshot.iteration_clients()) {
+    if (!iterations_.contains(acquire_iteration_client.iteration_id())) {
+      return errors::DataLoss(
+          "Iteration client ", acquire_iteration_client.iteration_client_id(),
+          " refers to unknown iteration ",
+          acquire_iteration_client.iteration_id());
+    }
+    AcquireIterationClient(acquire_iteration_client);
+  }
+  snapshot_paths_.insert(snapshot.snapshot_paths().begin(),
+                         snapshot.snapshot_paths().end());
+  for (const CompressionDisabledAtRuntimeUpdate& update :
+       snapshot.compression_disabled_at_runtime()) {
+    CompressionDisabledAtRuntime(update);
+  }
+  next_available_job_id_ =
+      std::max(next_available_job_id_, snapshot.next_available_job_id());
+  next_available_iteration_id_ = std::max(
+      next_available_iteration_id_, snapshot.next_available_iteration_id());
+  next_available_iteration_client_id_ =
+      std::max(next_available_iteration_client_id_,
+               snapshot.next_available_iteration_client_id());
+  next_available_task_id_ =
+      std::max(next_available_task_id_, snapshot.next_available_task_id());
+  return absl::OkStatus();
+}
+
+std::shared_ptr<DispatcherState::Task> DispatcherState::RestoreTask(
+    const TaskSnapshot& snapshot, const std::shared_ptr<Iteration>& iteration) {
+  auto task = std::make_shared<Task>(snapshot.create_task(), iteration);
+  task->starting_round = snapshot.starting_round();
+  task->finished = snapshot.finished();
+  task->removed = snapshot.removed();
+  // Finished and removed tasks are no longer assigned to their workers, and
+  // removed tasks can no longer be looked up.
+  TasksById& worker_tasks = tasks_by_worker_[task->worker_address];
+  if (!task->removed) {
+    tasks_[task->task_id] = task;
+    if (!task->finished) {
+      worker_tasks[task->task_id] = task;
+    }
+  }
+  next_available_task_id_ =
+      std::max(next_available_task_id_, task->task_id + 1);
+  return task;
+}
+
 }  // namespace data
 }  // namespace tensorflow
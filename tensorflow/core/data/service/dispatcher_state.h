@@ -305,6 +305,14 @@ class DispatcherState {
   // Returns the current number of registered workers.
   int64_t GetNumberOfRegisteredWorkers() const { return workers_.size(); }
 
+  // Returns a snapshot from which `RestoreSnapshot` recreates the current
+  // state. The snapshot's `journal_sequence_number` is left unset.
+  DispatcherStateSnapshot ExportSnapshot() const;
+
+  // Restores the state from `snapshot`. Must be called before any update is
+  // applied.
+  Status RestoreSnapshot(const DispatcherStateSnapshot& snapshot);
+
  private:
   void RegisterDataset(const RegisterDatasetUpdate& register_dataset);
   void RegisterWorker(const RegisterWorkerUpdate& register_worker);
@@ -325,6 +333,10 @@ class DispatcherState {
   void Snapshot(const SnapshotUpdate& snapshot);
   void CompressionDisabledAtRuntime(const CompressionDisabledAtRuntimeUpdate&
                                         compression_disabled_at_runtime);
+  // Restores a task of `iteration` from `snapshot`.
+  std::shared_ptr<Task> RestoreTask(
+      const TaskSnapshot& snapshot,
+      const std::shared_ptr<Iteration>& iteration);
 
   // Updates the next available dataset ID.
   void UpdateNextAvailableDatasetId();
@@ -335,6 +347,10 @@ class DispatcherState {
 
   // Registered workers, keyed by address.
   absl::flat_hash_map<std::string, std::shared_ptr<Worker>> workers_;
+  // Addresses of the registered workers, in the order in which they
+  // registered. The order determines the worker indices for
+  // `worker_index_resolver_`.
+  std::vector<std::string> registered_worker_addresses_;
 
   // Assigns an index to each worker according to worker addresses list
   // specified in the dispatcher config.
@@ -44,6 +44,7 @@ using ::testing::HasSubstr;
 using ::testing::IsEmpty;
 using ::testing::SizeIs;
 using ::testing::UnorderedElementsAre;
+using ::tsl::testing::IsOkAndHolds;
 using ::tsl::testing::StatusIs;
 
 Status RegisterDataset(const std::string& dataset_id, DispatcherState& state) {
@@ -652,5 +653,79 @@ TEST(DispatcherState, GetNumberOfRegisteredWorkers) {
   EXPECT_EQ(state.GetNumberOfRegisteredWorkers(), 2);
 }
 
+TEST(DispatcherState, RestoreSnapshot) {
+  experimental::DispatcherConfig config;
+  config.add_worker_addresses("localhost:%port%");
+  config.add_worker_addresses("localhost:%port%");
+  DispatcherState state(config);
+  TF_ASSERT_OK(RegisterDataset("dataset_id", state));
+  TF_ASSERT_OK(RegisterWorker("localhost:20000", state));
+  TF_ASSERT_OK(RegisterWorker("localhost:10000", state));
+  TF_ASSERT_OK(CreateIteration(/*iteration_id=*/3, "dataset_id", state));
+  TF_ASSERT_OK(CreateTask(/*task_id=*/8, /*iteration_id=*/3, "localhost:20000",
+                          state));
+  TF_ASSERT_OK(CreateTask(/*task_id=*/9, /*iteration_id=*/3, "localhost:10000",
+                          state));
+  TF_ASSERT_OK(FinishTask(/*task_id=*/8, state));
+  TF_ASSERT_OK(AcquireIterationClientId(/*iteration_id=*/3,
+                                        /*iteration_client_id=*/6, state));
+  TF_ASSERT_OK(AcquireIterationClientId(/*iteration_id=*/3,
+                                        /*iteration_client_id=*/7, state));
+  TF_ASSERT_OK(ReleaseIterationClientId(/*iteration_client_id=*/7,
+                                        /*release_time=*/100, state));
+  TF_ASSERT_OK(Snapshot("snapshot_path", state));
+  DispatcherStateSnapshot snapshot = state.ExportSnapshot();
+
+  DispatcherState restored(config);
+  TF_ASSERT_OK(restored.RestoreSnapshot(snapshot));
+  EXPECT_EQ(restored.NextAvailableDatasetId(), state.NextAvailableDatasetId());
+  EXPECT_EQ(restored.NextAvailableJobId(), state.NextAvailableJobId());
+  EXPECT_EQ(restored.NextAvailableIterationId(),
+            state.NextAvailableIterationId());
+  EXPECT_EQ(restored.NextAvailableIterationClientId(), 8);
+  EXPECT_EQ(restored.NextAvailableTaskId(), 10);
+  EXPECT_THAT(restored.GetWorkerIndex("localhost:20000"), IsOkAndHolds(0));
+  EXPECT_THAT(restored.GetWorkerIndex("localhost:10000"), IsOkAndHolds(1));
+  std::shared_ptr<const Dataset> dataset;
+  TF_EXPECT_OK(restored.DatasetFromId("dataset_id", dataset));
+
+  std::shared_ptr<const Iteration> iteration;
+  TF_ASSERT_OK(restored.IterationFromId(3, iteration));
+  EXPECT_EQ(iteration->num_clients, 1);
+  EXPECT_EQ(iteration->last_client_released_micros, 100);
+  EXPECT_FALSE(iteration->finished);
+  std::shared_ptr<const Iteration> client_iteration;
+  TF_ASSERT_OK(restored.IterationForIterationClientId(6, client_iteration));
+  EXPECT_EQ(client_iteration, iteration);
+  EXPECT_THAT(restored.ListActiveClientIds(), UnorderedElementsAre(6));
+
+  std::vector<std::shared_ptr<const Task>> tasks;
+  TF_ASSERT_OK(restored.TasksForIteration(3, tasks));
+  ASSERT_THAT(tasks, SizeIs(2));
+  EXPECT_EQ(tasks[0]->task_id, 8);
+  EXPECT_TRUE(tasks[0]->finished);
+  EXPECT_EQ(tasks[1]->task_id, 9);
+  EXPECT_FALSE(tasks[1]->finished);
+  TF_ASSERT_OK(restored.TasksForWorker("localhost:20000", tasks));
+  EXPECT_THAT(tasks, IsEmpty());
+  TF_ASSERT_OK(restored.TasksForWorker("localhost:10000", tasks));
+  ASSERT_THAT(tasks, SizeIs(1));
+  EXPECT_EQ(tasks[0]->task_id, 9);
+  EXPECT_THAT(restored.ListSnapshotPaths(),
+              UnorderedElementsAre("snapshot_path"));
+
+  // Updates apply to the restored state as to the original one.
+  TF_ASSERT_OK(FinishTask(/*task_id=*/9, restored));
+  TF_ASSERT_OK(restored.IterationFromId(3, iteration));
+  EXPECT_TRUE(iteration->finished);
+}
+
+TEST(DispatcherState, RestoreSnapshotIntoNonEmptyState) {
+  DispatcherState state;
+  TF_ASSERT_OK(RegisterDataset("dataset_id", state));
+  EXPECT_THAT(state.RestoreSnapshot(DispatcherStateSnapshot()),
+              StatusIs(error::FAILED_PRECONDITION));
+}
+
 }  // namespace data
 }  // namespace tensorflow
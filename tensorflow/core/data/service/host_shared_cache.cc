@@ -0,0 +1,221 @@
+/* Copyright 2024 The TensorFlow Authors. All Rights Reserved.
+
+Licensed under the Apache License, Version 2.0 (the "License");
+you may not use this file except in compliance with the License.
+You may obtain a copy of the License at
+
+    http://www.apache.org/licenses/LICENSE-2.0
+
+Unless required by applicable law or agreed to in writing, software
+distributed under the License is distributed on an "AS IS" BASIS,
+WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+See the License for the specific language governing permissions and
+limitations under the License.
+==============================================================================*/
+#include "tensorflow/core/data/service/host_shared_cache.h"
+
+#include <algorithm>
+#include <cstddef>
+#include <cstdint>
+#include <memory>
+#include <optional>
+#include <string>
+#include <utility>
+#include <vector>
+
+#include "absl/status/status.h"
+#include "absl/strings/numbers.h"
+#include "absl/strings/str_cat.h"
+#include "absl/strings/string_view.h"
+#include "absl/strings/strip.h"
+#include "tensorflow/core/data/mapped_cache_file.h"
+#include "tensorflow/core/data/service/cross_trainer_cache.h"
+#include "tensorflow/core/data/service/data_transfer.h"
+#include "tensorflow/core/framework/dataset.pb.h"
+#include "tensorflow/core/lib/gtl/cleanup.h"
+#include "tensorflow/core/lib/strings/proto_serialization.h"
+#include "tensorflow/core/platform/env.h"
+#include "tensorflow/core/platform/errors.h"
+#include "tensorflow/core/platform/fingerprint.h"
+#include "tensorflow/core/platform/logging.h"
+#include "tensorflow/core/platform/mutex.h"
+#include "tensorflow/core/platform/path.h"
+#include "tensorflow/core/platform/status.h"
+#include "tensorflow/core/platform/statusor.h"
+
+namespace tensorflow {
+namespace data {
+namespace {
+
+constexpr char kElementFilePrefix[] = "element_";
+constexpr char kClaimDirectoryPrefix[] = "claim_";
+// How often to check whether a claimed element has been published.
+constexpr int64_t kPollIntervalUs = 1000;  // 1ms.
+// How long a worker may take to produce a claimed element before other
+// workers assume it has failed.
+constexpr int64_t kClaimTimeoutNs = int64_t{60} * 1000 * 1000 * 1000;  // 1min.
+
+}  // namespace
+
+std::string HostSharedCacheDirectory(const std::string& shared_dir,
+                                     const DatasetDef& dataset_def) {
+  std::string serialized_graph;
+  SerializeToStringDeterministic(dataset_def.graph(), &serialized_graph);
+  const uint64_t fingerprint = Fingerprint64(serialized_graph);
+  return io::JoinPath(
+      shared_dir, absl::StrCat("cross_trainer_cache_",
+                               absl::Hex(fingerprint, absl::kZeroPad16)));
+}
+
+HostSharedCache::HostSharedCache(
+    std::string directory, size_t max_size_bytes,
+    std::unique_ptr<CachableSequence<GetElementResult>> sequence, Env* env)
+    : directory_(std::move(directory)),
+      max_size_bytes_(max_size_bytes),
+      sequence_(std::move(sequence)),
+      env_(env) {}
+
+StatusOr<GetElementResult> HostSharedCache::GetNext() {
+  mutex_lock l(mu_);
+  if (!initialized_) {
+    TF_RETURN_IF_ERROR(env_->RecursivelyCreateDir(directory_));
+    int64_t oldest, newest;
+    TF_RETURN_IF_ERROR(PublishedRange(oldest, newest));
+    next_index_ = std::max<int64_t>(oldest, 0);
+    initialized_ = true;
+    VLOG(2) << "Reading the host-shared cross-trainer cache in " << directory_
+            << " from element " << next_index_ << ".";
+  }
+
+  while (true) {
+    const int64_t index = next_index_;
+    TF_ASSIGN_OR_RETURN(std::optional<GetElementResult> element,
+                        ReadElement(index));
+    if (!element.has_value()) {
+      Status claim = env_->CreateDir(ClaimDirectory(index));
+      if (absl::IsAlreadyExists(claim)) {
+        // Another worker is producing the element.
+        if (ClaimExpired(index)) {
+          LOG(WARNING) << "Timed out waiting for element " << index
+                       << " of the host-shared cross-trainer cache in "
+                       << directory_ << ". Producing it instead.";
+          env_->DeleteDir(ClaimDirectory(index)).IgnoreError();
+        } else {
+          env_->SleepForMicroseconds(kPollIntervalUs);
+        }
+        continue;
+      }
+      TF_RETURN_IF_ERROR(claim);
+      int64_t oldest, newest;
+      TF_RETURN_IF_ERROR(PublishedRange(oldest, newest));
+      if (newest > index) {
+        // The element has already fallen out of the window.
+        env_->DeleteDir(ClaimDirectory(index)).IgnoreError();
+        next_index_ = std::max(oldest, index + 1);
+        continue;
+      }
+      TF_ASSIGN_OR_RETURN(element, ProduceElement(index));
+    }
+    Advance(index, GetElementSizeBytes(*element));
+    next_index_ = index + 1;
+    return std::move(*element);
+  }
+}
+
+size_t HostSharedCache::GetElementSizeBytes(
+    const GetElementResult& element) const {
+  return sequence_->GetElementSizeBytes(element);
+}
+
+StatusOr<std::optional<GetElementResult>> HostSharedCache::ReadElement(
+    int64_t index) const {
+  const std::string filename = ElementFile(index);
+  if (!env_->FileExists(filename).ok()) {
+    return std::nullopt;
+  }
+  StatusOr<std::shared_ptr<const MappedCacheFile>> file =
+      MappedCacheFile::Open(env_, filename);
+  if (absl::IsNotFound(file.status())) {
+    // The element fell out of the window after the check above.
+    return std::nullopt;
+  }
+  TF_RETURN_IF_ERROR(file.status());
+  GetElementResult result;
+  TF_RETURN_IF_ERROR((*file)->Get(/*index=*/0, &result.components));
+  result.element_index = index;
+  return result;
+}
+
+StatusOr<GetElementResult> HostSharedCache::ProduceElement(int64_t index) {
+  auto release_claim = gtl::MakeCleanup(
+      [this, index] { env_->DeleteDir(ClaimDirectory(index)).IgnoreError(); });
+  TF_ASSIGN_OR_RETURN(GetElementResult element, sequence_->GetNext());
+  element.element_index = index;
+  if (element.end_of_sequence || element.skip) {
+    return element;
+  }
+  Status s = [&]() -> Status {
+    TF_ASSIGN_OR_RETURN(std::unique_ptr<MappedCacheFileWriter> writer,
+                        MappedCacheFileWriter::Create(
+                            env_, ElementFile(index),
+                            element.components.size()));
+    TF_RETURN_IF_ERROR(writer->Write(element.components));
+    return writer->Finalize();
+  }();
+  if (!s.ok()) {
+    LOG(WARNING) << "Failed to share element " << index
+                 << " of the host-shared cross-trainer cache in " << directory_
+                 << ": " << s;
+  }
+  return element;
+}
+
+bool HostSharedCache::ClaimExpired(int64_t index) const {
+  FileStatistics stats;
+  if (!env_->Stat(ClaimDirectory(index), &stats).ok()) {
+    return false;
+  }
+  return static_cast<int64_t>(env_->NowNanos()) - stats.mtime_nsec >
+         kClaimTimeoutNs;
+}
+
+Status HostSharedCache::PublishedRange(int64_t& oldest,
+                                       int64_t& newest) const {
+  std::vector<std::string> children;
+  TF_RETURN_IF_ERROR(env_->GetChildren(directory_, &children));
+  oldest = -1;
+  newest = -1;
+  for (const std::string& child : children) {
+    absl::string_view name = child;
+    int64_t index;
+    if (!absl::ConsumePrefix(&name, kElementFilePrefix) ||
+        !absl::SimpleAtoi(name, &index)) {
+      continue;
+    }
+    oldest = oldest < 0 ? index : std::min(oldest, index);
+    newest = std::max(newest, index);
+  }
+  return absl::OkStatus();
+}
+
+void HostSharedCache::Advance(int64_t index, size_t size_bytes) {
+  window_.emplace_back(index, size_bytes);
+  window_size_bytes_ += size_bytes;
+  while (window_.size() > 1 && window_size_bytes_ > max_size_bytes_) {
+    // Workers that still read the element keep their mapping of it.
+    env_->DeleteFile(ElementFile(window_.front().first)).IgnoreError();
+    window_size_bytes_ -= window_.front().second;
+    window_.pop_front();
+  }
+}
+
+std::string HostSharedCache::ElementFile(int64_t index) const {
+  return io::JoinPath(directory_, absl::StrCat(kElementFilePrefix, index));
+}
+
+std::string HostSharedCache::ClaimDirectory(int64_t index) const {
+  return io::JoinPath(directory_, absl::StrCat(kClaimDirectoryPrefix, index));
+}
+
+}  // namespace data
+}  // namespace tensorflow
@@ -0,0 +1,110 @@
+/* Copyright 2024 The TensorFlow Authors. All Rights Reserved.
+
+Licensed under the Apache License, Version 2.0 (the "License");
+you may not use this file except in compliance with the License.
+You may obtain a copy of the License at
+
+    http://www.apache.org/licenses/LICENSE-2.0
+
+Unless required by applicable law or agreed to in writing, software
+distributed under the License is distributed on an "AS IS" BASIS,
+WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+See the License for the specific language governing permissions and
+limitations under the License.
+==============================================================================*/
+#ifndef TENSORFLOW_CORE_DATA_SERVICE_HOST_SHARED_CACHE_H_
+#define TENSORFLOW_CORE_DATA_SERVICE_HOST_SHARED_CACHE_H_
+
+#include <cstddef>
+#include <cstdint>
+#include <deque>
+#include <memory>
+#include <optional>
+#include <string>
+#include <utility>
+
+#include "tensorflow/core/data/service/cross_trainer_cache.h"
+#include "tensorflow/core/data/service/data_transfer.h"
+#include "tensorflow/core/framework/dataset.pb.h"
+#include "tensorflow/core/platform/env.h"
+#include "tensorflow/core/platform/mutex.h"
+#include "tensorflow/core/platform/status.h"
+#include "tensorflow/core/platform/statusor.h"
+#include "tensorflow/core/platform/thread_annotations.h"
+
+namespace tensorflow {
+namespace data {
+
+// Returns the directory under `shared_dir` where the workers of a host share
+// the cross-trainer cache elements of `dataset_def`. Workers share elements
+// only if their datasets have identical graphs.
+std::string HostSharedCacheDirectory(const std::string& shared_dir,
+                                     const DatasetDef& dataset_def);
+
+// A host-wide tier under the `CrossTrainerCache` of a tf.data service worker.
+// It lets the workers of one host, e.g. those of the trials of a
+// hyperparameter sweep, share the elements of the same infinite dataset
+// instead of each producing them.
+//
+// The elements form a sequence of numbered files in `directory`, each a
+// memory-mapped `MappedCacheFile`, so the workers share the pages of the
+// elements too. `GetNext` returns the next element of the shared sequence.
+// If no worker has produced it yet, the caller claims it by creating a marker
+// directory, reads it from `sequence`, and publishes it. Other workers wait
+// for the claimed element, or produce it themselves if the claim is older
+// than a minute. The sequence is a sliding window: every worker deletes the
+// files that fall out of the last `max_size_bytes` of elements it has read,
+// and a worker that falls behind skips to the oldest element that remains.
+//
+// `directory` should be on a local file system where creating a directory is
+// atomic, e.g. under /dev/shm. Failing to publish an element is not an error;
+// the element is still returned to the caller.
+class HostSharedCache : public CachableSequence<GetElementResult> {
+ public:
+  HostSharedCache(std::string directory, size_t max_size_bytes,
+                  std::unique_ptr<CachableSequence<GetElementResult>> sequence,
+                  Env* env = Env::Default());
+
+  StatusOr<GetElementResult> GetNext() override;
+  size_t GetElementSizeBytes(const GetElementResult& element) const override;
+
+ private:
+  // Returns the element at `index` if it has been published, and nullopt if
+  // it has not.
+  StatusOr<std::optional<GetElementResult>> ReadElement(int64_t index) const;
+  // Produces the element at `index` and publishes it.
+  StatusOr<GetElementResult> ProduceElement(int64_t index);
+  // Returns true if the claim on the element at `index` has expired.
+  bool ClaimExpired(int64_t index) const;
+  // Returns the smallest and largest indices of the published elements, or
+  // -1 if there are none.
+  Status PublishedRange(int64_t& oldest, int64_t& newest) const;
+  // Adds the element at `index` to the window and deletes the elements that
+  // fall out of it.
+  void Advance(int64_t index, size_t size_bytes)
+      TF_EXCLUSIVE_LOCKS_REQUIRED(mu_);
+
+  std::string ElementFile(int64_t index) const;
+  std::string ClaimDirectory(int64_t index) const;
+
+  const std::string directory_;
+  const size_t max_size_bytes_;
+  const std::unique_ptr<CachableSequence<GetElementResult>> sequence_;
+  Env* const env_;
+
+  mutex mu_;
+  bool initialized_ TF_GUARDED_BY(mu_) = false;
+  int64_t next_index_ TF_GUARDED_BY(mu_) = 0;
+  // The indices and sizes of the elements read by this worker that are still
+  // in the window.
+  std::deque<std::pair<int64_t, size_t>> window_ TF_GUARDED_BY(mu_);
+  size_t window_size_bytes_ TF_GUARDED_BY(mu_) = 0;
+
+  HostSharedCache(const HostSharedCache&) = delete;
+  void operator=(const HostSharedCache&) = delete;
+};
+
+}  // namespace data
+}  // namespace tensorflow
+
+#endif  // TENSORFLOW_CORE_DATA_SERVICE_HOST_SHARED_CACHE_H_
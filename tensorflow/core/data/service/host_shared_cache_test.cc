@@ -0,0 +1,159 @@
+/* Copyright 2024 The TensorFlow Authors. All Rights Reserved.
+
+Licensed under the Apache License, Version 2.0 (the "License");
+you may not use this file except in compliance with the License.
+You may obtain a copy of the License at
+
+    http://www.apache.org/licenses/LICENSE-2.0
+
+Unless required by applicable law or agreed to in writing, software
+distributed under the License is distributed on an "AS IS" BASIS,
+WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+See the License for the specific language governing permissions and
+limitations under the License.
+==============================================================================*/
+#include "tensorflow/core/data/service/host_shared_cache.h"
+
+#include <cstddef>
+#include <cstdint>
+#include <memory>
+#include <string>
+#include <vector>
+
+#include "tensorflow/core/data/service/cross_trainer_cache.h"
+#include "tensorflow/core/data/service/data_transfer.h"
+#include "tensorflow/core/framework/dataset.pb.h"
+#include "tensorflow/core/framework/tensor.h"
+#include "tensorflow/core/framework/tensor_testutil.h"
+#include "tensorflow/core/lib/core/status_test_util.h"
+#include "tensorflow/core/platform/env.h"
+#include "tensorflow/core/platform/statusor.h"
+#include "tensorflow/core/platform/test.h"
+
+namespace tensorflow {
+namespace data {
+namespace {
+
+constexpr size_t kElementSizeBytes = 8;
+constexpr size_t kLargeWindow = 1 << 20;
+
+// Produces `start`, `start + 1`, ..., and counts the elements it produces.
+class RangeSequence : public CachableSequence<GetElementResult> {
+ public:
+  RangeSequence(int64_t start, int64_t& num_produced)
+      : next_(start), num_produced_(num_produced) {}
+
+  StatusOr<GetElementResult> GetNext() override {
+    GetElementResult result;
+    result.components.push_back(Tensor(next_++));
+    ++num_produced_;
+    return result;
+  }
+
+  size_t GetElementSizeBytes(const GetElementResult&) const override {
+    return kElementSizeBytes;
+  }
+
+ private:
+  int64_t next_;
+  int64_t& num_produced_;
+};
+
+std::string NewSharedDir() {
+  std::string dir = testing::TmpDir();
+  CHECK(Env::Default()->CreateUniqueFileName(&dir, "host_shared_cache"));
+  return dir;
+}
+
+std::unique_ptr<HostSharedCache> MakeCache(const std::string& dir,
+                                           size_t window_size_bytes,
+                                           int64_t start,
+                                           int64_t& num_produced) {
+  return std::make_unique<HostSharedCache>(
+      dir, window_size_bytes,
+      std::make_unique<RangeSequence>(start, num_produced));
+}
+
+void ExpectNext(HostSharedCache& cache, int64_t expected) {
+  TF_ASSERT_OK_AND_ASSIGN(GetElementResult result, cache.GetNext());
+  ASSERT_EQ(result.components.size(), 1);
+  test::ExpectEqual(result.components[0], Tensor(expected));
+}
+
+int64_t NumElementFiles(const std::string& dir) {
+  std::vector<std::string> children;
+  TF_CHECK_OK(Env::Default()->GetChildren(dir, &children));
+  int64_t num_files = 0;
+  for (const std::string& child : children) {
+    if (child.find("element_") == 0) ++num_files;
+  }
+  return num_files;
+}
+
+TEST(HostSharedCacheTest, SharesElements) {
+  const std::string dir = NewSharedDir();
+  int64_t num_produced_a = 0, num_produced_b = 0;
+  auto cache_a = MakeCache(dir, kLargeWindow, /*start=*/0, num_produced_a);
+  auto cache_b = MakeCache(dir, kLargeWindow, /*start=*/100, num_produced_b);
+
+  for (int64_t i = 0; i < 3; ++i) {
+    ExpectNext(*cache_a, i);
+  }
+  for (int64_t i = 0; i < 3; ++i) {
+    ExpectNext(*cache_b, i);
+  }
+  // Whichever worker reaches an element first produces it.
+  ExpectNext(*cache_b, 100);
+  ExpectNext(*cache_a, 100);
+  EXPECT_EQ(num_produced_a, 3);
+  EXPECT_EQ(num_produced_b, 1);
+}
+
+TEST(HostSharedCacheTest, SlidingWindow) {
+  const std::string dir = NewSharedDir();
+  int64_t num_produced_a = 0, num_produced_b = 0;
+  auto cache_a =
+      MakeCache(dir, 2 * kElementSizeBytes, /*start=*/0, num_produced_a);
+  for (int64_t i = 0; i < 5; ++i) {
+    ExpectNext(*cache_a, i);
+  }
+  EXPECT_EQ(NumElementFiles(dir), 2);
+
+  // A new worker starts from the oldest element in the window.
+  auto cache_b =
+      MakeCache(dir, 2 * kElementSizeBytes, /*start=*/100, num_produced_b);
+  ExpectNext(*cache_b, 3);
+  ExpectNext(*cache_b, 4);
+  EXPECT_EQ(num_produced_b, 0);
+}
+
+TEST(HostSharedCacheTest, SlowWorkerSkipsAhead) {
+  const std::string dir = NewSharedDir();
+  int64_t num_produced_a = 0, num_produced_b = 0;
+  auto cache_a =
+      MakeCache(dir, 2 * kElementSizeBytes, /*start=*/0, num_produced_a);
+  auto cache_b =
+      MakeCache(dir, 2 * kElementSizeBytes, /*start=*/100, num_produced_b);
+  ExpectNext(*cache_a, 0);
+  ExpectNext(*cache_b, 0);
+  for (int64_t i = 1; i < 10; ++i) {
+    ExpectNext(*cache_a, i);
+  }
+  ExpectNext(*cache_b, 8);
+  ExpectNext(*cache_b, 9);
+  EXPECT_EQ(num_produced_b, 0);
+}
+
+TEST(HostSharedCacheTest, DirectoryDependsOnDataset) {
+  DatasetDef dataset_a, dataset_b;
+  dataset_a.mutable_graph()->add_node()->set_name("a");
+  dataset_b.mutable_graph()->add_node()->set_name("b");
+  EXPECT_EQ(HostSharedCacheDirectory("/dev/shm", dataset_a),
+            HostSharedCacheDirectory("/dev/shm", dataset_a));
+  EXPECT_NE(HostSharedCacheDirectory("/dev/shm", dataset_a),
+            HostSharedCacheDirectory("/dev/shm", dataset_b));
+}
+
+}  // namespace
+}  // namespace data
+}  // namespace tensorflow
@@ -14,6 +14,7 @@ limitations under the License.
 ==============================================================================*/
 #include "tensorflow/core/data/service/journal.h"
 
+#include <cstdint>
 #include <memory>
 #include <string>
 #include <vector>
@@ -25,6 +26,7 @@ limitations under the License.
 #include "tensorflow/core/lib/core/status_test_util.h"
 #include "tensorflow/core/platform/errors.h"
 #include "tensorflow/core/platform/path.h"
+#include "tensorflow/core/platform/statusor.h"
 #include "tensorflow/core/platform/test.h"
 #include "tensorflow/core/protobuf/data_service.pb.h"
 
@@ -115,6 +117,45 @@ TEST(Journal, AppendExistingJournal) {
   TF_EXPECT_OK(CheckJournalContent(journal_dir, updates));
 }
 
+TEST(Journal, StartNewFileAndTruncate) {
+  std::string journal_dir;
+  EXPECT_TRUE(NewJournalDir(journal_dir));
+  FileJournalWriter writer(Env::Default(), journal_dir);
+  TF_ASSERT_OK(writer.Write(MakeCreateIterationUpdate()));
+  TF_ASSERT_OK_AND_ASSIGN(int64_t sequence_number, writer.StartNewFile());
+  EXPECT_EQ(sequence_number, 1);
+  TF_ASSERT_OK(writer.Write(MakeRegisterDatasetUpdate()));
+  TF_ASSERT_OK(writer.Write(MakeFinishTaskUpdate()));
+  TF_EXPECT_OK(CheckJournalContent(
+      journal_dir, {MakeCreateIterationUpdate(), MakeRegisterDatasetUpdate(),
+                    MakeFinishTaskUpdate()}));
+
+  TF_ASSERT_OK(TruncateJournal(Env::Default(), journal_dir, sequence_number));
+  EXPECT_TRUE(absl::IsNotFound(
+      Env::Default()->FileExists(DataServiceJournalFile(journal_dir, 0))));
+  FileJournalReader reader(Env::Default(), journal_dir, sequence_number);
+  for (const Update& expected :
+       {MakeRegisterDatasetUpdate(), MakeFinishTaskUpdate()}) {
+    Update result;
+    bool end_of_journal = true;
+    TF_ASSERT_OK(reader.Read(result, end_of_journal));
+    EXPECT_FALSE(end_of_journal);
+    EXPECT_EQ(result.SerializeAsString(), expected.SerializeAsString());
+  }
+  Update result;
+  bool end_of_journal = false;
+  TF_ASSERT_OK(reader.Read(result, end_of_journal));
+  EXPECT_TRUE(end_of_journal);
+
+  // A new writer continues after the existing files, even the empty ones.
+  TF_ASSERT_OK_AND_ASSIGN(sequence_number, writer.StartNewFile());
+  EXPECT_EQ(sequence_number, 2);
+  FileJournalWriter next_writer(Env::Default(), journal_dir);
+  TF_ASSERT_OK(next_writer.EnsureInitialized());
+  TF_EXPECT_OK(
+      Env::Default()->FileExists(DataServiceJournalFile(journal_dir, 3)));
+}
+
 TEST(Journal, MissingFile) {
   std::string journal_dir;
   EXPECT_TRUE(NewJournalDir(journal_dir));
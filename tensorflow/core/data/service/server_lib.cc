@@ -208,10 +208,13 @@ void WorkerGrpcDataServer::MaybeStartAlternativeDataTransferServer(
             << config_.worker_address();
   DataTransferServerInfo alternative_transfer_server;
   alternative_transfer_server.set_protocol(config_.data_transfer_protocol());
-  alternative_transfer_server.set_address(
-      str_util::StringReplace(config_.data_transfer_address(), kPortPlaceholder,
-                              absl::StrCat(transfer_server_->Port()),
-                              /*replace_all=*/false));
+  std::string transfer_address = transfer_server_->Address();
+  if (transfer_address.empty()) {
+    transfer_address = str_util::StringReplace(
+        config_.data_transfer_address(), kPortPlaceholder,
+        absl::StrCat(transfer_server_->Port()), /*replace_all=*/false);
+  }
+  alternative_transfer_server.set_address(transfer_address);
   absl::StatusOr<std::string> compatibility_info =
       transfer_server_->GetCompatibilityInfo();
   if (!compatibility_info.ok()) {
@@ -0,0 +1,797 @@
+/* Copyright 2024 The TensorFlow Authors. All Rights Reserved.
+
+Licensed under the Apache License, Version 2.0 (the "License");
+you may not use this file except in compliance with the License.
+You may obtain a copy of the License at
+
+    http://www.apache.org/licenses/LICENSE-2.0
+
+Unless required by applicable law or agreed to in writing, software
+distributed under the License is distributed on an "AS IS" BASIS,
+WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+See the License for the specific language governing permissions and
+limitations under the License.
+==============================================================================*/
+#include "tensorflow/core/data/service/shm_data_transfer.h"
+
+#if defined(__linux__)
+#include <fcntl.h>
+#include <sys/mman.h>
+#include <sys/socket.h>
+#include <sys/un.h>
+#include <unistd.h>
+
+#include <algorithm>
+#include <cerrno>
+#include <cstddef>
+#include <cstdint>
+#include <cstring>
+#include <memory>
+#include <string>
+#include <utility>
+#include <vector>
+
+#include "absl/container/flat_hash_set.h"
+#include "absl/memory/memory.h"
+#include "absl/status/status.h"
+#include "absl/status/statusor.h"
+#include "absl/strings/ascii.h"
+#include "absl/strings/str_cat.h"
+#include "absl/strings/string_view.h"
+#include "tensorflow/core/data/service/data_transfer.h"
+#include "tensorflow/core/data/service/worker.pb.h"
+#include "tensorflow/core/framework/allocator.h"
+#include "tensorflow/core/framework/dataset.pb.h"
+#include "tensorflow/core/framework/metrics.h"
+#include "tensorflow/core/framework/tensor.h"
+#include "tensorflow/core/framework/tensor.pb.h"
+#include "tensorflow/core/framework/tensor_shape.h"
+#include "tensorflow/core/framework/types.h"
+#include "tensorflow/core/framework/variant.h"
+#include "tensorflow/core/lib/random/random.h"
+#include "tensorflow/core/platform/env.h"
+#include "tensorflow/core/platform/errors.h"
+#include "tensorflow/core/platform/host_info.h"
+#include "tensorflow/core/platform/logging.h"
+#include "tensorflow/core/platform/mutex.h"
+#include "tensorflow/core/platform/thread_annotations.h"
+#include "tensorflow/core/protobuf/service_config.pb.h"
+
+namespace tensorflow {
+namespace data {
+namespace {
+
+constexpr char kSharedMemoryDir[] = "/dev/shm";
+constexpr uint64_t kAlignment = Allocator::kAllocatorAlignment;
+// Buffers start at this size and at least double when an element does not
+// fit.
+constexpr uint64_t kMinBufferBytes = 4 << 20;
+constexpr uint64_t kMaxRequestBytes = 1 << 20;
+
+// The tensor data is stored as is.
+constexpr uint32_t kRawEncoding = 0;
+// The tensor is stored as a serialized `TensorProto`.
+constexpr uint32_t kProtoEncoding = 1;
+// The tensor is a scalar `CompressedElement` variant, stored as the serialized
+// `CompressedElement`.
+constexpr uint32_t kCompressedEncoding = 2;
+
+// Sent over the socket in reply to each request. If `buffer_bytes` is not 0,
+// the message carries the descriptor of a new buffer of that size, which
+// replaces the connection's buffer.
+struct ResponseMessage {
+  uint64_t payload_bytes;
+  uint64_t buffer_bytes;
+};
+
+// The start of the payload in the buffer, followed by the status message and
+// the tensors of the element.
+struct ElementHeader {
+  int32_t code;
+  uint32_t end_of_sequence;
+  uint32_t skip;
+  uint32_t reserved;
+  int64_t element_index;
+  uint64_t num_components;
+  uint64_t message_bytes;
+};
+
+struct TensorHeader {
+  uint32_t dtype;
+  uint32_t encoding;
+  uint32_t num_dims;
+  uint32_t reserved;
+  uint64_t num_bytes;
+};
+
+uint64_t AlignUp(uint64_t offset) {
+  return (offset + kAlignment - 1) / kAlignment * kAlignment;
+}
+
+// Identifies the host and its current boot, so that clients only use shared
+// memory with workers on the same machine.
+const std::string& HostId() {
+  static const std::string* host_id = [] {
+    std::string boot_id;
+    ReadFileToString(Env::Default(), "/proc/sys/kernel/random/boot_id",
+                     &boot_id)
+        .IgnoreError();
+    return new std::string(absl::StrCat(
+        port::Hostname(), "/", absl::StripAsciiWhitespace(boot_id)));
+  }();
+  return *host_id;
+}
+
+absl::Status SetSocketAddress(const std::string& name, sockaddr_un* addr,
+                              socklen_t* addr_len) {
+  std::memset(addr, 0, sizeof(*addr));
+  addr->sun_family = AF_UNIX;
+  // The name starts with a null byte to place it in the abstract namespace,
+  // which does not need to be cleaned up.
+  if (name.size() + 1 > sizeof(addr->sun_path)) {
+    return errors::InvalidArgument("Socket name is too long: ", name);
+  }
+  std::memcpy(addr->sun_path + 1, name.data(), name.size());
+  *addr_len = offsetof(sockaddr_un, sun_path) + 1 + name.size();
+  return absl::OkStatus();
+}
+
+absl::Status WriteAll(int fd, const void* data, size_t size) {
+  const char* ptr = static_cast<const char*>(data);
+  while (size > 0) {
+    ssize_t n = send(fd, ptr, size, MSG_NOSIGNAL);
+    if (n < 0) {
+      if (errno == EINTR) continue;
+      return errors::IOError("Failed to write to shared memory socket", errno);
+    }
+    ptr += n;
+    size -= n;
+  }
+  return absl::OkStatus();
+}
+
+absl::Status ReadAll(int fd, void* data, size_t size) {
+  char* ptr = static_cast<char*>(data);
+  while (size > 0) {
+    ssize_t n = recv(fd, ptr, size, 0);
+    if (n < 0) {
+      if (errno == EINTR) continue;
+      return errors::IOError("Failed to read from shared memory socket",
+                             errno);
+    }
+    if (n == 0) {
+      return errors::Unavailable("Shared memory socket was closed.");
+    }
+    ptr += n;
+    size -= n;
+  }
+  return absl::OkStatus();
+}
+
+// Writes `message`, passing `fd_to_send` along with it if it is not -1.
+absl::Status SendMessage(int fd, const ResponseMessage& message,
+                         int fd_to_send) {
+  if (fd_to_send < 0) {
+    return WriteAll(fd, &message, sizeof(message));
+  }
+  iovec iov;
+  iov.iov_base = const_cast<ResponseMessage*>(&message);
+  iov.iov_len = sizeof(message);
+  alignas(cmsghdr) char control[CMSG_SPACE(sizeof(int))] = {};
+  msghdr msg = {};
+  msg.msg_iov = &iov;
+  msg.msg_iovlen = 1;
+  msg.msg_control = control;
+  msg.msg_controllen = sizeof(control);
+  cmsghdr* cmsg = CMSG_FIRSTHDR(&msg);
+  cmsg->cmsg_level = SOL_SOCKET;
+  cmsg->cmsg_type = SCM_RIGHTS;
+  cmsg->cmsg_len = CMSG_LEN(sizeof(int));
+  std::memcpy(CMSG_DATA(cmsg), &fd_to_send, sizeof(int));
+  ssize_t n;
+  do {
+    n = sendmsg(fd, &msg, MSG_NOSIGNAL);
+  } while (n < 0 && errno == EINTR);
+  if (n < 0) {
+    return errors::IOError("Failed to write to shared memory socket", errno);
+  }
+  return WriteAll(fd, reinterpret_cast<const char*>(&message) + n,
+                  sizeof(message) - n);
+}
+
+// Reads a message, and the descriptor passed with it into `*received_fd`, or -1
+// if there is none.
+absl::Status ReceiveMessage(int fd, ResponseMessage* message,
+                            int* received_fd) {
+  *received_fd = -1;
+  iovec iov;
+  iov.iov_base = message;
+  iov.iov_len = sizeof(*message);
+  alignas(cmsghdr) char control[CMSG_SPACE(sizeof(int))] = {};
+  msghdr msg = {};
+  msg.msg_iov = &iov;
+  msg.msg_iovlen = 1;
+  msg.msg_control = control;
+  msg.msg_controllen = sizeof(control);
+  ssize_t n;
+  do {
+    n = recvmsg(fd, &msg, MSG_CMSG_CLOEXEC);
+  } while (n < 0 && errno == EINTR);
+  if (n < 0) {
+    return errors::IOError("Failed to read from shared memory socket", errno);
+  }
+  if (n == 0) {
+    return errors::Unavailable("Shared memory socket was closed.");
+  }
+  for (cmsghdr* cmsg = CMSG_FIRSTHDR(&msg); cmsg != nullptr;
+       cmsg = CMSG_NXTHDR(&msg, cmsg)) {
+    if (cmsg->cmsg_level == SOL_SOCKET && cmsg->cmsg_type == SCM_RIGHTS) {
+      std::memcpy(received_fd, CMSG_DATA(cmsg), sizeof(int));
+    }
+  }
+  return ReadAll(fd, reinterpret_cast<char*>(message) + n,
+                 sizeof(*message) - n);
+}
+
+// A shared memory file mapped into this process.
+class SharedBuffer {
+ public:
+  // Creates an unlinked file of `size` bytes in the shared memory file system.
+  static absl::StatusOr<std::unique_ptr<SharedBuffer>> Create(uint64_t size) {
+    std::string filename =
+        absl::StrCat(kSharedMemoryDir, "/tf_data_shm_XXXXXX");
+    int fd = mkostemp(filename.data(), O_CLOEXEC);
+    if (fd < 0) {
+      return errors::IOError(
+          absl::StrCat("Failed to create shared memory file in ",
+                       kSharedMemoryDir),
+          errno);
+    }
+    unlink(filename.c_str());
+    if (ftruncate(fd, size) != 0) {
+      const int error = errno;
+      close(fd);
+      return errors::IOError("Failed to resize shared memory file", error);
+    }
+    return Map(fd, size);
+  }
+
+  // Maps the shared memory file `fd`, of which it takes ownership.
+  static absl::StatusOr<std::unique_ptr<SharedBuffer>> Map(int fd,
+                                                           uint64_t size) {
+    void* data =
+        mmap(nullptr, size, PROT_READ | PROT_WRITE, MAP_SHARED, fd, 0);
+    if (data == MAP_FAILED) {
+      const int error = errno;
+      close(fd);
+      return errors::IOError("Failed to map shared memory file", error);
+    }
+    return absl::WrapUnique(
+        new SharedBuffer(fd, static_cast<char*>(data), size));
+  }
+
+  ~SharedBuffer() {
+    munmap(data_, size_);
+    close(fd_);
+  }
+
+  int fd() const { return fd_; }
+  char* data() const { return data_; }
+  uint64_t size() const { return size_; }
+
+ private:
+  SharedBuffer(int fd, char* data, uint64_t size)
+      : fd_(fd), data_(data), size_(size) {}
+
+  const int fd_;
+  char* const data_;
+  const uint64_t size_;
+
+  SharedBuffer(const SharedBuffer&) = delete;
+  void operator=(const SharedBuffer&) = delete;
+};
+
+// A tensor of an element, in the form in which it is written to the buffer.
+struct EncodedTensor {
+  const Tensor* tensor;
+  uint32_t encoding;
+  StringPiece data;
+  std::string serialized;
+};
+
+absl::Status EncodeTensor(const Tensor& tensor, EncodedTensor* encoded) {
+  encoded->tensor = &tensor;
+  if (DataTypeCanUseMemcpy(tensor.dtype())) {
+    encoded->encoding = kRawEncoding;
+    encoded->data = tensor.tensor_data();
+    return absl::OkStatus();
+  }
+  const CompressedElement* compressed = nullptr;
+  if (tensor.dtype() == DT_VARIANT && tensor.NumElements() == 1 &&
+      tensor.dims() == 0) {
+    compressed = tensor.scalar<Variant>()().get<CompressedElement>();
+  }
+  bool serialized;
+  if (compressed != nullptr) {
+    encoded->encoding = kCompressedEncoding;
+    serialized = compressed->SerializeToString(&encoded->serialized);
+  } else {
+    encoded->encoding = kProtoEncoding;
+    TensorProto proto;
+    tensor.AsProtoTensorContent(&proto);
+    serialized = proto.SerializeToString(&encoded->serialized);
+  }
+  if (!serialized) {
+    return errors::Internal("Failed to serialize a tensor of type ",
+                            DataTypeString(tensor.dtype()));
+  }
+  encoded->data = encoded->serialized;
+  return absl::OkStatus();
+}
+
+// Writes the outcome of a request to `*buffer`, replacing it with a larger one
+// if needed, and returns the number of bytes written.
+absl::StatusOr<uint64_t> WriteResult(const absl::Status& status,
+                                     const GetElementResult& result,
+                                     std::unique_ptr<SharedBuffer>* buffer,
+                                     bool* buffer_replaced) {
+  std::vector<EncodedTensor> tensors;
+  if (status.ok()) {
+    tensors.resize(result.components.size());
+    for (int i = 0; i < result.components.size(); ++i) {
+      TF_RETURN_IF_ERROR(EncodeTensor(result.components[i], &tensors[i]));
+    }
+  }
+  absl::string_view message = status.message();
+  uint64_t size = sizeof(ElementHeader) + message.size();
+  for (const EncodedTensor& tensor : tensors) {
+    size = AlignUp(size) + sizeof(TensorHeader) +
+           tensor.tensor->dims() * sizeof(int64_t);
+    size = AlignUp(size) + tensor.data.size();
+  }
+
+  *buffer_replaced = false;
+  if (*buffer == nullptr || (*buffer)->size() < size) {
+    uint64_t buffer_size =
+        std::max(kMinBufferBytes, *buffer ? 2 * (*buffer)->size() : 0);
+    while (buffer_size < size) buffer_size *= 2;
+    TF_ASSIGN_OR_RETURN(*buffer, SharedBuffer::Create(buffer_size));
+    *buffer_replaced = true;
+  }
+
+  char* data = (*buffer)->data();
+  ElementHeader header = {};
+  header.code = static_cast<int32_t>(status.code());
+  header.end_of_sequence = result.end_of_sequence;
+  header.skip = result.skip;
+  header.element_index = result.element_index;
+  header.num_components = tensors.size();
+  header.message_bytes = message.size();
+  std::memcpy(data, &header, sizeof(header));
+  uint64_t offset = sizeof(header);
+  std::memcpy(data + offset, message.data(), message.size());
+  offset += message.size();
+  for (const EncodedTensor& tensor : tensors) {
+    offset = AlignUp(offset);
+    TensorHeader tensor_header = {};
+    tensor_header.dtype = tensor.tensor->dtype();
+    tensor_header.encoding = tensor.encoding;
+    tensor_header.num_dims = tensor.tensor->dims();
+    tensor_header.num_bytes = tensor.data.size();
+    std::memcpy(data + offset, &tensor_header, sizeof(tensor_header));
+    offset += sizeof(tensor_header);
+    for (int i = 0; i < tensor.tensor->dims(); ++i) {
+      const int64_t dim = tensor.tensor->dim_size(i);
+      std::memcpy(data + offset, &dim, sizeof(dim));
+      offset += sizeof(dim);
+    }
+    offset = AlignUp(offset);
+    std::memcpy(data + offset, tensor.data.data(), tensor.data.size());
+    offset += tensor.data.size();
+  }
+  return offset;
+}
+
+// Reads the tensor at `*offset` of the `size` bytes at `data` into `*tensor`,
+// and advances `*offset` past it.
+absl::Status ReadTensor(const char* data, uint64_t size, Allocator* allocator,
+                        uint64_t* offset, Tensor* tensor) {
+  TensorHeader header;
+  *offset = AlignUp(*offset);
+  if (*offset > size || size - *offset < sizeof(header)) {
+    return errors::DataLoss("Bad tensor offset in shared memory buffer.");
+  }
+  std::memcpy(&header, data + *offset, sizeof(header));
+  *offset += sizeof(header);
+  if (header.num_dims > TensorShape::MaxDimensions() ||
+      (size - *offset) / sizeof(int64_t) < header.num_dims) {
+    return errors::DataLoss("Bad tensor shape in shared memory buffer.");
+  }
+  std::vector<int64_t> dims(header.num_dims);
+  std::memcpy(dims.data(), data + *offset, header.num_dims * sizeof(int64_t));
+  *offset = AlignUp(*offset + header.num_dims * sizeof(int64_t));
+  if (*offset > size || size - *offset < header.num_bytes) {
+    return errors::DataLoss("Bad tensor size in shared memory buffer.");
+  }
+  const char* tensor_data = data + *offset;
+  *offset += header.num_bytes;
+
+  const DataType dtype = static_cast<DataType>(header.dtype);
+  switch (header.encoding) {
+    case kRawEncoding: {
+      TensorShape shape;
+      TF_RETURN_IF_ERROR(TensorShape::BuildTensorShape(dims, &shape));
+      if (!DataTypeCanUseMemcpy(dtype) ||
+          shape.num_elements() * DataTypeSize(dtype) != header.num_bytes) {
+        return errors::DataLoss("Bad raw tensor in shared memory buffer.");
+      }
+      *tensor = Tensor(allocator, dtype, shape);
+      std::memcpy(const_cast<char*>(tensor->tensor_data().data()),
+                  tensor_data, header.num_bytes);
+      return absl::OkStatus();
+    }
+    case kProtoEncoding: {
+      TensorProto proto;
+      if (!proto.ParseFromArray(tensor_data, header.num_bytes) ||
+          !tensor->FromProto(allocator, proto)) {
+        return errors::DataLoss("Bad tensor proto in shared memory buffer.");
+      }
+      return absl::OkStatus();
+    }
+    case kCompressedEncoding: {
+      CompressedElement compressed;
+      if (!compressed.ParseFromArray(tensor_data, header.num_bytes)) {
+        return errors::DataLoss(
+            "Bad compressed element in shared memory buffer.");
+      }
+      *tensor = Tensor(DT_VARIANT, TensorShape{});
+      tensor->scalar<Variant>()() = std::move(compressed);
+      return absl::OkStatus();
+    }
+    default:
+      return errors::DataLoss("Bad tensor encoding in shared memory buffer.");
+  }
+}
+
+// Reads the outcome of a request from the `size` bytes at `data`.
+absl::Status ReadResult(const char* data, uint64_t size, Allocator* allocator,
+                        GetElementResult& result) {
+  ElementHeader header;
+  if (size < sizeof(header)) {
+    return errors::DataLoss("Shared memory buffer is too short.");
+  }
+  std::memcpy(&header, data, sizeof(header));
+  uint64_t offset = sizeof(header);
+  if (header.message_bytes > size - offset) {
+    return errors::DataLoss("Bad status in shared memory buffer.");
+  }
+  if (header.code != static_cast<int32_t>(absl::StatusCode::kOk)) {
+    return absl::Status(
+        static_cast<absl::StatusCode>(header.code),
+        absl::string_view(data + offset, header.message_bytes));
+  }
+  offset += header.message_bytes;
+  result.end_of_sequence = header.end_of_sequence;
+  result.skip = header.skip;
+  result.element_index = header.element_index;
+  if (header.num_components > size / sizeof(TensorHeader)) {
+    return errors::DataLoss("Bad element in shared memory buffer.");
+  }
+  result.components.resize(header.num_components);
+  for (Tensor& tensor : result.components) {
+    TF_RETURN_IF_ERROR(ReadTensor(data, size, allocator, &offset, &tensor));
+  }
+  return absl::OkStatus();
+}
+
+class ShmDataTransferServer : public DataTransferServer {
+ public:
+  explicit ShmDataTransferServer(GetElementT get_element)
+      : get_element_(std::move(get_element)),
+        socket_name_(absl::StrCat("tf_data_shm_transfer_", getpid(), "_",
+                                  random::New64())) {}
+
+  ~ShmDataTransferServer() override {
+    {
+      mutex_lock l(mu_);
+      cancelled_ = true;
+      if (listen_fd_ >= 0) shutdown(listen_fd_, SHUT_RDWR);
+      for (int fd : connection_fds_) shutdown(fd, SHUT_RDWR);
+    }
+    accept_thread_.reset();
+    std::vector<std::unique_ptr<Thread>> threads;
+    {
+      mutex_lock l(mu_);
+      threads = std::move(connection_threads_);
+    }
+    threads.clear();
+    if (listen_fd_ >= 0) close(listen_fd_);
+  }
+
+  Status Start(const experimental::WorkerConfig& config) override {
+    if (!Env::Default()->IsDirectory(kSharedMemoryDir).ok()) {
+      return errors::FailedPrecondition(
+          "Shared memory data transfer requires ", kSharedMemoryDir);
+    }
+    sockaddr_un addr;
+    socklen_t addr_len;
+    TF_RETURN_IF_ERROR(SetSocketAddress(socket_name_, &addr, &addr_len));
+    int fd = socket(AF_UNIX, SOCK_STREAM | SOCK_CLOEXEC, 0);
+    if (fd < 0) {
+      return errors::IOError("Failed to create shared memory socket", errno);
+    }
+    if (bind(fd, reinterpret_cast<sockaddr*>(&addr), addr_len) != 0 ||
+        listen(fd, SOMAXCONN) != 0) {
+      const int error = errno;
+      close(fd);
+      return errors::IOError(
+          absl::StrCat("Failed to listen on shared memory socket ",
+                       socket_name_),
+          error);
+    }
+    listen_fd_ = fd;
+    accept_thread_ = absl::WrapUnique(Env::Default()->StartThread(
+        {}, "tf_data_shm_transfer_accept", [this] { AcceptLoop(); }));
+    VLOG(1) << "Started shared memory data transfer server at "
+            << socket_name_ << " for worker " << config.worker_address();
+    return absl::OkStatus();
+  }
+
+  int Port() const override { return 0; }
+
+  std::string Address() const override { return socket_name_; }
+
+  absl::StatusOr<std::string> GetCompatibilityInfo() const override {
+    return HostId();
+  }
+
+ private:
+  void AcceptLoop() {
+    while (true) {
+      int fd = accept4(listen_fd_, nullptr, nullptr, SOCK_CLOEXEC);
+      if (fd < 0 && errno == EINTR) continue;
+      mutex_lock l(mu_);
+      if (cancelled_) {
+        if (fd >= 0) close(fd);
+        return;
+      }
+      if (fd < 0) {
+        LOG(ERROR) << "Failed to accept a connection on shared memory socket "
+                   << socket_name_ << ": " << std::strerror(errno);
+        return;
+      }
+      connection_fds_.insert(fd);
+      connection_threads_.push_back(
+          absl::WrapUnique(Env::Default()->StartThread(
+              {}, "tf_data_shm_transfer_connection",
+              [this, fd] { ServeConnection(fd); })));
+    }
+  }
+
+  // Serves the requests of one connection until it is closed.
+  void ServeConnection(int fd) {
+    std::unique_ptr<SharedBuffer> buffer;
+    absl::Status s;
+    while (s.ok()) {
+      s = ServeRequest(fd, &buffer);
+    }
+    VLOG(2) << "Closing shared memory data transfer connection: " << s;
+    mutex_lock l(mu_);
+    connection_fds_.erase(fd);
+    close(fd);
+  }
+
+  absl::Status ServeRequest(int fd, std::unique_ptr<SharedBuffer>* buffer) {
+    uint64_t request_bytes;
+    TF_RETURN_IF_ERROR(ReadAll(fd, &request_bytes, sizeof(request_bytes)));
+    if (request_bytes > kMaxRequestBytes) {
+      return errors::InvalidArgument("Request is too large: ", request_bytes);
+    }
+    std::string serialized_request(request_bytes, '\0');
+    TF_RETURN_IF_ERROR(
+        ReadAll(fd, serialized_request.data(), serialized_request.size()));
+    GetElementRequest request;
+    if (!request.ParseFromString(serialized_request)) {
+      return errors::InvalidArgument("Failed to parse GetElementRequest.");
+    }
+    GetElementResult result;
+    absl::Status status = get_element_(&request, &result);
+    bool buffer_replaced;
+    TF_ASSIGN_OR_RETURN(uint64_t payload_bytes,
+                        WriteResult(status, result, buffer, &buffer_replaced));
+    ResponseMessage message = {payload_bytes,
+                               buffer_replaced ? (*buffer)->size() : 0};
+    return SendMessage(fd, message, buffer_replaced ? (*buffer)->fd() : -1);
+  }
+
+  const GetElementT get_element_;
+  const std::string socket_name_;
+  int listen_fd_ = -1;
+  std::unique_ptr<Thread> accept_thread_;
+
+  mutex mu_;
+  bool cancelled_ TF_GUARDED_BY(mu_) = false;
+  absl::flat_hash_set<int> connection_fds_ TF_GUARDED_BY(mu_);
+  std::vector<std::unique_ptr<Thread>> connection_threads_ TF_GUARDED_BY(mu_);
+};
+
+class ShmDataTransferClient : public DataTransferClient {
+ public:
+  ShmDataTransferClient(std::string socket_name, Allocator* allocator)
+      : socket_name_(std::move(socket_name)),
+        allocator_(allocator != nullptr ? allocator : cpu_allocator()) {}
+
+  // Connects to the server, so that building a client for a server that cannot
+  // be reached fails.
+  absl::Status Initialize() {
+    TF_ASSIGN_OR_RETURN(std::unique_ptr<Connection> connection, Connect());
+    mutex_lock l(mu_);
+    idle_connections_.push_back(std::move(connection));
+    return absl::OkStatus();
+  }
+
+  Status GetElement(const GetElementRequest& req,
+                    GetElementResult& result) override {
+    VLOG(3) << "GetElement for task " << req.task_id() << " from shared "
+            << "memory worker server.";
+    TF_ASSIGN_OR_RETURN(std::unique_ptr<Connection> connection,
+                        TakeConnection());
+    int64_t start_time_us = env_->NowMicros();
+    absl::Status s = Exchange(*connection, req, result);
+    int64_t end_time_us = env_->NowMicros();
+    ReleaseConnection(std::move(connection));
+    TF_RETURN_IF_ERROR(s);
+    metrics::RecordTFDataServiceGetElementDuration(kShmTransferProtocol,
+                                                   end_time_us - start_time_us);
+    return absl::OkStatus();
+  }
+
+  void TryCancel() override {
+    VLOG(2) << "Cancel ShmDataTransferClient.";
+    mutex_lock l(mu_);
+    cancelled_ = true;
+    for (int fd : active_fds_) shutdown(fd, SHUT_RDWR);
+    idle_connections_.clear();
+  }
+
+  absl::StatusOr<std::string> GetCompatibilityInfo() const override {
+    return HostId();
+  }
+
+  Status CheckCompatibility(
+      const std::string& server_compatibility_info) const override {
+    if (server_compatibility_info != HostId()) {
+      return errors::FailedPrecondition(
+          "The tf.data service worker runs on host ",
+          server_compatibility_info, ", but the client runs on ", HostId());
+    }
+    return absl::OkStatus();
+  }
+
+ private:
+  struct Connection {
+    explicit Connection(int fd) : fd(fd) {}
+    ~Connection() { close(fd); }
+
+    const int fd;
+    std::unique_ptr<SharedBuffer> buffer;
+    bool broken = false;
+  };
+
+  absl::StatusOr<std::unique_ptr<Connection>> Connect() {
+    sockaddr_un addr;
+    socklen_t addr_len;
+    TF_RETURN_IF_ERROR(SetSocketAddress(socket_name_, &addr, &addr_len));
+    int fd = socket(AF_UNIX, SOCK_STREAM | SOCK_CLOEXEC, 0);
+    if (fd < 0) {
+      return errors::IOError("Failed to create shared memory socket", errno);
+    }
+    auto connection = std::make_unique<Connection>(fd);
+    if (connect(fd, reinterpret_cast<sockaddr*>(&addr), addr_len) != 0) {
+      return errors::IOError(
+          absl::StrCat("Failed to connect to shared memory socket ",
+                       socket_name_),
+          errno);
+    }
+    return connection;
+  }
+
+  absl::StatusOr<std::unique_ptr<Connection>> TakeConnection() {
+    {
+      mutex_lock l(mu_);
+      if (cancelled_) {
+        return errors::Cancelled("Client was cancelled.");
+      }
+      if (!idle_connections_.empty()) {
+        std::unique_ptr<Connection> connection =
+            std::move(idle_connections_.back());
+        idle_connections_.pop_back();
+        active_fds_.insert(connection->fd);
+        return connection;
+      }
+    }
+    TF_ASSIGN_OR_RETURN(std::unique_ptr<Connection> connection, Connect());
+    mutex_lock l(mu_);
+    if (cancelled_) {
+      return errors::Cancelled("Client was cancelled.");
+    }
+    active_fds_.insert(connection->fd);
+    return connection;
+  }
+
+  // Makes `connection` available to other requests, unless it is out of sync
+  // with the server after a failed exchange.
+  void ReleaseConnection(std::unique_ptr<Connection> connection) {
+    mutex_lock l(mu_);
+    active_fds_.erase(connection->fd);
+    if (!cancelled_ && !connection->broken) {
+      idle_connections_.push_back(std::move(connection));
+    }
+  }
+
+  absl::Status Exchange(Connection& connection, const GetElementRequest& req,
+                        GetElementResult& result) {
+    connection.broken = true;
+    std::string serialized_request = req.SerializeAsString();
+    uint64_t request_bytes = serialized_request.size();
+    TF_RETURN_IF_ERROR(
+        WriteAll(connection.fd, &request_bytes, sizeof(request_bytes)));
+    TF_RETURN_IF_ERROR(WriteAll(connection.fd, serialized_request.data(),
+                                serialized_request.size()));
+    ResponseMessage message;
+    int received_fd;
+    TF_RETURN_IF_ERROR(ReceiveMessage(connection.fd, &message, &received_fd));
+    if (received_fd >= 0) {
+      TF_ASSIGN_OR_RETURN(connection.buffer,
+                          SharedBuffer::Map(received_fd, message.buffer_bytes));
+    }
+    if (connection.buffer == nullptr ||
+        message.payload_bytes > connection.buffer->size()) {
+      return errors::DataLoss("Bad shared memory data transfer response.");
+    }
+    connection.broken = false;
+    return ReadResult(connection.buffer->data(), message.payload_bytes,
+                      allocator_, result);
+  }
+
+  const std::string socket_name_;
+  Allocator* const allocator_;
+
+  mutex mu_;
+  bool cancelled_ TF_GUARDED_BY(mu_) = false;
+  std::vector<std::unique_ptr<Connection>> idle_connections_
+      TF_GUARDED_BY(mu_);
+  // The sockets of the connections that are in use, so that they can be shut
+  // down by `TryCancel()`.
+  absl::flat_hash_set<int> active_fds_ TF_GUARDED_BY(mu_);
+};
+
+class ShmTransferRegistrar {
+ public:
+  ShmTransferRegistrar() {
+    DataTransferServer::Register(
+        kShmTransferProtocol,
+        [](DataTransferServer::GetElementT get_element,
+           std::shared_ptr<DataTransferServer>* out) {
+          *out =
+              std::make_shared<ShmDataTransferServer>(std::move(get_element));
+          return absl::OkStatus();
+        });
+    DataTransferClient::Register(
+        kShmTransferProtocol, [](DataTransferClient::Config config,
+                                 std::unique_ptr<DataTransferClient>* out) {
+          auto client = std::make_unique<ShmDataTransferClient>(
+              config.address, config.allocator);
+          TF_RETURN_IF_ERROR(client->Initialize());
+          *out = std::move(client);
+          return absl::OkStatus();
+        });
+  }
+};
+static ShmTransferRegistrar shm_transfer_registrar;
+
+}  // namespace
+}  // namespace data
+}  // namespace tensorflow
+
+#endif  // defined(__linux__)
@@ -0,0 +1,38 @@
+/* Copyright 2024 The TensorFlow Authors. All Rights Reserved.
+
+Licensed under the Apache License, Version 2.0 (the "License");
+you may not use this file except in compliance with the License.
+You may obtain a copy of the License at
+
+    http://www.apache.org/licenses/LICENSE-2.0
+
+Unless required by applicable law or agreed to in writing, software
+distributed under the License is distributed on an "AS IS" BASIS,
+WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+See the License for the specific language governing permissions and
+limitations under the License.
+==============================================================================*/
+#ifndef TENSORFLOW_CORE_DATA_SERVICE_SHM_DATA_TRANSFER_H_
+#define TENSORFLOW_CORE_DATA_SERVICE_SHM_DATA_TRANSFER_H_
+
+namespace tensorflow {
+namespace data {
+
+// A data transfer protocol for clients that run on the same host as their
+// tf.data service worker. A worker started with this `data_transfer_protocol`
+// listens on a Unix domain socket in the abstract namespace. Each connection
+// owns a shared memory buffer into which the worker writes the tensors of the
+// elements it serves, with their raw contents where the tensor types allow,
+// so that the client reads them with a single copy instead of parsing a gRPC
+// response. Concurrent requests use separate connections, and hence separate
+// buffers.
+//
+// Clients on other hosts, or in other network namespaces, fail the
+// compatibility check or the connection and fall back to gRPC. The protocol is
+// only available on Linux.
+constexpr const char kShmTransferProtocol[] = "shm";
+
+}  // namespace data
+}  // namespace tensorflow
+
+#endif  // TENSORFLOW_CORE_DATA_SERVICE_SHM_DATA_TRANSFER_H_
@@ -0,0 +1,184 @@
+/* Copyright 2024 The TensorFlow Authors. All Rights Reserved.
+
+Licensed under the Apache License, Version 2.0 (the "License");
+you may not use this file except in compliance with the License.
+You may obtain a copy of the License at
+
+    http://www.apache.org/licenses/LICENSE-2.0
+
+Unless required by applicable law or agreed to in writing, software
+distributed under the License is distributed on an "AS IS" BASIS,
+WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+See the License for the specific language governing permissions and
+limitations under the License.
+==============================================================================*/
+#include "tensorflow/core/data/service/shm_data_transfer.h"
+
+#include <cstdint>
+#include <memory>
+#include <string>
+#include <vector>
+
+#include "absl/status/status.h"
+#include "tensorflow/core/data/service/data_transfer.h"
+#include "tensorflow/core/data/service/worker.pb.h"
+#include "tensorflow/core/framework/allocator.h"
+#include "tensorflow/core/framework/dataset.pb.h"
+#include "tensorflow/core/framework/tensor.h"
+#include "tensorflow/core/framework/tensor_shape.h"
+#include "tensorflow/core/framework/tensor_testutil.h"
+#include "tensorflow/core/framework/variant.h"
+#include "tensorflow/core/lib/core/status_test_util.h"
+#include "tensorflow/core/platform/errors.h"
+#include "tensorflow/core/platform/test.h"
+#include "tensorflow/core/protobuf/service_config.pb.h"
+
+namespace tensorflow {
+namespace data {
+namespace {
+
+using ::testing::HasSubstr;
+
+class ShmDataTransferTest : public ::testing::Test {
+ protected:
+  void SetUp() override {
+#if !defined(__linux__)
+    GTEST_SKIP() << "Shared memory data transfer is only available on Linux.";
+#endif
+    TF_ASSERT_OK(DataTransferServer::Build(
+        kShmTransferProtocol,
+        [this](const GetElementRequest* request, GetElementResult* result) {
+          return GetElement(*request, *result);
+        },
+        &server_));
+    TF_ASSERT_OK(server_->Start(experimental::WorkerConfig()));
+  }
+
+  // Serves elements of task 0 and fails for other tasks. Element `i` is a
+  // scalar `i`, a string, and a vector of `i * 1M` floats, so that later
+  // elements no longer fit in the initial buffer.
+  absl::Status GetElement(const GetElementRequest& request,
+                          GetElementResult& result) {
+    if (request.task_id() != 0) {
+      return errors::NotFound("Task ", request.task_id(), " not found.");
+    }
+    const int64_t index = next_index_++;
+    if (index >= kNumElements) {
+      result.end_of_sequence = true;
+      return absl::OkStatus();
+    }
+    result.element_index = index;
+    result.components.push_back(test::AsScalar<int64_t>(index));
+    result.components.push_back(test::AsTensor<tstring>(
+        {tstring("element"), tstring(std::string(index, 'x'))}));
+    Tensor floats(DT_FLOAT, TensorShape({index << 20}));
+    floats.flat<float>().setConstant(index);
+    result.components.push_back(floats);
+    return absl::OkStatus();
+  }
+
+  absl::StatusOr<std::unique_ptr<DataTransferClient>> BuildClient(
+      const std::string& address) {
+    std::unique_ptr<DataTransferClient> client;
+    TF_RETURN_IF_ERROR(DataTransferClient::Build(
+        kShmTransferProtocol, {"grpc", address, cpu_allocator()}, &client));
+    return client;
+  }
+
+  static constexpr int64_t kNumElements = 4;
+  int64_t next_index_ = 0;
+  std::shared_ptr<DataTransferServer> server_;
+};
+
+TEST_F(ShmDataTransferTest, GetElements) {
+  TF_ASSERT_OK_AND_ASSIGN(std::unique_ptr<DataTransferClient> client,
+                          BuildClient(server_->Address()));
+  TF_ASSERT_OK_AND_ASSIGN(std::string compatibility_info,
+                          server_->GetCompatibilityInfo());
+  TF_EXPECT_OK(client->CheckCompatibility(compatibility_info));
+
+  GetElementRequest request;
+  for (int64_t i = 0; i < kNumElements; ++i) {
+    GetElementResult result;
+    TF_ASSERT_OK(client->GetElement(request, result));
+    EXPECT_FALSE(result.end_of_sequence);
+    EXPECT_EQ(result.element_index, i);
+    ASSERT_EQ(result.components.size(), 3);
+    test::ExpectEqual(result.components[0], test::AsScalar<int64_t>(i));
+    test::ExpectEqual(result.components[1],
+                      test::AsTensor<tstring>(
+                          {tstring("element"), tstring(std::string(i, 'x'))}));
+    Tensor floats(DT_FLOAT, TensorShape({i << 20}));
+    floats.flat<float>().setConstant(i);
+    test::ExpectEqual(result.components[2], floats);
+  }
+  GetElementResult result;
+  TF_ASSERT_OK(client->GetElement(request, result));
+  EXPECT_TRUE(result.end_of_sequence);
+  EXPECT_TRUE(result.components.empty());
+}
+
+TEST_F(ShmDataTransferTest, CompressedElement) {
+  CompressedElement compressed;
+  compressed.set_data("compressed data");
+  TF_ASSERT_OK(DataTransferServer::Build(
+      kShmTransferProtocol,
+      [&compressed](const GetElementRequest*, GetElementResult* result) {
+        Tensor tensor(DT_VARIANT, TensorShape{});
+        tensor.scalar<Variant>()() = compressed;
+        result->components.push_back(tensor);
+        return absl::OkStatus();
+      },
+      &server_));
+  TF_ASSERT_OK(server_->Start(experimental::WorkerConfig()));
+  TF_ASSERT_OK_AND_ASSIGN(std::unique_ptr<DataTransferClient> client,
+                          BuildClient(server_->Address()));
+
+  GetElementResult result;
+  TF_ASSERT_OK(client->GetElement(GetElementRequest(), result));
+  ASSERT_EQ(result.components.size(), 1);
+  const CompressedElement* received =
+      result.components[0].scalar<Variant>()().get<CompressedElement>();
+  ASSERT_NE(received, nullptr);
+  EXPECT_EQ(received->data(), "compressed data");
+}
+
+TEST_F(ShmDataTransferTest, PropagatesErrors) {
+  TF_ASSERT_OK_AND_ASSIGN(std::unique_ptr<DataTransferClient> client,
+                          BuildClient(server_->Address()));
+  GetElementRequest request;
+  request.set_task_id(7);
+  GetElementResult result;
+  absl::Status status = client->GetElement(request, result);
+  EXPECT_TRUE(absl::IsNotFound(status));
+  EXPECT_THAT(status.message(), HasSubstr("Task 7 not found."));
+
+  // The connection is still usable.
+  request.set_task_id(0);
+  TF_ASSERT_OK(client->GetElement(request, result));
+  EXPECT_EQ(result.element_index, 0);
+}
+
+TEST_F(ShmDataTransferTest, Cancel) {
+  TF_ASSERT_OK_AND_ASSIGN(std::unique_ptr<DataTransferClient> client,
+                          BuildClient(server_->Address()));
+  client->TryCancel();
+  GetElementResult result;
+  EXPECT_TRUE(
+      absl::IsCancelled(client->GetElement(GetElementRequest(), result)));
+}
+
+TEST_F(ShmDataTransferTest, IncompatibleHost) {
+  TF_ASSERT_OK_AND_ASSIGN(std::unique_ptr<DataTransferClient> client,
+                          BuildClient(server_->Address()));
+  EXPECT_TRUE(absl::IsFailedPrecondition(
+      client->CheckCompatibility("another_host/boot_id")));
+}
+
+TEST_F(ShmDataTransferTest, UnreachableServer) {
+  EXPECT_FALSE(BuildClient("tf_data_shm_transfer_no_such_server").ok());
+}
+
+}  // namespace
+}  // namespace data
+}  // namespace tensorflow
@@ -15,6 +15,7 @@ limitations under the License.
 #include "tensorflow/core/data/service/snapshot/parallel_tfrecord_writer.h"
 
 #include <cstdint>
+#include <deque>
 #include <memory>
 #include <optional>
 #include <string>
@@ -24,16 +25,19 @@ limitations under the License.
 #include "absl/base/thread_annotations.h"
 #include "absl/container/flat_hash_map.h"
 #include "absl/log/log.h"
+#include "absl/memory/memory.h"
 #include "absl/status/status.h"
 #include "absl/status/statusor.h"
 #include "absl/strings/str_cat.h"
+#include "absl/strings/string_view.h"
 #include "absl/synchronization/mutex.h"
 #include "tensorflow/core/data/service/byte_size.h"
-#include "tensorflow/core/data/service/snapshot/utils.h"
-#include "tensorflow/core/data/snapshot_utils.h"
 #include "tensorflow/core/framework/tensor.h"
+#include "tensorflow/core/framework/tensor.pb.h"
+#include "tsl/lib/io/record_writer.h"
 #include "tsl/platform/env.h"
 #include "tsl/platform/errors.h"
+#include "tsl/platform/file_system.h"
 #include "tsl/platform/path.h"
 #include "tsl/platform/random.h"
 #include "tsl/platform/statusor.h"
@@ -42,20 +46,160 @@ limitations under the License.
 
 namespace tensorflow {
 namespace data {
+namespace {
 
-ParallelTFRecordWriter::ParallelTFRecordWriter(const std::string& file_prefix,
-                                               const std::string& compression,
-                                               tsl::Env* env,
-                                               ByteSize max_file_size,
-                                               int64_t num_write_threads,
-                                               int64_t buffer_size)
+// The size of the writes to the file system.
+constexpr size_t kFileWriteSize = 4 << 20;  // 4MB.
+// The maximum number of writes waiting for the file system, per file.
+constexpr size_t kMaxPendingFileWrites = 4;
+
+// A `WritableFile` that writes to the file system on its own thread, so that
+// the thread that appends the compressed records does not wait for I/O.
+// Appended data is coalesced into writes of `kFileWriteSize` bytes, of which at
+// most `kMaxPendingFileWrites` are pending. Errors of the background writes
+// are returned by later calls.
+class AsyncWritableFile : public tsl::WritableFile {
+ public:
+  AsyncWritableFile(std::unique_ptr<tsl::WritableFile> file, tsl::Env* env)
+      : file_(std::move(file)) {
+    thread_ = absl::WrapUnique(env->StartThread(
+        tsl::ThreadOptions{}, "tfrecord_file_write_thread",
+        [this]() { WriteToFile(); }));
+  }
+
+  ~AsyncWritableFile() override { Close().IgnoreError(); }
+
+  absl::Status Append(absl::string_view data) override
+      ABSL_LOCKS_EXCLUDED(mu_) {
+    absl::MutexLock l(&mu_);
+    TF_RETURN_IF_ERROR(status_);
+    current_.append(data.data(), data.size());
+    position_ += data.size();
+    if (current_.size() >= kFileWriteSize) {
+      EnqueueCurrent();
+    }
+    return status_;
+  }
+
+  absl::Status Flush() override ABSL_LOCKS_EXCLUDED(mu_) {
+    TF_RETURN_IF_ERROR(Drain());
+    return file_->Flush();
+  }
+
+  absl::Status Sync() override ABSL_LOCKS_EXCLUDED(mu_) {
+    TF_RETURN_IF_ERROR(Drain());
+    return file_->Sync();
+  }
+
+  absl::Status Close() override ABSL_LOCKS_EXCLUDED(mu_) {
+    absl::Status status = Drain();
+    {
+      absl::MutexLock l(&mu_);
+      if (closed_) {
+        return status_;
+      }
+      closed_ = true;
+      cv_.SignalAll();
+    }
+    thread_.reset();
+    status.Update(file_->Close());
+    absl::MutexLock l(&mu_);
+    status_.Update(status);
+    return status_;
+  }
+
+  absl::Status Name(absl::string_view* result) const override {
+    return file_->Name(result);
+  }
+
+  absl::Status Tell(int64_t* position) override ABSL_LOCKS_EXCLUDED(mu_) {
+    absl::MutexLock l(&mu_);
+    *position = position_;
+    return absl::OkStatus();
+  }
+
+ private:
+  void EnqueueCurrent() ABSL_EXCLUSIVE_LOCKS_REQUIRED(mu_) {
+    while (status_.ok() && pending_.size() >= kMaxPendingFileWrites) {
+      cv_.Wait(&mu_);
+    }
+    pending_.push_back(std::move(current_));
+    current_.clear();
+    cv_.SignalAll();
+  }
+
+  // Waits until all appended data has been written to `file_`.
+  absl::Status Drain() ABSL_LOCKS_EXCLUDED(mu_) {
+    absl::MutexLock l(&mu_);
+    if (closed_) {
+      return status_;
+    }
+    if (!current_.empty()) {
+      EnqueueCurrent();
+    }
+    while (status_.ok() && (!pending_.empty() || writing_)) {
+      cv_.Wait(&mu_);
+    }
+    return status_;
+  }
+
+  void WriteToFile() ABSL_LOCKS_EXCLUDED(mu_) {
+    while (true) {
+      std::string data;
+      {
+        absl::MutexLock l(&mu_);
+        while (!closed_ && pending_.empty()) {
+          cv_.Wait(&mu_);
+        }
+        if (pending_.empty()) {
+          return;
+        }
+        data = std::move(pending_.front());
+        pending_.pop_front();
+        writing_ = true;
+      }
+      tsl::profiler::TraceMe activity("WriteTFRecordFile",
+                                      tsl::profiler::TraceMeLevel::kInfo);
+      absl::Status status = file_->Append(data);
+      absl::MutexLock l(&mu_);
+      writing_ = false;
+      status_.Update(std::move(status));
+      if (!status_.ok()) {
+        pending_.clear();
+      }
+      cv_.SignalAll();
+    }
+  }
+
+  const std::unique_ptr<tsl::WritableFile> file_;
+  absl::Mutex mu_;
+  absl::CondVar cv_;
+  absl::Status status_ ABSL_GUARDED_BY(mu_);
+  std::string current_ ABSL_GUARDED_BY(mu_);
+  std::deque<std::string> pending_ ABSL_GUARDED_BY(mu_);
+  bool writing_ ABSL_GUARDED_BY(mu_) = false;
+  bool closed_ ABSL_GUARDED_BY(mu_) = false;
+  int64_t position_ ABSL_GUARDED_BY(mu_) = 0;
+  std::unique_ptr<tsl::Thread> thread_;
+};
+
+}  // namespace
+
+ParallelTFRecordWriter::ParallelTFRecordWriter(
+    const std::string& file_prefix, const std::string& compression,
+    tsl::Env* env, ByteSize max_file_size, int64_t num_write_threads,
+    int64_t buffer_size, int64_t num_serialization_threads)
     : env_(env),
       file_prefix_(file_prefix),
       compression_(compression),
       max_file_size_(max_file_size),
       buffer_size_(buffer_size) {
   thread_pool_ = std::make_unique<tsl::thread::ThreadPool>(
-      env_, tsl::ThreadOptions{}, "write_tfrecord_thread", num_write_threads);
+      env_, tsl::ThreadOptions{}, "write_tfrecord_thread",
+      num_write_threads + num_serialization_threads);
+  for (int64_t i = 0; i < num_serialization_threads; ++i) {
+    thread_pool_->Schedule([this]() { SerializeRecords(); });
+  }
   for (int64_t i = 0; i < num_write_threads; ++i) {
     thread_pool_->Schedule([this]() { WriteFiles(); });
   }
@@ -81,7 +225,7 @@ absl::Status ParallelTFRecordWriter::Write(std::vector<Tensor> record)
   }
 
   buffer_.push_back(std::move(record));
-  ready_to_pop_.Signal();
+  ready_to_serialize_.Signal();
   return absl::OkStatus();
 }
 
@@ -91,6 +235,7 @@ ParallelTFRecordWriter::Finalize() ABSL_LOCKS_EXCLUDED(mu_) {
     absl::MutexLock l(&mu_);
     finalized_ = true;
     ready_to_push_.SignalAll();
+    ready_to_serialize_.SignalAll();
     ready_to_pop_.SignalAll();
   }
 
@@ -100,6 +245,66 @@ ParallelTFRecordWriter::Finalize() ABSL_LOCKS_EXCLUDED(mu_) {
   return file_stats_;
 }
 
+void ParallelTFRecordWriter::SerializeRecords() {
+  while (true) {
+    absl::StatusOr<std::optional<std::vector<Tensor>>> record =
+        GetNextRecordToSerialize();
+    if (!record.ok() || !record->has_value()) {
+      return;
+    }
+
+    tsl::profiler::TraceMe activity("SerializeTFRecord",
+                                    tsl::profiler::TraceMeLevel::kInfo);
+    SerializedRecord serialized;
+    absl::Status status;
+    for (const Tensor& tensor : **record) {
+      TensorProto proto;
+      tensor.AsProtoTensorContent(&proto);
+      std::string& serialized_tensor = serialized.tensors.emplace_back();
+      if (!proto.SerializeToString(&serialized_tensor)) {
+        status = absl::DataLossError(absl::StrCat(
+            "Failed to serialize tensor proto of ", proto.ByteSizeLong(),
+            " bytes to be written to ", file_prefix_, "."));
+        break;
+      }
+      serialized.size += ByteSize::Bytes(serialized_tensor.size());
+    }
+
+    absl::MutexLock l(&mu_);
+    --num_serializing_;
+    status_.Update(std::move(status));
+    if (status_.ok()) {
+      serialized_buffer_.push_back(std::move(serialized));
+    }
+    ready_to_push_.SignalAll();
+    ready_to_serialize_.SignalAll();
+    ready_to_pop_.SignalAll();
+  }
+}
+
+absl::StatusOr<std::optional<std::vector<Tensor>>>
+ParallelTFRecordWriter::GetNextRecordToSerialize() ABSL_LOCKS_EXCLUDED(mu_) {
+  absl::MutexLock l(&mu_);
+  while (status_.ok() && (buffer_.empty() || serialized_buffer_.size() +
+                                                     num_serializing_ >=
+                                                 buffer_size_)) {
+    if (finalized_ && buffer_.empty()) {
+      break;
+    }
+    ready_to_serialize_.Wait(&mu_);
+  }
+  TF_RETURN_IF_ERROR(status_);
+  if (buffer_.empty()) {
+    return std::nullopt;
+  }
+
+  std::vector<Tensor> record = std::move(buffer_.front());
+  buffer_.pop_front();
+  ++num_serializing_;
+  ready_to_push_.SignalAll();
+  return record;
+}
+
 void ParallelTFRecordWriter::WriteFiles() {
   while (HasNext()) {
     UpdateStatus(WriteFile());
@@ -108,20 +313,34 @@ void ParallelTFRecordWriter::WriteFiles() {
 
 bool ParallelTFRecordWriter::HasNext() const ABSL_LOCKS_EXCLUDED(mu_) {
   absl::MutexLock l(&mu_);
+  return HasNextLocked();
+}
+
+bool ParallelTFRecordWriter::HasNextLocked() const {
   if (!status_.ok()) {
     return false;
   }
-  return !finalized_ || !buffer_.empty();
+  return !finalized_ || !buffer_.empty() || num_serializing_ > 0 ||
+         !serialized_buffer_.empty();
 }
 
 absl::Status ParallelTFRecordWriter::WriteFile() ABSL_LOCKS_EXCLUDED(mu_) {
   TF_ASSIGN_OR_RETURN(const std::string filename, GetUniqueFile());
-  snapshot_util::TFRecordWriter writer(filename, compression_);
-  TF_RETURN_IF_ERROR(writer.Initialize(env_));
-  while (ShouldWriteFile(filename)) {
-    TF_RETURN_IF_ERROR(WriteRecord(filename, writer));
+  std::unique_ptr<tsl::WritableFile> file;
+  TF_RETURN_IF_ERROR(env_->NewAppendableFile(filename, &file));
+  AsyncWritableFile async_file(std::move(file), env_);
+  // Compression happens in `writer`, on this thread, while `async_file` writes
+  // the compressed data on its own thread.
+  tsl::io::RecordWriter writer(
+      &async_file,
+      tsl::io::RecordWriterOptions::CreateRecordWriterOptions(compression_));
+  absl::Status status;
+  while (status.ok() && ShouldWriteFile(filename)) {
+    status = WriteRecord(filename, writer);
   }
-  TF_RETURN_IF_ERROR(writer.Close());
+  status.Update(writer.Close());
+  status.Update(async_file.Close());
+  TF_RETURN_IF_ERROR(status);
   return DeleteEmptyFile(filename);
 }
 
@@ -137,8 +356,8 @@ bool ParallelTFRecordWriter::ShouldWriteFile(const std::string& filename) const
 }
 
 absl::Status ParallelTFRecordWriter::WriteRecord(
-    const std::string& filename, snapshot_util::TFRecordWriter& writer) {
-  TF_ASSIGN_OR_RETURN(std::optional<std::vector<Tensor>> record,
+    const std::string& filename, tsl::io::RecordWriter& writer) {
+  TF_ASSIGN_OR_RETURN(std::optional<SerializedRecord> record,
                       GetNextRecord(filename));
   if (!record.has_value()) {
     return absl::OkStatus();
@@ -146,30 +365,31 @@ absl::Status ParallelTFRecordWriter::WriteRecord(
 
   tsl::profiler::TraceMe activity("WriteTFRecord",
                                   tsl::profiler::TraceMeLevel::kInfo);
-  TF_RETURN_IF_ERROR(writer.WriteTensors(*std::move(record)));
+  for (const std::string& tensor : record->tensors) {
+    TF_RETURN_IF_ERROR(writer.WriteRecord(tensor));
+  }
   return absl::OkStatus();
 }
 
-absl::StatusOr<std::optional<std::vector<Tensor>>>
+absl::StatusOr<std::optional<ParallelTFRecordWriter::SerializedRecord>>
 ParallelTFRecordWriter::GetNextRecord(const std::string& filename)
     ABSL_LOCKS_EXCLUDED(mu_) {
   absl::MutexLock l(&mu_);
-  while (status_.ok() && !finalized_ && buffer_.empty()) {
+  while (HasNextLocked() && serialized_buffer_.empty()) {
     ready_to_pop_.Wait(&mu_);
   }
   TF_RETURN_IF_ERROR(status_);
-  if (buffer_.empty()) {
+  if (serialized_buffer_.empty()) {
     return std::nullopt;
   }
 
-  std::vector<Tensor> record = std::move(buffer_.front());
-  ByteSize estimated_size = EstimatedSize(record);
-  LOG_EVERY_N_SEC(INFO, 1) << "Writing TFRecord of " << estimated_size
+  SerializedRecord record = std::move(serialized_buffer_.front());
+  LOG_EVERY_N_SEC(INFO, 1) << "Writing TFRecord of " << record.size
                            << " to file " << filename << "*.";
   ++file_stats_[filename].num_records;
-  file_stats_[filename].estimated_size += estimated_size;
-  buffer_.pop_front();
-  ready_to_push_.SignalAll();
+  file_stats_[filename].estimated_size += record.size;
+  serialized_buffer_.pop_front();
+  ready_to_serialize_.SignalAll();
   return record;
 }
 
@@ -207,6 +427,7 @@ void ParallelTFRecordWriter::UpdateStatus(absl::Status status)
   absl::MutexLock l(&mu_);
   status_.Update(std::move(status));
   ready_to_push_.SignalAll();
+  ready_to_serialize_.SignalAll();
   ready_to_pop_.SignalAll();
 }
 }  // namespace data
@@ -28,8 +28,8 @@ limitations under the License.
 #include "absl/status/statusor.h"
 #include "absl/synchronization/mutex.h"
 #include "tensorflow/core/data/service/byte_size.h"
-#include "tensorflow/core/data/snapshot_utils.h"
 #include "tensorflow/core/framework/tensor.h"
+#include "tsl/lib/io/record_writer.h"
 #include "tsl/platform/env.h"
 #include "tsl/platform/threadpool.h"
 
@@ -40,6 +40,13 @@ namespace data {
 // waiting for the file writes, and it writes one shard of file per thread.
 // Returns the file names when writes are finished. This class is thread-safe.
 //
+// Writing is pipelined in three stages that run on separate threads and are
+// connected by bounded buffers: `num_serialization_threads` threads serialize
+// the records, each of the `num_write_threads` threads compresses the records
+// of its file, and each file has a thread that writes the compressed data to
+// the file system. `buffer_size` bounds both the records waiting to be
+// serialized and the serialized records waiting to be compressed.
+//
 // Usage example:
 //
 // ParallelTFRecordWriter writer(
@@ -60,7 +67,8 @@ class ParallelTFRecordWriter {
                                   const std::string& compression, tsl::Env* env,
                                   ByteSize max_file_size = ByteSize::GB(6),
                                   int64_t num_write_threads = 2,
-                                  int64_t buffer_size = 1);
+                                  int64_t buffer_size = 1,
+                                  int64_t num_serialization_threads = 2);
   virtual ~ParallelTFRecordWriter();
   ParallelTFRecordWriter(const ParallelTFRecordWriter&) = delete;
   ParallelTFRecordWriter& operator=(const ParallelTFRecordWriter&) = delete;
@@ -85,11 +93,25 @@ class ParallelTFRecordWriter {
   absl::StatusOr<FileToStatsMap> Finalize();
 
  private:
-  // Run by a thread to write buffered records to sharded files.
+  // A record whose tensors have been serialized to `TensorProto`s.
+  struct SerializedRecord {
+    std::vector<std::string> tensors;
+    ByteSize size;
+  };
+
+  // Run by a thread to serialize buffered records.
+  void SerializeRecords();
+
+  // Gets the next record to serialize. Returns `std::nullopt` if there are no
+  // more records to serialize.
+  absl::StatusOr<std::optional<std::vector<Tensor>>> GetNextRecordToSerialize();
+
+  // Run by a thread to write serialized records to sharded files.
   void WriteFiles();
 
   // Whether there are more records to be written.
   bool HasNext() const;
+  bool HasNextLocked() const ABSL_EXCLUSIVE_LOCKS_REQUIRED(mu_);
 
   // Writes a new file.
   absl::Status WriteFile();
@@ -99,11 +121,11 @@ class ParallelTFRecordWriter {
 
   // Writes one record to file.
   absl::Status WriteRecord(const std::string& filename,
-                           snapshot_util::TFRecordWriter& writer);
+                           tsl::io::RecordWriter& writer);
 
-  // Gets the next record from the buffer to write. Returns `std::nullopt` if
-  // there are no more records to write.
-  absl::StatusOr<std::optional<std::vector<Tensor>>> GetNextRecord(
+  // Gets the next serialized record to write. Returns `std::nullopt` if there
+  // are no more records to write.
+  absl::StatusOr<std::optional<SerializedRecord>> GetNextRecord(
       const std::string& filename);
 
   // Deletes the file if it's empty.
@@ -123,6 +145,7 @@ class ParallelTFRecordWriter {
 
   mutable absl::Mutex mu_;
   mutable absl::CondVar ready_to_push_;
+  mutable absl::CondVar ready_to_serialize_;
   mutable absl::CondVar ready_to_pop_;
 
   bool finalized_ ABSL_GUARDED_BY(mu_) = false;
@@ -131,10 +154,17 @@ class ParallelTFRecordWriter {
   // A map from absolute paths to the number of records in the files.
   FileToStatsMap file_stats_ ABSL_GUARDED_BY(mu_);
 
-  // Buffer to hold the records to be written. The size should be bounded by
-  // `buffer_size_`.
+  // Buffer to hold the records to be serialized. The size should be bounded
+  // by `buffer_size_`.
   std::deque<std::vector<Tensor>> buffer_ ABSL_GUARDED_BY(mu_);
 
+  // Buffer to hold the serialized records to be written. Its size plus
+  // `num_serializing_` should be bounded by `buffer_size_`.
+  std::deque<SerializedRecord> serialized_buffer_ ABSL_GUARDED_BY(mu_);
+
+  // The number of records being serialized.
+  int64_t num_serializing_ ABSL_GUARDED_BY(mu_) = 0;
+
   std::unique_ptr<tsl::thread::ThreadPool> thread_pool_;
 };
 
@@ -283,6 +283,25 @@ TEST(ParallelTFRecordWriterTest, WriteNoRecord) {
               IsOkAndHolds(IsEmpty()));
 }
 
+TEST(ParallelTFRecordWriterTest, NumSerializationThreads) {
+  for (int64_t num_serialization_threads : {1, 8}) {
+    TF_ASSERT_OK_AND_ASSIGN(std::string test_dir, TestDir());
+    ParallelTFRecordWriter parallel_tfrecord_writer(
+        test_dir, tsl::io::compression::kSnappy, tsl::Env::Default(),
+        /*max_file_size=*/ByteSize::Bytes(100), /*num_write_threads=*/2,
+        /*buffer_size=*/4, num_serialization_threads);
+
+    RangeIterator range_iterator(1000);
+    TF_ASSERT_OK_AND_ASSIGN(
+        ParallelTFRecordWriter::FileToStatsMap file_stats,
+        WriteRecords(parallel_tfrecord_writer, range_iterator));
+
+    const auto [files, stats] = Unzip(file_stats);
+    EXPECT_THAT(ReadRecords<int64_t>(files, tsl::io::compression::kSnappy),
+                IsOkAndHolds(UnorderedElementsAreArray(Range(1000))));
+  }
+}
+
 TEST(ParallelTFRecordWriterTest, CannotWriteFinalizedWriter) {
   TF_ASSERT_OK_AND_ASSIGN(std::string test_dir, TestDir());
   std::string file_prefix = "file";
@@ -0,0 +1,337 @@
+/* Copyright 2024 The TensorFlow Authors. All Rights Reserved.
+
+Licensed under the Apache License, Version 2.0 (the "License");
+you may not use this file except in compliance with the License.
+You may obtain a copy of the License at
+
+    http://www.apache.org/licenses/LICENSE-2.0
+
+Unless required by applicable law or agreed to in writing, software
+distributed under the License is distributed on an "AS IS" BASIS,
+WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+See the License for the specific language governing permissions and
+limitations under the License.
+==============================================================================*/
+#include "tensorflow/core/data/service/snapshot/prefetched_chunk_reader.h"
+
+#include <algorithm>
+#include <cstdint>
+#include <functional>
+#include <memory>
+#include <string>
+#include <utility>
+#include <vector>
+
+#include "absl/base/thread_annotations.h"
+#include "absl/status/status.h"
+#include "absl/status/statusor.h"
+#include "absl/strings/str_cat.h"
+#include "absl/synchronization/mutex.h"
+#include "tensorflow/core/data/snapshot_utils.h"
+#include "tensorflow/core/data/utils.h"
+#include "tensorflow/core/framework/dataset.h"
+#include "tensorflow/core/framework/tensor.h"
+#include "tsl/platform/env.h"
+#include "tsl/platform/errors.h"
+#include "tsl/platform/statusor.h"
+#include "tsl/platform/threadpool.h"
+#include "tsl/platform/tstring.h"
+
+namespace tensorflow {
+namespace data {
+namespace {
+
+constexpr char kNumChunks[] = "num_chunks";
+constexpr char kChunkFile[] = "chunk_file";
+constexpr char kStartIndex[] = "start_index";
+
+// Same as `SnapshotChunkDataset`, which reads one chunk per reader.
+constexpr int64_t kTFRecordReaderOutputBufferSize = 512 << 20;  // 512MB
+
+int64_t ElementBytes(const std::vector<Tensor>& element) {
+  int64_t bytes = 0;
+  for (const Tensor& tensor : element) {
+    bytes += tensor.TotalBytes();
+  }
+  return bytes;
+}
+
+}  // namespace
+
+PrefetchedChunkReader::PrefetchedChunkReader(
+    std::shared_ptr<SplitProvider> chunk_provider,
+    const std::string& compression, const DataTypeVector& dtypes,
+    tsl::Env* env, int64_t max_parallelism, int64_t max_buffered_bytes)
+    : env_(env),
+      compression_(compression),
+      dtypes_(dtypes),
+      max_parallelism_(std::max<int64_t>(max_parallelism, 1)),
+      max_buffered_bytes_(max_buffered_bytes),
+      chunk_provider_(std::move(chunk_provider)) {}
+
+PrefetchedChunkReader::~PrefetchedChunkReader() {
+  Cancel();
+  // Finishes the in-flight threads.
+  std::unique_ptr<tsl::thread::ThreadPool> thread_pool;
+  {
+    absl::MutexLock l(&mu_);
+    thread_pool = std::move(thread_pool_);
+  }
+}
+
+absl::Status PrefetchedChunkReader::GetNext(std::vector<Tensor>* element,
+                                            bool* end_of_sequence)
+    ABSL_LOCKS_EXCLUDED(mu_) {
+  absl::MutexLock l(&mu_);
+  StartReadThreads();
+  bool waited = false;
+  while (true) {
+    TF_RETURN_IF_ERROR(status_);
+    if (chunks_.empty() && end_of_chunks_) {
+      *end_of_sequence = true;
+      return absl::OkStatus();
+    }
+    if (!chunks_.empty()) {
+      Chunk& chunk = *chunks_.front();
+      if (!chunk.elements.empty()) {
+        *element = std::move(chunk.elements.front());
+        chunk.elements.pop_front();
+        ++chunk.num_elements_returned;
+        buffered_bytes_ -= ElementBytes(*element);
+        ready_to_push_.SignalAll();
+        *end_of_sequence = false;
+        return absl::OkStatus();
+      }
+      if (chunk.done) {
+        TF_RETURN_IF_ERROR(chunk.status);
+        chunks_.pop_front();
+        // The next chunk may be read regardless of the buffer size.
+        ready_to_push_.SignalAll();
+        continue;
+      }
+    }
+    // Reads more chunks in parallel if the next element is not ready while
+    // the buffer has room.
+    if (!waited && buffered_bytes_ < max_buffered_bytes_ / 2 &&
+        parallelism_ < max_parallelism_) {
+      ++parallelism_;
+      ready_to_push_.SignalAll();
+    }
+    waited = true;
+    ready_to_pop_.Wait(&mu_);
+  }
+}
+
+void PrefetchedChunkReader::StartReadThreads() {
+  if (thread_pool_ || !status_.ok()) {
+    return;
+  }
+  thread_pool_ = std::make_unique<tsl::thread::ThreadPool>(
+      env_, tsl::ThreadOptions{}, "tf_data_prefetch_chunks_thread",
+      max_parallelism_);
+  for (int64_t i = 0; i < max_parallelism_; ++i) {
+    thread_pool_->Schedule([this]() { ReadLoop(); });
+  }
+}
+
+void PrefetchedChunkReader::ReadLoop() ABSL_LOCKS_EXCLUDED(mu_) {
+  while (true) {
+    absl::StatusOr<std::shared_ptr<Chunk>> chunk = GetNextChunk();
+    if (!chunk.ok()) {
+      UpdateStatus(chunk.status());
+      return;
+    }
+    if (*chunk == nullptr) {
+      return;
+    }
+
+    absl::Status status = ReadChunk(**chunk);
+    absl::MutexLock l(&mu_);
+    (*chunk)->done = true;
+    (*chunk)->status = std::move(status);
+    --num_chunks_reading_;
+    ready_to_push_.SignalAll();
+    ready_to_pop_.SignalAll();
+  }
+}
+
+absl::StatusOr<std::shared_ptr<PrefetchedChunkReader::Chunk>>
+PrefetchedChunkReader::GetNextChunk() ABSL_LOCKS_EXCLUDED(mu_) {
+  {
+    absl::MutexLock l(&mu_);
+    while (status_.ok() && !end_of_chunks_ &&
+           num_chunks_reading_ >= parallelism_) {
+      ready_to_push_.Wait(&mu_);
+    }
+    TF_RETURN_IF_ERROR(status_);
+    if (end_of_chunks_) {
+      return nullptr;
+    }
+    ++num_chunks_reading_;
+  }
+
+  absl::MutexLock provider_lock(&provider_mu_);
+  std::shared_ptr<Chunk> chunk;
+  absl::Status status;
+  bool end_of_chunks = false;
+  if (!restored_chunks_.empty()) {
+    chunk = std::move(restored_chunks_.front());
+    restored_chunks_.pop_front();
+  } else {
+    Tensor chunk_file;
+    status = chunk_provider_->GetNext(&chunk_file, &end_of_chunks);
+    if (status.ok() && !end_of_chunks) {
+      chunk = std::make_shared<Chunk>(chunk_file.scalar<tsl::tstring>()());
+    }
+  }
+
+  absl::MutexLock l(&mu_);
+  if (chunk == nullptr) {
+    --num_chunks_reading_;
+    end_of_chunks_ = end_of_chunks;
+    ready_to_push_.SignalAll();
+    ready_to_pop_.SignalAll();
+    TF_RETURN_IF_ERROR(status);
+    return nullptr;
+  }
+  chunks_.push_back(chunk);
+  return chunk;
+}
+
+absl::Status PrefetchedChunkReader::ReadChunk(Chunk& chunk)
+    ABSL_LOCKS_EXCLUDED(mu_) {
+  snapshot_util::TFRecordReader reader(TranslateFileName(chunk.chunk_file),
+                                       compression_, dtypes_,
+                                       kTFRecordReaderOutputBufferSize);
+  TF_RETURN_IF_ERROR(reader.Initialize(env_));
+  absl::Status status;
+  for (int64_t i = 0;; ++i) {
+    std::vector<Tensor> element;
+    // Reads the element without holding a mutex.
+    status = reader.ReadTensors(&element);
+    if (!status.ok()) {
+      break;
+    }
+    if (i < chunk.start_index) {
+      continue;
+    }
+    const int64_t bytes = ElementBytes(element);
+    absl::MutexLock l(&mu_);
+    if (!WaitForBufferSpace(chunk, bytes)) {
+      return status_;
+    }
+    chunk.elements.push_back(std::move(element));
+    buffered_bytes_ += bytes;
+    ready_to_pop_.SignalAll();
+  }
+
+  absl::MutexLock l(&mu_);
+  bytes_read_ += reader.BytesRead();
+  if (absl::IsOutOfRange(status)) {
+    return absl::OkStatus();
+  }
+  return absl::Status(
+      status.code(), absl::StrCat("Failed to read tf.data snapshot file: ",
+                                  chunk.chunk_file, ": ", status.message()));
+}
+
+bool PrefetchedChunkReader::WaitForBufferSpace(const Chunk& chunk,
+                                               int64_t bytes) {
+  bool waited = false;
+  while (status_.ok() && buffered_bytes_ + bytes > max_buffered_bytes_ &&
+         buffered_bytes_ > 0 && chunks_.front().get() != &chunk) {
+    // Reads fewer chunks in parallel if the buffer is not drained fast
+    // enough for the chunks being read.
+    if (!waited && parallelism_ > 1) {
+      --parallelism_;
+    }
+    waited = true;
+    ready_to_push_.Wait(&mu_);
+  }
+  return status_.ok();
+}
+
+absl::Status PrefetchedChunkReader::Save(
+    std::function<std::string(std::string)> full_name,
+    IteratorStateWriter* writer) ABSL_LOCKS_EXCLUDED(provider_mu_, mu_) {
+  absl::MutexLock provider_lock(&provider_mu_);
+  // The chunks not fully returned, and the number of elements returned from
+  // the first one.
+  std::vector<std::shared_ptr<Chunk>> chunks;
+  int64_t start_index = 0;
+  {
+    absl::MutexLock l(&mu_);
+    TF_RETURN_IF_ERROR(status_);
+    chunks.assign(chunks_.begin(), chunks_.end());
+    chunks.insert(chunks.end(), restored_chunks_.begin(),
+                  restored_chunks_.end());
+    if (!chunks.empty()) {
+      start_index = chunks.front()->num_elements_returned;
+    }
+  }
+
+  TF_RETURN_IF_ERROR(writer->WriteScalar(full_name(kNumChunks),
+                                         static_cast<int64_t>(chunks.size())));
+  for (int64_t i = 0; i < chunks.size(); ++i) {
+    TF_RETURN_IF_ERROR(
+        writer->WriteScalar(full_name(absl::StrCat(kChunkFile, "_", i)),
+                            chunks[i]->chunk_file));
+  }
+  TF_RETURN_IF_ERROR(writer->WriteScalar(full_name(kStartIndex), start_index));
+  return chunk_provider_->Save(full_name, writer);
+}
+
+absl::Status PrefetchedChunkReader::Restore(
+    std::function<std::string(std::string)> full_name,
+    IteratorStateReader* reader) ABSL_LOCKS_EXCLUDED(provider_mu_, mu_) {
+  absl::MutexLock provider_lock(&provider_mu_);
+  {
+    absl::MutexLock l(&mu_);
+    if (thread_pool_) {
+      return absl::FailedPreconditionError(
+          "Failed to restore tf.data snapshot chunk reader: Restore must be "
+          "called before GetNext.");
+    }
+  }
+
+  int64_t num_chunks = 0, start_index = 0;
+  TF_RETURN_IF_ERROR(reader->ReadScalar(full_name(kNumChunks), &num_chunks));
+  TF_RETURN_IF_ERROR(reader->ReadScalar(full_name(kStartIndex), &start_index));
+  restored_chunks_.clear();
+  for (int64_t i = 0; i < num_chunks; ++i) {
+    tsl::tstring chunk_file;
+    TF_RETURN_IF_ERROR(reader->ReadScalar(
+        full_name(absl::StrCat(kChunkFile, "_", i)), &chunk_file));
+    restored_chunks_.push_back(
+        std::make_shared<Chunk>(chunk_file, i == 0 ? start_index : 0));
+    // Skipped elements count as returned in the next checkpoint.
+    restored_chunks_.back()->num_elements_returned =
+        restored_chunks_.back()->start_index;
+  }
+  return chunk_provider_->Restore(full_name, reader);
+}
+
+void PrefetchedChunkReader::Cancel() {
+  UpdateStatus(
+      absl::CancelledError("tf.data prefetched chunk reader is cancelled."));
+  chunk_provider_->Cancel();
+}
+
+int64_t PrefetchedChunkReader::BytesRead() const {
+  absl::MutexLock l(&mu_);
+  return bytes_read_;
+}
+
+void PrefetchedChunkReader::UpdateStatus(absl::Status status)
+    ABSL_LOCKS_EXCLUDED(mu_) {
+  if (status.ok()) {
+    return;
+  }
+  absl::MutexLock l(&mu_);
+  status_.Update(std::move(status));
+  ready_to_push_.SignalAll();
+  ready_to_pop_.SignalAll();
+}
+
+}  // namespace data
+}  // namespace tensorflow
@@ -0,0 +1,169 @@
+/* Copyright 2024 The TensorFlow Authors. All Rights Reserved.
+
+Licensed under the Apache License, Version 2.0 (the "License");
+you may not use this file except in compliance with the License.
+You may obtain a copy of the License at
+
+    http://www.apache.org/licenses/LICENSE-2.0
+
+Unless required by applicable law or agreed to in writing, software
+distributed under the License is distributed on an "AS IS" BASIS,
+WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+See the License for the specific language governing permissions and
+limitations under the License.
+==============================================================================*/
+#ifndef TENSORFLOW_CORE_DATA_SERVICE_SNAPSHOT_PREFETCHED_CHUNK_READER_H_
+#define TENSORFLOW_CORE_DATA_SERVICE_SNAPSHOT_PREFETCHED_CHUNK_READER_H_
+
+#include <cstdint>
+#include <deque>
+#include <functional>
+#include <memory>
+#include <string>
+#include <vector>
+
+#include "absl/base/thread_annotations.h"
+#include "absl/status/status.h"
+#include "absl/status/statusor.h"
+#include "absl/synchronization/mutex.h"
+#include "tensorflow/core/framework/dataset.h"
+#include "tensorflow/core/framework/tensor.h"
+#include "tensorflow/core/framework/types.h"
+#include "tsl/platform/env.h"
+#include "tsl/platform/threadpool.h"
+
+namespace tensorflow {
+namespace data {
+
+// Reads the elements of tf.data snapshot chunks, in the order of the chunks
+// returned by a chunk provider, while prefetching and decompressing the next
+// chunks in parallel. Used to load distributed snapshots from storage with high
+// per-file latency, where reading one chunk at a time is latency-bound. This
+// class is thread-safe.
+//
+// The number of chunks read in parallel is autotuned: it grows when `GetNext`
+// has to wait for the next element while the buffer has room, and shrinks when
+// the readers fill the buffer faster than it is drained.
+//
+// Usage example:
+//
+// std::shared_ptr<SplitProvider> chunk_provider =
+//     std::make_shared<SnapshotChunkProvider>(snapshot_path, env);
+// PrefetchedChunkReader reader(chunk_provider, compression, dtypes, env);
+// std::vector<Tensor> element;
+// bool end_of_sequence = false;
+// TF_RETURN_IF_ERROR(reader.GetNext(&element, &end_of_sequence));
+class PrefetchedChunkReader {
+ public:
+  // Reads the chunk files returned by `chunk_provider` as scalar string
+  // tensors. `max_parallelism` is the maximum number of chunks read in
+  // parallel. `max_buffered_bytes` bounds the size of the elements read but
+  // not returned yet, except for the chunk being returned, which is read even
+  // if the buffer is full so that the reader always makes progress.
+  PrefetchedChunkReader(std::shared_ptr<SplitProvider> chunk_provider,
+                        const std::string& compression,
+                        const DataTypeVector& dtypes, tsl::Env* env,
+                        int64_t max_parallelism = 16,
+                        int64_t max_buffered_bytes = int64_t{1} << 30);
+  virtual ~PrefetchedChunkReader();
+  PrefetchedChunkReader(const PrefetchedChunkReader&) = delete;
+  PrefetchedChunkReader& operator=(const PrefetchedChunkReader&) = delete;
+
+  // Returns the next element. Sets `end_of_sequence` to true if all the chunks
+  // have been read. Blocks until the next element has been read.
+  absl::Status GetNext(std::vector<Tensor>* element, bool* end_of_sequence);
+
+  // Supports checkpointing. `Save` blocks while the next chunk is requested
+  // from the chunk provider. `Restore` must be called before `GetNext`.
+  absl::Status Save(std::function<std::string(std::string)> full_name,
+                    IteratorStateWriter* writer);
+  absl::Status Restore(std::function<std::string(std::string)> full_name,
+                       IteratorStateReader* reader);
+
+  // Cancels the reader. After cancelling, concurrent and future `GetNext`
+  // calls will return a Cancelled error.
+  void Cancel();
+
+  // The number of bytes read from the chunk files.
+  int64_t BytesRead() const;
+
+ private:
+  // A chunk being read, or read but not fully returned.
+  struct Chunk {
+    explicit Chunk(const std::string& chunk_file, int64_t start_index = 0)
+        : chunk_file(chunk_file), start_index(start_index) {}
+
+    const std::string chunk_file;
+    // The number of elements skipped when restoring from a checkpoint.
+    const int64_t start_index;
+
+    // The elements read but not returned.
+    std::deque<std::vector<Tensor>> elements;
+    // The number of elements returned, including the skipped ones.
+    int64_t num_elements_returned = 0;
+    bool done = false;
+    absl::Status status;
+  };
+
+  // Starts the reading threads if they are not running.
+  void StartReadThreads() ABSL_EXCLUSIVE_LOCKS_REQUIRED(mu_);
+
+  // The reading threads run this method to read chunks until there are no
+  // more chunks.
+  void ReadLoop();
+
+  // Waits until fewer than `parallelism_` chunks are being read, then returns
+  // the next chunk to read. Returns nullptr if there are no more chunks.
+  absl::StatusOr<std::shared_ptr<Chunk>> GetNextChunk();
+
+  // Reads the elements of `chunk` into the buffer.
+  absl::Status ReadChunk(Chunk& chunk);
+
+  // Waits until `chunk` can add `bytes` to the buffer. Returns false if the
+  // reader is cancelled or fails.
+  bool WaitForBufferSpace(const Chunk& chunk, int64_t bytes)
+      ABSL_EXCLUSIVE_LOCKS_REQUIRED(mu_);
+
+  // Updates the status and notifies waiters.
+  void UpdateStatus(absl::Status status) ABSL_LOCKS_EXCLUDED(mu_);
+
+  tsl::Env* const env_;
+  const std::string compression_;
+  const DataTypeVector dtypes_;
+  const int64_t max_parallelism_;
+  const int64_t max_buffered_bytes_;
+  const std::shared_ptr<SplitProvider> chunk_provider_;
+
+  // Held while getting the next chunk from `chunk_provider_` and adding it to
+  // `chunks_`, so that the chunks are buffered in the order of the provider,
+  // and checkpoints see both or neither.
+  absl::Mutex provider_mu_ ABSL_ACQUIRED_BEFORE(mu_);
+  // Chunks restored from a checkpoint, to read before the chunk provider's.
+  std::deque<std::shared_ptr<Chunk>> restored_chunks_
+      ABSL_GUARDED_BY(provider_mu_);
+
+  mutable absl::Mutex mu_;
+  absl::CondVar ready_to_push_;
+  absl::CondVar ready_to_pop_;
+
+  absl::Status status_ ABSL_GUARDED_BY(mu_);
+
+  // The chunks to return elements from, in order.
+  std::deque<std::shared_ptr<Chunk>> chunks_ ABSL_GUARDED_BY(mu_);
+  bool end_of_chunks_ ABSL_GUARDED_BY(mu_) = false;
+
+  // The autotuned number of chunks to read in parallel, and the number of
+  // chunks being read.
+  int64_t parallelism_ ABSL_GUARDED_BY(mu_) = 1;
+  int64_t num_chunks_reading_ ABSL_GUARDED_BY(mu_) = 0;
+
+  int64_t buffered_bytes_ ABSL_GUARDED_BY(mu_) = 0;
+  int64_t bytes_read_ ABSL_GUARDED_BY(mu_) = 0;
+
+  std::unique_ptr<tsl::thread::ThreadPool> thread_pool_ ABSL_GUARDED_BY(mu_);
+};
+
+}  // namespace data
+}  // namespace tensorflow
+
+#endif  // TENSORFLOW_CORE_DATA_SERVICE_SNAPSHOT_PREFETCHED_CHUNK_READER_H_
@@ -0,0 +1,190 @@
+/* Copyright 2024 The TensorFlow Authors. All Rights Reserved.
+
+Licensed under the Apache License, Version 2.0 (the "License");
+you may not use this file except in compliance with the License.
+You may obtain a copy of the License at
+
+    http://www.apache.org/licenses/LICENSE-2.0
+
+Unless required by applicable law or agreed to in writing, software
+distributed under the License is distributed on an "AS IS" BASIS,
+WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+See the License for the specific language governing permissions and
+limitations under the License.
+==============================================================================*/
+#include "tensorflow/core/data/service/snapshot/prefetched_chunk_reader.h"
+
+#include <cstdint>
+#include <limits>
+#include <memory>
+#include <string>
+#include <vector>
+
+#include "absl/status/status.h"
+#include "absl/status/statusor.h"
+#include "absl/strings/str_cat.h"
+#include "tensorflow/core/data/serialization_utils.h"
+#include "tensorflow/core/data/service/snapshot/file_utils.h"
+#include "tensorflow/core/data/service/snapshot/path_utils.h"
+#include "tensorflow/core/data/service/snapshot/snapshot_chunk_provider.h"
+#include "tensorflow/core/framework/dataset.h"
+#include "tensorflow/core/framework/tensor.h"
+#include "tensorflow/core/framework/types.h"
+#include "tensorflow/core/framework/variant_tensor_data.h"
+#include "tsl/lib/core/status_test_util.h"
+#include "tsl/lib/io/compression.h"
+#include "tsl/platform/env.h"
+#include "tsl/platform/errors.h"
+#include "tsl/platform/path.h"
+#include "tsl/platform/status_matchers.h"
+#include "tsl/platform/statusor.h"
+#include "tsl/platform/test.h"
+
+namespace tensorflow {
+namespace data {
+namespace {
+
+using ::testing::ElementsAreArray;
+using ::tsl::testing::IsOkAndHolds;
+using ::tsl::testing::StatusIs;
+
+constexpr int64_t kNumStreams = 2;
+constexpr int64_t kNumChunksPerStream = 5;
+constexpr int64_t kNumElementsPerChunk = 10;
+constexpr int64_t kNumElements =
+    kNumStreams * kNumChunksPerStream * kNumElementsPerChunk;
+
+absl::StatusOr<std::string> CreateSnapshotDirectory() {
+  std::string snapshot_path;
+  if (!tsl::Env::Default()->LocalTempFilename(&snapshot_path)) {
+    return absl::FailedPreconditionError(
+        "Failed to create local temp file for snapshot.");
+  }
+  TF_RETURN_IF_ERROR(tsl::Env::Default()->RecursivelyCreateDir(
+      CommittedChunksDirectory(snapshot_path)));
+  return snapshot_path;
+}
+
+int64_t ElementValue(int64_t stream_index, int64_t chunk_index,
+                     int64_t element_index) {
+  return (chunk_index * kNumStreams + stream_index) * kNumElementsPerChunk +
+         element_index;
+}
+
+// Writes a finished snapshot where the elements are consecutive integers in
+// the order of the chunk provider.
+absl::StatusOr<std::string> WriteSnapshot() {
+  TF_ASSIGN_OR_RETURN(std::string snapshot_path, CreateSnapshotDirectory());
+  for (int64_t stream_index = 0; stream_index < kNumStreams; ++stream_index) {
+    for (int64_t chunk_index = 0; chunk_index < kNumChunksPerStream;
+         ++chunk_index) {
+      std::vector<Tensor> elements;
+      for (int64_t i = 0; i < kNumElementsPerChunk; ++i) {
+        elements.push_back(Tensor(ElementValue(stream_index, chunk_index, i)));
+      }
+      TF_RETURN_IF_ERROR(AtomicallyWriteTFRecords(
+          tsl::io::JoinPath(
+              CommittedChunksDirectory(snapshot_path),
+              absl::StrCat("chunk_", stream_index, "_", chunk_index, "_",
+                           kNumElementsPerChunk)),
+          elements, tsl::io::compression::kSnappy, tsl::Env::Default()));
+    }
+  }
+  TF_RETURN_IF_ERROR(AtomicallyWriteStringToFile(
+      SnapshotDoneFilePath(snapshot_path), "", tsl::Env::Default()));
+  return snapshot_path;
+}
+
+std::unique_ptr<PrefetchedChunkReader> CreateReader(
+    const std::string& snapshot_path, int64_t max_parallelism = 4,
+    int64_t max_buffered_bytes = 1 << 20) {
+  return std::make_unique<PrefetchedChunkReader>(
+      std::make_shared<SnapshotChunkProvider>(snapshot_path,
+                                              tsl::Env::Default()),
+      tsl::io::compression::kSnappy, DataTypeVector{DT_INT64},
+      tsl::Env::Default(), max_parallelism, max_buffered_bytes);
+}
+
+absl::StatusOr<std::vector<int64_t>> ReadElements(
+    PrefetchedChunkReader& reader,
+    int64_t max_num_elements = std::numeric_limits<int64_t>::max()) {
+  std::vector<int64_t> result;
+  while (static_cast<int64_t>(result.size()) < max_num_elements) {
+    std::vector<Tensor> element;
+    bool end_of_sequence = false;
+    TF_RETURN_IF_ERROR(reader.GetNext(&element, &end_of_sequence));
+    if (end_of_sequence) {
+      break;
+    }
+    result.push_back(element[0].scalar<int64_t>()());
+  }
+  return result;
+}
+
+std::vector<int64_t> Range(int64_t begin, int64_t end) {
+  std::vector<int64_t> range;
+  for (int64_t i = begin; i < end; ++i) {
+    range.push_back(i);
+  }
+  return range;
+}
+
+std::string full_name(const std::string& name) {
+  return FullName("test", name);
+}
+
+TEST(PrefetchedChunkReaderTest, ReadsChunksInOrder) {
+  TF_ASSERT_OK_AND_ASSIGN(std::string snapshot_path, WriteSnapshot());
+  std::unique_ptr<PrefetchedChunkReader> reader = CreateReader(snapshot_path);
+  EXPECT_THAT(ReadElements(*reader),
+              IsOkAndHolds(ElementsAreArray(Range(0, kNumElements))));
+}
+
+TEST(PrefetchedChunkReaderTest, ReadsChunksInOrderWithSmallBuffer) {
+  TF_ASSERT_OK_AND_ASSIGN(std::string snapshot_path, WriteSnapshot());
+  std::unique_ptr<PrefetchedChunkReader> reader =
+      CreateReader(snapshot_path, /*max_parallelism=*/10,
+                   /*max_buffered_bytes=*/1);
+  EXPECT_THAT(ReadElements(*reader),
+              IsOkAndHolds(ElementsAreArray(Range(0, kNumElements))));
+}
+
+TEST(PrefetchedChunkReaderTest, SaveAndRestore) {
+  TF_ASSERT_OK_AND_ASSIGN(std::string snapshot_path, WriteSnapshot());
+  for (int64_t num_elements_read : {0, 5, 10, 33, kNumElements}) {
+    std::unique_ptr<PrefetchedChunkReader> reader =
+        CreateReader(snapshot_path);
+    TF_ASSERT_OK_AND_ASSIGN(std::vector<int64_t> elements,
+                            ReadElements(*reader, num_elements_read));
+    VariantTensorDataWriter writer;
+    TF_ASSERT_OK(reader->Save(full_name, &writer));
+    std::vector<const VariantTensorData*> variants;
+    writer.GetData(&variants);
+    VariantTensorDataReader variant_reader(variants);
+
+    std::unique_ptr<PrefetchedChunkReader> restored_reader =
+        CreateReader(snapshot_path);
+    TF_ASSERT_OK(restored_reader->Restore(full_name, &variant_reader));
+    TF_ASSERT_OK_AND_ASSIGN(std::vector<int64_t> restored_elements,
+                            ReadElements(*restored_reader));
+    elements.insert(elements.end(), restored_elements.begin(),
+                    restored_elements.end());
+    EXPECT_THAT(elements, ElementsAreArray(Range(0, kNumElements)));
+  }
+}
+
+TEST(PrefetchedChunkReaderTest, Cancel) {
+  // The snapshot is unfinished, so the reader waits for more chunks.
+  TF_ASSERT_OK_AND_ASSIGN(std::string snapshot_path, CreateSnapshotDirectory());
+  std::unique_ptr<PrefetchedChunkReader> reader = CreateReader(snapshot_path);
+  std::unique_ptr<tsl::Thread> cancel_thread(tsl::Env::Default()->StartThread(
+      /*thread_options=*/{}, /*name=*/"cancel_thread", [&reader]() {
+        tsl::Env::Default()->SleepForMicroseconds(1000000);
+        reader->Cancel();
+      }));
+  EXPECT_THAT(ReadElements(*reader), StatusIs(absl::StatusCode::kCancelled));
+}
+
+}  // namespace
+}  // namespace data
+}  // namespace tensorflow
@@ -0,0 +1,226 @@
+/* Copyright 2024 The TensorFlow Authors. All Rights Reserved.
+
+Licensed under the Apache License, Version 2.0 (the "License");
+you may not use this file except in compliance with the License.
+You may obtain a copy of the License at
+
+    http://www.apache.org/licenses/LICENSE-2.0
+
+Unless required by applicable law or agreed to in writing, software
+distributed under the License is distributed on an "AS IS" BASIS,
+WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+See the License for the specific language governing permissions and
+limitations under the License.
+==============================================================================*/
+#include <functional>
+#include <memory>
+#include <string>
+#include <utility>
+#include <vector>
+
+#include "absl/status/status.h"
+#include "absl/strings/string_view.h"
+#include "tensorflow/core/data/name_utils.h"
+#include "tensorflow/core/data/service/snapshot/prefetched_chunk_reader.h"
+#include "tensorflow/core/data/service/snapshot/snapshot_chunk_provider.h"
+#include "tensorflow/core/data/split_utils.h"
+#include "tensorflow/core/framework/cancellation.h"
+#include "tensorflow/core/framework/dataset.h"
+#include "tensorflow/core/framework/metrics.h"
+#include "tensorflow/core/framework/op_kernel.h"
+#include "tensorflow/core/framework/op_requires.h"
+#include "tensorflow/core/framework/tensor_shape.h"
+#include "tensorflow/core/framework/types.h"
+#include "tensorflow/core/graph/graph.h"
+#include "tsl/platform/env.h"
+#include "tsl/platform/errors.h"
+#include "tsl/platform/statusor.h"
+#include "tsl/platform/tstring.h"
+
+namespace tensorflow {
+namespace data {
+namespace {
+
+constexpr const char kReadSnapshotChunksDataset[] = "ReadSnapshotChunksDataset";
+constexpr const char kSnapshotPath[] = "snapshot_path";
+constexpr const char kCompression[] = "compression";
+
+// Reads the elements of all the chunks of a distributed snapshot, in the order
+// of `ListSnapshotChunksDataset`, prefetching the next chunks in parallel.
+class ReadSnapshotChunksDatasetOp : public DatasetOpKernel {
+ public:
+  explicit ReadSnapshotChunksDatasetOp(OpKernelConstruction* ctx);
+
+ protected:
+  void MakeDataset(OpKernelContext* ctx, DatasetBase** output) override;
+
+ private:
+  class Dataset;
+
+  DataTypeVector output_types_;
+  std::vector<PartialTensorShape> output_shapes_;
+  std::string compression_;
+};
+
+class ReadSnapshotChunksDatasetOp::Dataset : public DatasetBase {
+ public:
+  Dataset(OpKernelContext* ctx, tsl::tstring snapshot_path,
+          const std::string& compression, const DataTypeVector& output_types,
+          const std::vector<PartialTensorShape>& output_shapes)
+      : DatasetBase(DatasetContext(ctx)),
+        snapshot_path_(std::move(snapshot_path)),
+        compression_(compression),
+        output_types_(output_types),
+        output_shapes_(output_shapes),
+        env_(ctx->env()) {}
+
+  absl::string_view snapshot_path() const { return snapshot_path_; }
+
+  const DataTypeVector& output_dtypes() const override { return output_types_; }
+
+  const std::vector<PartialTensorShape>& output_shapes() const override {
+    return output_shapes_;
+  }
+
+  absl::Status MakeSplitProviders(std::vector<std::unique_ptr<SplitProvider>>*
+                                      split_providers) const override {
+    split_providers->push_back(
+        std::make_unique<SnapshotChunkProvider>(snapshot_path_, env_));
+    return absl::OkStatus();
+  }
+
+  std::string DebugString() const override {
+    return name_utils::DatasetDebugString(kReadSnapshotChunksDataset);
+  }
+
+  absl::Status InputDatasets(
+      std::vector<const DatasetBase*>* inputs) const override {
+    inputs->clear();
+    return absl::OkStatus();
+  }
+
+  absl::Status CheckExternalState() const override { return absl::OkStatus(); }
+
+ protected:
+  std::unique_ptr<IteratorBase> MakeIteratorInternal(
+      const std::string& prefix) const override;
+
+  absl::Status AsGraphDefInternal(SerializationContext* ctx,
+                                  DatasetGraphDefBuilder* b,
+                                  Node** output) const override {
+    Node* snapshot_path = nullptr;
+    TF_RETURN_IF_ERROR(b->AddScalar(snapshot_path_, &snapshot_path));
+
+    AttrValue compression;
+    b->BuildAttrValue(compression_, &compression);
+
+    return b->AddDataset(this,
+                         /*inputs=*/
+                         {std::make_pair(0, snapshot_path)},
+                         /*list_inputs=*/{},
+                         /*attrs=*/
+                         {{kCompression, compression}},
+                         /*use_dataset_name=*/true, output);
+  }
+
+ private:
+  class Iterator;
+
+  const tsl::tstring snapshot_path_;
+  const std::string compression_;
+  const DataTypeVector output_types_;
+  const std::vector<PartialTensorShape> output_shapes_;
+  tsl::Env* const env_;
+};
+
+class ReadSnapshotChunksDatasetOp::Dataset::Iterator
+    : public DatasetIterator<ReadSnapshotChunksDatasetOp::Dataset> {
+ public:
+  explicit Iterator(const Params& params)
+      : DatasetIterator<ReadSnapshotChunksDatasetOp::Dataset>(params) {}
+
+  ~Iterator() override {
+    if (deregister_fn_) deregister_fn_();
+    if (reader_) {
+      metrics::GetTFDataBytesReadCounter(kReadSnapshotChunksDataset)
+          ->IncrementBy(reader_->BytesRead());
+    }
+  }
+
+  absl::Status Initialize(IteratorContext* ctx) override {
+    std::shared_ptr<SplitProvider> chunk_provider;
+    if (ctx->split_providers().empty()) {
+      chunk_provider = std::make_shared<SnapshotChunkProvider>(
+          dataset()->snapshot_path(), ctx->env());
+    } else {
+      TF_ASSIGN_OR_RETURN(chunk_provider,
+                          GetSingleSplitProvider(ctx, dataset()));
+    }
+    reader_ = std::make_unique<PrefetchedChunkReader>(
+        std::move(chunk_provider), dataset()->compression_,
+        dataset()->output_types_, ctx->env());
+    return RegisterCancellationCallback(
+        ctx->cancellation_manager(), [this]() { reader_->Cancel(); },
+        &deregister_fn_);
+  }
+
+ private:
+  absl::Status GetNextInternal(IteratorContext* ctx,
+                               std::vector<Tensor>* out_tensors,
+                               bool* end_of_sequence) override {
+    return reader_->GetNext(out_tensors, end_of_sequence);
+  }
+
+  absl::Status SaveInternal(SerializationContext* ctx,
+                            IteratorStateWriter* writer) override {
+    return reader_->Save(
+        [&](const std::string& key) { return full_name(key); }, writer);
+  }
+
+  absl::Status RestoreInternal(IteratorContext* ctx,
+                               IteratorStateReader* reader) override {
+    return reader_->Restore(
+        [&](const std::string& key) { return full_name(key); }, reader);
+  }
+
+  std::unique_ptr<PrefetchedChunkReader> reader_;
+  std::function<void()> deregister_fn_;
+};
+
+ReadSnapshotChunksDatasetOp::ReadSnapshotChunksDatasetOp(
+    OpKernelConstruction* ctx)
+    : DatasetOpKernel(ctx) {
+  OP_REQUIRES_OK(ctx, ctx->GetAttr("output_types", &output_types_));
+  OP_REQUIRES_OK(ctx, ctx->GetAttr("output_shapes", &output_shapes_));
+  OP_REQUIRES_OK(ctx, ctx->GetAttr(kCompression, &compression_));
+}
+
+void ReadSnapshotChunksDatasetOp::MakeDataset(OpKernelContext* ctx,
+                                              DatasetBase** output) {
+  tsl::tstring snapshot_path;
+  OP_REQUIRES_OK(ctx, ParseScalarArgument(ctx, kSnapshotPath, &snapshot_path));
+  OP_REQUIRES(ctx, !snapshot_path.empty(),
+              absl::InvalidArgumentError(
+                  "snapshot_path is required to read snapshot chunks."));
+  metrics::RecordTFDataServiceSnapshotOp(std::string(snapshot_path),
+                                         kReadSnapshotChunksDataset);
+  *output = new ReadSnapshotChunksDatasetOp::Dataset(
+      ctx, std::move(snapshot_path), compression_, output_types_,
+      output_shapes_);
+}
+
+std::unique_ptr<IteratorBase>
+ReadSnapshotChunksDatasetOp::Dataset::MakeIteratorInternal(
+    const std::string& prefix) const {
+  return std::make_unique<ReadSnapshotChunksDatasetOp::Dataset::Iterator>(
+      ReadSnapshotChunksDatasetOp::Dataset::Iterator::Params{
+          this,
+          name_utils::IteratorPrefix(kReadSnapshotChunksDataset, prefix)});
+}
+
+REGISTER_KERNEL_BUILDER(Name(kReadSnapshotChunksDataset).Device(DEVICE_CPU),
+                        ReadSnapshotChunksDatasetOp);
+
+}  // namespace
+}  // namespace data
+}  // namespace tensorflow
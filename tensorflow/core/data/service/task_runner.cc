@@ -17,13 +17,16 @@ limitations under the License.
 #include <algorithm>
 #include <memory>
 #include <optional>
+#include <string>
 #include <utility>
 #include <vector>
 
+#include "absl/strings/str_cat.h"
 #include "tensorflow/core/data/service/byte_size.h"
 #include "tensorflow/core/data/service/common.h"
 #include "tensorflow/core/data/service/cross_trainer_cache.h"
 #include "tensorflow/core/data/service/data_transfer.h"
+#include "tensorflow/core/data/service/host_shared_cache.h"
 #include "tensorflow/core/data/service/thread_safe_buffer.h"
 #include "tensorflow/core/data/service/worker.pb.h"
 #include "tensorflow/core/data/standalone.h"
@@ -80,6 +83,7 @@ std::shared_ptr<model::Model> StandaloneTaskIterator::model() const {
 
 Status TaskRunner::Create(const experimental::WorkerConfig& worker_config,
                           const TaskDef& task_def,
+                          const DatasetDef& dataset_def,
                           std::unique_ptr<TaskIterator> iterator,
                           std::unique_ptr<TaskRunner>& out) {
   if (task_def.optional_num_consumers_case() == TaskDef::kNumConsumers) {
@@ -100,8 +104,14 @@ Status TaskRunner::Create(const experimental::WorkerConfig& worker_config,
         worker_config.cross_trainer_cache_size_bytes() > 0
             ? worker_config.cross_trainer_cache_size_bytes()
             : kDefaultCrossTrainerCacheSizeBytes;
-    out = std::make_unique<CachingTaskRunner>(std::move(iterator),
-                                              max_cache_size_bytes);
+    std::string host_shared_cache_dir;
+    if (!worker_config.cross_trainer_cache_shared_dir().empty()) {
+      host_shared_cache_dir = HostSharedCacheDirectory(
+          worker_config.cross_trainer_cache_shared_dir(), dataset_def);
+    }
+    out = std::make_unique<CachingTaskRunner>(
+        std::move(iterator), max_cache_size_bytes,
+        std::move(host_shared_cache_dir));
   } else {
     out = std::make_unique<FirstComeFirstServedTaskRunner>(std::move(iterator));
   }
@@ -178,12 +188,31 @@ std::shared_ptr<model::Model> FirstComeFirstServedTaskRunner::model() const {
 }
 
 CachingTaskRunner::CachingTaskRunner(std::unique_ptr<TaskIterator> iterator,
-                                     size_t max_cache_size_bytes)
+                                     size_t max_cache_size_bytes,
+                                     std::string host_shared_cache_dir)
     : fcfs_task_runner_(std::move(iterator)),
       cache_(max_cache_size_bytes,
-             std::make_unique<GetElementResultSequence>(fcfs_task_runner_)) {
+             MakeSequence(fcfs_task_runner_, max_cache_size_bytes,
+                          host_shared_cache_dir)) {
   LOG(INFO) << "Initialized tf.data service cross-trainer cache with "
-            << ByteSize::Bytes(max_cache_size_bytes) << " of memory.";
+            << ByteSize::Bytes(max_cache_size_bytes) << " of memory"
+            << (host_shared_cache_dir.empty()
+                    ? ""
+                    : absl::StrCat(", shared with the workers of this host in ",
+                                   host_shared_cache_dir))
+            << ".";
+}
+
+std::unique_ptr<CachableSequence<GetElementResult>>
+CachingTaskRunner::MakeSequence(
+    FirstComeFirstServedTaskRunner& fcfs_task_runner,
+    size_t max_cache_size_bytes, const std::string& host_shared_cache_dir) {
+  auto sequence = std::make_unique<GetElementResultSequence>(fcfs_task_runner);
+  if (host_shared_cache_dir.empty()) {
+    return sequence;
+  }
+  return std::make_unique<HostSharedCache>(
+      host_shared_cache_dir, max_cache_size_bytes, std::move(sequence));
 }
 
 CachingTaskRunner::~CachingTaskRunner() { Cancel(); }
@@ -17,6 +17,7 @@ limitations under the License.
 
 #include <memory>
 #include <optional>
+#include <string>
 #include <vector>
 
 #include "tensorflow/core/data/service/common.pb.h"
@@ -25,6 +26,7 @@ limitations under the License.
 #include "tensorflow/core/data/service/thread_safe_buffer.h"
 #include "tensorflow/core/data/service/worker.pb.h"
 #include "tensorflow/core/data/standalone.h"
+#include "tensorflow/core/framework/dataset.pb.h"
 #include "tensorflow/core/framework/tensor.h"
 #include "tensorflow/core/platform/errors.h"
 #include "tensorflow/core/platform/macros.h"
@@ -89,9 +91,10 @@ class StandaloneTaskIterator : public TaskIterator {
 // Interface for providing elements to task consumers.
 class TaskRunner {
  public:
-  // Creates a `TaskRunner` and stores it in `out`.
+  // Creates a `TaskRunner` and stores it in `out`. `dataset_def` is the
+  // dataset of the task.
   static Status Create(const experimental::WorkerConfig& worker_config,
-                       const TaskDef& task_def,
+                       const TaskDef& task_def, const DatasetDef& dataset_def,
                        std::unique_ptr<TaskIterator> iterator,
                        std::unique_ptr<TaskRunner>& out);
   virtual ~TaskRunner() = default;
@@ -150,10 +153,15 @@ class FirstComeFirstServedTaskRunner : public TaskRunner {
 // bounded size and progresses when a trainer that has consumed all elements in
 // the cache. Trainers read from a sliding window of the dataset and may not
 // read the full dataset.
+//
+// If `host_shared_cache_dir` is not empty, the elements are also shared with
+// the other workers of the host through a `HostSharedCache` in that directory,
+// with a window of the same size.
 class CachingTaskRunner : public TaskRunner {
  public:
   explicit CachingTaskRunner(std::unique_ptr<TaskIterator> iterator,
-                             size_t max_cache_size_bytes);
+                             size_t max_cache_size_bytes,
+                             std::string host_shared_cache_dir = "");
   ~CachingTaskRunner() override;
 
   // Gets the next element from the cross-trainer cache, blocking if the data is
@@ -184,6 +192,12 @@ class CachingTaskRunner : public TaskRunner {
     FirstComeFirstServedTaskRunner& fcfs_task_runner_;
   };
 
+  // Returns the sequence of elements to cache, shared through
+  // `host_shared_cache_dir` if it is not empty.
+  static std::unique_ptr<CachableSequence<GetElementResult>> MakeSequence(
+      FirstComeFirstServedTaskRunner& fcfs_task_runner,
+      size_t max_cache_size_bytes, const std::string& host_shared_cache_dir);
+
   FirstComeFirstServedTaskRunner fcfs_task_runner_;
   CrossTrainerCache<GetElementResult> cache_;
 
@@ -352,8 +352,9 @@ Status DataServiceWorkerImpl::EnsureTaskInitialized(
                       MakeDatasetIterator(*dataset, task.task_def));
   auto task_iterator = std::make_unique<StandaloneTaskIterator>(
       std::move(dataset), std::move(iterator));
-  TF_RETURN_IF_ERROR(TaskRunner::Create(
-      config_, task.task_def, std::move(task_iterator), task.task_runner));
+  TF_RETURN_IF_ERROR(TaskRunner::Create(config_, task.task_def, dataset_def,
+                                        std::move(task_iterator),
+                                        task.task_runner));
 
   task.initialized = true;
   VLOG(3) << "Created iterator for task " << task.task_def.task_id();
@@ -16,6 +16,8 @@ limitations under the License.
 #include "tensorflow/core/data/standalone.h"
 
 #include <algorithm>
+#include <cstdint>
+#include <cstring>
 #include <functional>
 #include <iterator>
 #include <memory>
@@ -25,6 +27,8 @@ limitations under the License.
 #include <vector>
 
 #include "absl/memory/memory.h"
+#include "absl/strings/string_view.h"
+#include "absl/types/span.h"
 #include "tensorflow/core/common_runtime/device_mgr.h"
 #include "tensorflow/core/common_runtime/function.h"
 #include "tensorflow/core/common_runtime/graph_constructor.h"
@@ -34,6 +38,7 @@ limitations under the License.
 #include "tensorflow/core/data/dataset_utils.h"
 #include "tensorflow/core/data/root_dataset.h"
 #include "tensorflow/core/data/serialization_utils.h"
+#include "tensorflow/core/data/split_utils.h"
 #include "tensorflow/core/data/tf_data_memory_logger.h"
 #include "tensorflow/core/data/tfdataz_metrics.h"
 #include "tensorflow/core/framework/dataset.h"
@@ -135,6 +140,73 @@ Status Iterator::Restore(const std::vector<Tensor>& saved_iterator) {
 
 std::shared_ptr<model::Model> Iterator::model() const { return ctx_->model(); }
 
+ElementStream::ElementStream(std::vector<Shard> shards)
+    : shards_(std::move(shards)) {}
+
+Status ElementStream::GetShard(int64_t shard, Shard** result) {
+  if (shard < 0 || shard >= shards_.size()) {
+    return errors::InvalidArgument("Shard index must be in [0, ",
+                                   shards_.size(), "), got ", shard);
+  }
+  *result = &shards_[shard];
+  return absl::OkStatus();
+}
+
+Status ElementStream::GetNext(int64_t shard, std::vector<Tensor>* outputs,
+                              bool* end_of_input) {
+  Shard* s;
+  TF_RETURN_IF_ERROR(GetShard(shard, &s));
+  if (s->pending.has_value()) {
+    *outputs = *std::move(s->pending);
+    s->pending.reset();
+    *end_of_input = false;
+    return absl::OkStatus();
+  }
+  outputs->clear();
+  return s->iterator->GetNext(outputs, end_of_input);
+}
+
+Status ElementStream::GetNextInto(int64_t shard, absl::Span<Buffer> buffers,
+                                  bool* end_of_input) {
+  Shard* s;
+  TF_RETURN_IF_ERROR(GetShard(shard, &s));
+  std::vector<Tensor> element;
+  TF_RETURN_IF_ERROR(GetNext(shard, &element, end_of_input));
+  if (*end_of_input) {
+    return absl::OkStatus();
+  }
+  if (element.size() != buffers.size()) {
+    return errors::InvalidArgument("Expected ", element.size(),
+                                   " buffers, one per component, got ",
+                                   buffers.size());
+  }
+  bool fits = true;
+  for (size_t i = 0; i < element.size(); ++i) {
+    const Tensor& component = element[i];
+    if (!DataTypeCanUseMemcpy(component.dtype())) {
+      return errors::InvalidArgument(
+          "Component ", i, " has type ", DataTypeString(component.dtype()),
+          ", which cannot be copied into a buffer. Use `GetNext()` instead.");
+    }
+    buffers[i].shape = component.shape();
+    buffers[i].num_bytes = component.TotalBytes();
+    fits = fits && buffers[i].num_bytes <= buffers[i].size;
+  }
+  if (!fits) {
+    s->pending = std::move(element);
+    return errors::ResourceExhausted(
+        "The buffers are too small for the next element. See the `num_bytes` "
+        "of each buffer for the sizes of its components.");
+  }
+  for (size_t i = 0; i < element.size(); ++i) {
+    const StringPiece data = element[i].tensor_data();
+    if (!data.empty()) {
+      std::memcpy(buffers[i].data, data.data(), data.size());
+    }
+  }
+  return absl::OkStatus();
+}
+
 Status Dataset::FromGraph(Params params, const GraphDef& graph_def,
                           std::unique_ptr<Dataset>* result) {
   Graph graph(OpRegistry::Global());
@@ -195,6 +267,17 @@ Status Dataset::FromGraph(Params params, const GraphDef& graph_def,
   return absl::OkStatus();
 }  // static
 
+Status Dataset::FromSerializedGraph(Params params,
+                                   absl::string_view serialized_graph_def,
+                                   std::unique_ptr<Dataset>* result) {
+  GraphDef graph_def;
+  if (!graph_def.ParseFromArray(serialized_graph_def.data(),
+                                serialized_graph_def.size())) {
+    return errors::InvalidArgument("Failed to parse the serialized GraphDef.");
+  }
+  return FromGraph(std::move(params), graph_def, result);
+}  // static
+
 Status Dataset::MakeIterator(
     std::vector<std::unique_ptr<SplitProvider>> split_providers,
     std::unique_ptr<Iterator>* result) {
@@ -238,6 +321,32 @@ Status Dataset::MakeIterator(std::unique_ptr<Iterator>* result) {
   return MakeIterator(/*split_providers=*/{}, result);
 }
 
+Status Dataset::MakeElementStream(int64_t num_shards,
+                                  std::unique_ptr<ElementStream>* result) {
+  if (num_shards <= 0) {
+    return errors::InvalidArgument("num_shards must be positive, got ",
+                                   num_shards);
+  }
+  std::vector<ElementStream::Shard> shards(num_shards);
+  for (int64_t i = 0; i < num_shards; ++i) {
+    std::vector<std::unique_ptr<SplitProvider>> split_providers;
+    if (num_shards > 1) {
+      // Each shard reads its own copy of the splits of every source, and skips
+      // the splits of the other shards.
+      std::vector<std::unique_ptr<SplitProvider>> source_split_providers;
+      TF_RETURN_IF_ERROR(MakeSplitProviders(&source_split_providers));
+      for (auto& split_provider : source_split_providers) {
+        split_providers.push_back(std::make_unique<ShardingSplitProvider>(
+            num_shards, i, std::move(split_provider)));
+      }
+    }
+    TF_RETURN_IF_ERROR(
+        MakeIterator(std::move(split_providers), &shards[i].iterator));
+  }
+  *result = absl::WrapUnique(new ElementStream(std::move(shards)));
+  return absl::OkStatus();
+}
+
 Status Dataset::MakeSplitProviders(
     std::vector<std::unique_ptr<SplitProvider>>* result) {
   return finalized_dataset_->MakeSplitProviders(result);
@@ -15,11 +15,15 @@ limitations under the License.
 #ifndef TENSORFLOW_CORE_DATA_STANDALONE_H_
 #define TENSORFLOW_CORE_DATA_STANDALONE_H_
 
+#include <cstddef>
+#include <cstdint>
 #include <functional>
 #include <memory>
 #include <optional>
 #include <vector>
 
+#include "absl/strings/string_view.h"
+#include "absl/types/span.h"
 #include "tensorflow/core/common_runtime/device_mgr.h"
 #include "tensorflow/core/data/tfdataz_metrics.h"
 #include "tensorflow/core/data/unbounded_thread_pool.h"
@@ -31,6 +35,7 @@ limitations under the License.
 #include "tensorflow/core/framework/model.h"
 #include "tensorflow/core/framework/resource_mgr.h"
 #include "tensorflow/core/framework/tensor.h"
+#include "tensorflow/core/framework/tensor_shape.h"
 #include "tensorflow/core/lib/core/threadpool.h"
 #include "tensorflow/core/public/session_options.h"
 #include "tsl/platform/status.h"
@@ -73,6 +78,25 @@ namespace standalone {
 //     if (!s.ok()) { /* error handling */ }
 //     if (!end_of_input) { /* output handling */ }
 //   }
+//
+// Programs that do not otherwise use TensorFlow can create a `Dataset` from a
+// pipeline serialized ahead of time with `Dataset::FromSerializedGraph()`, and
+// read it from several threads with an `ElementStream`:
+//
+//   std::unique_ptr<tensorflow::data::standalone::ElementStream> stream;
+//   s = dataset->MakeElementStream(num_threads, &stream);
+//   if (!s.ok()) { /* error handling */ }
+//
+//   // In consumer thread `i`:
+//   std::vector<tensorflow::data::standalone::ElementStream::Buffer> buffers =
+//       /* one caller-owned buffer per component */;
+//   bool end_of_input = false;
+//   while (!end_of_input) {
+//     s = stream->GetNextInto(/*shard=*/i, absl::MakeSpan(buffers),
+//                             &end_of_input);
+//     if (!s.ok()) { /* error handling */ }
+//     if (!end_of_input) { /* output handling */ }
+//   }
 
 class Dataset;
 
@@ -109,6 +133,57 @@ class Iterator {
   std::shared_ptr<TfDatazMetricsCollector> tf_dataz_metrics_collector_;
 };
 
+// Streams the elements of an input pipeline to several consumer threads.
+//
+// The elements are divided into `num_shards()` disjoint shards by distributing
+// the splits of the sources of the pipeline round-robin, and each shard is
+// read by its own iterator, so that consumers of different shards do not
+// contend with each other. Each shard must be read by at most one thread at a
+// time.
+class ElementStream {
+ public:
+  // A caller-owned buffer for one component of an element.
+  struct Buffer {
+    void* data = nullptr;
+    size_t size = 0;
+    // Set by `GetNextInto()` to the shape of the component and the number of
+    // bytes it takes, even if the buffer is too small for it.
+    TensorShape shape;
+    size_t num_bytes = 0;
+  };
+
+  int64_t num_shards() const { return shards_.size(); }
+
+  // Returns the next element of `shard` (if there is one) and an indication of
+  // whether the end of the shard has been reached.
+  Status GetNext(int64_t shard, std::vector<Tensor>* outputs,
+                 bool* end_of_input);
+
+  // Copies the next element of `shard` (if there is one) into `buffers`, which
+  // must have one buffer per component. Only components whose type can be
+  // copied with `memcpy`, i.e. not strings or variants, can be copied into
+  // buffers. If a buffer is too small for its component, returns
+  // `ResourceExhausted` and keeps the element, so that the call can be retried
+  // with larger buffers.
+  Status GetNextInto(int64_t shard, absl::Span<Buffer> buffers,
+                     bool* end_of_input);
+
+ private:
+  friend class Dataset;
+
+  struct Shard {
+    std::unique_ptr<Iterator> iterator;
+    // An element that did not fit into the buffers of `GetNextInto()`.
+    std::optional<std::vector<Tensor>> pending;
+  };
+
+  explicit ElementStream(std::vector<Shard> shards);
+
+  Status GetShard(int64_t shard, Shard** result);
+
+  std::vector<Shard> shards_;
+};
+
 // Represents an input pipeline as a collection of data sources and a logical
 // plan of transformations that operate over the data.
 class Dataset {
@@ -122,6 +197,13 @@ class Dataset {
   static Status FromGraph(Params params, const GraphDef& graph_def,
                           std::unique_ptr<Dataset>* result);
 
+  // Creates a new `Dataset` instance by running the dataset graph serialized
+  // in `serialized_graph_def`, e.g. the output of
+  // `tf.data.Dataset._as_serialized_graph()`.
+  static Status FromSerializedGraph(Params params,
+                                    absl::string_view serialized_graph_def,
+                                    std::unique_ptr<Dataset>* result);
+
   ~Dataset();
 
   // Creates an iterator for this dataset.
@@ -131,6 +213,12 @@ class Dataset {
       std::vector<std::unique_ptr<SplitProvider>> split_providers,
       std::unique_ptr<Iterator>* result);
 
+  // Creates a stream of the elements of this dataset with `num_shards` shards.
+  // If `num_shards` is greater than 1, all sources of the dataset must support
+  // splitting.
+  Status MakeElementStream(int64_t num_shards,
+                           std::unique_ptr<ElementStream>* result);
+
   // Creates split providers for this dataset.
   Status MakeSplitProviders(
       std::vector<std::unique_ptr<SplitProvider>>* result);
@@ -15,12 +15,18 @@ limitations under the License.
 
 #include "tensorflow/core/data/standalone.h"
 
+#include <cstdint>
 #include <memory>
 #include <optional>
+#include <string>
 #include <vector>
 
+#include "absl/memory/memory.h"
+#include "absl/types/span.h"
 #include "tensorflow/core/framework/graph.pb.h"
 #include "tensorflow/core/lib/core/status_test_util.h"
+#include "tensorflow/core/platform/env.h"
+#include "tensorflow/core/platform/errors.h"
 #include "tensorflow/core/platform/test.h"
 #include "tsl/lib/core/status_test_util.h"
 
@@ -574,6 +580,93 @@ TEST(NoAutotune, Standalone) {
   EXPECT_EQ(iterator->model(), nullptr);
 }
 
+std::unique_ptr<Dataset> MakeRangeDatasetFromSerializedGraph() {
+  GraphDef graph_def;
+  protobuf::TextFormat::ParseFromString(kRangeGraphProto, &graph_def);
+  std::string serialized_graph_def;
+  graph_def.SerializeToString(&serialized_graph_def);
+  std::unique_ptr<Dataset> dataset;
+  TF_EXPECT_OK(
+      Dataset::FromSerializedGraph({}, serialized_graph_def, &dataset));
+  return dataset;
+}
+
+TEST(ElementStream, Shards) {
+  std::unique_ptr<Dataset> dataset = MakeRangeDatasetFromSerializedGraph();
+  std::unique_ptr<ElementStream> stream;
+  TF_ASSERT_OK(dataset->MakeElementStream(/*num_shards=*/3, &stream));
+  EXPECT_EQ(stream->num_shards(), 3);
+
+  std::vector<std::vector<int64_t>> shard_outputs(3);
+  {
+    std::vector<std::unique_ptr<Thread>> consumers;
+    for (int64_t shard = 0; shard < 3; ++shard) {
+      consumers.push_back(absl::WrapUnique(Env::Default()->StartThread(
+          {}, "consumer", [&stream, &shard_outputs, shard]() {
+            bool end_of_input = false;
+            while (!end_of_input) {
+              std::vector<Tensor> outputs;
+              TF_EXPECT_OK(stream->GetNext(shard, &outputs, &end_of_input));
+              if (!end_of_input) {
+                shard_outputs[shard].push_back(outputs[0].scalar<int64_t>()());
+              }
+            }
+          })));
+    }
+  }
+  EXPECT_EQ(shard_outputs[0], std::vector<int64_t>({0, 3, 6, 9}));
+  EXPECT_EQ(shard_outputs[1], std::vector<int64_t>({1, 4, 7}));
+  EXPECT_EQ(shard_outputs[2], std::vector<int64_t>({2, 5, 8}));
+}
+
+TEST(ElementStream, Buffers) {
+  std::unique_ptr<Dataset> dataset = MakeRangeDatasetFromSerializedGraph();
+  std::unique_ptr<ElementStream> stream;
+  TF_ASSERT_OK(dataset->MakeElementStream(/*num_shards=*/1, &stream));
+
+  int64_t value = -1;
+  std::vector<ElementStream::Buffer> buffers(1);
+  buffers[0].data = &value;
+  buffers[0].size = sizeof(int32_t);
+  bool end_of_input = false;
+  // The element is kept until it fits into the buffer.
+  EXPECT_TRUE(errors::IsResourceExhausted(
+      stream->GetNextInto(0, absl::MakeSpan(buffers), &end_of_input)));
+  EXPECT_EQ(buffers[0].num_bytes, sizeof(int64_t));
+  EXPECT_EQ(value, -1);
+
+  buffers[0].size = sizeof(value);
+  for (int64_t expected = 0; expected < 10; ++expected) {
+    TF_ASSERT_OK(
+        stream->GetNextInto(0, absl::MakeSpan(buffers), &end_of_input));
+    ASSERT_FALSE(end_of_input);
+    EXPECT_EQ(value, expected);
+    EXPECT_EQ(buffers[0].shape, TensorShape({}));
+  }
+  TF_ASSERT_OK(stream->GetNextInto(0, absl::MakeSpan(buffers), &end_of_input));
+  EXPECT_TRUE(end_of_input);
+}
+
+TEST(ElementStream, InvalidArguments) {
+  std::unique_ptr<Dataset> dataset = MakeRangeDatasetFromSerializedGraph();
+  std::unique_ptr<ElementStream> stream;
+  EXPECT_TRUE(errors::IsInvalidArgument(
+      dataset->MakeElementStream(/*num_shards=*/0, &stream)));
+  TF_ASSERT_OK(dataset->MakeElementStream(/*num_shards=*/2, &stream));
+  std::vector<Tensor> outputs;
+  bool end_of_input = false;
+  EXPECT_TRUE(errors::IsInvalidArgument(
+      stream->GetNext(/*shard=*/2, &outputs, &end_of_input)));
+  std::vector<ElementStream::Buffer> buffers(2);
+  EXPECT_TRUE(errors::IsInvalidArgument(
+      stream->GetNextInto(/*shard=*/0, absl::MakeSpan(buffers),
+                          &end_of_input)));
+
+  std::unique_ptr<Dataset> unparsable;
+  EXPECT_TRUE(errors::IsInvalidArgument(
+      Dataset::FromSerializedGraph({}, "not a graph", &unparsable)));
+}
+
 }  // namespace
 }  // namespace standalone
 }  // namespace data
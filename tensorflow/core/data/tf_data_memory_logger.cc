@@ -39,6 +39,8 @@ struct IteratorMemoryUsage {
   std::optional<std::string> dataset_name;
   int64_t memory_usage;
   std::string model_proto;
+  // The bytes buffered by each iterator of the pipeline.
+  std::string memory_usage_tree;
 };
 
 int64_t TotalMemoryUsage(const std::vector<IteratorMemoryUsage>& usages) {
@@ -61,9 +63,13 @@ void LogDatasetMemoryUsage() {
     if (!s.ok()) {
       LOG(ERROR) << "Failed to convert model to proto: " << s;
     }
-    usages.push_back(IteratorMemoryUsage{metric_collector->DatasetName(),
-                                         total_buffered_bytes,
-                                         model_proto.ShortDebugString()});
+    std::optional<model::Node::MemoryUsage> memory_usage_tree =
+        metric_collector->GetIteratorMemoryUsage();
+    usages.push_back(IteratorMemoryUsage{
+        metric_collector->DatasetName(), total_buffered_bytes,
+        model_proto.ShortDebugString(),
+        memory_usage_tree.has_value() ? memory_usage_tree->DebugString()
+                                      : std::string()});
   }
   std::sort(usages.begin(), usages.end(), [](const auto& a, const auto& b) {
     return a.memory_usage > b.memory_usage;
@@ -84,6 +90,8 @@ void LogDatasetMemoryUsage() {
     } else {
       VLOG(4) << "Dataset " << i << " (no name set): " << usage_string;
     }
+    VLOG(5) << "Buffered bytes per iterator:\n"
+            << usages[i].memory_usage_tree;
     VLOG(5) << "Model proto: " << usages[i].model_proto;
   }
 }
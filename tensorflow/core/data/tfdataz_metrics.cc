@@ -134,6 +134,11 @@ int64_t TfDatazMetricsCollector::GetIteratorTotalMemoryUsage() {
   return iterator_->TotalBufferedBytes();
 }
 
+std::optional<model::Node::MemoryUsage>
+TfDatazMetricsCollector::GetIteratorMemoryUsage() {
+  return iterator_->GetMemoryUsage();
+}
+
 std::shared_ptr<model::Model> TfDatazMetricsCollector::GetModel() {
   return model_;
 }
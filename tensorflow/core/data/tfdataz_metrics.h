@@ -118,6 +118,10 @@ class TfDatazMetricsCollector {
   // buffered in all nodes in the subtree.
   int64_t GetIteratorTotalMemoryUsage();
 
+  // Returns the bytes buffered by the iterator and by each of its input
+  // iterators, or `std::nullopt` if the iterator is not modeled.
+  std::optional<model::Node::MemoryUsage> GetIteratorMemoryUsage();
+
   std::shared_ptr<model::Model> GetModel();
 
  private:
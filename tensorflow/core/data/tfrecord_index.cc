@@ -0,0 +1,302 @@
+/* Copyright 2024 The TensorFlow Authors. All Rights Reserved.
+
+Licensed under the Apache License, Version 2.0 (the "License");
+you may not use this file except in compliance with the License.
+You may obtain a copy of the License at
+
+    http://www.apache.org/licenses/LICENSE-2.0
+
+Unless required by applicable law or agreed to in writing, software
+distributed under the License is distributed on an "AS IS" BASIS,
+WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+See the License for the specific language governing permissions and
+limitations under the License.
+==============================================================================*/
+#include "tensorflow/core/data/tfrecord_index.h"
+
+#include <algorithm>
+#include <cstdint>
+#include <cstring>
+#include <memory>
+#include <numeric>
+#include <string>
+#include <utility>
+#include <vector>
+
+#include "absl/memory/memory.h"
+#include "absl/status/status.h"
+#include "absl/status/statusor.h"
+#include "absl/strings/str_cat.h"
+#include "absl/strings/string_view.h"
+#include "absl/types/span.h"
+#include "tensorflow/core/lib/core/coding.h"
+#include "tensorflow/core/lib/hash/crc32c.h"
+#include "tensorflow/core/lib/io/record_writer.h"
+#include "tensorflow/core/lib/random/random.h"
+#include "tensorflow/core/platform/env.h"
+#include "tensorflow/core/platform/errors.h"
+#include "tensorflow/core/platform/file_system.h"
+#include "tensorflow/core/platform/statusor.h"
+#include "tensorflow/core/platform/tstring.h"
+
+namespace tensorflow {
+namespace data {
+namespace {
+
+constexpr char kIndexSuffix[] = ".index";
+constexpr uint64_t kMagic = 0x5845444e49524654;  // "TFRINDEX"
+constexpr uint64_t kVersion = 1;
+// The magic number, the version and the number of records.
+constexpr size_t kIndexHeaderSize = 3 * sizeof(uint64_t);
+constexpr size_t kIndexFooterSize = sizeof(uint32_t);
+
+constexpr size_t kRecordOverhead =
+    io::RecordWriter::kHeaderSize + io::RecordWriter::kFooterSize;
+
+// Records that are at most this many bytes apart are read together, since
+// reading the gap costs less than another request to the file system.
+constexpr uint64_t kMaxReadGap = 256 << 10;  // 256KB.
+// The maximum number of bytes of one read if it spans more than one record.
+constexpr uint64_t kMaxReadSize = 16 << 20;  // 16MB.
+
+bool HasValidCrc(absl::string_view data, const char* masked_crc) {
+  return crc32c::Unmask(core::DecodeFixed32(masked_crc)) ==
+         crc32c::Value(data.data(), data.size());
+}
+
+}  // namespace
+
+std::string TFRecordIndexFilename(absl::string_view filename) {
+  return absl::StrCat(filename, kIndexSuffix);
+}
+
+absl::Status TFRecordIndexBuilder::Write(Env* env,
+                                         const std::string& filename) const {
+  std::string contents;
+  core::PutFixed64(&contents, kMagic);
+  core::PutFixed64(&contents, kVersion);
+  core::PutFixed64(&contents, lengths_.size());
+  for (uint64_t length : lengths_) {
+    core::PutVarint64(&contents, length);
+  }
+  core::PutFixed32(&contents,
+                   crc32c::Mask(crc32c::Value(contents.data(),
+                                              contents.size())));
+
+  const std::string index_filename = TFRecordIndexFilename(filename);
+  const std::string temp_filename =
+      absl::StrCat(index_filename, ".tmp.", random::New64());
+  TF_RETURN_IF_ERROR(WriteStringToFile(env, temp_filename, contents));
+  return env->RenameFile(temp_filename, index_filename);
+}
+
+absl::StatusOr<std::unique_ptr<IndexedTFRecordWriter>>
+IndexedTFRecordWriter::Create(Env* env, const std::string& filename,
+                              const std::string& compression_type) {
+  if (!compression_type.empty()) {
+    return errors::InvalidArgument(
+        "Indexed TFRecord files must be uncompressed, got compression type ",
+        compression_type, " for ", filename);
+  }
+  std::unique_ptr<WritableFile> file;
+  TF_RETURN_IF_ERROR(env->NewWritableFile(filename, &file));
+  return absl::WrapUnique(
+      new IndexedTFRecordWriter(env, filename, std::move(file)));
+}
+
+IndexedTFRecordWriter::IndexedTFRecordWriter(Env* env, std::string filename,
+                                             std::unique_ptr<WritableFile> file)
+    : env_(env),
+      filename_(std::move(filename)),
+      file_(std::move(file)),
+      writer_(std::make_unique<io::RecordWriter>(file_.get())) {}
+
+absl::Status IndexedTFRecordWriter::WriteRecord(absl::string_view record) {
+  if (writer_ == nullptr) {
+    return errors::FailedPrecondition("Writing to closed TFRecord file ",
+                                      filename_);
+  }
+  TF_RETURN_IF_ERROR(writer_->WriteRecord(record));
+  index_builder_.AddRecord(record.size());
+  return absl::OkStatus();
+}
+
+absl::Status IndexedTFRecordWriter::Close() {
+  if (writer_ == nullptr) {
+    return absl::OkStatus();
+  }
+  TF_RETURN_IF_ERROR(writer_->Close());
+  writer_.reset();
+  TF_RETURN_IF_ERROR(file_->Close());
+  file_.reset();
+  return index_builder_.Write(env_, filename_);
+}
+
+absl::StatusOr<TFRecordIndex> TFRecordIndex::Read(
+    Env* env, const std::string& filename) {
+  const std::string index_filename = TFRecordIndexFilename(filename);
+  std::string contents;
+  TF_RETURN_IF_ERROR(ReadFileToString(env, index_filename, &contents));
+  auto corrupted = [&index_filename](absl::string_view reason) {
+    return errors::DataLoss("Corrupted TFRecord index file ", index_filename,
+                            ": ", reason);
+  };
+  if (contents.size() < kIndexHeaderSize + kIndexFooterSize) {
+    return corrupted("the file is too short");
+  }
+  const size_t footer_offset = contents.size() - kIndexFooterSize;
+  if (!HasValidCrc(absl::string_view(contents.data(), footer_offset),
+                   contents.data() + footer_offset)) {
+    return corrupted("bad checksum");
+  }
+  if (core::DecodeFixed64(contents.data()) != kMagic) {
+    return corrupted("bad magic number");
+  }
+  const uint64_t version = core::DecodeFixed64(contents.data() + 8);
+  if (version != kVersion) {
+    return corrupted(absl::StrCat("unsupported version ", version));
+  }
+
+  const uint64_t num_records = core::DecodeFixed64(contents.data() + 16);
+  StringPiece lengths(contents.data() + kIndexHeaderSize,
+                      footer_offset - kIndexHeaderSize);
+  // Every length takes at least one byte.
+  if (num_records > lengths.size()) {
+    return corrupted("bad number of records");
+  }
+  std::vector<uint64_t> offsets;
+  offsets.reserve(num_records + 1);
+  offsets.push_back(0);
+  for (uint64_t i = 0; i < num_records; ++i) {
+    uint64_t length;
+    if (!core::GetVarint64(&lengths, &length)) {
+      return corrupted("bad record length");
+    }
+    offsets.push_back(offsets.back() + length + kRecordOverhead);
+  }
+  if (!lengths.empty()) {
+    return corrupted("unexpected trailing bytes");
+  }
+  return TFRecordIndex(std::move(offsets));
+}
+
+absl::StatusOr<std::unique_ptr<RandomAccessTFRecordReader>>
+RandomAccessTFRecordReader::Create(Env* env, const std::string& filename) {
+  TF_ASSIGN_OR_RETURN(TFRecordIndex index, TFRecordIndex::Read(env, filename));
+  uint64_t file_size = 0;
+  TF_RETURN_IF_ERROR(env->GetFileSize(filename, &file_size));
+  if (file_size != index.offset(index.num_records())) {
+    return errors::DataLoss("The index of TFRecord file ", filename,
+                            " does not match the file: the index has ",
+                            index.num_records(), " records of ",
+                            index.offset(index.num_records()),
+                            " bytes, but the file has ", file_size, " bytes.");
+  }
+  std::unique_ptr<RandomAccessFile> file;
+  TF_RETURN_IF_ERROR(env->NewRandomAccessFile(filename, &file));
+  return absl::WrapUnique(new RandomAccessTFRecordReader(
+      filename, std::move(file), std::move(index)));
+}
+
+RandomAccessTFRecordReader::RandomAccessTFRecordReader(
+    std::string filename, std::unique_ptr<RandomAccessFile> file,
+    TFRecordIndex index)
+    : filename_(std::move(filename)),
+      file_(std::move(file)),
+      index_(std::move(index)) {}
+
+absl::Status RandomAccessTFRecordReader::ReadRecords(
+    absl::Span<const int64_t> indices, std::vector<tstring>* records) const {
+  for (int64_t index : indices) {
+    if (index < 0 || index >= num_records()) {
+      return errors::OutOfRange("Index out of range [0, ", num_records(),
+                                ") in TFRecord file ", filename_, ": ", index);
+    }
+  }
+  records->clear();
+  records->resize(indices.size());
+
+  // Visits the indices in the order of their offsets, and reads each run of
+  // nearby records with one read.
+  std::vector<size_t> order(indices.size());
+  std::iota(order.begin(), order.end(), 0);
+  std::sort(order.begin(), order.end(), [&indices](size_t a, size_t b) {
+    return indices[a] < indices[b];
+  });
+  size_t i = 0;
+  while (i < order.size()) {
+    const uint64_t begin = index_.offset(indices[order[i]]);
+    uint64_t end = begin + index_.size(indices[order[i]]);
+    size_t j = i + 1;
+    for (; j < order.size(); ++j) {
+      const int64_t next = indices[order[j]];
+      const uint64_t next_end = index_.offset(next) + index_.size(next);
+      if (index_.offset(next) > end + kMaxReadGap ||
+          next_end - begin > kMaxReadSize) {
+        break;
+      }
+      end = std::max(end, next_end);
+    }
+
+    std::string data;
+    TF_RETURN_IF_ERROR(ReadRange(begin, end, &data));
+    for (; i < j; ++i) {
+      const int64_t index = indices[order[i]];
+      TF_RETURN_IF_ERROR(ParseRecord(
+          index,
+          absl::string_view(data).substr(index_.offset(index) - begin,
+                                         index_.size(index)),
+          &(*records)[order[i]]));
+    }
+  }
+  return absl::OkStatus();
+}
+
+absl::Status RandomAccessTFRecordReader::ReadRange(uint64_t begin,
+                                                   uint64_t end,
+                                                   std::string* data) const {
+  const size_t n = end - begin;
+  data->resize(n);
+  StringPiece result;
+  absl::Status status = file_->Read(begin, n, &result, data->data());
+  if (errors::IsOutOfRange(status) || (status.ok() && result.size() < n)) {
+    return errors::DataLoss("Truncated TFRecord file ", filename_,
+                            ": failed to read ", n, " bytes at offset ",
+                            begin);
+  }
+  TF_RETURN_IF_ERROR(status);
+  if (result.data() != data->data()) {
+    std::memcpy(data->data(), result.data(), n);
+  }
+  return absl::OkStatus();
+}
+
+absl::Status RandomAccessTFRecordReader::ParseRecord(int64_t index,
+                                                     absl::string_view data,
+                                                     tstring* record) const {
+  constexpr size_t kLengthSize = sizeof(uint64_t);
+  if (!HasValidCrc(data.substr(0, kLengthSize), data.data() + kLengthSize)) {
+    return errors::DataLoss("Corrupted record ", index, " at offset ",
+                            index_.offset(index), " of TFRecord file ",
+                            filename_, ": bad length checksum");
+  }
+  const uint64_t length = core::DecodeFixed64(data.data());
+  if (length + kRecordOverhead != data.size()) {
+    return errors::DataLoss("The index of TFRecord file ", filename_,
+                            " does not match the file: record ", index,
+                            " has ", length, " bytes, but the index expects ",
+                            data.size() - kRecordOverhead, " bytes.");
+  }
+  const absl::string_view payload =
+      data.substr(io::RecordWriter::kHeaderSize, length);
+  if (!HasValidCrc(payload, payload.data() + length)) {
+    return errors::DataLoss("Corrupted record ", index, " at offset ",
+                            index_.offset(index), " of TFRecord file ",
+                            filename_, ": bad data checksum");
+  }
+  record->assign(payload.data(), payload.size());
+  return absl::OkStatus();
+}
+
+}  // namespace data
+}  // namespace tensorflow
@@ -0,0 +1,156 @@
+/* Copyright 2024 The TensorFlow Authors. All Rights Reserved.
+
+Licensed under the Apache License, Version 2.0 (the "License");
+you may not use this file except in compliance with the License.
+You may obtain a copy of the License at
+
+    http://www.apache.org/licenses/LICENSE-2.0
+
+Unless required by applicable law or agreed to in writing, software
+distributed under the License is distributed on an "AS IS" BASIS,
+WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+See the License for the specific language governing permissions and
+limitations under the License.
+==============================================================================*/
+#ifndef TENSORFLOW_CORE_DATA_TFRECORD_INDEX_H_
+#define TENSORFLOW_CORE_DATA_TFRECORD_INDEX_H_
+
+#include <cstdint>
+#include <memory>
+#include <string>
+#include <vector>
+
+#include "absl/status/status.h"
+#include "absl/status/statusor.h"
+#include "absl/strings/string_view.h"
+#include "absl/types/span.h"
+#include "tensorflow/core/lib/io/record_writer.h"
+#include "tensorflow/core/platform/env.h"
+#include "tensorflow/core/platform/file_system.h"
+#include "tensorflow/core/platform/tstring.h"
+
+namespace tensorflow {
+namespace data {
+
+// An index of the records of an uncompressed TFRecord file, stored in a
+// sidecar file next to it, which lets the records be read in any order with
+// positioned reads.
+//
+// The sidecar consists of a header with a magic number, a version and the
+// number of records, the length of each record as a varint, and a masked
+// CRC32C of all of the preceding bytes. From the lengths, the offset of every
+// record is computed when the index is read, so the index costs about a byte
+// or two per record on disk and 8 bytes per record in memory.
+
+// Returns the name of the index file of the TFRecord file `filename`.
+std::string TFRecordIndexFilename(absl::string_view filename);
+
+// Collects the lengths of the records written to a TFRecord file and writes
+// them to the index file of that file.
+class TFRecordIndexBuilder {
+ public:
+  // Adds a record of `length` bytes of data.
+  void AddRecord(uint64_t length) { lengths_.push_back(length); }
+
+  int64_t num_records() const { return lengths_.size(); }
+
+  // Writes the index of the TFRecord file `filename`. The index file is
+  // written to a temporary file first, so that it is either complete or
+  // absent.
+  absl::Status Write(Env* env, const std::string& filename) const;
+
+ private:
+  std::vector<uint64_t> lengths_;
+};
+
+// Writes an uncompressed TFRecord file and its index.
+class IndexedTFRecordWriter {
+ public:
+  // `compression_type` must be empty: compressed files cannot be read at
+  // arbitrary offsets.
+  static absl::StatusOr<std::unique_ptr<IndexedTFRecordWriter>> Create(
+      Env* env, const std::string& filename,
+      const std::string& compression_type = "");
+
+  absl::Status WriteRecord(absl::string_view record);
+
+  // Closes the TFRecord file and writes its index. The index is written
+  // last, so a TFRecord file with an index is always complete.
+  absl::Status Close();
+
+ private:
+  IndexedTFRecordWriter(Env* env, std::string filename,
+                        std::unique_ptr<WritableFile> file);
+
+  Env* const env_;
+  const std::string filename_;
+  std::unique_ptr<WritableFile> file_;
+  std::unique_ptr<io::RecordWriter> writer_;
+  TFRecordIndexBuilder index_builder_;
+};
+
+// The offsets of the records of a TFRecord file, read from its index file.
+class TFRecordIndex {
+ public:
+  // Reads the index of the TFRecord file `filename`. Returns `NotFound` if the
+  // file has no index.
+  static absl::StatusOr<TFRecordIndex> Read(Env* env,
+                                            const std::string& filename);
+
+  int64_t num_records() const { return offsets_.size() - 1; }
+
+  // The offset in the TFRecord file of record `index`, including its header.
+  uint64_t offset(int64_t index) const { return offsets_[index]; }
+
+  // The number of bytes of record `index`, including its header and footer.
+  uint64_t size(int64_t index) const {
+    return offsets_[index + 1] - offsets_[index];
+  }
+
+ private:
+  explicit TFRecordIndex(std::vector<uint64_t> offsets)
+      : offsets_(std::move(offsets)) {}
+
+  // `offsets_[i]` is the offset of record `i`. The last entry is the size of
+  // the TFRecord file.
+  std::vector<uint64_t> offsets_;
+};
+
+// Reads records from an indexed TFRecord file by index. This class is
+// thread-safe.
+class RandomAccessTFRecordReader {
+ public:
+  static absl::StatusOr<std::unique_ptr<RandomAccessTFRecordReader>> Create(
+      Env* env, const std::string& filename);
+
+  int64_t num_records() const { return index_.num_records(); }
+
+  // Reads the records `indices` into `records`, in the same order. Records
+  // that are close to each other in the file are read with a single positioned
+  // read, so the cost of a batch of indices depends on how many separate
+  // regions of the file they fall into rather than on their number.
+  absl::Status ReadRecords(absl::Span<const int64_t> indices,
+                           std::vector<tstring>* records) const;
+
+ private:
+  RandomAccessTFRecordReader(std::string filename,
+                             std::unique_ptr<RandomAccessFile> file,
+                             TFRecordIndex index);
+
+  // Reads the bytes [`begin`, `end`) of the file into `*data`.
+  absl::Status ReadRange(uint64_t begin, uint64_t end, std::string* data) const;
+
+  // Parses record `index`, which starts `data` and spans
+  // `index_.size(index)` bytes, into `*record`.
+  absl::Status ParseRecord(int64_t index, absl::string_view data,
+                           tstring* record) const;
+
+  const std::string filename_;
+  const std::unique_ptr<RandomAccessFile> file_;
+  const TFRecordIndex index_;
+};
+
+}  // namespace data
+}  // namespace tensorflow
+
+#endif  // TENSORFLOW_CORE_DATA_TFRECORD_INDEX_H_
@@ -0,0 +1,206 @@
+/* Copyright 2024 The TensorFlow Authors. All Rights Reserved.
+
+Licensed under the Apache License, Version 2.0 (the "License");
+you may not use this file except in compliance with the License.
+You may obtain a copy of the License at
+
+    http://www.apache.org/licenses/LICENSE-2.0
+
+Unless required by applicable law or agreed to in writing, software
+distributed under the License is distributed on an "AS IS" BASIS,
+WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+See the License for the specific language governing permissions and
+limitations under the License.
+==============================================================================*/
+#include "tensorflow/core/data/tfrecord_index.h"
+
+#include <algorithm>
+#include <cstdint>
+#include <memory>
+#include <string>
+#include <vector>
+
+#include "absl/strings/str_cat.h"
+#include "tensorflow/core/lib/core/status_test_util.h"
+#include "tensorflow/core/platform/env.h"
+#include "tensorflow/core/platform/errors.h"
+#include "tensorflow/core/platform/path.h"
+#include "tensorflow/core/platform/test.h"
+#include "tensorflow/core/platform/tstring.h"
+#include "tsl/platform/status_matchers.h"
+
+namespace tensorflow {
+namespace data {
+namespace {
+
+using ::testing::ElementsAreArray;
+using ::tsl::testing::StatusIs;
+
+std::string TestFilename(const std::string& name) {
+  return io::JoinPath(testing::TmpDir(), name);
+}
+
+std::string Record(int64_t i, size_t size) {
+  std::string record = absl::StrCat("record ", i, " ");
+  record.resize(std::max(size, record.size()), 'x');
+  return record;
+}
+
+// Writes `num_records` records of `record_size` bytes with an index.
+std::vector<std::string> WriteIndexedFile(const std::string& filename,
+                                          int64_t num_records,
+                                          size_t record_size) {
+  std::vector<std::string> records;
+  auto writer = IndexedTFRecordWriter::Create(Env::Default(), filename);
+  TF_CHECK_OK(writer.status());
+  for (int64_t i = 0; i < num_records; ++i) {
+    records.push_back(Record(i, record_size));
+    TF_CHECK_OK((*writer)->WriteRecord(records.back()));
+  }
+  TF_CHECK_OK((*writer)->Close());
+  return records;
+}
+
+std::vector<tstring> Expected(const std::vector<std::string>& records,
+                              const std::vector<int64_t>& indices) {
+  std::vector<tstring> expected;
+  for (int64_t index : indices) {
+    expected.push_back(records[index]);
+  }
+  return expected;
+}
+
+TEST(TFRecordIndexTest, ReadRecordsInAnyOrder) {
+  const std::string filename = TestFilename("any_order");
+  std::vector<std::string> records =
+      WriteIndexedFile(filename, /*num_records=*/100, /*record_size=*/10);
+
+  TF_ASSERT_OK_AND_ASSIGN(TFRecordIndex index,
+                          TFRecordIndex::Read(Env::Default(), filename));
+  EXPECT_EQ(index.num_records(), 100);
+  TF_ASSERT_OK_AND_ASSIGN(auto reader, RandomAccessTFRecordReader::Create(
+                                           Env::Default(), filename));
+  EXPECT_EQ(reader->num_records(), 100);
+
+  std::vector<int64_t> indices = {99, 3, 42, 0, 3, 57, 56, 1};
+  std::vector<tstring> result;
+  TF_ASSERT_OK(reader->ReadRecords(indices, &result));
+  EXPECT_THAT(result, ElementsAreArray(Expected(records, indices)));
+
+  TF_ASSERT_OK(reader->ReadRecords({}, &result));
+  EXPECT_TRUE(result.empty());
+}
+
+TEST(TFRecordIndexTest, ReadRecordsFarApart) {
+  // The records are larger than the gap up to which records are read together.
+  const std::string filename = TestFilename("far_apart");
+  std::vector<std::string> records =
+      WriteIndexedFile(filename, /*num_records=*/8, /*record_size=*/300 << 10);
+
+  TF_ASSERT_OK_AND_ASSIGN(auto reader, RandomAccessTFRecordReader::Create(
+                                           Env::Default(), filename));
+  std::vector<int64_t> indices = {7, 0, 2, 1, 5};
+  std::vector<tstring> result;
+  TF_ASSERT_OK(reader->ReadRecords(indices, &result));
+  EXPECT_THAT(result, ElementsAreArray(Expected(records, indices)));
+}
+
+TEST(TFRecordIndexTest, EmptyRecordsAndFiles) {
+  const std::string filename = TestFilename("empty_records");
+  std::vector<std::string> records =
+      WriteIndexedFile(filename, /*num_records=*/3, /*record_size=*/0);
+  TF_ASSERT_OK_AND_ASSIGN(auto reader, RandomAccessTFRecordReader::Create(
+                                           Env::Default(), filename));
+  std::vector<tstring> result;
+  TF_ASSERT_OK(reader->ReadRecords({2, 1, 0}, &result));
+  EXPECT_THAT(result, ElementsAreArray(Expected(records, {2, 1, 0})));
+
+  const std::string empty_filename = TestFilename("empty_file");
+  WriteIndexedFile(empty_filename, /*num_records=*/0, /*record_size=*/0);
+  TF_ASSERT_OK_AND_ASSIGN(reader, RandomAccessTFRecordReader::Create(
+                                      Env::Default(), empty_filename));
+  EXPECT_EQ(reader->num_records(), 0);
+}
+
+TEST(TFRecordIndexTest, IndexOutOfRange) {
+  const std::string filename = TestFilename("out_of_range");
+  WriteIndexedFile(filename, /*num_records=*/5, /*record_size=*/10);
+  TF_ASSERT_OK_AND_ASSIGN(auto reader, RandomAccessTFRecordReader::Create(
+                                           Env::Default(), filename));
+  std::vector<tstring> result;
+  EXPECT_THAT(reader->ReadRecords({0, 5}, &result),
+              StatusIs(error::OUT_OF_RANGE));
+  EXPECT_THAT(reader->ReadRecords({-1}, &result),
+              StatusIs(error::OUT_OF_RANGE));
+}
+
+TEST(TFRecordIndexTest, NoIndex) {
+  const std::string filename = TestFilename("no_index");
+  TF_ASSERT_OK(WriteStringToFile(Env::Default(), filename, ""));
+  EXPECT_THAT(RandomAccessTFRecordReader::Create(Env::Default(), filename),
+              StatusIs(error::NOT_FOUND));
+}
+
+TEST(TFRecordIndexTest, CompressedFilesAreNotIndexed) {
+  EXPECT_THAT(IndexedTFRecordWriter::Create(
+                  Env::Default(), TestFilename("compressed"), "ZLIB"),
+              StatusIs(error::INVALID_ARGUMENT));
+}
+
+TEST(TFRecordIndexTest, IndexDoesNotMatchFile) {
+  const std::string filename = TestFilename("mismatch");
+  WriteIndexedFile(filename, /*num_records=*/5, /*record_size=*/10);
+  // Rewrites the file with different records, but leaves the index as is.
+  TF_ASSERT_OK(Env::Default()->RenameFile(TFRecordIndexFilename(filename),
+                                          TestFilename("mismatch_index")));
+  WriteIndexedFile(filename, /*num_records=*/6, /*record_size=*/10);
+  TF_ASSERT_OK(Env::Default()->RenameFile(TestFilename("mismatch_index"),
+                                          TFRecordIndexFilename(filename)));
+  EXPECT_THAT(RandomAccessTFRecordReader::Create(Env::Default(), filename),
+              StatusIs(error::DATA_LOSS));
+}
+
+TEST(TFRecordIndexTest, CorruptedIndex) {
+  const std::string filename = TestFilename("corrupted_index");
+  WriteIndexedFile(filename, /*num_records=*/5, /*record_size=*/10);
+  const std::string index_filename = TFRecordIndexFilename(filename);
+  std::string contents;
+  TF_ASSERT_OK(ReadFileToString(Env::Default(), index_filename, &contents));
+  contents[contents.size() / 2] ^= 1;
+  TF_ASSERT_OK(WriteStringToFile(Env::Default(), index_filename, contents));
+  EXPECT_THAT(TFRecordIndex::Read(Env::Default(), filename),
+              StatusIs(error::DATA_LOSS));
+
+  TF_ASSERT_OK(WriteStringToFile(Env::Default(), index_filename, "short"));
+  EXPECT_THAT(TFRecordIndex::Read(Env::Default(), filename),
+              StatusIs(error::DATA_LOSS));
+}
+
+TEST(TFRecordIndexTest, CorruptedRecord) {
+  const std::string filename = TestFilename("corrupted_record");
+  WriteIndexedFile(filename, /*num_records=*/5, /*record_size=*/10);
+  std::string contents;
+  TF_ASSERT_OK(ReadFileToString(Env::Default(), filename, &contents));
+  contents[contents.size() - 6] ^= 1;
+  TF_ASSERT_OK(WriteStringToFile(Env::Default(), filename, contents));
+
+  TF_ASSERT_OK_AND_ASSIGN(auto reader, RandomAccessTFRecordReader::Create(
+                                           Env::Default(), filename));
+  std::vector<tstring> result;
+  TF_EXPECT_OK(reader->ReadRecords({0, 1, 2, 3}, &result));
+  EXPECT_THAT(reader->ReadRecords({4}, &result), StatusIs(error::DATA_LOSS));
+}
+
+TEST(TFRecordIndexTest, CannotWriteClosedWriter) {
+  TF_ASSERT_OK_AND_ASSIGN(
+      auto writer, IndexedTFRecordWriter::Create(Env::Default(),
+                                                 TestFilename("closed")));
+  TF_ASSERT_OK(writer->Close());
+  TF_EXPECT_OK(writer->Close());
+  EXPECT_THAT(writer->WriteRecord("record"),
+              StatusIs(error::FAILED_PRECONDITION));
+}
+
+}  // namespace
+}  // namespace data
+}  // namespace tensorflow
@@ -67,6 +67,13 @@ void BaseRendezvousMgr::RecvLocalAsync(int64_t step_id,
   FindOrCreate(step_id)->RecvLocalAsync(parsed, std::move(done));
 }
 
+void BaseRendezvousMgr::RecvLocalAsync(int64_t step_id,
+                                       const Rendezvous::ParsedKey& parsed,
+                                       const Rendezvous::Args& recv_args,
+                                       Rendezvous::DoneCallback done) {
+  FindOrCreate(step_id)->RecvLocalAsync(parsed, recv_args, std::move(done));
+}
+
 Status BaseRendezvousMgr::RecvLocal(int64_t step_id,
                                     const Rendezvous::ParsedKey& parsed,
                                     Tensor* val, bool* is_dead) {
@@ -141,7 +148,7 @@ Status BaseRemoteRendezvous::Initialize(WorkerSession* session) {
     std::swap(deferred_calls, deferred_calls_);
   }
   for (auto& call : deferred_calls) {
-    RecvLocalAsyncInternal(call.parsed, std::move(call.done));
+    RecvLocalAsyncInternal(call.parsed, call.recv_args, std::move(call.done));
   }
   return absl::OkStatus();
 }
@@ -346,6 +353,12 @@ void BaseRemoteRendezvous::RecvAsync(const ParsedKey& parsed,
 
 void BaseRemoteRendezvous::RecvLocalAsync(const ParsedKey& parsed,
                                           DoneCallback done) {
+  RecvLocalAsync(parsed, Args(), std::move(done));
+}
+
+void BaseRemoteRendezvous::RecvLocalAsync(const ParsedKey& parsed,
+                                          const Rendezvous::Args& recv_args,
+                                          DoneCallback done) {
   VLOG(2) << "RemoteRendezvous RecvLocal " << this << " " << parsed.FullKey();
   // Test whether the rendezvous is initialized using a shared lock, to avoid
   // the need for exclusive access in the common case.
@@ -359,21 +372,23 @@ void BaseRemoteRendezvous::RecvLocalAsync(const ParsedKey& parsed,
       // rendezvous logic. At some point after Initialize() is called, a Tensor
       // is produced locally that will then be sent in response to the incoming
       // RPC.
-      deferred_calls_.emplace_back(parsed, std::move(done), GetNewRef(this));
+      deferred_calls_.emplace_back(parsed, recv_args, std::move(done),
+                                   GetNewRef(this));
       return;
     }
   }
-  RecvLocalAsyncInternal(parsed, std::move(done));
+  RecvLocalAsyncInternal(parsed, recv_args, std::move(done));
 }
 
-void BaseRemoteRendezvous::RecvLocalAsyncInternal(const ParsedKey& parsed,
-                                                  DoneCallback done) {
+void BaseRemoteRendezvous::RecvLocalAsyncInternal(
+    const ParsedKey& parsed, const Rendezvous::Args& recv_args,
+    DoneCallback done) {
   Status s = ValidateDevices(parsed, true /* is_src */);
   if (!s.ok()) {
     done(s, Args(), Args(), Tensor(), false);
     return;
   }
-  local_.RecvAsync(parsed, Args(), std::move(done));
+  local_.RecvAsync(parsed, recv_args, std::move(done));
 }
 
 void BaseRemoteRendezvous::StartAbort(const Status& s) {
@@ -536,8 +551,11 @@ void BaseRemoteRendezvous::DeregisterCall(BaseRecvTensorCall* call,
 }
 
 BaseRemoteRendezvous::DeferredCall::DeferredCall(
-    const ParsedKey& parsed, DoneCallback done,
-    tsl::core::RefCountPtr<Rendezvous> rendez)
-    : parsed(parsed), done(std::move(done)), rendezvous(std::move(rendez)) {}
+    const ParsedKey& parsed, const Rendezvous::Args& recv_args,
+    DoneCallback done, tsl::core::RefCountPtr<Rendezvous> rendez)
+    : parsed(parsed),
+      recv_args(recv_args),
+      done(std::move(done)),
+      rendezvous(std::move(rendez)) {}
 
 }  // end namespace tensorflow
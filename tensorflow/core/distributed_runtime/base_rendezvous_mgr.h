@@ -87,6 +87,9 @@ class BaseRendezvousMgr : public RendezvousMgrInterface {
   // This method is used by the rpc handler of RecvTensor.
   void RecvLocalAsync(int64_t step_id, const Rendezvous::ParsedKey& parsed,
                       Rendezvous::DoneCallback done) override;
+  void RecvLocalAsync(int64_t step_id, const Rendezvous::ParsedKey& parsed,
+                      const Rendezvous::Args& recv_args,
+                      Rendezvous::DoneCallback done) override;
 
   // Synchronous wrapper for RecvLocalAsync.
   Status RecvLocal(int64_t step_id, const Rendezvous::ParsedKey& parsed,
@@ -160,6 +163,12 @@ class BaseRemoteRendezvous : public RemoteRendezvous {
   // REQUIRES: "parsed" is one that will be Saved into the local rendezvous.
   void RecvLocalAsync(const ParsedKey& parsed, DoneCallback done);
 
+  // Like RecvLocalAsync above, but the receive is abandoned if
+  // "recv_args.cancellation_manager" is cancelled before the tensor is
+  // produced.
+  void RecvLocalAsync(const ParsedKey& parsed,
+                      const Rendezvous::Args& recv_args, DoneCallback done);
+
  protected:
   virtual void RecvFromRemoteAsync(const Rendezvous::ParsedKey& parsed,
                                    const Rendezvous::Args& args,
@@ -206,13 +215,14 @@ class BaseRemoteRendezvous : public RemoteRendezvous {
   // Data structures to handle calls when partially initialized.
   struct DeferredCall {
     const ParsedKey parsed;
+    const Rendezvous::Args recv_args;
     DoneCallback done;
 
     // Keeps a reference to the rendezvous, to keep it alive.
     tsl::core::RefCountPtr<Rendezvous> rendezvous;
 
-    DeferredCall(const ParsedKey& parsed, DoneCallback done,
-                 tsl::core::RefCountPtr<Rendezvous> rendez);
+    DeferredCall(const ParsedKey& parsed, const Rendezvous::Args& recv_args,
+                 DoneCallback done, tsl::core::RefCountPtr<Rendezvous> rendez);
   };
   std::vector<DeferredCall> deferred_calls_ TF_GUARDED_BY(mu_);
 
@@ -269,7 +279,9 @@ class BaseRemoteRendezvous : public RemoteRendezvous {
                           Tensor* out, StatusCallback done);
 
   // Must be called only if fully initialized.
-  void RecvLocalAsyncInternal(const ParsedKey& parsed, DoneCallback done);
+  void RecvLocalAsyncInternal(const ParsedKey& parsed,
+                              const Rendezvous::Args& recv_args,
+                              DoneCallback done);
 
   BaseRemoteRendezvous(const BaseRemoteRendezvous&) = delete;
   void operator=(const BaseRemoteRendezvous&) = delete;
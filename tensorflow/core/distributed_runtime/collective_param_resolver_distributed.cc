@@ -14,6 +14,11 @@ limitations under the License.
 ==============================================================================*/
 #include "tensorflow/core/distributed_runtime/collective_param_resolver_distributed.h"
 
+#include <algorithm>
+#include <string>
+#include <utility>
+#include <vector>
+
 #include "absl/strings/escaping.h"
 #include "tensorflow/core/common_runtime/device.h"
 #include "tensorflow/core/common_runtime/device_mgr.h"
@@ -22,6 +27,7 @@ limitations under the License.
 #include "tensorflow/core/distributed_runtime/worker_cache.h"
 #include "tensorflow/core/framework/device_attributes.pb.h"
 #include "tensorflow/core/platform/errors.h"
+#include "tensorflow/core/platform/fingerprint.h"
 #include "tensorflow/core/platform/status.h"
 #include "tensorflow/core/protobuf/config.pb.h"
 #include "tensorflow/core/util/device_name_utils.h"
@@ -85,6 +91,23 @@ class CompleteInstanceCall : public CancellableCall {
   CompleteInstanceResponse resp_;
 };
 
+// Returns a fingerprint of the devices of `group` and their incarnations.  It
+// does not depend on the order of the members.
+uint64 GroupVersion(const CollGroupParams& group) {
+  std::vector<std::pair<string, uint64>> devices;
+  devices.reserve(group.members.size());
+  for (const CollGroupMember& member : group.members) {
+    devices.emplace_back(member.device.name(), member.device.incarnation());
+  }
+  std::sort(devices.begin(), devices.end());
+  uint64 version = Fingerprint64(strings::StrCat(group.group_key));
+  for (const auto& device : devices) {
+    version = FingerprintCat64(version, Fingerprint64(device.first));
+    version = FingerprintCat64(version, device.second);
+  }
+  return version;
+}
+
 }  // namespace
 
 CollectiveParamResolverDistributed::CollectiveParamResolverDistributed(
@@ -197,6 +220,7 @@ void CollectiveParamResolverDistributed::CompleteInstanceAsync(
             if (ir->status.ok()) {
               response->set_instance_key(cp->instance.instance_key);
               response->set_source_rank(ir->source_rank);
+              response->set_group_version(GroupVersion(cp->group));
             }
           }
         }
@@ -315,6 +339,12 @@ void CollectiveParamResolverDistributed::CompleteGroupDistributed(
   }
 }
 
+bool CollectiveParamResolverDistributed::GroupMatchesLeader(
+    int32_t group_key) {
+  mutex_lock l(group_mu_);
+  return groups_matching_leader_.contains(group_key);
+}
+
 bool CollectiveParamResolverDistributed::InstanceIsCached(
     int32_t group_key, const CollInstanceParams& instance) {
   mutex_lock l(instance_mu_);
@@ -371,6 +401,10 @@ void CollectiveParamResolverDistributed::CompleteInstanceDistributed(
     return CompleteInstanceLocal(device, cp, done);
   } else if (InstanceIsCached(cp->group.group_key, cp->instance)) {
     return CompleteInstanceLocal(device, cp, done);
+  } else if (cp->instance.type != BROADCAST_COLLECTIVE &&
+             GroupMatchesLeader(cp->group.group_key)) {
+    // Only broadcasts need the leader, to learn the source rank.
+    return CompleteInstanceLocal(device, cp, done);
   } else {
     CompleteInstanceCall* call = new CompleteInstanceCall(
         cp->group, cp->instance, cp->name, device, cp->is_source, cancel_mgr,
@@ -389,6 +423,11 @@ void CollectiveParamResolverDistributed::CompleteInstanceDistributed(
       if (s.ok()) {
         s = UpdateInstanceCache(cp, call->resp_);
       }
+      if (s.ok() && call->resp_.group_version() != 0 &&
+          call->resp_.group_version() == GroupVersion(cp->group)) {
+        mutex_lock l(group_mu_);
+        groups_matching_leader_.insert(cp->group.group_key);
+      }
       if (s.ok()) {
         CompleteInstanceLocal(device, cp, done);
       } else {
@@ -15,6 +15,7 @@ limitations under the License.
 #ifndef TENSORFLOW_CORE_DISTRIBUTED_RUNTIME_COLLECTIVE_PARAM_RESOLVER_DISTRIBUTED_H_
 #define TENSORFLOW_CORE_DISTRIBUTED_RUNTIME_COLLECTIVE_PARAM_RESOLVER_DISTRIBUTED_H_
 
+#include "absl/container/flat_hash_set.h"
 #include "tensorflow/core/common_runtime/collective_param_resolver_local.h"
 #include "tensorflow/core/framework/cancellation.h"
 #include "tensorflow/core/framework/device_attributes.pb.h"
@@ -87,9 +88,17 @@ class CollectiveParamResolverDistributed : public CollectiveParamResolverLocal {
                                    const StatusCallback& done)
       TF_LOCKS_EXCLUDED(instance_mu_, group_mu_);
 
+  // Returns true iff the group leader has reported the same group version as
+  // this worker, see CompleteInstanceResponse.group_version.
+  bool GroupMatchesLeader(int32_t group_key) TF_LOCKS_EXCLUDED(group_mu_);
+
   WorkerCacheInterface* worker_cache_;  // Not owned
   const string group_leader_;
   CancellationManager abortion_cancel_mgr_;
+  // Groups for which GroupMatchesLeader() is true.  Like group_table_, this
+  // persists for the lifetime of the resolver, so that instances created by
+  // retracing functions resolve without an RPC to the leader.
+  absl::flat_hash_set<int32_t> groups_matching_leader_ TF_GUARDED_BY(group_mu_);
 };
 
 }  // namespace tensorflow
@@ -89,6 +89,24 @@ class FakeCache : public TestWorkerCache {
     }
     done(errors::Internal("device not found: ", device));
   }
+
+  WorkerInterface* GetOrCreateWorker(const string& target) override {
+    {
+      mutex_lock l(mu_);
+      ++num_calls_[target];
+    }
+    return TestWorkerCache::GetOrCreateWorker(target);
+  }
+
+  // Returns the number of calls that were made to `target`.
+  int NumCalls(const string& target) {
+    mutex_lock l(mu_);
+    return num_calls_[target];
+  }
+
+ private:
+  mutex mu_;
+  absl::flat_hash_map<string, int> num_calls_ TF_GUARDED_BY(mu_);
 };
 
 class FakeNcclCommunicator : public NcclCommunicatorInterface {
@@ -179,16 +197,16 @@ class DeviceResDistTest : public ::testing::Test {
   CollectiveParams* CreateCollectiveParams(int num_workers, int num_devices,
                                            const string& device_type,
                                            CollectiveType coll_type,
-                                           bool is_source) {
+                                           bool is_source,
+                                           int instance_key = 3) {
     const int kGroupKey = 5;
-    const int kInstanceKey = 3;
     auto* cp = new CollectiveParams();
     cp->is_source = is_source;
     cp->group.group_key = kGroupKey;
     cp->group.group_size = num_workers * num_devices;
     cp->group.device_type = DeviceType(device_type);
     cp->group.num_tasks = num_workers;
-    cp->instance.instance_key = kInstanceKey;
+    cp->instance.instance_key = instance_key;
     cp->instance.type = coll_type;
     cp->instance.data_type = DT_FLOAT;
     cp->instance.shape = TensorShape({64});
@@ -349,6 +367,42 @@ TEST_F(DeviceResDistTest, DifferentIncarnation) {
   EXPECT_TRUE(errors::IsFailedPrecondition(status_[device_name]));
 }
 
+TEST_F(DeviceResDistTest, NewInstanceOfResolvedGroup) {
+  const int num_workers = 2;
+  const int num_devices = 2;
+  const string leader = "/job:worker/replica:0/task:0";
+  DefineWorkers(num_workers, num_devices, "CPU", /*nccl*/ false);
+  DefineCollectiveParams(num_workers, num_devices, "CPU");
+  IssueRequests(num_workers, num_devices);
+  ValidateCollectiveParams(num_workers, num_devices);
+  const int num_leader_calls = wc_.NumCalls(leader);
+  EXPECT_GT(num_leader_calls, 0);
+
+  // A reduction with a new instance key in the same group is resolved without
+  // calling the leader.
+  const string task_name = "/job:worker/replica:0/task:1";
+  const string device_name = absl::StrCat(task_name, "/device:CPU:0");
+  cp_[device_name]->Unref();
+  cp_[device_name] =
+      CreateCollectiveParams(num_workers, num_devices, "CPU",
+                             REDUCTION_COLLECTIVE, /*is_source=*/false,
+                             /*instance_key=*/4);
+  Notification done;
+  Status status;
+  Device* device = nullptr;
+  TF_ASSERT_OK(device_mgrs_[task_name]->LookupDevice(device_name, &device));
+  cp_resolvers_[task_name]->CompleteParamsAsync(
+      device->attributes(), cp_[device_name], &cm_, [&](const Status& s) {
+        status = s;
+        done.Notify();
+      });
+  done.WaitForNotification();
+  TF_ASSERT_OK(status);
+  EXPECT_EQ(cp_[device_name]->default_rank, num_devices);
+  EXPECT_EQ(cp_[device_name]->instance.instance_key, 4);
+  EXPECT_EQ(wc_.NumCalls(leader), num_leader_calls);
+}
+
 TEST_F(DeviceResDistTest, BroadcastSourceRank0) {
   const int num_workers = 2;
   const int num_devices = 2;
@@ -70,6 +70,9 @@ class MockCoordinationServiceAgent : public CoordinationServiceAgent {
                std::unique_ptr<CoordinationClient> leader_client,
                StatusCallback error_fn),
               (override));
+  MOCK_METHOD(Status, SetHeartbeatAggregatorClient,
+              (std::unique_ptr<CoordinationClient> aggregator_client),
+              (override));
   MOCK_METHOD(bool, IsInitialized, (), (override));
   MOCK_METHOD(bool, IsConnected, (), (override));
   MOCK_METHOD(bool, IsError, (), (override));
@@ -118,6 +121,8 @@ class MockCoordinationServiceAgent : public CoordinationServiceAgent {
               (std::string_view key,
                (const std::map<std::string, std::string>&)),
               (override));
+  MOCK_METHOD(absl::StatusOr<uint64_t>, AggregateHeartbeat,
+              (const CoordinatedTask& task, uint64_t incarnation), (override));
 };
 
 constexpr auto kTestKey = "test_key";
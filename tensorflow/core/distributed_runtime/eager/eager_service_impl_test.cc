@@ -32,6 +32,7 @@ limitations under the License.
 #include "tensorflow/core/common_runtime/eager/kernel_and_device.h"
 #include "tensorflow/core/common_runtime/eager/tensor_handle.h"
 #include "tensorflow/core/distributed_runtime/eager/cluster_function_library_runtime.h"
+#include "tensorflow/core/distributed_runtime/eager/remote_execute_node.h"
 #include "tensorflow/core/distributed_runtime/eager/remote_mgr.h"
 #include "tensorflow/core/distributed_runtime/rpc/rpc_rendezvous_mgr.h"
 #include "tensorflow/core/distributed_runtime/session_mgr.h"
@@ -1278,6 +1279,103 @@ TEST_F(FunctionWithRemoteInputsTest, KernelAndDeviceFuncAsyncTest) {
   CheckOutputsAndClose(outputs, op_id);
 }
 
+// Test sends a batch of three remote operations in one EnqueueRequest, and
+// the second one fails. The first operation keeps its outputs, and only the
+// failed operation and the one after it, which does not run, are poisoned.
+TEST_F(FunctionWithRemoteInputsTest, RemoteExecuteNodeBatchWithFailedOp) {
+  Init();
+  EagerContext* ctx = nullptr;
+  TF_ASSERT_OK(eager_service_impl_.GetEagerContext(context_id_, &ctx));
+  Device* device;
+  TF_ASSERT_OK(ctx->FindDeviceFromName(local_device_.c_str(), &device));
+  core::RefCountPtr<EagerClient> client;
+  TF_ASSERT_OK(ctx->GetClient(device, &client));
+
+  std::unordered_map<string, AttrValue> const_attrs;
+  AttrValue val;
+  val.set_type(tensorflow::DataType::DT_FLOAT);
+  const_attrs.insert({"dtype", val});
+  val.Clear();
+  SetTensorProto(val.mutable_tensor());
+  const_attrs.insert({"value", val});
+
+  std::unordered_map<string, AttrValue> matmul_attrs;
+  val.Clear();
+  val.set_type(tensorflow::DataType::DT_FLOAT);
+  matmul_attrs.insert({"T", val});
+  val.Clear();
+  val.set_b(false);
+  matmul_attrs.insert({"transpose_a", val});
+  matmul_attrs.insert({"transpose_b", val});
+
+  std::vector<std::unique_ptr<EnqueueRequest>> requests;
+  for (int i = 0; i < 3; ++i) {
+    requests.push_back(std::make_unique<EnqueueRequest>());
+    requests.back()->set_context_id(context_id_);
+  }
+  AddOperationToEnqueueRequest(2, "Const", {}, const_attrs, local_device_,
+                               requests[0].get());
+  // Op 99 does not exist on the worker.
+  AddOperationToEnqueueRequest(
+      3, "MatMul", {std::make_pair(99, 0), std::make_pair(99, 0)},
+      matmul_attrs, local_device_, requests[1].get());
+  AddOperationToEnqueueRequest(4, "Const", {}, const_attrs, local_device_,
+                               requests[2].get());
+
+  std::vector<TensorHandle*> retvals;
+  std::vector<std::unique_ptr<RemoteExecuteNode>> nodes;
+  std::vector<AsyncEagerNode*> batch;
+  for (int i = 0; i < 3; ++i) {
+    TensorHandle* retval = TensorHandle::CreateUnshapedRemoteHandle(
+        /*op_id=*/i + 2, /*output_num=*/0, /*remote_task=*/"",
+        tensorflow::DataType::DT_FLOAT, device, ctx);
+    retvals.push_back(retval);
+    nodes.push_back(std::make_unique<RemoteExecuteNode>(
+        ctx, std::move(requests[i]), device, ctx->GetContextViewId(),
+        client.get(), /*cancellation_manager=*/nullptr, NodeDef(),
+        ctx->FuncLibDef(), /*inputs=*/gtl::InlinedVector<TensorHandle*, 4>(),
+        absl::MakeSpan(&retval, 1)));
+    batch.push_back(nodes.back().get());
+    ASSERT_NE(nodes.back()->BatchKey(), nullptr);
+    ASSERT_EQ(nodes.back()->BatchKey(), nodes.front()->BatchKey());
+  }
+
+  std::vector<Status> statuses(3, errors::Unknown("Not done"));
+  nodes.front()->RunBatchAsync(
+      batch, [&statuses](int i, const Status& s) { statuses[i] = s; });
+
+  TF_EXPECT_OK(statuses[0]);
+  TensorShape shape;
+  TF_ASSERT_OK(retvals[0]->Shape(&shape));
+  EXPECT_EQ(shape, TensorShape({2, 2}));
+
+  EXPECT_EQ(statuses[1].code(), error::INVALID_ARGUMENT);
+  EXPECT_EQ(statuses[2], statuses[1]);
+  EXPECT_EQ(retvals[1]->Shape(&shape), statuses[1]);
+  EXPECT_EQ(retvals[2]->Shape(&shape), statuses[1]);
+
+  // The worker ran the first operation and not the last one.
+  tensorflow::TensorHandle* tensor_handle;
+  TF_EXPECT_OK(eager_service_impl_.GetTensorHandle(
+      context_id_, RemoteTensorHandleInternal(2, 0), &tensor_handle));
+  EXPECT_FALSE(eager_service_impl_
+                   .GetTensorHandle(context_id_,
+                                    RemoteTensorHandleInternal(4, 0),
+                                    &tensor_handle)
+                   .ok());
+
+  nodes.clear();
+  for (TensorHandle* retval : retvals) {
+    retval->Unref();
+  }
+  CloseContextRequest close_context_request;
+  close_context_request.set_context_id(context_id_);
+  close_context_request.set_context_view_id(0);
+  CloseContextResponse close_context_response;
+  TF_ASSERT_OK(eager_service_impl_.CloseContext(&close_context_request,
+                                                &close_context_response));
+}
+
 // Test creates a context and attempts to send a tensor (using the RPC), and
 // then use the tensor.
 TEST_F(EagerServiceImplTest, SendTensorTest) {
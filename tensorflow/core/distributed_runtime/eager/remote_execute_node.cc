@@ -15,6 +15,7 @@ limitations under the License.
 
 #include "tensorflow/core/distributed_runtime/eager/remote_execute_node.h"
 
+#include <algorithm>
 #include <memory>
 #include <vector>
 
@@ -24,6 +25,38 @@ limitations under the License.
 namespace tensorflow {
 namespace eager {
 
+namespace {
+
+// Sets the shapes and devices of `retvals`, the outputs of an operation run on
+// `device`, from `queue_response` if `status` is OK, or poisons them.
+void SetRemoteOutputs(const Status& status,
+                      const QueueResponse* queue_response,
+                      absl::Span<TensorHandle* const> retvals, Device* device,
+                      uint64 context_view_id) {
+  for (size_t i = 0; i < retvals.size(); ++i) {
+    if (status.ok()) {
+      const string output_device =
+          queue_response->device().empty() ? "" : queue_response->device(i);
+      Status s = retvals[i]->SetRemoteShapeAndDevice(
+          queue_response->shape(i), device, context_view_id, output_device);
+
+      if (!s.ok()) {
+        LOG(ERROR) << "Ignoring an error encountered when setting "
+                      "remote shape of tensor handle: "
+                   << retvals[i]
+                   << " with execute status: " << status.ToString()
+                   << " and SetRemoteShape status: " << s.ToString()
+                   << "\nThis should never happen. "
+                      "Please file an issue with the TensorFlow Team.";
+      }
+    } else {
+      retvals[i]->PoisonRemote(status, device, context_view_id);
+    }
+  }
+}
+
+}  // namespace
+
 void RemoteExecuteNode::RunAsync(StatusCallback done) {
   auto response = std::make_shared<EnqueueResponse>();
 
@@ -94,33 +127,77 @@ void RemoteExecuteNode::RunAsync(StatusCallback done) {
           VLOG(3) << "Failed: " << rpc_description << " with status "
                   << status.ToString();
         }
-        for (size_t i = 0; i < retvals.size(); ++i) {
-          if (status.ok()) {
-            const string output_device =
-                response->queue_response(0).device().empty()
-                    ? ""
-                    : response->queue_response(0).device(i);
-            Status s = retvals[i]->SetRemoteShapeAndDevice(
-                response->queue_response(0).shape(i), device, context_view_id,
-                output_device);
-
-            if (!s.ok()) {
-              LOG(ERROR) << "Ignoring an error encountered when setting "
-                            "remote shape of tensor handle: "
-                         << retvals[i]
-                         << " with execute status: " << status.ToString()
-                         << " and SetRemoteShape status: " << s.ToString()
-                         << "\nThis should never happen. "
-                            "Please file an issue with the TensorFlow Team.";
-            }
-          } else {
-            retvals[i]->PoisonRemote(status, device, context_view_id);
-          }
-          retvals[i]->Unref();
+        SetRemoteOutputs(status,
+                         status.ok() ? &response->queue_response(0) : nullptr,
+                         retvals, device, context_view_id);
+        for (auto handle : retvals) {
+          handle->Unref();
         }
         done(status);
       });
 }
 
+const void* RemoteExecuteNode::BatchKey() const {
+  if (needs_remote_inputs_ || cancellation_manager_ != nullptr ||
+      request_->queue_size() != 1) {
+    return nullptr;
+  }
+  return eager_client_;
+}
+
+void RemoteExecuteNode::RunBatchAsync(
+    absl::Span<AsyncEagerNode* const> batch,
+    std::function<void(int, const Status&)> done) {
+  // All nodes of `batch` have the same BatchKey(), and stay alive until their
+  // `done` is called.
+  std::vector<RemoteExecuteNode*> nodes;
+  nodes.reserve(batch.size());
+  auto request = std::make_shared<EnqueueRequest>();
+  request->set_context_id(request_->context_id());
+  for (AsyncEagerNode* async_node : batch) {
+    auto* node = static_cast<RemoteExecuteNode*>(async_node);
+    nodes.push_back(node);
+    *request->add_queue() = node->request_->queue(0);
+  }
+  VLOG(3) << "Issuing a batch of " << nodes.size() << " remote operations";
+
+  auto response = std::make_shared<EnqueueResponse>();
+  auto call_opts = std::make_shared<CallOptions>();
+  call_opts->SetTimeout(
+      eager_context_->session_options().config.operation_timeout_in_ms());
+  eager_client_->StreamingEnqueueAsync(
+      eager_context_->Executor().StreamingEnqueue(), call_opts.get(),
+      request.get(), response.get(),
+      [nodes = std::move(nodes), request, response, call_opts,
+       done = std::move(done)](const Status& status) {
+        if (!status.ok()) {
+          VLOG(3) << "Failed a batch of " << nodes.size()
+                  << " remote operations with status " << status.ToString();
+        }
+        // The worker adds the response of each item before running it, and
+        // stops at the first item that fails, so the items before the last
+        // response succeeded. Only the failed item and the ones after it,
+        // which did not run, get the error.
+        const int num_succeeded =
+            status.ok() ? static_cast<int>(nodes.size())
+                        : std::max(response->queue_response_size() - 1, 0);
+        for (int i = 0; i < nodes.size(); ++i) {
+          Status node_status = i < num_succeeded ? absl::OkStatus() : status;
+          if (node_status.ok() && i >= response->queue_response_size()) {
+            node_status = errors::Internal(
+                "Missing the response of operation ", i, " of a batch of ",
+                nodes.size(), " remote operations.");
+          }
+          RemoteExecuteNode* node = nodes[i];
+          SetRemoteOutputs(node_status,
+                           node_status.ok() ? &response->queue_response(i)
+                                            : nullptr,
+                           node->retvals_, node->device_,
+                           node->context_view_id_);
+          done(i, node_status);
+        }
+      });
+}
+
 }  // namespace eager
 }  // namespace tensorflow
@@ -17,6 +17,7 @@ limitations under the License.
 #define TENSORFLOW_CORE_DISTRIBUTED_RUNTIME_EAGER_REMOTE_EXECUTE_NODE_H_
 
 #include <cstddef>
+#include <functional>
 #include <memory>
 #include <utility>
 
@@ -98,6 +99,15 @@ class RemoteExecuteNode : public AsyncRemoteExecuteNode {
 
   void RunAsync(StatusCallback done) override;
 
+  // Nodes that enqueue one operation on the same worker, and that do not wait
+  // for remote inputs, can be batched.
+  const void* BatchKey() const override;
+
+  // Sends the operations of all of `batch` in a single EnqueueRequest, which
+  // the worker runs back to back.
+  void RunBatchAsync(absl::Span<AsyncEagerNode* const> batch,
+                     std::function<void(int, const Status&)> done) override;
+
   Status SyncExecutors() override { return eager_context_->SyncExecutors(); }
 
   void Abort(Status status) override {
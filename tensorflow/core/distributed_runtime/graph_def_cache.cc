@@ -0,0 +1,82 @@
+/* Copyright 2024 The TensorFlow Authors. All Rights Reserved.
+
+Licensed under the Apache License, Version 2.0 (the "License");
+you may not use this file except in compliance with the License.
+You may obtain a copy of the License at
+
+    http://www.apache.org/licenses/LICENSE-2.0
+
+Unless required by applicable law or agreed to in writing, software
+distributed under the License is distributed on an "AS IS" BASIS,
+WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+See the License for the specific language governing permissions and
+limitations under the License.
+==============================================================================*/
+#include "tensorflow/core/distributed_runtime/graph_def_cache.h"
+
+#include "tensorflow/core/lib/strings/proto_serialization.h"
+#include "tensorflow/core/platform/logging.h"
+#include "tensorflow/core/util/env_var.h"
+
+namespace tensorflow {
+namespace {
+
+int64_t CapacityFromEnv() {
+  int64_t capacity_mb;
+  Status s = ReadInt64FromEnvVar("TF_WORKER_GRAPH_DEF_CACHE_MB", 256,
+                                 &capacity_mb);
+  if (!s.ok()) {
+    LOG(ERROR) << s;
+    capacity_mb = 256;
+  }
+  return capacity_mb * 1024 * 1024;
+}
+
+}  // namespace
+
+GraphDefCache::GraphDefCache() : GraphDefCache(CapacityFromEnv()) {}
+
+GraphDefCache::GraphDefCache(int64_t capacity_bytes)
+    : capacity_bytes_(capacity_bytes) {}
+
+uint64_t GraphDefCache::Fingerprint(const GraphDef& graph_def) {
+  const uint64_t fingerprint = DeterministicProtoHash64(graph_def);
+  return fingerprint == 0 ? 1 : fingerprint;
+}
+
+bool GraphDefCache::Insert(uint64_t fingerprint, const GraphDef& graph_def) {
+  const int64_t bytes = graph_def.ByteSizeLong();
+  if (bytes > capacity_bytes_) return false;
+  auto copy = std::make_shared<const GraphDef>(graph_def);
+  mutex_lock l(mu_);
+  auto it = index_.find(fingerprint);
+  if (it != index_.end()) {
+    entries_.splice(entries_.begin(), entries_, it->second);
+    return true;
+  }
+  entries_.push_front({fingerprint, bytes, std::move(copy)});
+  index_[fingerprint] = entries_.begin();
+  bytes_ += bytes;
+  EvictLocked();
+  return true;
+}
+
+std::shared_ptr<const GraphDef> GraphDefCache::Lookup(uint64_t fingerprint) {
+  mutex_lock l(mu_);
+  auto it = index_.find(fingerprint);
+  if (it == index_.end()) return nullptr;
+  entries_.splice(entries_.begin(), entries_, it->second);
+  return it->second->graph_def;
+}
+
+void GraphDefCache::EvictLocked() {
+  while (bytes_ > capacity_bytes_) {
+    const Entry& entry = entries_.back();
+    VLOG(2) << "Evicting cached graph " << entry.fingerprint;
+    bytes_ -= entry.bytes;
+    index_.erase(entry.fingerprint);
+    entries_.pop_back();
+  }
+}
+
+}  // namespace tensorflow
@@ -0,0 +1,76 @@
+/* Copyright 2024 The TensorFlow Authors. All Rights Reserved.
+
+Licensed under the Apache License, Version 2.0 (the "License");
+you may not use this file except in compliance with the License.
+You may obtain a copy of the License at
+
+    http://www.apache.org/licenses/LICENSE-2.0
+
+Unless required by applicable law or agreed to in writing, software
+distributed under the License is distributed on an "AS IS" BASIS,
+WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+See the License for the specific language governing permissions and
+limitations under the License.
+==============================================================================*/
+#ifndef TENSORFLOW_CORE_DISTRIBUTED_RUNTIME_GRAPH_DEF_CACHE_H_
+#define TENSORFLOW_CORE_DISTRIBUTED_RUNTIME_GRAPH_DEF_CACHE_H_
+
+#include <cstdint>
+#include <list>
+#include <memory>
+#include <utility>
+
+#include "absl/container/flat_hash_map.h"
+#include "tensorflow/core/framework/graph.pb.h"
+#include "tensorflow/core/platform/mutex.h"
+#include "tensorflow/core/platform/thread_annotations.h"
+
+namespace tensorflow {
+
+// GraphDefCache keeps the graph partitions that a worker has recently been
+// asked to register, keyed by the fingerprint of their contents, so that the
+// master can register the same partition again, e.g. in a new session or for
+// another set of fetches, by sending only its fingerprint. When the total size
+// of the cached graphs exceeds `capacity_bytes`, the least recently used ones
+// are evicted. Thread safe.
+class GraphDefCache {
+ public:
+  // The capacity is read from TF_WORKER_GRAPH_DEF_CACHE_MB, 256 MiB by
+  // default. A capacity of 0 disables the cache.
+  GraphDefCache();
+  explicit GraphDefCache(int64_t capacity_bytes);
+
+  // Returns the fingerprint of `graph_def`, which is never 0.
+  static uint64_t Fingerprint(const GraphDef& graph_def);
+
+  // Adds `graph_def` with the given fingerprint. Returns false if it is not
+  // cached because it is larger than the capacity.
+  bool Insert(uint64_t fingerprint, const GraphDef& graph_def)
+      TF_LOCKS_EXCLUDED(mu_);
+
+  // Returns the graph with the given fingerprint, or nullptr if it is not
+  // cached.
+  std::shared_ptr<const GraphDef> Lookup(uint64_t fingerprint)
+      TF_LOCKS_EXCLUDED(mu_);
+
+ private:
+  struct Entry {
+    uint64_t fingerprint;
+    int64_t bytes;
+    std::shared_ptr<const GraphDef> graph_def;
+  };
+
+  void EvictLocked() TF_EXCLUSIVE_LOCKS_REQUIRED(mu_);
+
+  const int64_t capacity_bytes_;
+  mutex mu_;
+  int64_t bytes_ TF_GUARDED_BY(mu_) = 0;
+  // Most recently used first.
+  std::list<Entry> entries_ TF_GUARDED_BY(mu_);
+  absl::flat_hash_map<uint64_t, std::list<Entry>::iterator> index_
+      TF_GUARDED_BY(mu_);
+};
+
+}  // namespace tensorflow
+
+#endif  // TENSORFLOW_CORE_DISTRIBUTED_RUNTIME_GRAPH_DEF_CACHE_H_
@@ -0,0 +1,81 @@
+/* Copyright 2024 The TensorFlow Authors. All Rights Reserved.
+
+Licensed under the Apache License, Version 2.0 (the "License");
+you may not use this file except in compliance with the License.
+You may obtain a copy of the License at
+
+    http://www.apache.org/licenses/LICENSE-2.0
+
+Unless required by applicable law or agreed to in writing, software
+distributed under the License is distributed on an "AS IS" BASIS,
+WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+See the License for the specific language governing permissions and
+limitations under the License.
+==============================================================================*/
+#include "tensorflow/core/distributed_runtime/graph_def_cache.h"
+
+#include "tensorflow/core/lib/strings/strcat.h"
+#include "tensorflow/core/platform/test.h"
+
+namespace tensorflow {
+namespace {
+
+GraphDef MakeGraphDef(const string& name, int num_nodes) {
+  GraphDef graph_def;
+  for (int i = 0; i < num_nodes; ++i) {
+    NodeDef* node = graph_def.add_node();
+    node->set_name(strings::StrCat(name, "/", i));
+    node->set_op("NoOp");
+  }
+  return graph_def;
+}
+
+TEST(GraphDefCacheTest, Fingerprint) {
+  EXPECT_EQ(GraphDefCache::Fingerprint(MakeGraphDef("a", 3)),
+            GraphDefCache::Fingerprint(MakeGraphDef("a", 3)));
+  EXPECT_NE(GraphDefCache::Fingerprint(MakeGraphDef("a", 3)),
+            GraphDefCache::Fingerprint(MakeGraphDef("b", 3)));
+  EXPECT_NE(GraphDefCache::Fingerprint(GraphDef()), 0);
+}
+
+TEST(GraphDefCacheTest, InsertAndLookup) {
+  GraphDefCache cache(1 << 20);
+  const GraphDef graph_def = MakeGraphDef("a", 3);
+  const uint64_t fingerprint = GraphDefCache::Fingerprint(graph_def);
+  EXPECT_EQ(cache.Lookup(fingerprint), nullptr);
+  EXPECT_TRUE(cache.Insert(fingerprint, graph_def));
+  auto cached = cache.Lookup(fingerprint);
+  ASSERT_NE(cached, nullptr);
+  EXPECT_EQ(cached->SerializeAsString(), graph_def.SerializeAsString());
+}
+
+TEST(GraphDefCacheTest, EvictsLeastRecentlyUsed) {
+  const GraphDef a = MakeGraphDef("a", 10);
+  const GraphDef b = MakeGraphDef("b", 10);
+  const GraphDef c = MakeGraphDef("c", 10);
+  // Room for two of the graphs.
+  GraphDefCache cache(a.ByteSizeLong() * 2 + 1);
+  ASSERT_TRUE(cache.Insert(1, a));
+  ASSERT_TRUE(cache.Insert(2, b));
+  EXPECT_NE(cache.Lookup(1), nullptr);
+  ASSERT_TRUE(cache.Insert(3, c));
+  EXPECT_NE(cache.Lookup(1), nullptr);
+  EXPECT_EQ(cache.Lookup(2), nullptr);
+  EXPECT_NE(cache.Lookup(3), nullptr);
+}
+
+TEST(GraphDefCacheTest, DoesNotCacheGraphsLargerThanCapacity) {
+  const GraphDef graph_def = MakeGraphDef("a", 10);
+  GraphDefCache cache(graph_def.ByteSizeLong() - 1);
+  EXPECT_FALSE(cache.Insert(1, graph_def));
+  EXPECT_EQ(cache.Lookup(1), nullptr);
+}
+
+TEST(GraphDefCacheTest, Disabled) {
+  GraphDefCache cache(0);
+  EXPECT_FALSE(cache.Insert(1, MakeGraphDef("a", 1)));
+  EXPECT_EQ(cache.Lookup(1), nullptr);
+}
+
+}  // namespace
+}  // namespace tensorflow
@@ -24,11 +24,13 @@ limitations under the License.
 #include <utility>
 #include <vector>
 
+#include "absl/container/flat_hash_set.h"
 #include "absl/status/status.h"
 #include "tensorflow/core/common_runtime/process_util.h"
 #include "tensorflow/core/common_runtime/profile_handler.h"
 #include "tensorflow/core/common_runtime/stats_publisher_interface.h"
 #include "tensorflow/core/debug/debug_graph_utils.h"
+#include "tensorflow/core/distributed_runtime/graph_def_cache.h"
 #include "tensorflow/core/distributed_runtime/request_id.h"
 #include "tensorflow/core/distributed_runtime/scheduler.h"
 #include "tensorflow/core/distributed_runtime/worker_cache.h"
@@ -445,6 +447,39 @@ Status MasterSession::ReffedClientGraph::DoBuildPartitions(
   return Partition(popts, &client_graph->graph, out_partitions);
 }
 
+namespace {
+// Tracks the graph partitions that workers have reported as cached, see
+// RegisterGraphRequest.graph_def_fingerprint. It is shared by all sessions,
+// since the point is to avoid sending a worker a partition it has already
+// received in another session.
+class CachedGraphDefs {
+ public:
+  static CachedGraphDefs* Global() {
+    static CachedGraphDefs* cached_graph_defs = new CachedGraphDefs;
+    return cached_graph_defs;
+  }
+
+  bool Contains(const string& worker, uint64 fingerprint) {
+    mutex_lock l(mu_);
+    return cached_.contains({worker, fingerprint});
+  }
+
+  void Add(const string& worker, uint64 fingerprint) {
+    mutex_lock l(mu_);
+    // Workers evict graphs, so a stale entry only costs a retry. Forget
+    // everything rather than track the eviction order.
+    if (cached_.size() >= kMaxEntries) cached_.clear();
+    cached_.insert({worker, fingerprint});
+  }
+
+ private:
+  static constexpr int kMaxEntries = 1 << 20;
+
+  mutex mu_;
+  absl::flat_hash_set<std::pair<string, uint64>> cached_ TF_GUARDED_BY(mu_);
+};
+}  // namespace
+
 Status MasterSession::ReffedClientGraph::DoRegisterPartitions(
     const PartitionOptions& popts,
     std::unordered_map<string, GraphDef> graph_partitions) {
@@ -472,6 +507,9 @@ Status MasterSession::ReffedClientGraph::DoRegisterPartitions(
     RegisterGraphRequest req;
     RegisterGraphResponse resp;
     Status status;
+    // The partition, if `req` carries only its fingerprint.
+    GraphDef elided_graph_def;
+    bool graph_def_elided = false;
   };
   const int num = partitions_.size();
   gtl::InlinedVector<Call, 4> calls(num);
@@ -490,10 +528,33 @@ Status MasterSession::ReffedClientGraph::DoRegisterPartitions(
         callable_opts_.run_options().debug_options();
     c->req.set_collective_graph_key(collective_graph_key_);
     VLOG(2) << "Register " << c->req.graph_def().DebugString();
-    auto cb = [c, &done](const Status& s) {
+    const uint64 fingerprint = GraphDefCache::Fingerprint(c->req.graph_def());
+    c->req.set_graph_def_fingerprint(fingerprint);
+    if (CachedGraphDefs::Global()->Contains(part.name, fingerprint)) {
+      c->elided_graph_def.Swap(c->req.mutable_graph_def());
+      c->req.clear_graph_def();
+      c->graph_def_elided = true;
+    }
+    StatusCallback finish = [c, &done, name = part.name,
+                             fingerprint](const Status& s) {
+      if (s.ok() && c->resp.graph_def_cached()) {
+        CachedGraphDefs::Global()->Add(name, fingerprint);
+      }
       c->status = s;
       done.DecrementCount();
     };
+    auto cb = [c, worker = part.worker, finish](const Status& s) {
+      if (errors::IsNotFound(s) && c->graph_def_elided) {
+        // The worker has evicted the partition or has restarted.
+        VLOG(1) << "Registering a graph that is no longer cached: " << s;
+        c->graph_def_elided = false;
+        c->req.mutable_graph_def()->Swap(&c->elided_graph_def);
+        c->resp.Clear();
+        worker->RegisterGraphAsync(&c->req, &c->resp, finish);
+        return;
+      }
+      finish(s);
+    };
     part.worker->RegisterGraphAsync(&c->req, &c->resp, cb);
   }
   done.Wait();
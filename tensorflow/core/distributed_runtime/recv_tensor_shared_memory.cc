@@ -0,0 +1,164 @@
+/* Copyright 2024 The TensorFlow Authors. All Rights Reserved.
+
+Licensed under the Apache License, Version 2.0 (the "License");
+you may not use this file except in compliance with the License.
+You may obtain a copy of the License at
+
+    http://www.apache.org/licenses/LICENSE-2.0
+
+Unless required by applicable law or agreed to in writing, software
+distributed under the License is distributed on an "AS IS" BASIS,
+WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+See the License for the specific language governing permissions and
+limitations under the License.
+==============================================================================*/
+#include "tensorflow/core/distributed_runtime/recv_tensor_shared_memory.h"
+
+#include <cstdint>
+#include <memory>
+#include <string>
+
+#include "absl/container/flat_hash_map.h"
+#include "absl/status/status.h"
+#include "absl/strings/str_cat.h"
+#include "tensorflow/core/distributed_runtime/shared_memory_segment.h"
+#include "tensorflow/core/framework/types.h"
+#include "tensorflow/core/lib/random/random.h"
+#include "tensorflow/core/platform/env.h"
+#include "tensorflow/core/platform/errors.h"
+#include "tensorflow/core/platform/host_info.h"
+#include "tensorflow/core/platform/logging.h"
+#include "tensorflow/core/platform/mutex.h"
+#include "tensorflow/core/protobuf/transport_options.pb.h"
+#include "tensorflow/core/util/env_var.h"
+
+namespace tensorflow {
+namespace {
+
+// Smaller tensors are sent in the RPC response, where they cost less than a
+// round trip through the segment.
+constexpr int64_t kMinSharedMemoryTensorBytes = 64 << 10;
+
+// Returns the segment of this process, or nullptr if the transport is
+// disabled or the segment could not be created.
+SharedMemorySegment* LocalSegment() {
+  static SharedMemorySegment* segment = []() -> SharedMemorySegment* {
+    int64_t num_slots;
+    int64_t slot_bytes;
+    TF_CHECK_OK(ReadInt64FromEnvVar("TF_RECV_TENSOR_SHARED_MEMORY_SLOTS", 0,
+                                    &num_slots));
+    TF_CHECK_OK(ReadInt64FromEnvVar("TF_RECV_TENSOR_SHARED_MEMORY_SLOT_BYTES",
+                                    16 << 20, &slot_bytes));
+    if (num_slots <= 0 || slot_bytes < kMinSharedMemoryTensorBytes) {
+      return nullptr;
+    }
+    const std::string name =
+        absl::StrCat("/tf_recv_tensor_", Env::Default()->GetProcessId(), "_",
+                     random::New64());
+    auto segment = SharedMemorySegment::Create(name, num_slots, slot_bytes);
+    if (!segment.ok()) {
+      LOG(WARNING) << "Failed to create the RecvTensor shared memory segment "
+                   << name << ": " << segment.status();
+      return nullptr;
+    }
+    VLOG(1) << "Created the RecvTensor shared memory segment " << name
+            << " with " << num_slots << " slots of " << slot_bytes
+            << " bytes.";
+    return segment->release();
+  }();
+  return segment;
+}
+
+// Returns the segment `name` of another process, opening it on first use, or
+// nullptr if it cannot be opened.
+SharedMemorySegment* RemoteSegment(const std::string& name) {
+  static mutex* mu = new mutex;
+  static auto* segments =
+      new absl::flat_hash_map<std::string,
+                              std::unique_ptr<SharedMemorySegment>>;
+  mutex_lock l(*mu);
+  auto it = segments->find(name);
+  if (it == segments->end()) {
+    auto segment = SharedMemorySegment::Open(name);
+    if (!segment.ok()) {
+      // Failures are remembered so that the segment is not opened again for
+      // every tensor.
+      VLOG(1) << "Failed to open the RecvTensor shared memory segment " << name
+              << ": " << segment.status();
+    }
+    it = segments
+             ->emplace(name, segment.ok() ? *std::move(segment) : nullptr)
+             .first;
+  }
+  return it->second.get();
+}
+
+}  // namespace
+
+void MaybeAddSharedMemoryRecvTensorOptions(RecvTensorRequest* request) {
+  SharedMemorySegment* segment = LocalSegment();
+  if (segment == nullptr) return;
+  SharedMemoryRecvTensorOptions options;
+  options.set_host(port::Hostname());
+  options.set_segment_name(segment->name());
+  request->mutable_transport_options()->PackFrom(options);
+}
+
+bool MaybeWriteTensorToSharedMemory(const RecvTensorRequest& request,
+                                    const Tensor& tensor,
+                                    RecvTensorResponse* response) {
+  SharedMemoryRecvTensorOptions options;
+  if (!request.has_transport_options() ||
+      !request.transport_options().UnpackTo(&options)) {
+    return false;
+  }
+  if (!DataTypeCanUseMemcpy(tensor.dtype()) ||
+      tensor.TotalBytes() < kMinSharedMemoryTensorBytes ||
+      options.host() != port::Hostname()) {
+    return false;
+  }
+  SharedMemorySegment* segment = RemoteSegment(options.segment_name());
+  if (segment == nullptr) return false;
+  auto slot = segment->Write(tensor.tensor_data());
+  if (!slot.ok()) {
+    VLOG(2) << "Sending a tensor of " << tensor.TotalBytes()
+            << " bytes in the RecvTensor response: " << slot.status();
+    return false;
+  }
+  response->Clear();
+  TensorProto* proto = response->mutable_tensor();
+  proto->set_dtype(tensor.dtype());
+  tensor.shape().AsProto(proto->mutable_tensor_shape());
+  SharedMemoryTensorLocation location;
+  location.set_slot(*slot);
+  location.set_num_bytes(tensor.TotalBytes());
+  response->mutable_transport_options()->PackFrom(location);
+  response->set_send_start_micros(Env::Default()->NowMicros());
+  return true;
+}
+
+absl::Status MaybeReadTensorFromSharedMemory(TensorResponse* response) {
+  const RecvTensorResponse& meta = response->metadata();
+  SharedMemoryTensorLocation location;
+  if (!meta.has_transport_options() ||
+      !meta.transport_options().UnpackTo(&location)) {
+    return absl::OkStatus();
+  }
+  SharedMemorySegment* segment = LocalSegment();
+  if (segment == nullptr) {
+    return errors::Internal(
+        "Received a tensor in shared memory, but this process has no "
+        "RecvTensor shared memory segment");
+  }
+  StringPiece buf = response->tensor().tensor_data();
+  if (static_cast<int64_t>(buf.size()) != location.num_bytes()) {
+    return errors::Internal("Received a tensor of ", buf.size(),
+                            " bytes in shared memory with ",
+                            location.num_bytes(), " bytes of content");
+  }
+  // The tensor was allocated for the contents when the response was parsed.
+  return segment->Read(location.slot(), location.num_bytes(),
+                       const_cast<char*>(buf.data()));
+}
+
+}  // namespace tensorflow
@@ -0,0 +1,56 @@
+/* Copyright 2024 The TensorFlow Authors. All Rights Reserved.
+
+Licensed under the Apache License, Version 2.0 (the "License");
+you may not use this file except in compliance with the License.
+You may obtain a copy of the License at
+
+    http://www.apache.org/licenses/LICENSE-2.0
+
+Unless required by applicable law or agreed to in writing, software
+distributed under the License is distributed on an "AS IS" BASIS,
+WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+See the License for the specific language governing permissions and
+limitations under the License.
+==============================================================================*/
+#ifndef TENSORFLOW_CORE_DISTRIBUTED_RUNTIME_RECV_TENSOR_SHARED_MEMORY_H_
+#define TENSORFLOW_CORE_DISTRIBUTED_RUNTIME_RECV_TENSOR_SHARED_MEMORY_H_
+
+#include "absl/status/status.h"
+#include "tensorflow/core/distributed_runtime/tensor_coding.h"
+#include "tensorflow/core/framework/tensor.h"
+#include "tensorflow/core/protobuf/worker.pb.h"
+
+namespace tensorflow {
+
+// Helpers that let workers on the same host pass the contents of received
+// tensors through a `SharedMemorySegment` owned by the receiving process,
+// instead of through the RecvTensor RPC. Only the tensor metadata and the
+// location of the contents in the segment are sent in the RPC response.
+//
+// The transport is disabled by default. It is enabled in a receiving process
+// by setting TF_RECV_TENSOR_SHARED_MEMORY_SLOTS to the number of slots of its
+// segment, and TF_RECV_TENSOR_SHARED_MEMORY_SLOT_BYTES to their size (16 MiB
+// by default). Tensors that do not fit in a free slot are sent in the RPC
+// response as usual. The slots of responses that are lost, e.g. because their
+// RPC is cancelled after the sender wrote the slot, are not reclaimed.
+
+// Asks the sender of `request` to write the tensor contents to the segment of
+// this process, if the transport is enabled. Must only be called for
+// destinations in host memory.
+void MaybeAddSharedMemoryRecvTensorOptions(RecvTensorRequest* request);
+
+// Writes the contents of `tensor` to the segment requested by `request`, if
+// any, and sets `*response` to the response that locates them. Returns false,
+// leaving `*response` unspecified, if the contents must be sent in the
+// response instead.
+bool MaybeWriteTensorToSharedMemory(const RecvTensorRequest& request,
+                                    const Tensor& tensor,
+                                    RecvTensorResponse* response);
+
+// Reads the contents of the tensor of `*response` from the segment of this
+// process, if the sender wrote them there.
+absl::Status MaybeReadTensorFromSharedMemory(TensorResponse* response);
+
+}  // namespace tensorflow
+
+#endif  // TENSORFLOW_CORE_DISTRIBUTED_RUNTIME_RECV_TENSOR_SHARED_MEMORY_H_
@@ -90,6 +90,14 @@ class RendezvousMgrInterface {
                               const Rendezvous::ParsedKey& parsed,
                               Rendezvous::DoneCallback done) = 0;
 
+  // Like RecvLocalAsync above, but if "recv_args.cancellation_manager" is
+  // cancelled before the tensor is produced, "done" is run with a Cancelled
+  // error and the tensor is left in the rendezvous for a later receiver.
+  virtual void RecvLocalAsync(int64_t step_id,
+                              const Rendezvous::ParsedKey& parsed,
+                              const Rendezvous::Args& recv_args,
+                              Rendezvous::DoneCallback done) = 0;
+
   // Synchronous wrapper for RecvLocalAsync.
   virtual Status RecvLocal(int64_t step_id, const Rendezvous::ParsedKey& parsed,
                            Tensor* val, bool* is_dead) = 0;
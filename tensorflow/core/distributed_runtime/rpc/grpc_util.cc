@@ -15,9 +15,60 @@ limitations under the License.
 
 #include "tensorflow/core/distributed_runtime/rpc/grpc_util.h"
 
+#include <cstddef>
+#include <cstdint>
+#include <utility>
+#include <vector>
+
+#include "grpcpp/support/slice.h"
 #include "tensorflow/core/distributed_runtime/tensor_coding.h"
+#include "tensorflow/core/framework/allocation_description.pb.h"
+#include "tensorflow/core/framework/tensor.h"
 
 namespace tensorflow {
+namespace {
+
+// A buffer of tensor data received in a gRPC slice, which keeps the slice
+// alive. The slice may be shared with other readers, so the buffer must not be
+// forwarded to outputs.
+class GrpcSliceTensorBuffer : public TensorBuffer {
+ public:
+  GrpcSliceTensorBuffer(const char* data, size_t size, ::grpc::Slice slice)
+      : TensorBuffer(const_cast<char*>(data)),
+        size_(size),
+        slice_(std::move(slice)) {}
+
+  size_t size() const override { return size_; }
+  TensorBuffer* root_buffer() override { return this; }
+  bool OwnsMemory() const override { return false; }
+
+  void FillAllocationDescription(AllocationDescription* proto) const override {
+    proto->set_requested_bytes(static_cast<int64_t>(size_));
+    proto->set_allocator_name("GrpcSlice");
+  }
+
+ private:
+  const size_t size_;
+  const ::grpc::Slice slice_;
+};
+
+}  // namespace
+
+TensorBuffer* GrpcByteSource::ShareData(const char* data, size_t num_bytes) {
+  std::vector<::grpc::Slice> slices;
+  if (!buffer_->Dump(&slices).ok()) return nullptr;
+  const uintptr_t begin = reinterpret_cast<uintptr_t>(data);
+  for (::grpc::Slice& slice : slices) {
+    // Slices that are too small to be reference counted are copied by Dump(),
+    // and then do not contain `data`.
+    const uintptr_t slice_begin = reinterpret_cast<uintptr_t>(slice.begin());
+    if (begin >= slice_begin &&
+        begin + num_bytes <= slice_begin + slice.size()) {
+      return new GrpcSliceTensorBuffer(data, num_bytes, std::move(slice));
+    }
+  }
+  return nullptr;
+}
 
 bool GrpcMaybeParseTensorResponse(::grpc::ByteBuffer* src,
                                   TensorResponse* dst) {
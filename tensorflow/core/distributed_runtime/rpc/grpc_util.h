@@ -50,6 +50,10 @@ class GrpcByteSource : public TensorResponse::Source {
     return stream_;
   }
 
+  // Shares the data if it is within one slice of the buffer, by holding a
+  // reference to the slice.
+  TensorBuffer* ShareData(const char* data, size_t num_bytes) override;
+
  private:
   void DeleteStream() {
     if (stream_) {
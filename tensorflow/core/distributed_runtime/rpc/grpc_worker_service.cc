@@ -34,6 +34,7 @@ limitations under the License.
 #include "tensorflow/core/common_runtime/process_util.h"
 #include "tensorflow/core/common_runtime/step_stats_collector.h"
 #include "tensorflow/core/distributed_runtime/graph_mgr.h"
+#include "tensorflow/core/distributed_runtime/recv_tensor_shared_memory.h"
 #include "tensorflow/core/distributed_runtime/rendezvous_mgr_interface.h"
 #include "tensorflow/core/distributed_runtime/rpc/grpc_tensor_coding.h"
 #include "tensorflow/core/distributed_runtime/rpc/grpc_util.h"
@@ -447,11 +448,31 @@ void GrpcWorker::GrpcRecvTensorAsync(CallOptions* opts,
 
   bool cache_enabled = (response_cache_ != nullptr && request_id != 0);
 
-  auto do_response = [response, done, cache_enabled](const Tensor& tensor,
-                                                     bool is_dead,
-                                                     const Status& status) {
+  // The response cache holds a single tensor per request, so batched requests
+  // are served one key at a time when it is enabled.
+  RecvTensorBatchRequestExtra batch;
+  if (!cache_enabled && request->has_transport_options() &&
+      request->transport_options().UnpackTo(&batch)) {
+    GrpcRecvTensorBatchAsync(opts, request, batch, response, std::move(done));
+    return;
+  }
+
+  auto do_response = [request, response, done, cache_enabled](
+                         const Tensor& tensor, bool is_dead,
+                         const Status& status) {
     if (status.ok()) {
-      grpc::EncodeTensorToByteBuffer(is_dead, tensor, cache_enabled, response);
+      // Cached responses may be sent again, so they cannot refer to a slot of
+      // the shared memory segment of the receiver, which is freed when read.
+      RecvTensorResponse shared_memory_response;
+      if (!cache_enabled && !is_dead &&
+          MaybeWriteTensorToSharedMemory(*request, tensor,
+                                         &shared_memory_response)) {
+        grpc::EncodeRecvTensorResponseToByteBuffer(shared_memory_response,
+                                                   response);
+      } else {
+        grpc::EncodeTensorToByteBuffer(is_dead, tensor, cache_enabled,
+                                       response);
+      }
     }
     done(status);
   };
@@ -554,6 +575,141 @@ void GrpcWorker::GrpcRecvTensorAsync(CallOptions* opts,
       });
 }
 
+namespace {
+// The state of a batched RecvTensor request, which is shared by the
+// rendezvous callbacks of its keys.
+struct RecvTensorBatchState {
+  explicit RecvTensorBatchState(int num_keys) : pending(num_keys + 1) {}
+
+  mutex mu;
+  // Cancels the receives of the keys whose tensors are not ready by the time
+  // the response is sent, which leaves them in the rendezvous.
+  CancellationManager cancellation_manager;
+  // The number of rendezvous callbacks still to run, plus one until all keys
+  // have been requested.
+  int pending TF_GUARDED_BY(mu);
+  bool registering TF_GUARDED_BY(mu) = true;
+  // Whether a tensor is ready or an error occurred, and then whether the
+  // remaining receives have been cancelled.
+  bool ready TF_GUARDED_BY(mu) = false;
+  bool cancelled TF_GUARDED_BY(mu) = false;
+  Status status TF_GUARDED_BY(mu);
+  RecvTensorBatchResponseExtra extra TF_GUARDED_BY(mu);
+};
+}  // namespace
+
+void GrpcWorker::GrpcRecvTensorBatchAsync(
+    CallOptions* opts, const RecvTensorRequest* request,
+    const RecvTensorBatchRequestExtra& batch, ::grpc::ByteBuffer* response,
+    StatusCallback done) {
+  const int64_t step_id = request->step_id();
+  Status s = recent_request_ids_.TrackUnique(
+      request->request_id(), "RecvTensor (GrpcWorker)", *request);
+  // The keys are parsed up front, so that the request either fails before
+  // any tensor is consumed from the rendezvous or waits for all its keys.
+  std::vector<Rendezvous::ParsedKey> keys(batch.rendezvous_key_size() + 1);
+  for (int i = 0; s.ok() && i < keys.size(); ++i) {
+    const string& key =
+        i == 0 ? request->rendezvous_key() : batch.rendezvous_key(i - 1);
+    s = Rendezvous::ParseKey(key, &keys[i]);
+    Device* src_dev = nullptr;
+    if (s.ok()) {
+      s = PrepareRecvTensor(keys[i], &src_dev);
+    }
+    if (s.ok() && src_dev->tensorflow_accelerator_device_info() != nullptr) {
+      s = errors::InvalidArgument(
+          "Batched RecvTensor requests only support tensors of host devices, "
+          "got ",
+          key);
+    }
+  }
+  if (!s.ok()) {
+    done(s);
+    return;
+  }
+  TRACEPRINTF("RecvTensor: %lld %s and %d more keys", step_id,
+              request->rendezvous_key().c_str(), batch.rendezvous_key_size());
+
+  auto* state = new RecvTensorBatchState(keys.size());
+  // Runs when a rendezvous callback finishes, or when all keys have been
+  // requested, and sends the response once all of them have.
+  auto finish = [this, state, opts, response, done]() {
+    bool start_cancel = false;
+    {
+      mutex_lock l(state->mu);
+      if (state->ready && !state->registering && !state->cancelled) {
+        state->cancelled = true;
+        start_cancel = true;
+      }
+    }
+    // The cancellation runs the callbacks of the keys that are not ready, so
+    // it must happen before this call gives up its count.
+    if (start_cancel) {
+      state->cancellation_manager.StartCancel();
+    }
+    bool last;
+    {
+      mutex_lock l(state->mu);
+      last = --state->pending == 0;
+    }
+    if (!last) return;
+    opts->ClearCancelCallback();
+    Status status;
+    {
+      mutex_lock l(state->mu);
+      status = state->status;
+      if (status.ok()) {
+        RecvTensorResponse proto;
+        proto.mutable_transport_options()->PackFrom(state->extra);
+        proto.set_send_start_micros(env_->env->NowMicros());
+        grpc::EncodeRecvTensorResponseToByteBuffer(proto, response);
+      }
+    }
+    delete state;
+    done(status);
+  };
+
+  opts->SetCancelCallback([this, step_id]() {
+    LOG(WARNING) << "RecvTensor cancelled for " << step_id;
+    AbortStep(step_id);
+  });
+  Rendezvous::Args batch_args;
+  batch_args.cancellation_manager = &state->cancellation_manager;
+  for (int i = 0; i < keys.size(); ++i) {
+    env_->rendezvous_mgr->RecvLocalAsync(
+        step_id, keys[i], batch_args,
+        [state, finish, i](const Status& status,
+                           const Rendezvous::Args& send_args,
+                           const Rendezvous::Args& recv_args,
+                           const Tensor& val, const bool is_dead) {
+          {
+            mutex_lock l(state->mu);
+            if (status.ok()) {
+              RecvTensorBatchResponseExtra::Entry* entry =
+                  state->extra.add_entry();
+              entry->set_index(i);
+              entry->set_is_dead(is_dead);
+              if (!is_dead) {
+                val.AsProtoTensorContent(entry->mutable_tensor());
+              }
+              state->ready = true;
+            } else if (!state->cancelled) {
+              // Receives cancelled by this request are requested again by
+              // the receiver, but other errors fail the whole request.
+              state->status.Update(status);
+              state->ready = true;
+            }
+          }
+          finish();
+        });
+  }
+  {
+    mutex_lock l(state->mu);
+    state->registering = false;
+  }
+  finish();
+}
+
 namespace {
 // If RecvBufRespExtra.tensor_content is a single large string, then gRPC
 // can stall on the recv side when the string buffer needs to be enlarged,
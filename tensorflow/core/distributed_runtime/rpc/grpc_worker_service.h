@@ -37,6 +37,7 @@ class AsyncServiceInterface;
 namespace tensorflow {
 
 class ConfigProto;
+class RecvTensorBatchRequestExtra;
 struct WorkerEnv;
 class WorkerSession;
 class RpcResponseCache;
@@ -68,6 +69,14 @@ class GrpcWorker : public Worker {
   void RemoveCacheEntryForId(int64_t request_id);
 
  private:
+  // Serves a RecvTensor request for the tensors of several keys, which
+  // responds with all of them that are ready once one of them is.
+  void GrpcRecvTensorBatchAsync(CallOptions* opts,
+                                const RecvTensorRequest* request,
+                                const RecvTensorBatchRequestExtra& batch,
+                                ::grpc::ByteBuffer* response,
+                                StatusCallback done);
+
   std::unique_ptr<RpcResponseCache> response_cache_;
   const int32 recv_buf_max_chunk_;
 };
@@ -15,31 +15,65 @@ limitations under the License.
 
 #include "tensorflow/core/distributed_runtime/rpc/rpc_rendezvous_mgr.h"
 
+#include <iterator>
+#include <string>
+#include <utility>
+#include <vector>
+
+#include "absl/container/flat_hash_map.h"
 #include "tensorflow/core/common_runtime/device.h"
 #include "tensorflow/core/common_runtime/device_mgr.h"
 #include "tensorflow/core/common_runtime/dma_helper.h"
 #include "tensorflow/core/common_runtime/process_util.h"
+#include "tensorflow/core/distributed_runtime/recv_tensor_shared_memory.h"
 #include "tensorflow/core/distributed_runtime/request_id.h"
 #include "tensorflow/core/distributed_runtime/tensor_coding.h"
 #include "tensorflow/core/distributed_runtime/worker_cache.h"
 #include "tensorflow/core/distributed_runtime/worker_interface.h"
+#include "tensorflow/core/framework/cancellation.h"
 #include "tensorflow/core/framework/types.h"
 #include "tensorflow/core/lib/core/errors.h"
+#include "tensorflow/core/lib/monitoring/counter.h"
+#include "tensorflow/core/lib/monitoring/sampler.h"
 #include "tensorflow/core/lib/strings/numbers.h"
 #include "tensorflow/core/lib/strings/str_util.h"
 #include "tensorflow/core/platform/logging.h"
 #include "tensorflow/core/platform/macros.h"
 #include "tensorflow/core/platform/notification.h"
 #include "tensorflow/core/platform/types.h"
+#include "tensorflow/core/protobuf/transport_options.pb.h"
+#include "tensorflow/core/util/env_var.h"
 
 namespace tensorflow {
 
 namespace {
 
+auto* recv_tensor_batch_size = monitoring::Sampler<0>::New(
+    {"/tensorflow/rpc/client/recv_tensor_batch_size",
+     "The number of keys of batched RecvTensor requests."},
+    {monitoring::Buckets::Exponential(1, 2, 12)});
+
+auto* recv_tensor_batch_deferred_keys = monitoring::Counter<0>::New(
+    "/tensorflow/rpc/client/recv_tensor_batch_deferred_keys",
+    "The number of keys of batched RecvTensor requests whose tensors were not "
+    "ready when the request was answered, and were requested again.");
+
+class RpcRecvTensorCall;
+
+// A receive that waits to be sent in a batched RecvTensor request.
+struct BatchedRecv {
+  std::string key;
+  Device* dst_device;
+  Rendezvous::Args recv_args;
+  Rendezvous::DoneCallback done;
+};
+
 class RpcRemoteRendezvous : public BaseRemoteRendezvous {
  public:
-  RpcRemoteRendezvous(const WorkerEnv* env, int64_t step_id)
-      : BaseRemoteRendezvous(env, step_id) {}
+  RpcRemoteRendezvous(const WorkerEnv* env, int64_t step_id,
+                      int64_t max_recv_batch_size)
+      : BaseRemoteRendezvous(env, step_id),
+        max_recv_batch_size_(max_recv_batch_size) {}
 
  protected:
   void RecvFromRemoteAsync(const Rendezvous::ParsedKey& parsed,
@@ -47,8 +81,29 @@ class RpcRemoteRendezvous : public BaseRemoteRendezvous {
                            DoneCallback done) override;
 
  private:
+  // Batched receives are grouped by source worker and cancellation manager,
+  // which the RecvTensor call of a batch is registered with.
+  using BatchKey = std::pair<string, CancellationManager*>;
+
   ~RpcRemoteRendezvous() override {}
 
+  // Queues `recv` for the next batched request to `src_worker`.
+  void EnqueueBatchedRecv(const string& src_worker, BatchedRecv recv);
+
+  // Sends the receives queued for `batch_key` in one RecvTensor request.
+  void SendBatchedRecvs(const BatchKey& batch_key);
+
+  // Runs the callbacks of `recvs` with the tensors of `call`'s response, and
+  // queues the receives whose tensors were not ready again.
+  void FinishBatchedRecvs(RpcRecvTensorCall* call, const Status& status,
+                          std::vector<BatchedRecv> recvs);
+
+  const int64_t max_recv_batch_size_;
+
+  mutex batch_mu_;
+  absl::flat_hash_map<BatchKey, std::vector<BatchedRecv>> batched_recvs_
+      TF_GUARDED_BY(batch_mu_);
+
   RpcRemoteRendezvous(const RpcRemoteRendezvous&) = delete;
   void operator=(const RpcRemoteRendezvous&) = delete;
 };
@@ -69,6 +124,10 @@ class RpcRecvTensorCall : public BaseRecvTensorCall {
     req_.set_step_id(step_id);
     req_.set_rendezvous_key(key.data(), key.size());
     req_.set_request_id(GetUniqueRequestId());
+    if (alloc_attrs.on_host() ||
+        dst_device->attributes().device_type() == DEVICE_CPU) {
+      MaybeAddSharedMemoryRecvTensorOptions(&req_);
+    }
   }
 
   void Reset() {
@@ -83,6 +142,7 @@ class RpcRecvTensorCall : public BaseRecvTensorCall {
     // opts_ appropriately.
     req_.Clear();
     resp_.Clear();
+    batched_recvs_.clear();
     {
       mutex_lock l(mu_);
       status_ = absl::OkStatus();
@@ -102,6 +162,23 @@ class RpcRecvTensorCall : public BaseRecvTensorCall {
     StartRTCall(std::move(recv_done));
   }
 
+  // Makes this call request the tensors of `recvs`, the first of which is
+  // the one it was initialized with, in a single RecvTensor request.
+  void SetBatchedRecvs(std::vector<BatchedRecv> recvs) {
+    if (recvs.size() > 1) {
+      RecvTensorBatchRequestExtra extra;
+      for (int i = 1; i < recvs.size(); ++i) {
+        extra.add_rendezvous_key(recvs[i].key);
+      }
+      req_.mutable_transport_options()->PackFrom(extra);
+    }
+    batched_recvs_ = std::move(recvs);
+  }
+
+  std::vector<BatchedRecv> ReleaseBatchedRecvs() {
+    return std::move(batched_recvs_);
+  }
+
   void StartAbort(const Status& s) override {
     {
       mutex_lock l(mu_);
@@ -142,9 +219,13 @@ class RpcRecvTensorCall : public BaseRecvTensorCall {
       // Make sure the Rendezvous abort checking is finished before running the
       // callback, which might destroy the current call object.
       abort_checked->WaitForNotification();
-      if (!s.ok()) {
+      Status status = s;
+      if (status.ok()) {
+        status = MaybeReadTensorFromSharedMemory(&resp_);
+      }
+      if (!status.ok()) {
         mutex_lock l(mu_);
-        status_.Update(s);
+        status_.Update(status);
       }
       recv_done();
     };
@@ -177,6 +258,7 @@ class RpcRecvTensorCall : public BaseRecvTensorCall {
   TensorResponse resp_;
   Rendezvous::Args recv_args_;
   Rendezvous::DoneCallback done_;
+  std::vector<BatchedRecv> batched_recvs_;
 
   mutable mutex mu_;
   Status status_ TF_GUARDED_BY(mu_);
@@ -269,6 +351,19 @@ void RpcRemoteRendezvous::RecvFromRemoteAsync(
     return;
   }
 
+  // Only tensors that the sender holds in host memory and that are received
+  // into host memory are batched, since they are sent as `TensorProto`s.
+  if (max_recv_batch_size_ > 1 && parsed.src.type == DEVICE_CPU &&
+      (recv_args.alloc_attrs.on_host() ||
+       dst_device->attributes().device_type() == DEVICE_CPU)) {
+    const string src_worker = call->src_worker_;
+    sess->worker_cache()->ReleaseWorker(src_worker, rwi);
+    get_call_freelist()->Release(call);
+    EnqueueBatchedRecv(src_worker, {string(parsed.FullKey()), dst_device,
+                                    recv_args, std::move(done)});
+    return;
+  }
+
   call->Init(rwi, step_id_, parsed.FullKey(), recv_args.alloc_attrs, dst_device,
              recv_args, std::move(done));
 
@@ -305,15 +400,150 @@ void RpcRemoteRendezvous::RecvFromRemoteAsync(
   });
 }
 
+void RpcRemoteRendezvous::EnqueueBatchedRecv(const string& src_worker,
+                                             BatchedRecv recv) {
+  BatchKey batch_key(src_worker, recv.recv_args.cancellation_manager);
+  bool schedule;
+  {
+    mutex_lock l(batch_mu_);
+    std::vector<BatchedRecv>& recvs = batched_recvs_[batch_key];
+    schedule = recvs.empty();
+    recvs.push_back(std::move(recv));
+  }
+  // The receives that are issued before the closure runs, e.g. by the other
+  // Recv ops of the same executor iteration, are sent together.
+  if (schedule) {
+    Ref();
+    SchedClosure([this, batch_key]() {
+      SendBatchedRecvs(batch_key);
+      Unref();
+    });
+  }
+}
+
+void RpcRemoteRendezvous::SendBatchedRecvs(const BatchKey& batch_key) {
+  std::vector<BatchedRecv> recvs;
+  {
+    mutex_lock l(batch_mu_);
+    auto it = batched_recvs_.find(batch_key);
+    if (it == batched_recvs_.end()) return;
+    if (it->second.size() <= max_recv_batch_size_) {
+      recvs = std::move(it->second);
+      batched_recvs_.erase(it);
+    } else {
+      auto end = it->second.begin() + max_recv_batch_size_;
+      recvs.assign(std::make_move_iterator(it->second.begin()),
+                   std::make_move_iterator(end));
+      it->second.erase(it->second.begin(), end);
+      // The remaining receives are sent in further requests.
+      Ref();
+      SchedClosure([this, batch_key]() {
+        SendBatchedRecvs(batch_key);
+        Unref();
+      });
+    }
+  }
+  recv_tensor_batch_size->GetCell()->Add(recvs.size());
+
+  const string& src_worker = batch_key.first;
+  WorkerSession* sess = session();
+  std::shared_ptr<WorkerCacheInterface> worker_cache =
+      sess->GetSharedWorkerCache();
+  WorkerInterface* rwi = worker_cache->GetOrCreateWorker(src_worker);
+  if (rwi == nullptr) {
+    Status s = errors::Internal("No worker known as ", src_worker);
+    for (BatchedRecv& recv : recvs) {
+      recv.done(s, Args(), recv.recv_args, Tensor{}, false);
+    }
+    return;
+  }
+
+  RpcRecvTensorCall* call = get_call_freelist()->New();
+  call->src_worker_ = src_worker;
+  const BatchedRecv& first = recvs.front();
+  call->Init(rwi, step_id_, first.key, first.recv_args.alloc_attrs,
+             first.dst_device, first.recv_args, /*done=*/nullptr);
+  call->SetBatchedRecvs(std::move(recvs));
+
+  RegisterCall(call, call->recv_args());
+  if (!call->status().ok()) {
+    DeregisterCall(call, call->recv_args());
+    call->ReleaseWorker(sess->worker_cache());
+    FinishBatchedRecvs(call, call->status(), call->ReleaseBatchedRecvs());
+    get_call_freelist()->Release(call);
+    return;
+  }
+
+  Ref();
+  call->Start([this, call, worker_cache]() {
+    DeregisterCall(call, call->recv_args());
+    Status s = call->status();
+    call->ReleaseWorker(session()->worker_cache());
+    FinishBatchedRecvs(call, s, call->ReleaseBatchedRecvs());
+    get_call_freelist()->Release(call);
+    Unref();
+  });
+}
+
+void RpcRemoteRendezvous::FinishBatchedRecvs(RpcRecvTensorCall* call,
+                                             const Status& status,
+                                             std::vector<BatchedRecv> recvs) {
+  if (!status.ok()) {
+    for (BatchedRecv& recv : recvs) {
+      recv.done(status, Args(), recv.recv_args, Tensor(), false);
+    }
+    return;
+  }
+  std::vector<bool> received(recvs.size(), false);
+  RecvTensorBatchResponseExtra extra;
+  const RecvTensorResponse& meta = call->resp_.metadata();
+  if (recvs.size() > 1 && meta.has_transport_options() &&
+      meta.transport_options().UnpackTo(&extra)) {
+    for (const RecvTensorBatchResponseExtra::Entry& entry : extra.entry()) {
+      const int index = entry.index();
+      if (index < 0 || index >= recvs.size() || received[index]) continue;
+      received[index] = true;
+      BatchedRecv& recv = recvs[index];
+      Status s;
+      Tensor tensor;
+      if (!entry.is_dead() &&
+          !tensor.FromProto(
+              recv.dst_device->GetAllocator(recv.recv_args.alloc_attrs),
+              entry.tensor())) {
+        s = errors::InvalidArgument("Cannot parse tensor of ", recv.key,
+                                    " from batched RecvTensor response");
+      }
+      recv.done(s, Args(), recv.recv_args, tensor, entry.is_dead());
+    }
+  } else {
+    // The response of a single receive, or of a sender that does not batch
+    // requests, holds the tensor of the first key only.
+    received[0] = true;
+    recvs[0].done(status, Args(), recvs[0].recv_args, call->tensor(),
+                  call->is_dead());
+  }
+  const string src_worker = call->src_worker_;
+  for (int i = 0; i < recvs.size(); ++i) {
+    if (received[i]) continue;
+    recv_tensor_batch_deferred_keys->GetCell()->IncrementBy(1);
+    EnqueueBatchedRecv(src_worker, std::move(recvs[i]));
+  }
+}
+
 }  // namespace
 
 RpcRendezvousMgr::RpcRendezvousMgr(const WorkerEnv* env)
-    : BaseRendezvousMgr(env) {}
+    : BaseRendezvousMgr(env), max_recv_batch_size_([]() {
+        int64_t max_recv_batch_size;
+        TF_CHECK_OK(ReadInt64FromEnvVar("TF_RPC_RECV_TENSOR_MAX_BATCH_SIZE", 1,
+                                        &max_recv_batch_size));
+        return max_recv_batch_size;
+      }()) {}
 
 tsl::core::RefCountPtr<BaseRemoteRendezvous> RpcRendezvousMgr::Create(
     int64_t step_id, const WorkerEnv* worker_env) {
   return tsl::core::RefCountPtr<BaseRemoteRendezvous>(
-      new RpcRemoteRendezvous(worker_env, step_id));
+      new RpcRemoteRendezvous(worker_env, step_id, max_recv_batch_size_));
 }
 
 }  // end namespace tensorflow
@@ -51,6 +51,12 @@ class RpcRendezvousMgr : public BaseRendezvousMgr {
       int64_t step_id, const WorkerEnv* worker_env) override;
 
  private:
+  // The maximum number of keys of a RecvTensor request, read from
+  // TF_RPC_RECV_TENSOR_MAX_BATCH_SIZE. Receives from the same task that are
+  // issued together are coalesced into requests of up to this many keys when
+  // it is greater than 1.
+  const int64_t max_recv_batch_size_;
+
   RpcRendezvousMgr(const RpcRendezvousMgr&) = delete;
   void operator=(const RpcRendezvousMgr&) = delete;
 };
@@ -16,17 +16,21 @@ limitations under the License.
 #include "tensorflow/core/distributed_runtime/rpc/rpc_rendezvous_mgr.h"
 
 #include "tensorflow/core/common_runtime/process_util.h"
+#include "tensorflow/core/distributed_runtime/tensor_coding.h"
 #include "tensorflow/core/distributed_runtime/test_utils.h"
 #include "tensorflow/core/framework/cancellation.h"
 #include "tensorflow/core/framework/control_flow.h"
+#include "tensorflow/core/framework/rendezvous.h"
 #include "tensorflow/core/lib/core/errors.h"
 #include "tensorflow/core/lib/core/notification.h"
 #include "tensorflow/core/lib/core/status_test_util.h"
+#include "tensorflow/core/lib/strings/strcat.h"
 #include "tensorflow/core/platform/blocking_counter.h"
 #include "tensorflow/core/platform/env.h"
 #include "tensorflow/core/platform/logging.h"
 #include "tensorflow/core/platform/random.h"
 #include "tensorflow/core/platform/test.h"
+#include "tensorflow/core/protobuf/transport_options.pb.h"
 
 namespace tensorflow {
 
@@ -104,7 +108,9 @@ static Device* CreateDevice(const char* type, const char* name) {
    public:
     explicit FakeDevice(const DeviceAttributes& attr) : Device(nullptr, attr) {}
     Status Sync() override { return absl::OkStatus(); }
-    Allocator* GetAllocator(AllocatorAttributes) override { return nullptr; }
+    Allocator* GetAllocator(AllocatorAttributes) override {
+      return cpu_allocator();
+    }
   };
   DeviceAttributes attr;
   attr.set_name(name);
@@ -242,6 +248,35 @@ TEST_F(RpcRendezvousMgrTest, CancelAfterReceived) {
   delete cm;
 }
 
+TEST_F(RpcRendezvousMgrTest, CancelRecvLocal) {
+  const int64_t step_id = 123;
+  const Rendezvous::ParsedKey key = MakeKey(Rendezvous::CreateKey(
+      "/job:mnist/replica:1/task:2/cpu:0", 7890,
+      "/job:mnist/replica:1/task:2/cpu:1", "foo", FrameAndIter(0, 0)));
+  tsl::core::RefCountPtr<RemoteRendezvous> rendez = rmgr_.Find(step_id);
+  TF_ASSERT_OK(rendez->Initialize(&worker_session_));
+  CancellationManager cm;
+  Rendezvous::Args recv_args;
+  recv_args.cancellation_manager = &cm;
+  Notification n;
+  rmgr_.RecvLocalAsync(step_id, key, recv_args,
+                       [&n](const Status& s, const Rendezvous::Args&,
+                            const Rendezvous::Args&, const Tensor&, bool) {
+                         EXPECT_TRUE(errors::IsCancelled(s));
+                         n.Notify();
+                       });
+  cm.StartCancel();
+  n.WaitForNotification();
+
+  // The tensor sent after the cancellation is left for the next receiver.
+  TF_ASSERT_OK(rendez->Send(key, Rendezvous::Args(), V("peach"), false));
+  Tensor val(DT_STRING);
+  bool val_dead = false;
+  TF_ASSERT_OK(rmgr_.RecvLocal(step_id, key, &val, &val_dead));
+  EXPECT_EQ(V(val), "peach");
+  rmgr_.Cleanup(step_id);
+}
+
 namespace {
 class DummyDeviceContext : public DeviceContext {
  public:
@@ -342,4 +377,159 @@ TEST_F(RpcRendezvousMgrTest, RemoteRecvAsyncMany) {
   rmgr_.Cleanup(step_id);
 }
 
+namespace {
+class StringSource : public TensorResponse::Source {
+ public:
+  explicit StringSource(const string& data) : data_(data) {}
+  protobuf::io::ZeroCopyInputStream* contents() override {
+    stream_ = std::make_unique<protobuf::io::ArrayInputStream>(data_.data(),
+                                                                data_.size());
+    return stream_.get();
+  }
+
+ private:
+  const string data_;
+  std::unique_ptr<protobuf::io::ArrayInputStream> stream_;
+};
+
+// A worker that answers batched RecvTensor requests with the tensors of up to
+// `max_ready_keys` of their keys, and records the number of keys of each
+// request. The value of each tensor is the edge name of its key.
+class BatchingWorker : public TestWorkerInterface {
+ public:
+  explicit BatchingWorker(int max_ready_keys)
+      : max_ready_keys_(max_ready_keys) {}
+
+  void RecvTensorAsync(CallOptions* opts, const RecvTensorRequest* request,
+                       TensorResponse* response, StatusCallback done) override {
+    std::vector<string> keys = {request->rendezvous_key()};
+    RecvTensorBatchRequestExtra batch;
+    const bool batched = request->transport_options().UnpackTo(&batch);
+    keys.insert(keys.end(), batch.rendezvous_key().begin(),
+                batch.rendezvous_key().end());
+    {
+      mutex_lock l(mu_);
+      batch_sizes_.push_back(keys.size());
+    }
+    RecvTensorResponse proto;
+    if (batched) {
+      RecvTensorBatchResponseExtra extra;
+      for (int i = 0; i < keys.size() && i < max_ready_keys_; ++i) {
+        RecvTensorBatchResponseExtra::Entry* entry = extra.add_entry();
+        entry->set_index(i);
+        Value(keys[i]).AsProtoTensorContent(entry->mutable_tensor());
+      }
+      proto.mutable_transport_options()->PackFrom(extra);
+    } else {
+      Value(keys[0]).AsProtoTensorContent(proto.mutable_tensor());
+    }
+    StringSource source(proto.SerializeAsString());
+    Status s = response->ParseFrom(&source);
+    SchedClosure([s, done = std::move(done)]() { done(s); });
+  }
+
+  std::vector<int> batch_sizes() {
+    mutex_lock l(mu_);
+    return batch_sizes_;
+  }
+
+ private:
+  static Tensor Value(const string& key) {
+    Rendezvous::ParsedKey parsed;
+    TF_CHECK_OK(Rendezvous::ParseKey(key, &parsed));
+    return V(string(parsed.edge_name));
+  }
+
+  const int max_ready_keys_;
+  mutex mu_;
+  std::vector<int> batch_sizes_ TF_GUARDED_BY(mu_);
+};
+
+class BatchingWorkerCache : public DummyWorkerCache {
+ public:
+  explicit BatchingWorkerCache(int max_ready_keys)
+      : worker_(max_ready_keys) {}
+  WorkerInterface* GetOrCreateWorker(const string& target) override {
+    return &worker_;
+  }
+  void ReleaseWorker(const string& target, WorkerInterface* worker) override {}
+
+  BatchingWorker* worker() { return &worker_; }
+
+ private:
+  BatchingWorker worker_;
+};
+
+class RpcRendezvousMgrBatchingTest
+    : public ::testing::TestWithParam</*max_ready_keys=*/int> {
+ protected:
+  RpcRendezvousMgrBatchingTest()
+      : cache_(new BatchingWorkerCache(GetParam())),
+        worker_session_("rpc_session", "/job:mnist/replica:1/task:2",
+                        std::unique_ptr<WorkerCacheInterface>(cache_),
+                        std::unique_ptr<DeviceMgr>(CreateDeviceMgr()),
+                        std::unique_ptr<GraphMgr>(), nullptr,
+                        [](WorkerSession* worker_session, bool called,
+                           DeviceMgr* remote_device_mgr) { return nullptr; }) {
+    env_.env = Env::Default();
+    setenv("TF_RPC_RECV_TENSOR_MAX_BATCH_SIZE", "4", /*overwrite=*/1);
+    rmgr_ = std::make_unique<RpcRendezvousMgr>(&env_);
+    unsetenv("TF_RPC_RECV_TENSOR_MAX_BATCH_SIZE");
+  }
+
+  BatchingWorkerCache* cache_;  // Managed by worker_session.
+  WorkerEnv env_;
+  WorkerSession worker_session_;
+  std::unique_ptr<RpcRendezvousMgr> rmgr_;
+};
+
+TEST_P(RpcRendezvousMgrBatchingTest, RecvsBatchedTensors) {
+  const int64_t step_id = 123;
+  const int num_keys = 10;
+  {
+    tsl::core::RefCountPtr<RemoteRendezvous> rendez = rmgr_->Find(step_id);
+    TF_ASSERT_OK(rendez->Initialize(&worker_session_));
+    mutex mu;
+    Status status;
+    std::vector<string> values(num_keys);
+    BlockingCounter counter(num_keys);
+    for (int i = 0; i < num_keys; ++i) {
+      const Rendezvous::ParsedKey key = MakeKey(Rendezvous::CreateKey(
+          "/job:worker/replica:1/task:2/cpu:0", 7890,
+          "/job:mnist/replica:1/task:2/cpu:1", strings::StrCat("foo", i),
+          FrameAndIter(0, 0)));
+      rendez->RecvAsync(key, Rendezvous::Args(),
+                        [&, i](const Status& s, const Rendezvous::Args&,
+                               const Rendezvous::Args&, const Tensor& val,
+                               const bool is_dead) {
+                          {
+                            mutex_lock l(mu);
+                            status.Update(s);
+                            if (s.ok()) values[i] = V(val);
+                          }
+                          counter.DecrementCount();
+                        });
+    }
+    counter.Wait();
+    TF_ASSERT_OK(status);
+    for (int i = 0; i < num_keys; ++i) {
+      EXPECT_EQ(values[i], strings::StrCat("foo", i));
+    }
+  }
+  rmgr_->Cleanup(step_id);
+
+  int num_requested_keys = 0;
+  for (int batch_size : cache_->worker()->batch_sizes()) {
+    EXPECT_LE(batch_size, 4);
+    num_requested_keys += batch_size;
+  }
+  // Keys whose tensors were not ready are requested again.
+  EXPECT_GE(num_requested_keys, num_keys);
+}
+
+INSTANTIATE_TEST_SUITE_P(MaxReadyKeys, RpcRendezvousMgrBatchingTest,
+                         ::testing::Values(1, 2, 4));
+
+}  // namespace
+
 }  // namespace tensorflow
@@ -17,6 +17,7 @@ limitations under the License.
 
 #include <algorithm>
 #include <memory>
+#include <optional>
 #include <string>
 #include <utility>
 #include <vector>
@@ -304,6 +305,24 @@ Status SessionMgr::CreateSession(
         agent_cache->GetOwnedClient(coordination_config.service_leader()),
         std::move(coordination_error_callback)));
 
+    // Send the heartbeats of this task through the aggregator of its group,
+    // or aggregate the heartbeats of the group if this task is the aggregator.
+    CoordinatedTask task;
+    task.set_job_name(server_def.job_name());
+    task.set_task_id(server_def.task_index());
+    const std::optional<CoordinatedTask> aggregator =
+        tsl::GetHeartbeatAggregator(coordination_config, task);
+    if (aggregator.has_value() && aggregator->task_id() != task.task_id()) {
+      TF_RETURN_IF_ERROR(
+          coordination_service_agent_->SetHeartbeatAggregatorClient(
+              agent_cache->GetOwnedClient(strings::StrCat(
+                  "/job:", aggregator->job_name(), "/replica:",
+                  server_def.replica(), "/task:", aggregator->task_id()))));
+    } else if (aggregator.has_value() && coordination_handler_ != nullptr) {
+      coordination_handler_->SetAgentInstance(
+          coordination_service_agent_.get());
+    }
+
     activity_watcher::MaybeEnableMultiWorkersWatching(
         coordination_service_agent_.get());
   }
@@ -515,6 +534,9 @@ void SessionMgr::TeardownCoordinationService() {
 }
 
 void SessionMgr::TeardownCoordinationServiceAgent() {
+  if (coordination_handler_ != nullptr) {
+    coordination_handler_->SetAgentInstance(nullptr);
+  }
   coordination_service_agent_ = nullptr;
 }
 }  // namespace tensorflow
@@ -0,0 +1,290 @@
+/* Copyright 2024 The TensorFlow Authors. All Rights Reserved.
+
+Licensed under the Apache License, Version 2.0 (the "License");
+you may not use this file except in compliance with the License.
+You may obtain a copy of the License at
+
+    http://www.apache.org/licenses/LICENSE-2.0
+
+Unless required by applicable law or agreed to in writing, software
+distributed under the License is distributed on an "AS IS" BASIS,
+WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+See the License for the specific language governing permissions and
+limitations under the License.
+==============================================================================*/
+#include "tensorflow/core/distributed_runtime/shared_memory_segment.h"
+
+#include <atomic>
+#include <cerrno>
+#include <cstddef>
+#include <cstdint>
+#include <cstring>
+#include <memory>
+#include <new>
+#include <string>
+#include <utility>
+
+#include "absl/status/status.h"
+#include "absl/status/statusor.h"
+#include "absl/strings/string_view.h"
+#include "tensorflow/core/platform/errors.h"
+#include "tensorflow/core/platform/logging.h"
+
+#ifndef PLATFORM_WINDOWS
+#include <fcntl.h>
+#include <sys/mman.h>
+#include <sys/stat.h>
+#include <unistd.h>
+#endif  // PLATFORM_WINDOWS
+
+namespace tensorflow {
+namespace {
+
+constexpr uint64_t kMagic = 0x4d48535345565254;  // "TRVESSHM"
+constexpr uint32_t kVersion = 1;
+// Slots are aligned to cache lines, so that writers of different slots do not
+// contend for them.
+constexpr size_t kAlignment = 64;
+
+enum SlotState : uint32_t {
+  kFree = 0,
+  kWriting = 1,
+  kReady = 2,
+  kReading = 3,
+};
+
+// The slot states are shared with other processes, so their atomic operations
+// must not depend on a lock in this process.
+static_assert(std::atomic<uint32_t>::is_always_lock_free,
+              "Atomic operations on uint32_t are not lock-free");
+
+constexpr size_t AlignUp(size_t size) {
+  return (size + kAlignment - 1) / kAlignment * kAlignment;
+}
+
+struct Header {
+  uint64_t magic;
+  uint32_t version;
+  int32_t num_slots;
+  int64_t slot_bytes;
+  // The slot from which the next writer starts looking for a free one.
+  std::atomic<uint32_t> next_slot;
+};
+
+struct Slot {
+  std::atomic<uint32_t> state;
+  int64_t num_bytes;
+};
+
+constexpr size_t kHeaderBytes = AlignUp(sizeof(Header));
+constexpr size_t kSlotHeaderBytes = AlignUp(sizeof(Slot));
+
+size_t SlotStride(int64_t slot_bytes) {
+  return kSlotHeaderBytes + AlignUp(slot_bytes);
+}
+
+char* SlotData(Slot* slot) {
+  return reinterpret_cast<char*>(slot) + kSlotHeaderBytes;
+}
+
+}  // namespace
+
+#ifdef PLATFORM_WINDOWS
+
+absl::StatusOr<std::unique_ptr<SharedMemorySegment>>
+SharedMemorySegment::Create(const std::string& name, int num_slots,
+                            int64_t slot_bytes) {
+  return errors::Unimplemented("Shared memory segments are not supported.");
+}
+
+absl::StatusOr<std::unique_ptr<SharedMemorySegment>> SharedMemorySegment::Open(
+    const std::string& name) {
+  return errors::Unimplemented("Shared memory segments are not supported.");
+}
+
+SharedMemorySegment::~SharedMemorySegment() {}
+
+#else  // PLATFORM_WINDOWS
+
+absl::StatusOr<std::unique_ptr<SharedMemorySegment>>
+SharedMemorySegment::Create(const std::string& name, int num_slots,
+                            int64_t slot_bytes) {
+  if (num_slots <= 0 || slot_bytes <= 0) {
+    return errors::InvalidArgument(
+        "A shared memory segment needs a positive number and size of slots, "
+        "got ",
+        num_slots, " slots of ", slot_bytes, " bytes.");
+  }
+  const size_t size = kHeaderBytes + num_slots * SlotStride(slot_bytes);
+  const int fd = shm_open(name.c_str(), O_CREAT | O_EXCL | O_RDWR, 0600);
+  if (fd < 0) {
+    return errors::IOError(
+        absl::StrCat("Failed to create shared memory segment ", name), errno);
+  }
+  if (ftruncate(fd, size) != 0) {
+    const int error = errno;
+    close(fd);
+    shm_unlink(name.c_str());
+    return errors::IOError(
+        absl::StrCat("Failed to size shared memory segment ", name), error);
+  }
+  void* base = mmap(nullptr, size, PROT_READ | PROT_WRITE, MAP_SHARED, fd, 0);
+  const int error = errno;
+  close(fd);
+  if (base == MAP_FAILED) {
+    shm_unlink(name.c_str());
+    return errors::IOError(
+        absl::StrCat("Failed to map shared memory segment ", name), error);
+  }
+
+  // The memory is zero-filled, i.e. all slots are free.
+  Header* header = new (base) Header;
+  header->version = kVersion;
+  header->num_slots = num_slots;
+  header->slot_bytes = slot_bytes;
+  header->next_slot.store(0, std::memory_order_relaxed);
+  std::unique_ptr<SharedMemorySegment> segment(
+      new SharedMemorySegment(name, base, size, /*owned=*/true));
+  for (int i = 0; i < num_slots; ++i) {
+    Slot* slot = new (segment->SlotAddress(i)) Slot;
+    slot->state.store(kFree, std::memory_order_relaxed);
+  }
+  // Publish the segment to the processes that open it.
+  std::atomic_thread_fence(std::memory_order_release);
+  header->magic = kMagic;
+  return segment;
+}
+
+absl::StatusOr<std::unique_ptr<SharedMemorySegment>> SharedMemorySegment::Open(
+    const std::string& name) {
+  const int fd = shm_open(name.c_str(), O_RDWR, 0);
+  if (fd < 0) {
+    return errors::IOError(
+        absl::StrCat("Failed to open shared memory segment ", name), errno);
+  }
+  struct stat st;
+  if (fstat(fd, &st) != 0) {
+    const int error = errno;
+    close(fd);
+    return errors::IOError(
+        absl::StrCat("Failed to stat shared memory segment ", name), error);
+  }
+  const size_t size = st.st_size;
+  if (size < kHeaderBytes) {
+    close(fd);
+    return errors::InvalidArgument("Shared memory segment ", name,
+                                   " is too small: ", size, " bytes.");
+  }
+  void* base = mmap(nullptr, size, PROT_READ | PROT_WRITE, MAP_SHARED, fd, 0);
+  const int error = errno;
+  close(fd);
+  if (base == MAP_FAILED) {
+    return errors::IOError(
+        absl::StrCat("Failed to map shared memory segment ", name), error);
+  }
+  std::unique_ptr<SharedMemorySegment> segment(
+      new SharedMemorySegment(name, base, size, /*owned=*/false));
+
+  const Header* header = static_cast<const Header*>(base);
+  if (header->magic != kMagic || header->version != kVersion) {
+    return errors::InvalidArgument("Shared memory segment ", name,
+                                   " has an unsupported format.");
+  }
+  std::atomic_thread_fence(std::memory_order_acquire);
+  if (header->num_slots <= 0 || header->slot_bytes <= 0 ||
+      kHeaderBytes + header->num_slots * SlotStride(header->slot_bytes) >
+          size) {
+    return errors::InvalidArgument("Shared memory segment ", name,
+                                   " has an invalid layout.");
+  }
+  return segment;
+}
+
+SharedMemorySegment::~SharedMemorySegment() {
+  if (munmap(base_, size_) != 0) {
+    LOG(ERROR) << "Failed to unmap shared memory segment " << name_ << ": "
+               << strerror(errno);
+  }
+  if (owned_ && shm_unlink(name_.c_str()) != 0) {
+    LOG(ERROR) << "Failed to remove shared memory segment " << name_ << ": "
+               << strerror(errno);
+  }
+}
+
+#endif  // PLATFORM_WINDOWS
+
+SharedMemorySegment::SharedMemorySegment(std::string name, void* base,
+                                         size_t size, bool owned)
+    : name_(std::move(name)), base_(base), size_(size), owned_(owned) {}
+
+int SharedMemorySegment::num_slots() const {
+  return static_cast<const Header*>(base_)->num_slots;
+}
+
+int64_t SharedMemorySegment::slot_bytes() const {
+  return static_cast<const Header*>(base_)->slot_bytes;
+}
+
+void* SharedMemorySegment::SlotAddress(int index) const {
+  return static_cast<char*>(base_) + kHeaderBytes +
+         index * SlotStride(slot_bytes());
+}
+
+absl::StatusOr<int> SharedMemorySegment::Write(absl::string_view data) {
+  if (data.size() > slot_bytes()) {
+    return errors::ResourceExhausted(
+        "Data of ", data.size(), " bytes does not fit in a slot of ",
+        slot_bytes(), " bytes of shared memory segment ", name_);
+  }
+  Header* header = static_cast<Header*>(base_);
+  const int num_slots = this->num_slots();
+  const uint32_t start =
+      header->next_slot.fetch_add(1, std::memory_order_relaxed);
+  for (int i = 0; i < num_slots; ++i) {
+    const int index = (start + i) % num_slots;
+    Slot* slot = static_cast<Slot*>(SlotAddress(index));
+    uint32_t expected = kFree;
+    if (!slot->state.compare_exchange_strong(expected, kWriting,
+                                             std::memory_order_acquire,
+                                             std::memory_order_relaxed)) {
+      continue;
+    }
+    std::memcpy(SlotData(slot), data.data(), data.size());
+    slot->num_bytes = data.size();
+    slot->state.store(kReady, std::memory_order_release);
+    return index;
+  }
+  return errors::ResourceExhausted("All ", num_slots,
+                                   " slots of shared memory segment ", name_,
+                                   " are in use.");
+}
+
+absl::Status SharedMemorySegment::Read(int slot, int64_t num_bytes,
+                                       void* dst) {
+  if (slot < 0 || slot >= num_slots()) {
+    return errors::InvalidArgument("Invalid slot ", slot,
+                                   " of shared memory segment ", name_);
+  }
+  Slot* s = static_cast<Slot*>(SlotAddress(slot));
+  // Claim the slot, so that it is freed exactly once even if the read fails.
+  // A slot that is not ready is not owned by this reader, and is left as is.
+  uint32_t expected = kReady;
+  if (!s->state.compare_exchange_strong(expected, kReading,
+                                        std::memory_order_acquire)) {
+    return errors::Internal("Slot ", slot, " of shared memory segment ", name_,
+                            " holds no data.");
+  }
+  absl::Status status;
+  if (s->num_bytes != num_bytes) {
+    // The data cannot be consumed, so drop it rather than leak the slot.
+    status = errors::Internal("Slot ", slot, " of shared memory segment ",
+                              name_, " holds ", s->num_bytes,
+                              " bytes, expected ", num_bytes);
+  } else {
+    std::memcpy(dst, SlotData(s), num_bytes);
+  }
+  s->state.store(kFree, std::memory_order_release);
+  return status;
+}
+
+}  // namespace tensorflow
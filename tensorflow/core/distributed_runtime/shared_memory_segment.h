@@ -0,0 +1,83 @@
+/* Copyright 2024 The TensorFlow Authors. All Rights Reserved.
+
+Licensed under the Apache License, Version 2.0 (the "License");
+you may not use this file except in compliance with the License.
+You may obtain a copy of the License at
+
+    http://www.apache.org/licenses/LICENSE-2.0
+
+Unless required by applicable law or agreed to in writing, software
+distributed under the License is distributed on an "AS IS" BASIS,
+WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+See the License for the specific language governing permissions and
+limitations under the License.
+==============================================================================*/
+
+#ifndef TENSORFLOW_CORE_DISTRIBUTED_RUNTIME_SHARED_MEMORY_SEGMENT_H_
+#define TENSORFLOW_CORE_DISTRIBUTED_RUNTIME_SHARED_MEMORY_SEGMENT_H_
+
+#include <cstddef>
+#include <cstdint>
+#include <memory>
+#include <string>
+
+#include "absl/status/status.h"
+#include "absl/status/statusor.h"
+#include "absl/strings/string_view.h"
+
+namespace tensorflow {
+
+// A POSIX shared memory segment of fixed-size slots, through which processes
+// on the same host pass byte arrays without copying them through a socket.
+//
+// A writer claims a free slot, copies its data into it and passes the slot
+// index to the reader out of band, e.g. in an RPC response. The reader then
+// copies the data out and frees the slot. Slots are claimed and released with
+// atomic operations on the slot states in the segment, so any number of
+// processes may write to the segment concurrently without locks.
+//
+// This class is thread-safe.
+class SharedMemorySegment {
+ public:
+  // Creates a segment named `name` with `num_slots` slots of `slot_bytes`
+  // bytes each. The segment is removed when the returned object is destroyed,
+  // but remains mapped in the processes that opened it.
+  static absl::StatusOr<std::unique_ptr<SharedMemorySegment>> Create(
+      const std::string& name, int num_slots, int64_t slot_bytes);
+
+  // Opens a segment created by another process on the same host.
+  static absl::StatusOr<std::unique_ptr<SharedMemorySegment>> Open(
+      const std::string& name);
+
+  ~SharedMemorySegment();
+
+  const std::string& name() const { return name_; }
+  int num_slots() const;
+  int64_t slot_bytes() const;
+
+  // Copies `data` to a free slot and returns its index. Returns a
+  // ResourceExhausted error if `data` does not fit in a slot or if all slots
+  // are in use.
+  absl::StatusOr<int> Write(absl::string_view data);
+
+  // Copies the `num_bytes` bytes written to `slot` to `dst`, and frees the
+  // slot. The slot is also freed if it holds a different number of bytes, in
+  // which case its data is dropped.
+  absl::Status Read(int slot, int64_t num_bytes, void* dst);
+
+ private:
+  SharedMemorySegment(std::string name, void* base, size_t size, bool owned);
+
+  // Returns the address of the header of slot `index`.
+  void* SlotAddress(int index) const;
+
+  const std::string name_;
+  void* const base_;
+  const size_t size_;
+  // Whether the segment was created by this object, and is then removed by it.
+  const bool owned_;
+};
+
+}  // namespace tensorflow
+
+#endif  // TENSORFLOW_CORE_DISTRIBUTED_RUNTIME_SHARED_MEMORY_SEGMENT_H_
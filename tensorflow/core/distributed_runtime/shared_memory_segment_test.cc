@@ -0,0 +1,103 @@
+/* Copyright 2024 The TensorFlow Authors. All Rights Reserved.
+
+Licensed under the Apache License, Version 2.0 (the "License");
+you may not use this file except in compliance with the License.
+You may obtain a copy of the License at
+
+    http://www.apache.org/licenses/LICENSE-2.0
+
+Unless required by applicable law or agreed to in writing, software
+distributed under the License is distributed on an "AS IS" BASIS,
+WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+See the License for the specific language governing permissions and
+limitations under the License.
+==============================================================================*/
+#include "tensorflow/core/distributed_runtime/shared_memory_segment.h"
+
+#include <memory>
+#include <string>
+
+#include "absl/status/status.h"
+#include "absl/strings/str_cat.h"
+#include "absl/strings/string_view.h"
+#include "tensorflow/core/lib/random/random.h"
+#include "tensorflow/core/platform/env.h"
+#include "tensorflow/core/platform/test.h"
+#include "tsl/lib/core/status_test_util.h"
+
+namespace tensorflow {
+namespace {
+
+std::string SegmentName() {
+  return absl::StrCat("/tf_shared_memory_segment_test_",
+                      Env::Default()->GetProcessId(), "_", random::New64());
+}
+
+TEST(SharedMemorySegmentTest, WriteAndRead) {
+  auto owner = SharedMemorySegment::Create(SegmentName(), 2, 16);
+  TF_ASSERT_OK(owner.status());
+  auto writer = SharedMemorySegment::Open((*owner)->name());
+  TF_ASSERT_OK(writer.status());
+  EXPECT_EQ((*writer)->num_slots(), 2);
+  EXPECT_EQ((*writer)->slot_bytes(), 16);
+
+  auto slot = (*writer)->Write("hello");
+  TF_ASSERT_OK(slot.status());
+  char buf[5];
+  TF_ASSERT_OK((*owner)->Read(*slot, sizeof(buf), buf));
+  EXPECT_EQ(std::string(buf, sizeof(buf)), "hello");
+
+  // The slot is free again, and cannot be read twice.
+  EXPECT_FALSE((*owner)->Read(*slot, sizeof(buf), buf).ok());
+}
+
+TEST(SharedMemorySegmentTest, AllSlotsInUse) {
+  auto owner = SharedMemorySegment::Create(SegmentName(), 2, 16);
+  TF_ASSERT_OK(owner.status());
+  auto first = (*owner)->Write("a");
+  auto second = (*owner)->Write("b");
+  TF_ASSERT_OK(first.status());
+  TF_ASSERT_OK(second.status());
+  EXPECT_NE(*first, *second);
+  EXPECT_TRUE(absl::IsResourceExhausted((*owner)->Write("c").status()));
+
+  char c;
+  TF_ASSERT_OK((*owner)->Read(*first, 1, &c));
+  EXPECT_EQ(c, 'a');
+  auto third = (*owner)->Write("c");
+  TF_ASSERT_OK(third.status());
+  EXPECT_EQ(*third, *first);
+}
+
+TEST(SharedMemorySegmentTest, DataLargerThanSlot) {
+  auto owner = SharedMemorySegment::Create(SegmentName(), 1, 4);
+  TF_ASSERT_OK(owner.status());
+  EXPECT_TRUE(absl::IsResourceExhausted((*owner)->Write("hello").status()));
+}
+
+TEST(SharedMemorySegmentTest, ReadWrongSize) {
+  auto owner = SharedMemorySegment::Create(SegmentName(), 1, 16);
+  TF_ASSERT_OK(owner.status());
+  auto slot = (*owner)->Write("hello");
+  TF_ASSERT_OK(slot.status());
+  char buf[4];
+  EXPECT_FALSE((*owner)->Read(*slot, sizeof(buf), buf).ok());
+
+  // The slot is freed, so the only slot of the segment can be reused.
+  auto next_slot = (*owner)->Write("bye");
+  TF_ASSERT_OK(next_slot.status());
+  EXPECT_EQ(*next_slot, *slot);
+  char next_buf[3];
+  TF_ASSERT_OK((*owner)->Read(*next_slot, sizeof(next_buf), next_buf));
+  EXPECT_EQ(absl::string_view(next_buf, sizeof(next_buf)), "bye");
+
+  // A freed slot holds no data.
+  EXPECT_FALSE((*owner)->Read(*next_slot, sizeof(next_buf), next_buf).ok());
+}
+
+TEST(SharedMemorySegmentTest, OpenMissingSegment) {
+  EXPECT_FALSE(SharedMemorySegment::Open(SegmentName()).ok());
+}
+
+}  // namespace
+}  // namespace tensorflow
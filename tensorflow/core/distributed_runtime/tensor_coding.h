@@ -63,6 +63,15 @@ class TensorResponse {
     // Ownership of the returned stream is retained by the Source and
     // should not be deleted by the caller.
     virtual ::tensorflow::protobuf::io::ZeroCopyInputStream* contents() = 0;
+
+    // Returns a buffer that refers to the `num_bytes` bytes at `data` in place
+    // and keeps them alive, or nullptr if the source cannot share them, in
+    // which case they are copied. `data` points into the data yielded by the
+    // stream last returned by contents(). The returned buffer may outlive the
+    // source.
+    virtual TensorBuffer* ShareData(const char* data, size_t num_bytes) {
+      return nullptr;
+    }
   };
 
   // Parse the RecvTensorResponse encoded in the data yielded by
@@ -91,8 +100,12 @@ class TensorResponse {
   DeviceBase* device() const { return device_; }
 
  private:
-  bool ParseTensorSubmessage(protobuf::io::CodedInputStream* input,
+  bool ParseTensorSubmessage(Source* source,
+                             protobuf::io::CodedInputStream* input,
                              TensorProto* tensor_meta);
+  bool ShareTensorContent(Source* source,
+                          protobuf::io::CodedInputStream* input,
+                          const TensorProto& tensor_meta, int num_bytes);
   bool ParseFast(Source* source);
   bool ParseSlow(Source* source);
 
@@ -15,6 +15,8 @@ limitations under the License.
 
 #include "tensorflow/core/distributed_runtime/tensor_coding.h"
 
+#include "tensorflow/core/framework/allocation_description.pb.h"
+#include "tensorflow/core/framework/allocator.h"
 #include "tensorflow/core/framework/device_attributes.pb.h"
 #include "tensorflow/core/framework/device_base.h"
 #include "tensorflow/core/framework/tensor.h"
@@ -156,6 +158,109 @@ TEST_F(TensorResponseTest, Simple) {
 
 TEST_F(TensorResponseTest, StringTensor) { DoTestForStrings(DT_STRING); }
 
+// A buffer that refers to data owned by the test.
+class UnownedTensorBuffer : public TensorBuffer {
+ public:
+  UnownedTensorBuffer(const char* data, size_t size)
+      : TensorBuffer(const_cast<char*>(data)), size_(size) {}
+
+  size_t size() const override { return size_; }
+  TensorBuffer* root_buffer() override { return this; }
+  bool OwnsMemory() const override { return false; }
+  void FillAllocationDescription(AllocationDescription* proto) const override {}
+
+ private:
+  const size_t size_;
+};
+
+class SharingArraySource : public TensorResponse::Source {
+ public:
+  SharingArraySource(const char* data, int size, int block_size)
+      : stream_(data, size, block_size) {}
+
+  protobuf::io::ZeroCopyInputStream* contents() override { return &stream_; }
+
+  TensorBuffer* ShareData(const char* data, size_t num_bytes) override {
+    ++num_shared_;
+    return new UnownedTensorBuffer(data, num_bytes);
+  }
+
+  int num_shared() const { return num_shared_; }
+
+ private:
+  protobuf::io::ArrayInputStream stream_;
+  int num_shared_ = 0;
+};
+
+class TensorResponseSharingTest : public ::testing::Test {
+ protected:
+  void SetUp() override {
+    src_ = Tensor(DT_FLOAT, TensorShape({1024}));
+    test::FillIota<float>(&src_, 0.0f);
+    RecvTensorResponse proto;
+    src_.AsProtoTensorContent(proto.mutable_tensor());
+    proto.AppendToString(&encoded_);
+    content_offset_ = encoded_.find(string(src_.tensor_data()));
+    ASSERT_NE(content_offset_, string::npos);
+  }
+
+  // Returns a copy of the encoded response in `storage_`, at an address such
+  // that the tensor content is `misalignment` bytes past an aligned address.
+  const char* PlaceEncoded(int misalignment) {
+    storage_.assign(encoded_.size() + 2 * Allocator::kAllocatorAlignment, 0);
+    const uintptr_t content =
+        reinterpret_cast<uintptr_t>(storage_.data()) + content_offset_;
+    const size_t offset = (Allocator::kAllocatorAlignment -
+                           content % Allocator::kAllocatorAlignment) %
+                              Allocator::kAllocatorAlignment +
+                          misalignment;
+    storage_.replace(offset, encoded_.size(), encoded_);
+    return storage_.data() + offset;
+  }
+
+  Tensor src_;
+  string encoded_;
+  size_t content_offset_;
+  string storage_;
+};
+
+TEST_F(TensorResponseSharingTest, SharesAlignedContent) {
+  const char* encoded = PlaceEncoded(/*misalignment=*/0);
+  SharingArraySource source(encoded, encoded_.size(), encoded_.size());
+  TensorResponse response;
+  DummyDevice cpu_device(Env::Default());
+  response.InitAlloc(&cpu_device, AllocatorAttributes());
+  EXPECT_TRUE(response.ParseFrom(&source).ok());
+
+  EXPECT_EQ(source.num_shared(), 1);
+  EXPECT_EQ(response.tensor().tensor_data().data(), encoded + content_offset_);
+  test::ExpectTensorEqual<float>(response.tensor(), src_);
+}
+
+TEST_F(TensorResponseSharingTest, CopiesMisalignedContent) {
+  const char* encoded = PlaceEncoded(/*misalignment=*/4);
+  SharingArraySource source(encoded, encoded_.size(), encoded_.size());
+  TensorResponse response;
+  DummyDevice cpu_device(Env::Default());
+  response.InitAlloc(&cpu_device, AllocatorAttributes());
+  EXPECT_TRUE(response.ParseFrom(&source).ok());
+
+  EXPECT_EQ(source.num_shared(), 0);
+  test::ExpectTensorEqual<float>(response.tensor(), src_);
+}
+
+TEST_F(TensorResponseSharingTest, CopiesContentInSeveralBlocks) {
+  const char* encoded = PlaceEncoded(/*misalignment=*/0);
+  SharingArraySource source(encoded, encoded_.size(), /*block_size=*/1000);
+  TensorResponse response;
+  DummyDevice cpu_device(Env::Default());
+  response.InitAlloc(&cpu_device, AllocatorAttributes());
+  EXPECT_TRUE(response.ParseFrom(&source).ok());
+
+  EXPECT_EQ(source.num_shared(), 0);
+  test::ExpectTensorEqual<float>(response.tensor(), src_);
+}
+
 string MakeFloatTensorTestCase(int num_elems) {
   std::vector<int8> v(num_elems);
   for (int i = 0; i < num_elems; i++) {
@@ -0,0 +1,305 @@
+/* Copyright 2024 The TensorFlow Authors. All Rights Reserved.
+
+Licensed under the Apache License, Version 2.0 (the "License");
+you may not use this file except in compliance with the License.
+You may obtain a copy of the License at
+
+    http://www.apache.org/licenses/LICENSE-2.0
+
+Unless required by applicable law or agreed to in writing, software
+distributed under the License is distributed on an "AS IS" BASIS,
+WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+See the License for the specific language governing permissions and
+limitations under the License.
+==============================================================================*/
+
+// Benchmarks of the transport of tensors between the tasks of an in-process
+// gRPC cluster: RecvTensor across tensor sizes, tensor counts and numbers of
+// concurrent steps, and ring all-reduces and hierarchical tree broadcasts
+// across group sizes. The remote enqueue rate of eager ops is measured by
+// BM_RemoteExecute in tensorflow/c/eager/c_api_remote_test.cc.
+//
+// Run with --benchmark_filter=all. For regression tracking, pass
+// --benchmark_format=json, or --benchmark_out=<file> and
+// --benchmark_out_format=json, to get machine-readable results. Times are
+// wall-clock times per step, and the reported bytes and items per second
+// count the tensors that were transferred.
+
+#include <algorithm>
+#include <atomic>
+#include <memory>
+#include <string>
+#include <vector>
+
+#include "tensorflow/core/distributed_runtime/server_lib.h"
+#include "tensorflow/core/framework/graph.pb.h"
+#include "tensorflow/core/framework/node_def_builder.h"
+#include "tensorflow/core/framework/tensor.pb.h"
+#include "tensorflow/core/framework/tensor_shape.pb.h"
+#include "tensorflow/core/lib/core/threadpool.h"
+#include "tensorflow/core/platform/blocking_counter.h"
+#include "tensorflow/core/platform/logging.h"
+#include "tensorflow/core/platform/strcat.h"
+#include "tensorflow/core/platform/test.h"
+#include "tensorflow/core/platform/test_benchmark.h"
+#include "tensorflow/core/protobuf/cluster.pb.h"
+#include "tensorflow/core/protobuf/config.pb.h"
+#include "tensorflow/core/protobuf/tensorflow_server.pb.h"
+#include "tensorflow/core/public/session.h"
+
+namespace tensorflow {
+namespace {
+
+constexpr int kNumTasks = 4;
+constexpr char kJobName[] = "localhost";
+
+string DeviceName(int task) {
+  return strings::StrCat("/job:", kJobName, "/replica:0/task:", task,
+                         "/device:CPU:0");
+}
+
+// The servers of all tasks, which are started once and shared by all
+// benchmarks. Sessions connect to the master of task 0.
+class Cluster {
+ public:
+  static const Cluster& Get() {
+    static const Cluster* cluster = new Cluster();
+    return *cluster;
+  }
+
+  SessionOptions session_options() const {
+    SessionOptions options;
+    options.target = servers_[0]->target();
+    ConfigProto& config = options.config;
+    config.mutable_experimental()->set_collective_group_leader(DeviceName(0));
+    // Keeps the graphs as written, so that every step transfers the tensors.
+    config.mutable_graph_options()
+        ->mutable_optimizer_options()
+        ->set_opt_level(OptimizerOptions::L0);
+    config.mutable_graph_options()
+        ->mutable_rewrite_options()
+        ->set_disable_meta_optimizer(true);
+    return options;
+  }
+
+ private:
+  Cluster() {
+    ServerDef server_def;
+    server_def.set_protocol("grpc");
+    server_def.set_job_name(kJobName);
+    JobDef* job_def = server_def.mutable_cluster()->add_job();
+    job_def->set_name(kJobName);
+    for (int i = 0; i < kNumTasks; ++i) {
+      (*job_def->mutable_tasks())[i] =
+          strings::StrCat("localhost:", testing::PickUnusedPortOrDie());
+    }
+    (*server_def.mutable_default_session_config()->mutable_device_count())
+        ["CPU"] = 1;
+    for (int i = 0; i < kNumTasks; ++i) {
+      server_def.set_task_index(i);
+      std::unique_ptr<ServerInterface> server;
+      TF_CHECK_OK(NewServer(server_def, &server));
+      TF_CHECK_OK(server->Start());
+      servers_.push_back(std::move(server));
+    }
+  }
+
+  std::vector<std::unique_ptr<ServerInterface>> servers_;
+};
+
+// Collective group and instance keys that are unique in the process, since
+// the cluster outlives the sessions of the benchmarks.
+int NextCollectiveKey() {
+  static std::atomic<int> next_key(1);
+  return next_key.fetch_add(1);
+}
+
+// Adds a float tensor of "num_elements" ones that is produced on "task" and
+// that is cheap to describe in the GraphDef.
+void AddConst(const string& name, int task, int64_t num_elements,
+              GraphDef* def) {
+  TensorProto value;
+  value.set_dtype(DT_FLOAT);
+  value.mutable_tensor_shape()->add_dim()->set_size(num_elements);
+  value.add_float_val(1.0f);
+  TF_CHECK_OK(NodeDefBuilder(name, "Const")
+                  .Device(DeviceName(task))
+                  .Attr("dtype", DT_FLOAT)
+                  .Attr("value", value)
+                  .Finalize(def->add_node()));
+}
+
+int64_t NumElements(int64_t tensor_bytes) {
+  return std::max<int64_t>(1, tensor_bytes / sizeof(float));
+}
+
+void CreateSession(const GraphDef& def, std::unique_ptr<Session>* session) {
+  session->reset(NewSession(Cluster::Get().session_options()));
+  TF_CHECK_OK((*session)->Create(def));
+}
+
+// Runs "num_concurrent_steps" steps of "targets" concurrently per iteration,
+// after a few warm-up steps that also register the graph with the workers.
+void RunSteps(::testing::benchmark::State& state, Session* session,
+              const std::vector<string>& targets, int num_concurrent_steps) {
+  auto run_step = [session, &targets]() {
+    std::vector<Tensor> outputs;
+    TF_CHECK_OK(session->Run({}, {}, targets, &outputs));
+  };
+  for (int i = 0; i < 3; ++i) run_step();
+  if (num_concurrent_steps <= 1) {
+    for (auto s : state) run_step();
+    return;
+  }
+  thread::ThreadPool pool(Env::Default(), "transport_benchmark",
+                          num_concurrent_steps);
+  for (auto s : state) {
+    BlockingCounter counter(num_concurrent_steps);
+    for (int i = 0; i < num_concurrent_steps; ++i) {
+      pool.Schedule([&]() {
+        run_step();
+        counter.DecrementCount();
+      });
+    }
+    counter.Wait();
+  }
+}
+
+// Each step receives "num_tensors" tensors of "tensor_bytes" bytes on task 0
+// from task 1, with "num_concurrent_steps" steps in flight.
+void BM_RecvTensor(::testing::benchmark::State& state) {
+  const int64_t tensor_bytes = state.range(0);
+  const int num_tensors = state.range(1);
+  const int num_concurrent_steps = state.range(2);
+
+  GraphDef def;
+  for (int i = 0; i < num_tensors; ++i) {
+    const string name = strings::StrCat("x", i);
+    AddConst(name, /*task=*/1, NumElements(tensor_bytes), &def);
+    TF_CHECK_OK(NodeDefBuilder(strings::StrCat("y", i), "Identity")
+                    .Device(DeviceName(0))
+                    .Input(name, 0, DT_FLOAT)
+                    .Finalize(def.add_node()));
+  }
+  NodeDefBuilder done("done", "NoOp");
+  done.Device(DeviceName(0));
+  for (int i = 0; i < num_tensors; ++i) {
+    done.ControlInput(strings::StrCat("y", i));
+  }
+  TF_CHECK_OK(done.Finalize(def.add_node()));
+
+  std::unique_ptr<Session> session;
+  CreateSession(def, &session);
+  RunSteps(state, session.get(), {"done"}, num_concurrent_steps);
+  TF_CHECK_OK(session->Close());
+
+  const int64_t num_transfers =
+      state.iterations() * num_concurrent_steps * num_tensors;
+  state.SetItemsProcessed(num_transfers);
+  state.SetBytesProcessed(num_transfers * tensor_bytes);
+}
+BENCHMARK(BM_RecvTensor)
+    ->UseRealTime()
+    // Tensor sizes.
+    ->Args({4, 1, 1})
+    ->Args({4 << 10, 1, 1})
+    ->Args({256 << 10, 1, 1})
+    ->Args({4 << 20, 1, 1})
+    ->Args({64 << 20, 1, 1})
+    // Tensor counts.
+    ->Args({4 << 10, 16, 1})
+    ->Args({4 << 10, 256, 1})
+    ->Args({4 << 20, 16, 1})
+    // Concurrent steps.
+    ->Args({4 << 10, 1, 16})
+    ->Args({4 << 10, 16, 16})
+    ->Args({4 << 20, 1, 8});
+
+// Each step all-reduces a tensor of "tensor_bytes" bytes across the first
+// "group_size" tasks with the ring algorithm.
+void BM_RingAllReduce(::testing::benchmark::State& state) {
+  const int64_t tensor_bytes = state.range(0);
+  const int group_size = state.range(1);
+
+  const int group_key = NextCollectiveKey();
+  const int instance_key = NextCollectiveKey();
+  GraphDef def;
+  std::vector<string> targets;
+  for (int task = 0; task < group_size; ++task) {
+    const string input = strings::StrCat("x", task);
+    AddConst(input, task, NumElements(tensor_bytes), &def);
+    targets.push_back(strings::StrCat("reduce", task));
+    TF_CHECK_OK(NodeDefBuilder(targets.back(), "CollectiveReduce")
+                    .Device(DeviceName(task))
+                    .Input(input, 0, DT_FLOAT)
+                    .Attr("T", DT_FLOAT)
+                    .Attr("group_size", group_size)
+                    .Attr("group_key", group_key)
+                    .Attr("instance_key", instance_key)
+                    .Attr("merge_op", "Add")
+                    .Attr("final_op", "Id")
+                    .Attr("subdiv_offsets", std::vector<int>{0})
+                    .Attr("communication_hint", "ring")
+                    .Finalize(def.add_node()));
+  }
+
+  std::unique_ptr<Session> session;
+  CreateSession(def, &session);
+  RunSteps(state, session.get(), targets, /*num_concurrent_steps=*/1);
+  TF_CHECK_OK(session->Close());
+
+  state.SetItemsProcessed(state.iterations());
+  state.SetBytesProcessed(state.iterations() * tensor_bytes);
+}
+BENCHMARK(BM_RingAllReduce)
+    ->UseRealTime()
+    ->ArgPair(4 << 10, 2)
+    ->ArgPair(4 << 10, kNumTasks)
+    ->ArgPair(4 << 20, 2)
+    ->ArgPair(4 << 20, kNumTasks)
+    ->ArgPair(64 << 20, kNumTasks);
+
+// Each step broadcasts a tensor of "tensor_bytes" bytes from task 0 to the
+// first "group_size" tasks with the hierarchical tree algorithm.
+void BM_HierarchicalTreeBroadcast(::testing::benchmark::State& state) {
+  const int64_t tensor_bytes = state.range(0);
+  const int group_size = state.range(1);
+
+  const int group_key = NextCollectiveKey();
+  const int instance_key = NextCollectiveKey();
+  const TensorShape shape({NumElements(tensor_bytes)});
+  GraphDef def;
+  AddConst("x", /*task=*/0, shape.num_elements(), &def);
+  std::vector<string> targets;
+  for (int task = 0; task < group_size; ++task) {
+    targets.push_back(strings::StrCat("broadcast", task));
+    NodeDefBuilder builder(targets.back(), task == 0 ? "CollectiveBcastSend"
+                                                     : "CollectiveBcastRecv");
+    if (task == 0) builder.Input("x", 0, DT_FLOAT);
+    TF_CHECK_OK(builder.Device(DeviceName(task))
+                    .Attr("T", DT_FLOAT)
+                    .Attr("group_size", group_size)
+                    .Attr("group_key", group_key)
+                    .Attr("instance_key", instance_key)
+                    .Attr("shape", shape)
+                    .Finalize(def.add_node()));
+  }
+
+  std::unique_ptr<Session> session;
+  CreateSession(def, &session);
+  RunSteps(state, session.get(), targets, /*num_concurrent_steps=*/1);
+  TF_CHECK_OK(session->Close());
+
+  state.SetItemsProcessed(state.iterations());
+  state.SetBytesProcessed(state.iterations() * tensor_bytes);
+}
+BENCHMARK(BM_HierarchicalTreeBroadcast)
+    ->UseRealTime()
+    ->ArgPair(4 << 10, 2)
+    ->ArgPair(4 << 10, kNumTasks)
+    ->ArgPair(4 << 20, 2)
+    ->ArgPair(4 << 20, kNumTasks)
+    ->ArgPair(64 << 20, kNumTasks);
+
+}  // namespace
+}  // namespace tensorflow
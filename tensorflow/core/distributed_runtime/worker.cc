@@ -85,11 +85,29 @@ void Worker::RegisterGraphAsync(const RegisterGraphRequest* request,
   } else {
     session = env_->session_mgr->LegacySession();
   }
+  const GraphDef* graph_def = &request->graph_def();
+  std::shared_ptr<const GraphDef> cached_graph_def;
+  const uint64_t fingerprint = request->graph_def_fingerprint();
+  if (s.ok() && fingerprint != 0) {
+    if (request->has_graph_def()) {
+      response->set_graph_def_cached(
+          graph_def_cache_.Insert(fingerprint, *graph_def));
+    } else {
+      cached_graph_def = graph_def_cache_.Lookup(fingerprint);
+      if (cached_graph_def == nullptr) {
+        s = errors::NotFound("Graph with fingerprint ", fingerprint,
+                             " is not cached by this worker.");
+      } else {
+        graph_def = cached_graph_def.get();
+        response->set_graph_def_cached(true);
+      }
+    }
+  }
   if (s.ok()) {
     s = session->graph_mgr()->Register(
-        request->session_handle(), request->graph_def(),
-        request->graph_options(), request->debug_options(),
-        request->config_proto(), request->collective_graph_key(), session.get(),
+        request->session_handle(), *graph_def, request->graph_options(),
+        request->debug_options(), request->config_proto(),
+        request->collective_graph_key(), session.get(),
         session->cluster_flr(), response->mutable_graph_handle());
   }
   done(s);
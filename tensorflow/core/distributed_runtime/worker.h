@@ -18,6 +18,7 @@ limitations under the License.
 
 #include <unordered_map>
 
+#include "tensorflow/core/distributed_runtime/graph_def_cache.h"
 #include "tensorflow/core/distributed_runtime/graph_mgr.h"
 #include "tensorflow/core/distributed_runtime/partial_run_mgr.h"
 #include "tensorflow/core/distributed_runtime/recent_request_ids.h"
@@ -122,6 +123,10 @@ class Worker : public WorkerInterface {
 
   CancellationManager cancellation_manager_;
 
+  // Graphs registered by any session, see
+  // RegisterGraphRequest.graph_def_fingerprint.
+  GraphDefCache graph_def_cache_;
+
   Status PrepareRunGraph(RunGraphRequestWrapper* req,
                          GraphMgr::NamedTensors* in,
                          GraphMgr::NamedTensors* out);
@@ -43,10 +43,14 @@ using tsl::AllocatorWrapper;
 using tsl::cpu_allocator;
 using tsl::cpu_allocator_base;
 using tsl::CPUAllocatorFullStatsEnabled;
+using tsl::CPUAllocatorHugePageStats;
+using tsl::CPUAllocatorHugePageThreshold;
 using tsl::CPUAllocatorStatsEnabled;
 using tsl::DisableCPUAllocatorStats;
 using tsl::EnableCPUAllocatorFullStats;
 using tsl::EnableCPUAllocatorStats;
+using tsl::GetCPUAllocatorHugePageStats;
+using tsl::SetCPUAllocatorHugePageThreshold;
 using tsl::SubAllocator;
 // NOLINTEND(misc-unused-using-decls)
 
@@ -16,6 +16,7 @@ limitations under the License.
 #include "tensorflow/core/framework/allocator.h"
 
 #include <algorithm>
+#include <cstdint>
 #include <vector>
 
 #include "tensorflow/core/framework/typed_allocator.h"
@@ -172,6 +173,35 @@ TEST(CPUAllocatorTest, Simple) {
   DisableCPUAllocatorStats();
 }
 
+TEST(CPUAllocatorTest, HugePages) {
+  constexpr size_t kThreshold = 4 << 20;
+  SetCPUAllocatorHugePageThreshold(kThreshold);
+  Allocator* a = cpu_allocator_base();
+
+  // Allocations below the threshold are not affected.
+  void* small = a->AllocateRaw(Allocator::kAllocatorAlignment, kThreshold - 1);
+  ASSERT_NE(nullptr, small);
+  EXPECT_EQ(0, GetCPUAllocatorHugePageStats().num_allocs);
+
+  void* large = a->AllocateRaw(Allocator::kAllocatorAlignment, kThreshold + 1);
+  ASSERT_NE(nullptr, large);
+  EXPECT_EQ(0, reinterpret_cast<uintptr_t>(large) % port::kHugePageSize);
+  static_cast<char*>(large)[kThreshold] = 1;
+  CPUAllocatorHugePageStats stats = GetCPUAllocatorHugePageStats();
+  EXPECT_EQ(1, stats.num_allocs);
+  // The size is rounded up to a multiple of the huge page size.
+  EXPECT_EQ(kThreshold + port::kHugePageSize, stats.bytes_in_use);
+  EXPECT_LE(stats.huge_page_bytes_in_use, stats.bytes_in_use);
+
+  a->DeallocateRaw(large);
+  a->DeallocateRaw(small);
+  stats = GetCPUAllocatorHugePageStats();
+  EXPECT_EQ(0, stats.num_allocs);
+  EXPECT_EQ(0, stats.bytes_in_use);
+  EXPECT_EQ(0, stats.huge_page_bytes_in_use);
+  SetCPUAllocatorHugePageThreshold(0);
+}
+
 // Define a struct that we will use to observe behavior in the unit tests
 struct TestStruct {
   int x;  // not used just want to make sure sizeof(TestStruct) > 1
@@ -113,6 +113,9 @@ string CollInstanceParams::ToString() const {
     }
     strings::StrAppend(&v, "}");  // one subdiv
   }
+  if (!impl_details.compression.empty()) {
+    strings::StrAppend(&v, " compression=", impl_details.compression);
+  }
   if (!impl_details.subdiv_source_rank.empty()) {
     strings::StrAppend(&v, " subdiv_source_rank={");
     for (const auto& r : impl_details.subdiv_source_rank) {
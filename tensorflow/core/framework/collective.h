@@ -15,6 +15,7 @@ limitations under the License.
 #ifndef TENSORFLOW_CORE_FRAMEWORK_COLLECTIVE_H_
 #define TENSORFLOW_CORE_FRAMEWORK_COLLECTIVE_H_
 
+#include <memory>
 #include <string>
 #include <vector>
 
@@ -26,6 +27,7 @@ limitations under the License.
 #include "tensorflow/core/lib/core/refcount.h"
 #include "tensorflow/core/lib/core/status.h"
 #include "tensorflow/core/platform/intrusive_ptr.h"
+#include "tensorflow/core/platform/mutex.h"
 
 namespace tensorflow {
 
@@ -116,6 +118,13 @@ struct CollImplDetails {
                               // e.g. ring or nccl
   float timeout_seconds;      // If non zero, set a completion timeout for the
                               // collective op to detect staleness.
+  // If "float16" or "bfloat16", RingReduce casts the chunks of a float
+  // all-reduce to that type before sending them, see `RingReducer`.  Must be
+  // the same on all members of the group.
+  string compression;
+  // Set by RingAlg if the subdivisions of this execution are an autotuning
+  // trial, see `RingAutotuner`.
+  int autotune_trial = -1;
 };
 
 // Data common to all members of a collective instance.
@@ -144,6 +153,15 @@ struct CollInstanceParams {
 };
 
 // Unique to a single CollectiveOp node.
+// Error-feedback state of a compressed all-reduce, kept across the executions
+// of a collective instance on one device.
+struct CollectiveCompressionState {
+  mutex mu;
+  // The rounding error of the values that this device sent, which is added to
+  // its input at the next execution.
+  Tensor residual TF_GUARDED_BY(mu);
+};
+
 struct CollectiveParams : public core::RefCounted {
   CollGroupParams group;
   CollInstanceParams instance;
@@ -156,6 +174,8 @@ struct CollectiveParams : public core::RefCounted {
   std::vector<int> subdiv_rank;
   OpKernel* merge_op = nullptr;  // reduction only
   OpKernel* final_op = nullptr;  // reduction only
+  // Set by implementations that compress their messages.
+  std::shared_ptr<CollectiveCompressionState> compression_state;
   string ToString() const;
   bool run_group_initialization = true;
   bool is_stateless = false;
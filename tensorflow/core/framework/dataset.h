@@ -1119,6 +1119,13 @@ class IteratorBase : public Checkpointable {
     return 0;
   }
 
+  // Returns the bytes buffered by this iterator and by each of its input
+  // iterators, or `std::nullopt` if the iterator is not modeled.
+  std::optional<model::Node::MemoryUsage> GetMemoryUsage() const {
+    if (node_) return node_->GetMemoryUsage();
+    return std::nullopt;
+  }
+
  protected:
   // Returns a node that models this iterator.
   virtual std::shared_ptr<model::Node> CreateNode(
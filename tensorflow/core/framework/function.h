@@ -314,6 +314,17 @@ class CallFrameInterface {
   virtual bool CanConsumeArg(int index) const { return false; }
 
   virtual Status SetRetval(int index, const Tensor& val) = 0;
+
+  // Returns a tensor that the caller has provided to hold the value of the
+  // `index`-th return value, or nullptr if there is none. On success,
+  // `*on_host` is true iff the tensor is backed by host memory.
+  //
+  // The kernel that produces the return value may allocate its output in
+  // the buffer of the returned tensor, in which case the tensor passed to
+  // `SetRetval()` shares that buffer.
+  virtual const Tensor* GetRetvalBuffer(int index, bool* on_host) const {
+    return nullptr;
+  }
 };
 
 // Represents a function call frame. I.e., the data structure used to
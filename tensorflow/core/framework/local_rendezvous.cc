@@ -15,9 +15,11 @@ limitations under the License.
 
 #include "tensorflow/core/framework/local_rendezvous.h"
 
+#include <atomic>
 #include <memory>
 #include <string>
 #include <utility>
+#include <vector>
 
 #include "absl/strings/str_format.h"
 #include "tensorflow/core/activity_watcher/activity.h"
@@ -29,6 +31,7 @@ limitations under the License.
 #include "tensorflow/core/lib/monitoring/counter.h"
 #include "tensorflow/core/lib/strings/numbers.h"
 #include "tensorflow/core/lib/strings/str_util.h"
+#include "tensorflow/core/platform/env.h"
 #include "tensorflow/core/platform/logging.h"
 #include "tensorflow/core/platform/mutex.h"
 #include "tensorflow/core/platform/refcount.h"
@@ -106,6 +109,51 @@ struct LocalRendezvous::Item {
   }
 };
 
+// The slot of a static key. The first Send and the first RecvAsync of the key
+// each claim their side of the slot with a ticket, write their side, and then
+// set their bit in `state`: the one that sees the bit of the other one passes
+// the tensor to the waiter. An abort claims the slot in the same way, and the
+// one that sees kAborted fails the waiter or releases the tensor.
+struct LocalRendezvous::StaticSlot {
+  enum : int { kSent = 1, kRecvWaiting = 2, kAborted = 4 };
+
+  std::atomic<bool> send_claimed{false};
+  std::atomic<bool> recv_claimed{false};
+  std::atomic<bool> abort_claimed{false};
+  std::atomic<int> state{0};
+
+  // Written by the Send that claimed the slot, before setting kSent.
+  Rendezvous::Args send_args;
+  Tensor value;
+  bool is_dead = false;
+  tsl::core::RefCountPtr<Rendezvous> send_rc_owner;
+
+  // Written by the RecvAsync that claimed the slot, before setting
+  // kRecvWaiting.
+  Rendezvous::Args recv_args;
+  Rendezvous::DoneCallback waiter;
+  tsl::core::RefCountPtr<Rendezvous> recv_rc_owner;
+
+  // Written by the abort that claimed the slot, before setting kAborted.
+  Status abort_status;
+
+  // Releases the side of the Send. Returns the reference to the owner, to be
+  // released last since it may destruct the rendezvous.
+  tsl::core::RefCountPtr<Rendezvous> ReleaseSend() {
+    value = Tensor();
+    if (send_args.device_context) send_args.device_context->Unref();
+    send_args = Rendezvous::Args();
+    return std::move(send_rc_owner);
+  }
+
+  tsl::core::RefCountPtr<Rendezvous> ReleaseRecv() {
+    waiter = nullptr;
+    if (recv_args.device_context) recv_args.device_context->Unref();
+    recv_args = Rendezvous::Args();
+    return std::move(recv_rc_owner);
+  }
+};
+
 void LocalRendezvous::ItemQueue::push_back(Item* item) {
   if (TF_PREDICT_TRUE(head == nullptr)) {
     // The queue is empty.
@@ -135,6 +183,18 @@ LocalRendezvous::~LocalRendezvous() {
       table_not_empty = true;
     }
   }
+  while (static_pending_callbacks_.load(std::memory_order_acquire) != 0) {
+    Env::Default()->SleepForMicroseconds(50);
+  }
+  for (int i = 0; static_keys_ != nullptr && i < static_keys_->size(); ++i) {
+    // A Send or RecvAsync is still waiting in the slot.
+    const int state = static_slots_[i].state.load(std::memory_order_acquire);
+    const bool sent = state & StaticSlot::kSent;
+    const bool recv_waiting = state & StaticSlot::kRecvWaiting;
+    if (!(state & StaticSlot::kAborted) && sent != recv_waiting) {
+      table_not_empty = true;
+    }
+  }
   if (table_not_empty) {
     DoAbort(absl::CancelledError("LocalRendezvous deleted"));
   }
@@ -144,6 +204,117 @@ namespace {
 uint64 KeyHash(const StringPiece& k) { return Hash64(k.data(), k.size()); }
 }  // namespace
 
+StaticRendezvousKeys::StaticRendezvousKeys(
+    const std::vector<std::string>& full_keys) {
+  for (const std::string& key : full_keys) {
+    index_.emplace(KeyHash(key), index_.size());
+  }
+}
+
+void LocalRendezvous::SetStaticKeys(
+    std::shared_ptr<const StaticRendezvousKeys> keys) {
+  DCHECK(static_keys_ == nullptr);
+  static_slots_ = std::make_unique<StaticSlot[]>(keys->size());
+  static_keys_ = std::move(keys);
+}
+
+LocalRendezvous::StaticSlot* LocalRendezvous::FindStaticSlot(uint64 key_hash) {
+  if (static_keys_ == nullptr) return nullptr;
+  const int index = static_keys_->Find(key_hash);
+  return index < 0 ? nullptr : &static_slots_[index];
+}
+
+void LocalRendezvous::SendToStaticSlot(StaticSlot* slot,
+                                       const Rendezvous::Args& send_args,
+                                       const Tensor& val, bool is_dead) {
+  slot->send_args = send_args;
+  if (send_args.device_context) send_args.device_context->Ref();
+  slot->value = val;
+  slot->is_dead = is_dead;
+  slot->send_rc_owner = tsl::core::GetNewRef(rc_owner_);
+  const int state =
+      slot->state.fetch_or(StaticSlot::kSent, std::memory_order_acq_rel);
+  if (state & StaticSlot::kAborted) {
+    slot->ReleaseSend();
+  } else if (state & StaticSlot::kRecvWaiting) {
+    DeliverStaticSlot(slot);
+  }
+}
+
+void LocalRendezvous::RecvFromStaticSlot(StaticSlot* slot,
+                                         const Rendezvous::Args& recv_args,
+                                         Rendezvous::DoneCallback done) {
+  CancellationManager* cm = recv_args.cancellation_manager;
+  if (cm != nullptr) {
+    const Status cancelled =
+        StatusGroup::MakeDerived(errors::Cancelled("RecvAsync is cancelled."));
+    CancellationToken token = cm->get_cancellation_token();
+    if (!cm->RegisterCallback(token, [this, slot, cancelled] {
+          AbortStaticSlot(slot, cancelled);
+        })) {
+      AbortStaticSlot(slot, cancelled);
+      done(cancelled, Rendezvous::Args(), recv_args, Tensor(),
+           /*is_dead=*/false);
+      return;
+    }
+    // The cancellation manager may no longer be live after `done` is called.
+    done = [cm, token, done = std::move(done)](
+               const Status& s, const Rendezvous::Args& send_args,
+               const Rendezvous::Args& recv_args, const Tensor& v, bool dead) {
+      cm->TryDeregisterCallback(token);
+      done(s, send_args, recv_args, v, dead);
+    };
+  }
+  slot->recv_args = recv_args;
+  if (recv_args.device_context) recv_args.device_context->Ref();
+  slot->waiter = std::move(done);
+  slot->recv_rc_owner = tsl::core::GetNewRef(rc_owner_);
+  const int state =
+      slot->state.fetch_or(StaticSlot::kRecvWaiting, std::memory_order_acq_rel);
+  if (state & StaticSlot::kAborted) {
+    static_pending_callbacks_.fetch_add(1, std::memory_order_relaxed);
+    Rendezvous::DoneCallback waiter = std::move(slot->waiter);
+    tsl::core::RefCountPtr<Rendezvous> rc_owner = slot->ReleaseRecv();
+    waiter(slot->abort_status, Rendezvous::Args(), recv_args, Tensor(),
+           /*is_dead=*/false);
+    static_pending_callbacks_.fetch_sub(1, std::memory_order_release);
+  } else if (state & StaticSlot::kSent) {
+    DeliverStaticSlot(slot);
+  }
+}
+
+tsl::core::RefCountPtr<Rendezvous> LocalRendezvous::AbortStaticSlot(
+    StaticSlot* slot, const Status& status) {
+  if (slot->abort_claimed.exchange(true, std::memory_order_relaxed)) {
+    return nullptr;
+  }
+  slot->abort_status = status;
+  const int state =
+      slot->state.fetch_or(StaticSlot::kAborted, std::memory_order_acq_rel);
+  if (state == StaticSlot::kRecvWaiting) {
+    static_pending_callbacks_.fetch_add(1, std::memory_order_relaxed);
+    Rendezvous::DoneCallback waiter = std::move(slot->waiter);
+    Rendezvous::Args recv_args = slot->recv_args;
+    tsl::core::RefCountPtr<Rendezvous> rc_owner = slot->ReleaseRecv();
+    waiter(status, Rendezvous::Args(), recv_args, Tensor(), /*is_dead=*/false);
+    static_pending_callbacks_.fetch_sub(1, std::memory_order_release);
+    return rc_owner;
+  } else if (state == StaticSlot::kSent) {
+    return slot->ReleaseSend();
+  }
+  return nullptr;
+}
+
+void LocalRendezvous::DeliverStaticSlot(StaticSlot* slot) {
+  static_pending_callbacks_.fetch_add(1, std::memory_order_relaxed);
+  slot->waiter(OkStatus(), slot->send_args, slot->recv_args, slot->value,
+               slot->is_dead);
+  // Released last since they may destruct the rendezvous.
+  tsl::core::RefCountPtr<Rendezvous> send_rc_owner = slot->ReleaseSend();
+  tsl::core::RefCountPtr<Rendezvous> recv_rc_owner = slot->ReleaseRecv();
+  static_pending_callbacks_.fetch_sub(1, std::memory_order_release);
+}
+
 Status LocalRendezvous::Send(const Rendezvous::ParsedKey& key,
                              const Rendezvous::Args& send_args,
                              const Tensor& val, const bool is_dead) {
@@ -162,6 +333,13 @@ Status LocalRendezvous::Send(const Rendezvous::ParsedKey& key,
 
   TF_RETURN_IF_ERROR(status());
 
+  StaticSlot* slot = FindStaticSlot(key_hash);
+  if (slot != nullptr &&
+      !slot->send_claimed.exchange(true, std::memory_order_relaxed)) {
+    SendToStaticSlot(slot, send_args, val, is_dead);
+    return OkStatus();
+  }
+
   int bucket_index = key_hash % num_buckets_;
   auto& bucket = table_buckets_[bucket_index];
   bucket.mu.lock();
@@ -237,6 +415,13 @@ void LocalRendezvous::RecvAsync(const Rendezvous::ParsedKey& key,
     return;
   }
 
+  StaticSlot* slot = FindStaticSlot(key_hash);
+  if (slot != nullptr &&
+      !slot->recv_claimed.exchange(true, std::memory_order_relaxed)) {
+    RecvFromStaticSlot(slot, recv_args, std::move(done));
+    return;
+  }
+
   int bucket_index = key_hash % num_buckets_;
   auto& bucket = table_buckets_[bucket_index];
   bucket.mu.lock();
@@ -404,6 +589,12 @@ void LocalRendezvous::DoAbort(const Status& status) {
   LOG_EVERY_POW_2(INFO) << "Local rendezvous is aborting with status: "
                         << status;
 
+  // Keeps the references to the owner until the end, like `to_delete` below.
+  std::vector<tsl::core::RefCountPtr<Rendezvous>> static_rc_owners;
+  for (int i = 0; static_keys_ != nullptr && i < static_keys_->size(); ++i) {
+    static_rc_owners.push_back(AbortStaticSlot(&static_slots_[i], status));
+  }
+
   // Keeps one Item to make sure the current rendezvous won't be destructed.
   std::unique_ptr<Item> to_delete;
   for (int i = 0; i < num_buckets_; ++i) {
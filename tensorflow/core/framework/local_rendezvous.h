@@ -16,10 +16,13 @@ limitations under the License.
 #ifndef TENSORFLOW_CORE_FRAMEWORK_LOCAL_RENDEZVOUS_H_
 #define TENSORFLOW_CORE_FRAMEWORK_LOCAL_RENDEZVOUS_H_
 
+#include <atomic>
 #include <memory>
 #include <optional>
+#include <string>
 #include <vector>
 
+#include "absl/container/flat_hash_map.h"
 #include "tensorflow/core/framework/rendezvous.h"
 #include "tensorflow/core/framework/tensor.h"
 #include "tensorflow/core/lib/core/status.h"
@@ -30,6 +33,26 @@ limitations under the License.
 
 namespace tensorflow {
 
+// The keys of the Send/Recv pairs that every step of a graph exchanges, e.g.
+// the keys of the _Send/_Recv nodes between its partitions. It is built once
+// per graph and shared by the LocalRendezvous of its steps, which exchange the
+// tensor of each of these keys in a preallocated slot instead of their table.
+class StaticRendezvousKeys {
+ public:
+  explicit StaticRendezvousKeys(const std::vector<std::string>& full_keys);
+
+  // Returns the index of the key with `key_hash`, or -1.
+  int Find(uint64 key_hash) const {
+    auto it = index_.find(key_hash);
+    return it == index_.end() ? -1 : it->second;
+  }
+
+  int size() const { return index_.size(); }
+
+ private:
+  absl::flat_hash_map<uint64, int> index_;
+};
+
 // Implements the basic logic of matching Send and Recv operations. See
 // RendezvousInterface for more details.
 //
@@ -58,6 +81,13 @@ class LocalRendezvous {
   void StartAbort(const Status& status);
   Status status();
 
+  // Exchanges the tensors of `keys` in preallocated slots: the first Send and
+  // the first RecvAsync of each key meet there with atomic operations, without
+  // the lock of a table bucket or the allocation of an Item. The later pairs of
+  // the same key, if any, use the table. Must be called before the first Send
+  // or RecvAsync.
+  void SetStaticKeys(std::shared_ptr<const StaticRendezvousKeys> keys);
+
   // Releases all the references to the aborted rendezvous. Used in unit tests.
   static void ReleaseAbortedRendezvous() {
     mutex_lock l(aborted_rendezs_mu_);
@@ -70,6 +100,20 @@ class LocalRendezvous {
   tsl::core::RefCountPtr<Rendezvous> GetOwnerRefCountPtr();
 
   struct Item;
+  struct StaticSlot;
+
+  // Returns the slot of `key_hash` if it is a static key, or nullptr.
+  StaticSlot* FindStaticSlot(uint64 key_hash);
+  void SendToStaticSlot(StaticSlot* slot, const Rendezvous::Args& send_args,
+                        const Tensor& val, bool is_dead);
+  void RecvFromStaticSlot(StaticSlot* slot, const Rendezvous::Args& recv_args,
+                          Rendezvous::DoneCallback done);
+  // Returns the reference to the owner released, if any.
+  tsl::core::RefCountPtr<Rendezvous> AbortStaticSlot(StaticSlot* slot,
+                                                     const Status& status);
+  // Passes the sent tensor to the waiter, by the second one of the Send and
+  // RecvAsync to arrive.
+  void DeliverStaticSlot(StaticSlot* slot);
 
   // By invariant, the item queue under each key is of the form
   //   [item.type == kSend]* meaning each item is a sent message.
@@ -100,6 +144,12 @@ class LocalRendezvous {
 
   // Immutable set of buckets. This uses less memory than std::vector.
   const std::unique_ptr<TableBucket[]> table_buckets_;
+
+  // Set by SetStaticKeys, with a slot per key.
+  std::shared_ptr<const StaticRendezvousKeys> static_keys_;
+  std::unique_ptr<StaticSlot[]> static_slots_;
+  // The number of callbacks running for static slots.
+  std::atomic<int> static_pending_callbacks_{0};
   mutex mu_;
   Status status_ TF_GUARDED_BY(mu_);
 
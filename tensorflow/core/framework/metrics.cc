@@ -107,6 +107,26 @@ auto* tf_data_bytes_fetched_counter = tsl::monitoring::Counter<0>::New(
 auto* tf_data_elements_counter = tsl::monitoring::Counter<1>::New(
     "/tensorflow/data/elements", "tf.data elements", "name");
 
+auto* tf_data_reorder_stalls_counter = tsl::monitoring::Counter<1>::New(
+    "/tensorflow/data/reorder_stalls",
+    "The number of elements produced out of order by a tf.data Dataset "
+    "because its reorder window was full.",
+    "name");
+
+auto* tf_data_group_by_window_evictions_counter =
+    tsl::monitoring::Counter<1>::New(
+        "/tensorflow/data/group_by_window_evictions",
+        "The number of incomplete groups that tf.data `group_by_window` "
+        "flushed early to stay within its memory budget.",
+        "policy");
+
+auto* tf_data_group_by_window_evicted_elements_counter =
+    tsl::monitoring::Counter<1>::New(
+        "/tensorflow/data/group_by_window_evicted_elements",
+        "The number of elements in the incomplete groups that tf.data "
+        "`group_by_window` flushed early to stay within its memory budget.",
+        "policy");
+
 auto* tf_data_experiment_counter = tsl::monitoring::Counter<1>::New(
     "/tensorflow/data/experiment",
     "The number of times a tf.data experiment was applied.", "name");
@@ -299,6 +319,12 @@ auto* tf_data_model_gauge =
     tsl::monitoring::Gauge<std::function<std::string()>, 1>::New(
         "/tensorflow/data/model", "tf.data autotuning model proto.", "id");
 
+auto* tf_data_memory_usage_gauge =
+    tsl::monitoring::Gauge<std::function<std::string()>, 1>::New(
+        "/tensorflow/data/memory_usage",
+        "The bytes buffered by each iterator of a tf.data input pipeline.",
+        "id");
+
 auto* tf_data_pipeline_processing_time = tsl::monitoring::Gauge<double, 1>::New(
     "/tensorflow/data/pipeline_processing_time",
     "The total processing time of the slowest stage in the input pipeline "
@@ -516,11 +542,21 @@ tsl::monitoring::CounterCell* GetTFDataElementsCounter(const string& name) {
   return tf_data_elements_counter->GetCell(name);
 }
 
+tsl::monitoring::CounterCell* GetTFDataReorderStallsCounter(
+    const string& name) {
+  return tf_data_reorder_stalls_counter->GetCell(name);
+}
+
 tsl::monitoring::GaugeCell<std::function<std::string()>>* GetTFDataModelGauge(
     const string& id) {
   return tf_data_model_gauge->GetCell(id);
 }
 
+tsl::monitoring::GaugeCell<std::function<std::string()>>*
+GetTFDataMemoryUsageGauge(const string& id) {
+  return tf_data_memory_usage_gauge->GetCell(id);
+}
+
 tsl::monitoring::GaugeCell<double>* GetTFDataPipelineProcessingTimeGauge(
     const string& id) {
   return tf_data_pipeline_processing_time->GetCell(id);
@@ -696,6 +732,13 @@ void RecordTFDataFileLoggerAttempts() {
   tf_data_file_logger_attempts_counter->GetCell()->IncrementBy(1);
 }
 
+void RecordTFDataGroupByWindowEviction(const string& policy,
+                                       int64_t num_elements) {
+  tf_data_group_by_window_evictions_counter->GetCell(policy)->IncrementBy(1);
+  tf_data_group_by_window_evicted_elements_counter->GetCell(policy)
+      ->IncrementBy(num_elements);
+}
+
 void RecordTFDataFileLoggerErrors(error::Code error_code,
                                   const string& error_message) {
   tf_data_file_logger_errors_counter
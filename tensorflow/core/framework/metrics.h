@@ -72,12 +72,25 @@ monitoring::CounterCell* GetTFDataBytesReadCounter(const string& name);
 // The `name` argument identifies the Dataset type (e.g. "Batch" or "Map").
 monitoring::CounterCell* GetTFDataElementsCounter(const string& name);
 
+// Returns a counter than can be used to record the number of elements that a
+// tf.data.Dataset produced out of order because its reorder window was full.
+//
+// The `name` argument identifies the Dataset type (e.g. "ParallelMap").
+monitoring::CounterCell* GetTFDataReorderStallsCounter(const string& name);
+
 // Returns a gauge than can be used to record the performance model information.
 //
 // The `id` argument represents the (unique) model ID.
 monitoring::GaugeCell<std::function<std::string()>>* GetTFDataModelGauge(
     const string& id);
 
+// Returns a gauge than can be used to record the memory buffered by each
+// iterator of an input pipeline.
+//
+// The `id` argument represents the (unique) model ID.
+monitoring::GaugeCell<std::function<std::string()>>* GetTFDataMemoryUsageGauge(
+    const string& id);
+
 // Records the number of bytes fetched from tf.data.Dataset iterator.
 void RecordTFDataBytesFetched(int64_t num_bytes);
 
@@ -200,6 +213,13 @@ void RecordTFDataFilename(const string& name, const string& filename);
 // Records the total attempts made by file logger.
 void RecordTFDataFileLoggerAttempts();
 
+// Records that `GroupByWindowDataset` flushed an incomplete group early because
+// its buffered groups exceeded their memory budget.
+//
+// The `policy` argument identifies the eviction policy (e.g. "largest").
+void RecordTFDataGroupByWindowEviction(const string& policy,
+                                       int64_t num_elements);
+
 // Records an error of type `code` with message `error_message` encountered by
 // file logger.
 void RecordTFDataFileLoggerErrors(error::Code code,
@@ -32,6 +32,7 @@ limitations under the License.
 #include "tensorflow/core/platform/host_info.h"
 #include "tensorflow/core/platform/logging.h"
 #include "tensorflow/core/platform/mem.h"
+#include "tensorflow/core/platform/numbers.h"
 #include "tensorflow/core/platform/statusor.h"
 #include "tsl/platform/protobuf.h"
 
@@ -1655,6 +1656,7 @@ void Node::FlushMetrics() {
   metrics_.record_bytes_consumed(bytes_consumed_);
   metrics_.record_bytes_produced(bytes_produced_);
   metrics_.record_num_elements(num_elements_);
+  metrics_.record_num_reorder_stalls(num_reorder_stalls_);
 }
 
 double Node::OutputTime(Node::NodeValues* input_times,
@@ -1730,6 +1732,43 @@ double Node::TotalBufferedBytes() const {
   return total_bytes[long_name()];
 }
 
+Node::MemoryUsage Node::GetMemoryUsage() const {
+  MemoryUsage usage;
+  usage.name = long_name();
+  usage.buffered_bytes = buffered_bytes();
+  usage.peak_buffered_bytes = peak_buffered_bytes();
+  usage.buffered_elements = buffered_elements();
+  usage.total_buffered_bytes = usage.buffered_bytes;
+  for (const std::shared_ptr<Node>& input : inputs()) {
+    usage.inputs.push_back(input->GetMemoryUsage());
+    usage.total_buffered_bytes += usage.inputs.back().total_buffered_bytes;
+  }
+  return usage;
+}
+
+namespace {
+
+void MemoryUsageDebugStringHelper(const Node::MemoryUsage& usage, int depth,
+                                  string* result) {
+  strings::StrAppend(
+      result, string(2 * depth, ' '), usage.name, ": buffered ",
+      strings::HumanReadableNumBytes(usage.buffered_bytes), " in ",
+      usage.buffered_elements, " elements (peak ",
+      strings::HumanReadableNumBytes(usage.peak_buffered_bytes), "), total ",
+      strings::HumanReadableNumBytes(usage.total_buffered_bytes), "\n");
+  for (const Node::MemoryUsage& input : usage.inputs) {
+    MemoryUsageDebugStringHelper(input, depth + 1, result);
+  }
+}
+
+}  // namespace
+
+string Node::MemoryUsage::DebugString() const {
+  string result;
+  MemoryUsageDebugStringHelper(*this, /*depth=*/0, &result);
+  return result;
+}
+
 double Node::TotalMaximumBufferedBytes() const {
   Node::NodeValues total_bytes;
   tf_shared_lock l(mu_);
@@ -2033,6 +2072,8 @@ void Node::DebugStringHelper(absl::flat_hash_map<string, string>* debug_strings)
   strings::StrAppend(&result, "  processing_time=", processing_time_.load(),
                      "\n");
   strings::StrAppend(&result, "  num_elements=", num_elements_.load(), "\n");
+  strings::StrAppend(&result, "  num_reorder_stalls=",
+                     num_reorder_stalls_.load(), "\n");
   string inputs;
   for (auto& input : inputs_) {
     strings::StrAppend(&inputs, input->long_name(), ",");
@@ -2061,6 +2102,7 @@ std::shared_ptr<Node> Node::SnapshotHelper(
     cloned_current->bytes_consumed_.store(bytes_consumed_);
     cloned_current->bytes_produced_.store(bytes_produced_);
     cloned_current->num_elements_.store(num_elements_);
+    cloned_current->num_reorder_stalls_.store(num_reorder_stalls_);
     cloned_current->record_metrics_.store(false);
     cloned_current->processing_time_.store(processing_time_);
     {
@@ -2131,6 +2173,7 @@ Status Node::ToProto(ModelProto::Node* node_proto) const {
   node_proto->set_bytes_consumed(bytes_consumed_);
   node_proto->set_bytes_produced(bytes_produced_);
   node_proto->set_num_elements(num_elements_);
+  node_proto->set_num_reorder_stalls(num_reorder_stalls_);
   node_proto->set_processing_time(processing_time_);
   node_proto->set_record_metrics(record_metrics_);
 
@@ -2171,6 +2214,7 @@ Status Node::FromProtoHelper(ModelProto::Node node_proto,
     node->bytes_consumed_.store(node_proto.bytes_consumed());
     node->bytes_produced_.store(node_proto.bytes_produced());
     node->num_elements_.store(node_proto.num_elements());
+    node->num_reorder_stalls_.store(node_proto.num_reorder_stalls());
     node->processing_time_.store(node_proto.processing_time());
     node->record_metrics_.store(node_proto.record_metrics());
 
@@ -2238,6 +2282,93 @@ Status Node::FromProto(ModelProto::Node node_proto,
   return FromProtoHelper(node_proto, *node);
 }
 
+RamBudgetManager::~RamBudgetManager() {
+  GlobalRamBudget* global_budget;
+  {
+    tf_shared_lock l(mu_);
+    global_budget = global_budget_;
+  }
+  if (global_budget != nullptr) {
+    global_budget->Leave(this);
+  }
+}
+
+GlobalRamBudget* GlobalRamBudget::Get() {
+  static GlobalRamBudget* global_budget =
+      new GlobalRamBudget([]() { return port::AvailableRam(); });
+  return global_budget;
+}
+
+int64_t GlobalRamBudget::UpdateShare(RamBudgetManager* manager,
+                                     double ram_budget_share,
+                                     int64_t buffered_bytes,
+                                     double marginal_gain) {
+  mutex_lock l(mu_);
+  Pipeline& pipeline = pipelines_[manager];
+  pipeline.buffered_bytes = buffered_bytes;
+  pipeline.marginal_gain = marginal_gain;
+  {
+    mutex_lock manager_lock(manager->mu_);
+    manager->global_budget_ = this;
+  }
+
+  int64_t total_buffered_bytes = 0;
+  int64_t total_allocated_bytes = 0;
+  int64_t allocated_bytes = 0;
+  double total_known_gain = 0.0;
+  int64_t num_known_gains = 0;
+  for (const auto& [other_manager, other_pipeline] : pipelines_) {
+    const int64_t other_allocated_bytes = other_manager->AllocatedBytes();
+    if (other_manager == manager) {
+      allocated_bytes = other_allocated_bytes;
+    }
+    total_buffered_bytes += other_pipeline.buffered_bytes;
+    total_allocated_bytes += other_allocated_bytes;
+    if (other_pipeline.marginal_gain >= 0.0) {
+      total_known_gain += other_pipeline.marginal_gain;
+      ++num_known_gains;
+    }
+  }
+  // A pipeline whose gain is not known yet gets the mean gain, so that the
+  // headroom is divided evenly until the gains are known.
+  const double unknown_gain =
+      num_known_gains > 0 ? total_known_gain / num_known_gains : 1.0;
+  auto gain = [unknown_gain](const Pipeline& p) {
+    return p.marginal_gain >= 0.0 ? p.marginal_gain : unknown_gain;
+  };
+  double total_gain = 0.0;
+  for (const auto& [other_manager, other_pipeline] : pipelines_) {
+    total_gain += gain(other_pipeline);
+  }
+
+  const int64_t total_budget =
+      ram_budget_share * (available_ram_func_() + total_buffered_bytes);
+  int64_t share;
+  if (total_allocated_bytes >= total_budget) {
+    share = total_allocated_bytes > 0
+                ? static_cast<double>(total_budget) * allocated_bytes /
+                      total_allocated_bytes
+                : total_budget / static_cast<int64_t>(pipelines_.size());
+  } else {
+    const int64_t headroom = total_budget - total_allocated_bytes;
+    share = allocated_bytes +
+            (total_gain > 0.0
+                 ? headroom * gain(pipeline) / total_gain
+                 : headroom / static_cast<int64_t>(pipelines_.size()));
+  }
+  VLOG(2) << "Global ram budget: " << total_budget << ", allocated: "
+          << total_allocated_bytes << ", share of " << pipelines_.size()
+          << " pipelines: " << share;
+  return std::max<int64_t>(share, 0);
+}
+
+void GlobalRamBudget::Leave(RamBudgetManager* manager) {
+  mutex_lock l(mu_);
+  pipelines_.erase(manager);
+  mutex_lock manager_lock(manager->mu_);
+  manager->global_budget_ = nullptr;
+}
+
 Model::Model(std::optional<std::string> dataset_name)
     : dataset_name_(std::move(dataset_name)),
       optimization_period_ms_(kOptimizationPeriodMinMs),
@@ -2273,6 +2404,16 @@ Model::Model(std::optional<std::string> dataset_name)
         }
         return DebugString();
       });
+  memory_usage_gauge_cell_ = metrics::GetTFDataMemoryUsageGauge(model_id_);
+  memory_usage_gauge_cell_->Set(
+      [this, my_safe_to_collect_metrics = this->safe_to_collect_metrics_]() {
+        mutex_lock l(my_safe_to_collect_metrics->mu);
+        if (!my_safe_to_collect_metrics->val) {
+          return std::string();
+        }
+        std::optional<Node::MemoryUsage> usage = GetMemoryUsage();
+        return usage.has_value() ? usage->DebugString() : std::string();
+      });
 }
 
 Model::~Model() {
@@ -2282,6 +2423,14 @@ Model::~Model() {
   metrics::RecordPipelineProcessingTime(model_id_, 0);
 }
 
+std::optional<Node::MemoryUsage> Model::GetMemoryUsage() const {
+  std::shared_ptr<Node> snapshot = output();
+  if (!snapshot) {
+    return std::nullopt;
+  }
+  return snapshot->GetMemoryUsage();
+}
+
 void Model::AddNode(Node::Factory factory, const string& name,
                     std::shared_ptr<Node> parent,
                     std::shared_ptr<Node>* out_node) {
@@ -2361,6 +2510,14 @@ void Model::Optimize(AutotuneAlgorithm algorithm,
                        (port::AvailableRam() + TotalBufferedBytes(snapshot));
   }
 
+  if (!fixed_ram_budget.has_value() &&
+      experiments_.contains("global_ram_budget")) {
+    // Pipelines that share the process also share its RAM.
+    total_ram_budget = GlobalRamBudget::Get()->UpdateShare(
+        &ram_budget_manager, ram_budget_share, TotalBufferedBytes(snapshot),
+        marginal_ram_gain_);
+  }
+
   ram_budget_manager.UpdateBudget(total_ram_budget);
   int64_t model_ram_budget = ram_budget_manager.AvailableModelRam();
   int64_t original_model_bytes = TotalMaximumBufferedBytes(snapshot);
@@ -2403,6 +2560,10 @@ void Model::Optimize(AutotuneAlgorithm algorithm,
   if (experiments_.contains("autotune_buffer_optimization")) {
     OptimizeBuffers(snapshot, optimization_params.ram_budget());
   }
+  if (experiments_.contains("global_ram_budget")) {
+    marginal_ram_gain_ =
+        MarginalRamGain(snapshot, optimization_params.model_input_time());
+  }
   {
     // Save the snapshot of the model proto including the parameters used by
     // autotune. This will be used as the model proto returned in `tfstreamz`.
@@ -2465,6 +2626,12 @@ Model::ModelParameters Model::CollectTunableParameters(
 void Model::MaybeSyncStateValuesToValues(std::shared_ptr<Node> snapshot) {
   auto subtree_nodes = snapshot->CollectNodes(TraversalOrder::BFS, IsAnyNode);
   for (const auto& node : subtree_nodes) {
+    if (absl::StartsWith(node->name(), kParallelInterleave)) {
+      // Parallel interleave may adapt its cycle length to the latency of its
+      // inputs.
+      node->SyncStateValuesToParameterValues(kCycleLength);
+      continue;
+    }
     if (!absl::StartsWith(node->name(), kDataService)) {
       continue;
     }
@@ -2505,6 +2672,32 @@ absl::flat_hash_map<Node*, Parameter*> Model::CollectBufferParametersToUpsize(
   return node_parameters;
 }
 
+double Model::MarginalRamGain(std::shared_ptr<Node> snapshot,
+                              double model_input_time) {
+  auto parameters = CollectTunableParameters(snapshot);
+  const double output_time =
+      OutputTime(snapshot, model_input_time, /*gradients=*/nullptr);
+  const double buffered_bytes = TotalMaximumBufferedBytes(snapshot);
+  double marginal_gain = 0.0;
+  for (auto& pair : parameters) {
+    Parameter* parameter = pair.second.get();
+    if (parameter->name != kBufferSize || parameter->value >= parameter->max) {
+      continue;
+    }
+    parameter->value++;
+    const double delta_time =
+        output_time -
+        OutputTime(snapshot, model_input_time, /*gradients=*/nullptr);
+    const double delta_bytes =
+        TotalMaximumBufferedBytes(snapshot) - buffered_bytes;
+    parameter->value--;
+    if (delta_bytes > 0.0) {
+      marginal_gain = std::max(marginal_gain, delta_time / delta_bytes);
+    }
+  }
+  return marginal_gain;
+}
+
 bool Model::ShouldStop(int64_t cpu_budget, int64_t ram_budget,
                        const Model::ModelParameters& parameters,
                        const Model::ModelParameters& parallelism_parameters,
@@ -146,6 +146,8 @@ std::shared_ptr<Parameter> MakeParameter(const string& name,
 std::shared_ptr<Parameter> MakeNonTunableParameter(const string& name,
                                                    double value);
 
+class GlobalRamBudget;
+
 // Class for managing the ram budget of an iterator. This is necessary for
 // coordinating ram usage between the model-based autotuner and the legacy
 // prefetch autotuner. Once the legacy autotuner is retired we can remove this
@@ -160,6 +162,9 @@ class RamBudgetManager {
     }
   }
 
+  // Leaves the `GlobalRamBudget` that this manager has joined, if any.
+  ~RamBudgetManager();
+
   // Requests a new total memory allocation for the parts of the dataset
   // tuned by the model.
   //
@@ -237,6 +242,13 @@ class RamBudgetManager {
     VLOG(2) << "Updated ram budget to " << budget;
   }
 
+  // The total number of bytes allocated by the model and the legacy prefetch
+  // autotuner.
+  int64_t AllocatedBytes() const {
+    tf_shared_lock l(mu_);
+    return legacy_prefetch_allocated_ + model_allocated_;
+  }
+
   std::string DebugString() {
     mutex_lock l(mu_);
     return absl::StrCat("RamBudgetManager: budget_: ", budget_,
@@ -245,12 +257,65 @@ class RamBudgetManager {
   }
 
  private:
+  friend class GlobalRamBudget;
+
   mutable mutex mu_;
   int64_t budget_ TF_GUARDED_BY(mu_) = 0;
   // Number of bytes allocated by legacy prefetch autotuner.
   int64_t legacy_prefetch_allocated_ TF_GUARDED_BY(mu_) = 0;
   // Number of bytes allocated by the model.
   int64_t model_allocated_ TF_GUARDED_BY(mu_) = 0;
+  // The global budget that this manager has joined, or nullptr.
+  GlobalRamBudget* global_budget_ TF_GUARDED_BY(mu_) = nullptr;
+};
+
+// Divides one RAM budget between the `RamBudgetManager`s of all the input
+// pipelines of a process, so that pipelines which are autotuned independently
+// cannot collectively buffer more than the host can hold.
+//
+// The budget is `ram_budget_share` of the RAM that would be available if no
+// pipeline buffered anything, i.e. the currently available RAM plus the bytes
+// buffered by all the pipelines that joined. Every pipeline keeps the bytes
+// that it has already been allocated, and the remaining headroom is divided in
+// proportion to the marginal gain of each pipeline, i.e. the reduction of its
+// modeled output time per additional byte buffered. When the budget no longer
+// covers the allocated bytes, e.g. because other processes use more memory,
+// the share of every pipeline shrinks in proportion to its allocation, and the
+// autotuner downsizes its buffers to fit in the next optimization round.
+class GlobalRamBudget {
+ public:
+  // Returns the process-wide instance, which budgets `port::AvailableRam()`.
+  static GlobalRamBudget* Get();
+
+  explicit GlobalRamBudget(std::function<int64_t()> available_ram_func)
+      : available_ram_func_(std::move(available_ram_func)) {}
+
+  // Updates the buffered bytes and the marginal gain of the pipeline of
+  // `manager`, which joins this budget if it has not yet, and returns its
+  // share of the budget. A negative `marginal_gain` means that the gain is not
+  // known yet, in which case the mean gain of the other pipelines is used.
+  int64_t UpdateShare(RamBudgetManager* manager, double ram_budget_share,
+                      int64_t buffered_bytes, double marginal_gain);
+
+  // Removes `manager` from this budget.
+  void Leave(RamBudgetManager* manager);
+
+  // Returns the number of pipelines that joined this budget.
+  int64_t num_pipelines() const {
+    tf_shared_lock l(mu_);
+    return pipelines_.size();
+  }
+
+ private:
+  struct Pipeline {
+    int64_t buffered_bytes = 0;
+    double marginal_gain = -1.0;
+  };
+
+  const std::function<int64_t()> available_ram_func_;
+  mutable mutex mu_;
+  absl::flat_hash_map<RamBudgetManager*, Pipeline> pipelines_
+      TF_GUARDED_BY(mu_);
 };
 
 // Abstract representation of a TensorFlow input pipeline node. It collects
@@ -291,6 +356,22 @@ class Node {
   using ParameterGradients =
       absl::flat_hash_map<std::pair<string, string>, double>;
 
+  // The memory buffered by the iterator that a node models, and by the
+  // iterators of its inputs.
+  struct MemoryUsage {
+    // The long name of the node.
+    string name;
+    int64_t buffered_bytes = 0;
+    int64_t peak_buffered_bytes = 0;
+    int64_t buffered_elements = 0;
+    // `buffered_bytes` plus the `total_buffered_bytes` of all inputs.
+    int64_t total_buffered_bytes = 0;
+    std::vector<MemoryUsage> inputs;
+
+    // Returns one line per node, with inputs indented below their output.
+    string DebugString() const;
+  };
+
   explicit Node(Args args)
       : id_(args.id),
         name_(std::move(args.name)),
@@ -303,6 +384,7 @@ class Node {
         bytes_consumed_(0),
         bytes_produced_(0),
         num_elements_(0),
+        num_reorder_stalls_(0),
         processing_time_(0),
         record_metrics_(true),
         metrics_(name_),
@@ -415,6 +497,12 @@ class Node {
   // Returns the number of elements produced by the node.
   int64_t num_elements() const TF_LOCKS_EXCLUDED(mu_) { return num_elements_; }
 
+  // Returns the number of elements the node produced out of order because its
+  // reorder window was full.
+  int64_t num_reorder_stalls() const TF_LOCKS_EXCLUDED(mu_) {
+    return num_reorder_stalls_;
+  }
+
   // Returns the node output.
   Node* output() const { return output_; }
   std::shared_ptr<Node> output_shared() { return output_weak_ptr_.lock(); }
@@ -466,6 +554,10 @@ class Node {
     }
   }
 
+  // Records that the node produced an element out of order because its
+  // reorder window was full.
+  void record_reorder_stall() { num_reorder_stalls_++; }
+
   // Records that a node thread has started executing.
   void record_start(int64_t time_nanos) TF_LOCKS_EXCLUDED(mu_) {
     DCHECK_EQ(work_start_, 0);
@@ -583,6 +675,11 @@ class Node {
   // which autotuning is enabled.
   double TotalBufferedBytes() const TF_LOCKS_EXCLUDED(mu_);
 
+  // Returns the bytes buffered by each node in the subtree. Unlike
+  // `TotalBufferedBytes()`, this includes nodes without tunable buffers, such
+  // as shuffle, and nodes for which autotuning is disabled.
+  MemoryUsage GetMemoryUsage() const TF_LOCKS_EXCLUDED(mu_);
+
   // Collects the total buffer limit of all nodes in the subtree for which
   // autotuning is enabled. This number represents the amount of memory that
   // would be used by the subtree nodes if all of their buffers were full.
@@ -638,9 +735,11 @@ class Node {
         : bytes_consumed_counter_(metrics::GetTFDataBytesConsumedCounter(name)),
           bytes_produced_counter_(metrics::GetTFDataBytesProducedCounter(name)),
           num_elements_counter_(metrics::GetTFDataElementsCounter(name)),
+          reorder_stalls_counter_(metrics::GetTFDataReorderStallsCounter(name)),
           recorded_bytes_consumed_(0),
           recorded_bytes_produced_(0),
-          recorded_num_elements_(0) {}
+          recorded_num_elements_(0),
+          recorded_num_reorder_stalls_(0) {}
 
     // Expects the total number of bytes consumed and records the delta since
     // last invocation.
@@ -666,13 +765,23 @@ class Node {
       num_elements_counter_->IncrementBy(delta);
     }
 
+    // Expects the total number of reorder stalls and records the delta since
+    // last invocation.
+    void record_num_reorder_stalls(int64_t total_stalls) {
+      int64_t delta =
+          total_stalls - recorded_num_reorder_stalls_.exchange(total_stalls);
+      reorder_stalls_counter_->IncrementBy(delta);
+    }
+
    private:
     monitoring::CounterCell* const bytes_consumed_counter_;
     monitoring::CounterCell* const bytes_produced_counter_;
     monitoring::CounterCell* const num_elements_counter_;
+    monitoring::CounterCell* const reorder_stalls_counter_;
     std::atomic<int64_t> recorded_bytes_consumed_;
     std::atomic<int64_t> recorded_bytes_produced_;
     std::atomic<int64_t> recorded_num_elements_;
+    std::atomic<int64_t> recorded_num_reorder_stalls_;
   };
 
   // Computes the exponential moving average of processing time per element.
@@ -830,6 +939,7 @@ class Node {
   std::atomic<int64_t> bytes_consumed_;
   std::atomic<int64_t> bytes_produced_;
   std::atomic<int64_t> num_elements_;
+  std::atomic<int64_t> num_reorder_stalls_;
   std::atomic<int64_t> processing_time_;
   std::atomic<bool> record_metrics_;
   Metrics metrics_;
@@ -930,6 +1040,11 @@ class Model {
     return output_;
   }
 
+  // Returns the bytes buffered by each node of the model, or `std::nullopt` if
+  // the model has no output node yet.
+  std::optional<Node::MemoryUsage> GetMemoryUsage() const
+      TF_LOCKS_EXCLUDED(mu_);
+
   // Set the experiment that this job is part of.
   void AddExperiment(const std::string& experiment) {
     experiments_.insert(experiment);
@@ -1053,6 +1168,12 @@ class Model {
   // respecting the ram budget. Returns true if any buffer is upsized.
   bool UpsizeBuffers(std::shared_ptr<Node> snapshot, int64_t ram_budget);
 
+  // Returns the largest reduction of the output time of `snapshot`, in
+  // nanoseconds per element, per additional byte buffered that incrementing
+  // one of its tunable buffer sizes would achieve.
+  double MarginalRamGain(std::shared_ptr<Node> snapshot,
+                         double model_input_time);
+
   // Reset buffer watermarks of all asynchronous nodes to their buffered
   // elements.
   void ResetBufferWatermarks();
@@ -1173,6 +1294,9 @@ class Model {
   // Gauge cell that can be used to collect the state of the model.
   monitoring::GaugeCell<std::function<std::string()>>* model_gauge_cell_ =
       nullptr;
+  // Gauge cell that can be used to collect the memory buffered by each node.
+  monitoring::GaugeCell<std::function<std::string()>>*
+      memory_usage_gauge_cell_ = nullptr;
   // Used to synchronize metrics collection attempts against the model's
   // destruction.
   struct GuardedBool {
@@ -1196,6 +1320,9 @@ class Model {
   std::deque<uint64_t> gap_times_usec_ TF_GUARDED_BY(gap_mu_);
   // The experiment that this job is part of.
   absl::flat_hash_set<std::string> experiments_;
+  // The marginal gain of the last optimization, reported to the
+  // `GlobalRamBudget`, or a negative value if not yet known.
+  double marginal_ram_gain_ = -1.0;
   // Stores the optimization snapshot of the Model.
   std::shared_ptr<Node> snapshot_ TF_GUARDED_BY(mu_);
   // Stores the optimization parameters used by autotune.
@@ -20,6 +20,7 @@ limitations under the License.
 #include <cstdlib>
 #include <functional>
 #include <memory>
+#include <optional>
 #include <string>
 #include <tuple>
 #include <utility>
@@ -685,6 +686,65 @@ TEST(BufferedBytesTest, Node) {
   EXPECT_EQ(node->inputs().size(), 0);
 }
 
+TEST(MemoryUsageTest, Node) {
+  std::shared_ptr<Node> prefetch = model::MakeAsyncKnownRatioNode(
+      {0, "Prefetch", nullptr}, 1,
+      {model::MakeParameter("buffer_size",
+                            std::make_shared<SharedState>(3, nullptr, nullptr),
+                            1, 10)});
+  // Shuffle buffers are not tunable, so they are not part of
+  // `TotalBufferedBytes()`.
+  std::shared_ptr<Node> shuffle =
+      model::MakeKnownRatioNode({1, "Shuffle", prefetch}, 1);
+  std::shared_ptr<Node> source = model::MakeSourceNode({2, "Range", shuffle});
+  prefetch->add_input(shuffle);
+  shuffle->add_input(source);
+
+  prefetch->record_buffer_event(30, 1);
+  shuffle->record_buffer_event(100, 5);
+  shuffle->record_buffer_event(-20, -1);
+  EXPECT_EQ(prefetch->TotalBufferedBytes(), 30);
+
+  Node::MemoryUsage usage = prefetch->GetMemoryUsage();
+  EXPECT_EQ(usage.name, "Prefetch(id:0)");
+  EXPECT_EQ(usage.buffered_bytes, 30);
+  EXPECT_EQ(usage.buffered_elements, 1);
+  EXPECT_EQ(usage.total_buffered_bytes, 110);
+  ASSERT_EQ(usage.inputs.size(), 1);
+  const Node::MemoryUsage& shuffle_usage = usage.inputs[0];
+  EXPECT_EQ(shuffle_usage.name, "Shuffle(id:1)");
+  EXPECT_EQ(shuffle_usage.buffered_bytes, 80);
+  EXPECT_EQ(shuffle_usage.peak_buffered_bytes, 100);
+  EXPECT_EQ(shuffle_usage.buffered_elements, 4);
+  EXPECT_EQ(shuffle_usage.total_buffered_bytes, 80);
+  ASSERT_EQ(shuffle_usage.inputs.size(), 1);
+  EXPECT_EQ(shuffle_usage.inputs[0].name, "Range(id:2)");
+  EXPECT_EQ(shuffle_usage.inputs[0].total_buffered_bytes, 0);
+  EXPECT_TRUE(shuffle_usage.inputs[0].inputs.empty());
+
+  EXPECT_EQ(usage.DebugString(),
+            "Prefetch(id:0): buffered 30B in 1 elements (peak 30B), total "
+            "110B\n"
+            "  Shuffle(id:1): buffered 80B in 4 elements (peak 100B), total "
+            "80B\n"
+            "    Range(id:2): buffered 0B in 0 elements (peak 0B), total 0B\n");
+}
+
+TEST(MemoryUsageTest, Model) {
+  Model model;
+  EXPECT_FALSE(model.GetMemoryUsage().has_value());
+  std::shared_ptr<Node> root;
+  model.AddNode(
+      [](model::Node::Args args) {
+        return model::MakeSourceNode(std::move(args));
+      },
+      "Range", nullptr, &root);
+  root->record_buffer_event(8, 1);
+  std::optional<Node::MemoryUsage> usage = model.GetMemoryUsage();
+  ASSERT_TRUE(usage.has_value());
+  EXPECT_EQ(usage->total_buffered_bytes, 8);
+}
+
 // Returns a weighted sum of a prior and the actual processing time.
 double weighted_processing_time(int64_t num_elements, double processing_time,
                                 double prior) {
@@ -3572,6 +3632,39 @@ TEST(RamBudgetManagerTest, RequestAllocationsWithBudgetAdjustment) {
   EXPECT_TRUE(rbm.RequestLegacyPrefetchBytes(4));
 }
 
+TEST(GlobalRamBudgetTest, DividesBudgetBetweenPipelines) {
+  int64_t available_ram = 1000;
+  GlobalRamBudget global_budget([&available_ram]() { return available_ram; });
+  RamBudgetManager a(0);
+  {
+    RamBudgetManager b(0);
+    EXPECT_EQ(1000, global_budget.UpdateShare(&a, /*ram_budget_share=*/1.0,
+                                              /*buffered_bytes=*/0,
+                                              /*marginal_gain=*/-1.0));
+    // Pipelines whose gains are not known yet split the headroom evenly.
+    EXPECT_EQ(500, global_budget.UpdateShare(&b, 1.0, 0, -1.0));
+    EXPECT_EQ(2, global_budget.num_pipelines());
+
+    a.UpdateBudget(1000);
+    ASSERT_TRUE(a.RequestModelAllocation(400));
+    available_ram = 600;
+    // Allocations are kept and the headroom is divided by marginal gain. A
+    // pipeline whose gain is not known yet gets the mean of the known gains.
+    EXPECT_EQ(300, global_budget.UpdateShare(&b, 1.0, 0, 1.0));
+    EXPECT_EQ(850, global_budget.UpdateShare(&a, 1.0, 400, 3.0));
+    EXPECT_EQ(150, global_budget.UpdateShare(&b, 1.0, 0, 1.0));
+
+    b.UpdateBudget(150);
+    ASSERT_TRUE(b.RequestModelAllocation(100));
+    available_ram = 0;
+    // Under memory pressure, shares shrink in proportion to allocations.
+    EXPECT_EQ(50, global_budget.UpdateShare(&b, 0.5, 100, 1.0));
+    EXPECT_EQ(200, global_budget.UpdateShare(&a, 0.5, 400, 3.0));
+  }
+  // Destroyed managers leave the budget.
+  EXPECT_EQ(1, global_budget.num_pipelines());
+}
+
 TEST(NodeTest, OnlyCollectParametersThatHaveElementsProduced) {
   // Builds a graph:
   // root <- parallel_map <- parallel_interleave
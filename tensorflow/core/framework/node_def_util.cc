@@ -44,6 +44,7 @@ limitations under the License.
 namespace tensorflow {
 
 const char* const kColocationAttrName = "_class";
+const char* const kSchedulingPriorityAttrName = "_scheduling_priority";
 const char* const kColocationGroupPrefix = "loc:@";
 // For TPU distributed rewrite, TPU args are collected and "staged" on the local
 // host using an IdentityN TF op. Some args may result from a remote source.
@@ -54,6 +54,10 @@ class TensorShapeProto;
 // is described by list(string) attribute containing the name of colocation
 // groups.
 extern const char* const kColocationAttrName;
+// Name of the int attribute that holds the scheduling priority of a node.
+// When several nodes are ready, the executor runs those with higher priorities
+// first.
+extern const char* const kSchedulingPriorityAttrName;
 
 // String prefix applied to the operation name for colocation constraints.
 extern const char* const kColocationGroupPrefix;
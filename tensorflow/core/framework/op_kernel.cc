@@ -377,6 +377,16 @@ Allocator* OpKernelContext::get_allocator(AllocatorAttributes attr) {
   if (TF_PREDICT_FALSE(attr.scope_id > 0)) {
     allocator = params_->device->GetScopedAllocator(attr, step_id());
     CHECK(allocator);
+  } else if (TF_PREDICT_FALSE(params_->step_arena_allocator != nullptr) &&
+             attr.value == 0) {
+    allocator = params_->step_arena_allocator;
+  } else if (TF_PREDICT_FALSE(params_->memory_attribution_allocator !=
+                              nullptr) &&
+             attr.value == 0) {
+    allocator = params_->memory_attribution_allocator;
+  } else if (TF_PREDICT_FALSE(params_->buffer_pool_allocator != nullptr) &&
+             attr.value == 0) {
+    allocator = params_->buffer_pool_allocator;
   } else {
     allocator = params_->device->GetAllocator(attr);
   }
@@ -815,6 +825,16 @@ Status OpKernelContext::allocate_output(int index, const TensorShape& shape,
           " more than once.  Try turning off the ScopedAllocator optimizer.");
     }
   }
+  if (TF_PREDICT_FALSE(params_->output_buffers != nullptr) &&
+      attr.scope_id == 0) {
+    const Tensor* buffer = params_->output_buffers[index];
+    if (buffer != nullptr && buffer->dtype() == type &&
+        buffer->shape() == shape) {
+      outputs_[index] = TensorValue(new Tensor(*buffer));
+      *output = outputs_[index].tensor;
+      return OkStatus();
+    }
+  }
   profiler::ScopedMemoryDebugAnnotation op_annotation(
       op_kernel().name_view().data(), step_id(), "output", type,
       [&shape]() { return shape.DebugString(); });
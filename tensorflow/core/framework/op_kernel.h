@@ -619,9 +619,32 @@ class OpKernelContext {
     bool track_allocations = false;
     bool log_memory = false;
 
+    // If non-null, allocations with default `AllocatorAttributes` are made
+    // using this allocator instead of the device's allocator. The executor
+    // uses this to serve the intermediate tensors of a step from an arena.
+    Allocator* step_arena_allocator = nullptr;
+
+    // If non-null, and `step_arena_allocator` is null, allocations with
+    // default `AllocatorAttributes` are made using this allocator instead of
+    // the device's allocator. The executor uses this to attribute the memory
+    // of sampled steps to the nodes that allocate it.
+    Allocator* memory_attribution_allocator = nullptr;
+
+    // If non-null, and the allocators above are null, allocations with
+    // default `AllocatorAttributes` are made using this allocator instead of
+    // the device's allocator. Eager ops use this to recycle the buffers of
+    // dead tensors.
+    Allocator* buffer_pool_allocator = nullptr;
+
     // Array indexed by output number for this node
     const AllocatorAttributes* output_attr_array = nullptr;
 
+    // If non-null, an array indexed by output number for this node. If the
+    // entry for an output is non-null, and `allocate_output()` is called for
+    // that output with the entry's type and shape, the output shares the
+    // entry's buffer instead of being newly allocated.
+    const Tensor* const* output_buffers = nullptr;
+
     // Shared resources accessible by this op kernel invocation.
     ResourceMgr* resource_manager = nullptr;
 
@@ -18,6 +18,7 @@ limitations under the License.
 #include "absl/status/status.h"
 #include "unsupported/Eigen/CXX11/Tensor"  // from @eigen_archive
 #include "tensorflow/core/framework/cancellation.h"
+#include "tensorflow/core/framework/local_rendezvous.h"
 #include "tensorflow/core/framework/tensor.h"
 #include "tensorflow/core/framework/tensor_shape.h"
 #include "tensorflow/core/framework/tensor_types.h"
@@ -434,6 +435,116 @@ TEST_F(LocalRendezvousTest, TransferDummyDeviceContext) {
   args1.device_context->Unref();
 }
 
+class StaticKeysTest : public ::testing::Test {
+ public:
+  StaticKeysTest() : local_(/*owner=*/nullptr, /*num_shards=*/1) {
+    local_.SetStaticKeys(std::make_shared<StaticRendezvousKeys>(
+        std::vector<string>({string(KeyFoo().FullKey())})));
+  }
+
+  // Starts a RecvAsync of `key`, which sets `status` and `val` when done.
+  void RecvAsync(const Rendezvous::ParsedKey& key,
+                 const Rendezvous::Args& args, Notification* n, Status* status,
+                 string* val) {
+    local_.RecvAsync(key, args,
+                     [n, status, val](const Status& s, const Rendezvous::Args&,
+                                      const Rendezvous::Args&, const Tensor& v,
+                                      bool) {
+                       *status = s;
+                       if (s.ok()) *val = V(v);
+                       n->Notify();
+                     });
+  }
+
+  LocalRendezvous local_;
+};
+
+TEST_F(StaticKeysTest, SendRecv) {
+  Rendezvous::Args args;
+  TF_ASSERT_OK(local_.Send(KeyFoo(), args, V("hello"), false));
+  Notification n;
+  Status status;
+  string val;
+  RecvAsync(KeyFoo(), args, &n, &status, &val);
+  ASSERT_TRUE(n.HasBeenNotified());
+  TF_EXPECT_OK(status);
+  EXPECT_EQ("hello", val);
+}
+
+TEST_F(StaticKeysTest, RecvSend) {
+  Rendezvous::Args args;
+  Notification n;
+  Status status;
+  string val;
+  RecvAsync(KeyFoo(), args, &n, &status, &val);
+  EXPECT_FALSE(n.HasBeenNotified());
+  TF_ASSERT_OK(local_.Send(KeyFoo(), args, V("hello"), false));
+  ASSERT_TRUE(n.HasBeenNotified());
+  TF_EXPECT_OK(status);
+  EXPECT_EQ("hello", val);
+}
+
+TEST_F(StaticKeysTest, RepeatedKeyAndOtherKeysUseTheTable) {
+  Rendezvous::Args args;
+  TF_ASSERT_OK(local_.Send(KeyFoo(), args, V("first"), false));
+  TF_ASSERT_OK(local_.Send(KeyFoo(), args, V("second"), false));
+  TF_ASSERT_OK(local_.Send(KeyBar(), args, V("bar"), false));
+  Notification n1, n2, n3;
+  Status status1, status2, status3;
+  string val1, val2, val3;
+  RecvAsync(KeyFoo(), args, &n1, &status1, &val1);
+  RecvAsync(KeyFoo(), args, &n2, &status2, &val2);
+  RecvAsync(KeyBar(), args, &n3, &status3, &val3);
+  TF_EXPECT_OK(status1);
+  TF_EXPECT_OK(status2);
+  TF_EXPECT_OK(status3);
+  EXPECT_EQ("first", val1);
+  EXPECT_EQ("second", val2);
+  EXPECT_EQ("bar", val3);
+}
+
+TEST_F(StaticKeysTest, AbortWaitingRecv) {
+  Rendezvous::Args args;
+  Notification n;
+  Status status;
+  string val;
+  RecvAsync(KeyFoo(), args, &n, &status, &val);
+  local_.StartAbort(errors::Aborted(""));
+  ASSERT_TRUE(n.HasBeenNotified());
+  EXPECT_TRUE(absl::IsAborted(status));
+  EXPECT_TRUE(absl::IsAborted(local_.Send(KeyFoo(), args, V("hello"), false)));
+}
+
+TEST_F(StaticKeysTest, CancelWaitingRecv) {
+  CancellationManager cm;
+  Rendezvous::Args args;
+  args.cancellation_manager = &cm;
+  Notification n;
+  Status status;
+  string val;
+  RecvAsync(KeyFoo(), args, &n, &status, &val);
+  cm.StartCancel();
+  ASSERT_TRUE(n.HasBeenNotified());
+  EXPECT_TRUE(absl::IsCancelled(status));
+  // The Send after the cancellation is dropped.
+  TF_EXPECT_OK(local_.Send(KeyFoo(), Rendezvous::Args(), V("hello"), false));
+}
+
+TEST_F(StaticKeysTest, ConcurrentSendRecv) {
+  thread::ThreadPool threads(Env::Default(), "test", 2);
+  Notification n;
+  Status status;
+  string val;
+  threads.Schedule([&] {
+    TF_ASSERT_OK(local_.Send(KeyFoo(), Rendezvous::Args(), V("hello"), false));
+  });
+  threads.Schedule(
+      [&] { RecvAsync(KeyFoo(), Rendezvous::Args(), &n, &status, &val); });
+  n.WaitForNotification();
+  TF_EXPECT_OK(status);
+  EXPECT_EQ("hello", val);
+}
+
 void BM_SendRecv(::testing::benchmark::State& state) {
   Rendezvous* rendez = NewLocalRendezvous();
   Tensor orig = V("val");
@@ -128,10 +128,29 @@ ResourceMgr::ResourceAndName& ResourceMgr::ResourceAndName::operator=(
   return *this;
 }
 
-ResourceMgr::ResourceMgr() : default_container_("localhost") {}
+namespace {
+
+// The generations of all the ResourceMgrs come from this counter, so that a
+// ResourceMgr allocated at the address of a deleted one doesn't reuse its
+// generations.
+uint64 NewResourceMgrGeneration() {
+  static std::atomic<uint64> next_generation(1);
+  return next_generation.fetch_add(1, std::memory_order_relaxed);
+}
+
+}  // namespace
+
+ResourceMgr::ResourceMgr()
+    : default_container_("localhost"),
+      generation_(NewResourceMgrGeneration()) {}
 
 ResourceMgr::ResourceMgr(const string& default_container)
-    : default_container_(default_container) {}
+    : default_container_(default_container),
+      generation_(NewResourceMgrGeneration()) {}
+
+void ResourceMgr::BumpGeneration() {
+  generation_.store(NewResourceMgrGeneration(), std::memory_order_release);
+}
 
 ResourceMgr::~ResourceMgr() { Clear(); }
 
@@ -143,6 +162,7 @@ void ResourceMgr::Clear() {
     mutex_lock l(mu_);
     tmp_containers = std::move(containers_);
     containers_.clear();  // reinitialize after move.
+    BumpGeneration();
   }
   for (const auto& p : tmp_containers) {
     delete p.second;
@@ -205,6 +225,7 @@ Status ResourceMgr::DoCreate(const string& container_name, TypeIndex type,
       auto iter = container->find({type.hash_code(), borrowed_name});
       if (iter != container->end()) {
         container->erase(iter);
+        BumpGeneration();
       }
     };
     resource_and_name.resource =
@@ -230,6 +251,22 @@ Status ResourceMgr::Lookup(const ResourceHandle& handle,
                   /*type_name=*/"ResourceBase", handle.name(), resource);
 }
 
+Status ResourceMgr::LookupWithGeneration(const ResourceHandle& handle,
+                                         ResourceBase** resource,
+                                         uint64* generation,
+                                         bool* owned) const {
+  tf_shared_lock l(mu_);
+  TF_RETURN_IF_ERROR(DoLookup(handle.container(), handle.hash_code(),
+                              /*type_name=*/"ResourceBase", handle.name(),
+                              resource));
+  *generation = generation_.load(std::memory_order_relaxed);
+  const Container* b = gtl::FindPtrOrNull(containers_, handle.container());
+  auto iter = b->find({handle.hash_code(), handle.name()});
+  *owned = absl::holds_alternative<core::RefCountPtr<ResourceBase>>(
+      iter->second.resource);
+  return OkStatus();
+}
+
 Status ResourceMgr::DoLookup(const string& container, TypeIndex type,
                              const string& name,
                              ResourceBase** resource) const {
@@ -277,6 +314,7 @@ Status ResourceMgr::PopResourceAndName(const string& container,
   }
   std::swap(resource_and_name, iter->second);
   b->erase(iter);
+  BumpGeneration();
   return OkStatus();
 }
 
@@ -326,6 +364,7 @@ Status ResourceMgr::Cleanup(const string& container) {
     }
     b = iter->second;
     containers_.erase(iter);
+    BumpGeneration();
   }
   CHECK(b != nullptr);
   delete b;
@@ -16,6 +16,7 @@ limitations under the License.
 #ifndef TENSORFLOW_CORE_FRAMEWORK_RESOURCE_MGR_H_
 #define TENSORFLOW_CORE_FRAMEWORK_RESOURCE_MGR_H_
 
+#include <atomic>
 #include <memory>
 #include <string>
 #include <typeindex>
@@ -194,6 +195,20 @@ class ResourceMgr {
   Status Lookup(const ResourceHandle& handle,
                 ResourceBase** resource) const TF_MUST_USE_RESULT;
 
+  // Like Lookup(handle, resource), but also returns in "*generation" the
+  // generation() of the lookup, and in "*owned" whether *this owns a ref on
+  // "*resource" (i.e. it was not created with CreateUnowned()).
+  Status LookupWithGeneration(const ResourceHandle& handle,
+                              ResourceBase** resource, uint64* generation,
+                              bool* owned) const TF_MUST_USE_RESULT;
+
+  // Returns a number that changes whenever a resource is removed from *this,
+  // and that no other ResourceMgr returns. While it is unchanged, a resource
+  // found by a lookup is still the one that the same lookup would find.
+  uint64 generation() const {
+    return generation_.load(std::memory_order_acquire);
+  }
+
   // Similar to Lookup, but looks up multiple resources at once, with only a
   // single lock acquisition.  If containers_and_names[i] is uninitialized
   // then this function does not modify resources[i].
@@ -275,6 +290,12 @@ class ResourceMgr {
   const std::string default_container_;
   mutable mutex mu_;
   absl::flat_hash_map<string, Container*> containers_ TF_GUARDED_BY(mu_);
+  // Only changed with `mu_` held exclusively, so that the lookups holding it
+  // shared see the generation of the resources they find.
+  std::atomic<uint64> generation_;
+
+  // Changes generation_ after resources have been removed.
+  void BumpGeneration() TF_EXCLUSIVE_LOCKS_REQUIRED(mu_);
 
   template <typename T, bool use_dynamic_cast = false>
   Status LookupInternal(const std::string& container, const std::string& name,
@@ -428,6 +449,33 @@ Status LookupOrCreateResource(OpKernelContext* ctx, const ResourceHandle& p,
 template <typename T>
 Status DeleteResource(OpKernelContext* ctx, const ResourceHandle& p);
 
+// Caches the resource that a kernel looks up on every execution, e.g. the
+// variable of a ReadVariableOp, so that the later lookups of the same handle
+// neither take the lock of the ResourceMgr nor hash the handle. The resource is
+// looked up again once any resource has been removed from the ResourceMgr,
+// until then the cache keeps a ref on it.
+//
+// The resources of ref-counting handles, and those not owned by the
+// ResourceMgr, are not cached.
+//
+// This class is thread-safe.
+template <typename T>
+class ResourceLookupCache {
+ public:
+  // Same as LookupResource(ctx, p, value).
+  Status Lookup(OpKernelContext* ctx, const ResourceHandle& p,
+                core::RefCountPtr<T>* value);
+
+ private:
+  mutex mu_;
+  const ResourceMgr* resource_mgr_ TF_GUARDED_BY(mu_) = nullptr;
+  uint64 generation_ TF_GUARDED_BY(mu_) = 0;
+  uint64 hash_code_ TF_GUARDED_BY(mu_) = 0;
+  std::string container_ TF_GUARDED_BY(mu_);
+  std::string name_ TF_GUARDED_BY(mu_);
+  core::RefCountPtr<T> resource_ TF_GUARDED_BY(mu_);
+};
+
 // Same as above, but uses the hash code of the type directly.
 // The type name information will be missing in the debug output when the
 // resource is not present in the container.
@@ -827,6 +875,47 @@ Status LookupResource(OpKernelContext* ctx, const ResourceHandle& p,
   return OkStatus();
 }
 
+template <typename T>
+Status ResourceLookupCache<T>::Lookup(OpKernelContext* ctx,
+                                      const ResourceHandle& p,
+                                      core::RefCountPtr<T>* value) {
+  if (p.IsRefCounting()) return LookupResource(ctx, p, value);
+  TF_RETURN_IF_ERROR(internal::ValidateDeviceAndType<T>(ctx, p));
+  ResourceMgr* rm = ctx->resource_manager();
+  {
+    tf_shared_lock l(mu_);
+    if (resource_ != nullptr && resource_mgr_ == rm &&
+        generation_ == rm->generation() && hash_code_ == p.hash_code() &&
+        name_ == p.name() && container_ == p.container()) {
+      resource_->Ref();
+      value->reset(resource_.get());
+      return OkStatus();
+    }
+  }
+  ResourceBase* found = nullptr;
+  uint64 generation;
+  bool owned;
+  TF_RETURN_IF_ERROR(
+      rm->LookupWithGeneration(p, &found, &generation, &owned));
+  // It's safe to down cast 'found' to T* since ValidateDeviceAndType checked
+  // the type of the handle, which is part of the key of the resource.
+  value->reset(static_cast<T*>(found));
+  if (!owned) return OkStatus();
+
+  // Released after the lock, since its destructor may run.
+  core::RefCountPtr<T> stale;
+  mutex_lock l(mu_);
+  stale = std::move(resource_);
+  (*value)->Ref();
+  resource_.reset(value->get());
+  resource_mgr_ = rm;
+  generation_ = generation;
+  hash_code_ = p.hash_code();
+  container_ = p.container();
+  name_ = p.name();
+  return OkStatus();
+}
+
 // Similar to Lookup, but looks up multiple resources at once, with only a
 // single lock acquisition.
 template <typename T>
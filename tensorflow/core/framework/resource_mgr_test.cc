@@ -527,4 +527,98 @@ TEST(ResourceHandleTest, DeleteUsingResourceHandle) {
   EXPECT_NE(LookupResource<StubResource>(&ctx, p, &lookup_r).ok(), true);
 }
 
+TEST(ResourceLookupCacheTest, LooksUpAgainAfterDelete) {
+  ResourceMgr resource_mgr("");
+  OpKernelContext::Params params;
+  params.resource_manager = &resource_mgr;
+  StubDevice device("device_name");
+  params.device = &device;
+  OpKernelContext ctx(&params, 0);
+
+  ResourceHandle p =
+      MakeResourceHandle<StubResource>(&ctx, "container", "name");
+  StubResource* r = new StubResource;
+  TF_EXPECT_OK(CreateResource(&ctx, p, r));
+
+  ResourceLookupCache<StubResource> cache;
+  const uint64 generation = resource_mgr.generation();
+  for (int i = 0; i < 2; ++i) {
+    core::RefCountPtr<StubResource> lookup_r;
+    TF_EXPECT_OK(cache.Lookup(&ctx, p, &lookup_r));
+    EXPECT_EQ(lookup_r.get(), r);
+  }
+  // The cache and the manager hold a ref each.
+  EXPECT_EQ(r->RefCount(), 2);
+
+  // Creating another resource doesn't invalidate the cached ones.
+  ResourceHandle other =
+      MakeResourceHandle<StubResource>(&ctx, "container", "other");
+  TF_EXPECT_OK(CreateResource(&ctx, other, new StubResource));
+  EXPECT_EQ(resource_mgr.generation(), generation);
+
+  TF_EXPECT_OK(DeleteResource(&ctx, p));
+  EXPECT_NE(resource_mgr.generation(), generation);
+  core::RefCountPtr<StubResource> lookup_r;
+  EXPECT_TRUE(absl::IsNotFound(cache.Lookup(&ctx, p, &lookup_r)));
+
+  StubResource* new_r = new StubResource;
+  TF_EXPECT_OK(CreateResource(&ctx, p, new_r));
+  TF_EXPECT_OK(cache.Lookup(&ctx, p, &lookup_r));
+  EXPECT_EQ(lookup_r.get(), new_r);
+}
+
+TEST(ResourceLookupCacheTest, DifferentHandles) {
+  ResourceMgr resource_mgr("");
+  OpKernelContext::Params params;
+  params.resource_manager = &resource_mgr;
+  StubDevice device("device_name");
+  params.device = &device;
+  OpKernelContext ctx(&params, 0);
+
+  ResourceHandle p1 = MakeResourceHandle<StubResource>(&ctx, "container", "a");
+  ResourceHandle p2 = MakeResourceHandle<StubResource>(&ctx, "container", "b");
+  StubResource* r1 = new StubResource;
+  StubResource* r2 = new StubResource;
+  TF_EXPECT_OK(CreateResource(&ctx, p1, r1));
+  TF_EXPECT_OK(CreateResource(&ctx, p2, r2));
+
+  ResourceLookupCache<StubResource> cache;
+  core::RefCountPtr<StubResource> lookup_r;
+  TF_EXPECT_OK(cache.Lookup(&ctx, p1, &lookup_r));
+  EXPECT_EQ(lookup_r.get(), r1);
+  TF_EXPECT_OK(cache.Lookup(&ctx, p2, &lookup_r));
+  EXPECT_EQ(lookup_r.get(), r2);
+  TF_EXPECT_OK(cache.Lookup(&ctx, p1, &lookup_r));
+  EXPECT_EQ(lookup_r.get(), r1);
+
+  // The type of the handle is still checked.
+  ResourceHandle other_type =
+      MakeResourceHandle<OtherStubResource>(&ctx, "container", "a");
+  ResourceLookupCache<OtherStubResource> other_cache;
+  core::RefCountPtr<OtherStubResource> other_r;
+  EXPECT_FALSE(other_cache.Lookup(&ctx, other_type, &other_r).ok());
+}
+
+TEST(ResourceLookupCacheTest, DoesNotCacheUnownedResources) {
+  ResourceMgr resource_mgr("");
+  OpKernelContext::Params params;
+  params.resource_manager = &resource_mgr;
+  StubDevice device("device_name");
+  params.device = &device;
+  OpKernelContext ctx(&params, 0);
+
+  ResourceHandle p =
+      MakeResourceHandle<StubResource>(&ctx, "container", "name");
+  core::RefCountPtr<StubResource> r(new StubResource);
+  TF_EXPECT_OK(resource_mgr.CreateUnowned("container", "name", r.get()));
+
+  ResourceLookupCache<StubResource> cache;
+  {
+    core::RefCountPtr<StubResource> lookup_r;
+    TF_EXPECT_OK(cache.Lookup(&ctx, p, &lookup_r));
+    EXPECT_EQ(lookup_r.get(), r.get());
+  }
+  EXPECT_EQ(r->RefCount(), 1);
+}
+
 }  // end namespace tensorflow
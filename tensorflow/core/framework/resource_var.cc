@@ -15,6 +15,8 @@ limitations under the License.
 
 #include "tensorflow/core/framework/resource_var.h"
 
+#include <algorithm>
+
 #include "tensorflow/core/framework/resource_handle.h"
 #include "tensorflow/core/graph/graph_def_builder.h"
 
@@ -45,4 +47,70 @@ std::string Var::MakeRefCountingHandleName(int64_t resource_id) const {
   std::string handle_name = absl::StrFormat("%s%d", debug_name_, resource_id);
   return handle_name;
 }
+
+namespace {
+std::atomic<bool> any_tracking_dirty_rows{false};
+}  // namespace
+
+void Var::StartTrackingDirtyRows() {
+  mutex_lock l(dirty_rows_mu_);
+  all_rows_dirty_ = false;
+  dirty_rows_.clear();
+  tracking_dirty_rows_.store(true, std::memory_order_relaxed);
+  any_tracking_dirty_rows.store(true, std::memory_order_relaxed);
+}
+
+bool Var::AnyTrackingDirtyRows() {
+  return any_tracking_dirty_rows.load(std::memory_order_relaxed);
+}
+
+template <typename Index>
+void Var::MarkRowsDirtyImpl(absl::Span<const Index> rows) {
+  if (!is_tracking_dirty_rows()) return;
+  mutex_lock l(dirty_rows_mu_);
+  if (all_rows_dirty_) return;
+  dirty_rows_.insert(rows.begin(), rows.end());
+}
+
+void Var::MarkRowsDirty(absl::Span<const int32> rows) {
+  MarkRowsDirtyImpl(rows);
+}
+
+void Var::MarkRowsDirty(absl::Span<const int64_t> rows) {
+  MarkRowsDirtyImpl(rows);
+}
+
+void Var::MarkAllRowsDirty() {
+  if (!is_tracking_dirty_rows()) return;
+  mutex_lock l(dirty_rows_mu_);
+  all_rows_dirty_ = true;
+  dirty_rows_.clear();
+}
+
+bool Var::TakeDirtyRows(int64_t num_rows,
+                        std::vector<std::pair<int64_t, int64_t>>* ranges) {
+  ranges->clear();
+  std::vector<int64_t> rows;
+  {
+    mutex_lock l(dirty_rows_mu_);
+    if (all_rows_dirty_) {
+      all_rows_dirty_ = false;
+      return true;
+    }
+    rows.assign(dirty_rows_.begin(), dirty_rows_.end());
+    dirty_rows_.clear();
+  }
+  std::sort(rows.begin(), rows.end());
+  for (int64_t row : rows) {
+    // Invalid indices were rejected by the updates that recorded them.
+    if (row < 0 || row >= num_rows) continue;
+    if (!ranges->empty() && ranges->back().second == row) {
+      ++ranges->back().second;
+    } else {
+      ranges->emplace_back(row, row + 1);
+    }
+  }
+  return false;
+}
+
 }  //  end namespace tensorflow
@@ -16,7 +16,14 @@ limitations under the License.
 #ifndef TENSORFLOW_CORE_FRAMEWORK_RESOURCE_VAR_H_
 #define TENSORFLOW_CORE_FRAMEWORK_RESOURCE_VAR_H_
 
+#include <atomic>
+#include <cstdint>
 #include <string>
+#include <utility>
+#include <vector>
+
+#include "absl/container/flat_hash_set.h"
+#include "absl/types/span.h"
 
 #include "tensorflow/core/framework/resource_base.h"
 #include "tensorflow/core/framework/tensor.h"
@@ -110,9 +117,43 @@ class Var : public ResourceBase {
   // so desired.
   std::atomic<bool> copy_on_read_mode{false};
 
+  // Tracking of the rows, i.e. the slices along the first dimension, that are
+  // updated, so that incremental checkpoints can write only those rows.
+  // Sparse updates record their rows with MarkRowsDirty() and all other
+  // updates mark the whole variable with MarkAllRowsDirty().  Nothing is
+  // recorded until StartTrackingDirtyRows() is called.
+  //
+  // These methods have their own synchronization, and may be called with a
+  // shared lock on mu() by sparse updates.
+  void StartTrackingDirtyRows();
+  bool is_tracking_dirty_rows() const {
+    return tracking_dirty_rows_.load(std::memory_order_relaxed);
+  }
+  void MarkRowsDirty(absl::Span<const int32> rows);
+  void MarkRowsDirty(absl::Span<const int64_t> rows);
+  void MarkAllRowsDirty();
+
+  // Returns true if all rows were marked dirty.  Otherwise sets "*ranges" to
+  // the sorted, disjoint [start, end) ranges of the dirty rows in
+  // [0, num_rows).  Either way the dirty rows are cleared.
+  bool TakeDirtyRows(int64_t num_rows,
+                     std::vector<std::pair<int64_t, int64_t>>* ranges);
+
+  // Whether any variable of the process tracks its dirty rows.  Lets sparse
+  // kernels skip looking up their variables when none does.
+  static bool AnyTrackingDirtyRows();
+
  private:
+  template <typename Index>
+  void MarkRowsDirtyImpl(absl::Span<const Index> rows);
+
   mutex mu_;
   Tensor tensor_;
+
+  std::atomic<bool> tracking_dirty_rows_{false};
+  mutex dirty_rows_mu_;
+  bool all_rows_dirty_ TF_GUARDED_BY(dirty_rows_mu_) = false;
+  absl::flat_hash_set<int64_t> dirty_rows_ TF_GUARDED_BY(dirty_rows_mu_);
   std::string debug_name_;
 
   ~Var() override {}
@@ -15,6 +15,10 @@ limitations under the License.
 
 #include "tensorflow/core/framework/resource_var.h"
 
+#include <cstdint>
+#include <utility>
+#include <vector>
+
 #include "tensorflow/core/platform/logging.h"
 #include "tensorflow/core/platform/test.h"
 
@@ -34,5 +38,34 @@ TEST(ResourceVarTest, Uninitialize) {
   EXPECT_FALSE(var->is_initialized);
   EXPECT_TRUE(var->tensor()->data() == nullptr);
 }
+
+TEST(ResourceVarTest, DirtyRows) {
+  RefCountPtr<Var> var{new Var(DT_FLOAT)};
+  using Ranges = std::vector<std::pair<int64_t, int64_t>>;
+  Ranges ranges;
+
+  // Nothing is recorded before tracking starts.
+  var->MarkRowsDirty(std::vector<int64_t>{1});
+  EXPECT_FALSE(var->is_tracking_dirty_rows());
+  var->StartTrackingDirtyRows();
+  EXPECT_TRUE(Var::AnyTrackingDirtyRows());
+  EXPECT_FALSE(var->TakeDirtyRows(10, &ranges));
+  EXPECT_TRUE(ranges.empty());
+
+  var->MarkRowsDirty(std::vector<int32>{7, 2, 3, 2, 12});
+  var->MarkRowsDirty(std::vector<int64_t>{4, 9});
+  EXPECT_FALSE(var->TakeDirtyRows(10, &ranges));
+  EXPECT_EQ(ranges, (Ranges{{2, 5}, {7, 8}, {9, 10}}));
+  // Taking the rows clears them.
+  EXPECT_FALSE(var->TakeDirtyRows(10, &ranges));
+  EXPECT_TRUE(ranges.empty());
+
+  var->MarkRowsDirty(std::vector<int64_t>{1});
+  var->MarkAllRowsDirty();
+  var->MarkRowsDirty(std::vector<int64_t>{2});
+  EXPECT_TRUE(var->TakeDirtyRows(10, &ranges));
+  EXPECT_FALSE(var->TakeDirtyRows(10, &ranges));
+  EXPECT_TRUE(ranges.empty());
+}
 }  // namespace core
 }  // namespace tensorflow
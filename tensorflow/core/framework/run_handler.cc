@@ -43,6 +43,17 @@ static constexpr int32_t kMaxConcurrentHandlers = 128;
 typedef typename internal::RunHandlerEnvironment::Task Task;
 typedef Eigen::RunQueue<Task, 1024> Queue;
 
+// Returns the number of NUMA nodes to spread the pool's threads across, or 0
+// if the threads should not be pinned.
+int NumNumaNodesFromEnv() {
+  if (!ParamFromEnvBoolWithDefault("TF_RUN_HANDLER_USE_NUMA_AFFINITY", false) ||
+      !port::NUMAEnabled()) {
+    return 0;
+  }
+  const int num_numa_nodes = port::NUMANumNodes();
+  return num_numa_nodes > 1 ? num_numa_nodes : 0;
+}
+
 }  // namespace
 
 namespace internal {
@@ -51,14 +62,17 @@ RunHandlerEnvironment::RunHandlerEnvironment(
     : env_(env), thread_options_(thread_options), name_(name) {}
 
 RunHandlerEnvironment::EnvThread* RunHandlerEnvironment::CreateThread(
-    std::function<void()> f, const std::string& thread_name) {
+    std::function<void()> f, const std::string& thread_name, int numa_node) {
+  if (numa_node == port::kNUMANoAffinity) {
+    numa_node = thread_options_.numa_node;
+  }
   return env_->StartThread(thread_options_, thread_name, [=]() {
     // Set the processor flag to flush denormals to zero.
     port::ScopedFlushDenormal flush;
     // Set the processor rounding mode to ROUND TO NEAREST.
     port::ScopedSetRound round(FE_TONEAREST);
-    if (thread_options_.numa_node != port::kNUMANoAffinity) {
-      port::NUMASetThreadNodeAffinity(thread_options_.numa_node);
+    if (numa_node != port::kNUMANoAffinity) {
+      port::NUMASetThreadNodeAffinity(numa_node);
     }
     f();
   });
@@ -333,11 +347,15 @@ RunHandlerThreadPool::RunHandlerThreadPool(
           std::vector<double>({0, 0.4}))),
       sub_thread_pool_end_request_percentage_(ParamFromEnvWithDefault(
           "TF_RUN_HANDLER_SUB_THREAD_POOL_END_REQUEST_PERCENTAGE",
-          std::vector<double>({0.4, 1}))) {
+          std::vector<double>({0.4, 1}))),
+      num_numa_nodes_(NumNumaNodesFromEnv()),
+      max_steal_attempts_(static_cast<int>(
+          ParamFromEnvWithDefault("TF_RUN_HANDLER_MAX_STEAL_ATTEMPTS", 0))) {
   thread_data_.resize(num_threads_);
   VLOG(1) << "Creating RunHandlerThreadPool " << name << " with  "
           << num_blocking_threads_ << " blocking threads and "
-          << num_non_blocking_threads_ << " non-blocking threads.";
+          << num_non_blocking_threads_ << " non-blocking threads across "
+          << num_numa_nodes_ << " NUMA nodes.";
 }
 
 RunHandlerThreadPool::~RunHandlerThreadPool() {
@@ -366,6 +384,13 @@ void RunHandlerThreadPool::Start() {
     }
     thread_data_[i].sub_thread_pool_id = sub_thread_pool_id;
     const bool is_blocking_thread = (i < num_blocking_threads) ? true : false;
+    // Spread the blocking and the non-blocking threads evenly across the NUMA
+    // nodes.
+    if (num_numa_nodes_ > 0) {
+      thread_data_[i].numa_node =
+          (is_blocking_thread ? i : i - num_blocking_threads) %
+          num_numa_nodes_;
+    }
     // The blocking threads will handle both inter and intra op workload;
     // non-blocking thread will handle intra op workload only; and the
     // sub thread pool is only provided for blocking threads.
@@ -376,7 +401,8 @@ void RunHandlerThreadPool::Start() {
         },
         is_blocking_thread
             ? strings::StrCat(name_, "_blocking_thread_", sub_thread_pool_id)
-            : strings::StrCat(name_, "_non_blocking_thread")));
+            : strings::StrCat(name_, "_non_blocking_thread"),
+        thread_data_[i].numa_node));
   }
 }
 
@@ -433,15 +459,25 @@ void RunHandlerThreadPool::SetThreadWorkSources(
     // 4... for the other half of the threads.
     static const int num_shards =
         ParamFromEnvWithDefault("TF_RUN_HANDLER_QUEUE_SHARDS", 1);
-    int token = tid % num_shards;
-    for (int i = 0; i < num_shards; ++i) {
-      for (int j = token; j < thread_work_sources.size(); j += num_shards) {
-        if (j != start_request_idx) {
+    // If the thread is pinned to a NUMA node, add the requests homed on that
+    // node in the first pass, and the remaining requests in the second pass.
+    const int numa_node = thread_data_[tid].numa_node;
+    const int num_passes = numa_node == port::kNUMANoAffinity ? 1 : 2;
+    for (int pass = 0; pass < num_passes; ++pass) {
+      int token = tid % num_shards;
+      for (int i = 0; i < num_shards; ++i) {
+        for (int j = token; j < thread_work_sources.size(); j += num_shards) {
+          if (j == start_request_idx) continue;
+          if (num_passes > 1 &&
+              (thread_work_sources[j]->numa_node() == numa_node) !=
+                  (pass == 0)) {
+            continue;
+          }
           thread_data_[tid].new_thread_work_sources->emplace_back(
               thread_work_sources[j]);
         }
+        token = (token + 1) % num_shards;
       }
-      token = (token + 1) % num_shards;
     }
     thread_data_[tid].sources_not_empty.notify_all();
   }
@@ -472,6 +508,12 @@ int RunHandlerThreadPool::NumNonBlockingThreads() const {
   return num_non_blocking_threads_;
 }
 
+int RunHandlerThreadPool::NumNumaNodes() const { return num_numa_nodes_; }
+
+int RunHandlerThreadPool::ThreadNumaNode(int tid) const {
+  return thread_data_[tid].numa_node;
+}
+
 RunHandlerThreadPool::ThreadData::ThreadData()
     : new_version(0),
       current_index(0),
@@ -483,7 +525,9 @@ RunHandlerThreadPool::ThreadData::ThreadData()
       current_thread_work_sources(
           new Eigen::MaxSizeVector<ThreadWorkSource*>(static_cast<int32>(
               ParamFromEnvWithDefault("TF_RUN_HANDLER_MAX_CONCURRENT_HANDLERS",
-                                      kMaxConcurrentHandlers)))) {}
+                                      kMaxConcurrentHandlers)))),
+      numa_node(port::kNUMANoAffinity),
+      steal_index(0) {}
 
 Task RunHandlerThreadPool::FindTask(
     int searching_range_start, int searching_range_end, int thread_id,
@@ -523,6 +567,40 @@ Task RunHandlerThreadPool::FindTask(
   return t;
 }
 
+Task RunHandlerThreadPool::StealTask(
+    int thread_id,
+    const Eigen::MaxSizeVector<ThreadWorkSource*>& thread_work_sources,
+    ThreadWorkSource** tws) {
+  const int num_victims = thread_work_sources.size() - 1;
+  if (max_steal_attempts_ <= 0 || num_victims <= 0) return Task();
+
+  ThreadData& data = thread_data_[thread_id];
+  const int numa_node = data.numa_node;
+  int attempts = 0;
+  // Try the requests on the local NUMA node first, so that work only moves
+  // across nodes when the local node has none left. The starting point
+  // rotates to spread contention over the victims' queues.
+  for (int pass = 0; pass < 2 && attempts < max_steal_attempts_; ++pass) {
+    for (int k = 0; k < num_victims && attempts < max_steal_attempts_; ++k) {
+      // Index 0 is the primary request, which has already been searched.
+      const int idx = 1 + (data.steal_index + k) % num_victims;
+      ThreadWorkSource* victim = thread_work_sources[idx];
+      const bool is_local = numa_node == port::kNUMANoAffinity ||
+                            victim->numa_node() == numa_node;
+      if (is_local != (pass == 0)) continue;
+      ++attempts;
+      Task t = victim->PopNonBlockingTask(thread_id, true);
+      if (t.f) {
+        data.steal_index = idx - 1;
+        *tws = victim;
+        return t;
+      }
+    }
+  }
+  data.steal_index = (data.steal_index + 1) % num_victims;
+  return Task();
+}
+
 // Main worker thread loop.
 void RunHandlerThreadPool::WorkerLoop(int thread_id,
                                       bool may_steal_blocking_work) {
@@ -620,6 +698,14 @@ void RunHandlerThreadPool::WorkerLoop(int thread_id,
           }
         }
       }
+      if (!t.f) {
+        // The scan above only searches one queue shard of each non-primary
+        // request, so steal from the other shards before going to sleep.
+        t = StealTask(thread_id, *thread_work_sources, &tws);
+        if (t.f) {
+          task_from_blocking_queue = false;
+        }
+      }
     }
     if (t.f) {
       tsl::profiler::TraceMe activity(
@@ -806,6 +892,13 @@ class RunHandlerPool::Impl {
       queue_waiter.next = &queue_waiter;
       queue_waiter.prev = &queue_waiter;
     }
+    // Home the handlers round-robin on the NUMA nodes of the pool's threads.
+    const int num_numa_nodes = run_handler_thread_pool_->NumNumaNodes();
+    if (num_numa_nodes > 0) {
+      for (int i = 0; i < max_handlers_; ++i) {
+        handlers_[i]->tws()->set_numa_node(i % num_numa_nodes);
+      }
+    }
     run_handler_thread_pool_->Start();
   }
 
@@ -867,6 +960,7 @@ class RunHandlerPool::Impl {
       }
       // Remove the last entry from free_handlers_ and add to the end of
       // sorted_active_handlers_.
+      MovePreferredFreeHandlerToBack();
       handler_impl = free_handlers_.back();
       handler_impl->Reset(step_id, options);
       free_handlers_.pop_back();
@@ -942,6 +1036,10 @@ class RunHandlerPool::Impl {
 
   void LogInfo() TF_EXCLUSIVE_LOCKS_REQUIRED(mu_);
 
+  // If the calling thread is pinned to a NUMA node, moves a free handler homed
+  // on that node (if any) to the back of `free_handlers_`.
+  void MovePreferredFreeHandlerToBack() TF_EXCLUSIVE_LOCKS_REQUIRED(mu_);
+
   // Maximum number of handlers pre-created during pool construction time. The
   // number has been chosen expecting each handler might at least want 1
   // inter-op thread for execution (during compute intensive workloads like
@@ -1015,6 +1113,18 @@ void RunHandlerPool::Impl::RecomputePoolStats(
   }
 }
 
+void RunHandlerPool::Impl::MovePreferredFreeHandlerToBack() {
+  if (run_handler_thread_pool_->NumNumaNodes() == 0) return;
+  const int numa_node = port::NUMAGetThreadNodeAffinity();
+  if (numa_node == port::kNUMANoAffinity) return;
+  for (auto it = free_handlers_.rbegin(); it != free_handlers_.rend(); ++it) {
+    if ((*it)->tws()->numa_node() == numa_node) {
+      std::swap(*it, free_handlers_.back());
+      return;
+    }
+  }
+}
+
 void RunHandlerPool::Impl::LogInfo() {
   if (iterations_++ % 50000 == 10 && VLOG_IS_ON(1)) {
     int num_active_requests = sorted_active_handlers_.size();
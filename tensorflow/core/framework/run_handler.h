@@ -20,6 +20,7 @@ limitations under the License.
 #include "tensorflow/core/lib/histogram/histogram.h"
 #include "tensorflow/core/platform/context.h"
 #include "tensorflow/core/platform/mutex.h"
+#include "tensorflow/core/platform/numa.h"
 #include "tensorflow/core/platform/thread_annotations.h"
 #include "tensorflow/core/protobuf/config.pb.h"
 
@@ -129,8 +130,12 @@ class RunHandlerEnvironment {
   RunHandlerEnvironment(Env* env, const ThreadOptions& thread_options,
                         const string& name);
 
+  // Starts a thread running `f`. If `numa_node` is not
+  // `port::kNUMANoAffinity`, it overrides the NUMA node of the
+  // `ThreadOptions`.
   EnvThread* CreateThread(std::function<void()> f,
-                          const std::string& thread_name);
+                          const std::string& thread_name,
+                          int numa_node = port::kNUMANoAffinity);
 
   Task CreateTask(std::function<void()> f);
 
@@ -184,6 +189,12 @@ class ThreadWorkSource {
 
   unsigned NonBlockingWorkShardingFactor();
 
+  // The NUMA node that the owner of this work source is homed on, or
+  // `port::kNUMANoAffinity`. Threads pinned to the same node prefer this work
+  // source over others.
+  int numa_node() const { return numa_node_; }
+  void set_numa_node(int numa_node) { numa_node_ = numa_node; }
+
   std::string ToString();
 
  private:
@@ -205,6 +216,7 @@ class ThreadWorkSource {
   mutex waiters_mu_;
   Waiter queue_waiters_ TF_GUARDED_BY(waiters_mu_);
   std::atomic<int64_t> traceme_id_;
+  int numa_node_ = port::kNUMANoAffinity;
 
   mutex run_handler_waiter_mu_;
   uint64 version_ TF_GUARDED_BY(run_handler_waiter_mu_);
@@ -238,10 +250,21 @@ class RunHandlerThreadPool {
   // Set work queues from which the thread 'tid' can steal its work.
   // The request with start_request_idx will be attempted first. Other requests
   // will be attempted in FIFO order based on their arrival time.
+  //
+  // If NUMA affinity is enabled, the requests homed on the NUMA node of thread
+  // 'tid' are attempted before the requests homed on other nodes.
   void SetThreadWorkSources(
       int tid, int start_request_idx, uint64 version,
       const Eigen::MaxSizeVector<ThreadWorkSource*>& thread_work_sources);
 
+  // Returns the number of NUMA nodes that threads are spread across, or 0 if
+  // NUMA affinity is disabled.
+  int NumNumaNodes() const;
+
+  // Returns the NUMA node that thread 'tid' is pinned to, or
+  // `port::kNUMANoAffinity`.
+  int ThreadNumaNode(int tid) const;
+
   PerThread* GetPerThread();
 
   int CurrentThreadId() const;
@@ -264,6 +287,14 @@ class RunHandlerThreadPool {
       const Eigen::MaxSizeVector<ThreadWorkSource*>& thread_work_sources,
       bool* task_from_blocking_queue, ThreadWorkSource** tws);
 
+  // Tries to steal a non-blocking task, searching every queue shard of at
+  // most `max_steal_attempts_` requests other than the primary one. Requests
+  // homed on the NUMA node of thread 'thread_id' are tried first.
+  Task StealTask(
+      int thread_id,
+      const Eigen::MaxSizeVector<ThreadWorkSource*>& thread_work_sources,
+      ThreadWorkSource** tws);
+
   void WaitForWork(bool is_blocking, int thread_id,
                    int32_t max_blocking_inflight);
 
@@ -286,6 +317,12 @@ class RunHandlerThreadPool {
         current_thread_work_sources;
 
     int sub_thread_pool_id;
+
+    // The NUMA node that the thread is pinned to, or `port::kNUMANoAffinity`.
+    int numa_node;
+    // The index of the next request to steal from. Should only be accessed by
+    // one thread.
+    int steal_index;
   };
 
   const int num_threads_;
@@ -306,6 +343,13 @@ class RunHandlerThreadPool {
   // fashion.
   std::vector<double> sub_thread_pool_start_request_percentage_;
   std::vector<double> sub_thread_pool_end_request_percentage_;
+
+  // If positive, threads are pinned round-robin to this many NUMA nodes.
+  const int num_numa_nodes_;
+
+  // The maximum number of requests that an idle thread tries to steal
+  // non-blocking work from after the regular scan finds none.
+  const int max_steal_attempts_;
 };
 
 }  // namespace internal
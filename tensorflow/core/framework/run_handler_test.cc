@@ -18,6 +18,8 @@ limitations under the License.
 #include "tensorflow/core/framework/run_handler.h"
 
 #include <memory>
+#include <optional>
+#include <string>
 #include <vector>
 
 #define EIGEN_USE_THREADS
@@ -426,6 +428,83 @@ TEST(RunHandlerThreadPool, FindTask) {
   }
 }
 
+// Sets an environment variable for the lifetime of the object, and restores
+// its previous value, or unsets it, on destruction.
+class ScopedEnvVar {
+ public:
+  ScopedEnvVar(const char* name, const char* value) : name_(name) {
+    if (const char* old_value = getenv(name)) {
+      old_value_ = old_value;
+    }
+    setenv(name, value, /*overwrite=*/true);
+  }
+
+  ~ScopedEnvVar() {
+    if (old_value_.has_value()) {
+      setenv(name_.c_str(), old_value_->c_str(), /*overwrite=*/true);
+    } else {
+      unsetenv(name_.c_str());
+    }
+  }
+
+ private:
+  std::string name_;
+  std::optional<std::string> old_value_;
+};
+
+TEST(RunHandlerThreadPool, StealTask) {
+  ScopedEnvVar max_steal_attempts("TF_RUN_HANDLER_MAX_STEAL_ATTEMPTS", "1");
+  Eigen::MaxSizeVector<mutex> waiters_mu(2);
+  waiters_mu.resize(2);
+  Eigen::MaxSizeVector<internal::Waiter> waiters(2);
+  waiters.resize(2);
+  internal::RunHandlerThreadPool run_handler_thread_pool(
+      /*num_blocking_threads=*/1, /*num_non_blocking_threads=*/0,
+      Env::Default(), ThreadOptions(), "tf_run_handler_pool", &waiters_mu,
+      &waiters);
+  // NUMA affinity is disabled by default.
+  EXPECT_EQ(run_handler_thread_pool.NumNumaNodes(), 0);
+  EXPECT_EQ(run_handler_thread_pool.ThreadNumaNode(0), port::kNUMANoAffinity);
+
+  Eigen::MaxSizeVector<internal::ThreadWorkSource*> thread_work_sources(3);
+  thread_work_sources.resize(3);
+  internal::ThreadWorkSource tws[3];
+  for (int i = 0; i < 3; ++i) {
+    thread_work_sources[i] = &tws[i];
+  }
+
+  int result = 0;
+  run_handler_thread_pool.AddWorkToQueue(&tws[2], /*is_blocking=*/false,
+                                         [&result] { result = 1; });
+  internal::ThreadWorkSource* victim = nullptr;
+
+  // Only one request is searched per attempt, and the first attempt searches
+  // the request after the primary one.
+  internal::Task t = run_handler_thread_pool.StealTask(
+      /*thread_id=*/0, thread_work_sources, &victim);
+  EXPECT_EQ(t.f, nullptr);
+
+  // The next attempt moves on to the request that has work.
+  t = run_handler_thread_pool.StealTask(/*thread_id=*/0, thread_work_sources,
+                                        &victim);
+  ASSERT_NE(t.f, nullptr);
+  EXPECT_EQ(victim, &tws[2]);
+  t.f->f();
+  EXPECT_EQ(result, 1);
+  EXPECT_EQ(tws[2].TaskQueueSize(/*is_blocking=*/false), 0);
+
+  // Work in the primary request is never stolen.
+  run_handler_thread_pool.AddWorkToQueue(&tws[0], /*is_blocking=*/false,
+                                         [&result] { result = 2; });
+  for (int i = 0; i < 2; ++i) {
+    t = run_handler_thread_pool.StealTask(/*thread_id=*/0, thread_work_sources,
+                                          &victim);
+    EXPECT_EQ(t.f, nullptr);
+  }
+  tws[0].PopNonBlockingTask(0, true).f->f();
+  EXPECT_EQ(result, 2);
+}
+
 TEST(RunHandlerThreadPool, RoundRobinExecution) {
   // Set up environment for 1 sub thread pool.
   setenv("TF_RUN_HANDLER_USE_SUB_THREAD_POOL", "true", true);
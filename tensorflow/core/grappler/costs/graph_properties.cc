@@ -15,7 +15,12 @@ limitations under the License.
 
 #include "tensorflow/core/grappler/costs/graph_properties.h"
 
+#include <list>
+#include <memory>
+#include <unordered_set>
+
 #include "absl/hash/hash.h"
+#include "absl/strings/str_cat.h"
 #include "absl/types/optional.h"
 #include "tensorflow/core/common_runtime/function.h"
 #include "tensorflow/core/common_runtime/graph_constructor.h"
@@ -37,7 +42,11 @@ limitations under the License.
 #include "tensorflow/core/grappler/utils/topological_sort.h"
 #include "tensorflow/core/lib/gtl/cleanup.h"
 #include "tensorflow/core/lib/gtl/flatset.h"
+#include "tensorflow/core/lib/strings/proto_serialization.h"
 #include "tensorflow/core/lib/strings/str_util.h"
+#include "tensorflow/core/platform/fingerprint.h"
+#include "tensorflow/core/platform/mutex.h"
+#include "tensorflow/core/util/env_var.h"
 
 namespace tensorflow {
 namespace grappler {
@@ -491,6 +500,103 @@ uint64 NumElementsFromTensorProto(const TensorProto& tensor_proto) {
   return num_elements;
 }
 
+// The properties inferred statically for a graph, shared by all the
+// GraphProperties that infer them for the same graph with the same options.
+struct InferredProperties {
+  absl::flat_hash_map<string, std::vector<OpInfo::TensorProperties>>
+      input_properties;
+  absl::flat_hash_map<string, std::vector<OpInfo::TensorProperties>>
+      output_properties;
+  std::unordered_set<string> incompatible_shape_nodes;
+};
+
+// A process-wide LRU cache of the results of static shape inference. Many
+// optimizers of a meta optimizer pass infer the properties of a graph that the
+// previous optimizers left unchanged, and all of them but the first get the
+// properties from the cache. Its capacity is read from the
+// TF_GRAPPLER_SHAPE_INFERENCE_CACHE_CAPACITY environment variable, and a
+// non-positive capacity disables it.
+class InferredPropertiesCache {
+ public:
+  static InferredPropertiesCache* Global() {
+    static InferredPropertiesCache* cache = [] {
+      int64_t capacity;
+      Status status =
+          ReadInt64FromEnvVar("TF_GRAPPLER_SHAPE_INFERENCE_CACHE_CAPACITY",
+                              /*default_val=*/16, &capacity);
+      if (!status.ok()) {
+        LOG(WARNING) << "Invalid shape inference cache capacity: " << status;
+        capacity = 0;
+      }
+      return capacity > 0 ? new InferredPropertiesCache(capacity) : nullptr;
+    }();
+    return cache;
+  }
+
+  // Returns the key of the properties inferred for `item` with the given
+  // options. The properties only depend on the graph, which includes its
+  // function library, and on the names of the fed tensors.
+  static string Key(const GrapplerItem& item, bool assume_valid_feeds,
+                    bool aggressive_shape_inference,
+                    bool include_input_tensor_values,
+                    bool include_output_tensor_values) {
+    string serialized;
+    SerializeToStringDeterministic(item.graph, &serialized);
+    Fprint128 fingerprint = Fingerprint128(serialized);
+    fingerprint = FingerprintCat128(
+        fingerprint,
+        Fingerprint128(absl::StrCat(assume_valid_feeds, ":",
+                                    aggressive_shape_inference, ":",
+                                    include_input_tensor_values, ":",
+                                    include_output_tensor_values)));
+    if (!assume_valid_feeds) {
+      for (const auto& feed : item.feed) {
+        fingerprint =
+            FingerprintCat128(fingerprint, Fingerprint128(feed.first));
+      }
+    }
+    return absl::StrCat(absl::Hex(fingerprint.high64, absl::kZeroPad16),
+                        absl::Hex(fingerprint.low64, absl::kZeroPad16));
+  }
+
+  std::shared_ptr<const InferredProperties> Lookup(const string& key) {
+    mutex_lock l(mu_);
+    auto it = index_.find(key);
+    if (it == index_.end()) return nullptr;
+    entries_.splice(entries_.begin(), entries_, it->second);
+    return it->second->second;
+  }
+
+  void Insert(const string& key,
+              std::shared_ptr<const InferredProperties> properties) {
+    mutex_lock l(mu_);
+    auto it = index_.find(key);
+    if (it != index_.end()) {
+      it->second->second = std::move(properties);
+      entries_.splice(entries_.begin(), entries_, it->second);
+      return;
+    }
+    entries_.emplace_front(key, std::move(properties));
+    index_[key] = entries_.begin();
+    while (entries_.size() > capacity_) {
+      index_.erase(entries_.back().first);
+      entries_.pop_back();
+    }
+  }
+
+ private:
+  explicit InferredPropertiesCache(int64_t capacity) : capacity_(capacity) {}
+
+  using Entry = std::pair<string, std::shared_ptr<const InferredProperties>>;
+
+  const size_t capacity_;
+  mutex mu_;
+  // Most recently used first.
+  std::list<Entry> entries_ TF_GUARDED_BY(mu_);
+  absl::flat_hash_map<string, std::list<Entry>::iterator> index_
+      TF_GUARDED_BY(mu_);
+};
+
 }  // namespace
 
 // Note that tensor_as_shape input should not include kUnknownDimFromConst.
@@ -2518,6 +2624,37 @@ Status GraphProperties::InferStatically(bool assume_valid_feeds,
                                         bool aggressive_shape_inference,
                                         bool include_input_tensor_values,
                                         bool include_output_tensor_values) {
+  InferredPropertiesCache* cache = InferredPropertiesCache::Global();
+  if (cache == nullptr || has_properties()) {
+    return InferStaticallyFromScratch(
+        assume_valid_feeds, aggressive_shape_inference,
+        include_input_tensor_values, include_output_tensor_values);
+  }
+  const string key = InferredPropertiesCache::Key(
+      item_, assume_valid_feeds, aggressive_shape_inference,
+      include_input_tensor_values, include_output_tensor_values);
+  std::shared_ptr<const InferredProperties> cached = cache->Lookup(key);
+  if (cached != nullptr) {
+    VLOG(2) << "Shape inference cache hit for " << item_.id;
+    input_properties_ = cached->input_properties;
+    output_properties_ = cached->output_properties;
+    incompatible_shape_nodes_ = cached->incompatible_shape_nodes;
+    return absl::OkStatus();
+  }
+  TF_RETURN_IF_ERROR(InferStaticallyFromScratch(
+      assume_valid_feeds, aggressive_shape_inference,
+      include_input_tensor_values, include_output_tensor_values));
+  auto properties = std::make_shared<InferredProperties>();
+  properties->input_properties = input_properties_;
+  properties->output_properties = output_properties_;
+  properties->incompatible_shape_nodes = incompatible_shape_nodes_;
+  cache->Insert(key, std::move(properties));
+  return absl::OkStatus();
+}
+
+Status GraphProperties::InferStaticallyFromScratch(
+    bool assume_valid_feeds, bool aggressive_shape_inference,
+    bool include_input_tensor_values, bool include_output_tensor_values) {
   FunctionLibraryDefinition function_library(OpRegistry::Global(),
                                              item_.graph.library());
   absl::flat_hash_map<string, absl::flat_hash_set<int>> fed_ports;
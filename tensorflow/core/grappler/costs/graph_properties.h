@@ -96,6 +96,9 @@ class GraphProperties {
   // will included in the input properties.
   // If include_output_tensor_values is true, the values of constant tensors
   // will be included in the output properties.
+  // The results are cached per process, so inferring the properties of a graph
+  // that was already analyzed with the same options doesn't run the inference
+  // again (see TF_GRAPPLER_SHAPE_INFERENCE_CACHE_CAPACITY).
   Status InferStatically(bool assume_valid_feeds,
                          bool aggressive_shape_inference,
                          bool include_input_tensor_values,
@@ -159,6 +162,12 @@ class GraphProperties {
   }
 
  private:
+  // Runs the static shape inference without looking up the cached results.
+  Status InferStaticallyFromScratch(bool assume_valid_feeds,
+                                    bool aggressive_shape_inference,
+                                    bool include_input_tensor_values,
+                                    bool include_output_tensor_values);
+
   // Relaxes shapes <shapes_and_types>, determined from an EnqueueV2 node, into
   // <*queue_shapes_and_types>.
   static Status RelaxEnqueueShapesAndMergeTypes(
@@ -233,6 +233,37 @@ TEST_F(GraphPropertiesTest, Clear) {
   EXPECT_FALSE(properties.has_properties());
 }
 
+TEST_F(GraphPropertiesTest, CachedStaticProperties) {
+  tensorflow::Scope s = tensorflow::Scope::NewRootScope();
+  Output c = ops::Const(s.WithOpName("c"), 1.0f, {2, 3});
+  Output square = ops::Square(s.WithOpName("square"), c);
+  GrapplerItem item;
+  TF_ASSERT_OK(s.ToGraphDef(&item.graph));
+
+  for (int i = 0; i < 2; ++i) {
+    GraphProperties properties(item);
+    TF_ASSERT_OK(properties.InferStatically(false));
+    const auto props = properties.GetOutputProperties("square");
+    ASSERT_EQ(1, props.size());
+    EXPECT_EQ("float: [2,3]", PropToString(props[0]));
+  }
+
+  // The cached properties of the original graph don't apply to a modified one.
+  Tensor value(DT_FLOAT, TensorShape({4}));
+  value.flat<float>().setZero();
+  for (NodeDef& node : *item.graph.mutable_node()) {
+    if (node.name() == "c") {
+      value.AsProtoTensorContent(
+          (*node.mutable_attr())["value"].mutable_tensor());
+    }
+  }
+  GraphProperties properties(item);
+  TF_ASSERT_OK(properties.InferStatically(false));
+  const auto props = properties.GetOutputProperties("square");
+  ASSERT_EQ(1, props.size());
+  EXPECT_EQ("float: [4]", PropToString(props[0]));
+}
+
 TEST_F(GraphPropertiesTest, DynamicProperties) {
   TrivialTestGraphInputYielder fake_input(4, 1, 10, false,
                                           cluster_->GetDeviceNames());
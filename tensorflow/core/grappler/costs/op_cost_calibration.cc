@@ -0,0 +1,134 @@
+/* Copyright 2024 The TensorFlow Authors. All Rights Reserved.
+
+Licensed under the Apache License, Version 2.0 (the "License");
+you may not use this file except in compliance with the License.
+You may obtain a copy of the License at
+
+    http://www.apache.org/licenses/LICENSE-2.0
+
+Unless required by applicable law or agreed to in writing, software
+distributed under the License is distributed on an "AS IS" BASIS,
+WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+See the License for the specific language governing permissions and
+limitations under the License.
+==============================================================================*/
+#include "tensorflow/core/grappler/costs/op_cost_calibration.h"
+
+#include <unordered_map>
+#include <vector>
+
+#include "absl/strings/str_cat.h"
+#include "tensorflow/core/grappler/costs/graph_properties.h"
+#include "tensorflow/core/grappler/costs/utils.h"
+#include "tensorflow/core/platform/errors.h"
+#include "tensorflow/core/platform/logging.h"
+#include "tensorflow/core/util/env_var.h"
+
+namespace tensorflow {
+namespace grappler {
+namespace {
+
+std::string FactorKey(const std::string& device_type,
+                      const std::string& device_model, const std::string& op) {
+  return absl::StrCat(device_type, "/", device_model, "/", op);
+}
+
+}  // namespace
+
+OpCostCalibration::OpCostCalibration(const OpCostCorrectionList& corrections)
+    : corrections_(corrections) {
+  for (const OpCostCorrection& correction : corrections_.correction()) {
+    if (correction.factor() > 0) {
+      factors_[FactorKey(correction.device_type(), correction.device_model(),
+                         correction.op())] = correction.factor();
+    }
+  }
+}
+
+double OpCostCalibration::GetFactor(const DeviceProperties& device,
+                                    const std::string& op) const {
+  if (factors_.empty()) return 1.0;
+  // Corrections fitted on the same device model take precedence over the ones
+  // fitted for any device of the same type.
+  auto it = factors_.find(FactorKey(device.type(), device.model(), op));
+  if (it != factors_.end()) return it->second;
+  it = factors_.find(FactorKey(device.type(), "", op));
+  if (it != factors_.end()) return it->second;
+  return 1.0;
+}
+
+Status OpCostCalibration::Load(
+    Env* env, const std::string& filename,
+    std::unique_ptr<OpCostCalibration>* calibration) {
+  OpCostCorrectionList corrections;
+  TF_RETURN_IF_ERROR(ReadTextOrBinaryProto(env, filename, &corrections));
+  *calibration = std::make_unique<OpCostCalibration>(corrections);
+  return absl::OkStatus();
+}
+
+Status OpCostCalibration::Save(Env* env, const std::string& filename,
+                               const OpCostCorrectionList& corrections) {
+  return WriteBinaryProto(env, filename, corrections);
+}
+
+const OpCostCalibration* OpCostCalibration::Global() {
+  static const OpCostCalibration* calibration = []() {
+    std::string filename;
+    TF_CHECK_OK(ReadStringFromEnvVar("TF_GRAPPLER_OP_COST_CALIBRATION_FILE",
+                                     "", &filename));
+    if (filename.empty()) return static_cast<OpCostCalibration*>(nullptr);
+    std::unique_ptr<OpCostCalibration> loaded;
+    Status status = Load(Env::Default(), filename, &loaded);
+    if (!status.ok()) {
+      LOG(WARNING) << "Failed to read op cost corrections from " << filename
+                   << ": " << status;
+      return static_cast<OpCostCalibration*>(nullptr);
+    }
+    VLOG(1) << "Read " << loaded->corrections().correction_size()
+            << " op cost corrections from " << filename;
+    return loaded.release();
+  }();
+  return calibration;
+}
+
+Status OpCostCalibration::MeasurementsFromStepStats(
+    const StepStats& step_stats, const GrapplerItem& item,
+    OpPerformanceList* measurements) {
+  GraphProperties properties(item);
+  TF_RETURN_IF_ERROR(properties.InferStatically(/*assume_valid_feeds=*/false));
+  std::unordered_map<string, const NodeDef*> name_to_node;
+  for (const NodeDef& node : item.graph.node()) {
+    name_to_node[node.name()] = &node;
+  }
+
+  for (const DeviceStepStats& dev_stats : step_stats.dev_stats()) {
+    const DeviceProperties device = GetDeviceInfo(dev_stats.device());
+    for (const NodeExecStats& node_stats : dev_stats.node_stats()) {
+      auto it = name_to_node.find(node_stats.node_name());
+      if (it == name_to_node.end()) continue;
+      int64_t compute_cost_ns =
+          node_stats.op_end_rel_nanos() - node_stats.op_start_rel_nanos();
+      if (compute_cost_ns <= 0) {
+        compute_cost_ns = (node_stats.op_end_rel_micros() -
+                           node_stats.op_start_rel_micros()) *
+                          1000;
+      }
+      if (compute_cost_ns <= 0) continue;
+
+      const NodeDef& node = *it->second;
+      OpPerformance* perf = measurements->add_op_performance();
+      *perf->mutable_op() = BuildOpInfoWithoutDevice(
+          node, name_to_node, properties.GetInputProperties(node.name()));
+      for (const auto& output : properties.GetOutputProperties(node.name())) {
+        *perf->mutable_op()->add_outputs() = output;
+      }
+      *perf->mutable_op()->mutable_device() = device;
+      perf->set_node(node.name());
+      perf->set_compute_cost(compute_cost_ns);
+    }
+  }
+  return absl::OkStatus();
+}
+
+}  // end namespace grappler
+}  // end namespace tensorflow
@@ -0,0 +1,73 @@
+/* Copyright 2024 The TensorFlow Authors. All Rights Reserved.
+
+Licensed under the Apache License, Version 2.0 (the "License");
+you may not use this file except in compliance with the License.
+You may obtain a copy of the License at
+
+    http://www.apache.org/licenses/LICENSE-2.0
+
+Unless required by applicable law or agreed to in writing, software
+distributed under the License is distributed on an "AS IS" BASIS,
+WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+See the License for the specific language governing permissions and
+limitations under the License.
+==============================================================================*/
+#ifndef TENSORFLOW_CORE_GRAPPLER_COSTS_OP_COST_CALIBRATION_H_
+#define TENSORFLOW_CORE_GRAPPLER_COSTS_OP_COST_CALIBRATION_H_
+
+#include <memory>
+#include <string>
+
+#include "absl/container/flat_hash_map.h"
+#include "tensorflow/core/framework/step_stats.pb.h"
+#include "tensorflow/core/grappler/costs/op_performance_data.pb.h"
+#include "tensorflow/core/grappler/grappler_item.h"
+#include "tensorflow/core/platform/env.h"
+#include "tensorflow/core/platform/status.h"
+#include "tensorflow/core/protobuf/device_properties.pb.h"
+
+namespace tensorflow {
+namespace grappler {
+
+// Per device and op type correction factors of analytical op costs, fitted
+// from measured timings by OpLevelCostEstimator::FitCostCorrections(). The
+// estimator scales the execution time it predicts for an op by the factor of
+// its device type, device model and op type, if there is one.
+class OpCostCalibration {
+ public:
+  explicit OpCostCalibration(const OpCostCorrectionList& corrections);
+
+  // Returns the correction factor of `op` on `device`, or 1 if there is none.
+  double GetFactor(const DeviceProperties& device, const std::string& op) const;
+
+  const OpCostCorrectionList& corrections() const { return corrections_; }
+
+  // Reads corrections from a binary or text OpCostCorrectionList file.
+  static Status Load(Env* env, const std::string& filename,
+                     std::unique_ptr<OpCostCalibration>* calibration);
+  // Writes corrections to a binary OpCostCorrectionList file.
+  static Status Save(Env* env, const std::string& filename,
+                     const OpCostCorrectionList& corrections);
+
+  // Returns the calibration read from the file named by the
+  // TF_GRAPPLER_OP_COST_CALIBRATION_FILE environment variable, or nullptr if
+  // it is unset or cannot be read. Used by every OpLevelCostEstimator, and so
+  // by all the cost based Grappler passes.
+  static const OpCostCalibration* Global();
+
+  // Converts measured node timings in `step_stats` of a run of `item` to
+  // performance data that can be fitted. Nodes that are not in the graph of
+  // `item` or whose timings are missing are skipped.
+  static Status MeasurementsFromStepStats(const StepStats& step_stats,
+                                          const GrapplerItem& item,
+                                          OpPerformanceList* measurements);
+
+ private:
+  const OpCostCorrectionList corrections_;
+  absl::flat_hash_map<std::string, double> factors_;
+};
+
+}  // end namespace grappler
+}  // end namespace tensorflow
+
+#endif  // TENSORFLOW_CORE_GRAPPLER_COSTS_OP_COST_CALIBRATION_H_
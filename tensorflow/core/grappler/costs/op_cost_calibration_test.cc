@@ -0,0 +1,123 @@
+/* Copyright 2024 The TensorFlow Authors. All Rights Reserved.
+
+Licensed under the Apache License, Version 2.0 (the "License");
+you may not use this file except in compliance with the License.
+You may obtain a copy of the License at
+
+    http://www.apache.org/licenses/LICENSE-2.0
+
+Unless required by applicable law or agreed to in writing, software
+distributed under the License is distributed on an "AS IS" BASIS,
+WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+See the License for the specific language governing permissions and
+limitations under the License.
+==============================================================================*/
+#include "tensorflow/core/grappler/costs/op_cost_calibration.h"
+
+#include <memory>
+#include <string>
+
+#include "tensorflow/core/framework/function_testlib.h"
+#include "tensorflow/core/framework/step_stats.pb.h"
+#include "tensorflow/core/framework/tensor_shape.pb.h"
+#include "tensorflow/core/grappler/grappler_item.h"
+#include "tensorflow/core/lib/core/status_test_util.h"
+#include "tensorflow/core/platform/env.h"
+#include "tensorflow/core/platform/path.h"
+#include "tensorflow/core/platform/test.h"
+
+namespace tensorflow {
+namespace grappler {
+namespace {
+
+OpCostCorrection* AddCorrection(const std::string& device_type,
+                                const std::string& device_model,
+                                const std::string& op, double factor,
+                                OpCostCorrectionList* corrections) {
+  OpCostCorrection* correction = corrections->add_correction();
+  correction->set_device_type(device_type);
+  correction->set_device_model(device_model);
+  correction->set_op(op);
+  correction->set_factor(factor);
+  return correction;
+}
+
+TEST(OpCostCalibrationTest, GetFactor) {
+  OpCostCorrectionList corrections;
+  AddCorrection("GPU", "", "MatMul", 2.0, &corrections);
+  AddCorrection("GPU", "A100", "MatMul", 3.0, &corrections);
+  AddCorrection("CPU", "", "Conv2D", 0.5, &corrections);
+  OpCostCalibration calibration(corrections);
+
+  DeviceProperties gpu;
+  gpu.set_type("GPU");
+  gpu.set_model("A100");
+  EXPECT_EQ(calibration.GetFactor(gpu, "MatMul"), 3.0);
+  EXPECT_EQ(calibration.GetFactor(gpu, "Conv2D"), 1.0);
+  gpu.set_model("V100");
+  EXPECT_EQ(calibration.GetFactor(gpu, "MatMul"), 2.0);
+
+  DeviceProperties cpu;
+  cpu.set_type("CPU");
+  cpu.set_model("haswell");
+  EXPECT_EQ(calibration.GetFactor(cpu, "Conv2D"), 0.5);
+  EXPECT_EQ(calibration.GetFactor(cpu, "MatMul"), 1.0);
+}
+
+TEST(OpCostCalibrationTest, SaveAndLoad) {
+  OpCostCorrectionList corrections;
+  AddCorrection("CPU", "", "MatMul", 1.5, &corrections)->set_num_samples(7);
+  const std::string filename =
+      io::JoinPath(testing::TmpDir(), "op_cost_corrections.pb");
+  TF_ASSERT_OK(OpCostCalibration::Save(Env::Default(), filename, corrections));
+
+  std::unique_ptr<OpCostCalibration> calibration;
+  TF_ASSERT_OK(
+      OpCostCalibration::Load(Env::Default(), filename, &calibration));
+  ASSERT_EQ(calibration->corrections().correction_size(), 1);
+  EXPECT_EQ(calibration->corrections().correction(0).num_samples(), 7);
+  DeviceProperties cpu;
+  cpu.set_type("CPU");
+  EXPECT_EQ(calibration->GetFactor(cpu, "MatMul"), 1.5);
+}
+
+TEST(OpCostCalibrationTest, MeasurementsFromStepStats) {
+  using test::function::NDef;
+  constexpr char kDevice[] = "/job:localhost/replica:0/task:0/device:CPU:0";
+  TensorShapeProto shape;
+  shape.add_dim()->set_size(16);
+  GrapplerItem item;
+  item.graph = test::function::GDef(
+      {NDef("x", "Placeholder", {}, {{"dtype", DT_FLOAT}, {"shape", shape}},
+            kDevice),
+       NDef("y", "Relu", {"x"}, {{"T", DT_FLOAT}}, kDevice)},
+      {});
+
+  StepStats step_stats;
+  DeviceStepStats* dev_stats = step_stats.add_dev_stats();
+  dev_stats->set_device(kDevice);
+  NodeExecStats* relu = dev_stats->add_node_stats();
+  relu->set_node_name("y");
+  relu->set_op_start_rel_nanos(1000);
+  relu->set_op_end_rel_nanos(4000);
+  NodeExecStats* unknown = dev_stats->add_node_stats();
+  unknown->set_node_name("_SOURCE");
+  unknown->set_op_end_rel_nanos(100);
+
+  OpPerformanceList measurements;
+  TF_ASSERT_OK(OpCostCalibration::MeasurementsFromStepStats(step_stats, item,
+                                                            &measurements));
+  ASSERT_EQ(measurements.op_performance_size(), 1);
+  const OpPerformance& perf = measurements.op_performance(0);
+  EXPECT_EQ(perf.node(), "y");
+  EXPECT_EQ(perf.compute_cost(), 3000);
+  EXPECT_EQ(perf.op().op(), "Relu");
+  EXPECT_EQ(perf.op().device().type(), "CPU");
+  ASSERT_EQ(perf.op().inputs_size(), 1);
+  EXPECT_EQ(perf.op().inputs(0).shape().dim(0).size(), 16);
+  ASSERT_EQ(perf.op().outputs_size(), 1);
+}
+
+}  // namespace
+}  // end namespace grappler
+}  // end namespace tensorflow
@@ -20,8 +20,10 @@ limitations under the License.
 #include <cmath>
 #include <cstdint>
 #include <functional>
+#include <map>
 #include <optional>
 #include <string>
+#include <tuple>
 #include <vector>
 
 #include "absl/log/check.h"
@@ -655,9 +657,63 @@ OpLevelCostEstimator::OpLevelCostEstimator() {
 
   // By default, use sum of memory_time and compute_time for execution_time.
   compute_memory_overlap_ = false;
+
+  calibration_ = OpCostCalibration::Global();
 }
 
 Costs OpLevelCostEstimator::PredictCosts(const OpContext& op_context) const {
+  Costs costs = PredictUncalibratedCosts(op_context);
+  if (calibration_ == nullptr) return costs;
+  const double factor = calibration_->GetFactor(op_context.op_info.device(),
+                                                op_context.op_info.op());
+  if (factor != 1.0) {
+    costs.execution_time = costs.execution_time.count() * factor;
+    costs.compute_time = costs.compute_time.count() * factor;
+    costs.memory_time = costs.memory_time.count() * factor;
+    VLOG(1) << "Operation " << op_context.op_info.op() << " takes "
+            << costs.execution_time.count() << " ns after a correction by "
+            << factor << ".";
+  }
+  return costs;
+}
+
+OpCostCorrectionList OpLevelCostEstimator::FitCostCorrections(
+    const OpPerformanceList& measurements) const {
+  struct Fit {
+    OpCostCorrection correction;
+    double sum_log_ratio = 0;
+  };
+  // Keep the corrections in a deterministic order.
+  std::map<std::tuple<string, string, string>, Fit> fits;
+  for (const OpPerformance& perf : measurements.op_performance()) {
+    if (perf.compute_cost() <= 0) continue;
+    OpContext op_context;
+    op_context.name = perf.node();
+    op_context.op_info = perf.op();
+    const Costs costs = PredictUncalibratedCosts(op_context);
+    if (costs.inaccurate || costs.execution_time.count() <= 0) continue;
+    const DeviceProperties& device = perf.op().device();
+    Fit& fit = fits[{device.type(), device.model(), perf.op().op()}];
+    fit.sum_log_ratio += std::log(static_cast<double>(perf.compute_cost()) /
+                                  costs.execution_time.count());
+    fit.correction.set_num_samples(fit.correction.num_samples() + 1);
+  }
+
+  OpCostCorrectionList corrections;
+  for (auto& [key, fit] : fits) {
+    OpCostCorrection* correction = corrections.add_correction();
+    *correction = fit.correction;
+    correction->set_device_type(std::get<0>(key));
+    correction->set_device_model(std::get<1>(key));
+    correction->set_op(std::get<2>(key));
+    correction->set_factor(
+        std::exp(fit.sum_log_ratio / fit.correction.num_samples()));
+  }
+  return corrections;
+}
+
+Costs OpLevelCostEstimator::PredictUncalibratedCosts(
+    const OpContext& op_context) const {
   Costs costs;
   NodeCosts node_costs;
   if (PredictNodeCosts(op_context, &node_costs).ok()) {
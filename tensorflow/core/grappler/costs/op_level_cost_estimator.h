@@ -27,6 +27,7 @@ limitations under the License.
 #include "absl/status/statusor.h"
 #include "tensorflow/core/grappler/costs/cost_estimator.h"
 #include "tensorflow/core/grappler/costs/op_context.h"
+#include "tensorflow/core/grappler/costs/op_cost_calibration.h"
 #include "tensorflow/core/grappler/costs/op_performance_data.pb.h"
 #include "tensorflow/core/platform/types.h"
 #include "tensorflow/core/util/padding.h"
@@ -106,6 +107,20 @@ class OpLevelCostEstimator {
   // Returns basic device performance info.
   virtual DeviceInfo GetDeviceInfo(const DeviceProperties& device) const;
 
+  // Sets the measured corrections that PredictCosts() applies to the
+  // analytical costs, or disables them if `calibration` is nullptr. Defaults to
+  // OpCostCalibration::Global(). Not owned; must outlive the estimator.
+  void set_calibration(const OpCostCalibration* calibration) {
+    calibration_ = calibration;
+  }
+
+  // Fits a correction factor per device and op type to the measured
+  // `compute_cost` of the ops in `measurements`: the geometric mean of the
+  // ratios of measured to uncorrected predicted execution times. The result
+  // can be saved with OpCostCalibration::Save().
+  OpCostCorrectionList FitCostCorrections(
+      const OpPerformanceList& measurements) const;
+
  protected:
   // TODO(dyoon): Consider to remove PredictOpCountBasedCosts() with OpInfo.
   // Naive cost estimate based on the given operations count and total
@@ -338,6 +353,11 @@ class OpLevelCostEstimator {
 
  private:
   friend class OpLevelCostEstimatorTest;
+
+  // PredictCosts() without the measured corrections.
+  Costs PredictUncalibratedCosts(const OpContext& op_context) const;
+
+  const OpCostCalibration* calibration_;
 };
 
 }  // end namespace grappler
@@ -2365,5 +2365,44 @@ TEST_F(OpLevelCostEstimatorTest, CropAndResizeExecutionTime) {
   }
 }
 
+TEST_F(OpLevelCostEstimatorTest, FitAndApplyCostCorrections) {
+  const OpContext matmul = DescribeMatMul(100, 100, 100, 100);
+  const OpContext add = DescribeBinaryOp("Add", 1000, 1000);
+  const Costs matmul_costs = PredictCosts(matmul);
+  const Costs add_costs = PredictCosts(add);
+
+  // MatMul runs 2x and 8x slower than predicted; Add as predicted.
+  OpPerformanceList measurements;
+  for (int64_t scale : {2, 8}) {
+    OpPerformance* perf = measurements.add_op_performance();
+    *perf->mutable_op() = matmul.op_info;
+    perf->set_compute_cost(matmul_costs.execution_time.count() * scale);
+  }
+  OpPerformance* perf = measurements.add_op_performance();
+  *perf->mutable_op() = add.op_info;
+  perf->set_compute_cost(add_costs.execution_time.count());
+
+  const OpCostCorrectionList corrections =
+      estimator_.FitCostCorrections(measurements);
+  ASSERT_EQ(corrections.correction_size(), 2);
+  EXPECT_EQ(corrections.correction(0).op(), "Add");
+  EXPECT_NEAR(corrections.correction(0).factor(), 1.0, 1e-2);
+  EXPECT_EQ(corrections.correction(1).op(), "MatMul");
+  EXPECT_EQ(corrections.correction(1).device_type(), "CPU");
+  EXPECT_EQ(corrections.correction(1).num_samples(), 2);
+  EXPECT_NEAR(corrections.correction(1).factor(), 4.0, 1e-2);
+
+  OpCostCalibration calibration(corrections);
+  estimator_.set_calibration(&calibration);
+  const Costs calibrated = PredictCosts(matmul);
+  estimator_.set_calibration(nullptr);
+  EXPECT_NEAR(calibrated.execution_time.count(),
+              matmul_costs.execution_time.count() * 4.0,
+              matmul_costs.execution_time.count() * 1e-2);
+  EXPECT_NEAR(calibrated.compute_time.count(),
+              matmul_costs.compute_time.count() * 4.0,
+              matmul_costs.compute_time.count() * 1e-2);
+}
+
 }  // end namespace grappler
 }  // end namespace tensorflow
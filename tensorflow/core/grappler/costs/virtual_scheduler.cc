@@ -21,6 +21,7 @@ limitations under the License.
 #include <utility>
 
 #include "absl/status/status.h"
+#include "absl/strings/ascii.h"
 #include "absl/strings/str_cat.h"
 #include "absl/strings/str_format.h"
 #include "absl/strings/str_replace.h"
@@ -39,6 +40,7 @@ limitations under the License.
 #include "tensorflow/core/lib/strings/numbers.h"
 #include "tensorflow/core/platform/logging.h"
 #include "tensorflow/core/util/device_name_utils.h"
+#include "tensorflow/core/util/env_var.h"
 
 namespace tensorflow {
 namespace grappler {
@@ -128,6 +130,33 @@ bool IsStreamingPort(const NodeDef& node, const int port) {
   return is_streaming_port;
 }
 
+string GetDeviceType(const string& device_name) {
+  DeviceNameUtils::ParsedName parsed_name;
+  if (!DeviceNameUtils::ParseFullName(device_name, &parsed_name) ||
+      !parsed_name.has_type) {
+    return "";
+  }
+  return absl::AsciiStrToUpper(parsed_name.type);
+}
+
+// Returns the stream of the device that runs the node. On GPUs, copies from
+// and to the host run on their own streams; everything else runs on the
+// compute stream.
+DeviceStream GetDeviceStream(const NodeDef& node, const string& device_name) {
+  if (GetDeviceType(device_name) != "GPU") return DeviceStream::kCompute;
+  if (node.op() == "_CopyFromHostToGpu") return DeviceStream::kHostToDevice;
+  if (node.op() == "_CopyFromGpuToHost") return DeviceStream::kDeviceToHost;
+  if (IsRecv(node) && node.attr().count(kAttrSrcDevice) &&
+      GetDeviceType(node.attr().at(kAttrSrcDevice).s()) == "CPU") {
+    return DeviceStream::kHostToDevice;
+  }
+  if (IsSend(node) && node.attr().count(kAttrDstDevice) &&
+      GetDeviceType(node.attr().at(kAttrDstDevice).s()) == "CPU") {
+    return DeviceStream::kDeviceToHost;
+  }
+  return DeviceStream::kCompute;
+}
+
 }  // namespace
 
 void LIFOManager::AddNode(const NodeDef* node) {
@@ -401,6 +430,9 @@ SchedulerState::SchedulerState(const bool use_static_shapes,
   graph_costs_.num_ops_total = 0;
   initialized_ = false;
   track_mem_usage_snapshot_ = VLOG_IS_ON(1);
+  TF_CHECK_OK(ReadBoolFromEnvVar("TF_GRAPPLER_SIMULATE_GPU_STREAMS",
+                                 /*default_val=*/false,
+                                 &simulate_multiple_streams_));
 }
 
 Status SchedulerState::Init(const GrapplerItem* item,
@@ -936,14 +968,32 @@ std::vector<const NodeDef*> SchedulerState::MarkNodeExecuted(
   // still infinity here, we need to assign them. If not, it has been assigned
   // already, so skip. This latter case may occur when a scheduler in-lines
   // function calls, and thus schedules only function sub-nodes.
-  if (node_state.time_scheduled == Costs::Duration().infinity()) {
-    node_state.time_scheduled =
-        std::max(device.GetCurrTime(), node_state.time_ready);
-    // Override device curr time with the time_scheduled.
-    device.device_costs.execution_time = node_state.time_scheduled;
+  Costs::Duration curr_time;
+  if (simulate_multiple_streams_) {
+    // The node waits only for the stream it runs on; the device is busy
+    // until its last stream is done.
+    const DeviceStream stream = GetDeviceStream(*node, device_name);
+    Costs::Duration start_time = device.GetStreamCurrTime(stream);
+    if (node_state.time_scheduled == Costs::Duration().infinity()) {
+      node_state.time_scheduled = std::max(start_time, node_state.time_ready);
+      start_time = node_state.time_scheduled;
+    }
+    curr_time = start_time + total_node_costs.execution_time;
+    device.stream_curr_time[stream] = curr_time;
+    const Costs::Duration device_time =
+        std::max(device.GetCurrTime(), curr_time);
+    device.device_costs = CombineCosts(device.device_costs, total_node_costs);
+    device.device_costs.execution_time = device_time;
+  } else {
+    if (node_state.time_scheduled == Costs::Duration().infinity()) {
+      node_state.time_scheduled =
+          std::max(device.GetCurrTime(), node_state.time_ready);
+      // Override device curr time with the time_scheduled.
+      device.device_costs.execution_time = node_state.time_scheduled;
+    }
+    device.device_costs = CombineCosts(device.device_costs, total_node_costs);
+    curr_time = device.GetCurrTime();
   }
-  device.device_costs = CombineCosts(device.device_costs, total_node_costs);
-  auto curr_time = device.GetCurrTime();
   node_state.time_finished = curr_time;
 
   // Update shape annotation states.
@@ -101,6 +101,11 @@ struct NodeState {
   }
 };
 
+// The streams of a device that execute nodes concurrently when the scheduler
+// simulates multiple streams: GPUs overlap kernels with host to device and
+// device to host copies.
+enum class DeviceStream { kCompute, kHostToDevice, kDeviceToHost };
+
 struct DeviceState {
   // Nodes executed on this device in execution order.
   std::vector<const NodeDef*> nodes_executed;
@@ -138,6 +143,10 @@ struct DeviceState {
   Costs device_costs;
   std::map<string, Costs> op_to_cost;  // Per-op cost.
 
+  // Time at which each stream of the device becomes available, when multiple
+  // streams are simulated. The device time is the latest of them.
+  std::map<DeviceStream, Costs::Duration> stream_curr_time;
+
   int64_t memory_usage;      // Current temporary memory usage
   int64_t max_memory_usage;  // Max temporary memory usage
 
@@ -164,6 +173,10 @@ struct DeviceState {
   }
 
   Costs::Duration GetCurrTime() const { return device_costs.execution_time; }
+  Costs::Duration GetStreamCurrTime(DeviceStream stream) const {
+    auto it = stream_curr_time.find(stream);
+    return it == stream_curr_time.end() ? Costs::Duration(0) : it->second;
+  }
 };
 
 // ReadyNodeManager (abstract class):
@@ -370,6 +383,10 @@ class SchedulerState {
   const std::unordered_map<string, int64_t> GetPeakMemoryUsage() const;
   const std::unordered_map<string, int64_t> GetPersistentMemoryUsage() const;
   void enable_mem_usage_tracking() { track_mem_usage_snapshot_ = true; }
+  // Simulates separate compute, host to device and device to host streams on
+  // GPUs instead of one sequential queue per device. Also enabled by the
+  // TF_GRAPPLER_SIMULATE_GPU_STREAMS environment variable.
+  void enable_multi_stream_simulation() { simulate_multiple_streams_ = true; }
   // Returns (read only) device and node states.
   const std::unordered_map<string, DeviceState>* GetDeviceStates() const {
     return &device_;
@@ -456,6 +473,7 @@ class SchedulerState {
   bool use_static_shapes_;
   bool initialized_;
   bool track_mem_usage_snapshot_;
+  bool simulate_multiple_streams_;
   const bool use_aggressive_shape_inference_;
   std::unique_ptr<VirtualPlacer> placer_;
 };
@@ -527,6 +545,9 @@ class VirtualScheduler {
   void enable_mem_usage_tracking() {
     scheduler_state_->enable_mem_usage_tracking();
   }
+  void enable_multi_stream_simulation() {
+    scheduler_state_->enable_multi_stream_simulation();
+  }
 
  protected:
   // The state of the scheduler and the execution of the graph is encapsulated
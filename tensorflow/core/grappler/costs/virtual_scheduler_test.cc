@@ -26,6 +26,7 @@ limitations under the License.
 #include "tensorflow/core/framework/tensor_shape.pb.h"
 #include "tensorflow/core/grappler/clusters/virtual_cluster.h"
 #include "tensorflow/core/grappler/costs/graph_properties.h"
+#include "tensorflow/core/grappler/costs/op_level_cost_estimator.h"
 #include "tensorflow/core/grappler/costs/utils.h"
 #include "tensorflow/core/grappler/costs/virtual_placer.h"
 #include "tensorflow/core/lib/core/status_test_util.h"
@@ -3263,6 +3264,80 @@ TEST_F(VirtualSchedulerTest, TestNodeCostOutputTensorSize) {
   }
 }
 
+TEST(SchedulerStateTest, MultiStreamSimulationOverlapsCopiesWithCompute) {
+  constexpr char kGPU0[] = "/job:localhost/replica:0/task:0/device:GPU:0";
+  DeviceProperties cpu_device;
+  cpu_device.set_type("CPU");
+  cpu_device.set_frequency(4000);
+  cpu_device.set_num_cores(2);
+  cpu_device.set_bandwidth(2000000);
+  DeviceProperties gpu_device;
+  gpu_device.set_type("GPU");
+  gpu_device.set_frequency(1000);
+  gpu_device.set_num_cores(24);
+  gpu_device.set_bandwidth(128000000);
+  gpu_device.mutable_environment()->insert({"architecture", "6"});
+  std::unordered_map<string, DeviceProperties> devices;
+  devices[kCPU0] = cpu_device;
+  devices[kGPU0] = gpu_device;
+  VirtualCluster cluster(devices);
+
+  Scope s = Scope::NewRootScope().WithDevice(kGPU0);
+  auto x = ops::Const(s.WithOpName("x"), 1.0f, {512, 512});
+  auto m1 = ops::MatMul(s.WithOpName("m1"), x, x);
+  auto m2 = ops::MatMul(s.WithOpName("m2"), m1, m1);
+  auto y = ops::Identity(s.WithOpName("y").WithDevice(kCPU0), x);
+  GrapplerItem item;
+  item.fetch = {"m2", "y"};
+  TF_ASSERT_OK(s.ToGraphDef(&item.graph));
+
+  SchedulerState state(/*use_static_shapes=*/true,
+                       /*use_aggressive_shape_inference=*/true, &cluster,
+                       std::make_unique<VirtualPlacer>(cluster.GetDevices()));
+  state.enable_multi_stream_simulation();
+  FIFOManager ready_nodes;
+  std::vector<const NodeDef*> initial_nodes;
+  // Without channel devices, the copy of x to the host is a _Send on the GPU.
+  TF_ASSERT_OK(state.Init(&item, &initial_nodes,
+                          /*create_explicit_channel_device=*/false));
+  for (const NodeDef* node : initial_nodes) ready_nodes.AddNode(node);
+  OpLevelCostEstimator estimator;
+  while (!ready_nodes.Empty()) {
+    const NodeDef* node = ready_nodes.GetCurrNode();
+    OpContext op_context = state.CreateOpContext(node);
+    for (const NodeDef* new_node :
+         state.MarkNodeExecuted(node, estimator.PredictCosts(op_context),
+                                op_context)) {
+      ready_nodes.AddNode(new_node);
+    }
+    ready_nodes.RemoveCurrNode();
+  }
+
+  const NodeState* x_state = nullptr;
+  const NodeState* send_state = nullptr;
+  const NodeState* m2_state = nullptr;
+  for (const auto& node_and_state : *state.GetNodeStates()) {
+    if (node_and_state.first->name() == "x") x_state = &node_and_state.second;
+    if (node_and_state.first->name() == "m2") m2_state = &node_and_state.second;
+    if (node_and_state.first->op() == "_Send") {
+      send_state = &node_and_state.second;
+    }
+  }
+  ASSERT_NE(x_state, nullptr);
+  ASSERT_NE(send_state, nullptr);
+  ASSERT_NE(m2_state, nullptr);
+  EXPECT_EQ(send_state->device_name, kGPU0);
+  // The copy to the host does not wait for the MatMuls on the compute stream.
+  EXPECT_EQ(send_state->time_scheduled, x_state->time_finished);
+  const DeviceState& gpu_state = state.GetDeviceStates()->at(kGPU0);
+  EXPECT_EQ(gpu_state.GetStreamCurrTime(DeviceStream::kDeviceToHost),
+            send_state->time_finished);
+  EXPECT_EQ(gpu_state.GetStreamCurrTime(DeviceStream::kCompute),
+            m2_state->time_finished);
+  EXPECT_EQ(gpu_state.GetCurrTime(),
+            std::max(send_state->time_finished, m2_state->time_finished));
+}
+
 }  // namespace
 }  // end namespace grappler
 }  // end namespace tensorflow
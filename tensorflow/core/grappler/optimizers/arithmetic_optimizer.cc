@@ -4110,6 +4110,18 @@ class RemoveStackSliceSameAxis : public ArithmeticOptimizerStage {
 //     segment_ids = sparse_ids.indices[:, 0]
 //     result = tf.sparse.segment_<combiner>(
 //          embeddings, sparse_ids.values, segment_ids)
+//
+// More generally, a reduction of gathered rows, whatever the ids are
+//
+//     gathered_rows = tf.gather(params, ids)
+//     result = tf.sparse.segment_<combiner>(gathered_rows, idx, segment_ids)
+//
+// is rewritten to gather the ids instead of the rows, so that the reduction
+// reads the rows directly from `params` and the gathered rows are never
+// materialized:
+//
+//     result = tf.sparse.segment_<combiner>(
+//          params, tf.gather(ids, idx), segment_ids)
 class SimplifyEmbeddingLookupStage : public ArithmeticOptimizerStage {
  public:
   explicit SimplifyEmbeddingLookupStage(
@@ -4136,32 +4148,61 @@ class SimplifyEmbeddingLookupStage : public ArithmeticOptimizerStage {
       return absl::OkStatus();
     if (gather_node->op() == "GatherV2" && !IsAxis0(*gather_node, 2))
       return absl::OkStatus();
+    if (HasBatchDims(*gather_node)) return absl::OkStatus();
 
-    // Input 1 (indices) of the gather node must be a tf.unique() on the 0th
-    // axis.
+    const string old_indices = reduction_node->input(1);
+    string new_indices;
+    DataType new_indices_type;
     NodeDef* unique_node = nullptr;
     TF_RETURN_IF_ERROR(GetInputNode(gather_node->input(1), &unique_node));
-    if (!IsUnique(*unique_node) || IsInPreserveSet(*unique_node) ||
-        unique_node->device() != gather_node->device())
-      return absl::OkStatus();
-    if (unique_node->op() == "UniqueV2" && !IsAxis0(*unique_node, 1))
-      return absl::OkStatus();
-
-    DataType unique_element_type;
-    TF_RETURN_IF_ERROR(GetNodeAttr(*unique_node, "T", &unique_element_type));
-
-    // Input 1 (indices) of the reduction node must be output 1 of the unique
-    // node.
-    const TensorId idx_tensor = ParseTensorName(reduction_node->input(1));
-    if (idx_tensor != TensorId(unique_node->name(), 1)) return absl::OkStatus();
-
-    // Input 1 (indices) of the reduction node becomes input 0 (x) of the unique
-    // node.
-    reduction_node->set_input(1, unique_node->input(0));
-    ctx().node_map->UpdateInput(reduction_node->name(),
-                                reduction_node->input(1),
-                                unique_node->input(0));
-    SetDataTypeToAttr(unique_element_type, "Tidx", reduction_node);
+    if (IsUniqueIdx(*unique_node, *gather_node, old_indices)) {
+      // Input 1 (indices) of the reduction node becomes input 0 (x) of the
+      // unique node.
+      new_indices = unique_node->input(0);
+      TF_RETURN_IF_ERROR(GetNodeAttr(*unique_node, "T", &new_indices_type));
+    } else {
+      // Input 1 (indices) of the reduction node becomes the ids of the rows
+      // that it reduces. This is only worth it if the gathered rows have no
+      // other consumers, and is only done on CPU where the ids are gathered
+      // without a device round trip.
+      if (!NodeIsOnCpu(*reduction_node) ||
+          NumNonControlOutputs(*gather_node, *ctx().node_map) != 1)
+        return absl::OkStatus();
+      const OpInfo::TensorProperties* ids_properties;
+      TF_RETURN_IF_ERROR(
+          GetTensorProperties(gather_node->input(1), &ids_properties));
+      if (ids_properties->shape().unknown_rank() ||
+          ids_properties->shape().dim_size() != 1)
+        return absl::OkStatus();
+      TF_RETURN_IF_ERROR(
+          GetNodeAttr(*gather_node, "Tindices", &new_indices_type));
+      if (new_indices_type != DT_INT32 && new_indices_type != DT_INT64)
+        return absl::OkStatus();
+      DataType old_indices_type;
+      TF_RETURN_IF_ERROR(
+          GetNodeAttr(*reduction_node, "Tidx", &old_indices_type));
+
+      NodeDef* gather_ids_node = ctx().optimized_graph->add_node();
+      gather_ids_node->set_name(OptimizedNodeName(
+          ParseNodeScopeAndName(reduction_node->name()), "GatherIds"));
+      gather_ids_node->set_op("Gather");
+      gather_ids_node->add_input(gather_node->input(1));
+      gather_ids_node->add_input(old_indices);
+      gather_ids_node->set_device(reduction_node->device());
+      SetDataTypeToAttr(new_indices_type, "Tparams", gather_ids_node);
+      SetDataTypeToAttr(old_indices_type, "Tindices", gather_ids_node);
+      (*gather_ids_node->mutable_attr())["validate_indices"].set_b(true);
+      ctx().node_map->AddNode(gather_ids_node->name(), gather_ids_node);
+      ctx().node_map->AddOutput(NodeName(gather_node->input(1)),
+                                gather_ids_node->name());
+      ctx().node_map->AddOutput(NodeName(old_indices),
+                                gather_ids_node->name());
+      new_indices = gather_ids_node->name();
+    }
+    reduction_node->set_input(1, new_indices);
+    ctx().node_map->UpdateInput(reduction_node->name(), old_indices,
+                                new_indices);
+    SetDataTypeToAttr(new_indices_type, "Tidx", reduction_node);
 
     // Input 0 (data) of the reduction node becomes input 1 (params) of the
     // gather node.
@@ -4216,6 +4257,22 @@ class SimplifyEmbeddingLookupStage : public ArithmeticOptimizerStage {
   }
 
  private:
+  // Returns true if `node`, the input of `gather_node`, is a tf.unique() on
+  // the 0th axis whose output 1 (idx) is `indices`.
+  bool IsUniqueIdx(const NodeDef& node, const NodeDef& gather_node,
+                   const string& indices) {
+    if (!IsUnique(node) || IsInPreserveSet(node) ||
+        node.device() != gather_node.device())
+      return false;
+    if (node.op() == "UniqueV2" && !IsAxis0(node, 1)) return false;
+    return ParseTensorName(indices) == TensorId(node.name(), 1);
+  }
+
+  bool HasBatchDims(const NodeDef& node) {
+    const auto it = node.attr().find("batch_dims");
+    return it != node.attr().end() && it->second.i() != 0;
+  }
+
   bool IsAxis0(const NodeDef& node, int axis_input) {
     Tensor axis_tensor;
     if (!GetTensorFromConstNode(node.input(axis_input), &axis_tensor))
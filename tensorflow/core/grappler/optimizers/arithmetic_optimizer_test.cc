@@ -4717,6 +4717,60 @@ TEST_F(ArithmeticOptimizerTest, SimplifyEmbeddingLookup) {
   }
 }
 
+TEST_F(ArithmeticOptimizerTest, SimplifyEmbeddingLookupWithoutUnique) {
+  for (DataType idx_type : {DT_INT32, DT_INT64}) {
+    tensorflow::Scope s =
+        tensorflow::Scope::NewRootScope().WithDevice("/device:CPU:0");
+    Output embeddings =
+        ops::Const(s.WithOpName("embeddings"),
+                   {1.0f, 2.0f, 3.0f, 4.0f, 5.0f, 6.0f}, {3, 2});
+    Output ids = ops::Const(s.WithOpName("ids"), {2, 0, 1, 2});
+    Output segment_ids =
+        ops::Const(s.WithOpName("segment_ids"), {0, 1, 1, 2, 2});
+    Output idx = ops::Cast(s.WithOpName("idx"),
+                           ops::Const(s.WithOpName("idx_values"),
+                                      {0, 1, 3, 3, 2}),
+                           idx_type);
+    Output gathered_rows =
+        ops::Gather(s.WithOpName("gathered_rows"), embeddings, ids);
+    Output result = ops::SparseSegmentMean(s.WithOpName("result"),
+                                           gathered_rows, idx, segment_ids);
+    Output id = ops::Identity(s.WithOpName("id"), result);
+
+    GrapplerItem item;
+    TF_CHECK_OK(s.ToGraphDef(&item.graph));
+    item.fetch = {"id"};
+    auto tensors_expected = EvaluateNodes(item.graph, item.fetch);
+    ASSERT_EQ(tensors_expected.size(), 1);
+
+    GraphDef output;
+    ArithmeticOptimizer optimizer;
+    EnableOnlySimplifyEmbeddingLookup(&optimizer);
+    OptimizeAndPrune(&optimizer, &item, &output);
+
+    const string gather_ids_name =
+        "ArithmeticOptimizer/SimplifyEmbeddingLookupStage_GatherIds_result";
+    bool gather_ids_found = false;
+    for (const auto& node : output.node()) {
+      if (node.name() == "result") {
+        EXPECT_EQ(node.input(0), "embeddings");
+        EXPECT_EQ(node.input(1), gather_ids_name);
+      }
+      if (node.name() == gather_ids_name) {
+        gather_ids_found = true;
+        EXPECT_EQ(node.input(0), "ids");
+        EXPECT_EQ(node.input(1), "idx");
+      }
+      EXPECT_NE(node.name(), "gathered_rows");
+    }
+    EXPECT_TRUE(gather_ids_found);
+
+    auto tensors = EvaluateNodes(output, item.fetch);
+    ASSERT_EQ(tensors.size(), 1);
+    test::ExpectTensorEqual<float>(tensors[0], tensors_expected[0]);
+  }
+}
+
 TEST_F(ArithmeticOptimizerTest, SimplifyResourceEmbeddingLookup) {
   for (DataType unique_idx_type : {DT_INT32, DT_INT64}) {
     tensorflow::Scope s = tensorflow::Scope::NewRootScope();
@@ -31,6 +31,10 @@ limitations under the License.
 #include "tensorflow/core/framework/types.h"
 #include "tensorflow/core/framework/types.pb.h"
 #include "tensorflow/core/grappler/clusters/cluster.h"
+#include "tensorflow/core/grappler/costs/graph_properties.h"
+#include "tensorflow/core/grappler/costs/op_context.h"
+#include "tensorflow/core/grappler/costs/op_level_cost_estimator.h"
+#include "tensorflow/core/grappler/costs/utils.h"
 #include "tensorflow/core/grappler/costs/virtual_placer.h"
 #include "tensorflow/core/grappler/devices.h"
 #include "tensorflow/core/grappler/grappler_item.h"
@@ -43,6 +47,7 @@ limitations under the License.
 #include "tensorflow/core/lib/strings/numbers.h"
 #include "tensorflow/core/lib/strings/str_util.h"
 #include "tensorflow/core/lib/strings/strcat.h"
+#include "tensorflow/core/platform/cpu_info.h"
 #include "tensorflow/core/platform/logging.h"
 #include "tensorflow/core/platform/status.h"
 #include "tensorflow/core/platform/statusor.h"
@@ -1068,6 +1073,10 @@ class AutoMixedPrecisionImpl {
         return std::make_unique<AutoMixedPrecisionListsFp16>(
             cuda_version_, cudnn_version_, AutoMixedPrecisionMode::CUDA);
       case AutoMixedPrecisionMode::BF16:
+        if (use_cpu_features_) {
+          return std::make_unique<AutoMixedPrecisionListsMkl>(
+              cpu_has_native_bf16_);
+        }
         return std::make_unique<AutoMixedPrecisionListsMkl>();
       case AutoMixedPrecisionMode::CPU:
         return std::make_unique<AutoMixedPrecisionListsFp16>(
@@ -1101,6 +1110,8 @@ class AutoMixedPrecisionImpl {
       std::vector<NodeTypeIdEdge>* implicit_fp32_edges) const;
   void AddAllowlistOps(absl::flat_hash_set<int>* allow_set) const;
   void RemoveAllowsetWithFp32(absl::flat_hash_set<int>* allow_set) const;
+  void RemoveUnprofitableAllowClusters(
+      absl::flat_hash_set<int>* allow_set) const;
   void PropagateDenyFwdThroughClearAndInfer(
       absl::flat_hash_set<int>* deny_set) const;
   void ForceColorMatchBetweenTensorListOps(
@@ -1144,6 +1155,9 @@ class AutoMixedPrecisionImpl {
   GraphTypeTopologyView graph_type_view_;
   bool force_all_fp16_;
   bool treat_infer_as_deny_;
+  bool use_cpu_features_ = false;
+  bool cpu_has_native_bf16_ = false;
+  bool cpu_has_amx_bf16_ = false;
   AutoMixedPrecisionMode mode_;
   gtl::FlatSet<string> f16_allowlist_;
   gtl::FlatSet<string> f16_denylist_;
@@ -1400,6 +1414,20 @@ Status AutoMixedPrecisionImpl::Optimize() {
   treat_infer_as_deny_ = optimization_level == "TREAT_INFER_AS_DENY";
   VLOG(2) << "Optimization Level: " << optimization_level;
 
+  if (mode_ == AutoMixedPrecisionMode::BF16) {
+    TF_RETURN_IF_ERROR(ReadBoolFromEnvVar(
+        "TF_AUTO_MIXED_PRECISION_BF16_USE_CPU_FEATURES",
+        /*default_val=*/false, &use_cpu_features_));
+    cpu_has_amx_bf16_ = port::TestCPUFeature(port::CPUFeature::AMX_BF16);
+    cpu_has_native_bf16_ =
+        cpu_has_amx_bf16_ ||
+        port::TestCPUFeature(port::CPUFeature::AVX512_BF16) ||
+        port::TestCPUFeature(port::CPUFeature::AVX_NE_CONVERT);
+    VLOG(2) << "Use CPU features: " << use_cpu_features_
+            << ", native bfloat16: " << cpu_has_native_bf16_
+            << ", AMX bfloat16: " << cpu_has_amx_bf16_;
+  }
+
   std::unique_ptr<AutoMixedPrecisionLists> mp_lists =
       get_mixed_precision_lists();
   f16_allowlist_ = mp_lists->AllowList();
@@ -1540,6 +1568,13 @@ Status AutoMixedPrecisionImpl::Optimize() {
   RemoveAllowsetWithFp32(&allow_set);
   VLOG(2) << "Finished pass 6";
 
+  if (use_cpu_features_) {
+    VLOG(2) << "Beginning pass 7 to remove allow clusters whose estimated "
+               "speedup does not pay for their casts";
+    RemoveUnprofitableAllowClusters(&allow_set);
+    VLOG(2) << "Finished pass 7";
+  }
+
   VLOG(2) << "Forcing color match between data structure ops";
   for (const auto& cluster : tensor_list_clusters) {
     ForceColorMatchBetweenTensorListOps(cluster, &allow_set, &deny_set);
@@ -1914,6 +1949,162 @@ void AutoMixedPrecisionImpl::RemoveAllowsetWithFp32(
   }
 }
 
+// Removes the connected clusters of the allow set whose estimated speedup in
+// bfloat16 is smaller than the estimated cost of the casts at their boundary.
+// The speedup of allowlist ops comes from the bfloat16 dot product throughput
+// of the CPU, and the speedup of the other ops from halving their memory
+// traffic, which only pays off when the conversions are done in hardware.
+// Clusters whose cost cannot be estimated are kept.
+void AutoMixedPrecisionImpl::RemoveUnprofitableAllowClusters(
+    absl::flat_hash_set<int>* allow_set) const {
+  // Rough ratios of the bfloat16 to float32 matrix multiplication throughput.
+  constexpr double kAmxBf16MatMulSpeedup = 8.0;
+  constexpr double kNativeBf16MatMulSpeedup = 2.0;
+  const double matmul_speedup =
+      cpu_has_amx_bf16_ ? kAmxBf16MatMulSpeedup
+                        : (cpu_has_native_bf16_ ? kNativeBf16MatMulSpeedup
+                                                : 1.0);
+  const double memory_speedup = cpu_has_native_bf16_ ? 2.0 : 1.0;
+
+  GrapplerItem item;
+  item.graph = *graph_;
+  GraphProperties properties(item);
+  Status s = properties.InferStatically(/*assume_valid_feeds=*/false,
+                                        /*aggressive_shape_inference=*/false,
+                                        /*include_tensor_values=*/false);
+  if (!s.ok()) {
+    VLOG(1) << "Failed to infer shapes, keeping all allow clusters: "
+            << s.message();
+    return;
+  }
+  OpLevelCostEstimator cost_estimator;
+  auto predict_costs = [&](const string& op, const AttrValueMap* attr,
+                           const std::vector<OpInfo::TensorProperties>& inputs,
+                           const std::vector<OpInfo::TensorProperties>& outputs,
+                           const DeviceProperties& device) {
+    OpContext op_context;
+    op_context.op_info.set_op(op);
+    if (attr != nullptr) *op_context.op_info.mutable_attr() = *attr;
+    for (const auto& input : inputs) *op_context.op_info.add_inputs() = input;
+    for (const auto& output : outputs) {
+      *op_context.op_info.add_outputs() = output;
+    }
+    *op_context.op_info.mutable_device() = device;
+    return cost_estimator.PredictCosts(op_context);
+  };
+  // Returns the estimated time of a cast of `tensor` to or from bfloat16, or
+  // -1 if it is unknown.
+  auto cast_time = [&](const OpInfo::TensorProperties& tensor,
+                       const DeviceProperties& device) -> double {
+    if (CalculateTensorSize(tensor) <= 0) return -1;
+    OpInfo::TensorProperties cast_tensor = tensor;
+    cast_tensor.set_dtype(target_dtype_);
+    const Costs costs =
+        predict_costs("Cast", nullptr, {tensor}, {cast_tensor}, device);
+    return costs.inaccurate ? -1 : costs.execution_time.count();
+  };
+  auto is_allow = [&](const string& node_name, const TypeAttrId& type_attr) {
+    const absl::optional<int> idx =
+        graph_type_view_.GetNodeIndex(node_name, type_attr);
+    return idx.has_value() && allow_set->count(idx.value());
+  };
+
+  absl::flat_hash_set<int> visited;
+  for (int root_idx = 0; root_idx < graph_type_view_.num_nodes(); ++root_idx) {
+    if (!allow_set->count(root_idx) || visited.count(root_idx)) continue;
+    std::vector<int> cluster;
+    DfsTypeTraversal(graph_type_view_, {graph_type_view_.GetNode(root_idx)},
+                     TypeTraversalDirection::kFollowInputsAndOutputs,
+                     DfsTypePredicates::Enter([&](int idx) -> bool {
+                       return allow_set->count(idx) && !visited.count(idx);
+                     }),
+                     DfsTypeCallbacks::PreOrder([&](int idx) {
+                       visited.insert(idx);
+                       cluster.push_back(idx);
+                     }));
+
+    double saved_time = 0;
+    double casts_time = 0;
+    bool known = true;
+    for (int idx : cluster) {
+      const NodeTypeId& node_type = *graph_type_view_.GetNode(idx);
+      const NodeDef& node = *node_type.node;
+      if (!properties.HasInputProperties(node.name()) ||
+          !properties.HasOutputProperties(node.name())) {
+        known = false;
+        break;
+      }
+      const auto& inputs = properties.GetInputProperties(node.name());
+      const auto& outputs = properties.GetOutputProperties(node.name());
+      const DeviceProperties device = virtual_placer_.get_device(node);
+      const Costs costs =
+          predict_costs(node.op(), &node.attr(), inputs, outputs, device);
+      if (costs.inaccurate) {
+        known = false;
+        break;
+      }
+      const double speedup =
+          f16_allowlist_.count(node.op()) ? matmul_speedup : 1.0;
+      saved_time += costs.compute_time.count() * (1.0 - 1.0 / speedup) +
+                    costs.memory_time.count() * (1.0 - 1.0 / memory_speedup);
+
+      for (int port : node_type_map_.GetInputPorts(node, node_type.type_attr)) {
+        const TensorId tensor = ParseTensorName(node.input(port));
+        const NodeDef* input_node = graph_view_.GetNode(tensor.node());
+        if (input_node == nullptr || port >= static_cast<int>(inputs.size())) {
+          continue;
+        }
+        if (is_allow(input_node->name(), node_type_map_.GetOutputTypeAttr(
+                                             *input_node, tensor.index()))) {
+          continue;
+        }
+        const double time = cast_time(inputs[port], device);
+        if (time < 0) {
+          known = false;
+          break;
+        }
+        casts_time += time;
+      }
+      for (int port :
+           node_type_map_.GetOutputPorts(node, node_type.type_attr)) {
+        if (!known || port >= static_cast<int>(outputs.size())) break;
+        MutableGraphView::OutputPort src(graph_view_.GetNode(node.name()),
+                                         port);
+        bool needs_cast = false;
+        for (const MutableGraphView::InputPort& dst :
+             graph_view_.GetFanout(src)) {
+          if (dst.port_id >= 0 &&
+              !is_allow(dst.node->name(), node_type_map_.GetInputTypeAttr(
+                                              *dst.node, dst.port_id))) {
+            needs_cast = true;
+            break;
+          }
+        }
+        if (!needs_cast) continue;
+        const double time = cast_time(outputs[port], device);
+        if (time < 0) {
+          known = false;
+          break;
+        }
+        casts_time += time;
+      }
+      if (!known) break;
+    }
+    if (!known || saved_time > casts_time) continue;
+
+    for (int idx : cluster) {
+      allow_set->erase(idx);
+      if (VLOG_IS_ON(2)) {
+        const NodeTypeId& item = *graph_type_view_.GetNode(idx);
+        VLOG(2) << "UnPainting type " << item.type_attr.DebugString()
+                << " of " << item.node->op() << " node " << item.node->name()
+                << " ALLOW because its cluster saves an estimated "
+                << saved_time << " ns for " << casts_time << " ns of casts";
+      }
+    }
+  }
+}
+
 // Forces NextIteration nodes and their output Merge node(s) to have the same
 // color. Specifically, it removes them all from allow_set if any of the Merge
 // nodes is not in allow_set, otherwise it adds the NextIteration node to
@@ -390,6 +390,12 @@ class AutoMixedPrecisionListsMkl : public AutoMixedPrecisionLists {
  public:
   AutoMixedPrecisionListsMkl() {}
 
+  // native_bf16: Whether the CPU has bfloat16 instructions (AVX512-BF16,
+  //   AVX-NE-CONVERT or AMX-BF16). Without them, conversions to and from
+  //   bfloat16 are emulated.
+  explicit AutoMixedPrecisionListsMkl(bool native_bf16)
+      : native_bf16_(native_bf16) {}
+
   // Only ops which are supported by MKL in bfloat16 should be added to the
   // allow list, infer list, or clear list.
   gtl::FlatSet<string> AllowList() override {
@@ -460,6 +466,17 @@ class AutoMixedPrecisionListsMkl : public AutoMixedPrecisionLists {
                                      "SquaredDifference",
                                      "Tanh",
                                      "TanhGrad"};
+    if (!native_bf16_) {
+      // These ops compute in float32 internally, so in bfloat16 they only add
+      // emulated conversions. Leave them in float32.
+      for (const string& op : {"Elu", "EluGrad", "Erf", "Log", "Log1p",
+                               "LogSoftmax", "Reciprocal", "Rsqrt", "Selu",
+                               "SeluGrad", "Sigmoid", "SigmoidGrad", "Softmax",
+                               "Softplus", "SoftplusGrad", "Softsign",
+                               "SoftsignGrad", "Sqrt", "Tanh", "TanhGrad"}) {
+        list.erase(op);
+      }
+    }
     UpdateList("INFERLIST", &list);
     // For backwards compatibility, keeping the original env variable here.
     // TODO(reedwm): This should be removed if we don't have active users.
@@ -584,6 +601,9 @@ class AutoMixedPrecisionListsMkl : public AutoMixedPrecisionLists {
     UpdateList("CLEARLIST", &list);
     return list;
   }
+
+ private:
+  bool native_bf16_ = true;
 };
 
 }  // end namespace grappler
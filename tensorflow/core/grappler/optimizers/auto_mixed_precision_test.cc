@@ -34,6 +34,7 @@ limitations under the License.
 #include "tensorflow/core/grappler/utils/grappler_test.h"
 #include "tensorflow/core/lib/core/status_test_util.h"
 #include "tensorflow/core/lib/random/random.h"
+#include "tensorflow/core/platform/cpu_info.h"
 #include "tensorflow/core/util/util.h"
 
 // TODO(benbarsdell): Improve the numerical checks in these tests. The tests
@@ -1761,6 +1762,47 @@ TEST_F(AutoMixedPrecisionMklTest, InferFollowUpStreamDeny) {
     test::ExpectClose(tensors_expected[i], tensors[i]);
   }
 }
+
+TEST(AutoMixedPrecisionListsMklTest, KeepsMathInFloat32WithoutNativeBf16) {
+  AutoMixedPrecisionListsMkl default_lists;
+  AutoMixedPrecisionListsMkl native_lists(/*native_bf16=*/true);
+  AutoMixedPrecisionListsMkl emulated_lists(/*native_bf16=*/false);
+  EXPECT_EQ(default_lists.InferList().size(), native_lists.InferList().size());
+  EXPECT_TRUE(emulated_lists.AllowList().count("MatMul"));
+  EXPECT_TRUE(native_lists.InferList().count("Tanh"));
+  EXPECT_FALSE(emulated_lists.InferList().count("Tanh"));
+  EXPECT_TRUE(emulated_lists.InferList().count("BiasAdd"));
+}
+
+TEST_F(AutoMixedPrecisionMklTest, CostGuidedCastingFollowsCpuFeatures) {
+  setenv("TF_AUTO_MIXED_PRECISION_BF16_USE_CPU_FEATURES", "true",
+         1 /* replace */);
+  tensorflow::Scope s = tensorflow::Scope::NewRootScope().WithDevice(
+      "/job:localhost/replica:0/task:0/device:CPU:0");
+  Output input = ops::Const(s.WithOpName("input"), 1.f / 1024, {1024, 1024});
+  Output allow1 = ops::MatMul(s.WithOpName("allow1"), input, input);
+  Output fetch = ops::Identity(s.WithOpName("fetch"), allow1);
+
+  GrapplerItem item;
+  item.fetch = {"fetch"};
+  TF_CHECK_OK(s.ToGraphDef(&item.graph));
+
+  AutoMixedPrecision optimizer{AutoMixedPrecisionMode::BF16};
+  GraphDef output;
+  TF_ASSERT_OK(optimizer.Optimize(virtual_cluster_.get(), item, &output));
+  unsetenv("TF_AUTO_MIXED_PRECISION_BF16_USE_CPU_FEATURES");
+  VLOG(1) << output.DebugString();
+
+  // Without bfloat16 instructions the MatMul gains nothing from bfloat16, so
+  // it is not worth its casts.
+  const bool native_bf16 =
+      port::TestCPUFeature(port::CPUFeature::AMX_BF16) ||
+      port::TestCPUFeature(port::CPUFeature::AVX512_BF16) ||
+      port::TestCPUFeature(port::CPUFeature::AVX_NE_CONVERT);
+  GraphView output_view(&output);
+  EXPECT_EQ(output_view.GetNode("allow1")->attr().at("T").type(),
+            native_bf16 ? DT_BFLOAT16 : DT_FLOAT);
+}
 #endif  // INTEL_MKL
 
 }  // namespace
@@ -31,6 +31,7 @@ limitations under the License.
 #include "tensorflow/core/framework/op.h"
 #include "tensorflow/core/framework/op_def.pb.h"
 #include "tensorflow/core/framework/tensor.pb.h"
+#include "tensorflow/core/framework/tensor_shape.h"
 #include "tensorflow/core/framework/tensor_shape.pb.h"
 #include "tensorflow/core/framework/tensor_util.h"
 #include "tensorflow/core/framework/types.h"
@@ -49,6 +50,7 @@ limitations under the License.
 #include "tensorflow/core/lib/gtl/inlined_vector.h"
 #include "tensorflow/core/lib/strings/numbers.h"
 #include "tensorflow/core/lib/strings/strcat.h"
+#include "tensorflow/core/platform/blocking_counter.h"
 #include "tensorflow/core/platform/cpu_info.h"
 #include "tensorflow/core/platform/denormal.h"
 #include "tensorflow/core/platform/env.h"
@@ -56,6 +58,7 @@ limitations under the License.
 #include "tensorflow/core/platform/tensor_coding.h"
 #include "tensorflow/core/public/version.h"
 #include "tensorflow/core/util/bcast.h"
+#include "tensorflow/core/util/env_var.h"
 #include "tensorflow/core/util/overflow.h"
 #include "tensorflow/core/util/saved_tensor_slice_util.h"
 
@@ -67,6 +70,47 @@ using TensorVector = gtl::InlinedVector<TensorValue, 4>;
 const int64_t kMaxConstantSize = 100 * 1024;
 
 namespace {
+// Returns the number of threads that evaluate independent foldable nodes.
+int GetConstantFoldingNumThreads() {
+  static const int num_threads = [] {
+    int64_t value;
+    TF_CHECK_OK(ReadInt64FromEnvVar("TF_CONSTANT_FOLDING_NUM_THREADS",
+                                    port::MaxParallelism(), &value));
+    return static_cast<int>(std::max<int64_t>(value, 1));
+  }();
+  return num_threads;
+}
+
+// Returns the maximum total size of the folded outputs that are computed
+// before they are inserted in the graph.
+int64_t GetConstantFoldingMemoryBudget() {
+  static const int64_t budget = [] {
+    int64_t value;
+    TF_CHECK_OK(ReadInt64FromEnvVar("TF_CONSTANT_FOLDING_MEMORY_BUDGET_BYTES",
+                                    int64_t{1} << 30, &value));
+    return value;
+  }();
+  return budget;
+}
+
+// Returns an upper bound of the size of the constants that folding `node`
+// creates.
+int64_t EstimateFoldedSize(const NodeDef& node,
+                           const GraphProperties& properties) {
+  if (!properties.HasOutputProperties(node.name())) return kMaxConstantSize;
+  int64_t size = 0;
+  for (const auto& output : properties.GetOutputProperties(node.name())) {
+    const PartialTensorShape shape(output.shape());
+    const int64_t dtype_size = DataTypeSize(output.dtype());
+    if (!shape.IsFullyDefined() || dtype_size == 0) {
+      size += kMaxConstantSize;
+    } else {
+      size += shape.num_elements() * dtype_size;
+    }
+  }
+  return size;
+}
+
 template <typename T>
 bool AllValuesAre(const TensorProto& proto, const T& value) {
   Tensor tensor;
@@ -1515,16 +1559,42 @@ Status ConstantFolding::FoldMergeNode(NodeDef* node, GraphDef* output_graph) {
   return absl::OkStatus();
 }
 
-Status ConstantFolding::FoldNode(NodeDef* node, GraphDef* output_graph,
-                                 bool* result_too_large) {
-  *result_too_large = false;
-  if (IsMerge(*node)) {
-    return FoldMergeNode(node, output_graph);
+void ConstantFolding::EvaluateFoldables(
+    absl::Span<NodeDef* const> nodes, std::vector<EvaluatedFoldable>* results) {
+  const int num_nodes = nodes.size();
+  results->clear();
+  results->resize(num_nodes);
+  auto evaluate = [this, nodes, results](int i) {
+    EvaluatedFoldable& result = (*results)[i];
+    result.status = EvaluateOneFoldable(*nodes[i], &result.const_nodes,
+                                        &result.result_too_large);
+  };
+
+  const int num_threads = GetConstantFoldingNumThreads();
+  if (num_nodes < 2 || num_threads < 2) {
+    for (int i = 0; i < num_nodes; ++i) evaluate(i);
+  } else {
+    if (thread_pool_ == nullptr) {
+      thread_pool_ = std::make_unique<thread::ThreadPool>(
+          Env::Default(), "constant_folding", num_threads);
+    }
+    BlockingCounter counter(num_nodes);
+    for (int i = 0; i < num_nodes; ++i) {
+      thread_pool_->Schedule([&evaluate, &counter, i]() {
+        // The floating point environment is per thread.
+        port::ScopedFlushDenormal flush;
+        port::ScopedSetRound round(FE_TONEAREST);
+        evaluate(i);
+        counter.DecrementCount();
+      });
+    }
+    counter.Wait();
   }
+}
 
-  std::vector<NodeDef> const_nodes;
-  TF_RETURN_IF_ERROR(
-      EvaluateOneFoldable(*node, &const_nodes, result_too_large));
+Status ConstantFolding::ReplaceWithFoldedNodes(NodeDef* node,
+                                               std::vector<NodeDef> const_nodes,
+                                               GraphDef* output_graph) {
   VLOG(2) << "Folded node: " << SummarizeNodeDef(*node);
 
   NodeDef* constant_output = nullptr;
@@ -1655,32 +1725,78 @@ Status ConstantFolding::FoldGraph(
       queue.push_back(graph_->mutable_node(i));
     }
   }
+  const int64_t memory_budget = GetConstantFoldingMemoryBudget();
   while (!queue.empty()) {
-    NodeDef* node = queue.front();
-    queue.pop_front();
-    if (processed_nodes.count(node->name())) {
-      continue;
+    // The inputs of every queued node are already constant, and folding a node
+    // only changes the node itself and its fanouts, so all the queued nodes
+    // can be evaluated independently. The graph is then updated in queue
+    // order, which gives the same result as folding them one at a time.
+    std::vector<NodeDef*> wave;
+    absl::flat_hash_set<const NodeDef*> in_wave;
+    for (NodeDef* node : queue) {
+      if (!processed_nodes.count(node->name()) && in_wave.insert(node).second) {
+        wave.push_back(node);
+      }
     }
-    // We need to record a copy of output nodes before FoldNode() modifies it.
-    // We also need to ensure that the fanout is sorted deterministically.
-    std::vector<NodeDef*> fanout =
-        node_map_->GetOutputsOrderedByNodeName(node->name());
-    bool result_too_large = false;
-    Status s = FoldNode(node, optimized_graph, &result_too_large);
-    processed_nodes.insert(node->name());
-    if (!s.ok()) {
-      VLOG(1) << "Failed to fold node " << node->DebugString()
-              << "\nError message: " << s;
-      if (result_too_large) {
-        nodes_to_not_simplify->emplace(node->name());
+    queue.clear();
+
+    const int wave_size = wave.size();
+    int begin = 0;
+    while (begin < wave_size) {
+      // Bound the size of the folded outputs that are held before they are
+      // inserted in the graph.
+      int end = begin;
+      int64_t wave_bytes = 0;
+      std::vector<NodeDef*> to_evaluate;
+      while (end < wave_size) {
+        const int64_t bytes = IsMerge(*wave[end])
+                                  ? 0
+                                  : EstimateFoldedSize(*wave[end], properties);
+        if (end > begin && wave_bytes + bytes > memory_budget) break;
+        wave_bytes += bytes;
+        if (!IsMerge(*wave[end])) to_evaluate.push_back(wave[end]);
+        ++end;
       }
-    } else {
-      for (auto& fanout_node : fanout) {
-        if (IsFoldable(*fanout_node, &properties) &&
-            !nodes_to_not_simplify->count(fanout_node->name())) {
-          queue.push_back(fanout_node);
+      std::vector<EvaluatedFoldable> evaluated;
+      EvaluateFoldables(to_evaluate, &evaluated);
+
+      for (int i = begin, j = 0; i < end; ++i) {
+        NodeDef* node = wave[i];
+        // We need to record a copy of output nodes before the node is
+        // replaced. We also need to ensure that the fanout is sorted
+        // deterministically.
+        std::vector<NodeDef*> fanout =
+            node_map_->GetOutputsOrderedByNodeName(node->name());
+        bool result_too_large = false;
+        Status s;
+        if (IsMerge(*node)) {
+          s = FoldMergeNode(node, optimized_graph);
+        } else {
+          EvaluatedFoldable& result = evaluated[j++];
+          s = result.status;
+          result_too_large = result.result_too_large;
+          if (s.ok()) {
+            s = ReplaceWithFoldedNodes(node, std::move(result.const_nodes),
+                                       optimized_graph);
+          }
+        }
+        processed_nodes.insert(node->name());
+        if (!s.ok()) {
+          VLOG(1) << "Failed to fold node " << node->DebugString()
+                  << "\nError message: " << s;
+          if (result_too_large) {
+            nodes_to_not_simplify->emplace(node->name());
+          }
+        } else {
+          for (auto& fanout_node : fanout) {
+            if (IsFoldable(*fanout_node, &properties) &&
+                !nodes_to_not_simplify->count(fanout_node->name())) {
+              queue.push_back(fanout_node);
+            }
+          }
         }
       }
+      begin = end;
     }
   }
 
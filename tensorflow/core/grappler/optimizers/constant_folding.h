@@ -26,6 +26,7 @@ limitations under the License.
 #include "tensorflow/core/grappler/costs/graph_properties.h"
 #include "tensorflow/core/grappler/optimizers/graph_optimizer.h"
 #include "tensorflow/core/grappler/utils.h"
+#include "tensorflow/core/platform/threadpool.h"
 #include "tensorflow/core/protobuf/rewriter_config.pb.h"
 
 namespace tensorflow {
@@ -95,9 +96,21 @@ class ConstantFolding : public GraphOptimizer {
   Status EvaluateOneFoldable(const NodeDef& node, std::vector<NodeDef>* outputs,
                              bool* result_too_large);
 
+  // The result of EvaluateOneFoldable() for one node.
+  struct EvaluatedFoldable {
+    Status status;
+    std::vector<NodeDef> const_nodes;
+    bool result_too_large = false;
+  };
+  // Calls EvaluateOneFoldable() on each of `nodes`, concurrently if there is
+  // more than one and TF_CONSTANT_FOLDING_NUM_THREADS is not 1.
+  void EvaluateFoldables(absl::Span<NodeDef* const> nodes,
+                         std::vector<EvaluatedFoldable>* results);
+  // Replaces `node` with the constants computed by EvaluateOneFoldable().
+  Status ReplaceWithFoldedNodes(NodeDef* node, std::vector<NodeDef> const_nodes,
+                                GraphDef* output_graph);
+
   Status FoldMergeNode(NodeDef* node, GraphDef* output_graph);
-  Status FoldNode(NodeDef* node, GraphDef* output_graph,
-                  bool* result_too_large);
 
   bool IsOnes(const NodeDef& node) const;
   bool IsZeros(const NodeDef& node) const;
@@ -328,6 +341,8 @@ class ConstantFolding : public GraphOptimizer {
   std::unique_ptr<DeviceBase> owned_device_;
 
   std::unique_ptr<ResourceMgr> resource_mgr_;
+  // Evaluates independent foldable nodes concurrently. Created on first use.
+  std::unique_ptr<thread::ThreadPool> thread_pool_;
   GraphDef* graph_;
   std::unique_ptr<NodeMap> node_map_;
   std::unordered_set<string> nodes_to_preserve_;
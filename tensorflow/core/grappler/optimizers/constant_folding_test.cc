@@ -315,6 +315,41 @@ TEST_F(ConstantFoldingTest, SimpleFolding) {
   test::ExpectTensorEqual<float>(tensors_expected[0], tensors[0]);
 }
 
+TEST_F(ConstantFoldingTest, ManyIndependentFoldings) {
+  // Many independent chains of foldable nodes, which are evaluated
+  // concurrently one level at a time.
+  tensorflow::Scope s = tensorflow::Scope::NewRootScope();
+  constexpr int kNumChains = 64;
+  std::vector<Output> chains;
+  for (int i = 0; i < kNumChains; ++i) {
+    Output a = ops::Const(s.WithOpName(strings::StrCat("a", i)),
+                          static_cast<float>(i), {4});
+    Output b = ops::Const(s.WithOpName(strings::StrCat("b", i)), 2.0f, {4});
+    Output mul = ops::Mul(s.WithOpName(strings::StrCat("mul", i)), a, b);
+    chains.push_back(ops::Add(s.WithOpName(strings::StrCat("add", i)), mul, b));
+  }
+  Output sum = ops::AddN(s.WithOpName("sum"), chains);
+
+  GrapplerItem item;
+  item.fetch.push_back("sum");
+  TF_CHECK_OK(s.ToGraphDef(&item.graph));
+
+  ConstantFolding optimizer(/*cpu_device=*/nullptr);
+  GraphDef output;
+  TF_EXPECT_OK(optimizer.Optimize(/*cluster=*/nullptr, item, &output));
+
+  ASSERT_EQ(1, output.node_size());
+  EXPECT_EQ("sum", output.node(0).name());
+  EXPECT_EQ("Const", output.node(0).op());
+
+  std::vector<string> fetch = {"sum"};
+  auto tensors_expected = EvaluateNodes(item.graph, fetch);
+  auto tensors = EvaluateNodes(output, fetch);
+  ASSERT_EQ(1, tensors_expected.size());
+  ASSERT_EQ(1, tensors.size());
+  test::ExpectTensorEqual<float>(tensors_expected[0], tensors[0]);
+}
+
 TEST_F(ConstantFoldingTest, AddTree) {
   tensorflow::Scope s = tensorflow::Scope::NewRootScope();
 
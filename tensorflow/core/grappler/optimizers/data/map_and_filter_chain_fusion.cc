@@ -0,0 +1,256 @@
+/* Copyright 2024 The TensorFlow Authors. All Rights Reserved.
+
+Licensed under the Apache License, Version 2.0 (the "License");
+you may not use this file except in compliance with the License.
+You may obtain a copy of the License at
+
+    http://www.apache.org/licenses/LICENSE-2.0
+
+Unless required by applicable law or agreed to in writing, software
+distributed under the License is distributed on an "AS IS" BASIS,
+WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+See the License for the specific language governing permissions and
+limitations under the License.
+==============================================================================*/
+#include "tensorflow/core/grappler/optimizers/data/map_and_filter_chain_fusion.h"
+
+#include <algorithm>
+#include <optional>
+#include <string>
+#include <vector>
+
+#include "absl/container/flat_hash_set.h"
+#include "absl/strings/str_cat.h"
+#include "tensorflow/core/framework/attr_value.pb.h"
+#include "tensorflow/core/framework/function.h"
+#include "tensorflow/core/framework/function.pb.h"
+#include "tensorflow/core/framework/node_def.pb.h"
+#include "tensorflow/core/framework/node_def_util.h"
+#include "tensorflow/core/framework/types.h"
+#include "tensorflow/core/grappler/clusters/cluster.h"
+#include "tensorflow/core/grappler/grappler_item.h"
+#include "tensorflow/core/grappler/mutable_graph_view.h"
+#include "tensorflow/core/grappler/optimizers/custom_graph_optimizer_registry.h"
+#include "tensorflow/core/grappler/optimizers/data/fusion_utils.h"
+#include "tensorflow/core/grappler/optimizers/data/graph_utils.h"
+#include "tensorflow/core/grappler/utils.h"
+#include "tensorflow/core/grappler/utils/topological_sort.h"
+#include "tensorflow/core/lib/gtl/map_util.h"
+#include "tensorflow/core/platform/protobuf.h"
+
+namespace tensorflow {
+namespace grappler {
+namespace {
+
+constexpr char kMapDatasetOp[] = "MapDataset";
+constexpr char kFilterDatasetOp[] = "FilterDataset";
+constexpr char kFusedMapAndFilterDatasetOp[] = "FusedMapAndFilterDataset";
+constexpr char kMapStage[] = "map";
+constexpr char kFilterStage[] = "filter";
+constexpr char kMapAndFilterStage[] = "map_and_filter";
+constexpr char kPreserveCardinalityAttr[] = "preserve_cardinality";
+
+// A stage of the fused dataset, possibly composed of several nodes.
+struct Stage {
+  string type;
+  NameAttrList func;
+  std::vector<string> captured_inputs;
+  DataTypeVector captured_types;
+};
+
+bool GetBoolAttr(const NodeDef& node, const string& name, bool default_value) {
+  const auto* attr = gtl::FindOrNull(node.attr(), name);
+  return attr == nullptr ? default_value : attr->b();
+}
+
+const char* GetFunctionAttrName(const NodeDef& node) {
+  return node.op() == kMapDatasetOp ? "f" : "predicate";
+}
+
+bool IsStage(const NodeDef& node) {
+  if (node.op() != kMapDatasetOp && node.op() != kFilterDatasetOp) {
+    return false;
+  }
+  for (const string& input : node.input()) {
+    if (IsControlInput(input)) return false;
+  }
+  // The fused dataset always runs its functions with inter-op parallelism.
+  return GetBoolAttr(node, "use_inter_op_parallelism", true);
+}
+
+Stage MakeStage(const NodeDef& node) {
+  Stage stage;
+  stage.type = node.op() == kMapDatasetOp ? kMapStage : kFilterStage;
+  stage.func = node.attr().at(GetFunctionAttrName(node)).func();
+  for (int i = 1; i < node.input_size(); ++i) {
+    stage.captured_inputs.push_back(node.input(i));
+  }
+  for (int type : node.attr().at("Targuments").list().type()) {
+    stage.captured_types.push_back(static_cast<DataType>(type));
+  }
+  return stage;
+}
+
+// Composes the function of `node` into `stage` if `stage` is a map and neither
+// captures inputs. Sets `*composed` to whether it did.
+Status MaybeCompose(const NodeDef& node, Stage* stage,
+                    FunctionLibraryDefinition* function_library,
+                    GraphDef* output, bool* composed) {
+  *composed = false;
+  if (stage->type != kMapStage || !stage->captured_inputs.empty() ||
+      node.input_size() != 1) {
+    return absl::OkStatus();
+  }
+  const FunctionDef* parent_func = function_library->Find(stage->func.name());
+  const FunctionDef* func = function_library->Find(
+      node.attr().at(GetFunctionAttrName(node)).func().name());
+  if (parent_func == nullptr || func == nullptr ||
+      !fusion_utils::CanCompose(parent_func->signature(), func->signature())) {
+    return absl::OkStatus();
+  }
+  const bool is_filter = node.op() == kFilterDatasetOp;
+  const string fused_name = absl::StrCat("map_and_filter_chain_fusion/",
+                                         parent_func->signature().name(), "/",
+                                         func->signature().name());
+  FunctionDef* fused_func;
+  if (is_filter) {
+    // The composed function returns the outputs of the map followed by the
+    // predicate.
+    fused_func = fusion_utils::FuseFunctions(
+        *parent_func, *func, fused_name, fusion_utils::CombineSignature,
+        fusion_utils::ComposeInput, fusion_utils::CombineOutput,
+        fusion_utils::MergeNodes, output->mutable_library());
+  } else {
+    fused_func = fusion_utils::FuseFunctions(
+        *parent_func, *func, fused_name, fusion_utils::ComposeSignature,
+        fusion_utils::ComposeInput, fusion_utils::ComposeOutput,
+        fusion_utils::MergeNodes, output->mutable_library());
+  }
+  if (fused_func == nullptr) return absl::OkStatus();
+  TF_RETURN_IF_ERROR(function_library->AddFunctionDef(*fused_func));
+  stage->func.set_name(fused_func->signature().name());
+  stage->type = is_filter ? kMapAndFilterStage : kMapStage;
+  *composed = true;
+  return absl::OkStatus();
+}
+
+NodeDef MakeFusedNode(const std::vector<const NodeDef*>& chain,
+                      const std::vector<Stage>& stages,
+                      bool preserve_cardinality, MutableGraphView* graph) {
+  NodeDef fused_node;
+  graph_utils::SetUniqueGraphNodeName("fused_map_and_filter", graph->graph(),
+                                      &fused_node);
+  fused_node.set_op(kFusedMapAndFilterDatasetOp);
+  fused_node.add_input(chain.front()->input(0));
+
+  std::vector<NameAttrList> funcs;
+  std::vector<string> stage_types;
+  std::vector<int32> other_arguments_lengths;
+  DataTypeVector other_arguments_types;
+  for (const Stage& stage : stages) {
+    funcs.push_back(stage.func);
+    stage_types.push_back(stage.type);
+    other_arguments_lengths.push_back(stage.captured_inputs.size());
+    for (const string& input : stage.captured_inputs) {
+      fused_node.add_input(input);
+    }
+    other_arguments_types.insert(other_arguments_types.end(),
+                                 stage.captured_types.begin(),
+                                 stage.captured_types.end());
+  }
+  AddNodeAttr("functions", funcs, &fused_node);
+  AddNodeAttr("stage_types", stage_types, &fused_node);
+  AddNodeAttr("other_arguments_lengths", other_arguments_lengths, &fused_node);
+  AddNodeAttr("Targuments", other_arguments_types, &fused_node);
+  AddNodeAttr(kPreserveCardinalityAttr, preserve_cardinality, &fused_node);
+  graph_utils::CopyShapesAndTypesAttrs(*chain.back(), &fused_node);
+  return fused_node;
+}
+
+}  // namespace
+
+Status MapAndFilterChainFusion::OptimizeAndCollectStats(
+    Cluster* cluster, const GrapplerItem& item, GraphDef* output,
+    OptimizationStats* stats) {
+  GraphDef sorted_old_graph = item.graph;
+  TF_RETURN_IF_ERROR(TopologicalSort(&sorted_old_graph));
+  *output = sorted_old_graph;
+
+  MutableGraphView graph(output);
+  absl::flat_hash_set<string> nodes_to_delete;
+  absl::flat_hash_set<string> visited;
+  FunctionLibraryDefinition function_library(OpRegistry::Global(),
+                                             item.graph.library());
+  const auto nodes_to_preserve = item.NodesToPreserve();
+
+  // Visiting the nodes in reverse topological order reaches the last node of
+  // each chain first.
+  for (int i = sorted_old_graph.node_size() - 1; i >= 0; --i) {
+    const NodeDef& node = sorted_old_graph.node(i);
+    if (visited.contains(node.name()) || !IsStage(node)) continue;
+
+    // All the maps of a chain must agree on `preserve_cardinality`.
+    std::optional<bool> preserve_cardinality;
+    auto can_join = [&preserve_cardinality](const NodeDef& stage_node) {
+      if (stage_node.op() != kMapDatasetOp) return true;
+      const bool value =
+          GetBoolAttr(stage_node, kPreserveCardinalityAttr, false);
+      if (preserve_cardinality.has_value() && *preserve_cardinality != value) {
+        return false;
+      }
+      preserve_cardinality = value;
+      return true;
+    };
+
+    std::vector<const NodeDef*> chain = {graph.GetNode(node.name())};
+    can_join(*chain.back());
+    while (true) {
+      const NodeDef* input = graph_utils::GetInputNode(*chain.back(), graph);
+      // Nodes that are consumed elsewhere cannot be removed.
+      if (input == nullptr || visited.contains(input->name()) ||
+          !IsStage(*input) ||
+          graph.NumFanouts(*input, /*include_controlled_nodes=*/true) != 1 ||
+          nodes_to_preserve.find(input->name()) != nodes_to_preserve.end() ||
+          !can_join(*input)) {
+        break;
+      }
+      chain.push_back(input);
+    }
+    for (const NodeDef* chain_node : chain) {
+      visited.insert(chain_node->name());
+    }
+    if (chain.size() < 2) continue;
+    std::reverse(chain.begin(), chain.end());
+
+    std::vector<Stage> stages;
+    for (const NodeDef* chain_node : chain) {
+      if (!stages.empty()) {
+        bool composed;
+        TF_RETURN_IF_ERROR(MaybeCompose(*chain_node, &stages.back(),
+                                        &function_library, output, &composed));
+        if (composed) continue;
+      }
+      stages.push_back(MakeStage(*chain_node));
+    }
+
+    const NodeDef* fused_node = graph.AddNode(MakeFusedNode(
+        chain, stages, preserve_cardinality.value_or(false), &graph));
+    TF_RETURN_IF_ERROR(
+        graph.UpdateFanouts(chain.back()->name(), fused_node->name()));
+    for (const NodeDef* chain_node : chain) {
+      nodes_to_delete.insert(chain_node->name());
+    }
+    VLOG(2) << "Fused " << chain.size() << " map and filter nodes into "
+            << stages.size() << " stages of " << fused_node->name();
+    stats->num_changes++;
+  }
+
+  TF_RETURN_IF_ERROR(graph.DeleteNodes(nodes_to_delete));
+  return absl::OkStatus();
+}
+
+REGISTER_GRAPH_OPTIMIZER_AS(MapAndFilterChainFusion,
+                            "map_and_filter_chain_fusion");
+
+}  // namespace grappler
+}  // namespace tensorflow
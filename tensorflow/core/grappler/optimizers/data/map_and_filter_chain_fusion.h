@@ -0,0 +1,59 @@
+/* Copyright 2024 The TensorFlow Authors. All Rights Reserved.
+
+Licensed under the Apache License, Version 2.0 (the "License");
+you may not use this file except in compliance with the License.
+You may obtain a copy of the License at
+
+    http://www.apache.org/licenses/LICENSE-2.0
+
+Unless required by applicable law or agreed to in writing, software
+distributed under the License is distributed on an "AS IS" BASIS,
+WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+See the License for the specific language governing permissions and
+limitations under the License.
+==============================================================================*/
+#ifndef TENSORFLOW_CORE_GRAPPLER_OPTIMIZERS_DATA_MAP_AND_FILTER_CHAIN_FUSION_H_
+#define TENSORFLOW_CORE_GRAPPLER_OPTIMIZERS_DATA_MAP_AND_FILTER_CHAIN_FUSION_H_
+
+#include "tensorflow/core/grappler/optimizers/data/optimizer_base.h"
+
+namespace tensorflow {
+namespace grappler {
+
+// This transformation replaces a chain of `MapDataset` and `FilterDataset`
+// nodes with a single `FusedMapAndFilterDataset`, so that each element goes
+// through a single iterator instead of one per stage.
+//
+// Within the chain, a map followed by another map is composed into one
+// function, and a map followed by a filter is composed into one function that
+// also returns the predicate, as in `map_fusion` and `map_and_filter_fusion`.
+// A map that follows a filter is kept as a separate stage, because it must not
+// run on the elements that the filter drops. For example,
+// map(f).filter(p).map(g).map(h) becomes one dataset with the stages
+// map_and_filter(x -> f(x), p(f(x))) and map(x -> h(g(x))).
+//
+// The fused stages run sequentially, so the optimization runs before
+// `map_parallelization` and only applies to chains of sequential maps.
+class MapAndFilterChainFusion : public TFDataOptimizerBase {
+ public:
+  MapAndFilterChainFusion() = default;
+  ~MapAndFilterChainFusion() override = default;
+
+  string name() const override { return "map_and_filter_chain_fusion"; };
+
+  bool UsesFunctionLibrary() const override { return false; }
+
+  Status Init(
+      const tensorflow::RewriterConfig_CustomGraphOptimizer* config) override {
+    return absl::OkStatus();
+  }
+
+  Status OptimizeAndCollectStats(Cluster* cluster, const GrapplerItem& item,
+                                 GraphDef* output,
+                                 OptimizationStats* stats) override;
+};
+
+}  // namespace grappler
+}  // namespace tensorflow
+
+#endif  // TENSORFLOW_CORE_GRAPPLER_OPTIMIZERS_DATA_MAP_AND_FILTER_CHAIN_FUSION_H_
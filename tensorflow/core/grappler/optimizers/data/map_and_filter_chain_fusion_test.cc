@@ -0,0 +1,156 @@
+/* Copyright 2024 The TensorFlow Authors. All Rights Reserved.
+
+Licensed under the Apache License, Version 2.0 (the "License");
+you may not use this file except in compliance with the License.
+You may obtain a copy of the License at
+
+    http://www.apache.org/licenses/LICENSE-2.0
+
+Unless required by applicable law or agreed to in writing, software
+distributed under the License is distributed on an "AS IS" BASIS,
+WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+See the License for the specific language governing permissions and
+limitations under the License.
+==============================================================================*/
+#include "tensorflow/core/grappler/optimizers/data/map_and_filter_chain_fusion.h"
+
+#include <vector>
+
+#include "absl/strings/match.h"
+#include "tensorflow/core/framework/attr_value_util.h"
+#include "tensorflow/core/framework/function_testlib.h"
+#include "tensorflow/core/framework/tensor_testutil.h"
+#include "tensorflow/core/grappler/grappler_item.h"
+#include "tensorflow/core/grappler/optimizers/data/graph_test_utils.h"
+#include "tensorflow/core/grappler/optimizers/data/graph_utils.h"
+#include "tensorflow/core/lib/core/status_test_util.h"
+#include "tensorflow/core/platform/test.h"
+
+namespace tensorflow {
+namespace grappler {
+namespace {
+
+using graph_tests_utils::MakeFilterNode;
+using graph_tests_utils::MakeMapNode;
+using test::function::NDef;
+
+std::vector<NodeDef> RangeNodes() {
+  return {NDef("start", "Const", {}, {{"value", 0}, {"dtype", DT_INT32}}),
+          NDef("stop", "Const", {}, {{"value", 10}, {"dtype", DT_INT32}}),
+          NDef("step", "Const", {}, {{"value", 1}, {"dtype", DT_INT32}}),
+          NDef("range", "RangeDataset", {"start", "stop", "step"}, {})};
+}
+
+std::vector<string> GetStageTypes(const NodeDef& node) {
+  const auto& list = node.attr().at("stage_types").list().s();
+  return std::vector<string>(list.begin(), list.end());
+}
+
+TEST(MapAndFilterChainFusionTest, FuseMapFilterMap) {
+  std::vector<NodeDef> nodes = RangeNodes();
+  nodes.push_back(MakeMapNode("map1", "range"));
+  nodes.push_back(MakeFilterNode("filter", "map1"));
+  nodes.push_back(MakeMapNode("map2", "filter"));
+  nodes.push_back(MakeMapNode("map3", "map2"));
+  GrapplerItem item;
+  item.graph = test::function::GDef(
+      nodes, {test::function::XTimesTwo(), test::function::IsZero()});
+
+  MapAndFilterChainFusion optimizer;
+  GraphDef output;
+  TF_ASSERT_OK(optimizer.Optimize(nullptr, item, &output));
+
+  EXPECT_FALSE(graph_utils::ContainsNodeWithOp("MapDataset", output));
+  EXPECT_FALSE(graph_utils::ContainsNodeWithOp("FilterDataset", output));
+  std::vector<int> fused = graph_utils::FindAllGraphNodesWithOp(
+      "FusedMapAndFilterDataset", output);
+  ASSERT_EQ(fused.size(), 1);
+  const NodeDef& fused_node = output.node(fused[0]);
+  EXPECT_EQ(fused_node.input_size(), 1);
+  EXPECT_EQ(fused_node.input(0), "range");
+  // The first map is composed with the filter, and the last two maps with each
+  // other.
+  EXPECT_EQ(GetStageTypes(fused_node),
+            std::vector<string>({"map_and_filter", "map"}));
+  const auto& funcs = fused_node.attr().at("functions").list().func();
+  ASSERT_EQ(funcs.size(), 2);
+  for (const NameAttrList& func : funcs) {
+    EXPECT_TRUE(absl::StartsWith(func.name(), "map_and_filter_chain_fusion/"));
+    EXPECT_TRUE(graph_utils::ContainsGraphFunctionWithName(func.name(),
+                                                           output.library()));
+  }
+}
+
+TEST(MapAndFilterChainFusionTest, KeepsCapturedInputs) {
+  std::vector<NodeDef> nodes = RangeNodes();
+  nodes.push_back(
+      NDef("captured", "Const", {}, {{"value", 2}, {"dtype", DT_INT32}}));
+  nodes.push_back(MakeFilterNode("filter", "range"));
+  NodeDef map_node = MakeMapNode("map", "filter");
+  map_node.add_input("captured");
+  SetAttrValue(std::vector<DataType>({DT_INT32}),
+               &(*map_node.mutable_attr())["Targuments"]);
+  nodes.push_back(map_node);
+  GrapplerItem item;
+  item.graph = test::function::GDef(
+      nodes, {test::function::XTimesTwo(), test::function::IsZero()});
+
+  MapAndFilterChainFusion optimizer;
+  GraphDef output;
+  TF_ASSERT_OK(optimizer.Optimize(nullptr, item, &output));
+
+  std::vector<int> fused = graph_utils::FindAllGraphNodesWithOp(
+      "FusedMapAndFilterDataset", output);
+  ASSERT_EQ(fused.size(), 1);
+  const NodeDef& fused_node = output.node(fused[0]);
+  EXPECT_EQ(GetStageTypes(fused_node),
+            std::vector<string>({"filter", "map"}));
+  ASSERT_EQ(fused_node.input_size(), 2);
+  EXPECT_EQ(fused_node.input(1), "captured");
+  const auto& lengths =
+      fused_node.attr().at("other_arguments_lengths").list().i();
+  EXPECT_EQ(std::vector<int64_t>(lengths.begin(), lengths.end()),
+            std::vector<int64_t>({0, 1}));
+  EXPECT_EQ(fused_node.attr().at("Targuments").list().type_size(), 1);
+}
+
+TEST(MapAndFilterChainFusionTest, DoesNotFuseNodesWithOtherConsumers) {
+  std::vector<NodeDef> nodes = RangeNodes();
+  nodes.push_back(MakeMapNode("map1", "range"));
+  nodes.push_back(MakeFilterNode("filter", "map1"));
+  nodes.push_back(MakeMapNode("map2", "map1"));
+  GrapplerItem item;
+  item.graph = test::function::GDef(
+      nodes, {test::function::XTimesTwo(), test::function::IsZero()});
+
+  MapAndFilterChainFusion optimizer;
+  GraphDef output;
+  TF_ASSERT_OK(optimizer.Optimize(nullptr, item, &output));
+
+  EXPECT_TRUE(graph_utils::ContainsGraphNodeWithName("map1", output));
+  EXPECT_TRUE(graph_utils::ContainsGraphNodeWithName("filter", output));
+  EXPECT_TRUE(graph_utils::ContainsGraphNodeWithName("map2", output));
+  EXPECT_FALSE(
+      graph_utils::ContainsNodeWithOp("FusedMapAndFilterDataset", output));
+}
+
+TEST(MapAndFilterChainFusionTest, DoesNotFuseMixedPreserveCardinality) {
+  std::vector<NodeDef> nodes = RangeNodes();
+  nodes.push_back(MakeMapNode("map1", "range"));
+  NodeDef map_node = MakeMapNode("map2", "map1");
+  (*map_node.mutable_attr())["preserve_cardinality"].set_b(true);
+  nodes.push_back(map_node);
+  GrapplerItem item;
+  item.graph = test::function::GDef(nodes, {test::function::XTimesTwo()});
+
+  MapAndFilterChainFusion optimizer;
+  GraphDef output;
+  TF_ASSERT_OK(optimizer.Optimize(nullptr, item, &output));
+
+  EXPECT_TRUE(graph_utils::ContainsGraphNodeWithName("map1", output));
+  EXPECT_TRUE(graph_utils::ContainsGraphNodeWithName("map2", output));
+}
+
+}  // namespace
+}  // namespace grappler
+}  // namespace tensorflow
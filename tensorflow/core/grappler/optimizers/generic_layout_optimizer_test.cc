@@ -34,6 +34,7 @@ limitations under the License.
 #include "tensorflow/core/lib/core/status_test_util.h"
 #include "tensorflow/core/platform/tensor_float_32_utils.h"
 #include "tensorflow/core/platform/test.h"
+#include "tensorflow/core/util/util.h"
 
 namespace tensorflow {
 namespace grappler {
@@ -385,6 +386,64 @@ TEST_F(GenericLayoutOptimizerTest, CPUDevice) {
 #endif  // (GOOGLE_CUDA || TENSORFLOW_USE_ROCM)
 }
 
+#if !(GOOGLE_CUDA || TENSORFLOW_USE_ROCM)
+TEST_F(GenericLayoutOptimizerTest, CPUDeviceNHWCToNCHW) {
+  tensorflow::Scope s = tensorflow::Scope::NewRootScope().WithDevice("/CPU:0");
+  Output input = ops::RandomUniform(s.WithOpName("Input"),
+                                    {kBatchSize, kHeight, kWidth, kDepthIn},
+                                    DT_FLOAT);
+  Output filter = ops::RandomUniform(
+      s.WithOpName("Filter"), {kKernel, kKernel, kDepthIn, kDepthOut},
+      DT_FLOAT);
+  Output conv = ops::Conv2D(s.WithOpName("Conv2D"), input, filter,
+                            {1, 1, 1, 1}, "SAME",
+                            ops::Conv2D::Attrs().DataFormat("NHWC"));
+  Output relu = ops::Relu(s.WithOpName("Relu"), conv);
+  Output pool = ops::MaxPool(s.WithOpName("MaxPool"), relu, {1, 2, 2, 1},
+                             {1, 2, 2, 1}, "VALID",
+                             ops::MaxPool::Attrs().DataFormat("NHWC"));
+  Output depth_to_space =
+      ops::DepthToSpace(s.WithOpName("DepthToSpace"), pool, 2,
+                        ops::DepthToSpace::Attrs().DataFormat("NHWC"));
+  Output fetch = ops::Identity(s.WithOpName("Fetch"), {depth_to_space});
+  GrapplerItem item;
+  TF_ASSERT_OK(s.ToGraphDef(&item.graph));
+
+  GenericLayoutOptimizer optimizer(RewriterConfig::DEFAULT,
+                                   RewriterConfig::NHWC_TO_NCHW);
+  GraphDef output;
+  Status optimize_status =
+      optimizer.Optimize(virtual_cluster_.get(), item, &output);
+  if (!IsMKLEnabled()) {
+    EXPECT_EQ(optimize_status.code(), absl::StatusCode::kAborted);
+    return;
+  }
+  TF_ASSERT_OK(optimize_status);
+
+  Status status;
+  utils::GraphView graph_view(&output, &status);
+  TF_ASSERT_OK(status);
+  auto* conv_node = graph_view.GetNode("Conv2D");
+  ASSERT_NE(conv_node, nullptr);
+  VerifyDataFormatAttributeMatch(conv_node, "NCHW");
+  auto* pool_node = graph_view.GetNode("MaxPool");
+  ASSERT_NE(pool_node, nullptr);
+  VerifyDataFormatAttributeMatch(pool_node, "NCHW");
+  // There is no NCHW CPU kernel of DepthToSpace.
+  auto* depth_to_space_node = graph_view.GetNode("DepthToSpace");
+  ASSERT_NE(depth_to_space_node, nullptr);
+  VerifyDataFormatAttributeMatch(depth_to_space_node, "NHWC");
+
+  // The chain of Conv2D, Relu and MaxPool needs a single transpose at each
+  // end.
+  int num_transposes = 0;
+  for (const NodeDef& node : output.node()) {
+    if (node.op() == "Transpose") ++num_transposes;
+  }
+  EXPECT_EQ(num_transposes, 2);
+}
+#endif  // !(GOOGLE_CUDA || TENSORFLOW_USE_ROCM)
+
 TEST_F(GenericLayoutOptimizerTest, NoOptimizeIntegerConvolution) {
   tensorflow::Scope s = tensorflow::Scope::NewRootScope();
   auto conv = SimpleConv2D<int32>(&s, 4, 2, "VALID", "");
@@ -293,8 +293,17 @@ bool Transposer::ShouldProcess(const TransposeContext& context,
   const bool is_integer_conv2d = IsNonFloatingConv2D(node);
   const bool is_integer_conv3d = IsNonFloatingConv3D(node);
 
+  // Layout sensitive ops without a channels first CPU kernel stay in the
+  // channels last format.
+  const bool is_supported_data_format =
+      context.target_device != kCPU ||
+      absl::StartsWith(context.dst_format, "NHW") ||
+      absl::StartsWith(context.dst_format, "NDHW") ||
+      !IsLayoutSensitiveOp(*node_def) ||
+      IsChannelsFirstSupportedOnCpu(*node_def);
+
   return is_on_target_device && data_format_match && !is_integer_conv2d &&
-         !is_integer_conv3d &&
+         !is_integer_conv3d && is_supported_data_format &&
          !context.nodes_to_preserve.contains(node_def->name()) &&
          !(node.NumRegularFanouts() == 0 && node.NumControlledFanouts() == 0);
 }
@@ -2054,6 +2063,21 @@ bool IsLayoutSensitiveOp(const NodeDef& node) {
          IsConv3DBackpropFilterV2(node) || IsMaxPool3D(node);
 }
 
+bool IsChannelsFirstSupportedOnCpu(const NodeDef& node) {
+  static absl::flat_hash_set<string>* supported_ops =
+      new absl::flat_hash_set<std::string>(
+          {"AvgPool", "Conv2D", "DepthwiseConv2dNative", "FusedBatchNorm",
+           "FusedBatchNormV2", "FusedBatchNormV3", "MaxPool"});
+  return supported_ops->contains(node.op()) || IsAvgPoolGrad(node) ||
+         IsBiasAddV2(node) || IsBiasAddGrad(node) ||
+         IsConv2DBackpropFilter(node) || IsConv2DBackpropInput(node) ||
+         IsDepthwiseConv2dNativeBackpropFilter(node) ||
+         IsDepthwiseConv2dNativeBackpropInput(node) ||
+         IsFusedBatchNormGrad(node) || IsMaxPoolGrad(node) || IsConv3D(node) ||
+         IsConv3DBackpropInputV2(node) || IsConv3DBackpropFilterV2(node) ||
+         IsMaxPool3D(node);
+}
+
 bool IsDefaultLayoutAgnosticOp(const NodeDef& node) {
   static absl::flat_hash_set<string>* agnostic_nodes =
       new absl::flat_hash_set<std::string>({"Abs",
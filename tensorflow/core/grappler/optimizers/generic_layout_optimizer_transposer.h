@@ -625,6 +625,10 @@ bool IsDefaultLayoutSensitiveOp(const NodeDef& node);
 
 bool IsLayoutSensitiveOp(const NodeDef& node);
 
+// Returns true if `node` is a layout sensitive op with a oneDNN CPU kernel for
+// the channels first data formats.
+bool IsChannelsFirstSupportedOnCpu(const NodeDef& node);
+
 bool IsDefaultLayoutAgnosticOp(const NodeDef& node);
 
 bool IsLayoutAgnosticOp(const NodeDef& node);
@@ -30,6 +30,8 @@ limitations under the License.
 #include "tensorflow/core/grappler/clusters/virtual_cluster.h"
 #include "tensorflow/core/grappler/costs/graph_memory.h"
 #include "tensorflow/core/grappler/costs/graph_properties.h"
+#include "tensorflow/core/grappler/costs/op_context.h"
+#include "tensorflow/core/grappler/costs/op_level_cost_estimator.h"
 #include "tensorflow/core/grappler/costs/utils.h"
 #include "tensorflow/core/grappler/graph_topology_view.h"
 #include "tensorflow/core/grappler/grappler_item.h"
@@ -440,9 +442,140 @@ void RecomputeSubgraph(
   }
 }
 
+// Chooses the nodes to recompute for the RECOMPUTATION_COST_MODEL level. On
+// every device whose estimated peak memory usage exceeds the budget, the
+// candidates feeding a target node whose outputs are live at the peak are
+// picked greedily, cheapest estimated compute time per byte freed first, until
+// the excess is covered. This approximates the knapsack problem of finding the
+// cheapest set of activations to recompute that fits the graph in the budget.
+// A budget that is not positive stands for 80% of the memory of the device.
+std::unordered_set<string> ChooseNodesToRecompute(
+    Cluster* cluster, int64_t memory_budget, const GrapplerItem& item,
+    const GraphDef* graph, const NodeMap& node_map,
+    const std::function<bool(const NodeDef&)>& is_candidate,
+    const std::function<bool(const NodeDef&)>& is_target) {
+  std::unordered_set<string> nodes_to_recompute;
+  if (cluster == nullptr || item.fetch.empty()) {
+    return nodes_to_recompute;
+  }
+  GraphMemory memory(item);
+  Status s = memory.InferStatically(cluster->GetDevices());
+  if (!s.ok()) {
+    VLOG(1) << "Failed to infer memory usage: " << s.message();
+    return nodes_to_recompute;
+  }
+  GraphProperties properties(item);
+  s = properties.InferStatically(/*assume_valid_feeds=*/false,
+                                 /*aggressive_shape_inference=*/false,
+                                 /*include_tensor_values=*/false);
+  if (!s.ok()) {
+    VLOG(1) << "Failed to infer shapes: " << s.message();
+    return nodes_to_recompute;
+  }
+  std::unordered_set<const NodeDef*> candidates =
+      FindCandidateRecomputeNodes(node_map, graph, is_candidate, is_target);
+  OpLevelCostEstimator cost_estimator;
+
+  for (const auto& device : cluster->GetDevices()) {
+    const string& name = device.first;
+    const DeviceProperties& prop = device.second;
+    const int64_t budget = memory_budget > 0
+                               ? memory_budget
+                               : static_cast<int64_t>(prop.memory_size() * 0.8);
+    if (budget <= 0) {
+      VLOG(1) << "Available memory unknown for device " << name;
+      continue;
+    }
+    const GraphMemory::MemoryUsage& mem_usage = memory.GetPeakMemoryUsage(name);
+    if (mem_usage.used_memory <= budget) {
+      continue;
+    }
+    std::unordered_map<string, int64_t> live_bytes_per_node;
+    std::unordered_set<string> live_tensors;
+    for (const auto& live : mem_usage.live_tensors) {
+      live_bytes_per_node[live.node] += live.memory_used;
+      live_tensors.insert(strings::StrCat(live.node, ":", live.output_id));
+    }
+
+    struct Choice {
+      const NodeDef* node;
+      int64_t saved_bytes;
+      double cost_per_byte;
+    };
+    std::vector<Choice> choices;
+    for (const NodeDef* node : candidates) {
+      if (nodes_to_recompute.count(node->name()) > 0) {
+        continue;
+      }
+      auto live_it = live_bytes_per_node.find(node->name());
+      if (live_it == live_bytes_per_node.end() ||
+          !properties.HasInputProperties(node->name()) ||
+          !properties.HasOutputProperties(node->name())) {
+        continue;
+      }
+      // The inputs of a recomputed node must stay alive until the
+      // recomputation instead of its outputs.
+      const std::vector<OpInfo::TensorProperties>& inputs =
+          properties.GetInputProperties(node->name());
+      int64_t saved_bytes = live_it->second;
+      const int num_inputs = std::min<int>(node->input_size(), inputs.size());
+      for (int i = 0; i < num_inputs; ++i) {
+        if (IsControlInput(node->input(i))) {
+          break;
+        }
+        const TensorId input = ParseTensorName(node->input(i));
+        if (live_tensors.count(strings::StrCat(
+                input.node(), ":", std::max(0, input.index()))) == 0) {
+          saved_bytes -= CalculateTensorSize(inputs[i]);
+        }
+      }
+      if (saved_bytes <= 0) {
+        continue;
+      }
+      OpContext op_context;
+      op_context.name = node->name();
+      op_context.device_name = name;
+      OpInfo& op_info = op_context.op_info;
+      op_info.set_op(node->op());
+      *op_info.mutable_attr() = node->attr();
+      for (const auto& input : inputs) {
+        *op_info.add_inputs() = input;
+      }
+      for (const auto& output : properties.GetOutputProperties(node->name())) {
+        *op_info.add_outputs() = output;
+      }
+      *op_info.mutable_device() = prop;
+      const Costs costs = cost_estimator.PredictCosts(op_context);
+      if (costs.inaccurate) {
+        continue;
+      }
+      choices.push_back(
+          {node, saved_bytes,
+           static_cast<double>(costs.execution_time.count()) / saved_bytes});
+    }
+    std::sort(choices.begin(), choices.end(),
+              [](const Choice& a, const Choice& b) {
+                return a.cost_per_byte < b.cost_per_byte;
+              });
+    int64_t excess_bytes = mem_usage.used_memory - budget;
+    for (const Choice& choice : choices) {
+      if (excess_bytes <= 0) {
+        break;
+      }
+      VLOG(2) << "Recomputing " << choice.node->name() << " on " << name
+              << " to save " << choice.saved_bytes << " bytes";
+      nodes_to_recompute.insert(choice.node->name());
+      excess_bytes -= choice.saved_bytes;
+    }
+  }
+  return nodes_to_recompute;
+}
+
 void RecomputationRewritingPass(RewriterConfig::MemOptType optimization_level,
                                 const string& recomputation_targets_name_scope,
-                                GraphDef* graph, const GrapplerItem& item) {
+                                int64_t recomputation_memory_budget,
+                                Cluster* cluster, GraphDef* graph,
+                                const GrapplerItem& item) {
   // The topological numberings and NodeMap will be stale as soon as we start
   // modifying the graph in RecomputeSubgraph. However, RecomputeSubgraph only
   // looks up nodes which were in the original graph, and preserves the graph
@@ -488,6 +621,25 @@ void RecomputationRewritingPass(RewriterConfig::MemOptType optimization_level,
                   node.attr().count(kRecomputeHint) > 0);
         },
         is_target);
+  } else if (optimization_level ==
+             RewriterConfig::RECOMPUTATION_COST_MODEL) {
+    std::unordered_set<string> nodes_to_recompute = ChooseNodesToRecompute(
+        cluster, recomputation_memory_budget, item.WithGraph(GraphDef(*graph)),
+        graph, node_map,
+        [&feeds, &is_target](const NodeDef& node) {
+          return !is_target(node) && feeds.count(node.name()) == 0 &&
+                 NumNonControlInputs(node) > 0 && IsFreeOfSideEffect(node) &&
+                 !IsControlFlow(node);
+        },
+        is_target);
+    recomputed_subgraphs = GetOpGroupsToRecompute(
+        graph, node_map,
+        [&nodes_to_recompute, &feeds, &is_target](const NodeDef& node) {
+          return !is_target(node) && feeds.count(node.name()) == 0 &&
+                 (nodes_to_recompute.count(node.name()) > 0 ||
+                  node.attr().count(kRecomputeHint) > 0);
+        },
+        is_target);
   } else if (optimization_level == RewriterConfig::MANUAL) {
     recomputed_subgraphs = GetOpGroupsToRecompute(
         graph, node_map,
@@ -1386,6 +1538,7 @@ Status MemoryOptimizer::Optimize(Cluster* cluster, const GrapplerItem& item,
   bool run_recomputation_pass =
       (optimization_level_ == RewriterConfig::RECOMPUTATION_HEURISTICS ||
        optimization_level_ == RewriterConfig::HEURISTICS ||
+       optimization_level_ == RewriterConfig::RECOMPUTATION_COST_MODEL ||
        optimization_level_ == RewriterConfig::MANUAL);
   if (!run_recomputation_pass && nodes_to_relax.empty() && item.fetch.empty()) {
     return errors::Aborted("Nothing to do.");
@@ -1397,6 +1550,7 @@ Status MemoryOptimizer::Optimize(Cluster* cluster, const GrapplerItem& item,
   if (run_recomputation_pass) {
     RecomputationRewritingPass(optimization_level_,
                                recomputation_targets_name_scope_,
+                               recomputation_memory_budget_, cluster,
                                &optimized_item.graph, item);
   }
 
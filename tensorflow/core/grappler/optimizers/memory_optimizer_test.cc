@@ -448,6 +448,44 @@ TEST_F(MemoryOptimizerTest, AccumulationRewrites) {
   }
 }
 
+TEST_F(MemoryOptimizerTest, RecomputationCostModel) {
+  tensorflow::Scope s = tensorflow::Scope::NewRootScope();
+  Output a = ops::RandomNormal(s.WithOpName("a").WithDevice("/cpu:0"),
+                               {128, 128, 8}, DT_FLOAT);
+  Output b = ops::Relu(s.WithOpName("b").WithDevice("/cpu:0"), a);
+  Output c = ops::Square(s.WithOpName("c").WithDevice("/cpu:0"), b);
+  Output d = ops::AddN(s.WithOpName("gradients/d").WithDevice("/cpu:0"), {c});
+  Output e = ops::Mul(s.WithOpName("gradients/e").WithDevice("/cpu:0"), d, b);
+
+  GrapplerItem item;
+  TF_CHECK_OK(s.ToGraphDef(&item.graph));
+  item.fetch = {"gradients/e"};
+  std::unique_ptr<VirtualCluster> cluster(CreateVirtualCluster());
+
+  // Nothing is recomputed when the graph fits in the budget.
+  MemoryOptimizer large_budget_optimizer(
+      RewriterConfig::RECOMPUTATION_COST_MODEL, "gradients/",
+      /*recomputation_memory_budget=*/int64_t{1} << 30);
+  GraphDef output;
+  TF_EXPECT_OK(large_budget_optimizer.Optimize(cluster.get(), item, &output));
+  EXPECT_EQ(item.graph.node_size(), output.node_size());
+
+  MemoryOptimizer small_budget_optimizer(
+      RewriterConfig::RECOMPUTATION_COST_MODEL, "gradients/",
+      /*recomputation_memory_budget=*/1);
+  TF_EXPECT_OK(small_budget_optimizer.Optimize(cluster.get(), item, &output));
+  NodeMap node_map(&output);
+  const NodeDef* transformed_e = node_map.GetNode("gradients/e");
+  ASSERT_NE(transformed_e, nullptr);
+  ASSERT_EQ(2, transformed_e->input_size());
+  EXPECT_EQ("gradients/d", transformed_e->input(0));
+  EXPECT_EQ("Recomputed/b", transformed_e->input(1));
+  const NodeDef* recomputed_b = node_map.GetNode("Recomputed/b");
+  ASSERT_NE(recomputed_b, nullptr);
+  EXPECT_EQ("Relu", recomputed_b->op());
+  EXPECT_EQ("a", recomputed_b->input(0));
+}
+
 class RelaxAllocatorConstraintsTest : public GrapplerTest {};
 
 TEST_F(RelaxAllocatorConstraintsTest, SameDevice) {
@@ -22,8 +22,11 @@ limitations under the License.
 #include "tensorflow/core/graph/graph.h"
 #include "tensorflow/core/grappler/grappler_item.h"
 #include "tensorflow/core/grappler/optimizers/graph_optimizer.h"
+#include "tensorflow/core/grappler/utils/functions.h"
 #include "tensorflow/core/grappler/verifiers/graph_verifier.h"
 #include "tensorflow/core/lib/core/status.h"
+#include "tensorflow/core/platform/mutex.h"
+#include "tensorflow/core/platform/thread_annotations.h"
 #include "tensorflow/core/protobuf/config.pb.h"
 #include "tensorflow/core/protobuf/rewriter_config.pb.h"
 #include "tensorflow/core/protobuf/verifier_config.pb.h"
@@ -47,6 +50,9 @@ class MetaOptimizer : public GraphOptimizer {
     return OptimizeConsumeItem(cluster, std::move(copy), optimized_graph);
   }
 
+  // Returns the cached optimized graph if the result cache is enabled and
+  // `item` was optimized before with the same config, see
+  // OptimizationResultCache.
   Status OptimizeConsumeItem(Cluster* cluster, GrapplerItem&& item,
                              GraphDef* optimized_graph);
 
@@ -97,6 +103,19 @@ class MetaOptimizer : public GraphOptimizer {
   Status OptimizeGraph(Cluster* cluster, GrapplerItem&& item,
                        GraphDef* optimized_graph);
 
+  // Optimizes the main graph of `item` and its function library.
+  Status OptimizeItem(Cluster* cluster, GrapplerItem&& item,
+                      GraphDef* optimized_graph);
+
+  // Makes `func_item` from `func` and optimizes its body into
+  // `optimized_func_graph`. Only reads `flib`, so that the functions of a
+  // library can be optimized concurrently.
+  Status OptimizeFunction(Cluster* cluster, const FunctionDef& func,
+                          const FunctionLibraryDefinition& flib, int producer,
+                          bool allow_non_differentiable_rewrites,
+                          bool is_tpu_graph, GrapplerFunctionItem* func_item,
+                          GraphDef* optimized_func_graph);
+
   DeviceBase* const cpu_device_;  // may be NULL
   ConfigProto config_proto_;
   RewriterConfig& cfg_;
@@ -118,7 +137,9 @@ class MetaOptimizer : public GraphOptimizer {
                       GrapplerItem* optimized_item, GraphDef* optimized_graph,
                       GraphOptimizationResult* optimization_result);
 
-  std::vector<GraphOptimizationResult> optimization_results_;
+  mutable mutex optimization_results_mu_;
+  std::vector<GraphOptimizationResult> optimization_results_
+      TF_GUARDED_BY(optimization_results_mu_);
 };
 
 bool MetaOptimizerEnabled(const ConfigProto& cfg);
@@ -23,7 +23,9 @@ limitations under the License.
 #include "tensorflow/core/framework/dataset.h"
 #include "tensorflow/core/framework/function_testlib.h"
 #include "tensorflow/core/framework/graph.pb.h"
+#include "tensorflow/core/framework/node_def_util.h"
 #include "tensorflow/core/framework/tensor_testutil.h"
+#include "tensorflow/core/grappler/clusters/virtual_cluster.h"
 #include "tensorflow/core/grappler/grappler_item.h"
 #include "tensorflow/core/grappler/inputs/trivial_test_graph_input_yielder.h"
 #include "tensorflow/core/grappler/optimizers/custom_graph_optimizer.h"
@@ -150,6 +152,44 @@ TEST_F(MetaOptimizerTest, RunsCustomOptimizer) {
   EXPECT_TRUE(TestOptimizer::IsOptimized());
 }
 
+TEST_F(MetaOptimizerTest, AnnotatesSchedulingPriorities) {
+  TrivialTestGraphInputYielder fake_input(4, 1, 10, false, {kDevice});
+  GrapplerItem item;
+  ASSERT_TRUE(fake_input.NextItem(&item));
+
+  ConfigProto config_proto;
+  auto& rewriter_config =
+      *config_proto.mutable_graph_options()->mutable_rewrite_options();
+  rewriter_config.set_experimental_scheduling_priorities(RewriterConfig::ON);
+  rewriter_config.set_min_graph_nodes(-1);
+
+  DeviceProperties cpu_device;
+  cpu_device.set_type("CPU");
+  cpu_device.set_frequency(1000);
+  cpu_device.set_num_cores(4);
+  cpu_device.set_bandwidth(32);
+  VirtualCluster cluster({{kDevice, cpu_device}});
+
+  MetaOptimizer optimizer(nullptr, config_proto);
+  GraphDef output;
+  TF_ASSERT_OK(optimizer.Optimize(&cluster, item, &output));
+
+  // The fanins of a node are on a longer path than the node itself.
+  std::unordered_map<string, int64_t> priorities;
+  for (const NodeDef& node : output.node()) {
+    int64_t priority;
+    ASSERT_TRUE(TryGetNodeAttr(node, kSchedulingPriorityAttrName, &priority))
+        << node.name();
+    EXPECT_GT(priority, 0);
+    priorities[node.name()] = priority;
+  }
+  for (const NodeDef& node : output.node()) {
+    for (const string& input : node.input()) {
+      EXPECT_GT(priorities[NodeName(input)], priorities[node.name()]);
+    }
+  }
+}
+
 TEST_F(MetaOptimizerTest, RunsCustomOptimizerWithParams) {
   TrivialTestGraphInputYielder fake_input(4, 1, 10, false, {kDevice});
   GrapplerItem item;
@@ -420,6 +460,110 @@ TEST_F(MetaOptimizerTest, OptimizeFunctionLibrary) {
   test::ExpectTensorEqual<int>(tensors_expected[1], tensors[1]);
 }
 
+TEST_F(MetaOptimizerTest, OptimizeFunctionLibraryConcurrently) {
+  using test::function::NDef;
+
+  ConfigProto config_proto;
+  auto& rewriter_config =
+      *config_proto.mutable_graph_options()->mutable_rewrite_options();
+
+  rewriter_config.set_meta_optimizer_iterations(RewriterConfig::TWO);
+  rewriter_config.set_function_optimization(RewriterConfig::ON);
+  rewriter_config.add_optimizers("function");
+  rewriter_config.set_min_graph_nodes(-1);
+
+  // Define independent functions, each called from the main graph:
+  //
+  //  *MySquare(x) = x * x
+  //  *MyCube(x)   = x * x * x
+  //  *MyDouble(x) = x + x
+  //
+  //  * - marked as noinline
+  FunctionDef square_func = FunctionDefHelper::Create(
+      "MySquare", {"x:T"}, {"z:T"}, {"T: {float, double}"},
+      {{{"mul"}, "Mul", {"x", "x"}, {{"T", "$T"}}}},
+      /*ret_def=*/
+      {{"z", "mul:z:0"}});
+  (*square_func.mutable_attr())["_noinline"].set_b(true);
+
+  FunctionDef cube_func = FunctionDefHelper::Create(
+      "MyCube", {"x:T"}, {"z:T"}, {"T: {float, double}"},
+      {{{"square"}, "Mul", {"x", "x"}, {{"T", "$T"}}},
+       {{"cube"}, "Mul", {"square:z", "x"}, {{"T", "$T"}}}},
+      /*ret_def=*/
+      {{"z", "cube:z:0"}});
+  (*cube_func.mutable_attr())["_noinline"].set_b(true);
+
+  FunctionDef double_func = FunctionDefHelper::Create(
+      "MyDouble", {"x:T"}, {"z:T"}, {"T: {float, double}"},
+      {{{"add"}, "AddV2", {"x", "x"}, {{"T", "$T"}}}},
+      /*ret_def=*/
+      {{"z", "add:z:0"}});
+  (*double_func.mutable_attr())["_noinline"].set_b(true);
+
+  GrapplerItem item;
+  item.id = "tf_graph";
+  item.graph = test::function::GDef(
+      {NDef("a", "Placeholder", {}, {{"dtype", DT_FLOAT}}, kDevice),
+       NDef("square", "MySquare", {"a"}, {{"T", DT_FLOAT}}, kDevice),
+       NDef("cube", "MyCube", {"a"}, {{"T", DT_FLOAT}}, kDevice),
+       NDef("double", "MyDouble", {"a"}, {{"T", DT_FLOAT}}, kDevice),
+       NDef("out_s", "Identity", {"square:0"}, {{"T", DT_FLOAT}}, kDevice),
+       NDef("out_c", "Identity", {"cube:0"}, {{"T", DT_FLOAT}}, kDevice),
+       NDef("out_d", "Identity", {"double:0"}, {{"T", DT_FLOAT}}, kDevice)},
+      /*funcs=*/
+      {square_func, cube_func, double_func});
+
+  setenv("TF_GRAPPLER_FUNCTION_OPTIMIZATION_THREADS", "4", /*overwrite=*/1);
+
+  // The optimized library must not depend on the order in which the functions
+  // finish optimizing.
+  GraphDef output;
+  for (int i = 0; i < 4; ++i) {
+    MetaOptimizer optimizer(nullptr, config_proto);
+    GraphDef current_output;
+    TF_EXPECT_OK(optimizer.Optimize(nullptr, item, &current_output));
+    if (i == 0) {
+      output = current_output;
+    } else {
+      CompareGraphs(output, current_output);
+      ASSERT_EQ(output.library().function_size(),
+                current_output.library().function_size());
+      FunctionLibraryDefinition flib(OpRegistry::Global(),
+                                     current_output.library());
+      for (const FunctionDef& func : output.library().function()) {
+        const FunctionDef* current_func = flib.Find(func.signature().name());
+        ASSERT_NE(current_func, nullptr);
+        CompareFunctions(func, *current_func);
+      }
+    }
+  }
+
+  unsetenv("TF_GRAPPLER_FUNCTION_OPTIMIZATION_THREADS");
+
+  FunctionLibraryDefinition optimized_flib(OpRegistry::Global(),
+                                           output.library());
+  EXPECT_EQ(3, optimized_flib.num_functions());
+  for (const NodeDef& node : output.node()) {
+    if (node.name() == "square" || node.name() == "cube" ||
+        node.name() == "double") {
+      EXPECT_NE(optimized_flib.Find(node.op()), nullptr);
+    }
+  }
+
+  item.fetch = {"out_s", "out_c", "out_d"};
+  item.feed.emplace_back("a", test::AsScalar<float>(3.0f));
+  auto tensors_expected = EvaluateFetchNodes(item);
+
+  GrapplerItem optimized = item.WithGraph(std::move(output));
+  auto tensors = EvaluateFetchNodes(optimized);
+
+  ASSERT_EQ(tensors_expected.size(), tensors.size());
+  for (int i = 0; i < tensors.size(); ++i) {
+    test::ExpectTensorEqual<float>(tensors_expected[i], tensors[i]);
+  }
+}
+
 TEST_F(MetaOptimizerTest, OptimizeFunctionLibraryPruneUnusedOutputs) {
   using test::function::NDef;
 
@@ -0,0 +1,207 @@
+/* Copyright 2024 The TensorFlow Authors. All Rights Reserved.
+
+Licensed under the Apache License, Version 2.0 (the "License");
+you may not use this file except in compliance with the License.
+You may obtain a copy of the License at
+
+    http://www.apache.org/licenses/LICENSE-2.0
+
+Unless required by applicable law or agreed to in writing, software
+distributed under the License is distributed on an "AS IS" BASIS,
+WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+See the License for the specific language governing permissions and
+limitations under the License.
+==============================================================================*/
+#include "tensorflow/core/grappler/optimizers/optimization_result_cache.h"
+
+#include <string>
+#include <unordered_map>
+#include <utility>
+#include <vector>
+
+#include "absl/strings/str_cat.h"
+#include "tensorflow/core/framework/tensor.pb.h"
+#include "tensorflow/core/lib/random/random.h"
+#include "tensorflow/core/lib/strings/proto_serialization.h"
+#include "tensorflow/core/platform/fingerprint.h"
+#include "tensorflow/core/platform/logging.h"
+#include "tensorflow/core/platform/path.h"
+#include "tensorflow/core/protobuf/device_properties.pb.h"
+#include "tensorflow/core/util/env_var.h"
+
+namespace tensorflow {
+namespace grappler {
+namespace {
+
+void FingerprintCat(Fprint128* fingerprint, absl::string_view s) {
+  *fingerprint = FingerprintCat128(*fingerprint, Fingerprint128(s));
+}
+
+void FingerprintCat(Fprint128* fingerprint,
+                    const protobuf::MessageLite& proto) {
+  std::string serialized;
+  SerializeToStringDeterministic(proto, &serialized);
+  FingerprintCat(fingerprint, serialized);
+}
+
+void FingerprintCat(Fprint128* fingerprint,
+                    const std::vector<std::string>& strings) {
+  FingerprintCat(fingerprint, absl::StrCat(strings.size()));
+  for (const std::string& s : strings) FingerprintCat(fingerprint, s);
+}
+
+}  // namespace
+
+OptimizationResultCache::OptimizationResultCache(Env* env, int64_t capacity,
+                                                 std::string directory)
+    : env_(env), capacity_(capacity), directory_(std::move(directory)) {}
+
+OptimizationResultCache* OptimizationResultCache::Global() {
+  static OptimizationResultCache* cache = []() -> OptimizationResultCache* {
+    int64_t capacity;
+    Status status = ReadInt64FromEnvVar("TF_GRAPPLER_RESULT_CACHE_CAPACITY",
+                                        /*default_val=*/0, &capacity);
+    if (!status.ok()) {
+      LOG(ERROR) << "Disabling the Grappler result cache: " << status;
+      return nullptr;
+    }
+    if (capacity <= 0) return nullptr;
+    std::string directory;
+    status = ReadStringFromEnvVar("TF_GRAPPLER_RESULT_CACHE_DIR",
+                                  /*default_val=*/"", &directory);
+    if (!status.ok()) {
+      LOG(ERROR) << "Disabling the Grappler result cache: " << status;
+      return nullptr;
+    }
+    return new OptimizationResultCache(Env::Default(), capacity,
+                                       std::move(directory));
+  }();
+  return cache;
+}
+
+std::string OptimizationResultCache::Key(const GrapplerItem& item,
+                                         const Cluster* cluster,
+                                         const ConfigProto& config) {
+  Fprint128 fingerprint = Fingerprint128("grappler_result_cache_v1");
+  FingerprintCat(&fingerprint, item.graph);
+  FingerprintCat(&fingerprint, config);
+
+  FingerprintCat(&fingerprint, item.fetch);
+  FingerprintCat(&fingerprint, absl::StrCat(item.feed.size()));
+  for (const auto& feed : item.feed) {
+    FingerprintCat(&fingerprint, feed.first);
+    TensorProto tensor;
+    feed.second.AsProtoTensorContent(&tensor);
+    FingerprintCat(&fingerprint, tensor);
+  }
+  FingerprintCat(&fingerprint, item.init_ops);
+  FingerprintCat(&fingerprint, item.keep_ops);
+  FingerprintCat(&fingerprint,
+                 absl::StrCat(item.save_op, ";", item.restore_op, ";",
+                              item.save_restore_loc_tensor));
+  for (const QueueRunnerDef& queue_runner : item.queue_runners) {
+    FingerprintCat(&fingerprint, queue_runner);
+  }
+  FingerprintCat(&fingerprint, std::vector<std::string>(item.devices().begin(),
+                                                        item.devices().end()));
+
+  const GrapplerItem::OptimizationOptions& options =
+      item.optimization_options();
+  FingerprintCat(&fingerprint,
+                 absl::StrCat(options.allow_non_differentiable_rewrites,
+                              options.allow_pruning_stateful_and_dataset_ops,
+                              options.optimize_function_library,
+                              options.is_eager_mode, ";",
+                              options.intra_op_parallelism_threads));
+
+  if (cluster != nullptr) {
+    const std::vector<std::string> device_names = cluster->GetDeviceNames();
+    FingerprintCat(&fingerprint, device_names);
+    const std::unordered_map<string, DeviceProperties>& devices =
+        cluster->GetDevices();
+    for (const std::string& device_name : device_names) {
+      FingerprintCat(&fingerprint, devices.at(device_name));
+    }
+  }
+
+  return absl::StrCat(absl::Hex(fingerprint.high64, absl::kZeroPad16),
+                      absl::Hex(fingerprint.low64, absl::kZeroPad16));
+}
+
+bool OptimizationResultCache::Lookup(const std::string& key,
+                                     GraphDef* optimized_graph) {
+  {
+    mutex_lock l(mu_);
+    auto it = index_.find(key);
+    if (it != index_.end()) {
+      entries_.splice(entries_.begin(), entries_, it->second);
+      *optimized_graph = it->second->second;
+      VLOG(2) << "Grappler result cache hit in memory: " << key;
+      return true;
+    }
+  }
+  if (directory_.empty()) return false;
+
+  const std::string filename = Filename(key);
+  if (!env_->FileExists(filename).ok()) return false;
+  GraphDef graph;
+  Status status = ReadBinaryProto(env_, filename, &graph);
+  if (!status.ok()) {
+    LOG(WARNING) << "Failed to read a cached optimized graph from " << filename
+                 << ": " << status;
+    return false;
+  }
+  VLOG(2) << "Grappler result cache hit on disk: " << filename;
+  *optimized_graph = graph;
+  mutex_lock l(mu_);
+  InsertInMemory(key, graph);
+  return true;
+}
+
+void OptimizationResultCache::Insert(const std::string& key,
+                                     const GraphDef& optimized_graph) {
+  {
+    mutex_lock l(mu_);
+    InsertInMemory(key, optimized_graph);
+  }
+  if (directory_.empty()) return;
+
+  // Write to a temporary file first, so that concurrent readers, possibly in
+  // other processes, never see a partially written graph.
+  const std::string filename = Filename(key);
+  const std::string temp_filename =
+      absl::StrCat(filename, ".tmp.", random::New64());
+  Status status = env_->RecursivelyCreateDir(directory_);
+  if (status.ok()) {
+    status = WriteBinaryProto(env_, temp_filename, optimized_graph);
+  }
+  if (status.ok()) status = env_->RenameFile(temp_filename, filename);
+  if (!status.ok()) {
+    LOG(WARNING) << "Failed to write a cached optimized graph to " << filename
+                 << ": " << status;
+    env_->DeleteFile(temp_filename).IgnoreError();
+  }
+}
+
+void OptimizationResultCache::InsertInMemory(const std::string& key,
+                                             const GraphDef& optimized_graph) {
+  auto it = index_.find(key);
+  if (it != index_.end()) {
+    it->second->second = optimized_graph;
+    entries_.splice(entries_.begin(), entries_, it->second);
+    return;
+  }
+  entries_.emplace_front(key, optimized_graph);
+  index_[key] = entries_.begin();
+  while (entries_.size() > capacity_) {
+    index_.erase(entries_.back().first);
+    entries_.pop_back();
+  }
+}
+
+std::string OptimizationResultCache::Filename(const std::string& key) const {
+  return io::JoinPath(directory_, absl::StrCat(key, ".pb"));
+}
+
+}  // namespace grappler
+}  // namespace tensorflow
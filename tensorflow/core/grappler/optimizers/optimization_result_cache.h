@@ -0,0 +1,89 @@
+/* Copyright 2024 The TensorFlow Authors. All Rights Reserved.
+
+Licensed under the Apache License, Version 2.0 (the "License");
+you may not use this file except in compliance with the License.
+You may obtain a copy of the License at
+
+    http://www.apache.org/licenses/LICENSE-2.0
+
+Unless required by applicable law or agreed to in writing, software
+distributed under the License is distributed on an "AS IS" BASIS,
+WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+See the License for the specific language governing permissions and
+limitations under the License.
+==============================================================================*/
+#ifndef TENSORFLOW_CORE_GRAPPLER_OPTIMIZERS_OPTIMIZATION_RESULT_CACHE_H_
+#define TENSORFLOW_CORE_GRAPPLER_OPTIMIZERS_OPTIMIZATION_RESULT_CACHE_H_
+
+#include <list>
+#include <string>
+#include <utility>
+
+#include "absl/container/flat_hash_map.h"
+#include "tensorflow/core/framework/graph.pb.h"
+#include "tensorflow/core/grappler/clusters/cluster.h"
+#include "tensorflow/core/grappler/grappler_item.h"
+#include "tensorflow/core/platform/env.h"
+#include "tensorflow/core/platform/mutex.h"
+#include "tensorflow/core/platform/thread_annotations.h"
+#include "tensorflow/core/protobuf/config.pb.h"
+
+namespace tensorflow {
+namespace grappler {
+
+// A cache of graphs optimized by the meta optimizer, keyed by a fingerprint of
+// everything the optimization depends on. The same items are optimized again
+// for every replica, after every restart and for every retrace of the same
+// graph, and the cache returns the result of the first optimization instead.
+//
+// The cache keeps the `capacity` most recently used graphs in memory. If
+// `directory` is not empty, optimized graphs are also written to it, and graphs
+// missing from memory are read from it, so that they survive restarts.
+class OptimizationResultCache {
+ public:
+  OptimizationResultCache(Env* env, int64_t capacity, std::string directory);
+
+  // Returns the process wide cache configured by the
+  // TF_GRAPPLER_RESULT_CACHE_CAPACITY and TF_GRAPPLER_RESULT_CACHE_DIR
+  // environment variables, or nullptr if the capacity is zero, which is the
+  // default.
+  static OptimizationResultCache* Global();
+
+  // Returns the key for optimizing `item` on `cluster` (may be nullptr) with
+  // `config`. The whole config is fingerprinted, because some optimizers read
+  // options outside of the `RewriterConfig`. Feed tensors are fingerprinted
+  // with their values.
+  static std::string Key(const GrapplerItem& item, const Cluster* cluster,
+                         const ConfigProto& config);
+
+  // Looks up the optimized graph for `key`. Returns false on a miss.
+  bool Lookup(const std::string& key, GraphDef* optimized_graph);
+
+  // Stores the optimized graph for `key`. Persistence failures are logged and
+  // otherwise ignored.
+  void Insert(const std::string& key, const GraphDef& optimized_graph);
+
+ private:
+  using Entry = std::pair<std::string, GraphDef>;
+
+  // Makes `key` the most recently used entry and evicts the least recently
+  // used entries over the capacity.
+  void InsertInMemory(const std::string& key, const GraphDef& optimized_graph)
+      TF_EXCLUSIVE_LOCKS_REQUIRED(mu_);
+  std::string Filename(const std::string& key) const;
+
+  Env* const env_;
+  const int64_t capacity_;
+  const std::string directory_;
+
+  mutex mu_;
+  // Entries in most recently used order.
+  std::list<Entry> entries_ TF_GUARDED_BY(mu_);
+  absl::flat_hash_map<std::string, std::list<Entry>::iterator> index_
+      TF_GUARDED_BY(mu_);
+};
+
+}  // namespace grappler
+}  // namespace tensorflow
+
+#endif  // TENSORFLOW_CORE_GRAPPLER_OPTIMIZERS_OPTIMIZATION_RESULT_CACHE_H_
@@ -0,0 +1,119 @@
+/* Copyright 2024 The TensorFlow Authors. All Rights Reserved.
+
+Licensed under the Apache License, Version 2.0 (the "License");
+you may not use this file except in compliance with the License.
+You may obtain a copy of the License at
+
+    http://www.apache.org/licenses/LICENSE-2.0
+
+Unless required by applicable law or agreed to in writing, software
+distributed under the License is distributed on an "AS IS" BASIS,
+WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+See the License for the specific language governing permissions and
+limitations under the License.
+==============================================================================*/
+#include "tensorflow/core/grappler/optimizers/optimization_result_cache.h"
+
+#include <string>
+
+#include "tensorflow/core/framework/function_testlib.h"
+#include "tensorflow/core/framework/graph.pb.h"
+#include "tensorflow/core/framework/tensor_testutil.h"
+#include "tensorflow/core/grappler/grappler_item.h"
+#include "tensorflow/core/lib/core/status_test_util.h"
+#include "tensorflow/core/platform/env.h"
+#include "tensorflow/core/platform/path.h"
+#include "tensorflow/core/platform/test.h"
+#include "tensorflow/core/protobuf/config.pb.h"
+
+namespace tensorflow {
+namespace grappler {
+namespace {
+
+using test::function::NDef;
+
+GrapplerItem MakeItem() {
+  GrapplerItem item;
+  item.id = "tf_graph";
+  item.graph = test::function::GDef(
+      {NDef("a", "Placeholder", {}, {{"dtype", DT_FLOAT}}),
+       NDef("b", "Identity", {"a"}, {{"T", DT_FLOAT}})},
+      /*funcs=*/{});
+  item.fetch = {"b"};
+  return item;
+}
+
+GraphDef MakeOptimizedGraph(const std::string& name) {
+  return test::function::GDef(
+      {NDef(name, "Placeholder", {}, {{"dtype", DT_FLOAT}})},
+      /*funcs=*/{});
+}
+
+TEST(OptimizationResultCacheTest, KeyDependsOnInputs) {
+  const GrapplerItem item = MakeItem();
+  ConfigProto config;
+  const std::string key = OptimizationResultCache::Key(item, nullptr, config);
+  EXPECT_EQ(key, OptimizationResultCache::Key(MakeItem(), nullptr, config));
+
+  GrapplerItem other_graph = MakeItem();
+  other_graph.graph.mutable_node(1)->set_op("Snapshot");
+  EXPECT_NE(key, OptimizationResultCache::Key(other_graph, nullptr, config));
+
+  GrapplerItem other_fetch = MakeItem();
+  other_fetch.fetch = {"a"};
+  EXPECT_NE(key, OptimizationResultCache::Key(other_fetch, nullptr, config));
+
+  GrapplerItem other_feed = MakeItem();
+  other_feed.feed.emplace_back("a", test::AsScalar<float>(1.0f));
+  EXPECT_NE(key, OptimizationResultCache::Key(other_feed, nullptr, config));
+
+  GrapplerItem other_devices = MakeItem();
+  TF_ASSERT_OK(
+      other_devices.AddDevice("/job:localhost/replica:0/task:0/device:CPU:0"));
+  EXPECT_NE(key, OptimizationResultCache::Key(other_devices, nullptr, config));
+
+  ConfigProto other_config;
+  other_config.mutable_graph_options()
+      ->mutable_rewrite_options()
+      ->set_constant_folding(RewriterConfig::OFF);
+  EXPECT_NE(key, OptimizationResultCache::Key(item, nullptr, other_config));
+}
+
+TEST(OptimizationResultCacheTest, EvictsLeastRecentlyUsed) {
+  OptimizationResultCache cache(Env::Default(), /*capacity=*/2,
+                                /*directory=*/"");
+  cache.Insert("k0", MakeOptimizedGraph("n0"));
+  cache.Insert("k1", MakeOptimizedGraph("n1"));
+
+  GraphDef graph;
+  ASSERT_TRUE(cache.Lookup("k0", &graph));
+  EXPECT_EQ(graph.node(0).name(), "n0");
+
+  // "k1" is the least recently used entry.
+  cache.Insert("k2", MakeOptimizedGraph("n2"));
+  EXPECT_FALSE(cache.Lookup("k1", &graph));
+  ASSERT_TRUE(cache.Lookup("k0", &graph));
+  EXPECT_EQ(graph.node(0).name(), "n0");
+  ASSERT_TRUE(cache.Lookup("k2", &graph));
+  EXPECT_EQ(graph.node(0).name(), "n2");
+}
+
+TEST(OptimizationResultCacheTest, PersistsToDirectory) {
+  const std::string directory =
+      io::JoinPath(testing::TmpDir(), "optimization_result_cache");
+  {
+    OptimizationResultCache cache(Env::Default(), /*capacity=*/1, directory);
+    cache.Insert("k0", MakeOptimizedGraph("n0"));
+  }
+
+  // A new cache, as after a restart, reads the graph from the directory.
+  OptimizationResultCache cache(Env::Default(), /*capacity=*/1, directory);
+  GraphDef graph;
+  ASSERT_TRUE(cache.Lookup("k0", &graph));
+  EXPECT_EQ(graph.node(0).name(), "n0");
+  EXPECT_FALSE(cache.Lookup("k1", &graph));
+}
+
+}  // namespace
+}  // namespace grappler
+}  // namespace tensorflow
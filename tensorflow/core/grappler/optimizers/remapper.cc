@@ -2928,6 +2928,335 @@ bool FindFusedBatchMatMul(RemapperContext* ctx, int node_index,
   return found_op_type_match;
 }
 
+// Returns the input of `consumer_index` that is produced by `producer_index`.
+string RegularFaninFrom(const RemapperContext& ctx, int consumer_index,
+                        int producer_index) {
+  const auto* consumer = ctx.graph_view.GetNode(consumer_index);
+  for (int i = 0; i < consumer->NumRegularFanins(); ++i) {
+    if (consumer->GetRegularFanin(i).node_index() == producer_index) {
+      return consumer->node()->input(i);
+    }
+  }
+  return "";
+}
+
+// Finds the scaled dot-product attention subgraph rooted at `node_index`:
+//
+//   BatchMatMul(Softmax(BatchMatMul(query, key) * scale [+ mask]), value)
+//
+// which can be computed by _FusedScaledDotProductAttention without
+// materializing the scores. Sets the inputs of the fused node in
+// `input_node_names`: query, key, value, scale and the optional mask.
+bool FindScaledDotProductAttention(RemapperContext* ctx, int node_index,
+                                   std::map<string, int>* matched_nodes_map,
+                                   std::set<int>* remove_node_indices,
+                                   std::vector<string>* input_node_names) {
+  const auto* output_node_def = ctx->graph_view.GetNode(node_index)->node();
+  if (!IsAnyBatchMatMul(*output_node_def) || !NodeIsOnCpu(output_node_def) ||
+      !HasDataType(output_node_def, DT_FLOAT)) {
+    return false;
+  }
+
+  using utils::MatchingDirection;
+  using utils::NodeStatus;
+  // clang-format off
+  utils::OpTypePattern masked_pattern =
+    {"BatchMatMul|BatchMatMulV2", "output", NodeStatus::kReplace,
+      {
+        {"Softmax", "softmax", NodeStatus::kRemove,
+          {
+            {"Add|AddV2", "mask_add", NodeStatus::kRemove,
+              {
+                {"Mul", "scale_mul", NodeStatus::kRemove,
+                  {
+                    {"BatchMatMul|BatchMatMulV2", "qk", NodeStatus::kRemove},
+                    {"*", "scale", NodeStatus::kRemain}
+                  }
+                },
+                {"*", "mask", NodeStatus::kRemain}
+              }
+            }
+          }
+        },
+        {"*", "value", NodeStatus::kRemain}
+      }
+    };
+
+  utils::OpTypePattern unmasked_pattern =
+    {"BatchMatMul|BatchMatMulV2", "output", NodeStatus::kReplace,
+      {
+        {"Softmax", "softmax", NodeStatus::kRemove,
+          {
+            {"Mul", "scale_mul", NodeStatus::kRemove,
+              {
+                {"BatchMatMul|BatchMatMulV2", "qk", NodeStatus::kRemove},
+                {"*", "scale", NodeStatus::kRemain}
+              }
+            }
+          }
+        },
+        {"*", "value", NodeStatus::kRemain}
+      }
+    };
+  // clang-format on
+
+  utils::SubGraphMatcher<MatchingDirection::kFollowInputs> graph_matcher(
+      &(ctx->graph_view));
+  matched_nodes_map->clear();
+  remove_node_indices->clear();
+  bool has_mask = graph_matcher.GetMatchedNodes(
+      masked_pattern, ctx->nodes_to_preserve,
+      ctx->graph_view.GetNode(node_index), matched_nodes_map,
+      remove_node_indices);
+  if (!has_mask) {
+    matched_nodes_map->clear();
+    remove_node_indices->clear();
+    if (!graph_matcher.GetMatchedNodes(
+            unmasked_pattern, ctx->nodes_to_preserve,
+            ctx->graph_view.GetNode(node_index), matched_nodes_map,
+            remove_node_indices)) {
+      return false;
+    }
+  }
+
+  const auto node_def = [&](const string& name) {
+    return ctx->graph_view.GetNode(matched_nodes_map->at(name))->node();
+  };
+  const NodeDef* qk_node_def = node_def("qk");
+  for (const NodeDef* batch_matmul : {output_node_def, qk_node_def}) {
+    bool adj_x = false;
+    if (!TryGetNodeAttr(*batch_matmul, "adj_x", &adj_x) || adj_x) return false;
+  }
+  bool output_adj_y = false;
+  if (!TryGetNodeAttr(*output_node_def, "adj_y", &output_adj_y) ||
+      output_adj_y) {
+    return false;
+  }
+  for (const char* name : {"qk", "scale_mul", "softmax"}) {
+    if (!HasDataType(node_def(name), DT_FLOAT)) return false;
+  }
+  if (has_mask && !HasDataType(node_def("mask_add"), DT_FLOAT)) return false;
+
+  if (!ctx->inferred_graph_properties) {
+    Status s = ctx->graph_properties.InferStatically(
+        /*assume_valid_feeds=*/true,
+        /*aggressive_shape_inference=*/false,
+        /*include_input_tensor_values=*/false,
+        /*include_output_tensor_values=*/true);
+    if (!s.ok()) return false;
+    ctx->inferred_graph_properties = true;
+  }
+  const auto input_shape = [&](const NodeDef* node, int port) {
+    const auto& props = ctx->graph_properties.GetInputProperties(node->name());
+    return props.size() > port ? props[port].shape() : TensorShapeProto();
+  };
+  const auto output_shape = [&](const NodeDef* node) {
+    const auto& props =
+        ctx->graph_properties.GetOutputProperties(node->name());
+    return props.empty() ? TensorShapeProto() : props[0].shape();
+  };
+  const auto batch_shape = [](const TensorShapeProto& shape) {
+    TensorShapeProto batch;
+    for (int i = 0; i < shape.dim_size() - 2; ++i) {
+      *batch.add_dim() = shape.dim(i);
+    }
+    return batch;
+  };
+
+  // The fused kernel doesn't broadcast the batch dimensions of the query, key
+  // and value, nor the scores against the scale or the mask.
+  const TensorShapeProto query_shape = input_shape(qk_node_def, 0);
+  const TensorShapeProto key_shape = input_shape(qk_node_def, 1);
+  const TensorShapeProto value_shape = input_shape(output_node_def, 1);
+  const int rank = Rank(query_shape);
+  if (rank < 3 || Rank(key_shape) != rank || Rank(value_shape) != rank) {
+    return false;
+  }
+  const TensorShapeProto query_batch = batch_shape(query_shape);
+  if (!ShapesSymbolicallyEqual(query_batch, batch_shape(key_shape)) ||
+      !ShapesSymbolicallyEqual(query_batch, batch_shape(value_shape))) {
+    return false;
+  }
+  const TensorShapeProto scores_shape = output_shape(qk_node_def);
+  if (NumCoefficients(output_shape(node_def("scale"))) != 1 ||
+      !ShapesSymbolicallyEqual(output_shape(node_def("scale_mul")),
+                               scores_shape)) {
+    return false;
+  }
+  if (has_mask &&
+      (Rank(output_shape(node_def("mask"))) > rank ||
+       !ShapesSymbolicallyEqual(output_shape(node_def("mask_add")),
+                                scores_shape))) {
+    return false;
+  }
+
+  input_node_names->clear();
+  input_node_names->push_back(qk_node_def->input(0));
+  input_node_names->push_back(qk_node_def->input(1));
+  input_node_names->push_back(output_node_def->input(1));
+  input_node_names->push_back(
+      RegularFaninFrom(*ctx, matched_nodes_map->at("scale_mul"),
+                       matched_nodes_map->at("scale")));
+  if (has_mask) {
+    input_node_names->push_back(
+        RegularFaninFrom(*ctx, matched_nodes_map->at("mask_add"),
+                         matched_nodes_map->at("mask")));
+  }
+  for (const string& input : *input_node_names) {
+    if (input.empty()) return false;
+  }
+  return true;
+}
+
+// Finds the image preprocessing subgraph rooted at `node_index`:
+//
+//   [Cast]((ResizeBilinear|CropAndResize(...) - offset) / or * scale)
+//
+// which can be computed by _FusedResizeBilinearAndNormalize or
+// _FusedCropAndResizeAndNormalize without materializing the resized images.
+// The optional Cast rounds the float result to bfloat16. Sets the inputs of
+// the fused node in `input_node_names`: the inputs of the resize, the offset
+// and the scale.
+bool FindResizeAndNormalize(RemapperContext* ctx, int node_index,
+                            std::map<string, int>* matched_nodes_map,
+                            std::set<int>* remove_node_indices,
+                            std::vector<string>* input_node_names) {
+  const auto* root_node_def = ctx->graph_view.GetNode(node_index)->node();
+  if (!IsCast(*root_node_def) && !IsDiv(*root_node_def) &&
+      !IsRealDiv(*root_node_def) && !IsMul(*root_node_def)) {
+    return false;
+  }
+  if (!NodeIsOnCpu(root_node_def)) return false;
+
+  using utils::MatchingDirection;
+  using utils::NodeStatus;
+  // clang-format off
+  utils::OpTypePattern normalize_pattern =
+    {"RealDiv|Div|Mul", "normalize", NodeStatus::kReplace,
+      {
+        {"Sub", "sub", NodeStatus::kRemove,
+          {
+            {"ResizeBilinear|CropAndResize", "resize", NodeStatus::kRemove},
+            {"*", "offset", NodeStatus::kRemain}
+          }
+        },
+        {"*", "scale", NodeStatus::kRemain}
+      }
+    };
+
+  utils::OpTypePattern cast_pattern =
+    {"Cast", "cast", NodeStatus::kReplace,
+      {
+        {"RealDiv|Div|Mul", "normalize", NodeStatus::kRemove,
+          {
+            {"Sub", "sub", NodeStatus::kRemove,
+              {
+                {"ResizeBilinear|CropAndResize", "resize", NodeStatus::kRemove},
+                {"*", "offset", NodeStatus::kRemain}
+              }
+            },
+            {"*", "scale", NodeStatus::kRemain}
+          }
+        }
+      }
+    };
+  // clang-format on
+
+  utils::SubGraphMatcher<MatchingDirection::kFollowInputs> graph_matcher(
+      &(ctx->graph_view));
+  matched_nodes_map->clear();
+  remove_node_indices->clear();
+  const bool has_cast = IsCast(*root_node_def);
+  if (!graph_matcher.GetMatchedNodes(
+          has_cast ? cast_pattern : normalize_pattern, ctx->nodes_to_preserve,
+          ctx->graph_view.GetNode(node_index), matched_nodes_map,
+          remove_node_indices)) {
+    return false;
+  }
+
+  const auto node_def = [&](const string& name) {
+    return ctx->graph_view.GetNode(matched_nodes_map->at(name))->node();
+  };
+  const NodeDef* resize_node_def = node_def("resize");
+  const bool is_crop = resize_node_def->op() == "CropAndResize";
+  DataType resize_type;
+  if (!TryGetNodeAttr(*resize_node_def, "T", &resize_type) ||
+      (resize_type != DT_UINT8 && resize_type != DT_FLOAT)) {
+    return false;
+  }
+  if (is_crop) {
+    string method;
+    if (!TryGetNodeAttr(*resize_node_def, "method", &method) ||
+        method != "bilinear") {
+      return false;
+    }
+  }
+  for (const char* name : {"sub", "normalize"}) {
+    if (!HasDataType(node_def(name), DT_FLOAT)) return false;
+  }
+  if (has_cast) {
+    const NodeDef* cast_node_def = node_def("cast");
+    DataType src_type, dst_type;
+    if (!TryGetNodeAttr(*cast_node_def, "SrcT", &src_type) ||
+        !TryGetNodeAttr(*cast_node_def, "DstT", &dst_type) ||
+        src_type != DT_FLOAT || dst_type != DT_BFLOAT16) {
+      return false;
+    }
+  }
+
+  if (!ctx->inferred_graph_properties) {
+    Status s = ctx->graph_properties.InferStatically(
+        /*assume_valid_feeds=*/true,
+        /*aggressive_shape_inference=*/false,
+        /*include_input_tensor_values=*/false,
+        /*include_output_tensor_values=*/true);
+    if (!s.ok()) return false;
+    ctx->inferred_graph_properties = true;
+  }
+  const auto output_shape = [&](const NodeDef* node) {
+    const auto& props =
+        ctx->graph_properties.GetOutputProperties(node->name());
+    return props.empty() ? TensorShapeProto() : props[0].shape();
+  };
+
+  // The fused kernels only broadcast the offset and the scale along the
+  // channels, which must be known to check it.
+  const TensorShapeProto images_shape = output_shape(resize_node_def);
+  if (Rank(images_shape) != 4 || images_shape.dim(3).size() <= 0) {
+    return false;
+  }
+  const int64_t channels = images_shape.dim(3).size();
+  for (const char* name : {"offset", "scale"}) {
+    const TensorShapeProto shape = output_shape(node_def(name));
+    const int64_t num_coefficients = NumCoefficients(shape);
+    if (Rank(shape) < 0 || Rank(shape) > 4 ||
+        (num_coefficients != 1 &&
+         (num_coefficients != channels ||
+          shape.dim(shape.dim_size() - 1).size() != channels))) {
+      return false;
+    }
+  }
+  for (const char* name : {"sub", "normalize"}) {
+    if (!ShapesSymbolicallyEqual(output_shape(node_def(name)), images_shape)) {
+      return false;
+    }
+  }
+
+  input_node_names->clear();
+  for (int i = 0; i < (is_crop ? 4 : 2); ++i) {
+    input_node_names->push_back(resize_node_def->input(i));
+  }
+  input_node_names->push_back(RegularFaninFrom(
+      *ctx, matched_nodes_map->at("sub"), matched_nodes_map->at("offset")));
+  input_node_names->push_back(
+      RegularFaninFrom(*ctx, matched_nodes_map->at("normalize"),
+                       matched_nodes_map->at("scale")));
+  for (const string& input : *input_node_names) {
+    if (input.empty()) return false;
+  }
+  return true;
+}
+
 // Helper function to check if the reduction axes for a given input
 // shape align with instance normalization's mean computation.
 // Mean reduction axes for instance norm are expected to be:
@@ -4341,6 +4670,87 @@ Status AddFusedBatchMatMul(RemapperContext* ctx,
   return absl::OkStatus();
 }
 
+Status AddFusedScaledDotProductAttention(
+    RemapperContext* ctx, const std::map<string, int>& matched_nodes_map,
+    const std::set<int>& remove_node_indices,
+    const std::vector<string>& input_node_names,
+    std::vector<bool>* invalidated_nodes, std::vector<bool>* nodes_to_delete) {
+  auto* output_node =
+      ctx->graph_view.GetNode(matched_nodes_map.at("output"))->node();
+  auto* qk_node = ctx->graph_view.GetNode(matched_nodes_map.at("qk"))->node();
+
+  NodeDef fused_node;
+  fused_node.set_name(output_node->name());
+  fused_node.set_op("_FusedScaledDotProductAttention");
+  fused_node.set_device(output_node->device());
+  for (const auto& name : input_node_names) fused_node.add_input(name);
+
+  auto* attr = fused_node.mutable_attr();
+  (*attr)["T"] = output_node->attr().at("T");
+  SetAttrValue(qk_node->attr().at("adj_y").b(), &(*attr)["adj_key"]);
+  SetAttrValue(static_cast<int>(input_node_names.size()) - 4,
+               &(*attr)["num_args"]);
+
+  utils::Mutation* mutation = ctx->graph_view.GetMutationBuilder();
+  Status status;
+  mutation->AddNode(std::move(fused_node), &status);
+  TF_RETURN_IF_ERROR(status);
+  TF_RETURN_IF_ERROR(mutation->Apply());
+  (*invalidated_nodes)[matched_nodes_map.at("output")] = true;
+
+  for (const auto& node_idx : remove_node_indices) {
+    (*nodes_to_delete)[node_idx] = true;
+  }
+  return absl::OkStatus();
+}
+
+Status AddFusedResizeAndNormalize(
+    RemapperContext* ctx, const std::map<string, int>& matched_nodes_map,
+    const std::set<int>& remove_node_indices,
+    const std::vector<string>& input_node_names,
+    std::vector<bool>* invalidated_nodes, std::vector<bool>* nodes_to_delete) {
+  const bool has_cast = matched_nodes_map.count("cast") > 0;
+  const int root_index = matched_nodes_map.at(has_cast ? "cast" : "normalize");
+  auto* root_node = ctx->graph_view.GetNode(root_index)->node();
+  auto* normalize_node =
+      ctx->graph_view.GetNode(matched_nodes_map.at("normalize"))->node();
+  auto* resize_node =
+      ctx->graph_view.GetNode(matched_nodes_map.at("resize"))->node();
+  const bool is_crop = resize_node->op() == "CropAndResize";
+
+  NodeDef fused_node;
+  fused_node.set_name(root_node->name());
+  fused_node.set_op(is_crop ? "_FusedCropAndResizeAndNormalize"
+                            : "_FusedResizeBilinearAndNormalize");
+  fused_node.set_device(root_node->device());
+  for (const auto& name : input_node_names) fused_node.add_input(name);
+
+  auto* attr = fused_node.mutable_attr();
+  (*attr)["T"] = resize_node->attr().at("T");
+  SetAttrValue(has_cast ? DT_BFLOAT16 : DT_FLOAT, &(*attr)["out_type"]);
+  SetAttrValue(!IsMul(*normalize_node), &(*attr)["scale_is_divisor"]);
+  if (is_crop) {
+    (*attr)["extrapolation_value"] =
+        resize_node->attr().at("extrapolation_value");
+  } else {
+    (*attr)["align_corners"] = resize_node->attr().at("align_corners");
+    (*attr)["half_pixel_centers"] =
+        resize_node->attr().at("half_pixel_centers");
+  }
+
+  utils::Mutation* mutation = ctx->graph_view.GetMutationBuilder();
+  Status status;
+  mutation->AddNode(std::move(fused_node), &status);
+  TF_RETURN_IF_ERROR(status);
+  TF_RETURN_IF_ERROR(mutation->Apply());
+  (*invalidated_nodes)[root_index] = true;
+
+  for (const auto& node_idx : remove_node_indices) {
+    (*nodes_to_delete)[node_idx] = true;
+  }
+  return absl::OkStatus();
+}
+
 // Helper function to get data of type T from a given tensor and
 // return them in a vector and casted to type U.
 // Note - use this function only when type cast is safe from T to U.
@@ -5037,9 +5447,35 @@ Status Remapper::Optimize(Cluster* cluster, const GrapplerItem& item,
       }
     }
 
-    // Remap MatMul + BiasAdd + gelu-subgraph
+    // Remap BatchMatMul+Mul+(Add)+Softmax+BatchMatMul into the
+    // _FusedScaledDotProductAttention.
     std::map<string, int> matched_nodes_map;
     std::set<int> remove_node_indices;
+    std::vector<string> input_node_names;
+    if (allow_non_differentiable_rewrites &&
+        FindScaledDotProductAttention(&ctx, i, &matched_nodes_map,
+                                      &remove_node_indices,
+                                      &input_node_names)) {
+      TF_RETURN_IF_ERROR(AddFusedScaledDotProductAttention(
+          &ctx, matched_nodes_map, remove_node_indices, input_node_names,
+          &invalidated_nodes, &nodes_to_delete));
+      continue;
+    }
+
+    // Remap ResizeBilinear/CropAndResize+Sub+Div/Mul+(Cast) into the
+    // _FusedResizeBilinearAndNormalize or _FusedCropAndResizeAndNormalize.
+    if (allow_non_differentiable_rewrites &&
+        FindResizeAndNormalize(&ctx, i, &matched_nodes_map,
+                               &remove_node_indices, &input_node_names)) {
+      TF_RETURN_IF_ERROR(AddFusedResizeAndNormalize(
+          &ctx, matched_nodes_map, remove_node_indices, input_node_names,
+          &invalidated_nodes, &nodes_to_delete));
+      continue;
+    }
+
+    // Remap MatMul + BiasAdd + gelu-subgraph
+    matched_nodes_map.clear();
+    remove_node_indices.clear();
     bool is_gelu_approximate = false;
     if (FindMatMulBiasAddAndGelu(&ctx, i, cluster, &matched_nodes_map,
                                  &remove_node_indices, &is_gelu_approximate)) {
@@ -1490,6 +1490,196 @@ TEST_F(RemapperTest, FuseMatmulWithAdd) {
   test::ExpectClose(tensors[0], tensors_expected[0], 1e-6);
 }
 
+TEST_F(RemapperTest, FuseScaledDotProductAttention) {
+  using ::tensorflow::ops::Placeholder;
+  tensorflow::Scope s = tensorflow::Scope::NewRootScope();
+
+  auto query_shape = ops::Placeholder::Shape({2, 4, 16, 8});
+  auto key_shape = ops::Placeholder::Shape({2, 4, 160, 8});
+  auto value_shape = ops::Placeholder::Shape({2, 4, 160, 8});
+  auto mask_shape = ops::Placeholder::Shape({2, 1, 1, 160});
+
+  auto query = Placeholder(s.WithOpName("query"), DT_FLOAT, query_shape);
+  auto key = Placeholder(s.WithOpName("key"), DT_FLOAT, key_shape);
+  auto value = Placeholder(s.WithOpName("value"), DT_FLOAT, value_shape);
+  auto mask = Placeholder(s.WithOpName("mask"), DT_FLOAT, mask_shape);
+
+  auto scores = ops::BatchMatMulV2(s.WithOpName("scores"), query, key,
+                                   ops::BatchMatMulV2::AdjY(true));
+  auto scale = ops::Const(s.WithOpName("scale"), 0.35f, {});
+  auto scaled = ops::Mul(s.WithOpName("scaled"), scores, scale);
+  auto masked = ops::AddV2(s.WithOpName("masked"), scaled, mask);
+  auto softmax = ops::Softmax(s.WithOpName("softmax"), masked);
+  auto attention =
+      ops::BatchMatMulV2(s.WithOpName("attention"), softmax, value);
+  auto fetch = ops::Identity(s.WithOpName("fetch"), attention);
+
+  auto query_t = GenerateRandomTensor<DT_FLOAT>({2, 4, 16, 8});
+  auto key_t = GenerateRandomTensor<DT_FLOAT>({2, 4, 160, 8});
+  auto value_t = GenerateRandomTensor<DT_FLOAT>({2, 4, 160, 8});
+  auto mask_t = GenerateRandomTensor<DT_FLOAT>({2, 1, 1, 160});
+
+  GrapplerItem item;
+  item.fetch = {"fetch"};
+  item.feed = {{"query", query_t},
+               {"key", key_t},
+               {"value", value_t},
+               {"mask", mask_t}};
+  TF_ASSERT_OK(s.ToGraphDef(&item.graph));
+
+  // Place all nodes on CPU.
+  for (int i = 0; i < item.graph.node_size(); ++i) {
+    item.graph.mutable_node(i)->set_device("/device:CPU:0");
+  }
+
+  Remapper optimizer(RewriterConfig::ON);
+  GraphDef output;
+  TF_ASSERT_OK(optimizer.Optimize(nullptr, item, &output));
+
+  int found = 0;
+  for (const NodeDef& node : output.node()) {
+    if (node.name() == "attention") {
+      EXPECT_EQ(node.op(), "_FusedScaledDotProductAttention");
+      ASSERT_EQ(node.input_size(), 5);
+      EXPECT_EQ(node.input(0), "query");
+      EXPECT_EQ(node.input(1), "key");
+      EXPECT_EQ(node.input(2), "value");
+      EXPECT_EQ(node.input(3), "scale");
+      EXPECT_EQ(node.input(4), "mask");
+      EXPECT_TRUE(node.attr().at("adj_key").b());
+      EXPECT_EQ(node.attr().at("num_args").i(), 1);
+      found++;
+    }
+    EXPECT_NE(node.op(), "Softmax");
+  }
+  EXPECT_EQ(1, found);
+
+  auto tensors_expected = EvaluateNodes(item.graph, item.fetch, item.feed);
+  ASSERT_EQ(tensors_expected.size(), 1);
+  auto tensors = EvaluateNodes(output, item.fetch, item.feed);
+  ASSERT_EQ(tensors.size(), 1);
+  test::ExpectClose(tensors[0], tensors_expected[0], 1e-5, 1e-4);
+}
+
+TEST_F(RemapperTest, FuseResizeBilinearAndNormalize) {
+  using ::tensorflow::ops::Placeholder;
+  tensorflow::Scope s = tensorflow::Scope::NewRootScope();
+
+  auto images_shape = ops::Placeholder::Shape({2, 12, 10, 3});
+  auto images = Placeholder(s.WithOpName("images"), DT_UINT8, images_shape);
+  auto size = ops::Const(s.WithOpName("size"), {16, 20}, {2});
+  auto resize = ops::ResizeBilinear(
+      s.WithOpName("resize"), images, size,
+      ops::ResizeBilinear::HalfPixelCenters(true));
+  auto offset = ops::Const(s.WithOpName("offset"), {123.7f, 116.3f, 103.5f},
+                           {1, 1, 1, 3});
+  auto scale = ops::Const(s.WithOpName("scale"), {58.4f, 57.1f, 57.4f}, {3});
+  auto sub = ops::Sub(s.WithOpName("sub"), resize, offset);
+  auto normalize = ops::RealDiv(s.WithOpName("normalize"), sub, scale);
+  auto cast = ops::Cast(s.WithOpName("cast"), normalize, DT_BFLOAT16);
+  auto fetch = ops::Identity(s.WithOpName("fetch"), cast);
+
+  Tensor images_t(DT_UINT8, TensorShape({2, 12, 10, 3}));
+  images_t.flat<uint8>().setRandom();
+
+  GrapplerItem item;
+  item.fetch = {"fetch"};
+  item.feed = {{"images", images_t}};
+  TF_ASSERT_OK(s.ToGraphDef(&item.graph));
+
+  // Place all nodes on CPU.
+  for (int i = 0; i < item.graph.node_size(); ++i) {
+    item.graph.mutable_node(i)->set_device("/device:CPU:0");
+  }
+
+  Remapper optimizer(RewriterConfig::ON);
+  GraphDef output;
+  TF_ASSERT_OK(optimizer.Optimize(nullptr, item, &output));
+
+  int found = 0;
+  for (const NodeDef& node : output.node()) {
+    if (node.name() == "cast") {
+      EXPECT_EQ(node.op(), "_FusedResizeBilinearAndNormalize");
+      ASSERT_EQ(node.input_size(), 4);
+      EXPECT_EQ(node.input(0), "images");
+      EXPECT_EQ(node.input(1), "size");
+      EXPECT_EQ(node.input(2), "offset");
+      EXPECT_EQ(node.input(3), "scale");
+      EXPECT_EQ(node.attr().at("out_type").type(), DT_BFLOAT16);
+      EXPECT_TRUE(node.attr().at("half_pixel_centers").b());
+      EXPECT_TRUE(node.attr().at("scale_is_divisor").b());
+      found++;
+    }
+    EXPECT_NE(node.op(), "ResizeBilinear");
+  }
+  EXPECT_EQ(1, found);
+
+  auto tensors_expected = EvaluateNodes(item.graph, item.fetch, item.feed);
+  ASSERT_EQ(tensors_expected.size(), 1);
+  auto tensors = EvaluateNodes(output, item.fetch, item.feed);
+  ASSERT_EQ(tensors.size(), 1);
+  test::ExpectTensorEqual<bfloat16>(tensors[0], tensors_expected[0]);
+}
+
+TEST_F(RemapperTest, FuseCropAndResizeAndNormalize) {
+  using ::tensorflow::ops::Placeholder;
+  tensorflow::Scope s = tensorflow::Scope::NewRootScope();
+
+  auto image_shape = ops::Placeholder::Shape({2, 12, 10, 3});
+  auto image = Placeholder(s.WithOpName("image"), DT_FLOAT, image_shape);
+  auto boxes = ops::Const(s.WithOpName("boxes"),
+                          {0.1f, 0.2f, 0.8f, 0.9f, -0.1f, 0.0f, 0.5f, 1.2f},
+                          {2, 4});
+  auto box_ind = ops::Const(s.WithOpName("box_ind"), {1, 0}, {2});
+  auto crop_size = ops::Const(s.WithOpName("crop_size"), {7, 5}, {2});
+  auto crop = ops::CropAndResize(s.WithOpName("crop"), image, boxes, box_ind,
+                                 crop_size);
+  auto offset = ops::Const(s.WithOpName("offset"), 0.5f, {});
+  auto scale = ops::Const(s.WithOpName("scale"), {2.0f, 4.0f, 8.0f}, {3});
+  auto sub = ops::Sub(s.WithOpName("sub"), crop, offset);
+  auto normalize = ops::Mul(s.WithOpName("normalize"), scale, sub);
+  auto fetch = ops::Identity(s.WithOpName("fetch"), normalize);
+
+  auto image_t = GenerateRandomTensor<DT_FLOAT>({2, 12, 10, 3});
+
+  GrapplerItem item;
+  item.fetch = {"fetch"};
+  item.feed = {{"image", image_t}};
+  TF_ASSERT_OK(s.ToGraphDef(&item.graph));
+
+  // Place all nodes on CPU.
+  for (int i = 0; i < item.graph.node_size(); ++i) {
+    item.graph.mutable_node(i)->set_device("/device:CPU:0");
+  }
+
+  Remapper optimizer(RewriterConfig::ON);
+  GraphDef output;
+  TF_ASSERT_OK(optimizer.Optimize(nullptr, item, &output));
+
+  int found = 0;
+  for (const NodeDef& node : output.node()) {
+    if (node.name() == "normalize") {
+      EXPECT_EQ(node.op(), "_FusedCropAndResizeAndNormalize");
+      ASSERT_EQ(node.input_size(), 6);
+      EXPECT_EQ(node.input(0), "image");
+      EXPECT_EQ(node.input(3), "crop_size");
+      EXPECT_EQ(node.input(4), "offset");
+      EXPECT_EQ(node.input(5), "scale");
+      EXPECT_EQ(node.attr().at("out_type").type(), DT_FLOAT);
+      EXPECT_FALSE(node.attr().at("scale_is_divisor").b());
+      found++;
+    }
+    EXPECT_NE(node.op(), "CropAndResize");
+  }
+  EXPECT_EQ(1, found);
+
+  auto tensors_expected = EvaluateNodes(item.graph, item.fetch, item.feed);
+  ASSERT_EQ(tensors_expected.size(), 1);
+  auto tensors = EvaluateNodes(output, item.fetch, item.feed);
+  ASSERT_EQ(tensors.size(), 1);
+  test::ExpectClose(tensors[0], tensors_expected[0], 1e-6, 1e-6);
+}
+
 class RemapperFuseSoftplusTanhMul : public RemapperTest {
  public:
   template <DataType DTYPE>
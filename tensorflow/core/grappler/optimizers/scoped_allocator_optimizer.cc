@@ -25,6 +25,7 @@ limitations under the License.
 #include "tensorflow/core/grappler/op_types.h"
 #include "tensorflow/core/grappler/utils/frame.h"
 #include "tensorflow/core/lib/gtl/inlined_vector.h"
+#include "tensorflow/core/util/device_name_utils.h"
 
 // Like TF_RETURN_IF_ERROR, but also logs a WARNING.
 #define LOG_WARNING_AND_RETURN_IF_ERROR(...)            \
@@ -512,9 +513,8 @@ class UnaryElementwiseRewriter : public ScopedAllocatorOptimizer::Rewriter {
   // the output tensors of the input node set.
   Status ConstructScopedAllocatorNode(
       ScopedAllocatorOptimizer* sa_opti, GraphDef* graph, NodeMap* node_map,
-      const std::vector<NodeDef*>& ops, const string& device_name,
-      DataType dtype, int sa_id, const string& sa_name,
-      const std::vector<TensorShape>& input_shapes,
+      const string& device_name, DataType dtype, int sa_id,
+      const string& sa_name, const std::vector<TensorShape>& input_shapes,
       const std::vector<InputDesc>& inputs, const TensorShape& sa_shape) {
     VLOG(2) << "ConstructScopedAllocatorNode " << sa_name;
     NodeDefBuilder sa_builder(sa_name, "_ScopedAllocator");
@@ -524,7 +524,8 @@ class UnaryElementwiseRewriter : public ScopedAllocatorOptimizer::Rewriter {
     sa_builder.Attr("id", sa_id);
     sa_builder.Attr("shapes", input_shapes);
     sa_builder.Attr("shape", sa_shape);
-    sa_builder.Attr("expected_call_count", static_cast<int64_t>(ops.size()));
+    sa_builder.Attr("expected_call_count",
+                    static_cast<int64_t>(inputs.size()));
     NodeDef* sa_node = graph->add_node();
     LOG_WARNING_AND_RETURN_IF_ERROR(sa_builder.Finalize(sa_node));
     node_map->AddNode(sa_name, sa_node);
@@ -855,7 +856,7 @@ class UnaryElementwiseRewriter : public ScopedAllocatorOptimizer::Rewriter {
     string sa_name =
         strings::StrCat("scoped_allocator_", sa_id, "_", invocation_count);
     TF_RETURN_IF_ERROR(ConstructScopedAllocatorNode(
-        sa_opti, graph, node_map, ops, device_name, dtype, sa_id, sa_name,
+        sa_opti, graph, node_map, device_name, dtype, sa_id, sa_name,
         input_shapes, inputs, sa_shape));
 
     // Build a ScopedAllocatorConcat below all of the input nodes.
@@ -889,12 +890,288 @@ class UnaryElementwiseRewriter : public ScopedAllocatorOptimizer::Rewriter {
   }
 };
 
+// Rewrites each instance of a CPU Concat, ConcatV2, Pack or ParallelConcat
+// along axis 0 so that the producers of its inputs allocate their outputs
+// directly in their slices of the output, and nothing is copied.  The inputs
+// are allocated from a new ScopedAllocator whose backing tensor becomes the
+// output of a _ScopedAllocatorConcat with the shape of the concatenation.  The
+// original node is turned into an Identity of the _ScopedAllocatorConcat, so
+// that its consumers and fetches are unchanged.
+//
+// Since a ScopedAllocator pads each of its fields to kAllocatorAlignment, the
+// backing tensor is only a valid concatenation if the size of every input is a
+// multiple of kAllocatorAlignment bytes.  Each input must also be fully
+// defined, and be produced on the same device by an op that allocates it in
+// every step and does not pass it to any other op.  Instances that do not
+// qualify are left unchanged.
+class ConcatRewriter : public UnaryElementwiseRewriter {
+ public:
+  ~ConcatRewriter() override {}
+
+  bool RewritesSingleNodes() const override { return true; }
+
+  Status Rewrite(ScopedAllocatorOptimizer* sa_opti, int64_t invocation_count,
+                 GraphDef* graph, const string& op_name,
+                 const std::vector<NodeDef*>& ops, bool* applied) override {
+    for (NodeDef* op : ops) {
+      ConcatDesc desc;
+      Status s = AnalyzeConcat(sa_opti->node_map(), op, &desc);
+      if (!s.ok()) {
+        VLOG(1) << "ConcatRewriter not rewriting " << op->name() << ": " << s;
+        continue;
+      }
+      TF_RETURN_IF_ERROR(
+          RewriteConcat(sa_opti, invocation_count, graph, op, desc));
+      *applied = true;
+    }
+    return absl::OkStatus();
+  }
+
+ private:
+  struct ConcatDesc {
+    DataType dtype = DT_INVALID;
+    std::vector<InputDesc> inputs;
+    std::vector<TensorShape> input_shapes;
+    TensorShape output_shape;
+  };
+
+  // Returns true iff `op` is the only use of output `output_slot` of
+  // `producer`.
+  bool IsOnlyUse(NodeMap* node_map, const NodeDef& producer, int output_slot,
+                 const NodeDef& op) {
+    int num_uses = 0;
+    for (const NodeDef* consumer : node_map->GetOutputs(producer.name())) {
+      for (const string& input : consumer->input()) {
+        int position = 0;
+        if (ParseNodeNameAsStringPiece(input, &position) == producer.name() &&
+            position == output_slot) {
+          ++num_uses;
+        }
+      }
+    }
+    return num_uses == 1;
+  }
+
+  // Reads the constant axis of a Concat or ConcatV2 from `axis_input`.
+  Status GetConstantAxis(NodeMap* node_map, const string& axis_input,
+                         int64_t* axis) {
+    const NodeDef* axis_node = node_map->GetNode(axis_input);
+    if (axis_node == nullptr || !IsConstant(*axis_node)) {
+      return errors::Aborted("Axis ", axis_input, " is not a constant");
+    }
+    Tensor axis_tensor;
+    TF_RETURN_IF_ERROR(GetNodeAttr(*axis_node, "value", &axis_tensor));
+    if (axis_tensor.NumElements() != 1) {
+      return errors::Aborted("Axis ", axis_input, " is not a scalar");
+    }
+    *axis = axis_tensor.dtype() == DT_INT32
+                ? axis_tensor.flat<int32>()(0)
+                : axis_tensor.flat<int64_t>()(0);
+    return absl::OkStatus();
+  }
+
+  // Returns OK and populates *desc iff `op` can be rewritten.
+  Status AnalyzeConcat(NodeMap* node_map, NodeDef* op, ConcatDesc* desc) {
+    CHECK(graph_properties_);
+    DeviceNameUtils::ParsedName parsed_device;
+    if (!DeviceNameUtils::ParseFullName(op->device(), &parsed_device) ||
+        parsed_device.type != DEVICE_CPU) {
+      return errors::Aborted("Not placed on a CPU device");
+    }
+    TF_RETURN_IF_ERROR(GetNodeAttr(*op, "T", &desc->dtype));
+    const int dtype_size = DataTypeSize(desc->dtype);
+    if (dtype_size == 0 || Allocator::kAllocatorAlignment % dtype_size != 0) {
+      return errors::Aborted("Unsupported type ",
+                             DataTypeString(desc->dtype));
+    }
+    int num_values = 0;
+    TF_RETURN_IF_ERROR(GetNodeAttr(*op, "N", &num_values));
+    if (num_values < 2) {
+      return errors::Aborted("Fewer than 2 inputs");
+    }
+
+    // Find the data inputs that hold the values, and the axis.
+    int first_value = 0;
+    int64_t axis = 0;
+    if (op->op() == "Concat") {
+      first_value = 1;
+      TF_RETURN_IF_ERROR(GetConstantAxis(node_map, op->input(0), &axis));
+    } else if (op->op() == "ConcatV2") {
+      if (op->input_size() <= num_values) {
+        return errors::Aborted("Missing axis input");
+      }
+      TF_RETURN_IF_ERROR(
+          GetConstantAxis(node_map, op->input(num_values), &axis));
+    } else if (op->op() == "Pack") {
+      TF_RETURN_IF_ERROR(GetNodeAttr(*op, "axis", &axis));
+    }
+    if (op->input_size() < first_value + num_values) {
+      return errors::Aborted("Missing value inputs");
+    }
+
+    if (!graph_properties_->HasInputProperties(op->name())) {
+      return errors::Aborted("Input shapes not known");
+    }
+    const std::vector<OpInfo::TensorProperties>& input_props =
+        graph_properties_->GetInputProperties(op->name());
+    if (input_props.size() < first_value + num_values) {
+      return errors::Aborted("Input shapes not known");
+    }
+    for (int i = first_value; i < first_value + num_values; ++i) {
+      const OpInfo::TensorProperties& props = input_props[i];
+      if (props.dtype() != desc->dtype ||
+          !TensorShape::IsValid(props.shape()) ||
+          props.shape().unknown_rank()) {
+        return errors::Aborted("Complete shape not known for input ", i);
+      }
+      TensorShape shape(props.shape());
+      const int64_t num_bytes = shape.num_elements() * dtype_size;
+      if (num_bytes == 0 || num_bytes % Allocator::kAllocatorAlignment != 0) {
+        return errors::Aborted("Input ", i, " of ", num_bytes,
+                               " bytes would be padded");
+      }
+      if (!desc->input_shapes.empty() &&
+          !ShapesAreConcatenable(op->op() == "Pack",
+                                 desc->input_shapes.front(), shape)) {
+        return errors::Aborted("Incompatible shape for input ", i);
+      }
+      desc->input_shapes.push_back(shape);
+
+      const string& input_name = op->input(i);
+      if (IsControlInput(input_name)) {
+        return errors::Aborted("Missing value inputs");
+      }
+      int output_slot = 0;
+      ParseNodeName(input_name, &output_slot);
+      NodeDef* producer = node_map->GetNode(input_name);
+      if (producer == nullptr) {
+        return errors::Internal("Did not find node ", input_name);
+      }
+      if (IsConstant(*producer) || IsArg(*producer) ||
+          IsVariable(*producer)) {
+        return errors::Aborted("Input ", input_name,
+                               " is not allocated in every step");
+      }
+      if (producer->device() != op->device()) {
+        return errors::Aborted("Input ", input_name,
+                               " is produced on another device");
+      }
+      if (!IsOnlyUse(node_map, *producer, output_slot, *op)) {
+        return errors::Aborted("Input ", input_name, " has other uses");
+      }
+      desc->inputs.emplace_back(producer, output_slot, op);
+    }
+    TF_RETURN_IF_ERROR(CheckExistingScopedAllocator(desc->inputs));
+
+    // Pack inserts a new dimension, while the concatenating ops extend the
+    // first one.  ParallelConcat always concatenates along the first
+    // dimension.
+    desc->output_shape = desc->input_shapes.front();
+    if (op->op() == "Pack") {
+      desc->output_shape.InsertDim(0, num_values);
+    } else {
+      if (desc->output_shape.dims() == 0) {
+        return errors::Aborted("Cannot concatenate scalars");
+      }
+      int64_t dim0 = 0;
+      for (const TensorShape& shape : desc->input_shapes) {
+        dim0 += shape.dim_size(0);
+      }
+      desc->output_shape.set_dim(0, dim0);
+    }
+    if (axis < 0) axis += desc->output_shape.dims();
+    if (axis != 0) {
+      return errors::Aborted("Not along the first dimension");
+    }
+    return absl::OkStatus();
+  }
+
+  // Returns true iff `a` and `b` can be packed together, or, if `pack` is
+  // false, concatenated along the first dimension.
+  bool ShapesAreConcatenable(bool pack, const TensorShape& a,
+                             const TensorShape& b) {
+    if (pack || a.dims() == 0) return a == b;
+    if (a.dims() != b.dims()) return false;
+    for (int d = 1; d < a.dims(); ++d) {
+      if (a.dim_size(d) != b.dim_size(d)) return false;
+    }
+    return true;
+  }
+
+  Status RewriteConcat(ScopedAllocatorOptimizer* sa_opti,
+                       int64_t invocation_count, GraphDef* graph, NodeDef* op,
+                       const ConcatDesc& desc) {
+    VLOG(1) << "ConcatRewriter::Rewrite " << op->name();
+    NodeMap* node_map = sa_opti->node_map();
+    // None of the fields are padded, so the backing tensor holds exactly the
+    // elements of the output.
+    const TensorShape sa_shape({desc.output_shape.num_elements()});
+    const int sa_id = sa_opti->NewScopedAllocatorId(desc.inputs.size());
+    const string sa_name =
+        strings::StrCat("scoped_allocator_", sa_id, "_", invocation_count);
+    TF_RETURN_IF_ERROR(ConstructScopedAllocatorNode(
+        sa_opti, graph, node_map, op->device(), desc.dtype, sa_id, sa_name,
+        desc.input_shapes, desc.inputs, sa_shape));
+
+    const string sac_name = strings::StrCat("scoped_allocator_concat_", sa_id,
+                                            "_", invocation_count);
+    std::vector<NodeDefBuilder::NodeOut> sac_inputs;
+    for (const InputDesc& input : desc.inputs) {
+      sac_inputs.emplace_back(input.from_node_def->name(), input.output_slot,
+                              desc.dtype);
+    }
+    NodeDefBuilder sac_builder(sac_name, "_ScopedAllocatorConcat");
+    sac_builder.Device(op->device());
+    sac_builder.Attr("sa_name", sa_name);
+    sac_builder.Attr("id", sa_id);
+    sac_builder.Attr("T", desc.dtype);
+    sac_builder.Attr("shape", desc.output_shape);
+    sac_builder.Attr("reshape", true);
+    sac_builder.Attr("N", static_cast<int>(sac_inputs.size()));
+    sac_builder.Input(NodeDefBuilder::NodeOut(sa_name, 0, desc.dtype));
+    sac_builder.Input(sac_inputs);
+    NodeDef* sac_node = graph->add_node();
+    LOG_WARNING_AND_RETURN_IF_ERROR(sac_builder.Finalize(sac_node));
+    node_map->AddNode(sac_name, sac_node);
+    node_map->AddOutput(sa_name, sac_name);
+    for (const InputDesc& input : desc.inputs) {
+      node_map->AddOutput(input.from_node_def->name(), sac_name);
+    }
+
+    // Turn the original node into an Identity of the new concat, keeping its
+    // control inputs and internal attributes.
+    std::vector<string> control_inputs;
+    for (const string& input : op->input()) {
+      if (IsControlInput(input)) {
+        control_inputs.push_back(input);
+      }
+    }
+    node_map->RemoveInputs(op->name());
+    op->clear_input();
+    op->set_op("Identity");
+    for (const char* attr_name : {"N", "Tidx", "axis", "shape"}) {
+      op->mutable_attr()->erase(attr_name);
+    }
+    op->add_input(sac_name);
+    node_map->AddOutput(sac_name, op->name());
+    for (const string& input : control_inputs) {
+      op->add_input(input);
+      node_map->AddOutput(NodeName(input), op->name());
+    }
+    return absl::OkStatus();
+  }
+};
+
 ScopedAllocatorOptimizer::ScopedAllocatorOptimizer(
     RewriterConfig::Toggle opt_level, const ScopedAllocatorOptions& opts)
     : opt_level_(opt_level) {
   VLOG(1) << "ScopedAllocatorOptimizer::ScopedAllocatorOptimizer";
   Rewriter* r = new UnaryElementwiseRewriter();
   to_delete_.push_back(r);
+  Rewriter* concat_rewriter = new ConcatRewriter();
+  to_delete_.push_back(concat_rewriter);
+  const absl::flat_hash_set<string> concat_ops = {"Concat", "ConcatV2", "Pack",
+                                                  "ParallelConcat"};
   if (opts.enable_op_size() == 0) {
     // Opts handled by default:
     for (const auto& op_name : {"CollectiveReduce"}) {
@@ -904,7 +1181,8 @@ ScopedAllocatorOptimizer::ScopedAllocatorOptimizer(
   } else {
     for (const auto& op_name : opts.enable_op()) {
       op_name_set_.insert(op_name);
-      rewriters_[op_name] = r;
+      rewriters_[op_name] =
+          concat_ops.contains(op_name) ? concat_rewriter : r;
     }
   }
 }
@@ -1110,6 +1388,20 @@ Status ScopedAllocatorOptimizer::ProcessGraphDef(
           continue;
         }
         rewriter->SetGraphProperties(graph_properties);
+        if (rewriter->RewritesSingleNodes()) {
+          // ScopedAllocators are not supported within loops.
+          std::vector<NodeDef*> nodes;
+          for (NodeDef* n : it.second) {
+            if (!frame_view.IsInFrame(*n)) nodes.push_back(n);
+          }
+          bool applied = false;
+          status = rewriter->Rewrite(this, invocation_count, graph, op_name,
+                                     nodes, &applied);
+          if (!status.ok()) {
+            break;
+          }
+          continue;
+        }
         std::unique_ptr<Tree> root(ComputeScopeTree(it.first, it.second));
         // Record outputs that are inputs to multiple Tree nodes.
         absl::flat_hash_set<string> seen_outputs;
@@ -93,6 +93,10 @@ class ScopedAllocatorOptimizer : public GraphOptimizer {
                            const std::vector<NodeDef*>& nodes,
                            bool* applied) = 0;
 
+    // Returns true if this Rewriter rewrites every instance of its op
+    // independently, rather than groups of logically parallel instances.
+    virtual bool RewritesSingleNodes() const { return false; }
+
     void SetGraphProperties(const GraphProperties& graph_properties) {
       graph_properties_ = &graph_properties;
       CHECK(graph_properties_);
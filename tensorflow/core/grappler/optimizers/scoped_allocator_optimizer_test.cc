@@ -267,6 +267,36 @@ class ScopedAllocatorOptimizerTest : public ::testing::Test {
     TF_CHECK_OK(s.ToGraphDef(graph_def));
   }
 
+  // Constructs a graph that concatenates along axis 0, or packs if `pack` is
+  // true, the sum and the difference of two [4, dim] float tensors.
+  /*
+        a    b
+        |\  /|
+        | \/ |
+        | /\ |
+        s1   s2
+         \  /
+          c
+  */
+  void BuildConcatGraph(GraphDef* graph_def, bool pack, int dim) {
+    Scope s = Scope::NewRootScope();
+    s = s.WithDevice("/job:localhost/replica:0/task:0/device:CPU:0");
+
+    std::vector<float> a_values(4 * dim);
+    for (int i = 0; i < a_values.size(); ++i) a_values[i] = i;
+    Output a = ops::Const<float>(s.WithOpName("a"), a_values, {4, dim});
+    Output b = ops::Const<float>(s.WithOpName("b"),
+                                 std::vector<float>(4 * dim, 1.0), {4, dim});
+    Output s1 = ops::Add(s.WithOpName("s1"), a, b);
+    Output s2 = ops::Sub(s.WithOpName("s2"), a, b);
+    if (pack) {
+      ops::Stack(s.WithOpName("c"), {s1, s2});
+    } else {
+      ops::Concat(s.WithOpName("c"), {s1, s2}, 0);
+    }
+    TF_CHECK_OK(s.ToGraphDef(graph_def));
+  }
+
   void SetShapes(GraphDef* graph_def) {
     TensorShapeProto shape_proto;
     shape_proto.add_dim()->set_size(2);
@@ -283,7 +313,8 @@ class ScopedAllocatorOptimizerTest : public ::testing::Test {
   // returns the outputs specified by `output_names` in `outputs`.
   void ExecuteGraph(const GraphDef& graph_def,
                     const std::vector<string>& output_names,
-                    std::vector<Tensor>* outputs) {
+                    std::vector<Tensor>* outputs,
+                    const string& enable_op = "Abs") {
     // Turn off all optimization except the ScopedAllocatorOptimizer
     // to avoid anything that would alter the expected graph input/output,
     // e.g. by constant folding away all calculations.
@@ -297,7 +328,7 @@ class ScopedAllocatorOptimizerTest : public ::testing::Test {
     RewriterConfig* rwcfg = gopt->mutable_rewrite_options();
     rwcfg->clear_optimizers();
     (*rwcfg->add_optimizers()) = "scoped_allocator";
-    rwcfg->mutable_scoped_allocator_opts()->add_enable_op("Abs");
+    rwcfg->mutable_scoped_allocator_opts()->add_enable_op(enable_op);
     std::unique_ptr<Session> session(CreateSession(graph_def, config));
 
     std::vector<std::pair<string, Tensor>> inputs;
@@ -596,6 +627,84 @@ TEST_F(ScopedAllocatorOptimizerTest, ConstInput) {
   }
   EXPECT_EQ(num_identity_ops, 2);
 }
+
+// Test that a concatenation of inputs whose sizes are multiples of
+// kAllocatorAlignment is replaced by a _ScopedAllocatorConcat of the backing
+// tensor into which the inputs are allocated.
+TEST_F(ScopedAllocatorOptimizerTest, ConcatRewrite) {
+  GrapplerItem item;
+  BuildConcatGraph(&item.graph, /*pack=*/false, /*dim=*/4);
+
+  ScopedAllocatorOptions opts;
+  opts.add_enable_op("ConcatV2");
+  ScopedAllocatorOptimizer sao(RewriterConfig::ON, opts);
+  GraphDef optimized_graph;
+  TF_ASSERT_OK(sao.Optimize(nullptr /*cluster*/, item, &optimized_graph));
+
+  NodeMap node_map(&optimized_graph);
+  NodeDef* c = nullptr;
+  GetNode(&node_map, "c", &c);
+  EXPECT_EQ("Identity", c->op());
+  ASSERT_EQ(1, c->input_size());
+  NodeDef* sac = nullptr;
+  GetNode(&node_map, c->input(0), &sac);
+  EXPECT_EQ("_ScopedAllocatorConcat", sac->op());
+  EXPECT_TRUE(sac->attr().at("reshape").b());
+  EXPECT_EQ(TensorShape({8, 4}), TensorShape(sac->attr().at("shape").shape()));
+  ASSERT_EQ(3, sac->input_size());
+  EXPECT_EQ("s1", sac->input(1));
+  EXPECT_EQ("s2", sac->input(2));
+  NodeDef* sa_node = ValidateSAControlInput(&optimized_graph, &node_map, "s1");
+  EXPECT_EQ(sa_node->name(), sac->input(0));
+  EXPECT_EQ(sa_node, ValidateSAControlInput(&optimized_graph, &node_map, "s2"));
+  EXPECT_EQ(TensorShape({32}),
+            TensorShape(sa_node->attr().at("shape").shape()));
+}
+
+// Test that a concatenation of inputs that would be padded is not rewritten.
+TEST_F(ScopedAllocatorOptimizerTest, ConcatOfUnalignedInputs) {
+  GrapplerItem item;
+  BuildConcatGraph(&item.graph, /*pack=*/false, /*dim=*/2);
+
+  ScopedAllocatorOptions opts;
+  opts.add_enable_op("ConcatV2");
+  ScopedAllocatorOptimizer sao(RewriterConfig::ON, opts);
+  GraphDef optimized_graph;
+  TF_ASSERT_OK(sao.Optimize(nullptr /*cluster*/, item, &optimized_graph));
+
+  for (const NodeDef& node : optimized_graph.node()) {
+    EXPECT_NE("_ScopedAllocator", node.op());
+    if (node.name() == "c") {
+      EXPECT_EQ("ConcatV2", node.op());
+    }
+  }
+}
+
+TEST_F(ScopedAllocatorOptimizerTest, ConcatExecute) {
+  GraphDef graph_def;
+  BuildConcatGraph(&graph_def, /*pack=*/false, /*dim=*/4);
+  std::vector<Tensor> outputs;
+  ExecuteGraph(graph_def, /*output_names=*/{"c:0"}, &outputs,
+               /*enable_op=*/"ConcatV2");
+  std::vector<float> expected;
+  for (int i = 0; i < 16; ++i) expected.push_back(i + 1);
+  for (int i = 0; i < 16; ++i) expected.push_back(i - 1);
+  ValidateValues(outputs, {expected});
+  EXPECT_EQ(TensorShape({8, 4}), outputs[0].shape());
+}
+
+TEST_F(ScopedAllocatorOptimizerTest, PackExecute) {
+  GraphDef graph_def;
+  BuildConcatGraph(&graph_def, /*pack=*/true, /*dim=*/4);
+  std::vector<Tensor> outputs;
+  ExecuteGraph(graph_def, /*output_names=*/{"c:0"}, &outputs,
+               /*enable_op=*/"Pack");
+  std::vector<float> expected;
+  for (int i = 0; i < 16; ++i) expected.push_back(i + 1);
+  for (int i = 0; i < 16; ++i) expected.push_back(i - 1);
+  ValidateValues(outputs, {expected});
+  EXPECT_EQ(TensorShape({2, 4, 4}), outputs[0].shape());
+}
 #endif  // ENABLE_MKL
 
 }  // namespace
@@ -199,5 +199,69 @@ Status EstimateRequiredTimes(
   return absl::OkStatus();
 }
 
+Status EstimateCriticalPathLengths(
+    const GrapplerItem& item, const Cluster* cluster,
+    std::unordered_map<const NodeDef*, Costs::NanoSeconds>* path_lengths) {
+  std::unordered_map<string, const NodeDef*> name_map;
+  for (const NodeDef& node : item.graph.node()) {
+    name_map[node.name()] = &node;
+  }
+
+  std::unordered_map<const NodeDef*, int> pending_fanouts;
+  for (const NodeDef& node : item.graph.node()) {
+    for (const string& input : node.input()) {
+      string node_name = NodeName(input);
+      auto it = name_map.find(node_name);
+      if (it == name_map.end()) {
+        return errors::InvalidArgument(
+            strings::StrCat("Unknown input node ", input));
+      }
+      const NodeDef* fanin = it->second;
+      pending_fanouts[fanin] += 1;
+    }
+  }
+  std::deque<const NodeDef*> ready_nodes;
+  for (const NodeDef& node : item.graph.node()) {
+    (*path_lengths)[&node] = 0;
+    if (pending_fanouts[&node] == 0) {
+      ready_nodes.push_back(&node);
+    }
+  }
+  GraphProperties properties(item);
+  TF_RETURN_IF_ERROR(
+      properties.InferStatically(/*assume_valid_feeds=*/true,
+                                 /*aggressive_shape_inference=*/false,
+                                 /*include_tensor_values=*/false));
+  OpLevelCostEstimator estimator;
+  VirtualPlacer placer(cluster->GetDevices());
+
+  while (!ready_nodes.empty()) {
+    const NodeDef* node = ready_nodes.front();
+    ready_nodes.pop_front();
+
+    // Before this point, the path length of the node is the longest one of its
+    // fanouts.
+    Costs::NanoSeconds path_length =
+        PredictExecutionTime(properties, estimator, placer, *node) +
+        (*path_lengths)[node];
+    (*path_lengths)[node] = path_length;
+
+    for (const string& fanin_name : node->input()) {
+      const NodeDef* fanin = name_map[NodeName(fanin_name)];
+      int pending = pending_fanouts[fanin];
+      if (pending == 0) {
+        // Already processed. Avoid going through loops more than once.
+        continue;
+      } else if (pending == 1) {
+        ready_nodes.push_back(fanin);
+      }
+      pending_fanouts[fanin]--;
+      (*path_lengths)[fanin] = std::max((*path_lengths)[fanin], path_length);
+    }
+  }
+
+  return absl::OkStatus();
+}
+
 }  // end namespace grappler
 }  // end namespace tensorflow
@@ -44,6 +44,15 @@ Status EstimateRequiredTimes(
         execution_times,
     std::unordered_map<const NodeDef*, Costs::NanoSeconds>* required_times);
 
+// Compute for each node the length of the critical path from the start of the
+// execution of the node to the completion of the graph, i.e. the largest sum of
+// the execution times of the node and of a chain of its transitive fanouts.
+// Running the ready node with the longest critical path first is the classic
+// list scheduling heuristic.
+Status EstimateCriticalPathLengths(
+    const GrapplerItem& item, const Cluster* cluster,
+    std::unordered_map<const NodeDef*, Costs::NanoSeconds>* path_lengths);
+
 }  // namespace grappler
 }  // end namespace tensorflow
 
@@ -196,6 +196,39 @@ TEST_F(StaticScheduleTest, RequiredTimes) {
                                       "Sign_2", "Sign_3", "y"}));
 }
 
+TEST_F(StaticScheduleTest, CriticalPathLengths) {
+  tensorflow::Scope s = tensorflow::Scope::NewRootScope();
+  Output x = ops::Const(s.WithOpName("x"), 1.0f, {1024});
+  Output long1 = ops::Sqrt(s.WithOpName("long1"), x);
+  Output long2 = ops::Sqrt(s.WithOpName("long2"), long1);
+  Output long3 = ops::Sqrt(s.WithOpName("long3"), long2);
+  Output short1 = ops::Sqrt(s.WithOpName("short1"), x);
+  Output y = ops::Add(s.WithOpName("y"), long3, short1);
+  GrapplerItem item;
+  TF_CHECK_OK(s.ToGraphDef(&item.graph));
+  item.fetch.push_back("y");
+
+  std::unique_ptr<VirtualCluster> cluster(CreateVirtualCluster());
+
+  std::unordered_map<const NodeDef*, Costs::NanoSeconds> path_lengths;
+  TF_EXPECT_OK(
+      EstimateCriticalPathLengths(item, cluster.get(), &path_lengths));
+  EXPECT_EQ(item.graph.node_size(), path_lengths.size());
+
+  std::unordered_map<string, Costs::NanoSeconds> lengths;
+  for (const auto& node_length : path_lengths) {
+    lengths[node_length.first->name()] = node_length.second;
+  }
+  EXPECT_GT(lengths["y"], Costs::NanoSeconds(0));
+  EXPECT_GT(lengths["long3"], lengths["y"]);
+  EXPECT_GT(lengths["long2"], lengths["long3"]);
+  EXPECT_GT(lengths["long1"], lengths["long2"]);
+  EXPECT_GT(lengths["x"], lengths["long1"]);
+  // The single Sqrt on the short path has the same cost as long3.
+  EXPECT_EQ(lengths["short1"], lengths["long3"]);
+  EXPECT_GT(lengths["long1"], lengths["short1"]);
+}
+
 }  // namespace
 }  // namespace grappler
 }  // namespace tensorflow
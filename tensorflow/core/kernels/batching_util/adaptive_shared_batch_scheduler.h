@@ -26,6 +26,7 @@ limitations under the License.
 
 #include "absl/types/optional.h"
 #include "tensorflow/core/kernels/batching_util/batch_scheduler.h"
+#include "tensorflow/core/kernels/batching_util/batch_size_controller.h"
 #include "tensorflow/core/kernels/batching_util/periodic_function.h"
 #include "tensorflow/core/lib/core/errors.h"
 #include "tensorflow/core/lib/core/status.h"
@@ -171,6 +172,18 @@ class AdaptiveSharedBatchScheduler
 
     // If true, the padding will not be appended.
     bool disable_padding = false;
+
+    // If `target_batch_latency_micros` is positive, batches are closed at a
+    // size picked from `allowed_batch_sizes` by a `BatchSizeController`, which
+    // learns the processing latency of each size from the batches of this
+    // queue and picks the size with the highest throughput whose estimated
+    // 99th percentile processing latency is within the target. Otherwise
+    // batches are closed at `max_batch_size`.
+    //
+    // `allowed_batch_sizes` must then be non-empty, increasing, and not larger
+    // than `max_batch_size`.
+    std::vector<int32> allowed_batch_sizes;
+    int64_t target_batch_latency_micros = 0;
   };
 
   using BatchProcessor = std::function<void(std::unique_ptr<Batch<TaskType>>)>;
@@ -326,12 +339,18 @@ class ASBSQueue : public BatchScheduler<TaskType> {
   // Number of size 1 tasks which could currently be scheduled without failing.
   size_t SchedulingCapacityLocked() const TF_EXCLUSIVE_LOCKS_REQUIRED(mu_);
 
+  // The size at which batches are closed.
+  int target_batch_size() const;
+
   // Returns uint64 one greater than was returned by the previous call.
   // Context id is reused after std::numeric_limits<uint64>::max is exhausted.
   static uint64 NewTraceMeContextIdForBatch();
 
   std::shared_ptr<AdaptiveSharedBatchScheduler<TaskType>> scheduler_;
   const QueueOptions options_;
+  // Picks the batch size if `options_.target_batch_latency_micros` is
+  // positive. Shared with the batches, which outlive the queue.
+  const std::shared_ptr<BatchSizeController> batch_size_controller_;
   // Owned by scheduler_.
   ASBSBatch<TaskType>* current_batch_ TF_GUARDED_BY(mu_) = nullptr;
   int64_t num_enqueued_batches_ TF_GUARDED_BY(mu_) = 0;
@@ -346,11 +365,14 @@ template <typename TaskType>
 class ASBSBatch : public Batch<TaskType> {
  public:
   ASBSBatch(ASBSQueue<TaskType>* queue, int64_t creation_time_micros,
-            int64_t batch_timeout_micros, uint64 traceme_context_id)
+            int64_t batch_timeout_micros, uint64 traceme_context_id,
+            std::shared_ptr<BatchSizeController> batch_size_controller =
+                nullptr)
       : queue_(queue),
         creation_time_micros_(creation_time_micros),
         schedulable_time_micros_(creation_time_micros + batch_timeout_micros),
-        traceme_context_id_(traceme_context_id) {}
+        traceme_context_id_(traceme_context_id),
+        batch_size_controller_(std::move(batch_size_controller)) {}
 
   ~ASBSBatch() override {}
 
@@ -362,11 +384,17 @@ class ASBSBatch : public Batch<TaskType> {
 
   uint64 traceme_context_id() const { return traceme_context_id_; }
 
+  // The controller to report the processing latency of the batch to, if any.
+  const std::shared_ptr<BatchSizeController>& batch_size_controller() const {
+    return batch_size_controller_;
+  }
+
  private:
   ASBSQueue<TaskType>* queue_;
   const int64_t creation_time_micros_;
   const int64_t schedulable_time_micros_;
   const uint64 traceme_context_id_;
+  const std::shared_ptr<BatchSizeController> batch_size_controller_;
   ASBSBatch(const ASBSBatch&) = delete;
   void operator=(const ASBSBatch&) = delete;
 };
@@ -467,6 +495,25 @@ Status AdaptiveSharedBatchScheduler<TaskType>::AddQueue(
           options.max_batch_size);
     }
   }
+  if (options.target_batch_latency_micros > 0) {
+    const std::vector<int32>& sizes = options.allowed_batch_sizes;
+    if (sizes.empty()) {
+      return errors::InvalidArgument(
+          "allowed_batch_sizes must be set when target_batch_latency_micros "
+          "is positive");
+    }
+    for (int i = 0; i < sizes.size(); ++i) {
+      if (sizes[i] <= 0 || (i > 0 && sizes[i] <= sizes[i - 1])) {
+        return errors::InvalidArgument(
+            "allowed_batch_sizes must be positive and increasing");
+      }
+    }
+    if (sizes.back() > options.max_batch_size) {
+      return errors::InvalidArgument(
+          "allowed_batch_sizes must not exceed max_batch_size; got ",
+          sizes.back(), " and max_batch_size as ", options.max_batch_size);
+    }
+  }
   internal::ASBSQueue<TaskType>* asbs_queue_raw;
   queue->reset(asbs_queue_raw = new internal::ASBSQueue<TaskType>(
                    this->shared_from_this(), options));
@@ -642,9 +689,18 @@ void AdaptiveSharedBatchScheduler<TaskType>::CallbackWrapper(
       profiler::ContextType::kAdaptiveSharedBatchScheduler,
       batch->traceme_context_id());
   const int64_t start_time = batch->creation_time_micros();
+  // The batch is deleted by `callback`.
+  std::shared_ptr<BatchSizeController> batch_size_controller =
+      batch->batch_size_controller();
+  const int batch_size = batch->size();
+  const int64_t processing_start_time = GetEnv()->NowMicros();
   callback(std::unique_ptr<Batch<TaskType>>(
       const_cast<internal::ASBSBatch<TaskType>*>(batch)));
   int64_t end_time = GetEnv()->NowMicros();
+  if (batch_size_controller != nullptr) {
+    batch_size_controller->RecordBatchLatency(
+        batch_size, end_time - processing_start_time);
+  }
   mutex_lock l(mu_);
   if (is_express) {
     in_flight_express_batches_--;
@@ -710,7 +766,14 @@ template <typename TaskType>
 ASBSQueue<TaskType>::ASBSQueue(
     std::shared_ptr<AdaptiveSharedBatchScheduler<TaskType>> scheduler,
     const QueueOptions& options)
-    : scheduler_(scheduler), options_(options) {}
+    : scheduler_(scheduler),
+      options_(options),
+      batch_size_controller_(
+          options.target_batch_latency_micros > 0
+              ? std::make_shared<BatchSizeController>(
+                    options.allowed_batch_sizes,
+                    options.target_batch_latency_micros)
+              : nullptr) {}
 
 template <typename TaskType>
 ASBSQueue<TaskType>::~ASBSQueue() {
@@ -747,16 +810,22 @@ Status ASBSQueue<TaskType>::Schedule(std::unique_ptr<TaskType>* task) {
   std::vector<std::unique_ptr<TaskType>> tasks_to_schedule;
   std::vector<ASBSBatch<TaskType>*> new_batches;
   bool closed_batch = false;
+  const int batch_size = target_batch_size();
   {
     mutex_lock l(mu_);
     if (size > SchedulingCapacityLocked()) {
       return errors::Unavailable("The batch scheduling queue is full");
     }
 
+    if (current_batch_ && current_batch_->size() >= batch_size) {
+      // The batch size has been lowered since the current batch was started.
+      current_batch_->Close();
+      closed_batch = true;
+      current_batch_ = nullptr;
+    }
     int remaining_batch_size =
-        current_batch_ == nullptr
-            ? options_.max_batch_size
-            : options_.max_batch_size - current_batch_->size();
+        current_batch_ == nullptr ? batch_size
+                                  : batch_size - current_batch_->size();
     if (options_.split_input_task_func == nullptr ||
         size <= remaining_batch_size) {
       // Either we don't allow task splitting or task fits within the current
@@ -767,13 +836,12 @@ Status ASBSQueue<TaskType>::Schedule(std::unique_ptr<TaskType>* task) {
       // Beyond this point Schedule should not fail, as the caller has been
       // promised that all of the split tasks will be scheduled.
       TF_RETURN_IF_ERROR(options_.split_input_task_func(
-          task, remaining_batch_size, options_.max_batch_size,
-          &tasks_to_schedule));
+          task, remaining_batch_size, batch_size, &tasks_to_schedule));
     }
     for (auto& task : tasks_to_schedule) {
       // Can't fit within current batch, close it off and try to create another.
       if (current_batch_ &&
-          current_batch_->size() + task->size() > options_.max_batch_size) {
+          current_batch_->size() + task->size() > batch_size) {
         current_batch_->Close();
         closed_batch = true;
         current_batch_ = nullptr;
@@ -786,7 +854,8 @@ Status ASBSQueue<TaskType>::Schedule(std::unique_ptr<TaskType>* task) {
         // are processed in the same batch and should share traceme_context_id.
         current_batch_ = new ASBSBatch<TaskType>(
             this, scheduler_->GetEnv()->NowMicros(),
-            options_.batch_timeout_micros, NewTraceMeContextIdForBatch());
+            options_.batch_timeout_micros, NewTraceMeContextIdForBatch(),
+            batch_size_controller_);
         new_batches.push_back(current_batch_);
       }
 
@@ -806,8 +875,7 @@ Status ASBSQueue<TaskType>::Schedule(std::unique_ptr<TaskType>* task) {
       bool reached_max_tasks =
           (options_.max_tasks_per_batch.has_value() &&
            current_batch_->num_tasks() >= options_.max_tasks_per_batch.value());
-      if (current_batch_->size() == options_.max_batch_size ||
-          reached_max_tasks) {
+      if (current_batch_->size() >= batch_size || reached_max_tasks) {
         current_batch_->Close();
         closed_batch = true;
         current_batch_ = nullptr;
@@ -857,6 +925,14 @@ size_t ASBSQueue<TaskType>::SchedulingCapacityLocked() const {
   return spare_batches * options_.max_batch_size + current_batch_capacity;
 }
 
+template <typename TaskType>
+int ASBSQueue<TaskType>::target_batch_size() const {
+  if (batch_size_controller_ == nullptr) {
+    return options_.max_batch_size;
+  }
+  return batch_size_controller_->batch_size();
+}
+
 template <typename TaskType>
 // static
 uint64 ASBSQueue<TaskType>::NewTraceMeContextIdForBatch() {
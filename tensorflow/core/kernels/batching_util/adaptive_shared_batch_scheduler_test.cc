@@ -517,6 +517,58 @@ TEST(AdaptiveSharedBatchSchedulerTest, MaxTasksPerBatch) {
     if (processed_batches == 3) break;
   }
 }
+TEST(AdaptiveSharedBatchSchedulerTest, BadLatencyTargetOptions) {
+  std::shared_ptr<AdaptiveSharedBatchScheduler<FakeTask>> scheduler;
+  TF_ASSERT_OK(AdaptiveSharedBatchScheduler<FakeTask>::Create({}, &scheduler));
+  auto queue_callback = [](std::unique_ptr<Batch<FakeTask>> batch) {};
+  std::unique_ptr<BatchScheduler<FakeTask>> queue;
+  AdaptiveSharedBatchScheduler<FakeTask>::QueueOptions queue_options;
+  queue_options.max_batch_size = 8;
+  queue_options.target_batch_latency_micros = 1000;
+  EXPECT_FALSE(
+      scheduler->AddQueue(queue_options, queue_callback, &queue).ok());
+  queue_options.allowed_batch_sizes = {4, 2};
+  EXPECT_FALSE(
+      scheduler->AddQueue(queue_options, queue_callback, &queue).ok());
+  queue_options.allowed_batch_sizes = {2, 16};
+  EXPECT_FALSE(
+      scheduler->AddQueue(queue_options, queue_callback, &queue).ok());
+  queue_options.allowed_batch_sizes = {2, 8};
+  TF_EXPECT_OK(scheduler->AddQueue(queue_options, queue_callback, &queue));
+}
+
+TEST(AdaptiveSharedBatchSchedulerTest, LatencyTargetBatchSize) {
+  mutex mu;
+  std::vector<int> batch_sizes;
+  auto queue_callback =
+      [&mu, &batch_sizes](std::unique_ptr<Batch<FakeTask>> batch) {
+        ASSERT_TRUE(batch->IsClosed());
+        mutex_lock l(mu);
+        batch_sizes.push_back(batch->size());
+      };
+  std::shared_ptr<AdaptiveSharedBatchScheduler<FakeTask>> scheduler;
+  TF_ASSERT_OK(AdaptiveSharedBatchScheduler<FakeTask>::Create({}, &scheduler));
+  std::unique_ptr<BatchScheduler<FakeTask>> queue;
+
+  AdaptiveSharedBatchScheduler<FakeTask>::QueueOptions queue_options;
+  queue_options.max_batch_size = 100;
+  queue_options.batch_timeout_micros = 1000000000000;
+  queue_options.allowed_batch_sizes = {2, 4, 100};
+  queue_options.target_batch_latency_micros = 1000000000;
+  TF_ASSERT_OK(scheduler->AddQueue(queue_options, queue_callback, &queue));
+  // Until the controller has measured any batches, batches are closed at the
+  // smallest allowed size instead of waiting for `max_batch_size`.
+  for (int i = 0; i < 4; ++i) {
+    TF_ASSERT_OK(ScheduleTask(1, queue.get()));
+  }
+  while (true) {
+    mutex_lock l(mu);
+    if (batch_sizes.size() == 2) break;
+  }
+  mutex_lock l(mu);
+  EXPECT_EQ(batch_sizes[0], 2);
+  EXPECT_EQ(batch_sizes[1], 2);
+}
 }  // namespace anonymous
 }  // namespace serving
 }  // namespace tensorflow
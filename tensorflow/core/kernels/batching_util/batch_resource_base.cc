@@ -213,6 +213,35 @@ void RecordBatchDelayUsV2(int64_t batch_delay_us, const string& model_name,
       ->Add(static_cast<double>(batch_delay_us));
 }
 
+absl::string_view CriticalityName(tsl::criticality::Criticality criticality) {
+  switch (criticality) {
+    case tsl::criticality::Criticality::kSheddable:
+      return "sheddable";
+    case tsl::criticality::Criticality::kSheddablePlus:
+      return "sheddable_plus";
+    case tsl::criticality::Criticality::kCritical:
+      return "critical";
+    case tsl::criticality::Criticality::kCriticalPlus:
+      return "critical_plus";
+  }
+  return "unknown";
+}
+
+void RecordBatchDelayUsByCriticality(
+    int64_t batch_delay_us, const string& model_name, const string& op_name,
+    tsl::criticality::Criticality criticality) {
+  static auto* cell = tensorflow::monitoring::Sampler<3>::New(
+      {"/tensorflow/serving/batching/batch_delay_us_by_criticality",
+       "Tracks the batching delay (in microseconds) for inputs by model_name "
+       "(if available) and the criticality of the inputs.",
+       "model_name", "op_name", "criticality"},
+      // It's 27 buckets with the last bucket being 2^26 to DBL_MAX;
+      // so the limits are [1, 2, 4, 8, ..., 64 * 1024 * 1024, DBL_MAX].
+      monitoring::Buckets::Exponential(1, 2, 27));
+  cell->GetCell(model_name, op_name, std::string(CriticalityName(criticality)))
+      ->Add(static_cast<double>(batch_delay_us));
+}
+
 void RecordBatchParamBatchTimeoutMicros(int64_t batch_timeout_micros,
                                         const string& model_name,
                                         const string& op_name) {
@@ -391,6 +420,14 @@ Status BatchResourceBase::RegisterInput(
     }
     batch_components->inputs.push_back(tensor);
   }
+  WarmupSignatureRecorder& recorder = GetGlobalWarmupSignatureRecorder();
+  if (recorder.IsRecording() && forced_warmup_batch_size == 0 &&
+      !session_metadata().name().empty()) {
+    recorder.MaybeRecord({session_metadata().name(),
+                          session_metadata().version()},
+                         context->op_kernel().name(),
+                         batch_components->inputs);
+  }
   RecordInputBatchSize(tensors[0].shape().dim_size(0), GetModelName(context),
                        context->op_kernel().name());
   RecordInputBatchSizeV2(tensors[0].shape().dim_size(0), GetModelName(context),
@@ -729,6 +766,11 @@ Status BatchResourceBase::ConcatInputTensors(
       }
     }
 
+    // A batch of a single unpadded task is passed through without a copy.
+    if (to_concatenate.size() == 1) {
+      concatenated_tensors->push_back(std::move(to_concatenate[0]));
+      continue;
+    }
     Tensor concatenated_tensor;
     Status concat_status =
         Concat(context, to_concatenate, &concatenated_tensor);
@@ -886,8 +928,11 @@ Status BatchResourceBase::SplitOutputTensors(
           "the 0th dimension sizes of the input tensors");
     }
 
+    // The outputs of the tasks alias the batched output, so that it is not
+    // copied a second time. The batched output is freed once every task has
+    // released its output.
     std::vector<Tensor> split_tensor;
-    const Status split_status = tensor::Split(
+    const Status split_status = SliceBatchedTensor(
         output_tensor, task_sizes_plus_optional_padding, &split_tensor);
     DCHECK(split_status.ok()) << split_status;
     if (!split_status.ok()) {
@@ -923,6 +968,34 @@ Status BatchResourceBase::SplitOutputTensors(
   return absl::OkStatus();
 }
 
+/*static*/ Status BatchResourceBase::SliceBatchedTensor(
+    const Tensor& tensor, absl::Span<const int64_t> sizes,
+    std::vector<Tensor>* slices) {
+  if (tensor.dims() == 0) {
+    return errors::InvalidArgument("Cannot split a zero-dimensional tensor");
+  }
+  int64_t total_size = 0;
+  for (int64_t size : sizes) {
+    total_size += size;
+  }
+  if (total_size != tensor.dim_size(0)) {
+    return errors::InvalidArgument(
+        "The values in 'sizes' do not sum to the zeroth-dimension size of "
+        "'tensor'");
+  }
+  slices->reserve(slices->size() + sizes.size());
+  int64_t start = 0;
+  for (int64_t size : sizes) {
+    Tensor slice = tensor.Slice(start, start + size);
+    start += size;
+    if (!slice.IsAligned()) {
+      slice = tensor::DeepCopy(slice);
+    }
+    slices->push_back(std::move(slice));
+  }
+  return absl::OkStatus();
+}
+
 void BatchResourceBase::CleanUpFunctionHelper(BatchTask& task,
                                               const Status& status) const {
   WithContext wc(task.propagated_context);
@@ -1018,6 +1091,9 @@ void BatchResourceBase::ProcessFuncBatch(
     RecordBatchDelayUsV2((current_time - batch->task(i).start_time) * 1e-3,
                          model_name, last_task_context->op_kernel().name(),
                          processed_size);
+    RecordBatchDelayUsByCriticality(
+        (current_time - batch->task(i).start_time) * 1e-3, model_name,
+        last_task_context->op_kernel().name(), batch->task(i).criticality());
   }
   // Releases the cleanup method here, because the callback of the function
   // library runtime will handle it now.
@@ -26,6 +26,7 @@ limitations under the License.
 
 #include "absl/strings/str_join.h"
 #include "absl/synchronization/blocking_counter.h"
+#include "absl/types/span.h"
 #include "tensorflow/core/common_runtime/cost_measurement_registry.h"
 #include "tensorflow/core/common_runtime/request_cost.h"
 #include "tensorflow/core/framework/op_kernel.h"
@@ -270,6 +271,16 @@ class BatchResourceBase : public ResourceBase {
           batch_cost_measurements,
       int64_t processed_size, BatchT& batch);
 
+  // Splits `tensor` along its 0th dimension into tensors with 0th dimension
+  // sizes `sizes`. The splits alias the buffer of `tensor` instead of copying
+  // it, except for splits whose data is not aligned for Eigen, which are
+  // copied.
+  //
+  // REQUIRES: 'tensor' must have at least one dimension.
+  static Status SliceBatchedTensor(const Tensor& tensor,
+                                   absl::Span<const int64_t> sizes,
+                                   std::vector<Tensor>* slices);
+
  private:
   // Implementation of calling the process batch function.
   virtual void ProcessFuncBatchImpl(
@@ -28,6 +28,7 @@ limitations under the License.
 #include "tensorflow/core/common_runtime/request_cost.h"
 #include "tensorflow/core/framework/tensor.h"
 #include "tensorflow/core/framework/tensor_shape.h"
+#include "tensorflow/core/framework/tensor_testutil.h"
 #include "tensorflow/core/framework/types.pb.h"
 #include "tsl/platform/criticality.h"
 
@@ -294,6 +295,44 @@ TEST(SplitBatchCostsAndRecordMetricsTest, SplitOnlyNonZeroCostTypes) {
           UnorderedElementsAre(Pair("test_tpu", absl::Milliseconds(100))))));
 }
 
+TEST(SliceBatchedTensorTest, SlicesAliasBatchedTensor) {
+  Tensor batched = test::AsTensor<float>({1, 2, 3, 4, 5, 6, 7, 8},
+                                         TensorShape({8, 1}));
+  std::vector<Tensor> slices;
+  ASSERT_TRUE(
+      BatchResourceBase::SliceBatchedTensor(batched, {3, 1, 4}, &slices).ok());
+  ASSERT_EQ(slices.size(), 3);
+  test::ExpectTensorEqual<float>(
+      slices[0], test::AsTensor<float>({1, 2, 3}, TensorShape({3, 1})));
+  test::ExpectTensorEqual<float>(
+      slices[1], test::AsTensor<float>({4}, TensorShape({1, 1})));
+  test::ExpectTensorEqual<float>(
+      slices[2], test::AsTensor<float>({5, 6, 7, 8}, TensorShape({4, 1})));
+  EXPECT_TRUE(slices[0].SharesBufferWith(batched));
+}
+
+TEST(SliceBatchedTensorTest, CopiesUnalignedSlices) {
+  Tensor batched = test::AsTensor<float>({1, 2, 3}, TensorShape({3}));
+  std::vector<Tensor> slices;
+  ASSERT_TRUE(
+      BatchResourceBase::SliceBatchedTensor(batched, {1, 2}, &slices).ok());
+  ASSERT_EQ(slices.size(), 2);
+  // The second slice starts 4 bytes into the buffer.
+  EXPECT_TRUE(slices[1].IsAligned());
+  EXPECT_FALSE(slices[1].SharesBufferWith(batched));
+  test::ExpectTensorEqual<float>(
+      slices[1], test::AsTensor<float>({2, 3}, TensorShape({2})));
+}
+
+TEST(SliceBatchedTensorTest, RejectsBadSizes) {
+  Tensor batched = test::AsTensor<float>({1, 2, 3}, TensorShape({3}));
+  std::vector<Tensor> slices;
+  EXPECT_FALSE(
+      BatchResourceBase::SliceBatchedTensor(batched, {1, 1}, &slices).ok());
+  EXPECT_FALSE(
+      BatchResourceBase::SliceBatchedTensor(Tensor(1.0f), {1}, &slices).ok());
+}
+
 }  // namespace
 }  // namespace serving
 }  // namespace tensorflow
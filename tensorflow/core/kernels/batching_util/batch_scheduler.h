@@ -92,6 +92,13 @@ class BatchTask {
   virtual tsl::criticality::Criticality criticality() const {
     return tsl::criticality::Criticality::kCritical;
   }
+
+  // Returns the time, in microseconds in the scheduler's `Env::NowMicros()`
+  // clock, by which processing of the task should have started. It defaults to
+  // no deadline. Only used by schedulers with deadline scheduling enabled.
+  virtual std::optional<uint64> deadline_micros() const {
+    return std::nullopt;
+  }
 };
 
 // A thread-safe collection of BatchTasks. Tasks can be either added or removed
@@ -0,0 +1,124 @@
+/* Copyright 2024 The TensorFlow Authors. All Rights Reserved.
+
+Licensed under the Apache License, Version 2.0 (the "License");
+you may not use this file except in compliance with the License.
+You may obtain a copy of the License at
+
+    http://www.apache.org/licenses/LICENSE-2.0
+
+Unless required by applicable law or agreed to in writing, software
+distributed under the License is distributed on an "AS IS" BASIS,
+WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+See the License for the specific language governing permissions and
+limitations under the License.
+==============================================================================*/
+#include "tensorflow/core/kernels/batching_util/batch_size_controller.h"
+
+#include <algorithm>
+#include <cstdint>
+#include <utility>
+#include <vector>
+
+#include "tensorflow/core/platform/logging.h"
+#include "tensorflow/core/platform/mutex.h"
+
+namespace tensorflow {
+namespace serving {
+
+BatchSizeController::BatchSizeController(std::vector<int32> allowed_batch_sizes,
+                                         int64_t target_latency_micros,
+                                         int64_t window_size,
+                                         int64_t exploration_period)
+    : allowed_batch_sizes_(std::move(allowed_batch_sizes)),
+      target_latency_micros_(target_latency_micros),
+      window_size_(std::max<int64_t>(window_size, kMinSamples)),
+      exploration_period_(exploration_period),
+      stats_(allowed_batch_sizes_.size()) {
+  DCHECK(!allowed_batch_sizes_.empty());
+  DCHECK(std::is_sorted(allowed_batch_sizes_.begin(),
+                        allowed_batch_sizes_.end()));
+}
+
+int32 BatchSizeController::batch_size() const {
+  mutex_lock l(mu_);
+  return allowed_batch_sizes_[current_index_];
+}
+
+void BatchSizeController::RecordBatchLatency(int32 batch_size,
+                                             int64_t latency_micros) {
+  mutex_lock l(mu_);
+  const int index = std::min<int>(
+      std::lower_bound(allowed_batch_sizes_.begin(),
+                       allowed_batch_sizes_.end(), batch_size) -
+          allowed_batch_sizes_.begin(),
+      allowed_batch_sizes_.size() - 1);
+  SizeStats& stats = stats_[index];
+  stats.latencies_micros.push_back(latency_micros);
+  stats.latency_sum_micros += latency_micros;
+  if (stats.latencies_micros.size() > window_size_) {
+    stats.latency_sum_micros -= stats.latencies_micros.front();
+    stats.latencies_micros.pop_front();
+  }
+  ++num_batches_;
+  if (exploration_period_ > 0 && num_batches_ % exploration_period_ == 0) {
+    for (int i = current_index_ + 1; i < stats_.size(); ++i) {
+      stats_[i] = SizeStats();
+    }
+  }
+  UpdateBatchSizeLocked();
+}
+
+int64_t BatchSizeController::EstimatedP99LatencyMicros(int index) const {
+  mutex_lock l(mu_);
+  return EstimatedP99LatencyMicrosLocked(index);
+}
+
+int64_t BatchSizeController::EstimatedP99LatencyMicrosLocked(int index) const {
+  const std::deque<int64_t>& latencies = stats_[index].latencies_micros;
+  if (latencies.empty()) {
+    return -1;
+  }
+  std::vector<int64_t> sorted(latencies.begin(), latencies.end());
+  // The smallest sample that is greater than or equal to 99% of the samples.
+  const int64_t rank = (sorted.size() * 99 + 99) / 100 - 1;
+  std::nth_element(sorted.begin(), sorted.begin() + rank, sorted.end());
+  return sorted[rank];
+}
+
+void BatchSizeController::UpdateBatchSizeLocked() {
+  auto meets_target = [this](int index) TF_EXCLUSIVE_LOCKS_REQUIRED(mu_) {
+    return stats_[index].latencies_micros.size() >= kMinSamples &&
+           EstimatedP99LatencyMicrosLocked(index) <= target_latency_micros_;
+  };
+
+  // The size with the highest throughput among those that meet the target, or
+  // the smallest size if none does.
+  int best_index = 0;
+  double best_throughput = -1;
+  for (int i = 0; i < stats_.size(); ++i) {
+    if (!meets_target(i)) continue;
+    const SizeStats& stats = stats_[i];
+    const double mean_latency_micros =
+        std::max<double>(1.0, static_cast<double>(stats.latency_sum_micros) /
+                                  stats.latencies_micros.size());
+    const double throughput = allowed_batch_sizes_[i] / mean_latency_micros;
+    if (throughput > best_throughput) {
+      best_throughput = throughput;
+      best_index = i;
+    }
+  }
+  // Explore the next larger size until it has enough samples to be judged.
+  if (meets_target(best_index) && best_index + 1 < stats_.size() &&
+      stats_[best_index + 1].latencies_micros.size() < kMinSamples) {
+    ++best_index;
+  }
+  if (best_index != current_index_) {
+    VLOG(1) << "Changing batch size from "
+            << allowed_batch_sizes_[current_index_] << " to "
+            << allowed_batch_sizes_[best_index];
+    current_index_ = best_index;
+  }
+}
+
+}  // namespace serving
+}  // namespace tensorflow
@@ -0,0 +1,93 @@
+/* Copyright 2024 The TensorFlow Authors. All Rights Reserved.
+
+Licensed under the Apache License, Version 2.0 (the "License");
+you may not use this file except in compliance with the License.
+You may obtain a copy of the License at
+
+    http://www.apache.org/licenses/LICENSE-2.0
+
+Unless required by applicable law or agreed to in writing, software
+distributed under the License is distributed on an "AS IS" BASIS,
+WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+See the License for the specific language governing permissions and
+limitations under the License.
+==============================================================================*/
+#ifndef TENSORFLOW_CORE_KERNELS_BATCHING_UTIL_BATCH_SIZE_CONTROLLER_H_
+#define TENSORFLOW_CORE_KERNELS_BATCHING_UTIL_BATCH_SIZE_CONTROLLER_H_
+
+#include <cstdint>
+#include <deque>
+#include <vector>
+
+#include "tensorflow/core/platform/mutex.h"
+#include "tensorflow/core/platform/thread_annotations.h"
+#include "tensorflow/core/platform/types.h"
+
+namespace tensorflow {
+namespace serving {
+
+// Picks the batch size of a queue from the observed processing latency of its
+// batches. The controller keeps a window of recent latencies for each allowed
+// batch size, which is a sampled latency-vs-batch-size curve of the model, and
+// targets the allowed size with the highest throughput (size / mean latency)
+// among the sizes whose estimated 99th percentile latency is within
+// `target_latency_micros`.
+//
+// Sizes are explored upwards: starting from the smallest allowed size, the next
+// larger size is tried as long as the current size meets the target and the
+// larger size has too few samples. Every `exploration_period` batches, the
+// samples of the sizes above the current one are dropped, so that they are
+// explored again and the curve follows changes of the model or the load.
+//
+// Thread-safe.
+class BatchSizeController {
+ public:
+  // `allowed_batch_sizes` must be non-empty and increasing.
+  BatchSizeController(std::vector<int32> allowed_batch_sizes,
+                      int64_t target_latency_micros,
+                      int64_t window_size = kDefaultWindowSize,
+                      int64_t exploration_period = kDefaultExplorationPeriod);
+
+  // Returns the size at which batches should be closed.
+  int32 batch_size() const;
+
+  // Records that a batch of `batch_size` took `latency_micros` to process. The
+  // latency is attributed to the smallest allowed size that fits the batch,
+  // since that is the size the batch is padded to.
+  void RecordBatchLatency(int32 batch_size, int64_t latency_micros);
+
+  // Returns the estimated 99th percentile latency of batches of the allowed
+  // size at `index`, or -1 if it has no samples.
+  int64_t EstimatedP99LatencyMicros(int index) const;
+
+  static constexpr int64_t kDefaultWindowSize = 64;
+  static constexpr int64_t kDefaultExplorationPeriod = 1000;
+  // The number of samples needed before a size's latency is trusted.
+  static constexpr int64_t kMinSamples = 8;
+
+ private:
+  struct SizeStats {
+    std::deque<int64_t> latencies_micros;
+    int64_t latency_sum_micros = 0;
+  };
+
+  int64_t EstimatedP99LatencyMicrosLocked(int index) const
+      TF_EXCLUSIVE_LOCKS_REQUIRED(mu_);
+  void UpdateBatchSizeLocked() TF_EXCLUSIVE_LOCKS_REQUIRED(mu_);
+
+  const std::vector<int32> allowed_batch_sizes_;
+  const int64_t target_latency_micros_;
+  const int64_t window_size_;
+  const int64_t exploration_period_;
+
+  mutable mutex mu_;
+  std::vector<SizeStats> stats_ TF_GUARDED_BY(mu_);
+  // Index of the current batch size in `allowed_batch_sizes_`.
+  int current_index_ TF_GUARDED_BY(mu_) = 0;
+  int64_t num_batches_ TF_GUARDED_BY(mu_) = 0;
+};
+
+}  // namespace serving
+}  // namespace tensorflow
+
+#endif  // TENSORFLOW_CORE_KERNELS_BATCHING_UTIL_BATCH_SIZE_CONTROLLER_H_
@@ -0,0 +1,94 @@
+/* Copyright 2024 The TensorFlow Authors. All Rights Reserved.
+
+Licensed under the Apache License, Version 2.0 (the "License");
+you may not use this file except in compliance with the License.
+You may obtain a copy of the License at
+
+    http://www.apache.org/licenses/LICENSE-2.0
+
+Unless required by applicable law or agreed to in writing, software
+distributed under the License is distributed on an "AS IS" BASIS,
+WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+See the License for the specific language governing permissions and
+limitations under the License.
+==============================================================================*/
+#include "tensorflow/core/kernels/batching_util/batch_size_controller.h"
+
+#include <cstdint>
+#include <functional>
+
+#include "tensorflow/core/platform/test.h"
+
+namespace tensorflow {
+namespace serving {
+namespace {
+
+// Runs `num_batches` batches at the size picked by `controller`, each taking
+// `latency_micros(batch_size)`.
+void RunBatches(BatchSizeController& controller, int num_batches,
+                const std::function<int64_t(int32)>& latency_micros) {
+  for (int i = 0; i < num_batches; ++i) {
+    const int32 batch_size = controller.batch_size();
+    controller.RecordBatchLatency(batch_size, latency_micros(batch_size));
+  }
+}
+
+TEST(BatchSizeControllerTest, StartsAtSmallestSize) {
+  BatchSizeController controller({2, 4, 8}, /*target_latency_micros=*/100);
+  EXPECT_EQ(2, controller.batch_size());
+}
+
+TEST(BatchSizeControllerTest, PicksLargestSizeWhenAllMeetTarget) {
+  BatchSizeController controller({1, 2, 4, 8}, /*target_latency_micros=*/100);
+  RunBatches(controller, 200, [](int32 size) { return 20 + 5 * size; });
+  EXPECT_EQ(8, controller.batch_size());
+}
+
+TEST(BatchSizeControllerTest, StaysBelowSizeThatMissesTarget) {
+  BatchSizeController controller({1, 2, 4, 8}, /*target_latency_micros=*/100);
+  RunBatches(controller, 200, [](int32 size) { return 20 + 20 * size; });
+  EXPECT_EQ(4, controller.batch_size());
+  EXPECT_EQ(180, controller.EstimatedP99LatencyMicros(3));
+}
+
+TEST(BatchSizeControllerTest, PicksHighestThroughput) {
+  // Batches of 8 are within the target but slower per element than batches
+  // of 4.
+  BatchSizeController controller({1, 2, 4, 8}, /*target_latency_micros=*/100);
+  RunBatches(controller, 200,
+             [](int32 size) { return size == 8 ? 90 : 5 + 5 * size; });
+  EXPECT_EQ(4, controller.batch_size());
+}
+
+TEST(BatchSizeControllerTest, ReExploresLargerSizesPeriodically) {
+  BatchSizeController controller({1, 2, 4, 8}, /*target_latency_micros=*/100,
+                                 /*window_size=*/8,
+                                 /*exploration_period=*/50);
+  RunBatches(controller, 90, [](int32 size) { return 20 + 20 * size; });
+  EXPECT_EQ(4, controller.batch_size());
+  // The model became faster, e.g. after an upgrade of the hardware.
+  RunBatches(controller, 100, [](int32 size) { return 20 + 5 * size; });
+  EXPECT_EQ(8, controller.batch_size());
+}
+
+TEST(BatchSizeControllerTest, AttributesLatencyToPaddedSize) {
+  BatchSizeController controller({2, 4, 8}, /*target_latency_micros=*/100);
+  controller.RecordBatchLatency(3, 42);
+  EXPECT_EQ(-1, controller.EstimatedP99LatencyMicros(0));
+  EXPECT_EQ(42, controller.EstimatedP99LatencyMicros(1));
+  controller.RecordBatchLatency(100, 7);
+  EXPECT_EQ(7, controller.EstimatedP99LatencyMicros(2));
+}
+
+TEST(BatchSizeControllerTest, EstimatesP99) {
+  BatchSizeController controller({1}, /*target_latency_micros=*/100,
+                                 /*window_size=*/200);
+  for (int i = 1; i <= 200; ++i) {
+    controller.RecordBatchLatency(1, i);
+  }
+  EXPECT_EQ(198, controller.EstimatedP99LatencyMicros(0));
+}
+
+}  // namespace
+}  // namespace serving
+}  // namespace tensorflow
@@ -25,6 +25,8 @@ limitations under the License.
 #include <functional>
 #include <list>
 #include <memory>
+#include <optional>
+#include <type_traits>
 #include <utility>
 #include <variant>
 #include <vector>
@@ -269,6 +271,25 @@ class SharedBatchScheduler
     // effective only when enable_priority_queue is true.
     MixedPriorityBatchingPolicy mixed_priority_batching_policy =
         MixedPriorityBatchingPolicy::kLowPriorityPaddingWithMaxBatchSize;
+
+    // If true, the deadlines reported by `BatchTask::deadline_micros()` are
+    // used to schedule tasks:
+    //  - Schedule() rejects a task whose deadline has already passed with a
+    //    DEADLINE_EXCEEDED error.
+    //  - The open batch becomes schedulable, even if it is neither full nor
+    //    timed out, once the earliest deadline of its tasks is less than
+    //    `deadline_slack_micros` away.
+    //  - Batch threads take the batch with the earliest deadline among the
+    //    queues that have deadline scheduling enabled before visiting the
+    //    queues round-robin.
+    //
+    // Must be false if `enable_lazy_split` is true.
+    bool enable_deadline_scheduling = false;
+
+    // How long before the earliest task deadline the open batch is scheduled,
+    // e.g. the expected time for a batch thread to pick it up. Used iff
+    // `enable_deadline_scheduling` is true.
+    int64_t deadline_slack_micros = 0;
   };
   Status AddQueue(const QueueOptions& options,
                   ProcessBatchCallback process_batch_callback,
@@ -410,6 +431,11 @@ class Queue {
   // Batches are guaranteed to form at task enqueue time.
   std::unique_ptr<Batch<TaskType>> ScheduleBatchWithEagerSplit();
 
+  // Returns the earliest task deadline of the batch that `ScheduleBatch()`
+  // would return now. Returns the null value if there is no such batch, if its
+  // tasks have no deadlines, or if deadline scheduling is disabled.
+  std::optional<uint64> SchedulableBatchDeadlineMicros() const;
+
   // Retrieves the low priority tasks that can be padded to a high priority
   // batch of the specified size.
   std::vector<std::unique_ptr<TaskType>> GetLowPriorityTasksForPadding(
@@ -451,6 +477,18 @@ class Queue {
   // Returns true iff the task is a low priority task based on the queue option.
   bool IsLowPriorityTask(std::unique_ptr<TaskType>* task);
 
+  // Returns the deadline of `task`. The deadline is defined only when the task
+  // is a derived class of BatchTask.
+  static std::optional<uint64> TaskDeadlineMicros(const TaskType& task);
+
+  // Returns the earliest deadline of the tasks in `batch`.
+  static std::optional<uint64> EarliestDeadlineMicros(
+      const Batch<TaskType>& batch);
+
+  // Returns a DEADLINE_EXCEEDED error if deadline scheduling is enabled and
+  // the deadline of `task` has passed.
+  Status ValidateTaskDeadline(const TaskType& task) const;
+
   // Implementation of ScheduleWithoutOrEagerSplit above. Enqueues `task` as it
   // is or split it inline (eagerly) to form batches to be processed by
   // `Queue<TaskType>::ProcessBatch`
@@ -590,6 +628,10 @@ class Queue {
   // task.
   uint64 open_batch_start_time_micros_ TF_GUARDED_BY(mu_);
 
+  // The earliest deadline of the tasks in the open (back-most) batch in
+  // 'high_priority_batches_'. Maintained iff deadline scheduling is enabled.
+  std::optional<uint64> open_batch_deadline_micros_ TF_GUARDED_BY(mu_);
+
   // Whether this queue contains a batch that is eligible to be scheduled.
   // Used to keep track of when to call 'schedulable_batch_callback_'.
   bool schedulable_batch_ TF_GUARDED_BY(mu_) = false;
@@ -722,6 +764,17 @@ Status SharedBatchScheduler<TaskType>::AddQueueAfterRewritingOptions(
         "enable_large_batch_splitting is enabled.");
   }
 
+  if (options.enable_deadline_scheduling && options.enable_lazy_split) {
+    return errors::InvalidArgument(
+        "enable_deadline_scheduling is not supported with enable_lazy_split.");
+  }
+
+  if (options.deadline_slack_micros < 0) {
+    return errors::InvalidArgument(
+        "deadline_slack_micros must be non-negative; was ",
+        options.deadline_slack_micros);
+  }
+
   if (options.enable_large_batch_splitting &&
       (options.input_batch_size_limit < options.max_execution_batch_size)) {
     return errors::InvalidArgument(
@@ -784,6 +837,29 @@ void SharedBatchScheduler<TaskType>::GetNextWorkItem_Locked(
     BatchUniquePtr* batch_to_process_out) {
   BatchUniquePtr batch_to_process;
   internal::Queue<TaskType>* queue_for_batch = nullptr;
+
+  // Serve the most urgent batch first, if any queue has one with a deadline.
+  internal::Queue<TaskType>* most_urgent_queue = nullptr;
+  std::optional<uint64> earliest_deadline_micros;
+  for (const auto& queue : queues_) {
+    const std::optional<uint64> deadline_micros =
+        queue->SchedulableBatchDeadlineMicros();
+    if (deadline_micros.has_value() &&
+        (!earliest_deadline_micros.has_value() ||
+         *deadline_micros < *earliest_deadline_micros)) {
+      earliest_deadline_micros = deadline_micros;
+      most_urgent_queue = queue.get();
+    }
+  }
+  if (most_urgent_queue != nullptr) {
+    batch_to_process = most_urgent_queue->ScheduleBatch();
+    if (BatchExists(batch_to_process)) {
+      *queue_for_batch_out = most_urgent_queue;
+      *batch_to_process_out = std::move(batch_to_process);
+      return;
+    }
+  }
+
   const int num_queues = queues_.size();
   for (int num_queues_tried = 0;
        !BatchExists(batch_to_process) && num_queues_tried < num_queues;
@@ -1034,6 +1110,16 @@ Status Queue<TaskType>::ScheduleWithoutOrEagerSplitImpl(
     }
     if (batches.back()->empty()) {
       open_batch_start_time_micros_ = env_->NowMicros();
+      open_batch_deadline_micros_.reset();
+    }
+    if (options_.enable_deadline_scheduling) {
+      const std::optional<uint64> deadline_micros =
+          TaskDeadlineMicros(*output_tasks[i]);
+      if (deadline_micros.has_value() &&
+          (!open_batch_deadline_micros_.has_value() ||
+           *deadline_micros < *open_batch_deadline_micros_)) {
+        open_batch_deadline_micros_ = deadline_micros;
+      }
     }
     profiler::TraceMeProducer trace_me(
         [&output_tasks, i] {
@@ -1068,6 +1154,8 @@ Status Queue<TaskType>::ScheduleWithoutOrEagerSplit(
 
     DCHECK(!closed_);
 
+    TF_RETURN_IF_ERROR(ValidateTaskDeadline(**task));
+
     if (IsLowPriorityTask(task)) {
       // Insert the task to the low priority task queue instead of the high
       // priority batch queue below.
@@ -1417,6 +1505,12 @@ bool Queue<TaskType>::IsOpenBatchSchedulableAfterEagerSplit() const {
   if (open_batch->empty()) {
     return false;
   }
+  if (options_.enable_deadline_scheduling &&
+      open_batch_deadline_micros_.has_value() &&
+      env_->NowMicros() + options_.deadline_slack_micros >=
+          *open_batch_deadline_micros_) {
+    return true;
+  }
   return closed_ || open_batch->size() >= max_execution_batch_size() ||
          env_->NowMicros() >=
              open_batch_start_time_micros_ + options_.batch_timeout_micros;
@@ -1469,6 +1563,63 @@ std::unique_ptr<Batch<TaskType>> Queue<TaskType>::ScheduleLowPriorityBatch() {
   return batch_to_schedule;
 }
 
+template <typename TaskType>
+std::optional<uint64> Queue<TaskType>::SchedulableBatchDeadlineMicros() const {
+  if (!options_.enable_deadline_scheduling) {
+    return std::nullopt;
+  }
+  mutex_lock l(mu_);
+  const std::deque<std::unique_ptr<Batch<TaskType>>>& batches = GetBatches();
+  if (batches.size() >= 2) {
+    return EarliestDeadlineMicros(*batches.front());
+  }
+  if (IsOpenBatchSchedulable()) {
+    return open_batch_deadline_micros_;
+  }
+  return std::nullopt;
+}
+
+template <typename TaskType>
+std::optional<uint64> Queue<TaskType>::TaskDeadlineMicros(
+    const TaskType& task) {
+  if constexpr (std::is_base_of_v<BatchTask, TaskType>) {
+    return task.deadline_micros();
+  } else {
+    return std::nullopt;
+  }
+}
+
+template <typename TaskType>
+std::optional<uint64> Queue<TaskType>::EarliestDeadlineMicros(
+    const Batch<TaskType>& batch) {
+  std::optional<uint64> earliest_deadline_micros;
+  for (int i = 0; i < batch.num_tasks(); ++i) {
+    const std::optional<uint64> deadline_micros =
+        TaskDeadlineMicros(batch.task(i));
+    if (deadline_micros.has_value() &&
+        (!earliest_deadline_micros.has_value() ||
+         *deadline_micros < *earliest_deadline_micros)) {
+      earliest_deadline_micros = deadline_micros;
+    }
+  }
+  return earliest_deadline_micros;
+}
+
+template <typename TaskType>
+Status Queue<TaskType>::ValidateTaskDeadline(const TaskType& task) const {
+  if (!options_.enable_deadline_scheduling) {
+    return absl::OkStatus();
+  }
+  const std::optional<uint64> deadline_micros = TaskDeadlineMicros(task);
+  const uint64 now_micros = env_->NowMicros();
+  if (deadline_micros.has_value() && *deadline_micros < now_micros) {
+    return absl::DeadlineExceededError(absl::StrFormat(
+        "The task deadline passed %d microseconds before it was scheduled",
+        now_micros - *deadline_micros));
+  }
+  return absl::OkStatus();
+}
+
 template <typename TaskType>
 size_t Queue<TaskType>::tail_batch_task_size() const {
   if (options_.enable_lazy_split) {
@@ -17,6 +17,7 @@ limitations under the License.
 
 #include <cstddef>
 #include <memory>
+#include <optional>
 #include <string>
 #include <thread>  // NOLINT(build/c++11)
 #include <tuple>
@@ -51,8 +52,11 @@ using ::testing::HasSubstr;
 class FakeTask : public BatchTask {
  public:
   explicit FakeTask(size_t size, tsl::criticality::Criticality criticality =
-                                     tsl::criticality::Criticality::kCritical)
-      : size_(size), criticality_(criticality) {}
+                                     tsl::criticality::Criticality::kCritical,
+                    std::optional<uint64> deadline_micros = std::nullopt)
+      : size_(size),
+        criticality_(criticality),
+        deadline_micros_(deadline_micros) {}
 
   ~FakeTask() override = default;
 
@@ -62,9 +66,14 @@ class FakeTask : public BatchTask {
     return criticality_;
   }
 
+  std::optional<uint64> deadline_micros() const override {
+    return deadline_micros_;
+  }
+
  private:
   const size_t size_;
   const tsl::criticality::Criticality criticality_;
+  const std::optional<uint64> deadline_micros_;
 
   FakeTask(const FakeTask&) = delete;
   void operator=(const FakeTask&) = delete;
@@ -108,6 +117,18 @@ Status ScheduleTask(size_t task_size, BatchScheduler<FakeTask>* scheduler,
   return status;
 }
 
+// Creates a FakeTask of size 'task_size' with a deadline of 'deadline_micros',
+// and calls 'scheduler->Schedule()' on that task. Returns the resulting status.
+Status ScheduleTaskWithDeadline(size_t task_size, uint64 deadline_micros,
+                                BatchScheduler<FakeTask>* scheduler) {
+  std::unique_ptr<FakeTask> task(new FakeTask(
+      task_size, tsl::criticality::Criticality::kCritical, deadline_micros));
+  Status status = scheduler->Schedule(&task);
+  // Schedule() should have consumed 'task' iff it returned Status::OK.
+  CHECK_EQ(status.ok(), task == nullptr);
+  return status;
+}
+
 // Helper function similar to the function above. Creates a FakeTask of size
 // 'task_size' and calls 'scheduler->Schedule()' on that task. Returns the
 // resulting status.
@@ -1063,6 +1084,120 @@ INSTANTIATE_TEST_SUITE_P(
                       std::make_tuple(/*enable_input_batch_split=*/false,
                                       /*enable_lazy_split=*/false)));
 
+class SharedBatchSchedulerDeadlineTest
+    : public ::testing::TestWithParam<bool>,
+      public SharedBatchSchedulerTestBase {
+ protected:
+  bool enable_input_batch_split() const override { return GetParam(); }
+
+  bool enable_lazy_split() const override { return false; }
+
+  QueueOptions CreateDeadlineQueueOptions(int64_t deadline_slack_micros) {
+    QueueOptions options = CreateQueueOptions(
+        /*max_execution_batch_size=*/4, /*input_batch_size_limit=*/4,
+        /*batch_timeout_micros=*/1000 * 1000 * 1000,
+        /*max_enqueued_batches=*/2);
+    options.enable_deadline_scheduling = true;
+    options.deadline_slack_micros = deadline_slack_micros;
+    return options;
+  }
+};
+
+TEST_P(SharedBatchSchedulerDeadlineTest, InvalidWithLazySplit) {
+  auto callback = [](std::unique_ptr<Batch<FakeTask>> batch) {};
+  auto scheduler = CreateSharedBatchScheduler(1);
+  QueueOptions options = CreateDeadlineQueueOptions(0);
+  options.enable_large_batch_splitting = true;
+  options.split_input_task_func = get_split_func();
+  options.enable_lazy_split = true;
+  std::unique_ptr<Queue> queue;
+  EXPECT_THAT(
+      scheduler->AddQueue(options, callback, &queue),
+      testing::StatusIs(error::INVALID_ARGUMENT,
+                        HasSubstr("enable_deadline_scheduling is not "
+                                  "supported with enable_lazy_split")));
+}
+
+TEST_P(SharedBatchSchedulerDeadlineTest, SchedulesOpenBatchBeforeDeadline) {
+  test_util::FakeClockEnv env(Env::Default());
+  Notification start_teardown, stop_teardown;
+  std::unique_ptr<Thread> teardown_thread =
+      CreateFakeClockAdvancerThread(&env, &start_teardown, &stop_teardown);
+
+  {
+    Notification batch_processed;
+    auto callback = [&](std::unique_ptr<Batch<FakeTask>> batch) {
+      ASSERT_TRUE(batch->IsClosed());
+      EXPECT_EQ(2, batch->size());
+      batch_processed.Notify();
+    };
+    auto scheduler = CreateSharedBatchScheduler(1, &env);
+    auto queue = CreateQueue(scheduler, CreateDeadlineQueueOptions(10),
+                             callback);
+
+    env.AdvanceByMicroseconds(100);
+    // Tasks whose deadline has already passed are rejected.
+    EXPECT_THAT(ScheduleTaskWithDeadline(1, 50, queue.get()),
+                testing::StatusIs(absl::StatusCode::kDeadlineExceeded));
+
+    TF_ASSERT_OK(ScheduleTaskWithDeadline(1, 300, queue.get()));
+    TF_ASSERT_OK(ScheduleTaskWithDeadline(1, 200, queue.get()));
+    // The partial batch is scheduled once the earliest deadline is within the
+    // slack, long before the batch timeout.
+    env.AdvanceByMicroseconds(89);
+    Env::Default()->SleepForMicroseconds(10 * 1000 /* 10 milliseconds */);
+    EXPECT_FALSE(batch_processed.HasBeenNotified());
+    env.AdvanceByMicroseconds(1);
+    batch_processed.WaitForNotification();
+
+    start_teardown.Notify();
+  }
+  stop_teardown.Notify();
+}
+
+TEST_P(SharedBatchSchedulerDeadlineTest, ServesMostUrgentQueueFirst) {
+  mutex mu;
+  std::vector<int> processed_queues;
+  Notification blocking_batch_started, proceed;
+  auto make_callback = [&](int queue_index) {
+    return [&, queue_index](std::unique_ptr<Batch<FakeTask>> batch) {
+      if (queue_index == 0) {
+        blocking_batch_started.Notify();
+        proceed.WaitForNotification();
+        return;
+      }
+      mutex_lock l(mu);
+      processed_queues.push_back(queue_index);
+    };
+  };
+
+  {
+    auto scheduler = CreateSharedBatchScheduler(1);
+    // Queue 0 occupies the only batch thread, so that the batches of the other
+    // queues are pending when the thread becomes available.
+    auto blocking_queue = CreateQueue(scheduler, CreateDeadlineQueueOptions(0),
+                                      make_callback(0));
+    auto lax_queue = CreateQueue(scheduler, CreateDeadlineQueueOptions(0),
+                                 make_callback(1));
+    auto urgent_queue = CreateQueue(scheduler, CreateDeadlineQueueOptions(0),
+                                    make_callback(2));
+    TF_ASSERT_OK(ScheduleTask(4, blocking_queue.get()));
+    blocking_batch_started.WaitForNotification();
+
+    const uint64 now_micros = Env::Default()->NowMicros();
+    const uint64 kSecondMicros = 1000 * 1000;
+    TF_ASSERT_OK(ScheduleTaskWithDeadline(4, now_micros + 1000 * kSecondMicros,
+                                          lax_queue.get()));
+    TF_ASSERT_OK(ScheduleTaskWithDeadline(4, now_micros + 100 * kSecondMicros,
+                                          urgent_queue.get()));
+    proceed.Notify();
+  }
+  EXPECT_THAT(processed_queues, ::testing::ElementsAre(2, 1));
+}
+
+INSTANTIATE_TEST_SUITE_P(Parameter, SharedBatchSchedulerDeadlineTest,
+                         ::testing::Bool());
+
 class SharedBatchSchedulerPriorityTest
     : public ::testing::TestWithParam<
           std::tuple<bool, bool, MixedPriorityBatchingPolicy>>,
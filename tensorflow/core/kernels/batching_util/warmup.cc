@@ -14,14 +14,22 @@ limitations under the License.
 ==============================================================================*/
 #include "tensorflow/core/kernels/batching_util/warmup.h"
 
+#include <algorithm>
+#include <cstdint>
 #include <memory>
 #include <optional>
+#include <string>
 #include <utility>
+#include <vector>
 
 #include "absl/status/status.h"
 #include "absl/strings/str_cat.h"
 #include "absl/synchronization/mutex.h"
 #include "tensorflow/core/framework/op_kernel.h"
+#include "tensorflow/core/framework/tensor.pb.h"
+#include "tensorflow/core/framework/types.h"
+#include "tensorflow/core/platform/errors.h"
+#include "tensorflow/core/platform/threadpool.h"
 #include "tsl/platform/logging.h"
 
 namespace tensorflow {
@@ -78,5 +86,154 @@ bool ShouldWarmupAllBatchSizes(const OpKernelContext* c) {
   return per_model_data && per_model_data->warmup_all_batch_sizes;
 }
 
+absl::Status WarmupSignatureRecorder::StartRecording(
+    const WarmupStateRegistry::Key& model_key, int64_t sample_period,
+    int64_t max_signatures) {
+  if (sample_period <= 0 || max_signatures <= 0) {
+    return absl::InvalidArgumentError(absl::StrCat(
+        "sample_period and max_signatures must be positive; got ",
+        sample_period, " and ", max_signatures));
+  }
+  absl::MutexLock l(&mu_);
+  auto recording = std::make_unique<Recording>();
+  recording->sample_period = sample_period;
+  recording->max_signatures = max_signatures;
+  if (!recordings_.insert({model_key, std::move(recording)}).second) {
+    return absl::AlreadyExistsError(
+        absl::StrCat("Model ", model_key.name, ":", model_key.version,
+                     " is already being recorded"));
+  }
+  VLOG(1) << "Recording warm-up signatures of model " << model_key.name << ":"
+          << model_key.version;
+  num_recordings_.fetch_add(1, std::memory_order_relaxed);
+  return absl::OkStatus();
+}
+
+absl::StatusOr<WarmupSignatures> WarmupSignatureRecorder::StopRecording(
+    const WarmupStateRegistry::Key& model_key) {
+  std::unique_ptr<Recording> recording;
+  {
+    absl::MutexLock l(&mu_);
+    auto it = recordings_.find(model_key);
+    if (it == recordings_.end()) {
+      return absl::NotFoundError(
+          absl::StrCat("Model ", model_key.name, ":", model_key.version,
+                       " is not being recorded"));
+    }
+    recording = std::move(it->second);
+    recordings_.erase(it);
+    num_recordings_.fetch_sub(1, std::memory_order_relaxed);
+  }
+  WarmupSignatures signatures;
+  signatures.set_model_name(model_key.name);
+  signatures.set_model_version(model_key.version);
+  std::vector<WarmupSignature*> sorted;
+  sorted.reserve(recording->signatures.size());
+  for (auto& [key, signature] : recording->signatures) {
+    sorted.push_back(&signature);
+  }
+  std::sort(sorted.begin(), sorted.end(),
+            [](const WarmupSignature* a, const WarmupSignature* b) {
+              return a->count() > b->count();
+            });
+  for (WarmupSignature* signature : sorted) {
+    *signatures.add_signatures() = std::move(*signature);
+  }
+  return signatures;
+}
+
+void WarmupSignatureRecorder::MaybeRecord(
+    const WarmupStateRegistry::Key& model_key, absl::string_view op_name,
+    absl::Span<const Tensor> inputs) {
+  absl::MutexLock l(&mu_);
+  auto it = recordings_.find(model_key);
+  if (it == recordings_.end()) {
+    return;
+  }
+  Recording& recording = *it->second;
+  if (recording.num_requests++ % recording.sample_period != 0) {
+    return;
+  }
+  std::string key(op_name);
+  for (const Tensor& input : inputs) {
+    absl::StrAppend(&key, ";", static_cast<int>(input.dtype()), ":",
+                    input.shape().DebugString());
+  }
+  auto signature_it = recording.signatures.find(key);
+  if (signature_it == recording.signatures.end()) {
+    if (recording.signatures.size() >= recording.max_signatures) {
+      return;
+    }
+    WarmupSignature signature;
+    signature.set_op_name(std::string(op_name));
+    for (const Tensor& input : inputs) {
+      WarmupTensorSignature* tensor_signature = signature.add_inputs();
+      tensor_signature->set_dtype(input.dtype());
+      input.shape().AsProto(tensor_signature->mutable_shape());
+    }
+    signature_it =
+        recording.signatures.insert({key, std::move(signature)}).first;
+  }
+  signature_it->second.set_count(signature_it->second.count() + 1);
+}
+
+WarmupSignatureRecorder& GetGlobalWarmupSignatureRecorder() {
+  static auto* const recorder = new WarmupSignatureRecorder;
+  return *recorder;
+}
+
+absl::Status WriteWarmupSignatures(Env* env, const std::string& filename,
+                                   const WarmupSignatures& signatures) {
+  return WriteBinaryProto(env, filename, signatures);
+}
+
+absl::StatusOr<WarmupSignatures> ReadWarmupSignatures(
+    Env* env, const std::string& filename) {
+  WarmupSignatures signatures;
+  TF_RETURN_IF_ERROR(ReadBinaryProto(env, filename, &signatures));
+  return signatures;
+}
+
+absl::Status ReplayWarmupSignatures(const WarmupSignatures& signatures,
+                                    int num_threads,
+                                    const WarmupSignatureRunner& run) {
+  if (num_threads <= 0) {
+    return absl::InvalidArgumentError(
+        absl::StrCat("num_threads must be positive; got ", num_threads));
+  }
+  absl::Mutex mu;
+  absl::Status status;
+  {
+    thread::ThreadPool pool(Env::Default(), "warmup_replay", num_threads);
+    for (const WarmupSignature& signature : signatures.signatures()) {
+      pool.Schedule([&signature, &run, &mu, &status]() {
+        std::vector<Tensor> inputs(signature.inputs_size());
+        absl::Status run_status;
+        for (int i = 0; i < signature.inputs_size(); ++i) {
+          // A `TensorProto` without values parses to a tensor of zeros.
+          TensorProto proto;
+          proto.set_dtype(signature.inputs(i).dtype());
+          *proto.mutable_tensor_shape() = signature.inputs(i).shape();
+          if (!inputs[i].FromProto(proto)) {
+            run_status = absl::InvalidArgumentError(absl::StrCat(
+                "Invalid warm-up input ", i, " of batch op ",
+                signature.op_name(), ": ", proto.ShortDebugString()));
+            break;
+          }
+        }
+        if (run_status.ok()) {
+          run_status = run(signature, std::move(inputs));
+        }
+        absl::MutexLock l(&mu);
+        status.Update(run_status);
+      });
+    }
+  }
+  VLOG(1) << "Replayed " << signatures.signatures_size()
+          << " warm-up signatures of model " << signatures.model_name() << ":"
+          << signatures.model_version() << " with status " << status;
+  return status;
+}
+
 }  // namespace serving
 }  // namespace tensorflow
@@ -16,16 +16,26 @@ limitations under the License.
 #ifndef TENSORFLOW_CORE_KERNELS_BATCHING_UTIL_WARMUP_H_
 #define TENSORFLOW_CORE_KERNELS_BATCHING_UTIL_WARMUP_H_
 
+#include <atomic>
+#include <cstdint>
+#include <functional>
 #include <memory>
 #include <optional>
 #include <string>
 #include <utility>
+#include <vector>
 
 #include "absl/container/flat_hash_map.h"
 #include "absl/hash/hash.h"
+#include "absl/status/status.h"
 #include "absl/status/statusor.h"
+#include "absl/strings/string_view.h"
 #include "absl/synchronization/mutex.h"
+#include "absl/types/span.h"
 #include "tensorflow/core/framework/op_kernel.h"
+#include "tensorflow/core/framework/tensor.h"
+#include "tensorflow/core/kernels/batching_util/warmup_signatures.pb.h"
+#include "tensorflow/core/platform/env.h"
 #include "tensorflow/core/protobuf/config.pb.h"
 #include "tsl/platform/logging.h"
 
@@ -126,6 +136,75 @@ WarmupStateRegistry& GetGlobalWarmupStateRegistry();
 // based on the state of WarmupStateRegistry.
 bool ShouldWarmupAllBatchSizes(const OpKernelContext* c);
 
+// Samples the signatures, i.e. the dtypes and shapes of the inputs, of the
+// requests that batch ops receive while a model serves traffic. The signatures
+// can be written to a warmup file and replayed when the next version of the
+// model is loaded, which warms up the executables of the batch sizes and
+// shapes that are actually served, e.g. XLA compilations and cached kernels.
+class WarmupSignatureRecorder {
+ public:
+  static constexpr int64_t kDefaultMaxSignatures = 1024;
+
+  // Starts recording one in every `sample_period` requests of the model. At
+  // most `max_signatures` distinct signatures are kept; requests with other
+  // signatures are not recorded once the limit is reached.
+  absl::Status StartRecording(const WarmupStateRegistry::Key& model_key,
+                              int64_t sample_period,
+                              int64_t max_signatures = kDefaultMaxSignatures);
+
+  // Stops recording the model and returns its signatures.
+  absl::StatusOr<WarmupSignatures> StopRecording(
+      const WarmupStateRegistry::Key& model_key);
+
+  // Returns true if any model is being recorded. Cheap enough to be called for
+  // every request.
+  bool IsRecording() const {
+    return num_recordings_.load(std::memory_order_relaxed) > 0;
+  }
+
+  // Records the inputs of a request to the batch op `op_name` if the model is
+  // being recorded and the request is sampled.
+  void MaybeRecord(const WarmupStateRegistry::Key& model_key,
+                   absl::string_view op_name, absl::Span<const Tensor> inputs);
+
+ private:
+  struct Recording {
+    int64_t sample_period;
+    int64_t max_signatures;
+    int64_t num_requests = 0;
+    // Keyed by a string encoding of the signature.
+    absl::flat_hash_map<std::string, WarmupSignature> signatures;
+  };
+
+  std::atomic<int64_t> num_recordings_{0};
+  absl::Mutex mu_;
+  absl::flat_hash_map<WarmupStateRegistry::Key, std::unique_ptr<Recording>>
+      recordings_ ABSL_GUARDED_BY(&mu_);
+};
+
+WarmupSignatureRecorder& GetGlobalWarmupSignatureRecorder();
+
+// Writes and reads the warmup file of a model.
+absl::Status WriteWarmupSignatures(Env* env, const std::string& filename,
+                                   const WarmupSignatures& signatures);
+absl::StatusOr<WarmupSignatures> ReadWarmupSignatures(
+    Env* env, const std::string& filename);
+
+// Runs a request to the batch op of `signature` with the given inputs. The
+// caller maps the inputs of the batch op to a request of the model, e.g. its
+// `Session::Run` feeds.
+using WarmupSignatureRunner = std::function<absl::Status(
+    const WarmupSignature& signature, std::vector<Tensor> inputs)>;
+
+// Replays `signatures` by calling `run` once for each signature, with inputs
+// of the recorded dtypes and shapes filled with zeros, on `num_threads`
+// threads. The model should be registered in the `WarmupStateRegistry` while
+// the signatures are replayed, so that the batch ops do not batch the warmup
+// requests together. Returns the first error of `run`.
+absl::Status ReplayWarmupSignatures(const WarmupSignatures& signatures,
+                                    int num_threads,
+                                    const WarmupSignatureRunner& run);
+
 }  // namespace serving
 }  // namespace tensorflow
 
@@ -0,0 +1,146 @@
+/* Copyright 2024 The TensorFlow Authors. All Rights Reserved.
+
+Licensed under the Apache License, Version 2.0 (the "License");
+you may not use this file except in compliance with the License.
+You may obtain a copy of the License at
+
+    http://www.apache.org/licenses/LICENSE-2.0
+
+Unless required by applicable law or agreed to in writing, software
+distributed under the License is distributed on an "AS IS" BASIS,
+WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+See the License for the specific language governing permissions and
+limitations under the License.
+==============================================================================*/
+#include "tensorflow/core/kernels/batching_util/warmup.h"
+
+#include <string>
+#include <vector>
+
+#include "absl/status/status.h"
+#include "absl/synchronization/mutex.h"
+#include "tensorflow/core/framework/tensor.h"
+#include "tensorflow/core/framework/tensor_shape.h"
+#include "tensorflow/core/framework/tensor_testutil.h"
+#include "tensorflow/core/kernels/batching_util/warmup_signatures.pb.h"
+#include "tensorflow/core/lib/core/status_test_util.h"
+#include "tensorflow/core/platform/env.h"
+#include "tensorflow/core/platform/path.h"
+#include "tensorflow/core/platform/test.h"
+
+namespace tensorflow {
+namespace serving {
+namespace {
+
+TEST(WarmupSignatureRecorderTest, RecordsSampledSignatures) {
+  WarmupSignatureRecorder recorder;
+  const WarmupStateRegistry::Key key("model", 1);
+  EXPECT_FALSE(recorder.IsRecording());
+  TF_ASSERT_OK(recorder.StartRecording(key, /*sample_period=*/2));
+  EXPECT_TRUE(recorder.IsRecording());
+
+  const Tensor small(DT_FLOAT, TensorShape({1, 3}));
+  const Tensor large(DT_FLOAT, TensorShape({4, 3}));
+  for (int i = 0; i < 4; ++i) {
+    recorder.MaybeRecord(key, "batch", {large});
+  }
+  for (int i = 0; i < 2; ++i) {
+    recorder.MaybeRecord(key, "batch", {small});
+  }
+  // Other models are not recorded.
+  recorder.MaybeRecord({"other_model", 1}, "batch", {small});
+
+  TF_ASSERT_OK_AND_ASSIGN(WarmupSignatures signatures,
+                          recorder.StopRecording(key));
+  EXPECT_FALSE(recorder.IsRecording());
+  EXPECT_EQ(signatures.model_name(), "model");
+  EXPECT_EQ(signatures.model_version(), 1);
+  ASSERT_EQ(signatures.signatures_size(), 2);
+  EXPECT_EQ(signatures.signatures(0).op_name(), "batch");
+  EXPECT_EQ(signatures.signatures(0).count(), 2);
+  ASSERT_EQ(signatures.signatures(0).inputs_size(), 1);
+  EXPECT_EQ(signatures.signatures(0).inputs(0).dtype(), DT_FLOAT);
+  EXPECT_EQ(TensorShape(signatures.signatures(0).inputs(0).shape()),
+            large.shape());
+  EXPECT_EQ(signatures.signatures(1).count(), 1);
+  EXPECT_EQ(TensorShape(signatures.signatures(1).inputs(0).shape()),
+            small.shape());
+}
+
+TEST(WarmupSignatureRecorderTest, LimitsNumberOfSignatures) {
+  WarmupSignatureRecorder recorder;
+  const WarmupStateRegistry::Key key("model", 1);
+  TF_ASSERT_OK(recorder.StartRecording(key, /*sample_period=*/1,
+                                       /*max_signatures=*/2));
+  for (int batch_size = 1; batch_size <= 4; ++batch_size) {
+    recorder.MaybeRecord(key, "batch",
+                         {Tensor(DT_INT32, TensorShape({batch_size}))});
+  }
+  recorder.MaybeRecord(key, "batch", {Tensor(DT_INT32, TensorShape({1}))});
+  TF_ASSERT_OK_AND_ASSIGN(WarmupSignatures signatures,
+                          recorder.StopRecording(key));
+  ASSERT_EQ(signatures.signatures_size(), 2);
+  EXPECT_EQ(signatures.signatures(0).count(), 2);
+  EXPECT_EQ(signatures.signatures(1).count(), 1);
+}
+
+TEST(WarmupSignatureRecorderTest, BadRecordings) {
+  WarmupSignatureRecorder recorder;
+  const WarmupStateRegistry::Key key("model", 1);
+  EXPECT_FALSE(recorder.StartRecording(key, /*sample_period=*/0).ok());
+  EXPECT_FALSE(recorder.StopRecording(key).ok());
+  TF_ASSERT_OK(recorder.StartRecording(key, /*sample_period=*/1));
+  EXPECT_FALSE(recorder.StartRecording(key, /*sample_period=*/1).ok());
+  TF_EXPECT_OK(recorder.StopRecording(key).status());
+}
+
+TEST(WarmupSignaturesTest, WriteAndRead) {
+  WarmupSignatures signatures;
+  signatures.set_model_name("model");
+  WarmupSignature* signature = signatures.add_signatures();
+  signature->set_op_name("batch");
+  signature->add_inputs()->set_dtype(DT_STRING);
+  const std::string filename =
+      io::JoinPath(testing::TmpDir(), "warmup_signatures");
+  TF_ASSERT_OK(WriteWarmupSignatures(Env::Default(), filename, signatures));
+  TF_ASSERT_OK_AND_ASSIGN(WarmupSignatures read,
+                          ReadWarmupSignatures(Env::Default(), filename));
+  EXPECT_EQ(read.DebugString(), signatures.DebugString());
+}
+
+TEST(WarmupSignaturesTest, Replay) {
+  WarmupSignatures signatures;
+  for (int batch_size = 1; batch_size <= 8; ++batch_size) {
+    WarmupTensorSignature* input =
+        signatures.add_signatures()->add_inputs();
+    input->set_dtype(DT_INT64);
+    TensorShape({batch_size, 2}).AsProto(input->mutable_shape());
+  }
+  absl::Mutex mu;
+  std::vector<int64_t> batch_sizes;
+  TF_ASSERT_OK(ReplayWarmupSignatures(
+      signatures, /*num_threads=*/4,
+      [&](const WarmupSignature& signature, std::vector<Tensor> inputs) {
+        EXPECT_EQ(inputs.size(), 1);
+        const int64_t batch_size = inputs[0].dim_size(0);
+        test::ExpectTensorEqual<int64_t>(
+            inputs[0],
+            test::AsTensor<int64_t>(std::vector<int64_t>(batch_size * 2, 0),
+                                    TensorShape({batch_size, 2})));
+        absl::MutexLock l(&mu);
+        batch_sizes.push_back(batch_size);
+        return absl::OkStatus();
+      }));
+  EXPECT_EQ(batch_sizes.size(), 8);
+
+  const absl::Status status = ReplayWarmupSignatures(
+      signatures, /*num_threads=*/4,
+      [](const WarmupSignature& signature, std::vector<Tensor> inputs) {
+        return absl::InternalError("failed");
+      });
+  EXPECT_EQ(status.code(), absl::StatusCode::kInternal);
+}
+
+}  // namespace
+}  // namespace serving
+}  // namespace tensorflow
@@ -15,14 +15,138 @@ limitations under the License.
 
 #include "tensorflow/core/kernels/cast_op_impl.h"
 
+#include <cstdint>
+#include <cstring>
+
+#include "tensorflow/core/platform/cpu_info.h"
 #include "tensorflow/core/util/work_sharder.h"
 
+#if defined(__x86_64__) && (defined(__clang__) || __GNUC__ >= 10)
+#include <immintrin.h>
+#define TF_CAST_HAS_AVX512_BF16 1
+#endif
+
+#if defined(__aarch64__) && defined(__ARM_FEATURE_BF16_VECTOR_ARITHMETIC)
+#include <arm_neon.h>
+#define TF_CAST_HAS_NEON_BF16 1
+#endif
+
 namespace tensorflow {
 
 typedef Eigen::ThreadPoolDevice CPUDevice;
 typedef Eigen::GpuDevice GPUDevice;
 
+namespace {
+
+// Converts the elements of `src` that fall in chunks of 32 to bfloat16 with
+// the hardware rounding instruction, and returns the number of elements
+// converted. The instructions flush denormals to zero and keep NaN payloads,
+// unlike bfloat16(float), so chunks holding such values are rounded by Eigen
+// to keep the results bit identical to the generic path.
+typedef int64_t (*ConvertFloatToBfloat16Fn)(const float* src, bfloat16* dst,
+                                            int64_t size);
+
+#if defined(TF_CAST_HAS_AVX512_BF16)
+__attribute__((target("avx512f,avx512dq,avx512bf16"))) int64_t
+ConvertFloatToBfloat16Avx512(const float* src, bfloat16* dst, int64_t size) {
+  // Quiet NaN, denormal and signaling NaN classes of VFPCLASSPS.
+  constexpr int kSpecialClasses = 0x01 | 0x20 | 0x80;
+  int64_t i = 0;
+  for (; i + 32 <= size; i += 32) {
+    const __m512 lo = _mm512_loadu_ps(src + i);
+    const __m512 hi = _mm512_loadu_ps(src + i + 16);
+    if ((_mm512_fpclass_ps_mask(lo, kSpecialClasses) |
+         _mm512_fpclass_ps_mask(hi, kSpecialClasses)) != 0) {
+      for (int j = 0; j < 32; ++j) dst[i + j] = bfloat16(src[i + j]);
+      continue;
+    }
+    // VCVTNE2PS2BF16 puts the elements of its second operand first.
+    const __m512bh packed = _mm512_cvtne2ps_pbh(hi, lo);
+    std::memcpy(dst + i, &packed, sizeof(packed));
+  }
+  return i;
+}
+#endif  // TF_CAST_HAS_AVX512_BF16
+
+#if defined(TF_CAST_HAS_NEON_BF16)
+int64_t ConvertFloatToBfloat16Neon(const float* src, bfloat16* dst,
+                                   int64_t size) {
+  const uint32x4_t abs_mask = vdupq_n_u32(0x7fffffff);
+  const uint32x4_t inf_bits = vdupq_n_u32(0x7f800000);
+  const uint32x4_t min_normal_bits = vdupq_n_u32(0x00800000);
+  int64_t i = 0;
+  for (; i + 32 <= size; i += 32) {
+    uint32x4_t special = vdupq_n_u32(0);
+    for (int j = 0; j < 32; j += 4) {
+      const uint32x4_t abs =
+          vandq_u32(vreinterpretq_u32_f32(vld1q_f32(src + i + j)), abs_mask);
+      const uint32x4_t denormal =
+          vandq_u32(vcltq_u32(abs, min_normal_bits), vtstq_u32(abs, abs));
+      special = vorrq_u32(special, vorrq_u32(vcgtq_u32(abs, inf_bits),
+                                             denormal));
+    }
+    if (vmaxvq_u32(special) != 0) {
+      for (int j = 0; j < 32; ++j) dst[i + j] = bfloat16(src[i + j]);
+      continue;
+    }
+    for (int j = 0; j < 32; j += 8) {
+      // BFCVTN and BFCVTN2 round the two halves of 8 elements.
+      const bfloat16x8_t packed = vcvtq_high_bf16_f32(
+          vcvtq_low_bf16_f32(vld1q_f32(src + i + j)),
+          vld1q_f32(src + i + j + 4));
+      std::memcpy(dst + i + j, &packed, sizeof(packed));
+    }
+  }
+  return i;
+}
+#endif  // TF_CAST_HAS_NEON_BF16
+
+// Returns the vectorized conversion supported by the host, or nullptr.
+ConvertFloatToBfloat16Fn GetConvertFloatToBfloat16Fn() {
+#if defined(TF_CAST_HAS_AVX512_BF16)
+  if (port::TestCPUFeature(port::CPUFeature::AVX512F) &&
+      port::TestCPUFeature(port::CPUFeature::AVX512DQ) &&
+      port::TestCPUFeature(port::CPUFeature::AVX512_BF16)) {
+    return ConvertFloatToBfloat16Avx512;
+  }
+#endif
+#if defined(TF_CAST_HAS_NEON_BF16)
+  return ConvertFloatToBfloat16Neon;
+#endif
+  return nullptr;
+}
+
+void CastFloatToBfloat16(OpKernelContext* ctx, const Tensor& inp,
+                         Tensor* out) {
+  static const ConvertFloatToBfloat16Fn convert =
+      GetConvertFloatToBfloat16Fn();
+  const float* src = inp.flat<float>().data();
+  bfloat16* dst = out->flat<bfloat16>().data();
+  auto work = [src, dst](int64_t begin, int64_t end) {
+    const int64_t done = convert(src + begin, dst + begin, end - begin);
+    for (int64_t i = begin + done; i < end; ++i) dst[i] = bfloat16(src[i]);
+  };
+  const DeviceBase::CpuWorkerThreads* worker_threads =
+      ctx->device()->tensorflow_cpu_worker_threads();
+  Shard(worker_threads->num_threads, worker_threads->workers,
+        inp.NumElements(), /*cost_per_unit=*/1, work);
+}
+
+}  // namespace
+
 CastFunctorType GetCpuCastFromFloat(DataType dst_dtype) {
+  if (dst_dtype == DT_BFLOAT16 && GetConvertFloatToBfloat16Fn() != nullptr) {
+    return [](OpKernelContext* ctx, const Tensor& inp, Tensor* out,
+              bool truncate) {
+      if (truncate) {
+        functor::CastFunctor<CPUDevice, bfloat16, float> func;
+        func(ctx->eigen_device<CPUDevice>(), out->flat<bfloat16>(),
+             inp.flat<float>(), truncate);
+        return;
+      }
+      CastFloatToBfloat16(ctx, inp, out);
+    };
+  }
   CURRY_TYPES3(CAST_CASE, CPUDevice, float);
   CAST_CASE(CPUDevice, float, float8_e5m2);
   CAST_CASE(CPUDevice, float, float8_e4m3fn);
@@ -14,7 +14,10 @@ limitations under the License.
 ==============================================================================*/
 
 #include <cstdint>
+#include <limits>
+#include <vector>
 
+#include "absl/base/casts.h"
 #include "tensorflow/core/common_runtime/kernel_benchmark_testlib.h"
 #include "tensorflow/core/framework/fake_input.h"
 #include "tensorflow/core/framework/node_def_builder.h"
@@ -156,6 +159,35 @@ TEST_CAST(uint4, uint4)
 #undef TEST_INT_CASTS_TO
 #undef TEST_CAST
 
+TEST_F(CastOpTest, FloatToBfloat16RoundsLikeScalar) {
+  MakeOp(DT_FLOAT, DT_BFLOAT16, /*trunc=*/false);
+  // Enough elements for the vectorized CPU conversion, with rounding ties,
+  // denormals, infinities and NaNs spread over some of its chunks.
+  const int num = 32 * 100 + 7;
+  std::vector<float> values(num);
+  uint32_t bits = 1;
+  for (int i = 0; i < num; ++i) {
+    bits = bits * 1664525u + 1013904223u;
+    values[i] = (i % 7 == 0) ? static_cast<float>(bits % 1000) / 8.0f
+                             : absl::bit_cast<float>(bits);
+  }
+  values[5] = std::numeric_limits<float>::denorm_min();
+  values[70] = -std::numeric_limits<float>::min() / 3;
+  values[100] = std::numeric_limits<float>::infinity();
+  values[140] = -std::numeric_limits<float>::quiet_NaN();
+  values[200] = absl::bit_cast<float>(0x7f800001u);
+  values[300] = absl::bit_cast<float>(0x3f808000u);
+  values[301] = absl::bit_cast<float>(0x3f818000u);
+  AddInputFromArray<float>(TensorShape({num}), values);
+  TF_ASSERT_OK(RunOpKernel());
+  const auto output = GetOutput(0)->flat<bfloat16>();
+  for (int i = 0; i < num; ++i) {
+    EXPECT_EQ(Eigen::numext::bit_cast<uint16_t>(output(i)),
+              Eigen::numext::bit_cast<uint16_t>(bfloat16(values[i])))
+        << "at index " << i;
+  }
+}
+
 // TODO(wicke): check conversions from/to bool, and bfloat16
 
 static void BM_cpu_float_int64(::testing::benchmark::State& state) {
@@ -214,7 +246,11 @@ static void BM_cpu_float_bfloat16(::testing::benchmark::State& state) {
   state.SetBytesProcessed(static_cast<int64_t>(state.iterations()) * num *
                           (sizeof(float) + sizeof(bfloat16)));
 }
-BENCHMARK(BM_cpu_float_bfloat16)->UseRealTime()->Arg(64 << 10)->Arg(32 << 20);
+BENCHMARK(BM_cpu_float_bfloat16)
+    ->UseRealTime()
+    ->Arg(64 << 10)
+    ->Arg(1 << 20)
+    ->Arg(32 << 20);
 
 static void BM_cpu_bfloat16_float(::testing::benchmark::State& state) {
   const int num = state.range(0);
@@ -226,7 +262,11 @@ static void BM_cpu_bfloat16_float(::testing::benchmark::State& state) {
   state.SetBytesProcessed(static_cast<int64_t>(state.iterations()) * num *
                           (sizeof(float) + sizeof(bfloat16)));
 }
-BENCHMARK(BM_cpu_bfloat16_float)->UseRealTime()->Arg(64 << 10)->Arg(32 << 20);
+BENCHMARK(BM_cpu_bfloat16_float)
+    ->UseRealTime()
+    ->Arg(64 << 10)
+    ->Arg(1 << 20)
+    ->Arg(32 << 20);
 
 static void BM_cpu_float_half(::testing::benchmark::State& state) {
   const int num = state.range(0);
@@ -70,6 +70,7 @@ class ResourceCountUpToOp : public OpKernel {
     OP_REQUIRES_OK(context, LookupResource(context, HandleFromInput(context, 0),
                                            &variable));
     mutex_lock l(*variable->mu());
+    variable->MarkAllRowsDirty();
     Tensor before_increment = *variable->tensor();
     OP_REQUIRES(
         context, TensorShapeUtils::IsScalar(before_increment.shape()),
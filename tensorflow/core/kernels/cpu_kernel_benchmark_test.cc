@@ -0,0 +1,379 @@
+/* Copyright 2024 The TensorFlow Authors. All Rights Reserved.
+
+Licensed under the Apache License, Version 2.0 (the "License");
+you may not use this file except in compliance with the License.
+You may obtain a copy of the License at
+
+    http://www.apache.org/licenses/LICENSE-2.0
+
+Unless required by applicable law or agreed to in writing, software
+distributed under the License is distributed on an "AS IS" BASIS,
+WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+See the License for the specific language governing permissions and
+limitations under the License.
+==============================================================================*/
+
+// Benchmarks of the CPU kernels of the ops that dominate production models,
+// with shapes taken from those models. Every benchmark runs each of its shapes
+// with each of kNumThreads intra-op threads, and is named
+// BM_<Op>/shape:<index>/threads:<n>, with the shape described in its label.
+//
+// The results are tracked across releases by
+// //tensorflow/tools/test:cpu_kernel_benchmark, which converts them to
+// TestResults (see test_log.proto).
+
+#include <cstring>
+#include <string>
+#include <vector>
+
+#include "tensorflow/core/common_runtime/kernel_benchmark_testlib.h"
+#include "tensorflow/core/example/example.pb.h"
+#include "tensorflow/core/example/feature.pb.h"
+#include "tensorflow/core/framework/tensor.h"
+#include "tensorflow/core/framework/tensor_shape.h"
+#include "tensorflow/core/framework/types.pb.h"
+#include "tensorflow/core/graph/algorithm.h"
+#include "tensorflow/core/graph/graph.h"
+#include "tensorflow/core/graph/node_builder.h"
+#include "tensorflow/core/graph/testlib.h"
+#include "tensorflow/core/lib/core/status_test_util.h"
+#include "tensorflow/core/lib/strings/strcat.h"
+#include "tensorflow/core/platform/macros.h"
+#include "tensorflow/core/platform/test.h"
+#include "tensorflow/core/platform/test_benchmark.h"
+#include "tensorflow/core/public/session_options.h"
+
+namespace tensorflow {
+namespace {
+
+// The intra-op thread counts that every shape runs with.
+constexpr int kNumThreads[] = {1, 4, 16};
+
+// Registers `num_shapes` x kNumThreads runs of a benchmark.
+void ShapesAndThreads(benchmark::internal::Benchmark* b, int num_shapes) {
+  b->ArgNames({"shape", "threads"});
+  for (int shape = 0; shape < num_shapes; ++shape) {
+    for (int threads : kNumThreads) {
+      b->Args({shape, threads});
+    }
+  }
+  b->UseRealTime();
+}
+
+#define CPU_KERNEL_BENCHMARK(fn, shapes)                                  \
+  BENCHMARK(fn)->Apply([](benchmark::internal::Benchmark* b) {           \
+    ShapesAndThreads(b, TF_ARRAYSIZE(shapes));                            \
+  })
+
+// Runs `g` on a CPU device with `state.range(1)` intra-op threads.
+void RunGraph(Graph* g, const std::string& label,
+              ::testing::benchmark::State& state) {
+  SessionOptions opts;
+  opts.config.set_intra_op_parallelism_threads(state.range(1));
+  opts.config.set_inter_op_parallelism_threads(1);
+  test::Benchmark("cpu", g, &opts, nullptr, nullptr, "",
+                  /*old_benchmark_api=*/false)
+      .Run(state);
+  state.SetLabel(label);
+}
+
+Tensor RandomFloats(const TensorShape& shape) {
+  Tensor t(DT_FLOAT, shape);
+  t.flat<float>().setRandom();
+  return t;
+}
+
+// Indices in [0, limit) spread over the whole range.
+template <typename Index>
+Tensor SpreadIndices(int64_t num_indices, int64_t limit) {
+  Tensor t(DataTypeToEnum<Index>::value, TensorShape({num_indices}));
+  auto flat = t.flat<Index>();
+  for (int64_t i = 0; i < num_indices; ++i) {
+    flat(i) = static_cast<Index>((i * 7919) % limit);
+  }
+  return t;
+}
+
+// Transformer projections and feed-forward layers, ranking MLPs, and the
+// matrix-vector products of single-example inference.
+struct MatMulShape {
+  int m, k, n;
+};
+constexpr MatMulShape kMatMulShapes[] = {
+    {512, 768, 3072}, {512, 768, 768}, {256, 1024, 512},
+    {32, 256, 256},   {1, 1024, 1024},
+};
+
+void BM_MatMul(::testing::benchmark::State& state) {
+  const MatMulShape& s = kMatMulShapes[state.range(0)];
+  Graph* g = new Graph(OpRegistry::Global());
+  test::graph::Matmul(
+      g, test::graph::Constant(g, RandomFloats(TensorShape({s.m, s.k}))),
+      test::graph::Constant(g, RandomFloats(TensorShape({s.k, s.n}))),
+      /*transpose_a=*/false, /*transpose_b=*/false);
+  RunGraph(g, strings::StrCat(s.m, "x", s.k, "x", s.n), state);
+  state.SetItemsProcessed(state.iterations() * 2 * s.m * s.k * s.n);
+}
+CPU_KERNEL_BENCHMARK(BM_MatMul, kMatMulShapes);
+
+// The 3x3 convolutions of the stages of ResNet-50, and one of its 1x1
+// bottleneck convolutions. All have stride 1 and SAME padding.
+struct Conv2DShape {
+  int batch, size, in_depth, filter, out_depth;
+};
+constexpr Conv2DShape kConv2DShapes[] = {
+    {32, 56, 64, 3, 64},   {32, 28, 128, 3, 128}, {32, 14, 256, 3, 256},
+    {32, 7, 512, 3, 512},  {32, 56, 256, 1, 64},
+};
+
+void BM_Conv2D(::testing::benchmark::State& state) {
+  const Conv2DShape& s = kConv2DShapes[state.range(0)];
+  Graph* g = new Graph(OpRegistry::Global());
+  test::graph::Conv2D(
+      g,
+      test::graph::Constant(
+          g, RandomFloats(TensorShape({s.batch, s.size, s.size, s.in_depth}))),
+      test::graph::Constant(g, RandomFloats(TensorShape(
+                                   {s.filter, s.filter, s.in_depth,
+                                    s.out_depth}))));
+  RunGraph(g,
+           strings::StrCat(s.batch, "x", s.size, "x", s.size, "x", s.in_depth,
+                           "_", s.filter, "x", s.filter, "x", s.out_depth),
+           state);
+  state.SetItemsProcessed(state.iterations() * 2 * s.batch * s.size * s.size *
+                          s.filter * s.filter * s.in_depth * s.out_depth);
+}
+CPU_KERNEL_BENCHMARK(BM_Conv2D, kConv2DShapes);
+
+// Embedding lookups: a vocabulary of `rows` embeddings of `dim` floats.
+struct GatherShape {
+  int rows, dim, num_indices;
+};
+constexpr GatherShape kGatherShapes[] = {
+    {100000, 64, 4096},
+    {500000, 32, 16384},
+    {10000, 256, 512},
+};
+
+void BM_Gather(::testing::benchmark::State& state) {
+  const GatherShape& s = kGatherShapes[state.range(0)];
+  Graph* g = new Graph(OpRegistry::Global());
+  Tensor axis(DT_INT32, TensorShape({}));
+  axis.scalar<int32>()() = 0;
+  test::graph::Gather(
+      g, test::graph::Constant(g, RandomFloats(TensorShape({s.rows, s.dim}))),
+      test::graph::Constant(g, SpreadIndices<int32>(s.num_indices, s.rows)),
+      test::graph::Constant(g, axis));
+  RunGraph(g, strings::StrCat(s.rows, "x", s.dim, "_", s.num_indices), state);
+  state.SetBytesProcessed(state.iterations() * s.num_indices * s.dim *
+                          sizeof(float));
+}
+CPU_KERNEL_BENCHMARK(BM_Gather, kGatherShapes);
+
+// Pooled embedding lookups, with `num_indices` ids in `num_segments` bags.
+struct SparseSegmentShape {
+  int rows, dim, num_indices, num_segments;
+};
+constexpr SparseSegmentShape kSparseSegmentShapes[] = {
+    {100000, 64, 16384, 512},
+    {10000, 16, 4096, 256},
+    {500000, 32, 65536, 1024},
+};
+
+void SparseSegmentBenchmark(const std::string& op,
+                            ::testing::benchmark::State& state) {
+  const SparseSegmentShape& s = kSparseSegmentShapes[state.range(0)];
+  Graph* g = new Graph(OpRegistry::Global());
+  Tensor segment_ids(DT_INT32, TensorShape({s.num_indices}));
+  auto segment_ids_flat = segment_ids.flat<int32>();
+  for (int i = 0; i < s.num_indices; ++i) {
+    segment_ids_flat(i) =
+        static_cast<int64_t>(i) * s.num_segments / s.num_indices;
+  }
+  Node* node;
+  TF_CHECK_OK(
+      NodeBuilder(g->NewName("n"), op)
+          .Input(test::graph::Constant(
+              g, RandomFloats(TensorShape({s.rows, s.dim}))))
+          .Input(test::graph::Constant(
+              g, SpreadIndices<int32>(s.num_indices, s.rows)))
+          .Input(test::graph::Constant(g, segment_ids))
+          .Finalize(g, &node));
+  RunGraph(g,
+           strings::StrCat(s.rows, "x", s.dim, "_", s.num_indices, "_",
+                           s.num_segments),
+           state);
+  state.SetBytesProcessed(state.iterations() * s.num_indices * s.dim *
+                          sizeof(float));
+}
+
+void BM_SparseSegmentSum(::testing::benchmark::State& state) {
+  SparseSegmentBenchmark("SparseSegmentSum", state);
+}
+CPU_KERNEL_BENCHMARK(BM_SparseSegmentSum, kSparseSegmentShapes);
+
+void BM_SparseSegmentMean(::testing::benchmark::State& state) {
+  SparseSegmentBenchmark("SparseSegmentMean", state);
+}
+CPU_KERNEL_BENCHMARK(BM_SparseSegmentMean, kSparseSegmentShapes);
+
+// Top-k classes, top-k tokens over a vocabulary, and candidate retrieval.
+struct TopKShape {
+  int batch, n, k;
+};
+constexpr TopKShape kTopKShapes[] = {
+    {128, 1000, 5},
+    {32, 30522, 50},
+    {1, 1000000, 100},
+};
+
+void BM_TopK(::testing::benchmark::State& state) {
+  const TopKShape& s = kTopKShapes[state.range(0)];
+  Graph* g = new Graph(OpRegistry::Global());
+  Tensor k(DT_INT32, TensorShape({}));
+  k.scalar<int32>()() = s.k;
+  Node* node;
+  TF_CHECK_OK(NodeBuilder(g->NewName("n"), "TopKV2")
+                  .Input(test::graph::Constant(
+                      g, RandomFloats(TensorShape({s.batch, s.n}))))
+                  .Input(test::graph::Constant(g, k))
+                  .Finalize(g, &node));
+  RunGraph(g, strings::StrCat(s.batch, "x", s.n, "_k", s.k), state);
+  state.SetItemsProcessed(state.iterations() * s.batch * s.n);
+}
+CPU_KERNEL_BENCHMARK(BM_TopK, kTopKShapes);
+
+// The head transposes of attention, NHWC to NCHW, and a matrix transpose.
+struct TransposeShape {
+  std::vector<int64_t> dims;
+  std::vector<int32> perm;
+};
+const TransposeShape kTransposeShapes[] = {
+    {{32, 128, 12, 64}, {0, 2, 1, 3}},
+    {{32, 56, 56, 64}, {0, 3, 1, 2}},
+    {{1024, 1024}, {1, 0}},
+};
+
+void BM_Transpose(::testing::benchmark::State& state) {
+  const TransposeShape& s = kTransposeShapes[state.range(0)];
+  Graph* g = new Graph(OpRegistry::Global());
+  const TensorShape shape(s.dims);
+  Tensor perm(DT_INT32, TensorShape({static_cast<int64_t>(s.perm.size())}));
+  for (size_t i = 0; i < s.perm.size(); ++i) {
+    perm.vec<int32>()(i) = s.perm[i];
+  }
+  Node* node;
+  TF_CHECK_OK(NodeBuilder(g->NewName("n"), "Transpose")
+                  .Input(test::graph::Constant(g, RandomFloats(shape)))
+                  .Input(test::graph::Constant(g, perm))
+                  .Finalize(g, &node));
+  RunGraph(g, shape.DebugString(), state);
+  state.SetBytesProcessed(state.iterations() * shape.num_elements() *
+                          sizeof(float));
+}
+CPU_KERNEL_BENCHMARK(BM_Transpose, kTransposeShapes);
+
+// The casts around mixed precision layers and of integer features.
+struct CastShape {
+  DataType src, dst;
+  int64_t num_elements;
+};
+constexpr CastShape kCastShapes[] = {
+    {DT_FLOAT, DT_BFLOAT16, 1 << 22},
+    {DT_BFLOAT16, DT_FLOAT, 1 << 22},
+    {DT_FLOAT, DT_HALF, 1 << 22},
+    {DT_INT64, DT_FLOAT, 1 << 20},
+};
+
+void BM_Cast(::testing::benchmark::State& state) {
+  const CastShape& s = kCastShapes[state.range(0)];
+  Graph* g = new Graph(OpRegistry::Global());
+  Tensor in(s.src, TensorShape({s.num_elements}));
+  std::memset(const_cast<char*>(in.tensor_data().data()), 0, in.TotalBytes());
+  test::graph::Cast(g, test::graph::Constant(g, in), s.dst);
+  RunGraph(g,
+           strings::StrCat(DataTypeString(s.src), "_", DataTypeString(s.dst),
+                           "_", s.num_elements),
+           state);
+  state.SetItemsProcessed(state.iterations() * s.num_elements);
+}
+CPU_KERNEL_BENCHMARK(BM_Cast, kCastShapes);
+
+// Batches of ranking examples, with dense float and int64 features of a
+// value each and of embedding size.
+struct ParseExampleShape {
+  int batch, num_scalar_features, num_vector_features, vector_size;
+};
+constexpr ParseExampleShape kParseExampleShapes[] = {
+    {32, 100, 10, 64},
+    {128, 100, 10, 64},
+    {512, 20, 2, 16},
+};
+
+void BM_ParseExample(::testing::benchmark::State& state) {
+  const ParseExampleShape& s = kParseExampleShapes[state.range(0)];
+  Graph* g = new Graph(OpRegistry::Global());
+  const int num_keys = s.num_scalar_features + s.num_vector_features;
+
+  Example example;
+  Tensor dense_keys(DT_STRING, TensorShape({num_keys}));
+  std::vector<NodeBuilder::NodeOut> dense_defaults;
+  std::vector<PartialTensorShape> dense_shapes;
+  for (int i = 0; i < num_keys; ++i) {
+    const std::string key = strings::StrCat("feature_", i);
+    dense_keys.vec<tstring>()(i) = key;
+    Feature& feature = (*example.mutable_features()->mutable_feature())[key];
+    const bool is_vector = i >= s.num_scalar_features;
+    const int size = is_vector ? s.vector_size : 1;
+    // Alternates float and int64 features.
+    const DataType dtype = i % 2 == 0 ? DT_FLOAT : DT_INT64;
+    for (int j = 0; j < size; ++j) {
+      if (dtype == DT_FLOAT) {
+        feature.mutable_float_list()->add_value(0.5f * j);
+      } else {
+        feature.mutable_int64_list()->add_value(1729 * j);
+      }
+    }
+    Tensor dense_default(dtype, TensorShape({size}));
+    if (dtype == DT_FLOAT) {
+      dense_default.flat<float>().setZero();
+    } else {
+      dense_default.flat<int64_t>().setZero();
+    }
+    dense_defaults.emplace_back(test::graph::Constant(g, dense_default));
+    dense_shapes.push_back(PartialTensorShape({size}));
+  }
+  Tensor serialized(DT_STRING, TensorShape({s.batch}));
+  const std::string serialized_example = example.SerializeAsString();
+  for (int i = 0; i < s.batch; ++i) {
+    serialized.vec<tstring>()(i) = serialized_example;
+  }
+
+  Tensor empty_keys(DT_STRING, TensorShape({0}));
+  Node* node;
+  TF_CHECK_OK(NodeBuilder(g->NewName("n"), "ParseExampleV2")
+                  .Input(test::graph::Constant(g, serialized))
+                  .Input(test::graph::Constant(g, empty_keys))  // names
+                  .Input(test::graph::Constant(g, empty_keys))  // sparse_keys
+                  .Input(test::graph::Constant(g, dense_keys))
+                  .Input(test::graph::Constant(g, empty_keys))  // ragged_keys
+                  .Input(dense_defaults)
+                  .Attr("num_sparse", 0)
+                  .Attr("sparse_types", std::vector<DataType>())
+                  .Attr("ragged_value_types", std::vector<DataType>())
+                  .Attr("ragged_split_types", std::vector<DataType>())
+                  .Attr("dense_shapes", dense_shapes)
+                  .Finalize(g, &node));
+  FixupSourceAndSinkEdges(g);
+  RunGraph(g,
+           strings::StrCat(s.batch, "_", s.num_scalar_features, "x1_",
+                           s.num_vector_features, "x", s.vector_size),
+           state);
+  state.SetItemsProcessed(state.iterations() * s.batch);
+  state.SetBytesProcessed(state.iterations() * s.batch *
+                          serialized_example.size());
+}
+CPU_KERNEL_BENCHMARK(BM_ParseExample, kParseExampleShapes);
+
+}  // namespace
+}  // namespace tensorflow
@@ -18,11 +18,17 @@ limitations under the License.
 #include <cstddef>
 #include <cstdint>
 #include <memory>
+#include <optional>
 #include <string>
 #include <utility>
 #include <vector>
 
 #include "absl/status/status.h"
+#include "absl/status/statusor.h"
+#include "absl/strings/match.h"
+#include "absl/strings/string_view.h"
+#include "tensorflow/core/data/hash_utils.h"
+#include "tensorflow/core/data/mapped_cache_file.h"
 #include "tensorflow/core/data/name_utils.h"
 #include "tensorflow/core/data/serialization_utils.h"
 #include "tensorflow/core/framework/dataset.h"
@@ -36,6 +42,7 @@ limitations under the License.
 #include "tensorflow/core/lib/strings/stringprintf.h"
 #include "tensorflow/core/platform/env.h"
 #include "tensorflow/core/platform/errors.h"
+#include "tensorflow/core/platform/path.h"
 #include "tensorflow/core/platform/refcount.h"
 #include "tensorflow/core/util/tensor_bundle/naming.h"
 #include "tensorflow/core/util/tensor_bundle/tensor_bundle.h"
@@ -64,6 +71,9 @@ constexpr char kCurIndex[] = "cur_index";
 constexpr char kShardId[] = "shard_id";
 constexpr char kCreatedAt[] = "Created at";
 constexpr char kMemoryDatasetPrefix[] = "Memory";
+constexpr char kMappedFileDatasetPrefix[] = "MappedFile";
+constexpr char kMappedFileScheme[] = "mmap://";
+constexpr char kMappedFileSuffix[] = ".tfcache";
 constexpr char kMemoryCache[] = "MemoryCache";
 constexpr char kCacheCompleted[] = "cache_completed";
 constexpr char kIndex[] = "index";
@@ -767,6 +777,259 @@ class CacheDatasetOp::FileDatasetV2 : public CacheDatasetOp::FileDatasetBase {
   const Tensor resource_handle_;
 };
 
+// A file cache that is read through a memory mapping, selected by a filename
+// of the form "mmap://<directory>". The cache file is named after the
+// fingerprint of the input pipeline, so that all the processes of a host that
+// cache the same input share the pages of one file instead of each holding
+// its own copy of the elements. If several iterators write the cache file
+// concurrently, each writes its own temporary file and the last one to finish
+// replaces the others, so the input is expected to be deterministic.
+class CacheDatasetOp::MappedFileDataset : public DatasetBase {
+ public:
+  MappedFileDataset(OpKernelContext* ctx, const DatasetBase* input,
+                    tstring filename, std::string cache_filename, Env* env,
+                    std::optional<Tensor> resource_handle)
+      : DatasetBase(DatasetContext(ctx)),
+        input_(input),
+        filename_(std::move(filename)),
+        cache_filename_(std::move(cache_filename)),
+        env_(env),
+        resource_handle_(std::move(resource_handle)) {
+    input_->Ref();
+    random_indexing_compatible_ = input_->RandomIndexingCompatible();
+  }
+
+  ~MappedFileDataset() override { input_->Unref(); }
+
+  std::unique_ptr<IteratorBase> MakeIteratorInternal(
+      const string& prefix) const override {
+    name_utils::IteratorPrefixParams params;
+    params.dataset_prefix = kMappedFileDatasetPrefix;
+    return std::make_unique<Iterator>(Iterator::Params{
+        this, name_utils::IteratorPrefix(kDatasetType, prefix, params)});
+  }
+
+  const DataTypeVector& output_dtypes() const override {
+    return input_->output_dtypes();
+  }
+
+  const std::vector<PartialTensorShape>& output_shapes() const override {
+    return input_->output_shapes();
+  }
+
+  string DebugString() const override {
+    name_utils::DatasetDebugStringParams params;
+    params.dataset_prefix = kMappedFileDatasetPrefix;
+    return name_utils::DatasetDebugString(kDatasetType, params);
+  }
+
+  int64_t CardinalityInternal(CardinalityOptions options) const override {
+    return input_->Cardinality(options);
+  }
+
+  Status Get(OpKernelContext* ctx, int64 index,
+             std::vector<Tensor>* out_tensors) const override {
+    TF_ASSIGN_OR_RETURN(std::shared_ptr<const MappedCacheFile> file,
+                        GetFile());
+    if (file) {
+      return file->Get(index, out_tensors);
+    }
+    mutex_lock l(mu_);
+    if (!dataset_random_access_cache_) {
+      dataset_random_access_cache_ =
+          std::make_unique<DatasetRandomAccessCache>(input_);
+    }
+    return dataset_random_access_cache_->Get(ctx, index, out_tensors);
+  }
+
+  Status InputDatasets(std::vector<const DatasetBase*>* inputs) const override {
+    inputs->push_back(input_);
+    return absl::OkStatus();
+  }
+
+  Status CheckExternalState() const override {
+    return input_->CheckExternalState();
+  }
+
+  absl::Status RandomIndexingCompatible() const override {
+    return random_indexing_compatible_;
+  }
+
+ protected:
+  Status AsGraphDefInternal(SerializationContext* ctx,
+                            DatasetGraphDefBuilder* b,
+                            Node** output) const override {
+    Node* input_node = nullptr;
+    TF_RETURN_IF_ERROR(b->AddInputDataset(ctx, input_, &input_node));
+    Node* filename_node = nullptr;
+    TF_RETURN_IF_ERROR(b->AddScalar(filename_, &filename_node));
+    if (!resource_handle_.has_value()) {
+      return b->AddDataset(this, {input_node, filename_node}, output);
+    }
+    Node* resource_handle_node = nullptr;
+    TF_RETURN_IF_ERROR(b->AddTensor(*resource_handle_, &resource_handle_node));
+    return b->AddDataset(
+        this, {input_node, filename_node, resource_handle_node}, output);
+  }
+
+ private:
+  class Iterator : public DatasetIterator<MappedFileDataset> {
+   public:
+    explicit Iterator(const Params& params)
+        : DatasetIterator<MappedFileDataset>(params) {}
+
+    ~Iterator() override {
+      mutex_lock l(mu_);
+      if (writer_ != nullptr && index_ > 0) {
+        LOG(WARNING) << kIncompleteCacheErrorMessage;
+      }
+    }
+
+    Status Initialize(IteratorContext* ctx) override {
+      mutex_lock l(mu_);
+      return InitializeMode(ctx);
+    }
+
+    Status GetNextInternal(IteratorContext* ctx,
+                           std::vector<Tensor>* out_tensors,
+                           bool* end_of_sequence) override {
+      mutex_lock l(mu_);
+      if (ctx->index_mapper() != nullptr) {
+        if (!iterator_random_access_cache_) {
+          iterator_random_access_cache_ =
+              std::make_unique<IteratorRandomAccessCache>(dataset());
+        }
+        return iterator_random_access_cache_->Get(ctx, out_tensors,
+                                                  end_of_sequence);
+      }
+      if (file_) {
+        if (index_ >= file_->num_elements()) {
+          *end_of_sequence = true;
+          return absl::OkStatus();
+        }
+        TF_RETURN_IF_ERROR(file_->Get(index_, out_tensors));
+        ++index_;
+        *end_of_sequence = false;
+        return absl::OkStatus();
+      }
+      TF_RETURN_IF_ERROR(
+          input_impl_->GetNext(ctx, out_tensors, end_of_sequence));
+      if (*end_of_sequence) {
+        if (writer_ != nullptr) {
+          VLOG(2) << "Finalizing the cache because EOF has been reached.";
+          TF_RETURN_IF_ERROR(writer_->Finalize());
+          writer_.reset();
+        }
+        return absl::OkStatus();
+      }
+      if (writer_ != nullptr) {
+        TF_RETURN_IF_ERROR(writer_->Write(*out_tensors));
+      }
+      ++index_;
+      return absl::OkStatus();
+    }
+
+   protected:
+    std::shared_ptr<model::Node> CreateNode(
+        IteratorContext* ctx, model::Node::Args args) const override {
+      return model::MakeKnownRatioNode(std::move(args),
+                                       /*ratio=*/1);
+    }
+
+    Status SaveInternal(SerializationContext* ctx,
+                        IteratorStateWriter* writer) override {
+      mutex_lock l(mu_);
+      TF_RETURN_IF_ERROR(
+          writer->WriteScalar(prefix(), kMode, file_ ? 1 : 0));
+      TF_RETURN_IF_ERROR(writer->WriteScalar(prefix(), kCurIndex, index_));
+      if (file_) {
+        return absl::OkStatus();
+      }
+      return SaveInput(ctx, writer, input_impl_);
+    }
+
+    Status RestoreInternal(IteratorContext* ctx,
+                           IteratorStateReader* reader) override {
+      mutex_lock l(mu_);
+      int64_t read_mode;
+      TF_RETURN_IF_ERROR(reader->ReadScalar(prefix(), kMode, &read_mode));
+      TF_RETURN_IF_ERROR(reader->ReadScalar(prefix(), kCurIndex, &index_));
+      TF_RETURN_IF_ERROR(InitializeMode(ctx));
+      if (file_) {
+        // The cache may have been completed by another iterator since the
+        // checkpoint was written, in which case the input is not restored.
+        return absl::OkStatus();
+      }
+      if (read_mode) {
+        return errors::FailedPrecondition(
+            "The cache file ", dataset()->cache_filename_,
+            " read by the checkpointed iterator no longer exists.");
+      }
+      // The elements produced before the checkpoint are not in the
+      // temporary file of the new writer, so this iterator no longer writes
+      // the cache.
+      if (writer_ != nullptr && index_ > 0) {
+        LOG(WARNING) << "Not writing the cache file "
+                     << dataset()->cache_filename_
+                     << " from an iterator restored in the middle of the "
+                        "input.";
+        writer_.reset();
+      }
+      return RestoreInput(ctx, reader, input_impl_);
+    }
+
+   private:
+    // Reads the cache file if it exists, or else writes it while reading the
+    // input.
+    Status InitializeMode(IteratorContext* ctx)
+        TF_EXCLUSIVE_LOCKS_REQUIRED(mu_) {
+      writer_.reset();
+      input_impl_.reset();
+      TF_ASSIGN_OR_RETURN(file_, dataset()->GetFile());
+      if (file_) {
+        return absl::OkStatus();
+      }
+      TF_RETURN_IF_ERROR(dataset()->env_->RecursivelyCreateDir(
+          std::string(io::Dirname(dataset()->cache_filename_))));
+      TF_ASSIGN_OR_RETURN(
+          writer_, MappedCacheFileWriter::Create(
+                       dataset()->env_, dataset()->cache_filename_,
+                       dataset()->output_dtypes().size()));
+      return dataset()->input_->MakeIterator(ctx, this, prefix(),
+                                             &input_impl_);
+    }
+
+    mutex mu_;
+    std::shared_ptr<const MappedCacheFile> file_ TF_GUARDED_BY(mu_);
+    std::unique_ptr<MappedCacheFileWriter> writer_ TF_GUARDED_BY(mu_);
+    std::unique_ptr<IteratorBase> input_impl_ TF_GUARDED_BY(mu_);
+    int64_t index_ TF_GUARDED_BY(mu_) = 0;
+    std::unique_ptr<IteratorRandomAccessCache> iterator_random_access_cache_
+        TF_GUARDED_BY(mu_);
+  };
+
+  // Returns the mapping of the cache file, or nullptr if the file has not
+  // been written yet.
+  absl::StatusOr<std::shared_ptr<const MappedCacheFile>> GetFile() const {
+    mutex_lock l(mu_);
+    if (!file_ && env_->FileExists(cache_filename_).ok()) {
+      TF_ASSIGN_OR_RETURN(file_, MappedCacheFile::Open(env_, cache_filename_));
+    }
+    return file_;
+  }
+
+  const DatasetBase* const input_;
+  const tstring filename_;
+  const std::string cache_filename_;
+  Env* const env_;
+  const std::optional<Tensor> resource_handle_;
+  mutable mutex mu_;
+  mutable std::shared_ptr<const MappedCacheFile> file_ TF_GUARDED_BY(mu_);
+  mutable std::unique_ptr<DatasetRandomAccessCache> dataset_random_access_cache_
+      TF_GUARDED_BY(mu_);
+  absl::Status random_indexing_compatible_ = absl::OkStatus();
+};
+
 class CacheDatasetOp::MemoryDatasetBase : public DatasetBase {
  public:
   explicit MemoryDatasetBase(OpKernelContext* ctx, const DatasetBase* input,
@@ -1219,6 +1482,27 @@ void CacheDatasetOp::MakeDataset(OpKernelContext* ctx, DatasetBase* input,
       // Ownership of manager is transferred onto `MemoryDataset`.
       *output = new MemoryDataset(ctx, input, manager, std::move(handle));
     }
+  } else if (absl::StartsWith(filename, kMappedFileScheme)) {
+    SerializationContext::Params params(ctx);
+    std::vector<std::pair<string, Tensor>> input_list;
+    params.input_list = &input_list;
+    params.external_state_policy = ExternalStatePolicy::POLICY_IGNORE;
+    GraphDef graph_def;
+    OP_REQUIRES_OK(ctx,
+                   AsGraphDef(input, SerializationContext(params), &graph_def));
+    uint64 hash;
+    OP_REQUIRES_OK(ctx, HashGraph(graph_def, &hash));
+    std::string cache_filename = io::JoinPath(
+        absl::string_view(filename).substr(strlen(kMappedFileScheme)),
+        strings::StrCat(strings::Hex(hash, strings::kZeroPad16),
+                        kMappedFileSuffix));
+    std::optional<Tensor> resource_handle;
+    if (op_version_ == 2) {
+      resource_handle = ctx->input(2);
+    }
+    *output =
+        new MappedFileDataset(ctx, input, filename, std::move(cache_filename),
+                              ctx->env(), std::move(resource_handle));
   } else {
     if (op_version_ == 2) {
       *output =
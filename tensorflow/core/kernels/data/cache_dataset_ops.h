@@ -40,6 +40,7 @@ class CacheDatasetOp : public UnaryDatasetOpKernel {
  private:
   class FileDataset;
   class FileDatasetV2;
+  class MappedFileDataset;
   class MemoryDataset;
   class MemoryDatasetV2;
 
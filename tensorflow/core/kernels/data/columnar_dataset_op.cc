@@ -0,0 +1,287 @@
+/* Copyright 2024 The TensorFlow Authors. All Rights Reserved.
+
+Licensed under the Apache License, Version 2.0 (the "License");
+you may not use this file except in compliance with the License.
+You may obtain a copy of the License at
+
+    http://www.apache.org/licenses/LICENSE-2.0
+
+Unless required by applicable law or agreed to in writing, software
+distributed under the License is distributed on an "AS IS" BASIS,
+WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+See the License for the specific language governing permissions and
+limitations under the License.
+==============================================================================*/
+#include "tensorflow/core/kernels/data/columnar_dataset_op.h"
+
+#include <memory>
+#include <string>
+#include <utility>
+#include <vector>
+
+#include "tensorflow/core/data/columnar_file.h"
+#include "tensorflow/core/data/name_utils.h"
+#include "tensorflow/core/data/utils.h"
+#include "tensorflow/core/framework/metrics.h"
+#include "tensorflow/core/framework/partial_tensor_shape.h"
+#include "tensorflow/core/framework/tensor.h"
+
+namespace tensorflow {
+namespace data {
+
+// See documentation in ../../ops/dataset_ops.cc for a high-level
+// description of the following op.
+
+/* static */ constexpr const char* const ColumnarDatasetOp::kDatasetType;
+/* static */ constexpr const char* const ColumnarDatasetOp::kFileNames;
+/* static */ constexpr const char* const ColumnarDatasetOp::kColumns;
+/* static */ constexpr const char* const ColumnarDatasetOp::kOutputTypes;
+/* static */ constexpr const char* const ColumnarDatasetOp::kOutputShapes;
+
+constexpr char kCurrentFileIndex[] = "current_file_index";
+constexpr char kChunkIndex[] = "chunk_index";
+
+class ColumnarDatasetOp::Dataset : public DatasetBase {
+ public:
+  Dataset(OpKernelContext* ctx, std::vector<string> filenames,
+          std::vector<std::string> columns, DataTypeVector output_types,
+          std::vector<PartialTensorShape> output_shapes)
+      : DatasetBase(DatasetContext(ctx)),
+        filenames_(std::move(filenames)),
+        columns_(std::move(columns)),
+        output_types_(std::move(output_types)),
+        output_shapes_(std::move(output_shapes)) {}
+
+  std::unique_ptr<IteratorBase> MakeIteratorInternal(
+      const string& prefix) const override {
+    return std::make_unique<Iterator>(Iterator::Params{
+        this, name_utils::IteratorPrefix(kDatasetType, prefix)});
+  }
+
+  const DataTypeVector& output_dtypes() const override {
+    return output_types_;
+  }
+
+  const std::vector<PartialTensorShape>& output_shapes() const override {
+    return output_shapes_;
+  }
+
+  string DebugString() const override {
+    return name_utils::DatasetDebugString(kDatasetType);
+  }
+
+  Status InputDatasets(std::vector<const DatasetBase*>* inputs) const override {
+    return absl::OkStatus();
+  }
+
+  Status CheckExternalState() const override { return absl::OkStatus(); }
+
+ protected:
+  Status AsGraphDefInternal(SerializationContext* ctx,
+                            DatasetGraphDefBuilder* b,
+                            Node** output) const override {
+    Node* filenames = nullptr;
+    TF_RETURN_IF_ERROR(b->AddVector(filenames_, &filenames));
+    AttrValue columns;
+    b->BuildAttrValue(columns_, &columns);
+    TF_RETURN_IF_ERROR(
+        b->AddDataset(this, {filenames}, {{kColumns, columns}}, output));
+    return absl::OkStatus();
+  }
+
+ private:
+  class Iterator : public DatasetIterator<Dataset> {
+   public:
+    explicit Iterator(const Params& params)
+        : DatasetIterator<Dataset>(params) {}
+
+    bool SymbolicCheckpointCompatible() const override { return true; }
+
+    Status GetNextInternal(IteratorContext* ctx,
+                           std::vector<Tensor>* out_tensors,
+                           bool* end_of_sequence) override {
+      mutex_lock l(mu_);
+      do {
+        // We are currently reading a file, so try to read its next chunk.
+        if (file_) {
+          if (chunk_index_ < file_->num_chunks()) {
+            const size_t num_columns = column_indices_.size();
+            out_tensors->resize(2 * num_columns);
+            int64_t num_bytes = 0;
+            for (size_t i = 0; i < num_columns; ++i) {
+              TF_RETURN_IF_ERROR(file_->ReadColumn(
+                  chunk_index_, column_indices_[i], &(*out_tensors)[2 * i],
+                  &(*out_tensors)[2 * i + 1]));
+              num_bytes += (*out_tensors)[2 * i].TotalBytes() +
+                           (*out_tensors)[2 * i + 1].TotalBytes();
+            }
+            static monitoring::CounterCell* bytes_counter =
+                metrics::GetTFDataBytesReadCounter(kDatasetType);
+            bytes_counter->IncrementBy(num_bytes);
+            ++chunk_index_;
+            *end_of_sequence = false;
+            return absl::OkStatus();
+          }
+
+          // We have reached the end of the current file, so maybe move on to
+          // next file.
+          ResetFileLocked();
+          ++current_file_index_;
+        }
+
+        // Iteration ends when there are no more files to process.
+        if (current_file_index_ == dataset()->filenames_.size()) {
+          *end_of_sequence = true;
+          return absl::OkStatus();
+        }
+
+        Status s = OpenFileLocked(ctx->env());
+        if (!s.ok()) {
+          // Move forward the file index so that it works with ignore_errors.
+          // Otherwise the same file will repeat.
+          ++current_file_index_;
+          return s;
+        }
+      } while (true);
+    }
+
+   protected:
+    std::shared_ptr<model::Node> CreateNode(
+        IteratorContext* ctx, model::Node::Args args) const override {
+      return model::MakeSourceNode(std::move(args));
+    }
+
+    Status SaveInternal(SerializationContext* ctx,
+                        IteratorStateWriter* writer) override {
+      mutex_lock l(mu_);
+      TF_RETURN_IF_ERROR(writer->WriteScalar(prefix(), kCurrentFileIndex,
+                                             current_file_index_));
+      if (file_) {
+        TF_RETURN_IF_ERROR(
+            writer->WriteScalar(prefix(), kChunkIndex, chunk_index_));
+      }
+      return absl::OkStatus();
+    }
+
+    Status RestoreInternal(IteratorContext* ctx,
+                           IteratorStateReader* reader) override {
+      mutex_lock l(mu_);
+      ResetFileLocked();
+      int64_t current_file_index;
+      TF_RETURN_IF_ERROR(
+          reader->ReadScalar(prefix(), kCurrentFileIndex, &current_file_index));
+      current_file_index_ = size_t(current_file_index);
+      if (reader->Contains(prefix(), kChunkIndex)) {
+        int64_t chunk_index;
+        TF_RETURN_IF_ERROR(
+            reader->ReadScalar(prefix(), kChunkIndex, &chunk_index));
+        TF_RETURN_IF_ERROR(OpenFileLocked(ctx->env()));
+        chunk_index_ = chunk_index;
+      }
+      return absl::OkStatus();
+    }
+
+   private:
+    // Maps the file at `current_file_index_` and finds the projected columns
+    // in its schema.
+    Status OpenFileLocked(Env* env) TF_EXCLUSIVE_LOCKS_REQUIRED(mu_) {
+      if (current_file_index_ >= dataset()->filenames_.size()) {
+        return errors::InvalidArgument(
+            "current_file_index_:", current_file_index_,
+            " >= filenames_.size():", dataset()->filenames_.size());
+      }
+      const string& filename = dataset()->filenames_[current_file_index_];
+      TF_ASSIGN_OR_RETURN(std::shared_ptr<const ColumnarFile> file,
+                          ColumnarFile::Open(env, TranslateFileName(filename)));
+      std::vector<int> column_indices;
+      column_indices.reserve(dataset()->columns_.size());
+      for (size_t i = 0; i < dataset()->columns_.size(); ++i) {
+        const std::string& column = dataset()->columns_[i];
+        const int index = file->FindColumn(column);
+        if (index < 0) {
+          return errors::InvalidArgument("Column ", column,
+                                         " is not in columnar file ",
+                                         filename);
+        }
+        const DataType dtype = file->schema()[index].dtype;
+        if (dtype != dataset()->output_types_[2 * i]) {
+          return errors::InvalidArgument(
+              "Column ", column, " of columnar file ", filename, " has type ",
+              DataTypeString(dtype), ", expected ",
+              DataTypeString(dataset()->output_types_[2 * i]));
+        }
+        column_indices.push_back(index);
+      }
+      file_ = std::move(file);
+      column_indices_ = std::move(column_indices);
+      chunk_index_ = 0;
+      return absl::OkStatus();
+    }
+
+    void ResetFileLocked() TF_EXCLUSIVE_LOCKS_REQUIRED(mu_) {
+      file_.reset();
+      column_indices_.clear();
+      chunk_index_ = 0;
+    }
+
+    mutex mu_;
+    size_t current_file_index_ TF_GUARDED_BY(mu_) = 0;
+    std::shared_ptr<const ColumnarFile> file_ TF_GUARDED_BY(mu_);
+    // The indices in the schema of `file_` of the projected columns.
+    std::vector<int> column_indices_ TF_GUARDED_BY(mu_);
+    int64_t chunk_index_ TF_GUARDED_BY(mu_) = 0;
+  };
+
+  const std::vector<string> filenames_;
+  const std::vector<std::string> columns_;
+  const DataTypeVector output_types_;
+  const std::vector<PartialTensorShape> output_shapes_;
+};
+
+ColumnarDatasetOp::ColumnarDatasetOp(OpKernelConstruction* ctx)
+    : DatasetOpKernel(ctx) {
+  OP_REQUIRES_OK(ctx, ctx->GetAttr(kColumns, &columns_));
+  OP_REQUIRES_OK(ctx, ctx->GetAttr(kOutputTypes, &output_types_));
+  OP_REQUIRES_OK(ctx, ctx->GetAttr(kOutputShapes, &output_shapes_));
+  OP_REQUIRES(ctx,
+              output_types_.size() == 2 * columns_.size() &&
+                  output_shapes_.size() == output_types_.size(),
+              errors::InvalidArgument(
+                  "Expected two `output_types` and `output_shapes` for each "
+                  "column, got ",
+                  output_types_.size(), " and ", output_shapes_.size(),
+                  " for ", columns_.size(), " columns"));
+  for (size_t i = 0; i < columns_.size(); ++i) {
+    OP_REQUIRES(ctx, output_types_[2 * i + 1] == DT_INT64,
+                errors::InvalidArgument("The row splits of column ",
+                                        columns_[i], " must be int64"));
+  }
+}
+
+void ColumnarDatasetOp::MakeDataset(OpKernelContext* ctx,
+                                    DatasetBase** output) {
+  const Tensor* filenames_tensor;
+  OP_REQUIRES_OK(ctx, ctx->input(kFileNames, &filenames_tensor));
+  OP_REQUIRES(
+      ctx, filenames_tensor->dims() <= 1,
+      errors::InvalidArgument("`filenames` must be a scalar or a vector."));
+
+  std::vector<string> filenames;
+  filenames.reserve(filenames_tensor->NumElements());
+  for (int i = 0; i < filenames_tensor->NumElements(); ++i) {
+    VLOG(2) << "Reading file: " << filenames_tensor->flat<tstring>()(i);
+    filenames.push_back(filenames_tensor->flat<tstring>()(i));
+    metrics::RecordTFDataFilename(kDatasetType, filenames[i]);
+  }
+  LogFilenames(filenames);
+
+  *output = new Dataset(ctx, std::move(filenames), columns_, output_types_,
+                        output_shapes_);
+}
+
+namespace {
+REGISTER_KERNEL_BUILDER(Name("ColumnarDataset").Device(DEVICE_CPU),
+                        ColumnarDatasetOp);
+}  // namespace
+}  // namespace data
+}  // namespace tensorflow
@@ -0,0 +1,217 @@
+/* Copyright 2024 The TensorFlow Authors. All Rights Reserved.
+
+Licensed under the Apache License, Version 2.0 (the "License");
+you may not use this file except in compliance with the License.
+You may obtain a copy of the License at
+
+    http://www.apache.org/licenses/LICENSE-2.0
+
+Unless required by applicable law or agreed to in writing, software
+distributed under the License is distributed on an "AS IS" BASIS,
+WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+See the License for the specific language governing permissions and
+limitations under the License.
+==============================================================================*/
+#include "tensorflow/core/kernels/data/columnar_dataset_op.h"
+
+#include <memory>
+#include <string>
+#include <utility>
+#include <vector>
+
+#include "tensorflow/core/data/columnar_file.h"
+#include "tensorflow/core/data/dataset_test_base.h"
+#include "tensorflow/core/platform/env.h"
+
+namespace tensorflow {
+namespace data {
+namespace {
+
+constexpr char kNodeName[] = "columnar_dataset";
+
+class ColumnarDatasetParams : public DatasetParams {
+ public:
+  ColumnarDatasetParams(std::vector<tstring> filenames,
+                        std::vector<tstring> columns,
+                        DataTypeVector output_dtypes, string node_name)
+      : DatasetParams(output_dtypes,
+                      std::vector<PartialTensorShape>(output_dtypes.size(),
+                                                      PartialTensorShape({-1})),
+                      std::move(node_name)),
+        filenames_(std::move(filenames)),
+        columns_(std::move(columns)) {}
+
+  std::vector<Tensor> GetInputTensors() const override {
+    int num_files = filenames_.size();
+    return {CreateTensor<tstring>(TensorShape({num_files}), filenames_)};
+  }
+
+  Status GetInputNames(std::vector<string>* input_names) const override {
+    *input_names = {ColumnarDatasetOp::kFileNames};
+    return absl::OkStatus();
+  }
+
+  Status GetAttributes(AttributeVector* attr_vector) const override {
+    *attr_vector = {{ColumnarDatasetOp::kColumns, columns_},
+                    {ColumnarDatasetOp::kOutputTypes, output_dtypes_},
+                    {ColumnarDatasetOp::kOutputShapes, output_shapes_},
+                    {"metadata", ""}};
+    return absl::OkStatus();
+  }
+
+  string dataset_type() const override {
+    return ColumnarDatasetOp::kDatasetType;
+  }
+
+ private:
+  std::vector<tstring> filenames_;
+  std::vector<tstring> columns_;
+};
+
+class ColumnarDatasetOpTest : public DatasetOpsTestBase {};
+
+Tensor Splits(const std::vector<int64_t>& splits) {
+  return test::AsTensor<int64_t>(splits);
+}
+
+// Writes two files with columns "ids", "weights", and "query". The first file
+// has two chunks and the second one.
+std::vector<tstring> CreateTestFiles() {
+  std::vector<tstring> filenames = {
+      absl::StrCat(testing::TmpDir(), "/columnar_1"),
+      absl::StrCat(testing::TmpDir(), "/columnar_2")};
+  const std::vector<ColumnarColumn> schema = {
+      {"ids", DT_INT64}, {"weights", DT_FLOAT}, {"query", DT_STRING}};
+  auto writer =
+      ColumnarFileWriter::Create(Env::Default(), filenames[0], schema);
+  TF_CHECK_OK(writer.status());
+  TF_CHECK_OK((*writer)->WriteChunk(
+      {test::AsTensor<int64_t>({1, 2, 3}), test::AsTensor<float>({0.5, 1.5}),
+       test::AsTensor<tstring>({"a", "b"})},
+      {Splits({0, 2, 3}), Splits({0, 0, 2}), Splits({0, 1, 2})}));
+  TF_CHECK_OK((*writer)->WriteChunk(
+      {test::AsTensor<int64_t>({4}), test::AsTensor<float>({2.5}),
+       test::AsTensor<tstring>({"c"})},
+      {Splits({0, 1}), Splits({0, 1}), Splits({0, 1})}));
+  TF_CHECK_OK((*writer)->Finalize());
+  // The second file orders its columns differently.
+  writer = ColumnarFileWriter::Create(
+      Env::Default(), filenames[1],
+      {{"query", DT_STRING}, {"ids", DT_INT64}, {"weights", DT_FLOAT}});
+  TF_CHECK_OK(writer.status());
+  TF_CHECK_OK((*writer)->WriteChunk({test::AsTensor<tstring>({"d", "e"}),
+                                     test::AsTensor<int64_t>({5, 6}),
+                                     test::AsTensor<float>({})},
+                                    {Splits({0, 2}), Splits({0, 2}),
+                                     Splits({0, 0})}));
+  TF_CHECK_OK((*writer)->Finalize());
+  return filenames;
+}
+
+ColumnarDatasetParams IdsAndQueryParams() {
+  return ColumnarDatasetParams(CreateTestFiles(), {"ids", "query"},
+                               {DT_INT64, DT_INT64, DT_STRING, DT_INT64},
+                               kNodeName);
+}
+
+ColumnarDatasetParams MissingColumnParams() {
+  return ColumnarDatasetParams(CreateTestFiles(), {"labels"},
+                               {DT_FLOAT, DT_INT64}, kNodeName);
+}
+
+ColumnarDatasetParams WrongTypeParams() {
+  return ColumnarDatasetParams(CreateTestFiles(), {"weights"},
+                               {DT_DOUBLE, DT_INT64}, kNodeName);
+}
+
+std::vector<Tensor> IdsAndQueryOutputs() {
+  return {test::AsTensor<int64_t>({1, 2, 3}),
+          Splits({0, 2, 3}),
+          test::AsTensor<tstring>({"a", "b"}),
+          Splits({0, 1, 2}),
+          test::AsTensor<int64_t>({4}),
+          Splits({0, 1}),
+          test::AsTensor<tstring>({"c"}),
+          Splits({0, 1}),
+          test::AsTensor<int64_t>({5, 6}),
+          Splits({0, 2}),
+          test::AsTensor<tstring>({"d", "e"}),
+          Splits({0, 2})};
+}
+
+std::vector<GetNextTestCase<ColumnarDatasetParams>> GetNextTestCases() {
+  return {{/*dataset_params=*/IdsAndQueryParams(),
+           /*expected_outputs=*/IdsAndQueryOutputs()}};
+}
+
+ITERATOR_GET_NEXT_TEST_P(ColumnarDatasetOpTest, ColumnarDatasetParams,
+                         GetNextTestCases())
+
+TEST_F(ColumnarDatasetOpTest, DatasetNodeName) {
+  auto dataset_params = IdsAndQueryParams();
+  TF_ASSERT_OK(Initialize(dataset_params));
+  TF_ASSERT_OK(CheckDatasetNodeName(dataset_params.node_name()));
+}
+
+TEST_F(ColumnarDatasetOpTest, DatasetTypeString) {
+  auto dataset_params = IdsAndQueryParams();
+  TF_ASSERT_OK(Initialize(dataset_params));
+  TF_ASSERT_OK(CheckDatasetTypeString(
+      name_utils::OpName(ColumnarDatasetOp::kDatasetType)));
+}
+
+TEST_F(ColumnarDatasetOpTest, DatasetOutputDtypes) {
+  auto dataset_params = IdsAndQueryParams();
+  TF_ASSERT_OK(Initialize(dataset_params));
+  TF_ASSERT_OK(
+      CheckDatasetOutputDtypes({DT_INT64, DT_INT64, DT_STRING, DT_INT64}));
+}
+
+TEST_F(ColumnarDatasetOpTest, Cardinality) {
+  auto dataset_params = IdsAndQueryParams();
+  TF_ASSERT_OK(Initialize(dataset_params));
+  TF_ASSERT_OK(CheckDatasetCardinality(kUnknownCardinality));
+}
+
+TEST_F(ColumnarDatasetOpTest, IteratorPrefix) {
+  auto dataset_params = IdsAndQueryParams();
+  TF_ASSERT_OK(Initialize(dataset_params));
+  TF_ASSERT_OK(CheckIteratorPrefix(name_utils::IteratorPrefix(
+      ColumnarDatasetOp::kDatasetType, dataset_params.iterator_prefix())));
+}
+
+TEST_F(ColumnarDatasetOpTest, MissingColumn) {
+  auto dataset_params = MissingColumnParams();
+  TF_ASSERT_OK(Initialize(dataset_params));
+  bool end_of_sequence = false;
+  std::vector<Tensor> out_tensors;
+  EXPECT_EQ(
+      iterator_->GetNext(iterator_ctx_.get(), &out_tensors, &end_of_sequence)
+          .code(),
+      absl::StatusCode::kInvalidArgument);
+}
+
+TEST_F(ColumnarDatasetOpTest, WrongColumnType) {
+  auto dataset_params = WrongTypeParams();
+  TF_ASSERT_OK(Initialize(dataset_params));
+  bool end_of_sequence = false;
+  std::vector<Tensor> out_tensors;
+  EXPECT_EQ(
+      iterator_->GetNext(iterator_ctx_.get(), &out_tensors, &end_of_sequence)
+          .code(),
+      absl::StatusCode::kInvalidArgument);
+}
+
+std::vector<IteratorSaveAndRestoreTestCase<ColumnarDatasetParams>>
+IteratorSaveAndRestoreTestCases() {
+  return {{/*dataset_params=*/IdsAndQueryParams(),
+           /*breakpoints=*/{0, 1, 2, 4},
+           /*expected_outputs=*/IdsAndQueryOutputs()}};
+}
+
+ITERATOR_SAVE_AND_RESTORE_TEST_P(ColumnarDatasetOpTest, ColumnarDatasetParams,
+                                 IteratorSaveAndRestoreTestCases())
+
+}  // namespace
+}  // namespace data
+}  // namespace tensorflow
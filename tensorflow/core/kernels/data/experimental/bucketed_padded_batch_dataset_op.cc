@@ -0,0 +1,675 @@
+/* Copyright 2024 The TensorFlow Authors. All Rights Reserved.
+
+Licensed under the Apache License, Version 2.0 (the "License");
+you may not use this file except in compliance with the License.
+You may obtain a copy of the License at
+
+    http://www.apache.org/licenses/LICENSE-2.0
+
+Unless required by applicable law or agreed to in writing, software
+distributed under the License is distributed on an "AS IS" BASIS,
+WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+See the License for the specific language governing permissions and
+limitations under the License.
+==============================================================================*/
+#include "tensorflow/core/kernels/data/experimental/bucketed_padded_batch_dataset_op.h"
+
+#include <algorithm>
+#include <cstdint>
+#include <iterator>
+#include <map>
+#include <memory>
+#include <string>
+#include <utility>
+#include <vector>
+
+#include "absl/strings/str_cat.h"
+#include "absl/strings/str_join.h"
+#include "tensorflow/core/data/dataset_utils.h"
+#include "tensorflow/core/data/name_utils.h"
+#include "tensorflow/core/data/serialization_utils.h"
+#include "tensorflow/core/framework/dataset.h"
+#include "tensorflow/core/framework/partial_tensor_shape.h"
+#include "tensorflow/core/framework/tensor.h"
+#include "tensorflow/core/framework/tensor_util.h"
+#include "tensorflow/core/platform/errors.h"
+#include "tensorflow/core/util/batch_util.h"
+
+namespace tensorflow {
+namespace data {
+namespace experimental {
+
+// Constants declared in bucketed_padded_batch_dataset_op.h and used both here
+// and in test cases.
+/* static */ constexpr const char* const
+    BucketedPaddedBatchDatasetOp::kDatasetType;
+/* static */ constexpr const char* const
+    BucketedPaddedBatchDatasetOp::kInputDataset;
+/* static */ constexpr const char* const
+    BucketedPaddedBatchDatasetOp::kBatchSize;
+/* static */ constexpr const char* const
+    BucketedPaddedBatchDatasetOp::kPaddedShapes;
+/* static */ constexpr const char* const
+    BucketedPaddedBatchDatasetOp::kPaddingValues;
+/* static */ constexpr const char* const
+    BucketedPaddedBatchDatasetOp::kWindowSize;
+/* static */ constexpr const char* const
+    BucketedPaddedBatchDatasetOp::kNumBuckets;
+/* static */ constexpr const char* const
+    BucketedPaddedBatchDatasetOp::kDropRemainder;
+/* static */ constexpr const char* const
+    BucketedPaddedBatchDatasetOp::kToutputTypes;
+/* static */ constexpr const char* const
+    BucketedPaddedBatchDatasetOp::kOutputShapes;
+/* static */ constexpr const char* const
+    BucketedPaddedBatchDatasetOp::kNumPaddedShapes;
+
+namespace {
+
+constexpr char kInputImplEmpty[] = "input_impl_empty";
+constexpr char kBoundaries[] = "boundaries";
+constexpr char kPending[] = "pending";
+constexpr char kNumBucketsState[] = "num_buckets";
+constexpr char kBucket[] = "bucket";
+
+}  // namespace
+
+std::vector<int64_t> BucketedPaddedBatchDatasetOp::ChooseBucketBoundaries(
+    const std::vector<int64_t>& lengths, int64_t num_buckets) {
+  std::map<int64_t, int64_t> counts;
+  for (int64_t length : lengths) {
+    ++counts[length];
+  }
+  std::vector<int64_t> values;
+  // `num_le[i]` and `sum_le[i]` are the number and the sum of the lengths
+  // that are less than `values[i]`.
+  std::vector<int64_t> num_le = {0};
+  std::vector<int64_t> sum_le = {0};
+  for (const auto& [value, count] : counts) {
+    values.push_back(value);
+    num_le.push_back(num_le.back() + count);
+    sum_le.push_back(sum_le.back() + value * count);
+  }
+  const int64_t n = values.size();
+  const int64_t k = std::min(num_buckets, n);
+  // The padding of the lengths in `[values[i], values[j]]` when they are all
+  // padded to `values[j]`.
+  auto cost = [&](int64_t i, int64_t j) {
+    return (num_le[j + 1] - num_le[i]) * values[j] -
+           (sum_le[j + 1] - sum_le[i]);
+  };
+  // `min_cost[j]` is the padding of the best partition of `values[0..j]` into
+  // the current number of buckets, and `first[g][j]` is the first value of the
+  // last bucket of the best partition of `values[0..j]` into `g + 1` buckets.
+  std::vector<int64_t> min_cost(n);
+  std::vector<std::vector<int64_t>> first(k, std::vector<int64_t>(n, 0));
+  for (int64_t j = 0; j < n; ++j) {
+    min_cost[j] = cost(0, j);
+  }
+  for (int64_t g = 1; g < k; ++g) {
+    std::vector<int64_t> next_cost(n, 0);
+    for (int64_t j = g; j < n; ++j) {
+      next_cost[j] = min_cost[g - 1] + cost(g, j);
+      first[g][j] = g;
+      for (int64_t i = g + 1; i <= j; ++i) {
+        const int64_t c = min_cost[i - 1] + cost(i, j);
+        if (c < next_cost[j]) {
+          next_cost[j] = c;
+          first[g][j] = i;
+        }
+      }
+    }
+    min_cost = std::move(next_cost);
+  }
+  std::vector<int64_t> boundaries(k);
+  int64_t j = n - 1;
+  for (int64_t g = k - 1; g >= 0; --g) {
+    boundaries[g] = values[j];
+    j = first[g][j] - 1;
+  }
+  return boundaries;
+}
+
+class BucketedPaddedBatchDatasetOp::Dataset : public DatasetBase {
+ public:
+  Dataset(OpKernelContext* ctx, const DatasetBase* input, int64_t batch_size,
+          std::vector<PartialTensorShape> padded_shapes,
+          std::vector<Tensor> padding_values, int64_t window_size,
+          int64_t num_buckets, bool drop_remainder)
+      : DatasetBase(DatasetContext(ctx)),
+        input_(input),
+        batch_size_(batch_size),
+        padded_shapes_(std::move(padded_shapes)),
+        padding_values_(std::move(padding_values)),
+        window_size_(window_size),
+        num_buckets_(num_buckets),
+        drop_remainder_(drop_remainder) {
+    input_->Ref();
+    const bool static_batch_size =
+        drop_remainder_ || input_->Cardinality() == kInfiniteCardinality;
+    for (const PartialTensorShape& padded_shape : padded_shapes_) {
+      output_shapes_.push_back(
+          PartialTensorShape({static_batch_size ? batch_size_ : -1})
+              .Concatenate(padded_shape));
+    }
+  }
+
+  ~Dataset() override { input_->Unref(); }
+
+  std::unique_ptr<IteratorBase> MakeIteratorInternal(
+      const string& prefix) const override {
+    return std::make_unique<Iterator>(Iterator::Params{
+        this, name_utils::IteratorPrefix(kDatasetType, prefix)});
+  }
+
+  const DataTypeVector& output_dtypes() const override {
+    return input_->output_dtypes();
+  }
+
+  const std::vector<PartialTensorShape>& output_shapes() const override {
+    return output_shapes_;
+  }
+
+  string DebugString() const override {
+    name_utils::DatasetDebugStringParams params;
+    params.set_args(batch_size_, num_buckets_);
+    return name_utils::DatasetDebugString(kDatasetType, params);
+  }
+
+  int64_t CardinalityInternal(CardinalityOptions options) const override {
+    // Only the last batch may be partial, so there are as many batches as
+    // with `PaddedBatchDataset`.
+    int64_t n = input_->Cardinality(options);
+    if (n == kInfiniteCardinality || n == kUnknownCardinality) {
+      return n;
+    }
+    return n / batch_size_ + (n % batch_size_ == 0 || drop_remainder_ ? 0 : 1);
+  }
+
+  Status InputDatasets(std::vector<const DatasetBase*>* inputs) const override {
+    inputs->push_back(input_);
+    return absl::OkStatus();
+  }
+
+  Status CheckExternalState() const override {
+    return input_->CheckExternalState();
+  }
+
+ protected:
+  Status AsGraphDefInternal(SerializationContext* ctx,
+                            DatasetGraphDefBuilder* b,
+                            Node** output) const override {
+    Node* input_graph_node = nullptr;
+    TF_RETURN_IF_ERROR(b->AddInputDataset(ctx, input_, &input_graph_node));
+    Node* batch_size = nullptr;
+    TF_RETURN_IF_ERROR(b->AddScalar(batch_size_, &batch_size));
+
+    std::vector<Node*> padded_shapes;
+    padded_shapes.reserve(padded_shapes_.size());
+    for (const PartialTensorShape& padded_shape : padded_shapes_) {
+      Node* node;
+      Tensor t(DT_INT64, TensorShape({padded_shape.dims()}));
+      for (int j = 0; j < padded_shape.dims(); j++) {
+        t.vec<int64_t>()(j) = padded_shape.dim_size(j);
+      }
+      TF_RETURN_IF_ERROR(b->AddTensor(t, &node));
+      padded_shapes.emplace_back(node);
+    }
+
+    std::vector<Node*> padding_values;
+    padding_values.reserve(padding_values_.size());
+    for (const Tensor& t : padding_values_) {
+      Node* node;
+      TF_RETURN_IF_ERROR(b->AddTensor(t, &node));
+      padding_values.emplace_back(node);
+    }
+
+    Node* window_size = nullptr;
+    TF_RETURN_IF_ERROR(b->AddScalar(window_size_, &window_size));
+    Node* num_buckets = nullptr;
+    TF_RETURN_IF_ERROR(b->AddScalar(num_buckets_, &num_buckets));
+    Node* drop_remainder = nullptr;
+    TF_RETURN_IF_ERROR(b->AddScalar(drop_remainder_, &drop_remainder));
+
+    AttrValue output_types;
+    b->BuildAttrValue(output_dtypes(), &output_types);
+    AttrValue N;
+    b->BuildAttrValue<int64_t>(padded_shapes_.size(), &N);
+
+    TF_RETURN_IF_ERROR(b->AddDataset(
+        this,
+        {{0, input_graph_node},
+         {1, batch_size},
+         {4, window_size},
+         {5, num_buckets},
+         {6, drop_remainder}},
+        {{2, padded_shapes}, {3, padding_values}},
+        {{kToutputTypes, output_types}, {kNumPaddedShapes, N}}, output));
+    return absl::OkStatus();
+  }
+
+ private:
+  // Elements are grouped into buckets by their length, which is their largest
+  // size in any of the dimensions that `padded_shapes` leaves unknown. All of
+  // these dimensions of a batch are padded to the upper bound of the largest
+  // bucket that contributed to it, so that the batches of an epoch have at
+  // most as many distinct shapes as there are buckets.
+  //
+  // The bounds are chosen once, to minimize the padding of the first
+  // `window_size` elements, and are then kept so that the set of shapes stays
+  // stable. An element that is longer than the largest bound adds a bound of
+  // at least twice the largest one, so that a few outliers only add a
+  // logarithmic number of shapes.
+  class Iterator : public DatasetIterator<Dataset> {
+   public:
+    explicit Iterator(const Params& params)
+        : DatasetIterator<Dataset>(params) {}
+
+    bool SymbolicCheckpointCompatible() const override { return false; }
+
+    Status Initialize(IteratorContext* ctx) override {
+      return dataset()->input_->MakeIterator(ctx, this, prefix(), &input_impl_);
+    }
+
+    Status GetNextInternal(IteratorContext* ctx,
+                           std::vector<Tensor>* out_tensors,
+                           bool* end_of_sequence) override {
+      mutex_lock l(mu_);
+      std::vector<std::vector<Tensor>> batch;
+      int64_t bucket;
+      while (true) {
+        if (boundaries_.empty()) {
+          // Fill the first window to choose the bucket boundaries.
+          if (input_impl_ && pending_.size() < dataset()->window_size_) {
+            TF_RETURN_IF_ERROR(ReadInputLocked(ctx));
+            continue;
+          }
+          if (pending_.empty()) {
+            *end_of_sequence = true;
+            return absl::OkStatus();
+          }
+          TF_RETURN_IF_ERROR(ChooseBoundariesLocked());
+          continue;
+        }
+        bucket = FullBucketLocked();
+        if (bucket >= 0) {
+          TakeLocked(bucket, dataset()->batch_size_, &batch);
+          break;
+        }
+        if (!input_impl_ || num_buffered_ >= dataset()->window_size_) {
+          if (num_buffered_ == 0) {
+            *end_of_sequence = true;
+            return absl::OkStatus();
+          }
+          bucket = TakeMixedBatchLocked(&batch);
+          if (batch.size() < dataset()->batch_size_ &&
+              dataset()->drop_remainder_) {
+            // This is the last batch.
+            for (auto& elements : buckets_) {
+              elements.clear();
+            }
+            num_buffered_ = 0;
+            *end_of_sequence = true;
+            return absl::OkStatus();
+          }
+          break;
+        }
+        TF_RETURN_IF_ERROR(ReadInputLocked(ctx));
+      }
+      TF_RETURN_IF_ERROR(
+          CopyBatch(ctx, batch, boundaries_[bucket], out_tensors));
+      *end_of_sequence = false;
+      return absl::OkStatus();
+    }
+
+   protected:
+    std::shared_ptr<model::Node> CreateNode(
+        IteratorContext* ctx, model::Node::Args args) const override {
+      return model::MakeKnownRatioNode(std::move(args), dataset()->batch_size_);
+    }
+
+    Status SaveInternal(SerializationContext* ctx,
+                        IteratorStateWriter* writer) override {
+      mutex_lock l(mu_);
+      if (input_impl_) {
+        TF_RETURN_IF_ERROR(SaveInput(ctx, writer, input_impl_));
+      } else {
+        TF_RETURN_IF_ERROR(writer->WriteScalar(prefix(), kInputImplEmpty, ""));
+      }
+      Tensor boundaries(
+          DT_INT64, TensorShape({static_cast<int64_t>(boundaries_.size())}));
+      std::copy(boundaries_.begin(), boundaries_.end(),
+                boundaries.vec<int64_t>().data());
+      TF_RETURN_IF_ERROR(
+          writer->WriteTensor(prefix(), kBoundaries, boundaries));
+      TF_RETURN_IF_ERROR(
+          WriteElementsToCheckpoint(writer, full_name(kPending), pending_));
+      TF_RETURN_IF_ERROR(writer->WriteScalar(
+          prefix(), kNumBucketsState, static_cast<int64_t>(buckets_.size())));
+      for (int64_t i = 0; i < buckets_.size(); ++i) {
+        TF_RETURN_IF_ERROR(WriteElementsToCheckpoint(
+            writer, full_name(absl::StrCat(kBucket, "_", i)), buckets_[i]));
+      }
+      return absl::OkStatus();
+    }
+
+    Status RestoreInternal(IteratorContext* ctx,
+                           IteratorStateReader* reader) override {
+      mutex_lock l(mu_);
+      if (!reader->Contains(prefix(), kInputImplEmpty)) {
+        TF_RETURN_IF_ERROR(RestoreInput(ctx, reader, input_impl_));
+      } else {
+        input_impl_.reset();
+      }
+      Tensor boundaries;
+      TF_RETURN_IF_ERROR(
+          reader->ReadTensor(prefix(), kBoundaries, &boundaries));
+      auto boundaries_vec = boundaries.vec<int64_t>();
+      boundaries_.assign(boundaries_vec.data(),
+                         boundaries_vec.data() + boundaries_vec.size());
+      pending_.clear();
+      TF_RETURN_IF_ERROR(ReadElementsFromCheckpoint(
+          ctx, reader, full_name(kPending), &pending_));
+      int64_t num_buckets;
+      TF_RETURN_IF_ERROR(
+          reader->ReadScalar(prefix(), kNumBucketsState, &num_buckets));
+      if (num_buckets != boundaries_.size()) {
+        return errors::DataLoss("Expected ", boundaries_.size(),
+                                " buckets in the checkpoint, got ",
+                                num_buckets);
+      }
+      buckets_.clear();
+      buckets_.resize(num_buckets);
+      num_buffered_ = 0;
+      for (int64_t i = 0; i < num_buckets; ++i) {
+        TF_RETURN_IF_ERROR(ReadElementsFromCheckpoint(
+            ctx, reader, full_name(absl::StrCat(kBucket, "_", i)),
+            &buckets_[i]));
+        num_buffered_ += buckets_[i].size();
+      }
+      return absl::OkStatus();
+    }
+
+    TraceMeMetadata GetTraceMeMetadata() const override {
+      return {{"batch_size", absl::StrCat(dataset()->batch_size_)},
+              {"window_size", absl::StrCat(dataset()->window_size_)}};
+    }
+
+   private:
+    // Reads an input element into the pending window or into its bucket.
+    Status ReadInputLocked(IteratorContext* ctx)
+        TF_EXCLUSIVE_LOCKS_REQUIRED(mu_) {
+      std::vector<Tensor> element;
+      bool end_of_input = false;
+      TF_RETURN_IF_ERROR(input_impl_->GetNext(ctx, &element, &end_of_input));
+      if (end_of_input) {
+        input_impl_.reset();
+        return absl::OkStatus();
+      }
+      if (boundaries_.empty()) {
+        pending_.push_back(std::move(element));
+        return absl::OkStatus();
+      }
+      return AddLocked(std::move(element));
+    }
+
+    Status ElementLength(const std::vector<Tensor>& element,
+                         int64_t* length) const {
+      const auto& padded_shapes = dataset()->padded_shapes_;
+      if (element.size() != padded_shapes.size()) {
+        return errors::InvalidArgument("Expected an element with ",
+                                       padded_shapes.size(),
+                                       " components, got ", element.size());
+      }
+      *length = 0;
+      for (size_t i = 0; i < element.size(); ++i) {
+        const TensorShape& shape = element[i].shape();
+        if (shape.dims() != padded_shapes[i].dims()) {
+          return errors::InvalidArgument(
+              "All elements in a batch must have the same rank as the "
+              "padded shape for component",
+              i, ": expected rank ", padded_shapes[i].dims(),
+              " but got element with rank ", shape.dims());
+        }
+        for (int dim = 0; dim < shape.dims(); ++dim) {
+          if (padded_shapes[i].dim_size(dim) == -1) {
+            *length = std::max(*length, shape.dim_size(dim));
+          }
+        }
+      }
+      return absl::OkStatus();
+    }
+
+    Status ChooseBoundariesLocked() TF_EXCLUSIVE_LOCKS_REQUIRED(mu_) {
+      std::vector<int64_t> lengths(pending_.size());
+      for (size_t i = 0; i < pending_.size(); ++i) {
+        TF_RETURN_IF_ERROR(ElementLength(pending_[i], &lengths[i]));
+      }
+      boundaries_ = ChooseBucketBoundaries(lengths, dataset()->num_buckets_);
+      VLOG(2) << "Chose the bucket boundaries ["
+              << absl::StrJoin(boundaries_, ", ") << "] for "
+              << pending_.size() << " elements.";
+      buckets_.resize(boundaries_.size());
+      for (auto& element : pending_) {
+        TF_RETURN_IF_ERROR(AddLocked(std::move(element)));
+      }
+      pending_.clear();
+      return absl::OkStatus();
+    }
+
+    Status AddLocked(std::vector<Tensor> element)
+        TF_EXCLUSIVE_LOCKS_REQUIRED(mu_) {
+      int64_t length;
+      TF_RETURN_IF_ERROR(ElementLength(element, &length));
+      size_t bucket =
+          std::lower_bound(boundaries_.begin(), boundaries_.end(), length) -
+          boundaries_.begin();
+      if (bucket == boundaries_.size()) {
+        boundaries_.push_back(std::max(length, 2 * boundaries_.back()));
+        buckets_.emplace_back();
+        VLOG(2) << "Added the bucket boundary " << boundaries_.back()
+                << " for an element of length " << length << ".";
+      }
+      buckets_[bucket].push_back(std::move(element));
+      ++num_buffered_;
+      return absl::OkStatus();
+    }
+
+    // Returns the smallest bucket that holds a whole batch, or -1.
+    int64_t FullBucketLocked() TF_EXCLUSIVE_LOCKS_REQUIRED(mu_) {
+      for (int64_t i = 0; i < buckets_.size(); ++i) {
+        if (buckets_[i].size() >= dataset()->batch_size_) {
+          return i;
+        }
+      }
+      return -1;
+    }
+
+    // Moves the first `n` elements of `bucket` to the end of `*batch`.
+    void TakeLocked(int64_t bucket, int64_t n,
+                    std::vector<std::vector<Tensor>>* batch)
+        TF_EXCLUSIVE_LOCKS_REQUIRED(mu_) {
+      auto& elements = buckets_[bucket];
+      n = std::min<int64_t>(n, elements.size());
+      std::move(elements.begin(), elements.begin() + n,
+                std::back_inserter(*batch));
+      elements.erase(elements.begin(), elements.begin() + n);
+      num_buffered_ -= n;
+    }
+
+    // Takes a batch from the fullest bucket, topped up with the elements of
+    // the next larger and then the next smaller buckets, and returns the
+    // largest bucket that it was taken from. The batch is only partial if
+    // fewer than `batch_size` elements are buffered.
+    int64_t TakeMixedBatchLocked(std::vector<std::vector<Tensor>>* batch)
+        TF_EXCLUSIVE_LOCKS_REQUIRED(mu_) {
+      const int64_t batch_size = dataset()->batch_size_;
+      int64_t fullest = 0;
+      for (int64_t i = 1; i < buckets_.size(); ++i) {
+        if (buckets_[i].size() > buckets_[fullest].size()) {
+          fullest = i;
+        }
+      }
+      int64_t largest = fullest;
+      TakeLocked(fullest, batch_size, batch);
+      for (int64_t i = fullest + 1;
+           i < buckets_.size() && batch->size() < batch_size; ++i) {
+        if (!buckets_[i].empty()) {
+          TakeLocked(i, batch_size - batch->size(), batch);
+          largest = i;
+        }
+      }
+      for (int64_t i = fullest - 1; i >= 0 && batch->size() < batch_size;
+           --i) {
+        TakeLocked(i, batch_size - batch->size(), batch);
+      }
+      return largest;
+    }
+
+    // Copies `batch` into `out_tensors`, padding the dimensions that
+    // `padded_shapes` leaves unknown to `boundary`.
+    Status CopyBatch(IteratorContext* ctx,
+                     const std::vector<std::vector<Tensor>>& batch,
+                     int64_t boundary, std::vector<Tensor>* out_tensors) {
+      const int64_t num_batch_elements = batch.size();
+      for (size_t component_index = 0;
+           component_index < dataset()->padded_shapes_.size();
+           ++component_index) {
+        const PartialTensorShape& padded_shape =
+            dataset()->padded_shapes_[component_index];
+        TensorShape component_shape;
+        for (int dim = 0; dim < padded_shape.dims(); ++dim) {
+          TF_RETURN_IF_ERROR(component_shape.AddDimWithStatus(
+              padded_shape.dim_size(dim) == -1 ? boundary
+                                               : padded_shape.dim_size(dim)));
+        }
+        TensorShape batch_component_shape({num_batch_elements});
+        batch_component_shape.AppendShape(component_shape);
+        out_tensors->emplace_back(ctx->allocator({}),
+                                  output_dtypes()[component_index],
+                                  batch_component_shape);
+        Tensor& batch_component = out_tensors->back();
+        TF_RETURN_IF_ERROR(batch_util::SetElementZero(
+            &batch_component, dataset()->padding_values_[component_index]));
+        for (int64_t i = 0; i < num_batch_elements; ++i) {
+          const Tensor& element = batch[i][component_index];
+          if (element.shape() == component_shape) {
+            TF_RETURN_IF_ERROR(
+                batch_util::CopyElementToSlice(element, &batch_component, i));
+            continue;
+          }
+          for (int dim = 0; dim < component_shape.dims(); ++dim) {
+            if (element.dim_size(dim) > component_shape.dim_size(dim)) {
+              return errors::DataLoss(
+                  "Attempted to pad to a smaller size than the input "
+                  "element.");
+            }
+          }
+          TF_RETURN_IF_ERROR(batch_util::CopyElementToLargerSlice(
+              element, &batch_component, i));
+        }
+      }
+      return absl::OkStatus();
+    }
+
+    mutex mu_;
+    std::unique_ptr<IteratorBase> input_impl_ TF_GUARDED_BY(mu_);
+    // The sorted upper bounds of the buckets, empty until the first window has
+    // been read.
+    std::vector<int64_t> boundaries_ TF_GUARDED_BY(mu_);
+    // The elements of the first window, before the boundaries are chosen.
+    std::vector<std::vector<Tensor>> pending_ TF_GUARDED_BY(mu_);
+    // The elements of each bucket, in input order.
+    std::vector<std::vector<std::vector<Tensor>>> buckets_ TF_GUARDED_BY(mu_);
+    int64_t num_buffered_ TF_GUARDED_BY(mu_) = 0;
+  };
+
+  const DatasetBase* const input_;
+  const int64_t batch_size_;
+  const std::vector<PartialTensorShape> padded_shapes_;
+  const std::vector<Tensor> padding_values_;
+  const int64_t window_size_;
+  const int64_t num_buckets_;
+  const bool drop_remainder_;
+  std::vector<PartialTensorShape> output_shapes_;
+};
+
+void BucketedPaddedBatchDatasetOp::MakeDataset(OpKernelContext* ctx,
+                                               DatasetBase* input,
+                                               DatasetBase** output) {
+  int64_t batch_size;
+  OP_REQUIRES_OK(ctx,
+                 ParseScalarArgument<int64_t>(ctx, kBatchSize, &batch_size));
+  OP_REQUIRES(ctx, batch_size > 0,
+              errors::InvalidArgument("Batch size must be greater than zero."));
+  int64_t window_size;
+  OP_REQUIRES_OK(ctx,
+                 ParseScalarArgument<int64_t>(ctx, kWindowSize, &window_size));
+  OP_REQUIRES(ctx, window_size >= batch_size,
+              errors::InvalidArgument(
+                  "window_size must be at least batch_size, got ",
+                  window_size, " < ", batch_size));
+  int64_t num_buckets;
+  OP_REQUIRES_OK(ctx,
+                 ParseScalarArgument<int64_t>(ctx, kNumBuckets, &num_buckets));
+  OP_REQUIRES(
+      ctx, num_buckets > 0,
+      errors::InvalidArgument("num_buckets must be greater than zero."));
+  bool drop_remainder;
+  OP_REQUIRES_OK(
+      ctx, ParseScalarArgument<bool>(ctx, kDropRemainder, &drop_remainder));
+
+  OpInputList padded_shape_tensors;
+  OP_REQUIRES_OK(ctx, ctx->input_list(kPaddedShapes, &padded_shape_tensors));
+  OP_REQUIRES(ctx, padded_shape_tensors.size() == input->output_shapes().size(),
+              errors::InvalidArgument("Number of padded shapes (",
+                                      padded_shape_tensors.size(),
+                                      ") must match the number of components "
+                                      "in the input dataset's elements (",
+                                      input->output_shapes().size(), ")"));
+  std::vector<PartialTensorShape> padded_shapes;
+  padded_shapes.reserve(padded_shape_tensors.size());
+  for (const Tensor& padded_shape_t : padded_shape_tensors) {
+    OP_REQUIRES(ctx, TensorShapeUtils::IsVector(padded_shape_t.shape()),
+                errors::InvalidArgument("All padded shapes must be vectors"));
+    PartialTensorShape padded_shape;
+    OP_REQUIRES_OK(ctx, PartialTensorShape::MakePartialShape(
+                            padded_shape_t.vec<int64_t>().data(),
+                            padded_shape_t.NumElements(), &padded_shape));
+    padded_shapes.push_back(std::move(padded_shape));
+  }
+
+  OpInputList padding_values_list;
+  OP_REQUIRES_OK(ctx, ctx->input_list(kPaddingValues, &padding_values_list));
+  OP_REQUIRES(ctx, padding_values_list.size() == input->output_shapes().size(),
+              errors::InvalidArgument(
+                  "Number of padding values (", padding_values_list.size(),
+                  ") must match the number of components in the input "
+                  "dataset's elements (",
+                  input->output_shapes().size(), ")"));
+  std::vector<Tensor> padding_values;
+  for (int i = 0; i < padding_values_list.size(); ++i) {
+    const Tensor& padding_value_t = padding_values_list[i];
+    OP_REQUIRES(ctx, TensorShapeUtils::IsScalar(padding_value_t.shape()),
+                errors::InvalidArgument("All padding values must be scalars"));
+    OP_REQUIRES(ctx, padding_value_t.dtype() == input->output_dtypes()[i],
+                errors::InvalidArgument(
+                    "Mismatched type between padding value ", i,
+                    " and input dataset's component ", i, ": ",
+                    DataTypeString(padding_value_t.dtype()), " vs. ",
+                    DataTypeString(input->output_dtypes()[i])));
+    padding_values.push_back(tensor::DeepCopy(padding_value_t));
+  }
+
+  *output = new Dataset(ctx, input, batch_size, std::move(padded_shapes),
+                        std::move(padding_values), window_size, num_buckets,
+                        drop_remainder);
+}
+
+namespace {
+REGISTER_KERNEL_BUILDER(Name("BucketedPaddedBatchDataset").Device(DEVICE_CPU),
+                        BucketedPaddedBatchDatasetOp);
+}  // namespace
+}  // namespace experimental
+}  // namespace data
+}  // namespace tensorflow
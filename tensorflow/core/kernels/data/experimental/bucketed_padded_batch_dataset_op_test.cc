@@ -0,0 +1,246 @@
+/* Copyright 2024 The TensorFlow Authors. All Rights Reserved.
+
+Licensed under the Apache License, Version 2.0 (the "License");
+you may not use this file except in compliance with the License.
+You may obtain a copy of the License at
+
+    http://www.apache.org/licenses/LICENSE-2.0
+
+Unless required by applicable law or agreed to in writing, software
+distributed under the License is distributed on an "AS IS" BASIS,
+WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+See the License for the specific language governing permissions and
+limitations under the License.
+==============================================================================*/
+#include "tensorflow/core/kernels/data/experimental/bucketed_padded_batch_dataset_op.h"
+
+#include <cstdint>
+#include <vector>
+
+#include "tensorflow/core/data/dataset_test_base.h"
+#include "tensorflow/core/platform/test.h"
+
+namespace tensorflow {
+namespace data {
+namespace experimental {
+namespace {
+
+constexpr char kNodeName[] = "bucketed_padded_batch_dataset";
+
+class BucketedPaddedBatchDatasetParams : public DatasetParams {
+ public:
+  template <typename T>
+  BucketedPaddedBatchDatasetParams(
+      T input_dataset_params, int64_t batch_size,
+      std::vector<Tensor> padded_shapes, std::vector<Tensor> padded_values,
+      int64_t window_size, int64_t num_buckets, bool drop_remainder,
+      DataTypeVector output_dtypes,
+      std::vector<PartialTensorShape> output_shapes, string node_name)
+      : DatasetParams(std::move(output_dtypes), std::move(output_shapes),
+                      std::move(node_name)),
+        batch_size_(batch_size),
+        padded_shapes_(std::move(padded_shapes)),
+        padded_values_(std::move(padded_values)),
+        window_size_(window_size),
+        num_buckets_(num_buckets),
+        drop_remainder_(drop_remainder) {
+    input_dataset_params_.push_back(std::make_unique<T>(input_dataset_params));
+    iterator_prefix_ =
+        name_utils::IteratorPrefix(input_dataset_params.dataset_type(),
+                                   input_dataset_params.iterator_prefix());
+  }
+
+  std::vector<Tensor> GetInputTensors() const override {
+    std::vector<Tensor> input_tensors;
+    input_tensors.emplace_back(
+        CreateTensor<int64_t>(TensorShape({}), {batch_size_}));
+    for (const Tensor& padded_shape : padded_shapes_) {
+      input_tensors.emplace_back(padded_shape);
+    }
+    for (const Tensor& padded_value : padded_values_) {
+      input_tensors.emplace_back(padded_value);
+    }
+    input_tensors.emplace_back(
+        CreateTensor<int64_t>(TensorShape({}), {window_size_}));
+    input_tensors.emplace_back(
+        CreateTensor<int64_t>(TensorShape({}), {num_buckets_}));
+    input_tensors.emplace_back(
+        CreateTensor<bool>(TensorShape({}), {drop_remainder_}));
+    return input_tensors;
+  }
+
+  Status GetInputNames(std::vector<string>* input_names) const override {
+    *input_names = {BucketedPaddedBatchDatasetOp::kInputDataset,
+                    BucketedPaddedBatchDatasetOp::kBatchSize};
+    for (int i = 0; i < padded_shapes_.size(); ++i) {
+      input_names->emplace_back(
+          strings::StrCat(BucketedPaddedBatchDatasetOp::kPaddedShapes, "_", i));
+    }
+    for (int i = 0; i < padded_values_.size(); ++i) {
+      input_names->emplace_back(strings::StrCat(
+          BucketedPaddedBatchDatasetOp::kPaddingValues, "_", i));
+    }
+    input_names->push_back(BucketedPaddedBatchDatasetOp::kWindowSize);
+    input_names->push_back(BucketedPaddedBatchDatasetOp::kNumBuckets);
+    input_names->push_back(BucketedPaddedBatchDatasetOp::kDropRemainder);
+    return absl::OkStatus();
+  }
+
+  Status GetAttributes(AttributeVector* attr_vector) const override {
+    *attr_vector = {
+        {BucketedPaddedBatchDatasetOp::kToutputTypes, output_dtypes_},
+        {BucketedPaddedBatchDatasetOp::kOutputShapes, output_shapes_},
+        {BucketedPaddedBatchDatasetOp::kNumPaddedShapes,
+         static_cast<int64_t>(padded_shapes_.size())},
+        {"metadata", ""}};
+    return absl::OkStatus();
+  }
+
+  string dataset_type() const override {
+    return BucketedPaddedBatchDatasetOp::kDatasetType;
+  }
+
+ private:
+  int64_t batch_size_;
+  std::vector<Tensor> padded_shapes_;
+  std::vector<Tensor> padded_values_;
+  int64_t window_size_;
+  int64_t num_buckets_;
+  bool drop_remainder_;
+};
+
+class BucketedPaddedBatchDatasetOpTest : public DatasetOpsTestBase {};
+
+// Three elements of length 1, followed by three elements of length 3.
+ConcatenateDatasetParams MixedLengthsParams() {
+  auto short_params = TensorSliceDatasetParams(
+      /*components=*/CreateTensors<int64_t>(TensorShape{3, 1}, {{0, 1, 2}}),
+      /*node_name=*/"tensor_slice_0");
+  auto long_params = TensorSliceDatasetParams(
+      /*components=*/CreateTensors<int64_t>(
+          TensorShape{3, 3}, {{3, 4, 5, 6, 7, 8, 9, 10, 11}}),
+      /*node_name=*/"tensor_slice_1");
+  return ConcatenateDatasetParams(std::move(short_params),
+                                  std::move(long_params),
+                                  /*output_dtypes=*/{DT_INT64},
+                                  /*output_shapes=*/{PartialTensorShape({-1})},
+                                  /*node_name=*/"concatenate");
+}
+
+BucketedPaddedBatchDatasetParams BucketedParams(int64_t window_size,
+                                                int64_t num_buckets,
+                                                bool drop_remainder) {
+  return BucketedPaddedBatchDatasetParams(
+      MixedLengthsParams(),
+      /*batch_size=*/2,
+      /*padded_shapes=*/{CreateTensor<int64_t>(TensorShape{1}, {-1})},
+      /*padded_values=*/{CreateTensor<int64_t>(TensorShape{}, {-1})},
+      window_size, num_buckets, drop_remainder,
+      /*output_dtypes=*/{DT_INT64},
+      /*output_shapes=*/
+      {PartialTensorShape({drop_remainder ? 2 : -1, -1})}, kNodeName);
+}
+
+// The boundaries [1, 3] are chosen from the whole input.
+BucketedPaddedBatchDatasetParams WholeInputWindowParams() {
+  return BucketedParams(/*window_size=*/6, /*num_buckets=*/2,
+                        /*drop_remainder=*/false);
+}
+
+// The boundary [1] is chosen from the first two elements, and the boundary 3
+// is added for the first long element.
+BucketedPaddedBatchDatasetParams GrowingBoundariesParams() {
+  return BucketedParams(/*window_size=*/2, /*num_buckets=*/1,
+                        /*drop_remainder=*/false);
+}
+
+BucketedPaddedBatchDatasetParams DropRemainderParams() {
+  return BucketedParams(/*window_size=*/6, /*num_buckets=*/2,
+                        /*drop_remainder=*/true);
+}
+
+BucketedPaddedBatchDatasetParams InvalidWindowSizeParams() {
+  return BucketedParams(/*window_size=*/1, /*num_buckets=*/2,
+                        /*drop_remainder=*/false);
+}
+
+std::vector<Tensor> BucketedOutputs(bool drop_remainder) {
+  std::vector<Tensor> outputs = {
+      CreateTensor<int64_t>(TensorShape({2, 1}), {0, 1}),
+      CreateTensor<int64_t>(TensorShape({2, 3}), {3, 4, 5, 6, 7, 8})};
+  if (!drop_remainder) {
+    // The last short element is batched with the last long one.
+    outputs.push_back(
+        CreateTensor<int64_t>(TensorShape({2, 3}), {2, -1, -1, 9, 10, 11}));
+  }
+  return outputs;
+}
+
+std::vector<GetNextTestCase<BucketedPaddedBatchDatasetParams>>
+GetNextTestCases() {
+  return {{/*dataset_params=*/WholeInputWindowParams(),
+           /*expected_outputs=*/BucketedOutputs(false)},
+          {/*dataset_params=*/GrowingBoundariesParams(),
+           /*expected_outputs=*/BucketedOutputs(false)},
+          {/*dataset_params=*/DropRemainderParams(),
+           /*expected_outputs=*/BucketedOutputs(true)}};
+}
+
+ITERATOR_GET_NEXT_TEST_P(BucketedPaddedBatchDatasetOpTest,
+                         BucketedPaddedBatchDatasetParams, GetNextTestCases())
+
+TEST_F(BucketedPaddedBatchDatasetOpTest, DatasetNodeName) {
+  auto dataset_params = WholeInputWindowParams();
+  TF_ASSERT_OK(Initialize(dataset_params));
+  TF_ASSERT_OK(CheckDatasetNodeName(dataset_params.node_name()));
+}
+
+TEST_F(BucketedPaddedBatchDatasetOpTest, DatasetTypeString) {
+  auto dataset_params = WholeInputWindowParams();
+  TF_ASSERT_OK(Initialize(dataset_params));
+  TF_ASSERT_OK(CheckDatasetTypeString(
+      name_utils::OpName(BucketedPaddedBatchDatasetOp::kDatasetType)));
+}
+
+TEST_F(BucketedPaddedBatchDatasetOpTest, Cardinality) {
+  auto dataset_params = WholeInputWindowParams();
+  TF_ASSERT_OK(Initialize(dataset_params));
+  TF_ASSERT_OK(CheckDatasetCardinality(3));
+}
+
+TEST_F(BucketedPaddedBatchDatasetOpTest, InvalidWindowSize) {
+  auto dataset_params = InvalidWindowSizeParams();
+  EXPECT_EQ(Initialize(dataset_params).code(),
+            absl::StatusCode::kInvalidArgument);
+}
+
+TEST(ChooseBucketBoundariesTest, MinimizesPadding) {
+  const std::vector<int64_t> lengths = {1, 9, 1, 2, 10, 1};
+  EXPECT_EQ(BucketedPaddedBatchDatasetOp::ChooseBucketBoundaries(lengths, 1),
+            std::vector<int64_t>({10}));
+  EXPECT_EQ(BucketedPaddedBatchDatasetOp::ChooseBucketBoundaries(lengths, 2),
+            std::vector<int64_t>({2, 10}));
+  EXPECT_EQ(BucketedPaddedBatchDatasetOp::ChooseBucketBoundaries(lengths, 3),
+            std::vector<int64_t>({1, 2, 10}));
+  EXPECT_EQ(BucketedPaddedBatchDatasetOp::ChooseBucketBoundaries(lengths, 8),
+            std::vector<int64_t>({1, 2, 9, 10}));
+}
+
+std::vector<IteratorSaveAndRestoreTestCase<BucketedPaddedBatchDatasetParams>>
+IteratorSaveAndRestoreTestCases() {
+  return {{/*dataset_params=*/WholeInputWindowParams(),
+           /*breakpoints=*/{0, 1, 4}, /*expected_outputs=*/
+           BucketedOutputs(false)},
+          {/*dataset_params=*/GrowingBoundariesParams(),
+           /*breakpoints=*/{0, 1, 2, 4},
+           /*expected_outputs=*/BucketedOutputs(false)}};
+}
+
+ITERATOR_SAVE_AND_RESTORE_TEST_P(BucketedPaddedBatchDatasetOpTest,
+                                 BucketedPaddedBatchDatasetParams,
+                                 IteratorSaveAndRestoreTestCases())
+
+}  // namespace
+}  // namespace experimental
+}  // namespace data
+}  // namespace tensorflow
@@ -16,6 +16,7 @@ limitations under the License.
 #include "tensorflow/core/framework/dataset.h"
 #include "tensorflow/core/framework/op.h"
 #include "tensorflow/core/framework/shape_inference.h"
+#include "tensorflow/core/kernels/data/experimental/csv_structural_scanner.h"
 #include "tensorflow/core/lib/io/inputstream_interface.h"
 #include "tensorflow/core/lib/io/random_inputstream.h"
 #include "tensorflow/core/lib/io/zlib_compression_options.h"
@@ -276,7 +277,9 @@ class CSVDatasetOp : public DatasetOpKernel {
     class Iterator : public DatasetIterator<Dataset> {
      public:
       explicit Iterator(const Params& params)
-          : DatasetIterator<Dataset>(params) {}
+          : DatasetIterator<Dataset>(params),
+            scanner_(params.dataset->delim_,
+                     params.dataset->use_quote_delim_) {}
 
       Status GetNextInternal(IteratorContext* ctx,
                              std::vector<Tensor>* out_tensors,
@@ -487,8 +490,10 @@ class CSVDatasetOp : public DatasetOpKernel {
 
         buffer_.swap(temp_buffer);
         if (include && pos_ > *start) {
+          // Only keeps the part of the buffer that belongs to the field.
           earlier_pieces->push_back(
-              Piece(std::move(temp_buffer), *start, pos_ - *start));
+              Piece(string(temp_buffer.data() + *start, pos_ - *start), 0,
+                    pos_ - *start));
         }
         pos_ = 0;
         *start = 0;
@@ -508,7 +513,7 @@ class CSVDatasetOp : public DatasetOpKernel {
         pos_++;  // Starting quotation mark
 
         Status parse_result;
-        while (true) {  // Each iter reads 1 char, filling buffer if necessary
+        while (true) {  // Each iter finds 1 quote, filling buffer if necessary
           if (pos_ >= buffer_.size()) {
             Status s = SaveAndFillBuffer(&earlier_pieces, &start, include);
             if (errors::IsOutOfRange(s)) {
@@ -520,49 +525,51 @@ class CSVDatasetOp : public DatasetOpKernel {
             }
           }
 
-          char ch = buffer_[pos_];
-          if (ch == '"') {
-            // When we encounter a quote, we look ahead to the next character to
-            // decide what to do
-            pos_++;
-            if (pos_ >= buffer_.size()) {
-              Status s = SaveAndFillBuffer(&earlier_pieces, &start, include);
-              if (errors::IsOutOfRange(s)) {
-                // This was the last field. We are done
-                *end_of_record = true;
-                parse_result.Update(QuotedFieldToOutput(
-                    ctx, StringPiece(), out_tensors, earlier_pieces, include));
-                return parse_result;
-              } else if (!s.ok()) {
-                return s;
-              }
-            }
-
-            char next = buffer_[pos_];
-            pos_++;
-            if (next == dataset()->delim_) {
-              parse_result.Update(QuotedFieldToOutput(
-                  ctx, StringPiece(&buffer_[start], pos_ - 1 - start),
-                  out_tensors, earlier_pieces, include));
-              return parse_result;
-
-            } else if (next == '\n' || next == '\r') {
+          // Inside quotes, only another quote can end the field.
+          const void* quote = std::memchr(buffer_.data() + pos_, '"',
+                                          buffer_.size() - pos_);
+          if (quote == nullptr) {
+            pos_ = buffer_.size();
+            continue;
+          }
+          pos_ = static_cast<const char*>(quote) - buffer_.data();
+          // When we encounter a quote, we look ahead to the next character to
+          // decide what to do
+          pos_++;
+          if (pos_ >= buffer_.size()) {
+            Status s = SaveAndFillBuffer(&earlier_pieces, &start, include);
+            if (errors::IsOutOfRange(s)) {
+              // This was the last field. We are done
               *end_of_record = true;
               parse_result.Update(QuotedFieldToOutput(
-                  ctx, StringPiece(&buffer_[start], pos_ - 1 - start),
-                  out_tensors, earlier_pieces, include));
-              if (next == '\r') SkipNewLineIfNecessary();
+                  ctx, StringPiece(), out_tensors, earlier_pieces, include));
               return parse_result;
-            } else if (next != '"') {
-              // Take note of the error, but keep going to end of field.
-              include = false;  // So we don't get funky errors when trying to
-                                // unescape the quotes.
-              parse_result.Update(errors::InvalidArgument(
-                  "Quote inside a string has to be escaped by another quote"));
+            } else if (!s.ok()) {
+              return s;
             }
+          }
 
-          } else {
-            pos_++;
+          char next = buffer_[pos_];
+          pos_++;
+          if (next == dataset()->delim_) {
+            parse_result.Update(QuotedFieldToOutput(
+                ctx, StringPiece(&buffer_[start], pos_ - 1 - start),
+                out_tensors, earlier_pieces, include));
+            return parse_result;
+
+          } else if (next == '\n' || next == '\r') {
+            *end_of_record = true;
+            parse_result.Update(QuotedFieldToOutput(
+                ctx, StringPiece(&buffer_[start], pos_ - 1 - start),
+                out_tensors, earlier_pieces, include));
+            if (next == '\r') SkipNewLineIfNecessary();
+            return parse_result;
+          } else if (next != '"') {
+            // Take note of the error, but keep going to end of field.
+            include = false;  // So we don't get funky errors when trying to
+                              // unescape the quotes.
+            parse_result.Update(errors::InvalidArgument(
+                "Quote inside a string has to be escaped by another quote"));
           }
         }
       }
@@ -641,7 +648,7 @@ class CSVDatasetOp : public DatasetOpKernel {
         size_t start = pos_;
         Status parse_result;
 
-        while (true) {  // Each iter reads 1 char, filling buffer if necessary
+        while (true) {  // Each iter finds 1 structural char or fills the buffer
           if (pos_ >= buffer_.size()) {
             Status s = SaveAndFillBuffer(&earlier_pieces, &start, include);
             // Handle errors
@@ -657,6 +664,10 @@ class CSVDatasetOp : public DatasetOpKernel {
             }
           }
 
+          pos_ = scanner_.Next(pos_);
+          if (pos_ >= buffer_.size()) {
+            continue;  // The field goes on in the next buffer
+          }
           char ch = buffer_[pos_];
 
           if (ch == dataset()->delim_) {
@@ -682,7 +693,7 @@ class CSVDatasetOp : public DatasetOpKernel {
             parse_result.Update(errors::InvalidArgument(
                 "Unquoted fields cannot have quotes inside"));
           }
-          // Otherwise, go to next character
+          // Otherwise, go on after the quote
           pos_++;
         }
       }
@@ -692,6 +703,7 @@ class CSVDatasetOp : public DatasetOpKernel {
         ++num_buffer_reads_;
         Status s = input_stream_->ReadNBytes(
             dataset()->options_.input_buffer_size, result);
+        scanner_.Reset(result->data(), result->size());
 
         if (errors::IsOutOfRange(s) && !result->empty()) {
           // Ignore OutOfRange error when ReadNBytes read < N bytes.
@@ -789,7 +801,7 @@ class CSVDatasetOp : public DatasetOpKernel {
               component.scalar<tstring>()() =
                   dataset()->record_defaults_[output_idx].flat<tstring>()(0);
             } else {
-              component.scalar<tstring>()() = string(field);
+              component.scalar<tstring>()().assign(field.data(), field.size());
             }
             break;
           }
@@ -869,6 +881,7 @@ class CSVDatasetOp : public DatasetOpKernel {
           input_stream_ = random_access_input_stream_;
         }
         buffer_.clear();
+        scanner_.Reset(buffer_.data(), buffer_.size());
         pos_ = 0;
         num_buffer_reads_ = 0;
         if (dataset()->header_) {
@@ -897,6 +910,8 @@ class CSVDatasetOp : public DatasetOpKernel {
       size_t pos_ TF_GUARDED_BY(
           mu_);  // Index into the buffer must be maintained between iters
       size_t num_buffer_reads_ TF_GUARDED_BY(mu_);
+      // Finds the structural characters of `buffer_`.
+      StructuralScanner scanner_ TF_GUARDED_BY(mu_);
       std::shared_ptr<io::RandomAccessInputStream> random_access_input_stream_
           TF_GUARDED_BY(mu_);
       std::shared_ptr<io::InputStreamInterface> input_stream_
@@ -0,0 +1,155 @@
+/* Copyright 2018 The TensorFlow Authors. All Rights Reserved.
+
+Licensed under the Apache License, Version 2.0 (the "License");
+you may not use this file except in compliance with the License.
+You may obtain a copy of the License at
+
+    http://www.apache.org/licenses/LICENSE-2.0
+
+Unless required by applicable law or agreed to in writing, software
+distributed under the License is distributed on an "AS IS" BASIS,
+WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+See the License for the specific language governing permissions and
+limitations under the License.
+==============================================================================*/
+#ifndef TENSORFLOW_CORE_KERNELS_DATA_EXPERIMENTAL_CSV_STRUCTURAL_SCANNER_H_
+#define TENSORFLOW_CORE_KERNELS_DATA_EXPERIMENTAL_CSV_STRUCTURAL_SCANNER_H_
+
+#include <algorithm>
+#include <cstddef>
+#include <cstdint>
+#include <cstring>
+
+#include "absl/numeric/bits.h"
+#include "tensorflow/core/platform/byte_order.h"
+
+// Defining `TF_CSV_SCANNER_DISABLE_SSE2` selects the portable implementation
+// even where SSE2 is available, so that it can be tested on x86.
+#if defined(__SSE2__) && !defined(TF_CSV_SCANNER_DISABLE_SSE2)
+#include <emmintrin.h>
+#endif
+
+namespace tensorflow {
+namespace data {
+namespace experimental {
+
+// Finds the structural characters of a buffer of CSV input, i.e. the field
+// delimiter, the line breaks and, if quoted fields are enabled, the quotation
+// mark. The buffer is scanned in blocks of 64 bytes: for each block, a bit mask
+// of the positions of its structural characters is computed with vector (or
+// word-wide) comparisons, so that the parser can jump from one structural
+// character to the next instead of inspecting every byte of the input.
+class StructuralScanner {
+ public:
+  StructuralScanner(char delim, bool use_quote_delim)
+      // Without quoted fields, the delimiter takes the place of the quotation
+      // mark so that every block is always compared with four characters.
+      : chars_{delim, '\n', '\r', use_quote_delim ? '"' : delim} {}
+
+  // Starts scanning `size` bytes at `data`, which must stay valid until the
+  // next call to `Reset`.
+  void Reset(const char* data, size_t size) {
+    data_ = data;
+    size_ = size;
+    block_start_ = kNoBlock;
+  }
+
+  // Returns the position of the first structural character at or after `pos`,
+  // or the size of the buffer if there is none.
+  size_t Next(size_t pos) {
+    while (pos < size_) {
+      const size_t block_start = pos & ~(kBlockSize - 1);
+      if (block_start != block_start_) {
+        block_start_ = block_start;
+        block_mask_ = BlockMask(block_start);
+      }
+      const uint64_t mask = block_mask_ & (~uint64_t{0} << (pos - block_start));
+      if (mask != 0) {
+        return block_start + absl::countr_zero(mask);
+      }
+      pos = block_start + kBlockSize;
+    }
+    return size_;
+  }
+
+ private:
+  static constexpr size_t kBlockSize = 64;
+  static constexpr size_t kNoBlock = ~size_t{0};
+
+  // Returns the mask of the structural characters of the block at
+  // `block_start`. The last block of the buffer may be partial.
+  uint64_t BlockMask(size_t block_start) const {
+    const size_t length = std::min(kBlockSize, size_ - block_start);
+    if (length == kBlockSize) {
+      return FullBlockMask(data_ + block_start);
+    }
+    char block[kBlockSize] = {};
+    std::memcpy(block, data_ + block_start, length);
+    return FullBlockMask(block) & ((uint64_t{1} << length) - 1);
+  }
+
+  uint64_t FullBlockMask(const char* block) const {
+    uint64_t mask = 0;
+#if defined(__SSE2__) && !defined(TF_CSV_SCANNER_DISABLE_SSE2)
+    const __m128i c0 = _mm_set1_epi8(chars_[0]);
+    const __m128i c1 = _mm_set1_epi8(chars_[1]);
+    const __m128i c2 = _mm_set1_epi8(chars_[2]);
+    const __m128i c3 = _mm_set1_epi8(chars_[3]);
+    for (size_t i = 0; i < kBlockSize / 16; ++i) {
+      const __m128i v =
+          _mm_loadu_si128(reinterpret_cast<const __m128i*>(block + 16 * i));
+      const __m128i matches = _mm_or_si128(
+          _mm_or_si128(_mm_cmpeq_epi8(v, c0), _mm_cmpeq_epi8(v, c1)),
+          _mm_or_si128(_mm_cmpeq_epi8(v, c2), _mm_cmpeq_epi8(v, c3)));
+      mask |= static_cast<uint64_t>(static_cast<uint16_t>(
+                  _mm_movemask_epi8(matches)))
+              << (16 * i);
+    }
+#else
+    if (port::kLittleEndian) {
+      for (size_t i = 0; i < kBlockSize / 8; ++i) {
+        uint64_t word;
+        std::memcpy(&word, block + 8 * i, sizeof(word));
+        uint64_t matches = 0;
+        for (char c : chars_) {
+          matches |= ZeroBytes(word ^ Broadcast(c));
+        }
+        // Gathers the high bit of each byte into the low byte of the mask.
+        mask |= (((matches >> 7) * 0x0102040810204080ULL) >> 56) << (8 * i);
+      }
+    } else {
+      for (size_t i = 0; i < kBlockSize; ++i) {
+        for (char c : chars_) {
+          if (block[i] == c) {
+            mask |= uint64_t{1} << i;
+            break;
+          }
+        }
+      }
+    }
+#endif
+    return mask;
+  }
+
+  static uint64_t Broadcast(char c) {
+    return static_cast<uint8_t>(c) * 0x0101010101010101ULL;
+  }
+
+  // Returns a word with the high bit set in each byte of `word` that is zero.
+  static uint64_t ZeroBytes(uint64_t word) {
+    constexpr uint64_t kLowBits = 0x7F7F7F7F7F7F7F7FULL;
+    return ~(((word & kLowBits) + kLowBits) | word | kLowBits);
+  }
+
+  const char chars_[4];
+  const char* data_ = nullptr;
+  size_t size_ = 0;
+  size_t block_start_ = kNoBlock;
+  uint64_t block_mask_ = 0;
+};
+
+}  // namespace experimental
+}  // namespace data
+}  // namespace tensorflow
+
+#endif  // TENSORFLOW_CORE_KERNELS_DATA_EXPERIMENTAL_CSV_STRUCTURAL_SCANNER_H_
@@ -0,0 +1,170 @@
+/* Copyright 2018 The TensorFlow Authors. All Rights Reserved.
+
+Licensed under the Apache License, Version 2.0 (the "License");
+you may not use this file except in compliance with the License.
+You may obtain a copy of the License at
+
+    http://www.apache.org/licenses/LICENSE-2.0
+
+Unless required by applicable law or agreed to in writing, software
+distributed under the License is distributed on an "AS IS" BASIS,
+WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+See the License for the specific language governing permissions and
+limitations under the License.
+==============================================================================*/
+#include "tensorflow/core/kernels/data/experimental/csv_structural_scanner.h"
+
+#include <cstddef>
+#include <random>
+#include <string>
+#include <vector>
+
+#include "tensorflow/core/platform/test.h"
+
+namespace tensorflow {
+namespace data {
+namespace experimental {
+namespace {
+
+// Returns the positions of every structural character of `data`, found by
+// visiting the characters one at a time with the scanner.
+std::vector<size_t> ScanAll(StructuralScanner* scanner,
+                            const std::string& data) {
+  scanner->Reset(data.data(), data.size());
+  std::vector<size_t> positions;
+  for (size_t pos = scanner->Next(0); pos < data.size();
+       pos = scanner->Next(pos + 1)) {
+    positions.push_back(pos);
+  }
+  return positions;
+}
+
+// Returns the positions of every structural character of `data`, found by
+// inspecting every byte.
+std::vector<size_t> ExpectedPositions(const std::string& data, char delim,
+                                      bool use_quote_delim) {
+  std::vector<size_t> positions;
+  for (size_t i = 0; i < data.size(); ++i) {
+    const char c = data[i];
+    if (c == delim || c == '\n' || c == '\r' || (use_quote_delim && c == '"')) {
+      positions.push_back(i);
+    }
+  }
+  return positions;
+}
+
+TEST(StructuralScannerTest, EmptyBuffer) {
+  StructuralScanner scanner(',', /*use_quote_delim=*/true);
+  scanner.Reset(nullptr, 0);
+  EXPECT_EQ(scanner.Next(0), 0);
+}
+
+TEST(StructuralScannerTest, NoStructuralCharacters) {
+  StructuralScanner scanner(',', /*use_quote_delim=*/true);
+  const std::string data(200, 'a');
+  scanner.Reset(data.data(), data.size());
+  EXPECT_EQ(scanner.Next(0), data.size());
+  EXPECT_EQ(scanner.Next(100), data.size());
+}
+
+TEST(StructuralScannerTest, FieldsStraddleBlockBoundaries) {
+  StructuralScanner scanner(',', /*use_quote_delim=*/true);
+  std::string data(200, 'a');
+  for (size_t pos : {0, 62, 63, 64, 65, 127, 128, 191, 199}) {
+    data[pos] = ',';
+  }
+  EXPECT_EQ(ScanAll(&scanner, data),
+            std::vector<size_t>({0, 62, 63, 64, 65, 127, 128, 191, 199}));
+}
+
+TEST(StructuralScannerTest, QuotedFieldStraddlesBlockBoundary) {
+  StructuralScanner scanner(',', /*use_quote_delim=*/true);
+  // The quoted field starts in the first block and ends in the third one.
+  std::string data = std::string(60, 'a') + ",\"" + std::string(70, 'b') +
+                     "\"\",\"" + std::string(10, 'c') + "\"\n";
+  EXPECT_EQ(ScanAll(&scanner, data),
+            ExpectedPositions(data, ',', /*use_quote_delim=*/true));
+  EXPECT_EQ(ScanAll(&scanner, data),
+            std::vector<size_t>({60, 61, 132, 133, 134, 135, 146, 147}));
+}
+
+TEST(StructuralScannerTest, CrLfStraddlesBlockBoundary) {
+  StructuralScanner scanner(',', /*use_quote_delim=*/true);
+  std::string data = std::string(63, 'a') + "\r\n" + std::string(61, 'b') +
+                     "\r\n" + "c,d\r\n";
+  EXPECT_EQ(ScanAll(&scanner, data),
+            std::vector<size_t>({63, 64, 126, 127, 129, 131, 132}));
+}
+
+TEST(StructuralScannerTest, QuotesAreOrdinaryWithoutQuoteDelim) {
+  StructuralScanner scanner(',', /*use_quote_delim=*/false);
+  std::string data = std::string(62, '"') + ",\"" + std::string(64, '"') + "\n";
+  EXPECT_EQ(ScanAll(&scanner, data), std::vector<size_t>({62, 128}));
+}
+
+TEST(StructuralScannerTest, CustomDelimiter) {
+  StructuralScanner scanner('\t', /*use_quote_delim=*/true);
+  std::string data = std::string(64, ',') + "\t\"x\"\t" + std::string(64, ';');
+  EXPECT_EQ(ScanAll(&scanner, data), std::vector<size_t>({64, 65, 67, 68}));
+}
+
+TEST(StructuralScannerTest, NonAsciiDelimiter) {
+  const char delim = '\xfe';
+  StructuralScanner scanner(delim, /*use_quote_delim=*/true);
+  std::string data = std::string(70, '\xff') + delim + std::string(70, '\x7e') +
+                     delim + "\n";
+  EXPECT_EQ(ScanAll(&scanner, data), std::vector<size_t>({70, 141, 142}));
+}
+
+TEST(StructuralScannerTest, IgnoresBytesPastPartialLastBlock) {
+  StructuralScanner scanner(',', /*use_quote_delim=*/true);
+  const std::string data = std::string(70, 'a') + ",,,";
+  // Only the first 70 bytes belong to the buffer.
+  scanner.Reset(data.data(), 70);
+  EXPECT_EQ(scanner.Next(0), 70);
+  EXPECT_EQ(scanner.Next(65), 70);
+}
+
+TEST(StructuralScannerTest, ResetAfterRefill) {
+  // Refilling reuses the storage of the input buffer, so the scanner must not
+  // keep the masks of the previous contents.
+  StructuralScanner scanner(',', /*use_quote_delim=*/true);
+  std::string buffer = std::string(40, 'a') + "," + std::string(40, 'a');
+  scanner.Reset(buffer.data(), buffer.size());
+  EXPECT_EQ(scanner.Next(0), 40);
+
+  // The record goes on in the next buffer, which is shorter than it.
+  buffer.assign(std::string(30, 'b') + "\r\n" + std::string(49, 'c'));
+  scanner.Reset(buffer.data(), buffer.size());
+  EXPECT_EQ(scanner.Next(0), 30);
+  EXPECT_EQ(scanner.Next(31), 31);
+  EXPECT_EQ(scanner.Next(32), buffer.size());
+}
+
+TEST(StructuralScannerTest, RandomInputsMatchByteByByteScan) {
+  std::mt19937 gen(1234);
+  const std::string alphabet = "ab,;\"\n\r\xfe";
+  std::uniform_int_distribution<size_t> char_dist(0, alphabet.size() - 1);
+  std::uniform_int_distribution<size_t> size_dist(0, 300);
+  for (int i = 0; i < 1000; ++i) {
+    std::string data(size_dist(gen), ' ');
+    for (char& c : data) {
+      // Keep structural characters sparse, as in real input.
+      c = gen() % 4 == 0 ? alphabet[char_dist(gen)] : 'x';
+    }
+    for (char delim : {',', ';', '\xfe'}) {
+      for (bool use_quote_delim : {false, true}) {
+        StructuralScanner scanner(delim, use_quote_delim);
+        EXPECT_EQ(ScanAll(&scanner, data),
+                  ExpectedPositions(data, delim, use_quote_delim))
+            << "data=" << data << " delim=" << delim
+            << " use_quote_delim=" << use_quote_delim;
+      }
+    }
+  }
+}
+
+}  // namespace
+}  // namespace experimental
+}  // namespace data
+}  // namespace tensorflow
@@ -0,0 +1,455 @@
+/* Copyright 2024 The TensorFlow Authors. All Rights Reserved.
+
+Licensed under the Apache License, Version 2.0 (the "License");
+you may not use this file except in compliance with the License.
+You may obtain a copy of the License at
+
+    http://www.apache.org/licenses/LICENSE-2.0
+
+Unless required by applicable law or agreed to in writing, software
+distributed under the License is distributed on an "AS IS" BASIS,
+WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+See the License for the specific language governing permissions and
+limitations under the License.
+==============================================================================*/
+#include "tensorflow/core/kernels/data/experimental/external_shuffle_dataset_op.h"
+
+#include <memory>
+#include <string>
+#include <utility>
+#include <vector>
+
+#include "absl/strings/str_cat.h"
+#include "tensorflow/core/data/dataset_utils.h"
+#include "tensorflow/core/data/name_utils.h"
+#include "tensorflow/core/data/serialization_utils.h"
+#include "tensorflow/core/data/snapshot_utils.h"
+#include "tensorflow/core/framework/dataset.h"
+#include "tensorflow/core/framework/partial_tensor_shape.h"
+#include "tensorflow/core/framework/tensor.h"
+#include "tensorflow/core/lib/io/compression.h"
+#include "tensorflow/core/lib/random/philox_random.h"
+#include "tensorflow/core/lib/random/random.h"
+#include "tensorflow/core/lib/random/random_distributions.h"
+#include "tensorflow/core/platform/path.h"
+
+namespace tensorflow {
+namespace data {
+namespace experimental {
+
+// Constants declared in external_shuffle_dataset_op.h and used both here and
+// in test cases.
+/* static */ constexpr const char* const ExternalShuffleDatasetOp::kDatasetType;
+/* static */ constexpr const char* const
+    ExternalShuffleDatasetOp::kInputDataset;
+/* static */ constexpr const char* const ExternalShuffleDatasetOp::kRunSize;
+/* static */ constexpr const char* const ExternalShuffleDatasetOp::kSeed;
+/* static */ constexpr const char* const ExternalShuffleDatasetOp::kSeed2;
+/* static */ constexpr const char* const ExternalShuffleDatasetOp::kDirectory;
+/* static */ constexpr const char* const ExternalShuffleDatasetOp::kCompression;
+/* static */ constexpr const char* const ExternalShuffleDatasetOp::kOutputTypes;
+/* static */ constexpr const char* const
+    ExternalShuffleDatasetOp::kOutputShapes;
+
+namespace {
+
+// Runs are written with the TFRecord-based snapshot format.
+constexpr int kRunFileVersion = 2;
+
+constexpr char kNumRandomSamples[] = "num_random_samples";
+constexpr char kSeed[] = "seed";
+constexpr char kSeed2[] = "seed2";
+constexpr char kInputImplEmpty[] = "input_impl_empty";
+constexpr char kNumRuns[] = "num_runs";
+constexpr char kRunFilename[] = "run_filename";
+constexpr char kRunNumElements[] = "run_num_elements";
+constexpr char kRunNumRead[] = "run_num_read";
+constexpr char kBuffer[] = "buffer";
+
+}  // namespace
+
+class ExternalShuffleDatasetOp::Dataset : public DatasetBase {
+ public:
+  Dataset(OpKernelContext* ctx, const DatasetBase* input, int64_t run_size,
+          int64_t seed, int64_t seed2, std::string directory,
+          std::string compression)
+      : DatasetBase(DatasetContext(ctx)),
+        input_(input),
+        run_size_(run_size),
+        seeds_(seed, seed2),
+        directory_(std::move(directory)),
+        compression_(std::move(compression)) {
+    input_->Ref();
+  }
+
+  ~Dataset() override { input_->Unref(); }
+
+  std::unique_ptr<IteratorBase> MakeIteratorInternal(
+      const string& prefix) const override {
+    return std::make_unique<Iterator>(
+        Iterator::Params{this,
+                         name_utils::IteratorPrefix(kDatasetType, prefix)},
+        seeds_.first, seeds_.second);
+  }
+
+  const DataTypeVector& output_dtypes() const override {
+    return input_->output_dtypes();
+  }
+
+  const std::vector<PartialTensorShape>& output_shapes() const override {
+    return input_->output_shapes();
+  }
+
+  string DebugString() const override {
+    return name_utils::DatasetDebugString(kDatasetType);
+  }
+
+  int64_t CardinalityInternal(CardinalityOptions options) const override {
+    return input_->Cardinality(options);
+  }
+
+  Status InputDatasets(std::vector<const DatasetBase*>* inputs) const override {
+    inputs->push_back(input_);
+    return absl::OkStatus();
+  }
+
+  Status CheckExternalState() const override {
+    return input_->CheckExternalState();
+  }
+
+ protected:
+  Status AsGraphDefInternal(SerializationContext* ctx,
+                            DatasetGraphDefBuilder* b,
+                            Node** output) const override {
+    Node* input_graph_node = nullptr;
+    TF_RETURN_IF_ERROR(b->AddInputDataset(ctx, input_, &input_graph_node));
+    Node* run_size = nullptr;
+    Node* seed = nullptr;
+    Node* seed2 = nullptr;
+    Node* directory = nullptr;
+    TF_RETURN_IF_ERROR(b->AddScalar(run_size_, &run_size));
+    TF_RETURN_IF_ERROR(b->AddScalar(seeds_.first, &seed));
+    TF_RETURN_IF_ERROR(b->AddScalar(seeds_.second, &seed2));
+    TF_RETURN_IF_ERROR(b->AddScalar(tstring(directory_), &directory));
+    AttrValue compression;
+    b->BuildAttrValue(compression_, &compression);
+    TF_RETURN_IF_ERROR(b->AddDataset(
+        this, {input_graph_node, run_size, seed, seed2, directory},
+        {{kCompression, compression}}, output));
+    return absl::OkStatus();
+  }
+
+ private:
+  // The input is read into runs of up to `run_size` elements. Each complete
+  // run is shuffled in memory and written to a file in `directory`, and the
+  // last, partial run stays in memory. The runs are then merged by picking
+  // each output element from a run with probability proportional to the
+  // number of elements left in the run, which, as every run is uniformly
+  // shuffled, makes the output a uniform permutation of the input.
+  //
+  // A run file is deleted once all of its elements have been read, or when
+  // the iterator is destroyed, unless the iterator has been checkpointed, in
+  // which case the files are left for the restored iterator to read.
+  class Iterator : public DatasetIterator<Dataset> {
+   public:
+    Iterator(const Params& params, int64_t seed, int64_t seed2)
+        : DatasetIterator<Dataset>(params),
+          seeds_(MaybeOverrideSeeds({seed, seed2})),
+          parent_generator_(seeds_.first, seeds_.second),
+          generator_(&parent_generator_) {}
+
+    ~Iterator() override {
+      mutex_lock l(mu_);
+      if (!checkpointed_) {
+        DeleteRuns(Env::Default());
+      }
+    }
+
+    Status Initialize(IteratorContext* ctx) override {
+      return dataset()->input_->MakeIterator(ctx, this, prefix(), &input_impl_);
+    }
+
+    Status GetNextInternal(IteratorContext* ctx,
+                           std::vector<Tensor>* out_tensors,
+                           bool* end_of_sequence) override {
+      mutex_lock l(mu_);
+      if (input_impl_) {
+        TF_RETURN_IF_ERROR(FillRuns(ctx));
+      }
+      int64_t num_remaining = buffer_.size();
+      for (const Run& run : runs_) {
+        num_remaining += run.num_elements - run.num_read;
+      }
+      if (num_remaining == 0) {
+        *end_of_sequence = true;
+        return absl::OkStatus();
+      }
+      *end_of_sequence = false;
+      int64_t pick = Random() % num_remaining;
+      for (Run& run : runs_) {
+        const int64_t run_remaining = run.num_elements - run.num_read;
+        if (pick < run_remaining) {
+          return ReadFromRun(ctx, run, out_tensors);
+        }
+        pick -= run_remaining;
+      }
+      *out_tensors = std::move(buffer_.back());
+      buffer_.pop_back();
+      return absl::OkStatus();
+    }
+
+   protected:
+    std::shared_ptr<model::Node> CreateNode(
+        IteratorContext* ctx, model::Node::Args args) const override {
+      return model::MakeKnownRatioNode(std::move(args), /*ratio=*/1);
+    }
+
+    Status SaveInternal(SerializationContext* ctx,
+                        IteratorStateWriter* writer) override {
+      mutex_lock l(mu_);
+      TF_RETURN_IF_ERROR(writer->WriteScalar(prefix(), kNumRandomSamples,
+                                             num_random_samples_));
+      TF_RETURN_IF_ERROR(writer->WriteScalar(prefix(), kSeed, seeds_.first));
+      TF_RETURN_IF_ERROR(writer->WriteScalar(prefix(), kSeed2, seeds_.second));
+      if (input_impl_) {
+        TF_RETURN_IF_ERROR(SaveInput(ctx, writer, input_impl_));
+      } else {
+        TF_RETURN_IF_ERROR(writer->WriteScalar(prefix(), kInputImplEmpty, ""));
+      }
+      TF_RETURN_IF_ERROR(writer->WriteScalar(
+          prefix(), kNumRuns, static_cast<int64_t>(runs_.size())));
+      for (int64_t i = 0; i < runs_.size(); ++i) {
+        const Run& run = runs_[i];
+        TF_RETURN_IF_ERROR(
+            writer->WriteScalar(prefix(), absl::StrCat(kRunFilename, "_", i),
+                                tstring(run.filename)));
+        TF_RETURN_IF_ERROR(writer->WriteScalar(
+            prefix(), absl::StrCat(kRunNumElements, "_", i), run.num_elements));
+        TF_RETURN_IF_ERROR(writer->WriteScalar(
+            prefix(), absl::StrCat(kRunNumRead, "_", i), run.num_read));
+      }
+      TF_RETURN_IF_ERROR(
+          WriteElementsToCheckpoint(writer, full_name(kBuffer), buffer_));
+      checkpointed_ = true;
+      return absl::OkStatus();
+    }
+
+    Status RestoreInternal(IteratorContext* ctx,
+                           IteratorStateReader* reader) override {
+      mutex_lock l(mu_);
+      TF_RETURN_IF_ERROR(reader->ReadScalar(prefix(), kNumRandomSamples,
+                                            &num_random_samples_));
+      int64_t seed;
+      TF_RETURN_IF_ERROR(reader->ReadScalar(prefix(), kSeed, &seed));
+      int64_t seed2;
+      TF_RETURN_IF_ERROR(reader->ReadScalar(prefix(), kSeed2, &seed2));
+      seeds_ = {seed, seed2};
+      ResetRngs();
+      if (!reader->Contains(prefix(), kInputImplEmpty)) {
+        TF_RETURN_IF_ERROR(RestoreInput(ctx, reader, input_impl_));
+      } else {
+        input_impl_.reset();
+      }
+      if (!checkpointed_) {
+        DeleteRuns(ctx->env());
+      }
+      runs_.clear();
+      int64_t num_runs;
+      TF_RETURN_IF_ERROR(reader->ReadScalar(prefix(), kNumRuns, &num_runs));
+      runs_.resize(num_runs);
+      for (int64_t i = 0; i < num_runs; ++i) {
+        Run& run = runs_[i];
+        tstring filename;
+        TF_RETURN_IF_ERROR(reader->ReadScalar(
+            prefix(), absl::StrCat(kRunFilename, "_", i), &filename));
+        run.filename = filename;
+        TF_RETURN_IF_ERROR(reader->ReadScalar(
+            prefix(), absl::StrCat(kRunNumElements, "_", i),
+            &run.num_elements));
+        TF_RETURN_IF_ERROR(reader->ReadScalar(
+            prefix(), absl::StrCat(kRunNumRead, "_", i), &run.num_read));
+        if (run.num_read < run.num_elements) {
+          TF_RETURN_IF_ERROR(ctx->env()->FileExists(run.filename));
+        }
+      }
+      buffer_.clear();
+      TF_RETURN_IF_ERROR(ReadElementsFromCheckpoint(
+          ctx, reader, full_name(kBuffer), &buffer_));
+      // The restored run files are shared with the checkpoint, whose other
+      // restores may still need them.
+      checkpointed_ = true;
+      return absl::OkStatus();
+    }
+
+   private:
+    // A shuffled run of elements written to a file.
+    struct Run {
+      std::string filename;
+      int64_t num_elements = 0;
+      // The number of elements read from the file.
+      int64_t num_read = 0;
+      // Opened on the first read from the run.
+      std::unique_ptr<snapshot_util::Reader> reader;
+    };
+
+    // Reads the whole input into shuffled runs.
+    Status FillRuns(IteratorContext* ctx) TF_EXCLUSIVE_LOCKS_REQUIRED(mu_) {
+      bool end_of_input = false;
+      while (true) {
+        std::vector<Tensor> element;
+        TF_RETURN_IF_ERROR(input_impl_->GetNext(ctx, &element, &end_of_input));
+        if (end_of_input) {
+          break;
+        }
+        buffer_.push_back(std::move(element));
+        if (buffer_.size() >= dataset()->run_size_) {
+          TF_RETURN_IF_ERROR(WriteRun(ctx));
+        }
+      }
+      ShuffleBuffer();
+      input_impl_.reset();
+      return absl::OkStatus();
+    }
+
+    // Shuffles `buffer_` and moves it into a new run file.
+    Status WriteRun(IteratorContext* ctx) TF_EXCLUSIVE_LOCKS_REQUIRED(mu_) {
+      ShuffleBuffer();
+      TF_RETURN_IF_ERROR(
+          ctx->env()->RecursivelyCreateDir(dataset()->directory_));
+      Run run;
+      run.filename = io::JoinPath(
+          dataset()->directory_,
+          absl::StrCat("external_shuffle_", random::New64(), "_run_",
+                       runs_.size()));
+      run.num_elements = buffer_.size();
+      std::unique_ptr<snapshot_util::Writer> writer;
+      TF_RETURN_IF_ERROR(snapshot_util::Writer::Create(
+          ctx->env(), run.filename, dataset()->compression_, kRunFileVersion,
+          dataset()->output_dtypes(), &writer));
+      for (const std::vector<Tensor>& element : buffer_) {
+        TF_RETURN_IF_ERROR(writer->WriteTensors(element));
+      }
+      TF_RETURN_IF_ERROR(writer->Close());
+      VLOG(2) << "Wrote external shuffle run " << run.filename << " with "
+              << run.num_elements << " elements.";
+      runs_.push_back(std::move(run));
+      buffer_.clear();
+      return absl::OkStatus();
+    }
+
+    // Reads the next element of `run`, opening the run file if necessary.
+    Status ReadFromRun(IteratorContext* ctx, Run& run,
+                       std::vector<Tensor>* out_tensors)
+        TF_EXCLUSIVE_LOCKS_REQUIRED(mu_) {
+      if (!run.reader) {
+        TF_RETURN_IF_ERROR(snapshot_util::Reader::Create(
+            ctx->env(), run.filename, dataset()->compression_, kRunFileVersion,
+            dataset()->output_dtypes(), &run.reader));
+        TF_RETURN_IF_ERROR(run.reader->SkipRecords(run.num_read));
+      }
+      TF_RETURN_IF_ERROR(run.reader->ReadTensors(out_tensors));
+      if (++run.num_read == run.num_elements) {
+        run.reader.reset();
+        if (!checkpointed_) {
+          ctx->env()->DeleteFile(run.filename).IgnoreError();
+        }
+      }
+      return absl::OkStatus();
+    }
+
+    void ShuffleBuffer() TF_EXCLUSIVE_LOCKS_REQUIRED(mu_) {
+      for (int64_t i = buffer_.size() - 1; i > 0; --i) {
+        std::swap(buffer_[i], buffer_[Random() % (i + 1)]);
+      }
+    }
+
+    // Deletes the files of the runs that have not been read completely.
+    void DeleteRuns(Env* env) TF_EXCLUSIVE_LOCKS_REQUIRED(mu_) {
+      for (Run& run : runs_) {
+        run.reader.reset();
+        if (run.num_read < run.num_elements) {
+          env->DeleteFile(run.filename).IgnoreError();
+        }
+      }
+    }
+
+    void ResetRngs() TF_EXCLUSIVE_LOCKS_REQUIRED(mu_) {
+      parent_generator_ = random::PhiloxRandom(seeds_.first, seeds_.second);
+      generator_ =
+          random::SingleSampleAdapter<random::PhiloxRandom>(&parent_generator_);
+      generator_.Skip(num_random_samples_);
+    }
+
+    // Returns a random 64-bit number.
+    uint64 Random() TF_EXCLUSIVE_LOCKS_REQUIRED(mu_) {
+      num_random_samples_ += 2;
+      const uint64 high = generator_();
+      return (high << 32) | generator_();
+    }
+
+    mutex mu_;
+    std::pair<int64_t, int64_t> seeds_ TF_GUARDED_BY(mu_);
+    random::PhiloxRandom parent_generator_ TF_GUARDED_BY(mu_);
+    random::SingleSampleAdapter<random::PhiloxRandom> generator_
+        TF_GUARDED_BY(mu_);
+    int64_t num_random_samples_ TF_GUARDED_BY(mu_) = 0;
+    // Reset once the whole input has been read into runs.
+    std::unique_ptr<IteratorBase> input_impl_ TF_GUARDED_BY(mu_);
+    std::vector<Run> runs_ TF_GUARDED_BY(mu_);
+    // The run that is being filled, or the last run once the input has been
+    // read.
+    std::vector<std::vector<Tensor>> buffer_ TF_GUARDED_BY(mu_);
+    // Whether the run files may be needed to restore a checkpoint.
+    bool checkpointed_ TF_GUARDED_BY(mu_) = false;
+  };
+
+  const DatasetBase* const input_;
+  const int64_t run_size_;
+  const std::pair<int64_t, int64_t> seeds_;
+  const std::string directory_;
+  const std::string compression_;
+};
+
+ExternalShuffleDatasetOp::ExternalShuffleDatasetOp(OpKernelConstruction* ctx)
+    : UnaryDatasetOpKernel(ctx) {
+  OP_REQUIRES_OK(ctx, ctx->GetAttr(kCompression, &compression_));
+  OP_REQUIRES(
+      ctx,
+      compression_ == io::compression::kNone ||
+          compression_ == io::compression::kGzip ||
+          compression_ == io::compression::kSnappy ||
+          compression_ == io::compression::kZlib,
+      errors::InvalidArgument("Unsupported compression: ", compression_));
+}
+
+void ExternalShuffleDatasetOp::MakeDataset(OpKernelContext* ctx,
+                                           DatasetBase* input,
+                                           DatasetBase** output) {
+  int64_t run_size;
+  int64_t seed;
+  int64_t seed2;
+  tstring directory;
+  OP_REQUIRES_OK(ctx, ParseScalarArgument<int64_t>(ctx, kRunSize, &run_size));
+  OP_REQUIRES(ctx, run_size > 0,
+              errors::InvalidArgument("run_size must be greater than zero."));
+  OP_REQUIRES_OK(ctx, ParseScalarArgument<int64_t>(ctx, kSeed, &seed));
+  OP_REQUIRES_OK(ctx, ParseScalarArgument<int64_t>(ctx, kSeed2, &seed2));
+  OP_REQUIRES_OK(ctx,
+                 ParseScalarArgument<tstring>(ctx, kDirectory, &directory));
+  OP_REQUIRES(ctx, !directory.empty(),
+              errors::InvalidArgument("directory must not be empty."));
+  OP_REQUIRES(ctx, input->Cardinality() != kInfiniteCardinality,
+              errors::InvalidArgument(
+                  "An external shuffle requires a finite input dataset."));
+
+  *output = new Dataset(ctx, input, run_size, seed, seed2, directory,
+                        compression_);
+}
+
+namespace {
+REGISTER_KERNEL_BUILDER(Name("ExternalShuffleDataset").Device(DEVICE_CPU),
+                        ExternalShuffleDatasetOp);
+}  // namespace
+}  // namespace experimental
+}  // namespace data
+}  // namespace tensorflow
@@ -0,0 +1,216 @@
+/* Copyright 2024 The TensorFlow Authors. All Rights Reserved.
+
+Licensed under the Apache License, Version 2.0 (the "License");
+you may not use this file except in compliance with the License.
+You may obtain a copy of the License at
+
+    http://www.apache.org/licenses/LICENSE-2.0
+
+Unless required by applicable law or agreed to in writing, software
+distributed under the License is distributed on an "AS IS" BASIS,
+WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+See the License for the specific language governing permissions and
+limitations under the License.
+==============================================================================*/
+#include "tensorflow/core/kernels/data/experimental/external_shuffle_dataset_op.h"
+
+#include <string>
+#include <vector>
+
+#include "tensorflow/core/data/dataset_test_base.h"
+#include "tensorflow/core/platform/env.h"
+#include "tensorflow/core/platform/path.h"
+#include "tensorflow/core/platform/test.h"
+
+namespace tensorflow {
+namespace data {
+namespace experimental {
+namespace {
+
+constexpr char kNodeName[] = "external_shuffle_dataset";
+constexpr int64_t kRandomSeed = 42;
+constexpr int64_t kRandomSeed2 = 7;
+
+class ExternalShuffleDatasetParams : public DatasetParams {
+ public:
+  template <typename T>
+  ExternalShuffleDatasetParams(T input_dataset_params, int64_t run_size,
+                               std::string directory, std::string compression,
+                               DataTypeVector output_dtypes,
+                               std::vector<PartialTensorShape> output_shapes,
+                               string node_name)
+      : DatasetParams(std::move(output_dtypes), std::move(output_shapes),
+                      std::move(node_name)),
+        run_size_(run_size),
+        directory_(std::move(directory)),
+        compression_(std::move(compression)) {
+    input_dataset_params_.push_back(std::make_unique<T>(input_dataset_params));
+    iterator_prefix_ =
+        name_utils::IteratorPrefix(input_dataset_params.dataset_type(),
+                                   input_dataset_params.iterator_prefix());
+  }
+
+  std::vector<Tensor> GetInputTensors() const override {
+    return {CreateTensor<int64_t>(TensorShape({}), {run_size_}),
+            CreateTensor<int64_t>(TensorShape({}), {kRandomSeed}),
+            CreateTensor<int64_t>(TensorShape({}), {kRandomSeed2}),
+            CreateTensor<tstring>(TensorShape({}), {directory_})};
+  }
+
+  Status GetInputNames(std::vector<string>* input_names) const override {
+    *input_names = {ExternalShuffleDatasetOp::kInputDataset,
+                    ExternalShuffleDatasetOp::kRunSize,
+                    ExternalShuffleDatasetOp::kSeed,
+                    ExternalShuffleDatasetOp::kSeed2,
+                    ExternalShuffleDatasetOp::kDirectory};
+    return absl::OkStatus();
+  }
+
+  Status GetAttributes(AttributeVector* attr_vector) const override {
+    *attr_vector = {{ExternalShuffleDatasetOp::kCompression, compression_},
+                    {ExternalShuffleDatasetOp::kOutputTypes, output_dtypes_},
+                    {ExternalShuffleDatasetOp::kOutputShapes, output_shapes_},
+                    {"metadata", ""}};
+    return absl::OkStatus();
+  }
+
+  string dataset_type() const override {
+    return ExternalShuffleDatasetOp::kDatasetType;
+  }
+
+  const std::string& directory() const { return directory_; }
+
+ private:
+  int64_t run_size_;
+  std::string directory_;
+  std::string compression_;
+};
+
+class ExternalShuffleDatasetOpTest : public DatasetOpsTestBase {};
+
+std::string RunDirectory(const std::string& name) {
+  return io::JoinPath(testing::TmpDir(), "external_shuffle", name);
+}
+
+// Three runs of 3 elements are spilled to disk, and the last element stays in
+// memory.
+ExternalShuffleDatasetParams SpilledRunsParams() {
+  return ExternalShuffleDatasetParams(
+      RangeDatasetParams(0, 10, 1), /*run_size=*/3, RunDirectory("spilled"),
+      /*compression=*/"",
+      /*output_dtypes=*/{DT_INT64},
+      /*output_shapes=*/{PartialTensorShape({})}, kNodeName);
+}
+
+ExternalShuffleDatasetParams CompressedRunsParams() {
+  return ExternalShuffleDatasetParams(
+      RangeDatasetParams(0, 10, 1), /*run_size=*/4, RunDirectory("compressed"),
+      /*compression=*/"GZIP",
+      /*output_dtypes=*/{DT_INT64},
+      /*output_shapes=*/{PartialTensorShape({})}, kNodeName);
+}
+
+ExternalShuffleDatasetParams InMemoryParams() {
+  return ExternalShuffleDatasetParams(
+      RangeDatasetParams(0, 10, 1), /*run_size=*/100, RunDirectory("memory"),
+      /*compression=*/"",
+      /*output_dtypes=*/{DT_INT64},
+      /*output_shapes=*/{PartialTensorShape({})}, kNodeName);
+}
+
+ExternalShuffleDatasetParams InvalidRunSizeParams() {
+  return ExternalShuffleDatasetParams(
+      RangeDatasetParams(0, 10, 1), /*run_size=*/0, RunDirectory("invalid"),
+      /*compression=*/"",
+      /*output_dtypes=*/{DT_INT64},
+      /*output_shapes=*/{PartialTensorShape({})}, kNodeName);
+}
+
+std::vector<Tensor> RangeOutputs() {
+  return CreateTensors<int64_t>(
+      TensorShape({}), {{0}, {1}, {2}, {3}, {4}, {5}, {6}, {7}, {8}, {9}});
+}
+
+std::vector<GetNextTestCase<ExternalShuffleDatasetParams>> GetNextTestCases() {
+  return {{/*dataset_params=*/SpilledRunsParams(),
+           /*expected_outputs=*/RangeOutputs(), /*compare_order=*/false},
+          {/*dataset_params=*/CompressedRunsParams(),
+           /*expected_outputs=*/RangeOutputs(), /*compare_order=*/false},
+          {/*dataset_params=*/InMemoryParams(),
+           /*expected_outputs=*/RangeOutputs(), /*compare_order=*/false}};
+}
+
+ITERATOR_GET_NEXT_TEST_P(ExternalShuffleDatasetOpTest,
+                         ExternalShuffleDatasetParams, GetNextTestCases())
+
+TEST_F(ExternalShuffleDatasetOpTest, DatasetNodeName) {
+  auto dataset_params = SpilledRunsParams();
+  TF_ASSERT_OK(Initialize(dataset_params));
+  TF_ASSERT_OK(CheckDatasetNodeName(dataset_params.node_name()));
+}
+
+TEST_F(ExternalShuffleDatasetOpTest, DatasetTypeString) {
+  auto dataset_params = SpilledRunsParams();
+  TF_ASSERT_OK(Initialize(dataset_params));
+  TF_ASSERT_OK(CheckDatasetTypeString(
+      name_utils::OpName(ExternalShuffleDatasetOp::kDatasetType)));
+}
+
+TEST_F(ExternalShuffleDatasetOpTest, Cardinality) {
+  auto dataset_params = SpilledRunsParams();
+  TF_ASSERT_OK(Initialize(dataset_params));
+  TF_ASSERT_OK(CheckDatasetCardinality(10));
+}
+
+TEST_F(ExternalShuffleDatasetOpTest, ShufflesAcrossRunsAndDeletesThem) {
+  auto dataset_params = SpilledRunsParams();
+  TF_ASSERT_OK(Initialize(dataset_params));
+  std::vector<int64_t> outputs;
+  bool end_of_sequence = false;
+  while (!end_of_sequence) {
+    std::vector<Tensor> next;
+    TF_ASSERT_OK(
+        iterator_->GetNext(iterator_ctx_.get(), &next, &end_of_sequence));
+    if (!end_of_sequence) {
+      ASSERT_EQ(1, next.size());
+      outputs.push_back(next[0].scalar<int64_t>()());
+    }
+  }
+  ASSERT_EQ(10, outputs.size());
+  // Elements of the same run are not kept together.
+  bool interleaved = false;
+  for (int i = 0; i + 1 < outputs.size(); ++i) {
+    if (outputs[i] / 3 != outputs[i + 1] / 3) interleaved = true;
+  }
+  EXPECT_TRUE(interleaved);
+
+  std::vector<string> children;
+  TF_ASSERT_OK(
+      Env::Default()->GetChildren(dataset_params.directory(), &children));
+  EXPECT_TRUE(children.empty());
+}
+
+TEST_F(ExternalShuffleDatasetOpTest, InvalidRunSize) {
+  auto dataset_params = InvalidRunSizeParams();
+  EXPECT_EQ(Initialize(dataset_params).code(),
+            absl::StatusCode::kInvalidArgument);
+}
+
+std::vector<IteratorSaveAndRestoreTestCase<ExternalShuffleDatasetParams>>
+IteratorSaveAndRestoreTestCases() {
+  return {{/*dataset_params=*/SpilledRunsParams(),
+           /*breakpoints=*/{0, 4, 11}, /*expected_outputs=*/RangeOutputs(),
+           /*compare_order=*/false},
+          {/*dataset_params=*/InMemoryParams(),
+           /*breakpoints=*/{0, 4, 11}, /*expected_outputs=*/RangeOutputs(),
+           /*compare_order=*/false}};
+}
+
+ITERATOR_SAVE_AND_RESTORE_TEST_P(ExternalShuffleDatasetOpTest,
+                                 ExternalShuffleDatasetParams,
+                                 IteratorSaveAndRestoreTestCases())
+
+}  // namespace
+}  // namespace experimental
+}  // namespace data
+}  // namespace tensorflow
@@ -0,0 +1,420 @@
+/* Copyright 2024 The TensorFlow Authors. All Rights Reserved.
+
+Licensed under the Apache License, Version 2.0 (the "License");
+you may not use this file except in compliance with the License.
+You may obtain a copy of the License at
+
+    http://www.apache.org/licenses/LICENSE-2.0
+
+Unless required by applicable law or agreed to in writing, software
+distributed under the License is distributed on an "AS IS" BASIS,
+WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+See the License for the specific language governing permissions and
+limitations under the License.
+==============================================================================*/
+#include "tensorflow/core/kernels/data/experimental/fused_map_and_filter_dataset_op.h"
+
+#include <memory>
+#include <string>
+#include <utility>
+#include <vector>
+
+#include "absl/status/status.h"
+#include "tensorflow/core/common_runtime/input_colocation_exemption_registry.h"
+#include "tensorflow/core/data/captured_function.h"
+#include "tensorflow/core/data/dataset_utils.h"
+#include "tensorflow/core/data/name_utils.h"
+#include "tensorflow/core/framework/dataset.h"
+#include "tensorflow/core/framework/model.h"
+#include "tensorflow/core/framework/partial_tensor_shape.h"
+#include "tensorflow/core/framework/tensor.h"
+#include "tensorflow/core/platform/errors.h"
+#include "tensorflow/core/platform/mutex.h"
+
+namespace tensorflow {
+namespace data {
+namespace experimental {
+
+/* static */ constexpr const char* const
+    FusedMapAndFilterDatasetOp::kDatasetType;
+/* static */ constexpr const char* const
+    FusedMapAndFilterDatasetOp::kInputDataset;
+/* static */ constexpr const char* const
+    FusedMapAndFilterDatasetOp::kOtherArguments;
+/* static */ constexpr const char* const
+    FusedMapAndFilterDatasetOp::kFunctions;
+/* static */ constexpr const char* const
+    FusedMapAndFilterDatasetOp::kStageTypes;
+/* static */ constexpr const char* const
+    FusedMapAndFilterDatasetOp::kOtherArgumentsLengths;
+/* static */ constexpr const char* const
+    FusedMapAndFilterDatasetOp::kTarguments;
+/* static */ constexpr const char* const
+    FusedMapAndFilterDatasetOp::kOutputTypes;
+/* static */ constexpr const char* const
+    FusedMapAndFilterDatasetOp::kOutputShapes;
+/* static */ constexpr const char* const
+    FusedMapAndFilterDatasetOp::kPreserveCardinality;
+/* static */ constexpr const char* const
+    FusedMapAndFilterDatasetOp::kMapStage;
+/* static */ constexpr const char* const
+    FusedMapAndFilterDatasetOp::kFilterStage;
+/* static */ constexpr const char* const
+    FusedMapAndFilterDatasetOp::kMapAndFilterStage;
+
+namespace {
+
+constexpr char kInputImplEmpty[] = "input_impl_empty";
+
+}  // namespace
+
+class FusedMapAndFilterDatasetOp::Dataset : public DatasetBase {
+ public:
+  Dataset(OpKernelContext* ctx, const DatasetBase* input,
+          std::vector<std::unique_ptr<CapturedFunction>> captured_funcs,
+          std::vector<std::string> stage_types,
+          const DataTypeVector& output_types,
+          const std::vector<PartialTensorShape>& output_shapes,
+          bool preserve_cardinality)
+      : DatasetBase(DatasetContext(ctx)),
+        input_(input),
+        captured_funcs_(std::move(captured_funcs)),
+        stage_types_(std::move(stage_types)),
+        output_types_(output_types),
+        output_shapes_(output_shapes),
+        preserve_cardinality_(preserve_cardinality) {
+    for (const std::string& stage_type : stage_types_) {
+      has_filter_stage_ |= stage_type != kMapStage;
+    }
+    input_->Ref();
+  }
+
+  ~Dataset() override { input_->Unref(); }
+
+  std::unique_ptr<IteratorBase> MakeIteratorInternal(
+      const string& prefix) const override {
+    return std::make_unique<Iterator>(Iterator::Params{
+        this, name_utils::IteratorPrefix(kDatasetType, prefix)});
+  }
+
+  const DataTypeVector& output_dtypes() const override {
+    return output_types_;
+  }
+
+  const std::vector<PartialTensorShape>& output_shapes() const override {
+    return output_shapes_;
+  }
+
+  string DebugString() const override {
+    return name_utils::DatasetDebugString(kDatasetType);
+  }
+
+  int64_t CardinalityInternal(CardinalityOptions options) const override {
+    if (has_filter_stage_ || !preserve_cardinality_) {
+      return kUnknownCardinality;
+    }
+    return input_->Cardinality(options);
+  }
+
+  Status InputDatasets(std::vector<const DatasetBase*>* inputs) const override {
+    inputs->push_back(input_);
+    return absl::OkStatus();
+  }
+
+  Status CheckExternalState() const override {
+    for (const auto& captured_func : captured_funcs_) {
+      TF_RETURN_IF_ERROR(captured_func->CheckExternalState());
+    }
+    return input_->CheckExternalState();
+  }
+
+ protected:
+  Status AsGraphDefInternal(SerializationContext* ctx,
+                            DatasetGraphDefBuilder* b,
+                            Node** output) const override {
+    Node* input_graph_node;
+    TF_RETURN_IF_ERROR(b->AddInputDataset(ctx, input_, &input_graph_node));
+
+    std::vector<Node*> other_arguments;
+    DataTypeVector other_arguments_types;
+    std::vector<int32> other_arguments_lengths;
+    std::vector<NameAttrList> funcs;
+    other_arguments_lengths.reserve(captured_funcs_.size());
+    funcs.reserve(captured_funcs_.size());
+    for (const auto& captured_func : captured_funcs_) {
+      other_arguments_lengths.push_back(
+          captured_func->captured_inputs().size());
+      TF_RETURN_IF_ERROR(captured_func->AddToGraph(ctx, b, &other_arguments,
+                                                   &other_arguments_types));
+      funcs.push_back(captured_func->func());
+    }
+
+    AttrValue functions_attr;
+    b->BuildAttrValue(funcs, &functions_attr);
+    AttrValue stage_types_attr;
+    b->BuildAttrValue(stage_types_, &stage_types_attr);
+    AttrValue other_arguments_lengths_attr;
+    b->BuildAttrValue(other_arguments_lengths, &other_arguments_lengths_attr);
+    AttrValue other_arguments_types_attr;
+    b->BuildAttrValue(other_arguments_types, &other_arguments_types_attr);
+    AttrValue preserve_cardinality_attr;
+    b->BuildAttrValue(preserve_cardinality_, &preserve_cardinality_attr);
+
+    return b->AddDataset(
+        this, {std::make_pair(0, input_graph_node)},
+        {std::make_pair(1, other_arguments)},
+        {std::make_pair(kFunctions, functions_attr),
+         std::make_pair(kStageTypes, stage_types_attr),
+         std::make_pair(kOtherArgumentsLengths, other_arguments_lengths_attr),
+         std::make_pair(kTarguments, other_arguments_types_attr),
+         std::make_pair(kPreserveCardinality, preserve_cardinality_attr)},
+        output);
+  }
+
+ private:
+  class Iterator : public DatasetIterator<Dataset> {
+   public:
+    explicit Iterator(const Params& params)
+        : DatasetIterator<Dataset>(params) {}
+
+    bool SymbolicCheckpointCompatible() const override { return true; }
+
+    Status Initialize(IteratorContext* ctx) override {
+      TF_RETURN_IF_ERROR(
+          dataset()->input_->MakeIterator(ctx, this, prefix(), &input_impl_));
+      instantiated_captured_funcs_.resize(dataset()->captured_funcs_.size());
+      for (int i = 0; i < dataset()->captured_funcs_.size(); ++i) {
+        TF_RETURN_IF_ERROR(dataset()->captured_funcs_[i]->Instantiate(
+            ctx, &instantiated_captured_funcs_[i]));
+      }
+      return absl::OkStatus();
+    }
+
+    // Runs all the stages on an input element before pulling the next one, so
+    // that the chain costs a single `GetNext` call on the input per element.
+    Status GetNextInternal(IteratorContext* ctx,
+                           std::vector<Tensor>* out_tensors,
+                           bool* end_of_sequence) override {
+      std::vector<Tensor> result;
+      while (true) {
+        {
+          tf_shared_lock l(mu_);
+          if (!input_impl_) {
+            *end_of_sequence = true;
+            return absl::OkStatus();
+          }
+          TF_RETURN_IF_ERROR(
+              input_impl_->GetNext(ctx, out_tensors, end_of_sequence));
+        }
+        if (*end_of_sequence) {
+          mutex_lock l(mu_);
+          input_impl_.reset();
+          return absl::OkStatus();
+        }
+        bool matched = true;
+        for (int i = 0; i < instantiated_captured_funcs_.size() && matched;
+             ++i) {
+          TF_RETURN_IF_ERROR(RunStage(ctx, i, out_tensors, &result, &matched,
+                                      end_of_sequence));
+          if (*end_of_sequence) {
+            out_tensors->clear();
+            return absl::OkStatus();
+          }
+        }
+        if (matched) {
+          return absl::OkStatus();
+        }
+        out_tensors->clear();
+      }
+    }
+
+   protected:
+    std::shared_ptr<model::Node> CreateNode(
+        IteratorContext* ctx, model::Node::Args args) const override {
+      if (dataset()->has_filter_stage_) {
+        return model::MakeUnknownRatioNode(std::move(args));
+      }
+      return model::MakeKnownRatioNode(std::move(args), /*ratio=*/1);
+    }
+
+    Status SaveInternal(SerializationContext* ctx,
+                        IteratorStateWriter* writer) override {
+      for (const auto& captured_func : dataset()->captured_funcs_) {
+        TF_RETURN_IF_ERROR(ctx->HandleCheckExternalStateStatus(
+            captured_func->CheckExternalState()));
+      }
+      mutex_lock l(mu_);
+      TF_RETURN_IF_ERROR(writer->WriteScalar(
+          prefix(), kInputImplEmpty, static_cast<int64_t>(!input_impl_)));
+      if (input_impl_) {
+        TF_RETURN_IF_ERROR(SaveInput(ctx, writer, input_impl_));
+      }
+      return absl::OkStatus();
+    }
+
+    Status RestoreInternal(IteratorContext* ctx,
+                           IteratorStateReader* reader) override {
+      mutex_lock l(mu_);
+      int64_t input_empty;
+      TF_RETURN_IF_ERROR(
+          reader->ReadScalar(prefix(), kInputImplEmpty, &input_empty));
+      if (static_cast<bool>(input_empty)) {
+        input_impl_.reset();
+      } else {
+        TF_RETURN_IF_ERROR(RestoreInput(ctx, reader, input_impl_));
+      }
+      return absl::OkStatus();
+    }
+
+   private:
+    // Runs stage `i` on `*element`, using `*result` as scratch space. Sets
+    // `*matched` to false if the stage drops the element, and
+    // `*end_of_sequence` to true if a map function ends the iteration early.
+    Status RunStage(IteratorContext* ctx, int i, std::vector<Tensor>* element,
+                    std::vector<Tensor>* result, bool* matched,
+                    bool* end_of_sequence) {
+      const std::string& stage_type = dataset()->stage_types_[i];
+      InstantiatedCapturedFunction* func =
+          instantiated_captured_funcs_[i].get();
+      result->clear();
+      if (stage_type == kFilterStage) {
+        Status s =
+            func->RunWithBorrowedArgs(ctx, *element, result, model_node());
+        if (!s.ok()) {
+          return AddErrorContext(s);
+        }
+        return GetPredicate(*result, matched);
+      }
+
+      Status s = func->Run(ctx, std::move(*element), result, model_node());
+      element->clear();
+      if (errors::IsOutOfRange(s)) {
+        if (dataset()->preserve_cardinality_) {
+          // As in `MapDataset`, `OutOfRange` is converted to `InvalidArgument`
+          // because a caller may interpret it as the end of sequence.
+          return errors::InvalidArgument(
+              "Function invocation produced OutOfRangeError: ", s.message());
+        }
+        *end_of_sequence = true;
+        return absl::OkStatus();
+      }
+      if (!s.ok()) {
+        return AddErrorContext(s);
+      }
+      if (stage_type == kMapAndFilterStage) {
+        if (result->empty()) {
+          return errors::InvalidArgument(
+              "The function of a `map_and_filter` stage must return at least "
+              "one value.");
+        }
+        TF_RETURN_IF_ERROR(GetPredicate({result->back()}, matched));
+        result->pop_back();
+      }
+      std::swap(*element, *result);
+      return absl::OkStatus();
+    }
+
+    static Status GetPredicate(const std::vector<Tensor>& result,
+                               bool* matched) {
+      if (result.size() != 1 || result[0].dtype() != DT_BOOL ||
+          result[0].NumElements() != 1) {
+        return errors::InvalidArgument(
+            "Filter predicate `f` must return a scalar bool.");
+      }
+      *matched = result[0].scalar<bool>()();
+      return absl::OkStatus();
+    }
+
+    mutable mutex mu_;
+    std::unique_ptr<IteratorBase> input_impl_ TF_GUARDED_BY(mu_);
+    std::vector<std::unique_ptr<InstantiatedCapturedFunction>>
+        instantiated_captured_funcs_;
+  };
+
+  const DatasetBase* const input_;
+  const std::vector<std::unique_ptr<CapturedFunction>> captured_funcs_;
+  const std::vector<std::string> stage_types_;
+  const DataTypeVector output_types_;
+  const std::vector<PartialTensorShape> output_shapes_;
+  const bool preserve_cardinality_;
+  bool has_filter_stage_ = false;
+};
+
+FusedMapAndFilterDatasetOp::FusedMapAndFilterDatasetOp(
+    OpKernelConstruction* ctx)
+    : UnaryDatasetOpKernel(ctx) {
+  std::vector<NameAttrList> funcs;
+  OP_REQUIRES_OK(ctx, ctx->GetAttr(kFunctions, &funcs));
+  OP_REQUIRES_OK(ctx, ctx->GetAttr(kStageTypes, &stage_types_));
+  OP_REQUIRES_OK(ctx, ctx->GetAttr(kOtherArgumentsLengths,
+                                   &other_arguments_lengths_));
+  OP_REQUIRES_OK(ctx, ctx->GetAttr(kOutputTypes, &output_types_));
+  OP_REQUIRES_OK(ctx, ctx->GetAttr(kOutputShapes, &output_shapes_));
+  OP_REQUIRES_OK(ctx,
+                 ctx->GetAttr(kPreserveCardinality, &preserve_cardinality_));
+  OP_REQUIRES(ctx,
+              funcs.size() == stage_types_.size() &&
+                  funcs.size() == other_arguments_lengths_.size(),
+              errors::InvalidArgument(
+                  "functions, stage_types and other_arguments_lengths must "
+                  "have the same length."));
+  for (const std::string& stage_type : stage_types_) {
+    OP_REQUIRES(ctx,
+                stage_type == kMapStage || stage_type == kFilterStage ||
+                    stage_type == kMapAndFilterStage,
+                errors::InvalidArgument("Unknown stage type: ", stage_type));
+  }
+  func_metadatas_.resize(funcs.size());
+  for (int i = 0; i < funcs.size(); ++i) {
+    OP_REQUIRES_OK(
+        ctx, FunctionMetadata::Create(ctx, std::move(funcs[i]), /*params=*/{},
+                                      &func_metadatas_[i]));
+  }
+}
+
+void FusedMapAndFilterDatasetOp::MakeDataset(OpKernelContext* ctx,
+                                             DatasetBase* input,
+                                             DatasetBase** output) {
+  OpInputList inputs;
+  OP_REQUIRES_OK(ctx, ctx->input_list(kOtherArguments, &inputs));
+  int64_t num_other_arguments = 0;
+  for (int32 length : other_arguments_lengths_) {
+    OP_REQUIRES(ctx, length >= 0,
+                errors::InvalidArgument(
+                    "other_arguments_lengths must be non-negative."));
+    num_other_arguments += length;
+  }
+  OP_REQUIRES(ctx, num_other_arguments == inputs.size(),
+              errors::InvalidArgument(
+                  "other_arguments_lengths must sum up to the number of "
+                  "other_arguments, got ",
+                  num_other_arguments, " and ", inputs.size()));
+
+  std::vector<std::unique_ptr<CapturedFunction>> captured_funcs(
+      func_metadatas_.size());
+  int index = 0;
+  for (int i = 0; i < func_metadatas_.size(); ++i) {
+    std::vector<Tensor> captured_args;
+    captured_args.reserve(other_arguments_lengths_[i]);
+    const int end_index = index + other_arguments_lengths_[i];
+    for (; index < end_index; ++index) {
+      captured_args.push_back(inputs[index]);
+    }
+    OP_REQUIRES_OK(ctx, CapturedFunction::Create(ctx, func_metadatas_[i],
+                                                 std::move(captured_args),
+                                                 &captured_funcs[i]));
+  }
+  *output = new Dataset(ctx, input, std::move(captured_funcs), stage_types_,
+                        output_types_, output_shapes_, preserve_cardinality_);
+}
+
+namespace {
+
+REGISTER_KERNEL_BUILDER(Name("FusedMapAndFilterDataset").Device(DEVICE_CPU),
+                        FusedMapAndFilterDatasetOp);
+REGISTER_INPUT_COLOCATION_EXEMPTION("FusedMapAndFilterDataset");
+
+}  // namespace
+}  // namespace experimental
+}  // namespace data
+}  // namespace tensorflow
@@ -0,0 +1,294 @@
+/* Copyright 2024 The TensorFlow Authors. All Rights Reserved.
+
+Licensed under the Apache License, Version 2.0 (the "License");
+you may not use this file except in compliance with the License.
+You may obtain a copy of the License at
+
+    http://www.apache.org/licenses/LICENSE-2.0
+
+Unless required by applicable law or agreed to in writing, software
+distributed under the License is distributed on an "AS IS" BASIS,
+WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+See the License for the specific language governing permissions and
+limitations under the License.
+==============================================================================*/
+#include "tensorflow/core/kernels/data/experimental/fused_map_and_filter_dataset_op.h"
+
+#include <string>
+#include <utility>
+#include <vector>
+
+#include "tensorflow/core/data/dataset_test_base.h"
+#include "tensorflow/core/framework/function_testlib.h"
+
+namespace tensorflow {
+namespace data {
+namespace experimental {
+namespace {
+
+constexpr char kNodeName[] = "fused_map_and_filter_dataset";
+
+using FDH = FunctionDefHelper;
+
+class FusedMapAndFilterDatasetParams : public DatasetParams {
+ public:
+  template <typename T>
+  FusedMapAndFilterDatasetParams(
+      T input_dataset_params, std::vector<Tensor> other_arguments,
+      std::vector<FDH::AttrValueWrapper> funcs,
+      std::vector<std::string> stage_types,
+      std::vector<int32> other_arguments_lengths,
+      std::vector<FunctionDef> func_lib, DataTypeVector type_arguments,
+      bool preserve_cardinality, DataTypeVector output_dtypes,
+      std::vector<PartialTensorShape> output_shapes, string node_name)
+      : DatasetParams(std::move(output_dtypes), std::move(output_shapes),
+                      std::move(node_name)),
+        other_arguments_(std::move(other_arguments)),
+        stage_types_(std::move(stage_types)),
+        other_arguments_lengths_(std::move(other_arguments_lengths)),
+        func_lib_(std::move(func_lib)),
+        type_arguments_(std::move(type_arguments)),
+        preserve_cardinality_(preserve_cardinality) {
+    for (const auto& func : funcs) {
+      funcs_.push_back(func.proto.func());
+    }
+    input_dataset_params_.push_back(std::make_unique<T>(input_dataset_params));
+    iterator_prefix_ =
+        name_utils::IteratorPrefix(input_dataset_params.dataset_type(),
+                                   input_dataset_params.iterator_prefix());
+  }
+
+  std::vector<Tensor> GetInputTensors() const override {
+    return other_arguments_;
+  }
+
+  Status GetInputNames(std::vector<string>* input_names) const override {
+    input_names->emplace_back(FusedMapAndFilterDatasetOp::kInputDataset);
+    for (int i = 0; i < other_arguments_.size(); ++i) {
+      input_names->emplace_back(
+          absl::StrCat(FusedMapAndFilterDatasetOp::kOtherArguments, "_", i));
+    }
+    return absl::OkStatus();
+  }
+
+  Status GetAttributes(AttributeVector* attr_vector) const override {
+    *attr_vector = {{"functions", funcs_},
+                    {"stage_types", stage_types_},
+                    {"other_arguments_lengths", other_arguments_lengths_},
+                    {"Targuments", type_arguments_},
+                    {"output_shapes", output_shapes_},
+                    {"output_types", output_dtypes_},
+                    {"preserve_cardinality", preserve_cardinality_},
+                    {"metadata", ""}};
+    return absl::OkStatus();
+  }
+
+  std::vector<FunctionDef> func_lib() const override { return func_lib_; }
+
+  string dataset_type() const override {
+    return FusedMapAndFilterDatasetOp::kDatasetType;
+  }
+
+ private:
+  std::vector<Tensor> other_arguments_;
+  std::vector<NameAttrList> funcs_;
+  std::vector<std::string> stage_types_;
+  std::vector<int32> other_arguments_lengths_;
+  std::vector<FunctionDef> func_lib_;
+  DataTypeVector type_arguments_;
+  bool preserve_cardinality_;
+};
+
+class FusedMapAndFilterDatasetOpTest : public DatasetOpsTestBase {};
+
+FDH::AttrValueWrapper Func(const string& func_name) {
+  return FDH::FunctionRef(func_name, {{"T", DT_INT64}});
+}
+
+// Returns `2 * x` and whether `x <= 3`, as a `map_and_filter` stage does after
+// a map and a filter are fused into one function.
+FunctionDef XTimesTwoAndLessThanOrEqualToThree() {
+  const Tensor kTwo = test::AsScalar<int64_t>(2);
+  const Tensor kThree = test::AsScalar<int64_t>(3);
+  return FDH::Define(
+      // Name
+      "XTimesTwoAndLessThanOrEqualToThree",
+      // Args
+      {"x: T"},
+      // Return values
+      {"y: T", "z: bool"},
+      // Attr def
+      {"T: {int64}"},
+      // Nodes
+      {
+          {{"two"}, "Const", {}, {{"value", kTwo}, {"dtype", DT_INT64}}},
+          {{"y"}, "Mul", {"x", "two"}, {{"T", "$T"}}},
+          {{"three"}, "Const", {}, {{"value", kThree}, {"dtype", DT_INT64}}},
+          {{"z"}, "LessEqual", {"x", "three"}, {{"T", "$T"}}},
+      });
+}
+
+// map(x * 2).filter(x <= 6).map(x * 4)
+FusedMapAndFilterDatasetParams MapFilterMapDatasetParams() {
+  return FusedMapAndFilterDatasetParams(
+      RangeDatasetParams(0, 10, 1),
+      /*other_arguments=*/{},
+      /*funcs=*/
+      {Func("XTimesTwo"), Func("LessThanOrEqualToN"), Func("XTimesFour")},
+      /*stage_types=*/{"map", "filter", "map"},
+      /*other_arguments_lengths=*/{0, 0, 0},
+      /*func_lib=*/
+      {test::function::XTimesTwo(), test::function::LessThanOrEqualToN(6),
+       test::function::XTimesFour()},
+      /*type_arguments=*/{},
+      /*preserve_cardinality=*/true,
+      /*output_dtypes=*/{DT_INT64},
+      /*output_shapes=*/{PartialTensorShape({})},
+      /*node_name=*/kNodeName);
+}
+
+// map_and_filter(x * 2, x <= 3).map(x * 2)
+FusedMapAndFilterDatasetParams MapAndFilterStageDatasetParams() {
+  return FusedMapAndFilterDatasetParams(
+      RangeDatasetParams(0, 10, 1),
+      /*other_arguments=*/{},
+      /*funcs=*/
+      {Func("XTimesTwoAndLessThanOrEqualToThree"), Func("XTimesTwo")},
+      /*stage_types=*/{"map_and_filter", "map"},
+      /*other_arguments_lengths=*/{0, 0},
+      /*func_lib=*/
+      {XTimesTwoAndLessThanOrEqualToThree(), test::function::XTimesTwo()},
+      /*type_arguments=*/{},
+      /*preserve_cardinality=*/true,
+      /*output_dtypes=*/{DT_INT64},
+      /*output_shapes=*/{PartialTensorShape({})},
+      /*node_name=*/kNodeName);
+}
+
+// map(x * 2).map(x * 4)
+FusedMapAndFilterDatasetParams MapMapDatasetParams() {
+  return FusedMapAndFilterDatasetParams(
+      RangeDatasetParams(0, 4, 1),
+      /*other_arguments=*/{},
+      /*funcs=*/{Func("XTimesTwo"), Func("XTimesFour")},
+      /*stage_types=*/{"map", "map"},
+      /*other_arguments_lengths=*/{0, 0},
+      /*func_lib=*/{test::function::XTimesTwo(), test::function::XTimesFour()},
+      /*type_arguments=*/{},
+      /*preserve_cardinality=*/true,
+      /*output_dtypes=*/{DT_INT64},
+      /*output_shapes=*/{PartialTensorShape({})},
+      /*node_name=*/kNodeName);
+}
+
+FusedMapAndFilterDatasetParams InvalidStageTypeDatasetParams() {
+  return FusedMapAndFilterDatasetParams(
+      RangeDatasetParams(0, 4, 1),
+      /*other_arguments=*/{},
+      /*funcs=*/{Func("XTimesTwo")},
+      /*stage_types=*/{"flat_map"},
+      /*other_arguments_lengths=*/{0},
+      /*func_lib=*/{test::function::XTimesTwo()},
+      /*type_arguments=*/{},
+      /*preserve_cardinality=*/true,
+      /*output_dtypes=*/{DT_INT64},
+      /*output_shapes=*/{PartialTensorShape({})},
+      /*node_name=*/kNodeName);
+}
+
+FusedMapAndFilterDatasetParams InvalidLengthsDatasetParams() {
+  return FusedMapAndFilterDatasetParams(
+      RangeDatasetParams(0, 4, 1),
+      /*other_arguments=*/{},
+      /*funcs=*/{Func("XTimesTwo"), Func("XTimesFour")},
+      /*stage_types=*/{"map", "map"},
+      /*other_arguments_lengths=*/{0},
+      /*func_lib=*/{test::function::XTimesTwo(), test::function::XTimesFour()},
+      /*type_arguments=*/{},
+      /*preserve_cardinality=*/true,
+      /*output_dtypes=*/{DT_INT64},
+      /*output_shapes=*/{PartialTensorShape({})},
+      /*node_name=*/kNodeName);
+}
+
+std::vector<GetNextTestCase<FusedMapAndFilterDatasetParams>>
+GetNextTestCases() {
+  return {{/*dataset_params=*/MapFilterMapDatasetParams(),
+           /*expected_outputs=*/
+           CreateTensors<int64_t>(TensorShape({}), {{0}, {8}, {16}, {24}})},
+          {/*dataset_params=*/MapAndFilterStageDatasetParams(),
+           /*expected_outputs=*/
+           CreateTensors<int64_t>(TensorShape({}), {{0}, {4}, {8}, {12}})},
+          {/*dataset_params=*/MapMapDatasetParams(),
+           /*expected_outputs=*/
+           CreateTensors<int64_t>(TensorShape({}), {{0}, {8}, {16}, {24}})}};
+}
+
+ITERATOR_GET_NEXT_TEST_P(FusedMapAndFilterDatasetOpTest,
+                         FusedMapAndFilterDatasetParams, GetNextTestCases())
+
+TEST_F(FusedMapAndFilterDatasetOpTest, DatasetNodeName) {
+  auto dataset_params = MapFilterMapDatasetParams();
+  TF_ASSERT_OK(Initialize(dataset_params));
+  TF_ASSERT_OK(CheckDatasetNodeName(dataset_params.node_name()));
+}
+
+TEST_F(FusedMapAndFilterDatasetOpTest, DatasetTypeString) {
+  auto dataset_params = MapFilterMapDatasetParams();
+  TF_ASSERT_OK(Initialize(dataset_params));
+  TF_ASSERT_OK(CheckDatasetTypeString(
+      name_utils::OpName(FusedMapAndFilterDatasetOp::kDatasetType)));
+}
+
+TEST_F(FusedMapAndFilterDatasetOpTest, DatasetOutputDtypes) {
+  auto dataset_params = MapFilterMapDatasetParams();
+  TF_ASSERT_OK(Initialize(dataset_params));
+  TF_ASSERT_OK(CheckDatasetOutputDtypes({DT_INT64}));
+}
+
+std::vector<CardinalityTestCase<FusedMapAndFilterDatasetParams>>
+CardinalityTestCases() {
+  return {{/*dataset_params=*/MapFilterMapDatasetParams(),
+           /*expected_cardinality=*/kUnknownCardinality},
+          {/*dataset_params=*/MapAndFilterStageDatasetParams(),
+           /*expected_cardinality=*/kUnknownCardinality},
+          {/*dataset_params=*/MapMapDatasetParams(),
+           /*expected_cardinality=*/4}};
+}
+
+DATASET_CARDINALITY_TEST_P(FusedMapAndFilterDatasetOpTest,
+                           FusedMapAndFilterDatasetParams,
+                           CardinalityTestCases())
+
+std::vector<IteratorSaveAndRestoreTestCase<FusedMapAndFilterDatasetParams>>
+IteratorSaveAndRestoreTestCases() {
+  return {{/*dataset_params=*/MapFilterMapDatasetParams(),
+           /*breakpoints=*/{0, 2, 5},
+           /*expected_outputs=*/
+           CreateTensors<int64_t>(TensorShape({}), {{0}, {8}, {16}, {24}})},
+          {/*dataset_params=*/MapAndFilterStageDatasetParams(),
+           /*breakpoints=*/{0, 2, 5},
+           /*expected_outputs=*/
+           CreateTensors<int64_t>(TensorShape({}), {{0}, {4}, {8}, {12}})}};
+}
+
+ITERATOR_SAVE_AND_RESTORE_TEST_P(FusedMapAndFilterDatasetOpTest,
+                                 FusedMapAndFilterDatasetParams,
+                                 IteratorSaveAndRestoreTestCases())
+
+TEST_F(FusedMapAndFilterDatasetOpTest, InvalidStageType) {
+  auto dataset_params = InvalidStageTypeDatasetParams();
+  EXPECT_EQ(Initialize(dataset_params).code(),
+            absl::StatusCode::kInvalidArgument);
+}
+
+TEST_F(FusedMapAndFilterDatasetOpTest, InvalidOtherArgumentsLengths) {
+  auto dataset_params = InvalidLengthsDatasetParams();
+  EXPECT_EQ(Initialize(dataset_params).code(),
+            absl::StatusCode::kInvalidArgument);
+}
+
+}  // namespace
+}  // namespace experimental
+}  // namespace data
+}  // namespace tensorflow
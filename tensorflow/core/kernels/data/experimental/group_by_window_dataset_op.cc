@@ -13,12 +13,16 @@ See the License for the specific language governing permissions and
 limitations under the License.
 ==============================================================================*/
 #include <map>
+#include <set>
+#include <utility>
 
 #include "tensorflow/core/common_runtime/function.h"
 #include "tensorflow/core/common_runtime/input_colocation_exemption_registry.h"
 #include "tensorflow/core/data/captured_function.h"
 #include "tensorflow/core/data/dataset_utils.h"
 #include "tensorflow/core/framework/dataset.h"
+#include "tensorflow/core/framework/metrics.h"
+#include "tensorflow/core/framework/model.h"
 #include "tensorflow/core/framework/partial_tensor_shape.h"
 #include "tensorflow/core/framework/tensor.h"
 #include "tensorflow/core/kernels/data/window_dataset.h"
@@ -29,6 +33,12 @@ namespace data {
 namespace experimental {
 namespace {
 
+constexpr char kLargest[] = "largest";
+constexpr char kOldest[] = "oldest";
+// The share of the RAM budget of the input pipeline that the buffered groups
+// may use when `max_buffered_bytes` is `AUTOTUNE`.
+constexpr double kAutotuneRamBudgetShare = 0.25;
+
 class GroupByWindowDatasetOp : public UnaryDatasetOpKernel {
  public:
   explicit GroupByWindowDatasetOp(OpKernelConstruction* ctx)
@@ -43,6 +53,20 @@ class GroupByWindowDatasetOp : public UnaryDatasetOpKernel {
                                       &window_size_func_metadata_));
     OP_REQUIRES_OK(ctx, ctx->GetAttr("output_types", &output_types_));
     OP_REQUIRES_OK(ctx, ctx->GetAttr("output_shapes", &output_shapes_));
+    // `ExperimentalGroupByWindowDataset` does not have a memory budget.
+    has_memory_budget_attrs_ = ctx->HasAttr("max_buffered_bytes");
+    if (has_memory_budget_attrs_) {
+      OP_REQUIRES_OK(
+          ctx, ctx->GetAttr("max_buffered_bytes", &max_buffered_bytes_));
+      OP_REQUIRES(ctx,
+                  max_buffered_bytes_ >= 0 ||
+                      max_buffered_bytes_ == model::kAutotune,
+                  errors::InvalidArgument(
+                      "max_buffered_bytes must be non-negative or AUTOTUNE, "
+                      "got ",
+                      max_buffered_bytes_));
+      OP_REQUIRES_OK(ctx, ctx->GetAttr("eviction_policy", &eviction_policy_));
+    }
   }
 
   void MakeDataset(OpKernelContext* ctx, DatasetBase* input,
@@ -63,10 +87,11 @@ class GroupByWindowDatasetOp : public UnaryDatasetOpKernel {
                                             "window_size_func_other_arguments",
                                             &captured_window_size_func));
 
-    *output = new Dataset(ctx, input, std::move(captured_key_func),
-                          std::move(captured_reduce_func),
-                          std::move(captured_window_size_func), output_types_,
-                          output_shapes_);
+    *output = new Dataset(
+        ctx, input, std::move(captured_key_func),
+        std::move(captured_reduce_func), std::move(captured_window_size_func),
+        output_types_, output_shapes_, has_memory_budget_attrs_,
+        max_buffered_bytes_, eviction_policy_);
   }
 
  private:
@@ -77,14 +102,19 @@ class GroupByWindowDatasetOp : public UnaryDatasetOpKernel {
             std::unique_ptr<CapturedFunction> captured_reduce_func,
             std::unique_ptr<CapturedFunction> captured_window_size_func,
             const DataTypeVector& output_types,
-            const std::vector<PartialTensorShape>& output_shapes)
+            const std::vector<PartialTensorShape>& output_shapes,
+            bool has_memory_budget_attrs, int64_t max_buffered_bytes,
+            const string& eviction_policy)
         : DatasetBase(DatasetContext(ctx)),
           input_(input),
           captured_key_func_(std::move(captured_key_func)),
           captured_reduce_func_(std::move(captured_reduce_func)),
           captured_window_size_func_(std::move(captured_window_size_func)),
           output_types_(output_types),
-          output_shapes_(output_shapes) {
+          output_shapes_(output_shapes),
+          has_memory_budget_attrs_(has_memory_budget_attrs),
+          max_buffered_bytes_(max_buffered_bytes),
+          eviction_policy_(eviction_policy) {
       input_->Ref();
     }
 
@@ -170,20 +200,30 @@ class GroupByWindowDatasetOp : public UnaryDatasetOpKernel {
       b->BuildAttrValue(window_size_func_other_arguments_types,
                         &window_size_func_other_arguments_types_attr);
 
+      std::vector<std::pair<StringPiece, AttrValue>> attrs = {
+          {"key_func", key_func},
+          {"reduce_func", reduce_func},
+          {"window_size_func", window_size_func},
+          {"Tkey_func_other_arguments", key_func_other_arguments_types_attr},
+          {"Treduce_func_other_arguments",
+           reduce_func_other_arguments_types_attr},
+          {"Twindow_size_func_other_arguments",
+           window_size_func_other_arguments_types_attr}};
+      if (has_memory_budget_attrs_) {
+        AttrValue max_buffered_bytes;
+        b->BuildAttrValue(max_buffered_bytes_, &max_buffered_bytes);
+        attrs.emplace_back("max_buffered_bytes", max_buffered_bytes);
+        AttrValue eviction_policy;
+        b->BuildAttrValue(eviction_policy_, &eviction_policy);
+        attrs.emplace_back("eviction_policy", eviction_policy);
+      }
+
       TF_RETURN_IF_ERROR(b->AddDataset(
           this, {{0, input_graph_node}},
           {{1, key_func_other_arguments_node},
            {2, reduce_func_other_arguments_node},
            {3, window_size_func_other_arguments_node}},
-          {{"key_func", key_func},
-           {"reduce_func", reduce_func},
-           {"window_size_func", window_size_func},
-           {"Tkey_func_other_arguments", key_func_other_arguments_types_attr},
-           {"Treduce_func_other_arguments",
-            reduce_func_other_arguments_types_attr},
-           {"Twindow_size_func_other_arguments",
-            window_size_func_other_arguments_types_attr}},
-          output));
+          attrs, output));
       return absl::OkStatus();
     }
 
@@ -202,6 +242,17 @@ class GroupByWindowDatasetOp : public UnaryDatasetOpKernel {
             ctx, &instantiated_reduce_func_));
         TF_RETURN_IF_ERROR(dataset()->captured_window_size_func_->Instantiate(
             ctx, &instantiated_window_size_func_));
+        mutex_lock l(mu_);
+        max_buffered_bytes_ = dataset()->max_buffered_bytes_;
+        if (max_buffered_bytes_ == model::kAutotune) {
+          // Without a RAM budget, the groups are not bounded.
+          max_buffered_bytes_ =
+              ctx->ram_budget_manager()
+                  ? static_cast<int64_t>(
+                        ctx->ram_budget_manager()->AvailableModelRam() *
+                        kAutotuneRamBudgetShare)
+                  : 0;
+        }
         return absl::OkStatus();
       }
 
@@ -224,7 +275,7 @@ class GroupByWindowDatasetOp : public UnaryDatasetOpKernel {
             // We have reached the end of the current group, so maybe move on
             // to the next group.
             current_group_iterator_.reset();
-            groups_.erase(current_key_);
+            EraseGroup(current_key_);
           }
 
           // Iterate through the input dataset until we get a full
@@ -278,14 +329,31 @@ class GroupByWindowDatasetOp : public UnaryDatasetOpKernel {
 
               const int64_t window_size = window_sizes_[key];
 
+              const int64_t element_bytes = GetTotalBytes(next_input_element);
               std::vector<std::vector<Tensor>>& group = groups_[key];
               group.push_back(std::move(next_input_element));
+              AddToGroupStats(key, element_bytes);
 
               if (group.size() == window_size) {
                 current_key_ = key;
                 TF_RETURN_IF_ERROR(StartFlushingGroup(ctx, key));
                 break;
               }
+              if (max_buffered_bytes_ > 0 &&
+                  buffered_bytes_ > max_buffered_bytes_) {
+                // Flush an incomplete group early to bound the memory of the
+                // buffered groups.
+                current_key_ = eviction_order_.begin()->second;
+                const int64_t num_elements = groups_[current_key_].size();
+                VLOG(2) << "Flushing group " << current_key_ << " with "
+                        << num_elements << " elements early because "
+                        << buffered_bytes_ << " bytes are buffered, more than "
+                        << "the budget of " << max_buffered_bytes_;
+                metrics::RecordTFDataGroupByWindowEviction(
+                    dataset()->eviction_policy_, num_elements);
+                TF_RETURN_IF_ERROR(StartFlushingGroup(ctx, current_key_));
+                break;
+              }
             }
           }
 
@@ -335,6 +403,10 @@ class GroupByWindowDatasetOp : public UnaryDatasetOpKernel {
             int64_t key = it->first;
             TF_RETURN_IF_ERROR(writer->WriteScalar(
                 full_name(strings::StrCat("groups_[", idx, "]->key")), key));
+            TF_RETURN_IF_ERROR(writer->WriteScalar(
+                full_name(
+                    strings::StrCat("groups_[", idx, "]->sequence_number")),
+                group_stats_[key].sequence_number));
             TF_RETURN_IF_ERROR(SaveGroup(
                 writer, full_name(strings::StrCat("groups_[", idx, "]")),
                 it->second));
@@ -371,6 +443,9 @@ class GroupByWindowDatasetOp : public UnaryDatasetOpKernel {
         }
         TF_RETURN_IF_ERROR(writer->WriteScalar(full_name("group_counter"),
                                                group_counter_ - 1));
+        TF_RETURN_IF_ERROR(
+            writer->WriteScalar(full_name("next_group_sequence_number"),
+                                next_group_sequence_number_));
         return absl::OkStatus();
       }
 
@@ -394,9 +469,30 @@ class GroupByWindowDatasetOp : public UnaryDatasetOpKernel {
             TF_RETURN_IF_ERROR(RestoreGroup(
                 ctx, reader, full_name(strings::StrCat("groups_[", idx, "]")),
                 &group));
-            groups_[key] = group;
+            // Checkpoints without sequence numbers order groups by key.
+            int64_t sequence_number = idx;
+            const string sequence_number_name = full_name(
+                strings::StrCat("groups_[", idx, "]->sequence_number"));
+            if (reader->Contains(sequence_number_name)) {
+              TF_RETURN_IF_ERROR(
+                  reader->ReadScalar(sequence_number_name, &sequence_number));
+            }
+            GroupStats& stats = group_stats_[key];
+            stats.sequence_number = sequence_number;
+            for (const std::vector<Tensor>& element : group) {
+              stats.bytes += GetTotalBytes(element);
+            }
+            buffered_bytes_ += stats.bytes;
+            eviction_order_.insert({EvictionPriority(stats), key});
+            groups_[key] = std::move(group);
           }
         }
+        next_group_sequence_number_ = groups_.size();
+        if (reader->Contains(full_name("next_group_sequence_number"))) {
+          TF_RETURN_IF_ERROR(
+              reader->ReadScalar(full_name("next_group_sequence_number"),
+                                 &next_group_sequence_number_));
+        }
 
         // Restoring window_sizes_
         if (reader->Contains(full_name("window_sizes_size"))) {
@@ -435,6 +531,44 @@ class GroupByWindowDatasetOp : public UnaryDatasetOpKernel {
       }
 
      private:
+      // The size and age of a buffered group.
+      struct GroupStats {
+        int64_t bytes = 0;
+        // The order of the group's first element among those of all groups.
+        int64_t sequence_number = 0;
+      };
+
+      // Groups with lower priorities are flushed first when the buffered
+      // groups exceed their budget.
+      int64_t EvictionPriority(const GroupStats& stats) const {
+        return dataset()->eviction_policy_ == kOldest ? stats.sequence_number
+                                                      : -stats.bytes;
+      }
+
+      // Accounts for an element of `bytes` bytes added to group `key`.
+      void AddToGroupStats(int64_t key, int64_t bytes)
+          TF_EXCLUSIVE_LOCKS_REQUIRED(mu_) {
+        auto [it, inserted] = group_stats_.try_emplace(key);
+        GroupStats& stats = it->second;
+        if (inserted) {
+          stats.sequence_number = next_group_sequence_number_++;
+        } else {
+          eviction_order_.erase({EvictionPriority(stats), key});
+        }
+        stats.bytes += bytes;
+        buffered_bytes_ += bytes;
+        eviction_order_.insert({EvictionPriority(stats), key});
+      }
+
+      void EraseGroup(int64_t key) TF_EXCLUSIVE_LOCKS_REQUIRED(mu_) {
+        groups_.erase(key);
+        auto it = group_stats_.find(key);
+        if (it == group_stats_.end()) return;
+        buffered_bytes_ -= it->second.bytes;
+        eviction_order_.erase({EvictionPriority(it->second), key});
+        group_stats_.erase(it);
+      }
+
       Status SaveGroup(IteratorStateWriter* writer, const string& name,
                        const std::vector<std::vector<Tensor>>& group)
           TF_EXCLUSIVE_LOCKS_REQUIRED(mu_) {
@@ -537,6 +671,14 @@ class GroupByWindowDatasetOp : public UnaryDatasetOpKernel {
           TF_GUARDED_BY(mu_);
       std::unique_ptr<IteratorBase> current_group_iterator_ TF_GUARDED_BY(mu_);
       std::map<int64_t, int64_t> window_sizes_ TF_GUARDED_BY(mu_);
+      // The budget of the buffered groups in bytes, or 0 if unbounded.
+      int64_t max_buffered_bytes_ TF_GUARDED_BY(mu_) = 0;
+      // The total size of the buffered groups in bytes.
+      int64_t buffered_bytes_ TF_GUARDED_BY(mu_) = 0;
+      int64_t next_group_sequence_number_ TF_GUARDED_BY(mu_) = 0;
+      std::map<int64_t, GroupStats> group_stats_ TF_GUARDED_BY(mu_);
+      // Pairs of the eviction priority and the key of all buffered groups.
+      std::set<std::pair<int64_t, int64_t>> eviction_order_ TF_GUARDED_BY(mu_);
       std::unique_ptr<InstantiatedCapturedFunction> instantiated_key_func_;
       std::unique_ptr<InstantiatedCapturedFunction> instantiated_reduce_func_;
       std::unique_ptr<InstantiatedCapturedFunction>
@@ -549,6 +691,9 @@ class GroupByWindowDatasetOp : public UnaryDatasetOpKernel {
     const std::unique_ptr<CapturedFunction> captured_window_size_func_;
     const DataTypeVector output_types_;
     const std::vector<PartialTensorShape> output_shapes_;
+    const bool has_memory_budget_attrs_;
+    const int64_t max_buffered_bytes_;
+    const string eviction_policy_;
   };
 
   std::shared_ptr<FunctionMetadata> key_func_metadata_ = nullptr;
@@ -556,6 +701,9 @@ class GroupByWindowDatasetOp : public UnaryDatasetOpKernel {
   std::shared_ptr<FunctionMetadata> window_size_func_metadata_ = nullptr;
   DataTypeVector output_types_;
   std::vector<PartialTensorShape> output_shapes_;
+  bool has_memory_budget_attrs_ = false;
+  int64_t max_buffered_bytes_ = 0;
+  string eviction_policy_ = kLargest;
 };
 
 REGISTER_KERNEL_BUILDER(Name("GroupByWindowDataset").Device(DEVICE_CPU),
@@ -79,6 +79,31 @@ constexpr char kStatus[] = "status";
 // Computes ceil(x / y).
 inline int64_t CeilDiv(int64_t x, int64_t y) { return (x + y - 1) / y; }
 
+// Returns true iff every component of the batches described by `output_types`
+// and `output_shapes` has a static element shape and a type that kernels can
+// write into a slice of the batch, in which case the shapes of the elements
+// are stored in `*element_shapes`.
+bool GetStaticElementShapes(
+    const DataTypeVector& output_types,
+    const std::vector<PartialTensorShape>& output_shapes,
+    std::vector<TensorShape>* element_shapes) {
+  element_shapes->clear();
+  for (size_t i = 0; i < output_shapes.size(); ++i) {
+    const PartialTensorShape& shape = output_shapes[i];
+    if (!DataTypeCanUseMemcpy(output_types[i]) || shape.unknown_rank() ||
+        shape.dims() < 1) {
+      return false;
+    }
+    TensorShape element_shape;
+    for (int d = 1; d < shape.dims(); ++d) {
+      if (shape.dim_size(d) < 0) return false;
+      element_shape.AddDim(shape.dim_size(d));
+    }
+    element_shapes->push_back(std::move(element_shape));
+  }
+  return true;
+}
+
 }  // namespace
 
 class MapAndBatchDatasetOp::Dataset : public DatasetBase {
@@ -105,6 +130,10 @@ class MapAndBatchDatasetOp::Dataset : public DatasetBase {
               strings::Printf("%lld", static_cast<long long>(batch_size))},
              {"drop_remainder", drop_remainder ? "true" : "false"}}) {
     input_->Ref();
+    in_place_batching_ =
+        GetExperiments().contains("map_and_batch_in_place") &&
+        GetStaticElementShapes(output_types_, output_shapes_,
+                               &element_shapes_);
   }
 
   ~Dataset() override { input_->Unref(); }
@@ -447,9 +476,24 @@ class MapAndBatchDatasetOp::Dataset : public DatasetBase {
         return;
       }
 
+      // With static element shapes, the batch is allocated before the function
+      // runs, so that the function can write its return values straight into
+      // the slices of the batch instead of having them copied there.
+      std::shared_ptr<const std::vector<Tensor>> ret_buffers;
+      if (dataset()->in_place_batching_) {
+        Status allocate_status = EnsureStaticOutputAllocated(ctx, result);
+        if (!allocate_status.ok()) {
+          result->UpdateStatus(allocate_status, offset);
+          CallCompleted(ctx, result);
+          return;
+        }
+        ret_buffers = OutputSlices(result, offset);
+      }
+
       std::shared_ptr<std::vector<Tensor>> return_values =
           std::make_shared<std::vector<Tensor>>();
-      auto done = [this, ctx, result, return_values, offset](Status status) {
+      auto done = [this, ctx, result, return_values, ret_buffers,
+                   offset](Status status) {
         if (dataset()->preserve_cardinality_ && errors::IsOutOfRange(status)) {
           // To guarantee that the transformation preserves the cardinality of
           // the dataset, we convert `OutOfRange` to `InvalidArgument` as the
@@ -481,6 +525,12 @@ class MapAndBatchDatasetOp::Dataset : public DatasetBase {
                     offset);
                 break;
               }
+              if (ret_buffers != nullptr &&
+                  (*ret_buffers)[i].IsInitialized() &&
+                  tensor.data() == (*ret_buffers)[i].data()) {
+                // The function wrote the value into the batch.
+                continue;
+              }
               // TODO(mrry): Add a version of DoParallelConcat that allows us
               // to move `tensor` where possible, to speed up string tensor
               // batching.
@@ -502,9 +552,9 @@ class MapAndBatchDatasetOp::Dataset : public DatasetBase {
 
       // Apply the map function on `input_element`, storing the result in
       // `return_values`, and invoking `done` when finished.
-      instantiated_captured_func_->RunAsync(ctx.get(), std::move(input_element),
-                                            return_values.get(),
-                                            std::move(done), model_node());
+      instantiated_captured_func_->RunAsync(
+          ctx.get(), std::move(input_element), return_values.get(),
+          std::move(ret_buffers), std::move(done), model_node());
     }
 
     void CancelThreads(bool wait) TF_LOCKS_EXCLUDED(mu_) {
@@ -536,15 +586,41 @@ class MapAndBatchDatasetOp::Dataset : public DatasetBase {
       if (result->output_allocated) {
         return absl::OkStatus();
       }
-      const size_t num_components = return_values->size();
+      DataTypeVector dtypes;
+      std::vector<TensorShape> element_shapes;
+      for (const Tensor& value : *return_values) {
+        dtypes.push_back(value.dtype());
+        element_shapes.push_back(value.shape());
+      }
+      return AllocateOutputLocked(ctx, result, dtypes, element_shapes);
+    }
+
+    // Allocates the batch of `result` from the static element shapes of the
+    // dataset.
+    Status EnsureStaticOutputAllocated(
+        const std::shared_ptr<IteratorContext>& ctx,
+        const std::shared_ptr<BatchResult>& result) {
+      mutex_lock l(result->mu);
+      if (result->output_allocated) {
+        return absl::OkStatus();
+      }
+      return AllocateOutputLocked(ctx, result, dataset()->output_types_,
+                                  dataset()->element_shapes_);
+    }
+
+    Status AllocateOutputLocked(const std::shared_ptr<IteratorContext>& ctx,
+                                const std::shared_ptr<BatchResult>& result,
+                                const DataTypeVector& dtypes,
+                                const std::vector<TensorShape>& element_shapes)
+        TF_EXCLUSIVE_LOCKS_REQUIRED(result->mu) {
+      const size_t num_components = dtypes.size();
       result->output.reserve(num_components);
       for (size_t i = 0; i < num_components; ++i) {
         TensorShape component_shape({dataset()->batch_size_});
-        component_shape.AppendShape(return_values->at(i).shape());
+        component_shape.AppendShape(element_shapes[i]);
         AllocatorAttributes attr;
         attr.set_gpu_compatible(true);
-        result->output.emplace_back(ctx->allocator(attr),
-                                    return_values->at(i).dtype(),
+        result->output.emplace_back(ctx->allocator(attr), dtypes[i],
                                     component_shape);
         if (!result->output.back().IsInitialized()) {
           return errors::ResourceExhausted(
@@ -556,6 +632,21 @@ class MapAndBatchDatasetOp::Dataset : public DatasetBase {
       return absl::OkStatus();
     }
 
+    // Returns views of the slices at `offset` of the batch of `result`, for
+    // the function to write its return values into. Slices that are not
+    // aligned well enough for kernels to write into are left uninitialized.
+    std::shared_ptr<const std::vector<Tensor>> OutputSlices(
+        const std::shared_ptr<BatchResult>& result, int64_t offset) {
+      mutex_lock l(result->mu);
+      auto slices = std::make_shared<std::vector<Tensor>>();
+      slices->reserve(result->output.size());
+      for (const Tensor& batch : result->output) {
+        Tensor slice = batch.SubSlice(offset);
+        slices->push_back(slice.IsAligned() ? std::move(slice) : Tensor());
+      }
+      return slices;
+    }
+
     void RunnerThread(const std::shared_ptr<IteratorContext>& ctx)
         TF_LOCKS_EXCLUDED(*mu_) {
       std::vector<std::pair<std::shared_ptr<BatchResult>, int64_t>> new_calls;
@@ -734,6 +825,11 @@ class MapAndBatchDatasetOp::Dataset : public DatasetBase {
   const std::vector<PartialTensorShape> output_shapes_;
   const std::unique_ptr<CapturedFunction> captured_func_;
   const bool preserve_cardinality_;
+  // Whether the function writes its return values straight into the batch,
+  // which requires the shapes of the elements, `element_shapes_`, to be
+  // static.
+  bool in_place_batching_ = false;
+  std::vector<TensorShape> element_shapes_;
   const TraceMeMetadata traceme_metadata_;
 };
 
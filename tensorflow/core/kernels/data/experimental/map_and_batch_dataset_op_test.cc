@@ -407,6 +407,26 @@ ITERATOR_SAVE_AND_RESTORE_TEST_P(MapAndBatchDatasetOpTest,
                                  MapAndBatchDatasetParams,
                                  IteratorSaveAndRestoreTestCases())
 
+// With static element shapes, the function writes its return values into the
+// slices of the batch that are aligned, here the first one, and the others are
+// copied there.
+TEST_F(MapAndBatchDatasetOpTest, InPlaceBatching) {
+  setenv("TF_JOB_NAME", "test_job", /*overwrite=*/1);
+  setenv("TF_TASK_ID", "0", /*overwrite=*/1);
+  setenv("TF_DATA_EXPERIMENT_OPT_IN", "map_and_batch_in_place",
+         /*overwrite=*/1);
+  auto dataset_params = MapAndBatchDatasetParams3();
+  TF_ASSERT_OK(Initialize(dataset_params));
+  TF_EXPECT_OK(CheckIteratorGetNext(
+      {CreateTensor<int64_t>(TensorShape({2}), {0, 8}),
+       CreateTensor<int64_t>(TensorShape({2}), {16, 24}),
+       CreateTensor<int64_t>(TensorShape({1}), {32})},
+      /*compare_order=*/true));
+  unsetenv("TF_JOB_NAME");
+  unsetenv("TF_TASK_ID");
+  unsetenv("TF_DATA_EXPERIMENT_OPT_IN");
+}
+
 TEST_F(MapAndBatchDatasetOpTest, InvalidBatchSize) {
   auto dataset_params = InvalidBatchSizeMapAndBatchDatasetParams();
   EXPECT_EQ(Initialize(dataset_params).code(),
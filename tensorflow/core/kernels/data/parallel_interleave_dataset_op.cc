@@ -45,6 +45,7 @@ limitations under the License.
 #include "tensorflow/core/lib/strings/stringprintf.h"
 #include "tensorflow/core/platform/blocking_counter.h"
 #include "tensorflow/core/platform/cpu_info.h"
+#include "tensorflow/core/platform/env_time.h"
 #include "tensorflow/core/platform/errors.h"
 #include "tensorflow/core/platform/stringprintf.h"
 #include "tensorflow/core/profiler/lib/traceme.h"
@@ -91,6 +92,7 @@ constexpr char kCycleIndex[] = "cycle_index";
 constexpr char kMaxBufferedElements[] = "max_buffered_elements";
 constexpr char kEndOfInput[] = "end_of_input";
 constexpr char kElementIdCounter[] = "element_id_counter";
+constexpr char kCurrentCycleLength[] = "current_cycle_length";
 constexpr char kCurrentElements[] = "current_elements";
 constexpr char kCurrentElementsSize[] = "current_elements.size";
 constexpr char kFutureElements[] = "future_elements";
@@ -123,6 +125,21 @@ constexpr double kDefaultPerIteratorPrefetchFactor = 2.0L;
 // Period between reporting dataset statistics.
 constexpr int kStatsReportingPeriodMillis = 1000;
 
+// An adaptive cycle length stays within a factor of `kCycleLengthRange` of the
+// initial cycle length, which bounds the memory used by per-input buffers.
+constexpr int64_t kCycleLengthRange = 4;
+
+// Period between adjustments of an adaptive cycle length.
+constexpr int64_t kCycleLengthAdjustmentPeriodMicros = 100 * 1000;
+
+// The number of inputs that are read concurrently exceeds the number needed to
+// keep up with the consumer by this factor, to absorb latency variance.
+constexpr double kCycleLengthHeadroom = 1.25;
+
+// The weight of a new sample in the moving averages of the input latency and
+// of the time between consumer requests.
+constexpr double kLatencyEmaWeight = 0.1;
+
 inline int64_t CeilDiv(int64_t numerator, int64_t denominator) {
   return (numerator + denominator - 1) / denominator;
 }
@@ -208,6 +225,16 @@ class ParallelInterleaveDatasetOp::Dataset : public DatasetBase {
         captured_func_(std::move(captured_func)),
         input_cycle_length_(cycle_length),
         cycle_length_(ComputeCycleLength(cycle_length, num_parallel_calls)),
+        adaptive_cycle_length_(
+            cycle_length == model::kAutotune &&
+            num_parallel_calls == model::kAutotune &&
+            GetExperiments().contains("adaptive_interleave_cycle_length")),
+        min_cycle_length_(adaptive_cycle_length_
+                              ? CeilDiv(cycle_length_, kCycleLengthRange)
+                              : cycle_length_),
+        max_cycle_length_(adaptive_cycle_length_
+                              ? cycle_length_ * kCycleLengthRange
+                              : cycle_length_),
         block_length_(block_length),
         buffer_output_elements_(
             ComputeBufferOutputElements(buffer_output_elements, block_length)),
@@ -364,8 +391,13 @@ class ParallelInterleaveDatasetOp::Dataset : public DatasetBase {
           num_parallel_calls_(std::make_shared<model::SharedState>(
               params.dataset->num_parallel_calls_, mu_,
               num_parallel_calls_cond_var_)),
+          cycle_length_(std::make_shared<model::SharedState>(
+              params.dataset->cycle_length_, mu_,
+              num_parallel_calls_cond_var_)),
           deterministic_(deterministic),
-          current_elements_(params.dataset->cycle_length_) {}
+          adaptive_cycle_length_(params.dataset->adaptive_cycle_length_ &&
+                                 !deterministic),
+          current_elements_(params.dataset->max_cycle_length_) {}
 
     ~ParallelInterleaveIterator() override { CancelThreads(/*wait=*/true); }
 
@@ -385,11 +417,11 @@ class ParallelInterleaveDatasetOp::Dataset : public DatasetBase {
       // support `num_threads` concurrent tasks without blocking indefinitely.
       //
       // Allocate one thread for the worker manager, one thread for stats
-      // collection, `cycle_length_` threads for the current workers, and
+      // collection, `MaxCycleLength()` threads for the current workers, and
       // `future_elements_prefetch_` for the future workers.
-      int max_current_workers = dataset()->cycle_length_;
+      int max_current_workers = MaxCycleLength();
       int future_workers =
-          dataset()->prefetch_input_elements_ + dataset()->cycle_length_;
+          dataset()->prefetch_input_elements_ + MaxCycleLength();
       int num_threads = 1 + max_current_workers + future_workers;
       if (ctx->stats_aggregator()) {
         num_threads++;
@@ -426,6 +458,10 @@ class ParallelInterleaveDatasetOp::Dataset : public DatasetBase {
         mutex_lock l(*mu_);
         EnsureInitialElementsCreated(ctx);
         EnsureThreadsStarted(ctx);
+        if (adaptive_cycle_length_) {
+          RecordConsumerRequest();
+          MaybeAdjustCycleLength(ctx);
+        }
         while (!cancelled_ && !Consume(ctx, &result)) {
           RecordStop(ctx);
           if (deterministic_) {
@@ -443,6 +479,9 @@ class ParallelInterleaveDatasetOp::Dataset : public DatasetBase {
         if (result) {
           checkpoint_->Merge(&result->checkpoint);
         }
+        if (adaptive_cycle_length_) {
+          last_request_end_us_ = EnvTime::NowMicros();
+        }
       }
       if (!result) {
         *end_of_sequence = true;
@@ -475,19 +514,28 @@ class ParallelInterleaveDatasetOp::Dataset : public DatasetBase {
                     static_cast<double>(dataset()->cycle_length_),
                     std::ceil(std::pow(27 * dataset()->cycle_length_, 0.5)))
               : 1;
+      // An adaptive cycle length is adjusted by the iterator rather than by
+      // the optimizer, so its state is not tunable and the model only reads
+      // its current value.
+      std::shared_ptr<model::Parameter> cycle_length =
+          adaptive_cycle_length_
+              ? model::MakeParameter(kCycleLength, cycle_length_,
+                                     dataset()->min_cycle_length_,
+                                     dataset()->max_cycle_length_)
+              : model::MakeNonTunableParameter(kCycleLength,
+                                               dataset()->cycle_length_);
       return model::MakeAsyncInterleaveManyNode(
           std::move(args),
           {model::MakeParameter(kParallelism, num_parallel_calls_, /*min=*/min,
-                                /*max=*/dataset()->cycle_length_),
-           model::MakeNonTunableParameter(kCycleLength,
-                                          dataset()->cycle_length_),
+                                /*max=*/MaxCycleLength()),
+           std::move(cycle_length),
            model::MakeNonTunableParameter(kDeterministic,
                                           deterministic_ ? 1.0 : 0.0),
            model::MakeNonTunableParameter(
                kMaxBufferedElements,
                ComputeMaxBufferedElements(dataset()->prefetch_input_elements_,
                                           dataset()->buffer_output_elements_,
-                                          dataset()->cycle_length_))});
+                                          MaxCycleLength()))});
     }
 
     Status SaveInternal(SerializationContext* ctx,
@@ -525,6 +573,11 @@ class ParallelInterleaveDatasetOp::Dataset : public DatasetBase {
           prefix(), kEndOfInput, static_cast<int64_t>(end_of_input_)));
       TF_RETURN_IF_ERROR(writer->WriteScalar(prefix(), kElementIdCounter,
                                              element_id_counter_));
+      if (adaptive_cycle_length_) {
+        TF_RETURN_IF_ERROR(writer->WriteScalar(
+            prefix(), kCurrentCycleLength,
+            static_cast<int64_t>(cycle_length_->value)));
+      }
       TF_RETURN_IF_ERROR(WriteCurrentElements(ctx, writer));
       TF_RETURN_IF_ERROR(WriteFutureElements(ctx, writer));
       // Wake workers back up.
@@ -546,6 +599,15 @@ class ParallelInterleaveDatasetOp::Dataset : public DatasetBase {
             reader->ReadScalar(prefix(), kCycleIndex, &cycle_index_));
         TF_RETURN_IF_ERROR(reader->ReadScalar(prefix(), kElementIdCounter,
                                               &element_id_counter_));
+        if (adaptive_cycle_length_ &&
+            reader->Contains(prefix(), kCurrentCycleLength)) {
+          int64_t cycle_length;
+          TF_RETURN_IF_ERROR(reader->ReadScalar(prefix(), kCurrentCycleLength,
+                                                &cycle_length));
+          cycle_length_->value = std::clamp(cycle_length,
+                                            dataset()->min_cycle_length_,
+                                            dataset()->max_cycle_length_);
+        }
         int64_t end_of_input;
         TF_RETURN_IF_ERROR(
             reader->ReadScalar(prefix(), kEndOfInput, &end_of_input));
@@ -710,7 +772,7 @@ class ParallelInterleaveDatasetOp::Dataset : public DatasetBase {
     void EnsureInitialElementsCreated(IteratorContext* ctx)
         TF_EXCLUSIVE_LOCKS_REQUIRED(mu_) {
       if (!initial_elements_created_) {
-        for (int i = 0; i < dataset()->cycle_length_; ++i) {
+        for (int i = 0; i < cycle_length_->value; ++i) {
           current_elements_[i] = MakeElement(ctx);
           if (!current_elements_[i]) {
             break;
@@ -765,7 +827,7 @@ class ParallelInterleaveDatasetOp::Dataset : public DatasetBase {
       // If we are allowed to be nondeterministic (i.e. return results out of
       // order), try to find an element in the cycle that has a result
       // available.
-      for (int i = 0; i < dataset()->cycle_length_; ++i) {
+      for (int i = 0; i < current_elements_.size(); ++i) {
         if (ConsumeHelper(ctx, result)) {
           return true;
         }
@@ -815,7 +877,11 @@ class ParallelInterleaveDatasetOp::Dataset : public DatasetBase {
         // We've consumed all results from the element. Get a new element from
         // future_elements, or create a new element if no future elements are
         // available.
-        if (!future_elements_.empty()) {
+        if (cycle_index_ >= cycle_length_->value) {
+          // The cycle has been shortened since the element was added.
+          current_elements_[cycle_index_].reset();
+          TrimCurrentElements();
+        } else if (!future_elements_.empty()) {
           std::shared_ptr<Element> future_element =
               std::move(future_elements_.front());
           future_elements_.pop_front();
@@ -836,15 +902,7 @@ class ParallelInterleaveDatasetOp::Dataset : public DatasetBase {
             element->cycle_index = cycle_index_;
             current_workers_cond_var_.notify_one();
           }
-          while (last_valid_current_element_ >= 0 &&
-                 !current_elements_[last_valid_current_element_]) {
-            last_valid_current_element_--;
-            if (cycle_index_ > last_valid_current_element_) {
-              // We are about to move the cycle index below in
-              // AdvanceToNextInCycle().
-              cycle_index_ = last_valid_current_element_;
-            }
-          }
+          TrimCurrentElements();
         }
         if (last_valid_current_element_ != -1) {
           AdvanceToNextInCycle();
@@ -852,6 +910,122 @@ class ParallelInterleaveDatasetOp::Dataset : public DatasetBase {
       }
     }
 
+    // Returns the largest number of elements that the cycle may hold.
+    int64_t MaxCycleLength() const {
+      return adaptive_cycle_length_ ? dataset()->max_cycle_length_
+                                    : dataset()->cycle_length_;
+    }
+
+    // Moves `last_valid_current_element_` back to the last element of the
+    // cycle that is not null.
+    void TrimCurrentElements() TF_EXCLUSIVE_LOCKS_REQUIRED(mu_) {
+      while (last_valid_current_element_ >= 0 &&
+             !current_elements_[last_valid_current_element_]) {
+        last_valid_current_element_--;
+        if (cycle_index_ > last_valid_current_element_) {
+          // We are about to move the cycle index below in
+          // AdvanceToNextInCycle().
+          cycle_index_ = last_valid_current_element_;
+        }
+      }
+    }
+
+    // Updates the moving average of the time that the consumer spends between
+    // two calls to `GetNext`, excluding the time spent waiting for results.
+    void RecordConsumerRequest() TF_EXCLUSIVE_LOCKS_REQUIRED(mu_) {
+      if (last_request_end_us_ == 0) {
+        return;
+      }
+      UpdateMovingAverage(EnvTime::NowMicros() - last_request_end_us_,
+                          &consumer_interval_us_);
+    }
+
+    // Updates the moving average of the time that an input takes to produce
+    // one result.
+    void RecordInputLatency(int64_t latency_us)
+        TF_EXCLUSIVE_LOCKS_REQUIRED(mu_) {
+      UpdateMovingAverage(latency_us, &input_latency_us_);
+    }
+
+    static void UpdateMovingAverage(double sample, double* average) {
+      *average = *average < 0 ? sample
+                              : (1 - kLatencyEmaWeight) * *average +
+                                    kLatencyEmaWeight * sample;
+    }
+
+    // Adapts the cycle length to the number of inputs that must be read
+    // concurrently to keep up with the consumer, which by Little's law is the
+    // input latency divided by the time between consumer requests. The cycle
+    // grows at once when the inputs become slower, so that their latency
+    // stays hidden, and shrinks by one element per period when they become
+    // faster. Elements beyond a shortened cycle are consumed to the end
+    // before they are dropped from the cycle.
+    void MaybeAdjustCycleLength(IteratorContext* ctx)
+        TF_EXCLUSIVE_LOCKS_REQUIRED(mu_) {
+      const int64_t now_us = EnvTime::NowMicros();
+      if (input_latency_us_ < 0 || consumer_interval_us_ < 0 ||
+          now_us - last_cycle_length_adjustment_us_ <
+              kCycleLengthAdjustmentPeriodMicros) {
+        return;
+      }
+      last_cycle_length_adjustment_us_ = now_us;
+      const int64_t target = std::clamp(
+          static_cast<int64_t>(std::ceil(kCycleLengthHeadroom *
+                                         input_latency_us_ /
+                                         std::max(consumer_interval_us_, 1.0))),
+          dataset()->min_cycle_length_, dataset()->max_cycle_length_);
+      const int64_t cycle_length = cycle_length_->value;
+      int64_t new_cycle_length = cycle_length;
+      if (target > cycle_length) {
+        new_cycle_length = target;
+      } else if (target < cycle_length) {
+        new_cycle_length = cycle_length - 1;
+      }
+      if (new_cycle_length == cycle_length) {
+        return;
+      }
+      VLOG(2) << "Changing the cycle length of " << prefix() << " from "
+              << cycle_length << " to " << new_cycle_length
+              << " for an input latency of " << input_latency_us_
+              << "us and a consumer interval of " << consumer_interval_us_
+              << "us";
+      cycle_length_->value = new_cycle_length;
+      for (int64_t i = cycle_length; i < new_cycle_length; ++i) {
+        AddToCycle(ctx, i);
+      }
+    }
+
+    // Fills the empty position `cycle_index` of a lengthened cycle with a
+    // future element, or with a new element if there are no future elements.
+    void AddToCycle(IteratorContext* ctx, int64_t cycle_index)
+        TF_EXCLUSIVE_LOCKS_REQUIRED(mu_) {
+      if (current_elements_[cycle_index]) {
+        // The element was not yet consumed to the end after the cycle was
+        // shortened.
+        return;
+      }
+      std::shared_ptr<Element> element;
+      if (!future_elements_.empty()) {
+        element = std::move(future_elements_.front());
+        future_elements_.pop_front();
+        if (element->iterator) {
+          EnableAutotune(ctx, element->iterator.get());
+        }
+        future_workers_cond_var_.notify_one();
+      } else {
+        element = MakeElement(ctx);
+        if (!element) {
+          return;
+        }
+      }
+      element->cycle_index = cycle_index;
+      current_elements_[cycle_index] = std::move(element);
+      elements_to_process_.push_back(cycle_index);
+      current_workers_cond_var_.notify_one();
+      last_valid_current_element_ =
+          std::max(last_valid_current_element_, cycle_index);
+    }
+
     // Creates a new element.
     std::shared_ptr<Element> MakeElement(IteratorContext* ctx)
         TF_EXCLUSIVE_LOCKS_REQUIRED(mu_) {
@@ -882,7 +1056,7 @@ class ParallelInterleaveDatasetOp::Dataset : public DatasetBase {
       // `future_element_.size() < future_elements_prefetch_`, there will be a
       // future worker available to create a new future element.
       int future_workers =
-          dataset()->prefetch_input_elements_ + dataset()->cycle_length_;
+          dataset()->prefetch_input_elements_ + MaxCycleLength();
       {
         mutex_lock l(*mu_);
         initial_current_workers = num_parallel_calls_->value;
@@ -1091,6 +1265,8 @@ class ParallelInterleaveDatasetOp::Dataset : public DatasetBase {
         });
         bool end_of_input = false;
         IteratorContext nested_ctx = MakeNestedIteratorContext(ctx);
+        const int64_t start_us =
+            adaptive_cycle_length_ ? EnvTime::NowMicros() : 0;
         result->status = iterator->GetNext(&nested_ctx, &result->return_values,
                                            &end_of_input);
         result->checkpoint.Merge(nested_ctx.checkpoint());
@@ -1107,6 +1283,9 @@ class ParallelInterleaveDatasetOp::Dataset : public DatasetBase {
         }
         RecordBufferEnqueue(ctx, result->return_values);
         mutex_lock l(*mu_);
+        if (adaptive_cycle_length_) {
+          RecordInputLatency(EnvTime::NowMicros() - start_us);
+        }
         element->results.push_back(std::move(result));
         NotifyElementUpdate(*element);
         if (element->results.size() == dataset()->buffer_output_elements_) {
@@ -1661,6 +1840,11 @@ class ParallelInterleaveDatasetOp::Dataset : public DatasetBase {
     // Identifies the maximum number of parallel calls.
     const std::shared_ptr<model::SharedState> num_parallel_calls_;
 
+    // The number of elements in the interleave cycle, which only changes if
+    // `adaptive_cycle_length_`. `current_elements_` has room for the maximum
+    // cycle length.
+    const std::shared_ptr<model::SharedState> cycle_length_;
+
     // The number of current workers currently alive or scheduled to be started.
     // This includes current workers which are blocked waiting for work.
     int num_current_workers_ TF_GUARDED_BY(mu_) = 0;
@@ -1672,6 +1856,18 @@ class ParallelInterleaveDatasetOp::Dataset : public DatasetBase {
     // Determines whether outputs can be produced in deterministic order.
     const bool deterministic_;
 
+    // Whether the cycle length adapts to the latency of the inputs. Only
+    // nondeterministic iterators adapt it, since it determines the order of
+    // the outputs.
+    const bool adaptive_cycle_length_;
+
+    // Moving averages of the time that an input takes to produce a result and
+    // of the time between consumer requests, or -1 until they are measured.
+    double input_latency_us_ TF_GUARDED_BY(mu_) = -1;
+    double consumer_interval_us_ TF_GUARDED_BY(mu_) = -1;
+    int64_t last_request_end_us_ TF_GUARDED_BY(mu_) = 0;
+    int64_t last_cycle_length_adjustment_us_ TF_GUARDED_BY(mu_) = 0;
+
     // Controls cancellation of `input_impl_`. Must be ordered before
     // `input_impl_` so that `input_impl_` is destroyed first.
     std::unique_ptr<CancellationManager> cancellation_manager_;
@@ -1741,7 +1937,13 @@ class ParallelInterleaveDatasetOp::Dataset : public DatasetBase {
   const DatasetBase* const input_;
   const std::unique_ptr<CapturedFunction> captured_func_;
   const int64_t input_cycle_length_;
+  // The initial cycle length.
   const int64_t cycle_length_;
+  // Whether the cycle length of nondeterministic iterators adapts to the
+  // latency of the inputs, within `[min_cycle_length_, max_cycle_length_]`.
+  const bool adaptive_cycle_length_;
+  const int64_t min_cycle_length_;
+  const int64_t max_cycle_length_;
   const int64_t block_length_;
   const int64_t buffer_output_elements_;
   const int64_t prefetch_input_elements_;
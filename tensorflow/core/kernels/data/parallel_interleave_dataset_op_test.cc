@@ -729,6 +729,28 @@ TEST_F(ParallelInterleaveDatasetOpTest, InputCycleLengthPreservedInGraphDef) {
   unsetenv("TF_DATA_EXPERIMENT_OPT_IN");
 }
 
+// Test that an iterator whose cycle length adapts to the latency of its inputs
+// produces every element once, including across a checkpoint.
+TEST_F(ParallelInterleaveDatasetOpTest, AdaptiveCycleLength) {
+  setenv("TF_JOB_NAME", "test_job", /*overwrite=*/1);
+  setenv("TF_TASK_ID", "0", /*overwrite=*/1);
+  setenv("TF_DATA_EXPERIMENT_OPT_IN", "adaptive_interleave_cycle_length",
+         /*overwrite=*/1);
+  auto dataset_params = DatasetGraphDefParams();
+  TF_ASSERT_OK(Initialize(dataset_params));
+  std::vector<Tensor> expected_outputs = CreateTensors<tstring>(
+      TensorShape{1},
+      {{"a"}, {"b"}, {"c"}, {"d"}, {"e"}, {"f"}, {"g"}, {"h"}, {"i"}});
+  TF_ASSERT_OK(CheckIteratorGetNext(expected_outputs,
+                                    /*compare_order=*/false));
+  TF_ASSERT_OK(CheckIteratorSaveAndRestore(
+      dataset_params.iterator_prefix(), expected_outputs,
+      /*breakpoints=*/{0, 4, 11}, /*compare_order=*/false));
+  unsetenv("TF_JOB_NAME");
+  unsetenv("TF_TASK_ID");
+  unsetenv("TF_DATA_EXPERIMENT_OPT_IN");
+}
+
 TEST_F(ParallelInterleaveDatasetOpTest, DatasetNodeName) {
   auto dataset_params = ParallelInterleaveDatasetParams1();
   TF_ASSERT_OK(Initialize(dataset_params));
@@ -268,6 +268,11 @@ class ParallelMapDatasetOp::Dataset : public DatasetBase {
       if (num_parallel_calls_->value == model::kAutotune) {
         num_parallel_calls_->value = GetAutotuneDefaultParallelism(ctx);
       }
+      // Symbolic checkpoints require elements to be produced in order.
+      if (deterministic_ && !ctx->symbolic_checkpoint() &&
+          ctx->options() != nullptr) {
+        reorder_buffer_bytes_ = ctx->options()->reorder_buffer_bytes();
+      }
       cancellation_manager_ = std::make_unique<CancellationManager>();
       TF_RETURN_IF_ERROR(RegisterCancellationCallback(
           ctx->cancellation_manager(),
@@ -449,6 +454,10 @@ class ParallelMapDatasetOp::Dataset : public DatasetBase {
       bool end_of_input = false;
       const int64_t uid;
       MemoryCheckpoint checkpoint;
+      // Whether the result is still in `invocation_results_`, and the bytes it
+      // holds in the reorder window. Guarded by `mu_`.
+      bool buffered = true;
+      int64_t window_bytes = 0;
     };
 
     void CancelThreads(bool wait) TF_LOCKS_EXCLUDED(mu_) {
@@ -480,8 +489,17 @@ class ParallelMapDatasetOp::Dataset : public DatasetBase {
     void CallCompleted(const std::shared_ptr<IteratorContext>& ctx,
                        const std::shared_ptr<InvocationResult>& result)
         TF_LOCKS_EXCLUDED(*mu_) {
+      const int64_t window_bytes =
+          reorder_buffer_bytes_ > 0
+              ? GetAllocatedBytes(result->return_values) +
+                    static_cast<int64_t>(sizeof(InvocationResult))
+              : 0;
       mutex_lock l(*mu_);
       num_calls_--;
+      if (result->buffered) {
+        result->window_bytes = window_bytes;
+        reorder_window_bytes_ += window_bytes;
+      }
       result->notification.Notify();
       cond_var_->notify_all();
     }
@@ -586,8 +604,14 @@ class ParallelMapDatasetOp::Dataset : public DatasetBase {
       }
       auto busy = [this]() TF_EXCLUSIVE_LOCKS_REQUIRED(*mu_) -> bool {
         int64_t num_parallel_calls = num_parallel_calls_->value;
-        return num_calls_ >= num_parallel_calls ||
-               invocation_results_.size() >= num_parallel_calls;
+        if (num_calls_ >= num_parallel_calls) {
+          return true;
+        }
+        // Results that complete out of order may grow the buffer beyond
+        // `num_parallel_calls` as long as they fit in the reorder window.
+        return invocation_results_.size() >= num_parallel_calls &&
+               (reorder_buffer_bytes_ <= 0 ||
+                reorder_window_bytes_ >= reorder_buffer_bytes_);
       };
       while (true) {
         {
@@ -632,21 +656,49 @@ class ParallelMapDatasetOp::Dataset : public DatasetBase {
              it != invocation_results_.end(); ++it) {
           if ((*it)->notification.HasBeenNotified() &&
               (it == invocation_results_.begin() || !(*it)->end_of_input)) {
-            std::swap(*result, *it);
-            invocation_results_.erase(it);
-            cond_var_->notify_all();
+            TakeResult(it, result);
             return false;
           }
         }
       } else if (!invocation_results_.empty()) {
-        std::swap(*result, invocation_results_.front());
-        invocation_results_.pop_front();
-        cond_var_->notify_all();
+        if (reorder_buffer_bytes_ > 0 &&
+            !invocation_results_.front()->notification.HasBeenNotified()) {
+          // Wait for the oldest result while later results that complete can
+          // still be buffered. Once the reorder window is full, produce the
+          // oldest completed result out of order instead of stalling.
+          if (reorder_window_bytes_ < reorder_buffer_bytes_) {
+            return true;
+          }
+          for (auto it = invocation_results_.begin() + 1;
+               it != invocation_results_.end(); ++it) {
+            if ((*it)->notification.HasBeenNotified() && !(*it)->end_of_input) {
+              if (model_node()) {
+                model_node()->record_reorder_stall();
+              }
+              TakeResult(it, result);
+              return false;
+            }
+          }
+          return true;
+        }
+        TakeResult(invocation_results_.begin(), result);
         return false;
       }
       return true;
     }
 
+    // Removes the result at `it` from `invocation_results_` into `*result`.
+    void TakeResult(
+        std::deque<std::shared_ptr<InvocationResult>>::iterator it,
+        std::shared_ptr<InvocationResult>* result)
+        TF_EXCLUSIVE_LOCKS_REQUIRED(*mu_) {
+      (*it)->buffered = false;
+      reorder_window_bytes_ -= (*it)->window_bytes;
+      std::swap(*result, *it);
+      invocation_results_.erase(it);
+      cond_var_->notify_all();
+    }
+
     void StatsThread(const std::shared_ptr<IteratorContext>& ctx)
         TF_LOCKS_EXCLUDED(*mu_) {
       for (int64_t step = 0;; ++step) {
@@ -722,6 +774,12 @@ class ParallelMapDatasetOp::Dataset : public DatasetBase {
     const bool deterministic_;
     const bool preserve_cardinality_;
     const bool autotune_;
+    // If positive, results that complete while the oldest result is pending
+    // are buffered in a window of up to this many bytes, see
+    // `Options.reorder_buffer_bytes`. Only set for deterministic iterators.
+    int64_t reorder_buffer_bytes_ = 0;
+    // The bytes held by the completed results in `invocation_results_`.
+    int64_t reorder_window_bytes_ TF_GUARDED_BY(*mu_) = 0;
     // Counts the number of outstanding calls.
     int64_t num_calls_ TF_GUARDED_BY(*mu_) = 0;
     // Controls cancellation of `input_impl_`. Must be ordered before
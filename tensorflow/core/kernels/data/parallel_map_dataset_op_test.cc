@@ -411,6 +411,34 @@ TEST_F(ParallelMapDatasetOpTest, InvalidNumParallelCalls) {
             absl::StatusCode::kInvalidArgument);
 }
 
+TEST_F(ParallelMapDatasetOpTest, ReorderWindow) {
+  auto dataset_params = ParallelMapDatasetParams4();
+  TF_ASSERT_OK(Initialize(dataset_params));
+  const std::vector<Tensor> expected_outputs =
+      CreateTensors<int64_t>(TensorShape{}, {{0}, {6}, {12}, {18}});
+  // The output is deterministic while the reorder window has room, and
+  // produces all elements when it overflows.
+  for (int64_t reorder_buffer_bytes : {int64_t{1} << 20, int64_t{1}}) {
+    Options options;
+    options.set_reorder_buffer_bytes(reorder_buffer_bytes);
+    IteratorContext::Params params(iterator_ctx_.get());
+    params.options = &options;
+    IteratorContext ctx(std::move(params));
+    std::unique_ptr<IteratorBase> iterator;
+    TF_ASSERT_OK(dataset_->MakeIterator(
+        &ctx, /*parent=*/nullptr, dataset_params.iterator_prefix(), &iterator));
+    std::vector<Tensor> out_tensors;
+    bool end_of_sequence = false;
+    while (!end_of_sequence) {
+      std::vector<Tensor> next;
+      TF_ASSERT_OK(iterator->GetNext(&ctx, &next, &end_of_sequence));
+      out_tensors.insert(out_tensors.end(), next.begin(), next.end());
+    }
+    TF_EXPECT_OK(ExpectEqual(out_tensors, expected_outputs,
+                             /*compare_order=*/reorder_buffer_bytes > 1));
+  }
+}
+
 }  // namespace
 }  // namespace data
 }  // namespace tensorflow
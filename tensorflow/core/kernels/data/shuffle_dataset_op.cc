@@ -15,6 +15,7 @@ limitations under the License.
 #include "tensorflow/core/kernels/data/shuffle_dataset_op.h"
 
 #include <cstdint>
+#include <cstdlib>
 #include <deque>
 #include <memory>
 #include <numeric>
@@ -26,6 +27,7 @@ limitations under the License.
 #include "absl/container/flat_hash_set.h"
 #include "absl/strings/str_cat.h"
 #include "tensorflow/core/data/dataset_utils.h"
+#include "tensorflow/core/data/incremental_buffer_checkpoint.h"
 #include "tensorflow/core/data/name_utils.h"
 #include "tensorflow/core/data/serialization_utils.h"
 #include "tensorflow/core/framework/dataset.h"
@@ -37,8 +39,10 @@ limitations under the License.
 #include "tensorflow/core/lib/random/philox_random.h"
 #include "tensorflow/core/lib/random/random.h"
 #include "tensorflow/core/lib/random/random_distributions.h"
+#include "tensorflow/core/platform/env.h"
 #include "tensorflow/core/platform/errors.h"
 #include "tensorflow/core/platform/stringprintf.h"
+#include "tensorflow/core/util/env_var.h"
 
 namespace tensorflow {
 namespace data {
@@ -81,6 +85,34 @@ constexpr char kShuffleDatasetV3[] = "ShuffleDatasetV3";
 constexpr char kShuffleAndRepeatDatasetV1[] = "ShuffleAndRepeatDataset";
 constexpr char kShuffleAndRepeatDatasetV2[] = "ShuffleAndRepeatDatasetV2";
 
+// When set, shuffle buffers are checkpointed incrementally to files in this
+// directory. See `IncrementalBufferCheckpoint`.
+constexpr char kShuffleCheckpointDirEnvVar[] = "TF_DATA_SHUFFLE_CHECKPOINT_DIR";
+// The number of incremental checkpoints after which the whole buffer is
+// written again.
+constexpr char kShuffleCheckpointCompactionIntervalEnvVar[] =
+    "TF_DATA_SHUFFLE_CHECKPOINT_COMPACTION_INTERVAL";
+constexpr int64_t kDefaultShuffleCheckpointCompactionInterval = 10;
+
+std::unique_ptr<IncrementalBufferCheckpoint>
+MaybeCreateIncrementalCheckpoint() {
+  const char* directory = std::getenv(kShuffleCheckpointDirEnvVar);
+  if (directory == nullptr || *directory == '\0') {
+    return nullptr;
+  }
+  int64_t compaction_interval;
+  Status s = ReadInt64FromEnvVar(kShuffleCheckpointCompactionIntervalEnvVar,
+                                 kDefaultShuffleCheckpointCompactionInterval,
+                                 &compaction_interval);
+  if (!s.ok()) {
+    LOG(WARNING) << "Failed to read "
+                 << kShuffleCheckpointCompactionIntervalEnvVar << ": " << s;
+    compaction_interval = kDefaultShuffleCheckpointCompactionInterval;
+  }
+  return std::make_unique<IncrementalBufferCheckpoint>(
+      Env::Default(), directory, compaction_interval);
+}
+
 ShuffleDatasetOpBase::ShuffleDatasetOpBase(OpKernelConstruction* ctx)
     : UnaryDatasetOpKernel(ctx) {}
 
@@ -293,8 +325,19 @@ class ShuffleDatasetOpBase::ShuffleDatasetBase : public DatasetBase {
             writer, key_prefix, *buffer_, checkpoint_indices_));
         checkpoint_indices_.clear();
       } else {
-        TF_RETURN_IF_ERROR(
-            WriteElementsToCheckpoint(writer, key_prefix, *buffer_));
+        if (incremental_checkpoint_ == nullptr) {
+          incremental_checkpoint_ = MaybeCreateIncrementalCheckpoint();
+        }
+        if (incremental_checkpoint_ != nullptr) {
+          // Only the slots that changed since the previous save are written,
+          // to files outside of the checkpoint.
+          TF_RETURN_IF_ERROR(incremental_checkpoint_->Save(
+              writer, key_prefix, dataset()->output_dtypes(), *buffer_,
+              checkpoint_indices_));
+        } else {
+          TF_RETURN_IF_ERROR(
+              WriteElementsToCheckpoint(writer, key_prefix, *buffer_));
+        }
       }
 
       TF_RETURN_IF_ERROR(
@@ -358,9 +401,27 @@ class ShuffleDatasetOpBase::ShuffleDatasetBase : public DatasetBase {
         slices_size = static_cast<size_t>(temp);
       }
       buffer_ = std::make_unique<std::vector<std::vector<Tensor>>>();
-      TF_RETURN_IF_ERROR(ReadElementsFromCheckpoint(
-          ctx, reader, absl::StrCat(prefix(), kColon, "buffer"),
-          buffer_.get()));
+      const std::string key_prefix = absl::StrCat(prefix(), kColon, "buffer");
+      if (IncrementalBufferCheckpoint::Contains(reader, key_prefix)) {
+        if (incremental_checkpoint_ == nullptr) {
+          incremental_checkpoint_ = MaybeCreateIncrementalCheckpoint();
+        }
+        // Checkpoints are restored by their format, even when incremental
+        // checkpointing is no longer enabled for new saves.
+        std::unique_ptr<IncrementalBufferCheckpoint> fallback;
+        IncrementalBufferCheckpoint* checkpoint = incremental_checkpoint_.get();
+        if (checkpoint == nullptr) {
+          fallback = std::make_unique<IncrementalBufferCheckpoint>(
+              Env::Default(), /*directory=*/"", /*compaction_interval=*/1);
+          checkpoint = fallback.get();
+        }
+        TF_RETURN_IF_ERROR(checkpoint->Restore(
+            reader, key_prefix, dataset()->output_dtypes(), buffer_.get()));
+        checkpoint_indices_.clear();
+      } else {
+        TF_RETURN_IF_ERROR(ReadElementsFromCheckpoint(ctx, reader, key_prefix,
+                                                      buffer_.get()));
+      }
       if (ctx->symbolic_checkpoint()) {
         DCHECK(checkpoint_indices_.empty());
         for (size_t i = 0; i < buffer_->size(); ++i) {
@@ -562,8 +623,13 @@ class ShuffleDatasetOpBase::ShuffleDatasetBase : public DatasetBase {
         TF_GUARDED_BY(mu_);
     // Holds the indices of `buffer_` that have changed since the previous
     // `SaveInternal()` and need to be updated in the MemoryCheckpoint
-    // (if symbolic checkpointing is used) in the next `SaveInternal()`.
+    // (if symbolic checkpointing is used) or in the incremental checkpoint
+    // files in the next `SaveInternal()`.
     absl::flat_hash_set<int64_t> checkpoint_indices_ TF_GUARDED_BY(mu_);
+    // Writes `buffer_` incrementally when `TF_DATA_SHUFFLE_CHECKPOINT_DIR` is
+    // set and symbolic checkpointing is not used.
+    std::unique_ptr<IncrementalBufferCheckpoint> incremental_checkpoint_
+        TF_GUARDED_BY(mu_);
     std::unique_ptr<IteratorBase> input_impl_ TF_GUARDED_BY(mu_) = nullptr;
     int64_t epoch_ TF_GUARDED_BY(mu_) = 0;
     int64_t num_elements_ TF_GUARDED_BY(mu_) = 0;
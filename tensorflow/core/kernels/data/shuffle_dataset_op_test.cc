@@ -11,12 +11,14 @@ limitations under the License.
 ==============================================================================*/
 #include "tensorflow/core/kernels/data/shuffle_dataset_op.h"
 
+#include <cstdlib>
 #include <string>
 #include <utility>
 
 #include "tensorflow/core/data/dataset_test_base.h"
 #include "tensorflow/core/data/dataset_utils.h"
 #include "tensorflow/core/data/serialization_utils.h"
+#include "tensorflow/core/platform/path.h"
 
 namespace tensorflow {
 namespace data {
@@ -583,6 +585,61 @@ INSTANTIATE_TEST_CASE_P(ShuffleDatasetOpTest,
                         ParameterizedIteratorSaveAndRestoreTest,
                         ::testing::ValuesIn(IteratorSaveAndRestoreTestCases()));
 
+class ParameterizedIncrementalSaveAndRestoreTest
+    : public ParameterizedIteratorSaveAndRestoreTest {
+ protected:
+  void SetUp() override {
+    const std::string directory =
+        io::JoinPath(testing::TmpDir(), "shuffle_checkpoint");
+    setenv("TF_DATA_SHUFFLE_CHECKPOINT_DIR", directory.c_str(), 1);
+    setenv("TF_DATA_SHUFFLE_CHECKPOINT_COMPACTION_INTERVAL", "2", 1);
+  }
+
+  void TearDown() override {
+    unsetenv("TF_DATA_SHUFFLE_CHECKPOINT_DIR");
+    unsetenv("TF_DATA_SHUFFLE_CHECKPOINT_COMPACTION_INTERVAL");
+  }
+};
+
+// Checkpoints that write the shuffle buffer incrementally restore the same
+// sequence as full checkpoints.
+TEST_P(ParameterizedIncrementalSaveAndRestoreTest, IteratorSaveAndRestore) {
+  auto test_case = GetParam();
+  TF_ASSERT_OK(Initialize(test_case.dataset_params));
+
+  std::unique_ptr<SerializationContext> serialization_ctx;
+  TF_ASSERT_OK(CreateSerializationContext(&serialization_ctx));
+
+  bool end_of_sequence = false;
+  std::vector<Tensor> out_tensors;
+  int cur_iteration = 0;
+  for (int breakpoint : test_case.breakpoints) {
+    VariantTensorDataWriter writer;
+    TF_EXPECT_OK(iterator_->Save(serialization_ctx.get(), &writer));
+    std::vector<const VariantTensorData*> data;
+    writer.GetData(&data);
+    VariantTensorDataReader reader(data);
+    TF_EXPECT_OK(RestoreIterator(iterator_ctx_.get(), &reader,
+                                 test_case.dataset_params.iterator_prefix(),
+                                 *dataset_, &iterator_));
+
+    while (cur_iteration <= breakpoint) {
+      std::vector<Tensor> next;
+      TF_EXPECT_OK(
+          iterator_->GetNext(iterator_ctx_.get(), &next, &end_of_sequence));
+      out_tensors.insert(out_tensors.end(), next.begin(), next.end());
+      cur_iteration++;
+    }
+  }
+
+  TF_EXPECT_OK(ExpectEqual(out_tensors, test_case.expected_shuffle_outputs,
+                           /*compare_order=*/true));
+}
+
+INSTANTIATE_TEST_CASE_P(ShuffleDatasetOpTest,
+                        ParameterizedIncrementalSaveAndRestoreTest,
+                        ::testing::ValuesIn(IteratorSaveAndRestoreTestCases()));
+
 TEST_F(ShuffleDatasetOpTest, InvalidArguments) {
   std::vector<ShuffleDatasetParams> dataset_params_vec(
       {ShuffleDatasetParamsWithInvalidBufferSize(),
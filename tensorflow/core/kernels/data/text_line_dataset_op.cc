@@ -37,6 +37,9 @@ constexpr char kZLIB[] = "ZLIB";
 constexpr char kGZIP[] = "GZIP";
 constexpr char kCurrentFileIndex[] = "current_file_index";
 constexpr char kCurrentPos[] = "current_pos";
+// The default read size for uncompressed files. Lines are split with one
+// `memchr` scan per buffer, so larger buffers mostly save file system calls.
+constexpr int64_t kDefaultUncompressedBufferSize = 1 << 20;  // 1MB.
 
 class TextLineDatasetOp::Dataset : public DatasetBase {
  public:
@@ -270,6 +273,9 @@ void TextLineDatasetOp::MakeDataset(OpKernelContext* ctx,
                 errors::InvalidArgument("Unsupported compression_type."));
   }
 
+  if (buffer_size == 0 && compression_type.empty()) {
+    buffer_size = kDefaultUncompressedBufferSize;
+  }
   if (buffer_size != 0) {
     // Set the override size.
     zlib_compression_options.input_buffer_size = buffer_size;
@@ -14,7 +14,21 @@ limitations under the License.
 ==============================================================================*/
 #include "tensorflow/core/kernels/data/tf_record_dataset_op.h"
 
+#include <algorithm>
+#include <cstdint>
+#include <deque>
+#include <iterator>
+#include <map>
+#include <memory>
+#include <vector>
+
+#include "absl/status/status.h"
+#include "absl/status/statusor.h"
+#include "absl/strings/str_cat.h"
+#include "absl/types/span.h"
+#include "tensorflow/core/data/dataset_utils.h"
 #include "tensorflow/core/data/name_utils.h"
+#include "tensorflow/core/data/tfrecord_index.h"
 #include "tensorflow/core/data/utils.h"
 #include "tensorflow/core/framework/metrics.h"
 #include "tensorflow/core/framework/partial_tensor_shape.h"
@@ -37,6 +51,8 @@ namespace data {
 /* static */ constexpr const char* const TFRecordDatasetOp::kCompressionType;
 /* static */ constexpr const char* const TFRecordDatasetOp::kBufferSize;
 /* static */ constexpr const char* const TFRecordDatasetOp::kByteOffsets;
+/* static */ constexpr const char* const
+    TFRecordDatasetOp::kPayloadChecksumInterval;
 
 constexpr char kTFRecordDataset[] = "TFRecordDataset";
 constexpr char kCurrentFileIndex[] = "current_file_index";
@@ -45,6 +61,12 @@ constexpr char kGcsFsPrefix[] = "gs://";
 constexpr char kS3FsPrefix[] = "s3://";
 constexpr int64_t kCloudTpuBlockSize = 127LL << 20;  // 127MB.
 constexpr int64_t kS3BlockSize = kCloudTpuBlockSize;
+// The number of buffers whose reads are kept in flight when the
+// "tfrecord_read_ahead" experiment is enabled.
+constexpr int kReadAheadBlocks = 4;
+// The number of globally shuffled elements whose records are read together
+// when the dataset is read in random order.
+constexpr int64_t kRandomAccessBatchSize = 64;
 
 bool is_cloud_tpu_gcs_fs() {
 #if (defined(PLATFORM_CLOUD_TPU) && defined(TPU_GCS_FS)) || \
@@ -56,18 +78,34 @@ bool is_cloud_tpu_gcs_fs() {
 
 class TFRecordDatasetOp::Dataset : public DatasetBase {
  public:
-  explicit Dataset(OpKernelContext* ctx, std::vector<string> filenames,
-                   const string& compression_type, int64_t buffer_size,
-                   std::vector<int64_t> byte_offsets, int op_version)
+  explicit Dataset(
+      OpKernelContext* ctx, std::vector<string> filenames,
+      const string& compression_type, int64_t buffer_size,
+      std::vector<int64_t> byte_offsets, int64_t payload_checksum_interval,
+      int op_version,
+      std::vector<std::unique_ptr<RandomAccessTFRecordReader>>
+          random_access_readers,
+      absl::Status random_access_status)
       : DatasetBase(DatasetContext(ctx)),
         filenames_(std::move(filenames)),
         compression_type_(compression_type),
         options_(io::RecordReaderOptions::CreateRecordReaderOptions(
             compression_type)),
         byte_offsets_(std::move(byte_offsets)),
-        op_version_(op_version) {
+        op_version_(op_version),
+        random_access_readers_(std::move(random_access_readers)),
+        random_access_status_(std::move(random_access_status)) {
+    options_.payload_checksum_interval = payload_checksum_interval;
+    num_records_before_.push_back(0);
+    for (const auto& reader : random_access_readers_) {
+      num_records_before_.push_back(num_records_before_.back() +
+                                    reader->num_records());
+    }
     if (buffer_size > 0) {
       options_.buffer_size = buffer_size;
+      if (GetExperiments().contains("tfrecord_read_ahead")) {
+        options_.read_ahead_blocks = kReadAheadBlocks;
+      }
     }
   }
 
@@ -102,6 +140,33 @@ class TFRecordDatasetOp::Dataset : public DatasetBase {
 
   Status CheckExternalState() const override { return absl::OkStatus(); }
 
+  int64_t CardinalityInternal(CardinalityOptions options) const override {
+    if (!random_access_status_.ok()) {
+      return kUnknownCardinality;
+    }
+    return num_records_before_.back();
+  }
+
+  Status Get(OpKernelContext* ctx, int64 index,
+             std::vector<Tensor>* out_tensors) const override {
+    return Get(AnyContext(ctx), index, out_tensors);
+  }
+
+  Status Get(AnyContext ctx, int64 index,
+             std::vector<Tensor>* out_tensors) const override {
+    TF_RETURN_IF_ERROR(CheckRandomAccessCompatible(index));
+    std::vector<tstring> records;
+    TF_RETURN_IF_ERROR(ReadRecords({index}, &records));
+    out_tensors->clear();
+    out_tensors->emplace_back(ctx.allocator, DT_STRING, TensorShape({}));
+    out_tensors->back().scalar<tstring>()() = std::move(records[0]);
+    return absl::OkStatus();
+  }
+
+  absl::Status RandomIndexingCompatible() const override {
+    return random_access_status_;
+  }
+
  protected:
   Status AsGraphDefInternal(SerializationContext* ctx,
                             DatasetGraphDefBuilder* b,
@@ -112,14 +177,52 @@ class TFRecordDatasetOp::Dataset : public DatasetBase {
     TF_RETURN_IF_ERROR(b->AddScalar(compression_type_, &compression_type));
     Node* buffer_size = nullptr;
     TF_RETURN_IF_ERROR(b->AddScalar(options_.buffer_size, &buffer_size));
+    AttrValue payload_checksum_interval;
+    b->BuildAttrValue(options_.payload_checksum_interval,
+                      &payload_checksum_interval);
     TF_RETURN_IF_ERROR(b->AddDataset(
-        this, {filenames, compression_type, buffer_size}, output));
+        this, {filenames, compression_type, buffer_size},
+        {{kPayloadChecksumInterval, payload_checksum_interval}}, output));
     Node* byte_offsets = nullptr;
     TF_RETURN_IF_ERROR(b->AddVector(byte_offsets_, &byte_offsets));
     return absl::OkStatus();
   }
 
  private:
+  // Reads the records with indices `indices` in the concatenation of all files
+  // into `records`. The records of each file are read together.
+  // REQUIRES: `random_access_status_.ok()` and `0 <= index < Cardinality()`
+  // for every index.
+  Status ReadRecords(absl::Span<const int64_t> indices,
+                     std::vector<tstring>* records) const {
+    records->clear();
+    records->resize(indices.size());
+    // A map from file indices to the positions in `indices` of their records.
+    std::map<size_t, std::vector<size_t>> positions_by_file;
+    for (size_t i = 0; i < indices.size(); ++i) {
+      const size_t file_index =
+          std::upper_bound(num_records_before_.begin(),
+                           num_records_before_.end(), indices[i]) -
+          num_records_before_.begin() - 1;
+      positions_by_file[file_index].push_back(i);
+    }
+    for (const auto& [file_index, positions] : positions_by_file) {
+      std::vector<int64_t> file_indices;
+      file_indices.reserve(positions.size());
+      for (size_t position : positions) {
+        file_indices.push_back(indices[position] -
+                               num_records_before_[file_index]);
+      }
+      std::vector<tstring> file_records;
+      TF_RETURN_IF_ERROR(random_access_readers_[file_index]->ReadRecords(
+          file_indices, &file_records));
+      for (size_t i = 0; i < positions.size(); ++i) {
+        (*records)[positions[i]] = std::move(file_records[i]);
+      }
+    }
+    return absl::OkStatus();
+  }
+
   class Iterator : public DatasetIterator<Dataset> {
    public:
     explicit Iterator(const Params& params)
@@ -130,6 +233,9 @@ class TFRecordDatasetOp::Dataset : public DatasetBase {
     Status GetNextInternal(IteratorContext* ctx,
                            std::vector<Tensor>* out_tensors,
                            bool* end_of_sequence) override {
+      if (ctx->index_mapper() != nullptr) {
+        return GetNextShuffled(ctx, out_tensors, end_of_sequence);
+      }
       out_tensors->reserve(1);
       mutex_lock l(mu_);
       do {
@@ -236,6 +342,11 @@ class TFRecordDatasetOp::Dataset : public DatasetBase {
     Status RestoreInternal(IteratorContext* ctx,
                            IteratorStateReader* reader) override {
       mutex_lock l(mu_);
+      if (ctx->restored_element_count().has_value()) {
+        element_count_ = *ctx->restored_element_count();
+        shuffled_records_.clear();
+        return absl::OkStatus();
+      }
       ResetStreamsLocked();
       int64_t current_file_index;
       TF_RETURN_IF_ERROR(
@@ -251,6 +362,57 @@ class TFRecordDatasetOp::Dataset : public DatasetBase {
     }
 
    private:
+    // Returns the next globally shuffled element. The records of the next
+    // `kRandomAccessBatchSize` elements are read together, so that records
+    // that are close to each other in a file are read with one I/O.
+    Status GetNextShuffled(IteratorContext* ctx,
+                           std::vector<Tensor>* out_tensors,
+                           bool* end_of_sequence) {
+      mutex_lock l(mu_);
+      if (shuffled_records_.empty()) {
+        TF_RETURN_IF_ERROR(dataset()->RandomIndexingCompatible());
+        const int64_t cardinality = dataset()->num_records_before_.back();
+        std::vector<int64_t> indices;
+        for (int64_t i = 0; i < kRandomAccessBatchSize; ++i) {
+          absl::StatusOr<size_t> index =
+              ctx->index_mapper()(element_count_ + i);
+          if (!index.ok()) {
+            // Errors are returned when the element that caused them is
+            // reached.
+            if (indices.empty()) {
+              return index.status();
+            }
+            break;
+          }
+          if (*index >= cardinality) {
+            break;
+          }
+          indices.push_back(*index);
+        }
+        std::vector<tstring> records;
+        TF_RETURN_IF_ERROR(dataset()->ReadRecords(indices, &records));
+        shuffled_records_.assign(std::make_move_iterator(records.begin()),
+                                 std::make_move_iterator(records.end()));
+      }
+      if (shuffled_records_.empty()) {
+        *end_of_sequence = true;
+        return absl::OkStatus();
+      }
+
+      out_tensors->emplace_back(ctx->allocator({}), DT_STRING,
+                                TensorShape({}));
+      out_tensors->back().scalar<tstring>()() =
+          std::move(shuffled_records_.front());
+      shuffled_records_.pop_front();
+      ++element_count_;
+      static monitoring::CounterCell* bytes_counter =
+          metrics::GetTFDataBytesReadCounter(kDatasetType);
+      bytes_counter->IncrementBy(
+          out_tensors->back().scalar<tstring>()().size());
+      *end_of_sequence = false;
+      return absl::OkStatus();
+    }
+
     // Sets up reader streams to read from the file at `current_file_index_`.
     Status SetupStreamsLocked(Env* env) TF_EXCLUSIVE_LOCKS_REQUIRED(mu_) {
       if (current_file_index_ >= dataset()->filenames_.size()) {
@@ -285,6 +447,11 @@ class TFRecordDatasetOp::Dataset : public DatasetBase {
     // we must destroy `reader_` before `file_`.
     std::unique_ptr<RandomAccessFile> file_ TF_GUARDED_BY(mu_);
     std::unique_ptr<io::SequentialRecordReader> reader_ TF_GUARDED_BY(mu_);
+
+    // The number of elements produced when the dataset is globally shuffled,
+    // and the records of the elements that have been read ahead.
+    int64_t element_count_ TF_GUARDED_BY(mu_) = 0;
+    std::deque<tstring> shuffled_records_ TF_GUARDED_BY(mu_);
   };
 
   const std::vector<string> filenames_;
@@ -292,11 +459,58 @@ class TFRecordDatasetOp::Dataset : public DatasetBase {
   io::RecordReaderOptions options_;
   const std::vector<int64_t> byte_offsets_;
   const int op_version_;
+
+  // If all files have an index, the readers used for random access, and the
+  // number of records in the files before each file.
+  const std::vector<std::unique_ptr<RandomAccessTFRecordReader>>
+      random_access_readers_;
+  const absl::Status random_access_status_;
+  std::vector<int64_t> num_records_before_;
 };
 
+// Opens the files for random access if the "tfrecord_random_access"
+// experiment is enabled and every file has an index written with
+// `IndexedTFRecordWriter`. Otherwise, returns why the files cannot be read in
+// random order.
+absl::Status OpenRandomAccessReaders(
+    Env* env, const std::vector<string>& filenames,
+    const string& compression_type, const std::vector<int64_t>& byte_offsets,
+    std::vector<std::unique_ptr<RandomAccessTFRecordReader>>* readers) {
+  if (!GetExperiments().contains("tfrecord_random_access")) {
+    return absl::FailedPreconditionError(
+        "TFRecordDataset supports random access only when the "
+        "`tfrecord_random_access` experiment is enabled.");
+  }
+  if (!compression_type.empty() || !byte_offsets.empty()) {
+    return absl::FailedPreconditionError(
+        "TFRecordDataset supports random access only for uncompressed files "
+        "read from the beginning.");
+  }
+  for (const string& filename : filenames) {
+    absl::StatusOr<std::unique_ptr<RandomAccessTFRecordReader>> reader =
+        RandomAccessTFRecordReader::Create(env, TranslateFileName(filename));
+    if (!reader.ok()) {
+      return absl::FailedPreconditionError(absl::StrCat(
+          "TFRecordDataset supports random access only for files with an "
+          "index: ",
+          reader.status().ToString()));
+    }
+    readers->push_back(*std::move(reader));
+  }
+  return absl::OkStatus();
+}
+
 TFRecordDatasetOp::TFRecordDatasetOp(OpKernelConstruction* ctx)
     : DatasetOpKernel(ctx),
-      op_version_(ctx->def().op() == kTFRecordDataset ? 1 : 2) {}
+      op_version_(ctx->def().op() == kTFRecordDataset ? 1 : 2) {
+  if (ctx->HasAttr(kPayloadChecksumInterval)) {
+    OP_REQUIRES_OK(ctx, ctx->GetAttr(kPayloadChecksumInterval,
+                                     &payload_checksum_interval_));
+  }
+  OP_REQUIRES(ctx, payload_checksum_interval_ >= 0,
+              errors::InvalidArgument(
+                  "`payload_checksum_interval` must be >= 0 (0 == never)"));
+}
 
 void TFRecordDatasetOp::MakeDataset(OpKernelContext* ctx,
                                     DatasetBase** output) {
@@ -361,8 +575,21 @@ void TFRecordDatasetOp::MakeDataset(OpKernelContext* ctx,
     buffer_size = kS3BlockSize;
   }
 
+  std::vector<std::unique_ptr<RandomAccessTFRecordReader>>
+      random_access_readers;
+  absl::Status random_access_status =
+      OpenRandomAccessReaders(ctx->env(), filenames, compression_type,
+                              byte_offsets, &random_access_readers);
+  if (!random_access_status.ok()) {
+    VLOG(2) << "Reading TFRecord files sequentially: " << random_access_status;
+    random_access_readers.clear();
+  }
+
   *output = new Dataset(ctx, std::move(filenames), compression_type,
-                        buffer_size, std::move(byte_offsets), op_version_);
+                        buffer_size, std::move(byte_offsets),
+                        payload_checksum_interval_, op_version_,
+                        std::move(random_access_readers),
+                        std::move(random_access_status));
 }
 
 namespace {
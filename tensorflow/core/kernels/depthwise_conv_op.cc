@@ -36,6 +36,7 @@ limitations under the License.
 #include "tensorflow/core/platform/errors.h"
 #include "tensorflow/core/platform/logging.h"
 #include "tensorflow/core/platform/types.h"
+#include "tensorflow/core/util/env_var.h"
 #include "tensorflow/core/util/padding.h"
 #include "tensorflow/core/util/tensor_format.h"
 #include "tensorflow/core/util/use_cudnn.h"
@@ -154,16 +155,190 @@ struct DepthwiseConv2DKernel {
   }
 };
 
+// Computes the depthwise conv2d of 'input' by 'filter' for depth_multiplier
+// == 1 directly from the NHWC tensors, without padding the filter or copying
+// the input.
+//
+// The output is computed in tiles of output rows and columns, which is the
+// unit of work across the intra-op thread pool. Within a tile, the channels
+// are processed in blocks of 'kChannelBlock', so that the input window of the
+// tile stays in L1 cache across its output pixels, and each output pixel of a
+// block accumulates 'kBlockPackets' vector registers over the filter window.
+//
+// EX:
+//   in_depth = 2 * kChannelBlock + 3, kPacketSize = 4, kBlockPackets = 4
+//
+//   Channels [0, 16) and [16, 32) are computed with 4 accumulators each,
+//   channels [32, 35) are computed with scalar accumulators.
+template <typename T>
+struct DepthwiseConv2DDirectKernel {
+  typedef typename Eigen::internal::packet_traits<T>::type Packet;
+  static constexpr int64_t kPacketSize = sizeof(Packet) / sizeof(T);
+  static constexpr int kBlockPackets = 4;
+  static constexpr int64_t kChannelBlock = kBlockPackets * kPacketSize;
+
+  // Output rows and columns per unit of work.
+  static constexpr int64_t kTileRows = 4;
+  static constexpr int64_t kTileCols = 8;
+
+  // Returns true if the depthwise conv2d described by 'args' has enough
+  // channels for this kernel. It can be disabled by setting the environment
+  // variable TF_USE_DIRECT_DEPTHWISE_CONV2D to "0".
+  static bool CanUse(const DepthwiseArgs& args) {
+    if (args.depth_multiplier != 1 || args.in_depth < kChannelBlock) {
+      return false;
+    }
+    bool use_direct_kernel = true;
+    TF_CHECK_OK(ReadBoolFromEnvVar("TF_USE_DIRECT_DEPTHWISE_CONV2D",
+                                   /*default_val=*/true, &use_direct_kernel));
+    return use_direct_kernel;
+  }
+
+  static void Launch(OpKernelContext* ctx, const DepthwiseArgs& args,
+                     const T* input, const T* filter, T* output) {
+    const int64_t row_tiles = (args.out_rows + kTileRows - 1) / kTileRows;
+    const int64_t col_tiles = (args.out_cols + kTileCols - 1) / kTileCols;
+    const int64_t image_tiles = row_tiles * col_tiles;
+
+    auto shard = [&args, input, filter, output, col_tiles, image_tiles](
+                     int64_t start, int64_t limit) {
+      for (int64_t i = start; i < limit; ++i) {
+        const int64_t b = i / image_tiles;
+        const int64_t tile = i % image_tiles;
+        const int64_t row_begin = (tile / col_tiles) * kTileRows;
+        const int64_t col_begin = (tile % col_tiles) * kTileCols;
+        Run(args, b, row_begin,
+            std::min<int64_t>(row_begin + kTileRows, args.out_rows), col_begin,
+            std::min<int64_t>(col_begin + kTileCols, args.out_cols), input,
+            filter, output);
+      }
+    };
+
+    // One multiply-add per output element and filter tap.
+    const int64_t tile_cost = kTileRows * kTileCols * args.out_depth *
+                              args.filter_rows * args.filter_cols;
+
+    auto worker_threads = *(ctx->device()->tensorflow_cpu_worker_threads());
+    Shard(worker_threads.num_threads, worker_threads.workers,
+          args.batch * image_tiles, tile_cost, shard);
+  }
+
+ private:
+  // The filter taps [row_begin, row_end) x [col_begin, col_end) of an output
+  // pixel which fall inside the input, and the input position of tap (0, 0).
+  struct FilterWindow {
+    int64_t in_row;
+    int64_t in_col;
+    int64_t row_begin;
+    int64_t row_end;
+    int64_t col_begin;
+    int64_t col_end;
+  };
+
+  // Computes output rows [out_r_begin, out_r_end) and columns
+  // [out_c_begin, out_c_end) of image 'b'.
+  static void Run(const DepthwiseArgs& args, const int64_t b,
+                  const int64_t out_r_begin, const int64_t out_r_end,
+                  const int64_t out_c_begin, const int64_t out_c_end,
+                  const T* input, const T* filter, T* output) {
+    const int64_t depth = args.in_depth;
+    const T* image = input + b * args.in_rows * args.in_cols * depth;
+    T* out_image = output + b * args.out_rows * args.out_cols * depth;
+
+    for (int64_t d = 0; d < depth; d += kChannelBlock) {
+      const int64_t block_size = std::min(kChannelBlock, depth - d);
+      for (int64_t out_r = out_r_begin; out_r < out_r_end; ++out_r) {
+        FilterWindow window;
+        window.in_row = out_r * args.stride - args.pad_rows;
+        window.row_begin = std::max<int64_t>(0, -window.in_row);
+        window.row_end =
+            std::min<int64_t>(args.filter_rows, args.in_rows - window.in_row);
+        for (int64_t out_c = out_c_begin; out_c < out_c_end; ++out_c) {
+          window.in_col = out_c * args.stride - args.pad_cols;
+          window.col_begin = std::max<int64_t>(0, -window.in_col);
+          window.col_end =
+              std::min<int64_t>(args.filter_cols, args.in_cols - window.in_col);
+
+          T* out = out_image + (out_r * args.out_cols + out_c) * depth + d;
+          if (block_size == kChannelBlock) {
+            ComputePackets<kBlockPackets>(args, window, image + d, filter + d,
+                                          out);
+            continue;
+          }
+          int64_t offset = 0;
+          for (; offset + kPacketSize <= block_size; offset += kPacketSize) {
+            ComputePackets<1>(args, window, image + d + offset,
+                              filter + d + offset, out + offset);
+          }
+          ComputeScalars(args, window, block_size - offset, image + d + offset,
+                         filter + d + offset, out + offset);
+        }
+      }
+    }
+  }
+
+  // Computes 'kNumPackets' packets of channels of one output pixel. 'input'
+  // and 'filter' point to the first channel in the image and the filter.
+  template <int kNumPackets>
+  static void ComputePackets(const DepthwiseArgs& args,
+                             const FilterWindow& window, const T* input,
+                             const T* filter, T* output) {
+    Packet vaccum[kNumPackets];
+    for (int p = 0; p < kNumPackets; ++p) {
+      vaccum[p] = Eigen::internal::pset1<Packet>(static_cast<T>(0));
+    }
+    for (int64_t f_r = window.row_begin; f_r < window.row_end; ++f_r) {
+      const T* in_row =
+          input + (window.in_row + f_r) * args.in_cols * args.in_depth;
+      const T* filter_row = filter + f_r * args.filter_cols * args.in_depth;
+      for (int64_t f_c = window.col_begin; f_c < window.col_end; ++f_c) {
+        const T* in = in_row + (window.in_col + f_c) * args.in_depth;
+        const T* f = filter_row + f_c * args.in_depth;
+        for (int p = 0; p < kNumPackets; ++p) {
+          const auto filter_block =
+              Eigen::internal::ploadu<Packet>(f + p * kPacketSize);
+          const auto data_block =
+              Eigen::internal::ploadu<Packet>(in + p * kPacketSize);
+          vaccum[p] = Eigen::internal::pmadd<Packet>(filter_block, data_block,
+                                                     vaccum[p]);
+        }
+      }
+    }
+    for (int p = 0; p < kNumPackets; ++p) {
+      Eigen::internal::pstoreu<T>(output + p * kPacketSize, vaccum[p]);
+    }
+  }
+
+  // Computes the 'size' channels of one output pixel left after the packets.
+  static void ComputeScalars(const DepthwiseArgs& args,
+                             const FilterWindow& window, const int64_t size,
+                             const T* input, const T* filter, T* output) {
+    for (int64_t i = 0; i < size; ++i) {
+      T accum = static_cast<T>(0);
+      for (int64_t f_r = window.row_begin; f_r < window.row_end; ++f_r) {
+        for (int64_t f_c = window.col_begin; f_c < window.col_end; ++f_c) {
+          const int64_t in_index =
+              ((window.in_row + f_r) * args.in_cols + window.in_col + f_c) *
+              args.in_depth;
+          const int64_t filter_index =
+              (f_r * args.filter_cols + f_c) * args.in_depth;
+          accum += filter[filter_index + i] * input[in_index + i];
+        }
+      }
+      output[i] = accum;
+    }
+  }
+};
+
 // Computes the depthwise conv2d of 'input' by 'depthwise_filter' and stores
 // the result in 'output'. This implementation trades off copying small patches
 // of the input to achieve better data alignment, which enables vectorized
 // load/store and multiply-add operations (see comments at InputBufferCopyOp and
-// DepthwiseConv2DKernel for details).
+// DepthwiseConv2DKernel for details). Convolutions with depth_multiplier == 1
+// and enough channels are computed by DepthwiseConv2DDirectKernel instead.
 //
 // TODO(andydavis) Evaluate the performance of processing multiple input
 // patches in the inner loop.
-// TODO(andydavis) Consider a zero-copy implementation for the case when
-// 'in_depth' is a multiple of register width, and 'depth_multipler' is one.
 // TODO(andydavis) Evaluate the performance of alternative implementations.
 template <typename T>
 struct LaunchDepthwiseConvOp<CPUDevice, T> {
@@ -176,6 +351,11 @@ struct LaunchDepthwiseConvOp<CPUDevice, T> {
         ctx, data_format == FORMAT_NHWC,
         errors::Unimplemented(
             "Depthwise convolution on CPU is only supported for NHWC format"));
+    if (DepthwiseConv2DDirectKernel<T>::CanUse(args)) {
+      DepthwiseConv2DDirectKernel<T>::Launch(ctx, args, input,
+                                             depthwise_filter, output);
+      return;
+    }
     static const int64_t kPacketSize = (sizeof(Packet) / sizeof(T));
 
     // Pad 'depthwise_filter' to vector register width (if needed).
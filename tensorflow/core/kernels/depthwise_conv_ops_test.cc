@@ -22,15 +22,23 @@ limitations under the License.
 #include "tensorflow/core/framework/fake_input.h"
 #include "tensorflow/core/framework/node_def_builder.h"
 #include "tensorflow/core/framework/tensor.h"
+#include "tensorflow/core/framework/tensor_testutil.h"
 #include "tensorflow/core/framework/types.h"
+#include "tensorflow/core/graph/node_builder.h"
 #include "tensorflow/core/kernels/conv_ops_gpu.h"
 #include "tensorflow/core/kernels/ops_testutil.h"
 #include "tensorflow/core/kernels/ops_util.h"
 #include "tensorflow/core/lib/core/status_test_util.h"
+#include "tensorflow/core/lib/strings/strcat.h"
 #include "tensorflow/core/platform/test.h"
 #include "tensorflow/core/platform/test_benchmark.h"
 #include "tensorflow/core/public/session.h"
 
+#ifdef INTEL_MKL
+#include "tensorflow/core/common_runtime/mkl_layout_pass.h"
+#include "tensorflow/core/graph/mkl_graph_util.h"
+#endif  // INTEL_MKL
+
 namespace tensorflow {
 namespace {
 class DepthwiseConvOpTest : public OpsTestBase {
@@ -109,6 +117,52 @@ TEST_F(DepthwiseConvOpTest, DepthwiseConvHalfCpu) {
   Run<Eigen::half>(Device::CPU);
 }
 
+// Runs the depthwise conv2d of 'image' by 'filter' on CPU, with the direct
+// kernel for large channel counts enabled or not.
+Tensor RunDepthwiseConvOnCpu(const Tensor& image, const Tensor& filter,
+                             int stride, const string& padding,
+                             bool use_direct_kernel) {
+  setenv("TF_USE_DIRECT_DEPTHWISE_CONV2D", use_direct_kernel ? "1" : "0",
+         1 /* overwrite */);
+  Scope root = Scope::NewRootScope();
+  auto conv = ops::DepthwiseConv2dNative(root, ops::Const(root, image),
+                                         ops::Const(root, filter),
+                                         {1, stride, stride, 1}, padding);
+  GraphDef graph;
+  TF_CHECK_OK(root.ToGraphDef(&graph));
+  std::unique_ptr<Session> session(NewSession(SessionOptions()));
+  TF_CHECK_OK(session->Create(graph));
+  std::vector<Tensor> outputs;
+  TF_CHECK_OK(session->Run({}, {conv.output.name()}, {}, &outputs));
+  unsetenv("TF_USE_DIRECT_DEPTHWISE_CONV2D");
+  return outputs[0];
+}
+
+TEST(DepthwiseConvDirectKernelTest, MatchesTheBufferedKernel) {
+  // 67 channels cover the channel blocks, the packets and the scalars left.
+  const int depth = 67;
+  Tensor image(DT_FLOAT, {2, 9, 13, depth});
+  image.flat<float>().setRandom();
+  for (int filter_size : {3, 5}) {
+    Tensor filter(DT_FLOAT, {filter_size, filter_size, depth, 1});
+    filter.flat<float>().setRandom();
+    for (int stride : {1, 2}) {
+      for (const char* padding : {"SAME", "VALID"}) {
+        SCOPED_TRACE(strings::StrCat("filter_size = ", filter_size,
+                                     ", stride = ", stride,
+                                     ", padding = ", padding));
+        const Tensor expected =
+            RunDepthwiseConvOnCpu(image, filter, stride, padding,
+                                  /*use_direct_kernel=*/false);
+        const Tensor output =
+            RunDepthwiseConvOnCpu(image, filter, stride, padding,
+                                  /*use_direct_kernel=*/true);
+        test::ExpectTensorNear<float>(expected, output, 1e-5);
+      }
+    }
+  }
+}
+
 #if GOOGLE_CUDA || TENSORFLOW_USE_ROCM
 TEST_F(DepthwiseConvOpTest, DepthwiseConvFloatGpu) { Run<float>(Device::GPU); }
 TEST_F(DepthwiseConvOpTest, DepthwiseConvDoubleGpu) {
@@ -120,4 +174,115 @@ TEST_F(DepthwiseConvOpTest, DepthwiseConvHalfGpu) {
 #endif
 
 }  // namespace
+
+////////////////////////////////////////////////////////////////////////////////
+// Performance benchmarks for the CPU kernels of DepthwiseConv2dNative.      //
+////////////////////////////////////////////////////////////////////////////////
+
+enum class DepthwiseConvCpuKernel { kDirect, kBuffered, kOneDnn };
+
+// Creates a graph with a single DepthwiseConv2dNative node with 'SAME'
+// padding, rewritten to the oneDNN op for 'kOneDnn'.
+static Graph* DepthwiseConv2D(int batch, int rows, int cols, int depth,
+                              int filter_size, int stride,
+                              DepthwiseConvCpuKernel kernel) {
+  Graph* graph = new Graph(OpRegistry::Global());
+
+  Tensor images_t(DT_FLOAT, {batch, rows, cols, depth});
+  images_t.flat<float>().setRandom();
+  Tensor filter_t(DT_FLOAT, {filter_size, filter_size, depth, 1});
+  filter_t.flat<float>().setRandom();
+
+  Node* images = test::graph::Constant(graph, images_t, "images");
+  Node* filter = test::graph::Constant(graph, filter_t, "filter");
+  Node* conv;
+  TF_CHECK_OK(NodeBuilder(graph->NewName("depthwise_conv2d"),
+                          "DepthwiseConv2dNative")
+                  .Input(images)
+                  .Input(filter)
+                  .Attr("T", DT_FLOAT)
+                  .Attr("strides", {1, stride, stride, 1})
+                  .Attr("padding", "SAME")
+                  .Finalize(graph, &conv));
+
+#ifdef INTEL_MKL
+  if (kernel == DepthwiseConvCpuKernel::kOneDnn) {
+    std::unique_ptr<Graph> rewritten(graph);
+    RunMklLayoutRewritePass(&rewritten);
+    graph = rewritten.release();
+  }
+#endif  // INTEL_MKL
+
+  return graph;
+}
+
+static void BM_DepthwiseConv2D(::testing::benchmark::State& state, int batch,
+                               int rows, int cols, int depth, int filter_size,
+                               int stride, DepthwiseConvCpuKernel kernel,
+                               const string& label) {
+#ifdef INTEL_MKL
+  const bool onednn_enabled = IsMKLEnabled();
+#else
+  const bool onednn_enabled = false;
+#endif  // INTEL_MKL
+  if (kernel == DepthwiseConvCpuKernel::kOneDnn && !onednn_enabled) {
+    state.SkipWithError(
+        strings::StrCat("Skipping oneDNN benchmark (no oneDNN): ", label)
+            .c_str());
+    return;
+  }
+  state.SetLabel(label);
+
+  setenv("TF_USE_DIRECT_DEPTHWISE_CONV2D",
+         kernel == DepthwiseConvCpuKernel::kBuffered ? "0" : "1",
+         1 /* overwrite */);
+  test::Benchmark("cpu",
+                  DepthwiseConv2D(batch, rows, cols, depth, filter_size,
+                                  stride, kernel),
+                  /*old_benchmark_api=*/false)
+      .Run(state);
+  unsetenv("TF_USE_DIRECT_DEPTHWISE_CONV2D");
+
+  const int64_t out_rows = (rows + stride - 1) / stride;
+  const int64_t out_cols = (cols + stride - 1) / stride;
+  // We multiply by two since there are multiplications and additions.
+  const int64_t num_ops =
+      2 * batch * out_rows * out_cols * filter_size * filter_size * depth;
+  state.SetItemsProcessed(num_ops * state.iterations());
+}
+
+// BS: batch_size
+// R: tensor_in_rows
+// C: tensor_in_cols
+// D: depth
+// K: kernel_rows and kernel_cols
+// S: stride
+
+#define BM_NAME(KERNEL, BS, R, C, D, K, S)                         \
+  BM_DepthwiseConv2D_##KERNEL##_##BS##_##R##_##C##_##D##_##K##_##S
+
+#define BM_DepthwiseConv2DKernel(BS, R, C, D, K, S, KERNEL)                \
+  static void BM_NAME(KERNEL, BS, R, C, D, K,                              \
+                      S)(::testing::benchmark::State & state) {            \
+    BM_DepthwiseConv2D(state, BS, R, C, D, K, S,                           \
+                       DepthwiseConvCpuKernel::k##KERNEL,                  \
+                       strings::StrCat(BS, "_", R, "_", C, "_", D, "_", K, \
+                                       "_", S, "_", #KERNEL));             \
+  }                                                                        \
+  BENCHMARK(BM_NAME(KERNEL, BS, R, C, D, K, S))->UseRealTime();
+
+#define BM_DepthwiseConv2DAllKernels(BS, R, C, D, K, S)  \
+  BM_DepthwiseConv2DKernel(BS, R, C, D, K, S, Direct);   \
+  BM_DepthwiseConv2DKernel(BS, R, C, D, K, S, Buffered); \
+  BM_DepthwiseConv2DKernel(BS, R, C, D, K, S, OneDnn);
+
+// The configurations below are from mobilenet v2 and efficientnet models.
+BM_DepthwiseConv2DAllKernels(1, 112, 112, 96, 3, 2);
+BM_DepthwiseConv2DAllKernels(1, 56, 56, 144, 3, 1);
+BM_DepthwiseConv2DAllKernels(1, 28, 28, 240, 5, 1);
+BM_DepthwiseConv2DAllKernels(1, 14, 14, 672, 5, 1);
+BM_DepthwiseConv2DAllKernels(1, 7, 7, 1152, 5, 1);
+BM_DepthwiseConv2DAllKernels(32, 56, 56, 144, 3, 1);
+BM_DepthwiseConv2DAllKernels(32, 14, 14, 672, 5, 1);
+
 }  // namespace tensorflow
@@ -28,6 +28,8 @@ limitations under the License.
 #include "tensorflow/core/graph/graph.h"
 #include "tensorflow/core/graph/node_builder.h"
 #include "tensorflow/core/lib/core/status_test_util.h"
+#include "tensorflow/core/lib/random/philox_random.h"
+#include "tensorflow/core/lib/random/simple_philox.h"
 #include "tensorflow/core/lib/strings/stringprintf.h"
 #include "tensorflow/core/platform/test.h"
 #include "tensorflow/core/platform/test_benchmark.h"
@@ -66,6 +68,36 @@ class Int64Filler {
   DataType dtype = DT_INT64;
 };
 
+// Fills int64 lists with values distributed like the features of ranking
+// models: mostly small categorical values and counts, with some hashed ids of
+// 32 and 64 bits, which take 5 and 10 bytes to encode.
+class RankingInt64Filler {
+ public:
+  RankingInt64Filler() {}
+  void operator()(Feature* f, int feature_size) const {
+    random::PhiloxRandom philox(feature_size, 1729);
+    random::SimplePhilox rng(&philox);
+    for (int i = 0; i < feature_size; ++i) {
+      const uint32 bucket = rng.Uniform(10);
+      int64_t value;
+      if (bucket < 5) {
+        value = rng.Uniform(128);
+      } else if (bucket < 8) {
+        value = rng.Uniform(1 << 21);
+      } else if (bucket < 9) {
+        value = rng.Rand32();
+      } else {
+        value = static_cast<int64_t>(rng.Rand64());
+      }
+      f->mutable_int64_list()->add_value(value);
+    }
+  }
+  Tensor make_dense_default(int feature_size) {
+    return Tensor(dtype, TensorShape({feature_size}));
+  }
+  DataType dtype = DT_INT64;
+};
+
 class FloatFiller {
  public:
   FloatFiller() {}
@@ -140,6 +172,7 @@ absl::once_flag ExampleStore<T>::flags_init;
 template struct ExampleStore<BytesFiller>;
 template struct ExampleStore<Int64Filler>;
 template struct ExampleStore<FloatFiller>;
+template struct ExampleStore<RankingInt64Filler>;
 
 enum BenchmarkType { kDense, kSparse, kVarLenDense, kRagged };
 
@@ -345,6 +378,12 @@ typedef BenchmarkOptions<ExampleStore<FloatFiller>, kDense> DenseFloat;
 typedef BenchmarkOptions<ExampleStore<FloatFiller>, kVarLenDense>
     VarLenDenseFloat;
 typedef BenchmarkOptions<ExampleStore<FloatFiller>, kRagged> RaggedFloat;
+typedef BenchmarkOptions<ExampleStore<RankingInt64Filler>, kSparse>
+    SparseRankingInt64;
+typedef BenchmarkOptions<ExampleStore<RankingInt64Filler>, kVarLenDense>
+    VarLenDenseRankingInt64;
+typedef BenchmarkOptions<ExampleStore<RankingInt64Filler>, kRagged>
+    RaggedRankingInt64;
 
 // B == batch_size, K == num_keys. F == feature_size.
 // K must be one of 10, 100, 1000
@@ -436,6 +475,9 @@ BM_AllParseExampleV2(SparseFloat);
 BM_AllParseExampleV2(DenseFloat);
 BM_AllParseExampleV2(VarLenDenseFloat);
 BM_AllParseExampleV2(RaggedFloat);
+BM_AllParseExampleV2(SparseRankingInt64);
+BM_AllParseExampleV2(VarLenDenseRankingInt64);
+BM_AllParseExampleV2(RaggedRankingInt64);
 
 // K == num_keys. F == feature_size.
 // K must be one of 10, 100, 1000
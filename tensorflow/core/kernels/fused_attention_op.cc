@@ -0,0 +1,294 @@
+/* Copyright 2024 The TensorFlow Authors. All Rights Reserved.
+
+Licensed under the Apache License, Version 2.0 (the "License");
+you may not use this file except in compliance with the License.
+You may obtain a copy of the License at
+
+    http://www.apache.org/licenses/LICENSE-2.0
+
+Unless required by applicable law or agreed to in writing, software
+distributed under the License is distributed on an "AS IS" BASIS,
+WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+See the License for the specific language governing permissions and
+limitations under the License.
+==============================================================================*/
+// See docs in ../ops/nn_ops.cc.
+
+#include <algorithm>
+#include <cmath>
+#include <limits>
+#include <vector>
+
+#include "Eigen/Core"  // from @eigen_archive
+#include "tensorflow/core/framework/op_kernel.h"
+#include "tensorflow/core/framework/register_types.h"
+#include "tensorflow/core/framework/tensor.h"
+#include "tensorflow/core/framework/tensor_shape.h"
+#include "tensorflow/core/framework/types.h"
+#include "tensorflow/core/platform/errors.h"
+#include "tensorflow/core/util/work_sharder.h"
+
+namespace tensorflow {
+
+// Computes Softmax(query @ key * scale + mask) @ value one block of query rows
+// at a time. The scores of a block of rows are computed for one tile of keys
+// at a time and folded into the output with an online softmax: each row keeps
+// the maximum score and the sum of exponentials seen so far, and the partial
+// output is rescaled whenever the maximum grows. Only a block x tile matrix of
+// scores is ever live, instead of the full [M, N] matrix.
+template <typename T>
+class FusedScaledDotProductAttentionOp : public OpKernel {
+ public:
+  explicit FusedScaledDotProductAttentionOp(OpKernelConstruction* context)
+      : OpKernel(context) {
+    OP_REQUIRES_OK(context, context->GetAttr("adj_key", &adj_key_));
+    int num_args;
+    OP_REQUIRES_OK(context, context->GetAttr("num_args", &num_args));
+    OP_REQUIRES(context, num_args <= 1,
+                errors::InvalidArgument(
+                    "_FusedScaledDotProductAttention supports at most one "
+                    "mask, got num_args=",
+                    num_args));
+  }
+
+  void Compute(OpKernelContext* context) override {
+    const Tensor& query = context->input(0);
+    const Tensor& key = context->input(1);
+    const Tensor& value = context->input(2);
+    const Tensor& scale = context->input(3);
+
+    const int rank = query.dims();
+    OP_REQUIRES(context, rank >= 3,
+                errors::InvalidArgument("query must be at least rank 3: ",
+                                        query.shape().DebugString()));
+    OP_REQUIRES(context, key.dims() == rank && value.dims() == rank,
+                errors::InvalidArgument(
+                    "query, key and value must have the same rank: ",
+                    query.shape().DebugString(), " vs. ",
+                    key.shape().DebugString(), " vs. ",
+                    value.shape().DebugString()));
+    for (int i = 0; i < rank - 2; ++i) {
+      OP_REQUIRES(context,
+                  key.dim_size(i) == query.dim_size(i) &&
+                      value.dim_size(i) == query.dim_size(i),
+                  errors::InvalidArgument(
+                      "query, key and value must have the same batch "
+                      "dimensions: ",
+                      query.shape().DebugString(), " vs. ",
+                      key.shape().DebugString(), " vs. ",
+                      value.shape().DebugString()));
+    }
+    OP_REQUIRES(context, scale.NumElements() == 1,
+                errors::InvalidArgument("scale must have one element: ",
+                                        scale.shape().DebugString()));
+
+    const int64_t num_rows = query.dim_size(rank - 2);
+    const int64_t depth = query.dim_size(rank - 1);
+    const int64_t num_keys = key.dim_size(adj_key_ ? rank - 2 : rank - 1);
+    const int64_t value_depth = value.dim_size(rank - 1);
+    OP_REQUIRES(context,
+                key.dim_size(adj_key_ ? rank - 1 : rank - 2) == depth,
+                errors::InvalidArgument(
+                    "query and key must have the same depth: ",
+                    query.shape().DebugString(), " vs. ",
+                    key.shape().DebugString()));
+    OP_REQUIRES(context, value.dim_size(rank - 2) == num_keys,
+                errors::InvalidArgument(
+                    "key and value must have the same number of keys: ",
+                    key.shape().DebugString(), " vs. ",
+                    value.shape().DebugString()));
+
+    TensorShape output_shape = query.shape();
+    output_shape.set_dim(rank - 1, value_depth);
+    Tensor* output = nullptr;
+    OP_REQUIRES_OK(context, context->allocate_output(0, output_shape, &output));
+    if (output->NumElements() == 0) return;
+    if (num_keys == 0) {
+      // The softmax of no scores selects no values.
+      output->flat<T>().setZero();
+      return;
+    }
+
+    // The scores have shape [batch..., num_rows, num_keys]. The mask is
+    // broadcast to it, so its strides along broadcast dimensions are zero.
+    const T* mask = nullptr;
+    std::vector<int64_t> mask_strides(rank, 0);
+    if (context->num_inputs() > 4) {
+      const Tensor& mask_tensor = context->input(4);
+      OP_REQUIRES(context, mask_tensor.dims() <= rank,
+                  errors::InvalidArgument(
+                      "mask must not have a larger rank than the scores: ",
+                      mask_tensor.shape().DebugString()));
+      int64_t stride = 1;
+      for (int i = mask_tensor.dims() - 1, j = rank - 1; i >= 0; --i, --j) {
+        const int64_t scores_dim =
+            j == rank - 1 ? num_keys
+                          : (j == rank - 2 ? num_rows : query.dim_size(j));
+        const int64_t mask_dim = mask_tensor.dim_size(i);
+        OP_REQUIRES(context, mask_dim == 1 || mask_dim == scores_dim,
+                    errors::InvalidArgument(
+                        "mask ", mask_tensor.shape().DebugString(),
+                        " is not broadcastable to the scores"));
+        if (mask_dim != 1) mask_strides[j] = stride;
+        stride *= mask_dim;
+      }
+      mask = mask_tensor.flat<T>().data();
+    }
+
+    const int64_t batch_size = query.NumElements() / (num_rows * depth);
+    // Offsets of the mask of each batch.
+    std::vector<int64_t> mask_offsets(mask != nullptr ? batch_size : 0);
+    for (int64_t b = 0; b < mask_offsets.size(); ++b) {
+      int64_t remainder = b;
+      int64_t offset = 0;
+      for (int i = rank - 3; i >= 0; --i) {
+        offset += (remainder % query.dim_size(i)) * mask_strides[i];
+        remainder /= query.dim_size(i);
+      }
+      mask_offsets[b] = offset;
+    }
+
+    Params params;
+    params.query = query.flat<T>().data();
+    params.key = key.flat<T>().data();
+    params.value = value.flat<T>().data();
+    params.mask = mask;
+    params.output = output->flat<T>().data();
+    params.scale = scale.flat<T>()(0);
+    params.num_rows = num_rows;
+    params.depth = depth;
+    params.num_keys = num_keys;
+    params.value_depth = value_depth;
+    params.mask_row_stride = mask_strides[rank - 2];
+    params.mask_key_stride = mask_strides[rank - 1];
+    params.mask_offsets = mask_offsets.data();
+
+    const int64_t blocks_per_batch = (num_rows + kRowBlock - 1) / kRowBlock;
+    const auto work = [&](int64_t begin, int64_t end) {
+      Matrix scores(kRowBlock, kKeyTile);
+      Matrix accumulator(kRowBlock, value_depth);
+      std::vector<T> max_scores(kRowBlock);
+      std::vector<T> sums(kRowBlock);
+      for (int64_t i = begin; i < end; ++i) {
+        ComputeBlock(params, i / blocks_per_batch,
+                     (i % blocks_per_batch) * kRowBlock, &scores, &accumulator,
+                     max_scores.data(), sums.data());
+      }
+    };
+    const int64_t cost_per_block =
+        kRowBlock * num_keys * (depth + value_depth) * 2;
+    const auto& worker_threads =
+        *(context->device()->tensorflow_cpu_worker_threads());
+    Shard(worker_threads.num_threads, worker_threads.workers,
+          batch_size * blocks_per_batch, cost_per_block, work);
+  }
+
+ private:
+  // The number of query rows and keys of a tile of scores.
+  static constexpr int64_t kRowBlock = 32;
+  static constexpr int64_t kKeyTile = 128;
+
+  using Matrix = Eigen::Matrix<T, Eigen::Dynamic, Eigen::Dynamic,
+                               Eigen::RowMajor>;
+  using ConstMatrixMap =
+      Eigen::Map<const Matrix, Eigen::Unaligned, Eigen::OuterStride<>>;
+  using MatrixMap = Eigen::Map<Matrix, Eigen::Unaligned, Eigen::OuterStride<>>;
+
+  struct Params {
+    const T* query;
+    const T* key;
+    const T* value;
+    const T* mask;
+    T* output;
+    T scale;
+    int64_t num_rows;
+    int64_t depth;
+    int64_t num_keys;
+    int64_t value_depth;
+    int64_t mask_row_stride;
+    int64_t mask_key_stride;
+    const int64_t* mask_offsets;
+  };
+
+  // Computes the output rows [row_begin, row_begin + kRowBlock) of `batch`.
+  void ComputeBlock(const Params& p, int64_t batch, int64_t row_begin,
+                    Matrix* scores, Matrix* accumulator, T* max_scores,
+                    T* sums) const {
+    const int64_t rows = std::min(kRowBlock, p.num_rows - row_begin);
+    const ConstMatrixMap query(
+        p.query + (batch * p.num_rows + row_begin) * p.depth, rows, p.depth,
+        Eigen::OuterStride<>(p.depth));
+    const T* key = p.key + batch * p.num_keys * p.depth;
+    const T* value = p.value + batch * p.num_keys * p.value_depth;
+
+    std::fill(max_scores, max_scores + rows,
+              -std::numeric_limits<T>::infinity());
+    std::fill(sums, sums + rows, T(0));
+    accumulator->topRows(rows).setZero();
+
+    for (int64_t key_begin = 0; key_begin < p.num_keys;
+         key_begin += kKeyTile) {
+      const int64_t keys = std::min(kKeyTile, p.num_keys - key_begin);
+      auto tile = scores->topLeftCorner(rows, keys);
+      if (adj_key_) {
+        const ConstMatrixMap key_tile(key + key_begin * p.depth, keys,
+                                      p.depth, Eigen::OuterStride<>(p.depth));
+        tile.noalias() = query * key_tile.transpose();
+      } else {
+        const ConstMatrixMap key_tile(key + key_begin, p.depth, keys,
+                                      Eigen::OuterStride<>(p.num_keys));
+        tile.noalias() = query * key_tile;
+      }
+      tile *= p.scale;
+
+      for (int64_t r = 0; r < rows; ++r) {
+        auto row = tile.row(r);
+        if (p.mask != nullptr) {
+          const T* mask = p.mask + p.mask_offsets[batch] +
+                          (row_begin + r) * p.mask_row_stride +
+                          key_begin * p.mask_key_stride;
+          for (int64_t k = 0; k < keys; ++k) {
+            row(k) += mask[k * p.mask_key_stride];
+          }
+        }
+        const T max_score = std::max(max_scores[r], row.maxCoeff());
+        if (max_score == -std::numeric_limits<T>::infinity()) {
+          // All scores so far are masked out.
+          row.setZero();
+          continue;
+        }
+        row = (row.array() - max_score).exp().matrix();
+        const T correction = std::exp(max_scores[r] - max_score);
+        sums[r] = sums[r] * correction + row.sum();
+        accumulator->row(r) *= correction;
+        max_scores[r] = max_score;
+      }
+
+      const ConstMatrixMap value_tile(value + key_begin * p.value_depth, keys,
+                                      p.value_depth,
+                                      Eigen::OuterStride<>(p.value_depth));
+      accumulator->topRows(rows).noalias() += tile * value_tile;
+    }
+
+    MatrixMap output(p.output + (batch * p.num_rows + row_begin) *
+                                    p.value_depth,
+                     rows, p.value_depth, Eigen::OuterStride<>(p.value_depth));
+    for (int64_t r = 0; r < rows; ++r) {
+      // Rows whose scores are all masked out are NaN, as with Softmax.
+      output.row(r) = accumulator->row(r) / sums[r];
+    }
+  }
+
+  bool adj_key_;
+};
+
+#define REGISTER_CPU(T)                                         \
+  REGISTER_KERNEL_BUILDER(Name("_FusedScaledDotProductAttention") \
+                              .Device(DEVICE_CPU)               \
+                              .TypeConstraint<T>("T"),          \
+                          FusedScaledDotProductAttentionOp<T>);
+
+TF_CALL_float(REGISTER_CPU);
+#undef REGISTER_CPU
+
+}  // namespace tensorflow
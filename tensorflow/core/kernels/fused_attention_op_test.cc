@@ -0,0 +1,179 @@
+/* Copyright 2024 The TensorFlow Authors. All Rights Reserved.
+
+Licensed under the Apache License, Version 2.0 (the "License");
+you may not use this file except in compliance with the License.
+You may obtain a copy of the License at
+
+    http://www.apache.org/licenses/LICENSE-2.0
+
+Unless required by applicable law or agreed to in writing, software
+distributed under the License is distributed on an "AS IS" BASIS,
+WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+See the License for the specific language governing permissions and
+limitations under the License.
+==============================================================================*/
+#include <algorithm>
+#include <cmath>
+#include <limits>
+#include <vector>
+
+#include "tensorflow/core/framework/fake_input.h"
+#include "tensorflow/core/framework/node_def_builder.h"
+#include "tensorflow/core/framework/tensor.h"
+#include "tensorflow/core/framework/tensor_shape.h"
+#include "tensorflow/core/framework/tensor_testutil.h"
+#include "tensorflow/core/kernels/ops_testutil.h"
+#include "tensorflow/core/lib/core/status_test_util.h"
+#include "tensorflow/core/platform/test.h"
+
+namespace tensorflow {
+namespace {
+
+class FusedScaledDotProductAttentionOpTest : public OpsTestBase {
+ protected:
+  // Runs the fused op on [batch, heads, rows, depth] queries and compares it
+  // with Softmax(BatchMatMul(query, key) * scale + mask) @ value.
+  void RunTest(int64_t batch, int64_t heads, int64_t rows, int64_t keys,
+               int64_t depth, int64_t value_depth, bool adj_key,
+               const TensorShape& mask_shape, bool with_mask) {
+    const TensorShape key_shape =
+        adj_key ? TensorShape({batch, heads, keys, depth})
+                : TensorShape({batch, heads, depth, keys});
+    Tensor query(DT_FLOAT, TensorShape({batch, heads, rows, depth}));
+    Tensor key(DT_FLOAT, key_shape);
+    Tensor value(DT_FLOAT, TensorShape({batch, heads, keys, value_depth}));
+    query.flat<float>().setRandom();
+    key.flat<float>().setRandom();
+    value.flat<float>().setRandom();
+    const float scale = 1.0f / std::sqrt(static_cast<float>(depth));
+    Tensor mask(DT_FLOAT, mask_shape);
+    if (with_mask) {
+      // Masks out every third key, as a padding mask would.
+      auto mask_flat = mask.flat<float>();
+      for (int64_t i = 0; i < mask_flat.size(); ++i) {
+        mask_flat(i) = (i % mask_shape.dim_size(mask_shape.dims() - 1)) % 3 == 0
+                           ? -1e9f
+                           : 0.0f;
+      }
+    }
+
+    TF_ASSERT_OK(NodeDefBuilder("attention", "_FusedScaledDotProductAttention")
+                     .Input(FakeInput(DT_FLOAT))
+                     .Input(FakeInput(DT_FLOAT))
+                     .Input(FakeInput(DT_FLOAT))
+                     .Input(FakeInput(DT_FLOAT))
+                     .Input(FakeInput(with_mask ? 1 : 0, DT_FLOAT))
+                     .Attr("adj_key", adj_key)
+                     .Attr("num_args", with_mask ? 1 : 0)
+                     .Finalize(node_def()));
+    TF_ASSERT_OK(InitOp());
+    AddInputFromArray<float>(query.shape(), query.flat<float>());
+    AddInputFromArray<float>(key.shape(), key.flat<float>());
+    AddInputFromArray<float>(value.shape(), value.flat<float>());
+    AddInputFromArray<float>(TensorShape({}), {scale});
+    if (with_mask) AddInputFromArray<float>(mask.shape(), mask.flat<float>());
+    TF_ASSERT_OK(RunOpKernel());
+
+    Tensor expected(DT_FLOAT, TensorShape({batch, heads, rows, value_depth}));
+    auto q = query.tensor<float, 4>();
+    auto k = key.tensor<float, 4>();
+    auto v = value.tensor<float, 4>();
+    auto out = expected.tensor<float, 4>();
+    // Index of the mask element for scores element [b, h, i, j].
+    const auto mask_value = [&](int64_t b, int64_t h, int64_t i, int64_t j) {
+      const int64_t index[] = {b, h, i, j};
+      const int offset = 4 - mask_shape.dims();
+      int64_t flat_index = 0;
+      for (int d = 0; d < mask_shape.dims(); ++d) {
+        const int64_t dim = mask_shape.dim_size(d);
+        flat_index = flat_index * dim + (dim == 1 ? 0 : index[offset + d]);
+      }
+      return mask.flat<float>()(flat_index);
+    };
+    std::vector<float> scores(keys);
+    for (int64_t b = 0; b < batch; ++b) {
+      for (int64_t h = 0; h < heads; ++h) {
+        for (int64_t i = 0; i < rows; ++i) {
+          float max_score = -std::numeric_limits<float>::infinity();
+          for (int64_t j = 0; j < keys; ++j) {
+            float score = 0;
+            for (int64_t d = 0; d < depth; ++d) {
+              const float key_value = adj_key ? k(b, h, j, d) : k(b, h, d, j);
+              score += q(b, h, i, d) * key_value;
+            }
+            score *= scale;
+            if (with_mask) score += mask_value(b, h, i, j);
+            scores[j] = score;
+            max_score = std::max(max_score, score);
+          }
+          float sum = 0;
+          for (int64_t j = 0; j < keys; ++j) {
+            scores[j] = std::exp(scores[j] - max_score);
+            sum += scores[j];
+          }
+          for (int64_t d = 0; d < value_depth; ++d) {
+            float result = 0;
+            for (int64_t j = 0; j < keys; ++j) {
+              result += scores[j] / sum * v(b, h, j, d);
+            }
+            out(b, h, i, d) = result;
+          }
+        }
+      }
+    }
+    test::ExpectClose(expected, *GetOutput(0), /*atol=*/1e-5, /*rtol=*/1e-4);
+  }
+};
+
+TEST_F(FusedScaledDotProductAttentionOpTest, SingleTile) {
+  RunTest(/*batch=*/2, /*heads=*/3, /*rows=*/5, /*keys=*/7, /*depth=*/4,
+          /*value_depth=*/6, /*adj_key=*/true, TensorShape({}),
+          /*with_mask=*/false);
+}
+
+TEST_F(FusedScaledDotProductAttentionOpTest, ManyTiles) {
+  // Spans several blocks of query rows and several tiles of keys, with
+  // partial last blocks and tiles.
+  RunTest(/*batch=*/2, /*heads=*/2, /*rows=*/70, /*keys=*/300, /*depth=*/16,
+          /*value_depth=*/8, /*adj_key=*/true, TensorShape({}),
+          /*with_mask=*/false);
+}
+
+TEST_F(FusedScaledDotProductAttentionOpTest, KeyNotAdjoint) {
+  RunTest(/*batch=*/1, /*heads=*/2, /*rows=*/33, /*keys=*/200, /*depth=*/8,
+          /*value_depth=*/8, /*adj_key=*/false, TensorShape({}),
+          /*with_mask=*/false);
+}
+
+TEST_F(FusedScaledDotProductAttentionOpTest, BroadcastPaddingMask) {
+  RunTest(/*batch=*/2, /*heads=*/2, /*rows=*/40, /*keys=*/150, /*depth=*/8,
+          /*value_depth=*/4, /*adj_key=*/true, TensorShape({2, 1, 1, 150}),
+          /*with_mask=*/true);
+}
+
+TEST_F(FusedScaledDotProductAttentionOpTest, FullMask) {
+  RunTest(/*batch=*/1, /*heads=*/2, /*rows=*/20, /*keys=*/140, /*depth=*/8,
+          /*value_depth=*/4, /*adj_key=*/true, TensorShape({1, 2, 20, 140}),
+          /*with_mask=*/true);
+}
+
+TEST_F(FusedScaledDotProductAttentionOpTest, MismatchedBatch) {
+  TF_ASSERT_OK(NodeDefBuilder("attention", "_FusedScaledDotProductAttention")
+                   .Input(FakeInput(DT_FLOAT))
+                   .Input(FakeInput(DT_FLOAT))
+                   .Input(FakeInput(DT_FLOAT))
+                   .Input(FakeInput(DT_FLOAT))
+                   .Input(FakeInput(0, DT_FLOAT))
+                   .Attr("adj_key", true)
+                   .Finalize(node_def()));
+  TF_ASSERT_OK(InitOp());
+  AddInputFromArray<float>(TensorShape({2, 1, 2}), {1, 2, 3, 4});
+  AddInputFromArray<float>(TensorShape({1, 1, 2}), {1, 2});
+  AddInputFromArray<float>(TensorShape({1, 1, 2}), {1, 2});
+  AddInputFromArray<float>(TensorShape({}), {1});
+  const Status status = RunOpKernel();
+  EXPECT_TRUE(errors::IsInvalidArgument(status)) << status;
+}
+
+}  // namespace
+}  // namespace tensorflow
@@ -16,6 +16,9 @@ limitations under the License.
 #ifndef TENSORFLOW_CORE_KERNELS_GATHER_FUNCTOR_H_
 #define TENSORFLOW_CORE_KERNELS_GATHER_FUNCTOR_H_
 
+#include <algorithm>
+
+#include "absl/base/optimization.h"
 #include "absl/base/prefetch.h"
 #include "unsupported/Eigen/CXX11/Tensor"  // from @eigen_archive
 #include "tensorflow/core/framework/bounds_check.h"
@@ -32,6 +35,14 @@ typedef Eigen::GpuDevice GPUDevice;
 
 namespace functor {
 
+// The number of indices ahead of the one being copied whose params slices are
+// prefetched. Random lookups into large params are bound by the latency of
+// cache misses, which is hidden behind the copies of the slices in between.
+constexpr int kGatherPrefetchDistance = 8;
+
+// The maximum number of cache lines prefetched from each params slice.
+constexpr int kGatherMaxPrefetchLines = 4;
+
 // Helper method to copy using memcpy.
 template <typename T, typename Index, typename SliceIndex,
           SliceIndex static_slice_elems>
@@ -56,32 +67,52 @@ SliceIndex HandleCopies(OpKernelContext* ctx,
   // Store the value of invalidate index for printing error information, it's a
   // shared variable.
   SliceIndex result = -1;
+  const size_t prefetch_bytes = std::min<size_t>(
+      slice_bytes, kGatherMaxPrefetchLines * ABSL_CACHELINE_SIZE);
   auto work = [&](int64_t start, int64_t end) {
     SliceIndex batch_idx = static_cast<SliceIndex>(start / indices_size);
     SliceIndex indices_idx = static_cast<SliceIndex>(start % indices_size);
     SliceIndex batch_idx_end = static_cast<SliceIndex>(end / indices_size);
     SliceIndex indices_idx_end = static_cast<SliceIndex>(end % indices_size);
 
+    // The end of the indices of batch `b` copied by this shard.
+    auto row_end = [&](SliceIndex b) {
+      return b == batch_idx_end ? indices_idx_end : indices_size;
+    };
+    // Prefetches the params slice of indices(i) in batch `b`. An index that
+    // repeats the previous one was already prefetched, and an invalid index is
+    // reported when it is copied.
+    auto prefetch = [&](SliceIndex b, SliceIndex i) {
+      const Index index = internal::SubtleMustCopy(indices(i));
+      if (i > 0 && index == internal::SubtleMustCopy(indices(i - 1))) return;
+      if (!FastBoundsCheck(index, limit)) return;
+      const char* slice = reinterpret_cast<const char*>(
+          params_base + (b * static_cast<SliceIndex>(limit) +
+                         static_cast<SliceIndex>(index)) *
+                            slice_elems);
+      for (size_t offset = 0; offset < prefetch_bytes;
+           offset += ABSL_CACHELINE_SIZE) {
+        absl::PrefetchToLocalCache(slice + offset);
+      }
+    };
+    // Prefetches the slices of the first indices of batch `b` from `i` on.
+    auto prefetch_row = [&](SliceIndex b, SliceIndex i) {
+      const SliceIndex e = std::min<SliceIndex>(
+          i + kGatherPrefetchDistance, row_end(b));
+      for (; i < e; ++i) prefetch(b, i);
+    };
+
+    if (batch_idx <= batch_idx_end) prefetch_row(batch_idx, indices_idx);
     while ((batch_idx < batch_idx_end) ||
            (batch_idx == batch_idx_end && indices_idx < indices_idx_end)) {
-      SliceIndex i_next = indices_idx + 1;
-      SliceIndex b_next = batch_idx + 1;
       const Index index = internal::SubtleMustCopy(indices(indices_idx));
       if (!FastBoundsCheck(index, limit)) {
         mutex_lock l(mu);
         result = indices_idx;
         return;
       }
-      if ((batch_idx == batch_idx_end && i_next < indices_idx_end) ||
-          (i_next < indices_size)) {
-        absl::PrefetchToLocalCache(&params(batch_idx, indices(i_next), 0));
-        absl::PrefetchToLocalCache(&out(batch_idx, i_next, 0));
-        b_next = batch_idx;
-      } else if (b_next <= batch_idx_end) {
-        absl::PrefetchToLocalCache(&params(b_next, indices(0), 0));
-        absl::PrefetchToLocalCache(&out(b_next, 0, 0));
-        i_next = 0;
-      }
+      const SliceIndex ahead = indices_idx + kGatherPrefetchDistance;
+      if (ahead < row_end(batch_idx)) prefetch(batch_idx, ahead);
       // Copy using memcpy if possible, otherwise an Eigen loop
       // TODO(cwhipkey): avoid linking to framework to get Allocator (to improve
       // ahead-of-time compilation binary size).
@@ -98,8 +129,10 @@ SliceIndex HandleCopies(OpKernelContext* ctx,
         out.template chip<0>(batch_idx).template chip<0>(indices_idx) =
             params.template chip<0>(batch_idx).template chip<0>(index);
       }
-      indices_idx = i_next;
-      batch_idx = b_next;
+      if (++indices_idx == indices_size) {
+        indices_idx = 0;
+        if (++batch_idx <= batch_idx_end) prefetch_row(batch_idx, 0);
+      }
     }
   };
 
@@ -137,12 +170,28 @@ struct GatherFunctorCPU {
     }                                                                      \
   } while (0)
 
-    if (slice_size == 10)
-      CALL(10);
-    else if (slice_size == 20)
-      CALL(20);
-    else
-      CALL(-1);
+    // With a static slice size the copy of each slice is inlined and unrolled
+    // into vector moves. The sizes of common embedding widths are
+    // specialized.
+    switch (slice_size) {
+      case 10:
+        CALL(10);
+        break;
+      case 16:
+        CALL(16);
+        break;
+      case 20:
+        CALL(20);
+        break;
+      case 32:
+        CALL(32);
+        break;
+      case 64:
+        CALL(64);
+        break;
+      default:
+        CALL(-1);
+    }
 #undef CALL
 
     return bad_i;
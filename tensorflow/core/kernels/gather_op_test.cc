@@ -49,6 +49,8 @@ class GatherOpTest : public OpsTestBase {
                      .Finalize(node_def()));
     TF_ASSERT_OK(InitOp());
   }
+
+  void TestSliceSize(int slice_size);
 };
 
 TEST_F(GatherOpTest, ScalarIndices) {
@@ -148,6 +150,67 @@ TEST_F(GatherOpTest, Simple_TwoD64) {
   test::ExpectTensorEqual<float>(expected, *GetOutput(0));
 }
 
+// Gathers more rows than the prefetch distance, some of them repeated, with
+// `slice_size` elements each.
+void GatherOpTest::TestSliceSize(int slice_size) {
+  MakeOp(DT_FLOAT, DT_INT32);
+  constexpr int kRows = 50;
+  std::vector<float> params(kRows * slice_size);
+  for (int i = 0; i < params.size(); ++i) params[i] = i;
+  std::vector<int32> indices;
+  for (int i = 0; i < 40; ++i) indices.push_back((i * 7) % kRows);
+  indices.insert(indices.end(), {3, 3, 3, 49, 49, 0});
+  const int64_t num_indices = indices.size();
+  AddInputFromArray<float>(TensorShape({kRows, slice_size}), params);
+  AddInputFromArray<int32>(TensorShape({num_indices}), indices);
+  AddInputFromArray<int32>(TensorShape({}), {0});
+  TF_ASSERT_OK(RunOpKernel());
+
+  Tensor expected(allocator(), DT_FLOAT,
+                  TensorShape({num_indices, slice_size}));
+  auto expected_matrix = expected.matrix<float>();
+  for (int i = 0; i < num_indices; ++i) {
+    for (int j = 0; j < slice_size; ++j) {
+      expected_matrix(i, j) = params[indices[i] * slice_size + j];
+    }
+  }
+  test::ExpectTensorEqual<float>(expected, *GetOutput(0));
+}
+
+TEST_F(GatherOpTest, SliceSize1) { TestSliceSize(1); }
+TEST_F(GatherOpTest, SliceSize16) { TestSliceSize(16); }
+TEST_F(GatherOpTest, SliceSize32) { TestSliceSize(32); }
+TEST_F(GatherOpTest, SliceSize64) { TestSliceSize(64); }
+TEST_F(GatherOpTest, SliceSize100) { TestSliceSize(100); }
+
+TEST_F(GatherOpTest, BatchDimsPrefetchAcrossBatches) {
+  MakeOp(DT_FLOAT, DT_INT64, /*batch_dims=*/1);
+  constexpr int kBatch = 3, kRows = 20, kSlice = 16, kIndices = 12;
+  std::vector<float> params(kBatch * kRows * kSlice);
+  for (int i = 0; i < params.size(); ++i) params[i] = i;
+  std::vector<int64_t> indices;
+  for (int b = 0; b < kBatch; ++b) {
+    for (int i = 0; i < kIndices; ++i) indices.push_back((b + i * 3) % kRows);
+  }
+  AddInputFromArray<float>(TensorShape({kBatch, kRows, kSlice}), params);
+  AddInputFromArray<int64_t>(TensorShape({kBatch, kIndices}), indices);
+  AddInputFromArray<int64_t>(TensorShape({}), {1});
+  TF_ASSERT_OK(RunOpKernel());
+
+  Tensor expected(allocator(), DT_FLOAT,
+                  TensorShape({kBatch, kIndices, kSlice}));
+  auto expected_tensor = expected.tensor<float, 3>();
+  for (int b = 0; b < kBatch; ++b) {
+    for (int i = 0; i < kIndices; ++i) {
+      for (int j = 0; j < kSlice; ++j) {
+        expected_tensor(b, i, j) =
+            params[(b * kRows + indices[b * kIndices + i]) * kSlice + j];
+      }
+    }
+  }
+  test::ExpectTensorEqual<float>(expected, *GetOutput(0));
+}
+
 TEST_F(GatherOpTest, HighRank) {
   MakeOp(DT_FLOAT, DT_INT32);
 
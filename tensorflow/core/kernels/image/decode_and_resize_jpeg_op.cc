@@ -0,0 +1,277 @@
+/* Copyright 2024 The TensorFlow Authors. All Rights Reserved.
+
+Licensed under the Apache License, Version 2.0 (the "License");
+you may not use this file except in compliance with the License.
+You may obtain a copy of the License at
+
+    http://www.apache.org/licenses/LICENSE-2.0
+
+Unless required by applicable law or agreed to in writing, software
+distributed under the License is distributed on an "AS IS" BASIS,
+WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+See the License for the specific language governing permissions and
+limitations under the License.
+==============================================================================*/
+
+// See docs in ../ops/image_ops.cc
+
+#include <algorithm>
+#include <cmath>
+#include <cstdint>
+#include <limits>
+#include <vector>
+
+#include "tensorflow/core/framework/op_kernel.h"
+#include "tensorflow/core/framework/op_requires.h"
+#include "tensorflow/core/framework/tensor.h"
+#include "tensorflow/core/framework/tensor_shape.h"
+#include "tensorflow/core/framework/types.h"
+#include "tensorflow/core/lib/jpeg/jpeg_mem.h"
+#include "tensorflow/core/platform/errors.h"
+#include "tensorflow/core/platform/logging.h"
+#include "tensorflow/core/platform/stringpiece.h"
+#include "tensorflow/core/platform/tstring.h"
+
+namespace tensorflow {
+namespace {
+
+// Returns the largest IDCT scaling denominator that libjpeg supports whose
+// decoded image is still at least `out_height` x `out_width`. libjpeg rounds
+// the scaled dimensions up.
+int ChooseDecodeRatio(int height, int width, int out_height, int out_width) {
+  for (int ratio : {8, 4, 2}) {
+    if ((height + ratio - 1) / ratio >= out_height &&
+        (width + ratio - 1) / ratio >= out_width) {
+      return ratio;
+    }
+  }
+  return 1;
+}
+
+// Interpolation of one output coordinate of a bilinear resize.
+struct BilinearInterpolation {
+  int64_t lower;
+  int64_t upper;
+  float lerp;
+};
+
+// Computes the bilinear interpolation of each output coordinate with half
+// pixel centers, like `ResizeBilinear` with `half_pixel_centers=true`.
+std::vector<BilinearInterpolation> ComputeBilinearInterpolation(
+    int64_t in_size, int64_t out_size) {
+  const float scale = static_cast<float>(in_size) / out_size;
+  std::vector<BilinearInterpolation> interpolation(out_size);
+  for (int64_t i = 0; i < out_size; ++i) {
+    const float in = (static_cast<float>(i) + 0.5f) * scale - 0.5f;
+    const float in_f = std::floor(in);
+    interpolation[i].lower = std::max(static_cast<int64_t>(in_f), int64_t{0});
+    interpolation[i].upper =
+        std::min(static_cast<int64_t>(std::ceil(in)), in_size - 1);
+    interpolation[i].lerp = in - in_f;
+  }
+  return interpolation;
+}
+
+// The input coordinates covered by one output coordinate of an area resize,
+// and their weights.
+struct AreaInterpolation {
+  int64_t start;
+  std::vector<float> weights;
+};
+
+// Computes the input coverage of each output coordinate, like `ResizeArea`
+// with `align_corners=false`. The weights of each output coordinate sum to 1.
+std::vector<AreaInterpolation> ComputeAreaInterpolation(int64_t in_size,
+                                                        int64_t out_size) {
+  const float scale = static_cast<float>(in_size) / out_size;
+  std::vector<AreaInterpolation> interpolation(out_size);
+  for (int64_t i = 0; i < out_size; ++i) {
+    const float in_start = i * scale;
+    const float in_end = (i + 1) * scale;
+    const int64_t start = static_cast<int64_t>(std::floor(in_start));
+    const int64_t end =
+        std::min(static_cast<int64_t>(std::ceil(in_end)), in_size);
+    interpolation[i].start = start;
+    for (int64_t j = start; j < end; ++j) {
+      const float weight =
+          std::min(j + 1.0f, in_end) - std::max<float>(j, in_start);
+      interpolation[i].weights.push_back(weight / scale);
+    }
+  }
+  return interpolation;
+}
+
+void ResizeBilinear(const uint8* image, int64_t in_height, int64_t in_width,
+                    int64_t channels, int64_t out_height, int64_t out_width,
+                    float* output) {
+  const std::vector<BilinearInterpolation> ys =
+      ComputeBilinearInterpolation(in_height, out_height);
+  const std::vector<BilinearInterpolation> xs =
+      ComputeBilinearInterpolation(in_width, out_width);
+  const int64_t in_row_size = in_width * channels;
+  for (int64_t y = 0; y < out_height; ++y) {
+    const uint8* top = image + ys[y].lower * in_row_size;
+    const uint8* bottom = image + ys[y].upper * in_row_size;
+    const float y_lerp = ys[y].lerp;
+    for (int64_t x = 0; x < out_width; ++x) {
+      const int64_t left = xs[x].lower * channels;
+      const int64_t right = xs[x].upper * channels;
+      const float x_lerp = xs[x].lerp;
+      for (int64_t c = 0; c < channels; ++c) {
+        const float top_value =
+            top[left + c] + (top[right + c] - top[left + c]) * x_lerp;
+        const float bottom_value =
+            bottom[left + c] +
+            (bottom[right + c] - bottom[left + c]) * x_lerp;
+        *output++ = top_value + (bottom_value - top_value) * y_lerp;
+      }
+    }
+  }
+}
+
+void ResizeArea(const uint8* image, int64_t in_height, int64_t in_width,
+                int64_t channels, int64_t out_height, int64_t out_width,
+                float* output) {
+  const std::vector<AreaInterpolation> ys =
+      ComputeAreaInterpolation(in_height, out_height);
+  const std::vector<AreaInterpolation> xs =
+      ComputeAreaInterpolation(in_width, out_width);
+  const int64_t in_row_size = in_width * channels;
+  std::vector<float> sums(channels);
+  for (int64_t y = 0; y < out_height; ++y) {
+    for (int64_t x = 0; x < out_width; ++x) {
+      std::fill(sums.begin(), sums.end(), 0.0f);
+      for (int64_t i = 0; i < ys[y].weights.size(); ++i) {
+        const uint8* row = image + (ys[y].start + i) * in_row_size;
+        for (int64_t j = 0; j < xs[x].weights.size(); ++j) {
+          const uint8* pixel = row + (xs[x].start + j) * channels;
+          const float weight = ys[y].weights[i] * xs[x].weights[j];
+          for (int64_t c = 0; c < channels; ++c) {
+            sums[c] += pixel[c] * weight;
+          }
+        }
+      }
+      output = std::copy(sums.begin(), sums.end(), output);
+    }
+  }
+}
+
+// Decodes a JPEG image and resizes it to `size`. The image is decoded with
+// libjpeg's scaled IDCT at the smallest scale (1/8, 1/4 or 1/2) that is still
+// at least as large as `size`, so that the decoder does not produce pixels that
+// the resize would discard anyway. The decoded image is then resized to `size`
+// with bilinear interpolation or area averaging.
+class DecodeAndResizeJpegOp : public OpKernel {
+ public:
+  explicit DecodeAndResizeJpegOp(OpKernelConstruction* context)
+      : OpKernel(context) {
+    OP_REQUIRES_OK(context, context->GetAttr("channels", &flags_.components));
+    OP_REQUIRES(context,
+                flags_.components == 0 || flags_.components == 1 ||
+                    flags_.components == 3,
+                errors::InvalidArgument("channels must be 0, 1, or 3, got ",
+                                        flags_.components));
+    OP_REQUIRES_OK(context, context->GetAttr("method", &method_));
+    OP_REQUIRES_OK(
+        context, context->GetAttr("fancy_upscaling", &flags_.fancy_upscaling));
+    OP_REQUIRES_OK(context,
+                   context->GetAttr("try_recover_truncated",
+                                    &flags_.try_recover_truncated_jpeg));
+    OP_REQUIRES_OK(context, context->GetAttr("acceptable_fraction",
+                                             &flags_.min_acceptable_fraction));
+    string dct_method;
+    OP_REQUIRES_OK(context, context->GetAttr("dct_method", &dct_method));
+    OP_REQUIRES(
+        context,
+        (dct_method.empty() || dct_method == "INTEGER_FAST" ||
+         dct_method == "INTEGER_ACCURATE"),
+        errors::InvalidArgument("dct_method must be one of "
+                                "{'', 'INTEGER_FAST', 'INTEGER_ACCURATE'}"));
+    // Same default as `DecodeJpeg`.
+    flags_.dct_method =
+        dct_method == "INTEGER_ACCURATE" ? JDCT_ISLOW : JDCT_IFAST;
+  }
+
+  void Compute(OpKernelContext* context) override {
+    const Tensor& contents = context->input(0);
+    OP_REQUIRES(context, TensorShapeUtils::IsScalar(contents.shape()),
+                errors::InvalidArgument("contents must be scalar, got shape ",
+                                        contents.shape().DebugString()));
+    const StringPiece input = contents.scalar<tstring>()();
+    OP_REQUIRES(context, input.size() <= std::numeric_limits<int>::max(),
+                errors::InvalidArgument("JPEG contents are too large for int: ",
+                                        input.size()));
+    const Tensor& size = context->input(1);
+    OP_REQUIRES(context, size.dims() == 1 && size.NumElements() == 2,
+                errors::InvalidArgument("size must be 1-D with 2 elements, "
+                                        "got shape ",
+                                        size.shape().DebugString()));
+    const int out_height = size.vec<int32>()(0);
+    const int out_width = size.vec<int32>()(1);
+    OP_REQUIRES(context, out_height > 0 && out_width > 0,
+                errors::InvalidArgument("size must be positive, got ",
+                                        out_height, "x", out_width));
+
+    int height, width;
+    OP_REQUIRES(context,
+                jpeg::GetImageInfo(input.data(), input.size(), &width, &height,
+                                   /*components=*/nullptr),
+                errors::InvalidArgument("Invalid JPEG data, size ",
+                                        input.size()));
+
+    // Use local copy of flags to avoid race condition as the class member is
+    // shared among different invocations.
+    jpeg::UncompressFlags flags = flags_;
+    flags.ratio = ChooseDecodeRatio(height, width, out_height, out_width);
+    VLOG(3) << "Decoding a " << height << "x" << width << " JPEG image at 1/"
+            << flags.ratio << " scale to resize it to " << out_height << "x"
+            << out_width;
+
+    Tensor decoded;
+    uint8* buffer = jpeg::Uncompress(
+        input.data(), input.size(), flags, /*nwarn=*/nullptr,
+        [&](int width, int height, int channels) -> uint8* {
+          Status status = context->allocate_temp(
+              DT_UINT8, TensorShape({height, width, channels}), &decoded);
+          if (!status.ok()) {
+            VLOG(1) << status;
+            context->SetStatus(status);
+            return nullptr;
+          }
+          return decoded.flat<uint8>().data();
+        });
+    OP_REQUIRES(context, context->status().ok(), context->status());
+    OP_REQUIRES(context, buffer != nullptr,
+                errors::InvalidArgument(
+                    "jpeg::Uncompress failed. Invalid JPEG data."));
+
+    const int64_t decoded_height = decoded.dim_size(0);
+    const int64_t decoded_width = decoded.dim_size(1);
+    const int64_t channels = decoded.dim_size(2);
+    Tensor* output = nullptr;
+    OP_REQUIRES_OK(context,
+                   context->allocate_output(
+                       0, TensorShape({out_height, out_width, channels}),
+                       &output));
+    float* output_data = output->flat<float>().data();
+    if (decoded_height == out_height && decoded_width == out_width) {
+      std::copy_n(buffer, decoded.NumElements(), output_data);
+    } else if (method_ == "area") {
+      ResizeArea(buffer, decoded_height, decoded_width, channels, out_height,
+                 out_width, output_data);
+    } else {
+      ResizeBilinear(buffer, decoded_height, decoded_width, channels,
+                     out_height, out_width, output_data);
+    }
+  }
+
+ private:
+  jpeg::UncompressFlags flags_;
+  string method_;
+};
+
+REGISTER_KERNEL_BUILDER(Name("DecodeAndResizeJpeg").Device(DEVICE_CPU),
+                        DecodeAndResizeJpegOp);
+
+}  // namespace
+}  // namespace tensorflow
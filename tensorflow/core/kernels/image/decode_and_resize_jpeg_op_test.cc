@@ -0,0 +1,129 @@
+/* Copyright 2024 The TensorFlow Authors. All Rights Reserved.
+
+Licensed under the Apache License, Version 2.0 (the "License");
+you may not use this file except in compliance with the License.
+You may obtain a copy of the License at
+
+    http://www.apache.org/licenses/LICENSE-2.0
+
+Unless required by applicable law or agreed to in writing, software
+distributed under the License is distributed on an "AS IS" BASIS,
+WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+See the License for the specific language governing permissions and
+limitations under the License.
+==============================================================================*/
+
+#include <cstdint>
+#include <string>
+#include <vector>
+
+#include "tensorflow/core/framework/fake_input.h"
+#include "tensorflow/core/framework/node_def_builder.h"
+#include "tensorflow/core/framework/tensor.h"
+#include "tensorflow/core/framework/tensor_shape.h"
+#include "tensorflow/core/framework/types.h"
+#include "tensorflow/core/kernels/ops_testutil.h"
+#include "tensorflow/core/lib/core/status_test_util.h"
+#include "tensorflow/core/lib/jpeg/jpeg_mem.h"
+#include "tensorflow/core/platform/errors.h"
+#include "tensorflow/core/platform/test.h"
+#include "tensorflow/core/platform/tstring.h"
+
+namespace tensorflow {
+namespace {
+
+// Encodes a grayscale image whose left half is `left` and right half `right`.
+tstring EncodeGrayscaleImage(int height, int width, uint8 left, uint8 right) {
+  std::vector<uint8> pixels(height * width);
+  for (int y = 0; y < height; ++y) {
+    for (int x = 0; x < width; ++x) {
+      pixels[y * width + x] = x < width / 2 ? left : right;
+    }
+  }
+  jpeg::CompressFlags flags;
+  flags.format = jpeg::FORMAT_GRAYSCALE;
+  flags.quality = 100;
+  return jpeg::Compress(pixels.data(), width, height, flags);
+}
+
+class DecodeAndResizeJpegOpTest : public OpsTestBase {
+ protected:
+  void MakeOp(const std::string& method) {
+    TF_ASSERT_OK(NodeDefBuilder("decode_and_resize_jpeg", "DecodeAndResizeJpeg")
+                     .Input(FakeInput(DT_STRING))
+                     .Input(FakeInput(DT_INT32))
+                     .Attr("method", method)
+                     .Finalize(node_def()));
+    TF_ASSERT_OK(InitOp());
+  }
+
+  void AddInputs(const tstring& contents, int height, int width) {
+    AddInputFromArray<tstring>(TensorShape({}), {contents});
+    AddInputFromArray<int32>(TensorShape({2}), {height, width});
+  }
+
+  // Expects that every pixel of column `x` of the output is close to `value`.
+  void ExpectColumnNear(int x, float value, float tolerance) {
+    const Tensor& output = *GetOutput(0);
+    auto image = output.tensor<float, 3>();
+    for (int y = 0; y < output.dim_size(0); ++y) {
+      EXPECT_NEAR(image(y, x, 0), value, tolerance) << "at " << y << "," << x;
+    }
+  }
+};
+
+TEST_F(DecodeAndResizeJpegOpTest, ExactScale) {
+  MakeOp("bilinear");
+  // 1/8 of the encoded image.
+  AddInputs(EncodeGrayscaleImage(256, 320, 100, 100), 32, 40);
+  TF_ASSERT_OK(RunOpKernel());
+  EXPECT_EQ(GetOutput(0)->shape(), TensorShape({32, 40, 1}));
+  for (int x = 0; x < 40; ++x) {
+    ExpectColumnNear(x, 100, 2);
+  }
+}
+
+TEST_F(DecodeAndResizeJpegOpTest, Bilinear) {
+  MakeOp("bilinear");
+  AddInputs(EncodeGrayscaleImage(256, 320, 0, 200), 50, 50);
+  TF_ASSERT_OK(RunOpKernel());
+  EXPECT_EQ(GetOutput(0)->shape(), TensorShape({50, 50, 1}));
+  ExpectColumnNear(0, 0, 4);
+  ExpectColumnNear(10, 0, 4);
+  ExpectColumnNear(40, 200, 4);
+  ExpectColumnNear(49, 200, 4);
+}
+
+TEST_F(DecodeAndResizeJpegOpTest, Area) {
+  MakeOp("area");
+  AddInputs(EncodeGrayscaleImage(256, 320, 0, 200), 7, 2);
+  TF_ASSERT_OK(RunOpKernel());
+  EXPECT_EQ(GetOutput(0)->shape(), TensorShape({7, 2, 1}));
+  ExpectColumnNear(0, 0, 4);
+  ExpectColumnNear(1, 200, 4);
+}
+
+TEST_F(DecodeAndResizeJpegOpTest, Upscale) {
+  MakeOp("bilinear");
+  AddInputs(EncodeGrayscaleImage(16, 16, 50, 50), 40, 24);
+  TF_ASSERT_OK(RunOpKernel());
+  EXPECT_EQ(GetOutput(0)->shape(), TensorShape({40, 24, 1}));
+  for (int x = 0; x < 24; ++x) {
+    ExpectColumnNear(x, 50, 2);
+  }
+}
+
+TEST_F(DecodeAndResizeJpegOpTest, InvalidSize) {
+  MakeOp("bilinear");
+  AddInputs(EncodeGrayscaleImage(16, 16, 50, 50), 0, 8);
+  EXPECT_TRUE(errors::IsInvalidArgument(RunOpKernel()));
+}
+
+TEST_F(DecodeAndResizeJpegOpTest, InvalidContents) {
+  MakeOp("bilinear");
+  AddInputs("not a jpeg", 8, 8);
+  EXPECT_TRUE(errors::IsInvalidArgument(RunOpKernel()));
+}
+
+}  // namespace
+}  // namespace tensorflow
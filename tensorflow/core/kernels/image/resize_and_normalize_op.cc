@@ -0,0 +1,418 @@
+/* Copyright 2024 The TensorFlow Authors. All Rights Reserved.
+
+Licensed under the Apache License, Version 2.0 (the "License");
+you may not use this file except in compliance with the License.
+You may obtain a copy of the License at
+
+    http://www.apache.org/licenses/LICENSE-2.0
+
+Unless required by applicable law or agreed to in writing, software
+distributed under the License is distributed on an "AS IS" BASIS,
+WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+See the License for the specific language governing permissions and
+limitations under the License.
+==============================================================================*/
+
+// See docs in ../ops/image_ops.cc.
+
+#define EIGEN_USE_THREADS
+
+#include <algorithm>
+#include <cmath>
+#include <vector>
+
+#include "unsupported/Eigen/CXX11/Tensor"  // from @eigen_archive
+#include "tensorflow/core/framework/bounds_check.h"
+#include "tensorflow/core/framework/op_kernel.h"
+#include "tensorflow/core/framework/register_types.h"
+#include "tensorflow/core/framework/tensor.h"
+#include "tensorflow/core/framework/tensor_shape.h"
+#include "tensorflow/core/framework/types.h"
+#include "tensorflow/core/lib/core/errors.h"
+#include "tensorflow/core/util/image_resizer_state.h"
+#include "tensorflow/core/util/work_sharder.h"
+
+namespace tensorflow {
+namespace {
+
+// Where an output row or column samples the input: between `lower` and
+// `upper`, weighted by `lerp`. A sample off the input, which only crops have,
+// is extrapolated.
+struct Sample {
+  int64_t lower;
+  int64_t upper;
+  float lerp;
+  bool extrapolate;
+};
+
+// The per-channel normalization of the resized values, which computes
+// (value - offset) / scale, or (value - offset) * scale, with the same float
+// operations as the unfused Sub and Div or Mul.
+class Normalizer {
+ public:
+  // Sets an error on `context` unless `offset` and `scale` hold one value or
+  // `channels` values along their last dimension, so that they broadcast to
+  // the images along the channels only.
+  Normalizer(OpKernelContext* context, const Tensor& offset,
+             const Tensor& scale, bool scale_is_divisor, int64_t channels)
+      : scale_is_divisor_(scale_is_divisor) {
+    for (const Tensor* arg : {&offset, &scale}) {
+      OP_REQUIRES(context,
+                  arg->dims() <= 4 && (arg->NumElements() == 1 ||
+                                       (arg->NumElements() == channels &&
+                                        arg->dim_size(arg->dims() - 1) ==
+                                            channels)),
+                  errors::InvalidArgument(
+                      "offset and scale must hold 1 or ", channels,
+                      " values along their last dimension, got ",
+                      arg->shape().DebugString()));
+    }
+    offset_.resize(channels);
+    scale_.resize(channels);
+    for (int64_t c = 0; c < channels; ++c) {
+      offset_[c] = offset.flat<float>()(offset.NumElements() == 1 ? 0 : c);
+      scale_[c] = scale.flat<float>()(scale.NumElements() == 1 ? 0 : c);
+    }
+  }
+
+  float operator()(float value, int64_t c) const {
+    return scale_is_divisor_ ? (value - offset_[c]) / scale_[c]
+                             : (value - offset_[c]) * scale_[c];
+  }
+
+ private:
+  const bool scale_is_divisor_;
+  std::vector<float> offset_;
+  std::vector<float> scale_;
+};
+
+// Writes a row of `out_width` normalized pixels, interpolated between the
+// input rows `top` and `bottom`. The lower and upper columns of `xs` are
+// scaled by the number of channels.
+template <typename T, typename OutT>
+void ResizeAndNormalizeRow(const T* top, const T* bottom, const float y_lerp,
+                           const Sample* xs, const int64_t out_width,
+                           const int64_t channels, const Normalizer& normalize,
+                           const float extrapolation_value, OutT* out) {
+  for (int64_t x = 0; x < out_width; ++x, out += channels) {
+    if (xs[x].extrapolate) {
+      for (int64_t c = 0; c < channels; ++c) {
+        out[c] = static_cast<OutT>(normalize(extrapolation_value, c));
+      }
+      continue;
+    }
+    const int64_t left = xs[x].lower;
+    const int64_t right = xs[x].upper;
+    const float x_lerp = xs[x].lerp;
+    for (int64_t c = 0; c < channels; ++c) {
+      const float top_left(top[left + c]);
+      const float top_right(top[right + c]);
+      const float bottom_left(bottom[left + c]);
+      const float bottom_right(bottom[right + c]);
+      const float top_value = top_left + (top_right - top_left) * x_lerp;
+      const float bottom_value =
+          bottom_left + (bottom_right - bottom_left) * x_lerp;
+      out[c] = static_cast<OutT>(
+          normalize(top_value + (bottom_value - top_value) * y_lerp, c));
+    }
+  }
+}
+
+// Returns the cost in cycles of a row of `out_width` pixels.
+template <typename T>
+int64_t RowCost(int64_t out_width, int64_t channels) {
+  const double cost_per_value = Eigen::TensorOpCost::CastCost<T, float>() * 4 +
+                                Eigen::TensorOpCost::AddCost<float>() * 7 +
+                                Eigen::TensorOpCost::MulCost<float>() * 3 +
+                                Eigen::TensorOpCost::DivCost<float>();
+  return static_cast<int64_t>(out_width * channels * cost_per_value);
+}
+
+// Computes the samples of a resize like ResizeBilinear does.
+template <typename Scaler>
+void ComputeResizeSamples(const Scaler scaler, const int64_t out_size,
+                          const int64_t in_size, const float scale,
+                          std::vector<Sample>* samples) {
+  samples->resize(out_size);
+  for (int64_t i = 0; i < out_size; ++i) {
+    const float in = scaler(i, scale);
+    const float in_f = std::floor(in);
+    (*samples)[i].lower =
+        std::max(static_cast<int64_t>(in_f), static_cast<int64_t>(0));
+    (*samples)[i].upper =
+        std::min(static_cast<int64_t>(std::ceil(in)), in_size - 1);
+    (*samples)[i].lerp = in - in_f;
+    (*samples)[i].extrapolate = false;
+  }
+}
+
+template <typename T, typename OutT>
+class FusedResizeBilinearAndNormalizeOp : public OpKernel {
+ public:
+  explicit FusedResizeBilinearAndNormalizeOp(OpKernelConstruction* context)
+      : OpKernel(context) {
+    OP_REQUIRES_OK(context, context->GetAttr("align_corners", &align_corners_));
+    OP_REQUIRES_OK(
+        context, context->GetAttr("half_pixel_centers", &half_pixel_centers_));
+    OP_REQUIRES_OK(context,
+                   context->GetAttr("scale_is_divisor", &scale_is_divisor_));
+  }
+
+  void Compute(OpKernelContext* context) override {
+    ImageResizerState st(align_corners_, half_pixel_centers_);
+    st.ValidateAndCalculateOutputSize(context);
+    if (!context->status().ok()) return;
+    const Normalizer normalize(context, context->input(2), context->input(3),
+                               scale_is_divisor_, st.channels);
+    if (!context->status().ok()) return;
+
+    TensorShape shape;
+    OP_REQUIRES_OK(context, shape.AddDimWithStatus(st.batch_size));
+    OP_REQUIRES_OK(context, shape.AddDimWithStatus(st.out_height));
+    OP_REQUIRES_OK(context, shape.AddDimWithStatus(st.out_width));
+    OP_REQUIRES_OK(context, shape.AddDimWithStatus(st.channels));
+    Tensor* output = nullptr;
+    OP_REQUIRES_OK(context, context->allocate_output(0, shape, &output));
+    if (output->NumElements() == 0) return;
+
+    const T* images = context->input(0).flat<T>().data();
+    OutT* out = output->flat<OutT>().data();
+    const int64_t channels = st.channels;
+    const int64_t in_row_size = st.in_width * channels;
+    const int64_t in_image_size = st.in_height * in_row_size;
+    const int64_t out_row_size = st.out_width * channels;
+    const auto& worker_threads =
+        *context->device()->tensorflow_cpu_worker_threads();
+
+    // Like ResizeBilinear, a resize to the same size is a plain copy, which
+    // doesn't turn infinities into NaNs by interpolating them.
+    if (st.out_height == st.in_height && st.out_width == st.in_width) {
+      Shard(worker_threads.num_threads, worker_threads.workers,
+            st.batch_size * st.in_height, RowCost<T>(st.out_width, channels),
+            [&](int64_t start, int64_t limit) {
+              for (int64_t i = start * out_row_size; i < limit * out_row_size;
+                   i += channels) {
+                for (int64_t c = 0; c < channels; ++c) {
+                  out[i + c] = static_cast<OutT>(
+                      normalize(static_cast<float>(images[i + c]), c));
+                }
+              }
+            });
+      return;
+    }
+
+    std::vector<Sample> ys;
+    std::vector<Sample> xs;
+    if (half_pixel_centers_) {
+      ComputeResizeSamples(HalfPixelScaler(), st.out_height, st.in_height,
+                           st.height_scale, &ys);
+      ComputeResizeSamples(HalfPixelScaler(), st.out_width, st.in_width,
+                           st.width_scale, &xs);
+    } else {
+      ComputeResizeSamples(LegacyScaler(), st.out_height, st.in_height,
+                           st.height_scale, &ys);
+      ComputeResizeSamples(LegacyScaler(), st.out_width, st.in_width,
+                           st.width_scale, &xs);
+    }
+    for (Sample& x : xs) {
+      x.lower *= channels;
+      x.upper *= channels;
+    }
+
+    // Sharding across the rows of all the output images.
+    auto resize_rows = [&](int64_t start, int64_t limit) {
+      for (int64_t row = start; row < limit; ++row) {
+        const int64_t b = row / st.out_height;
+        const Sample& y = ys[row % st.out_height];
+        const T* image = images + b * in_image_size;
+        ResizeAndNormalizeRow(image + y.lower * in_row_size,
+                              image + y.upper * in_row_size, y.lerp, xs.data(),
+                              st.out_width, channels, normalize,
+                              /*extrapolation_value=*/0.0f,
+                              out + row * out_row_size);
+      }
+    };
+    Shard(worker_threads.num_threads, worker_threads.workers,
+          st.batch_size * st.out_height, RowCost<T>(st.out_width, channels),
+          resize_rows);
+  }
+
+ private:
+  bool align_corners_;
+  bool half_pixel_centers_;
+  bool scale_is_divisor_;
+};
+
+template <typename T, typename OutT>
+class FusedCropAndResizeAndNormalizeOp : public OpKernel {
+ public:
+  explicit FusedCropAndResizeAndNormalizeOp(OpKernelConstruction* context)
+      : OpKernel(context) {
+    OP_REQUIRES_OK(context, context->GetAttr("extrapolation_value",
+                                             &extrapolation_value_));
+    OP_REQUIRES_OK(context,
+                   context->GetAttr("scale_is_divisor", &scale_is_divisor_));
+  }
+
+  void Compute(OpKernelContext* context) override {
+    const Tensor& image = context->input(0);
+    const Tensor& boxes = context->input(1);
+    const Tensor& box_index = context->input(2);
+    const Tensor& crop_size = context->input(3);
+
+    // The inputs are validated as by CropAndResize.
+    OP_REQUIRES(context, image.dims() == 4,
+                errors::InvalidArgument("input image must be 4-D",
+                                        image.shape().DebugString()));
+    const int batch_size = image.dim_size(0);
+    const int image_height = image.dim_size(1);
+    const int image_width = image.dim_size(2);
+    const int depth = image.dim_size(3);
+    OP_REQUIRES(context, image_height > 0 && image_width > 0,
+                errors::InvalidArgument("image dimensions must be positive"));
+    OP_REQUIRES(context, boxes.dims() == 2 && boxes.dim_size(1) == 4,
+                errors::InvalidArgument("boxes must be 2-D with 4 columns, "
+                                        "got: ",
+                                        boxes.shape().DebugString()));
+    OP_REQUIRES(context, TensorShapeUtils::IsVector(box_index.shape()),
+                errors::InvalidArgument("box_indices must be rank 1 but is "
+                                        "shape ",
+                                        box_index.shape().DebugString()));
+    const int num_boxes = boxes.dim_size(0);
+    OP_REQUIRES(context, box_index.dim_size(0) == num_boxes,
+                errors::InvalidArgument("box_index has incompatible shape"));
+    OP_REQUIRES(context,
+                crop_size.dims() == 1 && crop_size.dim_size(0) == 2,
+                errors::InvalidArgument("crop_size must be 1-D with two "
+                                        "elements",
+                                        crop_size.shape().DebugString()));
+    const int crop_height = internal::SubtleMustCopy(crop_size.vec<int32>()(0));
+    const int crop_width = internal::SubtleMustCopy(crop_size.vec<int32>()(1));
+    OP_REQUIRES(context, crop_height > 0 && crop_width > 0,
+                errors::InvalidArgument("crop dimensions must be positive"));
+    const auto boxes_data = boxes.tensor<float, 2>();
+    const auto box_index_data = box_index.vec<int32>();
+    for (int b = 0; b < num_boxes; ++b) {
+      OP_REQUIRES(
+          context, FastBoundsCheck(box_index_data(b), batch_size),
+          errors::OutOfRange("box_index has values outside [0, batch_size)"));
+    }
+    const Eigen::Tensor<bool, 0, Eigen::RowMajor> only_finite_elements =
+        boxes_data.isfinite().all();
+    OP_REQUIRES(context, only_finite_elements(),
+                errors::InvalidArgument(
+                    "Boxes contains at least one element that is not finite"));
+    const Normalizer normalize(context, context->input(4), context->input(5),
+                               scale_is_divisor_, depth);
+    if (!context->status().ok()) return;
+
+    TensorShape shape;
+    OP_REQUIRES_OK(context, shape.AddDimWithStatus(num_boxes));
+    OP_REQUIRES_OK(context, shape.AddDimWithStatus(crop_height));
+    OP_REQUIRES_OK(context, shape.AddDimWithStatus(crop_width));
+    OP_REQUIRES_OK(context, shape.AddDimWithStatus(depth));
+    Tensor* output = nullptr;
+    OP_REQUIRES_OK(context, context->allocate_output(0, shape, &output));
+    if (output->NumElements() == 0) return;
+
+    const T* images = image.flat<T>().data();
+    OutT* out = output->flat<OutT>().data();
+    const int64_t in_row_size = static_cast<int64_t>(image_width) * depth;
+    const int64_t in_image_size = image_height * in_row_size;
+    const int64_t out_row_size = static_cast<int64_t>(crop_width) * depth;
+    const float extrapolation_value = extrapolation_value_;
+
+    // Sharding across the rows of all the crops. The samples along x are
+    // computed once per box and shard, with the same float operations as
+    // CropAndResize.
+    auto crop_rows = [&](int64_t start, int64_t limit) {
+      std::vector<Sample> xs(crop_width);
+      int64_t xs_box = -1;
+      for (int64_t row = start; row < limit; ++row) {
+        const int b = row / crop_height;
+        const int y = row % crop_height;
+        const float y1 = boxes_data(b, 0);
+        const float x1 = boxes_data(b, 1);
+        const float y2 = boxes_data(b, 2);
+        const float x2 = boxes_data(b, 3);
+        OutT* out_row = out + row * out_row_size;
+
+        const float height_scale =
+            (crop_height > 1)
+                ? (y2 - y1) * (image_height - 1) / (crop_height - 1)
+                : 0;
+        const float in_y = (crop_height > 1)
+                               ? y1 * (image_height - 1) + y * height_scale
+                               : 0.5 * (y1 + y2) * (image_height - 1);
+        if (in_y < 0 || in_y > image_height - 1) {
+          for (int64_t i = 0; i < out_row_size; i += depth) {
+            for (int c = 0; c < depth; ++c) {
+              out_row[i + c] =
+                  static_cast<OutT>(normalize(extrapolation_value, c));
+            }
+          }
+          continue;
+        }
+        if (xs_box != b) {
+          const float width_scale =
+              (crop_width > 1)
+                  ? (x2 - x1) * (image_width - 1) / (crop_width - 1)
+                  : 0;
+          for (int x = 0; x < crop_width; ++x) {
+            const float in_x = (crop_width > 1)
+                                   ? x1 * (image_width - 1) + x * width_scale
+                                   : 0.5 * (x1 + x2) * (image_width - 1);
+            Sample& sample = xs[x];
+            sample.extrapolate = in_x < 0 || in_x > image_width - 1;
+            if (sample.extrapolate) continue;
+            const int left_x_index = floorf(in_x);
+            const int right_x_index = ceilf(in_x);
+            sample.lower = static_cast<int64_t>(left_x_index) * depth;
+            sample.upper = static_cast<int64_t>(right_x_index) * depth;
+            sample.lerp = in_x - left_x_index;
+          }
+          xs_box = b;
+        }
+        const int top_y_index = floorf(in_y);
+        const int bottom_y_index = ceilf(in_y);
+        const T* crop_image = images + box_index_data(b) * in_image_size;
+        ResizeAndNormalizeRow(crop_image + top_y_index * in_row_size,
+                              crop_image + bottom_y_index * in_row_size,
+                              in_y - top_y_index, xs.data(), crop_width, depth,
+                              normalize, extrapolation_value, out_row);
+      }
+    };
+    const auto& worker_threads =
+        *context->device()->tensorflow_cpu_worker_threads();
+    Shard(worker_threads.num_threads, worker_threads.workers,
+          static_cast<int64_t>(num_boxes) * crop_height,
+          RowCost<T>(crop_width, depth), crop_rows);
+  }
+
+ private:
+  float extrapolation_value_;
+  bool scale_is_divisor_;
+};
+
+}  // namespace
+
+#define REGISTER_KERNELS(T, OutT)                                      \
+  REGISTER_KERNEL_BUILDER(Name("_FusedResizeBilinearAndNormalize")     \
+                              .Device(DEVICE_CPU)                      \
+                              .TypeConstraint<T>("T")                  \
+                              .TypeConstraint<OutT>("out_type"),       \
+                          FusedResizeBilinearAndNormalizeOp<T, OutT>); \
+  REGISTER_KERNEL_BUILDER(Name("_FusedCropAndResizeAndNormalize")      \
+                              .Device(DEVICE_CPU)                      \
+                              .TypeConstraint<T>("T")                  \
+                              .TypeConstraint<OutT>("out_type"),       \
+                          FusedCropAndResizeAndNormalizeOp<T, OutT>);
+
+REGISTER_KERNELS(uint8, float);
+REGISTER_KERNELS(uint8, bfloat16);
+REGISTER_KERNELS(float, float);
+REGISTER_KERNELS(float, bfloat16);
+
+#undef REGISTER_KERNELS
+
+}  // namespace tensorflow
@@ -0,0 +1,158 @@
+/* Copyright 2024 The TensorFlow Authors. All Rights Reserved.
+
+Licensed under the Apache License, Version 2.0 (the "License");
+you may not use this file except in compliance with the License.
+You may obtain a copy of the License at
+
+    http://www.apache.org/licenses/LICENSE-2.0
+
+Unless required by applicable law or agreed to in writing, software
+distributed under the License is distributed on an "AS IS" BASIS,
+WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+See the License for the specific language governing permissions and
+limitations under the License.
+==============================================================================*/
+
+#include <limits>
+
+#include "absl/strings/match.h"
+#include "tensorflow/core/framework/fake_input.h"
+#include "tensorflow/core/framework/node_def_builder.h"
+#include "tensorflow/core/framework/tensor.h"
+#include "tensorflow/core/framework/tensor_testutil.h"
+#include "tensorflow/core/framework/types.h"
+#include "tensorflow/core/kernels/ops_testutil.h"
+#include "tensorflow/core/lib/core/status_test_util.h"
+#include "tensorflow/core/platform/test.h"
+
+namespace tensorflow {
+
+class FusedResizeAndNormalizeOpTest : public OpsTestBase {
+ protected:
+  void MakeResizeOp(DataType type, DataType out_type, bool align_corners,
+                    bool scale_is_divisor) {
+    TF_EXPECT_OK(NodeDefBuilder("resize_and_normalize_op",
+                                "_FusedResizeBilinearAndNormalize")
+                     .Input(FakeInput(type))
+                     .Input(FakeInput(DT_INT32))
+                     .Input(FakeInput(DT_FLOAT))
+                     .Input(FakeInput(DT_FLOAT))
+                     .Attr("out_type", out_type)
+                     .Attr("align_corners", align_corners)
+                     .Attr("scale_is_divisor", scale_is_divisor)
+                     .Finalize(node_def()));
+    TF_EXPECT_OK(InitOp());
+  }
+
+  void MakeCropOp(float extrapolation_value) {
+    TF_EXPECT_OK(NodeDefBuilder("crop_and_resize_and_normalize_op",
+                                "_FusedCropAndResizeAndNormalize")
+                     .Input(FakeInput(DT_UINT8))
+                     .Input(FakeInput(DT_FLOAT))
+                     .Input(FakeInput(DT_INT32))
+                     .Input(FakeInput(DT_INT32))
+                     .Input(FakeInput(DT_FLOAT))
+                     .Input(FakeInput(DT_FLOAT))
+                     .Attr("extrapolation_value", extrapolation_value)
+                     .Finalize(node_def()));
+    TF_EXPECT_OK(InitOp());
+  }
+};
+
+TEST_F(FusedResizeAndNormalizeOpTest, ResizeBilinear) {
+  MakeResizeOp(DT_UINT8, DT_FLOAT, /*align_corners=*/true,
+               /*scale_is_divisor=*/true);
+  AddInputFromArray<uint8>(TensorShape({1, 2, 2, 1}), {0, 100, 200, 250});
+  AddInputFromArray<int32>(TensorShape({2}), {3, 3});
+  AddInputFromArray<float>(TensorShape({}), {50});
+  AddInputFromArray<float>(TensorShape({}), {2});
+  TF_ASSERT_OK(RunOpKernel());
+
+  // (ResizeBilinear(images) - 50) / 2.
+  Tensor expected(allocator(), DT_FLOAT, TensorShape({1, 3, 3, 1}));
+  test::FillValues<float>(&expected,
+                          {-25, 0, 25, 25, 43.75, 62.5, 75, 87.5, 100});
+  test::ExpectTensorEqual<float>(expected, *GetOutput(0));
+}
+
+TEST_F(FusedResizeAndNormalizeOpTest, ResizeBilinearPerChannelToBfloat16) {
+  MakeResizeOp(DT_UINT8, DT_BFLOAT16, /*align_corners=*/false,
+               /*scale_is_divisor=*/false);
+  AddInputFromArray<uint8>(TensorShape({1, 1, 1, 2}), {10, 20});
+  AddInputFromArray<int32>(TensorShape({2}), {2, 2});
+  AddInputFromArray<float>(TensorShape({2}), {1, 2});
+  AddInputFromArray<float>(TensorShape({1, 1, 1, 2}), {0.5, 0.25});
+  TF_ASSERT_OK(RunOpKernel());
+
+  // (images - [1, 2]) * [0.5, 0.25].
+  Tensor expected(allocator(), DT_BFLOAT16, TensorShape({1, 2, 2, 2}));
+  test::FillValues<bfloat16>(&expected,
+                             {bfloat16(4.5), bfloat16(4.5), bfloat16(4.5),
+                              bfloat16(4.5), bfloat16(4.5), bfloat16(4.5),
+                              bfloat16(4.5), bfloat16(4.5)});
+  test::ExpectTensorEqual<bfloat16>(expected, *GetOutput(0));
+}
+
+TEST_F(FusedResizeAndNormalizeOpTest, ResizeBilinearToSameSizeCopies) {
+  MakeResizeOp(DT_FLOAT, DT_FLOAT, /*align_corners=*/false,
+               /*scale_is_divisor=*/true);
+  const float inf = std::numeric_limits<float>::infinity();
+  AddInputFromArray<float>(TensorShape({1, 1, 2, 1}), {inf, 3});
+  AddInputFromArray<int32>(TensorShape({2}), {1, 2});
+  AddInputFromArray<float>(TensorShape({}), {1});
+  AddInputFromArray<float>(TensorShape({}), {2});
+  TF_ASSERT_OK(RunOpKernel());
+
+  // Infinities are not interpolated into NaNs.
+  Tensor expected(allocator(), DT_FLOAT, TensorShape({1, 1, 2, 1}));
+  test::FillValues<float>(&expected, {inf, 1});
+  test::ExpectTensorEqual<float>(expected, *GetOutput(0));
+}
+
+TEST_F(FusedResizeAndNormalizeOpTest, ResizeBilinearBadScale) {
+  MakeResizeOp(DT_UINT8, DT_FLOAT, /*align_corners=*/false,
+               /*scale_is_divisor=*/true);
+  AddInputFromArray<uint8>(TensorShape({1, 1, 1, 3}), {1, 2, 3});
+  AddInputFromArray<int32>(TensorShape({2}), {2, 2});
+  AddInputFromArray<float>(TensorShape({}), {0});
+  AddInputFromArray<float>(TensorShape({2}), {1, 2});
+  Status s = RunOpKernel();
+  EXPECT_TRUE(absl::StrContains(s.message(),
+                                "must hold 1 or 3 values along their last"))
+      << s;
+}
+
+TEST_F(FusedResizeAndNormalizeOpTest, CropAndResize) {
+  MakeCropOp(/*extrapolation_value=*/-1);
+  AddInputFromArray<uint8>(TensorShape({1, 2, 2, 1}), {1, 2, 3, 4});
+  AddInputFromArray<float>(TensorShape({2, 4}), {0, 0, 1, 1, 0, 0, 2, 2});
+  AddInputFromArray<int32>(TensorShape({2}), {0, 0});
+  AddInputFromArray<int32>(TensorShape({2}), {3, 3});
+  AddInputFromArray<float>(TensorShape({}), {1});
+  AddInputFromArray<float>(TensorShape({}), {2});
+  TF_ASSERT_OK(RunOpKernel());
+
+  // (CropAndResize(image) - 1) / 2, with the extrapolated values normalized
+  // too.
+  Tensor expected(allocator(), DT_FLOAT, TensorShape({2, 3, 3, 1}));
+  test::FillValues<float>(&expected,
+                          {0, 0.25, 0.5, 0.5, 0.75, 1, 1, 1.25, 1.5,  //
+                           0, 0.5, -1, 1, 1.5, -1, -1, -1, -1});
+  test::ExpectTensorEqual<float>(expected, *GetOutput(0));
+}
+
+TEST_F(FusedResizeAndNormalizeOpTest, CropAndResizeBadBoxIndex) {
+  MakeCropOp(/*extrapolation_value=*/0);
+  AddInputFromArray<uint8>(TensorShape({1, 2, 2, 1}), {1, 2, 3, 4});
+  AddInputFromArray<float>(TensorShape({1, 4}), {0, 0, 1, 1});
+  AddInputFromArray<int32>(TensorShape({1}), {1});
+  AddInputFromArray<int32>(TensorShape({2}), {3, 3});
+  AddInputFromArray<float>(TensorShape({}), {0});
+  AddInputFromArray<float>(TensorShape({}), {1});
+  Status s = RunOpKernel();
+  EXPECT_TRUE(absl::StrContains(
+      s.message(), "box_index has values outside [0, batch_size)"))
+      << s;
+}
+
+}  // namespace tensorflow
@@ -22,6 +22,7 @@ limitations under the License.
 #include "tensorflow/core/kernels/list_kernels.h"
 
 #include <algorithm>
+#include <cstring>
 #include <iterator>
 #include <limits>
 #include <memory>
@@ -136,6 +137,69 @@ Status ForwardInputOrCreateNewList(OpKernelContext* c, int32_t input_index,
   return absl::OkStatus();
 }
 
+Status MaybeStoreInListBuffer(OpKernelContext* c, int64_t index,
+                              TensorList* list) {
+  Tensor& value = list->tensors()[index];
+  if (!DataTypeCanUseMemcpy(value.dtype()) || value.NumElements() == 0 ||
+      value.TotalBytes() % Allocator::kAllocatorAlignment != 0) {
+    return absl::OkStatus();
+  }
+  TensorListBuffer* buffer = list->buffer();
+  if (buffer != nullptr && !buffer->HoldsElementsLike(value)) {
+    return absl::OkStatus();
+  }
+  const auto copy_to_slot = [](const TensorListBuffer& buffer, int64_t slot,
+                               Tensor* element) {
+    Tensor slice = buffer.Slot(slot);
+    std::memcpy(const_cast<char*>(slice.tensor_data().data()),
+                element->tensor_data().data(), element->TotalBytes());
+    *element = std::move(slice);
+  };
+
+  if (buffer != nullptr && index < buffer->capacity()) {
+    // The slot of `index` is taken if another list sharing the buffer stored
+    // an element there first.
+    if (buffer->Claim(index)) copy_to_slot(*buffer, index, &value);
+    return absl::OkStatus();
+  }
+
+  int64_t capacity = list->tensors().size();
+  if (buffer != nullptr) capacity = std::max(capacity, 2 * buffer->capacity());
+  if (list->max_num_elements != -1) {
+    capacity = std::min(
+        capacity, std::max<int64_t>(list->max_num_elements,
+                                    list->tensors().size()));
+  }
+  TensorShape buffer_shape = value.shape();
+  TF_RETURN_IF_ERROR(buffer_shape.InsertDimWithStatus(0, capacity));
+  Tensor buffer_tensor;
+  TF_RETURN_IF_ERROR(
+      c->allocate_temp(value.dtype(), buffer_shape, &buffer_tensor));
+  core::RefCountPtr<TensorListBuffer> new_buffer(
+      new TensorListBuffer(std::move(buffer_tensor)));
+  for (int64_t i = 0; i < list->tensors().size(); ++i) {
+    Tensor& element = list->tensors()[i];
+    if (new_buffer->HoldsElementsLike(element) && new_buffer->Claim(i)) {
+      copy_to_slot(*new_buffer, i, &element);
+    }
+  }
+  list->set_buffer(std::move(new_buffer));
+  return absl::OkStatus();
+}
+
+bool GetListBufferSlice(const TensorList& list, int64_t begin, int64_t end,
+                        Tensor* slice) {
+  const TensorListBuffer* buffer = list.buffer();
+  if (buffer == nullptr || begin >= end || end > list.tensors().size()) {
+    return false;
+  }
+  for (int64_t i = begin; i < end; ++i) {
+    if (!buffer->IsSlot(list.tensors()[i], i)) return false;
+  }
+  *slice = buffer->buffer().Slice(begin, end);
+  return true;
+}
+
 class EmptyTensorList : public OpKernel {
  public:
   explicit EmptyTensorList(OpKernelConstruction* ctx) : OpKernel(ctx) {
@@ -187,7 +251,9 @@ REGISTER_KERNEL_BUILDER(Name("EmptyTensorList")
 
 class TensorListPushBack : public OpKernel {
  public:
-  explicit TensorListPushBack(OpKernelConstruction* c) : OpKernel(c) {
+  explicit TensorListPushBack(OpKernelConstruction* c)
+      : OpKernel(c),
+        use_list_buffer_(c->device_type() == DeviceType(DEVICE_CPU)) {
     OP_REQUIRES_OK(c, c->GetAttr("element_dtype", &element_dtype_));
   }
 
@@ -226,10 +292,18 @@ class TensorListPushBack : public OpKernel {
     TensorList* output_list = nullptr;
     OP_REQUIRES_OK(c, ForwardInputOrCreateNewList(c, 0, 0, *l, &output_list));
     output_list->tensors().push_back(input);
+    if (use_list_buffer_) {
+      OP_REQUIRES_OK(c, MaybeStoreInListBuffer(
+                            c, output_list->tensors().size() - 1, output_list));
+    }
   }
 
  private:
   DataType element_dtype_;
+  // Whether elements are stored in the buffer of the list, so that stacking
+  // the list doesn't copy them. Only on CPU, where elements are in host
+  // memory.
+  const bool use_list_buffer_;
 };
 
 REGISTER_KERNEL_BUILDER(Name("TensorListPushBack").Device(DEVICE_CPU),
@@ -444,7 +518,9 @@ REGISTER_KERNEL_BUILDER(
 
 class TensorListSetItem : public OpKernel {
  public:
-  explicit TensorListSetItem(OpKernelConstruction* c) : OpKernel(c) {
+  explicit TensorListSetItem(OpKernelConstruction* c)
+      : OpKernel(c),
+        use_list_buffer_(c->device_type() == DeviceType(DEVICE_CPU)) {
     OP_REQUIRES_OK(c, c->GetAttr("element_dtype", &element_dtype_));
     OP_REQUIRES_OK(c, c->GetAttr("resize_if_index_out_of_bounds",
                                  &resize_if_index_out_of_bounds_));
@@ -481,11 +557,17 @@ class TensorListSetItem : public OpKernel {
       output_list->tensors().resize(index + 1, Tensor(DT_INVALID));
     }
     output_list->tensors()[index] = value;
+    if (use_list_buffer_) {
+      OP_REQUIRES_OK(c, MaybeStoreInListBuffer(c, index, output_list));
+    }
   }
 
  private:
   DataType element_dtype_;
   bool resize_if_index_out_of_bounds_;
+  // Whether elements are stored in the buffer of the list, as in
+  // TensorListPushBack.
+  const bool use_list_buffer_;
 };
 
 REGISTER_KERNEL_BUILDER(Name("TensorListSetItem").Device(DEVICE_CPU),
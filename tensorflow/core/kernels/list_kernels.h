@@ -69,6 +69,22 @@ Status ForwardInputOrCreateNewList(OpKernelContext* c, int32_t input_index,
                                    const TensorList& input_list,
                                    TensorList** output_list);
 
+// Copies element `index` of `list` into a slot of the buffer of `list`, and
+// replaces the element with the slice of the slot, if its dtype can be copied
+// with memcpy and its size keeps the slots aligned. When `index` is past the
+// capacity of the buffer, a buffer of twice the capacity is allocated and all
+// elements of `list` with the same shape and dtype are moved to it. Leaves the
+// element as is otherwise. `list` must be owned by the caller, and its
+// elements must be in host memory.
+Status MaybeStoreInListBuffer(OpKernelContext* c, int64_t index,
+                              TensorList* list);
+
+// Returns true, and sets `*slice` to the slice of the buffer of `list` holding
+// them, if elements [begin, end) of `list` are consecutive slots of its
+// buffer.
+bool GetListBufferSlice(const TensorList& list, int64_t begin, int64_t end,
+                        Tensor* slice);
+
 // TODO(penporn): Move this to a proper place.
 inline bool IsPluggableDevice(OpKernelContext* c) {
   return c->op_device_context() && c->op_device_context()->IsPluggableDevice();
@@ -219,6 +235,18 @@ class TensorListStack : public OpKernel {
                     partial_element_shape.DebugString()));
     TensorShape output_shape = element_shape;
     output_shape.InsertDim(0, tensor_list->tensors().size());
+
+    // If the elements are consecutive slots of the buffer of the list, the
+    // stacked tensor is a slice of the buffer.
+    Tensor buffer_slice;
+    if (std::is_same<Device, CPUDevice>::value && !IsPluggableDevice(c) &&
+        GetListBufferSlice(*tensor_list, 0, tensor_list->tensors().size(),
+                           &buffer_slice) &&
+        buffer_slice.shape() == output_shape) {
+      c->set_output(0, buffer_slice);
+      return;
+    }
+
     Tensor* output;
     OP_REQUIRES_OK(c, c->allocate_output(0, output_shape, &output));
     if (output->NumElements() == 0) {
@@ -716,6 +744,27 @@ class TensorListGather : public OpKernel {
                                 partial_element_shape.DebugString()));
     TensorShape output_shape = element_shape;
     output_shape.InsertDim(0, indices.NumElements());
+
+    // If the indices are a range of consecutive slots of the buffer of the
+    // list, the gathered tensor is a slice of the buffer.
+    if (std::is_same<Device, CPUDevice>::value && !IsPluggableDevice(c) &&
+        indices.NumElements() > 0) {
+      const auto indices_flat = indices.flat<int32>();
+      const int64_t begin = indices_flat(0);
+      bool is_range = begin >= 0;
+      for (int index = 1; is_range && index < indices.NumElements(); ++index) {
+        is_range = indices_flat(index) == begin + index;
+      }
+      Tensor buffer_slice;
+      if (is_range &&
+          GetListBufferSlice(*tensor_list, begin,
+                             begin + indices.NumElements(), &buffer_slice) &&
+          buffer_slice.shape() == output_shape) {
+        c->set_output(0, buffer_slice);
+        return;
+      }
+    }
+
     Tensor* output;
     OP_REQUIRES_OK(c, c->allocate_output(0, output_shape, &output));
     if (output->NumElements() == 0) {
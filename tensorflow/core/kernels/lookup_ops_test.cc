@@ -15,15 +15,21 @@ limitations under the License.
 
 // Tests kernels of lookup ops.
 
+#include <vector>
+
+#include "absl/strings/str_cat.h"
 #include "tensorflow/core/framework/fake_input.h"
 #include "tensorflow/core/framework/lookup_interface.h"
 #include "tensorflow/core/framework/node_def_builder.h"
 #include "tensorflow/core/framework/op.h"
 #include "tensorflow/core/framework/shape_inference_testutil.h"
+#include "tensorflow/core/framework/tensor_testutil.h"
 #include "tensorflow/core/framework/types.h"
 #include "tensorflow/core/kernels/lookup_table_op.h"
 #include "tensorflow/core/kernels/ops_testutil.h"
 #include "tensorflow/core/lib/core/status_test_util.h"
+#include "tensorflow/core/lib/core/threadpool.h"
+#include "tensorflow/core/lib/gtl/map_util.h"
 #include "tensorflow/core/platform/test.h"
 
 namespace tensorflow {
@@ -100,5 +106,92 @@ TEST_F(LookupOpsTest, AnonymousHashTable_RefCounting) {
   EXPECT_FALSE(alive);
 }
 
+using Int64Map = lookup::ShardedHashMap<int64_t, int64_t>;
+
+TEST(ShardedHashMapTest, InsertFindRemove) {
+  Int64Map map;
+  Tensor keys = test::AsTensor<int64_t>({1, 2, 3, 1, 100, 7});
+  const auto key_values = keys.flat<int64_t>();
+  map.MutateEachKey(key_values,
+                    [](Int64Map::Map& shard, int64_t i, const int64_t& key) {
+                      // The second 1 overwrites the first one.
+                      shard[key] = 10 * i;
+                    });
+  EXPECT_EQ(map.size(), 5);
+
+  std::vector<int64_t> found(key_values.size(), -1);
+  map.ForEachKey(key_values, [&](const Int64Map::Map& shard, int64_t i,
+                                 const int64_t& key) {
+    EXPECT_EQ(Int64Map::ShardOf(key), Int64Map::ShardOf(key_values(i)));
+    found[i] = gtl::FindWithDefault(shard, key, -1);
+  });
+  EXPECT_EQ(found, std::vector<int64_t>({30, 10, 20, 30, 40, 50}));
+
+  Tensor removed = test::AsTensor<int64_t>({2, 100, 5});
+  map.MutateEachKey(removed.flat<int64_t>(),
+                    [](Int64Map::Map& shard, int64_t i, const int64_t& key) {
+                      shard.erase(key);
+                    });
+  EXPECT_EQ(map.size(), 3);
+}
+
+TEST(ShardedHashMapTest, ReadAllSeesEveryShard) {
+  lookup::ShardedHashMap<tstring, int64_t> map;
+  constexpr int kNumKeys = 1000;
+  std::vector<tstring> key_vec;
+  for (int i = 0; i < kNumKeys; ++i) key_vec.push_back(absl::StrCat("k", i));
+  Tensor keys = test::AsTensor<tstring>(key_vec);
+  map.MutateEachKey(keys.flat<tstring>(),
+                    [](auto& shard, int64_t i, const tstring& key) {
+                      shard[key] = i;
+                    });
+  int num_nonempty_shards = 0;
+  int64_t sum = 0;
+  TF_EXPECT_OK(map.ReadAll([&](const auto& shards) {
+    for (const auto* shard : shards) {
+      if (!shard->empty()) ++num_nonempty_shards;
+      for (const auto& [key, value] : *shard) {
+        EXPECT_EQ(key, absl::StrCat("k", value));
+        sum += value;
+      }
+    }
+    return absl::OkStatus();
+  }));
+  EXPECT_EQ(num_nonempty_shards, decltype(map)::kNumShards);
+  EXPECT_EQ(sum, kNumKeys * (kNumKeys - 1) / 2);
+
+  TF_EXPECT_OK(map.WriteAll([](const auto& shards) {
+    for (auto* shard : shards) shard->clear();
+    return absl::OkStatus();
+  }));
+  EXPECT_EQ(map.size(), 0);
+}
+
+TEST(ShardedHashMapTest, ConcurrentInsertAndFind) {
+  Int64Map map;
+  constexpr int kNumThreads = 8;
+  constexpr int kNumKeys = 256;
+  {
+    thread::ThreadPool pool(Env::Default(), "test", kNumThreads);
+    for (int t = 0; t < kNumThreads; ++t) {
+      pool.Schedule([&map, t]() {
+        std::vector<int64_t> key_vec;
+        for (int i = 0; i < kNumKeys; ++i) key_vec.push_back(t * kNumKeys + i);
+        Tensor keys = test::AsTensor<int64_t>(key_vec);
+        map.MutateEachKey(
+            keys.flat<int64_t>(),
+            [](Int64Map::Map& shard, int64_t i, const int64_t& key) {
+              shard[key] = key + 1;
+            });
+        map.ForEachKey(keys.flat<int64_t>(), [](const Int64Map::Map& shard,
+                                                int64_t i, const int64_t& key) {
+          EXPECT_EQ(gtl::FindWithDefault(shard, key, -1), key + 1);
+        });
+      });
+    }
+  }
+  EXPECT_EQ(map.size(), kNumThreads * kNumKeys);
+}
+
 }  // namespace
 }  // namespace tensorflow
@@ -16,10 +16,13 @@ limitations under the License.
 #include "tensorflow/core/kernels/lookup_table_op.h"
 #define EIGEN_USE_THREADS
 
+#include <algorithm>
 #include <string>
 #include <type_traits>
 #include <utility>
+#include <vector>
 
+#include "absl/base/prefetch.h"
 #include "tensorflow/core/framework/register_types.h"
 #include "tensorflow/core/framework/types.h"
 #include "tensorflow/core/framework/variant.h"
@@ -36,11 +39,12 @@ std::string UniqueNodeName(const std::string& base) {
   return strings::StrCat(base, "/", counter.fetch_add(1), "/", random::New64());
 }
 
-// Lookup table that wraps an unordered_map, where the key and value data type
+// Lookup table that wraps a ShardedHashMap, where the key and value data type
 // is specified. Each individual value must be a scalar. If vector values are
 // required, use MutableHashTableOfTensors.
 //
 // This table is mutable and thread safe - Insert can be called at any time.
+// Lookups and insertions only contend on keys of the same shard.
 //
 // Sample use case:
 //
@@ -55,10 +59,7 @@ class MutableHashTableOfScalars final : public LookupInterface {
  public:
   MutableHashTableOfScalars(OpKernelContext* ctx, OpKernel* kernel) {}
 
-  size_t size() const override {
-    tf_shared_lock l(mu_);
-    return table_.size();
-  }
+  size_t size() const override { return table_.size(); }
 
   Status Find(OpKernelContext* ctx, const Tensor& key, Tensor* value,
               const Tensor& default_value) override {
@@ -70,8 +71,8 @@ class MutableHashTableOfScalars final : public LookupInterface {
     int64_t default_total = default_flat.size();
     bool is_full_size_default = (total == default_total);
 
-    tf_shared_lock l(mu_);
-    for (int64_t i = 0; i < key_values.size(); ++i) {
+    table_.ForEachKey(key_values, [&](const Map& map, int64_t i,
+                                      const K& key) {
       // is_full_size_default is true:
       //   Each key has an independent default value, key_values(i)
       //   corresponding uses default_flat(i) as its default value.
@@ -79,60 +80,58 @@ class MutableHashTableOfScalars final : public LookupInterface {
       // is_full_size_default is false:
       //   All keys will share the default_flat(0) as default value.
       value_values(i) = gtl::FindWithDefault(
-          table_, SubtleMustCopyIfIntegral(key_values(i)),
-          is_full_size_default ? default_flat(i) : default_flat(0));
-    }
-
-    return absl::OkStatus();
-  }
-
-  Status DoInsert(bool clear, const Tensor& keys, const Tensor& values) {
-    const auto key_values = keys.flat<K>();
-    const auto value_values = values.flat<V>();
+          map, key, is_full_size_default ? default_flat(i) : default_flat(0));
+    });
 
-    mutex_lock l(mu_);
-    if (clear) {
-      table_.clear();
-    }
-    for (int64_t i = 0; i < key_values.size(); ++i) {
-      gtl::InsertOrUpdate(&table_, SubtleMustCopyIfIntegral(key_values(i)),
-                          SubtleMustCopyIfIntegral(value_values(i)));
-    }
     return absl::OkStatus();
   }
 
   Status Insert(OpKernelContext* ctx, const Tensor& keys,
                 const Tensor& values) override {
-    return DoInsert(false, keys, values);
+    const auto value_values = values.flat<V>();
+    table_.MutateEachKey(keys.flat<K>(), [&](Map& map, int64_t i,
+                                             const K& key) {
+      gtl::InsertOrUpdate(&map, key, SubtleMustCopyIfIntegral(value_values(i)));
+    });
+    return absl::OkStatus();
   }
 
   Status Remove(OpKernelContext* ctx, const Tensor& keys) override {
-    const auto key_values = keys.flat<K>();
-
-    mutex_lock l(mu_);
-    for (int64_t i = 0; i < key_values.size(); ++i) {
-      table_.erase(SubtleMustCopyIfIntegral(key_values(i)));
-    }
+    table_.MutateEachKey(keys.flat<K>(),
+                         [](Map& map, int64_t i, const K& key) {
+                           map.erase(key);
+                         });
     return absl::OkStatus();
   }
 
   Status ImportValues(OpKernelContext* ctx, const Tensor& keys,
                       const Tensor& values) override {
-    return DoInsert(true, keys, values);
+    const auto key_values = keys.flat<K>();
+    const auto value_values = values.flat<V>();
+    return table_.WriteAll([&](const std::array<Map*, kNumShards>& maps) {
+      for (Map* map : maps) map->clear();
+      for (int64_t i = 0; i < key_values.size(); ++i) {
+        const K key = SubtleMustCopyIfIntegral(key_values(i));
+        gtl::InsertOrUpdate(maps[Table::ShardOf(key)], key,
+                            SubtleMustCopyIfIntegral(value_values(i)));
+      }
+      return absl::OkStatus();
+    });
   }
 
   Status ExportValues(OpKernelContext* ctx) override {
-    tf_shared_lock l(mu_);
-    int64_t size = table_.size();
-
-    Tensor* keys;
-    Tensor* values;
-    TF_RETURN_IF_ERROR(
-        ctx->allocate_output("keys", TensorShape({size}), &keys));
-    TF_RETURN_IF_ERROR(
-        ctx->allocate_output("values", TensorShape({size}), &values));
-    ExportKeysAndValues(keys, values);
-    return absl::OkStatus();
+    return table_.ReadAll([&](const std::array<const Map*, kNumShards>& maps) {
+      int64_t size = TotalSize(maps);
+
+      Tensor* keys;
+      Tensor* values;
+      TF_RETURN_IF_ERROR(
+          ctx->allocate_output("keys", TensorShape({size}), &keys));
+      TF_RETURN_IF_ERROR(
+          ctx->allocate_output("values", TensorShape({size}), &values));
+      ExportKeysAndValues(maps, keys, values);
+      return absl::OkStatus();
+    });
   }
 
   DataType key_dtype() const override { return DataTypeToEnum<K>::v(); }
@@ -145,24 +144,28 @@ class MutableHashTableOfScalars final : public LookupInterface {
 
   int64_t MemoryUsed() const override {
     int64_t ret = 0;
-    tf_shared_lock l(mu_);
-    for (unsigned i = 0; i < table_.bucket_count(); ++i) {
-      size_t bucket_size = table_.bucket_size(i);
-      if (bucket_size == 0) {
-        ret++;
-      } else {
-        ret += bucket_size;
-      }
-    }
+    table_
+        .ReadAll([&](const std::array<const Map*, kNumShards>& maps) {
+          for (const Map* map : maps) {
+            ret += map->capacity() * (sizeof(typename Map::value_type) + 1);
+          }
+          return absl::OkStatus();
+        })
+        .IgnoreError();
     return sizeof(MutableHashTableOfScalars) + ret;
   }
 
   Status AsGraphDef(GraphDefBuilder* builder, Node** out) const override {
-    tf_shared_lock l(mu_);
-    int64_t size = table_.size();
-    Tensor keys(key_dtype(), TensorShape({size}));
-    Tensor values(value_dtype(), TensorShape({size}));
-    ExportKeysAndValues(&keys, &values);
+    Tensor keys;
+    Tensor values;
+    TF_RETURN_IF_ERROR(
+        table_.ReadAll([&](const std::array<const Map*, kNumShards>& maps) {
+          int64_t size = TotalSize(maps);
+          keys = Tensor(key_dtype(), TensorShape({size}));
+          values = Tensor(value_dtype(), TensorShape({size}));
+          ExportKeysAndValues(maps, &keys, &values);
+          return absl::OkStatus();
+        }));
 
     // We set use_node_name_sharing with a unique node name so that the resource
     // can outlive the MutableHashTableV2 kernel. This means that the lifetime
@@ -195,24 +198,36 @@ class MutableHashTableOfScalars final : public LookupInterface {
   }
 
  private:
+  typedef ShardedHashMap<K, V> Table;
+  typedef typename Table::Map Map;
+  static constexpr int kNumShards = Table::kNumShards;
+
+  static int64_t TotalSize(const std::array<const Map*, kNumShards>& maps) {
+    int64_t size = 0;
+    for (const Map* map : maps) size += map->size();
+    return size;
+  }
+
   // Writes all keys and values into `keys` and `values`. `keys` and `values`
-  // must point to tensors of size `table_.size()`.
-  void ExportKeysAndValues(Tensor* keys, Tensor* values) const
-      TF_SHARED_LOCKS_REQUIRED(mu_) {
+  // must point to tensors of size `TotalSize(maps)`.
+  static void ExportKeysAndValues(
+      const std::array<const Map*, kNumShards>& maps, Tensor* keys,
+      Tensor* values) {
     auto keys_data = keys->flat<K>();
     auto values_data = values->flat<V>();
     int64_t i = 0;
-    for (auto it = table_.begin(); it != table_.end(); ++it, ++i) {
-      keys_data(i) = it->first;
-      values_data(i) = it->second;
+    for (const Map* map : maps) {
+      for (auto it = map->begin(); it != map->end(); ++it, ++i) {
+        keys_data(i) = it->first;
+        values_data(i) = it->second;
+      }
     }
   }
 
-  mutable mutex mu_;
-  std::unordered_map<K, V> table_ TF_GUARDED_BY(mu_);
+  Table table_;
 };
 
-// Lookup table that wraps an unordered_map. Behaves identical to
+// Lookup table that wraps a ShardedHashMap. Behaves identical to
 // MutableHashTableOfScalars except that each value must be a vector.
 template <class K, class V>
 class MutableHashTableOfTensors final : public LookupInterface {
@@ -226,10 +241,7 @@ class MutableHashTableOfTensors final : public LookupInterface {
                                 value_shape_.DebugString()));
   }
 
-  size_t size() const override {
-    tf_shared_lock l(mu_);
-    return table_.size();
-  }
+  size_t size() const override { return table_.size(); }
 
   Status Find(OpKernelContext* ctx, const Tensor& key, Tensor* value,
               const Tensor& default_value) override {
@@ -242,10 +254,9 @@ class MutableHashTableOfTensors final : public LookupInterface {
     int64_t default_total = default_flat.size();
     bool is_full_size_default = (total == default_total);
 
-    tf_shared_lock l(mu_);
-    for (int64_t i = 0; i < key_values.size(); ++i) {
-      ValueArray* value_vec =
-          gtl::FindOrNull(table_, SubtleMustCopyIfIntegral(key_values(i)));
+    table_.ForEachKey(key_values, [&](const Map& map, int64_t i,
+                                      const K& key) {
+      const ValueArray* value_vec = gtl::FindOrNull(map, key);
       if (value_vec != nullptr) {
         for (int64_t j = 0; j < value_dim; j++) {
           value_values(i, j) = value_vec->at(j);
@@ -262,65 +273,58 @@ class MutableHashTableOfTensors final : public LookupInterface {
               is_full_size_default ? default_flat(i, j) : default_flat(0, j);
         }
       }
-    }
-
-    return absl::OkStatus();
-  }
-
-  Status DoInsert(bool clear, const Tensor& keys, const Tensor& values) {
-    const auto key_values = keys.flat<K>();
-    const auto value_values = values.flat_inner_dims<V, 2>();
-    int64_t value_dim = value_shape_.dim_size(0);
+    });
 
-    mutex_lock l(mu_);
-    if (clear) {
-      table_.clear();
-    }
-    for (int64_t i = 0; i < key_values.size(); ++i) {
-      ValueArray value_vec;
-      for (int64_t j = 0; j < value_dim; j++) {
-        V value = value_values(i, j);
-        value_vec.push_back(value);
-      }
-      gtl::InsertOrUpdate(&table_, SubtleMustCopyIfIntegral(key_values(i)),
-                          value_vec);
-    }
     return absl::OkStatus();
   }
 
   Status Insert(OpKernelContext* ctx, const Tensor& keys,
                 const Tensor& values) override {
-    return DoInsert(false, keys, values);
+    const auto value_values = values.flat_inner_dims<V, 2>();
+    table_.MutateEachKey(keys.flat<K>(), [&](Map& map, int64_t i,
+                                             const K& key) {
+      gtl::InsertOrUpdate(&map, key, MakeValueArray(value_values, i));
+    });
+    return absl::OkStatus();
   }
 
   Status Remove(OpKernelContext* ctx, const Tensor& keys) override {
-    const auto key_values = keys.flat<K>();
-
-    mutex_lock l(mu_);
-    for (int64_t i = 0; i < key_values.size(); ++i) {
-      table_.erase(SubtleMustCopyIfIntegral(key_values(i)));
-    }
+    table_.MutateEachKey(keys.flat<K>(),
+                         [](Map& map, int64_t i, const K& key) {
+                           map.erase(key);
+                         });
     return absl::OkStatus();
   }
 
   Status ImportValues(OpKernelContext* ctx, const Tensor& keys,
                       const Tensor& values) override {
-    return DoInsert(true, keys, values);
+    const auto key_values = keys.flat<K>();
+    const auto value_values = values.flat_inner_dims<V, 2>();
+    return table_.WriteAll([&](const std::array<Map*, kNumShards>& maps) {
+      for (Map* map : maps) map->clear();
+      for (int64_t i = 0; i < key_values.size(); ++i) {
+        const K key = SubtleMustCopyIfIntegral(key_values(i));
+        gtl::InsertOrUpdate(maps[Table::ShardOf(key)], key,
+                            MakeValueArray(value_values, i));
+      }
+      return absl::OkStatus();
+    });
   }
 
   Status ExportValues(OpKernelContext* ctx) override {
-    tf_shared_lock l(mu_);
-    int64_t size = table_.size();
     int64_t value_dim = value_shape_.dim_size(0);
-
-    Tensor* keys;
-    Tensor* values;
-    TF_RETURN_IF_ERROR(
-        ctx->allocate_output("keys", TensorShape({size}), &keys));
-    TF_RETURN_IF_ERROR(ctx->allocate_output(
-        "values", TensorShape({size, value_dim}), &values));
-    ExportKeysAndValues(keys, values);
-    return absl::OkStatus();
+    return table_.ReadAll([&](const std::array<const Map*, kNumShards>& maps) {
+      int64_t size = TotalSize(maps);
+
+      Tensor* keys;
+      Tensor* values;
+      TF_RETURN_IF_ERROR(
+          ctx->allocate_output("keys", TensorShape({size}), &keys));
+      TF_RETURN_IF_ERROR(ctx->allocate_output(
+          "values", TensorShape({size, value_dim}), &values));
+      ExportKeysAndValues(maps, keys, values);
+      return absl::OkStatus();
+    });
   }
 
   DataType key_dtype() const override { return DataTypeToEnum<K>::v(); }
@@ -333,24 +337,29 @@ class MutableHashTableOfTensors final : public LookupInterface {
 
   int64_t MemoryUsed() const override {
     int64_t ret = 0;
-    tf_shared_lock l(mu_);
-    for (unsigned i = 0; i < table_.bucket_count(); ++i) {
-      size_t bucket_size = table_.bucket_size(i);
-      if (bucket_size == 0) {
-        ret++;
-      } else {
-        ret += bucket_size;
-      }
-    }
+    table_
+        .ReadAll([&](const std::array<const Map*, kNumShards>& maps) {
+          for (const Map* map : maps) {
+            ret += map->capacity() * (sizeof(typename Map::value_type) + 1);
+          }
+          return absl::OkStatus();
+        })
+        .IgnoreError();
     return sizeof(MutableHashTableOfTensors) + ret;
   }
 
   Status AsGraphDef(GraphDefBuilder* builder, Node** out) const override {
-    tf_shared_lock l(mu_);
-    int64_t size = table_.size();
-    Tensor keys(key_dtype(), TensorShape({size}));
-    Tensor values(value_dtype(), TensorShape({size, value_shape_.dim_size(0)}));
-    ExportKeysAndValues(&keys, &values);
+    Tensor keys;
+    Tensor values;
+    TF_RETURN_IF_ERROR(
+        table_.ReadAll([&](const std::array<const Map*, kNumShards>& maps) {
+          int64_t size = TotalSize(maps);
+          keys = Tensor(key_dtype(), TensorShape({size}));
+          values = Tensor(value_dtype(),
+                          TensorShape({size, value_shape_.dim_size(0)}));
+          ExportKeysAndValues(maps, &keys, &values);
+          return absl::OkStatus();
+        }));
 
     // We set use_node_name_sharing with a unique node name so that the resource
     // can outlive the MutableHashTableOfTensorsV2 kernel. This means that the
@@ -384,28 +393,50 @@ class MutableHashTableOfTensors final : public LookupInterface {
   }
 
  private:
+  typedef gtl::InlinedVector<V, 4> ValueArray;
+  typedef ShardedHashMap<K, ValueArray> Table;
+  typedef typename Table::Map Map;
+  static constexpr int kNumShards = Table::kNumShards;
+
+  ValueArray MakeValueArray(
+      const typename TTypes<V, 2>::ConstTensor& value_values, int64_t i) const {
+    int64_t value_dim = value_shape_.dim_size(0);
+    ValueArray value_vec;
+    for (int64_t j = 0; j < value_dim; j++) {
+      V value = value_values(i, j);
+      value_vec.push_back(value);
+    }
+    return value_vec;
+  }
+
+  static int64_t TotalSize(const std::array<const Map*, kNumShards>& maps) {
+    int64_t size = 0;
+    for (const Map* map : maps) size += map->size();
+    return size;
+  }
+
   // Writes all keys and values into `keys` and `values`. `keys` and `values`
-  // must point to tensors of size `table_.size()`.
-  void ExportKeysAndValues(Tensor* keys, Tensor* values) const
-      TF_SHARED_LOCKS_REQUIRED(mu_) {
+  // must point to tensors of size `TotalSize(maps)`.
+  void ExportKeysAndValues(const std::array<const Map*, kNumShards>& maps,
+                           Tensor* keys, Tensor* values) const {
     int64_t value_dim = value_shape_.dim_size(0);
     auto keys_data = keys->flat<K>();
     auto values_data = values->matrix<V>();
     int64_t i = 0;
-    for (auto it = table_.begin(); it != table_.end(); ++it, ++i) {
-      K key = it->first;
-      ValueArray value = it->second;
-      keys_data(i) = key;
-      for (int64_t j = 0; j < value_dim; j++) {
-        values_data(i, j) = value[j];
+    for (const Map* map : maps) {
+      for (auto it = map->begin(); it != map->end(); ++it, ++i) {
+        K key = it->first;
+        const ValueArray& value = it->second;
+        keys_data(i) = key;
+        for (int64_t j = 0; j < value_dim; j++) {
+          values_data(i, j) = value[j];
+        }
       }
     }
   }
 
   TensorShape value_shape_;
-  mutable mutex mu_;
-  typedef gtl::InlinedVector<V, 4> ValueArray;
-  std::unordered_map<K, ValueArray> table_ TF_GUARDED_BY(mu_);
+  Table table_;
 };
 
 namespace {
@@ -520,9 +551,30 @@ class MutableDenseHashTable final : public LookupInterface {
     const auto deleted_key_matrix =
         deleted_key_.template shaped<K, 2>({1, key_size});
     const int64_t bit_mask = num_buckets_ - 1;
+    // The keys are hashed up front, so that the first buckets of the keys
+    // kPrefetchDistance ahead are prefetched while the current key is probed.
+    // Lookups of large tables are otherwise bound by the latency of a cache
+    // miss per key.
+    std::vector<uint64> key_hashes(num_elements);
+    for (int64_t i = 0; i < num_elements; ++i) {
+      key_hashes[i] = HashKey(key_matrix, i);
+    }
+    auto prefetch_bucket = [&](int64_t bucket_index) {
+      absl::PrefetchToLocalCache(&tags_[bucket_index]);
+      absl::PrefetchToLocalCache(&key_buckets_matrix(bucket_index, 0));
+      if (value_size > 0) {
+        absl::PrefetchToLocalCache(&value_buckets_matrix(bucket_index, 0));
+      }
+    };
+    for (int64_t i = 0; i < std::min(num_elements, kPrefetchDistance); ++i) {
+      prefetch_bucket(key_hashes[i] & bit_mask);
+    }
     // TODO(andreasst): parallelize using work_sharder
     for (int64_t i = 0; i < num_elements; ++i) {
-      const uint64 key_hash = HashKey(key_matrix, i);
+      if (i + kPrefetchDistance < num_elements) {
+        prefetch_bucket(key_hashes[i + kPrefetchDistance] & bit_mask);
+      }
+      const uint64 key_hash = key_hashes[i];
       if (empty_key_hash_ == key_hash &&
           IsEqualKey(empty_key_matrix, 0, key_matrix, i)) {
         return errors::InvalidArgument(
@@ -533,10 +585,13 @@ class MutableDenseHashTable final : public LookupInterface {
         return errors::InvalidArgument(
             "Using the deleted_key as a table key is not allowed");
       }
+      const uint8 tag = TagOf(key_hash);
       int64_t bucket_index = key_hash & bit_mask;
       int64_t num_probes = 0;
       while (true) {
-        if (IsEqualKey(key_buckets_matrix, bucket_index, key_matrix, i)) {
+        const uint8 bucket_tag = tags_[bucket_index];
+        if (bucket_tag == tag &&
+            IsEqualKey(key_buckets_matrix, bucket_index, key_matrix, i)) {
           for (int64_t j = 0; j < value_size; ++j) {
             // TODO(andreasst): check if we can get rid of SubtleMustCopy
             // here and elsewhere in this file.
@@ -545,7 +600,7 @@ class MutableDenseHashTable final : public LookupInterface {
           }
           break;
         }
-        if (IsEqualKey(key_buckets_matrix, bucket_index, empty_key_matrix, 0)) {
+        if (bucket_tag == kEmptyTag) {
           for (int64_t j = 0; j < value_size; ++j) {
             value_matrix(i, j) = SubtleMustCopyIfIntegral(default_flat(j));
           }
@@ -617,10 +672,16 @@ class MutableDenseHashTable final : public LookupInterface {
     const auto deleted_key_tensor =
         deleted_key_.template shaped<K, 2>({1, key_shape_.num_elements()});
     const auto key_buckets_tensor = key_buckets_.template matrix<K>();
+    const auto keys_matrix = keys.matrix<K>();
+    tags_.resize(num_buckets_);
     for (int64_t i = 0; i < num_buckets_; ++i) {
-      if (!IsEqualKey(key_buckets_tensor, i, empty_key_tensor, 0) &&
-          !IsEqualKey(key_buckets_tensor, i, deleted_key_tensor, 0)) {
+      if (IsEqualKey(key_buckets_tensor, i, empty_key_tensor, 0)) {
+        tags_[i] = kEmptyTag;
+      } else if (IsEqualKey(key_buckets_tensor, i, deleted_key_tensor, 0)) {
+        tags_[i] = kDeletedTag;
+      } else {
         ++num_entries_;
+        tags_[i] = TagOf(HashKey(keys_matrix, i));
       }
     }
     return absl::OkStatus();
@@ -669,7 +730,8 @@ class MutableDenseHashTable final : public LookupInterface {
   int64_t MemoryUsed() const override TF_LOCKS_EXCLUDED(mu_) {
     tf_shared_lock l(mu_);
     return sizeof(MutableDenseHashTable) + key_buckets_.AllocatedBytes() +
-           value_buckets_.AllocatedBytes() + empty_key_.AllocatedBytes();
+           value_buckets_.AllocatedBytes() + empty_key_.AllocatedBytes() +
+           tags_.capacity();
   }
 
  private:
@@ -707,20 +769,22 @@ class MutableDenseHashTable final : public LookupInterface {
         return errors::InvalidArgument(
             "Using the deleted_key as a table key is not allowed");
       }
+      const uint8 tag = TagOf(key_hash);
       int64_t bucket_index = key_hash & bit_mask;
       int64_t num_probes = 0;
       while (true) {
-        if (IsEqualKey(key_buckets_matrix, bucket_index, key_matrix, i)) {
+        const uint8 bucket_tag = tags_[bucket_index];
+        if (bucket_tag == tag &&
+            IsEqualKey(key_buckets_matrix, bucket_index, key_matrix, i)) {
           for (int64_t j = 0; j < value_size; ++j) {
             value_buckets_matrix(bucket_index, j) =
                 SubtleMustCopyIfIntegral(value_matrix(i, j));
           }
           break;
         }
-        if (IsEqualKey(key_buckets_matrix, bucket_index, empty_key_tensor, 0) ||
-            IsEqualKey(key_buckets_matrix, bucket_index, deleted_key_tensor,
-                       0)) {
+        if (bucket_tag == kEmptyTag || bucket_tag == kDeletedTag) {
           ++num_entries_;
+          tags_[bucket_index] = tag;
           for (int64_t j = 0; j < key_size; ++j) {
             key_buckets_matrix(bucket_index, j) =
                 SubtleMustCopyIfIntegral(key_matrix(i, j));
@@ -768,18 +832,22 @@ class MutableDenseHashTable final : public LookupInterface {
         return errors::InvalidArgument(
             "Using the deleted_key as a table key is not allowed");
       }
+      const uint8 tag = TagOf(key_hash);
       int64_t bucket_index = key_hash & bit_mask;
       int64_t num_probes = 0;
       while (true) {
-        if (IsEqualKey(key_buckets_matrix, bucket_index, key_matrix, i)) {
+        const uint8 bucket_tag = tags_[bucket_index];
+        if (bucket_tag == tag &&
+            IsEqualKey(key_buckets_matrix, bucket_index, key_matrix, i)) {
           --num_entries_;
+          tags_[bucket_index] = kDeletedTag;
           for (int64_t j = 0; j < key_size; ++j) {
             key_buckets_matrix(bucket_index, j) =
                 SubtleMustCopyIfIntegral(deleted_key_flat(j));
           }
           break;
         }
-        if (IsEqualKey(key_buckets_matrix, bucket_index, empty_key_tensor, 0)) {
+        if (bucket_tag == kEmptyTag) {
           break;
         }
         ++num_probes;
@@ -815,6 +883,7 @@ class MutableDenseHashTable final : public LookupInterface {
         key_buckets_matrix(i, j) = empty_key_flat(j);
       }
     }
+    tags_.assign(num_buckets_, kEmptyTag);
 
     const int64_t value_size = value_shape_.num_elements();
 
@@ -840,6 +909,25 @@ class MutableDenseHashTable final : public LookupInterface {
     return DoInsert(ctx, old_key_buckets, old_value_buckets, true);
   }
 
+  // The number of keys ahead of the probed one whose buckets Find() prefetches.
+  static constexpr int64_t kPrefetchDistance = 8;
+
+  // Each bucket has a tag that is kEmptyTag if its key is the empty_key,
+  // kDeletedTag if it is the deleted_key, and TagOf() the hash of its key
+  // otherwise. Probing reads the dense tags and only compares the keys of
+  // buckets with matching tags. The tags are derived from the buckets, so the
+  // exported and imported tensors are unchanged.
+  static constexpr uint8 kEmptyTag = 0;
+  static constexpr uint8 kDeletedTag = 1;
+
+  // Returns a tag in [2, 256) from bits of `key_hash` that, unlike its low
+  // bits, do not select the first bucket of the key. The hash is mixed first
+  // because scalar integer keys are their own hash.
+  static uint8 TagOf(uint64 key_hash) {
+    return 2 + static_cast<uint8>(
+                   ((key_hash * 0x9E3779B97F4A7C15ull) >> 56) % 254);
+  }
+
   uint64 HashKey(typename TTypes<K>::ConstMatrix key, int64_t index) const {
     if (key_shape_.num_elements() == 1) {
       return HashScalar(key(index, 0));
@@ -872,6 +960,7 @@ class MutableDenseHashTable final : public LookupInterface {
   int64_t num_buckets_ TF_GUARDED_BY(mu_);
   Tensor key_buckets_ TF_GUARDED_BY(mu_);
   Tensor value_buckets_ TF_GUARDED_BY(mu_);
+  std::vector<uint8> tags_ TF_GUARDED_BY(mu_);
   Tensor empty_key_;
   uint64 empty_key_hash_;
   Tensor deleted_key_;
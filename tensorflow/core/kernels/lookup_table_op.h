@@ -16,7 +16,15 @@ limitations under the License.
 #ifndef TENSORFLOW_CORE_KERNELS_LOOKUP_TABLE_OP_H_
 #define TENSORFLOW_CORE_KERNELS_LOOKUP_TABLE_OP_H_
 
+#include <array>
+#include <cstdint>
+#include <type_traits>
+#include <vector>
+
+#include "absl/base/optimization.h"
 #include "absl/container/flat_hash_map.h"
+#include "absl/hash/hash.h"
+#include "absl/types/span.h"
 #include "tensorflow/core/framework/bounds_check.h"
 #include "tensorflow/core/framework/lookup_interface.h"
 #include "tensorflow/core/framework/op_kernel.h"
@@ -30,6 +38,7 @@ limitations under the License.
 #include "tensorflow/core/lib/gtl/map_util.h"
 #include "tensorflow/core/platform/errors.h"
 #include "tensorflow/core/platform/macros.h"
+#include "tensorflow/core/platform/mutex.h"
 #include "tensorflow/core/platform/thread_annotations.h"
 
 namespace tensorflow {
@@ -202,6 +211,140 @@ inline const ResourceHandle& SubtleMustCopyIfIntegral(
 // Returns a unique node name starting with "base".
 std::string UniqueNodeName(const std::string& base);
 
+// A hash map split into shards that have their own locks, so that concurrent
+// operations on keys of different shards do not contend, and lookups only
+// contend with insertions into the same shard. An operation on a batch of keys
+// locks each shard that the keys fall into once, and visits the keys of a shard
+// in their order in the batch.
+template <class K, class V>
+class ShardedHashMap {
+ public:
+  using Map = absl::flat_hash_map<K, V>;
+  static constexpr int kNumShards = 16;
+
+  size_t size() const {
+    size_t size = 0;
+    for (const Shard& shard : shards_) {
+      tf_shared_lock l(shard.mu);
+      size += shard.map.size();
+    }
+    return size;
+  }
+
+  // Calls `fn(map, i, key)` for each index `i` of `keys`, where `key` is
+  // `keys(i)` and `map` is its shard, with the shard locked for reading.
+  template <typename Keys, typename Fn>
+  void ForEachKey(const Keys& keys, Fn fn) const {
+    VisitShards(keys, [&](int s, absl::Span<const int64_t> indices,
+                          const auto& key_at) {
+      const Shard& shard = shards_[s];
+      tf_shared_lock l(shard.mu);
+      for (int64_t i : indices) fn(shard.map, i, key_at(i));
+    });
+  }
+
+  // Like `ForEachKey()`, but `map` is locked for writing and can be modified.
+  template <typename Keys, typename Fn>
+  void MutateEachKey(const Keys& keys, Fn fn) {
+    VisitShards(keys, [&](int s, absl::Span<const int64_t> indices,
+                          const auto& key_at) {
+      Shard& shard = shards_[s];
+      mutex_lock l(shard.mu);
+      for (int64_t i : indices) fn(shard.map, i, key_at(i));
+    });
+  }
+
+  // Returns `fn(maps)` where `maps` are all the shards, which are locked for
+  // reading so that `fn` sees a consistent state of the whole map.
+  template <typename Fn>
+  Status ReadAll(Fn fn) const TF_NO_THREAD_SAFETY_ANALYSIS {
+    std::array<const Map*, kNumShards> maps;
+    for (int s = 0; s < kNumShards; ++s) {
+      shards_[s].mu.lock_shared();
+      maps[s] = &shards_[s].map;
+    }
+    Status status = fn(maps);
+    for (const Shard& shard : shards_) shard.mu.unlock_shared();
+    return status;
+  }
+
+  // Like `ReadAll()`, but the shards are locked for writing and can be
+  // modified.
+  template <typename Fn>
+  Status WriteAll(Fn fn) TF_NO_THREAD_SAFETY_ANALYSIS {
+    std::array<Map*, kNumShards> maps;
+    for (int s = 0; s < kNumShards; ++s) {
+      shards_[s].mu.lock();
+      maps[s] = &shards_[s].map;
+    }
+    Status status = fn(maps);
+    for (Shard& shard : shards_) shard.mu.unlock();
+    return status;
+  }
+
+  // Returns the shard of `key`. Mixing the hash again keeps the shard
+  // independent of the bits that `Map` uses to place the key in a shard.
+  static int ShardOf(const K& key) {
+    const uint64_t hash = static_cast<uint64_t>(absl::HashOf(key));
+    return static_cast<int>((hash * 0x9E3779B97F4A7C15ull) >> 60);
+  }
+  static_assert(kNumShards == 16, "ShardOf() takes the top 4 bits");
+
+ private:
+  struct alignas(ABSL_CACHELINE_SIZE) Shard {
+    mutable mutex mu;
+    Map map;  // Guarded by `mu`.
+  };
+
+  // Calls `visit(s, indices, key_at)` for each shard `s` with keys, where
+  // `indices` are the indices of its keys in increasing order and `key_at(i)`
+  // returns `keys(i)`. Integral keys are copied once, so that a key that is
+  // updated concurrently is looked up in the shard that it was assigned to.
+  template <typename Keys, typename Visit>
+  static void VisitShards(const Keys& keys, Visit visit) {
+    const int64_t n = keys.size();
+    std::vector<K> copies;
+    if constexpr (std::is_integral_v<K>) {
+      copies.resize(n);
+      for (int64_t i = 0; i < n; ++i) {
+        copies[i] = SubtleMustCopyIfIntegral(keys(i));
+      }
+    }
+    auto key_at = [&](int64_t i) -> const K& {
+      if constexpr (std::is_integral_v<K>) {
+        return copies[i];
+      } else {
+        return keys(i);
+      }
+    };
+    if (n == 1) {
+      const int64_t index = 0;
+      visit(ShardOf(key_at(0)), absl::MakeConstSpan(&index, 1), key_at);
+      return;
+    }
+    // Counting sort of the indices by shard, which keeps their order.
+    std::vector<uint8_t> shard_of(n);
+    std::array<int64_t, kNumShards + 1> offsets = {};
+    for (int64_t i = 0; i < n; ++i) {
+      shard_of[i] = ShardOf(key_at(i));
+      ++offsets[shard_of[i] + 1];
+    }
+    for (int s = 0; s < kNumShards; ++s) offsets[s + 1] += offsets[s];
+    std::vector<int64_t> indices(n);
+    std::array<int64_t, kNumShards + 1> next = offsets;
+    for (int64_t i = 0; i < n; ++i) indices[next[shard_of[i]]++] = i;
+    for (int s = 0; s < kNumShards; ++s) {
+      if (offsets[s] == offsets[s + 1]) continue;
+      visit(s,
+            absl::MakeConstSpan(indices.data() + offsets[s],
+                                offsets[s + 1] - offsets[s]),
+            key_at);
+    }
+  }
+
+  std::array<Shard, kNumShards> shards_;
+};
+
 // Lookup table that wraps an flat_hash_map, where the key and value data type
 // is specified.
 //
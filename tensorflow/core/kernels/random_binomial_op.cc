@@ -395,6 +395,7 @@ class RandomBinomialOp : public OpKernel {
 
     core::RefCountPtr<Var> var;
     OP_REQUIRES_OK(ctx, LookupResource(ctx, HandleFromInput(ctx, 0), &var));
+    var->MarkAllRowsDirty();
 
     Tensor* var_tensor = var->tensor();
     OP_REQUIRES(
@@ -146,7 +146,7 @@ Status CopyVariable(int output_idx, OpKernelContext* ctx, const Tensor* t) {
 void ReadVariableOp::Compute(OpKernelContext* ctx) {
   core::RefCountPtr<Var> variable;
   const ResourceHandle& handle = HandleFromInput(ctx, 0);
-  const auto status = LookupResource(ctx, handle, &variable);
+  const auto status = variable_cache_.Lookup(ctx, handle, &variable);
   OP_REQUIRES(ctx, status.ok(),
               errors::FailedPrecondition(
                   "Could not find variable ", handle.name(), ". ",
@@ -435,6 +435,7 @@ class AssignVariableOp : public OpKernel {
                                   return absl::OkStatus();
                                 }));
     mutex_lock ml(*variable->mu());
+    variable->MarkAllRowsDirty();
     // (variable->tensor()->dtype() == DT_INVALID && !variable->is_initialized)
     // check below is to allow an XLA specific situation wherein update can
     // happen first by the AssignVariableOp,
@@ -607,14 +608,16 @@ class AssignUpdateVariableOp : public OpKernel {
 
   void Compute(OpKernelContext* context) override {
     core::RefCountPtr<Var> variable;
-    OP_REQUIRES_OK(context, LookupResource(context, HandleFromInput(context, 0),
-                                           &variable));
+    OP_REQUIRES_OK(context,
+                   variable_cache_.Lookup(context, HandleFromInput(context, 0),
+                                          &variable));
 
     const Tensor& value = context->input(1);
     // TODO(apassos): We could possibly avoid the copy done by
     // PrepareToUpdateVariable() for commutative operations like Op ==
     // ADD if value's refcount was 1.
     mutex_lock ml(*variable->mu());
+    variable->MarkAllRowsDirty();
     Tensor* var_tensor = variable->tensor();
     OP_REQUIRES_OK(context, ValidateAssignUpdateVariableOpShapes(
                                 var_tensor->shape(), value.shape()));
@@ -628,6 +631,9 @@ class AssignUpdateVariableOp : public OpKernel {
     update_functor(context->eigen_device<Device>(), var_tensor->flat<T>(),
                    value.flat<T>());
   }
+
+ private:
+  ResourceLookupCache<Var> variable_cache_;
 };
 
 #define REGISTER_KERNELS(type)                                     \
@@ -719,7 +725,7 @@ class ResourceGatherOp : public OpKernel {
 
   void Compute(OpKernelContext* c) override {
     core::RefCountPtr<Var> v;
-    OP_REQUIRES_OK(c, LookupResource(c, HandleFromInput(c, 0), &v));
+    OP_REQUIRES_OK(c, variable_cache_.Lookup(c, HandleFromInput(c, 0), &v));
     OP_REQUIRES_OK(c, EnsureSparseVariableAccess<Device, T>(c, v.get()));
     // NOTE: We hold the lock for the whole gather operation instead
     // of increasing the reference count of v->tensor() to avoid a
@@ -839,6 +845,7 @@ class ResourceGatherOp : public OpKernel {
   }
 
   int32 batch_dims_ = 0;
+  ResourceLookupCache<Var> variable_cache_;
 };
 
 #define REGISTER_GATHER_FULL(dev, type, index_type)                    \
@@ -1124,6 +1131,7 @@ class ResourceScatterUpdateOp : public OpKernel {
                     "DType of scatter resource and updates does not match."));
 
     OP_REQUIRES_OK(c, EnsureSparseVariableAccess<Device, T>(c, v.get()));
+    MarkSparseUpdatedRows<Device, Index>(c, {0}, 1);
     const bool is_non_pod_dtype = c->input_dtype(0) == DT_RESOURCE ||
                                   c->input_dtype(0) == DT_STRING ||
                                   c->input_dtype(0) == DT_VARIANT;
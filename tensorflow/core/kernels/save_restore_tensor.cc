@@ -33,6 +33,7 @@ limitations under the License.
 #include "tensorflow/core/lib/strings/stringprintf.h"
 #include "tensorflow/core/platform/logging.h"
 #include "tensorflow/core/platform/types.h"
+#include "tensorflow/core/util/env_var.h"
 #include "tensorflow/core/util/tensor_bundle/tensor_bundle.h"
 #include "tensorflow/core/util/tensor_slice_reader.h"
 #include "tensorflow/core/util/tensor_slice_reader_cache.h"
@@ -302,7 +303,13 @@ struct RestoreOp {
     VLOG(1) << "Restoring tensor " << idx << " : " << tensor_name << " : "
             << restored_full_shape.num_elements();
     Tensor* restored_tensor;
-    if (shape_and_slice.empty()) {
+    if (shape_and_slice.empty() && use_memory_map) {
+      // Lookup the full tensor, backed by the data file if possible.
+      Tensor mapped_tensor;
+      TF_RETURN_IF_ERROR(reader->LookupMapped(tensor_name, &mapped_tensor));
+      context->set_output(idx, mapped_tensor);
+      restored_tensor = context->mutable_output(idx);
+    } else if (shape_and_slice.empty()) {
       // Lookup the full tensor.
       TF_RETURN_IF_ERROR(
           context->allocate_output(idx, restored_full_shape, &restored_tensor));
@@ -356,6 +363,9 @@ struct RestoreOp {
   string shape_and_slice;
   string reader_prefix;
   DataType dtype;
+  // Whether full tensors are returned backed by read-only memory mappings of
+  // the data files instead of copies.
+  bool use_memory_map = false;
 
   ::tensorflow::Status status;
 };
@@ -371,11 +381,26 @@ Status RestoreTensorsV2(OpKernelContext* context, const Tensor& prefix,
   const auto& tensor_names_flat = tensor_names.flat<tstring>();
   const auto& shape_and_slices_flat = shape_and_slices.flat<tstring>();
 
+  // Restored tensors that are backed by memory mappings must never be
+  // modified, which holds e.g. for the frozen variables of serving models, so
+  // this is only enabled on request.
+  static const bool use_memory_map = [] {
+    bool use_memory_map = false;
+    const Status status =
+        ReadBoolFromEnvVar("TF_RESTORE_MEMORY_MAPPED_TENSORS",
+                           /*default_val=*/false, &use_memory_map);
+    if (!status.ok()) {
+      LOG(ERROR) << status;
+    }
+    return use_memory_map;
+  }();
+
   std::vector<RestoreOp> restore_ops;
   restore_ops.reserve(tensor_names_flat.size());
   for (int i = 0; i < tensor_names_flat.size(); ++i) {
     restore_ops.push_back({context, i, tensor_names_flat(i),
                            shape_and_slices_flat(i), prefix_string, dtypes[i]});
+    restore_ops.back().use_memory_map = use_memory_map;
   }
 
   tsl::Env* const env = tsl::Env::Default();
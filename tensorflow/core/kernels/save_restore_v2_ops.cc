@@ -16,23 +16,33 @@ limitations under the License.
 // See docs in ../ops/io_ops.cc.
 
 #include <cstddef>
+#include <functional>
 #include <limits>
 #include <string>
+#include <utility>
 #include <vector>
 
+#include "absl/container/flat_hash_map.h"
+
 #include "tensorflow/core/framework/bounds_check.h"
 #include "tensorflow/core/framework/op_kernel.h"
 #include "tensorflow/core/framework/resource_mgr.h"
+#include "tensorflow/core/framework/resource_var.h"
 #include "tensorflow/core/framework/tensor.h"
+#include "tensorflow/core/framework/tensor_util.h"
 #include "tensorflow/core/framework/types.h"
 #include "tensorflow/core/framework/types.pb.h"
 #include "tensorflow/core/kernels/checkpoint_callback_manager.h"
 #include "tensorflow/core/kernels/save_restore_tensor.h"
 #include "tensorflow/core/lib/core/status.h"
+#include "tensorflow/core/lib/core/threadpool.h"
+#include "tensorflow/core/lib/gtl/cleanup.h"
 #include "tensorflow/core/lib/io/path.h"
 #include "tensorflow/core/platform/env.h"
 #include "tensorflow/core/platform/logging.h"  // IWYU pragma: keep
+#include "tensorflow/core/platform/mutex.h"
 #include "tensorflow/core/platform/types.h"
+#include "tensorflow/core/util/env_var.h"
 #include "tensorflow/core/util/saved_tensor_slice_util.h"
 #include "tensorflow/core/util/tensor_bundle/naming.h"
 #include "tensorflow/core/util/tensor_bundle/tensor_bundle.h"
@@ -90,12 +100,118 @@ void ValidateInputs(bool is_save_op, OpKernelContext* context,
   }
 }
 
+// Checkpoint writes that run in the background when the
+// TF_ASYNC_CHECKPOINT_WRITES environment variable is set.  SaveV2 and
+// MergeV2Checkpoints then return as soon as the write of their prefix is
+// scheduled, and the ops of this process that read or overwrite the prefix
+// wait for the write to complete and report its errors.
+//
+// The metadata file of a bundle is written last, so other processes never see
+// a partially written checkpoint, but they may not see it at all until the
+// write completes.  Writes that are pending when the process exits are lost.
+class PendingCheckpointWrites {
+ public:
+  static PendingCheckpointWrites* Global() {
+    static PendingCheckpointWrites* writes = new PendingCheckpointWrites();
+    return writes;
+  }
+
+  // Runs "write" of "prefix" in the background, once the pending writes of all
+  // "dependencies" have completed successfully.
+  void Schedule(const string& prefix, std::vector<string> dependencies,
+                std::function<Status()> write) {
+    {
+      mutex_lock l(mu_);
+      ++num_pending_[prefix];
+    }
+    Env::Default()->SchedClosure([this, prefix,
+                                  dependencies = std::move(dependencies),
+                                  write = std::move(write)]() {
+      Status status;
+      for (const string& dependency : dependencies) {
+        status.Update(Wait(dependency));
+      }
+      if (status.ok()) status = write();
+      if (!status.ok()) {
+        LOG(ERROR) << "Failed to write checkpoint " << prefix << ": "
+                   << status;
+      }
+      mutex_lock l(mu_);
+      errors_[prefix].Update(status);
+      if (--num_pending_[prefix] == 0) num_pending_.erase(prefix);
+      cond_var_.notify_all();
+    });
+  }
+
+  // Blocks until no write of "prefix" is pending.  Returns the first error of
+  // the writes of "prefix" that failed since the last call.
+  Status Wait(const string& prefix) {
+    mutex_lock l(mu_);
+    while (num_pending_.contains(prefix)) cond_var_.wait(l);
+    auto it = errors_.find(prefix);
+    if (it == errors_.end()) return absl::OkStatus();
+    Status status = std::move(it->second);
+    errors_.erase(it);
+    return status;
+  }
+
+ private:
+  mutex mu_;
+  condition_variable cond_var_;
+  absl::flat_hash_map<string, int> num_pending_ TF_GUARDED_BY(mu_);
+  absl::flat_hash_map<string, Status> errors_ TF_GUARDED_BY(mu_);
+};
+
+bool AsyncCheckpointWrites() {
+  static const bool async = [] {
+    bool value;
+    TF_CHECK_OK(ReadBoolFromEnvVar("TF_ASYNC_CHECKPOINT_WRITES",
+                                   /*default_val=*/false, &value));
+    return value;
+  }();
+  return async;
+}
+
+// The threads that write the data files of a checkpoint in parallel, shared
+// by all SaveV2 kernels of the process.
+thread::ThreadPool* CheckpointWriterPool(int num_threads) {
+  static thread::ThreadPool* pool = new thread::ThreadPool(
+      Env::Default(), "checkpoint_writer", num_threads);
+  return pool;
+}
+
 }  // namespace
 
 // Saves a list of named tensors using the tensor bundle library.
 class SaveV2 : public OpKernel {
  public:
-  explicit SaveV2(OpKernelConstruction* context) : OpKernel(context) {}
+  explicit SaveV2(OpKernelConstruction* context) : OpKernel(context) {
+    // Aligned tensor data, e.g. to 64 bytes or to pages, can be restored
+    // without copies by memory mapping the data files.
+    int64_t data_alignment;
+    OP_REQUIRES_OK(context,
+                   ReadInt64FromEnvVar("TF_SAVE_TENSOR_DATA_ALIGNMENT",
+                                       /*default_val=*/1, &data_alignment));
+    OP_REQUIRES(context,
+                data_alignment >= 1 &&
+                    data_alignment <= std::numeric_limits<int>::max(),
+                errors::InvalidArgument(
+                    "TF_SAVE_TENSOR_DATA_ALIGNMENT must be a positive int; "
+                    "got ",
+                    data_alignment));
+    writer_options_.data_alignment = data_alignment;
+    // Checkpoints written with more than one thread have one data file per
+    // thread, which are written concurrently.
+    int64_t num_writer_threads;
+    OP_REQUIRES_OK(context,
+                   ReadInt64FromEnvVar("TF_CHECKPOINT_WRITER_THREADS",
+                                       /*default_val=*/1, &num_writer_threads));
+    OP_REQUIRES(context, num_writer_threads >= 1 && num_writer_threads <= 1024,
+                errors::InvalidArgument(
+                    "TF_CHECKPOINT_WRITER_THREADS must be in [1, 1024]; got ",
+                    num_writer_threads));
+    num_writer_threads_ = num_writer_threads;
+  }
 
   void Compute(OpKernelContext* context) override {
     const Tensor& prefix = context->input(0);
@@ -111,14 +227,22 @@ class SaveV2 : public OpKernel {
     const auto& tensor_names_flat = tensor_names.flat<tstring>();
     const auto& shape_and_slices_flat = shape_and_slices.flat<tstring>();
 
-    BundleWriter writer(Env::Default(), prefix_string);
-    OP_REQUIRES_OK(context, writer.status());
-    VLOG(1) << "BundleWriter, prefix_string: " << prefix_string;
+    const bool async = AsyncCheckpointWrites();
+    // Reports the errors of, and does not race with, an earlier asynchronous
+    // write of the same checkpoint.
+    OP_REQUIRES_OK(context,
+                   PendingCheckpointWrites::Global()->Wait(prefix_string));
 
+    std::vector<BundleWriteEntry> entries(num_tensors);
     for (int i = 0; i < num_tensors; ++i) {
       const string& tensor_name = tensor_names_flat(i);
       const Tensor& tensor = context->input(i + kFixedInputs);
-      VLOG(2) << "Starting save of " << tensor_name;
+      BundleWriteEntry& entry = entries[i];
+      entry.key = tensor_name;
+      // The entry shares the buffer of the input.  Resource variables copy
+      // their buffer before updating it in place while it is shared, so an
+      // asynchronous write sees the values of this step.
+      entry.tensor = tensor;
 
       if (!shape_and_slices_flat(i).empty()) {
         const string& shape_spec = shape_and_slices_flat(i);
@@ -135,10 +259,9 @@ class SaveV2 : public OpKernel {
                                             shape_spec, ", tensor: ",
                                             tensor.shape().DebugString()));
 
-        OP_REQUIRES_OK(context,
-                       writer.AddSlice(tensor_name, shape, slice, tensor));
-      } else {
-        OP_REQUIRES_OK(context, writer.Add(tensor_name, tensor));
+        entry.is_slice = true;
+        entry.full_shape = shape;
+        entry.slice_spec = slice;
       }
 
       if (VLOG_IS_ON(5)) {
@@ -157,11 +280,26 @@ class SaveV2 : public OpKernel {
                   << tensor.NumElements();
         }
       }
+    }
 
-      VLOG(2) << "Done save of " << tensor_name;
+    thread::ThreadPool* pool = num_writer_threads_ > 1
+                                   ? CheckpointWriterPool(num_writer_threads_)
+                                   : nullptr;
+    auto write = [prefix_string, entries = std::move(entries),
+                  num_shards = num_writer_threads_, pool,
+                  options = writer_options_]() {
+      VLOG(1) << "BundleWriter, prefix_string: " << prefix_string;
+      TF_RETURN_IF_ERROR(WriteBundleInParallel(
+          Env::Default(), prefix_string, entries, num_shards, pool, options));
+      VLOG(1) << "Done BundleWriter, prefix_string: " << prefix_string;
+      return absl::OkStatus();
+    };
+    if (async) {
+      PendingCheckpointWrites::Global()->Schedule(prefix_string, {},
+                                                  std::move(write));
+    } else {
+      OP_REQUIRES_OK(context, write());
     }
-    OP_REQUIRES_OK(context, writer.Finish());
-    VLOG(1) << "Done BundleWriter, prefix_string: " << prefix_string;
 
     ResourceMgr* resource_manager = context->resource_manager();
     if (resource_manager != nullptr) {
@@ -182,9 +320,129 @@ class SaveV2 : public OpKernel {
       checkpoint_callback_manager->Unref();
     }
   }
+
+ private:
+  BundleWriter::Options writer_options_;
+  int num_writer_threads_;
 };
 REGISTER_KERNEL_BUILDER(Name("SaveV2").Device(DEVICE_CPU), SaveV2);
 
+// Writes the rows of resource variables that changed since the checkpoint
+// written by the previous call, as a delta bundle on top of that checkpoint.
+class SaveResourceVariableDeltas : public OpKernel {
+ public:
+  explicit SaveResourceVariableDeltas(OpKernelConstruction* context)
+      : OpKernel(context) {}
+
+  void Compute(OpKernelContext* context) override {
+    const int kFixedInputs = 4;  // Prefixes, tensor names, shape_and_slices.
+    const Tensor& prefix = context->input(0);
+    const Tensor& base_prefix = context->input(1);
+    const Tensor& tensor_names = context->input(2);
+    const Tensor& shape_and_slices = context->input(3);
+    OP_REQUIRES(context,
+                prefix.NumElements() == 1 && base_prefix.NumElements() == 1,
+                errors::InvalidArgument(
+                    "prefix and base_prefix should have a single element"));
+    const int num_tensors = context->num_inputs() - kFixedInputs;
+    OP_REQUIRES(context,
+                tensor_names.NumElements() == num_tensors &&
+                    shape_and_slices.NumElements() == num_tensors,
+                errors::InvalidArgument(
+                    "Expected ", num_tensors,
+                    " tensor names and shape_and_slices, got ",
+                    tensor_names.NumElements(), " and ",
+                    shape_and_slices.NumElements()));
+    const string& prefix_string = prefix.scalar<tstring>()();
+    const string& base_prefix_string = base_prefix.scalar<tstring>()();
+    const auto& tensor_names_flat = tensor_names.flat<tstring>();
+    const auto& shape_and_slices_flat = shape_and_slices.flat<tstring>();
+
+    std::vector<core::RefCountPtr<Var>> vars(num_tensors);
+    bool written = false;
+    // The rows taken from the variables must be written by the next delta if
+    // this one fails.
+    auto mark_dirty_rows = gtl::MakeCleanup([&vars, &written] {
+      if (written) return;
+      for (const auto& var : vars) {
+        if (var) var->MarkAllRowsDirty();
+      }
+    });
+    std::vector<BundleWriteEntry> entries;
+    for (int i = 0; i < num_tensors; ++i) {
+      const ResourceHandle& handle = HandleFromInput(context, i + kFixedInputs);
+      OP_REQUIRES_OK(context, LookupResource(context, handle, &vars[i]));
+      Var* var = vars[i].get();
+      // Takes the dirty rows and copies them while no update can run.
+      mutex_lock l(*var->mu());
+      const Tensor& tensor = *var->tensor();
+      OP_REQUIRES(context, var->is_initialized,
+                  errors::FailedPrecondition(
+                      "Attempting to save an uninitialized variable: ",
+                      tensor_names_flat(i)));
+
+      TensorShape full_shape = tensor.shape();
+      TensorSlice slice(tensor.dims());
+      const bool is_slice = !shape_and_slices_flat(i).empty();
+      if (is_slice) {
+        TensorShape slice_shape;
+        OP_REQUIRES_OK(context, checkpoint::ParseShapeAndSlice(
+                                    shape_and_slices_flat(i), &full_shape,
+                                    &slice, &slice_shape));
+        OP_REQUIRES(context, slice_shape.IsSameSize(tensor.shape()),
+                    errors::InvalidArgument(
+                        "Slice in shape_and_slice specification does not "
+                        "match the shape of the variable to save: ",
+                        shape_and_slices_flat(i), ", variable: ",
+                        tensor.shape().DebugString()));
+      }
+
+      std::vector<std::pair<int64_t, int64_t>> ranges;
+      bool full = base_prefix_string.empty() || tensor.dims() == 0 ||
+                  !var->is_tracking_dirty_rows();
+      if (full) {
+        var->StartTrackingDirtyRows();
+      } else {
+        full = var->TakeDirtyRows(tensor.dim_size(0), &ranges);
+      }
+
+      BundleWriteEntry entry;
+      entry.key = tensor_names_flat(i);
+      entry.is_slice = is_slice;
+      entry.full_shape = full_shape;
+      if (full) {
+        // Sparse updates modify the buffer in place without copying it first.
+        entry.tensor =
+            var->copy_on_read_mode.load() ? tensor::DeepCopy(tensor) : tensor;
+        entry.slice_spec = slice;
+        entries.push_back(std::move(entry));
+        continue;
+      }
+      entry.is_slice = true;
+      const int64_t first_row = is_slice ? slice.start(0) : 0;
+      for (const auto& [start, end] : ranges) {
+        entry.tensor = tensor::DeepCopy(tensor.Slice(start, end));
+        entry.slice_spec = slice;
+        entry.slice_spec.set_start(0, first_row + start);
+        entry.slice_spec.set_length(0, end - start);
+        entries.push_back(entry);
+      }
+    }
+
+    VLOG(1) << "Writing " << entries.size() << " entries to "
+            << prefix_string << " on top of \"" << base_prefix_string << "\"";
+    BundleWriter::Options options;
+    options.base_prefix = base_prefix_string;
+    OP_REQUIRES_OK(context, WriteBundleInParallel(
+                                Env::Default(), prefix_string, entries,
+                                /*num_shards=*/1, /*thread_pool=*/nullptr,
+                                options));
+    written = true;
+  }
+};
+REGISTER_KERNEL_BUILDER(Name("SaveResourceVariableDeltas").Device(DEVICE_CPU),
+                        SaveResourceVariableDeltas);
+
 // Restores a list of named tensors from a tensor bundle (V2 checkpoint format).
 class RestoreV2 : public OpKernel {
  public:
@@ -205,6 +463,8 @@ class RestoreV2 : public OpKernel {
     if (!context->status().ok()) return;
 
     const string& prefix_string = prefix.scalar<tstring>()();
+    OP_REQUIRES_OK(context,
+                   PendingCheckpointWrites::Global()->Wait(prefix_string));
 
     VLOG(2) << "Started Restore at prefix: " << prefix_string;
     // Intention: we plan to use the RestoreV2 op as a backward-compatible
@@ -283,25 +543,46 @@ class MergeV2Checkpoints : public OpKernel {
                     "Input destination_prefix should be a scalar tensor, got ",
                     destination_prefix.shape().DebugString(), " instead."));
 
-    const absl::Span<const tstring> input_prefixes =
+    const absl::Span<const tstring> prefixes =
         absl::Span<const tstring>(checkpoint_prefixes.flat<tstring>());
-    Env* env = Env::Default();
+    std::vector<tstring> input_prefixes(prefixes.begin(), prefixes.end());
     const string& merged_prefix = destination_prefix.scalar<tstring>()();
     OP_REQUIRES_OK(context,
-                   tensorflow::MergeBundles(env, input_prefixes, merged_prefix,
-                                            allow_missing_files_));
-
-    if (delete_old_dirs_) {
-      const string merged_dir(io::Dirname(merged_prefix));
-      for (const string& input_prefix : input_prefixes) {
-        const string dirname(io::Dirname(input_prefix));
-        if (dirname == merged_dir) continue;
-        Status status = env->DeleteDir(dirname);
-        // For sharded save, only the first delete will go through and all
-        // others will hit NotFound.  Use vlog to be less verbose.
-        if (!status.ok()) VLOG(1) << status;
+                   PendingCheckpointWrites::Global()->Wait(merged_prefix));
+
+    auto merge = [input_prefixes, merged_prefix,
+                  allow_missing_files = allow_missing_files_,
+                  delete_old_dirs = delete_old_dirs_]() {
+      Env* env = Env::Default();
+      TF_RETURN_IF_ERROR(tensorflow::MergeBundles(
+          env, input_prefixes, merged_prefix, allow_missing_files));
+
+      if (delete_old_dirs) {
+        const string merged_dir(io::Dirname(merged_prefix));
+        for (const string& input_prefix : input_prefixes) {
+          const string dirname(io::Dirname(input_prefix));
+          if (dirname == merged_dir) continue;
+          Status status = env->DeleteDir(dirname);
+          // For sharded save, only the first delete will go through and all
+          // others will hit NotFound.  Use vlog to be less verbose.
+          if (!status.ok()) VLOG(1) << status;
+        }
       }
+      return absl::OkStatus();
+    };
+    if (AsyncCheckpointWrites()) {
+      // Merges once the asynchronous writes of the inputs have completed.
+      PendingCheckpointWrites::Global()->Schedule(
+          merged_prefix,
+          std::vector<string>(input_prefixes.begin(), input_prefixes.end()),
+          std::move(merge));
+      return;
+    }
+    for (const tstring& input_prefix : input_prefixes) {
+      OP_REQUIRES_OK(context,
+                     PendingCheckpointWrites::Global()->Wait(input_prefix));
     }
+    OP_REQUIRES_OK(context, merge());
   }
 
  private:
@@ -18,8 +18,10 @@ limitations under the License.
 
 #include "tensorflow/core/framework/fake_input.h"
 #include "tensorflow/core/framework/node_def_builder.h"
+#include "tensorflow/core/framework/resource_var.h"
 #include "tensorflow/core/framework/tensor.h"
 #include "tensorflow/core/framework/tensor_shape.h"
+#include "tensorflow/core/framework/tensor_testutil.h"
 #include "tensorflow/core/framework/types.h"
 #include "tensorflow/core/framework/types.pb.h"
 #include "tensorflow/core/kernels/ops_testutil.h"
@@ -340,5 +342,74 @@ TEST_F(SaveV2OpTest, Simple) {
   }
 }
 
+class SaveResourceVariableDeltasOpTest : public OpsTestBase {
+ protected:
+  void SetUp() override {
+    TF_ASSERT_OK(NodeDefBuilder("myop", "SaveResourceVariableDeltas")
+                     .Input(FakeInput())                 // prefix
+                     .Input(FakeInput())                 // base_prefix
+                     .Input(FakeInput())                 // tensor_names
+                     .Input(FakeInput())                 // shape_and_slices
+                     .Input(FakeInput(1, DT_RESOURCE))  // resources
+                     .Finalize(node_def()));
+    TF_ASSERT_OK(InitOp());
+    var_ = new Var(DT_FLOAT);
+    *var_->tensor() =
+        test::AsTensor<float>({0, 0, 1, 1, 2, 2, 3, 3}, TensorShape({4, 2}));
+    var_->is_initialized = true;
+    ResourceMgr* rm = device_->resource_manager();
+    TF_ASSERT_OK(rm->Create(rm->default_container(), "var", var_));
+  }
+
+  Status Save(const string& prefix, const string& base_prefix) {
+    inputs_.clear();
+    AddInputFromList<tstring>(TensorShape({}), {prefix});
+    AddInputFromList<tstring>(TensorShape({}), {base_prefix});
+    AddInputFromList<tstring>(TensorShape({1}), {"var"});
+    AddInputFromList<tstring>(TensorShape({1}), {""});
+    AddResourceInputInternal(device_->resource_manager()->default_container(),
+                             "var", TypeIndex::Make<Var>());
+    return RunOpKernel();
+  }
+
+  Var* var_;  // Owned by the resource manager.
+};
+
+TEST_F(SaveResourceVariableDeltasOpTest, WritesDirtyRows) {
+  const string base = io::JoinPath(testing::TmpDir(), "deltas_base");
+  const string delta1 = io::JoinPath(testing::TmpDir(), "deltas_1");
+  const string delta2 = io::JoinPath(testing::TmpDir(), "deltas_2");
+  TF_ASSERT_OK(Save(base, ""));
+  EXPECT_TRUE(var_->is_tracking_dirty_rows());
+
+  var_->tensor()->matrix<float>()(2, 1) = 20;
+  var_->MarkRowsDirty(std::vector<int64_t>{2});
+  TF_ASSERT_OK(Save(delta1, base));
+  {
+    BundleReader reader(Env::Default(), delta1);
+    TF_ASSERT_OK(reader.status());
+    std::vector<TensorSlice> slices;
+    TF_ASSERT_OK(reader.LookupTensorSlices("var", &slices));
+    ASSERT_EQ(slices.size(), 1);
+    EXPECT_EQ(slices[0].DebugString(), "2,1:-");
+    Tensor val(DT_FLOAT, TensorShape({4, 2}));
+    TF_ASSERT_OK(reader.Lookup("var", &val));
+    test::ExpectTensorEqual<float>(val, *var_->tensor());
+  }
+
+  // Updates that are not attributed to rows rewrite the whole variable.
+  var_->tensor()->matrix<float>()(0, 0) = 30;
+  var_->MarkAllRowsDirty();
+  TF_ASSERT_OK(Save(delta2, delta1));
+  BundleReader reader(Env::Default(), delta2);
+  TF_ASSERT_OK(reader.status());
+  std::vector<TensorSlice> slices;
+  TF_ASSERT_OK(reader.LookupTensorSlices("var", &slices));
+  EXPECT_TRUE(slices.empty());
+  Tensor val(DT_FLOAT, TensorShape({4, 2}));
+  TF_ASSERT_OK(reader.Lookup("var", &val));
+  test::ExpectTensorEqual<float>(val, *var_->tensor());
+}
+
 }  // namespace
 }  // namespace tensorflow
@@ -20,7 +20,10 @@ limitations under the License.
 
 #define EIGEN_USE_THREADS
 
+#include <algorithm>
 #include <atomic>
+#include <numeric>
+#include <vector>
 
 #include "unsupported/Eigen/CXX11/Tensor"  // from @eigen_archive
 
@@ -102,6 +105,10 @@ class UpdateExecutor<T, Input, Update, Output, scatter_nd_op::UpdateOp::MAX> {
 
 namespace functor {
 
+// The minimum number of updated elements for which updates are applied in
+// parallel.
+constexpr int64_t kParallelScatterNdMinElements = 32 * 1024;
+
 // Implementation of update functor for CPU.
 template <typename T, typename Index, scatter_nd_op::UpdateOp OP, int IXDIM>
 struct ScatterNdFunctor<CPUDevice, T, Index, OP, IXDIM> {
@@ -127,6 +134,12 @@ struct ScatterNdFunctor<CPUDevice, T, Index, OP, IXDIM> {
           batch_strides[dim + 1] * output_shape_prefix[dim + 1];
     }
 
+    if (d.numThreads() > 1 && batch_size > 1 && Toutput.dimension(0) > 1 &&
+        batch_size * slice_size >= kParallelScatterNdMinElements) {
+      return ParallelScatter(d, slice_size, output_shape_prefix, batch_strides,
+                             Tindices, Tupdates, Toutput);
+    }
+
     for (Eigen::DenseIndex loc = 0; loc < batch_size; ++loc) {
       Index i = 0;
       bool out_of_bounds = false;
@@ -151,6 +164,95 @@ struct ScatterNdFunctor<CPUDevice, T, Index, OP, IXDIM> {
 
     return error_loc;
   }
+
+ private:
+  // Applies the updates in parallel without races between updates to the
+  // same slice. The output slices are partitioned into contiguous ranges, and
+  // a stable counting sort groups the updates by the range of their
+  // destination. Each range is then updated by one thread, in the order of
+  // the updates, so duplicate indices are accumulated in the same order as
+  // the sequential loop. Unlike the sequential loop, no update is applied if
+  // an index is out of bounds.
+  static Index ParallelScatter(
+      const CPUDevice& d, const Index slice_size,
+      const Eigen::array<Eigen::DenseIndex, IXDIM>& output_shape_prefix,
+      const Index* batch_strides,
+      typename TTypes<Index, 2>::ConstTensor Tindices,
+      typename TTypes<T, 2>::ConstTensor Tupdates,
+      typename TTypes<T, 2>::Tensor Toutput) {
+    const Eigen::DenseIndex batch_size = Tindices.dimension(0);
+    const Eigen::DenseIndex num_slices = Toutput.dimension(0);
+
+    // Computes the slice of each update, and the first out-of-bounds index.
+    std::vector<Index> slices(batch_size);
+    std::atomic<Eigen::DenseIndex> error_loc(batch_size);
+    d.parallelFor(
+        batch_size,
+        Eigen::TensorOpCost(IXDIM * sizeof(Index), sizeof(Index), 2 * IXDIM),
+        [&](Eigen::DenseIndex begin, Eigen::DenseIndex end) {
+          for (Eigen::DenseIndex loc = begin; loc < end; ++loc) {
+            Index i = 0;
+            bool out_of_bounds = false;
+            for (int dim = 0; dim < IXDIM; ++dim) {
+              const Index ix_d = internal::SubtleMustCopy(Tindices(loc, dim));
+              out_of_bounds |= !FastBoundsCheck(ix_d, output_shape_prefix[dim]);
+              i += ix_d * batch_strides[dim];
+            }
+            if (TF_PREDICT_FALSE(out_of_bounds)) {
+              Eigen::DenseIndex first = error_loc.load();
+              while (loc < first &&
+                     !error_loc.compare_exchange_weak(first, loc)) {
+              }
+              return;
+            }
+            slices[loc] = i;
+          }
+        });
+    if (error_loc.load() < batch_size) return error_loc.load();
+
+    // Groups the updates by the range of their slice.
+    const Eigen::DenseIndex slices_per_range = Eigen::divup<Eigen::DenseIndex>(
+        num_slices, std::min<Eigen::DenseIndex>(num_slices,
+                                                4 * d.numThreads()));
+    const Eigen::DenseIndex num_ranges =
+        Eigen::divup(num_slices, slices_per_range);
+    std::vector<Eigen::DenseIndex> range_starts(num_ranges + 1, 0);
+    for (Eigen::DenseIndex loc = 0; loc < batch_size; ++loc) {
+      ++range_starts[slices[loc] / slices_per_range + 1];
+    }
+    std::partial_sum(range_starts.begin(), range_starts.end(),
+                     range_starts.begin());
+    std::vector<Eigen::DenseIndex> sorted_locs(batch_size);
+    std::vector<Eigen::DenseIndex> next(range_starts.begin(),
+                                        range_starts.end() - 1);
+    for (Eigen::DenseIndex loc = 0; loc < batch_size; ++loc) {
+      sorted_locs[next[slices[loc] / slices_per_range]++] = loc;
+    }
+
+    const double updates_per_range =
+        static_cast<double>(batch_size) / num_ranges;
+    const double elements_per_range = updates_per_range * slice_size;
+    d.parallelFor(
+        num_ranges,
+        Eigen::TensorOpCost(2 * elements_per_range * sizeof(T),
+                            elements_per_range * sizeof(T),
+                            elements_per_range),
+        [&](Eigen::DenseIndex begin, Eigen::DenseIndex end) {
+          const Eigen::DefaultDevice device;
+          for (Eigen::DenseIndex k = range_starts[begin];
+               k < range_starts[end]; ++k) {
+            const Eigen::DenseIndex loc = sorted_locs[k];
+            auto input_chip = Toutput.template chip<0>(slices[loc]);
+            auto output_chip = input_chip;
+            auto update_chip = Tupdates.template chip<0>(loc);
+            update_executor::UpdateExecutor<
+                Eigen::DefaultDevice, decltype(input_chip),
+                decltype(update_chip), decltype(output_chip),
+                OP>::Execute(device, input_chip, update_chip, output_chip);
+          }
+        });
+    return -1;
+  }
 };
 
 #define REGISTER_SCATTER_ND_FULL(T, Index, op)                               \
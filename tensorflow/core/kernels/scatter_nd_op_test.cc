@@ -240,6 +240,68 @@ TEST_F(ScatterNdUpdateOpTest, Error_MismatchedIndicesAndUpdateDimensions) {
       << s;
 }
 
+class ScatterNdAddOpTest : public OpsTestBase {
+ protected:
+  void MakeOp() {
+    TF_ASSERT_OK(NodeDefBuilder("myop", "ScatterNdAdd")
+                     .Input(FakeInput(DT_FLOAT_REF))
+                     .Input(FakeInput(DT_INT32))
+                     .Input(FakeInput(DT_FLOAT))
+                     .Finalize(node_def()));
+    TF_ASSERT_OK(InitOp());
+  }
+};
+
+// Enough updates to be applied in parallel, with many duplicate indices.
+TEST_F(ScatterNdAddOpTest, LargeBatchWithDuplicates) {
+  MakeOp();
+  const int kRows = 50, kCols = 16, kNumUpdates = 4096;
+  random::PhiloxRandom philox(301, 17);
+  random::SimplePhilox rnd(&philox);
+  std::vector<int32> indices(kNumUpdates * 2);
+  std::vector<float> updates(kNumUpdates * kCols);
+  for (int i = 0; i < kNumUpdates; ++i) {
+    indices[2 * i] = rnd.Uniform(kRows);
+    indices[2 * i + 1] = rnd.Uniform(2);
+  }
+  for (float& update : updates) update = rnd.RandFloat() - 0.5f;
+
+  // The updates of each slice are accumulated in the order of the batch.
+  Tensor expected(allocator(), DT_FLOAT, TensorShape({kRows, 2, kCols}));
+  auto expected_flat = expected.flat<float>();
+  expected_flat.setConstant(1);
+  for (int i = 0; i < kNumUpdates; ++i) {
+    const int slice = indices[2 * i] * 2 + indices[2 * i + 1];
+    for (int j = 0; j < kCols; ++j) {
+      expected_flat(slice * kCols + j) += updates[i * kCols + j];
+    }
+  }
+
+  AddInputFromArray<float>(TensorShape({kRows, 2, kCols}),
+                           std::vector<float>(kRows * 2 * kCols, 1));
+  AddInputFromArray<int32>(TensorShape({kNumUpdates, 2}), indices);
+  AddInputFromArray<float>(TensorShape({kNumUpdates, kCols}), updates);
+  TF_ASSERT_OK(RunOpKernel());
+  test::ExpectTensorEqual<float>(expected, *mutable_input(0).tensor);
+}
+
+TEST_F(ScatterNdAddOpTest, LargeBatchIndexOutOfRange) {
+  MakeOp();
+  const int kRows = 50, kCols = 16, kNumUpdates = 4096;
+  std::vector<int32> indices(kNumUpdates * 2, 0);
+  indices[2 * 3000] = 50;
+  indices[2 * 1000 + 1] = 2;
+  AddInputFromArray<float>(TensorShape({kRows, 2, kCols}),
+                           std::vector<float>(kRows * 2 * kCols, 0));
+  AddInputFromArray<int32>(TensorShape({kNumUpdates, 2}), indices);
+  AddInputFromArray<float>(TensorShape({kNumUpdates, kCols}),
+                           std::vector<float>(kNumUpdates * kCols, 1));
+  Status s = RunOpKernel();
+  EXPECT_TRUE(absl::StrContains(
+      s.ToString(), "indices[1000] = [0, 2] does not index into shape"))
+      << s;
+}
+
 class ScatterNdUpdateBM : public ScatterNdUpdateOpTest {
  public:
   void TestBody() override {}
@@ -255,14 +317,14 @@ class ScatterNdUpdateBM : public ScatterNdUpdateOpTest {
 
 template <typename Index>
 void BM_ScatterNdHelper(::testing::benchmark::State& state, int embedding_size,
-                        const char* op) {
+                        const char* op, int num_updates = 1000) {
   const int kRows = 10000000 / embedding_size;
   std::vector<float> values;
   values.reserve(kRows);
   for (int i = 0; i < kRows * embedding_size; i++) {
     values.push_back(i);
   }
-  const int kNumUpdates = 1000;
+  const int kNumUpdates = num_updates;
   random::PhiloxRandom philox(301, 17);
   random::SimplePhilox rnd(&philox);
   std::vector<Index> indices;
@@ -322,8 +384,16 @@ BENCHMARK(BM_ScatterNdUpdateInt64)
     ->Arg(256)
     ->Arg(1024);
 
+void BM_ScatterNdAddManyUpdatesInt32(::testing::benchmark::State& state) {
+  const int embedding_size = state.range(0);
+
+  BM_ScatterNdHelper<int32>(state, embedding_size, "ScatterNdAdd",
+                            /*num_updates=*/100000);
+}
+
 BENCHMARK(BM_ScatterNdAddInt32)->Arg(1)->Arg(10)->Arg(64)->Arg(256)->Arg(1024);
 BENCHMARK(BM_ScatterNdAddInt64)->Arg(1)->Arg(10)->Arg(64)->Arg(256)->Arg(1024);
+BENCHMARK(BM_ScatterNdAddManyUpdatesInt32)->Arg(1)->Arg(10)->Arg(64);
 
 }  // namespace
 }  // namespace tensorflow
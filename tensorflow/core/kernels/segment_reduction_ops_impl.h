@@ -18,7 +18,10 @@ limitations under the License.
 #ifndef TENSORFLOW_CORE_KERNELS_SEGMENT_REDUCTION_OPS_IMPL_H_
 #define TENSORFLOW_CORE_KERNELS_SEGMENT_REDUCTION_OPS_IMPL_H_
 
+#include <algorithm>
 #include <cstdint>
+#include <limits>
+#include <utility>
 
 #include "tensorflow/core/framework/op_requires.h"
 #include "tensorflow/core/platform/types.h"
@@ -41,8 +44,10 @@ limitations under the License.
 #include "tensorflow/core/kernels/segment_reduction_ops.h"
 #include "tensorflow/core/lib/core/status.h"
 #include "tensorflow/core/platform/logging.h"
+#include "tensorflow/core/platform/mutex.h"
 #include "tensorflow/core/util/determinism.h"
 #include "tensorflow/core/util/util.h"
+#include "tensorflow/core/util/work_sharder.h"
 
 #if GOOGLE_CUDA || TENSORFLOW_USE_ROCM
 #include "tensorflow/core/common_runtime/gpu/gpu_event_mgr.h"
@@ -126,80 +131,119 @@ class SegmentReductionOp : public OpKernel {
                 errors::InvalidArgument("segment ids must be >= 0"));
     auto output_flat = output->flat_outer_dims<T>();
 
-    Eigen::IndexList<Eigen::type2index<0> > dims_to_reduce;
-    Index start = 0, end = 1;
-
-    Index uninitialized_index = 0;  // Index from which the output is not set.
-    Index out_index = internal::SubtleMustCopy(segment_vec(start));
-
-    // TODO(agarwal): if this loop becomes a bottleneck, consider sharding it
-    // across threads.
-    Eigen::DSizes<Eigen::DenseIndex, 1> out_slice_shape(num_col);
-    while (end <= num_indices) {
-      // We initialize next_index to 0 to avoid "warning: 'next_index' may be
-      // used uninitialized in this function" in the Mac build (since the
-      // compiler isn't smart enough to realize the code is safe).
-      Index next_index = 0;
-      if (end < num_indices) {
-        next_index = internal::SubtleMustCopy(segment_vec(end));
-        if (out_index == next_index) {
+    // The segments are reduced in parallel. Each segment is reduced by the
+    // shard that contains its first row, which also sets the gap of missing
+    // segment ids before it to the default value. A shard reports the first
+    // error of its segments, and the error of the first segment in the input
+    // is returned, as if the segments were reduced in order.
+    mutex mu;
+    int64_t error_position = std::numeric_limits<int64_t>::max();
+    Status error;
+    auto set_error = [&](int64_t position, Status status) {
+      mutex_lock l(mu);
+      if (position < error_position) {
+        error_position = position;
+        error = std::move(status);
+      }
+    };
+    auto work = [&](int64_t shard_start, int64_t shard_end) {
+      Eigen::IndexList<Eigen::type2index<0> > dims_to_reduce;
+      Eigen::DSizes<Eigen::DenseIndex, 1> out_slice_shape(num_col);
+      // Skip the rows of a segment that starts in an earlier shard.
+      Index start = shard_start;
+      while (start > 0 && start < shard_end &&
+             internal::SubtleMustCopy(segment_vec(start - 1)) ==
+                 internal::SubtleMustCopy(segment_vec(start))) {
+        ++start;
+      }
+      if (start >= shard_end) return;
+      // Index from which the output is not set.
+      Index uninitialized_index =
+          start == 0
+              ? 0
+              : std::max<Index>(
+                    internal::SubtleMustCopy(segment_vec(start - 1)) + 1, 0);
+      while (start < shard_end) {
+        const Index out_index = internal::SubtleMustCopy(segment_vec(start));
+        Index end = start + 1;
+        while (end < num_indices &&
+               internal::SubtleMustCopy(segment_vec(end)) == out_index) {
           ++end;
-          continue;
         }
         // We have a new segment here.  Verify that the segment ids are growing.
-        OP_REQUIRES(context, out_index < next_index,
-                    errors::InvalidArgument("segment ids are not increasing"));
+        if (end < num_indices &&
+            !(out_index < internal::SubtleMustCopy(segment_vec(end)))) {
+          set_error(2 * start, errors::InvalidArgument(
+                                   "segment ids are not increasing"));
+          return;
+        }
+        if (!FastBoundsCheck(out_index, output_rows)) {
+          set_error(2 * start + 1,
+                    errors::InvalidArgument(
+                        "Segment id ", out_index, " out of range [0, ",
+                        output_rows,
+                        "), possibly because 'segment_ids' input is not "
+                        "sorted."));
+          return;
+        }
+        ReduceSegment(input_flat, start, end, uninitialized_index, out_index,
+                      dims_to_reduce, out_slice_shape, output_flat);
+        uninitialized_index = out_index + 1;
+        start = end;
       }
+    };
+    auto worker_threads = context->device()->tensorflow_cpu_worker_threads();
+    Shard(worker_threads->num_threads, worker_threads->workers, num_indices,
+          /*cost_per_unit=*/num_col * sizeof(T), work);
+    OP_REQUIRES_OK(context, error);
+  }
 
-      // Process segment [start, end)
-      const T* in_slice_ptr = &input_flat(start, 0);
-      typedef Eigen::TensorMap<Eigen::Tensor<T, 1, Eigen::RowMajor>,
-                               Eigen::Unaligned>
-          OutT;
-
-      OP_REQUIRES(
-          context, FastBoundsCheck(out_index, output_rows),
-          errors::InvalidArgument(
-              "Segment id ", out_index, " out of range [0, ", output_rows,
-              "), possibly because 'segment_ids' input is not sorted."));
+ private:
+  // Reduces the rows [start, end) of `input_flat` into row `out_index` of
+  // `output_flat`, after setting the rows [uninitialized_index, out_index) to
+  // the default value.
+  static void ReduceSegment(
+      typename TTypes<T, 2>::ConstTensor input_flat, Index start, Index end,
+      Index uninitialized_index, Index out_index,
+      const Eigen::IndexList<Eigen::type2index<0> >& dims_to_reduce,
+      const Eigen::DSizes<Eigen::DenseIndex, 1>& out_slice_shape,
+      typename TTypes<T, 2>::Tensor output_flat) {
+    const Eigen::DenseIndex num_col = out_slice_shape[0];
+    const T* in_slice_ptr = &input_flat(start, 0);
+    typedef Eigen::TensorMap<Eigen::Tensor<T, 1, Eigen::RowMajor>,
+                             Eigen::Unaligned>
+        OutT;
+
+    // If there is a gap between two indices, we need to set that gap to the
+    // default value.
+    if (out_index > uninitialized_index) {
+      Eigen::DSizes<Eigen::DenseIndex, 2> gap_slice_shape(
+          out_index - uninitialized_index, num_col);
+      Eigen::TensorMap<Eigen::Tensor<T, 2, Eigen::RowMajor>, Eigen::Unaligned>
+          gap_slice(&output_flat(uninitialized_index, 0), gap_slice_shape);
+      gap_slice.setConstant(T(default_value));
+    }
 
-      // If there is a gap between two indices, we need to set that gap to the
-      // default value.
-      if (out_index > uninitialized_index) {
-        Eigen::DSizes<Eigen::DenseIndex, 2> gap_slice_shape(
-            out_index - uninitialized_index, num_col);
-        Eigen::TensorMap<Eigen::Tensor<T, 2, Eigen::RowMajor>, Eigen::Unaligned>
-            gap_slice(&output_flat(uninitialized_index, 0), gap_slice_shape);
-        gap_slice.setConstant(T(default_value));
-      }
+    T* out_slice_ptr = &output_flat(out_index, 0);
+    OutT out_slice(out_slice_ptr, out_slice_shape);
+    // We don't use out_slice.device(context->eigen_device<Device>)
+    // because the segments are already reduced in parallel, and most are
+    // too small for the context switching overhead of splitting them. With
+    // the inner dimension preserved, Eigen vectorizes the reduction along it.
+    if (start == end - 1) {
+      typedef Eigen::TensorMap<Eigen::Tensor<const T, 1, Eigen::RowMajor>,
+                               Eigen::Unaligned>
+          InT;
+      InT in_slice(in_slice_ptr, out_slice_shape);
+      out_slice = in_slice;
+    } else {
+      Eigen::DSizes<Eigen::DenseIndex, 2> in_slice_shape(end - start, num_col);
+      typedef Eigen::TensorMap<Eigen::Tensor<const T, 2, Eigen::RowMajor>,
+                               Eigen::Unaligned>
+          InT;
+      InT in_slice(in_slice_ptr, in_slice_shape);
 
-      T* out_slice_ptr = &output_flat(out_index, 0);
-      OutT out_slice(out_slice_ptr, out_slice_shape);
-      // We don't use out_slice.device(context->eigen_device<Device>)
-      // because these pieces of work are likely to be very small and
-      // the context switching overhead dwarfs any benefit we get from
-      // using another thread to do this work.
-      if (start == end - 1) {
-        typedef Eigen::TensorMap<Eigen::Tensor<const T, 1, Eigen::RowMajor>,
-                                 Eigen::Unaligned>
-            InT;
-        InT in_slice(in_slice_ptr, out_slice_shape);
-        out_slice = in_slice;
-      } else {
-        Eigen::DSizes<Eigen::DenseIndex, 2> in_slice_shape(end - start,
-                                                           num_col);
-        typedef Eigen::TensorMap<Eigen::Tensor<const T, 2, Eigen::RowMajor>,
-                                 Eigen::Unaligned>
-            InT;
-        InT in_slice(in_slice_ptr, in_slice_shape);
-
-        out_slice = in_slice.reduce(dims_to_reduce, Reducer());
-      }
-      if (end >= num_indices) break;
-      start = end;
-      ++end;
-      uninitialized_index = out_index + 1;
-      out_index = next_index;
+      out_slice = in_slice.reduce(dims_to_reduce, Reducer());
     }
   }
 };
@@ -20,10 +20,14 @@ limitations under the License.
 #endif
 
 #include <algorithm>
+#include <limits>
 #include <memory>
 #include <numeric>
+#include <utility>
+#include <vector>
 
 #include "Eigen/SparseCore"  // from @eigen_archive
+#include "absl/container/flat_hash_map.h"
 #include "unsupported/Eigen/CXX11/Tensor"  // from @eigen_archive
 #include "tensorflow/core/framework/op.h"
 #include "tensorflow/core/framework/op_kernel.h"
@@ -59,6 +63,82 @@ void SwapDimSizes(const int dim_a, const int dim_b, TensorShape* shape) {
   shape->set_dim(dim_b, size_a);
 }
 
+// Accumulates the products of one row of a sparse-sparse matmul in an array
+// indexed by column, which is reused across the rows. Its memory grows with
+// the number of columns of the product.
+template <typename T>
+class DenseRowAccumulator {
+ public:
+  explicit DenseRowAccumulator(int64_t num_cols)
+      : row_of_col_(num_cols, -1), values_(num_cols) {}
+
+  void StartRow(int row) {
+    row_ = row;
+    cols_.clear();
+  }
+
+  // Adds `value` to the entry at `col` of the current row.
+  void Add(int col, const T& value) {
+    if (row_of_col_[col] != row_) {
+      row_of_col_[col] = row_;
+      values_[col] = value;
+      cols_.push_back(col);
+    } else {
+      values_[col] += value;
+    }
+  }
+
+  int64_t size() const { return cols_.size(); }
+
+  // Writes the entries of the current row, sorted by column.
+  void Finish(int* cols, T* values) {
+    std::sort(cols_.begin(), cols_.end());
+    for (int64_t i = 0; i < cols_.size(); ++i) {
+      cols[i] = cols_[i];
+      values[i] = values_[cols_[i]];
+    }
+  }
+
+ private:
+  int row_ = -1;
+  std::vector<int> row_of_col_;
+  std::vector<T> values_;
+  std::vector<int> cols_;
+};
+
+// Accumulates the products of one row of a sparse-sparse matmul in a hash map,
+// for products with too many columns for a DenseRowAccumulator.
+template <typename T>
+class HashRowAccumulator {
+ public:
+  void StartRow(int row) { values_.clear(); }
+
+  // Adds `value` to the entry at `col` of the current row.
+  void Add(int col, const T& value) {
+    auto [it, inserted] = values_.try_emplace(col, value);
+    if (!inserted) it->second += value;
+  }
+
+  int64_t size() const { return values_.size(); }
+
+  // Writes the entries of the current row, sorted by column.
+  void Finish(int* cols, T* values) {
+    entries_.assign(values_.begin(), values_.end());
+    std::sort(entries_.begin(), entries_.end(),
+              [](const std::pair<int, T>& lhs, const std::pair<int, T>& rhs) {
+                return lhs.first < rhs.first;
+              });
+    for (int64_t i = 0; i < entries_.size(); ++i) {
+      cols[i] = entries_[i].first;
+      values[i] = entries_[i].second;
+    }
+  }
+
+ private:
+  absl::flat_hash_map<int, T> values_;
+  std::vector<std::pair<int, T>> entries_;
+};
+
 #if GOOGLE_CUDA
 
 // Concatenates 'inputs' into a single tensor along the zeroth dimension.
@@ -98,8 +178,10 @@ void ConcatHelper(OpKernelContext* context, const std::vector<Tensor>& inputs,
 // the op's interface.
 //
 // If multiple threads are available, we parallelize across multiple batches
-// using Eigen ThreadPool. Within a single batch, we run in single threaded mode
-// because Eigen's Sparse-Sparse matmul doesn't support multithreading.
+// using Eigen ThreadPool. Eigen's Sparse-Sparse matmul doesn't support
+// multithreading, so when there are fewer batches than threads we instead
+// multiply each batch with Gustavson's algorithm, partitioning the rows of the
+// product across the threads.
 //
 // TODO(b/126472741): Due to the multiple batches of a 3D CSRSparseMatrix being
 // laid out in contiguous memory, this implementation allocates memory to store
@@ -210,8 +292,24 @@ class CSRSparseMatMulCPUOp : public OpKernel {
     const int64_t matmul_cost_per_batch =
         num_output_rows * (avg_nnz_per_row_a * avg_nnz_per_row_b);
 
-    // Parallelize matrix multiplication across batches.
-    Shard(worker_threads.num_threads, worker_threads.workers, batch_size,
+    if (batch_size < worker_threads.num_threads) {
+      // Parallelize matrix multiplication across the rows of each batch.
+      for (int64_t batch_idx = 0; batch_idx < batch_size; ++batch_idx) {
+        int batch_a = broadcast_batch_a ? 0 : batch_idx;
+        int batch_b = broadcast_batch_b ? 0 : batch_idx;
+        auto a_ref = GetSparseMatrixRef(*input_matrix_a, rank, batch_a,
+                                        transpose_a_, adjoint_a_);
+        auto b_ref = GetSparseMatrixRef(*input_matrix_b, rank, batch_b,
+                                        transpose_b_, adjoint_b_);
+        OP_REQUIRES_OK(ctx,
+                       ParallelSparseMatMul(worker_threads, a_ref, b_ref,
+                                            &output_matrices[batch_idx]));
+        batch_ptr_vec(batch_idx + 1) = output_matrices[batch_idx].nonZeros();
+      }
+    } else {
+      // Parallelize matrix multiplication across batches.
+      Shard(
+          worker_threads.num_threads, worker_threads.workers, batch_size,
           matmul_cost_per_batch, [&](int64_t batch_begin, int64_t batch_end) {
             for (int64_t batch_idx = batch_begin; batch_idx < batch_end;
                  ++batch_idx) {
@@ -224,8 +322,8 @@ class CSRSparseMatMulCPUOp : public OpKernel {
               auto b_ref = GetSparseMatrixRef(*input_matrix_b, rank, batch_b,
                                               transpose_b_, adjoint_b_);
 
-              // Matrix multiply while *not* pruning numerical zeros on the fly.
-              // Allocates output SparseMatrix and moves it to our list of
+              // Matrix multiply while *not* pruning numerical zeros on the
+              // fly. Allocates output SparseMatrix and moves it to our list of
               // output_matrices.
               output_matrices[batch_idx] = a_ref * b_ref;
 
@@ -235,6 +333,7 @@ class CSRSparseMatMulCPUOp : public OpKernel {
                   output_matrices[batch_idx].nonZeros();
             }
           });
+    }
 
     // Compute the cumulative sum to obtain the batch pointers.
     std::partial_sum(batch_ptr_vec.data(),
@@ -291,6 +390,93 @@ class CSRSparseMatMulCPUOp : public OpKernel {
   }
 
  private:
+  // Computes `a * b` into `output` with Gustavson's algorithm, partitioning
+  // the rows of the product across the worker threads. A first pass counts the
+  // nonzeros of each row of the product, so that a second pass can write the
+  // rows in place. As with Eigen's product, numeric zeros are not pruned.
+  Status ParallelSparseMatMul(
+      const DeviceBase::CpuWorkerThreads& worker_threads,
+      const Eigen::Ref<const SparseMatrix>& a,
+      const Eigen::Ref<const SparseMatrix>& b, SparseMatrix* output) {
+    DCHECK(a.isCompressed());
+    DCHECK(b.isCompressed());
+    const int64_t num_rows = a.rows();
+    const int64_t num_cols = b.cols();
+    const int* a_row_ptr = a.outerIndexPtr();
+    const int* a_col_ind = a.innerIndexPtr();
+    const T* a_values = a.valuePtr();
+    const int* b_row_ptr = b.outerIndexPtr();
+    const int* b_col_ind = b.innerIndexPtr();
+    const T* b_values = b.valuePtr();
+
+    // Estimate the cost per row as the average number of products per row.
+    const double avg_products_per_row =
+        num_rows == 0 || b.rows() == 0
+            ? 0.0
+            : (static_cast<double>(a.nonZeros()) / num_rows) *
+                  (static_cast<double>(b.nonZeros()) / b.rows());
+    const int64_t cost_per_row = std::max<int64_t>(1, avg_products_per_row);
+
+    // Runs `compute_rows(row_begin, row_end, accumulator)` over the rows. A
+    // DenseRowAccumulator is only used when the products of the rows of the
+    // shard outweigh its initialization.
+    const auto shard_rows = [&](const auto& compute_rows) {
+      Shard(worker_threads.num_threads, worker_threads.workers, num_rows,
+            cost_per_row, [&](int64_t row_begin, int64_t row_end) {
+              if (num_cols <= 4 * (row_end - row_begin) * cost_per_row) {
+                DenseRowAccumulator<T> accumulator(num_cols);
+                compute_rows(row_begin, row_end, &accumulator);
+              } else {
+                HashRowAccumulator<T> accumulator;
+                compute_rows(row_begin, row_end, &accumulator);
+              }
+            });
+    };
+    // Accumulates row `row` of the product, or only its structure if
+    // `values` is false.
+    const auto accumulate_row = [&](int64_t row, bool values,
+                                    auto* accumulator) {
+      accumulator->StartRow(row);
+      for (int i = a_row_ptr[row]; i < a_row_ptr[row + 1]; ++i) {
+        const int k = a_col_ind[i];
+        const T a_value = values ? a_values[i] : T();
+        for (int j = b_row_ptr[k]; j < b_row_ptr[k + 1]; ++j) {
+          accumulator->Add(b_col_ind[j], values ? a_value * b_values[j] : T());
+        }
+      }
+    };
+
+    *output = SparseMatrix(num_rows, num_cols);
+    int* row_ptr = output->outerIndexPtr();
+    std::vector<int64_t> row_nnz(num_rows + 1, 0);
+    shard_rows([&](int64_t row_begin, int64_t row_end, auto* accumulator) {
+      for (int64_t row = row_begin; row < row_end; ++row) {
+        accumulate_row(row, /*values=*/false, accumulator);
+        row_nnz[row + 1] = accumulator->size();
+      }
+    });
+    std::partial_sum(row_nnz.begin(), row_nnz.end(), row_nnz.begin());
+    const int64_t total_nnz = row_nnz[num_rows];
+    if (total_nnz > std::numeric_limits<int>::max()) {
+      return errors::InvalidArgument(
+          "The product of the sparse matrices has ", total_nnz,
+          " nonzeros, more than the maximum of ",
+          std::numeric_limits<int>::max());
+    }
+    std::copy(row_nnz.begin(), row_nnz.end(), row_ptr);
+
+    output->resizeNonZeros(total_nnz);
+    int* col_ind = output->innerIndexPtr();
+    T* values = output->valuePtr();
+    shard_rows([&](int64_t row_begin, int64_t row_end, auto* accumulator) {
+      for (int64_t row = row_begin; row < row_end; ++row) {
+        accumulate_row(row, /*values=*/true, accumulator);
+        accumulator->Finish(col_ind + row_ptr[row], values + row_ptr[row]);
+      }
+    });
+    return absl::OkStatus();
+  }
+
   // Returns an Eigen::Ref expression of a SparseMatrix; which points to the
   // underlying memory of the given CSRSparseMatrix.
   Eigen::Ref<const SparseMatrix> GetSparseMatrixRef(
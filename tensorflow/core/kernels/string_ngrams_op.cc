@@ -14,6 +14,7 @@ limitations under the License.
 ==============================================================================*/
 
 #include <algorithm>
+#include <cstring>
 #include <locale>
 #include <string>
 
@@ -210,17 +211,24 @@ class StringNGramsOp : public tensorflow::OpKernel {
       int num_separators = left_padding + right_padding + num_tokens - 1;
       ngram_size += num_separators * separator_.length();
 
-      // Build the ngram.
+      // Build the ngram in place, in a buffer sized once for it and without
+      // the capacity checks of appending to the tstring.
       tstring* ngram = &output[ngram_index];
-      ngram->reserve(ngram_size);
+      ngram->resize_uninitialized(ngram_size);
+      char* ngram_end = ngram->mdata();
+      auto append = [&ngram_end](StringPiece piece) {
+        if (piece.empty()) return;
+        std::memcpy(ngram_end, piece.data(), piece.size());
+        ngram_end += piece.size();
+      };
       for (int n = 0; n < left_padding; ++n) {
-        ngram->append(left_pad_);
-        ngram->append(separator_);
+        append(left_pad_);
+        append(separator_);
       }
       // Only output first num_tokens - 1 pairs of data and separator
       for (int n = 0; n < num_tokens - 1; ++n) {
-        ngram->append(data[data_start_index + n]);
-        ngram->append(separator_);
+        append(data[data_start_index + n]);
+        append(separator_);
       }
       // Handle case when there are no tokens or no right padding as these can
       // result in consecutive separators.
@@ -228,10 +236,10 @@ class StringNGramsOp : public tensorflow::OpKernel {
         // If we have tokens, then output last and then pair each separator with
         // the right padding that follows, to ensure ngram ends either with the
         // token or with the right pad.
-        ngram->append(data[data_start_index + num_tokens - 1]);
+        append(data[data_start_index + num_tokens - 1]);
         for (int n = 0; n < right_padding; ++n) {
-          ngram->append(separator_);
-          ngram->append(right_pad_);
+          append(separator_);
+          append(right_pad_);
         }
       } else {
         // If we don't have tokens, then the last item inserted into the ngram
@@ -239,15 +247,15 @@ class StringNGramsOp : public tensorflow::OpKernel {
         // output right pad and separator and make sure to finish with a
         // padding, not a separator.
         for (int n = 0; n < right_padding - 1; ++n) {
-          ngram->append(right_pad_);
-          ngram->append(separator_);
+          append(right_pad_);
+          append(separator_);
         }
-        ngram->append(right_pad_);
+        append(right_pad_);
       }
 
-      // In debug mode only: validate that we've reserved enough space for the
-      // ngram.
-      DCHECK_EQ(ngram_size, ngram->size());
+      // In debug mode only: validate that we've filled exactly the space
+      // sized for the ngram.
+      DCHECK_EQ(ngram_size, ngram_end - ngram->data());
     }
   }
 
@@ -16,13 +16,16 @@ limitations under the License.
 #ifndef TENSORFLOW_CORE_KERNELS_STRING_TO_HASH_BUCKET_FAST_OP_H_
 #define TENSORFLOW_CORE_KERNELS_STRING_TO_HASH_BUCKET_FAST_OP_H_
 
+#include <algorithm>
 #include <string>
 
+#include "absl/base/prefetch.h"
 #include "tensorflow/core/framework/op_kernel.h"
 #include "tensorflow/core/framework/tensor.h"
 #include "tensorflow/core/lib/core/errors.h"
 #include "tensorflow/core/lib/core/status.h"
 #include "tensorflow/core/platform/macros.h"
+#include "tensorflow/core/util/work_sharder.h"
 
 namespace tensorflow {
 
@@ -44,18 +47,53 @@ class StringToHashBucketOp : public OpKernel {
                                             &output_tensor));
     auto output_flat = output_tensor->flat<int64_t>();
 
-    typedef decltype(input_flat.size()) Index;
-    for (Index i = 0; i < input_flat.size(); ++i) {
-      const uint64 input_hash = hash(input_flat(i));
-      const uint64 bucket_id = input_hash % num_buckets_;
-      // The number of buckets is always in the positive range of int64 so is
-      // the resulting bucket_id. Casting the bucket_id from uint64 to int64 is
-      // safe.
-      output_flat(i) = static_cast<int64_t>(bucket_id);
-    }
+    const tstring* input_data = input_flat.data();
+    int64_t* output_data = output_flat.data();
+    const uint64 num_buckets = num_buckets_;
+    auto work = [input_data, output_data, num_buckets](int64_t start,
+                                                       int64_t limit) {
+      HashBatch(input_data, start, limit, num_buckets, output_data);
+    };
+    // Categorical feature values are mostly short enough to be stored inline
+    // in their tstring, so the cost is dominated by the hash of a few bytes.
+    const int64_t kCostPerUnit = 50;
+    auto worker_threads = context->device()->tensorflow_cpu_worker_threads();
+    Shard(worker_threads->num_threads, worker_threads->workers,
+          input_flat.size(), kCostPerUnit, work);
   }
 
  private:
+  // The number of strings gathered before hashing any of them.
+  static constexpr int64_t kBatchSize = 16;
+
+  // Hashes the strings in [start, limit) into `output`. The strings are
+  // taken a batch at a time: the bytes of the strings that are not stored
+  // inline in their tstring are prefetched first, so that their cache misses
+  // overlap instead of stalling each hash in turn.
+  static void HashBatch(const tstring* input, int64_t start, int64_t limit,
+                        uint64 num_buckets, int64_t* output) {
+    StringPiece batch[kBatchSize];
+    for (int64_t batch_start = start; batch_start < limit;
+         batch_start += kBatchSize) {
+      const int64_t batch_size = std::min(kBatchSize, limit - batch_start);
+      for (int64_t i = 0; i < batch_size; ++i) {
+        const tstring& input_string = input[batch_start + i];
+        batch[i] = StringPiece(input_string.data(), input_string.size());
+        if (input_string.type() != tstring::SMALL) {
+          absl::PrefetchToLocalCache(input_string.data());
+        }
+      }
+      for (int64_t i = 0; i < batch_size; ++i) {
+        const uint64 input_hash = hash(batch[i]);
+        const uint64 bucket_id = input_hash % num_buckets;
+        // The number of buckets is always in the positive range of int64 so
+        // is the resulting bucket_id. Casting the bucket_id from uint64 to
+        // int64 is safe.
+        output[batch_start + i] = static_cast<int64_t>(bucket_id);
+      }
+    }
+  }
+
   int64_t num_buckets_;
 
   StringToHashBucketOp(const StringToHashBucketOp&) = delete;
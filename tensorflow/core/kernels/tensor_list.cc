@@ -21,6 +21,34 @@ limitations under the License.
 
 namespace tensorflow {
 
+TensorListBuffer::TensorListBuffer(Tensor buffer)
+    : buffer_(std::move(buffer)), claimed_(buffer_.dim_size(0), false) {}
+
+bool TensorListBuffer::HoldsElementsLike(const Tensor& t) const {
+  if (t.dtype() != buffer_.dtype() || t.dims() + 1 != buffer_.dims()) {
+    return false;
+  }
+  for (int i = 0; i < t.dims(); ++i) {
+    if (t.dim_size(i) != buffer_.dim_size(i + 1)) return false;
+  }
+  return true;
+}
+
+bool TensorListBuffer::Claim(int64_t index) {
+  DCHECK_LT(index, capacity());
+  mutex_lock l(mu_);
+  if (claimed_[index]) return false;
+  claimed_[index] = true;
+  return true;
+}
+
+bool TensorListBuffer::IsSlot(const Tensor& t, int64_t index) const {
+  if (index >= capacity() || !HoldsElementsLike(t)) return false;
+  const size_t slot_bytes = t.TotalBytes();
+  return t.tensor_data().data() ==
+         buffer_.tensor_data().data() + index * slot_bytes;
+}
+
 TensorList::~TensorList() {
   if (tensors_) tensors_->Unref();
 }
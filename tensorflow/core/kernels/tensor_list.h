@@ -16,14 +16,53 @@ limitations under the License.
 #define TENSORFLOW_CORE_KERNELS_TENSOR_LIST_H_
 
 #include <utility>
+#include <vector>
 
 #include "tensorflow/core/framework/tensor.h"
 #include "tensorflow/core/framework/variant.h"
 #include "tensorflow/core/framework/variant_tensor_data.h"
 #include "tensorflow/core/lib/core/refcount.h"
+#include "tensorflow/core/platform/mutex.h"
+#include "tensorflow/core/platform/thread_annotations.h"
 
 namespace tensorflow {
 
+// A buffer of elements of one shape and dtype, which the elements of a
+// TensorList may be slices of, so that consecutive elements can be read as
+// one slice of the buffer without copying them.
+//
+// The buffer is shared by the copies of a list, so each slot is written once,
+// by the first list that claims it, and is never modified afterwards.
+class TensorListBuffer : public core::RefCounted {
+ public:
+  // `buffer` has shape [capacity] + element shape, and a dtype that can be
+  // copied with memcpy.
+  explicit TensorListBuffer(Tensor buffer);
+
+  const Tensor& buffer() const { return buffer_; }
+
+  int64_t capacity() const { return buffer_.dim_size(0); }
+
+  // Returns whether `t` has the shape and dtype of the elements of the buffer.
+  bool HoldsElementsLike(const Tensor& t) const;
+
+  // Claims slot `index`, which must be less than the capacity. Returns false
+  // if it was already claimed. The caller must write the slot before sharing
+  // its slice.
+  bool Claim(int64_t index);
+
+  // Returns the slice of slot `index`.
+  Tensor Slot(int64_t index) const { return buffer_.SubSlice(index); }
+
+  // Returns whether `t` is the slice of slot `index`.
+  bool IsSlot(const Tensor& t, int64_t index) const;
+
+ private:
+  const Tensor buffer_;
+  mutex mu_;
+  std::vector<bool> claimed_ TF_GUARDED_BY(mu_);
+};
+
 // Variant compatible type for a list of tensors. This is mutable but instances
 // should never be mutated after stored in a variant tensor.
 //
@@ -134,9 +173,21 @@ class TensorList {
     out.max_num_elements = max_num_elements;
     // This performs a copy of the std::vector.
     out.tensors_->values_ = tensors_->values_;
+    if (buffer() != nullptr) {
+      buffer()->Ref();
+      out.tensors_->buffer_.reset(buffer());
+    }
     return out;
   }
 
+  // The buffer that the elements of this list may be slices of, or nullptr.
+  // It is shared with the copies of this list.
+  TensorListBuffer* buffer() const { return tensors_->buffer_.get(); }
+
+  void set_buffer(core::RefCountPtr<TensorListBuffer> buffer) {
+    tensors_->buffer_ = std::move(buffer);
+  }
+
   // Is this TensorList the only one with a reference to the underlying
   // container?
   bool RefCountIsOne() const { return tensors_->RefCountIsOne(); }
@@ -145,6 +196,7 @@ class TensorList {
   class Tensors : public core::RefCounted {
    public:
     std::vector<Tensor> values_;
+    core::RefCountPtr<TensorListBuffer> buffer_;
   };
   Tensors* tensors_;
 };
@@ -20,7 +20,9 @@ limitations under the License.
 #include "tensorflow/core/kernels/topk_op.h"
 
 #include <algorithm>
+#include <functional>
 #include <numeric>
+#include <utility>
 #include <vector>
 
 #include "unsupported/Eigen/CXX11/Tensor"  // from @eigen_archive
@@ -30,6 +32,7 @@ limitations under the License.
 #include "tensorflow/core/framework/tensor_shape.h"
 #include "tensorflow/core/framework/types.h"
 #include "tensorflow/core/lib/gtl/top_n.h"
+#include "tensorflow/core/platform/mutex.h"
 #include "tensorflow/core/util/work_sharder.h"
 
 namespace tensorflow {
@@ -129,6 +132,63 @@ class TopK : public OpKernel {
 
 namespace functor {
 
+// Rows of at least kTopKFilterMinCols columns, with k at most a
+// kTopKFilterMaxKFraction-th of them, are filtered against a threshold
+// estimated from a sample of the row before the exact top k is taken of the
+// values that pass it.
+constexpr int64_t kTopKFilterMinCols = 4096;
+constexpr int64_t kTopKFilterMaxKFraction = 64;
+// The number of columns tested at once by FilterTopKCandidates.
+constexpr int64_t kTopKFilterBlockSize = 64;
+constexpr int64_t kTopKFilterMinSampleSize = 1024;
+
+// Returns a threshold that about 2k of the values of the row are not less
+// than, estimated from the values at a regular stride. Any threshold gives
+// the exact top k as long as at least k values pass it; a lower one only
+// lets more candidates through.
+template <typename T>
+T EstimateTopKThreshold(const T* row, int64_t num_cols, int k) {
+  const int64_t sample_size = std::min(
+      num_cols, std::max<int64_t>(kTopKFilterMinSampleSize, int64_t{16} * k));
+  const int64_t stride = num_cols / sample_size;
+  std::vector<T> sample;
+  sample.reserve(sample_size);
+  for (int64_t i = 0; i < sample_size; ++i) {
+    const T value = row[i * stride];
+    // NaNs would break the ordering of nth_element.
+    if (!Eigen::numext::isnan(value)) sample.push_back(value);
+  }
+  if (sample.empty()) return Eigen::NumTraits<T>::lowest();
+  const int64_t rank =
+      std::min<int64_t>(sample.size() - 1, 2 * k * sample_size / num_cols + 2);
+  std::nth_element(sample.begin(), sample.begin() + rank, sample.end(),
+                   std::greater<T>());
+  return sample[rank];
+}
+
+// Appends the columns in [begin, end) of the row whose values are not less
+// than `threshold` to `candidates`. The columns are tested a block at a time
+// with a branch-free compare which the compiler vectorizes, and only the
+// blocks holding a candidate, which are rare, are scanned again.
+template <typename T, typename Tidx>
+void FilterTopKCandidates(const T* row, int64_t begin, int64_t end,
+                          T threshold, std::vector<Tidx>* candidates) {
+  int64_t c = begin;
+  for (; c + kTopKFilterBlockSize <= end; c += kTopKFilterBlockSize) {
+    int any = 0;
+    for (int64_t i = 0; i < kTopKFilterBlockSize; ++i) {
+      any |= !(row[c + i] < threshold);
+    }
+    if (!any) continue;
+    for (int64_t i = c; i < c + kTopKFilterBlockSize; ++i) {
+      if (!(row[i] < threshold)) candidates->push_back(static_cast<Tidx>(i));
+    }
+  }
+  for (; c < end; ++c) {
+    if (!(row[c] < threshold)) candidates->push_back(static_cast<Tidx>(c));
+  }
+}
+
 template <typename T, typename Tidx>
 struct TopKFunctor<CPUDevice, T, Tidx> {
   static EIGEN_ALWAYS_INLINE Status Compute(
@@ -161,19 +221,55 @@ struct TopKFunctor<CPUDevice, T, Tidx> {
       return OkStatus();
     }
 
+    const bool use_filter = k < num_cols && num_cols >= kTopKFilterMinCols &&
+                            k * kTopKFilterMaxKFraction <= num_cols;
+
+    // Writes the indices of the top k values of row b to `indices`, taking
+    // them from `candidates`, or from all the columns if it is null.
+    auto TopKOfRow = [&](int64_t b, const std::vector<Tidx>* candidates) {
+      const T* input_data = &input(b, 0);
+      const auto stable_comp = [input_data](const Tidx a, const Tidx b) {
+        if (input_data[b] < input_data[a]) {
+          return true;
+        } else if (input_data[b] > input_data[a]) {
+          return false;
+        } else {
+          return a < b;
+        }
+      };
+      // Use the TopN heap object to sort.
+      gtl::TopN<Tidx, decltype(stable_comp)> filter(k, stable_comp);
+      if (candidates == nullptr) {
+        filter.reserve(num_cols);
+        for (Tidx c = 0; c < num_cols; ++c) {
+          filter.push(c);
+        }
+      } else {
+        filter.reserve(candidates->size());
+        for (const Tidx c : *candidates) {
+          filter.push(c);
+        }
+      }
+
+      int32_t i = 0;
+      if (sorted) {
+        std::unique_ptr<std::vector<Tidx>> top_k(filter.Extract());
+        for (auto top_k_it = top_k->begin(); top_k_it != top_k->end();
+             ++top_k_it, ++i) {
+          indices(b, i) = *top_k_it;
+        }
+      } else {
+        for (auto top_k_it = filter.unsorted_begin();
+             top_k_it != filter.unsorted_end(); ++top_k_it, ++i) {
+          indices(b, i) = *top_k_it;
+        }
+      }
+    };
+
     auto SortIndices = [&](int64_t start_batch, int64_t limit_batch) {
+      std::vector<Tidx> candidates;
       for (int32_t b = start_batch; b < limit_batch; ++b) {
         const T* input_data = &input(b, 0);
-        const auto stable_comp = [input_data](const int32_t a,
-                                              const int32_t b) {
-          if (input_data[b] < input_data[a]) {
-            return true;
-          } else if (input_data[b] > input_data[a]) {
-            return false;
-          } else {
-            return a < b;
-          }
-        };
         const auto comp = [input_data](const int32_t a, const int32_t b) {
           return input_data[b] < input_data[a];
         };
@@ -204,27 +300,16 @@ struct TopKFunctor<CPUDevice, T, Tidx> {
             }
             run_begin = run_end;
           }
+        } else if (use_filter) {
+          candidates.clear();
+          FilterTopKCandidates(input_data, 0, num_cols,
+                               EstimateTopKThreshold(input_data, num_cols, k),
+                               &candidates);
+          // Too low an estimate is fine, too high a one needs the whole row.
+          TopKOfRow(b, candidates.size() >= static_cast<size_t>(k) ? &candidates
+                                                                  : nullptr);
         } else {
-          // Use the TopN heap object to sort.
-          gtl::TopN<Tidx, decltype(stable_comp)> filter(k, stable_comp);
-          filter.reserve(num_cols);
-          for (Tidx c = 0; c < num_cols; ++c) {
-            filter.push(c);
-          }
-
-          int32_t i = 0;
-          if (sorted) {
-            std::unique_ptr<std::vector<Tidx>> top_k(filter.Extract());
-            for (auto top_k_it = top_k->begin(); top_k_it != top_k->end();
-                 ++top_k_it, ++i) {
-              indices(b, i) = *top_k_it;
-            }
-          } else {
-            for (auto top_k_it = filter.unsorted_begin();
-                 top_k_it != filter.unsorted_end(); ++top_k_it, ++i) {
-              indices(b, i) = *top_k_it;
-            }
-          }
+          TopKOfRow(b, nullptr);
         }
         // Now that the indices are sorted, copy the values over in
         // sorted order.
@@ -233,21 +318,53 @@ struct TopKFunctor<CPUDevice, T, Tidx> {
       }  // for (Tidx b = ...
     };
 
-    // Guesstimate of cost; 4*N*log(K) where N == num_cols.
-    // If K == N, assume the cost is N*log(K + 1).
     const double cmp_cost = 3 * Eigen::TensorOpCost::AddCost<Tidx>() +
                             Eigen::TensorOpCost::AddCost<T>();
+    auto worker_threads = *(context->device()->tensorflow_cpu_worker_threads());
+
+    // With fewer rows than threads, split the filtering of each row instead.
+    if (use_filter && num_rows < worker_threads.num_threads) {
+      mutex mu;
+      std::vector<Tidx> candidates;
+      for (int64_t b = 0; b < num_rows; ++b) {
+        const T* input_data = &input(b, 0);
+        const T threshold = EstimateTopKThreshold(input_data, num_cols, k);
+        candidates.clear();
+        Shard(worker_threads.num_threads, worker_threads.workers, num_cols,
+              static_cast<int64_t>(cmp_cost),
+              [&](int64_t start_col, int64_t limit_col) {
+                std::vector<Tidx> shard_candidates;
+                FilterTopKCandidates(input_data, start_col, limit_col,
+                                     threshold, &shard_candidates);
+                mutex_lock l(mu);
+                candidates.insert(candidates.end(), shard_candidates.begin(),
+                                  shard_candidates.end());
+              });
+        // The order of the candidates does not matter as ties are broken by
+        // index.
+        TopKOfRow(b, candidates.size() >= static_cast<size_t>(k) ? &candidates
+                                                                : nullptr);
+        std::transform(&indices(b, 0), &indices(b, k), &values(b, 0),
+                       [b, &input](const Tidx loc) { return input(b, loc); });
+      }
+      return OkStatus();
+    }
+
+    // Guesstimate of cost; 4*N*log(K) where N == num_cols.
+    // If K == N, assume the cost is N*log(K + 1). Filtered rows are assumed
+    // to cost a compare per column.
     const double base_cost =
         cmp_cost *
         static_cast<double>(num_cols *
                             Eigen::numext::log2(static_cast<float>(k + 1)));
-    const double sort_cost = (k == num_cols) ? base_cost : 4 * base_cost;
+    const double sort_cost = use_filter       ? cmp_cost * num_cols
+                             : (k == num_cols) ? base_cost
+                                               : 4 * base_cost;
     const double copy_cost = 2 * k * Eigen::TensorOpCost::AddCost<T>();
     const double total_cost = sort_cost + copy_cost;
     const int64_t final_cost = (total_cost >= static_cast<double>(kint64max))
                                    ? kint64max
                                    : static_cast<int64_t>(total_cost);
-    auto worker_threads = *(context->device()->tensorflow_cpu_worker_threads());
     Shard(worker_threads.num_threads, worker_threads.workers, num_rows,
           final_cost, SortIndices);
 
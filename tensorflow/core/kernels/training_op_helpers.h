@@ -17,6 +17,10 @@ limitations under the License.
 #define TENSORFLOW_CORE_KERNELS_TRAINING_OP_HELPERS_H_
 
 #include <optional>
+#include <type_traits>
+#include <vector>
+
+#include "absl/types/span.h"
 
 #include "tensorflow/core/framework/op_kernel.h"
 #include "tensorflow/core/framework/tensor.h"
@@ -273,6 +277,7 @@ Status GetInputTensorFromVariable(OpKernelContext* ctx, int input,
     }
     TF_RETURN_IF_ERROR(PrepareToUpdateVariable<Device, T>(
         ctx, var->tensor(), var->copy_on_read_mode.load()));
+    var->MarkAllRowsDirty();
     *out = *var->tensor();
     return absl::OkStatus();
   }
@@ -280,6 +285,32 @@ Status GetInputTensorFromVariable(OpKernelContext* ctx, int input,
   return absl::OkStatus();
 }
 
+// Records that a sparse update of the rows in input "indices_input" modifies
+// the resource variables in "inputs", for the variables that track their
+// dirty rows (see Var::StartTrackingDirtyRows()).  Indices in device memory
+// cannot be read here, so their variables are marked dirty entirely.
+template <typename Device, typename Tindex>
+void MarkSparseUpdatedRows(OpKernelContext* ctx,
+                           const std::vector<int>& inputs, int indices_input) {
+  if (!Var::AnyTrackingDirtyRows()) return;
+  const Tensor& indices = ctx->input(indices_input);
+  const bool indices_on_host =
+      std::is_same<Device, Eigen::ThreadPoolDevice>::value ||
+      ctx->input_memory_type(indices_input) == HOST_MEMORY;
+  for (int input : inputs) {
+    if (ctx->input_dtype(input) != DT_RESOURCE) continue;
+    core::RefCountPtr<Var> var;
+    if (!LookupResource(ctx, HandleFromInput(ctx, input), &var).ok()) continue;
+    if (!var->is_tracking_dirty_rows()) continue;
+    if (indices_on_host) {
+      var->MarkRowsDirty(absl::Span<const Tindex>(indices.flat<Tindex>().data(),
+                                                  indices.NumElements()));
+    } else {
+      var->MarkAllRowsDirty();
+    }
+  }
+}
+
 }  // end namespace tensorflow
 
 #endif  // TENSORFLOW_CORE_KERNELS_TRAINING_OP_HELPERS_H_
@@ -1196,6 +1196,7 @@ class SparseApplyAdadeltaOp : public OpKernel {
     const bool sparse = true;
     auto locks = MaybeLockVariableInputMutexesInOrder<Device, T>(
         ctx, use_exclusive_lock_, sparse, {0, 1, 2});
+    MarkSparseUpdatedRows<Device, Tindex>(ctx, {0, 1, 2}, 7);
     DoCompute(ctx);
   }
 
@@ -1435,6 +1436,7 @@ class SparseApplyProximalGradientDescentOp : public OpKernel {
     const bool sparse = true;
     auto locks = MaybeLockVariableInputMutexesInOrder<CPUDevice, T>(
         ctx, use_exclusive_lock_, sparse, {0});
+    MarkSparseUpdatedRows<CPUDevice, Tindex>(ctx, {0}, 5);
     Tensor var;
     OP_REQUIRES_OK(ctx, GetInputTensorFromVariable<CPUDevice, T>(
                             ctx, 0, use_exclusive_lock_, sparse, &var));
@@ -1890,6 +1892,7 @@ class SparseApplyAdagradOp : public OpKernel {
     const bool sparse = true;
     auto locks = MaybeLockVariableInputMutexesInOrder<Device, T>(
         ctx, use_exclusive_lock_, sparse, {0, 1});
+    MarkSparseUpdatedRows<Device, Tindex>(ctx, {0, 1}, 4);
     Tensor var;
     OP_REQUIRES_OK(ctx, GetInputTensorFromVariable<Device, T>(
                             ctx, 0, use_exclusive_lock_, sparse, &var));
@@ -2020,6 +2023,7 @@ class SparseApplyAdagradV2Op : public OpKernel {
     const bool sparse = true;
     auto locks = MaybeLockVariableInputMutexesInOrder<Device, T>(
         ctx, use_exclusive_lock_, sparse, {0, 1});
+    MarkSparseUpdatedRows<Device, Tindex>(ctx, {0, 1}, 5);
     Tensor var;
     OP_REQUIRES_OK(ctx, GetInputTensorFromVariable<Device, T>(
                             ctx, 0, use_exclusive_lock_, sparse, &var));
@@ -2153,6 +2157,7 @@ class SparseApplyProximalAdagradOp : public OpKernel {
     const bool sparse = true;
     auto locks = MaybeLockVariableInputMutexesInOrder<Device, T>(
         ctx, use_exclusive_lock_, sparse, {0, 1});
+    MarkSparseUpdatedRows<Device, Tindex>(ctx, {0, 1}, 6);
     Tensor var;
     OP_REQUIRES_OK(ctx, GetInputTensorFromVariable<Device, T>(
                             ctx, 0, use_exclusive_lock_, sparse, &var));
@@ -2397,6 +2402,7 @@ class SparseApplyAdagradDAOp : public OpKernel {
     const bool sparse = true;
     auto locks = MaybeLockVariableInputMutexesInOrder<CPUDevice, T>(
         ctx, use_exclusive_lock_, sparse, {0, 1, 2});
+    MarkSparseUpdatedRows<CPUDevice, Tindex>(ctx, {0, 1, 2}, 4);
     Tensor var;
     OP_REQUIRES_OK(ctx, GetInputTensorFromVariable<CPUDevice, T>(
                             ctx, 0, use_exclusive_lock_, sparse, &var));
@@ -2808,6 +2814,7 @@ class SparseApplyFtrlOp : public OpKernel {
     const bool sparse = true;
     auto locks = MaybeLockVariableInputMutexesInOrder<Device, T>(
         ctx, use_exclusive_lock_, sparse, {0, 1, 2});
+    MarkSparseUpdatedRows<Device, Tindex>(ctx, {0, 1, 2}, 4);
     Tensor var;
     OP_REQUIRES_OK(ctx, GetInputTensorFromVariable<Device, T>(
                             ctx, 0, use_exclusive_lock_, sparse, &var));
@@ -3174,6 +3181,7 @@ class SparseApplyMomentumOp : public OpKernel {
     const bool sparse = true;
     auto locks = MaybeLockVariableInputMutexesInOrder<CPUDevice, T>(
         ctx, use_exclusive_lock_, sparse, {0, 1});
+    MarkSparseUpdatedRows<CPUDevice, Tindex>(ctx, {0, 1}, 4);
 
     Tensor var;
     OP_REQUIRES_OK(ctx, GetInputTensorFromVariable<CPUDevice, T>(
@@ -3393,6 +3401,7 @@ class SparseApplyKerasMomentumOp : public OpKernel {
     const bool sparse = true;
     auto locks = MaybeLockVariableInputMutexesInOrder<Device, T>(
         ctx, use_exclusive_lock_, sparse, {0, 1});
+    MarkSparseUpdatedRows<Device, Tindex>(ctx, {0, 1}, 4);
 
     Tensor var;
     OP_REQUIRES_OK(ctx, GetInputTensorFromVariable<Device, T>(
@@ -4181,6 +4190,7 @@ class SparseApplyRMSPropOp : public OpKernel {
     const bool sparse = true;
     auto locks = MaybeLockVariableInputMutexesInOrder<CPUDevice, T>(
         ctx, use_exclusive_lock_, sparse, {0, 1, 2});
+    MarkSparseUpdatedRows<CPUDevice, Tindex>(ctx, {0, 1, 2}, 8);
 
     Tensor var;
     OP_REQUIRES_OK(ctx, GetInputTensorFromVariable<CPUDevice, T>(
@@ -4311,6 +4321,7 @@ class SparseApplyCenteredRMSPropOp : public OpKernel {
     const bool sparse = true;
     auto locks = MaybeLockVariableInputMutexesInOrder<CPUDevice, T>(
         ctx, use_exclusive_lock_, sparse, {0, 1, 2, 3});
+    MarkSparseUpdatedRows<CPUDevice, Tindex>(ctx, {0, 1, 2, 3}, 9);
 
     Tensor var;
     OP_REQUIRES_OK(ctx, GetInputTensorFromVariable<CPUDevice, T>(
@@ -16,7 +16,13 @@ limitations under the License.
 #define EIGEN_USE_THREADS
 
 #include <complex>
+#include <cstdint>
+#include <functional>
+#include <memory>
+#include <type_traits>
+#include <utility>
 
+#include "absl/container/inlined_vector.h"
 #include "unsupported/Eigen/CXX11/Tensor"  // from @eigen_archive
 #include "tensorflow/core/framework/attr_value.pb.h"
 #include "tensorflow/core/framework/tensor.h"
@@ -25,6 +31,11 @@ limitations under the License.
 #include "tensorflow/core/lib/core/status.h"
 #include "tensorflow/core/lib/gtl/array_slice.h"
 #include "tensorflow/core/lib/gtl/inlined_vector.h"
+#include "tensorflow/core/platform/mutex.h"
+
+#if !defined(IS_MOBILE_PLATFORM)
+#include "xla/pjrt/transpose.h"
+#endif  // !defined(IS_MOBILE_PLATFORM)
 
 typedef Eigen::ThreadPoolDevice CPUDevice;
 
@@ -68,12 +79,68 @@ void TransposeSimple(const CPUDevice& device, const Tensor& in,
   device.parallelFor(in.NumElements(), cost, std::move(transpose_fn));
 }
 
+#if !defined(IS_MOBILE_PLATFORM)
+// Tensors with at least this many elements are transposed with an
+// xla::TransposePlan, whose cache blocking and transpose microkernels beat
+// Eigen's shuffle on high-rank permutations and small minor dimensions. Below
+// it, looking up the plan costs more than it saves.
+constexpr int64_t kTransposePlanMinElements = 16 * 1024;
+constexpr int kTransposePlanCacheCapacity = 64;
+
+// Returns the plan for `options`, built once per (dims, permutation, element
+// size, number of threads) and then shared by all the transposes, or null if
+// no plan can be built.
+std::shared_ptr<xla::TransposePlan> GetTransposePlan(
+    const xla::TransposePlan::Options& options) {
+  static mutex* mu = new mutex;
+  static xla::TransposePlanCache* cache =
+      new xla::TransposePlanCache(kTransposePlanCacheCapacity);
+  mutex_lock l(*mu);
+  auto plan = cache->GetOrCreate(options);
+  if (!plan.ok()) return nullptr;
+  return *std::move(plan);
+}
+
+// Transposes `in` into `out` with a plan run on the intra-op pool of
+// `device`. Returns false, without writing `out`, if the transpose is not a
+// copy of elements the plan supports or is too small to be worth one.
+template <typename T, bool conjugate>
+bool TransposeUsingPlan(const CPUDevice& device, const Tensor& in,
+                        const absl::Span<const int32> perm, Tensor* out) {
+  if (conjugate || !std::is_trivially_copyable<T>::value ||
+      in.NumElements() < kTransposePlanMinElements) {
+    return false;
+  }
+  absl::InlinedVector<int64_t, 8> dims(in.dims());
+  for (int i = 0; i < in.dims(); ++i) {
+    dims[i] = in.dim_size(i);
+  }
+  absl::InlinedVector<int64_t, 8> permutation(perm.begin(), perm.end());
+  xla::TransposePlan::Options options;
+  options.elem_size_in_bytes = sizeof(T);
+  options.dims = dims;
+  options.permutation = permutation;
+  options.num_threads = device.numThreads();
+  std::shared_ptr<xla::TransposePlan> plan = GetTransposePlan(options);
+  if (plan == nullptr) return false;
+  plan->Execute(in.tensor_data().data(),
+                const_cast<char*>(out->tensor_data().data()),
+                [&device](std::function<void()> fn) {
+                  device.getPool()->Schedule(std::move(fn));
+                });
+  return true;
+}
+#endif  // !defined(IS_MOBILE_PLATFORM)
+
 }  // namespace
 
 template <typename T, bool conjugate>
 struct Transpose<CPUDevice, T, conjugate> {
   static void run(const CPUDevice& d, const Tensor& in,
                   const absl::Span<const int32> perm, Tensor* out) {
+#if !defined(IS_MOBILE_PLATFORM)
+    if (TransposeUsingPlan<T, conjugate>(d, in, perm, out)) return;
+#endif  // !defined(IS_MOBILE_PLATFORM)
     switch (in.dims()) {
       case 2:
         internal::TransposeUsingEigen<CPUDevice, T, 2>(d, in, perm, conjugate,
@@ -13,9 +13,15 @@ See the License for the specific language governing permissions and
 limitations under the License.
 ==============================================================================*/
 
+#define EIGEN_USE_THREADS
+
+#include <vector>
+
+#include "unsupported/Eigen/CXX11/Tensor"  // from @eigen_archive
 #include "tensorflow/core/framework/tensor.h"
 #include "tensorflow/core/framework/tensor_testutil.h"
 #include "tensorflow/core/kernels/transpose_functor.h"
+#include "tensorflow/core/lib/core/status_test_util.h"
 #include "tensorflow/core/platform/test.h"
 
 namespace tensorflow {
@@ -35,6 +41,42 @@ class TransposeUtilTest : public ::testing::Test {
     EXPECT_EQ(computed_perm, expected_perm);
     EXPECT_EQ(computed_dims, expected_dims);
   }
+
+  // Checks DoTranspose on the CPU against a transpose computed one element
+  // at a time.
+  template <typename T>
+  void TestCpuTranspose(const TensorShape& shape,
+                        const std::vector<int32>& perm) {
+    Tensor in(DataTypeToEnum<T>::value, shape);
+    test::FillIota<T>(&in, T(0));
+    TensorShape out_shape;
+    for (const int32 d : perm) {
+      out_shape.AddDim(shape.dim_size(d));
+    }
+    Tensor out(DataTypeToEnum<T>::value, out_shape);
+    Eigen::ThreadPool pool(4);
+    Eigen::ThreadPoolDevice device(&pool, 4);
+    TF_ASSERT_OK(DoTranspose(device, in, perm, &out));
+
+    Tensor expected(DataTypeToEnum<T>::value, out_shape);
+    const auto in_flat = in.flat<T>();
+    auto expected_flat = expected.flat<T>();
+    const int ndims = shape.dims();
+    std::vector<int64_t> in_index(ndims);
+    for (int64_t o = 0; o < out_shape.num_elements(); ++o) {
+      int64_t t = o;
+      for (int d = ndims - 1; d >= 0; --d) {
+        in_index[perm[d]] = t % out_shape.dim_size(d);
+        t /= out_shape.dim_size(d);
+      }
+      int64_t i = 0;
+      for (int d = 0; d < ndims; ++d) {
+        i = i * shape.dim_size(d) + in_index[d];
+      }
+      expected_flat(o) = in_flat(i);
+    }
+    test::ExpectTensorEqual<T>(expected, out);
+  }
 };
 
 TEST_F(TransposeUtilTest, NormalDimensionReduction) {
@@ -130,4 +172,16 @@ TEST_F(TransposeUtilTest, NonSingletonDimensionAlignment) {
                                                      {0, 1, 2, 5, 4, 3}));
 }
 
+TEST_F(TransposeUtilTest, CpuTranspose) {
+  // Small enough for Eigen.
+  TestCpuTranspose<float>({4, 8, 16}, {2, 0, 1});
+  // Large enough for a transpose plan: attention heads, NCHW to NHWC and a
+  // high-rank permutation with small minor dimensions.
+  TestCpuTranspose<float>({8, 128, 12, 64}, {0, 2, 1, 3});
+  TestCpuTranspose<float>({16, 3, 64, 64}, {0, 2, 3, 1});
+  TestCpuTranspose<float>({32, 2, 3, 4, 5, 6, 7}, {6, 0, 5, 1, 4, 2, 3});
+  TestCpuTranspose<int8>({16, 3, 64, 64}, {0, 2, 3, 1});
+  TestCpuTranspose<double>({256, 384}, {1, 0});
+}
+
 }  // namespace tensorflow
@@ -270,6 +270,38 @@ Status CombinedNMSShapeFn(InferenceContext* c) {
   return absl::OkStatus();
 }
 
+Status CropAndResizeShapeFn(InferenceContext* c) {
+  // Get inputs and validate ranks.
+  ShapeHandle input;
+  TF_RETURN_IF_ERROR(c->WithRank(c->input(0), 4, &input));
+  ShapeHandle boxes;
+  TF_RETURN_IF_ERROR(c->WithRank(c->input(1), 2, &boxes));
+  ShapeHandle box_ind;
+  TF_RETURN_IF_ERROR(c->WithRank(c->input(2), 1, &box_ind));
+
+  // boxes[0] and box_ind[0] are both num_boxes.
+  DimensionHandle num_boxes_dim;
+  TF_RETURN_IF_ERROR(
+      c->Merge(c->Dim(boxes, 0), c->Dim(box_ind, 0), &num_boxes_dim));
+
+  // boxes.dim(1) is 4.
+  DimensionHandle unused;
+  TF_RETURN_IF_ERROR(c->WithValue(c->Dim(boxes, 1), 4, &unused));
+
+  return SetOutputToSizedImage(c, num_boxes_dim, 3 /* size_input_idx */,
+                               c->Dim(input, 3));
+}
+
+// Checks the ranks of the offset and scale of a fused normalization, at
+// inputs `offset_idx` and `offset_idx + 1`, which broadcast to the images.
+Status NormalizeArgsShapeFn(InferenceContext* c, int offset_idx) {
+  for (int i = offset_idx; i < offset_idx + 2; ++i) {
+    ShapeHandle arg;
+    TF_RETURN_IF_ERROR(c->WithRankAtMost(c->input(i), 4, &arg));
+  }
+  return absl::OkStatus();
+}
+
 }  // namespace
 
 // --------------------------------------------------------------------------
@@ -526,6 +558,47 @@ REGISTER_OP("DecodeAndCropJpeg")
       return absl::OkStatus();
     });
 
+// --------------------------------------------------------------------------
+REGISTER_OP("DecodeAndResizeJpeg")
+    .Input("contents: string")
+    .Input("size: int32")
+    .Attr("channels: int = 0")
+    .Attr("method: {'bilinear', 'area'} = 'bilinear'")
+    .Attr("fancy_upscaling: bool = true")
+    .Attr("try_recover_truncated: bool = false")
+    .Attr("acceptable_fraction: float = 1.0")
+    .Attr("dct_method: string = ''")
+    .Output("image: float")
+    .SetShapeFn([](InferenceContext* c) {
+      ShapeHandle unused;
+      TF_RETURN_IF_ERROR(c->WithRank(c->input(0), 0, &unused));
+      DimensionHandle channels_dim = c->UnknownDim();
+      int32_t channels;
+      TF_RETURN_IF_ERROR(c->GetAttr("channels", &channels));
+      if (channels != 0) {
+        if (channels < 0) {
+          return errors::InvalidArgument("channels must be non-negative, got ",
+                                         channels);
+        }
+        channels_dim = c->MakeDim(channels);
+      }
+
+      ShapeHandle size;
+      DimensionHandle unused_dim;
+      TF_RETURN_IF_ERROR(c->WithRank(c->input(1), 1, &size));
+      TF_RETURN_IF_ERROR(c->WithValue(c->Dim(size, 0), 2, &unused_dim));
+      DimensionHandle h = c->UnknownDim();
+      DimensionHandle w = c->UnknownDim();
+      const Tensor* size_tensor = c->input_tensor(1);
+      if (size_tensor != nullptr) {
+        auto size_vec = size_tensor->vec<int32>();
+        h = c->MakeDim(size_vec(0));
+        w = c->MakeDim(size_vec(1));
+      }
+      c->set_output(0, c->MakeShape({h, w, channels_dim}));
+      return absl::OkStatus();
+    });
+
 // --------------------------------------------------------------------------
 REGISTER_OP("EncodeJpeg")
     .Input("image: uint8")
@@ -900,27 +973,64 @@ REGISTER_OP("CropAndResize")
     .Attr("T: {uint8, uint16, int8, int16, int32, int64, half, float, double}")
     .Attr("method: {'bilinear', 'nearest'} = 'bilinear'")
     .Attr("extrapolation_value: float = 0")
+    .SetShapeFn(CropAndResizeShapeFn);
+
+// --------------------------------------------------------------------------
+
+REGISTER_OP("_FusedResizeBilinearAndNormalize")
+    .Input("images: T")
+    .Input("size: int32")
+    .Input("offset: float")
+    .Input("scale: float")
+    .Output("output: out_type")
+    .Attr("T: {uint8, float}")
+    .Attr("out_type: {float, bfloat16} = DT_FLOAT")
+    .Attr("align_corners: bool = false")
+    .Attr("half_pixel_centers: bool = false")
+    .Attr("scale_is_divisor: bool = true")
     .SetShapeFn([](InferenceContext* c) {
-      // Get inputs and validate ranks.
-      ShapeHandle input;
-      TF_RETURN_IF_ERROR(c->WithRank(c->input(0), 4, &input));
-      ShapeHandle boxes;
-      TF_RETURN_IF_ERROR(c->WithRank(c->input(1), 2, &boxes));
-      ShapeHandle box_ind;
-      TF_RETURN_IF_ERROR(c->WithRank(c->input(2), 1, &box_ind));
+      TF_RETURN_IF_ERROR(NormalizeArgsShapeFn(c, 2));
+      return ResizeShapeFn(c);
+    })
+    .Doc(R"doc(
+Computes (ResizeBilinear(images, size) - offset) / scale in one pass.
 
-      // boxes[0] and box_ind[0] are both num_boxes.
-      DimensionHandle num_boxes_dim;
-      TF_RETURN_IF_ERROR(
-          c->Merge(c->Dim(boxes, 0), c->Dim(box_ind, 0), &num_boxes_dim));
+`offset` and `scale` hold one value, or one value per channel along their last
+dimension. If `scale_is_divisor` is false the offset images are multiplied by
+`scale` instead. The result is rounded to `out_type`.
 
-      // boxes.dim(1) is 4.
-      DimensionHandle unused;
-      TF_RETURN_IF_ERROR(c->WithValue(c->Dim(boxes, 1), 4, &unused));
+*NOTE*: Do not invoke this operator directly in Python. Grappler is expected to
+create these operators.
+)doc");
 
-      return SetOutputToSizedImage(c, num_boxes_dim, 3 /* size_input_idx */,
-                                   c->Dim(input, 3));
-    });
+REGISTER_OP("_FusedCropAndResizeAndNormalize")
+    .Input("image: T")
+    .Input("boxes: float")
+    .Input("box_ind: int32")
+    .Input("crop_size: int32")
+    .Input("offset: float")
+    .Input("scale: float")
+    .Output("output: out_type")
+    .Attr("T: {uint8, float}")
+    .Attr("out_type: {float, bfloat16} = DT_FLOAT")
+    .Attr("extrapolation_value: float = 0")
+    .Attr("scale_is_divisor: bool = true")
+    .SetShapeFn([](InferenceContext* c) {
+      TF_RETURN_IF_ERROR(NormalizeArgsShapeFn(c, 4));
+      return CropAndResizeShapeFn(c);
+    })
+    .Doc(R"doc(
+Computes (CropAndResize(image, boxes, box_ind, crop_size) - offset) / scale in
+one pass, with bilinear sampling.
+
+`offset` and `scale` hold one value, or one value per channel along their last
+dimension. If `scale_is_divisor` is false the offset crops are multiplied by
+`scale` instead. Extrapolated values are normalized too. The result is rounded
+to `out_type`.
+
+*NOTE*: Do not invoke this operator directly in Python. Grappler is expected to
+create these operators.
+)doc");
 
 REGISTER_OP("CropAndResizeGradImage")
     .Input("grads: float")
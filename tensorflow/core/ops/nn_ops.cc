@@ -1301,6 +1301,51 @@ REGISTER_OP("LogSoftmax")
 
 // --------------------------------------------------------------------------
 
+REGISTER_OP("_FusedScaledDotProductAttention")
+    .Input("query: T")
+    .Input("key: T")
+    .Input("value: T")
+    .Input("scale: T")
+    .Input("args: num_args * T")
+    .Output("output: T")
+    .Attr("T: {float}")
+    .Attr("adj_key: bool = false")
+    .Attr("num_args: int >= 0 = 0")
+    .SetShapeFn([](InferenceContext* c) {
+      ShapeHandle query;
+      ShapeHandle value;
+      TF_RETURN_IF_ERROR(c->WithRankAtLeast(c->input(0), 3, &query));
+      TF_RETURN_IF_ERROR(c->WithRank(c->input(2), c->Rank(query), &value));
+      ShapeHandle query_rows;
+      ShapeHandle batch;
+      TF_RETURN_IF_ERROR(c->Subshape(query, 0, -1, &query_rows));
+      TF_RETURN_IF_ERROR(c->Subshape(value, 0, -2, &batch));
+      ShapeHandle unused;
+      TF_RETURN_IF_ERROR(c->MergePrefix(query_rows, batch, &query_rows,
+                                        &unused));
+      ShapeHandle output;
+      TF_RETURN_IF_ERROR(c->Concatenate(
+          query_rows, c->Vector(c->Dim(value, -1)), &output));
+      c->set_output(0, output);
+      return absl::OkStatus();
+    })
+    .Doc(R"doc(
+Computes Softmax(BatchMatMul(query, key) * scale + mask) @ value.
+
+`query` has shape [..., M, K], `key` has shape [..., N, K] if `adj_key` and
+[..., K, N] otherwise, and `value` has shape [..., N, D], with the same batch
+dimensions. `scale` is a scalar. `args` is empty or holds the mask that is added
+to the scaled scores, which must be broadcastable to [..., M, N].
+
+The scores are computed in tiles with an online softmax, so that the [..., M, N]
+matrix of scores is never materialized.
+
+*NOTE*: Do not invoke this operator directly in Python. Grappler is expected to
+create these operators.
+)doc");
+
+// --------------------------------------------------------------------------
+
 REGISTER_OP("SoftmaxCrossEntropyWithLogits")
     .Input("features: T")
     .Input("labels: T")
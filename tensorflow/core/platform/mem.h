@@ -29,6 +29,9 @@ using ::tsl::port::AvailableRam;
 using ::tsl::port::Free;
 using ::tsl::port::GetMemoryBandwidthInfo;
 using ::tsl::port::GetMemoryInfo;
+using ::tsl::port::HugePageFree;
+using ::tsl::port::HugePageMalloc;
+using ::tsl::port::kHugePageSize;
 using ::tsl::port::Malloc;
 using ::tsl::port::MallocExtension_GetAllocatedSize;
 using ::tsl::port::MallocExtension_ReleaseToSystem;
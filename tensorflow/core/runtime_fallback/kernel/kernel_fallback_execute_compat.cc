@@ -24,6 +24,7 @@ limitations under the License.
 #include <utility>
 
 #include "absl/base/casts.h"
+#include "absl/time/clock.h"
 #include "llvm/ADT/StringRef.h"
 #include "tensorflow/core/framework/logging.h"
 #include "tensorflow/core/framework/tensor.h"
@@ -46,6 +47,7 @@ limitations under the License.
 #include "tensorflow/core/tfrt/utils/fallback_tensor.h"
 #include "tensorflow/core/tfrt/utils/tensor_util.h"
 #include "tensorflow/core/tfrt/utils/utils.h"
+#include "tensorflow/core/util/env_var.h"
 #include "tsl/platform/errors.h"
 #include "tfrt/host_context/async_dispatch.h"  // from @tf_runtime
 #include "tfrt/host_context/async_value_ref.h"  // from @tf_runtime
@@ -150,6 +152,34 @@ OpKernelRunState& GetThreadLocalOpKernelRunState() {
   return run_state;
 }
 
+// Returns the average cost in nanoseconds above which a synchronous kernel is
+// run on the work queue instead of inline, so that the kernels that do not
+// depend on it can run meanwhile. Returns 0 if kernels are always run inline.
+int64_t GetOffloadCostThreshold() {
+  static const int64_t threshold = []() {
+    int64_t threshold_us;
+    Status status = ReadInt64FromEnvVar("TF_TFRT_OFFLOAD_OP_COST_THRESHOLD_US",
+                                        /*default_val=*/0, &threshold_us);
+    if (!status.ok()) {
+      LOG(ERROR) << "Failed to read TF_TFRT_OFFLOAD_OP_COST_THRESHOLD_US: "
+                 << status;
+      return int64_t{0};
+    }
+    return std::max(threshold_us, int64_t{0}) * 1000;
+  }();
+  return threshold;
+}
+
+// Returns true for one in every `kCostSamplingPeriod` kernel executions on the
+// current thread. Only the sampled executions are timed, so that measuring
+// cheap kernels does not add to their cost, while the kernels' average costs
+// are still updated as the request mix changes.
+bool ShouldSampleCost() {
+  constexpr uint32_t kCostSamplingPeriod = 16;
+  thread_local uint32_t num_executions = 0;
+  return num_executions++ % kCostSamplingPeriod == 0;
+}
+
 }  // namespace
 
 // Execute a tensorflow::OpKernel Asynchronously. `kernel_runner` and
@@ -254,6 +284,71 @@ static void KernelFallbackExecuteCompatSyncInternal(
   if (op_chain) *op_chain = tfrt::MakeAvailableAsyncValueRef<tfrt::Chain>();
 }
 
+// Execute a synchronous tensorflow::OpKernel on the work queue of `exec_ctx`.
+// Like KernelFallbackExecuteCompatAsyncInternal, set unavailable result
+// AsyncValues in `results` that become available when the kernel finishes.
+template <typename TensorType>
+static void KernelFallbackExecuteCompatOffloadedInternal(
+    const tfrt::ExecutionContext& exec_ctx, OpKernelRunState* run_state,
+    const OpKernelRunner& kernel_runner,
+    tfrt::AsyncValueRef<tfrt::Chain>* op_chain,
+    llvm::MutableArrayRef<tfrt::RCReference<tfrt::AsyncValue>> results) {
+  struct OffloadedState {
+    explicit OffloadedState(const OpKernelRunState& rs)
+        : run_state(rs.input_tf_tensor_values, rs.params) {}
+
+    // Owns copies of the inputs, which may be released before the kernel
+    // runs.
+    OpKernelRunState run_state;
+
+    tfrt::AsyncValueRef<tfrt::Chain> chain;
+    llvm::SmallVector<tfrt::AsyncValueRef<TensorType>, 4> result_refs;
+  };
+
+  DCHECK_EQ(results.size(), kernel_runner.op_kernel()->num_outputs());
+  auto state = std::make_unique<OffloadedState>(*run_state);
+
+  state->chain = tfrt::MakeUnconstructedAsyncValueRef<tfrt::Chain>();
+  if (op_chain) *op_chain = state->chain.CopyRef();
+
+  // Allocate unconstructed result tensors and set them in the output `results`.
+  state->result_refs.reserve(results.size());
+  for (auto& result : results) {
+    state->result_refs.emplace_back(
+        tfrt::MakeUnconstructedAsyncValueRef<TensorType>());
+    result = state->result_refs.back().CopyRef();
+  }
+
+  tfrt::EnqueueWork(exec_ctx, [state = std::move(state), &kernel_runner,
+                               exec_ctx]() {
+    OpKernelContext context(&state->run_state.params,
+                            state->result_refs.size());
+    const bool sample_cost = ShouldSampleCost();
+    const int64_t start_time = sample_cost ? absl::GetCurrentTimeNanos() : 0;
+    kernel_runner.Run(&context);
+    if (sample_cost) {
+      kernel_runner.RecordCost(absl::GetCurrentTimeNanos() - start_time);
+    }
+
+    if (!context.status().ok()) {
+      auto diag = tfrt::EmitError(
+          exec_ctx,
+          absl::Status(context.status().code(),
+                       tfrt::StrCat("error running kernel fallback kernel ",
+                                    context.op_kernel().name(), ": ",
+                                    context.status().message())));
+      for (auto& result : state->result_refs) result.SetError(diag.status);
+      state->chain.SetError(diag.status);
+      return;
+    }
+
+    for (int i = 0; i < context.num_outputs(); ++i) {
+      state->result_refs[i].emplace(std::move(*context.mutable_output(i)));
+    }
+    state->chain.emplace();
+  });
+}
+
 tfrt::AsyncValueRef<tfrt::Chain> KernelFallbackExecuteCompatCoreRuntimeDispatch(
     const tfrt::ExecutionContext& exec_ctx, tfrt::string_view op_name,
     tfrt::string_view device_name, llvm::ArrayRef<tfrt::Tensor*> arguments,
@@ -464,11 +559,30 @@ TF_ATTRIBUTE_ALWAYS_INLINE static void KernelFallbackExecuteOpInternal(
     KernelFallbackExecuteCompatAsyncInternal<
         tensorflow::tfrt_stub::FallbackTensor>(
         exec_ctx, &run_state, kernel_runner, op_chain, results);
-  } else {
-    KernelFallbackExecuteCompatSyncInternal<
+    return;
+  }
+
+  // Synchronous kernels whose recent executions were expensive are run on the
+  // work queue, and the others inline. The decision is revisited on every
+  // execution as the sampled costs change.
+  const int64_t offload_cost_threshold = GetOffloadCostThreshold();
+  if (offload_cost_threshold > 0 &&
+      kernel_runner.average_cost() >
+          static_cast<uint64_t>(offload_cost_threshold)) {
+    KernelFallbackExecuteCompatOffloadedInternal<
         tensorflow::tfrt_stub::FallbackTensor>(
-        exec_ctx, &fallback_request_state, &run_state, kernel_runner, op_chain,
-        results);
+        exec_ctx, &run_state, kernel_runner, op_chain, results);
+    return;
+  }
+
+  const bool sample_cost = offload_cost_threshold > 0 && ShouldSampleCost();
+  const int64_t start_time = sample_cost ? absl::GetCurrentTimeNanos() : 0;
+  KernelFallbackExecuteCompatSyncInternal<
+      tensorflow::tfrt_stub::FallbackTensor>(
+      exec_ctx, &fallback_request_state, &run_state, kernel_runner, op_chain,
+      results);
+  if (sample_cost) {
+    kernel_runner.RecordCost(absl::GetCurrentTimeNanos() - start_time);
   }
 }
 
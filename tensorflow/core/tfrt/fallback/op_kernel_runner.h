@@ -18,6 +18,8 @@ limitations under the License.
 #include <assert.h>
 #include <stddef.h>
 
+#include <atomic>
+#include <cstdint>
 #include <functional>
 #include <memory>
 #include <string>
@@ -99,6 +101,24 @@ class OpKernelRunner {
 
   bool IsAsync() const { return info_->is_async; }
 
+  // Records the duration of an execution in nanoseconds. The recorded costs
+  // are kept as a moving average that favors recent executions, so that it
+  // follows changes in the inputs the kernel is run with.
+  void RecordCost(uint64_t cost) const {
+    // Concurrent updates may overwrite each other, which only drops samples.
+    const uint64_t average =
+        info_->average_cost.load(std::memory_order_relaxed);
+    info_->average_cost.store(
+        average == 0 ? cost : average - average / 8 + cost / 8,
+        std::memory_order_relaxed);
+  }
+
+  // Returns the moving average of the recorded costs in nanoseconds, or 0 if
+  // no cost is recorded.
+  uint64_t average_cost() const {
+    return info_->average_cost.load(std::memory_order_relaxed);
+  }
+
   tensorflow::OpKernel* op_kernel() const { return op_kernel_.get(); }
   tensorflow::Device* device() const { return info_->device; }
   tensorflow::FunctionLibraryRuntime* function_library_runtime() const {
@@ -130,6 +150,7 @@ class OpKernelRunner {
     tensorflow::FunctionLibraryRuntime* function_library_runtime = nullptr;
     tensorflow::ResourceMgr* resource_manager = nullptr;
     bool is_async = false;
+    std::atomic<uint64_t> average_cost = 0;
     gtl::InlinedVector<AllocatorAttributes, 4> input_alloc_attrs;
     gtl::InlinedVector<AllocatorAttributes, 1> output_alloc_attrs;
   };
@@ -14,16 +14,46 @@ limitations under the License.
 ==============================================================================*/
 #include "tensorflow/core/tfrt/fallback/op_kernel_runner_cache.h"
 
+#include <algorithm>
 #include <functional>
 #include <memory>
 #include <string>
 #include <utility>
+#include <vector>
 
 #include "absl/base/casts.h"
+#include "absl/container/flat_hash_map.h"
+#include "absl/strings/str_cat.h"
+#include "absl/time/clock.h"
+#include "absl/time/time.h"
+#include "tensorflow/core/platform/blocking_counter.h"
+#include "tensorflow/core/platform/env.h"
+#include "tensorflow/core/platform/errors.h"
 
 namespace tensorflow {
 namespace tfrt_stub {
 
+namespace {
+
+std::string GetNodeName(tfrt::Location loc, absl::string_view op_name) {
+  return absl::StrCat(op_name, "_", loc.data, "_",
+                      absl::bit_cast<uintptr_t>(loc.GetHandler()));
+}
+
+uint64_t ToCost(absl::Duration duration) {
+  return static_cast<uint64_t>(absl::ToInt64Nanoseconds(duration));
+}
+
+// Orders ops by how often they are used, and then by how long their runners
+// take to create.
+bool IsHotter(const OpKernelRunnerCacheProfileProto::Entry& a,
+              const OpKernelRunnerCacheProfileProto::Entry& b) {
+  return std::make_pair(a.num_uses(), a.creation_cost()) >
+         std::make_pair(b.num_uses(), b.creation_cost());
+}
+
+}  // namespace
+
 StatusOr<OpKernelRunner*> OpKernelRunnerCache::GetOrCreate(
     tfrt::Location loc, absl::string_view op_name,
     absl::string_view device_name, int num_args,
@@ -36,8 +66,9 @@ StatusOr<OpKernelRunner*> OpKernelRunnerCache::GetOrCreate(
     tf_shared_lock lock(mu_);
     auto it = map_.find(key);
     if (it != map_.end()) {
-      DCHECK_EQ(it->second->op_kernel()->def().op(), op_name);
-      return it->second.get();
+      DCHECK_EQ(it->second->runner.op_kernel()->def().op(), op_name);
+      it->second->num_uses.fetch_add(1, std::memory_order_relaxed);
+      return &it->second->runner;
     }
   }
 
@@ -45,29 +76,122 @@ StatusOr<OpKernelRunner*> OpKernelRunnerCache::GetOrCreate(
 
   auto it = map_.find(key);
   if (it != map_.end()) {
-    DCHECK_EQ(it->second->op_kernel()->def().op(), op_name);
-    return it->second.get();
+    DCHECK_EQ(it->second->runner.op_kernel()->def().op(), op_name);
+    it->second->num_uses.fetch_add(1, std::memory_order_relaxed);
+    return &it->second->runner;
   }
 
   VLOG(1) << "KernelFallbackExecuteCompat creating op " << op_name
           << " at location " << loc.data << " on device " << device_name;
 
-  std::string node_name = absl::StrCat(
-      op_name, "_", loc.data, "_", absl::bit_cast<uintptr_t>(loc.GetHandler()));
-
+  const absl::Time start_time = absl::Now();
   TF_ASSIGN_OR_RETURN(
-      auto runner, OpKernelRunner::Create(
-                       op_name, node_name, device_name, num_args, attr_builder,
-                       device_manager, process_function_library_runtime));
+      auto runner,
+      OpKernelRunner::Create(op_name, GetNodeName(loc, op_name), device_name,
+                             num_args, attr_builder, device_manager,
+                             process_function_library_runtime));
 
-  auto runner_uptr = std::make_unique<OpKernelRunner>(std::move(runner));
+  auto entry = std::make_unique<Entry>(std::move(runner),
+                                       ToCost(absl::Now() - start_time));
+  entry->num_uses = 1;
 
-  auto* runner_ptr = runner_uptr.get();
-  auto r = map_.emplace(key, std::move(runner_uptr)).second;
+  auto* runner_ptr = &entry->runner;
+  auto r = map_.emplace(key, std::move(entry)).second;
   DCHECK(r);
 
   return runner_ptr;
 }
 
+Status OpKernelRunnerCache::Prepopulate(
+    absl::Span<const CreationRequest> requests,
+    const OpKernelRunnerCacheProfileProto& profile,
+    const tensorflow::DeviceMgr& device_manager,
+    const tensorflow::ProcessFunctionLibraryRuntime&
+        process_function_library_runtime,
+    thread::ThreadPool* thread_pool) {
+  // Rank the profiled ops by hotness, where the hottest op is 0.
+  std::vector<const OpKernelRunnerCacheProfileProto::Entry*> profiled;
+  profiled.reserve(profile.entries_size());
+  for (const auto& entry : profile.entries()) profiled.push_back(&entry);
+  std::stable_sort(profiled.begin(), profiled.end(),
+                   [](const auto* a, const auto* b) {
+                     return IsHotter(*a, *b);
+                   });
+  absl::flat_hash_map<std::pair<int64_t, std::string>, int> ranks;
+  for (int i = 0; i < profiled.size(); ++i) {
+    ranks.try_emplace(
+        std::make_pair(profiled[i]->location(), profiled[i]->op_name()), i);
+  }
+
+  std::vector<std::pair<int, const CreationRequest*>> selected;
+  for (const CreationRequest& request : requests) {
+    auto it = ranks.find(std::make_pair(request.loc.data, request.op_name));
+    if (it != ranks.end()) selected.push_back({it->second, &request});
+  }
+  std::sort(selected.begin(), selected.end(),
+            [](const auto& a, const auto& b) { return a.first < b.first; });
+  VLOG(1) << "OpKernelRunnerCache creating " << selected.size() << " of "
+          << requests.size() << " ops ahead of their first execution.";
+
+  mutex status_mu;
+  Status status;
+  BlockingCounter counter(selected.size());
+  for (const auto& selection : selected) {
+    auto create = [&, request = selection.second]() {
+      const absl::Time start_time = absl::Now();
+      auto runner = OpKernelRunner::Create(
+          request->op_name, GetNodeName(request->loc, request->op_name),
+          request->device_name, request->num_args, request->attr_builder,
+          device_manager, process_function_library_runtime);
+      if (runner.ok()) {
+        auto entry = std::make_unique<Entry>(*std::move(runner),
+                                             ToCost(absl::Now() - start_time));
+        mutex_lock lock(mu_);
+        // An execution may have created the runner in the meantime.
+        map_.try_emplace(OpLocationKey(request->loc), std::move(entry));
+      } else {
+        mutex_lock lock(status_mu);
+        status.Update(runner.status());
+      }
+      counter.DecrementCount();
+    };
+    if (thread_pool != nullptr) {
+      thread_pool->Schedule(std::move(create));
+    } else {
+      create();
+    }
+  }
+  counter.Wait();
+  return status;
+}
+
+OpKernelRunnerCacheProfileProto OpKernelRunnerCache::GetProfile() const {
+  OpKernelRunnerCacheProfileProto profile;
+  {
+    tf_shared_lock lock(mu_);
+    for (const auto& [key, entry] : map_) {
+      auto* profile_entry = profile.add_entries();
+      profile_entry->set_location(key.loc().data);
+      profile_entry->set_op_name(entry->runner.op_kernel()->def().op());
+      profile_entry->set_num_uses(
+          entry->num_uses.load(std::memory_order_relaxed));
+      profile_entry->set_creation_cost(entry->creation_cost);
+    }
+  }
+  std::sort(profile.mutable_entries()->begin(),
+            profile.mutable_entries()->end(), IsHotter);
+  return profile;
+}
+
+Status OpKernelRunnerCache::WriteProfileToFile(
+    const std::string& path, const OpKernelRunnerCacheProfileProto& profile) {
+  return WriteBinaryProto(Env::Default(), path, profile);
+}
+
+Status OpKernelRunnerCache::ReadProfileFromFile(
+    const std::string& path, OpKernelRunnerCacheProfileProto* profile) {
+  return ReadBinaryProto(Env::Default(), path, profile);
+}
+
 }  // namespace tfrt_stub
 }  // namespace tensorflow
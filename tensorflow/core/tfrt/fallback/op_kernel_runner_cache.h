@@ -15,10 +15,16 @@ limitations under the License.
 #ifndef TENSORFLOW_CORE_TFRT_FALLBACK_OP_KERNEL_RUNNER_CACHE_H_
 #define TENSORFLOW_CORE_TFRT_FALLBACK_OP_KERNEL_RUNNER_CACHE_H_
 
+#include <atomic>
+#include <cstdint>
 #include <functional>
 #include <memory>
+#include <string>
 
 #include "absl/strings/string_view.h"
+#include "absl/types/span.h"
+#include "tensorflow/core/platform/threadpool.h"
+#include "tensorflow/core/tfrt/fallback/op_cost_map.pb.h"
 #include "tensorflow/core/tfrt/fallback/op_kernel_runner.h"
 #include "tfrt/host_context/location.h"  // from @tf_runtime
 
@@ -29,6 +35,8 @@ class OpLocationKey {
  public:
   explicit OpLocationKey(tfrt::Location loc) : loc_(loc) {}
 
+  tfrt::Location loc() const { return loc_; }
+
   template <typename H>
   friend H AbslHashValue(H h, const OpLocationKey& key) {
     // NOTE: Each BEF file has its own LocationHandler. Using LocationHandler
@@ -47,8 +55,22 @@ class OpLocationKey {
 };
 
 // OpKernelRunnerCache is similar to OpKernelRunnerTable but thread-safe.
+//
+// The cache records how often each runner is used and how long it took to
+// create. `GetProfile()` exports these records so that they can be persisted,
+// and `Prepopulate()` uses them on a later load to create the runners that
+// were actually executed before their first execution.
 class OpKernelRunnerCache {
  public:
+  // The arguments to create the runner of the op at `loc`.
+  struct CreationRequest {
+    tfrt::Location loc;
+    std::string op_name;
+    std::string device_name;
+    int num_args = 0;
+    std::function<Status(tensorflow::AttrValueMap*)> attr_builder;
+  };
+
   OpKernelRunnerCache() = default;
 
   StatusOr<OpKernelRunner*> GetOrCreate(
@@ -59,9 +81,37 @@ class OpKernelRunnerCache {
       const tensorflow::ProcessFunctionLibraryRuntime&
           process_function_library_runtime);
 
+  // Creates the runners of the `requests` that are in `profile`, from the
+  // hottest one, in parallel on `thread_pool` if it is not null. The runners
+  // of the other requests are still created on their first execution. Returns
+  // the first error; the runners created successfully are cached regardless.
+  Status Prepopulate(absl::Span<const CreationRequest> requests,
+                     const OpKernelRunnerCacheProfileProto& profile,
+                     const tensorflow::DeviceMgr& device_manager,
+                     const tensorflow::ProcessFunctionLibraryRuntime&
+                         process_function_library_runtime,
+                     thread::ThreadPool* thread_pool = nullptr);
+
+  // Returns the cached runners from the hottest one.
+  OpKernelRunnerCacheProfileProto GetProfile() const;
+
+  static Status WriteProfileToFile(
+      const std::string& path, const OpKernelRunnerCacheProfileProto& profile);
+  static Status ReadProfileFromFile(const std::string& path,
+                                    OpKernelRunnerCacheProfileProto* profile);
+
  private:
+  struct Entry {
+    Entry(OpKernelRunner runner, uint64_t creation_cost)
+        : runner(std::move(runner)), creation_cost(creation_cost) {}
+
+    OpKernelRunner runner;
+    const uint64_t creation_cost;
+    std::atomic<uint64_t> num_uses = 0;
+  };
+
   mutable mutex mu_;
-  absl::flat_hash_map<OpLocationKey, std::unique_ptr<OpKernelRunner>> map_
+  absl::flat_hash_map<OpLocationKey, std::unique_ptr<Entry>> map_
       TF_GUARDED_BY(mu_);
 };
 
@@ -18,6 +18,7 @@ limitations under the License.
 #include <string>
 #include <vector>
 
+#include "absl/strings/str_cat.h"
 #include "tensorflow/core/framework/device_base.h"
 #include "tensorflow/core/framework/device_factory.h"
 #include "tensorflow/core/framework/op_kernel.h"
@@ -25,9 +26,12 @@ limitations under the License.
 #include "tensorflow/core/framework/tensor_shape.h"
 #include "tensorflow/core/framework/types.pb.h"
 #include "tensorflow/core/lib/core/status_test_util.h"
+#include "tensorflow/core/platform/env.h"
 #include "tensorflow/core/platform/test.h"
+#include "tensorflow/core/platform/threadpool.h"
 #include "tensorflow/core/public/session_options.h"
 #include "tensorflow/core/tfrt/fallback/fallback_state.h"
+#include "tensorflow/core/tfrt/fallback/op_cost_map.pb.h"
 #include "tensorflow/core/tfrt/fallback/op_kernel_runner_cache.h"
 
 namespace tensorflow {
@@ -83,6 +87,37 @@ TEST(OpKernelRunnerTest, Create) {
   EXPECT_EQ(runner.op_kernel()->name(), "TestOp_node_name");
 }
 
+TEST(OpKernelRunnerTest, RecordCost) {
+  tensorflow::SessionOptions session_options;
+  tensorflow::FunctionDefLibrary fdef_lib;
+  TF_ASSERT_OK_AND_ASSIGN(auto fallback_state,
+                          FallbackState::Create(session_options, fdef_lib));
+
+  TF_ASSERT_OK_AND_ASSIGN(
+      auto runner,
+      OpKernelRunner::Create(
+          /*op_name=*/
+          "TestOp", /*node_name=*/"TestOp_node_name",
+          /*device_name=*/"/job:localhost/replica:0/task:0/device:CPU:0",
+          /*num_args=*/1,
+          /*attr_builder=*/
+          [](tensorflow::AttrValueMap*) { return absl::OkStatus(); },
+          fallback_state->device_manager(),
+          fallback_state->process_function_library_runtime()));
+
+  EXPECT_EQ(runner.average_cost(), 0);
+
+  // The first cost is used as is, and later costs are averaged in.
+  runner.RecordCost(800);
+  EXPECT_EQ(runner.average_cost(), 800);
+  runner.RecordCost(1600);
+  EXPECT_EQ(runner.average_cost(), 900);
+
+  // The average follows the costs when they change.
+  for (int i = 0; i < 100; ++i) runner.RecordCost(80);
+  EXPECT_LT(runner.average_cost(), 100);
+}
+
 TEST(OpKernelRunnerTest, OpKernelRunnerCache) {
   tensorflow::SessionOptions session_options;
   tensorflow::FunctionDefLibrary fdef_lib;
@@ -126,6 +161,71 @@ TEST(OpKernelRunnerTest, OpKernelRunnerCache) {
   EXPECT_EQ(runner->op_kernel()->name(), "TestOp_100_0");
 }
 
+TEST(OpKernelRunnerTest, OpKernelRunnerCachePrepopulate) {
+  tensorflow::SessionOptions session_options;
+  tensorflow::FunctionDefLibrary fdef_lib;
+  TF_ASSERT_OK_AND_ASSIGN(auto fallback_state,
+                          FallbackState::Create(session_options, fdef_lib));
+  constexpr char kDeviceName[] = "/job:localhost/replica:0/task:0/device:CPU:0";
+  auto attr_builder = [](tensorflow::AttrValueMap*) {
+    return absl::OkStatus();
+  };
+
+  // Execute the op at location 200 twice and the one at location 100 once.
+  OpKernelRunnerCache cache;
+  for (int data : {200, 100, 200}) {
+    TF_ASSERT_OK(
+        cache
+            .GetOrCreate(tfrt::Location(/*handler=*/nullptr, data),
+                         /*op_name=*/"TestOp", kDeviceName, /*num_args=*/1,
+                         attr_builder, fallback_state->device_manager(),
+                         fallback_state->process_function_library_runtime())
+            .status());
+  }
+  OpKernelRunnerCacheProfileProto profile = cache.GetProfile();
+  ASSERT_THAT(profile.entries(), SizeIs(2));
+  EXPECT_EQ(profile.entries(0).location(), 200);
+  EXPECT_EQ(profile.entries(0).num_uses(), 2);
+  EXPECT_EQ(profile.entries(1).location(), 100);
+  EXPECT_EQ(profile.entries(1).num_uses(), 1);
+
+  const std::string path =
+      absl::StrCat(testing::TmpDir(), "/op_kernel_runner_cache_profile");
+  TF_ASSERT_OK(OpKernelRunnerCache::WriteProfileToFile(path, profile));
+  OpKernelRunnerCacheProfileProto read_profile;
+  TF_ASSERT_OK(OpKernelRunnerCache::ReadProfileFromFile(path, &read_profile));
+  EXPECT_THAT(read_profile.entries(), SizeIs(2));
+
+  // Only the ops in the profile are created ahead of their first execution.
+  std::vector<OpKernelRunnerCache::CreationRequest> requests;
+  for (int data : {100, 200, 300}) {
+    requests.push_back({tfrt::Location(/*handler=*/nullptr, data), "TestOp",
+                        kDeviceName, /*num_args=*/1, attr_builder});
+  }
+  thread::ThreadPool thread_pool(Env::Default(), "prepopulate", 2);
+  OpKernelRunnerCache prepopulated_cache;
+  TF_ASSERT_OK(prepopulated_cache.Prepopulate(
+      requests, read_profile, fallback_state->device_manager(),
+      fallback_state->process_function_library_runtime(), &thread_pool));
+  profile = prepopulated_cache.GetProfile();
+  ASSERT_THAT(profile.entries(), SizeIs(2));
+  EXPECT_EQ(profile.entries(0).num_uses(), 0);
+  EXPECT_EQ(profile.entries(1).num_uses(), 0);
+
+  // The prepopulated runner is used without building its attributes.
+  TF_ASSERT_OK_AND_ASSIGN(
+      auto* runner,
+      prepopulated_cache.GetOrCreate(
+          tfrt::Location(/*handler=*/nullptr, 200), /*op_name=*/"TestOp",
+          kDeviceName, /*num_args=*/1,
+          [](tensorflow::AttrValueMap*) {
+            return absl::InternalError("The runner should be cached.");
+          },
+          fallback_state->device_manager(),
+          fallback_state->process_function_library_runtime()));
+  EXPECT_EQ(runner->op_kernel()->name(), "TestOp_200_0");
+}
+
 TEST(OpKernelRunnerTest, OpKernelRunState) {
   SessionOptions options;
   auto* device_count = options.config.mutable_device_count();
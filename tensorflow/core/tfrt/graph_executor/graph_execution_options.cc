@@ -130,6 +130,10 @@ std::ostream& operator<<(std::ostream& os,
             << ", model_metadata = "
             << options.model_metadata.DebugString()
             // clang-tidy on
+            << ", max_loaded_client_graphs = "
+            << options.max_loaded_client_graphs
+            << ", compile_client_graphs_in_background = "
+            << options.compile_client_graphs_in_background
             << ", compile_options = " << options.compile_options << "}";
 }
 
@@ -104,6 +104,18 @@ struct GraphExecutionOptions {
   // This option is experimental.
   bool enable_mlrt = false;
 
+  // The maximum number of loaded client graphs that are cached. When a new
+  // client graph would exceed it, the least recently used one is evicted and
+  // is compiled again the next time it is requested. If zero, the cache is
+  // unbounded.
+  int max_loaded_client_graphs = 0;
+
+  // If true, a request that misses the client graph cache is served by a
+  // cached client graph with the same inputs and targets whose outputs are a
+  // superset of the requested ones, if there is one, while the requested
+  // client graph is compiled in the background. This option is experimental.
+  bool compile_client_graphs_in_background = false;
+
   tensorflow::TfrtCompileOptions compile_options;
 };
 
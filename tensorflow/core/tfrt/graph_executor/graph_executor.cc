@@ -61,7 +61,9 @@ limitations under the License.
 #include "tensorflow/core/framework/rendezvous.h"
 #include "tensorflow/core/framework/tensor.h"
 #include "tensorflow/core/lib/gtl/cleanup.h"
+#include "tensorflow/core/lib/monitoring/counter.h"
 #include "tensorflow/core/lib/monitoring/gauge.h"
+#include "tensorflow/core/platform/env.h"
 #include "tensorflow/core/platform/errors.h"
 #include "tensorflow/core/platform/mutex.h"
 #include "tensorflow/core/platform/status.h"
@@ -139,6 +141,33 @@ auto* graph_executor_mode = monitoring::Gauge<std::string, 2>::New(
     "executor modes (BEF vs MLRT interpreter)",
     "model_name", "model_version");
 
+auto* client_graph_cache_events = monitoring::Counter<3>::New(
+    "/tfrt/graph_executor/client_graph_cache_events",
+    "Records the hits, misses, evictions and fallbacks of the loaded client "
+    "graph cache of GraphExecutor.",
+    "model_name", "model_version", "event");
+
+auto* client_graph_load_time = tsl::monitoring::Sampler<2>::New(
+    {"/tfrt/graph_executor/client_graph_load_time",
+     "Tracks the time (in milliseconds) to load a client graph.", "model_name",
+     "model_version"},
+    tsl::monitoring::Buckets::Exponential(1, 1.5, 40));
+
+void RecordClientGraphCacheEvent(const SessionMetadata& model_metadata,
+                                 const char* event) {
+  client_graph_cache_events
+      ->GetCell(model_metadata.name(), absl::StrCat(model_metadata.version()),
+                event)
+      ->IncrementBy(1);
+}
+
+void RecordClientGraphLoadTime(const SessionMetadata& model_metadata,
+                               absl::Duration duration) {
+  client_graph_load_time
+      ->GetCell(model_metadata.name(), absl::StrCat(model_metadata.version()))
+      ->Add(absl::ToDoubleMilliseconds(duration));
+}
+
 }  // namespace
 
 tensorflow::Status RunMlrtFunction(
@@ -491,6 +520,13 @@ GraphExecutor::GraphExecutor(
   SetSessionCreatedMetric();
 }
 
+GraphExecutor::~GraphExecutor() {
+  tensorflow::mutex_lock l(loaded_client_graphs_mu_);
+  while (!background_compilations_.empty()) {
+    background_compilations_cv_.wait(l);
+  }
+}
+
 absl::StatusOr<std::unique_ptr<GraphExecutor>> GraphExecutor::Create(
     Options options, std::unique_ptr<FallbackState> fallback_state,
     std::unique_ptr<tfrt::ResourceContext> resource_context,
@@ -590,12 +626,14 @@ tensorflow::Status GraphExecutor::Run(
   std::sort(sorted_target_node_names.begin(), sorted_target_node_names.end());
 
   // Load the client graph.
+  std::vector<int> fallback_output_indices;
   TF_ASSIGN_OR_RETURN(
-      LoadedClientGraph & loaded_client_graph,
+      std::shared_ptr<LoadedClientGraph> loaded_client_graph_ptr,
       GetOrCreateLoadedClientGraph(
           run_options, sorted_input_names, sorted_input_dtypes,
           sorted_output_names, sorted_target_node_names, run_options.work_queue,
-          /*graph_name=*/{}, inputs));
+          /*graph_name=*/{}, inputs, &fallback_output_indices));
+  LoadedClientGraph& loaded_client_graph = *loaded_client_graph_ptr;
 
   // Get a shared_ptr of the executable so that during the current request the
   // executable to use is guaranteed to be alive.
@@ -652,6 +690,16 @@ tensorflow::Status GraphExecutor::Run(
   if (cost_recorder != nullptr) {
     loaded_client_graph.UpdateCostAnalysisData(now, do_recompilation);
   }
+  // A fallback graph computes more outputs than requested; only keep the
+  // requested ones.
+  if (!fallback_output_indices.empty()) {
+    std::vector<tensorflow::Tensor> requested_outputs;
+    requested_outputs.reserve(fallback_output_indices.size());
+    for (int index : fallback_output_indices) {
+      requested_outputs.push_back(flat_outputs[index]);
+    }
+    flat_outputs = std::move(requested_outputs);
+  }
   // Create the outputs from the actual function results, which are sorted
   // according to the output tensor names.
   auto flat_output_iter = flat_outputs.begin();
@@ -916,7 +964,7 @@ tensorflow::Status GraphExecutor::InitBytecode(
   return absl::OkStatus();
 }
 
-absl::StatusOr<std::reference_wrapper<GraphExecutor::LoadedClientGraph>>
+absl::StatusOr<std::shared_ptr<GraphExecutor::LoadedClientGraph>>
 GraphExecutor::GetOrCreateLoadedClientGraph(
     const RunOptions& run_options,
     absl::Span<const std::string> input_tensor_names,
@@ -925,9 +973,14 @@ GraphExecutor::GetOrCreateLoadedClientGraph(
     absl::Span<const std::string> target_tensor_names,
     tensorflow::tfrt_stub::WorkQueueInterface* work_queue,
     absl::string_view graph_name,
-    absl::Span<const std::pair<std::string, tensorflow::Tensor>> inputs) {
+    absl::Span<const std::pair<std::string, tensorflow::Tensor>> inputs,
+    std::vector<int>* fallback_output_indices) {
   // The format of the joined name is illustrated as in the following example:
   // input1-input2^output1-output2^target1-target2
+  std::string input_and_target_names = absl::StrCat(
+      absl::StrJoin(input_tensor_names, kTensorNameJoiningDelimiter),
+      kArgumentTypeJoiningDelimiter,
+      absl::StrJoin(target_tensor_names, kTensorNameJoiningDelimiter));
   const std::string joined_name =
       !graph_name.empty()
           ? std::string(graph_name)
@@ -943,7 +996,12 @@ GraphExecutor::GetOrCreateLoadedClientGraph(
 
   // Cache hit; return immediately.
   const auto iter = loaded_client_graphs_.find(joined_name);
-  if (iter != loaded_client_graphs_.end()) return {*iter->second};
+  if (iter != loaded_client_graphs_.end()) {
+    RecordClientGraphCacheEvent(options_.model_metadata, "hit");
+    lru_client_graphs_.splice(lru_client_graphs_.begin(), lru_client_graphs_,
+                              iter->second.lru_position);
+    return iter->second.loaded_client_graph;
+  }
 
   if (run_options.disable_compilation) {
     return tensorflow::errors::InvalidArgument(
@@ -951,6 +1009,7 @@ GraphExecutor::GetOrCreateLoadedClientGraph(
                      "the compiled graph is not found for ",
                      joined_name));
   }
+  RecordClientGraphCacheEvent(options_.model_metadata, "miss");
 
   // Cache miss; populate a `ClientGraph` and load it.
   tensorflow::GraphImportConfig::InputArrays input_nodes;
@@ -969,13 +1028,129 @@ GraphExecutor::GetOrCreateLoadedClientGraph(
       std::move(input_nodes),
       {output_tensor_names.begin(), output_tensor_names.end()},
       {target_tensor_names.begin(), target_tensor_names.end()}};
+
+  // Serve the request with a graph that computes more outputs, if there is
+  // one, rather than compiling on the request path.
+  if (fallback_output_indices != nullptr &&
+      options_.compile_client_graphs_in_background &&
+      !output_tensor_names.empty()) {
+    auto fallback = FindFallbackClientGraph(
+        input_and_target_names, output_tensor_names, fallback_output_indices);
+    if (fallback != nullptr) {
+      RecordClientGraphCacheEvent(options_.model_metadata, "fallback");
+      if (!background_compilations_.contains(joined_name)) {
+        CompileClientGraphInBackground(
+            joined_name, std::move(input_and_target_names),
+            std::move(client_graph), {inputs.begin(), inputs.end()});
+      }
+      return fallback;
+    }
+  }
+
+  auto load_start_time = absl::Now();
   TF_ASSIGN_OR_RETURN(auto loaded_client_graph,
                       LoadClientGraph(client_graph, work_queue, inputs));
+  RecordClientGraphLoadTime(options_.model_metadata,
+                            absl::Now() - load_start_time);
 
   // Store the new loaded client graph in cache and return.
-  auto* loaded_client_graph_ptr = loaded_client_graph.get();
-  loaded_client_graphs_[joined_name] = std::move(loaded_client_graph);
-  return {*loaded_client_graph_ptr};
+  return InsertLoadedClientGraph(joined_name, std::move(input_and_target_names),
+                                 std::move(client_graph.output_nodes),
+                                 std::move(loaded_client_graph));
+}
+
+std::shared_ptr<GraphExecutor::LoadedClientGraph>
+GraphExecutor::FindFallbackClientGraph(
+    absl::string_view input_and_target_names,
+    absl::Span<const std::string> output_tensor_names,
+    std::vector<int>* output_indices) {
+  const CachedClientGraph* fallback = nullptr;
+  for (const auto& [joined_name, cached] : loaded_client_graphs_) {
+    if (cached.input_and_target_names != input_and_target_names ||
+        cached.output_names.size() <= output_tensor_names.size() ||
+        (fallback != nullptr &&
+         cached.output_names.size() >= fallback->output_names.size()) ||
+        !std::includes(cached.output_names.begin(), cached.output_names.end(),
+                       output_tensor_names.begin(),
+                       output_tensor_names.end())) {
+      continue;
+    }
+    fallback = &cached;
+  }
+  if (fallback == nullptr) return nullptr;
+
+  // Both lists of names are sorted.
+  const std::vector<std::string>& names = fallback->output_names;
+  output_indices->clear();
+  output_indices->reserve(output_tensor_names.size());
+  for (const std::string& name : output_tensor_names) {
+    output_indices->push_back(
+        std::lower_bound(names.begin(), names.end(), name) - names.begin());
+  }
+  lru_client_graphs_.splice(lru_client_graphs_.begin(), lru_client_graphs_,
+                            fallback->lru_position);
+  return fallback->loaded_client_graph;
+}
+
+void GraphExecutor::CompileClientGraphInBackground(
+    std::string joined_name, std::string input_and_target_names,
+    ClientGraph client_graph,
+    std::vector<std::pair<std::string, tensorflow::Tensor>> inputs) {
+  background_compilations_.insert(joined_name);
+  tensorflow::Env::Default()->SchedClosure(
+      [this, joined_name = std::move(joined_name),
+       input_and_target_names = std::move(input_and_target_names),
+       client_graph = std::move(client_graph),
+       inputs = std::move(inputs)]() mutable {
+        auto load_start_time = absl::Now();
+        auto loaded_client_graph =
+            LoadClientGraph(client_graph, /*work_queue=*/nullptr, inputs);
+        const absl::Duration load_duration = absl::Now() - load_start_time;
+
+        tensorflow::mutex_lock l(loaded_client_graphs_mu_);
+        if (loaded_client_graph.ok()) {
+          RecordClientGraphLoadTime(options_.model_metadata, load_duration);
+          InsertLoadedClientGraph(joined_name,
+                                  std::move(input_and_target_names),
+                                  std::move(client_graph.output_nodes),
+                                  *std::move(loaded_client_graph));
+        } else {
+          // Requests keep using the fallback graph, and the compilation is
+          // retried on the next one.
+          LOG(ERROR) << "TFRT failed to load client graph " << joined_name
+                     << " in the background: "
+                     << loaded_client_graph.status();
+        }
+        background_compilations_.erase(joined_name);
+        if (background_compilations_.empty()) {
+          background_compilations_cv_.notify_all();
+        }
+      });
+}
+
+std::shared_ptr<GraphExecutor::LoadedClientGraph>
+GraphExecutor::InsertLoadedClientGraph(
+    const std::string& joined_name, std::string input_and_target_names,
+    std::vector<std::string> output_names,
+    std::shared_ptr<LoadedClientGraph> loaded_client_graph) {
+  auto [iter, inserted] = loaded_client_graphs_.try_emplace(joined_name);
+  if (!inserted) return iter->second.loaded_client_graph;
+
+  lru_client_graphs_.push_front(joined_name);
+  iter->second = {std::move(loaded_client_graph),
+                  std::move(input_and_target_names), std::move(output_names),
+                  lru_client_graphs_.begin()};
+  auto result = iter->second.loaded_client_graph;
+
+  while (options_.max_loaded_client_graphs > 0 &&
+         lru_client_graphs_.size() > options_.max_loaded_client_graphs) {
+    LOG(INFO) << "TFRT evicting client graph " << lru_client_graphs_.back()
+              << " from the cache.";
+    RecordClientGraphCacheEvent(options_.model_metadata, "eviction");
+    loaded_client_graphs_.erase(lru_client_graphs_.back());
+    lru_client_graphs_.pop_back();
+  }
+  return result;
 }
 
 tensorflow::Status GraphExecutor::RunWithSyncInterpreter(
@@ -986,12 +1161,13 @@ tensorflow::Status GraphExecutor::RunWithSyncInterpreter(
     absl::Span<const std::string> target_tensor_names,
     absl::Span<mlrt::Value> outputs) {
   TF_ASSIGN_OR_RETURN(
-      LoadedClientGraph & loaded_client_graph,
+      std::shared_ptr<LoadedClientGraph> loaded_client_graph_ptr,
       GetOrCreateLoadedClientGraph(
           /*run_options=*/{}, input_names, input_dtypes, output_tensor_names,
           target_tensor_names,
           /*work_queue=*/nullptr,
           graph_name.empty() ? output_tensor_names[0] : graph_name));
+  LoadedClientGraph& loaded_client_graph = *loaded_client_graph_ptr;
 
   // Get a shared_ptr of the executable so that during the current request the
   // executable to use is guaranteed to be alive.
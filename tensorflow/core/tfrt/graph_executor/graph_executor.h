@@ -16,6 +16,7 @@ limitations under the License.
 #define TENSORFLOW_CORE_TFRT_GRAPH_EXECUTOR_GRAPH_EXECUTOR_H_
 
 #include <functional>
+#include <list>
 #include <memory>
 #include <optional>
 #include <string>
@@ -23,6 +24,7 @@ limitations under the License.
 #include <vector>
 
 #include "absl/container/flat_hash_map.h"
+#include "absl/container/flat_hash_set.h"
 #include "absl/log/check.h"
 #include "absl/strings/string_view.h"
 #include "absl/time/clock.h"
@@ -266,6 +268,9 @@ class GraphExecutor {
                     graph_execution_state,
                 std::unique_ptr<mlrt::KernelRegistry> kernel_registry);
 
+  // Waits for the client graphs that are being compiled in the background.
+  ~GraphExecutor();
+
   // Runs on the graph according to given input/output.
   tensorflow::Status Run(
       const RunOptions& run_options,
@@ -345,7 +350,17 @@ class GraphExecutor {
 
   // Returns a `LoadedClientGraph` given input/output tensor info. If there is
   // no existing one yet, creates one first.
-  absl::StatusOr<std::reference_wrapper<GraphExecutor::LoadedClientGraph>>
+  //
+  // If `fallback_output_indices` is not null and
+  // `compile_client_graphs_in_background` is enabled, a cache miss may instead
+  // return a cached graph that computes a superset of the requested outputs,
+  // while the requested graph is compiled in the background. In that case
+  // `*fallback_output_indices` is set to the positions of the requested
+  // outputs among the outputs of the returned graph; otherwise it is left
+  // empty.
+  //
+  // The returned graph stays alive even if it is evicted from the cache.
+  absl::StatusOr<std::shared_ptr<GraphExecutor::LoadedClientGraph>>
   GetOrCreateLoadedClientGraph(
       const RunOptions& run_options,
       absl::Span<const std::string> input_tensor_names,
@@ -354,9 +369,37 @@ class GraphExecutor {
       absl::Span<const std::string> target_tensor_names,
       tensorflow::tfrt_stub::WorkQueueInterface* work_queue,
       absl::string_view graph_name = "",
-      absl::Span<const std::pair<std::string, tensorflow::Tensor>> inputs = {})
+      absl::Span<const std::pair<std::string, tensorflow::Tensor>> inputs = {},
+      std::vector<int>* fallback_output_indices = nullptr)
       TF_LOCKS_EXCLUDED(loaded_client_graphs_mu_);
 
+  // Returns the cached graph with the fewest outputs whose inputs and targets
+  // are `input_and_target_names` and whose outputs include all of the sorted
+  // `output_tensor_names`, and sets `*output_indices` to the positions of the
+  // latter among the former. Returns null if there is no such graph.
+  std::shared_ptr<LoadedClientGraph> FindFallbackClientGraph(
+      absl::string_view input_and_target_names,
+      absl::Span<const std::string> output_tensor_names,
+      std::vector<int>* output_indices)
+      TF_EXCLUSIVE_LOCKS_REQUIRED(loaded_client_graphs_mu_);
+
+  // Compiles `client_graph` on another thread and adds it to the cache.
+  void CompileClientGraphInBackground(
+      std::string joined_name, std::string input_and_target_names,
+      ClientGraph client_graph,
+      std::vector<std::pair<std::string, tensorflow::Tensor>> inputs)
+      TF_EXCLUSIVE_LOCKS_REQUIRED(loaded_client_graphs_mu_);
+
+  // Adds `loaded_client_graph` to the cache as the most recently used graph,
+  // evicting the least recently used graphs beyond
+  // `max_loaded_client_graphs`. If a graph is already cached for
+  // `joined_name`, keeps that one instead. Returns the cached graph.
+  std::shared_ptr<LoadedClientGraph> InsertLoadedClientGraph(
+      const std::string& joined_name, std::string input_and_target_names,
+      std::vector<std::string> output_names,
+      std::shared_ptr<LoadedClientGraph> loaded_client_graph)
+      TF_EXCLUSIVE_LOCKS_REQUIRED(loaded_client_graphs_mu_);
+
   Options options_;
   std::unique_ptr<FallbackState> fallback_state_;
 
@@ -365,13 +408,29 @@ class GraphExecutor {
 
   tfrt::RequestDeadlineTracker req_deadline_tracker_;
 
+  struct CachedClientGraph {
+    // Shared with the requests that are running the graph, so that evicting it
+    // does not destroy it under them.
+    std::shared_ptr<LoadedClientGraph> loaded_client_graph;
+    // The joined input and target names, and the sorted output names, used to
+    // find a graph that can serve a request for a subset of its outputs.
+    std::string input_and_target_names;
+    std::vector<std::string> output_names;
+    // The position of the joined name in `lru_client_graphs_`.
+    std::list<std::string>::iterator lru_position;
+  };
+
   tensorflow::mutex loaded_client_graphs_mu_;
+  tensorflow::condition_variable background_compilations_cv_;
   // Caches `LoadedClientGraph` by the joined name.
-  // For pointer stability of values in `absl::flat_hash_map<>`, additional
-  // `std::unique_ptr<>` is necessary. (See https://abseil.io/tips/136.)
-  absl::flat_hash_map<std::string /*joined_name*/,
-                      std::unique_ptr<LoadedClientGraph>>
+  absl::flat_hash_map<std::string /*joined_name*/, CachedClientGraph>
       loaded_client_graphs_ TF_GUARDED_BY(loaded_client_graphs_mu_);
+  // The joined names of the cached graphs, from the most recently used one.
+  std::list<std::string> lru_client_graphs_
+      TF_GUARDED_BY(loaded_client_graphs_mu_);
+  // The joined names of the graphs that are being compiled in the background.
+  absl::flat_hash_set<std::string> background_compilations_
+      TF_GUARDED_BY(loaded_client_graphs_mu_);
 
   std::unique_ptr<mlrt::KernelRegistry> kernel_registry_;
 
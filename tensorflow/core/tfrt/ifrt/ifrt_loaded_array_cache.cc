@@ -0,0 +1,88 @@
+/* Copyright 2024 The TensorFlow Authors. All Rights Reserved.
+
+Licensed under the Apache License, Version 2.0 (the "License");
+you may not use this file except in compliance with the License.
+You may obtain a copy of the License at
+
+    http://www.apache.org/licenses/LICENSE-2.0
+
+Unless required by applicable law or agreed to in writing, software
+distributed under the License is distributed on an "AS IS" BASIS,
+WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+See the License for the specific language governing permissions and
+limitations under the License.
+==============================================================================*/
+
+#include "tensorflow/core/tfrt/ifrt/ifrt_loaded_array_cache.h"
+
+#include <memory>
+#include <utility>
+
+#include "absl/log/log.h"
+#include "absl/status/statusor.h"
+#include "absl/synchronization/mutex.h"
+#include "xla/python/ifrt/array.h"
+#include "tsl/concurrency/ref_count.h"
+#include "tsl/platform/fingerprint.h"
+
+namespace tensorflow {
+namespace ifrt_serving {
+
+IfrtLoadedArrayCache& IfrtLoadedArrayCache::Global() {
+  static auto* const cache = new IfrtLoadedArrayCache();
+  return *cache;
+}
+
+IfrtLoadedArrayCache::Reference IfrtLoadedArrayCache::GetOrLoad(
+    const tsl::Fprint128& key, Loader loader) {
+  auto promise = ArrayFuture::CreatePromise();
+  Reference array;
+  {
+    absl::MutexLock lock(&mutex_);
+    auto& cached_array = arrays_[key];
+    if ((array = cached_array.lock())) {
+      VLOG(1) << "Reusing a loaded array for a variable with identical "
+                 "contents.";
+      return array;
+    }
+    // The array is evicted when the last reference to it is destroyed.
+    array = Reference(new ArrayFuture(promise),
+                      [this, key](const ArrayFuture* future) {
+                        Evict(key);
+                        delete future;
+                      });
+    cached_array = array;
+  }
+  // Load the array without holding the lock, so that arrays with different
+  // keys are loaded concurrently.
+  absl::StatusOr<tsl::RCReference<xla::ifrt::Array>> loaded_array =
+      std::move(loader)();
+  if (!loaded_array.ok()) {
+    // Do not keep the error for the later callers, which load the array again.
+    absl::MutexLock lock(&mutex_);
+    auto it = arrays_.find(key);
+    if (it != arrays_.end() && it->second.lock() == array) {
+      arrays_.erase(it);
+    }
+  }
+  promise.Set(std::move(loaded_array));
+  return array;
+}
+
+void IfrtLoadedArrayCache::Evict(const tsl::Fprint128& key) {
+  absl::MutexLock lock(&mutex_);
+  auto it = arrays_.find(key);
+  // Another array may have been cached for `key` since the last reference to
+  // the evicted one was destroyed.
+  if (it != arrays_.end() && it->second.expired()) {
+    arrays_.erase(it);
+  }
+}
+
+int IfrtLoadedArrayCache::size() const {
+  absl::MutexLock lock(&mutex_);
+  return arrays_.size();
+}
+
+}  // namespace ifrt_serving
+}  // namespace tensorflow
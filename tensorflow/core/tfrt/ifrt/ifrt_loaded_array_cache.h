@@ -0,0 +1,75 @@
+/* Copyright 2024 The TensorFlow Authors. All Rights Reserved.
+
+Licensed under the Apache License, Version 2.0 (the "License");
+you may not use this file except in compliance with the License.
+You may obtain a copy of the License at
+
+    http://www.apache.org/licenses/LICENSE-2.0
+
+Unless required by applicable law or agreed to in writing, software
+distributed under the License is distributed on an "AS IS" BASIS,
+WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+See the License for the specific language governing permissions and
+limitations under the License.
+==============================================================================*/
+
+#ifndef TENSORFLOW_CORE_TFRT_IFRT_IFRT_LOADED_ARRAY_CACHE_H_
+#define TENSORFLOW_CORE_TFRT_IFRT_IFRT_LOADED_ARRAY_CACHE_H_
+
+#include <memory>
+
+#include "absl/base/thread_annotations.h"
+#include "absl/container/flat_hash_map.h"
+#include "absl/functional/any_invocable.h"
+#include "absl/status/statusor.h"
+#include "absl/synchronization/mutex.h"
+#include "xla/python/ifrt/array.h"
+#include "xla/python/ifrt/future.h"
+#include "tsl/concurrency/ref_count.h"
+#include "tsl/platform/fingerprint.h"
+
+namespace tensorflow {
+namespace ifrt_serving {
+
+// A process-wide cache of the device arrays loaded from variable tensors,
+// keyed by a fingerprint of the tensor contents and of where the array is
+// placed. The variables with identical contents, e.g. the weights shared by
+// the versions of a model that are loaded during a version swap, are then
+// loaded onto the devices once.
+//
+// An array stays in the cache as long as a `Reference` to it is alive.
+//
+// This class is thread safe.
+class IfrtLoadedArrayCache {
+ public:
+  using ArrayFuture =
+      xla::ifrt::Future<absl::StatusOr<tsl::RCReference<xla::ifrt::Array>>>;
+  using Reference = std::shared_ptr<const ArrayFuture>;
+  using Loader =
+      absl::AnyInvocable<absl::StatusOr<tsl::RCReference<xla::ifrt::Array>>()
+                             &&>;
+
+  static IfrtLoadedArrayCache& Global();
+
+  // Returns the array cached for `key`. If there is none, invokes `loader` in
+  // the caller thread to load it. Concurrent callers with the same `key` wait
+  // for the array loaded by the first one instead of loading their own.
+  Reference GetOrLoad(const tsl::Fprint128& key, Loader loader)
+      ABSL_LOCKS_EXCLUDED(mutex_);
+
+  // Returns the number of cached arrays.
+  int size() const ABSL_LOCKS_EXCLUDED(mutex_);
+
+ private:
+  void Evict(const tsl::Fprint128& key) ABSL_LOCKS_EXCLUDED(mutex_);
+
+  mutable absl::Mutex mutex_;
+  absl::flat_hash_map<tsl::Fprint128, std::weak_ptr<const ArrayFuture>,
+                      tsl::Fprint128Hasher>
+      arrays_ ABSL_GUARDED_BY(mutex_);
+};
+
+}  // namespace ifrt_serving
+}  // namespace tensorflow
+
+#endif  // TENSORFLOW_CORE_TFRT_IFRT_IFRT_LOADED_ARRAY_CACHE_H_
@@ -16,6 +16,9 @@ limitations under the License.
 #ifndef TENSORFLOW_CORE_TFRT_IFRT_IFRT_LOADED_VARIABLE_REGISTRY_H_
 #define TENSORFLOW_CORE_TFRT_IFRT_IFRT_LOADED_VARIABLE_REGISTRY_H_
 
+#include <memory>
+#include <string>
+
 #include "absl/container/flat_hash_map.h"
 #include "absl/functional/any_invocable.h"
 #include "absl/status/status.h"
@@ -25,6 +28,7 @@ limitations under the License.
 #include "tensorflow/compiler/mlir/tfrt/transforms/ifrt/ifrt_types.h"
 #include "xla/python/ifrt/array.h"
 #include "xla/python/ifrt/future.h"
+#include "tensorflow/core/tfrt/ifrt/ifrt_loaded_array_cache.h"
 #include "tsl/concurrency/ref_count.h"
 
 namespace tensorflow {
@@ -35,6 +39,11 @@ class IfrtLoadedVariableRegistry {
  public:
   struct LoadedVariable {
     xla::ifrt::Future<absl::StatusOr<tsl::RCReference<xla::ifrt::Array>>> array;
+    // If set, it is filled in with the entry of `IfrtLoadedArrayCache` that
+    // `array` is loaded from before `array` becomes ready. It keeps the array
+    // shared with the identical variables of other models while this variable
+    // is registered.
+    std::shared_ptr<IfrtLoadedArrayCache::Reference> cached_array;
   };
   using LoadedVariableConstructor =
       absl::AnyInvocable<absl::StatusOr<LoadedVariable>() const>;
@@ -15,7 +15,9 @@ limitations under the License.
 
 #include "tensorflow/core/tfrt/ifrt/ifrt_loaded_variable_utils.h"
 
+#include <cstdint>
 #include <memory>
+#include <optional>
 #include <string>
 #include <utility>
 #include <vector>
@@ -34,11 +36,15 @@ limitations under the License.
 #include "tensorflow/core/framework/resource_handle.h"
 #include "tensorflow/core/framework/tensor.h"
 #include "tensorflow/core/framework/tensor_shape.h"
+#include "tensorflow/core/framework/types.h"
+#include "tensorflow/core/lib/strings/proto_serialization.h"
+#include "tensorflow/core/tfrt/ifrt/ifrt_loaded_array_cache.h"
 #include "tensorflow/core/tfrt/ifrt/ifrt_loaded_variable_registry.h"
 #include "tensorflow/core/tfrt/ifrt/ifrt_restore_tensor_registry.h"
 #include "tensorflow/core/tfrt/ifrt/sharding_utils.h"
 #include "tsl/concurrency/ref_count.h"
 #include "tsl/platform/errors.h"
+#include "tsl/platform/fingerprint.h"
 #include "tsl/platform/statusor.h"
 #include "tsl/platform/threadpool.h"
 #include "tfrt/host_context/concurrent_work_queue.h"  // from @tf_runtime
@@ -62,6 +68,27 @@ absl::StatusOr<tsl::RCReference<xla::ifrt::Array>> LoadIfrtVariable(
       thread_pool);
 }
 
+// Returns the key of the array loaded from `variable` in
+// `IfrtLoadedArrayCache`, or nullopt if the array is not cached.
+std::optional<tsl::Fprint128> GetLoadedArrayKey(
+    const xla::ifrt::Client& ifrt_client, const tensorflow::Tensor& variable,
+    const VariableDeviceShardingConfigProto& sharding_config) {
+  // The data of other types, e.g. strings, does not hold their contents.
+  if (!DataTypeCanUseMemcpy(variable.dtype())) return std::nullopt;
+  std::string placement;
+  if (!SerializeToStringDeterministic(sharding_config, &placement)) {
+    return std::nullopt;
+  }
+  tsl::Fprint128 key = tsl::Fingerprint128(variable.tensor_data());
+  key = tsl::FingerprintCat128(
+      key, tsl::Fingerprint128(absl::StrCat(DataTypeString(variable.dtype()),
+                                            variable.shape().DebugString(),
+                                            placement)));
+  // Arrays are not shared across clients, which own different devices.
+  return tsl::FingerprintCat128(key,
+                                reinterpret_cast<uintptr_t>(&ifrt_client));
+}
+
 }  // namespace
 
 absl::StatusOr<ifrt_serving::DtypeAndShape> GetDtypeAndShape(
@@ -119,17 +146,19 @@ absl::Status AsyncLoadRestoredTensorAsIfrtLoadedVariable(
       ifrt_restore_tensor_registry.GetDtypeAndShape(runtime_name));
   // TODO(b/330360798) Load variable on devices from the result of core
   // selection.
+  auto cached_array = std::make_shared<IfrtLoadedArrayCache::Reference>();
   TF_RETURN_IF_ERROR(ifrt_loaded_variable_registry.TryRegisterLoadedVariable(
       runtime_name,
       [&]() -> absl::StatusOr<
                 ifrt_serving::IfrtLoadedVariableRegistry::LoadedVariable> {
         return ifrt_serving::IfrtLoadedVariableRegistry::LoadedVariable(
-            {.array = loaded_variable_future});
+            {.array = loaded_variable_future, .cached_array = cached_array});
       }));
   restored_tensor_future.OnReady(
       [ifrt_client = ifrt_client, &thread_pool = thread_pool,
        checkpoint_loader_queue = checkpoint_loader_queue,
        sharding_config = sharding_config,
+       cached_array = std::move(cached_array),
        loaded_variable_promise = std::move(loaded_variable_promise)](
           absl::StatusOr<tensorflow::Tensor> restored_tensor) mutable {
         if (!restored_tensor.ok()) {
@@ -141,14 +170,34 @@ absl::Status AsyncLoadRestoredTensorAsIfrtLoadedVariable(
         checkpoint_loader_queue->AddTask(
             [ifrt_client = ifrt_client, &thread_pool = thread_pool,
              sharding_config = std::move(sharding_config),
+             cached_array = std::move(cached_array),
              restored_tensor = std::move(*restored_tensor),
              loaded_variable_promise =
                  std::move(loaded_variable_promise)]() mutable {
-              absl::StatusOr<tsl::RCReference<xla::ifrt::Array>>
-                  variable_array =
-                      LoadIfrtVariable(ifrt_client, thread_pool,
-                                       restored_tensor, sharding_config);
-              loaded_variable_promise.Set(std::move(variable_array));
+              std::optional<tsl::Fprint128> key = GetLoadedArrayKey(
+                  *ifrt_client, restored_tensor, sharding_config);
+              if (!key.has_value()) {
+                loaded_variable_promise.Set(LoadIfrtVariable(
+                    ifrt_client, thread_pool, restored_tensor,
+                    sharding_config));
+                return;
+              }
+
+              // Share the array with the identical variables of other models,
+              // e.g. of the other loaded versions of this model.
+              *cached_array = IfrtLoadedArrayCache::Global().GetOrLoad(
+                  *key, [&]() {
+                    return LoadIfrtVariable(ifrt_client, thread_pool,
+                                            restored_tensor, sharding_config);
+                  });
+              IfrtLoadedArrayCache::ArrayFuture array_future = **cached_array;
+              array_future.OnReady(
+                  [loaded_variable_promise = std::move(
+                       loaded_variable_promise)](
+                      absl::StatusOr<tsl::RCReference<xla::ifrt::Array>>
+                          array) mutable {
+                    loaded_variable_promise.Set(std::move(array));
+                  });
             });
       });
   return absl::OkStatus();
@@ -18,6 +18,7 @@ limitations under the License.
 #include <cstdint>
 #include <memory>
 #include <utility>
+#include <vector>
 
 #include <gmock/gmock.h>
 #include <gtest/gtest.h>
@@ -36,6 +37,7 @@ limitations under the License.
 #include "tensorflow/core/framework/tensor_testutil.h"
 #include "tensorflow/core/framework/types.pb.h"
 #include "tensorflow/core/tfrt/ifrt/ifrt_config.pb.h"
+#include "tensorflow/core/tfrt/ifrt/ifrt_loaded_array_cache.h"
 #include "tensorflow/core/tfrt/ifrt/ifrt_loaded_variable_registry.h"
 #include "tensorflow/core/tfrt/ifrt/ifrt_restore_tensor_registry.h"
 #include "tsl/concurrency/ref_count.h"
@@ -155,6 +157,70 @@ TEST(ShardingUtilsTest, ShardTensorToIfrtLoadedVariableSucceed) {
     EXPECT_THAT(host_tensor, TensorEq(input_tensor));
   }
 }
+
+TEST(ShardingUtilsTest, IdenticalIfrtLoadedVariablesShareArray) {
+  auto input_tensor =
+      test::AsTensor<int32_t>({5, 6, 7, 8}, TensorShape({2, 2}));
+
+  Tensor variable_handle(DT_RESOURCE, TensorShape({}));
+  ResourceHandle resource_handle;
+  resource_handle.set_name("var_y");
+  resource_handle.set_dtypes_and_shapes({{
+      DT_INT32,
+      TensorShape({2, 2}),
+  }});
+  variable_handle.flat<ResourceHandle>()(0) = std::move(resource_handle);
+
+  TF_ASSERT_OK_AND_ASSIGN(std::shared_ptr<xla::ifrt::Client> client,
+                          xla::ifrt::test_util::GetClient());
+  constexpr int kMaxParallelism = 16;
+  tsl::thread::ThreadPool thread_pool(tsl::Env::Default(), tsl::ThreadOptions(),
+                                      "Resharding", kMaxParallelism);
+  auto restore_work_queue = tfrt::CreateMultiThreadedWorkQueue(
+      /*num_threads=*/4, /*num_blocking_threads=*/4);
+
+  VariableDeviceShardingConfigProto sharding_config;
+  sharding_config.add_device_ids(0);
+
+  const int num_cached_arrays = IfrtLoadedArrayCache::Global().size();
+
+  // Two models, e.g. two versions of a model, restore identical variables.
+  constexpr int kNumModels = 2;
+  auto restored_tensor_registries =
+      std::make_unique<IfrtRestoreTensorRegistry[]>(kNumModels);
+  auto loaded_variable_registries =
+      std::make_unique<IfrtLoadedVariableRegistry[]>(kNumModels);
+  std::vector<tsl::RCReference<xla::ifrt::Array>> arrays;
+  for (int i = 0; i < kNumModels; ++i) {
+    auto promise =
+        xla::ifrt::Future<absl::StatusOr<tensorflow::Tensor>>::CreatePromise();
+    auto future =
+        xla::ifrt::Future<absl::StatusOr<tensorflow::Tensor>>(promise);
+    IfrtRestoreTensorRegistry::RestoredTensorInfo restored_tensor_info = {
+        GetDtypeAndShape(variable_handle.scalar<ResourceHandle>()()).value(),
+        future};
+    TF_ASSERT_OK(restored_tensor_registries[i].TryRegister(
+        "var_y", restored_tensor_info));
+    TF_ASSERT_OK(AsyncLoadRestoredTensorAsIfrtLoadedVariable(
+        "var_y", client, thread_pool, restored_tensor_registries[i],
+        loaded_variable_registries[i], restore_work_queue.get(),
+        sharding_config));
+    promise.Set(input_tensor);
+    TF_ASSERT_OK_AND_ASSIGN(
+        auto v, loaded_variable_registries[i].GetLoadedVariable("var_y"));
+    TF_ASSERT_OK_AND_ASSIGN(auto array, v.array.Await());
+    arrays.push_back(std::move(array));
+  }
+
+  EXPECT_EQ(arrays[0].get(), arrays[1].get());
+  EXPECT_EQ(IfrtLoadedArrayCache::Global().size(), num_cached_arrays + 1);
+
+  // The array is evicted once no model uses it.
+  restore_work_queue->Quiesce();
+  loaded_variable_registries.reset();
+  EXPECT_EQ(IfrtLoadedArrayCache::Global().size(), num_cached_arrays);
+}
+
 }  // namespace
 }  // namespace ifrt_serving
 
@@ -16,12 +16,89 @@ limitations under the License.
 #include "tensorflow/core/tfrt/ifrt/ifrt_serving_core_selector.h"
 
 #include <cstdint>
+#include <memory>
+#include <utility>
 
+#include "absl/base/attributes.h"
 #include "absl/strings/str_cat.h"
+#include "absl/strings/string_view.h"
+#include "absl/synchronization/mutex.h"
+#include "absl/time/clock.h"
+#include "absl/types/span.h"
 #include "tsl/framework/serving_device_selector.h"
 
 namespace tensorflow {
 namespace ifrt_serving {
+namespace {
+
+// The estimated latency of a program that has not completed yet. It is small,
+// so that it only breaks ties between otherwise idle cores.
+constexpr int64_t kDefaultEstimateNs = 1;
+
+ABSL_CONST_INIT int64_t (*NowNs)() = +[]() -> int64_t {
+  return absl::GetCurrentTimeNanos();
+};
+
+}  // namespace
+
+LatencyAwareCoreSelector::LatencyAwareCoreSelector(
+    int num_cores, std::unique_ptr<Policy> core_selector_policy)
+    : core_states_(num_cores),
+      core_selector_policy_(std::move(core_selector_policy)) {}
+
+tsl::DeviceReservation LatencyAwareCoreSelector::ReserveDevice(
+    absl::string_view program_fingerprint) {
+  absl::MutexLock lock(&mu_);
+  const int64_t now_ns = NowNs();
+  DeviceStates core_states;
+  core_states.states = absl::Span<const DeviceState>(core_states_);
+  core_states.now_ns = now_ns;
+  core_states.min_exec_time_ns = min_exec_time_.value_or(kDefaultEstimateNs);
+  auto [it, emplaced] =
+      execution_info_.try_emplace(program_fingerprint, ExecutionInfo());
+  const int core_index =
+      core_selector_policy_->SelectDevice(program_fingerprint, core_states);
+
+  EnqueueHelper(core_states_.at(core_index), core_index, it->second,
+                program_fingerprint, /*priority=*/0, req_id_counter_++,
+                /*priority_queue_count=*/1, /*prefetch_results=*/0, now_ns);
+  return tsl::DeviceReservation(core_index, this);
+}
+
+void LatencyAwareCoreSelector::FreeDeviceReservation(
+    const tsl::DeviceReservation& reservation) {
+  absl::MutexLock lock(&mu_);
+  const int64_t now_ns = NowNs();
+  DeviceState& core_state = core_states_.at(reservation.device_index());
+  auto& programs = core_state.enqueued_programs[0];
+  if (programs.empty()) return;
+
+  // Unlike `CompletedHelper()`, which only times programs that run
+  // back-to-back, every program is timed, since the reservations cover the
+  // whole executions.
+  const ExecutionInfo* execution_info = programs.front().execution_info;
+  programs.pop_front();
+  const_cast<ExecutionInfo*>(execution_info)
+      ->AddTime(now_ns - core_state.last_started_ns, /*result=*/0);
+  const int64_t exec_time_ns = execution_info->GetTime(/*result=*/0);
+  if (!min_exec_time_.has_value() || exec_time_ns < *min_exec_time_) {
+    min_exec_time_ = exec_time_ns;
+  }
+  // The next program on this core starts now.
+  core_state.last_started_ns = now_ns;
+}
+
+int64_t LatencyAwareCoreSelector::EstimateTimeTillIdleNs(int core_index) {
+  absl::MutexLock lock(&mu_);
+  return ServingDeviceSelector::EstimateTimeTillIdleNs(
+      core_states_.at(core_index), /*priority=*/0,
+      min_exec_time_.value_or(kDefaultEstimateNs), NowNs());
+}
+
+/*static*/ void LatencyAwareCoreSelector::OverwriteNowNsFunctionForTest(
+    int64_t (*now_ns)()) {
+  NowNs = now_ns;
+}
 
 IfrtServingCoreSelector::IfrtServingCoreSelector(
     tsl::ServingDeviceSelector* device_selector)
@@ -17,11 +17,57 @@ limitations under the License.
 #define TENSORFLOW_CORE_TFRT_IFRT_IFRT_SERVING_CORE_SELECTOR_H_
 
 #include <cstdint>
+#include <memory>
+#include <optional>
+#include <string>
 
+#include "absl/base/thread_annotations.h"
+#include "absl/container/fixed_array.h"
+#include "absl/container/node_hash_map.h"
+#include "absl/strings/string_view.h"
+#include "absl/synchronization/mutex.h"
 #include "tsl/framework/serving_device_selector.h"
 namespace tensorflow {
 namespace ifrt_serving {
 
+// A `tsl::ServingDeviceSelector` for the cores of TPU-like devices, each of
+// which runs the programs reserved on it one at a time, in order. A program is
+// considered to run from when the previous reservation of its core is freed,
+// or from its own reservation if the core is idle, until its reservation is
+// freed, and those measured latencies are averaged per program. The policy
+// selects cores from the programs reserved on each core and their average
+// latencies, e.g. `tsl::AffinityEarliestCompletionPolicy` routes a program to
+// the core expected to complete it first while keeping it on the core that
+// last ran it.
+class LatencyAwareCoreSelector : public tsl::ServingDeviceSelector {
+ public:
+  LatencyAwareCoreSelector(int num_cores,
+                           std::unique_ptr<Policy> core_selector_policy);
+
+  tsl::DeviceReservation ReserveDevice(
+      absl::string_view program_fingerprint) override;
+
+  // Returns the estimated time in nanoseconds until the given core completes
+  // all the programs reserved on it.
+  int64_t EstimateTimeTillIdleNs(int core_index) ABSL_LOCKS_EXCLUDED(mu_);
+
+ private:
+  friend class LatencyAwareCoreSelectorTestHelper;
+  static void OverwriteNowNsFunctionForTest(int64_t (*now_ns)());
+
+  void FreeDeviceReservation(
+      const tsl::DeviceReservation& reservation) override;
+
+  absl::Mutex mu_;
+  absl::FixedArray<DeviceState, 8> core_states_ ABSL_GUARDED_BY(mu_);
+  std::unique_ptr<Policy> core_selector_policy_;
+  int64_t req_id_counter_ ABSL_GUARDED_BY(mu_) = 0;
+  // Map from program fingerprint to execution info.
+  absl::node_hash_map<std::string, ExecutionInfo> execution_info_
+      ABSL_GUARDED_BY(mu_);
+  std::optional<int64_t> min_exec_time_ ABSL_GUARDED_BY(mu_);
+};
+
 // A wrapper of a `tsl::ServingDeviceSelector` that will be responsible for the
 // core selection during Ifrt TPU execution.
 class IfrtServingCoreSelector {
@@ -21,11 +21,37 @@ limitations under the License.
 #include <gmock/gmock.h>
 #include <gtest/gtest.h>
 #include "absl/strings/str_cat.h"
+#include "absl/strings/string_view.h"
+#include "absl/time/clock.h"
 #include "tsl/framework/serving_device_selector.h"
+#include "tsl/framework/serving_device_selector_policies.h"
 #include "tsl/framework/test_util/mock_serving_device_selector.h"
 
 namespace tensorflow {
 namespace ifrt_serving {
+
+class LatencyAwareCoreSelectorTestHelper {
+ public:
+  LatencyAwareCoreSelectorTestHelper() {
+    LatencyAwareCoreSelector::OverwriteNowNsFunctionForTest(NowNs);
+    now_ns_ = 0;
+  }
+
+  ~LatencyAwareCoreSelectorTestHelper() {
+    LatencyAwareCoreSelector::OverwriteNowNsFunctionForTest(
+        absl::GetCurrentTimeNanos);
+  }
+
+  static void ElapseNs(int64_t ns) { now_ns_ += ns; }
+
+  static int64_t NowNs() { return now_ns_; }
+
+ private:
+  static int64_t now_ns_;
+};
+
+int64_t LatencyAwareCoreSelectorTestHelper::now_ns_ = 0;
+
 namespace {
 
 class IfrtServingCoreSelectorTest : public ::testing::Test {
@@ -51,6 +77,70 @@ TEST_F(IfrtServingCoreSelectorTest, ReservedDevicesReturns) {
   EXPECT_THAT(reservation.device_index(), 0);
 }
 
+// Runs `program_fingerprint` for `latency_ns` on the core that `selector`
+// selects, and returns the core.
+int RunProgram(LatencyAwareCoreSelector& selector,
+               absl::string_view program_fingerprint, int64_t latency_ns) {
+  tsl::DeviceReservation reservation =
+      selector.ReserveDevice(program_fingerprint);
+  LatencyAwareCoreSelectorTestHelper::ElapseNs(latency_ns);
+  return reservation.device_index();
+}
+
+TEST(LatencyAwareCoreSelectorTest, SelectsCoreWithEarliestCompletion) {
+  LatencyAwareCoreSelectorTestHelper helper;
+  LatencyAwareCoreSelector selector(
+      /*num_cores=*/2, std::make_unique<tsl::EarliestCompletionPolicy>());
+  EXPECT_EQ(RunProgram(selector, "slow", 100), 0);
+  EXPECT_EQ(RunProgram(selector, "fast", 10), 1);
+
+  // The cores are expected to complete the reserved programs after their
+  // measured latencies.
+  tsl::DeviceReservation slow = selector.ReserveDevice("slow");
+  tsl::DeviceReservation fast = selector.ReserveDevice("fast");
+  EXPECT_NE(slow.device_index(), fast.device_index());
+  EXPECT_EQ(selector.EstimateTimeTillIdleNs(slow.device_index()), 100);
+  EXPECT_EQ(selector.EstimateTimeTillIdleNs(fast.device_index()), 10);
+
+  // The next program goes to the core that completes its work first.
+  tsl::DeviceReservation next = selector.ReserveDevice("slow");
+  EXPECT_EQ(next.device_index(), fast.device_index());
+  EXPECT_EQ(selector.EstimateTimeTillIdleNs(fast.device_index()), 110);
+
+  LatencyAwareCoreSelectorTestHelper::ElapseNs(10);
+  fast.reset();
+  EXPECT_EQ(selector.EstimateTimeTillIdleNs(fast.device_index()), 100);
+  EXPECT_EQ(selector.EstimateTimeTillIdleNs(slow.device_index()), 90);
+}
+
+TEST(LatencyAwareCoreSelectorTest, KeepsProgramOnItsCore) {
+  LatencyAwareCoreSelectorTestHelper helper;
+  LatencyAwareCoreSelector selector(
+      /*num_cores=*/2,
+      std::make_unique<tsl::AffinityEarliestCompletionPolicy>(
+          /*switch_cost_ns=*/100));
+  EXPECT_EQ(RunProgram(selector, "a", 100), 0);
+  EXPECT_EQ(RunProgram(selector, "b", 100), 1);
+
+  // Each program returns to the core that last ran it.
+  EXPECT_EQ(RunProgram(selector, "a", 100), 0);
+  EXPECT_EQ(RunProgram(selector, "b", 100), 1);
+
+  // Waiting for the core of `a` costs less than switching programs on the
+  // other core.
+  tsl::DeviceReservation b = selector.ReserveDevice("b");
+  ASSERT_EQ(b.device_index(), 1);
+  LatencyAwareCoreSelectorTestHelper::ElapseNs(60);
+  tsl::DeviceReservation a = selector.ReserveDevice("a");
+  EXPECT_EQ(a.device_index(), 0);
+  tsl::DeviceReservation a2 = selector.ReserveDevice("a");
+  EXPECT_EQ(a2.device_index(), 0);
+
+  // Once the core of `a` is further behind than the switching cost, `a` moves.
+  tsl::DeviceReservation a3 = selector.ReserveDevice("a");
+  EXPECT_EQ(a3.device_index(), 1);
+}
+
 }  // namespace
 }  // namespace ifrt_serving
 }  // namespace tensorflow
@@ -16,13 +16,16 @@ limitations under the License.
 
 #include <cstdint>
 #include <memory>
+#include <optional>
 #include <string>
 #include <utility>
 #include <vector>
 
 #include "absl/cleanup/cleanup.h"
 #include "absl/container/flat_hash_set.h"
+#include "absl/log/log.h"
 #include "absl/status/status.h"
+#include "absl/status/statusor.h"
 #include "absl/strings/str_cat.h"
 #include "absl/strings/string_view.h"
 #include "absl/time/clock.h"
@@ -30,11 +33,15 @@ limitations under the License.
 #include "absl/types/span.h"
 #include "tensorflow/core/framework/op_kernel.h"
 #include "tensorflow/core/framework/op_requires.h"
+#include "tensorflow/core/framework/resource_base.h"
+#include "tensorflow/core/framework/resource_mgr.h"
 #include "tensorflow/core/framework/tensor.h"
 #include "tensorflow/core/framework/tensor_shape.h"
 #include "tensorflow/core/framework/types.h"
 #include "tensorflow/core/tfrt/kernels/stream_ops_util.h"
 #include "tensorflow/core/tfrt/runtime/stream.h"
+#include "tensorflow/core/util/env_var.h"
+#include "tsl/platform/errors.h"
 #include "tsl/profiler/lib/traceme.h"
 
 namespace tensorflow {
@@ -50,6 +57,48 @@ bool AreNamesUnique(absl::Span<const std::string> names) {
   return unique_names.size() == names.size();
 }
 
+// Returns the options for sending the streamed results in batches, or nullopt
+// if each `PwStreamResults` sends its results immediately.
+absl::StatusOr<std::optional<BatchingStreamWorkerInterface::Options>>
+GetBatchingOptions() {
+  int64_t max_batch_size;
+  TF_RETURN_IF_ERROR(
+      ReadInt64FromEnvVar("TF_TFRT_STREAM_RESULTS_MAX_BATCH_SIZE",
+                          /*default_val=*/1, &max_batch_size));
+  if (max_batch_size <= 1) return std::nullopt;
+  int64_t max_batch_delay_us;
+  TF_RETURN_IF_ERROR(
+      ReadInt64FromEnvVar("TF_TFRT_STREAM_RESULTS_MAX_BATCH_DELAY_US",
+                          /*default_val=*/1000, &max_batch_delay_us));
+
+  BatchingStreamWorkerInterface::Options options;
+  options.max_batch_size = max_batch_size;
+  options.max_batch_delay = absl::Microseconds(max_batch_delay_us);
+  return options;
+}
+
+// A per-step resource that sends the results batched during a step when the
+// step ends, so that they arrive before the controller unregisters the stream
+// callback of the step.
+class StreamResultsFlusher : public ResourceBase {
+ public:
+  explicit StreamResultsFlusher(
+      std::shared_ptr<BatchingStreamWorkerInterface> stream)
+      : stream_(std::move(stream)) {}
+
+  ~StreamResultsFlusher() override {
+    absl::Status status = stream_->Flush();
+    if (!status.ok()) {
+      LOG(ERROR) << "Failed to send the streamed results: " << status;
+    }
+  }
+
+  std::string DebugString() const override { return "StreamResultsFlusher"; }
+
+ private:
+  std::shared_ptr<BatchingStreamWorkerInterface> stream_;
+};
+
 }  // namespace
 
 PwStreamResultsOp::PwStreamResultsOp(tensorflow::OpKernelConstruction* ctx)
@@ -81,7 +130,16 @@ PwStreamResultsOp::PwStreamResultsOp(tensorflow::OpKernelConstruction* ctx)
   auto interface = tensorflow::tfrt_stub::GetGlobalStreamInterfaceFactory()
                        .CreateWorkerStreamInterface()(controller_address_);
   OP_REQUIRES_OK(ctx, interface.status());
-  stream_ = *std::move(interface);
+
+  auto batching_options = GetBatchingOptions();
+  OP_REQUIRES_OK(ctx, batching_options.status());
+  if (batching_options->has_value()) {
+    batching_stream_ = std::make_shared<BatchingStreamWorkerInterface>(
+        *std::move(interface), **batching_options);
+    stream_ = batching_stream_;
+  } else {
+    stream_ = *std::move(interface);
+  }
 }
 
 void PwStreamResultsOp::Compute(tensorflow::OpKernelContext* ctx) {
@@ -122,6 +180,25 @@ void PwStreamResultsOp::Compute(tensorflow::OpKernelContext* ctx) {
 
   OP_REQUIRES_OK(ctx, stream_->InvokeStreamCallback(callback_id_, names_,
                                                     responses.value()));
+
+  if (batching_stream_ != nullptr) {
+    // Send the pending results at the latest when the step ends.
+    ScopedStepContainer* step_container = ctx->step_container();
+    if (step_container == nullptr || ctx->resource_manager() == nullptr) {
+      OP_REQUIRES_OK(ctx, batching_stream_->Flush());
+      return;
+    }
+    StreamResultsFlusher* flusher = nullptr;
+    OP_REQUIRES_OK(
+        ctx, step_container->LookupOrCreate<StreamResultsFlusher>(
+                 ctx->resource_manager(),
+                 absl::StrCat("PwStreamResults_", name(), "_flusher"),
+                 &flusher, [&](StreamResultsFlusher** flusher) {
+                   *flusher = new StreamResultsFlusher(batching_stream_);
+                   return absl::OkStatus();
+                 }));
+    flusher->Unref();
+  }
 }
 
 REGISTER_KERNEL_BUILDER(Name("PwStreamResults").Device(tensorflow::DEVICE_CPU),
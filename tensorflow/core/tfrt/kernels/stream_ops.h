@@ -42,7 +42,11 @@ class PwStreamResultsOp : public tensorflow::OpKernel {
   StreamCallbackId callback_id_;
   std::vector<std::string> names_;
 
-  std::unique_ptr<tensorflow::tfrt_stub::StreamWorkerInterface> stream_;
+  std::shared_ptr<tensorflow::tfrt_stub::StreamWorkerInterface> stream_;
+  // Set iff the results are sent in batches, to the same interface as
+  // `stream_`. It is shared with the steps that have pending results, which
+  // may outlive this kernel.
+  std::shared_ptr<BatchingStreamWorkerInterface> batching_stream_;
 };
 
 }  // namespace tfrt_stub
@@ -14,6 +14,12 @@ limitations under the License.
 ==============================================================================*/
 #include "tensorflow/core/tfrt/mlrt/interpreter/context.h"
 
+#include <cstdint>
+#include <string>
+#include <utility>
+#include <vector>
+
+#include "absl/container/flat_hash_map.h"
 #include "absl/log/check.h"
 #include "absl/strings/string_view.h"
 #include "tensorflow/core/tfrt/mlrt/bytecode/executable.h"
@@ -35,21 +41,77 @@ KernelImplementation KernelRegistry::Get(absl::string_view name) const {
   return map_.at(name);
 }
 
+void KernelRegistry::RegisterSuperinstruction(
+    std::vector<std::string> kernel_names, KernelImplementation kernel) {
+  DCHECK_GE(kernel_names.size(), 2);
+  superinstructions_.push_back({std::move(kernel_names), kernel});
+}
+
 void KernelRegistry::Merge(const KernelRegistry& other) {
   map_.insert(other.map_.begin(), other.map_.end());
+  superinstructions_.insert(superinstructions_.end(),
+                            other.superinstructions_.begin(),
+                            other.superinstructions_.end());
 }
 
 LoadedExecutable::LoadedExecutable(bc::Executable executable,
                                    const KernelRegistry& kernel_registry)
     : executable_(executable) {
   kernels_.reserve(executable_.kernel_names().size());
+  absl::flat_hash_map<absl::string_view, uint32_t> kernel_codes;
   for (auto kernel_name : executable_.kernel_names()) {
+    kernel_codes[kernel_name.Get()] = kernels_.size();
     kernels_.push_back(kernel_registry.Get(kernel_name));
   }
 
+  // The kernel codes of the superinstructions whose kernels are all used by
+  // this executable.
+  std::vector<std::pair<std::vector<uint32_t>, KernelImplementation>>
+      superinstructions;
+  for (const auto& superinstruction : kernel_registry.superinstructions()) {
+    std::vector<uint32_t> codes;
+    for (const auto& kernel_name : superinstruction.kernel_names) {
+      auto iter = kernel_codes.find(kernel_name);
+      if (iter == kernel_codes.end()) break;
+      codes.push_back(iter->second);
+    }
+    if (codes.size() == superinstruction.kernel_names.size()) {
+      superinstructions.push_back({std::move(codes), superinstruction.kernel});
+    }
+  }
+
   functions_.reserve(executable_.functions().size());
+  function_kernels_.reserve(executable_.functions().size());
   for (auto function : executable_.functions()) {
     functions_[function.name().Get()] = function;
+
+    auto& function_kernels = function_kernels_[function.kernels().data()];
+    function_kernels.kernels.reserve(function.kernels().size());
+    for (auto kernel : function.kernels()) {
+      function_kernels.kernels.push_back(kernels_[kernel.code()]);
+    }
+
+    // Greedily replace the longest superinstruction starting at each kernel.
+    // The fused kernels keep their own implementations, so that the execution
+    // can resume at any of them.
+    int64_t num_kernels = function.kernels().size();
+    for (int64_t pc = 0; pc < num_kernels;) {
+      int64_t length = 1;
+      for (const auto& [codes, superinstruction] : superinstructions) {
+        int64_t num_codes = codes.size();
+        if (num_codes <= length || pc + num_codes > num_kernels) continue;
+        bool matches = true;
+        for (int64_t i = 0; matches && i < num_codes; ++i) {
+          matches = function.kernels()[pc + i].code() == codes[i];
+        }
+        if (matches) {
+          function_kernels.kernels[pc] = superinstruction;
+          function_kernels.has_superinstructions = true;
+          length = num_codes;
+        }
+      }
+      pc += length;
+    }
   }
 }
 
@@ -70,10 +70,28 @@ class KernelRegistry {
     Register<KernelClass>(KernelClass::kName);
   }
 
+  // Registers `kernel` as a superinstruction for the sequence of kernels named
+  // `kernel_names`. When an executable is loaded, every occurrence of the
+  // sequence in a function is dispatched to `kernel` instead of its first
+  // kernel, which saves the interpreter a dispatch per fused kernel. `kernel`
+  // is typically an instantiation of FusedKernels().
+  void RegisterSuperinstruction(std::vector<std::string> kernel_names,
+                                KernelImplementation kernel);
+
+  struct Superinstruction {
+    std::vector<std::string> kernel_names;
+    KernelImplementation kernel = nullptr;
+  };
+
+  absl::Span<const Superinstruction> superinstructions() const {
+    return superinstructions_;
+  }
+
   void Merge(const KernelRegistry& other);
 
  private:
   absl::flat_hash_map<std::string, KernelImplementation> map_;
+  std::vector<Superinstruction> superinstructions_;
 };
 
 class LoadedExecutable {
@@ -83,6 +101,29 @@ class LoadedExecutable {
 
   absl::Span<const KernelImplementation> kernels() const { return kernels_; }
 
+  struct FunctionKernels {
+    // The implementations of the kernels of a function in program order, so
+    // that the interpreter dispatches each kernel with a single indirect call
+    // through its program counter instead of looking up its kernel code. The
+    // first kernel of each occurrence of a registered superinstruction is
+    // replaced by the superinstruction.
+    std::vector<KernelImplementation> kernels;
+    bool has_superinstructions = false;
+  };
+
+  // Returns the kernel implementations of `function`, or empty ones if
+  // `function` is not in this executable. It is looked up once per call, when
+  // the function's FunctionContext is created.
+  const FunctionKernels& GetFunctionKernels(bc::Function function) const {
+    if (auto iter = function_kernels_.find(function.kernels().data());
+        iter != function_kernels_.end()) {
+      return iter->second;
+    }
+
+    static const FunctionKernels* const kEmpty = new FunctionKernels();
+    return *kEmpty;
+  }
+
   bc::Function GetFunction(absl::string_view name) const {
     if (auto iter = functions_.find(name); iter != functions_.end()) {
       return iter->second;
@@ -98,6 +139,9 @@ class LoadedExecutable {
 
   absl::flat_hash_map<std::string, bc::Function> functions_;
   std::vector<KernelImplementation> kernels_;
+  // The kernel implementations of each function, keyed by the address of the
+  // function's kernels.
+  absl::flat_hash_map<const char*, FunctionKernels> function_kernels_;
 };
 
 // A helper structure that holds states for a kernel. Typical usuage is that a
@@ -118,10 +162,15 @@ void UnwindOnError(ExecutionContext& context, int64_t pc);
 
 class FunctionContext {
  public:
-  FunctionContext(bc::Function function, ExecutionContext* execution_context)
+  // `kernels` are the kernel implementations of `function` (see
+  // LoadedExecutable::GetFunctionKernels()).
+  FunctionContext(bc::Function function,
+                  const LoadedExecutable::FunctionKernels& kernels,
+                  ExecutionContext* execution_context)
       : pc_(0),
         registers_(function.num_regs()),
         function_object_(function),
+        kernels_(&kernels),
         execution_context_(execution_context) {
     DCHECK(execution_context);
   }
@@ -207,6 +256,7 @@ class FunctionContext {
   std::vector<Value> registers_;
   std::vector<Value*> results_;
   bc::Function function_object_;
+  const LoadedExecutable::FunctionKernels* kernels_ = nullptr;
   KernelContext kernel_context_;
 
   ExecutionContext* execution_context_ = nullptr;
@@ -276,16 +326,18 @@ class ExecutionContext {
   template <typename Args, typename Results>
   void Call(bc::Function function_object, bc::Span<uint8_t> last_uses,
             Args args, Results results) {
-    auto& function_context =
-        function_stack_.emplace_back(function_object, this);
+    auto& function_context = function_stack_.emplace_back(
+        function_object,
+        loaded_executable_->GetFunctionKernels(function_object), this);
     function_context.Call(last_uses, args, results);
     state_ = State::kReady;
   }
 
   template <typename Args, typename Results>
   void CallByMove(bc::Function function_object, Args args, Results results) {
-    auto& function_context =
-        function_stack_.emplace_back(function_object, this);
+    auto& function_context = function_stack_.emplace_back(
+        function_object,
+        loaded_executable_->GetFunctionKernels(function_object), this);
     function_context.CallByMove(args, results);
     state_ = State::kReady;
   }
@@ -523,6 +575,11 @@ class KernelFrame {
     absl::Span<Value> regs;
     bc::Span<bc::String> attrs;
     ExecutionContext* execution_context = nullptr;
+
+    // The kernels of the function being executed and the program counter of
+    // `kernel`. They are only maintained for functions with superinstructions.
+    bc::Vector<bc::Kernel>::iterator kernels{nullptr};
+    int64_t pc = 0;
   };
 
   explicit KernelFrame(State* state) : state_(state) { DCHECK(state_); }
@@ -553,6 +610,14 @@ class KernelFrame {
 
   void set_kernel(bc::Kernel kernel) { this->kernel() = kernel; }
 
+  // Moves the frame to the kernel following the current one, so that a
+  // superinstruction can run it, and so that the interpreter resumes after it
+  // if it breaks the sequential execution.
+  void AdvanceToNextKernel() {
+    DCHECK(state_->kernels.data());
+    set_kernel(*(state_->kernels + ++state_->pc));
+  }
+
  private:
   bc::Kernel& kernel() { return state_->kernel; }
   const bc::Kernel& kernel() const { return state_->kernel; }
@@ -565,10 +630,37 @@ class KernelFrame {
   friend void Execute(ExecutionContext& context);
 };
 
+template <typename KernelClass>
+void InvokeKernel(KernelFrame frame) {
+  KernelClass(frame).Invoke();
+}
+
+// A superinstruction that runs the kernel implementations `kernel` and `rest`
+// in program order within a single dispatch, e.g.
+//
+//   registry.RegisterSuperinstruction(
+//       {"foo", "bar"},
+//       &FusedKernels<&InvokeKernel<FooKernel>, &InvokeKernel<BarKernel>>);
+//
+// It stops after a kernel that breaks the sequential execution, e.g. by
+// suspending or calling a function, and the interpreter then resumes at the
+// following kernel with its own implementation.
+template <KernelImplementation kernel, KernelImplementation... rest>
+void FusedKernels(KernelFrame frame) {
+  kernel(frame);
+  if constexpr (sizeof...(rest) > 0) {
+    if (frame.execution_context().state() !=
+        ExecutionContext::State::kRunning) {
+      return;
+    }
+    frame.AdvanceToNextKernel();
+    FusedKernels<rest...>(frame);
+  }
+}
+
 template <typename KernelClass>
 inline void KernelRegistry::Register(absl::string_view name) {
-  Register(
-      name, +[](KernelFrame frame) { KernelClass(frame).Invoke(); });
+  Register(name, &InvokeKernel<KernelClass>);
 }
 
 }  // namespace mlrt
@@ -18,6 +18,7 @@ limitations under the License.
 
 #include "absl/log/check.h"
 #include "absl/log/log.h"
+#include "absl/types/span.h"
 #include "tensorflow/core/tfrt/mlrt/bytecode/kernel.h"
 #include "tensorflow/core/tfrt/mlrt/interpreter/context.h"
 #include "tensorflow/core/tfrt/mlrt/interpreter/register_span.h"
@@ -88,7 +89,13 @@ void Execute(ExecutionContext& ctx) {
     FunctionContext* current_function = &context.function_stack_.back();
     int64_t pc = current_function->pc_;
 
-    auto kernels = context.loaded_executable().kernels();
+    // The kernel implementations are resolved per instruction when the
+    // executable is loaded, so that dispatching a kernel does not depend on
+    // reading its kernel code first.
+    const auto& function_kernels = *current_function->kernels_;
+    absl::Span<const KernelImplementation> kernels = function_kernels.kernels;
+    DCHECK_EQ(kernels.size(),
+              current_function->function_object().kernels().size());
 
     auto kernel_object_iter =
         current_function->function_object().kernels().begin();
@@ -100,13 +107,26 @@ void Execute(ExecutionContext& ctx) {
     // The main loop for executing kernels in program order. The kernels may set
     // the execution state to break this loop for context-switching or error
     // handling.
-    for (; context.state_ == ExecutionContext::State::kRunning; ++pc) {
-      DCHECK(kernel_object_iter <
-             current_function->function_object().kernels().end());
-      bc::Kernel kernel_object = *kernel_object_iter;
-      frame.set_kernel(kernel_object);
-      kernels[kernel_object.code()](frame);
-      ++kernel_object_iter;
+    if (!function_kernels.has_superinstructions) {
+      for (; context.state_ == ExecutionContext::State::kRunning; ++pc) {
+        DCHECK(kernel_object_iter <
+               current_function->function_object().kernels().end());
+        frame.set_kernel(*kernel_object_iter);
+        kernels[pc](frame);
+        ++kernel_object_iter;
+      }
+    } else {
+      // A superinstruction advances `kstate.pc` past the kernels it runs.
+      auto kernel_objects =
+          current_function->function_object().kernels().begin();
+      kstate.kernels = kernel_objects;
+      for (; context.state_ == ExecutionContext::State::kRunning;
+           pc = kstate.pc + 1) {
+        DCHECK_LT(pc, static_cast<int64_t>(kernels.size()));
+        kstate.pc = pc;
+        frame.set_kernel(*(kernel_objects + pc));
+        kernels[pc](frame);
+      }
     }
 
     // Update the program counter if we need to break the sequential execution
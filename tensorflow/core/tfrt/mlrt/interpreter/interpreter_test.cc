@@ -202,6 +202,51 @@ TEST(InterpreterTest, SequentialAdd) {
   EXPECT_EQ(result.Get<int32_t>(), 100);
 }
 
+int num_fused_adds = 0;
+
+void FusedAddI32(KernelFrame frame) {
+  ++num_fused_adds;
+  FusedKernels<&InvokeKernel<AddI32Kernel>, &InvokeKernel<AddI32Kernel>>(
+      frame);
+}
+
+TEST(InterpreterTest, SequentialAddSuperinstruction) {
+  auto buffer = CreateSequentialAddExecutable(99);
+
+  bc::Executable executable(buffer.data());
+
+  KernelRegistry kernel_registry;
+  RegisterBuiltinKernels(kernel_registry);
+  kernel_registry.Register<AddI32Kernel>();
+  kernel_registry.RegisterSuperinstruction({"add", "add"}, &FusedAddI32);
+
+  LoadedExecutable loaded_executable(executable, kernel_registry);
+
+  absl::Notification notification;
+
+  ExecutionContext execution_context(&loaded_executable);
+  execution_context.set_exit_handler([&]() { notification.Notify(); });
+
+  int32_t v = 1;
+  mlrt::Value arg(v);
+  mlrt::Value result;
+
+  auto function = loaded_executable.GetFunction("main");
+  ASSERT_TRUE(function);
+
+  num_fused_adds = 0;
+  std::vector<uint8_t> last_uses = {true};
+  execution_context.Call(function, last_uses, absl::Span<Value>(&arg, 1),
+                         absl::Span<Value>(&result, 1));
+  Execute(execution_context);
+
+  notification.WaitForNotification();
+
+  EXPECT_EQ(result.Get<int32_t>(), 100);
+  // The last of the 99 adds is not fused.
+  EXPECT_EQ(num_fused_adds, 49);
+}
+
 TEST(InterpreterTest, SequentialAddAttributes) {
   auto buffer = CreateSequentialAddAttributesExecutable(99);
 
@@ -728,6 +773,54 @@ TEST(InterpreterTest, Await) {
   EXPECT_EQ(output.Get<int32_t>(), 100);
 }
 
+void Return(KernelFrame frame) {
+  frame.execution_context().Return(frame.arguments());
+}
+
+TEST(InterpreterTest, SuperinstructionResumesAfterAwait) {
+  auto buffer = CreateAwaitExecutable();
+
+  bc::Executable executable(buffer.data());
+
+  KernelRegistry kernel_registry;
+  RegisterBuiltinKernels(kernel_registry);
+  kernel_registry.Register("await.i32", &AwaitI32);
+  kernel_registry.RegisterSuperinstruction(
+      {"await.i32", "return"},
+      &FusedKernels<&AwaitI32, &Return>);
+
+  LoadedExecutable loaded_executable(executable, kernel_registry);
+
+  auto work_queue = tfrt::CreateMultiThreadedWorkQueue(
+      /*num_threads=*/4, /*num_blocking_threads=*/4);
+  ExecutionContext execution_context(&loaded_executable);
+  execution_context.set_work_queue(work_queue.get());
+
+  absl::Notification notification;
+  execution_context.set_exit_handler(
+      [&notification]() { notification.Notify(); });
+
+  auto promise = Promise::Allocate<int32_t>();
+
+  Value input(promise.GetFuture());
+  Value output;
+
+  // The await suspends the superinstruction, and the execution resumes at the
+  // return op.
+  std::vector<uint8_t> last_uses = {true};
+  execution_context.Call(executable.functions()[0], last_uses,
+                         absl::Span<Value>(&input, 1),
+                         absl::Span<Value>(&output, 1));
+  Execute(execution_context);
+
+  std::move(promise).Set<int32_t>(100);
+
+  notification.WaitForNotification();
+  TF_ASSERT_OK(execution_context.status());
+
+  EXPECT_EQ(output.Get<int32_t>(), 100);
+}
+
 struct TestPayload {
   TestPayload() = default;
   TestPayload(const TestPayload& other)
@@ -3153,6 +3246,54 @@ void BM_SequentialAdd(::testing::benchmark::State& state) {
 }
 BENCHMARK(BM_SequentialAdd);
 
+void BM_SequentialAddSuperinstruction(::testing::benchmark::State& state) {
+  auto buffer = CreateSequentialAddExecutable(99);
+
+  bc::Executable executable(buffer.data());
+
+  KernelRegistry kernel_registry;
+  RegisterBuiltinKernels(kernel_registry);
+  kernel_registry.Register<AddI32Kernel>();
+  kernel_registry.RegisterSuperinstruction(
+      {"add", "add"},
+      &FusedKernels<&InvokeKernel<AddI32Kernel>, &InvokeKernel<AddI32Kernel>>);
+
+  LoadedExecutable loaded_executable(executable, kernel_registry);
+
+  absl::Notification notification;
+
+  ExecutionContext execution_context(&loaded_executable);
+  execution_context.set_exit_handler([&]() { notification.Notify(); });
+
+  int32_t v = 1;
+  Value arg(v);
+  Value result;
+
+  auto function = loaded_executable.GetFunction("main");
+  ASSERT_TRUE(function);
+
+  std::vector<uint8_t> last_uses = {false};
+  execution_context.Call(function, last_uses, absl::Span<Value>(&arg, 1),
+                         absl::Span<Value>(&result, 1));
+
+  Execute(execution_context);
+  notification.WaitForNotification();
+  CHECK_EQ(result.Get<int32_t>(), 100);
+
+  for (auto s : state) {
+    absl::Notification notification;
+
+    ExecutionContext execution_context(&loaded_executable);
+    execution_context.set_exit_handler([&]() { notification.Notify(); });
+
+    execution_context.Call(function, last_uses, absl::Span<Value>(&arg, 1),
+                           absl::Span<Value>(&result, 1));
+    Execute(execution_context);
+    notification.WaitForNotification();
+  }
+}
+BENCHMARK(BM_SequentialAddSuperinstruction);
+
 void BM_SequentialAddAttributes(::testing::benchmark::State& state) {
   auto buffer = CreateSequentialAddAttributesExecutable(99);
 
@@ -1047,6 +1047,10 @@ void RegisterTfMlrtKernels(mlrt::KernelRegistry& registry) {
   registry.Register("tf_mlrt.promise", &PromiseTensor);
   registry.Register("tf_mlrt.promise_future", &PromiseFuture);
   registry.Register<PromiseReturnOp>();
+  // An awaited tensor is typically consumed right away by a fallback op.
+  registry.RegisterSuperinstruction(
+      {"tf_mlrt.await", "tf_mlrt.executeop"},
+      &mlrt::FusedKernels<&AwaitTensor, &mlrt::InvokeKernel<ExecuteOp>>);
 
   registry.Merge(GetTfMlrtOptionalKernelRegistry());
 }
@@ -673,7 +673,8 @@ class RunHandler::Impl {
   void ScheduleInterOpClosure(TaskFunction fn);
   void ScheduleIntraOpClosure(TaskFunction fn);
 
-  void Reset(int64_t step_id, const RunHandlerOptions& options);
+  void Reset(int64_t step_id, const RunHandlerOptions& options,
+             int64_t cost_us);
 
   RunHandlerPool::Impl* pool_impl() { return pool_impl_; }
 
@@ -684,6 +685,10 @@ class RunHandler::Impl {
   internal::ThreadWorkSource* tws() { return &tws_; }
 
   int64_t priority() const { return options_.priority; }
+  int request_class() const { return options_.request_class; }
+
+  // The estimated cost with which the request was admitted.
+  int64_t cost_us() const { return cost_us_; }
 
  private:
   class RunHandlerEigenThreadPool
@@ -712,6 +717,7 @@ class RunHandler::Impl {
   int64_t step_id_;
   internal::ThreadWorkSource tws_;
   RunHandlerOptions options_;
+  int64_t cost_us_;
 };
 
 // Contains shared state across all run handlers present in the pool. Also
@@ -739,8 +745,18 @@ class RunHandlerPool::Impl {
         version_(0),
         wait_if_no_active_request_(options.wait_if_no_active_request),
         sub_thread_pool_end_request_percentage_(
-            options.sub_thread_request_percentage) {
+            options.sub_thread_request_percentage),
+        max_inflight_cost_us_(options.max_inflight_cost_us),
+        shed_load_(options.shed_load),
+        request_class_weights_(options.request_class_weights.empty()
+                                   ? std::vector<double>{1.0}
+                                   : options.request_class_weights),
+        class_finish_tags_(request_class_weights_.size(), 0.0),
+        class_average_cost_us_(request_class_weights_.size(), 0) {
     VLOG(1) << "Creating a RunHandlerPool with max handlers: " << max_handlers_;
+    for (double weight : request_class_weights_) {
+      DCHECK_GT(weight, 0.0);
+    }
     free_handlers_.reserve(max_handlers_);
     handlers_.reserve(max_handlers_);
     for (int i = 0; i < max_handlers_; ++i) {
@@ -776,6 +792,54 @@ class RunHandlerPool::Impl {
     return !free_handlers_.empty();
   }
 
+  // A request waiting in Get() for admission.
+  struct PendingRequest {
+    RunHandlerPool::Impl* pool_impl;
+    int64_t cost_us;
+    // The start tag in start-time fair queuing, and the arrival order to break
+    // ties.
+    double start_tag;
+    uint64_t sequence;
+
+    bool IsBefore(const PendingRequest& other) const {
+      return start_tag < other.start_tag ||
+             (start_tag == other.start_tag && sequence < other.sequence);
+    }
+  };
+
+  // Returns true if `request` is first in the fair queuing order, and there
+  // is a free handler and room in the cost budget for it.
+  bool CanAdmit(const PendingRequest& request)
+      TF_EXCLUSIVE_LOCKS_REQUIRED(mu_) {
+    if (!has_free_handler()) return false;
+    for (const PendingRequest* pending : pending_requests_) {
+      if (pending->IsBefore(request)) return false;
+    }
+    return max_inflight_cost_us_ <= 0 || inflight_cost_us_ == 0 ||
+           inflight_cost_us_ + request.cost_us <= max_inflight_cost_us_;
+  }
+
+  static bool CanAdmitPendingRequest(PendingRequest* request)
+      TF_NO_THREAD_SAFETY_ANALYSIS {
+    return request->pool_impl->CanAdmit(*request);
+  }
+
+  // Returns the expected time until `request` fits in the cost budget. The
+  // cost that must finish first, i.e. the cost of the requests that hold a
+  // handler or are ahead of `request` in excess of the budget, is expected to
+  // drain at one microsecond per microsecond per active request.
+  int64_t ExpectedQueueingDelayUs(const PendingRequest& request)
+      TF_EXCLUSIVE_LOCKS_REQUIRED(mu_) {
+    if (max_inflight_cost_us_ <= 0) return 0;
+    int64_t cost = inflight_cost_us_ + request.cost_us;
+    for (const PendingRequest* pending : pending_requests_) {
+      if (pending->IsBefore(request)) cost += pending->cost_us;
+    }
+    const int64_t excess = cost - max_inflight_cost_us_;
+    if (excess <= 0) return 0;
+    return excess / std::max<int64_t>(1, sorted_active_handlers_.size());
+  }
+
   std::unique_ptr<RunHandler> Get(int64_t step_id, int64_t timeout_in_ms,
                                   const RunHandlerOptions& options)
       TF_LOCKS_EXCLUDED(mu_) {
@@ -788,31 +852,78 @@ class RunHandlerPool::Impl {
     RunHandler::Impl* handler_impl;
     {
       tensorflow::mutex_lock l(mu_);
-      if (!has_free_handler()) {
+      RunHandlerOptions admitted_options = options;
+      int& request_class = admitted_options.request_class;
+      if (request_class < 0 ||
+          request_class >= static_cast<int>(request_class_weights_.size())) {
+        LOG_EVERY_N_SEC(WARNING, 10)
+            << "Invalid request class " << request_class << ", using 0.";
+        request_class = 0;
+      }
+      PendingRequest request;
+      request.pool_impl = this;
+      request.cost_us = options.estimated_cost_us > 0
+                            ? options.estimated_cost_us
+                            : class_average_cost_us_[request_class];
+      request.start_tag =
+          std::max(virtual_time_, class_finish_tags_[request_class]);
+      request.sequence = next_sequence_++;
+      const double finish_tag =
+          request.start_tag +
+          request.cost_us / request_class_weights_[request_class];
+      class_finish_tags_[request_class] = finish_tag;
+      // A request that is not admitted does not count against its class,
+      // unless a later request of the class has already been tagged.
+      auto reject = [&]() TF_EXCLUSIVE_LOCKS_REQUIRED(mu_) {
+        if (class_finish_tags_[request_class] == finish_tag) {
+          class_finish_tags_[request_class] = request.start_tag;
+        }
+        return nullptr;
+      };
+
+      if (!CanAdmit(request)) {
+        if (shed_load_ && timeout_in_ms > 0) {
+          const int64_t expected_delay_us = ExpectedQueueingDelayUs(request);
+          if (expected_delay_us > timeout_in_ms * 1000) {
+            VLOG(1) << "Shedding request " << step_id
+                    << " with expected queueing delay " << expected_delay_us
+                    << " us.";
+            return reject();
+          }
+        }
         tsl::profiler::TraceMe activity(
             [step_id] {
               return tsl::profiler::TraceMeEncode("WaitingForHandler",
                                                   {{"step_id", step_id}});
             },
             tsl::profiler::TraceMeLevel::kInfo);
+        pending_requests_.push_back(&request);
+        tensorflow::Condition can_admit(&Impl::CanAdmitPendingRequest,
+                                        &request);
+        bool admitted = true;
         if (timeout_in_ms == 0) {
-          mu_.Await(tensorflow::Condition(this, &Impl::has_free_handler));
-        } else if (!mu_.AwaitWithDeadline(
-                       tensorflow::Condition(this, &Impl::has_free_handler),
-                       tensorflow::EnvTime::NowNanos() +
-                           timeout_in_ms * 1000 * 1000)) {
-          return nullptr;
+          mu_.Await(can_admit);
+        } else {
+          admitted = mu_.AwaitWithDeadline(
+              can_admit,
+              tensorflow::EnvTime::NowNanos() + timeout_in_ms * 1000 * 1000);
         }
+        pending_requests_.erase(std::find(pending_requests_.begin(),
+                                          pending_requests_.end(), &request));
+        if (!admitted) return reject();
       }
+      virtual_time_ = request.start_tag;
+      inflight_cost_us_ += request.cost_us;
+
       // Remove the last entry from free_handlers_ and add to the end of
       // sorted_active_handlers_.
       handler_impl = free_handlers_.back();
-      handler_impl->Reset(step_id, options);
+      handler_impl->Reset(step_id, admitted_options, request.cost_us);
       free_handlers_.pop_back();
 
       num_active_requests = sorted_active_handlers_.size() + 1;
       thread_work_sources->resize(num_active_requests);
-      int priority = options.priority;
+      int priority = admitted_options.priority;
       auto it = sorted_active_handlers_.cbegin();
       bool new_handler_inserted = false;
       for (int i = 0; i < num_active_requests; ++i) {
@@ -843,6 +954,19 @@ class RunHandlerPool::Impl {
     double elapsed = (now - handler->start_time_us()) / 1000.0;
     time_hist_.Add(elapsed);
 
+    // Keep an exponentially weighted moving average of the execution times,
+    // with a weight of 1/8 for the latest one, to estimate the costs of the
+    // requests that do not have one.
+    inflight_cost_us_ -= handler->cost_us();
+    int64_t& average_cost_us =
+        class_average_cost_us_[handler->request_class()];
+    const int64_t elapsed_us = now - handler->start_time_us();
+    if (average_cost_us == 0) {
+      average_cost_us = elapsed_us;
+    } else {
+      average_cost_us += (elapsed_us - average_cost_us) / 8;
+    }
+
     // Erase from and update sorted_active_handlers_. Add it to the end of
     // free_handlers_.
     auto iter = std::find(sorted_active_handlers_.begin(),
@@ -881,6 +1005,11 @@ class RunHandlerPool::Impl {
     return ret;
   }
 
+  int GetNumPendingRequestsForTesting() TF_LOCKS_EXCLUDED(mu_) {
+    tensorflow::mutex_lock l(mu_);
+    return pending_requests_.size();
+  }
+
   void Quiesce() TF_LOCKS_EXCLUDED(mu_) {
     while (true) {
       {
@@ -938,6 +1067,21 @@ class RunHandlerPool::Impl {
   int64_t version_ TF_GUARDED_BY(mu_);
   bool wait_if_no_active_request_;
   const std::vector<double> sub_thread_pool_end_request_percentage_;
+
+  // Admission control.
+  const int64_t max_inflight_cost_us_;
+  const bool shed_load_;
+  const std::vector<double> request_class_weights_;
+  // The total estimated cost of the requests that hold a handler.
+  int64_t inflight_cost_us_ TF_GUARDED_BY(mu_) = 0;
+  std::vector<PendingRequest*> pending_requests_ TF_GUARDED_BY(mu_);
+  // The virtual time of start-time fair queuing, i.e. the start tag of the
+  // last admitted request, and the finish tag of the last request of each
+  // class.
+  double virtual_time_ TF_GUARDED_BY(mu_) = 0;
+  std::vector<double> class_finish_tags_ TF_GUARDED_BY(mu_);
+  uint64_t next_sequence_ TF_GUARDED_BY(mu_) = 0;
+  std::vector<int64_t> class_average_cost_us_ TF_GUARDED_BY(mu_);
 };
 
 void RunHandlerPool::Impl::RecomputePoolStats(
@@ -995,7 +1139,7 @@ void RunHandlerPool::Impl::LogInfo() {
 
 RunHandler::Impl::Impl(RunHandlerPool::Impl* pool_impl)
     : pool_impl_(pool_impl), eigen_thread_pool_(this) {
-  Reset(0, RunHandlerOptions());
+  Reset(0, RunHandlerOptions(), 0);
 }
 
 void RunHandler::Impl::ScheduleInterOpClosure(TaskFunction fn) {
@@ -1011,10 +1155,12 @@ void RunHandler::Impl::ScheduleIntraOpClosure(TaskFunction fn) {
 }
 
 void RunHandler::Impl::Reset(int64_t step_id,
-                             const RunHandlerOptions& options) {
+                             const RunHandlerOptions& options,
+                             int64_t cost_us) {
   start_time_us_ = tensorflow::Env::Default()->NowMicros();
   step_id_ = step_id;
   options_ = options;
+  cost_us_ = cost_us;
   tws_.SetTracemeId(step_id);
 }
 
@@ -1040,6 +1186,10 @@ std::vector<int64_t> RunHandlerPool::GetActiveHandlerPrioritiesForTesting()
   return impl_->GetActiveHandlerPrioritiesForTesting();
 }
 
+int RunHandlerPool::GetNumPendingRequestsForTesting() const {
+  return impl_->GetNumPendingRequestsForTesting();
+}
+
 void RunHandlerPool::Quiesce() const { impl_->Quiesce(); }
 
 RunHandler::RunHandler(Impl* impl) : impl_(impl) {}
@@ -18,6 +18,7 @@ limitations under the License.
 
 #include <atomic>
 #include <cstddef>
+#include <cstdint>
 #include <functional>
 #include <memory>
 #include <optional>
@@ -48,6 +49,15 @@ struct RunHandlerOptions {
 
   // Request priority.
   int priority;
+
+  // The estimated cost of the request, as microseconds of execution time. If
+  // zero, the average execution time of the recent requests of the same class
+  // is used.
+  int64_t estimated_cost_us = 0;
+
+  // The class of the request, an index into
+  // `RunHandlerPool::Options::request_class_weights`.
+  int request_class = 0;
 };
 
 // RunHandlerPool is a fixed size pool of pre-allocated RunHandlers
@@ -108,6 +118,22 @@ class RunHandlerPool {
 
     // If true, threads will be waken up by new tasks.
     bool enable_wake_up = true;
+
+    // The maximum total estimated cost, in microseconds, of the requests that
+    // hold a handler. A request that would exceed it waits until enough of
+    // them finish, unless no request holds a handler. If zero, only the
+    // number of handlers limits the admission of requests.
+    int64_t max_inflight_cost_us = 0;
+
+    // The weights of the request classes. Waiting requests are admitted in
+    // start-time fair queuing order, so that each class with waiting requests
+    // gets a share of the admitted cost proportional to its weight.
+    std::vector<double> request_class_weights = {1.0};
+
+    // If true and `max_inflight_cost_us` is set, Get() with a timeout returns
+    // nullptr right away when the expected queueing delay of the request
+    // exceeds the timeout, instead of waiting for the timeout to expire.
+    bool shed_load = false;
   };
   explicit RunHandlerPool(Options options);
   ~RunHandlerPool();
@@ -119,7 +145,9 @@ class RunHandlerPool {
   // and is being used by a client.  It becomes 'inactive' once more when the
   // unique_ptr is destroyed.
   //
-  // Will block unless there is an inactive handler.
+  // Will block unless there is an inactive handler and the request fits in
+  // the cost budget. Returns nullptr if the request is not admitted within
+  // `timeout_in_ms`, or is shed.
   std::unique_ptr<RunHandler> Get(
       int64_t step_id = 0, int64_t timeout_in_ms = 0,
       const RunHandlerOptions& options = RunHandlerOptions());
@@ -128,6 +156,9 @@ class RunHandlerPool {
   // order of the active handler list.
   std::vector<int64_t> GetActiveHandlerPrioritiesForTesting() const;
 
+  // Get the number of requests waiting for admission in Get().
+  int GetNumPendingRequestsForTesting() const;
+
   // Block until the system is quiescent (no pending work and no inflight work).
   void Quiesce() const;
 
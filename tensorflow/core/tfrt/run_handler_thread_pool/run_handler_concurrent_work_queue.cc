@@ -56,6 +56,8 @@ RunHandlerThreadWorkQueue::RunHandlerThreadWorkQueue(const Options& options)
   pool_options.enable_wake_up = options.enable_wake_up;
   pool_options.wait_if_no_active_request = options.wait_if_no_active_request;
   pool_options.use_adaptive_waiting_time = options.use_adaptive_waiting_time;
+  pool_options.max_inflight_cost_us = options.max_inflight_cost_us;
+  pool_options.shed_load = options.shed_load;
   handler_pool_ = std::make_unique<RunHandlerPool>(pool_options);
 }
 
@@ -67,7 +69,7 @@ RunHandlerThreadWorkQueue::InitializeRequest(int64_t request_id) const {
   if (!handler) {
     return tensorflow::errors::Internal(absl::StrCat(
         "Could not obtain RunHandler for request after waiting for ",
-        options_.init_timeout_ms, " ms."));
+        options_.init_timeout_ms, " ms, or the request was shed."));
   }
 
   return {std::make_unique<RunHandlerWorkQueue>(std::move(handler))};
@@ -126,7 +128,9 @@ std::ostream& operator<<(std::ostream& strm,
               << options.use_adaptive_waiting_time
               << ", wait_if_no_active_request = "
               << options.wait_if_no_active_request
-              << ", enable_wake_up = " << options.enable_wake_up << "}";
+              << ", enable_wake_up = " << options.enable_wake_up
+              << ", max_inflight_cost_us = " << options.max_inflight_cost_us
+              << ", shed_load = " << options.shed_load << "}";
 }
 
 }  // namespace tf
@@ -79,6 +79,14 @@ class RunHandlerThreadWorkQueue
 
     // If true, threads will be waken up by new tasks.
     bool enable_wake_up = true;
+
+    // The maximum total estimated cost, in microseconds, of the in-flight
+    // requests. If zero, only `max_concurrent_handler` limits them.
+    int64_t max_inflight_cost_us = 0;
+
+    // If true, InitRequest() fails right away instead of waiting when the
+    // expected queueing delay of the request exceeds `init_timeout_ms`.
+    bool shed_load = false;
   };
 
   explicit RunHandlerThreadWorkQueue(const Options& options);
@@ -137,6 +137,95 @@ TEST(RunHandlerUtilTest, IntraOpThreadPool) {
   notification.WaitForNotification();
 }
 
+TEST(RunHandlerUtilTest, CostBudgetLimitsAdmission) {
+  RunHandlerPool::Options pool_options;
+  pool_options.max_inflight_cost_us = 100;
+  std::unique_ptr<RunHandlerPool> pool(new RunHandlerPool(pool_options));
+
+  RunHandlerOptions options = RunHandlerOptions();
+  options.estimated_cost_us = 60;
+  auto handler1 = pool->Get(/*step_id=*/1, /*timeout_in_ms=*/0, options);
+  ASSERT_NE(handler1, nullptr);
+
+  // The second request does not fit in the budget until the first one ends.
+  EXPECT_EQ(pool->Get(/*step_id=*/2, /*timeout_in_ms=*/10, options), nullptr);
+  options.estimated_cost_us = 40;
+  auto handler3 = pool->Get(/*step_id=*/3, /*timeout_in_ms=*/0, options);
+  EXPECT_NE(handler3, nullptr);
+
+  handler1.reset();
+  handler3.reset();
+  options.estimated_cost_us = 100;
+  EXPECT_NE(pool->Get(/*step_id=*/4, /*timeout_in_ms=*/0, options), nullptr);
+}
+
+TEST(RunHandlerUtilTest, ShedsRequestsExceedingTimeout) {
+  RunHandlerPool::Options pool_options;
+  pool_options.max_inflight_cost_us = 100'000'000;
+  pool_options.shed_load = true;
+  std::unique_ptr<RunHandlerPool> pool(new RunHandlerPool(pool_options));
+
+  RunHandlerOptions options = RunHandlerOptions();
+  options.estimated_cost_us = 100'000'000;
+  auto handler = pool->Get(/*step_id=*/1, /*timeout_in_ms=*/0, options);
+  ASSERT_NE(handler, nullptr);
+
+  // The expected queueing delay of 100 seconds exceeds the timeout, so the
+  // request is rejected without waiting for the timeout.
+  const uint64_t start_us = tensorflow::Env::Default()->NowMicros();
+  EXPECT_EQ(pool->Get(/*step_id=*/2, /*timeout_in_ms=*/60'000, options),
+            nullptr);
+  EXPECT_LT(tensorflow::Env::Default()->NowMicros() - start_us, 30'000'000);
+}
+
+TEST(RunHandlerUtilTest, FairSharingAcrossRequestClasses) {
+  RunHandlerPool::Options pool_options;
+  pool_options.max_inflight_cost_us = 100;
+  pool_options.request_class_weights = {1.0, 1.0};
+  std::unique_ptr<RunHandlerPool> pool(new RunHandlerPool(pool_options));
+
+  RunHandlerOptions class0_options = RunHandlerOptions();
+  class0_options.estimated_cost_us = 100;
+  class0_options.request_class = 0;
+  RunHandlerOptions class1_options = class0_options;
+  class1_options.request_class = 1;
+
+  auto handler = pool->Get(/*step_id=*/0, /*timeout_in_ms=*/0, class0_options);
+  ASSERT_NE(handler, nullptr);
+
+  tensorflow::mutex mu;
+  std::vector<int64_t> admitted_step_ids;
+  {
+    tensorflow::thread::ThreadPool test_pool(tensorflow::Env::Default(),
+                                             "test", /*num_threads=*/3);
+    auto get = [&](int64_t step_id, const RunHandlerOptions& options) {
+      test_pool.Schedule([&, step_id, options]() {
+        auto admitted_handler =
+            pool->Get(step_id, /*timeout_in_ms=*/0, options);
+        tensorflow::mutex_lock l(mu);
+        admitted_step_ids.push_back(step_id);
+      });
+    };
+    // Class 0 already holds the whole budget, so its waiting requests come
+    // after the one of class 1 even though they arrive first.
+    get(/*step_id=*/1, class0_options);
+    while (pool->GetNumPendingRequestsForTesting() < 1) {
+      tensorflow::Env::Default()->SleepForMicroseconds(1000);
+    }
+    get(/*step_id=*/2, class0_options);
+    while (pool->GetNumPendingRequestsForTesting() < 2) {
+      tensorflow::Env::Default()->SleepForMicroseconds(1000);
+    }
+    get(/*step_id=*/3, class1_options);
+    while (pool->GetNumPendingRequestsForTesting() < 3) {
+      tensorflow::Env::Default()->SleepForMicroseconds(1000);
+    }
+    handler.reset();
+  }
+
+  EXPECT_EQ(admitted_step_ids, std::vector<int64_t>({3, 1, 2}));
+}
+
 class RunHandlerThreadPoolTest
     : public testing::TestWithParam<std::tuple<bool, bool>> {
  protected:
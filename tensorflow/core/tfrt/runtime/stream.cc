@@ -25,6 +25,7 @@ limitations under the License.
 #include "absl/container/flat_hash_map.h"
 #include "absl/functional/any_invocable.h"
 #include "absl/log/check.h"
+#include "absl/log/log.h"
 #include "absl/status/status.h"
 #include "absl/status/statusor.h"
 #include "absl/synchronization/mutex.h"
@@ -36,6 +37,8 @@ limitations under the License.
 #include "tensorflow/compiler/mlir/tensorflow/ir/tf_ops.h"
 #include "tensorflow/core/framework/tensor.h"
 #include "tensorflow/core/framework/tensor.pb.h"
+#include "tsl/platform/env.h"
+#include "tsl/platform/errors.h"
 #include "tsl/platform/random.h"
 #include "tsl/platform/threadpool_interface.h"
 #include "tsl/profiler/lib/traceme.h"
@@ -79,6 +82,125 @@ absl::StatusOr<std::optional<StreamCallbackId>> CreateStreamCallbackId(
   return callback_id;
 }
 
+struct BatchingStreamWorkerInterface::Batcher {
+  Batcher(std::unique_ptr<StreamWorkerInterface> stream,
+          const Options& options)
+      : stream(std::move(stream)), options(options) {}
+
+  absl::Status Flush() ABSL_LOCKS_EXCLUDED(send_mu, mu);
+
+  const std::unique_ptr<StreamWorkerInterface> stream;
+  const Options options;
+
+  // Held while a batch is sent, so that batches are sent in order.
+  absl::Mutex send_mu;
+
+  absl::Mutex mu;
+  StreamCallbackId callback_id ABSL_GUARDED_BY(mu);
+  std::vector<std::string> names ABSL_GUARDED_BY(mu);
+  std::vector<std::pair<int64_t, std::vector<tensorflow::Tensor>>> responses
+      ABSL_GUARDED_BY(mu);
+  // The first error from sending a batch in the background.
+  absl::Status status ABSL_GUARDED_BY(mu);
+};
+
+absl::Status BatchingStreamWorkerInterface::Batcher::Flush() {
+  absl::MutexLock send_lock(&send_mu);
+  StreamCallbackId batch_callback_id;
+  std::vector<std::string> batch_names;
+  std::vector<std::pair<int64_t, std::vector<tensorflow::Tensor>>> batch;
+  {
+    absl::MutexLock lock(&mu);
+    if (responses.empty()) return absl::OkStatus();
+    batch_callback_id = callback_id;
+    batch_names = names;
+    batch.swap(responses);
+  }
+  tsl::profiler::TraceMe trace_me([&]() {
+    return tsl::profiler::TraceMeEncode(
+        "BatchingStreamWorkerInterface::Flush",
+        {{"callback_id", batch_callback_id.id}, {"batch_size", batch.size()}});
+  });
+  TF_RETURN_IF_ERROR(stream->AcquireCredits(batch.size()));
+  return stream->InvokeStreamCallback(batch_callback_id, batch_names, batch);
+}
+
+BatchingStreamWorkerInterface::BatchingStreamWorkerInterface(
+    std::unique_ptr<StreamWorkerInterface> stream, const Options& options)
+    : StreamWorkerInterface(std::string(stream->controller_address())),
+      batcher_(std::make_shared<Batcher>(std::move(stream), options)) {}
+
+BatchingStreamWorkerInterface::~BatchingStreamWorkerInterface() {
+  absl::Status status = Flush();
+  if (!status.ok()) {
+    LOG(ERROR) << "Failed to send the streamed results: " << status;
+  }
+}
+
+void BatchingStreamWorkerInterface::RecordSendLatency(
+    absl::string_view model_name, absl::Duration latency) {
+  batcher_->stream->RecordSendLatency(model_name, latency);
+}
+
+absl::Status BatchingStreamWorkerInterface::InvokeStreamCallback(
+    const StreamCallbackId& callback_id, const std::vector<std::string>& names,
+    const std::vector<std::pair<int64_t, std::vector<tensorflow::Tensor>>>&
+        responses) {
+  bool flush_pending_batch;
+  {
+    absl::MutexLock lock(&batcher_->mu);
+    if (!batcher_->status.ok()) {
+      return std::exchange(batcher_->status, absl::OkStatus());
+    }
+    // A batch only holds the responses for one callback and set of names.
+    flush_pending_batch =
+        !batcher_->responses.empty() &&
+        (!(batcher_->callback_id == callback_id) || batcher_->names != names);
+  }
+  if (flush_pending_batch) TF_RETURN_IF_ERROR(Flush());
+
+  bool send_now;
+  bool schedule_send;
+  {
+    absl::MutexLock lock(&batcher_->mu);
+    const bool was_empty = batcher_->responses.empty();
+    batcher_->callback_id = callback_id;
+    batcher_->names = names;
+    batcher_->responses.insert(batcher_->responses.end(), responses.begin(),
+                               responses.end());
+    send_now = batcher_->responses.size() >=
+                   static_cast<size_t>(batcher_->options.max_batch_size) ||
+               batcher_->options.max_batch_delay <= absl::ZeroDuration();
+    schedule_send = was_empty && !send_now;
+  }
+  if (send_now) return Flush();
+
+  if (schedule_send) {
+    tsl::Env::Default()->SchedClosureAfter(
+        absl::ToInt64Microseconds(batcher_->options.max_batch_delay),
+        [batcher = std::weak_ptr<Batcher>(batcher_)]() {
+          // The pending batch was sent when this object was destroyed.
+          std::shared_ptr<Batcher> b = batcher.lock();
+          if (b == nullptr) return;
+          absl::Status status = b->Flush();
+          if (!status.ok()) {
+            absl::MutexLock lock(&b->mu);
+            b->status.Update(status);
+          }
+        });
+  }
+  return absl::OkStatus();
+}
+
+absl::Status BatchingStreamWorkerInterface::AcquireCredits(
+    int64_t num_responses) {
+  return batcher_->stream->AcquireCredits(num_responses);
+}
+
+absl::Status BatchingStreamWorkerInterface::Flush() {
+  return batcher_->Flush();
+}
+
 absl::Status StreamCallbackRegistry::CallbackState::Invoke(
     tsl::thread::ThreadPoolInterface* thread_pool, StreamedResult result) {
   {
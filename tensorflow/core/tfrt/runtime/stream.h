@@ -90,10 +90,58 @@ class StreamWorkerInterface {
       const std::vector<std::pair<int64_t, std::vector<tensorflow::Tensor>>>&
           responses) = 0;
 
+  // Blocks until the controller has granted the credits to receive
+  // `num_responses` more responses, and consumes them. Implementations with
+  // credit-based flow control use it to apply backpressure on the senders when
+  // the controller falls behind; the others return immediately.
+  virtual absl::Status AcquireCredits(int64_t num_responses) {
+    return absl::OkStatus();
+  }
+
  private:
   std::string controller_address_;
 };
 
+// A `StreamWorkerInterface` that coalesces the responses sent through it and
+// sends them to the controller in batches, each after acquiring the credits for
+// its responses. A batch is sent when it is full, when its first response has
+// waited for `max_batch_delay`, or when `Flush()` is called, and batches are
+// sent in order. Errors from sending a batch in the background are returned by
+// the next `InvokeStreamCallback()`.
+//
+// This class is thread-safe.
+class BatchingStreamWorkerInterface : public StreamWorkerInterface {
+ public:
+  struct Options {
+    // The maximum number of responses in a batch.
+    int max_batch_size = 16;
+    // The maximum time a response waits before its batch is sent.
+    absl::Duration max_batch_delay = absl::Milliseconds(1);
+  };
+
+  BatchingStreamWorkerInterface(std::unique_ptr<StreamWorkerInterface> stream,
+                                const Options& options);
+  ~BatchingStreamWorkerInterface() override;
+
+  void RecordSendLatency(absl::string_view model_name,
+                         absl::Duration latency) override;
+  absl::Status InvokeStreamCallback(
+      const StreamCallbackId& callback_id,
+      const std::vector<std::string>& names,
+      const std::vector<std::pair<int64_t, std::vector<tensorflow::Tensor>>>&
+          responses) override;
+  absl::Status AcquireCredits(int64_t num_responses) override;
+
+  // Sends the pending batch, if any.
+  absl::Status Flush();
+
+ private:
+  struct Batcher;
+  // Shared with the delayed sends, which must not extend the lifetime of this
+  // object.
+  std::shared_ptr<Batcher> batcher_;
+};
+
 class ScopedStreamCallback;
 
 class StreamInterfaceFactory {
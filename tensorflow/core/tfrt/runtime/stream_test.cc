@@ -22,16 +22,20 @@ limitations under the License.
 
 #include <gmock/gmock.h>
 #include <gtest/gtest.h>
+#include "absl/base/thread_annotations.h"
 #include "absl/container/flat_hash_map.h"
 #include "absl/log/check.h"
 #include "absl/log/log.h"
 #include "absl/memory/memory.h"
+#include "absl/status/status.h"
+#include "absl/synchronization/mutex.h"
 #include "absl/time/clock.h"
 #include "absl/time/time.h"
 #include "tensorflow/core/framework/tensor.h"
 #include "tensorflow/core/framework/tensor_testutil.h"
 #include "tensorflow/core/tfrt/saved_model/saved_model_testutil.h"
 #include "tensorflow/core/tfrt/utils/thread_pool.h"
+#include "tsl/lib/core/status_test_util.h"
 #include "tsl/platform/env.h"
 #include "tsl/platform/statusor.h"
 
@@ -142,6 +146,113 @@ TEST(StreamTest, MultipleWriters) {
   }
 }
 
+class RecordingStreamWorkerInterface : public StreamWorkerInterface {
+ public:
+  RecordingStreamWorkerInterface() : StreamWorkerInterface("test_address") {}
+
+  absl::Status InvokeStreamCallback(
+      const StreamCallbackId& callback_id,
+      const std::vector<std::string>& names,
+      const std::vector<std::pair<int64_t, std::vector<tensorflow::Tensor>>>&
+          responses) override {
+    absl::MutexLock lock(&mu_);
+    batch_sizes_.push_back(responses.size());
+    return absl::OkStatus();
+  }
+
+  absl::Status AcquireCredits(int64_t num_responses) override {
+    absl::MutexLock lock(&mu_);
+    credits_ += num_responses;
+    return absl::OkStatus();
+  }
+
+  std::vector<int64_t> batch_sizes() {
+    absl::MutexLock lock(&mu_);
+    return batch_sizes_;
+  }
+
+  int64_t credits() {
+    absl::MutexLock lock(&mu_);
+    return credits_;
+  }
+
+ private:
+  absl::Mutex mu_;
+  std::vector<int64_t> batch_sizes_ ABSL_GUARDED_BY(mu_);
+  int64_t credits_ ABSL_GUARDED_BY(mu_) = 0;
+};
+
+std::vector<std::pair<int64_t, std::vector<tensorflow::Tensor>>> MakeResponse(
+    int64_t step_id) {
+  return {{step_id, {AsTensor<int32_t>({100})}}};
+}
+
+TEST(BatchingStreamWorkerInterfaceTest, SendsFullBatches) {
+  auto recording = std::make_unique<RecordingStreamWorkerInterface>();
+  RecordingStreamWorkerInterface* recording_ptr = recording.get();
+  BatchingStreamWorkerInterface::Options options;
+  options.max_batch_size = 2;
+  options.max_batch_delay = absl::Hours(1);
+  BatchingStreamWorkerInterface stream(std::move(recording), options);
+
+  StreamCallbackId callback_id(1234);
+  std::vector<std::string> names = {"a"};
+  for (int i = 0; i < 5; ++i) {
+    TF_ASSERT_OK(stream.InvokeStreamCallback(callback_id, names,
+                                             MakeResponse(/*step_id=*/i)));
+  }
+  EXPECT_THAT(recording_ptr->batch_sizes(), ElementsAreArray({2, 2}));
+  EXPECT_EQ(recording_ptr->credits(), 4);
+
+  TF_ASSERT_OK(stream.Flush());
+  EXPECT_THAT(recording_ptr->batch_sizes(), ElementsAreArray({2, 2, 1}));
+  EXPECT_EQ(recording_ptr->credits(), 5);
+
+  // Nothing is pending, so flushing again does not send anything.
+  TF_ASSERT_OK(stream.Flush());
+  EXPECT_THAT(recording_ptr->batch_sizes(), ElementsAreArray({2, 2, 1}));
+}
+
+TEST(BatchingStreamWorkerInterfaceTest, SendsBatchAfterDelay) {
+  auto recording = std::make_unique<RecordingStreamWorkerInterface>();
+  RecordingStreamWorkerInterface* recording_ptr = recording.get();
+  BatchingStreamWorkerInterface::Options options;
+  options.max_batch_size = 100;
+  options.max_batch_delay = absl::Milliseconds(1);
+  BatchingStreamWorkerInterface stream(std::move(recording), options);
+
+  TF_ASSERT_OK(stream.InvokeStreamCallback(StreamCallbackId(1234), {"a"},
+                                           MakeResponse(/*step_id=*/0)));
+  TF_ASSERT_OK(stream.InvokeStreamCallback(StreamCallbackId(1234), {"a"},
+                                           MakeResponse(/*step_id=*/1)));
+
+  while (recording_ptr->batch_sizes().empty()) {
+    absl::SleepFor(absl::Milliseconds(1));
+  }
+  EXPECT_THAT(recording_ptr->batch_sizes(), ElementsAreArray({2}));
+  EXPECT_EQ(recording_ptr->credits(), 2);
+}
+
+TEST(BatchingStreamWorkerInterfaceTest, FlushesOnCallbackChange) {
+  auto recording = std::make_unique<RecordingStreamWorkerInterface>();
+  RecordingStreamWorkerInterface* recording_ptr = recording.get();
+  BatchingStreamWorkerInterface::Options options;
+  options.max_batch_size = 100;
+  options.max_batch_delay = absl::Hours(1);
+  BatchingStreamWorkerInterface stream(std::move(recording), options);
+
+  TF_ASSERT_OK(stream.InvokeStreamCallback(StreamCallbackId(1), {"a"},
+                                           MakeResponse(/*step_id=*/0)));
+  TF_ASSERT_OK(stream.InvokeStreamCallback(StreamCallbackId(1), {"a"},
+                                           MakeResponse(/*step_id=*/1)));
+  TF_ASSERT_OK(stream.InvokeStreamCallback(StreamCallbackId(2), {"a"},
+                                           MakeResponse(/*step_id=*/2)));
+  EXPECT_THAT(recording_ptr->batch_sizes(), ElementsAreArray({2}));
+
+  TF_ASSERT_OK(stream.Flush());
+  EXPECT_THAT(recording_ptr->batch_sizes(), ElementsAreArray({2, 1}));
+}
+
 }  // namespace
 }  // namespace tfrt_stub
 }  // namespace tensorflow
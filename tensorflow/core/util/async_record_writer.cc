@@ -0,0 +1,102 @@
+/* Copyright 2024 The TensorFlow Authors. All Rights Reserved.
+
+Licensed under the Apache License, Version 2.0 (the "License");
+you may not use this file except in compliance with the License.
+You may obtain a copy of the License at
+
+    http://www.apache.org/licenses/LICENSE-2.0
+
+Unless required by applicable law or agreed to in writing, software
+distributed under the License is distributed on an "AS IS" BASIS,
+WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+See the License for the specific language governing permissions and
+limitations under the License.
+==============================================================================*/
+
+#include "tensorflow/core/util/async_record_writer.h"
+
+#include <cstdint>
+#include <string>
+#include <utility>
+#include <vector>
+
+#include "tensorflow/core/platform/env.h"
+#include "tensorflow/core/platform/mutex.h"
+
+namespace tensorflow {
+
+AsyncRecordWriter::AsyncRecordWriter(Env* env, const std::string& name,
+                                     const AsyncRecordWriterOptions& options,
+                                     BatchWriter write_batch)
+    : options_(options), write_batch_(std::move(write_batch)) {
+  thread_.reset(
+      env->StartThread(ThreadOptions(), name, [this] { WriterLoop(); }));
+}
+
+AsyncRecordWriter::~AsyncRecordWriter() {
+  {
+    mutex_lock l(mu_);
+    stopping_ = true;
+  }
+  queued_cv_.notify_all();
+  // Joins the writer thread, which writes the remaining records first.
+  thread_.reset();
+}
+
+bool AsyncRecordWriter::Write(std::string record) {
+  {
+    mutex_lock l(mu_);
+    while (static_cast<int64_t>(queue_.size()) >=
+           options_.max_queued_records) {
+      if (options_.overflow_policy ==
+          AsyncRecordWriterOptions::OverflowPolicy::kDrop) {
+        ++num_dropped_;
+        return false;
+      }
+      written_cv_.wait(l);
+    }
+    queue_.push_back(std::move(record));
+    ++num_queued_;
+  }
+  queued_cv_.notify_one();
+  return true;
+}
+
+void AsyncRecordWriter::Drain() {
+  mutex_lock l(mu_);
+  const int64_t num_queued = num_queued_;
+  while (num_written_ < num_queued) {
+    written_cv_.wait(l);
+  }
+}
+
+int64_t AsyncRecordWriter::num_dropped() const {
+  mutex_lock l(mu_);
+  return num_dropped_;
+}
+
+void AsyncRecordWriter::WriterLoop() {
+  std::vector<std::string> batch;
+  while (true) {
+    {
+      mutex_lock l(mu_);
+      while (queue_.empty() && !stopping_) {
+        queued_cv_.wait(l);
+      }
+      if (queue_.empty()) return;
+      batch.swap(queue_);
+    }
+    // The producers blocked on a full queue can continue.
+    written_cv_.notify_all();
+    const int64_t batch_size = batch.size();
+    write_batch_(&batch);
+    batch.clear();
+    {
+      mutex_lock l(mu_);
+      num_written_ += batch_size;
+    }
+    written_cv_.notify_all();
+  }
+}
+
+}  // namespace tensorflow
@@ -0,0 +1,100 @@
+/* Copyright 2024 The TensorFlow Authors. All Rights Reserved.
+
+Licensed under the Apache License, Version 2.0 (the "License");
+you may not use this file except in compliance with the License.
+You may obtain a copy of the License at
+
+    http://www.apache.org/licenses/LICENSE-2.0
+
+Unless required by applicable law or agreed to in writing, software
+distributed under the License is distributed on an "AS IS" BASIS,
+WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+See the License for the specific language governing permissions and
+limitations under the License.
+==============================================================================*/
+
+#ifndef TENSORFLOW_CORE_UTIL_ASYNC_RECORD_WRITER_H_
+#define TENSORFLOW_CORE_UTIL_ASYNC_RECORD_WRITER_H_
+
+#include <cstdint>
+#include <functional>
+#include <memory>
+#include <string>
+#include <vector>
+
+#include "tensorflow/core/platform/env.h"
+#include "tensorflow/core/platform/mutex.h"
+#include "tensorflow/core/platform/thread_annotations.h"
+
+namespace tensorflow {
+
+struct AsyncRecordWriterOptions {
+  // What Write() does when `max_queued_records` records are waiting.
+  enum class OverflowPolicy {
+    // Waits until the writer thread has taken the queued records.
+    kBlock,
+    // Drops the record and counts it in num_dropped().
+    kDrop,
+  };
+
+  int64_t max_queued_records = 1024;
+  OverflowPolicy overflow_policy = OverflowPolicy::kBlock;
+};
+
+// AsyncRecordWriter moves the writing of records off the threads producing
+// them: Write() only queues the record, and a writer thread passes all the
+// records queued since its last batch to `write_batch`, so that a slow file
+// system delays the writer thread rather than the producers.
+//
+// This class is thread-safe.
+class AsyncRecordWriter {
+ public:
+  // Called on the writer thread with the records in the order of the Write()
+  // calls. Batches are not passed concurrently.
+  using BatchWriter = std::function<void(std::vector<std::string>* records)>;
+
+  AsyncRecordWriter(Env* env, const std::string& name,
+                    const AsyncRecordWriterOptions& options,
+                    BatchWriter write_batch);
+
+  // Writes the queued records and stops the writer thread.
+  ~AsyncRecordWriter();
+
+  // Queues `record`. Returns false if it was dropped because of the overflow
+  // policy.
+  bool Write(std::string record);
+
+  // Blocks until the records queued before the call have been written.
+  void Drain();
+
+  // The number of records dropped because the queue was full.
+  int64_t num_dropped() const;
+
+ private:
+  void WriterLoop();
+
+  const AsyncRecordWriterOptions options_;
+  const BatchWriter write_batch_;
+
+  mutable mutex mu_;
+  // Signaled when records are queued or when stopping.
+  condition_variable queued_cv_;
+  // Signaled when a batch has been taken off the queue or written.
+  condition_variable written_cv_;
+  std::vector<std::string> queue_ TF_GUARDED_BY(mu_);
+  // The number of records queued and written since the construction.
+  int64_t num_queued_ TF_GUARDED_BY(mu_) = 0;
+  int64_t num_written_ TF_GUARDED_BY(mu_) = 0;
+  int64_t num_dropped_ TF_GUARDED_BY(mu_) = 0;
+  bool stopping_ TF_GUARDED_BY(mu_) = false;
+
+  // Last, so that the thread is joined before the state above is destroyed.
+  std::unique_ptr<Thread> thread_;
+
+  AsyncRecordWriter(const AsyncRecordWriter&) = delete;
+  void operator=(const AsyncRecordWriter&) = delete;
+};
+
+}  // namespace tensorflow
+
+#endif  // TENSORFLOW_CORE_UTIL_ASYNC_RECORD_WRITER_H_
@@ -0,0 +1,143 @@
+/* Copyright 2024 The TensorFlow Authors. All Rights Reserved.
+
+Licensed under the Apache License, Version 2.0 (the "License");
+you may not use this file except in compliance with the License.
+You may obtain a copy of the License at
+
+    http://www.apache.org/licenses/LICENSE-2.0
+
+Unless required by applicable law or agreed to in writing, software
+distributed under the License is distributed on an "AS IS" BASIS,
+WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+See the License for the specific language governing permissions and
+limitations under the License.
+==============================================================================*/
+
+#include "tensorflow/core/util/async_record_writer.h"
+
+#include <atomic>
+#include <memory>
+#include <string>
+#include <vector>
+
+#include "tensorflow/core/platform/env.h"
+#include "tensorflow/core/platform/mutex.h"
+#include "tensorflow/core/platform/notification.h"
+#include "tensorflow/core/platform/test.h"
+
+namespace tensorflow {
+namespace {
+
+// Collects the records written, and optionally blocks the writer thread in
+// the first batch until Unblock() is called.
+class RecordCollector {
+ public:
+  explicit RecordCollector(bool block_first_batch = false) {
+    if (!block_first_batch) unblocked_.Notify();
+  }
+
+  AsyncRecordWriter::BatchWriter BatchWriter() {
+    return [this](std::vector<std::string>* batch) {
+      if (!started_.HasBeenNotified()) started_.Notify();
+      unblocked_.WaitForNotification();
+      mutex_lock l(mu_);
+      records_.insert(records_.end(), batch->begin(), batch->end());
+    };
+  }
+
+  void WaitUntilStarted() { started_.WaitForNotification(); }
+  void Unblock() { unblocked_.Notify(); }
+
+  std::vector<std::string> records() {
+    mutex_lock l(mu_);
+    return records_;
+  }
+
+ private:
+  Notification started_;
+  Notification unblocked_;
+  mutex mu_;
+  std::vector<std::string> records_ TF_GUARDED_BY(mu_);
+};
+
+TEST(AsyncRecordWriterTest, WritesTheRecordsInOrder) {
+  RecordCollector collector;
+  AsyncRecordWriterOptions options;
+  options.max_queued_records = 4;
+  AsyncRecordWriter writer(Env::Default(), "test_writer", options,
+                           collector.BatchWriter());
+  std::vector<std::string> expected;
+  for (int i = 0; i < 100; ++i) {
+    expected.push_back(std::to_string(i));
+    EXPECT_TRUE(writer.Write(expected.back()));
+  }
+  writer.Drain();
+  EXPECT_EQ(collector.records(), expected);
+  EXPECT_EQ(writer.num_dropped(), 0);
+}
+
+TEST(AsyncRecordWriterTest, DropsRecordsWhenTheQueueIsFull) {
+  RecordCollector collector(/*block_first_batch=*/true);
+  AsyncRecordWriterOptions options;
+  options.max_queued_records = 2;
+  options.overflow_policy = AsyncRecordWriterOptions::OverflowPolicy::kDrop;
+  AsyncRecordWriter writer(Env::Default(), "test_writer", options,
+                           collector.BatchWriter());
+  EXPECT_TRUE(writer.Write("a"));
+  // The writer thread has taken "a" off the queue.
+  collector.WaitUntilStarted();
+  EXPECT_TRUE(writer.Write("b"));
+  EXPECT_TRUE(writer.Write("c"));
+  EXPECT_FALSE(writer.Write("d"));
+  EXPECT_EQ(writer.num_dropped(), 1);
+
+  collector.Unblock();
+  writer.Drain();
+  EXPECT_EQ(collector.records(), std::vector<std::string>({"a", "b", "c"}));
+}
+
+TEST(AsyncRecordWriterTest, BlocksWhenTheQueueIsFull) {
+  RecordCollector collector(/*block_first_batch=*/true);
+  AsyncRecordWriterOptions options;
+  options.max_queued_records = 2;
+  AsyncRecordWriter writer(Env::Default(), "test_writer", options,
+                           collector.BatchWriter());
+  EXPECT_TRUE(writer.Write("a"));
+  collector.WaitUntilStarted();
+  EXPECT_TRUE(writer.Write("b"));
+  EXPECT_TRUE(writer.Write("c"));
+
+  std::atomic<bool> written(false);
+  std::unique_ptr<Thread> producer(
+      Env::Default()->StartThread(ThreadOptions(), "producer", [&] {
+        EXPECT_TRUE(writer.Write("d"));
+        written = true;
+      }));
+  Env::Default()->SleepForMicroseconds(10000);
+  EXPECT_FALSE(written);
+
+  collector.Unblock();
+  producer.reset();
+  EXPECT_TRUE(written);
+  writer.Drain();
+  EXPECT_EQ(collector.records(),
+            std::vector<std::string>({"a", "b", "c", "d"}));
+  EXPECT_EQ(writer.num_dropped(), 0);
+}
+
+TEST(AsyncRecordWriterTest, WritesTheQueuedRecordsOnDestruction) {
+  RecordCollector collector(/*block_first_batch=*/true);
+  {
+    AsyncRecordWriter writer(Env::Default(), "test_writer",
+                             AsyncRecordWriterOptions(),
+                             collector.BatchWriter());
+    writer.Write("a");
+    collector.WaitUntilStarted();
+    writer.Write("b");
+    collector.Unblock();
+  }
+  EXPECT_EQ(collector.records(), std::vector<std::string>({"a", "b"}));
+}
+
+}  // namespace
+}  // namespace tensorflow
@@ -17,6 +17,8 @@ limitations under the License.
 
 #include <deque>
 #include <memory>
+#include <optional>
+#include <string>
 #include <unordered_map>
 #include <utility>
 #include <vector>
@@ -26,6 +28,7 @@ limitations under the License.
 #include "tensorflow/core/lib/strings/stringprintf.h"
 #include "tensorflow/core/platform/host_info.h"
 #include "tensorflow/core/public/version.h"
+#include "tensorflow/core/util/async_record_writer.h"
 
 namespace tensorflow {
 namespace tfdbg {
@@ -44,6 +47,26 @@ SingleDebugEventFileWriter::SingleDebugEventFileWriter(const string& file_path)
       num_outstanding_events_(0),
       writer_mu_() {}
 
+SingleDebugEventFileWriter::SingleDebugEventFileWriter(
+    const string& file_path, const AsyncRecordWriterOptions& async_options)
+    : SingleDebugEventFileWriter(file_path) {
+  async_writer_ = std::make_unique<AsyncRecordWriter>(
+      env_, "debug_events_writer", async_options,
+      [this](std::vector<std::string>* records) {
+        if (record_writer_ == nullptr) {
+          if (!Init().ok()) {
+            LOG(ERROR) << "Write failed because file could not be opened.";
+            return;
+          }
+        }
+        num_outstanding_events_.fetch_add(records->size());
+        mutex_lock l(writer_mu_);
+        for (const std::string& record : *records) {
+          record_writer_->WriteRecord(record).IgnoreError();
+        }
+      });
+}
+
 Status SingleDebugEventFileWriter::Init() {
   if (record_writer_ != nullptr) {
     // TODO(cais): We currently don't check for file deletion. When the need
@@ -70,6 +93,10 @@ Status SingleDebugEventFileWriter::Init() {
 
 void SingleDebugEventFileWriter::WriteSerializedDebugEvent(
     StringPiece debug_event_str) {
+  if (async_writer_ != nullptr) {
+    async_writer_->Write(string(debug_event_str));
+    return;
+  }
   if (record_writer_ == nullptr) {
     if (!Init().ok()) {
       LOG(ERROR) << "Write failed because file could not be opened.";
@@ -84,6 +111,7 @@ void SingleDebugEventFileWriter::WriteSerializedDebugEvent(
 }
 
 Status SingleDebugEventFileWriter::Flush() {
+  if (async_writer_ != nullptr) async_writer_->Drain();
   const int num_outstanding = num_outstanding_events_.load();
   if (num_outstanding == 0) {
     return absl::OkStatus();
@@ -134,8 +162,24 @@ DebugEventsWriter* DebugEventsWriter::GetDebugEventsWriter(
   std::unordered_map<string, std::unique_ptr<DebugEventsWriter>>* writer_pool =
       DebugEventsWriter::GetDebugEventsWriterMap();
   if (writer_pool->find(dump_root) == writer_pool->end()) {
-    std::unique_ptr<DebugEventsWriter> writer(
-        new DebugEventsWriter(dump_root, tfdbg_run_id, circular_buffer_size));
+    std::unique_ptr<DebugEventsWriter> writer(new DebugEventsWriter(
+        dump_root, tfdbg_run_id, circular_buffer_size, std::nullopt));
+    writer_pool->insert(std::make_pair(dump_root, std::move(writer)));
+  }
+  return (*writer_pool)[dump_root].get();
+}
+
+// static
+DebugEventsWriter* DebugEventsWriter::GetDebugEventsWriter(
+    const string& dump_root, const string& tfdbg_run_id,
+    int64_t circular_buffer_size,
+    const AsyncRecordWriterOptions& async_options) {
+  mutex_lock l(DebugEventsWriter::factory_mu_);
+  std::unordered_map<string, std::unique_ptr<DebugEventsWriter>>* writer_pool =
+      DebugEventsWriter::GetDebugEventsWriterMap();
+  if (writer_pool->find(dump_root) == writer_pool->end()) {
+    std::unique_ptr<DebugEventsWriter> writer(new DebugEventsWriter(
+        dump_root, tfdbg_run_id, circular_buffer_size, async_options));
     writer_pool->insert(std::make_pair(dump_root, std::move(writer)));
   }
   return (*writer_pool)[dump_root].get();
@@ -481,13 +525,16 @@ DebugEventsWriter::GetDebugEventsWriterMap() {
 
 DebugEventsWriter::DebugEventsWriter(const string& dump_root,
                                      const string& tfdbg_run_id,
-                                     int64_t circular_buffer_size)
+                                     int64_t circular_buffer_size,
+                                     std::optional<AsyncRecordWriterOptions>
+                                         async_options)
     : env_(Env::Default()),
       dump_root_(dump_root),
       tfdbg_run_id_(tfdbg_run_id),
       is_initialized_(false),
       initialization_mu_(),
       circular_buffer_size_(circular_buffer_size),
+      async_options_(async_options),
       execution_buffer_(),
       execution_buffer_mu_(),
       graph_execution_trace_buffer_(),
@@ -501,7 +548,12 @@ Status DebugEventsWriter::InitNonMetadataFile(DebugEventFileType type) {
   const string filename = GetFileNameInternal(type);
   writer->reset();
 
-  *writer = std::make_unique<SingleDebugEventFileWriter>(filename);
+  if (async_options_.has_value()) {
+    *writer =
+        std::make_unique<SingleDebugEventFileWriter>(filename, *async_options_);
+  } else {
+    *writer = std::make_unique<SingleDebugEventFileWriter>(filename);
+  }
   if (*writer == nullptr) {
     return errors::Unknown("Could not create debug event file writer for ",
                            filename);
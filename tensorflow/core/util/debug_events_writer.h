@@ -19,6 +19,7 @@ limitations under the License.
 #include <atomic>
 #include <deque>
 #include <memory>
+#include <optional>
 #include <unordered_map>
 
 #include "absl/container/flat_hash_map.h"
@@ -29,6 +30,7 @@ limitations under the License.
 #include "tensorflow/core/platform/macros.h"
 #include "tensorflow/core/platform/types.h"
 #include "tensorflow/core/protobuf/debug_event.pb.h"
+#include "tensorflow/core/util/async_record_writer.h"
 
 namespace tensorflow {
 namespace tfdbg {
@@ -50,6 +52,9 @@ enum DebugEventFileType {
 class SingleDebugEventFileWriter {
  public:
   explicit SingleDebugEventFileWriter(const string& file_path);
+  // The events are written to the file in batches by a background thread.
+  SingleDebugEventFileWriter(const string& file_path,
+                             const AsyncRecordWriterOptions& async_options);
 
   Status Init();
 
@@ -68,6 +73,9 @@ class SingleDebugEventFileWriter {
   std::unique_ptr<WritableFile> writable_file_;
   std::unique_ptr<io::RecordWriter> record_writer_ TF_PT_GUARDED_BY(writer_mu_);
   mutex writer_mu_;
+  // Only set in the asynchronous mode. Last, so that its thread is joined
+  // before the file is destroyed.
+  std::unique_ptr<AsyncRecordWriter> async_writer_;
 };
 
 // The DebugEvents writer class.
@@ -111,6 +119,15 @@ class DebugEventsWriter {
   static DebugEventsWriter* GetDebugEventsWriter(const string& dump_root,
                                                  const string& tfdbg_run_id,
                                                  int64_t circular_buffer_size);
+  // Like the above, but a newly created writer writes the DebugEvents of all
+  // the files but the metadata one in background threads, so that the Write*()
+  // methods do not wait for the file system. `async_options` sets what they do
+  // when too many DebugEvents are waiting. FlushNonExecutionFiles() and
+  // FlushExecutionFiles() wait for the DebugEvents to be written.
+  static DebugEventsWriter* GetDebugEventsWriter(
+      const string& dump_root, const string& tfdbg_run_id,
+      int64_t circular_buffer_size,
+      const AsyncRecordWriterOptions& async_options);
   // Look up existing events writer by dump_root.
   // If no DebugEventsWriter has been created at the dump_root, a non-OK
   // Status will be returned. Else an OK status will be returned, with
@@ -221,7 +238,8 @@ class DebugEventsWriter {
   static mutex factory_mu_;
 
   DebugEventsWriter(const string& dump_root, const string& tfdbg_run_id,
-                    int64_t circular_buffer_size);
+                    int64_t circular_buffer_size,
+                    std::optional<AsyncRecordWriterOptions> async_options);
 
   // Get the path prefix. The same for all files, which differ only in the
   // suffix.
@@ -247,6 +265,8 @@ class DebugEventsWriter {
   mutex initialization_mu_;
 
   const int64_t circular_buffer_size_;
+  // Set if the non-metadata files are written asynchronously.
+  const std::optional<AsyncRecordWriterOptions> async_options_;
   std::deque<string> execution_buffer_ TF_GUARDED_BY(execution_buffer_mu_);
   mutex execution_buffer_mu_;
   std::deque<string> graph_execution_trace_buffer_
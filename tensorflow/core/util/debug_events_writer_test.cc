@@ -886,5 +886,43 @@ TEST_F(DebugEventsWriterTest, DisableCyclicBufferBehavior) {
   TF_ASSERT_OK(writer->Close());
 }
 
+TEST_F(DebugEventsWriterTest, WriteAsynchronously) {
+  AsyncRecordWriterOptions async_options;
+  async_options.max_queued_records = 4;
+  DebugEventsWriter* writer = DebugEventsWriter::GetDebugEventsWriter(
+      dump_root_, tfdbg_run_id_, /*circular_buffer_size=*/0, async_options);
+  TF_ASSERT_OK(writer->Init());
+
+  const size_t kNumEvents = 20;
+  for (size_t i = 0; i < kNumEvents; ++i) {
+    Execution* execution = new Execution();
+    execution->set_op_type("Log");
+    execution->add_input_tensor_ids(i);
+    TF_ASSERT_OK(writer->WriteExecution(execution));
+
+    SourceFile* source_file = new SourceFile();
+    source_file->set_file_path(strings::Printf("/home/tf_programs/%ld.py", i));
+    TF_ASSERT_OK(writer->WriteSourceFile(source_file));
+  }
+  TF_ASSERT_OK(writer->FlushExecutionFiles());
+  TF_ASSERT_OK(writer->FlushNonExecutionFiles());
+
+  std::vector<DebugEvent> actuals;
+  ReadDebugEventProtos(writer, DebugEventFileType::EXECUTION, &actuals);
+  ASSERT_EQ(actuals.size(), kNumEvents);
+  for (size_t i = 0; i < kNumEvents; ++i) {
+    EXPECT_EQ(actuals[i].execution().input_tensor_ids()[0], i);
+  }
+  ReadDebugEventProtos(writer, DebugEventFileType::SOURCE_FILES, &actuals);
+  ASSERT_EQ(actuals.size(), kNumEvents);
+  for (size_t i = 0; i < kNumEvents; ++i) {
+    EXPECT_EQ(actuals[i].source_file().file_path(),
+              strings::Printf("/home/tf_programs/%ld.py", i));
+  }
+
+  // Close the writer so the files can be safely deleted.
+  TF_ASSERT_OK(writer->Close());
+}
+
 }  // namespace tfdbg
 }  // namespace tensorflow
@@ -18,6 +18,8 @@ limitations under the License.
 #include <stddef.h>  // for NULL
 
 #include <memory>
+#include <string>
+#include <vector>
 
 #include "tensorflow/core/lib/core/errors.h"
 #include "tensorflow/core/lib/core/status.h"
@@ -27,7 +29,9 @@ limitations under the License.
 #include "tensorflow/core/platform/env.h"
 #include "tensorflow/core/platform/host_info.h"
 #include "tensorflow/core/platform/logging.h"
+#include "tensorflow/core/platform/mutex.h"
 #include "tensorflow/core/platform/types.h"
+#include "tensorflow/core/util/async_record_writer.h"
 #include "tensorflow/core/util/event.pb.h"
 
 namespace tensorflow {
@@ -38,6 +42,19 @@ EventsWriter::EventsWriter(const string& file_prefix)
       file_prefix_(file_prefix),
       num_outstanding_events_(0) {}
 
+EventsWriter::EventsWriter(const string& file_prefix,
+                           const AsyncRecordWriterOptions& async_options)
+    : EventsWriter(file_prefix) {
+  async_writer_ = std::make_unique<AsyncRecordWriter>(
+      env_, "events_writer", async_options,
+      [this](std::vector<std::string>* records) {
+        mutex_lock l(mu_);
+        for (const std::string& record : *records) {
+          WriteSerializedEventLocked(record);
+        }
+      });
+}
+
 EventsWriter::~EventsWriter() {
   Close().IgnoreError();  // Autoclose in destructor.
 }
@@ -45,6 +62,7 @@ EventsWriter::~EventsWriter() {
 Status EventsWriter::Init() { return InitWithSuffix(""); }
 
 Status EventsWriter::InitWithSuffix(const string& suffix) {
+  mutex_lock l(mu_);
   file_suffix_ = suffix;
   return InitIfNeeded();
 }
@@ -93,13 +111,16 @@ Status EventsWriter::InitIfNeeded() {
     event.set_file_version(strings::StrCat(kVersionPrefix, kCurrentVersion));
     SourceMetadata* source_metadata = event.mutable_source_metadata();
     source_metadata->set_writer(kWriterSourceMetadata);
-    WriteEvent(event);
-    TF_RETURN_WITH_CONTEXT_IF_ERROR(Flush(), "Flushing first event.");
+    string record;
+    event.AppendToString(&record);
+    WriteSerializedEventLocked(record);
+    TF_RETURN_WITH_CONTEXT_IF_ERROR(FlushLocked(), "Flushing first event.");
   }
   return absl::OkStatus();
 }
 
 string EventsWriter::FileName() {
+  mutex_lock l(mu_);
   if (filename_.empty()) {
     InitIfNeeded().IgnoreError();
   }
@@ -107,6 +128,15 @@ string EventsWriter::FileName() {
 }
 
 void EventsWriter::WriteSerializedEvent(StringPiece event_str) {
+  if (async_writer_ != nullptr) {
+    async_writer_->Write(string(event_str));
+    return;
+  }
+  mutex_lock l(mu_);
+  WriteSerializedEventLocked(event_str);
+}
+
+void EventsWriter::WriteSerializedEventLocked(StringPiece event_str) {
   if (recordio_writer_ == nullptr) {
     if (!InitIfNeeded().ok()) {
       LOG(ERROR) << "Write failed because file could not be opened.";
@@ -126,6 +156,12 @@ void EventsWriter::WriteEvent(const Event& event) {
 }
 
 Status EventsWriter::Flush() {
+  if (async_writer_ != nullptr) async_writer_->Drain();
+  mutex_lock l(mu_);
+  return FlushLocked();
+}
+
+Status EventsWriter::FlushLocked() {
   if (num_outstanding_events_ == 0) return absl::OkStatus();
   CHECK(recordio_file_ != nullptr) << "Unexpected NULL file";
 
@@ -141,7 +177,13 @@ Status EventsWriter::Flush() {
 }
 
 Status EventsWriter::Close() {
-  Status status = Flush();
+  if (async_writer_ != nullptr) async_writer_->Drain();
+  mutex_lock l(mu_);
+  return CloseLocked();
+}
+
+Status EventsWriter::CloseLocked() {
+  Status status = FlushLocked();
   if (recordio_file_ != nullptr) {
     Status close_status = recordio_file_->Close();
     if (!close_status.ok()) {
@@ -154,6 +196,10 @@ Status EventsWriter::Close() {
   return status;
 }
 
+int64_t EventsWriter::num_dropped_events() const {
+  return async_writer_ != nullptr ? async_writer_->num_dropped() : 0;
+}
+
 Status EventsWriter::FileStillExists() {
   if (env_->FileExists(filename_).ok()) {
     return absl::OkStatus();
@@ -23,7 +23,10 @@ limitations under the License.
 #include "tensorflow/core/lib/io/record_writer.h"
 #include "tensorflow/core/platform/env.h"
 #include "tensorflow/core/platform/macros.h"
+#include "tensorflow/core/platform/mutex.h"
+#include "tensorflow/core/platform/thread_annotations.h"
 #include "tensorflow/core/platform/types.h"
+#include "tensorflow/core/util/async_record_writer.h"
 #include "tensorflow/core/util/event.pb.h"
 
 namespace tensorflow {
@@ -47,6 +50,11 @@ class EventsWriter {
   // Note that it is not recommended to simultaneously have two
   // EventWriters writing to the same file_prefix.
   explicit EventsWriter(const std::string& file_prefix);
+  // Like the above, but the events are written to the file by a background
+  // thread, in batches: Write*() only serialize and queue the event, and
+  // `async_options` sets what they do when the queue is full.
+  EventsWriter(const std::string& file_prefix,
+               const AsyncRecordWriterOptions& async_options);
   ~EventsWriter();
 
   // Sets the event file filename and opens file for writing.  If not called by
@@ -78,20 +86,37 @@ class EventsWriter {
   // be written too.
   //   Close() calls Flush() and then closes the current events file.
   // Returns true only if both the flush and the closure were successful.
+  // In the asynchronous mode, both first wait for the queued events to be
+  // written.
   Status Flush();
   Status Close();
 
+  // The number of events dropped because the queue of the asynchronous mode
+  // was full.
+  int64_t num_dropped_events() const;
+
  private:
-  Status FileStillExists();  // OK if event_file_path_ exists.
-  Status InitIfNeeded();
+  // OK if event_file_path_ exists.
+  Status FileStillExists() TF_EXCLUSIVE_LOCKS_REQUIRED(mu_);
+  Status InitIfNeeded() TF_EXCLUSIVE_LOCKS_REQUIRED(mu_);
+  void WriteSerializedEventLocked(tensorflow::StringPiece event_str)
+      TF_EXCLUSIVE_LOCKS_REQUIRED(mu_);
+  Status FlushLocked() TF_EXCLUSIVE_LOCKS_REQUIRED(mu_);
+  Status CloseLocked() TF_EXCLUSIVE_LOCKS_REQUIRED(mu_);
 
   Env* env_;
   const std::string file_prefix_;
-  std::string file_suffix_;
-  std::string filename_;
-  std::unique_ptr<WritableFile> recordio_file_;
-  std::unique_ptr<io::RecordWriter> recordio_writer_;
-  int num_outstanding_events_;
+  // Guards the file, which the background thread of the asynchronous mode
+  // writes concurrently with the calls of the user.
+  mutex mu_;
+  std::string file_suffix_ TF_GUARDED_BY(mu_);
+  std::string filename_ TF_GUARDED_BY(mu_);
+  std::unique_ptr<WritableFile> recordio_file_ TF_GUARDED_BY(mu_);
+  std::unique_ptr<io::RecordWriter> recordio_writer_ TF_GUARDED_BY(mu_);
+  int num_outstanding_events_ TF_GUARDED_BY(mu_);
+  // Only set in the asynchronous mode. Last, so that its thread is joined
+  // before the file is destroyed.
+  std::unique_ptr<AsyncRecordWriter> async_writer_;
 #ifndef SWIG
   EventsWriter(const EventsWriter&) = delete;
   void operator=(const EventsWriter&) = delete;
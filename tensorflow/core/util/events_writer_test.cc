@@ -209,5 +209,51 @@ TEST(EventWriter, FileDeletionBeforeWriting) {
   VerifyFile(filename1);
 }
 
+TEST(EventWriter, AsyncWriteFlush) {
+  string file_prefix = GetDirName("/asyncwriteflush_test");
+  EventsWriter writer(file_prefix, AsyncRecordWriterOptions());
+  WriteFile(&writer);
+  TF_EXPECT_OK(writer.Flush());
+  string filename = writer.FileName();
+  VerifyFile(filename);
+}
+
+TEST(EventWriter, AsyncWriteDelete) {
+  string file_prefix = GetDirName("/asyncwritedelete_test");
+  EventsWriter* writer =
+      new EventsWriter(file_prefix, AsyncRecordWriterOptions());
+  WriteFile(writer);
+  string filename = writer->FileName();
+  delete writer;
+  VerifyFile(filename);
+}
+
+TEST(EventWriter, AsyncWriteManyEvents) {
+  string file_prefix = GetDirName("/asyncwritemany_test");
+  AsyncRecordWriterOptions options;
+  options.max_queued_records = 16;
+  EventsWriter writer(file_prefix, options);
+  for (int i = 0; i < 1000; ++i) {
+    WriteSimpleValue(&writer, 1234, i, "foo", i);
+  }
+  TF_EXPECT_OK(writer.Close());
+  EXPECT_EQ(writer.num_dropped_events(), 0);
+
+  string filename = writer.FileName();
+  std::unique_ptr<RandomAccessFile> event_file;
+  TF_ASSERT_OK(env()->NewRandomAccessFile(filename, &event_file));
+  io::RecordReader reader(event_file.get());
+  uint64 offset = 0;
+  Event actual;
+  // The version event.
+  ASSERT_TRUE(ReadEventProto(&reader, &offset, &actual));
+  for (int i = 0; i < 1000; ++i) {
+    ASSERT_TRUE(ReadEventProto(&reader, &offset, &actual));
+    EXPECT_EQ(actual.step(), i);
+  }
+  EXPECT_FALSE(ReadEventProto(&reader, &offset, &actual));
+  TF_ASSERT_OK(env()->DeleteFile(filename));
+}
+
 }  // namespace
 }  // namespace tensorflow
@@ -15,12 +15,14 @@ limitations under the License.
 #include "tensorflow/core/util/example_proto_fast_parsing.h"
 
 #include <algorithm>
+#include <cstring>
 #include <functional>
 #include <optional>
 #include <utility>
 #include <vector>
 
 #include "absl/base/casts.h"
+#include "absl/numeric/bits.h"
 #include "absl/container/flat_hash_map.h"
 #include "tensorflow/core/example/example.pb.h"
 #include "tensorflow/core/example/feature.pb.h"
@@ -117,6 +119,77 @@ constexpr uint8 kVarintTag(uint32 tag) { return (tag << 3) | 0; }
 constexpr uint8 kDelimitedTag(uint32 tag) { return (tag << 3) | 2; }
 constexpr uint8 kFixed32Tag(uint32 tag) { return (tag << 3) | 5; }
 
+// Returns a pointer to the next `size` bytes of `stream`, or nullptr if they
+// are not in its buffer. Streams over flat arrays, like the ones used here,
+// have all of their remaining bytes in their buffer.
+const uint8* PeekRaw(protobuf::io::CodedInputStream* stream, uint32 size) {
+  const void* ptr;
+  int available;
+  if (!stream->GetDirectBufferPointer(&ptr, &available) ||
+      static_cast<uint32>(available) < size) {
+    return nullptr;
+  }
+  return static_cast<const uint8*>(ptr);
+}
+
+// The continuation bits of eight varint bytes.
+constexpr uint64 kVarintContinuationBits = 0x8080808080808080ULL;
+
+// Returns the number of varints that end in data[0, size), i.e. the number of
+// bytes without a continuation bit. The bytes are tested eight at a time.
+size_t CountVarints(const uint8* data, size_t size) {
+  size_t count = 0;
+  size_t i = 0;
+  for (; i + sizeof(uint64) <= size; i += sizeof(uint64)) {
+    uint64 bytes;
+    std::memcpy(&bytes, data + i, sizeof(bytes));
+    count += absl::popcount(~bytes & kVarintContinuationBits);
+  }
+  for (; i < size; ++i) {
+    count += data[i] < 0x80;
+  }
+  return count;
+}
+
+// Decodes the varints in data[0, size), storing the first `max_values` of them
+// in `out`. Runs of eight single-byte varints, which are common in feature
+// lists of small values, are decoded at once. Returns false if the data ends
+// in the middle of a varint or a varint is longer than ten bytes.
+bool DecodeVarints(const uint8* data, size_t size, int64_t* out,
+                   size_t max_values) {
+  const uint8* const end = data + size;
+  size_t index = 0;
+  while (data < end) {
+    if (static_cast<size_t>(end - data) >= sizeof(uint64) &&
+        index + sizeof(uint64) <= max_values) {
+      uint64 bytes;
+      std::memcpy(&bytes, data, sizeof(bytes));
+      if ((bytes & kVarintContinuationBits) == 0) {
+        for (size_t i = 0; i < sizeof(uint64); ++i) {
+          out[index + i] = data[i];
+        }
+        data += sizeof(uint64);
+        index += sizeof(uint64);
+        continue;
+      }
+    }
+    uint64 value = 0;
+    int shift = 0;
+    uint8 byte;
+    do {
+      if (data == end || shift >= 64) return false;
+      byte = *data++;
+      value |= static_cast<uint64>(byte & 0x7f) << shift;
+      shift += 7;
+    } while (byte & 0x80);
+    if (index < max_values) {
+      out[index] = static_cast<int64_t>(value);
+    }
+    ++index;
+  }
+  return true;
+}
+
 namespace parsed {
 
 // ParseDataType has to be called first, then appropriate ParseZzzzList.
@@ -303,15 +376,23 @@ class Feature {
         if (!stream.ExpectTag(kDelimitedTag(1))) return false;  // packed tag
         uint32 packed_length;
         if (!stream.ReadVarint32(&packed_length)) return false;
-        auto packed_limit = stream.PushLimit(packed_length);
-
-        while (!stream.ExpectAtEnd()) {
-          protobuf_uint64 n;  // There is no API for int64
-          if (!stream.ReadVarint64(&n)) return false;
-          int64_list->push_back(static_cast<int64_t>(n));
+        if (packed_length > 0) {
+          const uint8* packed = PeekRaw(&stream, packed_length);
+          if (packed == nullptr) return false;
+
+          // Resize the output once and decode the values straight into it.
+          // As for floats, fewer values than were counted may fit in the
+          // result in case of a LimitedArraySlice.
+          const size_t initial_size = int64_list->size();
+          int64_list->resize(initial_size +
+                             CountVarints(packed, packed_length));
+          if (!DecodeVarints(packed, packed_length,
+                             int64_list->data() + initial_size,
+                             int64_list->size() - initial_size)) {
+            return false;
+          }
+          if (!stream.Skip(packed_length)) return false;
         }
-
-        stream.PopLimit(packed_limit);
       } else {  // non-packed
         while (!stream.ExpectAtEnd()) {
           if (!stream.ExpectTag(kVarintTag(1))) return false;
@@ -539,6 +620,31 @@ void ParallelFor(const std::function<void(size_t)>& f, size_t n,
   }
 }
 
+// Returns the number of minibatches to parse `serialized` in.
+size_t NumMiniBatches(absl::Span<const tstring> serialized) {
+  // This parameter affects performance in a big and data-dependent way.
+  const size_t kMiniBatchSizeBytes = 50000;
+
+  // In main regime make each minibatch around kMiniBatchSizeBytes bytes.
+  // Apply 'special logic' below for small and big regimes.
+  size_t result = 0;
+  size_t minibatch_bytes = 0;
+  for (size_t i = 0; i < serialized.size(); i++) {
+    if (minibatch_bytes == 0) {  // start minibatch
+      result++;
+    }
+    minibatch_bytes += serialized[i].size() + 1;
+    if (minibatch_bytes > kMiniBatchSizeBytes) {
+      minibatch_bytes = 0;
+    }
+  }
+  // 'special logic'
+  const size_t min_minibatches = std::min<size_t>(8, serialized.size());
+  const size_t max_minibatches = 64;
+  return std::max<size_t>(min_minibatches,
+                          std::min<size_t>(max_minibatches, result));
+}
+
 // Enumeration for distinguishing feature types.
 // Note: FastParseSequenceExample constructs a map that includes Type values,
 // and relies on the fact that they are default-initialized to Dense.
@@ -1187,31 +1293,7 @@ Status FastParseExample(const Config& config,
     fixed_dense_values[d] = Tensor(config.dense[d].dtype, out_shape);
   }
 
-  // This parameter affects performance in a big and data-dependent way.
-  const size_t kMiniBatchSizeBytes = 50000;
-
-  // Calculate number of minibatches.
-  // In main regime make each minibatch around kMiniBatchSizeBytes bytes.
-  // Apply 'special logic' below for small and big regimes.
-  const size_t num_minibatches = [&] {
-    size_t result = 0;
-    size_t minibatch_bytes = 0;
-    for (size_t i = 0; i < serialized.size(); i++) {
-      if (minibatch_bytes == 0) {  // start minibatch
-        result++;
-      }
-      minibatch_bytes += serialized[i].size() + 1;
-      if (minibatch_bytes > kMiniBatchSizeBytes) {
-        minibatch_bytes = 0;
-      }
-    }
-    // 'special logic'
-    const size_t min_minibatches = std::min<size_t>(8, serialized.size());
-    const size_t max_minibatches = 64;
-    return std::max<size_t>(min_minibatches,
-                            std::min<size_t>(max_minibatches, result));
-  }();
-
+  const size_t num_minibatches = NumMiniBatches(serialized);
   auto first_example_of_minibatch = [&](size_t minibatch) -> size_t {
     return (serialized.size() * minibatch) / num_minibatches;
   };
@@ -1841,13 +1923,18 @@ namespace {
 struct FeatureProtos {
   // Proto substrings from each serialized SequenceExample that correspond
   // with this feature.  `protos_present` records whether the proto had a
-  // value defined (even if that value is empty).
+  // value defined (even if that value is empty). It is not a vector<bool>, so
+  // that the examples can be extracted concurrently.
   std::vector<StringPiece> protos;
-  std::vector<bool> protos_present;
+  std::vector<uint8> protos_present;
 
   // Information derived from protos:
   size_t length;    // total length for ragged/sparse, max row length for dense.
   size_t num_rows;  // only populated for ragged sequence features.
+  // `length` and `num_rows` of each minibatch of examples, before they are
+  // reduced into the fields above.
+  std::vector<size_t> minibatch_lengths;
+  std::vector<size_t> minibatch_num_rows;
 
   // Information from the config:
   Type type;  // Whether this feature is sparse, ragged, or dense.
@@ -1924,18 +2011,27 @@ inline int ParseFloatFeature(protobuf::io::CodedInputStream* stream,
           !stream->ReadVarint32(&packed_length)) {
         return -1;
       }
-      auto packed_limit = stream->PushLimit(packed_length);
-      while (!stream->ExpectAtEnd()) {
-        uint32 buffer32;
-        if (!stream->ReadLittleEndian32(&buffer32)) {
+      if (port::kLittleEndian && packed_length % sizeof(float) == 0) {
+        // The values can be copied straight into the output.
+        num_elements = packed_length / sizeof(float);
+        if (out != nullptr ? !stream->ReadRaw(out, packed_length)
+                           : !stream->Skip(packed_length)) {
           return -1;
         }
-        if (out != nullptr) {
-          *out++ = absl::bit_cast<float>(buffer32);
+      } else {
+        auto packed_limit = stream->PushLimit(packed_length);
+        while (!stream->ExpectAtEnd()) {
+          uint32 buffer32;
+          if (!stream->ReadLittleEndian32(&buffer32)) {
+            return -1;
+          }
+          if (out != nullptr) {
+            *out++ = absl::bit_cast<float>(buffer32);
+          }
+          num_elements++;
         }
-        num_elements++;
+        stream->PopLimit(packed_limit);
       }
-      stream->PopLimit(packed_limit);
     } else if (peek_tag == kFixed32Tag(1)) {
       while (!stream->ExpectAtEnd()) {
         uint32 buffer32;
@@ -1975,18 +2071,21 @@ inline int ParseInt64Feature(protobuf::io::CodedInputStream* stream,
           !stream->ReadVarint32(&packed_length)) {
         return -1;
       }
-      auto packed_limit = stream->PushLimit(packed_length);
-      while (!stream->ExpectAtEnd()) {
-        protobuf_uint64 n;  // There is no API for int64
-        if (!stream->ReadVarint64(&n)) {
+      if (packed_length > 0) {
+        const uint8* packed = PeekRaw(stream, packed_length);
+        // The last varint must end with the packed values.
+        if (packed == nullptr || packed[packed_length - 1] >= 0x80) {
           return -1;
         }
-        if (out != nullptr) {
-          *out++ = n;
+        num_elements = CountVarints(packed, packed_length);
+        if (out != nullptr &&
+            !DecodeVarints(packed, packed_length, out, num_elements)) {
+          return -1;
+        }
+        if (!stream->Skip(packed_length)) {
+          return -1;
         }
-        num_elements++;
       }
-      stream->PopLimit(packed_limit);
     } else if (peek_tag == kVarintTag(1)) {
       while (!stream->ExpectAtEnd()) {
         protobuf_uint64 n;  // There is no API for int64
@@ -2093,11 +2192,15 @@ inline bool SkipEmptyFeature(protobuf::io::CodedInputStream* stream,
 }
 
 // Reads an example proto, and extracts a StringPiece pointer to each feature.
+// Populates the protos of `context_features` and `sequence_features` for the
+// examples in [first_example, end_example). The ranges of examples can be
+// extracted concurrently.
 Status ExtractFeaturesFromSequenceExamples(
     const absl::Span<const tstring> examples,
-    const absl::Span<const tstring> example_names,
-    FeatureProtosMap* context_features, FeatureProtosMap* sequence_features) {
-  for (int d = 0; d < examples.size(); d++) {
+    const absl::Span<const tstring> example_names, size_t first_example,
+    size_t end_example, FeatureProtosMap* context_features,
+    FeatureProtosMap* sequence_features) {
+  for (int d = first_example; d < end_example; d++) {
     const tstring& example = examples[d];
     protobuf::io::CodedInputStream stream(
         reinterpret_cast<const uint8*>(example.data()), example.size());
@@ -2160,13 +2263,17 @@ Status ExtractFeaturesFromSequenceExamples(
   return absl::OkStatus();
 }
 
-// Populates context_features[k].length based on context_features[k].protos
-// (for all k).
+// Populates context_features[k].minibatch_lengths[minibatch] based on
+// context_features[k].protos[first_example:end_example] (for all k). The
+// minibatches can be scanned concurrently.
 Status GetContextFeatureLengths(const absl::Span<const tstring> example_names,
+                                size_t first_example, size_t end_example,
+                                size_t minibatch,
                                 FeatureProtosMap* context_features) {
   for (auto& c : *context_features) {
     FeatureProtos& feature = c.second;
-    for (int d = 0; d < feature.protos.size(); ++d) {
+    size_t& length = feature.minibatch_lengths[minibatch];
+    for (int d = first_example; d < end_example; ++d) {
       const auto& proto = feature.protos[d];
       if (proto.empty()) continue;
       protobuf::io::CodedInputStream stream(
@@ -2183,11 +2290,10 @@ Status GetContextFeatureLengths(const absl::Span<const tstring> example_names,
       switch (feature.type) {
         case Type::Sparse:  // intentional fall-through
         case Type::Ragged:
-          feature.length += num_elements;
+          length += num_elements;
           break;
         case Type::Dense:
-          feature.length =
-              std::max(feature.length, static_cast<size_t>(num_elements));
+          length = std::max(length, static_cast<size_t>(num_elements));
           break;
       }
     }
@@ -2195,13 +2301,19 @@ Status GetContextFeatureLengths(const absl::Span<const tstring> example_names,
   return absl::OkStatus();
 }
 
-// Populates sequence_features[k].length and sequence_features[k].num_rows based
-// on sequence_features[k].protos (for all k).
+// Populates sequence_features[k].minibatch_lengths[minibatch] and
+// sequence_features[k].minibatch_num_rows[minibatch] based on
+// sequence_features[k].protos[first_example:end_example] (for all k). The
+// minibatches can be scanned concurrently.
 Status GetSequenceFeatureLengths(const absl::Span<const tstring> example_names,
+                                 size_t first_example, size_t end_example,
+                                 size_t minibatch,
                                  FeatureProtosMap* sequence_features) {
   for (auto& c : *sequence_features) {
     FeatureProtos& feature = c.second;
-    for (int d = 0; d < feature.protos.size(); ++d) {
+    size_t& length = feature.minibatch_lengths[minibatch];
+    size_t& total_num_rows = feature.minibatch_num_rows[minibatch];
+    for (int d = first_example; d < end_example; ++d) {
       const auto& proto = feature.protos[d];
       if (proto.empty()) continue;
 
@@ -2247,14 +2359,14 @@ Status GetSequenceFeatureLengths(const absl::Span<const tstring> example_names,
       }
       switch (feature.type) {
         case Type::Sparse:
-          feature.length += num_elements;
+          length += num_elements;
           break;
         case Type::Ragged:
-          feature.length += num_elements;
-          feature.num_rows += num_rows;
+          length += num_elements;
+          total_num_rows += num_rows;
           break;
         case Type::Dense:
-          feature.length = std::max(feature.length, num_elements);
+          length = std::max(length, num_elements);
           break;
       }
     }
@@ -2262,6 +2374,24 @@ Status GetSequenceFeatureLengths(const absl::Span<const tstring> example_names,
   return absl::OkStatus();
 }
 
+// Reduces the minibatch lengths and numbers of rows of `features` into their
+// length and num_rows.
+void ReduceFeatureLengths(FeatureProtosMap* features) {
+  for (auto& c : *features) {
+    FeatureProtos& feature = c.second;
+    for (const size_t length : feature.minibatch_lengths) {
+      if (feature.type == Type::Dense) {
+        feature.length = std::max(feature.length, length);
+      } else {
+        feature.length += length;
+      }
+    }
+    for (const size_t num_rows : feature.minibatch_num_rows) {
+      feature.num_rows += num_rows;
+    }
+  }
+}
+
 // Copies src into dst[dst_offset:dst_offset+src.size], and then increments
 // dst_offset by src.size.
 void CopyTensorIntoTensor(DataType dtype, const Tensor& src, Tensor* dst,
@@ -2292,431 +2422,288 @@ void CopyTensorIntoTensor(DataType dtype, const Tensor& src, Tensor* dst,
   *dst_offset += src_size;
 }
 
-// Parses dense features in `context_features`, and writes their parsed
+// Parses the dense feature `t` in `context_features`, and writes its parsed
 // values to `context_results`.
-Status ParseContextDenseFeatures(const FeatureProtosMap& context_features,
-                                 const FastParseExampleConfig& context_config,
-                                 absl::Span<const tstring> example_names,
-                                 bool is_batch, int num_examples,
-                                 Allocator* allocator, Result* context_result) {
-  for (int t = 0; t < context_config.dense.size(); ++t) {
-    const auto& c = context_config.dense[t];
-    const FeatureProtos& feature =
-        context_features.find(c.feature_name)->second;
-    TensorShape dense_shape, example_shape;
-    DataType dtype = c.dtype;
-    const size_t data_max_elements = feature.length;
-    if (!c.shape.AsTensorShape(&example_shape) ||
-        data_max_elements != example_shape.num_elements()) {
-      return errors::InvalidArgument(
-          "Inconsistent max number of elements for feature ", c.feature_name,
-          ": expected ", example_shape.num_elements(), ", but found ",
-          data_max_elements);
-    }
-    if (is_batch) {
-      dense_shape.AddDim(num_examples);
-    }
-    for (const int dim : c.shape.dim_sizes()) {
-      dense_shape.AddDim(dim);
-    }
-    context_result->dense_values[t] = Tensor(allocator, dtype, dense_shape);
+Status ParseContextDenseFeature(const FeatureProtosMap& context_features,
+                                const FastParseExampleConfig& context_config,
+                                int t, absl::Span<const tstring> example_names,
+                                bool is_batch, int num_examples,
+                                Allocator* allocator, Result* context_result) {
+  const auto& c = context_config.dense[t];
+  const FeatureProtos& feature = context_features.find(c.feature_name)->second;
+  TensorShape dense_shape, example_shape;
+  DataType dtype = c.dtype;
+  const size_t data_max_elements = feature.length;
+  if (!c.shape.AsTensorShape(&example_shape) ||
+      data_max_elements != example_shape.num_elements()) {
+    return errors::InvalidArgument(
+        "Inconsistent max number of elements for feature ", c.feature_name,
+        ": expected ", example_shape.num_elements(), ", but found ",
+        data_max_elements);
+  }
+  if (is_batch) {
+    dense_shape.AddDim(num_examples);
+  }
+  for (const int dim : c.shape.dim_sizes()) {
+    dense_shape.AddDim(dim);
+  }
+  context_result->dense_values[t] = Tensor(allocator, dtype, dense_shape);
 
-    Tensor& out = context_result->dense_values[t];
-    size_t out_offset = 0;
+  Tensor& out = context_result->dense_values[t];
+  size_t out_offset = 0;
 
-    // Fill in the values.
-    for (int e = 0; e < num_examples; e++) {
-      size_t num_elements = 0;
-      const auto& feature_proto = feature.protos[e];
-      if (!feature.protos_present[e]) {
-        // Copy the default value, if present. If not, return an error.
-        if (c.default_value.NumElements() == 0) {
-          return errors::InvalidArgument(
-              "Feature: ", c.feature_name,
-              " (data type: ", DataTypeString(c.dtype), ")",
-              " is required but could not be found.");
-        }
-        CopyTensorIntoTensor(dtype, c.default_value, &out, &out_offset);
-        num_elements += c.default_value.NumElements();
-      } else if (!feature_proto.empty()) {
-        protobuf::io::CodedInputStream stream(
-            reinterpret_cast<const uint8*>(feature_proto.data()),
-            feature_proto.size());
-        EnableAliasing(&stream);
-        num_elements += ParseFeature(dtype, &stream, &out, &out_offset);
-      }
-      if (num_elements != data_max_elements) {
+  // Fill in the values.
+  for (int e = 0; e < num_examples; e++) {
+    size_t num_elements = 0;
+    const auto& feature_proto = feature.protos[e];
+    if (!feature.protos_present[e]) {
+      // Copy the default value, if present. If not, return an error.
+      if (c.default_value.NumElements() == 0) {
         return errors::InvalidArgument(
-            "Unexpected number of elements in example ",
-            ExampleName(example_names, e));
+            "Feature: ", c.feature_name,
+            " (data type: ", DataTypeString(c.dtype), ")",
+            " is required but could not be found.");
       }
-    }
-  }
-  return absl::OkStatus();
-}
-
-// Parses sparse features in `context_features`, and writes their parsed
-// values to `context_results`.
-Status ParseContextSparseFeatures(const FeatureProtosMap& context_features,
-                                  const FastParseExampleConfig& context_config,
-                                  absl::Span<const tstring> example_names,
-                                  bool is_batch, int num_examples,
-                                  Allocator* allocator,
-                                  Result* context_result) {
-  for (int t = 0; t < context_config.sparse.size(); ++t) {
-    const auto& c = context_config.sparse[t];
-    const FeatureProtos& feature =
-        context_features.find(c.feature_name)->second;
-    TensorShape indices_shape, values_shape;
-    DataType dtype = c.dtype;
-    size_t expected_num_elements = feature.length;
-    indices_shape.AddDim(expected_num_elements);
-    indices_shape.AddDim(is_batch ? 2 : 1);
-    values_shape.AddDim(expected_num_elements);
-    context_result->sparse_indices[t] =
-        Tensor(allocator, DT_INT64, indices_shape);
-    context_result->sparse_values[t] = Tensor(allocator, dtype, values_shape);
-    context_result->sparse_shapes[t] =
-        Tensor(allocator, DT_INT64, TensorShape({is_batch ? 2 : 1}));
-    Tensor& out_values = context_result->sparse_values[t];
-    size_t out_values_offset = 0;
-    int64_t* out_indices =
-        context_result->sparse_indices[t].flat<int64_t>().data();
-    auto out_shape = context_result->sparse_shapes[t].vec<int64_t>();
-
-    // Fill in the values.
-    size_t num_elements = 0;
-    size_t max_num_cols = 0;
-    for (int e = 0; e < num_examples; e++) {
-      const auto& feature_proto = feature.protos[e];
-      if (feature_proto.empty()) continue;
+      CopyTensorIntoTensor(dtype, c.default_value, &out, &out_offset);
+      num_elements += c.default_value.NumElements();
+    } else if (!feature_proto.empty()) {
       protobuf::io::CodedInputStream stream(
           reinterpret_cast<const uint8*>(feature_proto.data()),
           feature_proto.size());
       EnableAliasing(&stream);
-      size_t num_added =
-          ParseFeature(dtype, &stream, &out_values, &out_values_offset);
-      num_elements += num_added;
-      max_num_cols = std::max(max_num_cols, num_added);
-      for (int i = 0; i < num_added; i++) {
-        if (is_batch) *out_indices++ = e;
-        *out_indices++ = i;
-      }
+      num_elements += ParseFeature(dtype, &stream, &out, &out_offset);
     }
-    if (num_elements != expected_num_elements) {
+    if (num_elements != data_max_elements) {
       return errors::InvalidArgument(
-          "Unexpected total number of elements in feature ", c.feature_name);
+          "Unexpected number of elements in example ",
+          ExampleName(example_names, e));
     }
-    if (is_batch) {
-      out_shape(0) = num_examples;
-      out_shape(1) = max_num_cols;
-    } else {
-      out_shape(0) = max_num_cols;
+  }
+  return absl::OkStatus();
+}
+
+// Parses the sparse feature `t` in `context_features`, and writes its parsed
+// values to `context_results`.
+Status ParseContextSparseFeature(const FeatureProtosMap& context_features,
+                                 const FastParseExampleConfig& context_config,
+                                 int t, absl::Span<const tstring> example_names,
+                                 bool is_batch, int num_examples,
+                                 Allocator* allocator, Result* context_result) {
+  const auto& c = context_config.sparse[t];
+  const FeatureProtos& feature = context_features.find(c.feature_name)->second;
+  TensorShape indices_shape, values_shape;
+  DataType dtype = c.dtype;
+  size_t expected_num_elements = feature.length;
+  indices_shape.AddDim(expected_num_elements);
+  indices_shape.AddDim(is_batch ? 2 : 1);
+  values_shape.AddDim(expected_num_elements);
+  context_result->sparse_indices[t] =
+      Tensor(allocator, DT_INT64, indices_shape);
+  context_result->sparse_values[t] = Tensor(allocator, dtype, values_shape);
+  context_result->sparse_shapes[t] =
+      Tensor(allocator, DT_INT64, TensorShape({is_batch ? 2 : 1}));
+  Tensor& out_values = context_result->sparse_values[t];
+  size_t out_values_offset = 0;
+  int64_t* out_indices =
+      context_result->sparse_indices[t].flat<int64_t>().data();
+  auto out_shape = context_result->sparse_shapes[t].vec<int64_t>();
+
+  // Fill in the values.
+  size_t num_elements = 0;
+  size_t max_num_cols = 0;
+  for (int e = 0; e < num_examples; e++) {
+    const auto& feature_proto = feature.protos[e];
+    if (feature_proto.empty()) continue;
+    protobuf::io::CodedInputStream stream(
+        reinterpret_cast<const uint8*>(feature_proto.data()),
+        feature_proto.size());
+    EnableAliasing(&stream);
+    size_t num_added =
+        ParseFeature(dtype, &stream, &out_values, &out_values_offset);
+    num_elements += num_added;
+    max_num_cols = std::max(max_num_cols, num_added);
+    for (int i = 0; i < num_added; i++) {
+      if (is_batch) *out_indices++ = e;
+      *out_indices++ = i;
     }
   }
+  if (num_elements != expected_num_elements) {
+    return errors::InvalidArgument(
+        "Unexpected total number of elements in feature ", c.feature_name);
+  }
+  if (is_batch) {
+    out_shape(0) = num_examples;
+    out_shape(1) = max_num_cols;
+  } else {
+    out_shape(0) = max_num_cols;
+  }
   return absl::OkStatus();
 }
 
-// Parses ragged features in `context_features`, and writes their parsed
+// Parses the ragged feature `t` in `context_features`, and writes its parsed
 // values to `context_results`.
-Status ParseContextRaggedFeatures(const FeatureProtosMap& context_features,
-                                  const FastParseExampleConfig& context_config,
-                                  absl::Span<const tstring> example_names,
-                                  bool is_batch, int num_examples,
-                                  Allocator* allocator,
-                                  Result* context_result) {
-  for (int t = 0; t < context_config.ragged.size(); ++t) {
-    const auto& c = context_config.ragged[t];
-    const FeatureProtos& feature =
-        context_features.find(c.feature_name)->second;
-    TensorShape values_shape, splits_shape;
-    DataType dtype = c.dtype;
-    DataType splits_dtype = c.splits_dtype;
-    size_t expected_num_elements = feature.length;
-    values_shape.AddDim(expected_num_elements);
-    if (is_batch) {
-      splits_shape.AddDim(num_examples + 1);
-    }
-    context_result->ragged_values[t] = Tensor(allocator, dtype, values_shape);
-    context_result->ragged_splits[t] =
-        Tensor(allocator, splits_dtype, splits_shape);
-    Tensor& out_values = context_result->ragged_values[t];
-    size_t out_values_offset = 0;
-    int32* int32_splits =
-        is_batch && splits_dtype == DT_INT32
-            ? context_result->ragged_splits[t].vec<int32>().data()
-            : nullptr;
-    int64_t* int64_splits =
-        is_batch && splits_dtype == DT_INT64
-            ? context_result->ragged_splits[t].vec<int64_t>().data()
-            : nullptr;
+Status ParseContextRaggedFeature(const FeatureProtosMap& context_features,
+                                 const FastParseExampleConfig& context_config,
+                                 int t, absl::Span<const tstring> example_names,
+                                 bool is_batch, int num_examples,
+                                 Allocator* allocator, Result* context_result) {
+  const auto& c = context_config.ragged[t];
+  const FeatureProtos& feature = context_features.find(c.feature_name)->second;
+  TensorShape values_shape, splits_shape;
+  DataType dtype = c.dtype;
+  DataType splits_dtype = c.splits_dtype;
+  size_t expected_num_elements = feature.length;
+  values_shape.AddDim(expected_num_elements);
+  if (is_batch) {
+    splits_shape.AddDim(num_examples + 1);
+  }
+  context_result->ragged_values[t] = Tensor(allocator, dtype, values_shape);
+  context_result->ragged_splits[t] =
+      Tensor(allocator, splits_dtype, splits_shape);
+  Tensor& out_values = context_result->ragged_values[t];
+  size_t out_values_offset = 0;
+  int32* int32_splits =
+      is_batch && splits_dtype == DT_INT32
+          ? context_result->ragged_splits[t].vec<int32>().data()
+          : nullptr;
+  int64_t* int64_splits =
+      is_batch && splits_dtype == DT_INT64
+          ? context_result->ragged_splits[t].vec<int64_t>().data()
+          : nullptr;
+  if (int32_splits) {
+    *int32_splits++ = 0;
+  } else if (int64_splits) {
+    *int64_splits++ = 0;
+  }
+
+  // Fill in the values.
+  size_t split = 0;  // = total number of elements we've seen so far
+  for (int e = 0; e < num_examples; e++) {
+    const auto& feature_proto = feature.protos[e];
+    if (!feature_proto.empty()) {
+      protobuf::io::CodedInputStream stream(
+          reinterpret_cast<const uint8*>(feature_proto.data()),
+          feature_proto.size());
+      EnableAliasing(&stream);
+      size_t num_added =
+          ParseFeature(dtype, &stream, &out_values, &out_values_offset);
+      split += num_added;
+    }
     if (int32_splits) {
-      *int32_splits++ = 0;
+      *int32_splits++ = split;
     } else if (int64_splits) {
-      *int64_splits++ = 0;
-    }
-
-    // Fill in the values.
-    size_t split = 0;  // = total number of elements we've seen so far
-    for (int e = 0; e < num_examples; e++) {
-      const auto& feature_proto = feature.protos[e];
-      if (!feature_proto.empty()) {
-        protobuf::io::CodedInputStream stream(
-            reinterpret_cast<const uint8*>(feature_proto.data()),
-            feature_proto.size());
-        EnableAliasing(&stream);
-        size_t num_added =
-            ParseFeature(dtype, &stream, &out_values, &out_values_offset);
-        split += num_added;
-      }
-      if (int32_splits) {
-        *int32_splits++ = split;
-      } else if (int64_splits) {
-        *int64_splits++ = split;
-      }
+      *int64_splits++ = split;
     }
-    if (split != expected_num_elements) {
+  }
+  if (split != expected_num_elements) {
+    return errors::InvalidArgument(
+        "Unexpected total number of elements in feature ", c.feature_name);
+  }
+  if (int32_splits || int64_splits) {
+    int actual_splits =
+        int32_splits
+            ? int32_splits -
+                  context_result->ragged_splits[t].vec<int32>().data()
+            : int64_splits -
+                  context_result->ragged_splits[t].vec<int64_t>().data();
+    if (actual_splits != num_examples + 1) {
       return errors::InvalidArgument(
-          "Unexpected total number of elements in feature ", c.feature_name);
-    }
-    if (int32_splits || int64_splits) {
-      int actual_splits =
-          int32_splits
-              ? int32_splits -
-                    context_result->ragged_splits[t].vec<int32>().data()
-              : int64_splits -
-                    context_result->ragged_splits[t].vec<int64_t>().data();
-      if (actual_splits != num_examples + 1) {
-        return errors::InvalidArgument(
-            "Unexpected number of examples for feature ", c.feature_name);
-      }
+          "Unexpected number of examples for feature ", c.feature_name);
     }
   }
   return absl::OkStatus();
 }
 
-// Parses dense features in `sequence_features`, and writes their parsed
+// Parses the dense feature `t` in `sequence_features`, and writes its parsed
 // values to `sequence_result`.
-Status ParseSequenceDenseFeatures(const FeatureProtosMap& sequence_features,
-                                  const FastParseExampleConfig& sequence_config,
-                                  absl::Span<const tstring> example_names,
-                                  bool is_batch, int num_examples,
-                                  Allocator* allocator, Result* sequence_result,
-                                  std::vector<Tensor>* dense_feature_lengths) {
+Status ParseSequenceDenseFeature(const FeatureProtosMap& sequence_features,
+                                 const FastParseExampleConfig& sequence_config,
+                                 int t, absl::Span<const tstring> example_names,
+                                 bool is_batch, int num_examples,
+                                 Allocator* allocator, Result* sequence_result,
+                                 std::vector<Tensor>* dense_feature_lengths) {
   TensorShape dense_length_shape;
   if (is_batch) {
     dense_length_shape.AddDim(num_examples);
   }
-  for (int t = 0; t < sequence_config.dense.size(); ++t) {
-    const auto& c = sequence_config.dense[t];
-    const FeatureProtos& feature =
-        sequence_features.find(c.feature_name)->second;
-    TensorShape dense_shape, row_shape;
-    DataType dtype = c.dtype;
-    const size_t expected_max_elements = feature.length;
-    if (!c.shape.AsTensorShape(&row_shape) ||
-        expected_max_elements !=
-            (expected_max_elements / row_shape.num_elements()) *
-                row_shape.num_elements()) {
-      PartialTensorShape total_shape = row_shape;
-      total_shape.InsertDim(0, -1);
-      return errors::InvalidArgument(
-          "Feature list '", c.feature_name,
-          "' has an unexpected number of values.  Total values size: ",
-          expected_max_elements,
-          " is not consistent with output shape: ", total_shape.DebugString());
-    }
-    int64_t expected_max_rows =
-        expected_max_elements / row_shape.num_elements();
-    if (is_batch) {
-      dense_shape.AddDim(num_examples);
-    }
-    dense_shape.AddDim(expected_max_rows);
-    for (const int dim : sequence_config.dense[t].shape.dim_sizes()) {
-      dense_shape.AddDim(dim);
-    }
-    sequence_result->dense_values[t] = Tensor(allocator, dtype, dense_shape);
-    (*dense_feature_lengths)[t] =
-        Tensor(allocator, DT_INT64, dense_length_shape);
-    int64_t* out_lengths = (*dense_feature_lengths)[t].flat<int64_t>().data();
-
-    tstring* out_bytes = nullptr;
-    float* out_float = nullptr;
-    int64_t* out_int64 = nullptr;
-    switch (dtype) {
-      case DT_STRING:
-        out_bytes = sequence_result->dense_values[t].flat<tstring>().data();
-        break;
-      case DT_FLOAT:
-        out_float = sequence_result->dense_values[t].flat<float>().data();
-        break;
-      case DT_INT64:
-        out_int64 = sequence_result->dense_values[t].flat<int64_t>().data();
-        break;
-      default:
-        ReportUnexpectedDataType(dtype);
-    }
-
-    // Fill in the values.
-    for (int e = 0; e < num_examples; e++) {
-      size_t num_elements = 0, num_rows = 0;
-      const auto& feature_proto = feature.protos[e];
-      if (!feature.protos_present[e]) {
-        // Return an error if this feature was not allowed to be missing.
-        // Otherwise, we'll pad as needed below.
-        if (!c.variable_length) {
-          return errors::InvalidArgument(
-              "Name: ", ExampleName(example_names, e), ", Feature list '",
-              c.feature_name,
-              "' is required but could not be found.  "
-              "Did you mean to include it in "
-              "feature_list_dense_missing_assumed_empty or "
-              "feature_list_dense_defaults?");
-        }
-      } else if (!feature_proto.empty()) {
-        protobuf::io::CodedInputStream stream(
-            reinterpret_cast<const uint8*>(feature_proto.data()),
-            feature_proto.size());
-        EnableAliasing(&stream);
-        while (!stream.ExpectAtEnd()) {
-          uint32 feature_length;
-          if (!stream.ExpectTag(kDelimitedTag(1)) ||
-              !stream.ReadVarint32(&feature_length)) {
-            return errors::InvalidArgument("Error in sequence feature ",
-                                           c.feature_name, " in example ",
-                                           ExampleName(example_names, e));
-          }
-          auto limit = stream.PushLimit(feature_length);
-          int num_added = 0;
-          if (feature_length > 2) {
-            switch (dtype) {
-              case DT_STRING:
-                num_added = ParseBytesFeature(&stream, out_bytes);
-                out_bytes += num_added;
-                break;
-              case DT_FLOAT:
-                num_added = ParseFloatFeature(&stream, out_float);
-                out_float += num_added;
-                break;
-              case DT_INT64:
-                num_added = ParseInt64Feature(&stream, out_int64);
-                out_int64 += num_added;
-                break;
-              default:
-                ReportUnexpectedDataType(dtype);
-                num_added = 0;
-            }
-            if (num_added < 0) {
-              // This should be unreachable -- we already scanned the feature in
-              // GetSequenceFeatureLengths, and it hasn't changed since then.
-              return errors::InvalidArgument("Error in sequence feature ",
-                                             c.feature_name, " in example ",
-                                             ExampleName(example_names, e));
-            }
-          }
-          if (num_added != row_shape.num_elements()) {
-            return errors::InvalidArgument(
-                "Name: ", ExampleName(example_names, e),
-                ", Key: ", c.feature_name, ", Index: ", num_rows,
-                ".  Number of values != expected.  values size: ", num_added,
-                " but output shape: ", row_shape.DebugString());
-          }
-          num_elements += num_added;
-          num_rows++;
-          stream.PopLimit(limit);
-        }
-      }
-      *out_lengths++ = num_rows;
-      // Pad as necessary.
-      int num_to_pad = expected_max_elements - num_elements;
-      switch (dtype) {
-        case DT_STRING:
-          out_bytes += num_to_pad;
-          break;
-        case DT_FLOAT:
-          PadFloatFeature(num_to_pad, out_float);
-          out_float += num_to_pad;
-          break;
-        case DT_INT64:
-          PadInt64Feature(num_to_pad, out_int64);
-          out_int64 += num_to_pad;
-          break;
-        default:
-          ReportUnexpectedDataType(dtype);
-      }
-    }
+  const auto& c = sequence_config.dense[t];
+  const FeatureProtos& feature = sequence_features.find(c.feature_name)->second;
+  TensorShape dense_shape, row_shape;
+  DataType dtype = c.dtype;
+  const size_t expected_max_elements = feature.length;
+  if (!c.shape.AsTensorShape(&row_shape) ||
+      expected_max_elements !=
+          (expected_max_elements / row_shape.num_elements()) *
+              row_shape.num_elements()) {
+    PartialTensorShape total_shape = row_shape;
+    total_shape.InsertDim(0, -1);
+    return errors::InvalidArgument(
+        "Feature list '", c.feature_name,
+        "' has an unexpected number of values.  Total values size: ",
+        expected_max_elements,
+        " is not consistent with output shape: ", total_shape.DebugString());
   }
-  return absl::OkStatus();
-}
+  int64_t expected_max_rows = expected_max_elements / row_shape.num_elements();
+  if (is_batch) {
+    dense_shape.AddDim(num_examples);
+  }
+  dense_shape.AddDim(expected_max_rows);
+  for (const int dim : sequence_config.dense[t].shape.dim_sizes()) {
+    dense_shape.AddDim(dim);
+  }
+  sequence_result->dense_values[t] = Tensor(allocator, dtype, dense_shape);
+  (*dense_feature_lengths)[t] = Tensor(allocator, DT_INT64, dense_length_shape);
+  int64_t* out_lengths = (*dense_feature_lengths)[t].flat<int64_t>().data();
 
-// Parses sparse features in `sequence_features`, and writes their parsed
-// values to `sequence_result`.
-Status ParseSequenceSparseFeatures(
-    const FeatureProtosMap& sequence_features,
-    const FastParseExampleConfig& sequence_config,
-    absl::Span<const tstring> example_names, bool is_batch, int num_examples,
-    Allocator* allocator, Result* sequence_result) {
-  for (int t = 0; t < sequence_config.sparse.size(); ++t) {
-    const auto& c = sequence_config.sparse[t];
-    const FeatureProtos& feature =
-        sequence_features.find(c.feature_name)->second;
-    TensorShape indices_shape, values_shape;
-    DataType dtype = c.dtype;
-    size_t expected_num_elements = feature.length;
-    indices_shape.AddDim(expected_num_elements);
-    indices_shape.AddDim(is_batch ? 3 : 2);
-    values_shape.AddDim(expected_num_elements);
-    sequence_result->sparse_indices[t] =
-        Tensor(allocator, DT_INT64, indices_shape);
-    sequence_result->sparse_values[t] = Tensor(allocator, dtype, values_shape);
-    sequence_result->sparse_shapes[t] =
-        Tensor(allocator, DT_INT64, TensorShape({is_batch ? 3 : 2}));
-
-    tstring* out_bytes = nullptr;
-    float* out_float = nullptr;
-    int64_t* out_int64 = nullptr;
-    switch (dtype) {
-      case DT_STRING:
-        out_bytes = sequence_result->sparse_values[t].flat<tstring>().data();
-        break;
-      case DT_FLOAT:
-        out_float = sequence_result->sparse_values[t].flat<float>().data();
-        break;
-      case DT_INT64:
-        out_int64 = sequence_result->sparse_values[t].flat<int64_t>().data();
-        break;
-      default:
-        ReportUnexpectedDataType(dtype);
-    }
-    int64_t* out_indices =
-        sequence_result->sparse_indices[t].flat<int64_t>().data();
-    auto out_shape = sequence_result->sparse_shapes[t].vec<int64_t>();
+  tstring* out_bytes = nullptr;
+  float* out_float = nullptr;
+  int64_t* out_int64 = nullptr;
+  switch (dtype) {
+    case DT_STRING:
+      out_bytes = sequence_result->dense_values[t].flat<tstring>().data();
+      break;
+    case DT_FLOAT:
+      out_float = sequence_result->dense_values[t].flat<float>().data();
+      break;
+    case DT_INT64:
+      out_int64 = sequence_result->dense_values[t].flat<int64_t>().data();
+      break;
+    default:
+      ReportUnexpectedDataType(dtype);
+  }
 
-    // Fill in the values.
-    size_t num_elements = 0;
-    size_t max_num_rows = 0;
-    size_t max_num_cols = 0;
-    for (int e = 0; e < num_examples; e++) {
-      const auto& feature_proto = feature.protos[e];
-      if (feature_proto.empty()) continue;
+  // Fill in the values.
+  for (int e = 0; e < num_examples; e++) {
+    size_t num_elements = 0, num_rows = 0;
+    const auto& feature_proto = feature.protos[e];
+    if (!feature.protos_present[e]) {
+      // Return an error if this feature was not allowed to be missing.
+      // Otherwise, we'll pad as needed below.
+      if (!c.variable_length) {
+        return errors::InvalidArgument(
+            "Name: ", ExampleName(example_names, e), ", Feature list '",
+            c.feature_name,
+            "' is required but could not be found.  "
+            "Did you mean to include it in "
+            "feature_list_dense_missing_assumed_empty or "
+            "feature_list_dense_defaults?");
+      }
+    } else if (!feature_proto.empty()) {
       protobuf::io::CodedInputStream stream(
           reinterpret_cast<const uint8*>(feature_proto.data()),
           feature_proto.size());
       EnableAliasing(&stream);
-      size_t num_rows = 0;
       while (!stream.ExpectAtEnd()) {
         uint32 feature_length;
         if (!stream.ExpectTag(kDelimitedTag(1)) ||
             !stream.ReadVarint32(&feature_length)) {
-          // This should be unreachable -- we already scanned the feature in
-          // GetSequenceFeatureLengths, and it hasn't changed since then.
           return errors::InvalidArgument("Error in sequence feature ",
                                          c.feature_name, " in example ",
                                          ExampleName(example_names, e));
         }
+        auto limit = stream.PushLimit(feature_length);
+        int num_added = 0;
         if (feature_length > 2) {
-          auto limit = stream.PushLimit(feature_length);
-          size_t num_added;
           switch (dtype) {
             case DT_STRING:
               num_added = ParseBytesFeature(&stream, out_bytes);
@@ -2734,189 +2721,310 @@ Status ParseSequenceSparseFeatures(
               ReportUnexpectedDataType(dtype);
               num_added = 0;
           }
-          num_elements += num_added;
-          max_num_cols = std::max(max_num_cols, num_added);
-          for (int i = 0; i < num_added; i++) {
-            if (is_batch) *out_indices++ = e;
-            *out_indices++ = num_rows;
-            *out_indices++ = i;
-          }
-          stream.PopLimit(limit);
-        } else if (feature_length == 2) {
-          if (!SkipEmptyFeature(&stream, dtype)) {
+          if (num_added < 0) {
             // This should be unreachable -- we already scanned the feature in
             // GetSequenceFeatureLengths, and it hasn't changed since then.
             return errors::InvalidArgument("Error in sequence feature ",
                                            c.feature_name, " in example ",
                                            ExampleName(example_names, e));
           }
-        } else if (feature_length != 0) {
+        }
+        if (num_added != row_shape.num_elements()) {
+          return errors::InvalidArgument(
+              "Name: ", ExampleName(example_names, e),
+              ", Key: ", c.feature_name, ", Index: ", num_rows,
+              ".  Number of values != expected.  values size: ", num_added,
+              " but output shape: ", row_shape.DebugString());
+        }
+        num_elements += num_added;
+        num_rows++;
+        stream.PopLimit(limit);
+      }
+    }
+    *out_lengths++ = num_rows;
+    // Pad as necessary.
+    int num_to_pad = expected_max_elements - num_elements;
+    switch (dtype) {
+      case DT_STRING:
+        out_bytes += num_to_pad;
+        break;
+      case DT_FLOAT:
+        PadFloatFeature(num_to_pad, out_float);
+        out_float += num_to_pad;
+        break;
+      case DT_INT64:
+        PadInt64Feature(num_to_pad, out_int64);
+        out_int64 += num_to_pad;
+        break;
+      default:
+        ReportUnexpectedDataType(dtype);
+    }
+  }
+  return absl::OkStatus();
+}
+
+// Parses the sparse feature `t` in `sequence_features`, and writes its parsed
+// values to `sequence_result`.
+Status ParseSequenceSparseFeature(
+    const FeatureProtosMap& sequence_features,
+    const FastParseExampleConfig& sequence_config, int t,
+    absl::Span<const tstring> example_names, bool is_batch, int num_examples,
+    Allocator* allocator, Result* sequence_result) {
+  const auto& c = sequence_config.sparse[t];
+  const FeatureProtos& feature = sequence_features.find(c.feature_name)->second;
+  TensorShape indices_shape, values_shape;
+  DataType dtype = c.dtype;
+  size_t expected_num_elements = feature.length;
+  indices_shape.AddDim(expected_num_elements);
+  indices_shape.AddDim(is_batch ? 3 : 2);
+  values_shape.AddDim(expected_num_elements);
+  sequence_result->sparse_indices[t] =
+      Tensor(allocator, DT_INT64, indices_shape);
+  sequence_result->sparse_values[t] = Tensor(allocator, dtype, values_shape);
+  sequence_result->sparse_shapes[t] =
+      Tensor(allocator, DT_INT64, TensorShape({is_batch ? 3 : 2}));
+
+  tstring* out_bytes = nullptr;
+  float* out_float = nullptr;
+  int64_t* out_int64 = nullptr;
+  switch (dtype) {
+    case DT_STRING:
+      out_bytes = sequence_result->sparse_values[t].flat<tstring>().data();
+      break;
+    case DT_FLOAT:
+      out_float = sequence_result->sparse_values[t].flat<float>().data();
+      break;
+    case DT_INT64:
+      out_int64 = sequence_result->sparse_values[t].flat<int64_t>().data();
+      break;
+    default:
+      ReportUnexpectedDataType(dtype);
+  }
+  int64_t* out_indices =
+      sequence_result->sparse_indices[t].flat<int64_t>().data();
+  auto out_shape = sequence_result->sparse_shapes[t].vec<int64_t>();
+
+  // Fill in the values.
+  size_t num_elements = 0;
+  size_t max_num_rows = 0;
+  size_t max_num_cols = 0;
+  for (int e = 0; e < num_examples; e++) {
+    const auto& feature_proto = feature.protos[e];
+    if (feature_proto.empty()) continue;
+    protobuf::io::CodedInputStream stream(
+        reinterpret_cast<const uint8*>(feature_proto.data()),
+        feature_proto.size());
+    EnableAliasing(&stream);
+    size_t num_rows = 0;
+    while (!stream.ExpectAtEnd()) {
+      uint32 feature_length;
+      if (!stream.ExpectTag(kDelimitedTag(1)) ||
+          !stream.ReadVarint32(&feature_length)) {
+        // This should be unreachable -- we already scanned the feature in
+        // GetSequenceFeatureLengths, and it hasn't changed since then.
+        return errors::InvalidArgument("Error in sequence feature ",
+                                       c.feature_name, " in example ",
+                                       ExampleName(example_names, e));
+      }
+      if (feature_length > 2) {
+        auto limit = stream.PushLimit(feature_length);
+        size_t num_added;
+        switch (dtype) {
+          case DT_STRING:
+            num_added = ParseBytesFeature(&stream, out_bytes);
+            out_bytes += num_added;
+            break;
+          case DT_FLOAT:
+            num_added = ParseFloatFeature(&stream, out_float);
+            out_float += num_added;
+            break;
+          case DT_INT64:
+            num_added = ParseInt64Feature(&stream, out_int64);
+            out_int64 += num_added;
+            break;
+          default:
+            ReportUnexpectedDataType(dtype);
+            num_added = 0;
+        }
+        num_elements += num_added;
+        max_num_cols = std::max(max_num_cols, num_added);
+        for (int i = 0; i < num_added; i++) {
+          if (is_batch) *out_indices++ = e;
+          *out_indices++ = num_rows;
+          *out_indices++ = i;
+        }
+        stream.PopLimit(limit);
+      } else if (feature_length == 2) {
+        if (!SkipEmptyFeature(&stream, dtype)) {
           // This should be unreachable -- we already scanned the feature in
           // GetSequenceFeatureLengths, and it hasn't changed since then.
           return errors::InvalidArgument("Error in sequence feature ",
                                          c.feature_name, " in example ",
                                          ExampleName(example_names, e));
         }
-        num_rows++;
+      } else if (feature_length != 0) {
+        // This should be unreachable -- we already scanned the feature in
+        // GetSequenceFeatureLengths, and it hasn't changed since then.
+        return errors::InvalidArgument("Error in sequence feature ",
+                                       c.feature_name, " in example ",
+                                       ExampleName(example_names, e));
       }
-      max_num_rows = std::max(max_num_rows, num_rows);
-    }
-    if (num_elements != expected_num_elements) {
-      return errors::InvalidArgument(
-          "Unexpected number of elements in feature ", c.feature_name);
-    }
-    if (is_batch) {
-      out_shape(0) = num_examples;
-      out_shape(1) = max_num_rows;
-      out_shape(2) = max_num_cols;
-    } else {
-      out_shape(0) = max_num_rows;
-      out_shape(1) = max_num_cols;
+      num_rows++;
     }
+    max_num_rows = std::max(max_num_rows, num_rows);
+  }
+  if (num_elements != expected_num_elements) {
+    return errors::InvalidArgument(
+        "Unexpected number of elements in feature ", c.feature_name);
+  }
+  if (is_batch) {
+    out_shape(0) = num_examples;
+    out_shape(1) = max_num_rows;
+    out_shape(2) = max_num_cols;
+  } else {
+    out_shape(0) = max_num_rows;
+    out_shape(1) = max_num_cols;
   }
   return absl::OkStatus();
 }
 
-// Parses ragged features in `sequence_features`, and writes their parsed
+// Parses the ragged feature `t` in `sequence_features`, and writes its parsed
 // values to `sequence_result`.
-Status ParseSequenceRaggedFeatures(
+Status ParseSequenceRaggedFeature(
     const FeatureProtosMap& sequence_features,
-    const FastParseExampleConfig& sequence_config,
+    const FastParseExampleConfig& sequence_config, int t,
     absl::Span<const tstring> example_names, bool is_batch, int num_examples,
     Allocator* allocator, Result* sequence_result) {
-  for (int t = 0; t < sequence_config.ragged.size(); ++t) {
-    const auto& c = sequence_config.ragged[t];
-    const FeatureProtos& feature =
-        sequence_features.find(c.feature_name)->second;
-    TensorShape values_shape, inner_splits_shape, outer_splits_shape;
-    DataType dtype = c.dtype;
-    DataType splits_dtype = c.splits_dtype;
-    size_t expected_num_elements = feature.length;
-    size_t expected_num_rows = feature.num_rows;
-    values_shape.AddDim(expected_num_elements);
-    inner_splits_shape.AddDim(expected_num_rows + 1);
-    if (is_batch) {
-      outer_splits_shape.AddDim(num_examples + 1);
-    }
-    sequence_result->ragged_values[t] = Tensor(allocator, dtype, values_shape);
-    sequence_result->ragged_splits[t] =
-        Tensor(allocator, splits_dtype, inner_splits_shape);
-    sequence_result->ragged_outer_splits[t] =
-        Tensor(allocator, splits_dtype, outer_splits_shape);
-    Tensor& out_values = sequence_result->ragged_values[t];
-    size_t out_values_offset = 0;
-    int32* int32_inner_splits =
-        splits_dtype == DT_INT32
-            ? sequence_result->ragged_splits[t].vec<int32>().data()
-            : nullptr;
-    int64_t* int64_inner_splits =
-        splits_dtype == DT_INT64
-            ? sequence_result->ragged_splits[t].vec<int64_t>().data()
-            : nullptr;
-    int32* int32_outer_splits =
-        is_batch && splits_dtype == DT_INT32
-            ? sequence_result->ragged_outer_splits[t].vec<int32>().data()
-            : nullptr;
-    int64_t* int64_outer_splits =
-        is_batch && splits_dtype == DT_INT64
-            ? sequence_result->ragged_outer_splits[t].vec<int64_t>().data()
-            : nullptr;
-    if (int32_inner_splits) {
-      *int32_inner_splits++ = 0;
-    } else if (int64_inner_splits) {
-      *int64_inner_splits++ = 0;
-    }
-    if (int32_outer_splits) {
-      *int32_outer_splits++ = 0;
-    } else if (int64_outer_splits) {
-      *int64_outer_splits++ = 0;
-    }
-
-    // Fill in the values.
-    size_t inner_split = 0;  // total number of elements we've seen so far
-    size_t outer_split = 0;  // total number of rows we've seen so far
-    for (int e = 0; e < num_examples; e++) {
-      const auto& feature_proto = feature.protos[e];
-      if (!feature_proto.empty()) {
-        protobuf::io::CodedInputStream stream(
-            reinterpret_cast<const uint8*>(feature_proto.data()),
-            feature_proto.size());
-        EnableAliasing(&stream);
-        while (!stream.ExpectAtEnd()) {
-          uint32 feature_length;
-          if (!stream.ExpectTag(kDelimitedTag(1)) ||
-              !stream.ReadVarint32(&feature_length)) {
-            // This should be unreachable -- we already scanned the feature in
-            // GetSequenceFeatureLengths, and it hasn't changed since then.
-            return errors::InvalidArgument("Error in sequence feature ",
-                                           c.feature_name, " in example ",
-                                           ExampleName(example_names, e));
-          }
-          if (feature_length > 2) {
-            auto limit = stream.PushLimit(feature_length);
-            size_t num_added =
-                ParseFeature(dtype, &stream, &out_values, &out_values_offset);
-            inner_split += num_added;
-            stream.PopLimit(limit);
-          } else if (feature_length == 2) {
-            if (!SkipEmptyFeature(&stream, dtype)) {
-              // This should be unreachable -- we already scanned the feature in
-              // GetSequenceFeatureLengths, and it hasn't changed since then.
-              return errors::InvalidArgument("Error in sequence feature ",
-                                             c.feature_name, " in example ",
-                                             ExampleName(example_names, e));
-            }
-          } else if (feature_length != 0) {
+  const auto& c = sequence_config.ragged[t];
+  const FeatureProtos& feature = sequence_features.find(c.feature_name)->second;
+  TensorShape values_shape, inner_splits_shape, outer_splits_shape;
+  DataType dtype = c.dtype;
+  DataType splits_dtype = c.splits_dtype;
+  size_t expected_num_elements = feature.length;
+  size_t expected_num_rows = feature.num_rows;
+  values_shape.AddDim(expected_num_elements);
+  inner_splits_shape.AddDim(expected_num_rows + 1);
+  if (is_batch) {
+    outer_splits_shape.AddDim(num_examples + 1);
+  }
+  sequence_result->ragged_values[t] = Tensor(allocator, dtype, values_shape);
+  sequence_result->ragged_splits[t] =
+      Tensor(allocator, splits_dtype, inner_splits_shape);
+  sequence_result->ragged_outer_splits[t] =
+      Tensor(allocator, splits_dtype, outer_splits_shape);
+  Tensor& out_values = sequence_result->ragged_values[t];
+  size_t out_values_offset = 0;
+  int32* int32_inner_splits =
+      splits_dtype == DT_INT32
+          ? sequence_result->ragged_splits[t].vec<int32>().data()
+          : nullptr;
+  int64_t* int64_inner_splits =
+      splits_dtype == DT_INT64
+          ? sequence_result->ragged_splits[t].vec<int64_t>().data()
+          : nullptr;
+  int32* int32_outer_splits =
+      is_batch && splits_dtype == DT_INT32
+          ? sequence_result->ragged_outer_splits[t].vec<int32>().data()
+          : nullptr;
+  int64_t* int64_outer_splits =
+      is_batch && splits_dtype == DT_INT64
+          ? sequence_result->ragged_outer_splits[t].vec<int64_t>().data()
+          : nullptr;
+  if (int32_inner_splits) {
+    *int32_inner_splits++ = 0;
+  } else if (int64_inner_splits) {
+    *int64_inner_splits++ = 0;
+  }
+  if (int32_outer_splits) {
+    *int32_outer_splits++ = 0;
+  } else if (int64_outer_splits) {
+    *int64_outer_splits++ = 0;
+  }
+
+  // Fill in the values.
+  size_t inner_split = 0;  // total number of elements we've seen so far
+  size_t outer_split = 0;  // total number of rows we've seen so far
+  for (int e = 0; e < num_examples; e++) {
+    const auto& feature_proto = feature.protos[e];
+    if (!feature_proto.empty()) {
+      protobuf::io::CodedInputStream stream(
+          reinterpret_cast<const uint8*>(feature_proto.data()),
+          feature_proto.size());
+      EnableAliasing(&stream);
+      while (!stream.ExpectAtEnd()) {
+        uint32 feature_length;
+        if (!stream.ExpectTag(kDelimitedTag(1)) ||
+            !stream.ReadVarint32(&feature_length)) {
+          // This should be unreachable -- we already scanned the feature in
+          // GetSequenceFeatureLengths, and it hasn't changed since then.
+          return errors::InvalidArgument("Error in sequence feature ",
+                                         c.feature_name, " in example ",
+                                         ExampleName(example_names, e));
+        }
+        if (feature_length > 2) {
+          auto limit = stream.PushLimit(feature_length);
+          size_t num_added =
+              ParseFeature(dtype, &stream, &out_values, &out_values_offset);
+          inner_split += num_added;
+          stream.PopLimit(limit);
+        } else if (feature_length == 2) {
+          if (!SkipEmptyFeature(&stream, dtype)) {
             // This should be unreachable -- we already scanned the feature in
             // GetSequenceFeatureLengths, and it hasn't changed since then.
             return errors::InvalidArgument("Error in sequence feature ",
                                            c.feature_name, " in example ",
                                            ExampleName(example_names, e));
           }
-          if (int32_inner_splits) {
-            *int32_inner_splits++ = inner_split;
-          } else if (int64_inner_splits) {
-            *int64_inner_splits++ = inner_split;
-          }
-          outer_split++;
+        } else if (feature_length != 0) {
+          // This should be unreachable -- we already scanned the feature in
+          // GetSequenceFeatureLengths, and it hasn't changed since then.
+          return errors::InvalidArgument("Error in sequence feature ",
+                                         c.feature_name, " in example ",
+                                         ExampleName(example_names, e));
         }
-      }
-      if (int32_outer_splits) {
-        *int32_outer_splits++ = outer_split;
-      } else if (int64_outer_splits) {
-        *int64_outer_splits++ = outer_split;
+        if (int32_inner_splits) {
+          *int32_inner_splits++ = inner_split;
+        } else if (int64_inner_splits) {
+          *int64_inner_splits++ = inner_split;
+        }
+        outer_split++;
       }
     }
-    if (outer_split != expected_num_rows) {
+    if (int32_outer_splits) {
+      *int32_outer_splits++ = outer_split;
+    } else if (int64_outer_splits) {
+      *int64_outer_splits++ = outer_split;
+    }
+  }
+  if (outer_split != expected_num_rows) {
+    return errors::InvalidArgument("Unexpected number of rows for feature ",
+                                   c.feature_name);
+  }
+  if (inner_split != expected_num_elements) {
+    return errors::InvalidArgument(
+        "Unexpected number of elements for feature ", c.feature_name);
+  }
+
+  if (int32_inner_splits || int64_inner_splits) {
+    const auto& inner_splits = sequence_result->ragged_splits[t];
+    int num_inner_splits =
+        int32_inner_splits
+            ? int32_inner_splits - inner_splits.vec<int32>().data()
+            : int64_inner_splits - inner_splits.vec<int64_t>().data();
+    if (num_inner_splits != expected_num_rows + 1) {
       return errors::InvalidArgument("Unexpected number of rows for feature ",
                                      c.feature_name);
     }
-    if (inner_split != expected_num_elements) {
+  }
+  if (int32_outer_splits || int64_outer_splits) {
+    const auto& outer_splits = sequence_result->ragged_outer_splits[t];
+    int num_outer_splits =
+        int32_outer_splits
+            ? int32_outer_splits - outer_splits.vec<int32>().data()
+            : int64_outer_splits - outer_splits.vec<int64_t>().data();
+    if (num_outer_splits != num_examples + 1) {
       return errors::InvalidArgument(
-          "Unexpected number of elements for feature ", c.feature_name);
-    }
-
-    if (int32_inner_splits || int64_inner_splits) {
-      const auto& inner_splits = sequence_result->ragged_splits[t];
-      int num_inner_splits =
-          int32_inner_splits
-              ? int32_inner_splits - inner_splits.vec<int32>().data()
-              : int64_inner_splits - inner_splits.vec<int64_t>().data();
-      if (num_inner_splits != expected_num_rows + 1) {
-        return errors::InvalidArgument("Unexpected number of rows for feature ",
-                                       c.feature_name);
-      }
-    }
-    if (int32_outer_splits || int64_outer_splits) {
-      const auto& outer_splits = sequence_result->ragged_outer_splits[t];
-      int num_outer_splits =
-          int32_outer_splits
-              ? int32_outer_splits - outer_splits.vec<int32>().data()
-              : int64_outer_splits - outer_splits.vec<int64_t>().data();
-      if (num_outer_splits != num_examples + 1) {
-        return errors::InvalidArgument(
-            "Unexpected number of examples for feature ", c.feature_name);
-      }
+          "Unexpected number of examples for feature ", c.feature_name);
     }
   }
   return absl::OkStatus();
@@ -2924,7 +3032,6 @@ Status ParseSequenceRaggedFeatures(
 
 }  // namespace
 
-// TODO(sundberg): Use the threadpool to parallelize example parsing.
 // TODO(b/111553342): Support extracting feature statistics from the examples.
 Status FastParseSequenceExample(const FastParseExampleConfig& context_config,
                                 const FastParseExampleConfig& sequence_config,
@@ -3031,15 +3138,41 @@ Status FastParseSequenceExample(const FastParseExampleConfig& context_config,
     feature.protos_present.resize(num_examples);
   }
 
-  // Find the serialized proto substrings for each feature.
-  TF_RETURN_IF_ERROR(ExtractFeaturesFromSequenceExamples(
-      serialized, example_names, &context_features, &sequence_features));
+  const size_t num_minibatches = NumMiniBatches(serialized);
+  auto first_example_of_minibatch = [&](size_t minibatch) -> size_t {
+    return (num_examples * minibatch) / num_minibatches;
+  };
+  for (FeatureProtosMap* features : {&context_features, &sequence_features}) {
+    for (auto& c : *features) {
+      c.second.minibatch_lengths.resize(num_minibatches);
+      c.second.minibatch_num_rows.resize(num_minibatches);
+    }
+  }
 
-  // Scan through the protos to determine how much memory we need to allocate.
-  TF_RETURN_IF_ERROR(
-      GetContextFeatureLengths(example_names, &context_features));
-  TF_RETURN_IF_ERROR(
-      GetSequenceFeatureLengths(example_names, &sequence_features));
+  // Find the serialized proto substrings for each feature, and scan through
+  // them to determine how much memory we need to allocate, in minibatches of
+  // examples in parallel.
+  std::vector<Status> status_of_minibatch(num_minibatches);
+  auto ProcessMiniBatch = [&](size_t minibatch) {
+    const size_t start = first_example_of_minibatch(minibatch);
+    const size_t end = first_example_of_minibatch(minibatch + 1);
+    Status& status = status_of_minibatch[minibatch];
+    status = ExtractFeaturesFromSequenceExamples(serialized, example_names,
+                                                 start, end, &context_features,
+                                                 &sequence_features);
+    if (!status.ok()) return;
+    status = GetContextFeatureLengths(example_names, start, end, minibatch,
+                                      &context_features);
+    if (!status.ok()) return;
+    status = GetSequenceFeatureLengths(example_names, start, end, minibatch,
+                                       &sequence_features);
+  };
+  ParallelFor(ProcessMiniBatch, num_minibatches, thread_pool);
+  for (Status& status : status_of_minibatch) {
+    TF_RETURN_IF_ERROR(status);
+  }
+  ReduceFeatureLengths(&context_features);
+  ReduceFeatureLengths(&sequence_features);
 
   // Allocate memory.
   context_result->sparse_values.resize(context_config.sparse.size());
@@ -3062,24 +3195,58 @@ Status FastParseSequenceExample(const FastParseExampleConfig& context_config,
   // to avoid lock contention in `tensorflow::cpu_allocator()`.
   Allocator* allocator = tensorflow::cpu_allocator();
 
-  TF_RETURN_IF_ERROR(ParseContextDenseFeatures(
-      context_features, context_config, example_names, is_batch, num_examples,
-      allocator, context_result));
-  TF_RETURN_IF_ERROR(ParseContextSparseFeatures(
-      context_features, context_config, example_names, is_batch, num_examples,
-      allocator, context_result));
-  TF_RETURN_IF_ERROR(ParseContextRaggedFeatures(
-      context_features, context_config, example_names, is_batch, num_examples,
-      allocator, context_result));
-  TF_RETURN_IF_ERROR(ParseSequenceDenseFeatures(
-      sequence_features, sequence_config, example_names, is_batch, num_examples,
-      allocator, sequence_result, dense_feature_lengths));
-  TF_RETURN_IF_ERROR(ParseSequenceSparseFeatures(
-      sequence_features, sequence_config, example_names, is_batch, num_examples,
-      allocator, sequence_result));
-  TF_RETURN_IF_ERROR(ParseSequenceRaggedFeatures(
-      sequence_features, sequence_config, example_names, is_batch, num_examples,
-      allocator, sequence_result));
+  // Each output feature is parsed into its own tensors, so the features are
+  // parsed in parallel.
+  std::vector<std::function<Status()>> parse_features;
+  for (int t = 0; t < context_config.dense.size(); ++t) {
+    parse_features.push_back([&, t] {
+      return ParseContextDenseFeature(context_features, context_config, t,
+                                      example_names, is_batch, num_examples,
+                                      allocator, context_result);
+    });
+  }
+  for (int t = 0; t < context_config.sparse.size(); ++t) {
+    parse_features.push_back([&, t] {
+      return ParseContextSparseFeature(context_features, context_config, t,
+                                       example_names, is_batch, num_examples,
+                                       allocator, context_result);
+    });
+  }
+  for (int t = 0; t < context_config.ragged.size(); ++t) {
+    parse_features.push_back([&, t] {
+      return ParseContextRaggedFeature(context_features, context_config, t,
+                                       example_names, is_batch, num_examples,
+                                       allocator, context_result);
+    });
+  }
+  for (int t = 0; t < sequence_config.dense.size(); ++t) {
+    parse_features.push_back([&, t] {
+      return ParseSequenceDenseFeature(
+          sequence_features, sequence_config, t, example_names, is_batch,
+          num_examples, allocator, sequence_result, dense_feature_lengths);
+    });
+  }
+  for (int t = 0; t < sequence_config.sparse.size(); ++t) {
+    parse_features.push_back([&, t] {
+      return ParseSequenceSparseFeature(sequence_features, sequence_config, t,
+                                        example_names, is_batch, num_examples,
+                                        allocator, sequence_result);
+    });
+  }
+  for (int t = 0; t < sequence_config.ragged.size(); ++t) {
+    parse_features.push_back([&, t] {
+      return ParseSequenceRaggedFeature(sequence_features, sequence_config, t,
+                                        example_names, is_batch, num_examples,
+                                        allocator, sequence_result);
+    });
+  }
+  std::vector<Status> status_of_feature(parse_features.size());
+  ParallelFor(
+      [&](size_t i) { status_of_feature[i] = parse_features[i](); },
+      parse_features.size(), thread_pool);
+  for (Status& status : status_of_feature) {
+    TF_RETURN_IF_ERROR(status);
+  }
 
   return absl::OkStatus();
 }
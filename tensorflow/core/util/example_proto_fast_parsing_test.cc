@@ -21,8 +21,12 @@ limitations under the License.
 
 #include "tensorflow/core/example/example.pb.h"
 #include "tensorflow/core/example/feature.pb.h"
+#include "tensorflow/core/framework/tensor.h"
+#include "tensorflow/core/lib/core/status_test_util.h"
+#include "tensorflow/core/lib/core/threadpool.h"
 #include "tensorflow/core/lib/random/philox_random.h"
 #include "tensorflow/core/lib/random/simple_philox.h"
+#include "tensorflow/core/platform/env.h"
 #include "tensorflow/core/platform/protobuf.h"
 #include "tensorflow/core/platform/test.h"
 #include "tensorflow/core/platform/test_benchmark.h"
@@ -172,6 +176,25 @@ TEST(FastParse, Packed) {
       "\x0a\x0d\x0a\x0b\x0a\x03\x61\x67\x65\x12\x04\x1a\x02\x08\x0d");
 }
 
+TEST(FastParse, PackedInt64OfAllWidths) {
+  Example example;
+  auto* int64_list = (*example.mutable_features()->mutable_feature())["ids"]
+                         .mutable_int64_list();
+  // Runs of single-byte values are decoded eight at a time.
+  for (int i = 0; i < 19; ++i) {
+    int64_list->add_value(i);
+  }
+  for (int width = 0; width < 64; ++width) {
+    int64_list->add_value(static_cast<int64_t>(uint64_t{1} << width));
+    int64_list->add_value(static_cast<int64_t>((uint64_t{1} << width) - 1));
+    int64_list->add_value(-width);
+  }
+  for (int i = 0; i < 13; ++i) {
+    int64_list->add_value(127 - i);
+  }
+  TestCorrectness(Serialize(example));
+}
+
 TEST(FastParse, ValueBeforeKeyInMap) {
   TestCorrectness("\x0a\x12\x0a\x10\x12\x09\x0a\x07\x0a\x05value\x0a\x03key");
 }
@@ -429,6 +452,114 @@ TEST(TestFastParseExample, Empty) {
   EXPECT_TRUE(status.ok()) << status;
 }
 
+// Builds SequenceExamples whose features have different numbers of values
+// and rows in each example.
+std::vector<tstring> MakeSequenceExamples(int num_examples) {
+  std::vector<tstring> serialized;
+  for (int e = 0; e < num_examples; ++e) {
+    SequenceExample example;
+    auto& context = *example.mutable_context()->mutable_feature();
+    context["c_dense"].mutable_int64_list()->add_value(e);
+    for (int i = 0; i < e % 3; ++i) {
+      context["c_sparse"].mutable_int64_list()->add_value(e + i);
+      context["c_ragged"].mutable_float_list()->add_value(e * i);
+    }
+    auto& feature_lists =
+        *example.mutable_feature_lists()->mutable_feature_list();
+    for (int row = 0; row < e % 5; ++row) {
+      Feature* dense = feature_lists["f_dense"].add_feature();
+      dense->mutable_float_list()->add_value(row);
+      dense->mutable_float_list()->add_value(e);
+      Feature* sparse = feature_lists["f_sparse"].add_feature();
+      Feature* ragged = feature_lists["f_ragged"].add_feature();
+      for (int i = 0; i < row; ++i) {
+        sparse->mutable_int64_list()->add_value(e * row + i);
+        ragged->mutable_bytes_list()->add_value(strings::StrCat(e, ":", i));
+      }
+    }
+    serialized.push_back(Serialize(example));
+  }
+  return serialized;
+}
+
+void ExpectTensorsEqual(const std::vector<Tensor>& actual,
+                        const std::vector<Tensor>& expected) {
+  ASSERT_EQ(actual.size(), expected.size());
+  for (int i = 0; i < actual.size(); ++i) {
+    EXPECT_EQ(actual[i].DebugString(/*num_values=*/-1),
+              expected[i].DebugString(/*num_values=*/-1));
+  }
+}
+
+void ExpectResultsEqual(const Result& actual, const Result& expected) {
+  ExpectTensorsEqual(actual.sparse_indices, expected.sparse_indices);
+  ExpectTensorsEqual(actual.sparse_values, expected.sparse_values);
+  ExpectTensorsEqual(actual.sparse_shapes, expected.sparse_shapes);
+  ExpectTensorsEqual(actual.dense_values, expected.dense_values);
+  ExpectTensorsEqual(actual.ragged_values, expected.ragged_values);
+  ExpectTensorsEqual(actual.ragged_splits, expected.ragged_splits);
+  ExpectTensorsEqual(actual.ragged_outer_splits, expected.ragged_outer_splits);
+}
+
+TEST(TestFastParseSequenceExample, ThreadPoolParsesLikeTheCallingThread) {
+  FastParseExampleConfig context_config;
+  context_config.dense.emplace_back("c_dense", DT_INT64, PartialTensorShape({}),
+                                    Tensor(), /*variable_length=*/false,
+                                    /*elements_per_stride=*/1);
+  context_config.sparse.emplace_back("c_sparse", DT_INT64);
+  context_config.ragged.emplace_back("c_ragged", DT_FLOAT, DT_INT64);
+  FastParseExampleConfig sequence_config;
+  sequence_config.dense.emplace_back(
+      "f_dense", DT_FLOAT, PartialTensorShape({2}), Tensor(DT_FLOAT),
+      /*variable_length=*/true, /*elements_per_stride=*/2);
+  sequence_config.sparse.emplace_back("f_sparse", DT_INT64);
+  sequence_config.ragged.emplace_back("f_ragged", DT_STRING, DT_INT32);
+  // Enough examples for several minibatches.
+  const std::vector<tstring> serialized = MakeSequenceExamples(100);
+
+  Result context_result, sequence_result;
+  std::vector<Tensor> dense_feature_lengths;
+  TF_ASSERT_OK(FastParseSequenceExample(
+      context_config, sequence_config, serialized, {}, nullptr,
+      &context_result, &sequence_result, &dense_feature_lengths));
+
+  thread::ThreadPool thread_pool(Env::Default(), "parse_sequence_example", 4);
+  Result threaded_context_result, threaded_sequence_result;
+  std::vector<Tensor> threaded_dense_feature_lengths;
+  TF_ASSERT_OK(FastParseSequenceExample(
+      context_config, sequence_config, serialized, {}, &thread_pool,
+      &threaded_context_result, &threaded_sequence_result,
+      &threaded_dense_feature_lengths));
+
+  ExpectResultsEqual(threaded_context_result, context_result);
+  ExpectResultsEqual(threaded_sequence_result, sequence_result);
+  ExpectTensorsEqual(threaded_dense_feature_lengths, dense_feature_lengths);
+  // The outer splits of "f_ragged" count the rows of each example.
+  const auto outer_splits =
+      threaded_sequence_result.ragged_outer_splits[0].vec<int32>();
+  ASSERT_EQ(outer_splits.size(), 101);
+  for (int e = 0; e < 100; ++e) {
+    EXPECT_EQ(outer_splits(e + 1) - outer_splits(e), e % 5);
+  }
+}
+
+TEST(TestFastParseSequenceExample, ThreadPoolReportsInvalidExamples) {
+  FastParseExampleConfig context_config;
+  context_config.sparse.emplace_back("c_sparse", DT_INT64);
+  FastParseExampleConfig sequence_config;
+  std::vector<tstring> serialized = MakeSequenceExamples(100);
+  serialized[57] = "invalid";
+
+  thread::ThreadPool thread_pool(Env::Default(), "parse_sequence_example", 4);
+  Result context_result, sequence_result;
+  std::vector<Tensor> dense_feature_lengths;
+  EXPECT_FALSE(FastParseSequenceExample(context_config, sequence_config,
+                                        serialized, {}, &thread_pool,
+                                        &context_result, &sequence_result,
+                                        &dense_feature_lengths)
+                   .ok());
+}
+
 }  // namespace
 }  // namespace example
 }  // namespace tensorflow
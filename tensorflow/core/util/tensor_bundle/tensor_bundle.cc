@@ -15,14 +15,21 @@ limitations under the License.
 
 #include "tensorflow/core/util/tensor_bundle/tensor_bundle.h"
 
+#include <algorithm>
+#include <cstdint>
 #include <cstdlib>
 #include <cstring>
+#include <map>
 #include <memory>
+#include <numeric>
 #include <utility>
 
 #include "absl/base/call_once.h"
+#include "absl/container/flat_hash_set.h"
+#include "absl/strings/match.h"
 #include "absl/synchronization/mutex.h"
 #include "xla/tsl/util/byte_swap_array.h"
+#include "tensorflow/core/framework/allocation_description.pb.h"
 #include "tensorflow/core/framework/register_types.h"
 #include "tensorflow/core/framework/tensor.pb.h"
 #include "tensorflow/core/framework/tensor_shape.pb.h"
@@ -41,6 +48,7 @@ limitations under the License.
 #include "tensorflow/core/lib/io/table_builder.h"
 #include "tensorflow/core/lib/strings/str_util.h"
 #include "tensorflow/core/platform/bfloat16.h"
+#include "tensorflow/core/platform/blocking_counter.h"
 #include "tensorflow/core/platform/cord.h"
 #include "tensorflow/core/platform/errors.h"
 #include "tensorflow/core/platform/mem.h"
@@ -562,6 +570,8 @@ Status BundleWriter::Finish() {
     header.set_num_shards(1);
     header.set_endianness(BundleHeaderProto::LITTLE);
     if (!port::kLittleEndian) header.set_endianness(BundleHeaderProto::BIG);
+    header.set_data_alignment(options_.data_alignment);
+    header.set_base_prefix(options_.base_prefix);
     VersionDef* version = header.mutable_version();
     version->set_producer(kTensorBundleVersion);
     version->set_min_consumer(kTensorBundleMinConsumer);
@@ -599,6 +609,11 @@ struct MergeState {
   bool seen_first_bundle = false;
   BundleHeaderProto_Endianness endianness;
   VersionDef version;
+  // The largest alignment that holds for all merged bundles, or 0 if the
+  // alignment of any of them is unknown.
+  int64_t data_alignment = 0;
+  // The base of the merged delta bundles, which must be the same for all.
+  string base_prefix;
 
   // Tensor key -> BundleEntryProto.
   std::map<string, BundleEntryProto> entries;
@@ -640,7 +655,19 @@ static Status MergeOneBundle(Env* env, StringPiece prefix,
       merge_state->seen_first_bundle = true;
       merge_state->endianness = header.endianness();
       merge_state->version = header.version();
+      merge_state->data_alignment = header.data_alignment();
+      merge_state->base_prefix = header.base_prefix();
     } else {
+      if (merge_state->base_prefix != header.base_prefix()) {
+        return errors::InvalidArgument(
+            "Merging bundles with different bases: merged \"",
+            merge_state->base_prefix, "\" vs. curr \"", header.base_prefix(),
+            "\"");
+      }
+      merge_state->data_alignment =
+          merge_state->data_alignment == 0 || header.data_alignment() == 0
+              ? 0
+              : std::gcd(merge_state->data_alignment, header.data_alignment());
       // Validates "endianness".
       if (merge_state->endianness != header.endianness()) {
         return errors::InvalidArgument(
@@ -748,6 +775,8 @@ Status MergeBundles(Env* env, absl::Span<const tstring> prefixes,
     BundleHeaderProto header;
     header.set_num_shards(merge.num_shards);
     header.set_endianness(merge.endianness);
+    header.set_data_alignment(merge.data_alignment);
+    header.set_base_prefix(merge.base_prefix);
     *header.mutable_version() = merge.version;
     builder.Add(kHeaderEntryKey, header.SerializeAsString());
     // All others.
@@ -767,6 +796,100 @@ Status MergeBundles(Env* env, absl::Span<const tstring> prefixes,
   return status;
 }
 
+static Status WriteOneBundle(Env* env, StringPiece prefix,
+                             absl::Span<const BundleWriteEntry* const> entries,
+                             const BundleWriter::Options& options) {
+  BundleWriter writer(env, prefix, options);
+  TF_RETURN_IF_ERROR(writer.status());
+  for (const BundleWriteEntry* entry : entries) {
+    if (entry->is_slice) {
+      TF_RETURN_IF_ERROR(writer.AddSlice(entry->key, entry->full_shape,
+                                         entry->slice_spec, entry->tensor));
+    } else {
+      TF_RETURN_IF_ERROR(writer.Add(entry->key, entry->tensor));
+    }
+  }
+  return writer.Finish();
+}
+
+Status WriteBundleInParallel(Env* env, StringPiece prefix,
+                             absl::Span<const BundleWriteEntry> entries,
+                             int num_shards, thread::ThreadPool* thread_pool,
+                             const BundleWriter::Options& options) {
+  // Groups the entries by key, so that all slices of a tensor are written to
+  // the same shard and their metadata is merged consistently.
+  std::vector<std::vector<const BundleWriteEntry*>> groups;
+  std::vector<int64_t> group_bytes;
+  absl::flat_hash_map<StringPiece, size_t> group_ids;
+  for (const BundleWriteEntry& entry : entries) {
+    auto result = group_ids.insert({entry.key, groups.size()});
+    if (result.second) {
+      groups.emplace_back();
+      group_bytes.push_back(0);
+    }
+    groups[result.first->second].push_back(&entry);
+    group_bytes[result.first->second] += entry.tensor.TotalBytes();
+  }
+  num_shards = std::min<int64_t>(num_shards, groups.size());
+  if (num_shards <= 1) {
+    std::vector<const BundleWriteEntry*> all;
+    all.reserve(entries.size());
+    for (const BundleWriteEntry& entry : entries) all.push_back(&entry);
+    return WriteOneBundle(env, prefix, all, options);
+  }
+
+  // Assigns the largest tensors first, each to the least loaded shard.
+  std::vector<size_t> order(groups.size());
+  std::iota(order.begin(), order.end(), 0);
+  std::stable_sort(order.begin(), order.end(), [&](size_t a, size_t b) {
+    return group_bytes[a] > group_bytes[b];
+  });
+  std::vector<std::vector<const BundleWriteEntry*>> shards(num_shards);
+  std::vector<int64_t> shard_bytes(num_shards, 0);
+  for (size_t group : order) {
+    const int shard =
+        std::min_element(shard_bytes.begin(), shard_bytes.end()) -
+        shard_bytes.begin();
+    shard_bytes[shard] += group_bytes[group];
+    shards[shard].insert(shards[shard].end(), groups[group].begin(),
+                         groups[group].end());
+  }
+
+  const uint64 temp_id = random::New64();
+  std::vector<tstring> shard_prefixes(num_shards);
+  std::vector<Status> statuses(num_shards);
+  BlockingCounter counter(num_shards);
+  for (int i = 0; i < num_shards; ++i) {
+    shard_prefixes[i] =
+        strings::StrCat(prefix, "_temp_", temp_id, "_shard_", i);
+    auto write_shard = [&, i]() {
+      statuses[i] =
+          WriteOneBundle(env, shard_prefixes[i], shards[i], options);
+      counter.DecrementCount();
+    };
+    if (thread_pool != nullptr) {
+      thread_pool->Schedule(write_shard);
+    } else {
+      write_shard();
+    }
+  }
+  counter.Wait();
+
+  Status status;
+  for (const Status& shard_status : statuses) status.Update(shard_status);
+  if (status.ok()) {
+    status = MergeBundles(env, shard_prefixes, prefix);
+  }
+  if (!status.ok()) {
+    // Best effort cleanup of the shards that were written.
+    for (const tstring& shard_prefix : shard_prefixes) {
+      env->DeleteFile(MetaFilename(shard_prefix)).IgnoreError();
+      env->DeleteFile(DataFilename(shard_prefix, 0, 1)).IgnoreError();
+    }
+  }
+  return status;
+}
+
 // Interface for reading a tensor bundle.
 
 BundleReader::BundleReader(
@@ -830,6 +953,7 @@ BundleReader::BundleReader(Env* env, StringPiece prefix, Options options)
     return;
   }
   num_shards_ = header.num_shards();
+  data_alignment_ = header.data_alignment();
   if ((header.endianness() == BundleHeaderProto::BIG && port::kLittleEndian) ||
       (header.endianness() == BundleHeaderProto::LITTLE &&
        !port::kLittleEndian)) {
@@ -837,6 +961,28 @@ BundleReader::BundleReader(Env* env, StringPiece prefix, Options options)
   }
   status_ = CheckVersions(header.version(), kTensorBundleVersion,
                           kTensorBundleMinProducer, "Checkpoint", "checkpoint");
+  if (!status_.ok() || header.base_prefix().empty()) return;
+
+  string base_prefix = header.base_prefix();
+  if (!io::IsAbsolutePath(base_prefix) &&
+      !absl::StrContains(base_prefix, "://")) {
+    base_prefix = io::JoinPath(io::Dirname(prefix_), base_prefix);
+  }
+  if (base_prefix == prefix_) {
+    status_ = CorruptFileError(errors::DataLoss("self-referencing bundle"),
+                               filename, "invalid base prefix");
+    return;
+  }
+  base_ = std::make_unique<BundleReader>(
+      env_, base_prefix,
+      Options{cache_, enable_multi_threading_for_testing_});
+  if (!base_->status().ok()) {
+    status_ = errors::CreateWithUpdatedMessage(
+        base_->status(),
+        strings::StrCat("Failed to open the base bundle ", base_prefix,
+                        " of delta bundle ", prefix_, ": ",
+                        base_->status().message()));
+  }
 }
 
 BundleReader::~BundleReader() {
@@ -1022,7 +1168,9 @@ Status BundleReader::GetValue(const BundleEntryProto& entry, Tensor* val) {
 Status BundleReader::Lookup(StringPiece key, Tensor* val) {
   CHECK(val != nullptr);
   BundleEntryProto entry;
-  TF_RETURN_IF_ERROR(GetBundleEntryProto(key, &entry));
+  Status s = GetBundleEntryProto(key, &entry);
+  if (errors::IsNotFound(s) && base_ != nullptr) return base_->Lookup(key, val);
+  TF_RETURN_IF_ERROR(s);
 
   if (entry.slices().empty()) {
     return GetValue(entry, val);
@@ -1033,6 +1181,91 @@ Status BundleReader::Lookup(StringPiece key, Tensor* val) {
   }
 }
 
+namespace {
+
+// A read-only tensor buffer that refers to a memory mapping of a data file.
+class MappedTensorBuffer : public TensorBuffer {
+ public:
+  MappedTensorBuffer(const char* data, size_t size,
+                     std::shared_ptr<ReadOnlyMemoryRegion> region)
+      : TensorBuffer(const_cast<char*>(data)),
+        size_(size),
+        region_(std::move(region)) {}
+
+  size_t size() const override { return size_; }
+  TensorBuffer* root_buffer() override { return this; }
+  void FillAllocationDescription(AllocationDescription* proto) const override {
+    proto->set_requested_bytes(size_);
+    proto->set_allocator_name("BundleReader::LookupMapped");
+  }
+  bool OwnsMemory() const override { return false; }
+
+ private:
+  const size_t size_;
+  const std::shared_ptr<ReadOnlyMemoryRegion> region_;
+};
+
+}  // namespace
+
+Status BundleReader::LookupMapped(absl::string_view key, Tensor* val) {
+  CHECK(val != nullptr);
+  BundleEntryProto entry;
+  Status s = GetBundleEntryProto(key, &entry);
+  if (errors::IsNotFound(s) && base_ != nullptr) {
+    return base_->LookupMapped(key, val);
+  }
+  TF_RETURN_IF_ERROR(s);
+  const TensorShape shape(entry.shape());
+
+  // Bundles that are known to be packed are not mapped in vain. The alignment
+  // of each entry is still checked, since it is unknown for old bundles.
+  const bool may_be_aligned =
+      data_alignment_ == 0 || data_alignment_ % EIGEN_MAX_ALIGN_BYTES == 0;
+  std::shared_ptr<ReadOnlyMemoryRegion> region;
+  if (may_be_aligned && entry.slices().empty() &&
+      DataTypeCanUseMemcpy(entry.dtype()) &&
+      !need_to_swap_bytes_ && entry.size() > 0 &&
+      cache_
+          ->GetMemoryRegion(
+              DataFilename(prefix_, entry.shard_id(), num_shards_), &region)
+          .ok()) {
+    if (entry.size() != shape.num_elements() * DataTypeSize(entry.dtype())) {
+      return errors::DataLoss("Invalid size in bundle entry: key ", key,
+                              "; stored size ", entry.size(),
+                              "; expected size ",
+                              shape.num_elements() *
+                                  DataTypeSize(entry.dtype()));
+    }
+    if (entry.offset() < 0 || entry.offset() > region->length() ||
+        region->length() - entry.offset() < entry.size()) {
+      return errors::DataLoss("Bundle entry ", key, " at offset ",
+                              entry.offset(), " with size ", entry.size(),
+                              " is out of bounds of data file shard ",
+                              entry.shard_id());
+    }
+    const char* data = static_cast<const char*>(region->data()) +
+                       entry.offset();
+    if (reinterpret_cast<uintptr_t>(data) % EIGEN_MAX_ALIGN_BYTES == 0) {
+      const uint32 actual_crc32c = crc32c::Value(data, entry.size());
+      if (crc32c::Unmask(entry.crc32c()) != actual_crc32c) {
+        return errors::DataLoss(
+            "TensorBundle at ", prefix_, " shard ", entry.shard_id(), " (",
+            entry.size(), " bytes): Checksum does not match: stored ",
+            strings::Printf("%08u", crc32c::Unmask(entry.crc32c())),
+            " vs. calculated on the mapped bytes ", actual_crc32c);
+      }
+      auto* buffer =
+          new MappedTensorBuffer(data, entry.size(), std::move(region));
+      *val = Tensor(entry.dtype(), shape, buffer);
+      buffer->Unref();
+      return absl::OkStatus();
+    }
+  }
+
+  *val = Tensor(entry.dtype(), shape);
+  return Lookup(key, val);
+}
+
 Status BundleReader::ReadCurrent(Tensor* val) {
   CHECK(val != nullptr);
   BundleEntryProto entry;
@@ -1055,7 +1288,11 @@ Status BundleReader::LookupTensorSlices(StringPiece key,
                                         std::vector<TensorSlice>* slices) {
   slices->clear();
   BundleEntryProto entry;
-  TF_RETURN_IF_ERROR(GetBundleEntryProto(key, &entry));
+  Status s = GetBundleEntryProto(key, &entry);
+  if (errors::IsNotFound(s) && base_ != nullptr) {
+    return base_->LookupTensorSlices(key, slices);
+  }
+  TF_RETURN_IF_ERROR(s);
   slices->reserve(entry.slices_size());
   for (const auto& slice : entry.slices()) {
     slices->emplace_back(slice);
@@ -1067,10 +1304,55 @@ Status BundleReader::LookupSlice(StringPiece full_tensor_key,
                                  const TensorSlice& slice_spec, Tensor* val) {
   CHECK(val != nullptr);
   BundleEntryProto entry;
-  TF_RETURN_IF_ERROR(GetBundleEntryProto(full_tensor_key, &entry));
+  Status s = GetBundleEntryProto(full_tensor_key, &entry);
+  if (errors::IsNotFound(s) && base_ != nullptr) {
+    return base_->LookupSlice(full_tensor_key, slice_spec, val);
+  }
+  TF_RETURN_IF_ERROR(s);
   return GetSliceValue(full_tensor_key, entry, slice_spec, val);
 }
 
+// Copies the intersection of "stored_slice" and "slice_spec" of a tensor of
+// shape "full_shape" from "stored" to "val".
+static Status CopySliceIntersection(DataType dtype,
+                                    const TensorShape& full_shape,
+                                    const TensorSlice& stored_slice,
+                                    const Tensor& stored,
+                                    const TensorSlice& slice_spec,
+                                    Tensor* val) {
+  switch (dtype) {
+#define HANDLE_COPY(T)                                                       \
+  case DataTypeToEnum<T>::value:                                             \
+    CHECK(CopyDataFromTensorSliceToTensorSlice(full_shape, stored_slice,     \
+                                               slice_spec,                   \
+                                               stored.flat<T>().data(),      \
+                                               val->flat<T>().data()));      \
+    break;
+
+    HANDLE_COPY(float)
+    HANDLE_COPY(double)
+    HANDLE_COPY(int32)
+    HANDLE_COPY(uint8)
+    HANDLE_COPY(int16)
+    HANDLE_COPY(int8)
+    HANDLE_COPY(complex64)
+    HANDLE_COPY(complex128)
+    HANDLE_COPY(int64_t)
+    HANDLE_COPY(bool)
+    HANDLE_COPY(qint32)
+    HANDLE_COPY(quint8)
+    HANDLE_COPY(qint8)
+    HANDLE_COPY(bfloat16)
+    HANDLE_COPY(int4)
+    HANDLE_COPY(uint4)
+    default:
+      return errors::InvalidArgument("Dtype ", DataTypeString(dtype),
+                                     " not supported.");
+  }
+#undef HANDLE_COPY
+  return absl::OkStatus();
+}
+
 Status BundleReader::GetSliceValue(StringPiece full_tensor_key,
                                    const BundleEntryProto& full_tensor_entry,
                                    const TensorSlice& slice_spec, Tensor* val) {
@@ -1104,6 +1386,10 @@ Status BundleReader::GetSliceValue(StringPiece full_tensor_key,
     CHECK_NE(tss, nullptr);
   }
   if (!tss->QueryMeta(slice_spec, &details)) {
+    if (base_ != nullptr) {
+      return GetDeltaSliceValue(full_tensor_key, full_tensor_entry, slice_spec,
+                                val);
+    }
     return errors::InvalidArgument(
         "Does not have sufficient slices for partitioned tensor ",
         full_tensor_key,
@@ -1154,49 +1440,54 @@ Status BundleReader::GetSliceValue(StringPiece full_tensor_key,
     if (!status_.ok()) return status_;
 
     // Copies the intersection over.
-    const DataType common_dtype = full_tensor_entry.dtype();
-    switch (common_dtype) {
-#define HANDLE_COPY(T)                                                 \
-  case DataTypeToEnum<T>::value:                                       \
-    CHECK(CopyDataFromTensorSliceToTensorSlice(                        \
-        full_shape, stored_slice, slice_spec,                          \
-        stored_slice_tensor.flat<T>().data(), val->flat<T>().data())); \
-    break;
+    TF_RETURN_IF_ERROR(CopySliceIntersection(
+        full_tensor_entry.dtype(), full_shape, stored_slice,
+        stored_slice_tensor, slice_spec, val));
+  }
+  return absl::OkStatus();
+}
 
-      HANDLE_COPY(float)
-      HANDLE_COPY(double)
-      HANDLE_COPY(int32)
-      HANDLE_COPY(uint8)
-      HANDLE_COPY(int16)
-      HANDLE_COPY(int8)
-      HANDLE_COPY(complex64)
-      HANDLE_COPY(complex128)
-      HANDLE_COPY(int64_t)
-      HANDLE_COPY(bool)
-      HANDLE_COPY(qint32)
-      HANDLE_COPY(quint8)
-      HANDLE_COPY(qint8)
-      HANDLE_COPY(bfloat16)
-      HANDLE_COPY(int4)
-      HANDLE_COPY(uint4)
-      default:
-        return errors::InvalidArgument("Dtype ", DataTypeString(common_dtype),
-                                       " not supported.");
-    }
-#undef HANDLE_COPY
+Status BundleReader::GetDeltaSliceValue(
+    StringPiece full_tensor_key, const BundleEntryProto& full_tensor_entry,
+    const TensorSlice& slice_spec, Tensor* val) {
+  // Reads the slice from the base, then overwrites the rows stored here.
+  TF_RETURN_IF_ERROR(base_->LookupSlice(full_tensor_key, slice_spec, val));
+  const TensorShape full_shape(full_tensor_entry.shape());
+  const string full_tensor_key_string(full_tensor_key);
+  BundleEntryProto stored_slice_entry;
+  for (const TensorSliceProto& proto : full_tensor_entry.slices()) {
+    const TensorSlice stored_slice(proto);
+    if (!stored_slice.Overlaps(slice_spec)) continue;
+    status_ = GetBundleEntryProto(
+        checkpoint::EncodeTensorNameSlice(full_tensor_key_string,
+                                          stored_slice),
+        &stored_slice_entry);
+    if (!status_.ok()) return status_;
+    Tensor stored_slice_tensor(stored_slice_entry.dtype(),
+                               TensorShape(stored_slice_entry.shape()));
+    status_ = GetValue(stored_slice_entry, &stored_slice_tensor);
+    if (!status_.ok()) return status_;
+    TF_RETURN_IF_ERROR(CopySliceIntersection(
+        full_tensor_entry.dtype(), full_shape, stored_slice,
+        stored_slice_tensor, slice_spec, val));
   }
   return absl::OkStatus();
 }
 
 bool BundleReader::Contains(StringPiece key) {
   Seek(key);
-  return Valid() && (this->key() == key);
+  if (Valid() && this->key() == key) return true;
+  return base_ != nullptr && base_->Contains(key);
 }
 
 Status BundleReader::LookupDtypeAndShape(StringPiece key, DataType* dtype,
                                          TensorShape* shape) {
   BundleEntryProto entry;
-  TF_RETURN_IF_ERROR(GetBundleEntryProto(key, &entry));
+  Status s = GetBundleEntryProto(key, &entry);
+  if (errors::IsNotFound(s) && base_ != nullptr) {
+    return base_->LookupDtypeAndShape(key, dtype, shape);
+  }
+  TF_RETURN_IF_ERROR(s);
   *dtype = entry.dtype();
   *shape = TensorShape(entry.shape());
   return absl::OkStatus();
@@ -1223,19 +1514,136 @@ string BundleReader::DebugString() {
   return shape_str;
 }
 
+// Lists the keys of the full tensors stored by "reader", excluding its base
+// bundles and the keys of the stored slices of partitioned tensors.
+static Status ListStoredTensors(BundleReader* reader,
+                                std::vector<string>* keys) {
+  absl::flat_hash_set<string> slice_keys;
+  BundleEntryProto entry;
+  reader->Seek(kHeaderEntryKey);
+  for (reader->Next(); reader->Valid(); reader->Next()) {
+    TF_RETURN_IF_ERROR(
+        ParseEntryProto(reader->key(), reader->value(), &entry));
+    for (const TensorSliceProto& slice : entry.slices()) {
+      slice_keys.insert(checkpoint::EncodeTensorNameSlice(
+          string(reader->key()), TensorSlice(slice)));
+    }
+    keys->emplace_back(reader->key());
+  }
+  keys->erase(std::remove_if(keys->begin(), keys->end(),
+                             [&](const string& key) {
+                               return slice_keys.contains(key);
+                             }),
+              keys->end());
+  return absl::OkStatus();
+}
+
+Status FoldBundles(Env* env, absl::Span<const tstring> prefixes,
+                   StringPiece folded_prefix,
+                   const BundleWriter::Options& options) {
+  if (!options.base_prefix.empty()) {
+    return errors::InvalidArgument("A folded bundle can't be a delta bundle: ",
+                                   folded_prefix);
+  }
+  std::vector<std::unique_ptr<BundleReader>> readers;
+  // The indices of the readers that store each tensor, in order, and the
+  // first base bundle that stores it.
+  std::map<string, std::vector<int>> stored;
+  std::map<string, BundleReader*> stored_in_base;
+  for (const tstring& prefix : prefixes) {
+    auto reader = std::make_unique<BundleReader>(env, prefix);
+    TF_RETURN_IF_ERROR(reader->status());
+    std::vector<string> keys;
+    TF_RETURN_IF_ERROR(ListStoredTensors(reader.get(), &keys));
+    for (string& key : keys) {
+      stored[std::move(key)].push_back(readers.size());
+    }
+    for (BundleReader* base = reader->base(); base != nullptr;
+         base = base->base()) {
+      keys.clear();
+      TF_RETURN_IF_ERROR(ListStoredTensors(base, &keys));
+      for (string& key : keys) stored_in_base.emplace(std::move(key), base);
+    }
+    readers.push_back(std::move(reader));
+  }
+  for (const auto& p : stored_in_base) stored[p.first];
+
+  BundleWriter writer(env, folded_prefix, options);
+  TF_RETURN_IF_ERROR(writer.status());
+  for (const auto& [key, indices] : stored) {
+    const auto base_it = stored_in_base.find(key);
+    BundleReader* const base =
+        base_it == stored_in_base.end() ? nullptr : base_it->second;
+    DataType dtype;
+    TensorShape shape;
+    TF_RETURN_IF_ERROR((base != nullptr ? base : readers[indices[0]].get())
+                           ->LookupDtypeAndShape(key, &dtype, &shape));
+    Tensor val(dtype, shape);
+    // Whether "val" is fully initialized, or else the number of elements that
+    // the stored slices copied over it.
+    bool is_full = false;
+    int64_t num_copied = 0;
+    if (base != nullptr) {
+      TF_RETURN_IF_ERROR(base->Lookup(key, &val));
+      is_full = true;
+    }
+    for (int index : indices) {
+      BundleReader* const reader = readers[index].get();
+      DataType stored_dtype;
+      TensorShape stored_shape;
+      TF_RETURN_IF_ERROR(
+          reader->LookupDtypeAndShape(key, &stored_dtype, &stored_shape));
+      if (stored_dtype != dtype || stored_shape != shape) {
+        return errors::InvalidArgument(
+            "Tensor ", key, " is stored as ", DataTypeString(stored_dtype),
+            stored_shape.DebugString(), " in ", prefixes[index], " but as ",
+            DataTypeString(dtype), shape.DebugString(), " elsewhere");
+      }
+      std::vector<TensorSlice> slices;
+      TF_RETURN_IF_ERROR(reader->LookupTensorSlices(key, &slices));
+      if (slices.empty()) {
+        TF_RETURN_IF_ERROR(reader->Lookup(key, &val));
+        is_full = true;
+        continue;
+      }
+      for (const TensorSlice& slice : slices) {
+        TensorShape slice_shape;
+        TF_RETURN_IF_ERROR(slice.SliceTensorShape(shape, &slice_shape));
+        Tensor slice_val(dtype, slice_shape);
+        TF_RETURN_IF_ERROR(reader->LookupSlice(key, slice, &slice_val));
+        TF_RETURN_IF_ERROR(CopySliceIntersection(
+            dtype, shape, slice, slice_val, TensorSlice(shape.dims()), &val));
+        num_copied += slice_shape.num_elements();
+      }
+    }
+    // The stored slices of a partitioned tensor are disjoint, so they cover
+    // the tensor iff they have as many elements as it does.
+    if (!is_full && num_copied < shape.num_elements()) {
+      return errors::InvalidArgument(
+          "The stored slices of partitioned tensor ", key,
+          " don't cover its shape ", shape.DebugString());
+    }
+    TF_RETURN_IF_ERROR(writer.Add(key, val));
+  }
+  TF_RETURN_IF_ERROR(writer.Finish());
+  VLOG(1) << "Folded " << prefixes.size() << " bundles to " << folded_prefix;
+  return absl::OkStatus();
+}
+
 BundleCache::BundleCache(Env* env) : env_(env) {}
 
+BundleCache::FileState* BundleCache::GetFileState(const std::string& name) {
+  absl::MutexLock l(&mu_);
+  auto& slot = opened_files_[name];
+  if (slot == nullptr) {
+    slot = std::make_unique<FileState>();
+  }
+  return slot.get();
+}
+
 BundleCache::FileState* BundleCache::EnsureOpened(std::string name) {
   // Get the file, opening it if necessary.
-  FileState* f;
-  {
-    absl::MutexLock l(&mu_);
-    auto& slot = opened_files_[name];
-    if (slot == nullptr) {
-      slot = std::make_unique<FileState>();
-    }
-    f = slot.get();
-  }
+  FileState* f = GetFileState(name);
 
   // Open the file or wait for a concurrent open to complete. We do not hold
   // mu_ here to avoid blocking threads reading from other files.
@@ -1252,6 +1660,18 @@ Status BundleCache::GetFile(const std::string& fname, RandomAccessFile** file) {
   return f->open_status;
 }
 
+Status BundleCache::GetMemoryRegion(
+    const std::string& fname, std::shared_ptr<ReadOnlyMemoryRegion>* region) {
+  FileState* f = GetFileState(fname);
+  absl::call_once(f->map_once, [this, &fname, f] {
+    std::unique_ptr<ReadOnlyMemoryRegion> mapped;
+    f->map_status = env_->NewReadOnlyMemoryRegionFromFile(fname, &mapped);
+    f->region = std::move(mapped);
+  });
+  *region = f->region;
+  return f->map_status;
+}
+
 namespace {
 inline char* AlignedMalloc(size_t size) {
   char* buffer = static_cast<char*>(port::AlignedMalloc(size, 64));
@@ -75,6 +75,7 @@ limitations under the License.
 #include "tensorflow/core/framework/tensor.h"
 #include "tensorflow/core/framework/tensor_shape.h"
 #include "tensorflow/core/framework/tensor_slice.h"
+#include "tensorflow/core/lib/core/threadpool.h"
 #include "tensorflow/core/lib/gtl/array_slice.h"
 #include "tensorflow/core/lib/io/cache.h"
 #include "tensorflow/core/lib/io/inputbuffer.h"
@@ -117,8 +118,15 @@ class BundleWriter {
   struct Options {
     Options() {}
     // Alignment, in bytes, for tensor data.
-    // Must be >= 1. The default size of 1 densely packs tensors.
+    // Must be >= 1. The default size of 1 densely packs tensors. An alignment
+    // of 64 or of the page size lets "BundleReader::LookupMapped()" return
+    // tensors that alias the data files instead of copies. The alignment is
+    // recorded in the header of the bundle.
     int data_alignment{1};
+    // If set, the bundle is a delta bundle on top of the bundle at this
+    // prefix (see "BundleHeaderProto.base_prefix"), e.g. only the rows of
+    // sparsely updated variables that changed since that bundle was written.
+    std::string base_prefix;
   };
   BundleWriter(Env* env, absl::string_view prefix,
                const Options& options = Options());
@@ -180,7 +188,8 @@ class BundleWriter {
 // guarantee not to re-order the input data files.
 //
 // Once merged, makes a best effort to delete the old metadata files.
-// Returns OK iff all bundles are successfully merged.
+// Returns OK iff all bundles are successfully merged.  Delta bundles can only
+// be merged with bundles on top of the same base.
 //
 // "allow_missing_files": If set to true, merges "prefixes" as long as
 // at least one file exists. (Defaults to false.)
@@ -194,12 +203,64 @@ Status MergeBundles(Env* env, absl::Span<const tstring> prefixes,
                     absl::string_view merged_prefix,
                     bool allow_missing_files = false);
 
+// A tensor, or a slice of a larger tensor, to be written by
+// WriteBundleInParallel().
+struct BundleWriteEntry {
+  std::string key;
+  Tensor tensor;
+  // If set, "tensor" holds "slice_spec" of a tensor of shape "full_shape", as
+  // in BundleWriter::AddSlice().
+  bool is_slice = false;
+  TensorShape full_shape;
+  TensorSlice slice_spec;
+};
+
+// Writes "entries" as a bundle at "prefix" with up to "num_shards" data files,
+// which are written concurrently on "thread_pool", or one after the other if
+// it is null.  Tensors are balanced across the shards by size, and all slices
+// of a tensor are written to the same shard.
+//
+// Each shard is written as a temporary bundle next to "prefix" and the shards
+// are then merged with MergeBundles(), so the metadata file of "prefix" is
+// only written once all the data files are complete.  With "num_shards" <= 1
+// this is equivalent to adding all entries to a single BundleWriter.
+Status WriteBundleInParallel(
+    Env* env, absl::string_view prefix,
+    absl::Span<const BundleWriteEntry> entries, int num_shards,
+    thread::ThreadPool* thread_pool,
+    const BundleWriter::Options& options = BundleWriter::Options());
+
+// Writes a self-contained bundle at "folded_prefix" holding every tensor of
+// the bundles at "prefixes" and of their chains of base bundles, e.g. to fold
+// the delta bundles that each task wrote independently, without merging them,
+// on top of the last complete checkpoint.  Unlike MergeBundles(), the tensor
+// data is copied, so "prefixes" may be on a different filesystem than
+// "folded_prefix" and are left in place.
+//
+// A tensor stored by a bundle in "prefixes" takes precedence over its base
+// bundles.  A tensor stored by several bundles in "prefixes" is folded in
+// order: a full tensor replaces the previous contents and the slices of a
+// partitioned tensor are copied over them.  Folded tensors are stored whole.
+//
+// Returns an InvalidArgumentError if "options" would make the folded bundle a
+// delta bundle, or if the bundles disagree on the dtype or the shape of a
+// tensor.
+Status FoldBundles(
+    Env* env, absl::Span<const tstring> prefixes,
+    absl::string_view folded_prefix,
+    const BundleWriter::Options& options = BundleWriter::Options());
+
 class BundleCache;
 
 // On construction, silently attempts to read the metadata associated with
 // "prefix".  If caller intends to call any function afterwards, "status()"
 // must be checked.
 // All threads accessing the same BundleReader must synchronize.
+//
+// A delta bundle is read on top of its chain of base bundles, which are opened
+// on construction: lookups of tensors that the delta bundle does not store,
+// or does not fully cover with slices, fall back to the base bundles.  The
+// iteration methods (Seek(), Next(), ...) only visit the entries of "prefix".
 class BundleReader {
  public:
   BundleReader(Env* const env, absl::string_view prefix,
@@ -221,6 +282,11 @@ class BundleReader {
   // the metadata).
   Status status() const { return status_; }
 
+  // The alignment in bytes of the tensor data in the data files, as recorded
+  // by the writer, or 0 if unknown.
+  // REQUIRES: status().ok()
+  int64_t data_alignment() const { return data_alignment_; }
+
   // Queries whether the bundle contains an entry keyed by "key".  Calls Seek()
   // internally, so this call invalidates the reader's current position.
   // REQUIRES: status().ok()
@@ -264,6 +330,21 @@ class BundleReader {
   // REQUIRES: status().ok()
   Status Lookup(absl::string_view key, Tensor* val) TF_MUST_USE_RESULT;
 
+  // Like "Lookup()", but "val" is replaced by a tensor that refers to a
+  // read-only memory mapping of the data file instead of a copy of its data,
+  // if the tensor is not partitioned, has a type that can be copied with
+  // memcpy, is stored in the byte order of this machine, and is stored at an
+  // offset that is aligned for Eigen (see "BundleWriter::Options"). Otherwise
+  // "val" is replaced by a newly allocated tensor filled by "Lookup()".
+  //
+  // The mapping remains valid for as long as the returned tensor, even after
+  // the reader and its cache are destroyed. The returned tensor must not be
+  // modified.
+  //
+  // Validates the stored crc32c checksum against the mapped bytes.
+  // REQUIRES: status().ok()
+  Status LookupMapped(absl::string_view key, Tensor* val) TF_MUST_USE_RESULT;
+
   // Looks up the tensor pointed to by the internal iterator.
   //
   // On error, "val" may contain nonsense data.
@@ -310,6 +391,10 @@ class BundleReader {
 
   std::string DebugString();
 
+  // The reader of the base bundle of a delta bundle, or null.
+  // REQUIRES: status().ok()
+  BundleReader* base() const { return base_.get(); }
+
  private:
   // Seeks for "key" and reads the metadata proto.
   // On non-OK return, clears "entry" for the caller.
@@ -330,6 +415,15 @@ class BundleReader {
                        const TensorSlice& slice_spec,
                        Tensor* val) TF_MUST_USE_RESULT;
 
+  // Like "GetSliceValue()", for a slice of a delta bundle that the stored
+  // slices do not cover: the base bundle is read and the stored slices are
+  // copied over it.
+  // REQUIRES: base_ != nullptr
+  Status GetDeltaSliceValue(absl::string_view full_tensor_key,
+                            const BundleEntryProto& full_tensor_entry,
+                            const TensorSlice& slice_spec,
+                            Tensor* val) TF_MUST_USE_RESULT;
+
   Env* env_;  // Not owned.
   const std::string prefix_;
   std::unique_ptr<BundleCache> owned_cache_;  // may be null
@@ -356,6 +450,12 @@ class BundleReader {
   // differs from that of the current system's processor architecture.
   bool need_to_swap_bytes_;
 
+  // Alignment of the tensor data recorded in the header, or 0 if unknown.
+  int64_t data_alignment_ = 0;
+
+  // The reader of the base bundle of a delta bundle, or null.
+  std::unique_ptr<BundleReader> base_;
+
   friend class TensorBundleAlignmentTest;  // For testing data alignment.
 
   bool enable_multi_threading_for_testing_ = false;
@@ -401,6 +501,11 @@ class BundleCache {
   // while the BundleCache lives.
   Status GetFile(const std::string& fname, RandomAccessFile** file);
 
+  // Get a read-only memory mapping of fname, mapping it if necessary. The
+  // result may outlive the BundleCache.
+  Status GetMemoryRegion(const std::string& fname,
+                         std::shared_ptr<ReadOnlyMemoryRegion>* region);
+
  private:
   // State for each opened file (opened on first read).
   struct FileState {
@@ -408,8 +513,13 @@ class BundleCache {
 
     std::unique_ptr<RandomAccessFile> file;
     Status open_status;  // Records any error encountered on open
+
+    absl::once_flag map_once;  // Ensures file is mapped at most once.
+    std::shared_ptr<ReadOnlyMemoryRegion> region;
+    Status map_status;  // Records any error encountered on mapping
   };
 
+  FileState* GetFileState(const std::string& name);
   FileState* EnsureOpened(std::string name);
 
   Env* const env_;
@@ -24,6 +24,9 @@ limitations under the License.
 #endif  // _WIN32
 
 #include "absl/status/status.h"
+#include "absl/strings/match.h"
+#include "tensorflow/core/framework/allocation_description.pb.h"
+#include "tensorflow/core/framework/tensor_description.pb.h"
 #include "tensorflow/core/framework/tensor_testutil.h"
 #include "tensorflow/core/framework/tensor_util.h"
 #include "tensorflow/core/framework/types.pb.h"
@@ -1270,6 +1273,285 @@ TEST_F(TensorBundleAlignmentTest, AlignmentTest) {
   }
 }
 
+std::string AllocatorName(const Tensor& tensor) {
+  TensorDescription description;
+  tensor.FillDescription(&description);
+  return description.allocation_description().allocator_name();
+}
+
+TEST(TensorBundleTest, LookupMapped) {
+  {
+    BundleWriter::Options opts;
+    opts.data_alignment = 64;
+    BundleWriter writer(Env::Default(), Prefix("foo"), opts);
+    TF_EXPECT_OK(writer.Add("float", Constant_100x100<float>(3)));
+    TF_EXPECT_OK(writer.Add("int", Constant_2x3<int32>(2)));
+    TF_EXPECT_OK(writer.Add("string", Constant_2x3<tstring>("foo")));
+    TF_ASSERT_OK(writer.Finish());
+  }
+  Tensor mapped;
+  {
+    BundleReader reader(Env::Default(), Prefix("foo"));
+    TF_ASSERT_OK(reader.status());
+    EXPECT_EQ(reader.data_alignment(), 64);
+    TF_ASSERT_OK(reader.LookupMapped("float", &mapped));
+    test::ExpectTensorEqual<float>(mapped, Constant_100x100<float>(3));
+    EXPECT_EQ(AllocatorName(mapped), "BundleReader::LookupMapped");
+
+    Tensor int_tensor;
+    TF_ASSERT_OK(reader.LookupMapped("int", &int_tensor));
+    test::ExpectTensorEqual<int32>(int_tensor, Constant_2x3<int32>(2));
+    EXPECT_EQ(AllocatorName(int_tensor), "BundleReader::LookupMapped");
+
+    // String tensors are copied.
+    Tensor string_tensor;
+    TF_ASSERT_OK(reader.LookupMapped("string", &string_tensor));
+    test::ExpectTensorEqual<tstring>(string_tensor,
+                                     Constant_2x3<tstring>("foo"));
+    EXPECT_NE(AllocatorName(string_tensor), "BundleReader::LookupMapped");
+
+    EXPECT_TRUE(absl::IsNotFound(reader.LookupMapped("missing", &mapped)));
+  }
+  // The mapping outlives the reader.
+  test::ExpectTensorEqual<float>(mapped, Constant_100x100<float>(3));
+}
+
+TEST(TensorBundleTest, LookupMappedUnaligned) {
+  {
+    BundleWriter::Options opts;
+    opts.data_alignment = 1;
+    BundleWriter writer(Env::Default(), Prefix("foo"), opts);
+    TF_EXPECT_OK(writer.Add("a", Constant(static_cast<int8>(1),
+                                          TensorShape({1}))));
+    TF_EXPECT_OK(writer.Add("b", Constant_2x3<float>(2)));
+    TF_ASSERT_OK(writer.Finish());
+  }
+  BundleReader reader(Env::Default(), Prefix("foo"));
+  TF_ASSERT_OK(reader.status());
+  EXPECT_EQ(reader.data_alignment(), 1);
+  Tensor tensor;
+  TF_ASSERT_OK(reader.LookupMapped("b", &tensor));
+  test::ExpectTensorEqual<float>(tensor, Constant_2x3<float>(2));
+  EXPECT_NE(AllocatorName(tensor), "BundleReader::LookupMapped");
+}
+
+TEST(TensorBundleTest, MergeRecordsDataAlignment) {
+  for (const auto& [prefix, alignment] :
+       {std::pair<std::string, int>{"foo", 4096}, {"bar", 64}}) {
+    BundleWriter::Options opts;
+    opts.data_alignment = alignment;
+    BundleWriter writer(Env::Default(), Prefix(prefix), opts);
+    TF_EXPECT_OK(writer.Add(prefix, Constant_2x3<float>(1)));
+    TF_ASSERT_OK(writer.Finish());
+  }
+  TF_ASSERT_OK(MergeBundles(Env::Default(), {Prefix("foo"), Prefix("bar")},
+                            Prefix("merged")));
+  BundleReader reader(Env::Default(), Prefix("merged"));
+  TF_ASSERT_OK(reader.status());
+  EXPECT_EQ(reader.data_alignment(), 64);
+  Tensor tensor;
+  TF_ASSERT_OK(reader.LookupMapped("foo", &tensor));
+  test::ExpectTensorEqual<float>(tensor, Constant_2x3<float>(1));
+  EXPECT_EQ(AllocatorName(tensor), "BundleReader::LookupMapped");
+}
+
+TEST(TensorBundleTest, WriteBundleInParallel) {
+  const TensorShape kFullShape({2, 3});
+  std::vector<BundleWriteEntry> entries(5);
+  entries[0].key = "big";
+  entries[0].tensor = Constant_100x100<float>(1);
+  entries[1].key = "small";
+  entries[1].tensor = Constant_2x3<int32>(2);
+  entries[2].key = "medium";
+  entries[2].tensor = Constant<double>(3, TensorShape({50}));
+  for (int i = 0; i < 2; ++i) {
+    entries[3 + i].key = "sliced";
+    entries[3 + i].tensor = Constant<float>(4 + i, TensorShape({1, 3}));
+    entries[3 + i].is_slice = true;
+    entries[3 + i].full_shape = kFullShape;
+    entries[3 + i].slice_spec = TensorSlice::ParseOrDie(i == 0 ? "0,1:-"
+                                                               : "1,1:-");
+  }
+  thread::ThreadPool pool(Env::Default(), "writers", 3);
+  TF_ASSERT_OK(WriteBundleInParallel(Env::Default(), Prefix("parallel"),
+                                     entries, /*num_shards=*/3, &pool));
+
+  BundleReader reader(Env::Default(), Prefix("parallel"));
+  TF_ASSERT_OK(reader.status());
+  Expect<float>(&reader, "big", Constant_100x100<float>(1));
+  Expect<int32>(&reader, "small", Constant_2x3<int32>(2));
+  Expect<double>(&reader, "medium", Constant<double>(3, TensorShape({50})));
+  Tensor sliced(DT_FLOAT, kFullShape);
+  TF_ASSERT_OK(reader.Lookup("sliced", &sliced));
+  test::ExpectTensorEqual<float>(
+      sliced, test::AsTensor<float>({4, 4, 4, 5, 5, 5}, kFullShape));
+
+  // Each shard has its own data file, and no temporary bundles remain.
+  std::vector<string> paths;
+  TF_ASSERT_OK(Env::Default()->GetMatchingPaths(
+      strings::StrCat(Prefix("parallel"), ".data-*"), &paths));
+  EXPECT_EQ(paths.size(), 3);
+  TF_ASSERT_OK(Env::Default()->GetMatchingPaths(
+      strings::StrCat(Prefix("parallel"), "_temp_*"), &paths));
+  EXPECT_TRUE(paths.empty());
+}
+
+TEST(TensorBundleTest, WriteBundleInParallelSingleShard) {
+  std::vector<BundleWriteEntry> entries(1);
+  entries[0].key = "foo";
+  entries[0].tensor = Constant_2x3<float>(1);
+  TF_ASSERT_OK(WriteBundleInParallel(Env::Default(), Prefix("single"),
+                                     entries, /*num_shards=*/4,
+                                     /*thread_pool=*/nullptr));
+  BundleReader reader(Env::Default(), Prefix("single"));
+  TF_ASSERT_OK(reader.status());
+  Expect<float>(&reader, "foo", Constant_2x3<float>(1));
+  TF_EXPECT_OK(
+      Env::Default()->FileExists(DataFilename(Prefix("single"), 0, 1)));
+}
+
+TEST(TensorBundleTest, DeltaBundles) {
+  const TensorShape kShape({4, 2});
+  {
+    BundleWriter writer(Env::Default(), Prefix("base"));
+    TF_EXPECT_OK(writer.Add("dense", Constant_2x3<float>(1)));
+    TF_EXPECT_OK(writer.Add("rows", test::AsTensor<float>(
+                                        {0, 0, 1, 1, 2, 2, 3, 3}, kShape)));
+    TF_EXPECT_OK(writer.Add("unchanged", Constant_2x3<int32>(5)));
+    TF_ASSERT_OK(writer.Finish());
+  }
+  {
+    BundleWriter::Options options;
+    options.base_prefix = Prefix("base");
+    BundleWriter writer(Env::Default(), Prefix("delta1"), options);
+    TF_EXPECT_OK(writer.Add("dense", Constant_2x3<float>(2)));
+    TF_EXPECT_OK(writer.AddSlice("rows", kShape,
+                                 TensorSlice::ParseOrDie("1,2:-"),
+                                 Constant<float>(10, TensorShape({2, 2}))));
+    TF_ASSERT_OK(writer.Finish());
+  }
+  {
+    // A relative base prefix is resolved against the directory of the delta.
+    BundleWriter::Options options;
+    options.base_prefix = "delta1";
+    BundleWriter writer(Env::Default(), Prefix("delta2"), options);
+    TF_EXPECT_OK(writer.AddSlice("rows", kShape,
+                                 TensorSlice::ParseOrDie("3,1:-"),
+                                 Constant<float>(20, TensorShape({1, 2}))));
+    TF_ASSERT_OK(writer.Finish());
+  }
+
+  BundleReader reader(Env::Default(), Prefix("delta2"));
+  TF_ASSERT_OK(reader.status());
+  Expect<float>(&reader, "dense", Constant_2x3<float>(2));
+  Expect<int32>(&reader, "unchanged", Constant_2x3<int32>(5));
+  Expect<float>(&reader, "rows",
+                test::AsTensor<float>({0, 0, 10, 10, 10, 10, 20, 20}, kShape));
+  Tensor slice(DT_FLOAT, TensorShape({2, 2}));
+  TF_ASSERT_OK(
+      reader.LookupSlice("rows", TensorSlice::ParseOrDie("0,2:-"), &slice));
+  test::ExpectTensorEqual<float>(
+      slice, test::AsTensor<float>({0, 0, 10, 10}, TensorShape({2, 2})));
+  EXPECT_FALSE(reader.Contains("missing"));
+  Tensor missing;
+  EXPECT_TRUE(errors::IsNotFound(reader.Lookup("missing", &missing)));
+
+  // Bundles on top of different bases cannot be merged.
+  EXPECT_TRUE(errors::IsInvalidArgument(MergeBundles(
+      Env::Default(), {Prefix("delta1"), Prefix("delta2")}, Prefix("merged"))));
+}
+
+TEST(TensorBundleTest, DeltaBundleWithMissingBase) {
+  {
+    BundleWriter::Options options;
+    options.base_prefix = Prefix("nonexistent_base");
+    BundleWriter writer(Env::Default(), Prefix("orphan"), options);
+    TF_EXPECT_OK(writer.Add("foo", Constant_2x3<float>(1)));
+    TF_ASSERT_OK(writer.Finish());
+  }
+  BundleReader reader(Env::Default(), Prefix("orphan"));
+  EXPECT_TRUE(errors::IsNotFound(reader.status()));
+  EXPECT_TRUE(absl::StrContains(reader.status().message(), "base bundle"));
+}
+
+TEST(TensorBundleTest, FoldBundles) {
+  const TensorShape kShape({4, 2});
+  {
+    BundleWriter writer(Env::Default(), Prefix("fold_base"));
+    TF_EXPECT_OK(writer.Add("dense", Constant_2x3<float>(1)));
+    TF_EXPECT_OK(writer.Add("rows", test::AsTensor<float>(
+                                        {0, 0, 1, 1, 2, 2, 3, 3}, kShape)));
+    TF_EXPECT_OK(writer.Add("unchanged", Constant_2x3<int32>(5)));
+    TF_ASSERT_OK(writer.Finish());
+  }
+  // Two tasks write the state they changed on top of the same base.
+  BundleWriter::Options options;
+  options.base_prefix = Prefix("fold_base");
+  {
+    BundleWriter writer(Env::Default(), Prefix("fold_task0"), options);
+    TF_EXPECT_OK(writer.Add("dense", Constant_2x3<float>(2)));
+    TF_EXPECT_OK(writer.AddSlice("rows", kShape,
+                                 TensorSlice::ParseOrDie("1,1:-"),
+                                 Constant<float>(10, TensorShape({1, 2}))));
+    TF_ASSERT_OK(writer.Finish());
+  }
+  {
+    BundleWriter writer(Env::Default(), Prefix("fold_task1"), options);
+    TF_EXPECT_OK(writer.AddSlice("rows", kShape,
+                                 TensorSlice::ParseOrDie("3,1:-"),
+                                 Constant<float>(20, TensorShape({1, 2}))));
+    TF_EXPECT_OK(writer.Add("added", Constant_2x3<int32>(7)));
+    TF_ASSERT_OK(writer.Finish());
+  }
+
+  TF_ASSERT_OK(FoldBundles(Env::Default(),
+                           {Prefix("fold_task0"), Prefix("fold_task1")},
+                           Prefix("folded")));
+  BundleReader reader(Env::Default(), Prefix("folded"));
+  TF_ASSERT_OK(reader.status());
+  EXPECT_EQ(reader.base(), nullptr);
+  Expect<float>(&reader, "dense", Constant_2x3<float>(2));
+  Expect<int32>(&reader, "unchanged", Constant_2x3<int32>(5));
+  Expect<int32>(&reader, "added", Constant_2x3<int32>(7));
+  Expect<float>(&reader, "rows",
+                test::AsTensor<float>({0, 0, 10, 10, 2, 2, 20, 20}, kShape));
+  std::vector<TensorSlice> slices;
+  TF_ASSERT_OK(reader.LookupTensorSlices("rows", &slices));
+  EXPECT_TRUE(slices.empty());
+  // The deltas are left in place.
+  TF_EXPECT_OK(Env::Default()->FileExists(MetaFilename(Prefix("fold_task0"))));
+
+  // A folded bundle is never a delta bundle.
+  EXPECT_TRUE(errors::IsInvalidArgument(
+      FoldBundles(Env::Default(), {Prefix("fold_task0")},
+                  Prefix("folded_delta"), options)));
+}
+
+TEST(TensorBundleTest, FoldBundlesErrors) {
+  {
+    BundleWriter writer(Env::Default(), Prefix("fold_a"));
+    TF_EXPECT_OK(writer.Add("foo", Constant_2x3<float>(1)));
+    TF_EXPECT_OK(writer.AddSlice("part", TensorShape({4}),
+                                 TensorSlice::ParseOrDie("0,2"),
+                                 Constant<float>(1, TensorShape({2}))));
+    TF_ASSERT_OK(writer.Finish());
+  }
+  {
+    BundleWriter writer(Env::Default(), Prefix("fold_b"));
+    TF_EXPECT_OK(writer.Add("foo", Constant<float>(1, TensorShape({3}))));
+    TF_ASSERT_OK(writer.Finish());
+  }
+  // The slices of "part" don't cover it and nothing else stores it.
+  EXPECT_TRUE(errors::IsInvalidArgument(FoldBundles(
+      Env::Default(), {Prefix("fold_a")}, Prefix("folded_a"))));
+  // The bundles disagree on the shape of "foo".
+  EXPECT_TRUE(errors::IsInvalidArgument(
+      FoldBundles(Env::Default(), {Prefix("fold_b"), Prefix("fold_a")},
+                  Prefix("folded_ab"))));
+  EXPECT_TRUE(errors::IsNotFound(FoldBundles(
+      Env::Default(), {Prefix("fold_missing")}, Prefix("folded_missing"))));
+}
+
 static void BM_BundleAlignment(::testing::benchmark::State& state) {
   {
     const int alignment = state.range(0);
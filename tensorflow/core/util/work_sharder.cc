@@ -16,10 +16,13 @@ limitations under the License.
 #include "tensorflow/core/util/work_sharder.h"
 
 #include <algorithm>
+#include <atomic>
+#include <cmath>
 #include <functional>
 
 #include "xla/tsl/util/env_var.h"
 #include "tensorflow/core/platform/blocking_counter.h"
+#include "tensorflow/core/platform/env_time.h"
 #include "tensorflow/core/platform/logging.h"
 #include "tsl/profiler/lib/traceme.h"
 
@@ -105,7 +108,11 @@ void Sharder::Do(int64_t total, int64_t cost_per_unit, const Work& work,
   const int num_shards =
       std::max<int>(1, std::min(static_cast<int64_t>(max_parallelism),
                                 total * cost_per_unit / kMinCostPerShard));
+  DoInShards(total, num_shards, work, runner);
+}
 
+void Sharder::DoInShards(int64_t total, int num_shards, const Work& work,
+                         const Runner& runner) {
   // Each shard contains up to "block_size" units. [0, total) is sharded
   // into:
   //   [0, block_size), [block_size, 2*block_size), ...
@@ -133,4 +140,55 @@ void Sharder::Do(int64_t total, int64_t cost_per_unit, const Work& work,
   counter.Wait();
 }
 
+void AdaptiveShardCost::Record(int64_t units, int64_t nanos) {
+  if (units <= 0) return;
+  const double measured = static_cast<double>(nanos) / units;
+  // The first measurement replaces the initial estimate, the later ones are
+  // smoothed since the time of a call varies with the load of the machine.
+  // Concurrent calls may lose an update, which only delays the convergence.
+  if (!measured_.exchange(true, std::memory_order_relaxed)) {
+    cost_per_unit_.store(measured, std::memory_order_relaxed);
+    return;
+  }
+  const double previous = cost_per_unit_.load(std::memory_order_relaxed);
+  cost_per_unit_.store(previous + (measured - previous) / 4,
+                       std::memory_order_relaxed);
+}
+
+void AdaptiveShard(int max_parallelism, thread::ThreadPool* workers,
+                   int64_t total, AdaptiveShardCost* cost,
+                   std::function<void(int64_t, int64_t)> work) {
+  CHECK_GE(total, 0);
+  if (total == 0) {
+    return;
+  }
+  max_parallelism = std::min(max_parallelism, GetPerThreadMaxParallelism());
+  const double max_shards_of_min_size =
+      std::floor(cost->cost_per_unit() * total / cost->min_shard_nanos());
+  const int num_shards = static_cast<int>(
+      std::max(1.0, std::min<double>(max_parallelism, max_shards_of_min_size)));
+  tsl::profiler::TraceMe trace_me([=]() {
+    return tsl::profiler::TraceMeEncode(
+        "AdaptiveShard", {{"cost_per_unit", cost->cost_per_unit()},
+                          {"total", total},
+                          {"num_shards", num_shards}});
+  });
+
+  std::atomic<int64_t> busy_nanos(0);
+  auto timed_work = [&work, &busy_nanos](int64_t start, int64_t limit) {
+    const uint64 start_nanos = EnvTime::NowNanos();
+    work(start, limit);
+    busy_nanos.fetch_add(EnvTime::NowNanos() - start_nanos,
+                         std::memory_order_relaxed);
+  };
+  if (num_shards <= 1) {
+    timed_work(0, total);
+  } else {
+    Sharder::DoInShards(
+        total, num_shards, timed_work,
+        [workers](Sharder::Closure c) { workers->Schedule(std::move(c)); });
+  }
+  cost->Record(total, busy_nanos.load(std::memory_order_relaxed));
+}
+
 }  // end namespace tensorflow
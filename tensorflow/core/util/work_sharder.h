@@ -16,6 +16,7 @@ limitations under the License.
 #ifndef TENSORFLOW_CORE_UTIL_WORK_SHARDER_H_
 #define TENSORFLOW_CORE_UTIL_WORK_SHARDER_H_
 
+#include <atomic>
 #include <functional>
 
 #include "tensorflow/core/lib/core/threadpool.h"
@@ -59,6 +60,53 @@ namespace tensorflow {
 void Shard(int max_parallelism, thread::ThreadPool* workers, int64_t total,
            int64_t cost_per_unit, std::function<void(int64_t, int64_t)> work);
 
+// Learns the cost per unit of work of an AdaptiveShard() call site from the
+// time taken by its previous calls, instead of relying on a constant estimate.
+// Each call site should have its own AdaptiveShardCost, e.g. a function-local
+// static, since the cost per unit depends on the work.
+//
+// This class is thread-safe.
+class AdaptiveShardCost {
+ public:
+  // "initial_cost_per_unit" is the estimate, in nanoseconds, used until the
+  // first call has been measured. Shards are sized to take at least
+  // "min_shard_nanos" so that their scheduling overhead stays small.
+  explicit AdaptiveShardCost(double initial_cost_per_unit,
+                             int64_t min_shard_nanos = 20000)
+      : cost_per_unit_(initial_cost_per_unit),
+        min_shard_nanos_(min_shard_nanos) {}
+
+  // The estimated nanoseconds per unit of work.
+  double cost_per_unit() const {
+    return cost_per_unit_.load(std::memory_order_relaxed);
+  }
+
+  int64_t min_shard_nanos() const { return min_shard_nanos_; }
+
+  // Updates the estimate with a call where "units" took "nanos" in total,
+  // summed over its shards.
+  void Record(int64_t units, int64_t nanos);
+
+ private:
+  std::atomic<double> cost_per_unit_;
+  std::atomic<bool> measured_{false};
+  const int64_t min_shard_nanos_;
+
+  AdaptiveShardCost(const AdaptiveShardCost&) = delete;
+  void operator=(const AdaptiveShardCost&) = delete;
+};
+
+// Same as Shard(), but with the number of shards derived from the cost per
+// unit learned by "cost": "total" units are split into as many shards as
+// possible, up to "max_parallelism", that each take at least
+// cost->min_shard_nanos(). The time taken by the shards is then recorded in
+// "cost" for the later calls.
+//
+// REQUIRES: cost != nullptr
+void AdaptiveShard(int max_parallelism, thread::ThreadPool* workers,
+                   int64_t total, AdaptiveShardCost* cost,
+                   std::function<void(int64_t, int64_t)> work);
+
 // Each thread has an associated option to express the desired maximum
 // parallelism. Its default is a very large quantity.
 //
@@ -96,6 +144,11 @@ class Sharder {
   // schedule a closure. Shard() uses thread::ThreadPool instead.
   static void Do(int64_t total, int64_t cost_per_unit, const Work& work,
                  const Runner& runner, int max_parallelism);
+
+  // Splits [0, total) into at most "num_shards" shards of the same size. The
+  // first one runs on the calling thread, and the others with "runner".
+  static void DoInShards(int64_t total, int num_shards, const Work& work,
+                         const Runner& runner);
 };
 
 }  // end namespace tensorflow
@@ -21,6 +21,7 @@ limitations under the License.
 #include <vector>
 
 #include "tensorflow/core/lib/core/threadpool.h"
+#include "tensorflow/core/platform/env.h"
 #include "tensorflow/core/platform/logging.h"
 #include "tensorflow/core/platform/mutex.h"
 #include "tensorflow/core/platform/test.h"
@@ -93,6 +94,79 @@ TEST(Shard, OverflowTest) {
   }
 }
 
+// Returns the number of shards used by AdaptiveShard(), and checks that each
+// unit was done once.
+int RunAdaptiveSharding(int max_parallelism, int64_t total,
+                        AdaptiveShardCost* cost, thread::ThreadPool* threads,
+                        int64_t micros_per_unit = 0) {
+  mutex mu;
+  int num_shards = 0;
+  std::vector<bool> work(total, false);
+  AdaptiveShard(max_parallelism, threads, total, cost,
+                [&](int64_t start, int64_t limit) {
+                  if (micros_per_unit > 0) {
+                    Env::Default()->SleepForMicroseconds(micros_per_unit *
+                                                         (limit - start));
+                  }
+                  mutex_lock l(mu);
+                  ++num_shards;
+                  for (; start < limit; ++start) {
+                    EXPECT_FALSE(work[start]);
+                    work[start] = true;
+                  }
+                });
+  EXPECT_EQ(std::count(work.begin(), work.end(), true), total);
+  return num_shards;
+}
+
+TEST(AdaptiveShard, Basic) {
+  thread::ThreadPool threads(Env::Default(), "test", 16);
+  for (auto max_parallelism : {0, 1, 2, 7, 16, 100}) {
+    for (auto total : {0, 1, 7, 100, 9999}) {
+      for (double initial_cost : {0.0, 1.0, 1000.0, 1e6}) {
+        AdaptiveShardCost cost(initial_cost);
+        const int num_shards =
+            RunAdaptiveSharding(max_parallelism, total, &cost, &threads);
+        EXPECT_LE(num_shards, std::max(1, max_parallelism));
+      }
+    }
+  }
+}
+
+TEST(AdaptiveShard, LearnsThatTheWorkIsCheap) {
+  thread::ThreadPool threads(Env::Default(), "test", 4);
+  // Overestimated, so that the first call uses all the threads.
+  AdaptiveShardCost cost(/*initial_cost_per_unit=*/1e6);
+  EXPECT_EQ(RunAdaptiveSharding(4, 8, &cost, &threads), 4);
+  EXPECT_LT(cost.cost_per_unit(), 1e6);
+  // 8 units take much less than min_shard_nanos().
+  EXPECT_EQ(RunAdaptiveSharding(4, 8, &cost, &threads), 1);
+}
+
+TEST(AdaptiveShard, LearnsThatTheWorkIsExpensive) {
+  thread::ThreadPool threads(Env::Default(), "test", 4);
+  // Underestimated, so that the first call runs inline.
+  AdaptiveShardCost cost(/*initial_cost_per_unit=*/1);
+  EXPECT_EQ(RunAdaptiveSharding(4, 8, &cost, &threads,
+                                /*micros_per_unit=*/100),
+            1);
+  EXPECT_GE(cost.cost_per_unit(), 100000);
+  EXPECT_EQ(RunAdaptiveSharding(4, 8, &cost, &threads,
+                                /*micros_per_unit=*/100),
+            4);
+}
+
+TEST(AdaptiveShardCost, Record) {
+  AdaptiveShardCost cost(/*initial_cost_per_unit=*/1000);
+  EXPECT_EQ(cost.cost_per_unit(), 1000);
+  cost.Record(/*units=*/10, /*nanos=*/100);
+  EXPECT_EQ(cost.cost_per_unit(), 10);
+  cost.Record(/*units=*/10, /*nanos=*/500);
+  EXPECT_EQ(cost.cost_per_unit(), 20);
+  cost.Record(/*units=*/0, /*nanos=*/500);
+  EXPECT_EQ(cost.cost_per_unit(), 20);
+}
+
 void BM_Sharding(::testing::benchmark::State& state) {
   const int arg = state.range(0);
 
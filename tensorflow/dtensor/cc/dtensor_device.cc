@@ -86,6 +86,7 @@ limitations under the License.
 #include "tensorflow/dtensor/cc/dtensor_operation.h"
 #include "tensorflow/dtensor/cc/dtensor_utils.h"
 #include "tensorflow/dtensor/cc/parallel_executor.h"
+#include "tensorflow/dtensor/cc/pending_executions.h"
 #include "tensorflow/dtensor/cc/small_constant_optimization.h"
 #include "tensorflow/dtensor/cc/tensor_layout.h"
 #include "tensorflow/dtensor/cc/tpu_system_interface.h"
@@ -325,8 +326,9 @@ class DTensorDevice {
     std::unique_ptr<TF_Status, decltype(&TF_DeleteStatus)> first_bad_status(
         nullptr, TF_DeleteStatus);
 
-    Set_TF_Status_from_Status(status,
-                              eager_executor_->WaitForAllPendingNodes());
+    Status pending_status = pending_executions_.WaitAll();
+    pending_status.Update(eager_executor_->WaitForAllPendingNodes());
+    Set_TF_Status_from_Status(status, pending_status);
 
     if (TF_GetCode(status) != TF_OK) {
       first_bad_status.reset(status);
@@ -416,6 +418,7 @@ class DTensorDevice {
         function_manager_(new ExecutableManager<ExecutionFunctions>()),
         cancellation_manager_(std::make_unique<CancellationManager>()),
         parallel_executor_(std::move(parallel_executor)),
+        pending_executions_(in_flight_nodes_limit),
         eager_executor_(std::move(eager_executor)) {}
 
   // Stores states of a DTensorOperation that will be used for lowering,
@@ -712,6 +715,10 @@ class DTensorDevice {
   // Dispatchs functions for Pathways.
   std::unique_ptr<ParallelExecutor> parallel_executor_;
 
+  // The computations that a pipelining parallel executor runs in the
+  // background.
+  PendingExecutions pending_executions_;
+
   // Dispatchs functions for TensorFlow.
   std::unique_ptr<EagerExecutor> eager_executor_;
 
@@ -1827,7 +1834,15 @@ void DTensorDevice::ParallelExecuteRegularOperation(
       ParallelExecutor::ExecutionResult execution_result,
       parallel_executor_->Execute(context, inputs, mlir_module, attributes),
       status);
-  RETURN_C_STATUS_IF_NOT_OK(execution_result.status.Await(), status);
+  // A pipelining executor accepts the pending outputs as inputs of the next
+  // operations, so the next operation is lowered, or found in the module
+  // cache, and launched while this one runs. Errors reach the operations
+  // that consume the outputs, and the next AsyncWait.
+  if (parallel_executor_->SupportsPipelining()) {
+    pending_executions_.Add(std::move(execution_result.status));
+  } else {
+    RETURN_C_STATUS_IF_NOT_OK(execution_result.status.Await(), status);
+  }
 
   std::vector<TensorWithLayout*> typed_outputs = execution_result.outputs;
   // assign outputs and take outputs' ownership
@@ -62,6 +62,13 @@ class ParallelExecutor {
       TFE_Context* context, const std::vector<TensorWithLayout*>& inputs,
       mlir::ModuleOp module, const TFE_OpAttrs* attributes) const = 0;
 
+  // Whether the outputs of `Execute` may be passed as inputs to later calls
+  // before its `status` future resolves. If true, the executor orders each
+  // computation after the computations that produce its inputs and fails it
+  // if one of them fails, so that callers can lower and launch the next
+  // computation while the previous ones are still running.
+  virtual bool SupportsPipelining() const { return false; }
+
   // Disassembles `t` into multiple TensorWithLayouts. `t` may or may not be
   // valid to use afterwards.
   virtual StatusOr<std::vector<std::unique_ptr<TensorWithLayout>>> Disassemble(
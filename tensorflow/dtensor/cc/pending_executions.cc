@@ -0,0 +1,52 @@
+/* Copyright 2023 The TensorFlow Authors. All Rights Reserved.
+
+Licensed under the Apache License, Version 2.0 (the "License");
+you may not use this file except in compliance with the License.
+You may obtain a copy of the License at
+
+    http://www.apache.org/licenses/LICENSE-2.0
+
+Unless required by applicable law or agreed to in writing, software
+distributed under the License is distributed on an "AS IS" BASIS,
+WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+See the License for the specific language governing permissions and
+limitations under the License.
+==============================================================================*/
+
+#include "tensorflow/dtensor/cc/pending_executions.h"
+
+#include <cstdint>
+#include <utility>
+
+#include "absl/status/status.h"
+
+namespace tensorflow {
+namespace dtensor {
+
+void PendingExecutions::Add(Future<> execution) {
+  mutex_lock lock(mu_);
+  pending_.push_back(std::move(execution));
+  while (!pending_.empty() &&
+         (pending_.front().IsKnownReady() ||
+          (limit_ > 0 && static_cast<int64_t>(pending_.size()) > limit_))) {
+    status_.Update(pending_.front().Await());
+    pending_.pop_front();
+  }
+}
+
+Status PendingExecutions::WaitAll() {
+  mutex_lock lock(mu_);
+  for (Future<>& execution : pending_) {
+    status_.Update(execution.Await());
+  }
+  pending_.clear();
+  return std::exchange(status_, absl::OkStatus());
+}
+
+int64_t PendingExecutions::size() const {
+  mutex_lock lock(mu_);
+  return pending_.size();
+}
+
+}  // namespace dtensor
+}  // namespace tensorflow
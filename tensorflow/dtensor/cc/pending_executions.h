@@ -0,0 +1,70 @@
+/* Copyright 2023 The TensorFlow Authors. All Rights Reserved.
+
+Licensed under the Apache License, Version 2.0 (the "License");
+you may not use this file except in compliance with the License.
+You may obtain a copy of the License at
+
+    http://www.apache.org/licenses/LICENSE-2.0
+
+Unless required by applicable law or agreed to in writing, software
+distributed under the License is distributed on an "AS IS" BASIS,
+WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+See the License for the specific language governing permissions and
+limitations under the License.
+==============================================================================*/
+
+#ifndef TENSORFLOW_DTENSOR_CC_PENDING_EXECUTIONS_H_
+#define TENSORFLOW_DTENSOR_CC_PENDING_EXECUTIONS_H_
+
+#include <cstdint>
+#include <deque>
+
+#include "tensorflow/core/platform/mutex.h"
+#include "tensorflow/core/platform/status.h"
+#include "tensorflow/core/platform/thread_annotations.h"
+#include "tensorflow/dtensor/cc/parallel_executor.h"
+
+namespace tensorflow {
+namespace dtensor {
+
+// Tracks the status futures of the computations that a pipelining
+// ParallelExecutor runs in the background.
+//
+// A failed computation fails the computations that consume its outputs, so
+// its error reaches the caller through those outputs. Unrelated operations
+// launched meanwhile are not failed; the error is only reported by the next
+// `WaitAll`, the synchronization point of the device.
+class PendingExecutions {
+ public:
+  // At most `limit` computations are pending at once; non-positive means
+  // unbounded.
+  explicit PendingExecutions(int64_t limit) : limit_(limit) {}
+
+  PendingExecutions(const PendingExecutions&) = delete;
+  PendingExecutions& operator=(const PendingExecutions&) = delete;
+
+  // Tracks `execution`. Retires the oldest computations that have resolved,
+  // then blocks on the oldest ones while more than `limit` are pending.
+  void Add(Future<> execution) TF_LOCKS_EXCLUDED(mu_);
+
+  // Waits for all the pending computations, oldest first. Returns the first
+  // error of the computations tracked since the last call.
+  Status WaitAll() TF_LOCKS_EXCLUDED(mu_);
+
+  // The number of computations that have not been retired.
+  int64_t size() const TF_LOCKS_EXCLUDED(mu_);
+
+ private:
+  const int64_t limit_;
+
+  mutable mutex mu_;
+  // Oldest first.
+  std::deque<Future<>> pending_ TF_GUARDED_BY(mu_);
+  // The first error of the retired computations.
+  Status status_ TF_GUARDED_BY(mu_);
+};
+
+}  // namespace dtensor
+}  // namespace tensorflow
+
+#endif  // TENSORFLOW_DTENSOR_CC_PENDING_EXECUTIONS_H_
@@ -15,6 +15,14 @@ limitations under the License.
 
 #include "tensorflow/dtensor/cc/save_restore_util.h"
 
+#include <cstdint>
+#include <functional>
+#include <limits>
+#include <numeric>
+#include <string>
+#include <vector>
+
+#include "absl/algorithm/container.h"
 #include "llvm/ADT/SmallVector.h"
 #include "mlir/IR/Builders.h"  // from @llvm-project
 #include "tensorflow/compiler/mlir/tensorflow/ir/tf_ops.h"
@@ -23,39 +31,35 @@ namespace tensorflow {
 namespace dtensor {
 
 namespace {
-// A map that is keyed by the index of tensor_name.
-// For example, {2 : <"spec_a", "spec_b"> } means that the
-// save_v2.tensor_names[2] should have "spec_a" and "spec_b" saved.
-using SliceSpecByName = absl::flat_hash_map<int64_t, std::vector<std::string>>;
-
-// Builds a map from tensor slice spec to saving device_id for the given Tensor
-// and layout. The output would record the saving device and the slices it needs
-// to save.
+
+// A unique slice of a Tensor, as a shape_and_slice spec, and the ids of the
+// devices that hold a copy of it, in increasing order.
+struct SliceHolders {
+  std::string shape_and_slice;
+  std::vector<int64_t> device_ids;
+};
+
+// Lists the unique slices of the given Tensor and layout with the devices that
+// hold them, ordered by the first device that holds each slice.
 //
 // For each sharded Tensor, each device would hold a slice of the Tensor - but
 // it isn't necessary a unique copy. For a 2 way sharded Tensor in a (2,4) mesh
 // on the first dimension, device [0-3] and device [4-7] will hold the same
-// slice data. To avoid saving duplicated copies of the Tensor slice, the map
-// would only contain the min(device_id) that occupies the slice and save from
-// there.
+// slice data. Only one of the holders needs to save the slice.
 //
 // Furthermore, to save a Tensor that isn't on CPU mesh, send/recv is necessary
 // from saving device to its corresponding host(CPU) devices. Since we don't
 // have multi-mesh execution yet, this isn't implemented yet.
-StatusOr<SliceSpecByName> BuildSliceSpecDeviceMap(
+StatusOr<std::vector<SliceHolders>> BuildSliceHolders(
     absl::Span<const int64_t> global_shape, Layout layout) {
   if (!layout.mesh().is_cpu_mesh())
     return errors::Unimplemented(
         "Saving tensors on non CPU mesh needs explicit send/receive and isn't "
         "implemented yet");
 
-  // Result map that records the minimum device_id that occupies the unique
-  // copy.
-  // Note that llvm::SmallDenseMap won't accept std::string as a key.
-  absl::flat_hash_map<std::string, int64_t> min_device_for_slice_spec;
-  // Records the map of device_ids and a list of slice_spec that it needs to
-  // save.
-  SliceSpecByName device_slices;
+  std::vector<SliceHolders> slices;
+  // Maps each shape_and_slice to its index in `slices`.
+  absl::flat_hash_map<std::string, int64_t> slice_index;
 
   const auto& mesh = layout.mesh();
   // Construct SliceSpec for each device in the mesh.
@@ -73,22 +77,29 @@ StatusOr<SliceSpecByName> BuildSliceSpecDeviceMap(
     // Concat shape spec and slice spec to form a complete shape_and_slice.
     std::string shape_and_slice = absl::StrCat(shape_spec, " ", slice_spec);
 
-    // Only record the min device_id for the unique slice_spec on a given
-    // Tensor.
-    if (min_device_for_slice_spec.find(shape_and_slice) ==
-            min_device_for_slice_spec.end() ||
-        device_id < min_device_for_slice_spec[shape_and_slice]) {
-      min_device_for_slice_spec[shape_and_slice] = device_id;
-    }
+    auto [it, inserted] =
+        slice_index.try_emplace(shape_and_slice, slices.size());
+    if (inserted) slices.push_back({std::move(shape_and_slice), {}});
+    slices[it->second].device_ids.push_back(device_id);
   }
+  return slices;
+}
 
-  // Constructs device_id keyed map for future save operation conditioned on
-  // device_ids.
-  for (const auto& spec_and_id : min_device_for_slice_spec) {
-    device_slices[spec_and_id.second].push_back(spec_and_id.first);
+// Returns the holder with the fewest elements to save so far, or the smallest
+// device id among those, so that every client computes the same assignment.
+int64_t LeastLoadedDevice(absl::Span<const int64_t> device_ids,
+                          const absl::flat_hash_map<int64_t, int64_t>& load) {
+  int64_t best_device = device_ids[0];
+  int64_t best_load = std::numeric_limits<int64_t>::max();
+  for (int64_t device_id : device_ids) {
+    auto it = load.find(device_id);
+    const int64_t device_load = it == load.end() ? 0 : it->second;
+    if (device_load < best_load) {
+      best_device = device_id;
+      best_load = device_load;
+    }
   }
-
-  return device_slices;
+  return best_device;
 }
 
 }  // namespace
@@ -105,6 +116,11 @@ BuildSavingSpec(absl::Span<const SavingTensorMetadata> tensor_metadatas) {
   absl::flat_hash_map<int64_t,
                       absl::flat_hash_map<int64_t, std::vector<std::string>>>
       saving_specs;
+  // The number of elements each device saves so far. Every unique slice is
+  // saved by the least loaded device that holds it, so that the devices, and
+  // the hosts they are on, write the checkpoint in parallel instead of device
+  // 0 writing every replicated Tensor.
+  absl::flat_hash_map<int64_t, int64_t> load;
   for (const SavingTensorMetadata& tensor_metadata : tensor_metadatas) {
     // We use index to select the tensor names and shape_and_slices from the
     // inputs. This is generic regardless whether the inputs are constants or
@@ -114,19 +130,27 @@ BuildSavingSpec(absl::Span<const SavingTensorMetadata> tensor_metadatas) {
     absl::Span<const int64_t> tensor_shape = tensor_metadata.shape;
 
     if (layout.IsFullyReplicated()) {
-      // Push a fully replicated save on device 0, where slice_spec is simply
+      // Every device holds the full Tensor, and the slice_spec is simply the
       // empty string.
-      saving_specs[0][index].push_back("");
+      std::vector<int64_t> device_ids(layout.mesh().size());
+      std::iota(device_ids.begin(), device_ids.end(), 0);
+      const int64_t saving_device_id = LeastLoadedDevice(device_ids, load);
+      load[saving_device_id] += absl::c_accumulate(
+          tensor_shape, int64_t{1}, std::multiplies<int64_t>());
+      saving_specs[saving_device_id][index].push_back("");
     } else {
       // Calculate shape_and_slices for sharded case here.
-      TF_ASSIGN_OR_RETURN(const auto& slice_specs,
-                          BuildSliceSpecDeviceMap(tensor_shape, layout));
-      // Push specs for each device into the global map.
-      for (const auto& slice_spec : slice_specs) {
-        int64_t saving_device_id = slice_spec.first;
-        for (const std::string& slice : slice_spec.second) {
-          saving_specs[saving_device_id][index].push_back(slice);
-        }
+      TF_ASSIGN_OR_RETURN(const std::vector<SliceHolders> slices,
+                          BuildSliceHolders(tensor_shape, layout));
+      const std::vector<int64_t> local_shape =
+          layout.LocalShapeFromGlobalShape(tensor_shape);
+      const int64_t num_elements = absl::c_accumulate(
+          local_shape, int64_t{1}, std::multiplies<int64_t>());
+      for (const SliceHolders& slice : slices) {
+        const int64_t saving_device_id =
+            LeastLoadedDevice(slice.device_ids, load);
+        load[saving_device_id] += num_elements;
+        saving_specs[saving_device_id][index].push_back(slice.shape_and_slice);
       }
     }
   }
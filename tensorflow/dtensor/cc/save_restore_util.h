@@ -88,7 +88,9 @@ std::string DeviceSuffix(int device_id, int total_devices);
 // <tensor_index -> (tensor_global_shape, tensor_layout)>.
 //
 // (tensor_global_shape, tensor_layout & tensor_layout.mesh) defines which
-// device saves what slices of the Tensor.
+// device saves what slices of the Tensor. Each unique slice is saved once, by
+// the device holding a copy of it that saves the fewest elements so far, so
+// that the saves are spread over the devices of the mesh.
 //
 // For a complete definition of shape_and_slices field, please see:
 // third_party/tensorflow/core/framework/tensor_slice.h
@@ -0,0 +1,196 @@
+/* Copyright 2023 The TensorFlow Authors. All Rights Reserved.
+
+Licensed under the Apache License, Version 2.0 (the "License");
+you may not use this file except in compliance with the License.
+You may obtain a copy of the License at
+
+    http://www.apache.org/licenses/LICENSE-2.0
+
+Unless required by applicable law or agreed to in writing, software
+distributed under the License is distributed on an "AS IS" BASIS,
+WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+See the License for the specific language governing permissions and
+limitations under the License.
+==============================================================================*/
+
+#include "tensorflow/dtensor/cc/pending_executions.h"
+
+#include <memory>
+#include <utility>
+#include <vector>
+
+#include <gmock/gmock.h>
+#include <gtest/gtest.h>
+#include "absl/status/status.h"
+#include "absl/synchronization/notification.h"
+#include "tensorflow/core/platform/env.h"
+#include "tensorflow/core/platform/mutex.h"
+#include "tensorflow/dtensor/cc/parallel_executor.h"
+#include "tsl/lib/core/status_test_util.h"
+#include "tsl/platform/status_matchers.h"
+#include "tsl/protobuf/error_codes.pb.h"
+
+namespace tensorflow {
+namespace dtensor {
+namespace {
+
+using ::tsl::error::INTERNAL;
+using ::tsl::testing::StatusIs;
+
+// Stands in for a pipelining ParallelExecutor. A launched computation runs
+// when its `run` promise is set and resolves once all of its inputs have
+// resolved, failing with the first error among its inputs and itself.
+class FakePipeliningExecutor {
+ public:
+  struct Computation {
+    Future<>::Promise run;
+    Future<> status;
+  };
+
+  Computation Launch(const std::vector<Future<>>& inputs) {
+    struct State {
+      mutex mu;
+      int remaining;
+      Status status;
+      Future<>::Promise done;
+    };
+    auto state = std::make_shared<State>();
+    state->remaining = inputs.size() + 1;
+    state->done = Future<>::CreatePromise();
+    Computation computation{Future<>::CreatePromise(),
+                            Future<>(state->done)};
+
+    auto on_ready = [state](Status status) {
+      bool last;
+      {
+        mutex_lock lock(state->mu);
+        state->status.Update(status);
+        last = --state->remaining == 0;
+      }
+      if (last) state->done.Set(state->status);
+    };
+    for (const Future<>& input : inputs) input.OnReady(on_ready);
+    Future<>(computation.run).OnReady(on_ready);
+    return computation;
+  }
+};
+
+TEST(PendingExecutionsTest, WaitAllWaitsForEveryComputation) {
+  FakePipeliningExecutor executor;
+  PendingExecutions pending(/*limit=*/0);
+  FakePipeliningExecutor::Computation first = executor.Launch({});
+  FakePipeliningExecutor::Computation second = executor.Launch({});
+  pending.Add(first.status);
+  pending.Add(second.status);
+  EXPECT_EQ(pending.size(), 2);
+
+  // Resolve the computations out of order while WaitAll blocks.
+  absl::Notification waited;
+  std::unique_ptr<Thread> waiter(
+      Env::Default()->StartThread({}, "waiter", [&]() {
+        TF_EXPECT_OK(pending.WaitAll());
+        waited.Notify();
+      }));
+  second.run.Set();
+  EXPECT_FALSE(waited.WaitForNotificationWithTimeout(absl::Milliseconds(50)));
+  first.run.Set();
+  waiter.reset();
+
+  EXPECT_TRUE(waited.HasBeenNotified());
+  EXPECT_EQ(pending.size(), 0);
+}
+
+TEST(PendingExecutionsTest, RetiresResolvedComputationsOldestFirst) {
+  FakePipeliningExecutor executor;
+  PendingExecutions pending(/*limit=*/0);
+  FakePipeliningExecutor::Computation first = executor.Launch({});
+  FakePipeliningExecutor::Computation second = executor.Launch({});
+  FakePipeliningExecutor::Computation third = executor.Launch({});
+  pending.Add(first.status);
+  pending.Add(second.status);
+
+  // `second` resolving does not retire it while `first` is pending.
+  second.run.Set();
+  pending.Add(third.status);
+  EXPECT_EQ(pending.size(), 3);
+
+  // Both are retired on the next Add, the pending `third` is not.
+  first.run.Set();
+  pending.Add(Future<>(absl::OkStatus()));
+  EXPECT_EQ(pending.size(), 2);
+
+  third.run.Set();
+  TF_EXPECT_OK(pending.WaitAll());
+}
+
+TEST(PendingExecutionsTest, AddBlocksAboveTheLimit) {
+  FakePipeliningExecutor executor;
+  PendingExecutions pending(/*limit=*/2);
+  FakePipeliningExecutor::Computation first = executor.Launch({});
+  FakePipeliningExecutor::Computation second = executor.Launch({});
+  FakePipeliningExecutor::Computation third = executor.Launch({});
+  pending.Add(first.status);
+  pending.Add(second.status);
+
+  absl::Notification added;
+  std::unique_ptr<Thread> launcher(
+      Env::Default()->StartThread({}, "launcher", [&]() {
+        pending.Add(third.status);
+        added.Notify();
+      }));
+  EXPECT_FALSE(added.WaitForNotificationWithTimeout(absl::Milliseconds(50)));
+
+  first.run.Set();
+  launcher.reset();
+  EXPECT_TRUE(added.HasBeenNotified());
+  EXPECT_EQ(pending.size(), 2);
+
+  second.run.Set();
+  third.run.Set();
+  TF_EXPECT_OK(pending.WaitAll());
+}
+
+TEST(PendingExecutionsTest, ErrorsReachConsumersAndWaitAllOnly) {
+  FakePipeliningExecutor executor;
+  PendingExecutions pending(/*limit=*/0);
+  FakePipeliningExecutor::Computation producer = executor.Launch({});
+  FakePipeliningExecutor::Computation consumer =
+      executor.Launch({producer.status});
+  pending.Add(producer.status);
+  pending.Add(consumer.status);
+
+  producer.run.Set(absl::InternalError("producer failed"));
+  consumer.run.Set();
+  EXPECT_THAT(consumer.status.Await(), StatusIs(INTERNAL, "producer failed"));
+
+  // An unrelated computation launched after the failure still succeeds, and
+  // tracking it does not report the error.
+  FakePipeliningExecutor::Computation unrelated = executor.Launch({});
+  pending.Add(unrelated.status);
+  unrelated.run.Set();
+  TF_EXPECT_OK(unrelated.status.Await());
+
+  EXPECT_THAT(pending.WaitAll(), StatusIs(INTERNAL, "producer failed"));
+  // The error is reported once.
+  TF_EXPECT_OK(pending.WaitAll());
+}
+
+TEST(PendingExecutionsTest, WaitAllReportsTheFirstError) {
+  FakePipeliningExecutor executor;
+  PendingExecutions pending(/*limit=*/1);
+  FakePipeliningExecutor::Computation first = executor.Launch({});
+  FakePipeliningExecutor::Computation second = executor.Launch({});
+  first.run.Set(absl::InternalError("first"));
+  second.run.Set(absl::InternalError("second"));
+
+  // Resolved computations are retired as soon as they are added.
+  pending.Add(first.status);
+  pending.Add(second.status);
+  EXPECT_EQ(pending.size(), 0);
+
+  EXPECT_THAT(pending.WaitAll(), StatusIs(INTERNAL, "first"));
+}
+
+}  // namespace
+}  // namespace dtensor
+}  // namespace tensorflow
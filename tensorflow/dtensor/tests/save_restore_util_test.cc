@@ -0,0 +1,167 @@
+/* Copyright 2023 The TensorFlow Authors. All Rights Reserved.
+
+Licensed under the Apache License, Version 2.0 (the "License");
+you may not use this file except in compliance with the License.
+You may obtain a copy of the License at
+
+    http://www.apache.org/licenses/LICENSE-2.0
+
+Unless required by applicable law or agreed to in writing, software
+distributed under the License is distributed on an "AS IS" BASIS,
+WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+See the License for the specific language governing permissions and
+limitations under the License.
+==============================================================================*/
+
+#include "tensorflow/dtensor/cc/save_restore_util.h"
+
+#include <cstdint>
+#include <string>
+#include <vector>
+
+#include <gmock/gmock.h>
+#include "absl/container/flat_hash_map.h"
+#include "tensorflow/core/platform/test.h"
+#include "tensorflow/dtensor/cc/tensor_layout.h"
+#include "tsl/platform/status_matchers.h"
+#include "tsl/platform/statusor.h"
+
+namespace tensorflow {
+namespace dtensor {
+namespace {
+
+using ::testing::ElementsAre;
+using ::testing::Pair;
+using ::testing::UnorderedElementsAre;
+using ::tsl::testing::StatusIs;
+
+Layout ParseLayout(const std::string& layout) {
+  return Layout::FromString(layout).value();
+}
+
+// Fully replicated Tensors are spread over the devices instead of all being
+// saved by device 0.
+TEST(SaveRestoreUtilTest, ReplicatedTensorsAreBalanced) {
+  const Layout layout =
+      ParseLayout("sharding_specs:unsharded, mesh:|x=2,y=2|*CPU");
+  std::vector<SavingTensorMetadata> metadatas;
+  for (int64_t i = 0; i < 4; ++i) {
+    metadatas.emplace_back(i, std::vector<int64_t>{8}, layout);
+  }
+
+  TF_ASSERT_OK_AND_ASSIGN(auto saving_specs, BuildSavingSpec(metadatas));
+
+  EXPECT_THAT(saving_specs,
+              UnorderedElementsAre(
+                  Pair(0, UnorderedElementsAre(Pair(0, ElementsAre("")))),
+                  Pair(1, UnorderedElementsAre(Pair(1, ElementsAre("")))),
+                  Pair(2, UnorderedElementsAre(Pair(2, ElementsAre("")))),
+                  Pair(3, UnorderedElementsAre(Pair(3, ElementsAre(""))))));
+}
+
+// A larger replicated Tensor counts for more than a smaller one, so the next
+// Tensors avoid the device that saves it.
+TEST(SaveRestoreUtilTest, ReplicatedTensorsAreBalancedByElements) {
+  const Layout layout = ParseLayout("sharding_specs:unsharded, mesh:|x=2|*CPU");
+  std::vector<SavingTensorMetadata> metadatas;
+  metadatas.emplace_back(0, std::vector<int64_t>{16}, layout);
+  metadatas.emplace_back(1, std::vector<int64_t>{4}, layout);
+  metadatas.emplace_back(2, std::vector<int64_t>{4}, layout);
+
+  TF_ASSERT_OK_AND_ASSIGN(auto saving_specs, BuildSavingSpec(metadatas));
+
+  EXPECT_THAT(saving_specs,
+              UnorderedElementsAre(
+                  Pair(0, UnorderedElementsAre(Pair(0, ElementsAre("")))),
+                  Pair(1, UnorderedElementsAre(Pair(1, ElementsAre("")),
+                                               Pair(2, ElementsAre(""))))));
+}
+
+// Each unique slice of a Tensor sharded on x and replicated on y is held by
+// two devices. Successive Tensors alternate between the holders.
+TEST(SaveRestoreUtilTest, ReplicatedSlicesAreBalanced) {
+  const Layout layout =
+      ParseLayout("sharding_specs:x,unsharded, mesh:|x=2,y=2|*CPU");
+  std::vector<SavingTensorMetadata> metadatas;
+  metadatas.emplace_back(0, std::vector<int64_t>{4, 2}, layout);
+  metadatas.emplace_back(1, std::vector<int64_t>{4, 2}, layout);
+
+  TF_ASSERT_OK_AND_ASSIGN(auto saving_specs, BuildSavingSpec(metadatas));
+
+  // Devices 0 and 1 hold the first slice, devices 2 and 3 the second one.
+  EXPECT_THAT(
+      saving_specs,
+      UnorderedElementsAre(
+          Pair(0, UnorderedElementsAre(Pair(0, ElementsAre("4 2 0,2:-")))),
+          Pair(1, UnorderedElementsAre(Pair(1, ElementsAre("4 2 0,2:-")))),
+          Pair(2, UnorderedElementsAre(Pair(0, ElementsAre("4 2 2,2:-")))),
+          Pair(3, UnorderedElementsAre(Pair(1, ElementsAre("4 2 2,2:-"))))));
+}
+
+// Every unique slice is saved exactly once, even when the assignment is
+// balanced across Tensors with different layouts.
+TEST(SaveRestoreUtilTest, EachSliceIsSavedOnce) {
+  const Layout replicated =
+      ParseLayout("sharding_specs:unsharded,unsharded, mesh:|x=2,y=2|*CPU");
+  const Layout sharded_x =
+      ParseLayout("sharding_specs:x,unsharded, mesh:|x=2,y=2|*CPU");
+  const Layout sharded_xy =
+      ParseLayout("sharding_specs:x,y, mesh:|x=2,y=2|*CPU");
+  std::vector<SavingTensorMetadata> metadatas;
+  metadatas.emplace_back(0, std::vector<int64_t>{4, 4}, sharded_x);
+  metadatas.emplace_back(1, std::vector<int64_t>{2, 2}, replicated);
+  metadatas.emplace_back(2, std::vector<int64_t>{4, 4}, sharded_xy);
+
+  TF_ASSERT_OK_AND_ASSIGN(auto saving_specs, BuildSavingSpec(metadatas));
+
+  absl::flat_hash_map<int64_t, std::vector<std::string>> saved_slices;
+  for (const auto& [device_id, device_specs] : saving_specs) {
+    for (const auto& [tensor_index, specs] : device_specs) {
+      for (const std::string& spec : specs) {
+        saved_slices[tensor_index].push_back(spec);
+      }
+    }
+  }
+  EXPECT_THAT(saved_slices[0],
+              UnorderedElementsAre("4 4 0,2:-", "4 4 2,2:-"));
+  EXPECT_THAT(saved_slices[1], ElementsAre(""));
+  EXPECT_THAT(saved_slices[2],
+              UnorderedElementsAre("4 4 0,2:0,2", "4 4 0,2:2,2", "4 4 2,2:0,2",
+                                   "4 4 2,2:2,2"));
+}
+
+// Every client builds the saving spec on its own, so the assignment must not
+// depend on anything but the inputs.
+TEST(SaveRestoreUtilTest, AssignmentIsDeterministic) {
+  const Layout replicated =
+      ParseLayout("sharding_specs:unsharded, mesh:|x=2,y=4|*CPU");
+  const Layout sharded =
+      ParseLayout("sharding_specs:y,unsharded, mesh:|x=2,y=4|*CPU");
+  std::vector<SavingTensorMetadata> metadatas;
+  for (int64_t i = 0; i < 16; ++i) {
+    if (i % 3 == 0) {
+      metadatas.emplace_back(i, std::vector<int64_t>{8, i + 1}, sharded);
+    } else {
+      metadatas.emplace_back(i, std::vector<int64_t>{i + 1}, replicated);
+    }
+  }
+
+  TF_ASSERT_OK_AND_ASSIGN(auto first, BuildSavingSpec(metadatas));
+  for (int run = 0; run < 3; ++run) {
+    TF_ASSERT_OK_AND_ASSIGN(auto saving_specs, BuildSavingSpec(metadatas));
+    EXPECT_EQ(saving_specs, first);
+  }
+}
+
+TEST(SaveRestoreUtilTest, ShardedTensorOnNonCpuMeshIsUnimplemented) {
+  const Layout layout = ParseLayout("sharding_specs:x, mesh:|x=2|*TPU");
+  std::vector<SavingTensorMetadata> metadatas;
+  metadatas.emplace_back(0, std::vector<int64_t>{4}, layout);
+
+  EXPECT_THAT(BuildSavingSpec(metadatas),
+              StatusIs(tsl::error::UNIMPLEMENTED));
+}
+
+}  // namespace
+}  // namespace dtensor
+}  // namespace tensorflow
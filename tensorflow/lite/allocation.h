@@ -64,6 +64,12 @@ class MMAPAllocation : public Allocation {
   /// Loads and maps the provided file to a memory region.
   MMAPAllocation(const char* filename, ErrorReporter* error_reporter);
 
+  /// Same as above, but if `populate` is true, also reads the whole file into
+  /// memory upfront (`MAP_POPULATE` on Linux), so that the first accesses to
+  /// the model, e.g. at a latency critical startup, don't page fault.
+  MMAPAllocation(const char* filename, bool populate,
+                 ErrorReporter* error_reporter);
+
   /// Maps the provided file descriptor to a memory region.
   /// Note: The provided file descriptor will be dup'ed for usage; the caller
   /// retains ownership of the provided descriptor and should close accordingly.
@@ -95,6 +101,28 @@ class MMAPAllocation : public Allocation {
     return offset_of_buffer_in_file_;
   }
 
+  /// How a range of the mapped memory is going to be accessed.
+  enum class Advice {
+    // No particular pattern, the default.
+    kNormal,
+    // Read in order, e.g. while a delegate packs the weights: the kernel reads
+    // ahead aggressively.
+    kSequential,
+    // Going to be read soon: the kernel starts reading it in.
+    kWillNeed,
+    // No longer read, e.g. weights a delegate has copied: the pages are
+    // released from the resident memory. Since the mapping is a read-only
+    // mapping of the file, they are read again from it if accessed later.
+    kDontNeed,
+  };
+
+  /// Advises the kernel that the `size` bytes at `data`, which must lie within
+  /// the mapped buffer, are going to be accessed as `advice` says. kDontNeed
+  /// only releases the pages entirely within the range, the others the pages
+  /// overlapping it. Returns false if the range is invalid or the advice can't
+  /// be given on this platform.
+  bool Advise(const void* data, size_t size, Advice advice) const;
+
   static bool IsSupported();
 
  protected:
@@ -108,12 +136,12 @@ class MMAPAllocation : public Allocation {
 
  private:
   // Assumes ownership of the provided `owned_fd` instance.
-  MMAPAllocation(ErrorReporter* error_reporter, int owned_fd);
+  MMAPAllocation(ErrorReporter* error_reporter, int owned_fd, bool populate);
 
   // Assumes ownership of the provided `owned_fd` instance, and uses the given
   // offset and length (both in bytes) for memory mapping.
   MMAPAllocation(ErrorReporter* error_reporter, int owned_fd, size_t offset,
-                 size_t length);
+                 size_t length, bool populate);
 };
 
 class FileCopyAllocation : public Allocation {
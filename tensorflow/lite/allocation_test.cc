@@ -19,8 +19,12 @@ limitations under the License.
 #endif
 
 #include <sys/stat.h>
+#include <unistd.h>
 
+#include <cstdint>
+#include <cstdio>
 #include <string>
+#include <vector>
 
 #include <gtest/gtest.h>
 #include "tensorflow/lite/testing/util.h"
@@ -52,7 +56,66 @@ TEST(MMAPAllocation, TestValidFile) {
   EXPECT_NE(allocation.base(), nullptr);
 }
 
+TEST(MMAPAllocation, TestPopulatedFile) {
+  if (!MMAPAllocation::IsSupported()) {
+    return;
+  }
+
+  TestErrorReporter error_reporter;
+  MMAPAllocation allocation("tensorflow/lite/testdata/empty_model.bin",
+                            /*populate=*/true, &error_reporter);
+
+  ASSERT_TRUE(allocation.valid());
+  EXPECT_GT(allocation.bytes(), 0);
+  EXPECT_NE(allocation.base(), nullptr);
+}
+
 #if defined(__linux__)
+TEST(MMAPAllocation, TestAdvise) {
+  if (!MMAPAllocation::IsSupported()) {
+    return;
+  }
+
+  // A file of a few pages, each byte holding the index of its page.
+  const size_t pagesize = sysconf(_SC_PAGE_SIZE);
+  const int num_pages = 4;
+  std::vector<uint8_t> contents(num_pages * pagesize);
+  for (size_t i = 0; i < contents.size(); ++i) {
+    contents[i] = i / pagesize;
+  }
+  const std::string path = ::testing::TempDir() + "/tflite_advise_test.bin";
+  FILE* file = fopen(path.c_str(), "wb");
+  ASSERT_NE(file, nullptr);
+  ASSERT_EQ(fwrite(contents.data(), 1, contents.size(), file), contents.size());
+  fclose(file);
+
+  TestErrorReporter error_reporter;
+  MMAPAllocation allocation(path.c_str(), &error_reporter);
+  ASSERT_TRUE(allocation.valid());
+  const uint8_t* base = static_cast<const uint8_t*>(allocation.base());
+
+  EXPECT_TRUE(allocation.Advise(base, allocation.bytes(),
+                                MMAPAllocation::Advice::kSequential));
+  EXPECT_TRUE(allocation.Advise(base + 10, pagesize,
+                                MMAPAllocation::Advice::kWillNeed));
+  EXPECT_TRUE(allocation.Advise(base, allocation.bytes(),
+                                MMAPAllocation::Advice::kNormal));
+  // Ranges not within the mapped buffer are rejected.
+  EXPECT_FALSE(allocation.Advise(base + 1, allocation.bytes(),
+                                 MMAPAllocation::Advice::kNormal));
+  EXPECT_FALSE(allocation.Advise(base - 1, 1, MMAPAllocation::Advice::kNormal));
+
+  // Released pages are read again from the file.
+  EXPECT_TRUE(allocation.Advise(base + pagesize / 2, 2 * pagesize,
+                                MMAPAllocation::Advice::kDontNeed));
+  EXPECT_TRUE(allocation.Advise(base, 1, MMAPAllocation::Advice::kDontNeed));
+  for (size_t i = 0; i < contents.size(); ++i) {
+    ASSERT_EQ(base[i], contents[i]) << i;
+  }
+
+  unlink(path.c_str());
+}
+
 TEST(MMAPAllocation, TestInvalidFileDescriptor) {
   if (!MMAPAllocation::IsSupported()) {
     return;
@@ -18,8 +18,10 @@ limitations under the License.
 
 #include <algorithm>
 #include <cstdint>
+#include <cstring>
 #include <limits>
 #include <memory>
+#include <string>
 #include <utility>
 #include <vector>
 
@@ -33,6 +35,81 @@ constexpr int32_t kLastActiveNodeUndefined =
     std::numeric_limits<int32_t>::max();
 constexpr int32_t kNodeNotAssigned = std::numeric_limits<int32_t>::max();
 constexpr int32_t kScalarTensorBytes = 4;
+// Maximum number of plans kept by ArenaPlanner::cached_plans_.
+constexpr size_t kMaxCachedPlans = 16;
+// Marks the data returned by ArenaPlanner::SerializeCachedPlans().
+constexpr uint64_t kCachedPlansMagic = 0x544c41504c414e31;  // "TLAPLAN1"
+
+namespace {
+
+void AppendUint64(uint64_t value, std::string* data) {
+  data->append(reinterpret_cast<const char*>(&value), sizeof(value));
+}
+
+void AppendAllocs(const std::vector<ArenaAllocWithUsageInterval>& allocs,
+                  std::string* data) {
+  AppendUint64(allocs.size(), data);
+  for (const auto& alloc : allocs) {
+    AppendUint64(alloc.offset, data);
+    AppendUint64(alloc.size, data);
+    AppendUint64(alloc.tensor, data);
+    AppendUint64(alloc.first_node, data);
+    AppendUint64(alloc.last_node, data);
+  }
+}
+
+// Reads the values serialized by AppendUint64() from a string.
+class Uint64Reader {
+ public:
+  explicit Uint64Reader(const std::string& data) : data_(data) {}
+
+  bool Read(uint64_t* value) {
+    if (data_.size() - pos_ < sizeof(*value)) return false;
+    std::memcpy(value, data_.data() + pos_, sizeof(*value));
+    pos_ += sizeof(*value);
+    return true;
+  }
+
+  // Reads the number of elements of a vector holding `values_per_element`
+  // values each, which must fit in the remaining data.
+  bool ReadCount(size_t values_per_element, uint64_t* count) {
+    return Read(count) && *count <= (data_.size() - pos_) / sizeof(uint64_t) /
+                                        values_per_element;
+  }
+
+  bool ReadInt32(int32_t* value) {
+    uint64_t v;
+    if (!Read(&v)) return false;
+    *value = static_cast<int32_t>(v);
+    return static_cast<uint64_t>(*value) == v;
+  }
+
+  bool ReadAllocs(std::vector<ArenaAllocWithUsageInterval>* allocs) {
+    uint64_t count;
+    if (!ReadCount(5, &count)) return false;
+    allocs->resize(count);
+    for (auto& alloc : *allocs) {
+      uint64_t offset, size;
+      if (!Read(&offset) || !Read(&size) || !ReadInt32(&alloc.tensor) ||
+          !ReadInt32(&alloc.first_node) || !ReadInt32(&alloc.last_node) ||
+          alloc.tensor < 0 || offset > std::numeric_limits<size_t>::max() ||
+          size > std::numeric_limits<size_t>::max() - offset) {
+        return false;
+      }
+      alloc.offset = offset;
+      alloc.size = size;
+    }
+    return true;
+  }
+
+  bool AtEnd() const { return pos_ == data_.size(); }
+
+ private:
+  const std::string& data_;
+  size_t pos_ = 0;
+};
+
+}  // namespace
 
 ArenaPlanner::ArenaPlanner(TfLiteContext* context,
                            std::unique_ptr<GraphInfo> graph_info,
@@ -381,6 +458,44 @@ TfLiteStatus ArenaPlanner::ExecuteAllocations(int first_node, int last_node) {
   return kTfLiteOk;
 }
 
+TfLiteStatus ArenaPlanner::UpdateAllocations(const std::vector<int>& tensors,
+                                             bool* updated) {
+  *updated = false;
+  if (!has_nonpersistent_memory_) {
+    return kTfLiteOk;
+  }
+  // Tensors sharing a buffer were chosen for their sizes when the plan was
+  // made, so they must be planned again once any of them is resized.
+  // NOLINTNEXTLINE - absl::flat_hash_set increases binary size by 106kB.
+  std::unordered_set<int32_t> shared_tensors;
+  for (const auto& [tensor_index, root_tensor_index] : actual_tensor_id_) {
+    shared_tensors.insert(tensor_index);
+    shared_tensors.insert(root_tensor_index);
+  }
+  TfLiteTensor* graph_tensors = graph_info_->tensors();
+  for (int tensor_index : tensors) {
+    if (tensor_index == kTfLiteOptionalTensor) continue;
+    if (tensor_index < 0 || tensor_index >= allocs_.size()) {
+      return kTfLiteOk;
+    }
+    const TfLiteTensor& tensor = graph_tensors[tensor_index];
+    if (tensor.allocation_type != kTfLiteArenaRw &&
+        tensor.allocation_type != kTfLiteArenaRwPersistent) {
+      continue;
+    }
+    if (shared_tensors.count(tensor_index) != 0 ||
+        allocs_[tensor_index].size < tensor.bytes) {
+      return kTfLiteOk;
+    }
+  }
+  for (int tensor_index : tensors) {
+    if (tensor_index == kTfLiteOptionalTensor) continue;
+    TF_LITE_ENSURE_STATUS(ResolveTensorAllocation(tensor_index, graph_tensors));
+  }
+  *updated = true;
+  return kTfLiteOk;
+}
+
 TfLiteStatus ArenaPlanner::ReleaseNonPersistentMemory() {
   // Clear non-persistent arena's buffer.
   TF_LITE_ENSURE_STATUS(arena_.ReleaseBuffer());
@@ -428,6 +543,37 @@ void ArenaPlanner::GetAllocInfo(size_t* arena_size,
   *arena_persist_size = persistent_arena_.GetBufferSize();
 }
 
+void ArenaPlanner::SetNodeStages(const std::vector<int>& node_stages) {
+  const int num_nodes = static_cast<int>(node_stages.size());
+  stage_first_node_.resize(num_nodes);
+  stage_last_node_.resize(num_nodes);
+  for (int i = 0; i < num_nodes; ++i) {
+    stage_first_node_[i] = (i > 0 && node_stages[i] == node_stages[i - 1])
+                               ? stage_first_node_[i - 1]
+                               : i;
+  }
+  for (int i = num_nodes - 1; i >= 0; --i) {
+    stage_last_node_[i] =
+        (i + 1 < num_nodes && node_stages[i] == node_stages[i + 1])
+            ? stage_last_node_[i + 1]
+            : i;
+  }
+}
+
+int32_t ArenaPlanner::StageFirstNode(int32_t node) const {
+  if (node < 0 || node >= static_cast<int32_t>(stage_first_node_.size())) {
+    return node;
+  }
+  return stage_first_node_[node];
+}
+
+int32_t ArenaPlanner::StageLastNode(int32_t node) const {
+  if (node < 0 || node >= static_cast<int32_t>(stage_last_node_.size())) {
+    return node;
+  }
+  return stage_last_node_[node];
+}
+
 TfLiteStatus ArenaPlanner::Commit(bool* reallocated) {
   bool arena_reallocated, persistent_arena_reallocated;
   TF_LITE_ENSURE_STATUS(arena_.Commit(&arena_reallocated));
@@ -509,6 +655,9 @@ TfLiteStatus ArenaPlanner::CalculateAllocations(
     last_active_node_ = last_node;
     return kTfLiteOk;
   }
+  // After ResetAllocations() the offsets only depend on the tensors to
+  // allocate, so they can be reused from an earlier call for the same ones.
+  const bool cache_plan = last_active_node_ == kLastActiveNodeUndefined;
   if (first_node < last_active_node_) {
     arena_.ResetAllocs();
     last_active_node_ = first_node;
@@ -517,6 +666,18 @@ TfLiteStatus ArenaPlanner::CalculateAllocations(
     // exection faster.
     arena_.PurgeActiveAllocs(first_node);
   }
+  CachedPlan plan;
+  if (cache_plan) {
+    plan.key = CachedPlanKey(first_node, last_node, *tensors_allocated);
+    for (auto it = cached_plans_.begin(); it != cached_plans_.end(); ++it) {
+      if (it->key == plan.key) {
+        std::rotate(it, it + 1, cached_plans_.end());
+        TF_LITE_ENSURE_STATUS(RestoreCachedPlan(cached_plans_.back()));
+        last_active_node_ = last_node;
+        return kTfLiteOk;
+      }
+    }
+  }
   CreateTensorAllocationVector(tensors_allocated);
   // Vector of ids of already allocated tensors, ordered by offset.
   for (const auto& tensor_index : *tensors_allocated) {
@@ -535,16 +696,19 @@ TfLiteStatus ArenaPlanner::CalculateAllocations(
       if (allocation_type != kTfLiteArenaRw ||
           tensors[it->second].bytes != tensors[it->first].bytes) {
         actual_tensor_id_.erase(it);
+        if (cache_plan) plan.unshared_tensors.push_back(tensor_index);
       } else {
         // Don't allocate the tensor, it can safely share the input buffer.
         continue;
       }
     }
     if (tensor.allocation_type == kTfLiteArenaRw) {
-      TF_LITE_ENSURE_STATUS(
-          arena_.Allocate(context_, tensor_alignment_, tensor.bytes,
-                          tensor_index, alloc_node_[tensor_index],
-                          dealloc_node_[tensor_index], &allocs_[tensor_index]));
+      // Tensors used by nodes that may run concurrently must not overlap.
+      TF_LITE_ENSURE_STATUS(arena_.Allocate(
+          context_, tensor_alignment_, tensor.bytes, tensor_index,
+          StageFirstNode(alloc_node_[tensor_index]),
+          StageLastNode(dealloc_node_[tensor_index]), &allocs_[tensor_index]));
+      if (cache_plan) plan.allocs.push_back(allocs_[tensor_index]);
     }
     // Check allocs_[].size to prevent from reallocation of persistent tensors.
     // Only allocate ArenaRwPersistent tensors which own their buffer.
@@ -556,13 +720,112 @@ TfLiteStatus ArenaPlanner::CalculateAllocations(
             /*first_node=*/alloc_node_[tensor_index],
             /*last_node=*/std::numeric_limits<int32_t>::max(),
             &allocs_[tensor_index]));
+        if (cache_plan) {
+          plan.persistent_allocs.push_back(allocs_[tensor_index]);
+        }
       }
     }
   }
+  if (cache_plan) {
+    if (cached_plans_.size() >= kMaxCachedPlans) {
+      cached_plans_.erase(cached_plans_.begin());
+    }
+    cached_plans_.push_back(std::move(plan));
+  }
   last_active_node_ = last_node;
   return kTfLiteOk;
 }
 
+std::vector<uint64_t> ArenaPlanner::CachedPlanKey(
+    int first_node, int last_node,
+    const std::vector<int32_t>& tensors_allocated) const {
+  const TfLiteTensor* tensors = graph_info_->tensors();
+  std::vector<uint64_t> key;
+  key.reserve(3 + 8 * tensors_allocated.size());
+  auto append = [&key](auto value) {
+    key.push_back(static_cast<uint64_t>(value));
+  };
+  append(tensor_alignment_);
+  append(first_node);
+  append(last_node);
+  for (int32_t tensor_index : tensors_allocated) {
+    append(tensor_index);
+    append(tensors[tensor_index].allocation_type);
+    append(tensors[tensor_index].bytes);
+    append(StageFirstNode(alloc_node_[tensor_index]));
+    append(StageLastNode(dealloc_node_[tensor_index]));
+    auto it = actual_tensor_id_.find(tensor_index);
+    if (it == actual_tensor_id_.end()) {
+      append(tensor_index);
+      append(0);
+      append(0);
+    } else {
+      append(it->second);
+      append(tensors[it->second].allocation_type);
+      append(tensors[it->second].bytes);
+    }
+  }
+  return key;
+}
+
+TfLiteStatus ArenaPlanner::RestoreCachedPlan(const CachedPlan& plan) {
+  for (int32_t tensor_index : plan.unshared_tensors) {
+    actual_tensor_id_.erase(tensor_index);
+  }
+  for (const auto* allocs : {&plan.allocs, &plan.persistent_allocs}) {
+    for (const auto& alloc : *allocs) {
+      TF_LITE_ENSURE(context_,
+                     static_cast<size_t>(alloc.tensor) < allocs_.size());
+      allocs_[alloc.tensor] = alloc;
+    }
+  }
+  arena_.AddAllocs(plan.allocs);
+  persistent_arena_.AddAllocs(plan.persistent_allocs);
+  return kTfLiteOk;
+}
+
+std::string ArenaPlanner::SerializeCachedPlans() const {
+  std::string data;
+  AppendUint64(kCachedPlansMagic, &data);
+  AppendUint64(cached_plans_.size(), &data);
+  for (const CachedPlan& plan : cached_plans_) {
+    AppendUint64(plan.key.size(), &data);
+    for (uint64_t value : plan.key) AppendUint64(value, &data);
+    AppendAllocs(plan.allocs, &data);
+    AppendAllocs(plan.persistent_allocs, &data);
+    AppendUint64(plan.unshared_tensors.size(), &data);
+    for (int32_t tensor_index : plan.unshared_tensors) {
+      AppendUint64(tensor_index, &data);
+    }
+  }
+  return data;
+}
+
+TfLiteStatus ArenaPlanner::LoadCachedPlans(const std::string& data) {
+  Uint64Reader reader(data);
+  uint64_t magic, num_plans;
+  TF_LITE_ENSURE(context_, reader.Read(&magic) && magic == kCachedPlansMagic);
+  TF_LITE_ENSURE(context_, reader.ReadCount(1, &num_plans) &&
+                               num_plans <= kMaxCachedPlans);
+  std::vector<CachedPlan> plans(num_plans);
+  for (CachedPlan& plan : plans) {
+    uint64_t count;
+    TF_LITE_ENSURE(context_, reader.ReadCount(1, &count));
+    plan.key.resize(count);
+    for (uint64_t& value : plan.key) reader.Read(&value);
+    TF_LITE_ENSURE(context_, reader.ReadAllocs(&plan.allocs));
+    TF_LITE_ENSURE(context_, reader.ReadAllocs(&plan.persistent_allocs));
+    TF_LITE_ENSURE(context_, reader.ReadCount(1, &count));
+    plan.unshared_tensors.resize(count);
+    for (int32_t& tensor_index : plan.unshared_tensors) {
+      TF_LITE_ENSURE(context_, reader.ReadInt32(&tensor_index));
+    }
+  }
+  TF_LITE_ENSURE(context_, reader.AtEnd());
+  cached_plans_ = std::move(plans);
+  return kTfLiteOk;
+}
+
 bool AreTensorsAllocatedInSameArena(int32_t root_tensor_index,
                                     int32_t tensor_index,
                                     const TfLiteTensor* tensors) {
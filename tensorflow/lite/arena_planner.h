@@ -18,6 +18,7 @@ limitations under the License.
 #include <cstddef>
 #include <cstdint>
 #include <memory>
+#include <string>
 #include <unordered_map>
 #include <unordered_set>
 #include <vector>
@@ -62,17 +63,57 @@ class ArenaPlanner : public MemoryPlanner {
   TfLiteStatus ResetAllocationsAfter(int node) override;
   TfLiteStatus PlanAllocations() override;
   TfLiteStatus ExecuteAllocations(int first_node, int last_node) override;
+  TfLiteStatus UpdateAllocations(const std::vector<int>& tensors,
+                                 bool* updated) override;
   TfLiteStatus ReleaseNonPersistentMemory() override;
   TfLiteStatus AcquireNonPersistentMemory() override;
   bool HasNonPersistentMemory() override;
   void DumpDebugInfo(const std::vector<int>& execution_plan) const override;
   void GetAllocInfo(size_t* arena_size,
                     size_t* arena_persist_size) const override;
+  void SetNodeStages(const std::vector<int>& node_stages) override;
 
   // Returns the base arena location for a given allocation type.
   std::intptr_t BasePointer(TfLiteAllocationType type);
 
+  // The tensor offsets calculated by ExecuteAllocations() after
+  // ResetAllocations() are cached, keyed by the size, allocation type, usage
+  // interval and buffer sharing of the tensors they were calculated for. A
+  // later call with the same tensors, e.g. after resizing the inputs back to
+  // shapes used before, reuses them instead of calculating them again.
+  //
+  // Returns the cached plans, in host byte order, to be given to
+  // LoadCachedPlans() by a later planner of the same graph.
+  std::string SerializeCachedPlans() const;
+
+  // Replaces the cached plans by the ones serialized in `data`. The plans must
+  // have been serialized by a planner of the same graph: their offsets are not
+  // checked again when they are used.
+  TfLiteStatus LoadCachedPlans(const std::string& data);
+
  private:
+  // The offsets calculated by CalculateAllocations() for a set of tensors
+  // after ResetAllocations().
+  struct CachedPlan {
+    // Holds for each allocated tensor, in order, its index, allocation type,
+    // size, the first and last node of the stages it is used in and the index,
+    // allocation type and size of the tensor whose buffer it shares.
+    std::vector<uint64_t> key;
+    std::vector<ArenaAllocWithUsageInterval> allocs;
+    std::vector<ArenaAllocWithUsageInterval> persistent_allocs;
+    // Tensors that stopped sharing the buffer of another tensor.
+    std::vector<int32_t> unshared_tensors;
+  };
+
+  // Returns the key of the plan for `tensors_allocated`, in the order given by
+  // GetTensorsToAllocate().
+  std::vector<uint64_t> CachedPlanKey(
+      int first_node, int last_node,
+      const std::vector<int32_t>& tensors_allocated) const;
+
+  // Restores the allocations of `plan` instead of calculating them.
+  TfLiteStatus RestoreCachedPlan(const CachedPlan& plan);
+
   // Check whether the input tensor's memory may be shared the output tensor.
   // tensor_changed: true if the output tensor modifies the tensor data. For
   // example, `Reshape` doesn't modify data but Add does.
@@ -120,6 +161,14 @@ class ArenaPlanner : public MemoryPlanner {
   // Return the index of the tensor owing `tensor_index's` buffer.
   int FindSharedTensor(int tensor_index);
 
+  // Returns the first node of the stage of `node`, where the tensors first
+  // used by `node` are allocated at, or `node` if stages are not set.
+  int32_t StageFirstNode(int32_t node) const;
+
+  // Returns the last node of the stage of `node`, where the tensors last used
+  // by `node` are deallocated at, or `node` if stages are not set.
+  int32_t StageLastNode(int32_t node) const;
+
   TfLiteContext* context_;
   std::unique_ptr<GraphInfo> graph_info_;
 
@@ -166,6 +215,13 @@ class ArenaPlanner : public MemoryPlanner {
 
   // Store number of references to each tensor.
   std::vector<int> refcounts_;
+
+  // First and last node of the stage of each node, see SetNodeStages().
+  std::vector<int32_t> stage_first_node_;
+  std::vector<int32_t> stage_last_node_;
+
+  // Plans calculated after ResetAllocations(), the most recently used last.
+  std::vector<CachedPlan> cached_plans_;
 };
 
 }  // namespace tflite
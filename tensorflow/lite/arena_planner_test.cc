@@ -22,6 +22,7 @@ limitations under the License.
 #include <initializer_list>
 #include <memory>
 #include <set>
+#include <string>
 #include <utility>
 #include <vector>
 
@@ -330,6 +331,144 @@ TEST_F(ArenaPlannerTest, SimpleGraph) {
   EXPECT_EQ(GetOffset(1), 4);
 }
 
+TEST_F(ArenaPlannerTest, NodeStagesDoNotShareMemory) {
+  TestGraph graph({0},
+                  {
+                      /* in, out, tmp */
+                      {{0}, {1}, {}},     // First op, first stage
+                      {{0}, {2}, {}},     // Second op, first stage
+                      {{1}, {3}, {6}},    // Third op, second stage
+                      {{2}, {4}, {7}},    // Fourth op, second stage
+                      {{3, 4}, {5}, {}},  // Fifth op, third stage
+                  },
+                  {5});
+  SetGraph(&graph);
+  Execute(0, graph.nodes().size() - 1);
+  // Run one at a time, the third and fourth ops share their temporaries.
+  EXPECT_EQ(GetOffset(6), GetOffset(7));
+
+  planner_->SetNodeStages({0, 0, 1, 1, 2});
+  ResetAllocations();
+  ASSERT_EQ(planner_->PlanAllocations(), kTfLiteOk);
+  Execute(0, graph.nodes().size() - 1);
+  // The tensors used by the ops of a stage are all allocated during the
+  // stage.
+  const std::vector<std::vector<int>> stage_tensors = {{0, 1, 2},
+                                                       {1, 2, 3, 4, 6, 7}};
+  for (const std::vector<int>& tensors : stage_tensors) {
+    for (int i : tensors) {
+      for (int j : tensors) {
+        if (i == j) continue;
+        EXPECT_TRUE(GetOffsetAfter(i) <= GetOffset(j) ||
+                    GetOffsetAfter(j) <= GetOffset(i))
+            << "tensors " << i << " and " << j << " overlap";
+      }
+    }
+  }
+}
+
+TEST_F(ArenaPlannerTest, CachedPlanReusedAfterResize) {
+  TestGraph graph({0, 1},
+                  {
+                      /* in, out, tmp */
+                      {{0, 1}, {2}, {}},     // First op
+                      {{2, 0}, {4, 5}, {}},  // Second op
+                      {{4, 5}, {3}, {}}      // Third op
+                  },
+                  {3});
+  SetGraph(&graph);
+  Execute(0, graph.nodes().size() - 1);
+  std::vector<std::ptrdiff_t> offsets;
+  for (int i = 0; i < 6; ++i) offsets.push_back(GetOffset(i));
+
+  ResetAllocations();
+  std::vector<TfLiteTensor>& tensors = *graph.tensors();
+  tensors[0].bytes = 100;
+  Execute(0, graph.nodes().size() - 1);
+  EXPECT_NE(GetOffset(1), offsets[1]);
+  const std::string two_plans = planner_->SerializeCachedPlans();
+
+  // Resizing back reuses the first plan instead of adding a third one.
+  ResetAllocations();
+  tensors[0].bytes = 3;
+  Execute(0, graph.nodes().size() - 1);
+  for (int i = 0; i < 6; ++i) EXPECT_EQ(GetOffset(i), offsets[i]);
+  EXPECT_EQ(planner_->SerializeCachedPlans().size(), two_plans.size());
+}
+
+TEST_F(ArenaPlannerTest, UpdateAllocationsOfTensorsThatStillFit) {
+  TestGraph graph({0, 1},
+                  {
+                      /* in, out, tmp */
+                      {{0, 1}, {2}, {}},     // First op
+                      {{2, 0}, {4, 5}, {}},  // Second op
+                      {{4, 5}, {3}, {}}      // Third op
+                  },
+                  {3});
+  SetGraph(&graph);
+  Execute(0, graph.nodes().size() - 1);
+  std::vector<std::ptrdiff_t> offsets;
+  for (int i = 0; i < 6; ++i) offsets.push_back(GetOffset(i));
+
+  std::vector<TfLiteTensor>& tensors = *graph.tensors();
+  tensors[0].bytes = 1;
+  tensors[3].bytes = 6;
+  tensors[3].data.raw = nullptr;
+  bool updated = false;
+  ASSERT_EQ(planner_->UpdateAllocations({0, 3}, &updated), kTfLiteOk);
+  EXPECT_TRUE(updated);
+  for (int i = 0; i < 6; ++i) EXPECT_EQ(GetOffset(i), offsets[i]);
+
+  // A tensor larger than the memory planned for it needs a new plan.
+  tensors[3].bytes = 100;
+  ASSERT_EQ(planner_->UpdateAllocations({0, 3}, &updated), kTfLiteOk);
+  EXPECT_FALSE(updated);
+}
+
+TEST_F(ArenaPlannerTest, SerializedCachedPlansReused) {
+  TestGraph graph({0},
+                  {
+                      /* in, out, tmp */
+                      {{0}, {1}, {}},     // First op
+                      {{1}, {2}, {7}},    // Second op
+                      {{2}, {3}, {}},     // Third op
+                      {{3}, {4}, {}},     // Fourth op
+                      {{1, 4}, {5}, {}},  // Fifth op
+                  },
+                  {5});
+  (*graph.tensors())[7].allocation_type = kTfLiteArenaRwPersistent;
+  SetGraph(&graph);
+  Execute(0, graph.nodes().size() - 1);
+  // Tensor 6 is not used by the graph.
+  const std::vector<int> allocated_tensors = {0, 1, 2, 3, 4, 5, 7};
+  std::vector<std::ptrdiff_t> offsets;
+  for (int i : allocated_tensors) offsets.push_back(GetOffset(i));
+  const std::string data = planner_->SerializeCachedPlans();
+
+  SetGraph(&graph);
+  ASSERT_EQ(planner_->LoadCachedPlans(data), kTfLiteOk);
+  Execute(0, graph.nodes().size() - 1);
+  for (int i = 0; i < allocated_tensors.size(); ++i) {
+    EXPECT_EQ(GetOffset(allocated_tensors[i]), offsets[i]);
+  }
+  // The loaded plan was used, so no other plan has been cached.
+  EXPECT_EQ(planner_->SerializeCachedPlans(), data);
+}
+
+TEST_F(ArenaPlannerTest, LoadCachedPlansRejectsInvalidData) {
+  TestGraph graph({0, 1}, {{{0, 1}, {2}, {}}}, {2});
+  SetGraph(&graph);
+  Execute(0, graph.nodes().size() - 1);
+  std::string data = planner_->SerializeCachedPlans();
+
+  EXPECT_EQ(planner_->LoadCachedPlans(""), kTfLiteError);
+  EXPECT_EQ(planner_->LoadCachedPlans(data.substr(0, data.size() - 1)),
+            kTfLiteError);
+  EXPECT_EQ(planner_->LoadCachedPlans(data + data), kTfLiteError);
+  data[0] ^= 1;
+  EXPECT_EQ(planner_->LoadCachedPlans(data), kTfLiteError);
+}
+
 TEST_F(ArenaPlannerTest, AllocsCorrectlyReset) {
   TestGraph graph({0, 1},
                   {
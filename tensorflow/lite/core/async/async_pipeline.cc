@@ -0,0 +1,152 @@
+/* Copyright 2024 The TensorFlow Authors. All Rights Reserved.
+
+Licensed under the Apache License, Version 2.0 (the "License");
+you may not use this file except in compliance with the License.
+You may obtain a copy of the License at
+
+    http://www.apache.org/licenses/LICENSE-2.0
+
+Unless required by applicable law or agreed to in writing, software
+distributed under the License is distributed on an "AS IS" BASIS,
+WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+See the License for the specific language governing permissions and
+limitations under the License.
+==============================================================================*/
+#include "tensorflow/lite/core/async/async_pipeline.h"
+
+#include <algorithm>
+#include <mutex>  // NOLINT(build/c++11)
+#include <utility>
+#include <vector>
+
+#include "tensorflow/lite/core/async/async_signature_runner.h"
+#include "tensorflow/lite/core/async/c/types.h"
+#include "tensorflow/lite/core/c/c_api_types.h"
+#include "tensorflow/lite/logger.h"
+#include "tensorflow/lite/minimal_logging.h"
+
+namespace tflite {
+namespace async {
+
+AsyncPipeline::AsyncPipeline(std::vector<Stage> stages, int num_slots)
+    : stages_(std::move(stages)),
+      slots_(std::max(num_slots, 1)),
+      stage_queues_(stages_.size()) {
+  threads_.reserve(stages_.size());
+  for (int i = 0; i < static_cast<int>(stages_.size()); ++i) {
+    threads_.emplace_back([this, i] { StageLoop(i); });
+  }
+}
+
+AsyncPipeline::~AsyncPipeline() {
+  {
+    std::unique_lock<std::mutex> lock(mutex_);
+    changed_.wait(lock, [this] {
+      return std::none_of(slots_.begin(), slots_.end(), [](const Slot& slot) {
+        return slot.state == SlotState::kRunning;
+      });
+    });
+    stopping_ = true;
+  }
+  changed_.notify_all();
+  for (std::thread& thread : threads_) {
+    thread.join();
+  }
+}
+
+int AsyncPipeline::AcquireSlot() {
+  std::unique_lock<std::mutex> lock(mutex_);
+  auto free_slot = slots_.end();
+  changed_.wait(lock, [&] {
+    free_slot =
+        std::find_if(slots_.begin(), slots_.end(), [](const Slot& slot) {
+          return slot.state == SlotState::kFree;
+        });
+    return free_slot != slots_.end();
+  });
+  free_slot->state = SlotState::kAcquired;
+  return static_cast<int>(free_slot - slots_.begin());
+}
+
+TfLiteStatus AsyncPipeline::Submit(int slot) {
+  {
+    std::lock_guard<std::mutex> lock(mutex_);
+    if (slot < 0 || slot >= num_slots() ||
+        slots_[slot].state != SlotState::kAcquired) {
+      TFLITE_LOG(tflite::TFLITE_LOG_ERROR,
+                 "The pipeline slot %d is not acquired.", slot);
+      return kTfLiteError;
+    }
+    slots_[slot].status = kTfLiteOk;
+    if (stages_.empty()) {
+      slots_[slot].state = SlotState::kDone;
+    } else {
+      slots_[slot].state = SlotState::kRunning;
+      stage_queues_[0].push_back(slot);
+    }
+  }
+  changed_.notify_all();
+  return kTfLiteOk;
+}
+
+TfLiteStatus AsyncPipeline::Wait(int slot) {
+  std::unique_lock<std::mutex> lock(mutex_);
+  if (slot < 0 || slot >= num_slots() ||
+      (slots_[slot].state != SlotState::kRunning &&
+       slots_[slot].state != SlotState::kDone)) {
+    TFLITE_LOG(tflite::TFLITE_LOG_ERROR,
+               "The pipeline slot %d has not been submitted.", slot);
+    return kTfLiteError;
+  }
+  changed_.wait(lock,
+                [&] { return slots_[slot].state == SlotState::kDone; });
+  return slots_[slot].status;
+}
+
+void AsyncPipeline::ReleaseSlot(int slot) {
+  {
+    std::unique_lock<std::mutex> lock(mutex_);
+    if (slot < 0 || slot >= num_slots()) return;
+    changed_.wait(lock,
+                  [&] { return slots_[slot].state != SlotState::kRunning; });
+    slots_[slot].state = SlotState::kFree;
+  }
+  changed_.notify_all();
+}
+
+AsyncPipeline::Stage AsyncPipeline::SignatureRunnerStage(
+    AsyncSignatureRunner* runner, std::vector<TfLiteExecutionTask*> tasks) {
+  return [runner, tasks = std::move(tasks)](int slot) {
+    if (slot >= static_cast<int>(tasks.size())) return kTfLiteError;
+    if (runner->InvokeAsync(tasks[slot]) != kTfLiteOk) return kTfLiteError;
+    return runner->Wait(tasks[slot]);
+  };
+}
+
+void AsyncPipeline::StageLoop(int stage_index) {
+  std::deque<int>& queue = stage_queues_[stage_index];
+  std::unique_lock<std::mutex> lock(mutex_);
+  while (true) {
+    changed_.wait(lock, [&] { return stopping_ || !queue.empty(); });
+    if (queue.empty()) return;
+    const int slot = queue.front();
+    queue.pop_front();
+    TfLiteStatus status = slots_[slot].status;
+    if (status == kTfLiteOk) {
+      // Other stages run other slots meanwhile.
+      lock.unlock();
+      status = stages_[stage_index](slot);
+      lock.lock();
+      slots_[slot].status = status;
+    }
+    if (stage_index + 1 < static_cast<int>(stages_.size())) {
+      stage_queues_[stage_index + 1].push_back(slot);
+    } else {
+      slots_[slot].state = SlotState::kDone;
+    }
+    changed_.notify_all();
+  }
+}
+
+}  // namespace async
+}  // namespace tflite
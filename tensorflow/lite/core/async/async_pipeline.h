@@ -0,0 +1,117 @@
+/* Copyright 2024 The TensorFlow Authors. All Rights Reserved.
+
+Licensed under the Apache License, Version 2.0 (the "License");
+you may not use this file except in compliance with the License.
+You may obtain a copy of the License at
+
+    http://www.apache.org/licenses/LICENSE-2.0
+
+Unless required by applicable law or agreed to in writing, software
+distributed under the License is distributed on an "AS IS" BASIS,
+WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+See the License for the specific language governing permissions and
+limitations under the License.
+==============================================================================*/
+#ifndef TENSORFLOW_LITE_CORE_ASYNC_ASYNC_PIPELINE_H_
+#define TENSORFLOW_LITE_CORE_ASYNC_ASYNC_PIPELINE_H_
+
+#include <condition_variable>  // NOLINT(build/c++11)
+#include <deque>
+#include <functional>
+#include <mutex>  // NOLINT(build/c++11)
+#include <thread>  // NOLINT(build/c++11)
+#include <vector>
+
+#include "tensorflow/lite/core/async/async_signature_runner.h"
+#include "tensorflow/lite/core/async/c/types.h"
+#include "tensorflow/lite/core/c/c_api_types.h"
+
+namespace tflite {
+namespace async {
+
+// AsyncPipeline runs consecutive inferences through a sequence of stages
+// concurrently, e.g. the CPU preprocessing of frame N+1 while a delegate runs
+// frame N, so that the throughput is bounded by the slowest stage rather than
+// the sum of the stages.
+//
+// Each inference in flight uses one of `num_slots` slots, and each stage has
+// per slot resources, e.g. an execution task with its own registered buffers:
+// with 2 slots the buffers between the stages are double buffered. Each stage
+// runs on its own thread, one slot at a time in submission order.
+//
+// Since AsyncSubgraph only supports subgraphs fully delegated to one backend,
+// a graph is split at its delegate boundaries into one AsyncSignatureRunner
+// per delegated part, see `SignatureRunnerStage`, and CPU stages.
+//
+// Usage:
+//   AsyncPipeline pipeline({preprocess, AsyncPipeline::SignatureRunnerStage(
+//                                           runner, tasks)});
+//   for each frame:
+//     int slot = pipeline.AcquireSlot();  // Blocks while all are in flight.
+//     ... Write the frame to the input of `slot`.
+//     pipeline.Submit(slot);
+//   and, e.g. on another thread, in the same order:
+//     pipeline.Wait(slot);
+//     ... Read the outputs of `slot`.
+//     pipeline.ReleaseSlot(slot);
+//
+// WARNING: This is an experimental API and subject to change.
+class AsyncPipeline {
+ public:
+  // Runs the stage for the inference in `slot`. If a stage fails, the later
+  // stages don't run for that inference.
+  using Stage = std::function<TfLiteStatus(int slot)>;
+
+  explicit AsyncPipeline(std::vector<Stage> stages, int num_slots = 2);
+
+  // Waits for the inferences submitted to go through the stages.
+  ~AsyncPipeline();
+
+  AsyncPipeline(const AsyncPipeline&) = delete;
+  AsyncPipeline& operator=(const AsyncPipeline&) = delete;
+
+  int num_slots() const { return static_cast<int>(slots_.size()); }
+
+  // Blocks until a slot is free and returns it.
+  int AcquireSlot();
+
+  // Starts the inference in `slot`, which must be acquired, through the
+  // stages.
+  TfLiteStatus Submit(int slot);
+
+  // Blocks until the inference in `slot` went through the stages and returns
+  // the status of the first failed stage, or kTfLiteOk.
+  TfLiteStatus Wait(int slot);
+
+  // Releases `slot` once its inference is done and its outputs are read.
+  void ReleaseSlot(int slot);
+
+  // Returns a stage running `tasks[slot]` with `runner`, blocking until the
+  // backend finishes it. `runner` and the tasks must outlive the pipeline.
+  static Stage SignatureRunnerStage(AsyncSignatureRunner* runner,
+                                    std::vector<TfLiteExecutionTask*> tasks);
+
+ private:
+  enum class SlotState { kFree, kAcquired, kRunning, kDone };
+
+  struct Slot {
+    SlotState state = SlotState::kFree;
+    TfLiteStatus status = kTfLiteOk;
+  };
+
+  void StageLoop(int stage_index);
+
+  std::vector<Stage> stages_;
+  std::mutex mutex_;
+  std::condition_variable changed_;
+  bool stopping_ = false;
+  std::vector<Slot> slots_;
+  // The slots waiting for each stage, in submission order.
+  std::vector<std::deque<int>> stage_queues_;
+  std::vector<std::thread> threads_;
+};
+
+}  // namespace async
+}  // namespace tflite
+
+#endif  // TENSORFLOW_LITE_CORE_ASYNC_ASYNC_PIPELINE_H_
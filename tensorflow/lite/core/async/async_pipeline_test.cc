@@ -0,0 +1,145 @@
+/* Copyright 2024 The TensorFlow Authors. All Rights Reserved.
+
+Licensed under the Apache License, Version 2.0 (the "License");
+you may not use this file except in compliance with the License.
+You may obtain a copy of the License at
+
+    http://www.apache.org/licenses/LICENSE-2.0
+
+Unless required by applicable law or agreed to in writing, software
+distributed under the License is distributed on an "AS IS" BASIS,
+WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+See the License for the specific language governing permissions and
+limitations under the License.
+==============================================================================*/
+#include "tensorflow/lite/core/async/async_pipeline.h"
+
+#include <chrono>  // NOLINT(build/c++11)
+#include <condition_variable>  // NOLINT(build/c++11)
+#include <mutex>  // NOLINT(build/c++11)
+#include <utility>
+#include <vector>
+
+#include <gmock/gmock.h>
+#include <gtest/gtest.h>
+#include "tensorflow/lite/core/c/c_api_types.h"
+
+namespace tflite {
+namespace async {
+namespace {
+
+using ::testing::ElementsAre;
+
+// Records the (inference, stage) pairs run, with the inference of each slot.
+class Recorder {
+ public:
+  AsyncPipeline::Stage Stage(int stage_index) {
+    return [this, stage_index](int slot) {
+      std::lock_guard<std::mutex> lock(mutex_);
+      runs_.emplace_back(inference_of_slot_[slot], stage_index);
+      return kTfLiteOk;
+    };
+  }
+
+  void SetInference(int slot, int inference) {
+    std::lock_guard<std::mutex> lock(mutex_);
+    inference_of_slot_[slot] = inference;
+  }
+
+  std::vector<std::pair<int, int>> runs() {
+    std::lock_guard<std::mutex> lock(mutex_);
+    return runs_;
+  }
+
+ private:
+  std::mutex mutex_;
+  int inference_of_slot_[2] = {};
+  std::vector<std::pair<int, int>> runs_;
+};
+
+TEST(AsyncPipelineTest, RunsTheStagesOfEachInferenceInOrder) {
+  Recorder recorder;
+  AsyncPipeline pipeline({recorder.Stage(0), recorder.Stage(1)});
+  EXPECT_EQ(pipeline.num_slots(), 2);
+  for (int inference = 0; inference < 3; ++inference) {
+    const int slot = pipeline.AcquireSlot();
+    recorder.SetInference(slot, inference);
+    ASSERT_EQ(pipeline.Submit(slot), kTfLiteOk);
+    EXPECT_EQ(pipeline.Wait(slot), kTfLiteOk);
+    pipeline.ReleaseSlot(slot);
+  }
+  EXPECT_THAT(recorder.runs(),
+              ElementsAre(std::make_pair(0, 0), std::make_pair(0, 1),
+                          std::make_pair(1, 0), std::make_pair(1, 1),
+                          std::make_pair(2, 0), std::make_pair(2, 1)));
+}
+
+TEST(AsyncPipelineTest, OverlapsStagesOfConsecutiveInferences) {
+  // The second stage of the first inference blocks until the first stage of
+  // the second inference ran, which requires them to run concurrently.
+  std::mutex mutex;
+  std::condition_variable changed;
+  int first_stage_runs = 0;
+  AsyncPipeline::Stage first_stage = [&](int slot) {
+    {
+      std::lock_guard<std::mutex> lock(mutex);
+      ++first_stage_runs;
+    }
+    changed.notify_all();
+    return kTfLiteOk;
+  };
+  AsyncPipeline::Stage second_stage = [&](int slot) {
+    std::unique_lock<std::mutex> lock(mutex);
+    const bool overlapped =
+        changed.wait_for(lock, std::chrono::seconds(10),
+                         [&] { return first_stage_runs == 2; });
+    return overlapped ? kTfLiteOk : kTfLiteError;
+  };
+  AsyncPipeline pipeline({first_stage, second_stage});
+  const int first = pipeline.AcquireSlot();
+  ASSERT_EQ(pipeline.Submit(first), kTfLiteOk);
+  const int second = pipeline.AcquireSlot();
+  EXPECT_NE(first, second);
+  ASSERT_EQ(pipeline.Submit(second), kTfLiteOk);
+  EXPECT_EQ(pipeline.Wait(first), kTfLiteOk);
+  EXPECT_EQ(pipeline.Wait(second), kTfLiteOk);
+  pipeline.ReleaseSlot(first);
+  pipeline.ReleaseSlot(second);
+}
+
+TEST(AsyncPipelineTest, SkipsTheStagesAfterAFailure) {
+  Recorder recorder;
+  AsyncPipeline pipeline(
+      {recorder.Stage(0), [](int slot) { return kTfLiteDelegateError; },
+       recorder.Stage(2)});
+  const int slot = pipeline.AcquireSlot();
+  ASSERT_EQ(pipeline.Submit(slot), kTfLiteOk);
+  EXPECT_EQ(pipeline.Wait(slot), kTfLiteDelegateError);
+  pipeline.ReleaseSlot(slot);
+  EXPECT_THAT(recorder.runs(), ElementsAre(std::make_pair(0, 0)));
+
+  // The slot runs all the stages again on its next inference.
+  const int next_slot = pipeline.AcquireSlot();
+  ASSERT_EQ(pipeline.Submit(next_slot), kTfLiteOk);
+  EXPECT_EQ(pipeline.Wait(next_slot), kTfLiteDelegateError);
+  pipeline.ReleaseSlot(next_slot);
+  EXPECT_EQ(recorder.runs().size(), 2);
+}
+
+TEST(AsyncPipelineTest, RequiresAcquiredSlots) {
+  AsyncPipeline pipeline({[](int slot) { return kTfLiteOk; }},
+                         /*num_slots=*/1);
+  EXPECT_EQ(pipeline.Submit(0), kTfLiteError);
+  EXPECT_EQ(pipeline.Submit(1), kTfLiteError);
+  EXPECT_EQ(pipeline.Wait(0), kTfLiteError);
+  const int slot = pipeline.AcquireSlot();
+  EXPECT_EQ(slot, 0);
+  ASSERT_EQ(pipeline.Submit(slot), kTfLiteOk);
+  EXPECT_EQ(pipeline.Submit(slot), kTfLiteError);
+  EXPECT_EQ(pipeline.Wait(slot), kTfLiteOk);
+  pipeline.ReleaseSlot(slot);
+}
+
+}  // namespace
+}  // namespace async
+}  // namespace tflite
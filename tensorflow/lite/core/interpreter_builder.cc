@@ -446,8 +446,14 @@ TfLiteStatus InterpreterBuilder::ParseQuantization(
   }
 
   // Ensure that the number of scales is 1 for per-layer quantization, and
-  // matches number of quantization dimensions for per-axis quantization.
-  if (num_scales != 1 &&
+  // matches number of quantization dimensions for per-axis quantization. 2-D
+  // tensors quantized along their first dimension may also have group-wise
+  // scales, splitting each row in groups of the same number of values.
+  const bool is_group_wise =
+      dims.size() == 2 && src_quantization->quantized_dimension() == 0 &&
+      dims[0] > 0 && num_scales % dims[0] == 0 &&
+      dims[1] % (num_scales / dims[0]) == 0;
+  if (num_scales != 1 && !is_group_wise &&
       (!dims.empty() &&
        num_scales != dims[src_quantization->quantized_dimension()])) {
     TF_LITE_REPORT_ERROR(
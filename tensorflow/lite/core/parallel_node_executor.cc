@@ -0,0 +1,81 @@
+/* Copyright 2024 The TensorFlow Authors. All Rights Reserved.
+
+Licensed under the Apache License, Version 2.0 (the "License");
+you may not use this file except in compliance with the License.
+You may obtain a copy of the License at
+
+    http://www.apache.org/licenses/LICENSE-2.0
+
+Unless required by applicable law or agreed to in writing, software
+distributed under the License is distributed on an "AS IS" BASIS,
+WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+See the License for the specific language governing permissions and
+limitations under the License.
+==============================================================================*/
+#include "tensorflow/lite/core/parallel_node_executor.h"
+
+#include <functional>
+#include <mutex>  // NOLINT(build/c++11)
+
+namespace tflite {
+
+ParallelNodeExecutor::ParallelNodeExecutor(int num_threads) {
+  for (int thread = 1; thread < num_threads; ++thread) {
+    threads_.emplace_back([this, thread] { WorkerLoop(thread); });
+  }
+}
+
+ParallelNodeExecutor::~ParallelNodeExecutor() {
+  {
+    std::lock_guard<std::mutex> lock(mutex_);
+    stop_ = true;
+  }
+  work_available_.notify_all();
+  for (std::thread& thread : threads_) thread.join();
+}
+
+void ParallelNodeExecutor::Run(int num_tasks,
+                               const std::function<void(int, int)>& fn) {
+  if (threads_.empty() || num_tasks <= 1) {
+    for (int task = 0; task < num_tasks; ++task) fn(0, task);
+    return;
+  }
+  {
+    std::lock_guard<std::mutex> lock(mutex_);
+    fn_ = &fn;
+    num_tasks_ = num_tasks;
+    next_task_.store(0, std::memory_order_relaxed);
+    busy_workers_ = static_cast<int>(threads_.size());
+    ++batch_;
+  }
+  work_available_.notify_all();
+  RunTasks(/*thread=*/0);
+  std::unique_lock<std::mutex> lock(mutex_);
+  work_done_.wait(lock, [this] { return busy_workers_ == 0; });
+  fn_ = nullptr;
+}
+
+void ParallelNodeExecutor::WorkerLoop(int thread) {
+  int batch = 0;
+  while (true) {
+    {
+      std::unique_lock<std::mutex> lock(mutex_);
+      work_available_.wait(lock, [&] { return stop_ || batch_ != batch; });
+      if (stop_) return;
+      batch = batch_;
+    }
+    RunTasks(thread);
+    std::lock_guard<std::mutex> lock(mutex_);
+    if (--busy_workers_ == 0) work_done_.notify_one();
+  }
+}
+
+void ParallelNodeExecutor::RunTasks(int thread) {
+  for (int task = next_task_.fetch_add(1, std::memory_order_relaxed);
+       task < num_tasks_;
+       task = next_task_.fetch_add(1, std::memory_order_relaxed)) {
+    (*fn_)(thread, task);
+  }
+}
+
+}  // namespace tflite
@@ -0,0 +1,65 @@
+/* Copyright 2024 The TensorFlow Authors. All Rights Reserved.
+
+Licensed under the Apache License, Version 2.0 (the "License");
+you may not use this file except in compliance with the License.
+You may obtain a copy of the License at
+
+    http://www.apache.org/licenses/LICENSE-2.0
+
+Unless required by applicable law or agreed to in writing, software
+distributed under the License is distributed on an "AS IS" BASIS,
+WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+See the License for the specific language governing permissions and
+limitations under the License.
+==============================================================================*/
+#ifndef TENSORFLOW_LITE_CORE_PARALLEL_NODE_EXECUTOR_H_
+#define TENSORFLOW_LITE_CORE_PARALLEL_NODE_EXECUTOR_H_
+
+#include <atomic>
+#include <condition_variable>  // NOLINT(build/c++11)
+#include <functional>
+#include <mutex>  // NOLINT(build/c++11)
+#include <thread>  // NOLINT(build/c++11)
+#include <vector>
+
+namespace tflite {
+
+// Runs batches of independent tasks, e.g. the nodes of a subgraph that do not
+// depend on each other, on a fixed set of threads. The thread calling Run() is
+// one of them, so that a batch of a single task does not switch threads.
+class ParallelNodeExecutor {
+ public:
+  explicit ParallelNodeExecutor(int num_threads);
+  ~ParallelNodeExecutor();
+  ParallelNodeExecutor(const ParallelNodeExecutor&) = delete;
+  ParallelNodeExecutor& operator=(const ParallelNodeExecutor&) = delete;
+
+  int num_threads() const { return static_cast<int>(threads_.size()) + 1; }
+
+  // Calls `fn(thread, task)` for each task in [0, num_tasks) and returns once
+  // all the calls have returned. `thread` is in [0, num_threads()) and
+  // identifies the thread making the call, 0 being the calling thread, so that
+  // `fn` can use per-thread state. Run() must not be called concurrently.
+  void Run(int num_tasks, const std::function<void(int, int)>& fn);
+
+ private:
+  void WorkerLoop(int thread);
+  void RunTasks(int thread);
+
+  std::vector<std::thread> threads_;
+  std::mutex mutex_;
+  std::condition_variable work_available_;
+  std::condition_variable work_done_;
+  // The batch being run, published to the workers under `mutex_`.
+  const std::function<void(int, int)>* fn_ = nullptr;
+  int num_tasks_ = 0;
+  std::atomic<int> next_task_{0};
+  // Incremented for each batch, so that workers wake up once per batch.
+  int batch_ = 0;
+  int busy_workers_ = 0;
+  bool stop_ = false;
+};
+
+}  // namespace tflite
+
+#endif  // TENSORFLOW_LITE_CORE_PARALLEL_NODE_EXECUTOR_H_
@@ -24,6 +24,7 @@ limitations under the License.
 #include <cstring>
 #include <iterator>
 #include <memory>
+#include <numeric>
 #include <string>
 #include <unordered_set>
 #include <utility>
@@ -40,6 +41,7 @@ limitations under the License.
 #include "tensorflow/lite/core/c/c_api_types.h"
 #include "tensorflow/lite/core/c/common.h"
 #include "tensorflow/lite/experimental/resource/resource_base.h"
+#include "tensorflow/lite/external_cpu_backend_context.h"
 #include "tensorflow/lite/graph_info.h"
 #include "tensorflow/lite/memory_planner.h"
 #include "tensorflow/lite/minimal_logging.h"
@@ -746,8 +748,7 @@ TfLiteStatus Subgraph::GetNodeInitDataMmapInfo(
     return kTfLiteError;
   }
 
-  const MMAPAllocation* mmap_alloc =
-      static_cast<const MMAPAllocation*>(allocation_);
+  const MMAPAllocation* mmap_alloc = GetMMAPAllocation();
   *fd = mmap_alloc->fd();
   if (node->custom_initial_data == nullptr) {
     *custom_initial_data_offset_in_file = -1;
@@ -972,6 +973,13 @@ TfLiteStatus Subgraph::AllocateTensors() {
   // Restore delegation state if applicable.
   TF_LITE_ENSURE_STATUS(RedoAllDelegates());
 
+  // Order the nodes in stages of independent nodes, as the memory plan depends
+  // on the order.
+  if (NumParallelNodeThreads() > 1 &&
+      execution_plan_ != parallel_execution_plan_) {
+    TF_LITE_ENSURE_STATUS(PlanParallelNodeStages());
+  }
+
   // The runtime doesn't need to adjust any allocations if the state is
   // invokable & no inputs are dynamic (which implies memory plan is unchanged).
   const bool no_reallocations_necessary =
@@ -1000,6 +1008,17 @@ TfLiteStatus Subgraph::AllocateTensors() {
   // Profile "AllocateTensors" only when memory planning is needed.
   TFLITE_SCOPED_TAGGED_DEFAULT_PROFILE(profiler_.get(), "AllocateTensors");
 
+  const bool only_inputs_resized = only_inputs_resized_;
+  only_inputs_resized_ = false;
+  if (only_inputs_resized && ShouldPrepareIncrementallyOnResize()) {
+    bool prepared = false;
+    TF_LITE_ENSURE_STATUS(PrepareOpsIncrementally(&prepared));
+    if (prepared) {
+      state_ = kStateInvokable;
+      return kTfLiteOk;
+    }
+  }
+
   next_execution_plan_index_to_prepare_ = 0;
   next_execution_plan_index_to_plan_allocation_ = 0;
   next_original_execution_plan_index_to_prepare_ = 0;
@@ -1079,6 +1098,7 @@ TfLiteStatus Subgraph::AddNodeWithParameters(
     return kTfLiteError;
   }
   state_ = kStateUninvokable;
+  only_inputs_resized_ = false;
 
   TF_LITE_ENSURE_OK(&context_, CheckTensorIndices("node inputs", inputs.data(),
                                                   inputs.size()));
@@ -1195,6 +1215,13 @@ TfLiteStatus Subgraph::ResizeInputTensor(int tensor_index,
     // Undo delegation if it resulted in the graph being immutable.
     TF_LITE_ENSURE_STATUS(UndoAllDelegates());
   }
+  if (state_ != kStateUninvokable) {
+    only_inputs_resized_ = true;
+    resized_input_tensors_.clear();
+  }
+  if (only_inputs_resized_) {
+    resized_input_tensors_.push_back(tensor_index);
+  }
   state_ = kStateUninvokable;
   return ResizeTensorImpl(tensor, ConvertVectorToTfLiteIntArray(dims));
 }
@@ -1231,6 +1258,7 @@ TfLiteStatus Subgraph::ResizeInputTensorStrict(int tensor_index,
 
 TfLiteStatus Subgraph::ReleaseNonPersistentMemory() {
   state_ = kStateUninvokable;
+  only_inputs_resized_ = false;
   if (memory_planner_) {
     TF_LITE_ENSURE_STATUS(memory_planner_->ReleaseNonPersistentMemory());
   }
@@ -1239,6 +1267,7 @@ TfLiteStatus Subgraph::ReleaseNonPersistentMemory() {
 
 TfLiteStatus Subgraph::ReleaseMemory() {
   state_ = kStateUninvokable;
+  only_inputs_resized_ = false;
   ReleaseNonPersistentMemory();
 
   // Free dynamic input tensors.
@@ -1366,7 +1395,7 @@ TfLiteStatus Subgraph::OpPrepare(const TfLiteRegistration& op_reg,
 
 // Invoke the operator represented by 'node'.
 TfLiteStatus Subgraph::OpInvoke(const TfLiteRegistration& op_reg,
-                                TfLiteNode* node) {
+                                TfLiteNode* node, TfLiteContext* context) {
   // Delegates that use the stable delegate API to iterate over the nodes and
   // registrations are presented with ABI stable 'TfLiteOperator'
   // pointers, as opposed to ABI unstable 'TfLiteRegistration' pointers, even
@@ -1385,16 +1414,16 @@ TfLiteStatus Subgraph::OpInvoke(const TfLiteRegistration& op_reg,
         &nodes_and_registration_[op_reg.registration_external->node_index]
              .second;
     if (referenced_registration->invoke == nullptr) return kTfLiteError;
-    return referenced_registration->invoke(&context_, node);
+    return referenced_registration->invoke(context, node);
   }
 
   if (op_reg.registration_external && op_reg.registration_external->invoke) {
     return op_reg.registration_external->invoke(
-        reinterpret_cast<TfLiteOpaqueContext*>(&context_),
+        reinterpret_cast<TfLiteOpaqueContext*>(context),
         reinterpret_cast<TfLiteOpaqueNode*>(node));
   }
   if (op_reg.invoke == nullptr) return kTfLiteError;
-  return op_reg.invoke(&context_, node);
+  return op_reg.invoke(context, node);
 }
 
 // Let 'op_reg' release any memory it might have allocated via 'OpInit'.
@@ -1525,6 +1554,9 @@ TfLiteStatus Subgraph::PrepareOpsAndTensors() {
         &context_, CreateGraphInfo(), ShouldPreserveAllTensors(),
         kDefaultTensorAlignment, subgraph_index_);
 #endif
+    if (!node_stages_.empty() && execution_plan_ == parallel_execution_plan_) {
+      memory_planner_->SetNodeStages(node_stages_);
+    }
     memory_planner_->PlanAllocations();
   }
 
@@ -1564,6 +1596,112 @@ TfLiteStatus Subgraph::PrepareOpsAndTensors() {
   return kTfLiteOk;
 }
 
+TfLiteStatus Subgraph::PrepareOpsIncrementally(bool* prepared) {
+  *prepared = false;
+  // The nodes using the resized inputs only tell the shapes of their own
+  // outputs once all nodes were prepared with static shapes. Delegates and
+  // custom allocations may depend on the shapes of any tensor.
+  if (!memory_planner_ || !memory_planner_->HasNonPersistentMemory() ||
+      !delegates_applied_.empty() || !custom_allocations_.empty() ||
+      has_dynamic_tensors_ ||
+      next_execution_plan_index_to_prepare_ != execution_plan_.size() ||
+      HasDynamicTensorImpl(context_, inputs(), &dynamic_tensor_index_)) {
+    return kTfLiteOk;
+  }
+
+  const size_t num_tensors = tensors_.size();
+  std::vector<bool> resized(num_tensors, false);
+  for (int tensor_index : resized_input_tensors_) {
+    resized[tensor_index] = true;
+  }
+  auto any_resized = [&resized](const TfLiteIntArray* tensor_indices) {
+    if (tensor_indices == nullptr) return false;
+    for (int i = 0; i < tensor_indices->size; ++i) {
+      const int tensor_index = tensor_indices->data[i];
+      if (tensor_index != kTfLiteOptionalTensor && resized[tensor_index]) {
+        return true;
+      }
+    }
+    return false;
+  };
+
+  // The resized inputs and the tensors the nodes prepared again may have
+  // resized, whose data pointers must be resolved again.
+  std::vector<int> tensors_to_update = resized_input_tensors_;
+  std::vector<std::vector<int>> output_dims;
+  std::vector<size_t> output_bytes;
+  for (int node_index : execution_plan_) {
+    TfLiteNode& node = nodes_and_registration_[node_index].first;
+    const TfLiteRegistration& registration =
+        nodes_and_registration_[node_index].second;
+    if (!any_resized(node.inputs) && !any_resized(node.intermediates)) {
+      continue;
+    }
+
+    output_dims.assign(node.outputs->size, {});
+    output_bytes.assign(node.outputs->size, 0);
+    for (int i = 0; i < node.outputs->size; ++i) {
+      const int tensor_index = node.outputs->data[i];
+      if (tensor_index == kTfLiteOptionalTensor) continue;
+      const TfLiteTensor& output = tensors_[tensor_index];
+      if (output.dims != nullptr) {
+        output_dims[i].assign(output.dims->data,
+                              output.dims->data + output.dims->size);
+      }
+      output_bytes[i] = output.bytes;
+    }
+
+    EnsureTensorsVectorCapacity();
+#ifdef TF_LITE_TENSORFLOW_PROFILER
+    tflite::OnTfLiteOpPrepare(GetTFLiteOpName(registration), subgraph_index_,
+                              node_index);
+#endif  // TF_LITE_TENSORFLOW_PROFILER
+    const TfLiteStatus op_prepare_status = OpPrepare(registration, &node);
+    if (op_prepare_status != kTfLiteOk) {
+      ReportOpError(&context_, node, registration, node_index,
+                    "failed to prepare");
+      return op_prepare_status;
+    }
+    // Nodes adding tensors or making their outputs dynamic need the memory of
+    // the whole graph to be planned again.
+    if (tensors_.size() != num_tensors ||
+        HasDynamicTensor(context_, node.outputs, &dynamic_tensor_index_)) {
+      return kTfLiteOk;
+    }
+
+    for (int i = 0; i < node.outputs->size; ++i) {
+      const int tensor_index = node.outputs->data[i];
+      if (tensor_index == kTfLiteOptionalTensor) continue;
+      const TfLiteTensor& output = tensors_[tensor_index];
+      if (output.bytes != output_bytes[i] ||
+          !EqualArrayAndTfLiteIntArray(
+              output.dims, static_cast<int>(output_dims[i].size()),
+              output_dims[i].data())) {
+        resized[tensor_index] = true;
+      }
+      tensors_to_update.push_back(tensor_index);
+    }
+    for (const TfLiteIntArray* tensor_indices :
+         {node.temporaries, node.intermediates}) {
+      if (tensor_indices == nullptr) continue;
+      for (int i = 0; i < tensor_indices->size; ++i) {
+        tensors_to_update.push_back(tensor_indices->data[i]);
+      }
+    }
+  }
+
+  bool updated = false;
+  TF_LITE_ENSURE_STATUS(
+      memory_planner_->UpdateAllocations(tensors_to_update, &updated));
+  if (!updated) {
+    TF_LITE_ENSURE_STATUS(memory_planner_->ResetAllocations());
+    TF_LITE_ENSURE_STATUS(memory_planner_->ExecuteAllocations(
+        0, static_cast<int>(execution_plan_.size()) - 1));
+  }
+  *prepared = true;
+  return kTfLiteOk;
+}
+
 TfLiteStatus Subgraph::RemoveUnusedInputs() {
   std::vector<int> input_tensors_count = GetInputTensorsCount();
   // Mark unused inputs as kTfLiteOptionalTensor.
@@ -1602,6 +1740,15 @@ TfLiteStatus Subgraph::InvokeImpl() {
       tflite::OnTfLiteSubgraphInvoke(name_.c_str(), subgraph_index_);
 #endif  // TF_LITE_TENSORFLOW_PROFILER
 
+  // Stages of independent nodes are invoked concurrently unless profiling,
+  // which is not thread-safe.
+  bool invoke_parallel_stages = parallel_node_executor_ != nullptr &&
+                                profiler_ == nullptr &&
+                                execution_plan_ == parallel_execution_plan_;
+#ifdef TF_LITE_TENSORFLOW_PROFILER
+  invoke_parallel_stages = false;
+#endif  // TF_LITE_TENSORFLOW_PROFILER
+
   // Invocations are always done in node order.
   // Note that calling Invoke repeatedly will cause the original memory plan to
   // be reused, unless either ResizeInputTensor() or AllocateTensors() has been
@@ -1613,6 +1760,15 @@ TfLiteStatus Subgraph::InvokeImpl() {
       TF_LITE_ENSURE(&context_, next_execution_plan_index_to_prepare_ >=
                                     execution_plan_index);
     }
+    if (invoke_parallel_stages) {
+      const int stage_end = ParallelNodeStageEnd(execution_plan_index);
+      if (stage_end > execution_plan_index) {
+        TF_LITE_ENSURE_STATUS(
+            InvokeNodesInParallel(execution_plan_index, stage_end));
+        execution_plan_index = stage_end - 1;
+        continue;
+      }
+    }
     int node_index = execution_plan_[execution_plan_index];
     TfLiteNode& node = nodes_and_registration_[node_index].first;
     const TfLiteRegistration& registration =
@@ -1723,6 +1879,227 @@ TfLiteStatus Subgraph::InvokeImpl() {
   return status;
 }
 
+struct Subgraph::NodeWorker {
+  TfLiteContext context;
+  // Kernels invoked on different threads must not share the CPU backend
+  // context, which holds their scratch buffers.
+  ExternalCpuBackendContext cpu_backend_context;
+};
+
+bool Subgraph::IsNodeParallelizable(
+    const TfLiteNode& node, const TfLiteRegistration& registration) const {
+  if (node.delegate != nullptr) return false;
+  switch (registration.builtin_code) {
+    case kTfLiteBuiltinCustom:
+    case kTfLiteBuiltinDelegate:
+    // Control flow ops invoke other subgraphs.
+    case kTfLiteBuiltinCall:
+    case kTfLiteBuiltinCallOnce:
+    case kTfLiteBuiltinIf:
+    case kTfLiteBuiltinWhile:
+    case kTfLiteBuiltinStablehloWhile:
+    // Ops on resources have side effects the next ops depend on.
+    case kTfLiteBuiltinHashtable:
+    case kTfLiteBuiltinHashtableFind:
+    case kTfLiteBuiltinHashtableImport:
+    case kTfLiteBuiltinHashtableSize:
+    case kTfLiteBuiltinVarHandle:
+    case kTfLiteBuiltinReadVariable:
+    case kTfLiteBuiltinAssignVariable:
+      return false;
+    default:
+      break;
+  }
+  // Variable tensors are updated in place.
+  for (const TfLiteIntArray* tensor_indices : {node.inputs, node.outputs}) {
+    for (int tensor_index : TfLiteIntArrayView(tensor_indices)) {
+      if (tensor_index == kTfLiteOptionalTensor) continue;
+      const TfLiteTensor& tensor = tensors_[tensor_index];
+      if (tensor.is_variable || tensor.type == kTfLiteResource ||
+          tensor.type == kTfLiteVariant) {
+        return false;
+      }
+    }
+  }
+  return true;
+}
+
+TfLiteStatus Subgraph::PlanParallelNodeStages() {
+  const int num_nodes = static_cast<int>(execution_plan_.size());
+  std::unordered_set<int> control_edge_nodes;
+  if (control_edges_ != nullptr) {
+    for (const ControlEdge& edge : *control_edges_) {
+      control_edge_nodes.insert(edge.first);
+      control_edge_nodes.insert(edge.second);
+    }
+  }
+  // A node is in the stage following the ones of the nodes producing its
+  // inputs. A node that is not parallelizable is alone in a stage following
+  // those of all the previous nodes, and precedes all the next nodes.
+  std::vector<int> tensor_stages(tensors_.size(), -1);
+  std::vector<int> stages(num_nodes);
+  int first_stage = 0;
+  int num_stages = 0;
+  bool has_parallel_stage = false;
+  for (int i = 0; i < num_nodes; ++i) {
+    const int node_index = execution_plan_[i];
+    const auto& [node, registration] = nodes_and_registration_[node_index];
+    int stage = first_stage;
+    if (!IsNodeParallelizable(node, registration) ||
+        control_edge_nodes.count(node_index)) {
+      stage = num_stages;
+      first_stage = stage + 1;
+    } else {
+      for (int tensor_index : TfLiteIntArrayView(node.inputs)) {
+        if (tensor_index == kTfLiteOptionalTensor) continue;
+        stage = std::max(stage, tensor_stages[tensor_index] + 1);
+      }
+    }
+    for (int tensor_index : TfLiteIntArrayView(node.outputs)) {
+      if (tensor_index == kTfLiteOptionalTensor) continue;
+      tensor_stages[tensor_index] = stage;
+    }
+    has_parallel_stage |= stage < num_stages;
+    stages[i] = stage;
+    num_stages = std::max(num_stages, stage + 1);
+  }
+
+  // Nodes in the same stage keep their original order.
+  std::vector<int> order(num_nodes);
+  std::iota(order.begin(), order.end(), 0);
+  std::stable_sort(order.begin(), order.end(),
+                   [&](int a, int b) { return stages[a] < stages[b]; });
+  parallel_execution_plan_.resize(num_nodes);
+  node_stages_.resize(num_nodes);
+  for (int i = 0; i < num_nodes; ++i) {
+    parallel_execution_plan_[i] = execution_plan_[order[i]];
+    node_stages_[i] = stages[order[i]];
+  }
+  execution_plan_ = parallel_execution_plan_;
+  // The nodes must be prepared, and their tensors planned, in the new order.
+  state_ = kStateUninvokable;
+  only_inputs_resized_ = false;
+  next_execution_plan_index_to_prepare_ = 0;
+  next_execution_plan_index_to_plan_allocation_ = 0;
+  if (memory_planner_) {
+    memory_planner_->SetNodeStages(node_stages_);
+    TF_LITE_ENSURE_STATUS(memory_planner_->PlanAllocations());
+  }
+
+  const int num_threads = NumParallelNodeThreads();
+  if (!has_parallel_stage) {
+    parallel_node_executor_.reset();
+    node_workers_.clear();
+  } else if (!parallel_node_executor_ ||
+             parallel_node_executor_->num_threads() != num_threads) {
+    parallel_node_executor_ =
+        std::make_unique<ParallelNodeExecutor>(num_threads);
+    node_workers_.clear();
+    for (int i = 0; i < num_threads; ++i) {
+      node_workers_.push_back(std::make_unique<NodeWorker>());
+    }
+  }
+  return kTfLiteOk;
+}
+
+int Subgraph::ParallelNodeStageEnd(int first_index) const {
+  if (node_stages_.size() != execution_plan_.size() ||
+      (first_index > 0 &&
+       node_stages_[first_index - 1] == node_stages_[first_index])) {
+    return first_index;
+  }
+  int end_index = first_index + 1;
+  while (end_index < static_cast<int>(execution_plan_.size()) &&
+         node_stages_[end_index] == node_stages_[first_index]) {
+    ++end_index;
+  }
+  // Nodes which are not prepared yet, or which may allocate or resize tensors
+  // when invoked, are invoked one at a time.
+  if (end_index - first_index < 2 ||
+      end_index > next_execution_plan_index_to_prepare_) {
+    return first_index;
+  }
+  for (int i = first_index; i < end_index; ++i) {
+    const TfLiteNode& node = nodes_and_registration_[execution_plan_[i]].first;
+    for (int tensor_index : TfLiteIntArrayView(node.inputs)) {
+      if (tensor_index == kTfLiteOptionalTensor) continue;
+      const TfLiteTensor& tensor = tensors_[tensor_index];
+      if ((tensor.delegate && tensor.data_is_stale) ||
+          (tensor.data.raw == nullptr && tensor.bytes > 0)) {
+        return first_index;
+      }
+    }
+    for (const TfLiteIntArray* tensor_indices :
+         {node.outputs, node.temporaries}) {
+      for (int tensor_index : TfLiteIntArrayView(tensor_indices)) {
+        if (tensor_index == kTfLiteOptionalTensor) continue;
+        if (tensors_[tensor_index].allocation_type == kTfLiteDynamic) {
+          return first_index;
+        }
+      }
+    }
+  }
+  return end_index;
+}
+
+TfLiteStatus Subgraph::InvokeNodesInParallel(int first_index, int end_index) {
+  if (check_cancelled_func_ != nullptr &&
+      check_cancelled_func_(cancellation_data_)) {
+    ReportError("Client requested cancel during Invoke()");
+    return kTfLiteError;
+  }
+
+  if (continue_invocation_ && !continue_invocation_->test_and_set()) {
+    // `Cancel` is called and cancellation flag is flipped.
+    ReportError("Client requested cancel during Invoke()");
+    return kTfLiteCancelled;
+  }
+
+  EnsureTensorsVectorCapacity();
+  tensor_resized_since_op_invoke_ = false;
+  for (const auto& worker : node_workers_) {
+    // The kernels are single-threaded, as the nodes already run concurrently.
+    worker->context = context_;
+    worker->context.recommended_num_threads = 1;
+    worker->context.GetExternalContext = GetNodeWorkerExternalContext;
+  }
+  std::vector<TfLiteStatus> statuses(end_index - first_index, kTfLiteOk);
+  parallel_node_executor_->Run(
+      end_index - first_index, [&](int thread, int task) {
+        auto& [node, registration] =
+            nodes_and_registration_[execution_plan_[first_index + task]];
+        statuses[task] =
+            OpInvoke(registration, &node, &node_workers_[thread]->context);
+      });
+
+  for (int i = first_index; i < end_index; ++i) {
+    const int node_index = execution_plan_[i];
+    const auto& [node, registration] = nodes_and_registration_[node_index];
+    if (auto s = statuses[i - first_index]; s != kTfLiteOk) {
+      auto err = ReportOpError(&context_, node, registration, node_index,
+                               "failed to invoke");
+      return s == kTfLiteCancelled ? s : err;
+    }
+  }
+  for (int i = first_index; i < end_index; ++i) {
+    const int node_index = execution_plan_[i];
+    MaybeReleaseDynamicTensors(nodes_and_registration_[node_index].first,
+                               node_index);
+  }
+  return kTfLiteOk;
+}
+
+TfLiteExternalContext* Subgraph::GetNodeWorkerExternalContext(
+    struct TfLiteContext* context, TfLiteExternalContextType type) {
+  auto* subgraph = static_cast<Subgraph*>(context->impl_);
+  if (type == kTfLiteCpuBackendContext) {
+    for (const auto& worker : subgraph->node_workers_) {
+      if (&worker->context == context) return &worker->cpu_backend_context;
+    }
+  }
+  return subgraph->GetExternalContext(type);
+}
+
 TfLiteStatus Subgraph::ResizeTensor(TfLiteContext* context,
                                     TfLiteTensor* tensor,
                                     TfLiteIntArray* new_size) {
@@ -1885,6 +2262,7 @@ TfLiteStatus Subgraph::SetTensorParametersReadOnly(
     tensor.allocation = allocation;
   } else {
     state_ = kStateUninvokable;
+    only_inputs_resized_ = false;
     TfLiteTensorReset(type, name, ConvertArrayToTfLiteIntArray(ndims, dims),
                       GetLegacyQuantization(quantization),
                       const_cast<char*>(buffer), bytes, kTfLiteMmapRo,
@@ -2155,6 +2533,7 @@ TfLiteStatus Subgraph::UndoAllDelegates() {
 
   // After undoing delegates, the graph is uninvokable, but mutable.
   state_ = kStateUninvokable;
+  only_inputs_resized_ = false;
 
   delegates_undone_ = true;
   return kTfLiteOk;
@@ -2207,6 +2586,7 @@ void Subgraph::EnsureTensorsVectorCapacity() {
 TfLiteStatus Subgraph::EnsureMemoryAllocations() {
   if (memory_planner_) {
     state_ = kStateUninvokable;
+    only_inputs_resized_ = false;
     TF_LITE_ENSURE_OK(&context_, memory_planner_->PlanAllocations());
   }
   TF_LITE_ENSURE_OK(&context_, AllocateTensors());
@@ -2259,6 +2639,7 @@ TfLiteStatus Subgraph::ModifyGraphWithDelegateImpl(TfLiteDelegate* delegate) {
     // tensors.
     // Reset the state to force tensor/op reallocation.
     state_ = kStateUninvokable;
+    only_inputs_resized_ = false;
   } else if (!delegate_supports_dynamic_shapes) {
     // Check if graph has dynamic tensors by preparing ops.
     int last_execution_plan_index_prepared;
@@ -2285,11 +2666,22 @@ TfLiteStatus Subgraph::ModifyGraphWithDelegateImpl(TfLiteDelegate* delegate) {
   // STEP 2: Delegate replaces applicable nodes with delegate kernels.
   // =================================================================
 
+  // Delegates mostly read the weights in order while copying or packing them,
+  // have the model file read ahead meanwhile.
+  const MMAPAllocation* mmap_allocation = GetMMAPAllocation();
+  if (mmap_allocation) {
+    mmap_allocation->Advise(mmap_allocation->base(), mmap_allocation->bytes(),
+                            MMAPAllocation::Advice::kSequential);
+  }
   // Setup additional context interface.
   SwitchToDelegateContext();
   TfLiteStatus status = TfLiteDelegatePrepareInternal(&context_, delegate);
   // Remove additional context info.
   SwitchToKernelContext();
+  if (mmap_allocation) {
+    mmap_allocation->Advise(mmap_allocation->base(), mmap_allocation->bytes(),
+                            MMAPAllocation::Advice::kNormal);
+  }
   TF_LITE_ENSURE_STATUS(reset_delegation_if_not_ok(status));
 
   // STEP 3: Leave graph in consistent state based on delegate & previous state.
@@ -2299,6 +2691,7 @@ TfLiteStatus Subgraph::ModifyGraphWithDelegateImpl(TfLiteDelegate* delegate) {
     // CASE 1: Current delegate does not support dynamic shapes.
     // Reset the state to force tensor/op reallocation.
     state_ = kStateUninvokable;
+    only_inputs_resized_ = false;
     TF_LITE_ENSURE_STATUS(
         reset_delegation_if_not_ok(EnsureMemoryAllocations()));
     // After using a delegate which doesn't support dynamic tensors, make the
@@ -2330,10 +2723,51 @@ TfLiteStatus Subgraph::ModifyGraphWithDelegateImpl(TfLiteDelegate* delegate) {
         reset_delegation_if_not_ok(EnsureMemoryAllocations()));
   }
   delegates_applied_.push_back(delegate);
+  if (ShouldReleaseDelegatedWeights()) {
+    ReleaseDelegatedWeights();
+  }
 
   return status;
 }
 
+const MMAPAllocation* Subgraph::GetMMAPAllocation() const {
+  if (!allocation_ || allocation_->type() != Allocation::Type::kMMap) {
+    return nullptr;
+  }
+  return static_cast<const MMAPAllocation*>(allocation_);
+}
+
+void Subgraph::ReleaseDelegatedWeights() {
+  const MMAPAllocation* mmap_allocation = GetMMAPAllocation();
+  if (!mmap_allocation) return;
+  // The data of the tensors still read by the nodes not delegated or by the
+  // caller.
+  std::unordered_set<const void*> data_in_use;
+  for (int node_index : execution_plan_) {
+    const TfLiteNode& node = nodes_and_registration_[node_index].first;
+    if (node.delegate != nullptr) continue;
+    for (int tensor_index : TfLiteIntArrayView(node.inputs)) {
+      if (tensor_index == kTfLiteOptionalTensor) continue;
+      data_in_use.insert(context_.tensors[tensor_index].data.raw_const);
+    }
+  }
+  for (int tensor_index : outputs_) {
+    data_in_use.insert(context_.tensors[tensor_index].data.raw_const);
+  }
+  for (size_t i = 0; i < context_.tensors_size; ++i) {
+    const TfLiteTensor& tensor = context_.tensors[i];
+    if (tensor.allocation_type != kTfLiteMmapRo ||
+        tensor.data.raw_const == nullptr ||
+        data_in_use.count(tensor.data.raw_const) != 0) {
+      continue;
+    }
+    // Ignored if the data isn't within the mapped file, e.g. if converted at
+    // load time.
+    mmap_allocation->Advise(tensor.data.raw_const, tensor.bytes,
+                            MMAPAllocation::Advice::kDontNeed);
+  }
+}
+
 TfLiteStatus Subgraph::SetCustomAllocationForTensor(
     int tensor_index, const TfLiteCustomAllocation& allocation, int64_t flags) {
   TfLiteTensor* tensor = &context_.tensors[tensor_index];
@@ -34,6 +34,7 @@ limitations under the License.
 #include "tensorflow/lite/core/api/profiler.h"
 #include "tensorflow/lite/core/c/common.h"
 #include "tensorflow/lite/core/macros.h"
+#include "tensorflow/lite/core/parallel_node_executor.h"
 #include "tensorflow/lite/experimental/resource/initialization_status.h"
 #include "tensorflow/lite/experimental/resource/resource_base.h"
 #include "tensorflow/lite/graph_info.h"
@@ -448,6 +449,27 @@ class Subgraph {
     return (options_ && options_->GetPreserveAllTensors());
   }
 
+  // WARNING: This is an experimental API and subject to change.
+  // Number of threads invoking the nodes that do not depend on each other
+  // concurrently, or a value <= 1 if nodes are invoked one at a time.
+  int NumParallelNodeThreads() const {
+    return options_ ? options_->GetNumParallelNodeThreads() : 1;
+  }
+
+  // WARNING: This is an experimental API and subject to change.
+  // True if AllocateTensors() after ResizeInputTensor() should only prepare
+  // again the nodes affected by the resized inputs.
+  bool ShouldPrepareIncrementallyOnResize() const {
+    return (options_ && options_->GetIncrementalPrepareOnResize());
+  }
+
+  // WARNING: This is an experimental API and subject to change.
+  // True if the pages of the constant tensors only read by delegates should be
+  // released from the resident memory after applying a delegate.
+  bool ShouldReleaseDelegatedWeights() const {
+    return (options_ && options_->GetReleaseDelegatedWeights());
+  }
+
   // WARNING: This is an experimental API and subject to change.
   // True if all intermediate dynamic tensors should be released once they are
   // not used by the model.
@@ -672,7 +694,40 @@ class Subgraph {
   TfLiteStatus OpPrepare(const TfLiteRegistration& op_reg, TfLiteNode* node);
 
   // Invoke the operator represented by 'node'.
-  TfLiteStatus OpInvoke(const TfLiteRegistration& op_reg, TfLiteNode* node);
+  TfLiteStatus OpInvoke(const TfLiteRegistration& op_reg, TfLiteNode* node) {
+    return OpInvoke(op_reg, node, &context_);
+  }
+
+  // Invoke the operator represented by 'node' with the given copy of
+  // `context_`.
+  TfLiteStatus OpInvoke(const TfLiteRegistration& op_reg, TfLiteNode* node,
+                        TfLiteContext* context);
+
+  // Returns true if 'node' may be invoked concurrently with the nodes that it
+  // does not depend on. Delegated, custom, control flow and stateful nodes are
+  // always invoked alone.
+  bool IsNodeParallelizable(const TfLiteNode& node,
+                            const TfLiteRegistration& registration) const;
+
+  // Orders the execution plan by dependency level when
+  // NumParallelNodeThreads() > 1, so that the nodes of a level, which do not
+  // depend on each other, form a stage that is invoked concurrently.
+  TfLiteStatus PlanParallelNodeStages();
+
+  // Returns the end of the stage starting at 'first_index' in the execution
+  // plan if its nodes are ready to be invoked concurrently, or 'first_index'
+  // otherwise.
+  int ParallelNodeStageEnd(int first_index) const;
+
+  // Invokes the nodes in [first_index, end_index) of the execution plan
+  // concurrently.
+  TfLiteStatus InvokeNodesInParallel(int first_index, int end_index);
+
+  // Returns the CPU backend context of the thread invoking a node with the
+  // 'context' of InvokeNodesInParallel(), and the shared external contexts
+  // otherwise, so that threads do not share CPU backends.
+  static TfLiteExternalContext* GetNodeWorkerExternalContext(
+      struct TfLiteContext* context, TfLiteExternalContextType type);
 
   // Call OpPrepare() for as many ops as possible, allocating memory for their
   // tensors. If an op containing dynamic tensors is found, preparation will be
@@ -680,6 +735,13 @@ class Subgraph {
   // to wait until Invoke() to resolve the sizes of dynamic tensors.
   TfLiteStatus PrepareOpsAndTensors();
 
+  // Calls OpPrepare() again, in execution plan order, only for the nodes with
+  // an input in `resized_input_tensors_` or among the resized outputs of a
+  // node prepared again, and updates the memory planned for the tensors they
+  // resized. Sets `prepared` to false if the whole graph must be prepared
+  // again instead, e.g. when a node output becomes dynamic.
+  TfLiteStatus PrepareOpsIncrementally(bool* prepared);
+
   // Call OpPrepare() for all ops starting at 'first_node'. Stop when a
   // dynamic tensors is found or all ops have been prepared. Fill
   // 'last_node_prepared' with the id of the op containing dynamic tensors, or
@@ -873,6 +935,13 @@ class Subgraph {
   // afterwards.
   TfLiteStatus RemoveAllDelegates();
 
+  // Returns `allocation_` if the model is mapped from a file, else nullptr.
+  const MMAPAllocation* GetMMAPAllocation() const;
+
+  // Releases from the resident memory the pages of the constant tensors mapped
+  // from the model file that no node left to the CPU reads.
+  void ReleaseDelegatedWeights();
+
   // Cleanups up data reserved for the given node. Does not remove the {node,
   // registration} pair from nodes_and_registrations_.
   void CleanupNode(int node_index);
@@ -1054,6 +1123,17 @@ class Subgraph {
 
   std::unique_ptr<MemoryPlanner> memory_planner_;
 
+  // The execution plan ordered by PlanParallelNodeStages(), and the stage of
+  // each of its nodes.
+  std::vector<int> parallel_execution_plan_;
+  std::vector<int> node_stages_;
+
+  // Threads invoking the stages of the execution plan, each with a copy of
+  // `context_` giving its kernels their own CPU backend context.
+  struct NodeWorker;
+  std::unique_ptr<ParallelNodeExecutor> parallel_node_executor_;
+  std::vector<std::unique_ptr<NodeWorker>> node_workers_;
+
   // Maps tensor index to custom allocation for all applicable tensors.
   std::map<int, TfLiteCustomAllocation> custom_allocations_;
 
@@ -1077,6 +1157,11 @@ class Subgraph {
   // The value is invalid before `PrepareOpStartingAt` is called.
   bool has_dynamic_tensors_ = true;
 
+  // True if the only changes since the graph was last fully prepared are the
+  // resizes of `resized_input_tensors_` by ResizeInputTensor().
+  bool only_inputs_resized_ = false;
+  std::vector<int> resized_input_tensors_;
+
   // WARNING: This is an experimental interface that is subject to change.
   // This is the index of dynamic tensor which was checked at
   // PrepareOpsStartingAt() when `has_dynamic_tensors_` is set. This information
@@ -20,6 +20,7 @@ limitations under the License.
 #include <functional>
 #include <memory>
 #include <numeric>
+#include <utility>
 #include <vector>
 
 #include <gmock/gmock.h>
@@ -27,6 +28,7 @@ limitations under the License.
 #include "absl/log/check.h"
 #include "tensorflow/lite/c/c_api_types.h"
 #include "tensorflow/lite/core/interpreter.h"
+#include "tensorflow/lite/interpreter_options.h"
 #include "tensorflow/lite/stderr_reporter.h"
 #include "tensorflow/lite/util.h"
 
@@ -124,6 +126,161 @@ TEST(MarkSubgraphAsDelegationSkippable, MarkSubgraphAsDelegationSkippable) {
   ASSERT_TRUE(subgraphs[1]->IsDelegationSkippable());
 }
 
+TEST(ParallelNodeStages, IndependentNodesAreInvokedInParallel) {
+  Interpreter interpreter;
+  InterpreterOptions options;
+  options.SetNumParallelNodeThreads(2);
+  ASSERT_EQ(interpreter.ApplyOptions(&options), kTfLiteOk);
+  auto& subgraph = interpreter.primary_subgraph();
+  subgraph.AddTensors(4);
+  for (int i = 0; i < 4; ++i) {
+    ASSERT_EQ(subgraph.SetTensorParametersReadWrite(i, kTfLiteFloat32, "", {2},
+                                                    TfLiteQuantization()),
+              kTfLiteOk);
+  }
+  subgraph.SetInputs({0});
+  subgraph.SetOutputs({2, 3});
+  TfLiteRegistration* neg_op = tflite::ops::builtin::Register_NEG();
+  subgraph.AddNodeWithParameters({0}, {1}, {}, nullptr, 0, nullptr, neg_op);
+  subgraph.AddNodeWithParameters({1}, {2}, {}, nullptr, 0, nullptr, neg_op);
+  subgraph.AddNodeWithParameters({0}, {3}, {}, nullptr, 0, nullptr, neg_op);
+
+  ASSERT_EQ(subgraph.AllocateTensors(), kTfLiteOk);
+  // The nodes negating the input are in the first stage.
+  EXPECT_THAT(subgraph.execution_plan(), ElementsAreArray({0, 2, 1}));
+  // The tensors of the nodes of a stage do not overlap.
+  EXPECT_NE(subgraph.tensor(1)->data.raw, subgraph.tensor(3)->data.raw);
+
+  for (int iteration = 0; iteration < 3; ++iteration) {
+    float* input = subgraph.tensor(0)->data.f;
+    input[0] = iteration;
+    input[1] = -2.5f;
+    ASSERT_EQ(subgraph.Invoke(), kTfLiteOk);
+    EXPECT_THAT(std::vector<float>(subgraph.tensor(2)->data.f,
+                                   subgraph.tensor(2)->data.f + 2),
+                ElementsAreArray({static_cast<float>(iteration), -2.5f}));
+    EXPECT_THAT(std::vector<float>(subgraph.tensor(3)->data.f,
+                                   subgraph.tensor(3)->data.f + 2),
+                ElementsAreArray({static_cast<float>(-iteration), 2.5f}));
+  }
+}
+
+// Registration of an op copying its input to its output, which counts the
+// calls to its Prepare() in the int given as its init data.
+TfLiteRegistration CountingCopyRegistration() {
+  TfLiteRegistration registration = {};
+  registration.init = [](TfLiteContext*, const char* buffer,
+                         size_t) -> void* {
+    return const_cast<char*>(buffer);
+  };
+  registration.prepare = [](TfLiteContext* context, TfLiteNode* node) {
+    ++*reinterpret_cast<int*>(node->user_data);
+    const TfLiteTensor* input = &context->tensors[node->inputs->data[0]];
+    TfLiteTensor* output = &context->tensors[node->outputs->data[0]];
+    return context->ResizeTensor(context, output,
+                                 TfLiteIntArrayCopy(input->dims));
+  };
+  registration.invoke = [](TfLiteContext* context, TfLiteNode* node) {
+    const TfLiteTensor* input = &context->tensors[node->inputs->data[0]];
+    TfLiteTensor* output = &context->tensors[node->outputs->data[0]];
+    std::copy(input->data.f, input->data.f + input->bytes / sizeof(float),
+              output->data.f);
+    return kTfLiteOk;
+  };
+  return registration;
+}
+
+// Builds a subgraph copying input 0 to tensor 2, then to output 3, and input 1
+// to output 4, all of shape {2}.
+void BuildTwoCopyChains(Subgraph* subgraph,
+                        const TfLiteRegistration* registration,
+                        int* num_prepares) {
+  subgraph->AddTensors(5);
+  for (int i = 0; i < 5; ++i) {
+    ASSERT_EQ(subgraph->SetTensorParametersReadWrite(
+                  i, kTfLiteFloat32, "", {2}, TfLiteQuantization()),
+              kTfLiteOk);
+  }
+  subgraph->SetInputs({0, 1});
+  subgraph->SetOutputs({3, 4});
+  const std::vector<std::pair<int, int>> copies = {{0, 2}, {2, 3}, {1, 4}};
+  for (size_t i = 0; i < copies.size(); ++i) {
+    ASSERT_EQ(subgraph->AddNodeWithParameters(
+                  {copies[i].first}, {copies[i].second}, {},
+                  reinterpret_cast<const char*>(&num_prepares[i]), 0, nullptr,
+                  registration),
+              kTfLiteOk);
+  }
+}
+
+TEST(IncrementalPrepareOnResize, OnlyNodesUsingResizedTensorsArePrepared) {
+  Interpreter interpreter;
+  InterpreterOptions options;
+  options.SetIncrementalPrepareOnResize();
+  ASSERT_EQ(interpreter.ApplyOptions(&options), kTfLiteOk);
+  auto& subgraph = interpreter.primary_subgraph();
+  int num_prepares[3] = {0, 0, 0};
+  const TfLiteRegistration registration = CountingCopyRegistration();
+  BuildTwoCopyChains(&subgraph, &registration, num_prepares);
+  ASSERT_EQ(subgraph.AllocateTensors(), kTfLiteOk);
+  EXPECT_THAT(num_prepares, ElementsAreArray({1, 1, 1}));
+
+  for (const int size : {4, 3, 8}) {
+    ASSERT_EQ(subgraph.ResizeInputTensor(0, {size}), kTfLiteOk);
+    ASSERT_EQ(subgraph.AllocateTensors(), kTfLiteOk);
+    ASSERT_EQ(subgraph.tensor(3)->bytes, size * sizeof(float));
+    std::vector<float> values(size);
+    std::iota(values.begin(), values.end(), 1.0f);
+    std::copy(values.begin(), values.end(), subgraph.tensor(0)->data.f);
+    subgraph.tensor(1)->data.f[0] = size;
+    subgraph.tensor(1)->data.f[1] = -size;
+    ASSERT_EQ(subgraph.Invoke(), kTfLiteOk);
+    EXPECT_THAT(std::vector<float>(subgraph.tensor(3)->data.f,
+                                   subgraph.tensor(3)->data.f + size),
+                ElementsAreArray(values));
+    EXPECT_THAT(std::vector<float>(subgraph.tensor(4)->data.f,
+                                   subgraph.tensor(4)->data.f + 2),
+                ElementsAreArray({static_cast<float>(size),
+                                  static_cast<float>(-size)}));
+  }
+  // The copy of input 1 was prepared only once.
+  EXPECT_THAT(num_prepares, ElementsAreArray({4, 4, 1}));
+}
+
+TEST(IncrementalPrepareOnResize, TensorsThatStillFitKeepTheirMemory) {
+  Interpreter interpreter;
+  InterpreterOptions options;
+  options.SetIncrementalPrepareOnResize();
+  ASSERT_EQ(interpreter.ApplyOptions(&options), kTfLiteOk);
+  auto& subgraph = interpreter.primary_subgraph();
+  int num_prepares[3] = {0, 0, 0};
+  const TfLiteRegistration registration = CountingCopyRegistration();
+  BuildTwoCopyChains(&subgraph, &registration, num_prepares);
+  ASSERT_EQ(subgraph.ResizeInputTensor(0, {8}), kTfLiteOk);
+  ASSERT_EQ(subgraph.AllocateTensors(), kTfLiteOk);
+  std::vector<void*> data;
+  for (int i = 0; i < 5; ++i) data.push_back(subgraph.tensor(i)->data.raw);
+
+  ASSERT_EQ(subgraph.ResizeInputTensor(0, {5}), kTfLiteOk);
+  ASSERT_EQ(subgraph.AllocateTensors(), kTfLiteOk);
+  for (int i = 0; i < 5; ++i) {
+    EXPECT_EQ(subgraph.tensor(i)->data.raw, data[i]);
+  }
+  EXPECT_EQ(subgraph.tensor(3)->bytes, 5 * sizeof(float));
+}
+
+TEST(IncrementalPrepareOnResize, AllNodesArePreparedWhenDisabled) {
+  Interpreter interpreter;
+  auto& subgraph = interpreter.primary_subgraph();
+  int num_prepares[3] = {0, 0, 0};
+  const TfLiteRegistration registration = CountingCopyRegistration();
+  BuildTwoCopyChains(&subgraph, &registration, num_prepares);
+  ASSERT_EQ(subgraph.AllocateTensors(), kTfLiteOk);
+  ASSERT_EQ(subgraph.ResizeInputTensor(0, {4}), kTfLiteOk);
+  ASSERT_EQ(subgraph.AllocateTensors(), kTfLiteOk);
+  EXPECT_THAT(num_prepares, ElementsAreArray({2, 2, 2}));
+}
+
 // Helper to get the minimal buffer size to allocate for a buffer of given
 // shape.
 size_t BytesFor(const TfLiteType type, const int* const data,
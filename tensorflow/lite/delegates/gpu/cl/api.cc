@@ -28,6 +28,7 @@ limitations under the License.
 #include <vector>
 
 #include "absl/memory/memory.h"
+#include "absl/synchronization/mutex.h"
 #include "absl/types/span.h"
 #include "tensorflow/lite/delegates/gpu/cl/cl_command_queue.h"
 #include "tensorflow/lite/delegates/gpu/cl/cl_errors.h"
@@ -713,13 +714,17 @@ CreateGpuModelInfo GetCreateInfo(const Environment& environment,
 
 class InferenceBuilderImpl : public InferenceBuilder {
  public:
-  explicit InferenceBuilderImpl(Environment* environment)
-      : environment_(environment) {}
+  // `shared_intermediate_buffer`, if not null, must outlive the builder.
+  InferenceBuilderImpl(Environment* environment,
+                       SharedIntermediateBuffer* shared_intermediate_buffer)
+      : environment_(environment),
+        shared_intermediate_buffer_(shared_intermediate_buffer) {}
 
   absl::Status Initialize(const InferenceOptions& options,
                           const InferenceEnvironmentOptions& env_options,
                           const GraphFloat32& graph) {
     context_ = std::make_unique<InferenceContext>();
+    context_->SetSharedIntermediateBuffer(shared_intermediate_buffer_);
     CreateGpuModelInfo create_info = GetCreateInfo(*environment_, options);
     RETURN_IF_ERROR(context_->InitFromGraph(create_info, graph, environment_));
 #ifdef TFLITE_GPU_ENABLE_INVOKE_LOOP
@@ -747,6 +752,7 @@ class InferenceBuilderImpl : public InferenceBuilder {
   absl::Status Initialize(const InferenceEnvironmentOptions& env_options,
                           const absl::Span<const uint8_t> serialized_model) {
     context_ = std::make_unique<InferenceContext>();
+    context_->SetSharedIntermediateBuffer(shared_intermediate_buffer_);
     RETURN_IF_ERROR(
         context_->RestoreDeserialized(serialized_model, environment_));
 
@@ -890,6 +896,7 @@ class InferenceBuilderImpl : public InferenceBuilder {
   int gpu_invoke_loop_times_;
 #endif
   Environment* environment_;
+  SharedIntermediateBuffer* shared_intermediate_buffer_;
 
   std::vector<TensorTieDef> inputs_;
   std::vector<TensorTieDef> outputs_;
@@ -902,6 +909,10 @@ class InferenceEnvironmentImpl : public InferenceEnvironment {
       : options_(options) {}
 
   absl::Status Init() {
+    if (options_.share_intermediate_memory) {
+      shared_intermediate_buffer_ =
+          std::make_unique<SharedIntermediateBuffer>();
+    }
     RETURN_IF_ERROR(LoadOpenCL());
     properties_.is_opencl_available = true;
 
@@ -1008,7 +1019,8 @@ class InferenceEnvironmentImpl : public InferenceEnvironment {
     }
 
     RETURN_IF_ERROR(RunGraphTransformsForGpuModel(&model));
-    auto builder_impl = std::make_unique<InferenceBuilderImpl>(&environment_);
+    auto builder_impl = std::make_unique<InferenceBuilderImpl>(
+        &environment_, shared_intermediate_buffer_.get());
     RETURN_IF_ERROR(
         builder_impl->Initialize(resolved_options, options_, model));
     *builder = std::move(builder_impl);
@@ -1027,7 +1039,8 @@ class InferenceEnvironmentImpl : public InferenceEnvironment {
           .IgnoreError();
     }
 
-    auto builder_impl = std::make_unique<InferenceBuilderImpl>(&environment_);
+    auto builder_impl = std::make_unique<InferenceBuilderImpl>(
+        &environment_, shared_intermediate_buffer_.get());
     RETURN_IF_ERROR(builder_impl->Initialize(options_, serialized_model));
     *builder = std::move(builder_impl);
     return absl::OkStatus();
@@ -1050,6 +1063,8 @@ class InferenceEnvironmentImpl : public InferenceEnvironment {
   const InferenceEnvironmentOptions options_;
   Environment environment_;
   InferenceEnvironmentProperties properties_;
+  // Null unless options_.share_intermediate_memory.
+  std::unique_ptr<SharedIntermediateBuffer> shared_intermediate_buffer_;
 };
 
 }  // namespace
@@ -1068,6 +1083,52 @@ absl::Status NewInferenceEnvironment(
   return absl::OkStatus();
 }
 
+absl::Status GetSharedInferenceEnvironment(
+    const InferenceEnvironmentOptions& options,
+    std::shared_ptr<InferenceEnvironment>* environment,
+    InferenceEnvironmentProperties* properties) {
+  struct SharedEnvironment {
+    std::weak_ptr<InferenceEnvironment> environment;
+    InferenceEnvironmentOptions options;
+    InferenceEnvironmentProperties properties;
+  };
+  static absl::Mutex* const mutex = new absl::Mutex();
+  // Indexed by options.share_intermediate_memory.
+  static SharedEnvironment* const shared_environments =
+      new SharedEnvironment[2];
+  absl::MutexLock lock(mutex);
+  SharedEnvironment& shared =
+      shared_environments[options.share_intermediate_memory ? 1 : 0];
+  std::shared_ptr<InferenceEnvironment> shared_environment =
+      shared.environment.lock();
+  if (shared_environment) {
+    const InferenceEnvironmentOptions& shared_options = shared.options;
+    if (options.device != shared_options.device ||
+        options.context != shared_options.context ||
+        options.command_queue != shared_options.command_queue ||
+        options.egl_display != shared_options.egl_display ||
+        options.egl_context != shared_options.egl_context) {
+      return absl::InvalidArgumentError(
+          "The shared OpenCL environment was created with another device, "
+          "context, command queue or EGL display and context.");
+    }
+  } else {
+    std::unique_ptr<InferenceEnvironment> new_environment;
+    RETURN_IF_ERROR(
+        NewInferenceEnvironment(options, &new_environment, &shared.properties));
+    shared_environment = std::move(new_environment);
+    shared.environment = shared_environment;
+    shared.options = options;
+    // The cache is not owned, and is not needed after the creation.
+    shared.options.serialized_binary_cache = {};
+  }
+  if (properties) {
+    *properties = shared.properties;
+  }
+  *environment = std::move(shared_environment);
+  return absl::OkStatus();
+}
+
 }  // namespace cl
 }  // namespace gpu
 }  // namespace tflite
@@ -129,6 +129,11 @@ struct InferenceEnvironmentOptions {
   // incompatible when GPU driver is updated.
   absl::Span<const uint8_t> serialized_binary_cache;
 
+  // If true, the intermediate tensors of all the models built by the
+  // environment share the same memory, as big as needed by the biggest model.
+  // The inference runners of such models must never run concurrently.
+  bool share_intermediate_memory = false;
+
   bool IsGlAware() const {
     return egl_context != EGL_NO_CONTEXT && egl_display != EGL_NO_DISPLAY;
   }
@@ -141,6 +146,21 @@ absl::Status NewInferenceEnvironment(
     std::unique_ptr<InferenceEnvironment>* environment,
     InferenceEnvironmentProperties* properties /* optional */);
 
+// Sets `environment` to the OpenCL environment shared by the callers with the
+// same `options.share_intermediate_memory`, creating it if none of them holds
+// it anymore. The environment is destroyed with its last holder.
+//
+// Returns InvalidArgument if that environment is alive and was created with
+// another device, context, command queue, or EGL display and context, than
+// `options`. `options.serialized_binary_cache` is only used on creation.
+//
+// The inference runners built by callers of a shared environment must not run
+// concurrently.
+absl::Status GetSharedInferenceEnvironment(
+    const InferenceEnvironmentOptions& options,
+    std::shared_ptr<InferenceEnvironment>* environment,
+    InferenceEnvironmentProperties* properties /* optional */);
+
 class CLInferenceRunner : public ::tflite::gpu::InferenceRunner {
  public:
   // The RunWithoutExternalBufferCopy provides a contract where the user of this
@@ -0,0 +1,99 @@
+/* Copyright 2023 The TensorFlow Authors. All Rights Reserved.
+
+Licensed under the Apache License, Version 2.0 (the "License");
+you may not use this file except in compliance with the License.
+You may obtain a copy of the License at
+
+    http://www.apache.org/licenses/LICENSE-2.0
+
+Unless required by applicable law or agreed to in writing, software
+distributed under the License is distributed on an "AS IS" BASIS,
+WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+See the License for the specific language governing permissions and
+limitations under the License.
+==============================================================================*/
+
+#include "tensorflow/lite/delegates/gpu/cl/api.h"
+
+#include <cstdint>
+#include <memory>
+
+#include <gtest/gtest.h>
+#include "absl/status/status.h"
+#include "tensorflow/lite/delegates/gpu/cl/cl_test.h"
+#include "tensorflow/lite/delegates/gpu/cl/environment.h"
+#include "tensorflow/lite/delegates/gpu/common/status.h"
+
+namespace tflite {
+namespace gpu {
+namespace cl {
+namespace {
+
+TEST_F(OpenCLTest, SharedInferenceEnvironmentIsReusedWhileAlive) {
+  InferenceEnvironmentOptions options;
+  std::shared_ptr<InferenceEnvironment> first;
+  InferenceEnvironmentProperties properties;
+  ASSERT_OK(GetSharedInferenceEnvironment(options, &first, &properties));
+  EXPECT_TRUE(properties.is_opencl_available);
+
+  std::shared_ptr<InferenceEnvironment> second;
+  ASSERT_OK(GetSharedInferenceEnvironment(options, &second, nullptr));
+  EXPECT_EQ(second, first);
+
+  // The environment is destroyed with its last holder.
+  std::weak_ptr<InferenceEnvironment> weak_first = first;
+  first.reset();
+  second.reset();
+  EXPECT_TRUE(weak_first.expired());
+
+  std::shared_ptr<InferenceEnvironment> third;
+  ASSERT_OK(GetSharedInferenceEnvironment(options, &third, nullptr));
+  EXPECT_NE(third, nullptr);
+}
+
+TEST_F(OpenCLTest, SharedInferenceEnvironmentPerIntermediateMemorySharing) {
+  InferenceEnvironmentOptions options;
+  std::shared_ptr<InferenceEnvironment> not_sharing_memory;
+  ASSERT_OK(
+      GetSharedInferenceEnvironment(options, &not_sharing_memory, nullptr));
+
+  options.share_intermediate_memory = true;
+  std::shared_ptr<InferenceEnvironment> sharing_memory;
+  ASSERT_OK(GetSharedInferenceEnvironment(options, &sharing_memory, nullptr));
+  EXPECT_NE(sharing_memory, not_sharing_memory);
+
+  std::shared_ptr<InferenceEnvironment> also_sharing_memory;
+  ASSERT_OK(
+      GetSharedInferenceEnvironment(options, &also_sharing_memory, nullptr));
+  EXPECT_EQ(also_sharing_memory, sharing_memory);
+}
+
+TEST_F(OpenCLTest, SharedInferenceEnvironmentRejectsOtherOptions) {
+  InferenceEnvironmentOptions options;
+  options.device = env_.device().id();
+  options.context = env_.context().context();
+  options.command_queue = env_.queue()->queue();
+  std::shared_ptr<InferenceEnvironment> environment;
+  ASSERT_OK(GetSharedInferenceEnvironment(options, &environment, nullptr));
+
+  // The environment is alive, so options that would create another one are
+  // rejected instead of silently ignored.
+  InferenceEnvironmentOptions other_options;
+  std::shared_ptr<InferenceEnvironment> other;
+  absl::Status status =
+      GetSharedInferenceEnvironment(other_options, &other, nullptr);
+  EXPECT_EQ(status.code(), absl::StatusCode::kInvalidArgument);
+  EXPECT_EQ(other, nullptr);
+
+  // The serialized binary cache does not matter once the environment exists.
+  const uint8_t cache[] = {1, 2, 3};
+  options.serialized_binary_cache = cache;
+  std::shared_ptr<InferenceEnvironment> same;
+  ASSERT_OK(GetSharedInferenceEnvironment(options, &same, nullptr));
+  EXPECT_EQ(same, environment);
+}
+
+}  // namespace
+}  // namespace cl
+}  // namespace gpu
+}  // namespace tflite
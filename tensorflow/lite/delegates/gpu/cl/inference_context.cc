@@ -539,6 +539,39 @@ absl::Status InferenceContext::AllocateVariableTensors(
   return absl::OkStatus();
 }
 
+absl::Status SharedIntermediateBuffer::Acquire(
+    size_t size, CLContext* context, std::shared_ptr<Buffer>* buffer) {
+  absl::MutexLock lock(&mutex_);
+  if (!buffer_ || buffer_->GetMemorySizeInBytes() < size) {
+    Buffer new_buffer;
+    RETURN_IF_ERROR(CreateReadWriteBuffer(size, context, &new_buffer));
+    buffer_ = std::make_shared<Buffer>(std::move(new_buffer));
+  }
+  *buffer = buffer_;
+  return absl::OkStatus();
+}
+
+absl::Status InferenceContext::AllocateSharedBuffersParent(size_t size,
+                                                           CLContext* context) {
+  if (shared_buffers_parent_ptr_) {
+    if (shared_buffers_parent_ptr_->GetMemorySizeInBytes() < size) {
+      return absl::FailedPreconditionError(
+          "Externally provided buffer not big enough.");
+    }
+    return absl::OkStatus();
+  }
+  if (shared_intermediate_buffer_) {
+    RETURN_IF_ERROR(shared_intermediate_buffer_->Acquire(
+        size, context, &shared_buffers_parent_));
+  } else {
+    Buffer shared_buffer;
+    RETURN_IF_ERROR(CreateReadWriteBuffer(size, context, &shared_buffer));
+    shared_buffers_parent_ = std::make_shared<Buffer>(std::move(shared_buffer));
+  }
+  shared_buffers_parent_ptr_ = shared_buffers_parent_.get();
+  return absl::OkStatus();
+}
+
 absl::Status InferenceContext::AllocateBufferBasedTensors(
     const GpuModel& gpu_model, const GpuInfo& gpu_info,
     const CreateGpuModelInfo* create_info, CLContext* context) {
@@ -559,18 +592,8 @@ absl::Status InferenceContext::AllocateBufferBasedTensors(
   }
 
   if (use_offset_assignment) {
-    if (!shared_buffers_parent_ptr_) {
-      Buffer shared_buffer;
-      RETURN_IF_ERROR(CreateReadWriteBuffer(offset_assignment.total_size,
-                                            context, &shared_buffer));
-      shared_buffers_parent_ =
-          std::make_unique<Buffer>(std::move(shared_buffer));
-      shared_buffers_parent_ptr_ = shared_buffers_parent_.get();
-    } else if (shared_buffers_parent_ptr_->GetMemorySizeInBytes() <
-               offset_assignment.total_size) {
-      return absl::FailedPreconditionError(
-          "Externally provided buffer not big enough.");
-    }
+    RETURN_IF_ERROR(
+        AllocateSharedBuffersParent(offset_assignment.total_size, context));
     shared_buffers_.resize(offset_assignment.offsets.size());
     for (int i = 0; i < offset_assignment.offsets.size(); ++i) {
       RETURN_IF_ERROR(CreateReadWriteSubBuffer(
@@ -581,18 +604,7 @@ absl::Status InferenceContext::AllocateBufferBasedTensors(
     const size_t total_size = TotalSize(buffer_assignment, base_align_bytes);
     if (is_sub_buffers_supported && total_size <= gpu_info.GetMaxBufferSize()) {
       // use single parent buffer:
-      if (!shared_buffers_parent_ptr_) {
-        Buffer shared_buffer;
-        RETURN_IF_ERROR(
-            CreateReadWriteBuffer(total_size, context, &shared_buffer));
-        shared_buffers_parent_ =
-            std::make_unique<Buffer>(std::move(shared_buffer));
-        shared_buffers_parent_ptr_ = shared_buffers_parent_.get();
-      } else if (shared_buffers_parent_ptr_->GetMemorySizeInBytes() <
-                 total_size) {
-        return absl::FailedPreconditionError(
-            "Externally provided buffer not big enough.");
-      }
+      RETURN_IF_ERROR(AllocateSharedBuffersParent(total_size, context));
 
       shared_buffers_.resize(buffer_assignment.object_sizes.size());
       size_t offset = 0;
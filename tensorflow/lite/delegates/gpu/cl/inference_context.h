@@ -23,7 +23,9 @@ limitations under the License.
 #include <string>
 #include <vector>
 
+#include "absl/base/thread_annotations.h"
 #include "absl/container/flat_hash_map.h"
+#include "absl/synchronization/mutex.h"
 #include "tensorflow/lite/delegates/gpu/cl/buffer.h"
 #include "tensorflow/lite/delegates/gpu/cl/cl_command_queue.h"
 #include "tensorflow/lite/delegates/gpu/cl/cl_operation.h"
@@ -63,8 +65,34 @@ struct CLNode {
 
 enum class TensorType { kVariable, kConst, kExternal, kRuntime };
 
+// Parent buffer of the intermediate tensors shared by the InferenceContexts of
+// several models. The models must be run one after the other, never
+// concurrently, and on the same command queue so that the GPU runs them in
+// order too.
+//
+// The buffer is as big as the biggest request so far: a request bigger than
+// the current buffer replaces it with a new one, while the contexts created
+// before keep using the old one. Initialize the biggest model first to
+// allocate a single buffer.
+class SharedIntermediateBuffer {
+ public:
+  // Sets `buffer` to a buffer of `size` bytes at least.
+  absl::Status Acquire(size_t size, CLContext* context,
+                       std::shared_ptr<Buffer>* buffer);
+
+ private:
+  absl::Mutex mutex_;
+  std::shared_ptr<Buffer> buffer_ ABSL_GUARDED_BY(mutex_);
+};
+
 class InferenceContext {
  public:
+  // Makes the intermediate tensors of the next initialization sub-buffers of
+  // `shared_buffer`, which must outlive the initialization.
+  void SetSharedIntermediateBuffer(SharedIntermediateBuffer* shared_buffer) {
+    shared_intermediate_buffer_ = shared_buffer;
+  }
+
   absl::Status InitFromGraph(const CreateGpuModelInfo& create_info,
                              const GraphFloat32& graph, Environment* env,
                              std::vector<uint8_t>* serialized_model = nullptr);
@@ -129,6 +157,10 @@ class InferenceContext {
   absl::Status AllocateVariableTensors(const GpuModel& gpu_model,
                                        CLContext* context);
 
+  // Sets the parent buffer of the intermediate tensors, of `size` bytes at
+  // least, unless an external one was given.
+  absl::Status AllocateSharedBuffersParent(size_t size, CLContext* context);
+
   absl::Status AllocateBufferBasedTensors(const GpuModel& gpu_model,
                                           const GpuInfo& gpu_info,
                                           const CreateGpuModelInfo* create_info,
@@ -188,7 +220,8 @@ class InferenceContext {
   std::map<ValueId, ValueId> variable_ids_and_refs_;
   std::map<ValueId, Tensor> variable_tensors_;
 
-  std::unique_ptr<Buffer> shared_buffers_parent_;
+  SharedIntermediateBuffer* shared_intermediate_buffer_ = nullptr;
+  std::shared_ptr<Buffer> shared_buffers_parent_;
   Buffer* shared_buffers_parent_ptr_ = nullptr;
   std::vector<Buffer> shared_buffers_;
   std::vector<Tensor>
@@ -0,0 +1,64 @@
+/* Copyright 2023 The TensorFlow Authors. All Rights Reserved.
+
+Licensed under the Apache License, Version 2.0 (the "License");
+you may not use this file except in compliance with the License.
+You may obtain a copy of the License at
+
+    http://www.apache.org/licenses/LICENSE-2.0
+
+Unless required by applicable law or agreed to in writing, software
+distributed under the License is distributed on an "AS IS" BASIS,
+WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+See the License for the specific language governing permissions and
+limitations under the License.
+==============================================================================*/
+
+#include "tensorflow/lite/delegates/gpu/cl/inference_context.h"
+
+#include <memory>
+
+#include <gtest/gtest.h>
+#include "tensorflow/lite/delegates/gpu/cl/buffer.h"
+#include "tensorflow/lite/delegates/gpu/cl/cl_test.h"
+
+namespace tflite {
+namespace gpu {
+namespace cl {
+namespace {
+
+TEST_F(OpenCLTest, SharedIntermediateBufferIsReusedWhenBigEnough) {
+  SharedIntermediateBuffer shared_buffer;
+  std::shared_ptr<Buffer> first;
+  ASSERT_OK(shared_buffer.Acquire(1024, &env_.context(), &first));
+  EXPECT_GE(first->GetMemorySizeInBytes(), 1024);
+
+  std::shared_ptr<Buffer> smaller;
+  ASSERT_OK(shared_buffer.Acquire(256, &env_.context(), &smaller));
+  EXPECT_EQ(smaller, first);
+
+  std::shared_ptr<Buffer> same_size;
+  ASSERT_OK(shared_buffer.Acquire(1024, &env_.context(), &same_size));
+  EXPECT_EQ(same_size, first);
+}
+
+TEST_F(OpenCLTest, SharedIntermediateBufferGrows) {
+  SharedIntermediateBuffer shared_buffer;
+  std::shared_ptr<Buffer> small;
+  ASSERT_OK(shared_buffer.Acquire(256, &env_.context(), &small));
+
+  std::shared_ptr<Buffer> big;
+  ASSERT_OK(shared_buffer.Acquire(4096, &env_.context(), &big));
+  EXPECT_NE(big, small);
+  EXPECT_GE(big->GetMemorySizeInBytes(), 4096);
+  // The holders of the old buffer keep it.
+  EXPECT_GE(small->GetMemorySizeInBytes(), 256);
+
+  std::shared_ptr<Buffer> next;
+  ASSERT_OK(shared_buffer.Acquire(256, &env_.context(), &next));
+  EXPECT_EQ(next, big);
+}
+
+}  // namespace
+}  // namespace cl
+}  // namespace gpu
+}  // namespace tflite
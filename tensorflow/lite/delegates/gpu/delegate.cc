@@ -38,6 +38,7 @@ limitations under the License.
 #include "absl/container/flat_hash_map.h"
 #include "absl/container/flat_hash_set.h"
 #include "absl/strings/numbers.h"
+#include "absl/synchronization/mutex.h"
 #include "absl/types/span.h"
 #include "tensorflow/lite/builtin_ops.h"
 
@@ -336,6 +337,12 @@ class DelegateKernelCore {
   absl::Status InitializeOpenGlApi(GraphFloat32* graph,
                                    std::unique_ptr<InferenceBuilder>* builder);
 
+  // Sets cl_environment_ to a new environment, or to the shared one if the
+  // delegate options ask for it.
+  absl::Status InitializeClEnvironment(
+      const cl::InferenceEnvironmentOptions& env_options,
+      cl::InferenceEnvironmentProperties* properties);
+
   absl::Status MaybeInitializeSerializedOpenCL(
       TfLiteContext* context, const TfLiteDelegateParams* delegate_params,
       std::unique_ptr<InferenceBuilder>* builder, cl::InferenceOptions* options,
@@ -351,7 +358,9 @@ class DelegateKernelCore {
   // The Delegate instance that's shared across all DelegateKernel instances.
   Delegate* const delegate_;  // doesn't own the memory.
 
-  std::unique_ptr<cl::InferenceEnvironment> cl_environment_;
+  // Shared with other kernels with
+  // TFLITE_GPU_EXPERIMENTAL_FLAGS_SHARE_ENVIRONMENT.
+  std::shared_ptr<cl::InferenceEnvironment> cl_environment_;
 #ifndef CL_DELEGATE_NO_GL
   std::unique_ptr<gl::InferenceEnvironment> gl_environment_;
 #endif
@@ -522,11 +531,14 @@ absl::Status DelegateKernelCore::InitializeOpenClApi(
     const TfLiteDelegateParams* delegate_params,
     Serialization* serialization = nullptr) {
   *graph_is_destroyed = false;
+  auto delegate_options = delegate_->options();
   cl::InferenceEnvironmentOptions env_options;
+  env_options.share_intermediate_memory =
+      delegate_options.experimental_flags &
+      TFLITE_GPU_EXPERIMENTAL_FLAGS_SHARE_INTERMEDIATE_MEMORY;
   cl::InferenceEnvironmentProperties properties;
 
   // OpenCL initialization is parameterized by these InferenceOptions.
-  auto delegate_options = delegate_->options();
   cl::InferenceOptions options;
   // If is_precision_loss_allowed == -1, then just use priorities instead
   // of paying attention to is_precision_loss_allowed value.
@@ -550,8 +562,7 @@ absl::Status DelegateKernelCore::InitializeOpenClApi(
 
   if (!serialization) {
     // This path is faster when there is no serialization involved.
-    RETURN_IF_ERROR(cl::NewInferenceEnvironment(env_options, &cl_environment_,
-                                                &properties));
+    RETURN_IF_ERROR(InitializeClEnvironment(env_options, &properties));
     *graph_is_destroyed = true;
     RETURN_IF_ERROR(cl_environment_->NewInferenceBuilder(
         options, std::move(*graph), builder));
@@ -564,8 +575,7 @@ absl::Status DelegateKernelCore::InitializeOpenClApi(
       return absl::OkStatus();
     }
 
-    RETURN_IF_ERROR(cl::NewInferenceEnvironment(env_options, &cl_environment_,
-                                                &properties));
+    RETURN_IF_ERROR(InitializeClEnvironment(env_options, &properties));
     *graph_is_destroyed = true;
     std::vector<uint8_t> serialized_model;
     RETURN_IF_ERROR(cl_environment_->BuildSerializedModel(
@@ -582,6 +592,23 @@ absl::Status DelegateKernelCore::InitializeOpenClApi(
   return absl::OkStatus();
 }
 
+absl::Status DelegateKernelCore::InitializeClEnvironment(
+    const cl::InferenceEnvironmentOptions& env_options,
+    cl::InferenceEnvironmentProperties* properties) {
+  const int experimental_flags = delegate_->options().experimental_flags;
+  if (experimental_flags &
+      (TFLITE_GPU_EXPERIMENTAL_FLAGS_SHARE_ENVIRONMENT |
+       TFLITE_GPU_EXPERIMENTAL_FLAGS_SHARE_INTERMEDIATE_MEMORY)) {
+    return cl::GetSharedInferenceEnvironment(env_options, &cl_environment_,
+                                             properties);
+  }
+  std::unique_ptr<cl::InferenceEnvironment> environment;
+  RETURN_IF_ERROR(
+      cl::NewInferenceEnvironment(env_options, &environment, properties));
+  cl_environment_ = std::move(environment);
+  return absl::OkStatus();
+}
+
 // Returns Ok only if serialized data is successfully found.
 absl::Status DelegateKernelCore::InitializeOpenGlApi(
     GraphFloat32* graph, std::unique_ptr<InferenceBuilder>* builder) {
@@ -640,8 +667,7 @@ absl::Status DelegateKernelCore::MaybeInitializeSerializedOpenCL(
   if (model_data_status == kTfLiteOk) {
     absl::Span<const uint8_t> model_span = absl::Span<const uint8_t>{
         reinterpret_cast<const uint8_t*>(model_data.data()), model_data.size()};
-    RETURN_IF_ERROR(cl::NewInferenceEnvironment(*env_options, &cl_environment_,
-                                                properties));
+    RETURN_IF_ERROR(InitializeClEnvironment(*env_options, properties));
     RETURN_IF_ERROR(cl_environment_->NewInferenceBuilder(model_span, builder));
     TFLITE_LOG_PROD_ONCE(tflite::TFLITE_LOG_INFO,
                          "Initialized OpenCL-based API from serialized data.");
@@ -71,6 +71,23 @@ enum TfLiteGpuExperimentalFlags {
   // TfLiteGpuDelegateOptionsV2.
   // Currently works only if CL backend is used.
   TFLITE_GPU_EXPERIMENTAL_FLAGS_ENABLE_SERIALIZATION = 1 << 3,
+  // Shares one OpenCL environment (context, command queue and compiled program
+  // cache) between all the delegate instances with this flag in the process,
+  // instead of creating one per delegated partition. Saves the memory and
+  // initialization time of the contexts when running several models.
+  //
+  // NOTE: The interpreters of delegates sharing the environment must not be
+  // modified or invoked concurrently. Currently works only if CL backend is
+  // used.
+  TFLITE_GPU_EXPERIMENTAL_FLAGS_SHARE_ENVIRONMENT = 1 << 4,
+  // Implies TFLITE_GPU_EXPERIMENTAL_FLAGS_SHARE_ENVIRONMENT, and makes the
+  // intermediate tensors of all the models delegated with this flag share the
+  // same GPU memory, as big as needed by the biggest model. Apply the delegate
+  // of the biggest model first to allocate that memory once.
+  //
+  // NOTE: The interpreters of these models must be invoked one after the other,
+  // never concurrently, e.g. the stages of a camera pipeline.
+  TFLITE_GPU_EXPERIMENTAL_FLAGS_SHARE_INTERMEDIATE_MEMORY = 1 << 5,
 };
 
 // IMPORTANT: Always use TfLiteGpuDelegateOptionsV2Default() method to create
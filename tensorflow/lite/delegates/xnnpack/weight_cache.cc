@@ -0,0 +1,452 @@
+/* Copyright 2024 The TensorFlow Authors. All Rights Reserved.
+
+Licensed under the Apache License, Version 2.0 (the "License");
+you may not use this file except in compliance with the License.
+You may obtain a copy of the License at
+
+    http://www.apache.org/licenses/LICENSE-2.0
+
+Unless required by applicable law or agreed to in writing, software
+distributed under the License is distributed on an "AS IS" BASIS,
+WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+See the License for the specific language governing permissions and
+limitations under the License.
+==============================================================================*/
+#include "tensorflow/lite/delegates/xnnpack/weight_cache.h"
+
+#include <algorithm>
+#include <cstddef>
+#include <cstdint>
+#include <cstdio>
+#include <cstring>
+#include <limits>
+#include <mutex>  // NOLINT(build/c++11)
+#include <string>
+#include <utility>
+#include <vector>
+
+#if !defined(_WIN32)
+#include <fcntl.h>
+#include <sys/mman.h>
+#include <sys/stat.h>
+#include <unistd.h>
+#endif
+
+#ifdef TFLITE_HAVE_CPUINFO
+#include "include/cpuinfo.h"
+#endif
+
+#include "xnnpack.h"  // from @XNNPACK
+#include "tensorflow/lite/minimal_logging.h"
+
+namespace tflite {
+namespace xnnpack {
+namespace {
+
+// XNNPACK expects this offset for weights that are not in the cache.
+constexpr size_t kNotFound = std::numeric_limits<size_t>::max();
+
+constexpr uint64_t kFnvOffsetBasis = 0xcbf29ce484222325;
+constexpr uint64_t kFnvPrime = 0x100000001b3;
+
+uint64_t Mix(uint64_t value) {
+  value ^= value >> 33;
+  value *= 0xff51afd7ed558ccd;
+  value ^= value >> 33;
+  value *= 0xc4ceb9fe1a85ec53;
+  value ^= value >> 33;
+  return value;
+}
+
+uint64_t HashCombine(uint64_t hash, uint64_t value) {
+  return (hash ^ Mix(value)) * kFnvPrime;
+}
+
+size_t AlignUp(size_t size) {
+  return (size + kWeightCacheAlignment - 1) & ~(kWeightCacheAlignment - 1);
+}
+
+bool WriteBytes(FILE* file, const void* data, size_t size) {
+  return size == 0 || std::fwrite(data, 1, size, file) == size;
+}
+
+}  // namespace
+
+uint64_t WeightCacheBufferId(const void* data, size_t size) {
+  const uint8_t* bytes = static_cast<const uint8_t*>(data);
+  uint64_t hash = HashCombine(kFnvOffsetBasis, size);
+  size_t i = 0;
+  for (; i + sizeof(uint64_t) <= size; i += sizeof(uint64_t)) {
+    uint64_t word;
+    std::memcpy(&word, bytes + i, sizeof(word));
+    hash = HashCombine(hash, word);
+  }
+  uint64_t tail = 0;
+  std::memcpy(&tail, bytes + i, size - i);
+  hash = Mix(HashCombine(hash, tail));
+  return hash == 0 ? 1 : hash;
+}
+
+uint64_t GetXNNPackFingerprint() {
+  uint64_t hash = kFnvOffsetBasis;
+  for (const char* c = kXNNPackRevision; *c != '\0'; ++c) {
+    hash = HashCombine(hash, static_cast<uint8_t>(*c));
+  }
+  hash = HashCombine(hash, sizeof(void*));
+  hash = HashCombine(hash, XNN_EXTRA_BYTES);
+#ifdef TFLITE_HAVE_CPUINFO
+  // XNNPACK packs the weights for the micro-kernels selected for the CPU.
+  if (cpuinfo_initialize()) {
+    const bool features[] = {
+        cpuinfo_has_x86_sse4_1(),     cpuinfo_has_x86_avx(),
+        cpuinfo_has_x86_avx2(),       cpuinfo_has_x86_fma3(),
+        cpuinfo_has_x86_f16c(),       cpuinfo_has_x86_avx512f(),
+        cpuinfo_has_x86_avx512bw(),   cpuinfo_has_x86_avx512dq(),
+        cpuinfo_has_x86_avx512vl(),   cpuinfo_has_x86_avx512vnni(),
+        cpuinfo_has_x86_avx512bf16(), cpuinfo_has_x86_avxvnni(),
+        cpuinfo_has_arm_neon(),       cpuinfo_has_arm_neon_fp16_arith(),
+        cpuinfo_has_arm_neon_dot(),   cpuinfo_has_arm_i8mm(),
+        cpuinfo_has_arm_sve(),        cpuinfo_has_arm_sve2(),
+    };
+    uint64_t feature_bits = 0;
+    for (size_t i = 0; i < sizeof(features) / sizeof(features[0]); ++i) {
+      feature_bits |= static_cast<uint64_t>(features[i]) << i;
+    }
+    hash = HashCombine(hash, feature_bits);
+  }
+#endif
+  return Mix(hash);
+}
+
+size_t FileWeightCacheProvider::KeyHash::operator()(const Key& key) const {
+  return HashCombine(HashCombine(Mix(key.seed), key.kernel), key.bias);
+}
+
+FileWeightCacheProvider::FileWeightCacheProvider() {
+  cache_provider_.context = this;
+  cache_provider_.look_up = LookUp;
+  cache_provider_.reserve_space = ReserveSpace;
+  cache_provider_.look_up_or_insert = LookUpOrInsert;
+  cache_provider_.is_finalized = IsFinalized;
+  cache_provider_.offset_to_addr = OffsetToAddr;
+  cache_provider_.delete_cache = Delete;
+}
+
+FileWeightCacheProvider::~FileWeightCacheProvider() { Unmap(); }
+
+bool FileWeightCacheProvider::Initialize(const std::string& path,
+                                         uint64_t model_fingerprint) {
+  std::lock_guard<std::mutex> lock(mutex_);
+  if (initialized_) {
+    return false;
+  }
+  initialized_ = true;
+  path_ = path;
+  model_fingerprint_ = model_fingerprint;
+  loaded_ = Load();
+  next_offset_ = mapped_data_size_;
+  return true;
+}
+
+uint64_t FileWeightCacheProvider::MapBuffer(const void* data, size_t size) {
+  const uint64_t id = WeightCacheBufferId(data, size);
+  std::lock_guard<std::mutex> lock(mutex_);
+  buffer_ids_.emplace(data, id);
+  return id;
+}
+
+void FileWeightCacheProvider::ClearBufferMap() {
+  std::lock_guard<std::mutex> lock(mutex_);
+  buffer_ids_.clear();
+}
+
+bool FileWeightCacheProvider::Finalize() {
+  std::lock_guard<std::mutex> lock(mutex_);
+  if (finalized_) {
+    return true;
+  }
+  finalized_ = true;
+  if (loaded_) {
+    return true;
+  }
+  if (!Write()) {
+    TFLITE_LOG_PROD(tflite::TFLITE_LOG_WARNING,
+                    "Failed to write XNNPACK weight cache file %s.",
+                    path_.c_str());
+    return false;
+  }
+  if (!Load()) {
+    TFLITE_LOG_PROD(tflite::TFLITE_LOG_WARNING,
+                    "Failed to map XNNPACK weight cache file %s.",
+                    path_.c_str());
+    return false;
+  }
+  // The packed weights written to the file are now read from it.
+  for (auto it = buffers_.begin(); it != buffers_.end();) {
+    if (it->first < mapped_data_size_) {
+      it = buffers_.erase(it);
+    } else {
+      ++it;
+    }
+  }
+  entries_.clear();
+  return true;
+}
+
+bool FileWeightCacheProvider::GetFileKey(
+    const xnn_weights_cache_look_up_key& cache_key, Key* key) const {
+  key->seed = cache_key.seed;
+  for (auto [data, id] : {std::make_pair(cache_key.kernel, &key->kernel),
+                          std::make_pair(cache_key.bias, &key->bias)}) {
+    if (data == nullptr) {
+      *id = 0;
+      continue;
+    }
+    auto it = buffer_ids_.find(data);
+    if (it == buffer_ids_.end()) {
+      return false;
+    }
+    *id = it->second;
+  }
+  return true;
+}
+
+size_t FileWeightCacheProvider::LookUpLocked(
+    const xnn_weights_cache_look_up_key& cache_key) const {
+  Key key;
+  if (GetFileKey(cache_key, &key)) {
+    auto it = file_locations_.find(key);
+    if (it != file_locations_.end()) {
+      return it->second.offset;
+    }
+  }
+  auto it = process_offsets_.find(
+      Key{cache_key.seed, reinterpret_cast<uintptr_t>(cache_key.kernel),
+          reinterpret_cast<uintptr_t>(cache_key.bias)});
+  return it != process_offsets_.end() ? it->second : kNotFound;
+}
+
+size_t FileWeightCacheProvider::LookUp(
+    void* context, const xnn_weights_cache_look_up_key* cache_key) {
+  auto* provider = static_cast<FileWeightCacheProvider*>(context);
+  std::lock_guard<std::mutex> lock(provider->mutex_);
+  return provider->LookUpLocked(*cache_key);
+}
+
+void* FileWeightCacheProvider::ReserveSpace(void* context, size_t n) {
+  auto* provider = static_cast<FileWeightCacheProvider*>(context);
+  std::lock_guard<std::mutex> lock(provider->mutex_);
+  Buffer& buffer = provider->reserved_;
+  buffer.storage.reset(new uint8_t[n + kWeightCacheAlignment]);
+  buffer.data = reinterpret_cast<uint8_t*>(
+      AlignUp(reinterpret_cast<uintptr_t>(buffer.storage.get())));
+  buffer.size = n;
+  return buffer.data;
+}
+
+size_t FileWeightCacheProvider::LookUpOrInsert(
+    void* context, const xnn_weights_cache_look_up_key* cache_key, void* ptr,
+    size_t size) {
+  auto* provider = static_cast<FileWeightCacheProvider*>(context);
+  std::lock_guard<std::mutex> lock(provider->mutex_);
+  const size_t existing_offset = provider->LookUpLocked(*cache_key);
+  if (existing_offset != kNotFound) {
+    return existing_offset;
+  }
+
+  Buffer buffer;
+  if (ptr == provider->reserved_.data && size <= provider->reserved_.size) {
+    buffer = std::move(provider->reserved_);
+  } else {
+    buffer.storage.reset(new uint8_t[size + kWeightCacheAlignment]);
+    buffer.data = reinterpret_cast<uint8_t*>(
+        AlignUp(reinterpret_cast<uintptr_t>(buffer.storage.get())));
+    std::memcpy(buffer.data, ptr, size);
+  }
+  buffer.size = size;
+  provider->reserved_ = Buffer();
+  const size_t offset = provider->next_offset_;
+  provider->next_offset_ += AlignUp(size);
+  provider->buffers_.emplace(offset, std::move(buffer));
+
+  // Only the weights packed from mapped buffers before the file is written
+  // can be looked up in it.
+  Key key;
+  if (!provider->loaded_ && !provider->finalized_ &&
+      provider->GetFileKey(*cache_key, &key)) {
+    provider->file_locations_.emplace(key, Location{offset, size});
+    provider->entries_.push_back(
+        WeightCacheEntry{key.seed, key.kernel, key.bias, offset, size});
+  } else {
+    provider->process_offsets_.emplace(
+        Key{cache_key->seed, reinterpret_cast<uintptr_t>(cache_key->kernel),
+            reinterpret_cast<uintptr_t>(cache_key->bias)},
+        offset);
+  }
+  return offset;
+}
+
+bool FileWeightCacheProvider::IsFinalized(void* context) {
+  auto* provider = static_cast<FileWeightCacheProvider*>(context);
+  std::lock_guard<std::mutex> lock(provider->mutex_);
+  return provider->finalized_;
+}
+
+void* FileWeightCacheProvider::OffsetToAddr(void* context, size_t offset) {
+  auto* provider = static_cast<FileWeightCacheProvider*>(context);
+  std::lock_guard<std::mutex> lock(provider->mutex_);
+  if (offset < provider->mapped_data_size_) {
+    // XNNPACK does not write to packed weights once they are inserted.
+    return const_cast<uint8_t*>(provider->mapped_data_) + offset;
+  }
+  auto it = provider->buffers_.find(offset);
+  return it != provider->buffers_.end() ? it->second.data : nullptr;
+}
+
+xnn_status FileWeightCacheProvider::Delete(void* context) {
+  // The provider is owned by the delegate.
+  return xnn_status_success;
+}
+
+#if defined(_WIN32)
+
+bool FileWeightCacheProvider::Load() { return false; }
+
+bool FileWeightCacheProvider::Write() {
+  TFLITE_LOG_PROD_ONCE(tflite::TFLITE_LOG_WARNING,
+                       "XNNPACK weight cache files are not supported on "
+                       "this platform.");
+  return false;
+}
+
+void FileWeightCacheProvider::Unmap() {}
+
+#else
+
+bool FileWeightCacheProvider::Load() {
+  Unmap();
+  file_locations_.clear();
+  const int fd = open(path_.c_str(), O_RDONLY);
+  if (fd < 0) {
+    return false;
+  }
+  struct stat file_stat;
+  void* mapped_file = MAP_FAILED;
+  if (fstat(fd, &file_stat) == 0 &&
+      static_cast<size_t>(file_stat.st_size) >= sizeof(WeightCacheHeader)) {
+    mapped_file = mmap(nullptr, file_stat.st_size, PROT_READ, MAP_SHARED, fd,
+                       /*offset=*/0);
+  }
+  close(fd);
+  if (mapped_file == MAP_FAILED) {
+    return false;
+  }
+  mapped_file_ = mapped_file;
+  mapped_file_size_ = file_stat.st_size;
+
+  const uint8_t* file = static_cast<const uint8_t*>(mapped_file_);
+  WeightCacheHeader header;
+  std::memcpy(&header, file, sizeof(header));
+  const uint64_t size = mapped_file_size_;
+  if (header.magic != WeightCacheHeader::kMagic ||
+      header.version != WeightCacheHeader::kVersion ||
+      header.xnnpack_fingerprint != GetXNNPackFingerprint() ||
+      header.model_fingerprint != model_fingerprint_ ||
+      header.data_offset % kWeightCacheAlignment != 0 ||
+      header.data_offset < sizeof(header) || header.data_offset > size ||
+      header.data_size > size - header.data_offset ||
+      header.entries_offset % alignof(WeightCacheEntry) != 0 ||
+      header.entries_offset > size ||
+      header.entry_count >
+          (size - header.entries_offset) / sizeof(WeightCacheEntry)) {
+    TFLITE_LOG_PROD(tflite::TFLITE_LOG_INFO,
+                    "XNNPACK weight cache file %s does not match the model or "
+                    "the XNNPACK build and will be written again.",
+                    path_.c_str());
+    Unmap();
+    return false;
+  }
+  const WeightCacheEntry* entries = reinterpret_cast<const WeightCacheEntry*>(
+      file + header.entries_offset);
+  for (uint64_t i = 0; i < header.entry_count; ++i) {
+    const WeightCacheEntry& entry = entries[i];
+    if (entry.offset % kWeightCacheAlignment != 0 ||
+        entry.offset > header.data_size ||
+        entry.size > header.data_size - entry.offset) {
+      TFLITE_LOG_PROD(tflite::TFLITE_LOG_WARNING,
+                      "Invalid XNNPACK weight cache file %s.", path_.c_str());
+      file_locations_.clear();
+      Unmap();
+      return false;
+    }
+    file_locations_.emplace(Key{entry.seed, entry.kernel_id, entry.bias_id},
+                            Location{entry.offset, entry.size});
+  }
+  mapped_data_ = file + header.data_offset;
+  mapped_data_size_ = header.data_size;
+  return true;
+}
+
+bool FileWeightCacheProvider::Write() {
+  WeightCacheHeader header;
+  header.magic = WeightCacheHeader::kMagic;
+  header.version = WeightCacheHeader::kVersion;
+  header.xnnpack_fingerprint = GetXNNPackFingerprint();
+  header.model_fingerprint = model_fingerprint_;
+  header.data_offset = AlignUp(sizeof(header));
+  header.data_size = next_offset_;
+  header.entries_offset = header.data_offset + header.data_size;
+  header.entry_count = entries_.size();
+
+  std::vector<std::pair<size_t, const Buffer*>> buffers;
+  buffers.reserve(buffers_.size());
+  for (const auto& [offset, buffer] : buffers_) {
+    buffers.emplace_back(offset, &buffer);
+  }
+  std::sort(buffers.begin(), buffers.end());
+
+  // Processes loading the same model may write the file concurrently, so it
+  // is replaced atomically.
+  const std::string temp_path =
+      path_ + ".tmp" + std::to_string(static_cast<long>(getpid()));
+  FILE* file = std::fopen(temp_path.c_str(), "wb");
+  if (file == nullptr) {
+    return false;
+  }
+  // The weights are aligned, so the padding before each of them is shorter
+  // than the alignment.
+  const std::vector<uint8_t> padding(kWeightCacheAlignment, 0);
+  bool ok = WriteBytes(file, &header, sizeof(header)) &&
+            WriteBytes(file, padding.data(),
+                       header.data_offset - sizeof(header));
+  size_t position = 0;
+  for (const auto& [offset, buffer] : buffers) {
+    ok = ok && WriteBytes(file, padding.data(), offset - position) &&
+         WriteBytes(file, buffer->data, buffer->size);
+    position = offset + buffer->size;
+  }
+  ok = ok && WriteBytes(file, padding.data(), header.data_size - position) &&
+       WriteBytes(file, entries_.data(),
+                  entries_.size() * sizeof(WeightCacheEntry));
+  ok = std::fclose(file) == 0 && ok;
+  if (!ok || std::rename(temp_path.c_str(), path_.c_str()) != 0) {
+    std::remove(temp_path.c_str());
+    return false;
+  }
+  return true;
+}
+
+void FileWeightCacheProvider::Unmap() {
+  if (mapped_file_ != nullptr) {
+    munmap(mapped_file_, mapped_file_size_);
+  }
+  mapped_file_ = nullptr;
+  mapped_file_size_ = 0;
+  mapped_data_ = nullptr;
+  mapped_data_size_ = 0;
+}
+
+#endif  // defined(_WIN32)
+
+}  // namespace xnnpack
+}  // namespace tflite
@@ -0,0 +1,203 @@
+/* Copyright 2024 The TensorFlow Authors. All Rights Reserved.
+
+Licensed under the Apache License, Version 2.0 (the "License");
+you may not use this file except in compliance with the License.
+You may obtain a copy of the License at
+
+    http://www.apache.org/licenses/LICENSE-2.0
+
+Unless required by applicable law or agreed to in writing, software
+distributed under the License is distributed on an "AS IS" BASIS,
+WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+See the License for the specific language governing permissions and
+limitations under the License.
+==============================================================================*/
+
+#ifndef TENSORFLOW_LITE_DELEGATES_XNNPACK_WEIGHT_CACHE_H_
+#define TENSORFLOW_LITE_DELEGATES_XNNPACK_WEIGHT_CACHE_H_
+
+#include <cstddef>
+#include <cstdint>
+#include <memory>
+#include <mutex>  // NOLINT(build/c++11)
+#include <string>
+#include <unordered_map>
+#include <vector>
+
+#include "xnnpack.h"  // from @XNNPACK
+
+namespace tflite {
+namespace xnnpack {
+
+// Revision of XNNPACK the packed weights of a cache file are produced with.
+// Sync with tensorflow/workspace2.bzl.
+inline constexpr char kXNNPackRevision[] =
+    "50037f8072731a2cc30a961b96e199ad691887e4";
+
+// Alignment of the packed weights, and of their offsets in a cache file.
+inline constexpr size_t kWeightCacheAlignment = 64;
+
+// A weight cache file starts with this header, followed by the packed weights
+// at `data_offset` and by `entry_count` `WeightCacheEntry`s at
+// `entries_offset`.
+struct WeightCacheHeader {
+  static constexpr uint64_t kMagic = 0x48434143574e4e58;  // "XNNWCACH"
+  static constexpr uint64_t kVersion = 1;
+
+  uint64_t magic;
+  uint64_t version;
+  // Identify the XNNPACK build and the CPU features, which decide how the
+  // weights are packed.
+  uint64_t xnnpack_fingerprint;
+  // Identifies the model and the delegate options the file is built for.
+  uint64_t model_fingerprint;
+  uint64_t data_offset;
+  uint64_t data_size;
+  uint64_t entries_offset;
+  uint64_t entry_count;
+};
+
+// The packed weights of an XNNPACK operator in a cache file. The weights are
+// identified by the contents of the kernel and bias buffers they are packed
+// from, as returned by `WeightCacheBufferId()`, rather than by their address.
+struct WeightCacheEntry {
+  uint64_t seed;
+  uint64_t kernel_id;
+  uint64_t bias_id;
+  // Offset of the packed weights from `WeightCacheHeader::data_offset`.
+  uint64_t offset;
+  uint64_t size;
+};
+
+// Returns an identifier of the `size` bytes at `data` which is the same in all
+// processes. It is never 0, which identifies a missing buffer.
+uint64_t WeightCacheBufferId(const void* data, size_t size);
+
+// Returns the fingerprint of the XNNPACK build and of the features of the CPU
+// that the packed weights are specific to.
+uint64_t GetXNNPackFingerprint();
+
+// XNNPACK weights cache backed by a file shared between processes.
+//
+// If the file exists and matches the model and XNNPACK fingerprints, the
+// packed weights are mapped read-only from it, so the processes running the
+// model share their memory and do not pack them again. Otherwise the weights
+// are packed in memory and written to the file by `Finalize()`, which then
+// maps them from it.
+//
+// XNNPACK refers to the weights by the addresses of the kernel and bias
+// buffers they are packed from, which are registered with `MapBuffer()` to
+// be looked up in the file. Weights packed from other buffers, or after
+// `Finalize()`, are kept in memory of the process.
+class FileWeightCacheProvider {
+ public:
+  FileWeightCacheProvider();
+  ~FileWeightCacheProvider();
+  FileWeightCacheProvider(const FileWeightCacheProvider&) = delete;
+  FileWeightCacheProvider& operator=(const FileWeightCacheProvider&) = delete;
+
+  // Maps the weight cache file at `path` if it is valid for
+  // `model_fingerprint`, and otherwise prepares to write it on `Finalize()`.
+  // Returns false if the provider is already initialized.
+  bool Initialize(const std::string& path, uint64_t model_fingerprint);
+
+  // Registers the buffer of `size` bytes at `data`, which XNNPACK may pack
+  // weights from, and returns its `WeightCacheBufferId()`.
+  uint64_t MapBuffer(const void* data, size_t size);
+
+  // Forgets the buffers registered with `MapBuffer()`.
+  void ClearBufferMap();
+
+  // Writes the packed weights to the file, unless they were mapped from it,
+  // and maps them from the file. XNNPACK only runs operators once the cache
+  // is finalized. Returns false if the file could not be written, in which
+  // case the weights stay in memory.
+  bool Finalize();
+
+  bool IsInitialized() const { return initialized_; }
+  bool IsFinalized() const { return finalized_; }
+
+  // Returns true if the packed weights were mapped from an existing file.
+  bool IsLoaded() const { return loaded_; }
+
+  // Returns the cache to pass to `xnn_create_runtime_v4()`.
+  xnn_weights_cache_t GetCacheProvider() { return &cache_provider_; }
+
+ private:
+  struct Key {
+    uint64_t seed;
+    uint64_t kernel;
+    uint64_t bias;
+    bool operator==(const Key& other) const {
+      return seed == other.seed && kernel == other.kernel &&
+             bias == other.bias;
+    }
+  };
+  struct KeyHash {
+    size_t operator()(const Key& key) const;
+  };
+  struct Location {
+    size_t offset;
+    size_t size;
+  };
+  // Packed weights in memory, aligned to kWeightCacheAlignment.
+  struct Buffer {
+    std::unique_ptr<uint8_t[]> storage;
+    uint8_t* data = nullptr;
+    size_t size = 0;
+  };
+
+  // Callbacks of `xnn_weights_cache_provider`.
+  static size_t LookUp(void* context,
+                       const xnn_weights_cache_look_up_key* cache_key);
+  static void* ReserveSpace(void* context, size_t n);
+  static size_t LookUpOrInsert(void* context,
+                               const xnn_weights_cache_look_up_key* cache_key,
+                               void* ptr, size_t size);
+  static bool IsFinalized(void* context);
+  static void* OffsetToAddr(void* context, size_t offset);
+  static xnn_status Delete(void* context);
+
+  // Returns the key of the weights packed for `cache_key` in the file, or
+  // false if its buffers are not mapped.
+  bool GetFileKey(const xnn_weights_cache_look_up_key& cache_key,
+                  Key* key) const;
+  size_t LookUpLocked(const xnn_weights_cache_look_up_key& cache_key) const;
+  bool Load();
+  bool Write();
+  void Unmap();
+
+  xnn_weights_cache_provider cache_provider_;
+  std::string path_;
+  uint64_t model_fingerprint_ = 0;
+  bool initialized_ = false;
+  bool finalized_ = false;
+  bool loaded_ = false;
+
+  mutable std::mutex mutex_;
+  // Identifiers of the buffers registered with `MapBuffer()`.
+  std::unordered_map<const void*, uint64_t> buffer_ids_;
+  // Weights that can be looked up in the file, and others.
+  std::unordered_map<Key, Location, KeyHash> file_locations_;
+  std::unordered_map<Key, size_t, KeyHash> process_offsets_;
+  // The entries of the weights to write to the file.
+  std::vector<WeightCacheEntry> entries_;
+  // Packed weights in memory by offset.
+  std::unordered_map<size_t, Buffer> buffers_;
+  // Space returned by the latest `ReserveSpace()`.
+  Buffer reserved_;
+  // Offset of the next weights packed in memory.
+  size_t next_offset_ = 0;
+
+  // The mapped file, and the packed weights in it, which are at the offsets
+  // below `mapped_data_size_`.
+  void* mapped_file_ = nullptr;
+  size_t mapped_file_size_ = 0;
+  const uint8_t* mapped_data_ = nullptr;
+  size_t mapped_data_size_ = 0;
+};
+
+}  // namespace xnnpack
+}  // namespace tflite
+
+#endif  // TENSORFLOW_LITE_DELEGATES_XNNPACK_WEIGHT_CACHE_H_
@@ -0,0 +1,180 @@
+/* Copyright 2024 The TensorFlow Authors. All Rights Reserved.
+
+Licensed under the Apache License, Version 2.0 (the "License");
+you may not use this file except in compliance with the License.
+You may obtain a copy of the License at
+
+    http://www.apache.org/licenses/LICENSE-2.0
+
+Unless required by applicable law or agreed to in writing, software
+distributed under the License is distributed on an "AS IS" BASIS,
+WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+See the License for the specific language governing permissions and
+limitations under the License.
+==============================================================================*/
+
+#include "tensorflow/lite/delegates/xnnpack/weight_cache.h"
+
+#include <cstdint>
+#include <cstdio>
+#include <cstring>
+#include <numeric>
+#include <string>
+#include <vector>
+
+#include <gtest/gtest.h>
+#include "xnnpack.h"  // from @XNNPACK
+
+namespace tflite {
+namespace xnnpack {
+namespace {
+
+constexpr size_t kNotFound = SIZE_MAX;
+
+// Packs `weights` like an XNNPACK operator, by negating them, and returns
+// their offset in the cache.
+size_t Pack(xnn_weights_cache_t cache, uint32_t seed,
+            const std::vector<int32_t>& weights) {
+  const xnn_weights_cache_look_up_key key = {seed, weights.data(), nullptr};
+  const size_t offset = cache->look_up(cache->context, &key);
+  if (offset != kNotFound) {
+    return offset;
+  }
+  const size_t size = weights.size() * sizeof(int32_t);
+  auto* packed =
+      static_cast<int32_t*>(cache->reserve_space(cache->context, size));
+  for (size_t i = 0; i < weights.size(); ++i) {
+    packed[i] = -weights[i];
+  }
+  return cache->look_up_or_insert(cache->context, &key, packed, size);
+}
+
+std::vector<int32_t> Packed(xnn_weights_cache_t cache, size_t offset,
+                            size_t count) {
+  const auto* packed = static_cast<const int32_t*>(
+      cache->offset_to_addr(cache->context, offset));
+  return std::vector<int32_t>(packed, packed + count);
+}
+
+class WeightCacheTest : public testing::Test {
+ protected:
+  void SetUp() override {
+    path_ = testing::TempDir() + "/" +
+            testing::UnitTest::GetInstance()->current_test_info()->name() +
+            ".xnnpack_cache";
+    std::remove(path_.c_str());
+    weights_.resize(1000);
+    std::iota(weights_.begin(), weights_.end(), 0);
+    other_weights_.assign(17, 5);
+  }
+
+  void TearDown() override { std::remove(path_.c_str()); }
+
+  // Packs the weights with a new provider, and returns whether they were
+  // loaded from the file.
+  bool PackWithNewProvider(uint64_t model_fingerprint) {
+    // Copies the weights, as another process would have them at another
+    // address.
+    const std::vector<int32_t> weights = weights_;
+    const std::vector<int32_t> other_weights = other_weights_;
+    FileWeightCacheProvider provider;
+    EXPECT_TRUE(provider.Initialize(path_, model_fingerprint));
+    EXPECT_FALSE(provider.Initialize(path_, model_fingerprint));
+    provider.MapBuffer(weights.data(), weights.size() * sizeof(int32_t));
+    provider.MapBuffer(other_weights.data(),
+                       other_weights.size() * sizeof(int32_t));
+    xnn_weights_cache_t cache = provider.GetCacheProvider();
+    const size_t offset = Pack(cache, /*seed=*/1, weights);
+    const size_t other_offset = Pack(cache, /*seed=*/2, other_weights);
+    // The same weights packed again are shared.
+    EXPECT_EQ(Pack(cache, /*seed=*/1, weights), offset);
+    EXPECT_NE(other_offset, offset);
+
+    EXPECT_FALSE(cache->is_finalized(cache->context));
+    EXPECT_TRUE(provider.Finalize());
+    EXPECT_TRUE(cache->is_finalized(cache->context));
+    std::vector<int32_t> expected(weights.size());
+    for (size_t i = 0; i < weights.size(); ++i) expected[i] = -weights[i];
+    EXPECT_EQ(Packed(cache, offset, weights.size()), expected);
+    EXPECT_EQ(Packed(cache, other_offset, other_weights.size()),
+              std::vector<int32_t>(other_weights.size(), -5));
+    return provider.IsLoaded();
+  }
+
+  std::string path_;
+  std::vector<int32_t> weights_;
+  std::vector<int32_t> other_weights_;
+};
+
+TEST_F(WeightCacheTest, WritesAndLoadsFile) {
+  EXPECT_FALSE(PackWithNewProvider(/*model_fingerprint=*/42));
+  EXPECT_TRUE(PackWithNewProvider(/*model_fingerprint=*/42));
+  EXPECT_TRUE(PackWithNewProvider(/*model_fingerprint=*/42));
+}
+
+TEST_F(WeightCacheTest, RewritesFileOfOtherModel) {
+  EXPECT_FALSE(PackWithNewProvider(/*model_fingerprint=*/42));
+  EXPECT_FALSE(PackWithNewProvider(/*model_fingerprint=*/43));
+  EXPECT_TRUE(PackWithNewProvider(/*model_fingerprint=*/43));
+}
+
+TEST_F(WeightCacheTest, DoesNotLoadChangedWeights) {
+  EXPECT_FALSE(PackWithNewProvider(/*model_fingerprint=*/42));
+  // The weights are looked up by their contents.
+  weights_[7] = -1;
+  FileWeightCacheProvider provider;
+  ASSERT_TRUE(provider.Initialize(path_, /*model_fingerprint=*/42));
+  provider.MapBuffer(weights_.data(), weights_.size() * sizeof(int32_t));
+  xnn_weights_cache_t cache = provider.GetCacheProvider();
+  const xnn_weights_cache_look_up_key key = {1, weights_.data(), nullptr};
+  EXPECT_EQ(cache->look_up(cache->context, &key), kNotFound);
+}
+
+TEST_F(WeightCacheTest, RewritesInvalidFile) {
+  EXPECT_FALSE(PackWithNewProvider(/*model_fingerprint=*/42));
+  FILE* file = std::fopen(path_.c_str(), "r+b");
+  ASSERT_NE(file, nullptr);
+  ASSERT_EQ(std::fseek(file, 0, SEEK_END), 0);
+  const long size = std::ftell(file);
+  // Makes the last entry point past the packed weights.
+  const uint64_t offset = uint64_t{1} << 40;
+  ASSERT_EQ(std::fseek(file, size - 2 * sizeof(uint64_t), SEEK_SET), 0);
+  ASSERT_EQ(std::fwrite(&offset, sizeof(offset), 1, file), 1);
+  ASSERT_EQ(std::fclose(file), 0);
+  EXPECT_FALSE(PackWithNewProvider(/*model_fingerprint=*/42));
+  EXPECT_TRUE(PackWithNewProvider(/*model_fingerprint=*/42));
+}
+
+TEST_F(WeightCacheTest, KeepsWeightsOfUnmappedBuffersInMemory) {
+  FileWeightCacheProvider provider;
+  ASSERT_TRUE(provider.Initialize(path_, /*model_fingerprint=*/42));
+  xnn_weights_cache_t cache = provider.GetCacheProvider();
+  const size_t offset = Pack(cache, /*seed=*/1, weights_);
+  EXPECT_EQ(Pack(cache, /*seed=*/1, weights_), offset);
+  ASSERT_TRUE(provider.Finalize());
+  EXPECT_EQ(Packed(cache, offset, 1), std::vector<int32_t>{0});
+  EXPECT_EQ(Packed(cache, offset + sizeof(int32_t), 1),
+            std::vector<int32_t>{-1});
+
+  // Weights packed after the file is written stay in memory.
+  const size_t other_offset = Pack(cache, /*seed=*/2, other_weights_);
+  EXPECT_EQ(Packed(cache, other_offset, other_weights_.size()),
+            std::vector<int32_t>(other_weights_.size(), -5));
+}
+
+TEST(WeightCacheBufferIdTest, DependsOnContents) {
+  const std::vector<uint8_t> buffer = {1, 2, 3, 4, 5, 6, 7, 8, 9, 10};
+  const std::vector<uint8_t> copy = buffer;
+  EXPECT_EQ(WeightCacheBufferId(buffer.data(), buffer.size()),
+            WeightCacheBufferId(copy.data(), copy.size()));
+  EXPECT_NE(WeightCacheBufferId(buffer.data(), buffer.size()),
+            WeightCacheBufferId(buffer.data(), buffer.size() - 1));
+  std::vector<uint8_t> changed = buffer;
+  changed[9] = 0;
+  EXPECT_NE(WeightCacheBufferId(buffer.data(), buffer.size()),
+            WeightCacheBufferId(changed.data(), changed.size()));
+}
+
+}  // namespace
+}  // namespace xnnpack
+}  // namespace tflite
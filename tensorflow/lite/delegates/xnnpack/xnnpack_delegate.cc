@@ -39,6 +39,7 @@ limitations under the License.
 #include "tensorflow/lite/core/c/builtin_op_data.h"
 #include "tensorflow/lite/core/c/common.h"
 #include "tensorflow/lite/delegates/xnnpack/quantization_util.h"
+#include "tensorflow/lite/delegates/xnnpack/weight_cache.h"
 #include "tensorflow/lite/kernels/cpu_backend_context.h"
 #include "tensorflow/lite/kernels/internal/compatibility.h"
 #include "tensorflow/lite/kernels/internal/tensor_ctypes.h"
@@ -525,6 +526,18 @@ class Delegate {
         options != nullptr ? *options : TfLiteXNNPackDelegateOptionsDefault();
     delegate_.flags = GetXNNPackDelegateFlags();
     workspace_.reset(workspace);
+    if (options_.weight_cache_file_path != nullptr) {
+      if (options_.weights_cache != nullptr) {
+        TFLITE_LOG_PROD(tflite::TFLITE_LOG_WARNING,
+                        "XNNPACK weight cache file %s is ignored because a "
+                        "weights cache is set.",
+                        options_.weight_cache_file_path);
+      } else {
+        weight_cache_file_path_ = options_.weight_cache_file_path;
+      }
+    }
+    // The path is only valid during the call.
+    options_.weight_cache_file_path = nullptr;
   }
 
   TfLiteIntArray* PrepareOpsToDelegate(TfLiteContext* context);
@@ -610,14 +623,28 @@ class Delegate {
 #endif
   }
 
-  xnn_weights_cache_t weights_cache() const {
-    if (options_.weights_cache == nullptr) {
+  xnn_weights_cache_t weights_cache() {
+    if (weight_cache_provider_.IsInitialized()) {
+      return weight_cache_provider_.GetCacheProvider();
+    } else if (options_.weights_cache == nullptr) {
       return nullptr;
     } else {
       return reinterpret_cast<xnn_weights_cache_t>(options_.weights_cache);
     }
   }
 
+  // Registers the static buffers of `context` that weights may be packed from
+  // with the weight cache file, and opens the file for the first subgraph.
+  void PrepareWeightCache(TfLiteContext* context);
+
+  // Finalizes the weight cache file before the weights are first used.
+  void FinalizeWeightCache() {
+    if (weight_cache_provider_.IsInitialized() &&
+        !weight_cache_provider_.IsFinalized()) {
+      weight_cache_provider_.Finalize();
+    }
+  }
+
   xnn_workspace_t workspace() const { return workspace_.get(); }
 
   TfLiteStatus AssociateVariableWithTensor(int local_id,
@@ -711,6 +738,10 @@ class Delegate {
   TfLiteXNNPackDelegateOptions options_{};
   VariableHolder variable_holder_;
   std::mutex workspace_mutex_;
+
+  // Cache of the packed weights backed by `weight_cache_file_path_`.
+  std::string weight_cache_file_path_;
+  FileWeightCacheProvider weight_cache_provider_;
 };
 
 class Subgraph {
@@ -7449,6 +7480,52 @@ TfLiteIntArray* Delegate::PrepareOpsToDelegate(TfLiteContext* context) {
   return nodes_to_delegate;
 }
 
+void Delegate::PrepareWeightCache(TfLiteContext* context) {
+  if (weight_cache_file_path_.empty()) {
+    return;
+  }
+  // Identifies the model by its static buffers, and by the options and
+  // metadata deciding how they are packed.
+  std::vector<uint64_t> fingerprint_data = {options_.flags, force_fp16()};
+  const char* precision_metadata_ptr = nullptr;
+  size_t precision_metadata_size = 0;
+  if (context->GetModelMetadata(context, optimize::kTfLiteReducedPrecisionKey,
+                                &precision_metadata_ptr,
+                                &precision_metadata_size) == kTfLiteOk) {
+    fingerprint_data.push_back(
+        WeightCacheBufferId(precision_metadata_ptr, precision_metadata_size));
+  }
+
+  weight_cache_provider_.ClearBufferMap();
+  for (size_t t = 0; t < context->tensors_size; ++t) {
+    const TfLiteTensor& tensor = context->tensors[t];
+    const void* data = nullptr;
+    if (tensor.allocation_type == kTfLiteMmapRo) {
+      data = tensor.data.raw_const;
+    } else if (auto it = static_unpacked_data_map_.find(t);
+               it != static_unpacked_data_map_.end()) {
+      data = static_unpacked_data_.data() + it->second;
+    }
+    if (data != nullptr) {
+      fingerprint_data.push_back(t);
+      fingerprint_data.push_back(
+          weight_cache_provider_.MapBuffer(data, tensor.bytes));
+    }
+  }
+
+  if (!weight_cache_provider_.IsInitialized()) {
+    weight_cache_provider_.Initialize(
+        weight_cache_file_path_,
+        WeightCacheBufferId(fingerprint_data.data(),
+                            fingerprint_data.size() * sizeof(uint64_t)));
+    if (weight_cache_provider_.IsLoaded()) {
+      TFLITE_LOG_PROD(tflite::TFLITE_LOG_INFO,
+                      "Loaded XNNPACK packed weights from %s.",
+                      weight_cache_file_path_.c_str());
+    }
+  }
+}
+
 void* SubgraphInit(TfLiteContext* context, const char* buffer, size_t length) {
   const TfLiteDelegateParams* params =
       reinterpret_cast<const TfLiteDelegateParams*>(buffer);
@@ -7464,6 +7541,8 @@ TfLiteStatus SubgraphPrepare(TfLiteContext* context, TfLiteNode* node) {
   }
 
   Subgraph* subgraph = static_cast<Subgraph*>(node->user_data);
+  // XNNPACK only runs the operators once their weights cache is finalized.
+  subgraph->GetDelegate()->FinalizeWeightCache();
   return static_cast<Subgraph*>(node->user_data)
       ->Prepare(context, node, subgraph->EnableSubgraphReshaping(),
                 subgraph->GetDelegate());
@@ -7498,12 +7577,14 @@ const TfLiteRegistration kSubgraphRegistration = {
 };
 
 TfLiteStatus DelegatePrepare(TfLiteContext* context, TfLiteDelegate* delegate) {
+  auto* xnnpack_delegate =
+      static_cast<::tflite::xnnpack::Delegate*>(delegate->data_);
   TfLiteIntArray* ops_to_replace =
-      static_cast<::tflite::xnnpack::Delegate*>(delegate->data_)
-          ->PrepareOpsToDelegate(context);
+      xnnpack_delegate->PrepareOpsToDelegate(context);
   if (ops_to_replace == nullptr) {
     return kTfLiteError;
   }
+  xnnpack_delegate->PrepareWeightCache(context);
 
   const TfLiteStatus status = context->ReplaceNodeSubsetsWithDelegateKernels(
       context, kSubgraphRegistration, ops_to_replace, delegate);
@@ -70,6 +70,14 @@ typedef struct {
   bool handle_variable_ops;
   // Enable adaptive optimization for AVX CPUs.
   bool experimental_adaptive_avx_optimization;
+  // Path to a file caching the packed weights of the model. If the file was
+  // written for the same model and XNNPACK build, the packed weights are
+  // mapped read-only from it instead of being packed again, so processes
+  // running the model share their memory. Otherwise the file is written once
+  // the weights are packed. Ignored if `weights_cache` is set.
+  //
+  // WARNING: This is an experimental API and subject to change.
+  const char* weight_cache_file_path;
 } TfLiteXNNPackDelegateOptions;
 
 // Returns a structure with the default XNNPack delegate options.
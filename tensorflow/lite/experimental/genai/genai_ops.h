@@ -16,6 +16,8 @@ limitations under the License.
 #ifndef TENSORFLOW_LITE_EXPERIMENTAL_GENAI_GENAI_OPS_H_
 #define TENSORFLOW_LITE_EXPERIMENTAL_GENAI_GENAI_OPS_H_
 
+#include "tensorflow/lite/core/subgraph.h"
+#include "tensorflow/lite/experimental/resource/paged_cache_buffer.h"
 #include "tensorflow/lite/mutable_op_resolver.h"
 
 namespace tflite {
@@ -24,6 +26,14 @@ namespace custom {
 
 TfLiteRegistration* Register_KV_CACHE();
 TfLiteRegistration* Register_SDPA();
+TfLiteRegistration* Register_PAGED_KV_CACHE();
+TfLiteRegistration* Register_PAGED_SDPA();
+
+// Returns the paged KV cache shared by the PAGED_KV_CACHE and PAGED_SDPA ops
+// of the subgraph, or nullptr if the tensors of the subgraph have not been
+// allocated yet. Sequences can be forked and released through it, e.g. to
+// share the cache of a common prompt or to end a session.
+resource::PagedCacheBuffer* GetPagedKVCache(Subgraph* subgraph);
 
 extern "C" void GenAIOpsRegisterer(::tflite::MutableOpResolver* resolver);
 
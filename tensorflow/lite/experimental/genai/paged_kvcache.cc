@@ -0,0 +1,258 @@
+/* Copyright 2024 The TensorFlow Authors. All Rights Reserved.
+
+Licensed under the Apache License, Version 2.0 (the "License");
+you may not use this file except in compliance with the License.
+You may obtain a copy of the License at
+
+    http://www.apache.org/licenses/LICENSE-2.0
+
+Unless required by applicable law or agreed to in writing, software
+distributed under the License is distributed on an "AS IS" BASIS,
+WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+See the License for the specific language governing permissions and
+limitations under the License.
+==============================================================================*/
+
+#include <algorithm>
+#include <cstddef>
+#include <cstdint>
+#include <cstring>
+#include <vector>
+
+#include "flatbuffers/flexbuffers.h"
+#include "tensorflow/lite/core/c/common.h"
+#include "tensorflow/lite/core/subgraph.h"
+#include "tensorflow/lite/experimental/genai/genai_ops.h"
+#include "tensorflow/lite/experimental/resource/paged_cache_buffer.h"
+#include "tensorflow/lite/experimental/resource/resource_base.h"
+#include "tensorflow/lite/kernels/internal/tensor_ctypes.h"
+#include "tensorflow/lite/kernels/kernel_util.h"
+
+namespace tflite {
+namespace ops {
+namespace custom {
+namespace llm {
+
+// Writes the keys and values of a sequence into the paged KV cache of the
+// subgraph, and outputs the block table of the sequence for the
+// PAGED_SDPA ops of the layer.
+//
+// Inputs: position (int64, [S]), key and value (float32, [1, S, N, H]), and
+// optionally the id of the sequence (int32, one element, 0 if omitted).
+// Output: the block table of the sequence (int32, [num_blocks]).
+
+static const int kPositionTensor = 0;
+static const int kKeyTensor = 1;
+static const int kValueTensor = 2;
+static const int kSequenceIdTensor = 3;
+static const int kBlockTableTensor = 0;
+static const int kRequiredNumDimensions = 4;
+static const int kDefaultBlockSize = 16;
+static const int kDefaultMaxNumCacheEntries = 2048;
+static const int kDefaultNumTransformerLayers = 32;
+
+static const int KVCACHE_PAGED_RESOURCE = 44;
+
+struct OpData {
+  int num_layers;
+  int layer_index;
+  int block_size;
+  int num_blocks;
+  // Pointer to the cache that this Op doesn't own (and therefore does not
+  // free on destruction of this Op).
+  resource::PagedCacheBuffer* cache;
+  bool is_initialized;
+};
+
+void* PagedKVCacheInit(TfLiteContext* context, const char* buffer,
+                       size_t length) {
+  OpData* op_data = new OpData();
+  op_data->num_layers = -1;
+  op_data->layer_index = -1;
+  op_data->block_size = -1;
+  op_data->num_blocks = -1;
+  op_data->cache = nullptr;
+  op_data->is_initialized = false;
+  return op_data;
+}
+
+TfLiteStatus PagedKVCachePrepare(TfLiteContext* context, TfLiteNode* node) {
+  TF_LITE_ENSURE(context, NumInputs(node) == 3 || NumInputs(node) == 4);
+  TF_LITE_ENSURE_EQ(context, NumOutputs(node), 1);
+
+  OpData* op_data = reinterpret_cast<OpData*>(node->user_data);
+
+  if (!op_data->is_initialized) {
+    const uint8_t* buffer =
+        reinterpret_cast<const uint8_t*>(node->custom_initial_data);
+    const size_t length = node->custom_initial_data_size;
+    auto flexbuffer_map = flexbuffers::GetRoot(buffer, length).AsMap();
+    int32_t num_layers = flexbuffer_map["num_layers"].AsInt32();
+    int32_t layer_index = flexbuffer_map["layer_index"].AsInt32();
+    int32_t block_size = flexbuffer_map["block_size"].AsInt32();
+    int32_t num_blocks = flexbuffer_map["num_blocks"].AsInt32();
+    op_data->num_layers =
+        num_layers > 0 ? num_layers : kDefaultNumTransformerLayers;
+    op_data->layer_index = layer_index;
+    op_data->block_size = block_size > 0 ? block_size : kDefaultBlockSize;
+    op_data->num_blocks =
+        num_blocks > 0 ? num_blocks
+                       : kDefaultMaxNumCacheEntries / op_data->block_size;
+    op_data->is_initialized = true;
+  }
+  TF_LITE_ENSURE(context, op_data->layer_index >= 0 &&
+                              op_data->layer_index < op_data->num_layers);
+
+  const TfLiteTensor* position;
+  const TfLiteTensor* key;
+  const TfLiteTensor* value;
+  TF_LITE_ENSURE_OK(context,
+                    GetInputSafe(context, node, kPositionTensor, &position));
+  TF_LITE_ENSURE_OK(context, GetInputSafe(context, node, kKeyTensor, &key));
+  TF_LITE_ENSURE_OK(context, GetInputSafe(context, node, kValueTensor, &value));
+
+  TF_LITE_ENSURE_EQ(context, position->type, kTfLiteInt64);
+  TF_LITE_ENSURE_EQ(context, key->type, kTfLiteFloat32);
+  TF_LITE_ENSURE_EQ(context, value->type, kTfLiteFloat32);
+  TF_LITE_ENSURE(context, NumDimensions(position) == 1);
+  // Support only (B, S, N, H) with B == 1 for now.
+  TF_LITE_ENSURE(context, NumDimensions(key) == kRequiredNumDimensions);
+  TF_LITE_ENSURE(context, GetTensorShape(key).Dims(0) == 1);
+  TF_LITE_ENSURE(
+      context, GetTensorShape(position).Dims(0) == GetTensorShape(key).Dims(1));
+  TF_LITE_ENSURE(context, HaveSameShapes(key, value));
+  if (NumInputs(node) == 4) {
+    const TfLiteTensor* sequence_id;
+    TF_LITE_ENSURE_OK(
+        context, GetInputSafe(context, node, kSequenceIdTensor, &sequence_id));
+    TF_LITE_ENSURE_EQ(context, sequence_id->type, kTfLiteInt32);
+    TF_LITE_ENSURE_EQ(context, NumElements(sequence_id), 1);
+  }
+
+  // The size of the block table changes as the sequence grows.
+  TfLiteTensor* block_table;
+  TF_LITE_ENSURE_OK(context,
+                    GetOutputSafe(context, node, kBlockTableTensor,
+                                  &block_table));
+  block_table->type = kTfLiteInt32;
+  SetTensorToDynamic(block_table);
+
+  const int entry_size = key->dims->data[2] * key->dims->data[3];
+  Subgraph* subgraph = reinterpret_cast<Subgraph*>(context->impl_);
+  auto& resources = subgraph->resources();
+  if (resources.count(KVCACHE_PAGED_RESOURCE) == 0) {
+    auto* cache = new resource::PagedCacheBuffer();
+    resources.emplace(KVCACHE_PAGED_RESOURCE, cache);
+    TF_LITE_ENSURE_OK(
+        context, cache->Initialize(op_data->num_blocks, op_data->block_size,
+                                   op_data->num_layers, entry_size));
+    op_data->cache = cache;
+  } else {
+    op_data->cache = static_cast<resource::PagedCacheBuffer*>(
+        resources.at(KVCACHE_PAGED_RESOURCE).get());
+  }
+  // All layers share the cache, so they must agree on its layout.
+  TF_LITE_ENSURE_EQ(context, op_data->cache->GetNumLayers(),
+                    op_data->num_layers);
+  TF_LITE_ENSURE_EQ(context, op_data->cache->GetBlockSize(),
+                    op_data->block_size);
+  TF_LITE_ENSURE_EQ(context, op_data->cache->GetEntrySize(), entry_size);
+  return kTfLiteOk;
+}
+
+void PagedKVCacheFree(TfLiteContext* context, void* buffer) {
+  delete static_cast<OpData*>(buffer);
+}
+
+TfLiteStatus PagedKVCacheEval(TfLiteContext* context, TfLiteNode* node) {
+  const TfLiteTensor* position;
+  TF_LITE_ENSURE_OK(context,
+                    GetInputSafe(context, node, kPositionTensor, &position));
+  const TfLiteTensor* key;
+  TF_LITE_ENSURE_OK(context, GetInputSafe(context, node, kKeyTensor, &key));
+  const TfLiteTensor* value;
+  TF_LITE_ENSURE_OK(context, GetInputSafe(context, node, kValueTensor, &value));
+  int sequence_id = 0;
+  if (NumInputs(node) == 4) {
+    const TfLiteTensor* sequence_id_tensor;
+    TF_LITE_ENSURE_OK(context, GetInputSafe(context, node, kSequenceIdTensor,
+                                            &sequence_id_tensor));
+    sequence_id = GetTensorData<int32_t>(sequence_id_tensor)[0];
+  }
+  TfLiteTensor* block_table_tensor;
+  TF_LITE_ENSURE_OK(context,
+                    GetOutputSafe(context, node, kBlockTableTensor,
+                                  &block_table_tensor));
+  OpData* op_data = reinterpret_cast<OpData*>(node->user_data);
+  resource::PagedCacheBuffer* cache = op_data->cache;
+
+  const int64_t num_slots = NumElements(position);
+  const int64_t* positions = GetTensorData<int64_t>(position);
+  if (num_slots > 0) {
+    const int64_t first_position =
+        *std::min_element(positions, positions + num_slots);
+    const int64_t last_position =
+        *std::max_element(positions, positions + num_slots);
+    if (cache->Reserve(sequence_id, first_position, last_position) !=
+        kTfLiteOk) {
+      TF_LITE_KERNEL_LOG(context,
+                         "Can not reserve positions %lld to %lld of sequence "
+                         "%d in the paged KV cache, %d of %d blocks are free",
+                         static_cast<long long>(first_position),
+                         static_cast<long long>(last_position), sequence_id,
+                         cache->GetNumFreeBlocks(), cache->GetNumBlocks());
+      return kTfLiteError;
+    }
+
+    const std::vector<int>& block_table = *cache->GetBlockTable(sequence_id);
+    const int block_size = cache->GetBlockSize();
+    const int entry_size = cache->GetEntrySize();
+    const size_t num_bytes_per_entry = sizeof(float) * entry_size;
+    const float* key_data = GetTensorData<float>(key);
+    const float* value_data = GetTensorData<float>(value);
+    for (int64_t i = 0; i < num_slots; ++i) {
+      const int block = block_table[positions[i] / block_size];
+      const int offset = positions[i] % block_size;
+      memcpy(cache->GetKey(block, op_data->layer_index, offset),
+             key_data + i * entry_size, num_bytes_per_entry);
+      memcpy(cache->GetValue(block, op_data->layer_index, offset),
+             value_data + i * entry_size, num_bytes_per_entry);
+    }
+    cache->SetNumEntries(sequence_id,
+                         std::max(cache->GetNumEntries(sequence_id),
+                                  last_position + 1));
+  }
+
+  // Output the block table, even if no entry was written.
+  const std::vector<int>* block_table = cache->GetBlockTable(sequence_id);
+  const int num_blocks = block_table ? block_table->size() : 0;
+  TfLiteIntArray* block_table_dims = TfLiteIntArrayCreate(1);
+  block_table_dims->data[0] = num_blocks;
+  TF_LITE_ENSURE_OK(context, context->ResizeTensor(context, block_table_tensor,
+                                                   block_table_dims));
+  if (num_blocks > 0) {
+    memcpy(GetTensorData<int32_t>(block_table_tensor), block_table->data(),
+           sizeof(int32_t) * num_blocks);
+  }
+  return kTfLiteOk;
+}
+
+}  // namespace llm
+
+resource::PagedCacheBuffer* GetPagedKVCache(Subgraph* subgraph) {
+  auto& resources = subgraph->resources();
+  auto it = resources.find(llm::KVCACHE_PAGED_RESOURCE);
+  if (it == resources.end()) return nullptr;
+  return static_cast<resource::PagedCacheBuffer*>(it->second.get());
+}
+
+TfLiteRegistration* Register_PAGED_KV_CACHE() {
+  static TfLiteRegistration r = {llm::PagedKVCacheInit, llm::PagedKVCacheFree,
+                                 llm::PagedKVCachePrepare,
+                                 llm::PagedKVCacheEval};
+  return &r;
+}
+
+}  // namespace custom
+}  // namespace ops
+}  // namespace tflite
@@ -0,0 +1,291 @@
+/* Copyright 2024 The TensorFlow Authors. All Rights Reserved.
+
+Licensed under the Apache License, Version 2.0 (the "License");
+you may not use this file except in compliance with the License.
+You may obtain a copy of the License at
+
+    http://www.apache.org/licenses/LICENSE-2.0
+
+Unless required by applicable law or agreed to in writing, software
+distributed under the License is distributed on an "AS IS" BASIS,
+WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+See the License for the specific language governing permissions and
+limitations under the License.
+==============================================================================*/
+
+#include <cmath>
+#include <cstdint>
+#include <cstring>
+#include <vector>
+
+#include <gmock/gmock.h>
+#include <gtest/gtest.h>
+#include "flatbuffers/flexbuffers.h"
+#include "tensorflow/lite/c/c_api_types.h"
+#include "tensorflow/lite/experimental/genai/genai_ops.h"
+#include "tensorflow/lite/experimental/resource/paged_cache_buffer.h"
+#include "tensorflow/lite/interpreter.h"
+#include "tensorflow/lite/schema/schema_generated.h"
+
+namespace tflite {
+namespace {
+
+using ::testing::ElementsAre;
+using ::testing::FloatNear;
+using ::testing::Pointwise;
+
+constexpr int kNumHeads = 2;
+constexpr int kNumKVHeads = 1;
+constexpr int kHeadDim = 2;
+constexpr int kBlockSize = 2;
+constexpr int kNumBlocks = 8;
+
+// Runs PAGED_KV_CACHE followed by PAGED_SDPA on `num_tokens` tokens.
+class PagedAttentionModel {
+ public:
+  explicit PagedAttentionModel(int num_tokens) {
+    flexbuffers::Builder fbb;
+    fbb.Map([&]() {
+      fbb.Int("num_layers", 1);
+      fbb.Int("layer_index", 0);
+      fbb.Int("block_size", kBlockSize);
+      fbb.Int("num_blocks", kNumBlocks);
+    });
+    fbb.Finish();
+    options_ = fbb.GetBuffer();
+
+    kv_cache_registration_ = *ops::custom::Register_PAGED_KV_CACHE();
+    kv_cache_registration_.builtin_code = BuiltinOperator_CUSTOM;
+    kv_cache_registration_.custom_name = "odml.update_paged_kv_cache";
+    sdpa_registration_ = *ops::custom::Register_PAGED_SDPA();
+    sdpa_registration_.builtin_code = BuiltinOperator_CUSTOM;
+    sdpa_registration_.custom_name = "odml.paged_scaled_dot_product_attention";
+
+    interpreter_.AddTensors(7);
+    interpreter_.SetInputs({kPosition, kKey, kValue, kSequenceId, kQuery});
+    interpreter_.SetOutputs({kOutput});
+    TfLiteQuantization quant = {kTfLiteNoQuantization, nullptr};
+    interpreter_.SetTensorParametersReadWrite(kPosition, kTfLiteInt64, "",
+                                              {num_tokens}, quant);
+    interpreter_.SetTensorParametersReadWrite(
+        kKey, kTfLiteFloat32, "", {1, num_tokens, kNumKVHeads, kHeadDim},
+        quant);
+    interpreter_.SetTensorParametersReadWrite(
+        kValue, kTfLiteFloat32, "", {1, num_tokens, kNumKVHeads, kHeadDim},
+        quant);
+    interpreter_.SetTensorParametersReadWrite(kSequenceId, kTfLiteInt32, "",
+                                              {1}, quant);
+    interpreter_.SetTensorParametersReadWrite(
+        kQuery, kTfLiteFloat32, "", {1, num_tokens, kNumHeads, kHeadDim},
+        quant);
+    interpreter_.SetTensorParametersReadWrite(kBlockTable, kTfLiteInt32, "",
+                                              {0}, quant);
+    interpreter_.SetTensorParametersReadWrite(kOutput, kTfLiteFloat32, "", {},
+                                              quant);
+    const char* options = reinterpret_cast<const char*>(options_.data());
+    interpreter_.AddNodeWithParameters(
+        {kPosition, kKey, kValue, kSequenceId}, {kBlockTable}, options,
+        options_.size(), nullptr, &kv_cache_registration_);
+    interpreter_.AddNodeWithParameters({kQuery, kPosition, kBlockTable},
+                                       {kOutput}, options, options_.size(),
+                                       nullptr, &sdpa_registration_);
+  }
+
+  TfLiteStatus AllocateTensors() { return interpreter_.AllocateTensors(); }
+
+  TfLiteStatus Invoke(int sequence_id, const std::vector<int64_t>& positions,
+                      const std::vector<float>& keys,
+                      const std::vector<float>& values,
+                      const std::vector<float>& queries) {
+    interpreter_.typed_tensor<int32_t>(kSequenceId)[0] = sequence_id;
+    Populate(kPosition, positions);
+    Populate(kKey, keys);
+    Populate(kValue, values);
+    Populate(kQuery, queries);
+    return interpreter_.Invoke();
+  }
+
+  std::vector<int> GetBlockTable() { return Extract<int>(kBlockTable); }
+  std::vector<float> GetOutput() { return Extract<float>(kOutput); }
+  resource::PagedCacheBuffer* GetCache() {
+    return ops::custom::GetPagedKVCache(&interpreter_.primary_subgraph());
+  }
+
+ private:
+  enum {
+    kPosition,
+    kKey,
+    kValue,
+    kSequenceId,
+    kQuery,
+    kBlockTable,
+    kOutput,
+  };
+
+  template <typename T>
+  void Populate(int index, const std::vector<T>& data) {
+    TfLiteTensor* tensor = interpreter_.tensor(index);
+    ASSERT_EQ(tensor->bytes, sizeof(T) * data.size());
+    std::memcpy(tensor->data.raw, data.data(), tensor->bytes);
+  }
+
+  template <typename T>
+  std::vector<T> Extract(int index) {
+    const T* data = interpreter_.typed_tensor<T>(index);
+    return std::vector<T>(data,
+                          data + interpreter_.tensor(index)->bytes / sizeof(T));
+  }
+
+  std::vector<uint8_t> options_;
+  TfLiteRegistration kv_cache_registration_;
+  TfLiteRegistration sdpa_registration_;
+  Interpreter interpreter_;
+};
+
+// Reference causal attention of `queries` over all `keys` and `values` of a
+// sequence so far.
+std::vector<float> ReferenceAttention(const std::vector<int64_t>& positions,
+                                      const std::vector<float>& queries,
+                                      const std::vector<float>& keys,
+                                      const std::vector<float>& values) {
+  const float scale = 1 / std::sqrt(static_cast<float>(kHeadDim));
+  std::vector<float> output(queries.size());
+  for (int t = 0; t < positions.size(); ++t) {
+    for (int h = 0; h < kNumHeads; ++h) {
+      const float* q = &queries[(t * kNumHeads + h) * kHeadDim];
+      std::vector<float> weights;
+      float sum = 0;
+      for (int j = 0; j <= positions[t]; ++j) {
+        float dot = 0;
+        for (int d = 0; d < kHeadDim; ++d) dot += q[d] * keys[j * kHeadDim + d];
+        weights.push_back(std::exp(dot * scale));
+        sum += weights.back();
+      }
+      for (int j = 0; j <= positions[t]; ++j) {
+        for (int d = 0; d < kHeadDim; ++d) {
+          output[(t * kNumHeads + h) * kHeadDim + d] +=
+              weights[j] / sum * values[j * kHeadDim + d];
+        }
+      }
+    }
+  }
+  return output;
+}
+
+TEST(PagedKVCacheTest, WritesEntriesThroughBlockTable) {
+  PagedAttentionModel m(/*num_tokens=*/3);
+  ASSERT_EQ(m.AllocateTensors(), kTfLiteOk);
+  const std::vector<float> keys = {1, 2, 3, 4, 5, 6};
+  const std::vector<float> values = {-1, -2, -3, -4, -5, -6};
+  ASSERT_EQ(m.Invoke(/*sequence_id=*/0, {0, 1, 2}, keys, values,
+                     std::vector<float>(12, 1)),
+            kTfLiteOk);
+  EXPECT_THAT(m.GetBlockTable(), ElementsAre(0, 1));
+
+  resource::PagedCacheBuffer* cache = m.GetCache();
+  ASSERT_NE(cache, nullptr);
+  EXPECT_EQ(cache->GetNumEntries(0), 3);
+  EXPECT_EQ(cache->GetNumFreeBlocks(), kNumBlocks - 2);
+  for (int position = 0; position < 3; ++position) {
+    const int block = m.GetBlockTable()[position / kBlockSize];
+    const float* key = cache->GetKey(block, 0, position % kBlockSize);
+    const float* value = cache->GetValue(block, 0, position % kBlockSize);
+    EXPECT_THAT(std::vector<float>(key, key + kHeadDim),
+                ElementsAre(keys[2 * position], keys[2 * position + 1]));
+    EXPECT_THAT(std::vector<float>(value, value + kHeadDim),
+                ElementsAre(values[2 * position], values[2 * position + 1]));
+  }
+}
+
+TEST(PagedKVCacheTest, AttendsToAllPreviousEntries) {
+  const std::vector<float> keys = {1, 0, 0, 1, 1, 1};
+  const std::vector<float> values = {1, 2, 3, 4, 5, 6};
+  const std::vector<float> queries = {1, 0, 0, 1, 2, 1, 1, 2, 0, 3, 1, -1};
+  PagedAttentionModel m(/*num_tokens=*/3);
+  ASSERT_EQ(m.AllocateTensors(), kTfLiteOk);
+  ASSERT_EQ(m.Invoke(0, {0, 1, 2}, keys, values, queries), kTfLiteOk);
+  EXPECT_THAT(m.GetOutput(),
+              Pointwise(FloatNear(1e-5),
+                        ReferenceAttention({0, 1, 2}, queries, keys, values)));
+}
+
+TEST(PagedKVCacheTest, DecodesOneTokenAtATime) {
+  const std::vector<float> keys = {1, 0, 0, 1, 1, 1, -1, 2, 3, 1};
+  const std::vector<float> values = {1, 2, 3, 4, 5, 6, 7, 8, 9, 10};
+  PagedAttentionModel m(/*num_tokens=*/1);
+  ASSERT_EQ(m.AllocateTensors(), kTfLiteOk);
+  for (int position = 0; position < 5; ++position) {
+    const std::vector<float> query = {1, 2, -1, 0.5f};
+    ASSERT_EQ(m.Invoke(0, {position},
+                       {keys[2 * position], keys[2 * position + 1]},
+                       {values[2 * position], values[2 * position + 1]},
+                       query),
+              kTfLiteOk);
+    EXPECT_THAT(m.GetOutput(),
+                Pointwise(FloatNear(1e-5),
+                          ReferenceAttention({position}, query, keys, values)));
+  }
+  EXPECT_THAT(m.GetBlockTable(), ElementsAre(0, 1, 2));
+}
+
+TEST(PagedKVCacheTest, ForkedSequencesShareTheirPrefix) {
+  const std::vector<float> prefix_keys = {1, 0, 0, 1, 1, 1};
+  const std::vector<float> prefix_values = {1, 2, 3, 4, 5, 6};
+  const std::vector<float> query = {1, 2, -1, 0.5f};
+  PagedAttentionModel m(/*num_tokens=*/1);
+  ASSERT_EQ(m.AllocateTensors(), kTfLiteOk);
+  for (int position = 0; position < 3; ++position) {
+    ASSERT_EQ(m.Invoke(0, {position},
+                       {prefix_keys[2 * position],
+                        prefix_keys[2 * position + 1]},
+                       {prefix_values[2 * position],
+                        prefix_values[2 * position + 1]},
+                       query),
+              kTfLiteOk);
+  }
+  resource::PagedCacheBuffer* cache = m.GetCache();
+  ASSERT_EQ(cache->ForkSequence(0, 1, 3), kTfLiteOk);
+  EXPECT_EQ(cache->GetNumFreeBlocks(), kNumBlocks - 2);
+
+  // Both sequences continue from the shared prefix with different tokens.
+  for (int sequence_id = 0; sequence_id < 2; ++sequence_id) {
+    const std::vector<float> key = {sequence_id * 2.0f, -1};
+    const std::vector<float> value = {sequence_id * 3.0f, 7};
+    ASSERT_EQ(m.Invoke(sequence_id, {3}, key, value, query), kTfLiteOk);
+    std::vector<float> keys = prefix_keys;
+    keys.insert(keys.end(), key.begin(), key.end());
+    std::vector<float> values = prefix_values;
+    values.insert(values.end(), value.begin(), value.end());
+    EXPECT_THAT(m.GetOutput(),
+                Pointwise(FloatNear(1e-5),
+                          ReferenceAttention({3}, query, keys, values)));
+  }
+  // The sequences share the first block, and each has its own second block.
+  EXPECT_EQ((*cache->GetBlockTable(0))[0], (*cache->GetBlockTable(1))[0]);
+  EXPECT_NE((*cache->GetBlockTable(0))[1], (*cache->GetBlockTable(1))[1]);
+  EXPECT_EQ(cache->GetNumFreeBlocks(), kNumBlocks - 3);
+
+  cache->ReleaseSequence(0);
+  cache->ReleaseSequence(1);
+  EXPECT_EQ(cache->GetNumFreeBlocks(), kNumBlocks);
+}
+
+TEST(PagedKVCacheTest, FailsWhenThePoolIsExhausted) {
+  PagedAttentionModel m(/*num_tokens=*/3);
+  ASSERT_EQ(m.AllocateTensors(), kTfLiteOk);
+  const std::vector<float> keys(6, 1);
+  const std::vector<float> queries(12, 1);
+  // Every sequence takes 2 of the blocks.
+  for (int sequence_id = 0; sequence_id < kNumBlocks / 2; ++sequence_id) {
+    ASSERT_EQ(m.Invoke(sequence_id, {0, 1, 2}, keys, keys, queries),
+              kTfLiteOk);
+  }
+  EXPECT_EQ(m.Invoke(kNumBlocks / 2, {0, 1, 2}, keys, keys, queries),
+            kTfLiteError);
+  m.GetCache()->ReleaseSequence(0);
+  EXPECT_EQ(m.Invoke(kNumBlocks / 2, {0, 1, 2}, keys, keys, queries),
+            kTfLiteOk);
+}
+
+}  // namespace
+}  // namespace tflite
@@ -15,23 +15,23 @@ limitations under the License.
 
 #include <math.h>
 
+#include <algorithm>
+#include <cmath>
 #include <cstddef>
 #include <cstdint>
 #include <cstring>
 #include <limits>
+#include <vector>
 
 #include "flatbuffers/flexbuffers.h"
 #include "tensorflow/lite/c/c_api_types.h"
 #include "tensorflow/lite/core/c/common.h"
-#include "tensorflow/lite/kernels/internal/common.h"
-#include "tensorflow/lite/kernels/internal/reference/add.h"
-#include "tensorflow/lite/kernels/internal/reference/batch_matmul.h"
-#include "tensorflow/lite/kernels/internal/reference/fully_connected.h"
-#include "tensorflow/lite/kernels/internal/reference/softmax.h"
-#include "tensorflow/lite/kernels/internal/reference/transpose.h"
-#include "tensorflow/lite/kernels/internal/runtime_shape.h"
+#include "tensorflow/lite/core/subgraph.h"
+#include "tensorflow/lite/experimental/genai/genai_ops.h"
+#include "tensorflow/lite/experimental/resource/paged_cache_buffer.h"
+#include "tensorflow/lite/kernels/cpu_backend_context.h"
+#include "tensorflow/lite/kernels/cpu_backend_threadpool.h"
 #include "tensorflow/lite/kernels/internal/tensor_ctypes.h"
-#include "tensorflow/lite/kernels/internal/types.h"
 #include "tensorflow/lite/kernels/kernel_util.h"
 
 namespace tflite {
@@ -45,25 +45,33 @@ static const int kValueTensor = 2;
 static const int kAttentionMaskTensor = 3;
 static const int kOutputTensor = 0;
 
-static const int kNumTempTensors = 8;
-static const int kTransposeQueryTempTensorIndex = 0;
-static const int kTransposeKeyTempTensorIndex = 1;
-static const int kMatMul1TempTensorIndex = 2;
-static const int kAddTempTensorIndex = 3;
-static const int kTransposeValueTempTensorIndex = 4;
-static const int kMatMul2TempTensorIndex = 5;
-static const int kReshape1TempTensorIndex = 6;
-static const int kReshape2TempTensorIndex = 7;
+// The attention is computed by tiles of query rows and key/value entries
+// with an online softmax, so that the scores are never materialized for the
+// whole context. A key/value tile of kKeyValueTileSize entries of a head is
+// reused by the kQueryTileSize query rows of the tile while it is in cache.
+static const int kQueryTileSize = 8;
+static const int kKeyValueTileSize = 64;
+static const int kScratchTensorIndex = 0;
 
 struct OpData {
   float scale;
   int scratch_tensor_index;
+  // The number of tasks the scratch tensor has room for.
+  int max_num_tasks;
 };
 
+// The number of floats of scratch space one task needs: the scores of a tile,
+// and the output accumulator, running max and running sum of its query rows.
+inline int ScratchSizePerTask(int head_dim) {
+  return kQueryTileSize * kKeyValueTileSize + kQueryTileSize * head_dim +
+         2 * kQueryTileSize;
+}
+
 void* SDPAInit(TfLiteContext* context, const char* buffer, size_t length) {
   OpData* op_data = new OpData();
   op_data->scale = 0.0f;
-  context->AddTensors(context, kNumTempTensors, &op_data->scratch_tensor_index);
+  op_data->max_num_tasks = 0;
+  context->AddTensors(context, 1, &op_data->scratch_tensor_index);
   return op_data;
 }
 
@@ -89,6 +97,19 @@ TfLiteStatus SDPAPrepare(TfLiteContext* context, TfLiteNode* node) {
   TF_LITE_ENSURE_EQ(context, NumDimensions(v_tensor),
                     NumDimensions(mask_tensor));
   TF_LITE_ENSURE_EQ(context, NumDimensions(mask_tensor), 4);
+  // q: (B, T, N, H), k and v: (B, S, N_kv, H), mask broadcastable to
+  // (B, N, T, S). N_kv == N for mha, divides N for gqa, and is 1 for mqa.
+  TF_LITE_ENSURE(context, HaveSameShapes(k_tensor, v_tensor));
+  TF_LITE_ENSURE_EQ(context, q_tensor->dims->data[0], k_tensor->dims->data[0]);
+  TF_LITE_ENSURE_EQ(context, q_tensor->dims->data[3], k_tensor->dims->data[3]);
+  TF_LITE_ENSURE_EQ(context,
+                    q_tensor->dims->data[2] % k_tensor->dims->data[2], 0);
+  const int mask_dims[4] = {q_tensor->dims->data[0], q_tensor->dims->data[2],
+                            q_tensor->dims->data[1], k_tensor->dims->data[1]};
+  for (int i = 0; i < 4; ++i) {
+    TF_LITE_ENSURE(context, mask_tensor->dims->data[i] == 1 ||
+                                mask_tensor->dims->data[i] == mask_dims[i]);
+  }
 
   // Get custom op params
   const uint8_t* buffer =
@@ -102,219 +123,171 @@ TfLiteStatus SDPAPrepare(TfLiteContext* context, TfLiteNode* node) {
   if (op_data->scale == 0.0f)
     op_data->scale = 1 / sqrt(q_tensor->dims->data[3]);
 
+  // Temp tensor for the tiles of each task.
   TfLiteIntArrayFree(node->temporaries);
-  node->temporaries = TfLiteIntArrayCreate(kNumTempTensors);
-  bool mqa = k_tensor->dims->data[2] == 1;
-
-  // Temp tensor for Transposed Q;
-  {
-    node->temporaries->data[kTransposeQueryTempTensorIndex] =
-        op_data->scratch_tensor_index + kTransposeQueryTempTensorIndex;
-    TfLiteTensor* scratch_buffer;
-    TF_LITE_ENSURE_OK(context,
-                      GetTemporarySafe(context, node,
-                                       /*index=*/kTransposeQueryTempTensorIndex,
-                                       &scratch_buffer));
-    TfLiteIntArray* scratch_buffer_size = TfLiteIntArrayCreate(4);
-    for (int i = 0; i < 4; ++i) {
-      scratch_buffer_size->data[i] = q_tensor->dims->data[i];
-    }
-    // Swap middle two dimensions.
-    scratch_buffer_size->data[1] = q_tensor->dims->data[2];
-    scratch_buffer_size->data[2] = q_tensor->dims->data[1];
-
-    scratch_buffer->type = kTfLiteFloat32;
-    scratch_buffer->allocation_type = kTfLiteArenaRw;
-    TF_LITE_ENSURE_OK(context, context->ResizeTensor(context, scratch_buffer,
-                                                     scratch_buffer_size));
-  }
-
-  // Temp tensor for Transposed K;
-  {
-    node->temporaries->data[kTransposeKeyTempTensorIndex] =
-        op_data->scratch_tensor_index + kTransposeKeyTempTensorIndex;
-    TfLiteTensor* scratch_buffer;
-    TF_LITE_ENSURE_OK(context,
-                      GetTemporarySafe(context, node,
-                                       /*index=*/kTransposeKeyTempTensorIndex,
-                                       &scratch_buffer));
-    TfLiteIntArray* scratch_buffer_size = TfLiteIntArrayCreate(4);
-    for (int i = 0; i < 4; ++i) {
-      scratch_buffer_size->data[i] = k_tensor->dims->data[i];
-    }
-    // Swap to middle two dimensions.
-    scratch_buffer_size->data[1] = k_tensor->dims->data[2];
-    scratch_buffer_size->data[2] = k_tensor->dims->data[1];
-
-    scratch_buffer->type = kTfLiteFloat32;
-    scratch_buffer->allocation_type = kTfLiteArenaRw;
-    TF_LITE_ENSURE_OK(context, context->ResizeTensor(context, scratch_buffer,
-                                                     scratch_buffer_size));
-  }
+  node->temporaries = TfLiteIntArrayCreate(1);
+  node->temporaries->data[kScratchTensorIndex] = op_data->scratch_tensor_index;
+  TfLiteTensor* scratch_buffer;
+  TF_LITE_ENSURE_OK(context,
+                    GetTemporarySafe(context, node,
+                                     /*index=*/kScratchTensorIndex,
+                                     &scratch_buffer));
+  op_data->max_num_tasks =
+      CpuBackendContext::GetFromContext(context)->max_num_threads();
+  TfLiteIntArray* scratch_buffer_size = TfLiteIntArrayCreate(2);
+  scratch_buffer_size->data[0] = op_data->max_num_tasks;
+  scratch_buffer_size->data[1] = ScratchSizePerTask(q_tensor->dims->data[3]);
+  scratch_buffer->type = kTfLiteFloat32;
+  scratch_buffer->allocation_type = kTfLiteArenaRw;
+  return context->ResizeTensor(context, scratch_buffer, scratch_buffer_size);
+}
 
-  TfLiteIntArray* add_broadcast_shape = nullptr;
-  // Temp tensor for Matmul1 output;
-  {
-    node->temporaries->data[kMatMul1TempTensorIndex] =
-        op_data->scratch_tensor_index + kMatMul1TempTensorIndex;
-    TfLiteTensor* scratch_buffer;
-    TF_LITE_ENSURE_OK(
-        context,
-        GetTemporarySafe(context, node,
-                         /*index=*/kMatMul1TempTensorIndex, &scratch_buffer));
-    TfLiteIntArray* scratch_buffer_size = TfLiteIntArrayCreate(4);
-    // mha/gqa: [permute_q[0], permute_q[1], permute_q[2], permute_k[2]]
-    int matmul_out_shape[4] = {q_tensor->dims->data[0], q_tensor->dims->data[2],
-                               q_tensor->dims->data[1],
-                               k_tensor->dims->data[1]};
-    for (int i = 0; i < 4; ++i) {
-      scratch_buffer_size->data[i] = matmul_out_shape[i];
-    }
+void SDPAFree(TfLiteContext* context, void* buffer) {
+  delete static_cast<OpData*>(buffer);
+}
 
-    scratch_buffer->type = kTfLiteFloat32;
-    scratch_buffer->allocation_type = kTfLiteArenaRw;
-    TF_LITE_ENSURE_OK(context, context->ResizeTensor(context, scratch_buffer,
-                                                     scratch_buffer_size));
-    // get dims from attention_mask, matmul1_out for add broadcast
-    CalculateShapeForBroadcast(context, mask_tensor, scratch_buffer,
-                               &add_broadcast_shape);
-  }
+struct AttentionParams {
+  const float* query;
+  const float* key;
+  const float* value;
+  const float* mask;
+  float* output;
+  int batch_size;
+  int num_queries;
+  int num_entries;
+  int num_heads;
+  int num_kv_heads;
+  int head_dim;
+  // Strides of the mask for (B, N, T, S), 0 for the broadcast dimensions.
+  int mask_strides[4];
+  float scale;
+};
 
-  // Temp tensor for add output;
-  int add_out_shape[4];
-  {
-    node->temporaries->data[kAddTempTensorIndex] =
-        op_data->scratch_tensor_index + kAddTempTensorIndex;
-    TfLiteTensor* scratch_buffer;
-    TF_LITE_ENSURE_OK(context, GetTemporarySafe(context, node,
-                                                /*index=*/kAddTempTensorIndex,
-                                                &scratch_buffer));
-    TfLiteIntArray* scratch_buffer_size = add_broadcast_shape;
-    for (int i = 0; i < 4; ++i) {
-      add_out_shape[i] = scratch_buffer_size->data[i];
+// Computes the attention of the query rows [`t_begin`, `t_end`) of head `h`
+// of batch `b`.
+void AttendQueryTile(const AttentionParams& p, int b, int h, int t_begin,
+                     int t_end, float* scratch) {
+  const int num_rows = t_end - t_begin;
+  const int head_dim = p.head_dim;
+  float* scores = scratch;
+  float* acc = scores + kQueryTileSize * kKeyValueTileSize;
+  float* row_max = acc + kQueryTileSize * head_dim;
+  float* row_sum = row_max + kQueryTileSize;
+  std::fill(acc, acc + num_rows * head_dim, 0.0f);
+  std::fill(row_max, row_max + num_rows,
+            -std::numeric_limits<float>::infinity());
+  std::fill(row_sum, row_sum + num_rows, 0.0f);
+
+  const int kv_head = h / (p.num_heads / p.num_kv_heads);
+  const int q_stride = p.num_heads * head_dim;
+  const int kv_stride = p.num_kv_heads * head_dim;
+  const float* q_base =
+      p.query + (static_cast<size_t>(b) * p.num_queries * p.num_heads + h) *
+                    head_dim;
+  const float* k_base =
+      p.key + (static_cast<size_t>(b) * p.num_entries * p.num_kv_heads +
+               kv_head) *
+                  head_dim;
+  const float* v_base =
+      p.value + (static_cast<size_t>(b) * p.num_entries * p.num_kv_heads +
+                 kv_head) *
+                    head_dim;
+  const float* mask_base =
+      p.mask + b * p.mask_strides[0] + h * p.mask_strides[1];
+
+  for (int s_begin = 0; s_begin < p.num_entries;
+       s_begin += kKeyValueTileSize) {
+    const int s_end = std::min(s_begin + kKeyValueTileSize, p.num_entries);
+    const int num_cols = s_end - s_begin;
+    for (int r = 0; r < num_rows; ++r) {
+      const int t = t_begin + r;
+      const float* q = q_base + static_cast<size_t>(t) * q_stride;
+      const float* mask_row = mask_base + t * p.mask_strides[2];
+      float* score_row = scores + r * kKeyValueTileSize;
+      // logits = scale * q . k + mask. Masked out entries are skipped, so
+      // that causal masking saves the work of the upper triangle.
+      float tile_max = -std::numeric_limits<float>::infinity();
+      for (int j = 0; j < num_cols; ++j) {
+        const int s = s_begin + j;
+        const float mask_value = mask_row[s * p.mask_strides[3]];
+        if (mask_value == -std::numeric_limits<float>::infinity()) {
+          score_row[j] = mask_value;
+          continue;
+        }
+        const float* k = k_base + static_cast<size_t>(s) * kv_stride;
+        float dot = 0.0f;
+        for (int d = 0; d < head_dim; ++d) {
+          dot += q[d] * k[d];
+        }
+        score_row[j] = dot * p.scale + mask_value;
+        tile_max = std::max(tile_max, score_row[j]);
+      }
+      if (tile_max == -std::numeric_limits<float>::infinity()) continue;
+
+      // Rescale what was accumulated for the previous tiles to the new max.
+      const float new_max = std::max(row_max[r], tile_max);
+      const float correction = std::exp(row_max[r] - new_max);
+      row_max[r] = new_max;
+      float* out = acc + r * head_dim;
+      row_sum[r] *= correction;
+      for (int d = 0; d < head_dim; ++d) {
+        out[d] *= correction;
+      }
+      for (int j = 0; j < num_cols; ++j) {
+        const float weight = std::exp(score_row[j] - new_max);
+        if (weight == 0.0f) continue;
+        row_sum[r] += weight;
+        const float* v =
+            v_base + static_cast<size_t>(s_begin + j) * kv_stride;
+        for (int d = 0; d < head_dim; ++d) {
+          out[d] += weight * v[d];
+        }
+      }
     }
-
-    scratch_buffer->type = kTfLiteFloat32;
-    scratch_buffer->allocation_type = kTfLiteArenaRw;
-    TF_LITE_ENSURE_OK(context, context->ResizeTensor(context, scratch_buffer,
-                                                     scratch_buffer_size));
-  }
-
-  // Temp tensor for Transposed V;
-  {
-    node->temporaries->data[kTransposeValueTempTensorIndex] =
-        op_data->scratch_tensor_index + kTransposeValueTempTensorIndex;
-    TfLiteTensor* scratch_buffer;
-    TF_LITE_ENSURE_OK(context,
-                      GetTemporarySafe(context, node,
-                                       /*index=*/kTransposeValueTempTensorIndex,
-                                       &scratch_buffer));
-    TfLiteIntArray* scratch_buffer_size = TfLiteIntArrayCreate(4);
-    // Swap to {0, 2, 3, 1} dimensions.
-    scratch_buffer_size->data[0] = v_tensor->dims->data[0];
-    scratch_buffer_size->data[1] = v_tensor->dims->data[2];
-    scratch_buffer_size->data[2] = v_tensor->dims->data[3];
-    scratch_buffer_size->data[3] = v_tensor->dims->data[1];
-
-    scratch_buffer->type = kTfLiteFloat32;
-    scratch_buffer->allocation_type = kTfLiteArenaRw;
-    TF_LITE_ENSURE_OK(context, context->ResizeTensor(context, scratch_buffer,
-                                                     scratch_buffer_size));
-  }
-
-  // Temp tensor for Matmul2 output;
-  {
-    node->temporaries->data[kMatMul2TempTensorIndex] =
-        op_data->scratch_tensor_index + kMatMul2TempTensorIndex;
-    TfLiteTensor* scratch_buffer;
-    TF_LITE_ENSURE_OK(
-        context,
-        GetTemporarySafe(context, node,
-                         /*index=*/kMatMul2TempTensorIndex, &scratch_buffer));
-    TfLiteIntArray* scratch_buffer_size = TfLiteIntArrayCreate(4);
-    // logits_out_shape = add_out_shape
-    // mha/gqa: [logits_out[0], logits_out[1], logits_out[2], permute_v[2]]
-    scratch_buffer_size->data[0] = add_out_shape[0];
-    scratch_buffer_size->data[1] = add_out_shape[1];
-    scratch_buffer_size->data[2] = add_out_shape[2];
-    scratch_buffer_size->data[3] = v_tensor->dims->data[3];
-
-    scratch_buffer->type = kTfLiteFloat32;
-    scratch_buffer->allocation_type = kTfLiteArenaRw;
-    TF_LITE_ENSURE_OK(context, context->ResizeTensor(context, scratch_buffer,
-                                                     scratch_buffer_size));
   }
 
-  // Temp tensor for Reshape K / Transpose Q;
-  {
-    node->temporaries->data[kReshape1TempTensorIndex] =
-        op_data->scratch_tensor_index + kReshape1TempTensorIndex;
-    TfLiteTensor* scratch_buffer;
-    TF_LITE_ENSURE_OK(
-        context,
-        GetTemporarySafe(context, node,
-                         /*index=*/kReshape1TempTensorIndex, &scratch_buffer));
-    TfLiteIntArray* scratch_buffer_size;
-    if (mqa)
-      scratch_buffer_size = TfLiteIntArrayCreate(2);
-    else
-      scratch_buffer_size = TfLiteIntArrayCreate(4);
-    if (mqa) {
-      scratch_buffer_size->data[0] = k_tensor->dims->data[1];
-      scratch_buffer_size->data[1] = k_tensor->dims->data[3];
-    } else {
-      scratch_buffer_size->data[0] = q_tensor->dims->data[0];
-      scratch_buffer_size->data[1] = q_tensor->dims->data[2];
-      scratch_buffer_size->data[2] = q_tensor->dims->data[3];
-      scratch_buffer_size->data[3] = q_tensor->dims->data[1];
+  for (int r = 0; r < num_rows; ++r) {
+    float* out =
+        p.output + (static_cast<size_t>(b) * p.num_queries * p.num_heads +
+                    static_cast<size_t>(t_begin + r) * p.num_heads + h) *
+                       head_dim;
+    // A row without any unmasked entry has no attention weights.
+    const float inv_sum = row_sum[r] > 0.0f ? 1.0f / row_sum[r] : 0.0f;
+    for (int d = 0; d < head_dim; ++d) {
+      out[d] = acc[r * head_dim + d] * inv_sum;
     }
-
-    scratch_buffer->type = kTfLiteFloat32;
-    scratch_buffer->allocation_type = kTfLiteArenaRw;
-    TF_LITE_ENSURE_OK(context, context->ResizeTensor(context, scratch_buffer,
-                                                     scratch_buffer_size));
   }
+}
 
-  // Temp tensor for Reshape V / Add_out (softmax_out);
-  {
-    node->temporaries->data[kReshape2TempTensorIndex] =
-        op_data->scratch_tensor_index + kReshape2TempTensorIndex;
-    TfLiteTensor* scratch_buffer;
-    TF_LITE_ENSURE_OK(
-        context,
-        GetTemporarySafe(context, node,
-                         /*index=*/kReshape2TempTensorIndex, &scratch_buffer));
-    TfLiteIntArray* scratch_buffer_size;
-    if (mqa)
-      scratch_buffer_size = TfLiteIntArrayCreate(2);
-    else
-      scratch_buffer_size = TfLiteIntArrayCreate(4);
-    if (mqa) {
-      scratch_buffer_size->data[0] = v_tensor->dims->data[3];
-      scratch_buffer_size->data[1] = v_tensor->dims->data[1];
-    } else {
-      scratch_buffer_size->data[0] = add_out_shape[0];
-      scratch_buffer_size->data[1] = add_out_shape[1];
-      scratch_buffer_size->data[2] = add_out_shape[3];
-      scratch_buffer_size->data[3] = add_out_shape[2];
+// Computes the query tiles [`begin`, `end`) of all batches and heads.
+struct AttentionTask : cpu_backend_threadpool::Task {
+  AttentionTask(const AttentionParams& params, int begin, int end,
+                float* scratch)
+      : params(params), begin(begin), end(end), scratch(scratch) {}
+
+  void Run() override {
+    const int num_query_tiles =
+        (params.num_queries + kQueryTileSize - 1) / kQueryTileSize;
+    for (int i = begin; i < end; ++i) {
+      const int tile = i % num_query_tiles;
+      const int h = (i / num_query_tiles) % params.num_heads;
+      const int b = i / num_query_tiles / params.num_heads;
+      const int t_begin = tile * kQueryTileSize;
+      const int t_end =
+          std::min(t_begin + kQueryTileSize, params.num_queries);
+      AttendQueryTile(params, b, h, t_begin, t_end, scratch);
     }
-
-    scratch_buffer->type = kTfLiteFloat32;
-    scratch_buffer->allocation_type = kTfLiteArenaRw;
-    TF_LITE_ENSURE_OK(context, context->ResizeTensor(context, scratch_buffer,
-                                                     scratch_buffer_size));
   }
 
-  return kTfLiteOk;
-}
-
-void SDPAFree(TfLiteContext* context, void* buffer) {
-  delete static_cast<OpData*>(buffer);
-}
+  const AttentionParams& params;
+  int begin;
+  int end;
+  float* scratch;
+};
 
 TfLiteStatus SDPAEval(TfLiteContext* context, TfLiteNode* node) {
   /*
-  Simple implementation of Scaled Dot Product Attention.
+  Tiled implementation of Scaled Dot Product Attention.
   Takes query_proj, key_proj, value_proj, mask tensors as inputs, and
   outputs the attention result.
 
@@ -328,225 +301,237 @@ TfLiteStatus SDPAEval(TfLiteContext* context, TfLiteNode* node) {
   const TfLiteTensor* query_tensor;
   TF_LITE_ENSURE_OK(context,
                     GetInputSafe(context, node, kQueryTensor, &query_tensor));
-  auto query_shape = GetTensorShape(query_tensor);
-  auto query_data = GetTensorData<float>(query_tensor);
   const TfLiteTensor* key_tensor;
   TF_LITE_ENSURE_OK(context,
                     GetInputSafe(context, node, kKeyTensor, &key_tensor));
-  auto key_shape = GetTensorShape(key_tensor);
-  auto key_data = GetTensorData<float>(key_tensor);
   const TfLiteTensor* value_tensor;
   TF_LITE_ENSURE_OK(context,
                     GetInputSafe(context, node, kValueTensor, &value_tensor));
-  auto value_shape = GetTensorShape(value_tensor);
-  auto value_data = GetTensorData<float>(value_tensor);
   const TfLiteTensor* attention_mask_tensor;
   TF_LITE_ENSURE_OK(context, GetInputSafe(context, node, kAttentionMaskTensor,
                                           &attention_mask_tensor));
-  auto attention_mask_shape = GetTensorShape(attention_mask_tensor);
-  auto attention_mask_data = GetTensorData<float>(attention_mask_tensor);
   TfLiteTensor* output_tensor;
   TF_LITE_ENSURE_OK(
       context, GetOutputSafe(context, node, kOutputTensor, &output_tensor));
-  auto output_shape = GetTensorShape(output_tensor);
-  auto output_data = GetTensorData<float>(output_tensor);
-
-  // temporaries
-  TfLiteTensor* transpose_q_out_tensor;
-  TF_LITE_ENSURE_OK(
-      context,
-      GetTemporarySafe(context, node, /*index=*/kTransposeQueryTempTensorIndex,
-                       &transpose_q_out_tensor));
-  auto transpose_q_out_shape = GetTensorShape(transpose_q_out_tensor);
-  auto transpose_q_out_data = GetTensorData<float>(transpose_q_out_tensor);
-  TfLiteTensor* transpose_k_out_tensor;
-  TF_LITE_ENSURE_OK(
-      context,
-      GetTemporarySafe(context, node, /*index=*/kTransposeKeyTempTensorIndex,
-                       &transpose_k_out_tensor));
-  auto transpose_k_out_shape = GetTensorShape(transpose_k_out_tensor);
-  auto transpose_k_out_data = GetTensorData<float>(transpose_k_out_tensor);
-  TfLiteTensor* matmul1_out_tensor;
-  TF_LITE_ENSURE_OK(context, GetTemporarySafe(context, node,
-                                              /*index=*/kMatMul1TempTensorIndex,
-                                              &matmul1_out_tensor));
-  auto matmul1_out_shape = GetTensorShape(matmul1_out_tensor);
-  auto matmul1_out_data = GetTensorData<float>(matmul1_out_tensor);
-  TfLiteTensor* add_out_tensor;
-  TF_LITE_ENSURE_OK(
-      context, GetTemporarySafe(context, node, /*index=*/kAddTempTensorIndex,
-                                &add_out_tensor));
-  auto add_out_shape = GetTensorShape(add_out_tensor);
-  auto add_out_data = GetTensorData<float>(add_out_tensor);
-  TfLiteTensor* transpose_v_out_tensor;
-  TF_LITE_ENSURE_OK(
-      context,
-      GetTemporarySafe(context, node, /*index=*/kTransposeValueTempTensorIndex,
-                       &transpose_v_out_tensor));
-  auto transpose_v_out_shape = GetTensorShape(transpose_v_out_tensor);
-  auto transpose_v_out_data = GetTensorData<float>(transpose_v_out_tensor);
-  TfLiteTensor* matmul2_out_tensor;
-  TF_LITE_ENSURE_OK(context, GetTemporarySafe(context, node,
-                                              /*index=*/kMatMul2TempTensorIndex,
-                                              &matmul2_out_tensor));
-  auto matmul2_out_shape = GetTensorShape(matmul2_out_tensor);
-  auto matmul2_out_data = GetTensorData<float>(matmul2_out_tensor);
-  TfLiteTensor* reshape_k_or_q_out_tensor;
-  TF_LITE_ENSURE_OK(
-      context,
-      GetTemporarySafe(context, node, /*index=*/kReshape1TempTensorIndex,
-                       &reshape_k_or_q_out_tensor));
-  auto reshape_k_or_q_out_shape = GetTensorShape(reshape_k_or_q_out_tensor);
-  auto reshape_k_or_q_out_data =
-      GetTensorData<float>(reshape_k_or_q_out_tensor);
-  TfLiteTensor* reshape_v_or_add_out_tensor;
-  TF_LITE_ENSURE_OK(
-      context,
-      GetTemporarySafe(context, node, /*index=*/kReshape2TempTensorIndex,
-                       &reshape_v_or_add_out_tensor));
-  auto reshape_v_or_add_out_shape = GetTensorShape(reshape_v_or_add_out_tensor);
-  auto reshape_v_or_add_out_data =
-      GetTensorData<float>(reshape_v_or_add_out_tensor);
+  TfLiteTensor* scratch_tensor;
+  TF_LITE_ENSURE_OK(context,
+                    GetTemporarySafe(context, node,
+                                     /*index=*/kScratchTensorIndex,
+                                     &scratch_tensor));
+  TF_LITE_ENSURE_EQ(context, NumElements(output_tensor),
+                    NumElements(query_tensor));
 
   OpData* op_data = reinterpret_cast<OpData*>(node->user_data);
 
-  bool mqa = key_tensor->dims->data[2] == 1;
-
-  // scale * q
-  float scale = op_data->scale;
-  int flat_size = query_shape.FlatSize();
-  float output_min = -std::numeric_limits<float>::infinity();
-  float output_max = std::numeric_limits<float>::infinity();
-  for (int i = 0; i < flat_size; ++i) {
-    query_tensor->data.f[i] = ActivationFunctionWithMinMax(
-        query_tensor->data.f[i] * scale, output_min, output_max);
+  AttentionParams params;
+  params.query = GetTensorData<float>(query_tensor);
+  params.key = GetTensorData<float>(key_tensor);
+  params.value = GetTensorData<float>(value_tensor);
+  params.mask = GetTensorData<float>(attention_mask_tensor);
+  params.output = GetTensorData<float>(output_tensor);
+  params.batch_size = query_tensor->dims->data[0];
+  params.num_queries = query_tensor->dims->data[1];
+  params.num_heads = query_tensor->dims->data[2];
+  params.head_dim = query_tensor->dims->data[3];
+  params.num_entries = key_tensor->dims->data[1];
+  params.num_kv_heads = key_tensor->dims->data[2];
+  params.scale = op_data->scale;
+  int stride = 1;
+  for (int i = 3; i >= 0; --i) {
+    const int dim = attention_mask_tensor->dims->data[i];
+    params.mask_strides[i] = dim == 1 ? 0 : stride;
+    stride *= dim;
   }
 
-  // permute q {0, 2, 1, 3}
-  tflite::TransposeParams transpose_q_params;
-  transpose_q_params.perm_count = 4;
-  transpose_q_params.perm[0] = 0;
-  transpose_q_params.perm[1] = 2;
-  transpose_q_params.perm[2] = 1;
-  transpose_q_params.perm[3] = 3;
-  reference_ops::Transpose(transpose_q_params, query_shape, query_data,
-                           transpose_q_out_shape, transpose_q_out_data);
-
-  // permute k {0, 2, 1, 3}
-  tflite::TransposeParams transpose_k_params;
-  transpose_k_params.perm_count = 4;
-  transpose_k_params.perm[0] = 0;
-  transpose_k_params.perm[1] = 2;
-  transpose_k_params.perm[2] = 1;
-  transpose_k_params.perm[3] = 3;
-  reference_ops::Transpose(transpose_k_params, key_shape, key_data,
-                           transpose_k_out_shape, transpose_k_out_data);
-
-  // reshape k for MQA, or transpose q for MHA
-  if (mqa) {
-    TF_LITE_ENSURE_EQ(context, transpose_k_out_tensor->bytes,
-                      reshape_k_or_q_out_tensor->bytes);
-    memcpy(reshape_k_or_q_out_tensor->data.data,
-           transpose_k_out_tensor->data.data, transpose_k_out_tensor->bytes);
-  } else {
-    // permute q2 {0, 1, 3, 2}
-    tflite::TransposeParams transpose_q2_params;
-    transpose_q2_params.perm_count = 4;
-    transpose_q2_params.perm[0] = 0;
-    transpose_q2_params.perm[1] = 1;
-    transpose_q2_params.perm[2] = 3;
-    transpose_q2_params.perm[3] = 2;
-    reference_ops::Transpose(transpose_q2_params, transpose_q_out_shape,
-                             transpose_q_out_data, reshape_k_or_q_out_shape,
-                             reshape_k_or_q_out_data);
+  const int num_query_tiles =
+      (params.num_queries + kQueryTileSize - 1) / kQueryTileSize;
+  const int num_work_items =
+      params.batch_size * params.num_heads * num_query_tiles;
+  CpuBackendContext* cpu_backend_context =
+      CpuBackendContext::GetFromContext(context);
+  const int num_tasks =
+      std::min({cpu_backend_context->max_num_threads(),
+                op_data->max_num_tasks, num_work_items});
+  float* scratch = GetTensorData<float>(scratch_tensor);
+  const int scratch_size = ScratchSizePerTask(params.head_dim);
+  if (num_tasks <= 1) {
+    AttentionTask(params, 0, num_work_items, scratch).Run();
+    return kTfLiteOk;
   }
-
-  // mqa FC (q, squeezed_k)
-  // mha BMM(q, k) transpose_b = true
-  if (mqa) {
-    tflite::FullyConnectedParams fc_params;
-    fc_params.float_activation_min = output_min;
-    fc_params.float_activation_max = output_max;
-    reference_ops::FullyConnected(
-        fc_params, transpose_q_out_shape, transpose_q_out_data,
-        reshape_k_or_q_out_shape, reshape_k_or_q_out_data, RuntimeShape(),
-        nullptr, matmul1_out_shape, matmul1_out_data);
-  } else {
-    // pass rhs first (this is why we transpose q above)
-    reference_ops::BatchMatMul(
-        transpose_k_out_shape, transpose_k_out_data, reshape_k_or_q_out_shape,
-        reshape_k_or_q_out_data, matmul1_out_shape, matmul1_out_data);
+  std::vector<AttentionTask> tasks;
+  tasks.reserve(num_tasks);
+  int begin = 0;
+  for (int i = 0; i < num_tasks; ++i) {
+    // Spread the remainder over the first tasks.
+    const int end = begin + num_work_items / num_tasks +
+                    (i < num_work_items % num_tasks ? 1 : 0);
+    tasks.emplace_back(params, begin, end, scratch + i * scratch_size);
+    begin = end;
   }
+  cpu_backend_threadpool::Execute(tasks.size(), tasks.data(),
+                                  cpu_backend_context);
+  return kTfLiteOk;
+}
 
-  // add matmul_out + mask
-  tflite::ArithmeticParams add_params;
-  SetActivationParams(output_min, output_max, &add_params);
-  reference_ops::BroadcastAdd6DSlow(
-      add_params, attention_mask_shape, attention_mask_data, matmul1_out_shape,
-      matmul1_out_data, add_out_shape, add_out_data);
-
-  // softmax, can do in-place
-  tflite::SoftmaxParams softmax_params;
-  softmax_params.beta = 1.0f;
-  reference_ops::Softmax(softmax_params, add_out_shape, add_out_data,
-                         add_out_shape, add_out_data);
-
-  // permute v {0, 2, 3, 1}
-  tflite::TransposeParams transpose_v_params;
-  transpose_v_params.perm_count = 4;
-  transpose_v_params.perm[0] = 0;
-  transpose_v_params.perm[1] = 2;
-  transpose_v_params.perm[2] = 3;
-  transpose_v_params.perm[3] = 1;
-  reference_ops::Transpose(transpose_v_params, value_shape, value_data,
-                           transpose_v_out_shape, transpose_v_out_data);
-
-  // reshape v for MQA, or add_out (softmax_out)
-  if (mqa) {
-    TF_LITE_ENSURE_EQ(context, transpose_v_out_tensor->bytes,
-                      reshape_v_or_add_out_tensor->bytes);
-    memcpy(reshape_v_or_add_out_tensor->data.data,
-           transpose_v_out_tensor->data.data, transpose_v_out_tensor->bytes);
-  } else {
-    // permute softmax_out {0, 1, 3, 2}
-    tflite::TransposeParams transpose_softmax_out_params;
-    transpose_softmax_out_params.perm_count = 4;
-    transpose_softmax_out_params.perm[0] = 0;
-    transpose_softmax_out_params.perm[1] = 1;
-    transpose_softmax_out_params.perm[2] = 3;
-    transpose_softmax_out_params.perm[3] = 2;
-    reference_ops::Transpose(transpose_softmax_out_params, add_out_shape,
-                             add_out_data, reshape_v_or_add_out_shape,
-                             reshape_v_or_add_out_data);
-  }
+// Scaled dot product attention over the paged KV cache written by the
+// PAGED_KV_CACHE op of the same layer. Every query attends to the cache
+// entries of its sequence up to and including its own position.
+//
+// Inputs: query (float32, [1, T, N, H]), position of each query (int64, [T])
+// and the block table of the sequence (int32, [num_blocks]).
+// Output: the attention result (float32, [1, T, N, H]).
 
-  // mqa FC (softmax_out, squeezed_v)
-  // mha BMM(softmax_out, v) transpose_b = true
-  if (mqa) {
-    tflite::FullyConnectedParams fc_params;
-    fc_params.float_activation_min = output_min;
-    fc_params.float_activation_max = output_max;
-    reference_ops::FullyConnected(fc_params, add_out_shape, add_out_data,
-                                  reshape_v_or_add_out_shape,
-                                  reshape_v_or_add_out_data, RuntimeShape(),
-                                  nullptr, matmul2_out_shape, matmul2_out_data);
-  } else {
-    // pass rhs first (this is why we transpose add_out above)
-    reference_ops::BatchMatMul(
-        transpose_v_out_shape, transpose_v_out_data, reshape_v_or_add_out_shape,
-        reshape_v_or_add_out_data, matmul2_out_shape, matmul2_out_data);
-  }
+static const int kPagedQueryTensor = 0;
+static const int kPagedPositionTensor = 1;
+static const int kPagedBlockTableTensor = 2;
 
-  // permute out {0, 2, 1, 3}
-  tflite::TransposeParams transpose_out_params;
-  transpose_out_params.perm_count = 4;
-  transpose_out_params.perm[0] = 0;
-  transpose_out_params.perm[1] = 2;
-  transpose_out_params.perm[2] = 1;
-  transpose_out_params.perm[3] = 3;
-  reference_ops::Transpose(transpose_out_params, matmul2_out_shape,
-                           matmul2_out_data, output_shape, output_data);
+struct PagedOpData {
+  float scale;
+  int layer_index;
+  // Scratch space for the attention weights of one query head.
+  std::vector<float> logits;
+};
 
+void* PagedSDPAInit(TfLiteContext* context, const char* buffer,
+                    size_t length) {
+  PagedOpData* op_data = new PagedOpData();
+  op_data->scale = 0.0f;
+  op_data->layer_index = -1;
+  return op_data;
+}
+
+TfLiteStatus PagedSDPAPrepare(TfLiteContext* context, TfLiteNode* node) {
+  TF_LITE_ENSURE_EQ(context, NumInputs(node), 3);
+  TF_LITE_ENSURE_EQ(context, NumOutputs(node), 1);
+  PagedOpData* op_data = reinterpret_cast<PagedOpData*>(node->user_data);
+
+  const TfLiteTensor* q_tensor;
+  TF_LITE_ENSURE_OK(context,
+                    GetInputSafe(context, node, kPagedQueryTensor, &q_tensor));
+  const TfLiteTensor* position_tensor;
+  TF_LITE_ENSURE_OK(context, GetInputSafe(context, node, kPagedPositionTensor,
+                                          &position_tensor));
+  const TfLiteTensor* block_table_tensor;
+  TF_LITE_ENSURE_OK(context, GetInputSafe(context, node, kPagedBlockTableTensor,
+                                          &block_table_tensor));
+  TF_LITE_ENSURE_EQ(context, q_tensor->type, kTfLiteFloat32);
+  TF_LITE_ENSURE_EQ(context, position_tensor->type, kTfLiteInt64);
+  TF_LITE_ENSURE_EQ(context, block_table_tensor->type, kTfLiteInt32);
+  TF_LITE_ENSURE_EQ(context, NumDimensions(q_tensor), 4);
+  TF_LITE_ENSURE_EQ(context, q_tensor->dims->data[0], 1);
+  TF_LITE_ENSURE_EQ(context, NumDimensions(position_tensor), 1);
+  TF_LITE_ENSURE_EQ(context, position_tensor->dims->data[0],
+                    q_tensor->dims->data[1]);
+
+  // Get custom op params
+  const uint8_t* buffer =
+      reinterpret_cast<const uint8_t*>(node->custom_initial_data);
+  const size_t length = node->custom_initial_data_size;
+  auto flexbuffer_map = flexbuffers::GetRoot(buffer, length).AsMap();
+  float scale = flexbuffer_map["scale"].AsFloat();
+  op_data->scale = scale > 0.0f ? scale : 1 / sqrt(q_tensor->dims->data[3]);
+  op_data->layer_index = flexbuffer_map["layer_index"].AsInt32();
+  TF_LITE_ENSURE(context, op_data->layer_index >= 0);
+
+  TfLiteTensor* output_tensor;
+  TF_LITE_ENSURE_OK(
+      context, GetOutputSafe(context, node, kOutputTensor, &output_tensor));
+  output_tensor->type = kTfLiteFloat32;
+  return context->ResizeTensor(context, output_tensor,
+                               TfLiteIntArrayCopy(q_tensor->dims));
+}
+
+void PagedSDPAFree(TfLiteContext* context, void* buffer) {
+  delete static_cast<PagedOpData*>(buffer);
+}
+
+TfLiteStatus PagedSDPAEval(TfLiteContext* context, TfLiteNode* node) {
+  const TfLiteTensor* query_tensor;
+  TF_LITE_ENSURE_OK(context, GetInputSafe(context, node, kPagedQueryTensor,
+                                          &query_tensor));
+  const TfLiteTensor* position_tensor;
+  TF_LITE_ENSURE_OK(context, GetInputSafe(context, node, kPagedPositionTensor,
+                                          &position_tensor));
+  const TfLiteTensor* block_table_tensor;
+  TF_LITE_ENSURE_OK(context, GetInputSafe(context, node, kPagedBlockTableTensor,
+                                          &block_table_tensor));
+  TfLiteTensor* output_tensor;
+  TF_LITE_ENSURE_OK(
+      context, GetOutputSafe(context, node, kOutputTensor, &output_tensor));
+  PagedOpData* op_data = reinterpret_cast<PagedOpData*>(node->user_data);
+
+  resource::PagedCacheBuffer* cache =
+      GetPagedKVCache(reinterpret_cast<Subgraph*>(context->impl_));
+  TF_LITE_ENSURE(context, cache != nullptr);
+  TF_LITE_ENSURE(context, op_data->layer_index < cache->GetNumLayers());
+
+  const int num_queries = query_tensor->dims->data[1];
+  const int num_heads = query_tensor->dims->data[2];
+  const int head_dim = query_tensor->dims->data[3];
+  TF_LITE_ENSURE_EQ(context, cache->GetEntrySize() % head_dim, 0);
+  // mha: num_kv_heads == num_heads, gqa/mqa: num_kv_heads divides num_heads.
+  const int num_kv_heads = cache->GetEntrySize() / head_dim;
+  TF_LITE_ENSURE_EQ(context, num_heads % num_kv_heads, 0);
+  const int heads_per_kv_head = num_heads / num_kv_heads;
+  const int block_size = cache->GetBlockSize();
+  const int num_blocks = NumElements(block_table_tensor);
+  const int32_t* block_table = GetTensorData<int32_t>(block_table_tensor);
+  for (int i = 0; i < num_blocks; ++i) {
+    TF_LITE_ENSURE(context, block_table[i] >= 0 &&
+                                block_table[i] < cache->GetNumBlocks());
+  }
+
+  const float* query_data = GetTensorData<float>(query_tensor);
+  const int64_t* positions = GetTensorData<int64_t>(position_tensor);
+  float* output_data = GetTensorData<float>(output_tensor);
+  const float scale = op_data->scale;
+  std::vector<float>& logits = op_data->logits;
+  for (int t = 0; t < num_queries; ++t) {
+    const int64_t position = positions[t];
+    if (position < 0 ||
+        position >= static_cast<int64_t>(num_blocks) * block_size) {
+      TF_LITE_KERNEL_LOG(context,
+                         "Position %lld is not covered by the block table",
+                         static_cast<long long>(position));
+      return kTfLiteError;
+    }
+    const int num_entries = position + 1;
+    logits.resize(num_entries);
+    for (int h = 0; h < num_heads; ++h) {
+      const float* q = query_data + (t * num_heads + h) * head_dim;
+      const int kv_head_offset = (h / heads_per_kv_head) * head_dim;
+      // logits = scale * q . k, softmax over the entries.
+      float max_logit = -std::numeric_limits<float>::infinity();
+      for (int j = 0; j < num_entries; ++j) {
+        const float* k = cache->GetKey(block_table[j / block_size],
+                                       op_data->layer_index, j % block_size) +
+                         kv_head_offset;
+        float dot = 0.0f;
+        for (int d = 0; d < head_dim; ++d) {
+          dot += q[d] * k[d];
+        }
+        logits[j] = dot * scale;
+        max_logit = std::max(max_logit, logits[j]);
+      }
+      float sum = 0.0f;
+      for (int j = 0; j < num_entries; ++j) {
+        logits[j] = std::exp(logits[j] - max_logit);
+        sum += logits[j];
+      }
+      float* out = output_data + (t * num_heads + h) * head_dim;
+      std::fill(out, out + head_dim, 0.0f);
+      for (int j = 0; j < num_entries; ++j) {
+        const float* v = cache->GetValue(block_table[j / block_size],
+                                         op_data->layer_index,
+                                         j % block_size) +
+                         kv_head_offset;
+        const float weight = logits[j] / sum;
+        for (int d = 0; d < head_dim; ++d) {
+          out[d] += weight * v[d];
+        }
+      }
+    }
+  }
   return kTfLiteOk;
 }
 
@@ -558,6 +543,12 @@ TfLiteRegistration* Register_SDPA() {
   return &r;
 }
 
+TfLiteRegistration* Register_PAGED_SDPA() {
+  static TfLiteRegistration r = {llm::PagedSDPAInit, llm::PagedSDPAFree,
+                                 llm::PagedSDPAPrepare, llm::PagedSDPAEval};
+  return &r;
+}
+
 }  // namespace custom
 }  // namespace ops
 }  // namespace tflite
@@ -0,0 +1,267 @@
+/* Copyright 2024 The TensorFlow Authors. All Rights Reserved.
+
+Licensed under the Apache License, Version 2.0 (the "License");
+you may not use this file except in compliance with the License.
+You may obtain a copy of the License at
+
+    http://www.apache.org/licenses/LICENSE-2.0
+
+Unless required by applicable law or agreed to in writing, software
+distributed under the License is distributed on an "AS IS" BASIS,
+WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+See the License for the specific language governing permissions and
+limitations under the License.
+==============================================================================*/
+
+#include <cmath>
+#include <cstdint>
+#include <cstring>
+#include <limits>
+#include <random>
+#include <vector>
+
+#include <gmock/gmock.h>
+#include <gtest/gtest.h>
+#include "tensorflow/lite/c/c_api_types.h"
+#include "tensorflow/lite/experimental/genai/genai_ops.h"
+#include "tensorflow/lite/interpreter.h"
+#include "tensorflow/lite/schema/schema_generated.h"
+
+namespace tflite {
+namespace {
+
+using ::testing::FloatNear;
+using ::testing::Pointwise;
+
+struct SDPAShape {
+  int batch_size;
+  int num_queries;
+  int num_entries;
+  int num_heads;
+  int num_kv_heads;
+  int head_dim;
+};
+
+// Runs SDPA on (B, T, N, H) queries, (B, S, N_kv, H) keys and values and a
+// mask of shape `mask_dims`.
+class SDPAModel {
+ public:
+  SDPAModel(const SDPAShape& shape, const std::vector<int>& mask_dims,
+            int num_threads) {
+    registration_ = *ops::custom::Register_SDPA();
+    registration_.builtin_code = BuiltinOperator_CUSTOM;
+    registration_.custom_name = "odml.scaled_dot_product_attention";
+
+    interpreter_.AddTensors(5);
+    interpreter_.SetInputs({kQuery, kKey, kValue, kMask});
+    interpreter_.SetOutputs({kOutput});
+    TfLiteQuantization quant = {kTfLiteNoQuantization, nullptr};
+    const std::vector<int> query_dims = {shape.batch_size, shape.num_queries,
+                                         shape.num_heads, shape.head_dim};
+    const std::vector<int> kv_dims = {shape.batch_size, shape.num_entries,
+                                      shape.num_kv_heads, shape.head_dim};
+    interpreter_.SetTensorParametersReadWrite(kQuery, kTfLiteFloat32, "",
+                                              query_dims, quant);
+    interpreter_.SetTensorParametersReadWrite(kKey, kTfLiteFloat32, "",
+                                              kv_dims, quant);
+    interpreter_.SetTensorParametersReadWrite(kValue, kTfLiteFloat32, "",
+                                              kv_dims, quant);
+    interpreter_.SetTensorParametersReadWrite(kMask, kTfLiteFloat32, "",
+                                              mask_dims, quant);
+    interpreter_.SetTensorParametersReadWrite(kOutput, kTfLiteFloat32, "",
+                                              query_dims, quant);
+    interpreter_.AddNodeWithParameters({kQuery, kKey, kValue, kMask},
+                                       {kOutput}, nullptr, 0, nullptr,
+                                       &registration_);
+    interpreter_.SetNumThreads(num_threads);
+  }
+
+  TfLiteStatus AllocateTensors() { return interpreter_.AllocateTensors(); }
+
+  TfLiteStatus Invoke(const std::vector<float>& query,
+                      const std::vector<float>& key,
+                      const std::vector<float>& value,
+                      const std::vector<float>& mask) {
+    Populate(kQuery, query);
+    Populate(kKey, key);
+    Populate(kValue, value);
+    Populate(kMask, mask);
+    return interpreter_.Invoke();
+  }
+
+  std::vector<float> GetOutput() {
+    const float* data = interpreter_.typed_tensor<float>(kOutput);
+    return std::vector<float>(
+        data, data + interpreter_.tensor(kOutput)->bytes / sizeof(float));
+  }
+
+ private:
+  enum { kQuery, kKey, kValue, kMask, kOutput };
+
+  void Populate(int index, const std::vector<float>& data) {
+    TfLiteTensor* tensor = interpreter_.tensor(index);
+    ASSERT_EQ(tensor->bytes, sizeof(float) * data.size());
+    std::memcpy(tensor->data.raw, data.data(), tensor->bytes);
+  }
+
+  TfLiteRegistration registration_;
+  Interpreter interpreter_;
+};
+
+// Computes the full score matrix of the attention, as the reference.
+std::vector<float> ReferenceSDPA(const SDPAShape& shape,
+                                 const std::vector<float>& query,
+                                 const std::vector<float>& key,
+                                 const std::vector<float>& value,
+                                 const std::vector<int>& mask_dims,
+                                 const std::vector<float>& mask) {
+  const float scale = 1 / std::sqrt(static_cast<float>(shape.head_dim));
+  const int group_size = shape.num_heads / shape.num_kv_heads;
+  std::vector<float> output(query.size());
+  for (int b = 0; b < shape.batch_size; ++b) {
+    for (int h = 0; h < shape.num_heads; ++h) {
+      for (int t = 0; t < shape.num_queries; ++t) {
+        const float* q =
+            &query[((b * shape.num_queries + t) * shape.num_heads + h) *
+                   shape.head_dim];
+        std::vector<float> logits(shape.num_entries);
+        float max_logit = -std::numeric_limits<float>::infinity();
+        for (int s = 0; s < shape.num_entries; ++s) {
+          const float* k =
+              &key[((b * shape.num_entries + s) * shape.num_kv_heads +
+                    h / group_size) *
+                   shape.head_dim];
+          float dot = 0;
+          for (int d = 0; d < shape.head_dim; ++d) dot += q[d] * k[d];
+          const int mask_index =
+              ((mask_dims[0] == 1 ? 0 : b) * mask_dims[1] +
+               (mask_dims[1] == 1 ? 0 : h)) *
+                  mask_dims[2] * mask_dims[3] +
+              (mask_dims[2] == 1 ? 0 : t) * mask_dims[3] + s;
+          logits[s] = dot * scale + mask[mask_index];
+          max_logit = std::max(max_logit, logits[s]);
+        }
+        float sum = 0;
+        for (float& logit : logits) {
+          logit = std::exp(logit - max_logit);
+          sum += logit;
+        }
+        float* out =
+            &output[((b * shape.num_queries + t) * shape.num_heads + h) *
+                    shape.head_dim];
+        for (int s = 0; s < shape.num_entries; ++s) {
+          const float* v =
+              &value[((b * shape.num_entries + s) * shape.num_kv_heads +
+                      h / group_size) *
+                     shape.head_dim];
+          for (int d = 0; d < shape.head_dim; ++d) {
+            out[d] += logits[s] / sum * v[d];
+          }
+        }
+      }
+    }
+  }
+  return output;
+}
+
+std::vector<float> RandomData(int size, std::mt19937& rng) {
+  std::uniform_real_distribution<float> dist(-1.0f, 1.0f);
+  std::vector<float> data(size);
+  for (float& x : data) x = dist(rng);
+  return data;
+}
+
+// Returns a (T, S) causal mask for the last T of S entries.
+std::vector<float> CausalMask(int num_queries, int num_entries,
+                              float masked_value) {
+  std::vector<float> mask(num_queries * num_entries, 0.0f);
+  for (int t = 0; t < num_queries; ++t) {
+    for (int s = num_entries - num_queries + t + 1; s < num_entries; ++s) {
+      mask[t * num_entries + s] = masked_value;
+    }
+  }
+  return mask;
+}
+
+void RunSDPATest(const SDPAShape& shape, float masked_value, int num_threads) {
+  std::mt19937 rng(1);
+  const std::vector<float> query = RandomData(
+      shape.batch_size * shape.num_queries * shape.num_heads * shape.head_dim,
+      rng);
+  const int kv_size = shape.batch_size * shape.num_entries *
+                      shape.num_kv_heads * shape.head_dim;
+  const std::vector<float> key = RandomData(kv_size, rng);
+  const std::vector<float> value = RandomData(kv_size, rng);
+  const std::vector<int> mask_dims = {1, 1, shape.num_queries,
+                                      shape.num_entries};
+  const std::vector<float> mask =
+      CausalMask(shape.num_queries, shape.num_entries, masked_value);
+
+  SDPAModel m(shape, mask_dims, num_threads);
+  ASSERT_EQ(m.AllocateTensors(), kTfLiteOk);
+  ASSERT_EQ(m.Invoke(query, key, value, mask), kTfLiteOk);
+  EXPECT_THAT(m.GetOutput(),
+              Pointwise(FloatNear(1e-5), ReferenceSDPA(shape, query, key,
+                                                       value, mask_dims,
+                                                       mask)));
+}
+
+TEST(SDPATest, MultiHeadAttention) {
+  RunSDPATest({/*batch_size=*/1, /*num_queries=*/5, /*num_entries=*/5,
+               /*num_heads=*/2, /*num_kv_heads=*/2, /*head_dim=*/4},
+              -std::numeric_limits<float>::infinity(), /*num_threads=*/1);
+}
+
+TEST(SDPATest, GroupedQueryAttention) {
+  RunSDPATest({/*batch_size=*/1, /*num_queries=*/3, /*num_entries=*/7,
+               /*num_heads=*/4, /*num_kv_heads=*/2, /*head_dim=*/8},
+              -std::numeric_limits<float>::infinity(), /*num_threads=*/1);
+}
+
+TEST(SDPATest, MultiQueryAttention) {
+  RunSDPATest({/*batch_size=*/1, /*num_queries=*/1, /*num_entries=*/9,
+               /*num_heads=*/4, /*num_kv_heads=*/1, /*head_dim=*/8},
+              -std::numeric_limits<float>::infinity(), /*num_threads=*/1);
+}
+
+TEST(SDPATest, SpansSeveralTiles) {
+  RunSDPATest({/*batch_size=*/2, /*num_queries=*/19, /*num_entries=*/150,
+               /*num_heads=*/2, /*num_kv_heads=*/1, /*head_dim=*/16},
+              -std::numeric_limits<float>::infinity(), /*num_threads=*/1);
+}
+
+TEST(SDPATest, FiniteMask) {
+  RunSDPATest({/*batch_size=*/1, /*num_queries=*/19, /*num_entries=*/150,
+               /*num_heads=*/2, /*num_kv_heads=*/2, /*head_dim=*/16},
+              -1e9f, /*num_threads=*/1);
+}
+
+TEST(SDPATest, MultiThreaded) {
+  RunSDPATest({/*batch_size=*/1, /*num_queries=*/33, /*num_entries=*/100,
+               /*num_heads=*/3, /*num_kv_heads=*/3, /*head_dim=*/8},
+              -std::numeric_limits<float>::infinity(), /*num_threads=*/4);
+}
+
+TEST(SDPATest, MaskPerHead) {
+  const SDPAShape shape = {/*batch_size=*/1, /*num_queries=*/2,
+                           /*num_entries=*/3, /*num_heads=*/2,
+                           /*num_kv_heads=*/2, /*head_dim=*/2};
+  std::mt19937 rng(2);
+  const std::vector<float> query = RandomData(8, rng);
+  const std::vector<float> key = RandomData(12, rng);
+  const std::vector<float> value = RandomData(12, rng);
+  const std::vector<int> mask_dims = {1, 2, 2, 3};
+  const float inf = std::numeric_limits<float>::infinity();
+  const std::vector<float> mask = {0, -inf, -inf, 0, 0, -inf,
+                                   0, 0, 0.5f, -1, 0, 0};
+  SDPAModel m(shape, mask_dims, /*num_threads=*/1);
+  ASSERT_EQ(m.AllocateTensors(), kTfLiteOk);
+  ASSERT_EQ(m.Invoke(query, key, value, mask), kTfLiteOk);
+  EXPECT_THAT(m.GetOutput(),
+              Pointwise(FloatNear(1e-5), ReferenceSDPA(shape, query, key,
+                                                       value, mask_dims,
+                                                       mask)));
+}
+
+}  // namespace
+}  // namespace tflite
@@ -0,0 +1,314 @@
+/* Copyright 2024 The TensorFlow Authors. All Rights Reserved.
+
+Licensed under the Apache License, Version 2.0 (the "License");
+you may not use this file except in compliance with the License.
+You may obtain a copy of the License at
+
+    http://www.apache.org/licenses/LICENSE-2.0
+
+Unless required by applicable law or agreed to in writing, software
+distributed under the License is distributed on an "AS IS" BASIS,
+WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+See the License for the specific language governing permissions and
+limitations under the License.
+==============================================================================*/
+#include "tensorflow/lite/experimental/remat/model_rematerializer.h"
+
+#include <algorithm>
+#include <cstddef>
+#include <cstdint>
+#include <map>
+#include <memory>
+#include <string>
+#include <utility>
+#include <vector>
+
+#include "tensorflow/compiler/mlir/lite/experimental/remat/rematerializer.h"
+#include "tensorflow/lite/core/api/error_reporter.h"
+#include "tensorflow/lite/core/api/flatbuffer_conversions.h"
+#include "tensorflow/lite/core/c/common.h"
+#include "tensorflow/lite/experimental/remat/metadata_util.h"
+#include "tensorflow/lite/graph_info.h"
+#include "tensorflow/lite/schema/schema_generated.h"
+#include "tensorflow/lite/schema/schema_utils.h"
+#include "tensorflow/lite/util.h"
+
+namespace tflite {
+
+namespace {
+
+using ::mlir::TFL::Rematerializer;
+
+bool IsConstant(const ModelT& model, const TensorT& tensor) {
+  if (tensor.buffer == 0 || tensor.buffer >= model.buffers.size()) {
+    return false;
+  }
+  const BufferT& buffer = *model.buffers[tensor.buffer];
+  return !buffer.data.empty() || buffer.offset > 1;
+}
+
+// Returns the size of `tensor` in bytes, or -1 if its type has no fixed size.
+int64_t TensorSize(const TensorT& tensor) {
+  TfLiteType type;
+  size_t type_size;
+  if (ConvertTensorType(tensor.type, &type, DefaultErrorReporter()) !=
+          kTfLiteOk ||
+      GetSizeOfType(/*context=*/nullptr, type, &type_size) != kTfLiteOk) {
+    return -1;
+  }
+  int64_t size = type_size;
+  for (const int32_t dim : tensor.shape) {
+    size *= dim > 0 ? dim : 1;
+  }
+  return size;
+}
+
+// The same as Subgraph::OpMightHaveSideEffect, on the model.
+bool OpMightHaveSideEffect(const SubGraphT& subgraph, const OperatorT& op,
+                           BuiltinOperator op_code) {
+  for (const auto* tensors : {&op.inputs, &op.outputs}) {
+    for (const int32_t tensor : *tensors) {
+      if (tensor >= 0 &&
+          subgraph.tensors[tensor]->type == TensorType_RESOURCE) {
+        return true;
+      }
+    }
+  }
+  return op_code == BuiltinOperator_IF || op_code == BuiltinOperator_WHILE ||
+         op_code == BuiltinOperator_CALL_ONCE;
+}
+
+// Returns true if recomputing `op` may not give the same outputs, or its
+// outputs can't be duplicated.
+bool OpCanBeRecomputed(const ModelT& model, const SubGraphT& subgraph,
+                       const OperatorT& op) {
+  const BuiltinOperator op_code =
+      GetBuiltinCode(model.operator_codes[op.opcode_index].get());
+  if (OpMightHaveSideEffect(subgraph, op, op_code)) return false;
+  switch (op_code) {
+    case BuiltinOperator_CUSTOM:
+    case BuiltinOperator_STABLEHLO_CUSTOM_CALL:
+    case BuiltinOperator_RANDOM_UNIFORM:
+    case BuiltinOperator_RANDOM_STANDARD_NORMAL:
+    case BuiltinOperator_MULTINOMIAL:
+    case BuiltinOperator_DELEGATE:
+      return false;
+    default:
+      break;
+  }
+  for (const auto* tensors : {&op.inputs, &op.outputs, &op.intermediates}) {
+    for (const int32_t tensor : *tensors) {
+      if (tensor < 0) continue;
+      const TensorT& t = *subgraph.tensors[tensor];
+      if (t.is_variable || TensorSize(t) < 0) return false;
+    }
+  }
+  return true;
+}
+
+// Represents the memory profile of a subgraph for the Rematerializer, and
+// applies its rematerializations to the subgraph.
+//
+// The operations of the Rematerializer are those of the subgraph shifted by
+// one: a first operation uses the subgraph inputs and a last one its outputs,
+// so that their lifetimes span the whole subgraph.
+class SubgraphRematerializer : public Rematerializer {
+ public:
+  SubgraphRematerializer(const ModelT& model, const SubGraphT& subgraph) {
+    for (const auto& tensor : subgraph.tensors) {
+      AddTensor(IsConstant(model, *tensor) ? 0
+                                           : std::max<int64_t>(
+                                                 TensorSize(*tensor), 0));
+    }
+    const int source = AddOperation(/*is_stateful=*/true);
+    for (const int32_t tensor : subgraph.inputs) AddUse(source, tensor);
+    for (const auto& op : subgraph.operators) {
+      const int operation = AddOperation(
+          /*is_stateful=*/!OpCanBeRecomputed(model, subgraph, *op));
+      for (const auto* tensors : {&op->inputs, &op->outputs,
+                                  &op->intermediates}) {
+        for (const int32_t tensor : *tensors) {
+          if (tensor >= 0 && !IsConstant(model, *subgraph.tensors[tensor])) {
+            AddUse(operation, tensor);
+          }
+        }
+      }
+    }
+    const int sink = AddOperation(/*is_stateful=*/true);
+    for (const int32_t tensor : subgraph.outputs) AddUse(sink, tensor);
+
+    original_indices_.resize(subgraph.operators.size());
+    for (int i = 0; i < original_indices_.size(); ++i) {
+      original_indices_[i] = i;
+    }
+    recomputed_block_starts_.assign(subgraph.operators.size(), false);
+  }
+
+  // Runs the rematerializations with `options` on `subgraph`, which must be
+  // the one this was created from.
+  void Run(const RematerializationOptions& options, SubGraphT* subgraph) {
+    subgraph_ = subgraph;
+    RunGreedyAlgorithm(options.max_cost, options.max_block_length,
+                       options.min_savings, options.max_peak_memory);
+    subgraph_ = nullptr;
+  }
+
+  int num_inserted() const { return num_inserted_; }
+
+  // Returns the control edges of the subgraph after rematerialization: the
+  // `original` ones, or those ordering the operators with side effects if
+  // null, and edges running each recomputed block after the operator before
+  // it, so that a delegate doesn't compute it earlier.
+  ControlEdges GetControlEdges(const SubGraphT& subgraph,
+                               const ModelT& model,
+                               const ControlEdges* original) const {
+    ControlEdges edges;
+    std::vector<int> new_indices;
+    for (int i = 0; i < original_indices_.size(); ++i) {
+      if (original_indices_[i] < 0) continue;
+      new_indices.resize(std::max<size_t>(new_indices.size(),
+                                          original_indices_[i] + 1));
+      new_indices[original_indices_[i]] = i;
+    }
+    if (original != nullptr) {
+      for (const ControlEdge& edge : *original) {
+        if (edge.first < 0 || edge.first >= new_indices.size() ||
+            edge.second < 0 || edge.second >= new_indices.size()) {
+          continue;
+        }
+        edges.emplace_back(new_indices[edge.first], new_indices[edge.second]);
+      }
+    } else {
+      int last_op_with_side_effect = -1;
+      for (int i = 0; i < subgraph.operators.size(); ++i) {
+        const OperatorT& op = *subgraph.operators[i];
+        const BuiltinOperator op_code =
+            GetBuiltinCode(model.operator_codes[op.opcode_index].get());
+        if (!OpMightHaveSideEffect(subgraph, op, op_code)) continue;
+        if (last_op_with_side_effect != -1) {
+          edges.emplace_back(last_op_with_side_effect, i);
+        }
+        last_op_with_side_effect = i;
+      }
+    }
+    for (int i = 1; i < recomputed_block_starts_.size(); ++i) {
+      if (recomputed_block_starts_[i]) edges.emplace_back(i - 1, i);
+    }
+    return edges;
+  }
+
+ private:
+  void ApplyRemat(const RematSpec& remat) override {
+    // Operator indices in the subgraph.
+    const int begin = remat.begin - 1;
+    const int end = remat.end - 1;
+    const int insert = remat.insert - 1;
+    auto& operators = subgraph_->operators;
+    auto& tensors = subgraph_->tensors;
+
+    // Clone the block with new output tensors.
+    std::map<int32_t, int32_t> new_tensors;
+    std::vector<std::unique_ptr<OperatorT>> clones;
+    for (int i = begin; i < end; ++i) {
+      auto clone = std::make_unique<OperatorT>(*operators[i]);
+      for (auto* op_tensors : {&clone->outputs, &clone->intermediates}) {
+        for (int32_t& tensor : *op_tensors) {
+          if (tensor < 0) continue;
+          auto new_tensor = std::make_unique<TensorT>(*tensors[tensor]);
+          new_tensor->name += "_remat";
+          const int32_t new_index = static_cast<int32_t>(tensors.size());
+          tensors.push_back(std::move(new_tensor));
+          new_tensors[tensor] = new_index;
+          tensor = new_index;
+        }
+      }
+      clones.push_back(std::move(clone));
+    }
+    const int num_cloned = end - begin;
+    operators.insert(operators.begin() + insert,
+                     std::make_move_iterator(clones.begin()),
+                     std::make_move_iterator(clones.end()));
+    original_indices_.insert(original_indices_.begin() + insert, num_cloned,
+                             -1);
+    recomputed_block_starts_.insert(recomputed_block_starts_.begin() + insert,
+                                    num_cloned, false);
+    recomputed_block_starts_[insert] = true;
+    num_inserted_ += num_cloned;
+
+    // Let the clones and the operators after them use the new tensors.
+    const auto rename = [&new_tensors](int32_t& tensor) {
+      const auto it = new_tensors.find(tensor);
+      if (it != new_tensors.end()) tensor = it->second;
+    };
+    for (int i = insert; i < operators.size(); ++i) {
+      for (int32_t& tensor : operators[i]->inputs) rename(tensor);
+    }
+    for (int32_t& tensor : subgraph_->outputs) rename(tensor);
+  }
+
+  // Only set while running the rematerializations.
+  SubGraphT* subgraph_ = nullptr;
+  // The index before rematerialization of each operator, or -1 if inserted.
+  std::vector<int> original_indices_;
+  // Whether each operator is the first of a recomputed block.
+  std::vector<bool> recomputed_block_starts_;
+  int num_inserted_ = 0;
+};
+
+}  // namespace
+
+TfLiteStatus RematerializeModel(const RematerializationOptions& options,
+                                ModelT* model, int* num_inserted,
+                                ErrorReporter* error_reporter) {
+  *num_inserted = 0;
+  MetadataT* control_dependencies_metadata = nullptr;
+  ModelControlDependencies original_dependencies;
+  for (const auto& metadata : model->metadata) {
+    if (metadata->name != kModelControlDependenciesMetadataKey) continue;
+    const auto& data = model->buffers[metadata->buffer]->data;
+    if (!ParseModelControlDependencies(
+            reinterpret_cast<const char*>(data.data()), data.size(),
+            &original_dependencies) ||
+        original_dependencies.size() != model->subgraphs.size()) {
+      TF_LITE_REPORT_ERROR(error_reporter,
+                           "Invalid model control dependencies metadata.");
+      return kTfLiteError;
+    }
+    control_dependencies_metadata = metadata.get();
+    break;
+  }
+
+  ModelControlDependencies control_dependencies(model->subgraphs.size());
+  for (int i = 0; i < model->subgraphs.size(); ++i) {
+    SubGraphT* subgraph = model->subgraphs[i].get();
+    SubgraphRematerializer rematerializer(*model, *subgraph);
+    rematerializer.Run(options, subgraph);
+    *num_inserted += rematerializer.num_inserted();
+    control_dependencies[i] = rematerializer.GetControlEdges(
+        *subgraph, *model,
+        control_dependencies_metadata != nullptr ? &original_dependencies[i]
+                                                 : nullptr);
+  }
+  if (*num_inserted == 0) return kTfLiteOk;
+
+  const std::string serialized =
+      SerializeModelControlDependencies(control_dependencies);
+  if (control_dependencies_metadata == nullptr) {
+    model->buffers.push_back(std::make_unique<BufferT>());
+    auto metadata = std::make_unique<MetadataT>();
+    metadata->name = kModelControlDependenciesMetadataKey;
+    metadata->buffer = model->buffers.size() - 1;
+    control_dependencies_metadata = metadata.get();
+    model->metadata.push_back(std::move(metadata));
+  }
+  model->buffers[control_dependencies_metadata->buffer]->data.assign(
+      serialized.begin(), serialized.end());
+  return kTfLiteOk;
+}
+
+int64_t EstimatePeakActivationMemory(const ModelT& model,
+                                     const SubGraphT& subgraph) {
+  return SubgraphRematerializer(model, subgraph).GetPeakMemory().size;
+}
+
+}  // namespace tflite
@@ -0,0 +1,72 @@
+/* Copyright 2024 The TensorFlow Authors. All Rights Reserved.
+
+Licensed under the Apache License, Version 2.0 (the "License");
+you may not use this file except in compliance with the License.
+You may obtain a copy of the License at
+
+    http://www.apache.org/licenses/LICENSE-2.0
+
+Unless required by applicable law or agreed to in writing, software
+distributed under the License is distributed on an "AS IS" BASIS,
+WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+See the License for the specific language governing permissions and
+limitations under the License.
+==============================================================================*/
+/// \file
+///
+/// Rematerialization of the intermediate tensors of a model, trading
+/// recomputation for a lower peak activation memory.
+///
+
+#ifndef TENSORFLOW_LITE_EXPERIMENTAL_REMAT_MODEL_REMATERIALIZER_H_
+#define TENSORFLOW_LITE_EXPERIMENTAL_REMAT_MODEL_REMATERIALIZER_H_
+
+#include <cstdint>
+
+#include "tensorflow/lite/core/api/error_reporter.h"
+#include "tensorflow/lite/core/c/common.h"
+#include "tensorflow/lite/schema/schema_generated.h"
+
+namespace tflite {
+
+/// Options of RematerializeModel.
+struct RematerializationOptions {
+  /// The peak memory of the activations of each subgraph, in bytes, to
+  /// rematerialize down to. The rematerialization stops as soon as the peak is
+  /// at most this; a negative value lowers it as much as possible.
+  int64_t max_peak_memory = -1;
+  /// The maximum number of consecutive operators recomputed together.
+  int max_block_length = 1;
+  /// The maximum number of operators inserted per subgraph, or -1 for no
+  /// limit.
+  int max_cost = -1;
+  /// The minimum number of bytes a rematerialization must save.
+  int64_t min_savings = 1;
+};
+
+/// Rematerializes intermediate tensors of the subgraphs of `model`: operators
+/// with small inputs and large outputs are recomputed right before their
+/// outputs are used again, instead of keeping the outputs alive, so that the
+/// arena planner needs less memory for the activations. The peak memory is
+/// estimated as the sum of the sizes of the tensors alive at each operator,
+/// which the arena can exceed by its fragmentation.
+///
+/// Operators with side effects, state, variables, random outputs or custom
+/// implementations are never recomputed. The order of the recomputed operators
+/// is recorded as control dependencies in the model metadata (see
+/// metadata_util.h), for the delegate partitioning to preserve it.
+///
+/// Sets `*num_inserted` to the number of operators inserted. Returns an error
+/// if the control dependencies already in the metadata can't be parsed.
+TfLiteStatus RematerializeModel(const RematerializationOptions& options,
+                                ModelT* model, int* num_inserted,
+                                ErrorReporter* error_reporter);
+
+/// Returns the estimated peak memory of the activations of `subgraph` of
+/// `model`, see RematerializeModel.
+int64_t EstimatePeakActivationMemory(const ModelT& model,
+                                     const SubGraphT& subgraph);
+
+}  // namespace tflite
+
+#endif  // TENSORFLOW_LITE_EXPERIMENTAL_REMAT_MODEL_REMATERIALIZER_H_
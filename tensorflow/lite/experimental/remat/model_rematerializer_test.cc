@@ -0,0 +1,183 @@
+/* Copyright 2024 The TensorFlow Authors. All Rights Reserved.
+
+Licensed under the Apache License, Version 2.0 (the "License");
+you may not use this file except in compliance with the License.
+You may obtain a copy of the License at
+
+    http://www.apache.org/licenses/LICENSE-2.0
+
+Unless required by applicable law or agreed to in writing, software
+distributed under the License is distributed on an "AS IS" BASIS,
+WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+See the License for the specific language governing permissions and
+limitations under the License.
+==============================================================================*/
+#include "tensorflow/lite/experimental/remat/model_rematerializer.h"
+
+#include <cstdint>
+#include <memory>
+#include <string>
+#include <utility>
+#include <vector>
+
+#include <gmock/gmock.h>
+#include <gtest/gtest.h>
+#include "tensorflow/lite/core/api/error_reporter.h"
+#include "tensorflow/lite/core/c/common.h"
+#include "tensorflow/lite/experimental/remat/metadata_util.h"
+#include "tensorflow/lite/schema/schema_generated.h"
+
+namespace tflite {
+namespace {
+
+using ::testing::ElementsAre;
+using ::testing::Pair;
+
+class ModelRematerializerTest : public ::testing::Test {
+ protected:
+  // Builds a subgraph where `big` is computed first and only used by the last
+  // operator, while another big tensor is alive:
+  //   big = ADD(input, input)     // 1024 bytes
+  //   big2 = ADD(input, input)    // 1024 bytes
+  //   small = ADD(big2, big2)
+  //   output = ADD(big, small)
+  void SetUp() override {
+    model_.operator_codes.push_back(std::make_unique<OperatorCodeT>());
+    model_.operator_codes[0]->builtin_code = BuiltinOperator_ADD;
+    model_.operator_codes[0]->deprecated_builtin_code = BuiltinOperator_ADD;
+    model_.operator_codes.push_back(std::make_unique<OperatorCodeT>());
+    model_.operator_codes[1]->builtin_code = BuiltinOperator_CUSTOM;
+    model_.operator_codes[1]->deprecated_builtin_code = BuiltinOperator_CUSTOM;
+    model_.operator_codes[1]->custom_code = "MyCustomOp";
+    model_.buffers.push_back(std::make_unique<BufferT>());
+
+    auto subgraph = std::make_unique<SubGraphT>();
+    const int input = AddTensor(subgraph.get(), "input", 4);
+    const int big = AddTensor(subgraph.get(), "big", 256);
+    const int big2 = AddTensor(subgraph.get(), "big2", 256);
+    const int small = AddTensor(subgraph.get(), "small", 4);
+    const int output = AddTensor(subgraph.get(), "output", 4);
+    AddOperator(subgraph.get(), {input, input}, {big});
+    AddOperator(subgraph.get(), {input, input}, {big2});
+    AddOperator(subgraph.get(), {big2, big2}, {small});
+    AddOperator(subgraph.get(), {big, small}, {output});
+    subgraph->inputs = {input};
+    subgraph->outputs = {output};
+    model_.subgraphs.push_back(std::move(subgraph));
+  }
+
+  static int AddTensor(SubGraphT* subgraph, const std::string& name,
+                       int num_elements) {
+    auto tensor = std::make_unique<TensorT>();
+    tensor->name = name;
+    tensor->type = TensorType_FLOAT32;
+    tensor->shape = {num_elements};
+    subgraph->tensors.push_back(std::move(tensor));
+    return subgraph->tensors.size() - 1;
+  }
+
+  static void AddOperator(SubGraphT* subgraph, std::vector<int32_t> inputs,
+                          std::vector<int32_t> outputs) {
+    auto op = std::make_unique<OperatorT>();
+    op->opcode_index = 0;
+    op->inputs = std::move(inputs);
+    op->outputs = std::move(outputs);
+    subgraph->operators.push_back(std::move(op));
+  }
+
+  const SubGraphT& subgraph() const { return *model_.subgraphs[0]; }
+
+  ModelT model_;
+};
+
+TEST_F(ModelRematerializerTest, RecomputesTheBigTensorBeforeItsUse) {
+  EXPECT_EQ(EstimatePeakActivationMemory(model_, subgraph()), 2064);
+
+  int num_inserted;
+  ASSERT_EQ(RematerializeModel(RematerializationOptions(), &model_,
+                               &num_inserted, DefaultErrorReporter()),
+            kTfLiteOk);
+  EXPECT_EQ(num_inserted, 1);
+  EXPECT_EQ(EstimatePeakActivationMemory(model_, subgraph()), 1056);
+
+  ASSERT_EQ(subgraph().operators.size(), 5);
+  ASSERT_EQ(subgraph().tensors.size(), 6);
+  EXPECT_EQ(subgraph().tensors[5]->name, "big_remat");
+  EXPECT_THAT(subgraph().operators[3]->inputs, ElementsAre(0, 0));
+  EXPECT_THAT(subgraph().operators[3]->outputs, ElementsAre(5));
+  EXPECT_THAT(subgraph().operators[4]->inputs, ElementsAre(5, 3));
+
+  // The recomputed operator runs after the operator before it.
+  ASSERT_EQ(model_.metadata.size(), 1);
+  EXPECT_EQ(model_.metadata[0]->name, kModelControlDependenciesMetadataKey);
+  const auto& data = model_.buffers[model_.metadata[0]->buffer]->data;
+  ModelControlDependencies control_dependencies;
+  ASSERT_TRUE(ParseModelControlDependencies(
+      reinterpret_cast<const char*>(data.data()), data.size(),
+      &control_dependencies));
+  ASSERT_EQ(control_dependencies.size(), 1);
+  EXPECT_THAT(control_dependencies[0], ElementsAre(Pair(2, 3)));
+}
+
+TEST_F(ModelRematerializerTest, StopsOnceThePeakFits) {
+  RematerializationOptions options;
+  options.max_peak_memory = 2064;
+  int num_inserted;
+  ASSERT_EQ(RematerializeModel(options, &model_, &num_inserted,
+                               DefaultErrorReporter()),
+            kTfLiteOk);
+  EXPECT_EQ(num_inserted, 0);
+  EXPECT_EQ(subgraph().operators.size(), 4);
+  EXPECT_TRUE(model_.metadata.empty());
+}
+
+TEST_F(ModelRematerializerTest, DoesNotRecomputeCustomOperators) {
+  model_.subgraphs[0]->operators[0]->opcode_index = 1;
+  int num_inserted;
+  ASSERT_EQ(RematerializeModel(RematerializationOptions(), &model_,
+                               &num_inserted, DefaultErrorReporter()),
+            kTfLiteOk);
+  EXPECT_EQ(num_inserted, 0);
+  EXPECT_EQ(EstimatePeakActivationMemory(model_, subgraph()), 2064);
+}
+
+TEST_F(ModelRematerializerTest, RemapsExistingControlDependencies) {
+  const std::string serialized = SerializeModelControlDependencies({{{0, 1}}});
+  model_.buffers.push_back(std::make_unique<BufferT>());
+  model_.buffers.back()->data.assign(serialized.begin(), serialized.end());
+  auto metadata = std::make_unique<MetadataT>();
+  metadata->name = kModelControlDependenciesMetadataKey;
+  metadata->buffer = model_.buffers.size() - 1;
+  model_.metadata.push_back(std::move(metadata));
+
+  int num_inserted;
+  ASSERT_EQ(RematerializeModel(RematerializationOptions(), &model_,
+                               &num_inserted, DefaultErrorReporter()),
+            kTfLiteOk);
+  EXPECT_EQ(num_inserted, 1);
+  ASSERT_EQ(model_.metadata.size(), 1);
+  const auto& data = model_.buffers[model_.metadata[0]->buffer]->data;
+  ModelControlDependencies control_dependencies;
+  ASSERT_TRUE(ParseModelControlDependencies(
+      reinterpret_cast<const char*>(data.data()), data.size(),
+      &control_dependencies));
+  EXPECT_THAT(control_dependencies,
+              ElementsAre(ElementsAre(Pair(0, 1), Pair(2, 3))));
+}
+
+TEST_F(ModelRematerializerTest, FailsOnInvalidControlDependencies) {
+  model_.buffers.push_back(std::make_unique<BufferT>());
+  model_.buffers.back()->data = {1, 2, 3};
+  auto metadata = std::make_unique<MetadataT>();
+  metadata->name = kModelControlDependenciesMetadataKey;
+  metadata->buffer = model_.buffers.size() - 1;
+  model_.metadata.push_back(std::move(metadata));
+
+  int num_inserted;
+  EXPECT_EQ(RematerializeModel(RematerializationOptions(), &model_,
+                               &num_inserted, DefaultErrorReporter()),
+            kTfLiteError);
+}
+
+}  // namespace
+}  // namespace tflite
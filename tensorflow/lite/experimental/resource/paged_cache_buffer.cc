@@ -0,0 +1,170 @@
+/* Copyright 2024 The TensorFlow Authors. All Rights Reserved.
+
+Licensed under the Apache License, Version 2.0 (the "License");
+you may not use this file except in compliance with the License.
+You may obtain a copy of the License at
+
+    http://www.apache.org/licenses/LICENSE-2.0
+
+Unless required by applicable law or agreed to in writing, software
+distributed under the License is distributed on an "AS IS" BASIS,
+WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+See the License for the specific language governing permissions and
+limitations under the License.
+==============================================================================*/
+
+#include "tensorflow/lite/experimental/resource/paged_cache_buffer.h"
+
+#include <cstddef>
+#include <cstdint>
+#include <cstring>
+#include <vector>
+
+#include "tensorflow/lite/core/c/c_api_types.h"
+#include "tensorflow/lite/core/c/common.h"
+#include "tensorflow/lite/kernels/internal/compatibility.h"
+
+namespace tflite {
+namespace resource {
+
+TfLiteStatus PagedCacheBuffer::Initialize(int num_blocks, int block_size,
+                                          int num_layers, int entry_size) {
+  if (num_blocks <= 0 || block_size <= 0 || num_layers <= 0 ||
+      entry_size <= 0) {
+    return kTfLiteError;
+  }
+  block_size_ = block_size;
+  num_layers_ = num_layers;
+  entry_size_ = entry_size;
+  block_floats_ = static_cast<size_t>(num_layers) * 2 * block_size * entry_size;
+  const size_t buf_size = block_floats_ * num_blocks;
+  blocks_.reset(new float[buf_size]);
+  memset(blocks_.get(), 0, sizeof(float) * buf_size);
+
+  ref_counts_.assign(num_blocks, 0);
+  free_blocks_.clear();
+  free_blocks_.reserve(num_blocks);
+  // Hand out the blocks in increasing order.
+  for (int block = num_blocks - 1; block >= 0; --block) {
+    free_blocks_.push_back(block);
+  }
+  sequences_.clear();
+  return kTfLiteOk;
+}
+
+size_t PagedCacheBuffer::GetMemoryUsage() {
+  return sizeof(float) * block_floats_ * ref_counts_.size();
+}
+
+int PagedCacheBuffer::AllocateBlock() {
+  if (free_blocks_.empty()) return -1;
+  const int block = free_blocks_.back();
+  free_blocks_.pop_back();
+  ref_counts_[block] = 1;
+  return block;
+}
+
+void PagedCacheBuffer::UnrefBlock(int block) {
+  TFLITE_DCHECK_GT(ref_counts_[block], 0);
+  if (--ref_counts_[block] == 0) {
+    free_blocks_.push_back(block);
+  }
+}
+
+float* PagedCacheBuffer::GetBlock(int block) {
+  return blocks_.get() + block_floats_ * block;
+}
+
+float* PagedCacheBuffer::GetKey(int block, int layer, int offset) {
+  return GetBlock(block) +
+         (static_cast<size_t>(layer) * 2 * block_size_ + offset) * entry_size_;
+}
+
+float* PagedCacheBuffer::GetValue(int block, int layer, int offset) {
+  return GetKey(block, layer, offset) +
+         static_cast<size_t>(block_size_) * entry_size_;
+}
+
+TfLiteStatus PagedCacheBuffer::Reserve(int sequence_id,
+                                       int64_t first_position,
+                                       int64_t last_position) {
+  if (!IsInitialized() || first_position < 0 ||
+      last_position < first_position) {
+    return kTfLiteError;
+  }
+  std::vector<int>& block_table = sequences_[sequence_id].block_table;
+  const int64_t first_block = first_position / block_size_;
+  const int64_t last_block = last_position / block_size_;
+  if (last_block >= GetNumBlocks()) return kTfLiteError;
+  // Copy the shared blocks that are written to.
+  const int64_t num_held = block_table.size();
+  for (int64_t i = first_block; i <= last_block && i < num_held; ++i) {
+    const int shared_block = block_table[i];
+    if (ref_counts_[shared_block] == 1) continue;
+    const int block = AllocateBlock();
+    if (block < 0) return kTfLiteError;
+    memcpy(GetBlock(block), GetBlock(shared_block),
+           sizeof(float) * block_floats_);
+    UnrefBlock(shared_block);
+    block_table[i] = block;
+  }
+  while (static_cast<int64_t>(block_table.size()) <= last_block) {
+    const int block = AllocateBlock();
+    if (block < 0) return kTfLiteError;
+    block_table.push_back(block);
+  }
+  return kTfLiteOk;
+}
+
+const std::vector<int>* PagedCacheBuffer::GetBlockTable(
+    int sequence_id) const {
+  auto it = sequences_.find(sequence_id);
+  return it == sequences_.end() ? nullptr : &it->second.block_table;
+}
+
+int64_t PagedCacheBuffer::GetNumEntries(int sequence_id) const {
+  auto it = sequences_.find(sequence_id);
+  return it == sequences_.end() ? 0 : it->second.num_entries;
+}
+
+void PagedCacheBuffer::SetNumEntries(int sequence_id, int64_t num_entries) {
+  Sequence& sequence = sequences_[sequence_id];
+  TFLITE_DCHECK_LE(num_entries,
+                   static_cast<int64_t>(sequence.block_table.size()) *
+                       block_size_);
+  sequence.num_entries = num_entries;
+}
+
+TfLiteStatus PagedCacheBuffer::ForkSequence(int src_sequence_id,
+                                            int dst_sequence_id,
+                                            int64_t num_entries) {
+  if (src_sequence_id == dst_sequence_id) return kTfLiteError;
+  auto it = sequences_.find(src_sequence_id);
+  if (it == sequences_.end() || num_entries < 0 ||
+      num_entries > it->second.num_entries) {
+    return kTfLiteError;
+  }
+  const std::vector<int>& src_block_table = it->second.block_table;
+  const int64_t num_blocks = (num_entries + block_size_ - 1) / block_size_;
+  ReleaseSequence(dst_sequence_id);
+  Sequence& dst = sequences_[dst_sequence_id];
+  dst.block_table.assign(src_block_table.begin(),
+                         src_block_table.begin() + num_blocks);
+  for (int block : dst.block_table) {
+    ++ref_counts_[block];
+  }
+  dst.num_entries = num_entries;
+  return kTfLiteOk;
+}
+
+void PagedCacheBuffer::ReleaseSequence(int sequence_id) {
+  auto it = sequences_.find(sequence_id);
+  if (it == sequences_.end()) return;
+  for (int block : it->second.block_table) {
+    UnrefBlock(block);
+  }
+  sequences_.erase(it);
+}
+
+}  // namespace resource
+}  // namespace tflite
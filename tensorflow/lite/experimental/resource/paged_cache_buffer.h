@@ -0,0 +1,119 @@
+/* Copyright 2024 The TensorFlow Authors. All Rights Reserved.
+
+Licensed under the Apache License, Version 2.0 (the "License");
+you may not use this file except in compliance with the License.
+You may obtain a copy of the License at
+
+    http://www.apache.org/licenses/LICENSE-2.0
+
+Unless required by applicable law or agreed to in writing, software
+distributed under the License is distributed on an "AS IS" BASIS,
+WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+See the License for the specific language governing permissions and
+limitations under the License.
+==============================================================================*/
+#ifndef TENSORFLOW_LITE_EXPERIMENTAL_RESOURCE_PAGED_CACHE_BUFFER_H_
+#define TENSORFLOW_LITE_EXPERIMENTAL_RESOURCE_PAGED_CACHE_BUFFER_H_
+
+#include <cstddef>
+#include <cstdint>
+#include <memory>
+#include <unordered_map>
+#include <vector>
+
+#include "tensorflow/lite/core/c/common.h"
+#include "tensorflow/lite/experimental/resource/resource_base.h"
+
+namespace tflite {
+namespace resource {
+
+/// WARNING: Experimental interface, subject to change.
+// A paged cache for the keys and values of the attention layers of a
+// transformer, shared by several sequences.
+//
+// The memory is a pool of fixed size blocks. A block holds the keys and the
+// values of `block_size` consecutive positions of one sequence, for all
+// layers, so that all layers of a sequence share one block table. A sequence
+// only holds the blocks that cover the positions written so far, and a block
+// can be shared by several sequences with a common prefix (see
+// `ForkSequence`). A shared block is copied before it is written to.
+class PagedCacheBuffer : public ResourceBase {
+ public:
+  PagedCacheBuffer() = default;
+  PagedCacheBuffer(const PagedCacheBuffer &) = delete;
+  PagedCacheBuffer &operator=(const PagedCacheBuffer &) = delete;
+
+  // Allocates `num_blocks` blocks of `block_size` entries, each entry holding
+  // `entry_size` floats of key and as many of value for each of the
+  // `num_layers` layers.
+  TfLiteStatus Initialize(int num_blocks, int block_size, int num_layers,
+                          int entry_size);
+
+  bool IsInitialized() override { return blocks_ != nullptr; }
+  size_t GetMemoryUsage() override;
+
+  int GetNumBlocks() const { return static_cast<int>(ref_counts_.size()); }
+  int GetNumFreeBlocks() const { return static_cast<int>(free_blocks_.size()); }
+  int GetBlockSize() const { return block_size_; }
+  int GetNumLayers() const { return num_layers_; }
+  int GetEntrySize() const { return entry_size_; }
+
+  // Makes the entries [`first_position`, `last_position`] of the sequence
+  // writable: allocates the blocks that cover them and copies the blocks
+  // among them that are shared with other sequences. Fails if the pool runs
+  // out of blocks, in which case the blocks allocated so far are kept.
+  TfLiteStatus Reserve(int sequence_id, int64_t first_position,
+                       int64_t last_position);
+
+  // Returns the block table of the sequence. Position `p` of the sequence is
+  // entry `p % block_size` of block `block_table[p / block_size]`. Returns
+  // nullptr if the sequence does not exist.
+  const std::vector<int> *GetBlockTable(int sequence_id) const;
+
+  // Returns the key or value of entry `offset` of `block` in `layer`.
+  float *GetKey(int block, int layer, int offset);
+  float *GetValue(int block, int layer, int offset);
+
+  // Gets or sets the number of positions of the sequence that hold a key and
+  // a value, i.e. one past the last position written.
+  int64_t GetNumEntries(int sequence_id) const;
+  void SetNumEntries(int sequence_id, int64_t num_entries);
+
+  // Creates the sequence `dst_sequence_id`, or replaces its entries, with the
+  // first `num_entries` entries of `src_sequence_id`. The blocks are shared
+  // rather than copied, so a common prompt prefix is kept once.
+  TfLiteStatus ForkSequence(int src_sequence_id, int dst_sequence_id,
+                            int64_t num_entries);
+
+  // Deletes the sequence and returns the blocks no other sequence uses to the
+  // pool.
+  void ReleaseSequence(int sequence_id);
+
+ private:
+  struct Sequence {
+    std::vector<int> block_table;
+    int64_t num_entries = 0;
+  };
+
+  // Returns a free block, or -1 if there is none.
+  int AllocateBlock();
+  void UnrefBlock(int block);
+  float *GetBlock(int block);
+
+  int block_size_ = 0;
+  int num_layers_ = 0;
+  int entry_size_ = 0;
+  // The number of floats in a block. For each layer, a block holds the keys
+  // of all its entries followed by their values.
+  size_t block_floats_ = 0;
+  std::unique_ptr<float[]> blocks_;
+  // The number of sequences that hold each block.
+  std::vector<int> ref_counts_;
+  std::vector<int> free_blocks_;
+  std::unordered_map<int, Sequence> sequences_;
+};
+
+}  // namespace resource
+}  // namespace tflite
+
+#endif  // TENSORFLOW_LITE_EXPERIMENTAL_RESOURCE_PAGED_CACHE_BUFFER_H_
@@ -0,0 +1,119 @@
+/* Copyright 2024 The TensorFlow Authors. All Rights Reserved.
+
+Licensed under the Apache License, Version 2.0 (the "License");
+you may not use this file except in compliance with the License.
+You may obtain a copy of the License at
+
+    http://www.apache.org/licenses/LICENSE-2.0
+
+Unless required by applicable law or agreed to in writing, software
+distributed under the License is distributed on an "AS IS" BASIS,
+WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+See the License for the specific language governing permissions and
+limitations under the License.
+==============================================================================*/
+#include "tensorflow/lite/experimental/resource/paged_cache_buffer.h"
+
+#include <cstdlib>
+#include <vector>
+
+#include <gtest/gtest.h>
+#include "tensorflow/lite/core/c/common.h"
+
+namespace tflite {
+namespace resource {
+
+TEST(PagedCacheBufferTest, Initialize) {
+  PagedCacheBuffer cache;
+  EXPECT_FALSE(cache.IsInitialized());
+  ASSERT_EQ(cache.Initialize(/*num_blocks=*/4, /*block_size=*/2,
+                             /*num_layers=*/3, /*entry_size=*/5),
+            kTfLiteOk);
+  EXPECT_TRUE(cache.IsInitialized());
+  EXPECT_EQ(cache.GetMemoryUsage(), sizeof(float) * 4 * 3 * 2 * 2 * 5);
+  EXPECT_EQ(cache.GetNumFreeBlocks(), 4);
+  EXPECT_EQ(cache.GetBlockTable(0), nullptr);
+  EXPECT_EQ(cache.GetNumEntries(0), 0);
+  EXPECT_EQ(cache.Initialize(0, 2, 3, 5), kTfLiteError);
+}
+
+TEST(PagedCacheBufferTest, ReserveAllocatesBlocksOnDemand) {
+  PagedCacheBuffer cache;
+  ASSERT_EQ(cache.Initialize(/*num_blocks=*/4, /*block_size=*/2,
+                             /*num_layers=*/1, /*entry_size=*/1),
+            kTfLiteOk);
+  ASSERT_EQ(cache.Reserve(0, 0, 2), kTfLiteOk);
+  EXPECT_EQ(*cache.GetBlockTable(0), std::vector<int>({0, 1}));
+  ASSERT_EQ(cache.Reserve(1, 0, 0), kTfLiteOk);
+  EXPECT_EQ(*cache.GetBlockTable(1), std::vector<int>({2}));
+  ASSERT_EQ(cache.Reserve(0, 3, 3), kTfLiteOk);
+  EXPECT_EQ(*cache.GetBlockTable(0), std::vector<int>({0, 1}));
+  EXPECT_EQ(cache.GetNumFreeBlocks(), 1);
+
+  // The pool only has one block left.
+  EXPECT_EQ(cache.Reserve(1, 2, 5), kTfLiteError);
+  EXPECT_EQ(cache.GetNumFreeBlocks(), 0);
+
+  cache.ReleaseSequence(0);
+  EXPECT_EQ(cache.GetBlockTable(0), nullptr);
+  EXPECT_EQ(cache.GetNumFreeBlocks(), 2);
+  EXPECT_EQ(cache.Reserve(1, 2, 5), kTfLiteOk);
+  EXPECT_EQ(cache.GetBlockTable(1)->size(), 3);
+}
+
+TEST(PagedCacheBufferTest, LayersAndValuesDoNotOverlap) {
+  PagedCacheBuffer cache;
+  ASSERT_EQ(cache.Initialize(/*num_blocks=*/2, /*block_size=*/2,
+                             /*num_layers=*/2, /*entry_size=*/3),
+            kTfLiteOk);
+  std::vector<float*> entries;
+  for (int block = 0; block < 2; ++block) {
+    for (int layer = 0; layer < 2; ++layer) {
+      for (int offset = 0; offset < 2; ++offset) {
+        entries.push_back(cache.GetKey(block, layer, offset));
+        entries.push_back(cache.GetValue(block, layer, offset));
+      }
+    }
+  }
+  for (int i = 0; i < entries.size(); ++i) {
+    for (int j = i + 1; j < entries.size(); ++j) {
+      EXPECT_GE(std::abs(entries[i] - entries[j]), 3);
+    }
+  }
+}
+
+TEST(PagedCacheBufferTest, ForkSharesBlocksAndCopiesOnWrite) {
+  PagedCacheBuffer cache;
+  ASSERT_EQ(cache.Initialize(/*num_blocks=*/4, /*block_size=*/2,
+                             /*num_layers=*/1, /*entry_size=*/1),
+            kTfLiteOk);
+  ASSERT_EQ(cache.Reserve(0, 0, 2), kTfLiteOk);
+  for (int position = 0; position < 3; ++position) {
+    const int block = (*cache.GetBlockTable(0))[position / 2];
+    *cache.GetKey(block, 0, position % 2) = position + 1;
+  }
+  cache.SetNumEntries(0, 3);
+
+  EXPECT_EQ(cache.ForkSequence(0, 1, 4), kTfLiteError);
+  ASSERT_EQ(cache.ForkSequence(0, 1, 3), kTfLiteOk);
+  EXPECT_EQ(*cache.GetBlockTable(1), std::vector<int>({0, 1}));
+  EXPECT_EQ(cache.GetNumEntries(1), 3);
+  EXPECT_EQ(cache.GetNumFreeBlocks(), 2);
+
+  // Writing to the partially filled block it shares copies it.
+  ASSERT_EQ(cache.Reserve(1, 3, 3), kTfLiteOk);
+  EXPECT_EQ(*cache.GetBlockTable(1), std::vector<int>({0, 2}));
+  EXPECT_EQ(*cache.GetBlockTable(0), std::vector<int>({0, 1}));
+  EXPECT_EQ(*cache.GetKey(2, 0, 0), 3);
+  *cache.GetKey(2, 0, 1) = 10;
+  EXPECT_EQ(*cache.GetKey(1, 0, 1), 0);
+
+  // The first block stays allocated until no sequence uses it.
+  cache.ReleaseSequence(0);
+  EXPECT_EQ(cache.GetNumFreeBlocks(), 2);
+  cache.ReleaseSequence(1);
+  EXPECT_EQ(cache.GetNumFreeBlocks(), 4);
+}
+
+}  // namespace resource
+}  // namespace tflite
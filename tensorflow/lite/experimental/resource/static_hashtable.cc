@@ -15,6 +15,8 @@ limitations under the License.
 
 #include "tensorflow/lite/experimental/resource/static_hashtable.h"
 
+#include <algorithm>
+#include <cstdint>
 #include <memory>
 #include <string>
 
@@ -23,6 +25,30 @@ limitations under the License.
 namespace tflite {
 namespace resource {
 namespace internal {
+namespace {
+
+// The number of keys whose slots are prefetched together by Lookup.
+constexpr int kLookupBatchSize = 16;
+
+inline void PrefetchSlot(const int32_t* slot) {
+#ifdef __GNUC__
+  __builtin_prefetch(slot, /*rw=*/0, /*locality=*/3);
+#else
+  (void)slot;
+#endif
+}
+
+}  // namespace
+
+template <typename KeyType, typename ValueType>
+int32_t StaticHashtable<KeyType, ValueType>::Find(KeyView key,
+                                                  size_t slot) const {
+  while (true) {
+    const int32_t index = slots_[slot];
+    if (index == kEmptySlot || keys_.Equals(index, key)) return index;
+    slot = (slot + 1) & slot_mask_;
+  }
+}
 
 template <typename KeyType, typename ValueType>
 TfLiteStatus StaticHashtable<KeyType, ValueType>::Lookup(
@@ -36,17 +62,31 @@ TfLiteStatus StaticHashtable<KeyType, ValueType>::Lookup(
   const int size =
       MatchingFlatSize(GetTensorShape(keys), GetTensorShape(values));
 
-  auto key_tensor_reader = TensorReader<KeyType>(keys);
   auto value_tensor_writer = TensorWriter<ValueType>(values);
   auto default_value_tensor_reader = TensorReader<ValueType>(default_value);
   ValueType first_default_value = default_value_tensor_reader.GetData(0);
 
-  for (int i = 0; i < size; ++i) {
-    auto result = map_.find(key_tensor_reader.GetData(i));
-    if (result != map_.end()) {
-      value_tensor_writer.SetData(i, result->second);
-    } else {
-      value_tensor_writer.SetData(i, first_default_value);
+  // The slots of a batch of keys are computed and prefetched before probing
+  // them, so that their cache misses overlap.
+  size_t slots[kLookupBatchSize];
+  for (int begin = 0; begin < size; begin += kLookupBatchSize) {
+    const int end = std::min(begin + kLookupBatchSize, size);
+    for (int i = begin; i < end; ++i) {
+      const size_t slot =
+          FlatHashtableKeys<KeyType>::Hash(
+              FlatHashtableKeys<KeyType>::Read(keys, i)) &
+          slot_mask_;
+      slots[i - begin] = slot;
+      PrefetchSlot(&slots_[slot]);
+    }
+    for (int i = begin; i < end; ++i) {
+      const int32_t index =
+          Find(FlatHashtableKeys<KeyType>::Read(keys, i), slots[i - begin]);
+      if (index != kEmptySlot) {
+        value_tensor_writer.SetData(i, values_[index]);
+      } else {
+        value_tensor_writer.SetData(i, first_default_value);
+      }
     }
   }
 
@@ -72,11 +112,29 @@ TfLiteStatus StaticHashtable<KeyType, ValueType>::Import(
   const int size =
       MatchingFlatSize(GetTensorShape(keys), GetTensorShape(values));
 
-  auto key_tensor_reader = TensorReader<KeyType>(keys);
-  auto value_tensor_writer = TensorReader<ValueType>(values);
+  // At most half full, with at least one empty slot to end the probes.
+  size_t num_slots = 2;
+  while (num_slots < 2 * static_cast<size_t>(size)) num_slots *= 2;
+  slots_.assign(num_slots, kEmptySlot);
+  slot_mask_ = num_slots - 1;
+  keys_.Reserve(size);
+  values_.reserve(size);
+
+  auto value_tensor_reader = TensorReader<ValueType>(values);
   for (int i = 0; i < size; ++i) {
-    map_.insert({key_tensor_reader.GetData(i), value_tensor_writer.GetData(i)});
+    const KeyView key = FlatHashtableKeys<KeyType>::Read(keys, i);
+    size_t slot = FlatHashtableKeys<KeyType>::Hash(key) & slot_mask_;
+    while (slots_[slot] != kEmptySlot && !keys_.Equals(slots_[slot], key)) {
+      slot = (slot + 1) & slot_mask_;
+    }
+    // Like the insertion into a map, the first value of a key is kept.
+    if (slots_[slot] != kEmptySlot) continue;
+    slots_[slot] = static_cast<int32_t>(values_.size());
+    keys_.Add(key);
+    values_.push_back(value_tensor_reader.GetData(i));
   }
+  keys_.ShrinkToFit();
+  values_.shrink_to_fit();
 
   is_initialized_ = true;
   return kTfLiteOk;
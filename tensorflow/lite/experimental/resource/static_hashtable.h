@@ -15,7 +15,10 @@ limitations under the License.
 #ifndef TENSORFLOW_LITE_EXPERIMENTAL_RESOURCE_STATIC_HASHTABLE_H_
 #define TENSORFLOW_LITE_EXPERIMENTAL_RESOURCE_STATIC_HASHTABLE_H_
 
-#include <unordered_map>
+#include <cstdint>
+#include <cstring>
+#include <string>
+#include <vector>
 
 #include "tensorflow/lite/core/c/common.h"
 #include "tensorflow/lite/experimental/resource/lookup_interfaces.h"
@@ -28,8 +31,92 @@ namespace tflite {
 namespace resource {
 namespace internal {
 
+// The keys of a StaticHashtable, stored contiguously in insertion order.
+template <typename KeyType>
+class FlatHashtableKeys;
+
+template <>
+class FlatHashtableKeys<std::int64_t> {
+ public:
+  using View = std::int64_t;
+
+  static View Read(const TfLiteTensor* keys, int index) {
+    return GetTensorData<std::int64_t>(keys)[index];
+  }
+
+  static std::uint64_t Hash(View key) {
+    // The finalizer of MurmurHash3, so that consecutive ids spread over the
+    // table.
+    std::uint64_t hash = static_cast<std::uint64_t>(key);
+    hash ^= hash >> 33;
+    hash *= 0xff51afd7ed558ccdULL;
+    hash ^= hash >> 33;
+    hash *= 0xc4ceb9fe1a85ec53ULL;
+    return hash ^ (hash >> 33);
+  }
+
+  void Reserve(int size) { keys_.reserve(size); }
+  void Add(View key) { keys_.push_back(key); }
+  bool Equals(int index, View key) const { return keys_[index] == key; }
+  void ShrinkToFit() { keys_.shrink_to_fit(); }
+  size_t GetMemoryUsage() const { return keys_.capacity() * sizeof(View); }
+
+ private:
+  std::vector<std::int64_t> keys_;
+};
+
+// String keys are concatenated into a single buffer instead of allocating one
+// std::string per key.
+template <>
+class FlatHashtableKeys<std::string> {
+ public:
+  using View = StringRef;
+
+  static View Read(const TfLiteTensor* keys, int index) {
+    return GetString(keys, index);
+  }
+
+  static std::uint64_t Hash(View key) {
+    // 64-bit FNV-1a.
+    std::uint64_t hash = 0xcbf29ce484222325ULL;
+    for (int i = 0; i < key.len; ++i) {
+      hash ^= static_cast<unsigned char>(key.str[i]);
+      hash *= 0x100000001b3ULL;
+    }
+    return hash ^ (hash >> 32);
+  }
+
+  void Reserve(int size) { offsets_.reserve(size + 1); }
+  void Add(View key) {
+    chars_.append(key.str, key.len);
+    offsets_.push_back(chars_.size());
+  }
+  bool Equals(int index, View key) const {
+    const size_t begin = offsets_[index];
+    return offsets_[index + 1] - begin == key.len &&
+           std::memcmp(chars_.data() + begin, key.str, key.len) == 0;
+  }
+  void ShrinkToFit() {
+    chars_.shrink_to_fit();
+    offsets_.shrink_to_fit();
+  }
+  size_t GetMemoryUsage() const {
+    return chars_.capacity() + offsets_.capacity() * sizeof(size_t);
+  }
+
+ private:
+  std::string chars_;
+  // The key `i` is chars_[offsets_[i], offsets_[i + 1]).
+  std::vector<size_t> offsets_ = {0};
+};
+
 // A static hash table class. This hash table allows initialization one time in
 // its life cycle. This hash table implements Tensorflow core's HashTableV2 op.
+//
+// Since the table is only built once, by Import, it uses open addressing with
+// linear probing over flat arrays: the keys and values are stored contiguously
+// in insertion order, and the slots of the table only hold their indices. The
+// table is kept at most half full so that most lookups probe a single slot.
 template <typename KeyType, typename ValueType>
 class StaticHashtable : public tflite::resource::LookupInterface {
  public:
@@ -49,7 +136,7 @@ class StaticHashtable : public tflite::resource::LookupInterface {
                       const TfLiteTensor* values) override;
 
   // Returns the item size of the hash table.
-  size_t Size() override { return map_.size(); }
+  size_t Size() override { return values_.size(); }
 
   TfLiteType GetKeyType() const override { return key_type_; }
   TfLiteType GetValueType() const override { return value_type_; }
@@ -65,13 +152,28 @@ class StaticHashtable : public tflite::resource::LookupInterface {
   // Returns true if the hash table is initialized.
   bool IsInitialized() override { return is_initialized_; }
 
-  size_t GetMemoryUsage() override { return map_.size() * sizeof(ValueType); }
+  size_t GetMemoryUsage() override {
+    return keys_.GetMemoryUsage() + values_.capacity() * sizeof(ValueType) +
+           slots_.capacity() * sizeof(int32_t);
+  }
 
  private:
+  using KeyView = typename FlatHashtableKeys<KeyType>::View;
+
+  static constexpr int32_t kEmptySlot = -1;
+
+  // Returns the index of `key` in keys_ and values_, or -1 if not found, by
+  // probing from `slot`, the slot of its hash.
+  int32_t Find(KeyView key, size_t slot) const;
+
   TfLiteType key_type_;
   TfLiteType value_type_;
 
-  std::unordered_map<KeyType, ValueType> map_;
+  FlatHashtableKeys<KeyType> keys_;
+  std::vector<ValueType> values_;
+  // The indices of the entries, or kEmptySlot. The size is a power of two.
+  std::vector<int32_t> slots_;
+  size_t slot_mask_ = 0;
   bool is_initialized_ = false;
 };
 
@@ -0,0 +1,180 @@
+/* Copyright 2024 The TensorFlow Authors. All Rights Reserved.
+
+Licensed under the Apache License, Version 2.0 (the "License");
+you may not use this file except in compliance with the License.
+You may obtain a copy of the License at
+
+    http://www.apache.org/licenses/LICENSE-2.0
+
+Unless required by applicable law or agreed to in writing, software
+distributed under the License is distributed on an "AS IS" BASIS,
+WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+See the License for the specific language governing permissions and
+limitations under the License.
+==============================================================================*/
+#include "tensorflow/lite/experimental/resource/static_hashtable.h"
+
+#include <cstdint>
+#include <cstdlib>
+#include <cstring>
+#include <memory>
+#include <string>
+#include <vector>
+
+#include <gtest/gtest.h>
+#include "tensorflow/lite/core/c/common.h"
+#include "tensorflow/lite/experimental/resource/lookup_interfaces.h"
+#include "tensorflow/lite/string_util.h"
+
+namespace tflite {
+namespace resource {
+namespace {
+
+// A 1-D tensor owning its data.
+class Tensor {
+ public:
+  explicit Tensor(const std::vector<std::int64_t>& data) {
+    const int size = data.size();
+    const size_t bytes = data.size() * sizeof(std::int64_t);
+    char* buffer = static_cast<char*>(malloc(bytes));
+    if (bytes > 0) std::memcpy(buffer, data.data(), bytes);
+    TfLiteTensorReset(kTfLiteInt64, /*name=*/nullptr,
+                      TfLiteIntArrayCreate(1), {}, buffer, bytes,
+                      kTfLiteDynamic, /*allocation=*/nullptr,
+                      /*is_variable=*/false, &tensor_);
+    tensor_.dims->data[0] = size;
+  }
+
+  explicit Tensor(const std::vector<std::string>& data) {
+    TfLiteTensorReset(kTfLiteString, /*name=*/nullptr,
+                      TfLiteIntArrayCreate(1), {}, /*buffer=*/nullptr,
+                      /*size=*/0, kTfLiteDynamic, /*allocation=*/nullptr,
+                      /*is_variable=*/false, &tensor_);
+    tensor_.dims->data[0] = data.size();
+    DynamicBuffer buffer;
+    for (const std::string& value : data) {
+      buffer.AddString(value.data(), value.size());
+    }
+    buffer.WriteToTensor(&tensor_, /*new_shape=*/nullptr);
+  }
+
+  ~Tensor() { TfLiteTensorFree(&tensor_); }
+
+  TfLiteTensor* get() { return &tensor_; }
+
+  std::int64_t GetInt64(int index) const { return tensor_.data.i64[index]; }
+
+  std::string GetString(int index) const {
+    const StringRef ref = tflite::GetString(&tensor_, index);
+    return std::string(ref.str, ref.len);
+  }
+
+ private:
+  TfLiteTensor tensor_ = {};
+};
+
+TEST(StaticHashtableTest, LooksUpStringKeys) {
+  std::unique_ptr<LookupInterface> table(
+      internal::CreateStaticHashtable(kTfLiteString, kTfLiteInt64));
+  ASSERT_NE(table, nullptr);
+  EXPECT_FALSE(table->IsInitialized());
+
+  Tensor keys(std::vector<std::string>{"the", "", "quick", "fox", "the"});
+  Tensor values(std::vector<std::int64_t>{1, 2, 3, 4, 5});
+  ASSERT_EQ(table->Import(nullptr, keys.get(), values.get()), kTfLiteOk);
+  EXPECT_TRUE(table->IsInitialized());
+  // The first value of a duplicate key is kept.
+  EXPECT_EQ(table->Size(), 4);
+
+  Tensor queries(
+      std::vector<std::string>{"fox", "quick", "th", "the", "", "foxes"});
+  Tensor results(std::vector<std::int64_t>(6));
+  Tensor default_value(std::vector<std::int64_t>{-1});
+  ASSERT_EQ(table->Lookup(nullptr, queries.get(), results.get(),
+                          default_value.get()),
+            kTfLiteOk);
+  const std::vector<std::int64_t> expected = {4, 3, -1, 1, 2, -1};
+  for (int i = 0; i < expected.size(); ++i) {
+    EXPECT_EQ(results.GetInt64(i), expected[i]) << i;
+  }
+}
+
+TEST(StaticHashtableTest, LooksUpInt64Keys) {
+  std::unique_ptr<LookupInterface> table(
+      internal::CreateStaticHashtable(kTfLiteInt64, kTfLiteString));
+  ASSERT_NE(table, nullptr);
+
+  Tensor keys(std::vector<std::int64_t>{7, -3, 1LL << 40});
+  Tensor values(std::vector<std::string>{"seven", "minus three", "big"});
+  ASSERT_EQ(table->Import(nullptr, keys.get(), values.get()), kTfLiteOk);
+  EXPECT_EQ(table->Size(), 3);
+
+  Tensor queries(std::vector<std::int64_t>{-3, 0, 1LL << 40, 7});
+  Tensor results(std::vector<std::string>(4));
+  Tensor default_value(std::vector<std::string>{"unknown"});
+  ASSERT_EQ(table->Lookup(nullptr, queries.get(), results.get(),
+                          default_value.get()),
+            kTfLiteOk);
+  EXPECT_EQ(results.GetString(0), "minus three");
+  EXPECT_EQ(results.GetString(1), "unknown");
+  EXPECT_EQ(results.GetString(2), "big");
+  EXPECT_EQ(results.GetString(3), "seven");
+}
+
+TEST(StaticHashtableTest, LooksUpManyKeysInBatches) {
+  std::unique_ptr<LookupInterface> table(
+      internal::CreateStaticHashtable(kTfLiteInt64, kTfLiteString));
+  ASSERT_NE(table, nullptr);
+
+  // Consecutive ids, which collide in a table indexed by the low bits.
+  constexpr int kSize = 1000;
+  std::vector<std::int64_t> key_data;
+  std::vector<std::string> value_data;
+  for (int i = 0; i < kSize; ++i) {
+    key_data.push_back(i * 1024);
+    value_data.push_back(std::to_string(i));
+  }
+  Tensor keys(key_data);
+  Tensor values(value_data);
+  ASSERT_EQ(table->Import(nullptr, keys.get(), values.get()), kTfLiteOk);
+  EXPECT_EQ(table->Size(), kSize);
+  // Importing again is ignored.
+  Tensor other_values(std::vector<std::string>(kSize, "other"));
+  ASSERT_EQ(table->Import(nullptr, keys.get(), other_values.get()),
+            kTfLiteOk);
+
+  std::vector<std::int64_t> query_data;
+  for (int i = 0; i < 2 * kSize; ++i) query_data.push_back(i * 512);
+  Tensor queries(query_data);
+  Tensor results(std::vector<std::string>(2 * kSize));
+  Tensor default_value(std::vector<std::string>{"none"});
+  ASSERT_EQ(table->Lookup(nullptr, queries.get(), results.get(),
+                          default_value.get()),
+            kTfLiteOk);
+  for (int i = 0; i < 2 * kSize; ++i) {
+    EXPECT_EQ(results.GetString(i), i % 2 ? "none" : std::to_string(i / 2))
+        << i;
+  }
+}
+
+TEST(StaticHashtableTest, LooksUpInEmptyTable) {
+  std::unique_ptr<LookupInterface> table(
+      internal::CreateStaticHashtable(kTfLiteString, kTfLiteInt64));
+  ASSERT_NE(table, nullptr);
+  Tensor keys(std::vector<std::string>{});
+  Tensor values(std::vector<std::int64_t>{});
+  ASSERT_EQ(table->Import(nullptr, keys.get(), values.get()), kTfLiteOk);
+  EXPECT_EQ(table->Size(), 0);
+
+  Tensor queries(std::vector<std::string>{"a"});
+  Tensor results(std::vector<std::int64_t>{0});
+  Tensor default_value(std::vector<std::int64_t>{42});
+  ASSERT_EQ(table->Lookup(nullptr, queries.get(), results.get(),
+                          default_value.get()),
+            kTfLiteOk);
+  EXPECT_EQ(results.GetInt64(0), 42);
+}
+
+}  // namespace
+}  // namespace resource
+}  // namespace tflite
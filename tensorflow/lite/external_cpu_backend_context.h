@@ -92,9 +92,27 @@ class ExternalCpuBackendContext : public TfLiteExternalContext {
     return internal_backend_context_.get();
   }
 
+  // Makes the internal backend context, when it is lazily initialized, run its
+  // parallel work on worker threads shared by all the interpreters of the
+  // process, instead of on thread pools of its own. Unlike sharing this
+  // context, each interpreter given its own context with this flag set may be
+  // invoked concurrently with the others: the workers take the tasks of the
+  // interpreters in turn.
+  //
+  //  auto* ctxt1 = new ExternalCpuBackendContext();
+  //  ctxt1->set_use_shared_thread_pool(true);
+  //  interpreter1->SetExternalContext(kTfLiteCpuBackendContext, ctxt1);
+  //  auto* ctxt2 = new ExternalCpuBackendContext();
+  //  ctxt2->set_use_shared_thread_pool(true);
+  //  interpreter2->SetExternalContext(kTfLiteCpuBackendContext, ctxt2);
+  void set_use_shared_thread_pool(bool flag) { use_shared_thread_pool_ = flag; }
+
+  bool use_shared_thread_pool() const { return use_shared_thread_pool_; }
+
  private:
   // Note the actual internal backend context object is lazily initialized.
   std::unique_ptr<TfLiteInternalBackendContext> internal_backend_context_;
+  bool use_shared_thread_pool_ = false;
 
   ExternalCpuBackendContext(const ExternalCpuBackendContext&) = delete;
   ExternalCpuBackendContext& operator=(const ExternalCpuBackendContext&) =
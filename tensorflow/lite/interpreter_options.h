@@ -103,12 +103,74 @@ class InterpreterOptions {
     return experimental_cache_constant_cast_op_;
   }
 
+  // If `value` > 1, the nodes of a subgraph that do not depend on each other
+  // are invoked concurrently on `value` threads. AllocateTensors() then orders
+  // the execution plan by dependency level, and the memory planner does not
+  // share memory between the tensors of nodes of the same level. Each node
+  // runs its kernel on a single thread. Delegated, custom, control flow and
+  // stateful nodes are still invoked alone, in their original order.
+  //
+  // WARNING: This is an experimental API and subject to change.
+  void SetNumParallelNodeThreads(int value) {
+    experimental_num_parallel_node_threads_ = value;
+  }
+
+  // Returns the number of threads invoking independent nodes concurrently, or
+  // a value <= 1 if nodes are invoked one at a time.
+  //
+  // WARNING: This is an experimental API and subject to change.
+  int GetNumParallelNodeThreads() const {
+    return experimental_num_parallel_node_threads_;
+  }
+
+  // If set to `true`, AllocateTensors() after ResizeInputTensor() only
+  // prepares again the nodes whose inputs were resized, directly or through
+  // the outputs of other nodes prepared again, and keeps the memory planned
+  // for the tensors that still fit in it. Variable tensors are then not reset
+  // to zero. Models with delegates, custom allocations or dynamic tensors are
+  // always prepared again in full.
+  //
+  // WARNING: This is an experimental API and subject to change.
+  void SetIncrementalPrepareOnResize(bool value = true) {
+    experimental_incremental_prepare_on_resize_ = value;
+  }
+
+  // Returns if the `experimental_incremental_prepare_on_resize_` feature is
+  // enabled.
+  //
+  // WARNING: This is an experimental API and subject to change.
+  bool GetIncrementalPrepareOnResize() const {
+    return experimental_incremental_prepare_on_resize_;
+  }
+
+  // If set to `true`, applying a delegate to a model mapped from a file
+  // releases from the resident memory the pages of the constant tensors that
+  // only the delegate reads, typically weights it has copied or packed. They
+  // are read again from the file if accessed later, e.g. after the delegate is
+  // removed, so this is safe but may slow down such accesses.
+  //
+  // WARNING: This is an experimental API and subject to change.
+  void SetReleaseDelegatedWeights(bool value = true) {
+    experimental_release_delegated_weights_ = value;
+  }
+
+  // Returns if the `experimental_release_delegated_weights_` feature is
+  // enabled.
+  //
+  // WARNING: This is an experimental API and subject to change.
+  bool GetReleaseDelegatedWeights() const {
+    return experimental_release_delegated_weights_;
+  }
+
  private:
   bool experimental_preserve_all_tensors_ = false;
   bool experimental_ensure_dynamic_tensors_are_released_ = false;
   int experimental_optimize_memory_for_large_tensors_ = 0;
   bool experimental_disable_delegate_clustering_ = false;
   bool experimental_cache_constant_cast_op_ = false;
+  int experimental_num_parallel_node_threads_ = 1;
+  bool experimental_incremental_prepare_on_resize_ = false;
+  bool experimental_release_delegated_weights_ = false;
 };
 
 }  // namespace tflite
@@ -116,6 +116,10 @@ CpuBackendContext* CpuBackendContext::GetFromContext(TfLiteContext* context) {
     // We do the lazy initialization here for the TfLiteInternalBackendContext
     // that's wrapped inside ExternalCpuBackendContext.
     cpu_backend_context = new CpuBackendContext();
+    if (external_context->use_shared_thread_pool()) {
+      cpu_backend_context->SetSharedThreadPool(
+          CpuBackendSharedThreadPool::Global());
+    }
     cpu_backend_context->SetMaxNumThreads(context->recommended_num_threads);
     external_context->set_internal_backend_context(
         std::unique_ptr<TfLiteInternalBackendContext>(cpu_backend_context));
@@ -124,6 +128,13 @@ CpuBackendContext* CpuBackendContext::GetFromContext(TfLiteContext* context) {
   return cpu_backend_context;
 }
 
+CpuBackendContext* CpuBackendContext::GetForCurrentThread() {
+  thread_local CpuBackendContext context;
+  // The tasks of a GEMM are only split from GEMMs that don't cache.
+  context.SetUseCaching(false);
+  return &context;
+}
+
 CpuBackendContext::CpuBackendContext()
     : TfLiteInternalBackendContext(),
       ruy_context_(new ruy::Context),
@@ -143,8 +154,17 @@ void CpuBackendContext::SetMaxNumThreads(int max_num_threads) {
   const int target_num_threads =
       max_num_threads > -1 ? max_num_threads : kDefaultNumThreadpoolThreads;
   max_num_threads_ = target_num_threads;
-  ruy_context_->set_max_num_threads(target_num_threads);
-  gemmlowp_context_->set_max_num_threads(target_num_threads);
+  // With a shared thread pool, the parallel work of ruy and gemmlowp is split
+  // into tasks by cpu_backend_gemm::Gemm() instead.
+  const int backend_num_threads =
+      shared_thread_pool_queue_ ? 1 : target_num_threads;
+  ruy_context_->set_max_num_threads(backend_num_threads);
+  gemmlowp_context_->set_max_num_threads(backend_num_threads);
+}
+
+void CpuBackendContext::SetSharedThreadPool(CpuBackendSharedThreadPool* pool) {
+  shared_thread_pool_queue_ = pool ? pool->CreateQueue() : nullptr;
+  SetMaxNumThreads(max_num_threads_);
 }
 
 void CpuBackendContext::SetUseCaching(bool flag) { use_caching_ = flag; }
@@ -28,6 +28,7 @@ limitations under the License.
 #include "ruy/context.h"  // from @ruy
 #include "tensorflow/lite/core/c/common.h"
 #include "tensorflow/lite/external_cpu_backend_context.h"
+#include "tensorflow/lite/kernels/cpu_backend_shared_threadpool.h"
 
 namespace tflite {
 
@@ -35,6 +36,10 @@ class CpuBackendContext final : public TfLiteInternalBackendContext {
  public:
   static CpuBackendContext* GetFromContext(TfLiteContext* context);
 
+  // Returns a context of the calling thread, limited to one thread, for tasks
+  // executed on a shared thread pool to run single-threaded computations with.
+  static CpuBackendContext* GetForCurrentThread();
+
   CpuBackendContext();
   ~CpuBackendContext() override;
 
@@ -58,6 +63,18 @@ class CpuBackendContext final : public TfLiteInternalBackendContext {
 
   void ClearCaches() override { ruy_context_->ClearPrepackedCache(); }
 
+  // Makes the tasks given to cpu_backend_threadpool::Execute() and the GEMMs
+  // run on `pool`, which must outlive this context, instead of on the thread
+  // pools of ruy and gemmlowp, which are then limited to the calling thread.
+  // Must be called before any computation.
+  void SetSharedThreadPool(CpuBackendSharedThreadPool* pool);
+
+  // Returns the queue of this context on its shared thread pool, or null if
+  // it uses thread pools of its own.
+  CpuBackendSharedThreadPool::Queue* shared_thread_pool_queue() const {
+    return shared_thread_pool_queue_.get();
+  }
+
   // Gemmlowp on x86 is a deprecated path but some clients may still use
   // this path based on link time dependencies.
   bool PreferGemmlowpOnX86();
@@ -123,6 +140,9 @@ class CpuBackendContext final : public TfLiteInternalBackendContext {
   std::unique_ptr<pthreadpool, decltype(&pthreadpool_destroy)>
       xnnpack_threadpool_{nullptr, &pthreadpool_destroy};
 
+  // The queue of this context on the pool given to SetSharedThreadPool().
+  std::unique_ptr<CpuBackendSharedThreadPool::Queue> shared_thread_pool_queue_;
+
   CpuBackendContext(const CpuBackendContext&) = delete;
 };
 
@@ -16,6 +16,7 @@ limitations under the License.
 #ifndef TENSORFLOW_LITE_KERNELS_CPU_BACKEND_GEMM_H_
 #define TENSORFLOW_LITE_KERNELS_CPU_BACKEND_GEMM_H_
 
+#include <algorithm>
 #include <cstdint>
 
 #include "ruy/profiler/instrumentation.h"  // from @ruy
@@ -23,6 +24,7 @@ limitations under the License.
 #include "tensorflow/lite/kernels/cpu_backend_gemm_custom_gemv.h"
 #include "tensorflow/lite/kernels/cpu_backend_gemm_params.h"
 #include "tensorflow/lite/kernels/cpu_backend_gemm_ruy.h"
+#include "tensorflow/lite/kernels/cpu_backend_shared_threadpool.h"
 
 #ifndef TFLITE_WITH_RUY
 #include "tensorflow/lite/kernels/cpu_backend_gemm_eigen.h"
@@ -109,6 +111,59 @@ struct GemmImpl<float, float, float, float, QuantizationFlavor::kFloatingPoint>
 
 #endif  // not TFLITE_WITH_RUY and TFLITE_X86_PLATFORM
 
+namespace detail {
+
+// The minimum number of multiply-accumulates of the tasks split from a GEMM by
+// GemmOnSharedThreadPool().
+constexpr std::int64_t kMinSharedThreadPoolGemmTaskSize = 1 << 16;
+
+// Splits a GEMM of a context with a shared thread pool in tasks computing
+// blocks of columns of the destination, each on a single-threaded context of
+// the thread running it, and calls `gemm` for each block with its rhs and
+// destination columns. Returns false, without calling `gemm`, if the GEMM
+// should run on `context` instead. GEMMs caching prepacked matrices aren't
+// split, as each thread would cache them.
+template <typename LhsScalar, typename RhsScalar, typename DstScalar,
+          typename GemmFn>
+bool GemmOnSharedThreadPool(const MatrixParams<LhsScalar>& lhs_params,
+                            const MatrixParams<RhsScalar>& rhs_params,
+                            const RhsScalar* rhs_data,
+                            const MatrixParams<DstScalar>& dst_params,
+                            DstScalar* dst_data, CpuBackendContext* context,
+                            const GemmFn& gemm) {
+  CpuBackendSharedThreadPool::Queue* queue =
+      context->shared_thread_pool_queue();
+  if (queue == nullptr || context->use_caching() ||
+      rhs_params.order != Order::kColMajor ||
+      dst_params.order != Order::kColMajor) {
+    return false;
+  }
+  const std::int64_t size = static_cast<std::int64_t>(dst_params.rows) *
+                            dst_params.cols * lhs_params.cols;
+  const int tasks_count = static_cast<int>(std::min<std::int64_t>(
+      {context->max_num_threads(), dst_params.cols,
+       size / kMinSharedThreadPoolGemmTaskSize}));
+  if (tasks_count <= 1) {
+    return false;
+  }
+  queue->Execute(tasks_count, [&](int task) {
+    const int first_col = static_cast<std::int64_t>(dst_params.cols) * task /
+                          tasks_count;
+    const int end_col = static_cast<std::int64_t>(dst_params.cols) *
+                        (task + 1) / tasks_count;
+    MatrixParams<RhsScalar> block_rhs_params = rhs_params;
+    block_rhs_params.cols = end_col - first_col;
+    MatrixParams<DstScalar> block_dst_params = dst_params;
+    block_dst_params.cols = end_col - first_col;
+    gemm(block_rhs_params, rhs_data + first_col * rhs_params.rows,
+         block_dst_params, dst_data + first_col * dst_params.rows,
+         CpuBackendContext::GetForCurrentThread());
+  });
+  return true;
+}
+
+}  // namespace detail
+
 /* Public entry point */
 
 template <typename LhsScalar, typename RhsScalar, typename AccumScalar,
@@ -127,6 +182,16 @@ void Gemm(const MatrixParams<LhsScalar>& lhs_params, const LhsScalar* lhs_data,
     TFLITE_DCHECK(false);
     return;
   }
+  if (detail::GemmOnSharedThreadPool(
+          lhs_params, rhs_params, rhs_data, dst_params, dst_data, context,
+          [&](const auto& block_rhs_params, const auto* block_rhs_data,
+              const auto& block_dst_params, auto* block_dst_data,
+              CpuBackendContext* block_context) {
+            Gemm(lhs_params, lhs_data, block_rhs_params, block_rhs_data,
+                 block_dst_params, block_dst_data, params, block_context);
+          })) {
+    return;
+  }
   // In some cases we want to unconditionally use ruy as the backend, overriding
   // the `tflite_with_ruy` setting and the platform default.
   bool must_use_ruy = false;
@@ -184,6 +249,16 @@ void Gemm(const MatrixParams<int8_t>& lhs_params, const int8_t* lhs_data,
     TFLITE_DCHECK(false);
     return;
   }
+  if (detail::GemmOnSharedThreadPool(
+          lhs_params, rhs_params, rhs_data, dst_params, dst_data, context,
+          [&](const auto& block_rhs_params, const auto* block_rhs_data,
+              const auto& block_dst_params, auto* block_dst_data,
+              CpuBackendContext* block_context) {
+            Gemm(lhs_params, lhs_data, block_rhs_params, block_rhs_data,
+                 block_dst_params, block_dst_data, params, block_context);
+          })) {
+    return;
+  }
 
   // Currently, only Ruy backend supports 16x8 quant gemm so we use ruy
   // only.
@@ -205,6 +280,16 @@ void Gemm(const MatrixParams<LhsScalar>& lhs_params, const LhsScalar* lhs_data,
           CpuBackendContext* context) {
   ruy::profiler::ScopeLabel label("cpu_backend_gemm::Gemm");
   ValidateParams(lhs_params, rhs_params, dst_params, params);
+  if (detail::GemmOnSharedThreadPool(
+          lhs_params, rhs_params, rhs_data, dst_params, dst_data, context,
+          [&](const auto& block_rhs_params, const auto* block_rhs_data,
+              const auto& block_dst_params, auto* block_dst_data,
+              CpuBackendContext* block_context) {
+            Gemm(lhs_params, lhs_data, block_rhs_params, block_rhs_data,
+                 block_dst_params, block_dst_data, params, block_context);
+          })) {
+    return;
+  }
 
   // Currently, only Ruy backend supports get raw accumulator, so we use ruy
   // only.
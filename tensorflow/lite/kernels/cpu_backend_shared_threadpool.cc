@@ -0,0 +1,165 @@
+/* Copyright 2024 The TensorFlow Authors. All Rights Reserved.
+
+Licensed under the Apache License, Version 2.0 (the "License");
+you may not use this file except in compliance with the License.
+You may obtain a copy of the License at
+
+    http://www.apache.org/licenses/LICENSE-2.0
+
+Unless required by applicable law or agreed to in writing, software
+distributed under the License is distributed on an "AS IS" BASIS,
+WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+See the License for the specific language governing permissions and
+limitations under the License.
+==============================================================================*/
+
+#include "tensorflow/lite/kernels/cpu_backend_shared_threadpool.h"
+
+#include <algorithm>
+#include <condition_variable>  // NOLINT(build/c++11)
+#include <functional>
+#include <memory>
+#include <mutex>  // NOLINT(build/c++11)
+#include <thread>  // NOLINT(build/c++11)
+
+namespace tflite {
+
+// The tasks of one call to Queue::Execute().
+struct CpuBackendSharedThreadPool::Queue::Job {
+  Queue* queue;
+  const std::function<void(int)>* run_task;
+  int tasks_count;
+  // Index of the next task to take.
+  int next_task = 0;
+  // Number of tasks taken and not done yet.
+  int running_tasks = 0;
+};
+
+CpuBackendSharedThreadPool::Queue::~Queue() {
+  std::lock_guard<std::mutex> lock(pool_->mutex_);
+  auto& queues = pool_->queues_;
+  queues.erase(std::find(queues.begin(), queues.end(), this));
+  if (pool_->next_queue_ >= queues.size()) {
+    pool_->next_queue_ = 0;
+  }
+}
+
+void CpuBackendSharedThreadPool::Queue::Execute(
+    int tasks_count, const std::function<void(int)>& run_task) {
+  if (tasks_count <= 0) {
+    return;
+  }
+  if (tasks_count == 1 || pool_->workers_.empty()) {
+    for (int i = 0; i < tasks_count; ++i) {
+      run_task(i);
+    }
+    return;
+  }
+  Job job;
+  job.queue = this;
+  job.run_task = &run_task;
+  job.tasks_count = tasks_count;
+  std::unique_lock<std::mutex> lock(pool_->mutex_);
+  jobs_.push_back(&job);
+  // The calling thread runs one of the tasks at least.
+  const int workers_needed =
+      std::min(tasks_count - 1, static_cast<int>(pool_->workers_.size()));
+  for (int i = 0; i < workers_needed; ++i) {
+    pool_->work_available_.notify_one();
+  }
+  // Run the tasks not taken by the workers yet, then wait for theirs.
+  int task_index;
+  while (pool_->TakeTaskOf(&job, &task_index)) {
+    lock.unlock();
+    run_task(task_index);
+    lock.lock();
+    pool_->FinishTask(&job);
+  }
+  pool_->job_done_.wait(lock, [&job] { return job.running_tasks == 0; });
+}
+
+CpuBackendSharedThreadPool::CpuBackendSharedThreadPool(int num_threads) {
+  workers_.reserve(std::max(num_threads, 0));
+  for (int i = 0; i < num_threads; ++i) {
+    workers_.emplace_back([this] { WorkerLoop(); });
+  }
+}
+
+CpuBackendSharedThreadPool::~CpuBackendSharedThreadPool() {
+  {
+    std::lock_guard<std::mutex> lock(mutex_);
+    stopping_ = true;
+  }
+  work_available_.notify_all();
+  for (std::thread& worker : workers_) {
+    worker.join();
+  }
+}
+
+CpuBackendSharedThreadPool* CpuBackendSharedThreadPool::Global() {
+  static CpuBackendSharedThreadPool* const pool =
+      new CpuBackendSharedThreadPool(std::max(
+          static_cast<int>(std::thread::hardware_concurrency()) - 1, 0));
+  return pool;
+}
+
+std::unique_ptr<CpuBackendSharedThreadPool::Queue>
+CpuBackendSharedThreadPool::CreateQueue() {
+  std::unique_ptr<Queue> queue(new Queue(this));
+  std::lock_guard<std::mutex> lock(mutex_);
+  queues_.push_back(queue.get());
+  return queue;
+}
+
+void CpuBackendSharedThreadPool::WorkerLoop() {
+  std::unique_lock<std::mutex> lock(mutex_);
+  while (true) {
+    Queue::Job* job;
+    int task_index;
+    work_available_.wait(lock, [&] {
+      return stopping_ || TakeTask(&job, &task_index);
+    });
+    if (stopping_) {
+      return;
+    }
+    lock.unlock();
+    (*job->run_task)(task_index);
+    lock.lock();
+    FinishTask(job);
+  }
+}
+
+bool CpuBackendSharedThreadPool::TakeTask(Queue::Job** job, int* task_index) {
+  for (size_t i = 0; i < queues_.size(); ++i) {
+    Queue* queue = queues_[(next_queue_ + i) % queues_.size()];
+    if (!queue->jobs_.empty()) {
+      *job = queue->jobs_.front();
+      TakeTaskOf(*job, task_index);
+      next_queue_ = (next_queue_ + i + 1) % queues_.size();
+      return true;
+    }
+  }
+  return false;
+}
+
+bool CpuBackendSharedThreadPool::TakeTaskOf(Queue::Job* job, int* task_index) {
+  if (job->next_task == job->tasks_count) {
+    return false;
+  }
+  *task_index = job->next_task++;
+  ++job->running_tasks;
+  if (job->next_task == job->tasks_count) {
+    // The job has no task left to take, remove it from its queue.
+    auto& jobs = job->queue->jobs_;
+    jobs.erase(std::find(jobs.begin(), jobs.end(), job));
+  }
+  return true;
+}
+
+void CpuBackendSharedThreadPool::FinishTask(Queue::Job* job) {
+  if (--job->running_tasks == 0 && job->next_task == job->tasks_count) {
+    job_done_.notify_all();
+  }
+}
+
+}  // namespace tflite
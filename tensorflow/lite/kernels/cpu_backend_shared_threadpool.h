@@ -0,0 +1,116 @@
+/* Copyright 2024 The TensorFlow Authors. All Rights Reserved.
+
+Licensed under the Apache License, Version 2.0 (the "License");
+you may not use this file except in compliance with the License.
+You may obtain a copy of the License at
+
+    http://www.apache.org/licenses/LICENSE-2.0
+
+Unless required by applicable law or agreed to in writing, software
+distributed under the License is distributed on an "AS IS" BASIS,
+WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+See the License for the specific language governing permissions and
+limitations under the License.
+==============================================================================*/
+
+#ifndef TENSORFLOW_LITE_KERNELS_CPU_BACKEND_SHARED_THREADPOOL_H_
+#define TENSORFLOW_LITE_KERNELS_CPU_BACKEND_SHARED_THREADPOOL_H_
+
+#include <condition_variable>  // NOLINT(build/c++11)
+#include <cstddef>
+#include <deque>
+#include <functional>
+#include <memory>
+#include <mutex>  // NOLINT(build/c++11)
+#include <thread>  // NOLINT(build/c++11)
+#include <vector>
+
+namespace tflite {
+
+// A pool of worker threads shared by the cpu backend contexts of any number of
+// interpreters, so that a process running many interpreters doesn't create a
+// thread pool for each of them.
+//
+// Each context submits its tasks to a queue of its own. The workers take the
+// tasks of the queues in turn, so that an interpreter running a large op
+// doesn't hold back the ops of the others. A thread executing tasks runs them
+// too, which guarantees progress even when all the workers are busy, e.g. with
+// tasks executing tasks of their own.
+class CpuBackendSharedThreadPool {
+ public:
+  // The tasks submitted by one client of the pool, e.g. a CpuBackendContext.
+  // Any number of threads may execute tasks on the same queue concurrently.
+  class Queue {
+   public:
+    ~Queue();
+
+    // Calls `run_task(i)` for every `i` in [0, tasks_count) on the workers of
+    // the pool and on the calling thread, and returns when all the calls have
+    // returned.
+    void Execute(int tasks_count, const std::function<void(int)>& run_task);
+
+   private:
+    friend class CpuBackendSharedThreadPool;
+
+    struct Job;
+
+    explicit Queue(CpuBackendSharedThreadPool* pool) : pool_(pool) {}
+    Queue(const Queue&) = delete;
+    Queue& operator=(const Queue&) = delete;
+
+    CpuBackendSharedThreadPool* const pool_;
+    // Jobs with tasks not taken yet, in submission order. Guarded by the mutex
+    // of `pool_`.
+    std::deque<Job*> jobs_;
+  };
+
+  // Starts `num_threads` workers.
+  explicit CpuBackendSharedThreadPool(int num_threads);
+
+  // Stops the workers. All the queues must have been destroyed.
+  ~CpuBackendSharedThreadPool();
+
+  // Returns the pool shared by the whole process, which has a worker for each
+  // hardware thread but one, that of the thread executing the tasks. It is
+  // created by the first call and never destroyed.
+  static CpuBackendSharedThreadPool* Global();
+
+  // Returns a new queue to submit tasks to the pool.
+  std::unique_ptr<Queue> CreateQueue();
+
+  int num_threads() const { return static_cast<int>(workers_.size()); }
+
+ private:
+  CpuBackendSharedThreadPool(const CpuBackendSharedThreadPool&) = delete;
+  CpuBackendSharedThreadPool& operator=(const CpuBackendSharedThreadPool&) =
+      delete;
+
+  void WorkerLoop();
+
+  // Takes the next task of the first queue with one, in turn from the queue
+  // after the one of the previous task. Returns false if no queue has a task.
+  // Must be called with `mutex_` held.
+  bool TakeTask(Queue::Job** job, int* task_index);
+
+  // Takes the next task of `job`. Must be called with `mutex_` held.
+  bool TakeTaskOf(Queue::Job* job, int* task_index);
+
+  // Marks a task of `job` as done. Must be called with `mutex_` held.
+  void FinishTask(Queue::Job* job);
+
+  std::mutex mutex_;
+  // Signaled when a job is submitted or the pool is stopping.
+  std::condition_variable work_available_;
+  // Signaled when all the tasks of a job are done.
+  std::condition_variable job_done_;
+  // The queues created by CreateQueue() and not destroyed yet.
+  std::vector<Queue*> queues_;
+  // Index in `queues_` of the queue to take the next task from.
+  size_t next_queue_ = 0;
+  bool stopping_ = false;
+  std::vector<std::thread> workers_;
+};
+
+}  // namespace tflite
+
+#endif  // TENSORFLOW_LITE_KERNELS_CPU_BACKEND_SHARED_THREADPOOL_H_
@@ -0,0 +1,83 @@
+/* Copyright 2024 The TensorFlow Authors. All Rights Reserved.
+
+Licensed under the Apache License, Version 2.0 (the "License");
+you may not use this file except in compliance with the License.
+You may obtain a copy of the License at
+
+    http://www.apache.org/licenses/LICENSE-2.0
+
+Unless required by applicable law or agreed to in writing, software
+distributed under the License is distributed on an "AS IS" BASIS,
+WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+See the License for the specific language governing permissions and
+limitations under the License.
+==============================================================================*/
+
+#include "tensorflow/lite/kernels/cpu_backend_shared_threadpool.h"
+
+#include <atomic>
+#include <memory>
+#include <thread>  // NOLINT(build/c++11)
+#include <vector>
+
+#include <gtest/gtest.h>
+
+namespace tflite {
+namespace {
+
+void ExpectIncrementingInts(CpuBackendSharedThreadPool::Queue* queue,
+                            int tasks_count) {
+  std::vector<int> buffer(tasks_count, -1);
+  queue->Execute(tasks_count, [&buffer](int i) { buffer[i] = i; });
+  for (int i = 0; i < tasks_count; ++i) {
+    ASSERT_EQ(buffer[i], i);
+  }
+}
+
+TEST(CpuBackendSharedThreadPoolTest, ExecutesAllTasks) {
+  CpuBackendSharedThreadPool pool(3);
+  EXPECT_EQ(pool.num_threads(), 3);
+  std::unique_ptr<CpuBackendSharedThreadPool::Queue> queue =
+      pool.CreateQueue();
+  for (int tasks_count : {0, 1, 2, 3, 4, 100}) {
+    ExpectIncrementingInts(queue.get(), tasks_count);
+  }
+}
+
+TEST(CpuBackendSharedThreadPoolTest, ExecutesAllTasksWithoutWorkers) {
+  CpuBackendSharedThreadPool pool(0);
+  std::unique_ptr<CpuBackendSharedThreadPool::Queue> queue =
+      pool.CreateQueue();
+  ExpectIncrementingInts(queue.get(), 10);
+}
+
+TEST(CpuBackendSharedThreadPoolTest, ExecutesTasksOfConcurrentQueues) {
+  CpuBackendSharedThreadPool pool(2);
+  std::vector<std::thread> clients;
+  for (int c = 0; c < 4; ++c) {
+    clients.emplace_back([&pool] {
+      std::unique_ptr<CpuBackendSharedThreadPool::Queue> queue =
+          pool.CreateQueue();
+      for (int j = 0; j < 50; ++j) {
+        ExpectIncrementingInts(queue.get(), 8);
+      }
+    });
+  }
+  for (std::thread& client : clients) {
+    client.join();
+  }
+}
+
+TEST(CpuBackendSharedThreadPoolTest, ExecutesNestedTasks) {
+  CpuBackendSharedThreadPool pool(2);
+  std::unique_ptr<CpuBackendSharedThreadPool::Queue> queue =
+      pool.CreateQueue();
+  std::atomic<int> sum(0);
+  queue->Execute(4, [&](int i) {
+    queue->Execute(4, [&](int j) { sum += i * 4 + j; });
+  });
+  EXPECT_EQ(sum, 15 * 16 / 2);
+}
+
+}  // namespace
+}  // namespace tflite
@@ -17,6 +17,7 @@ limitations under the License.
 #define TENSORFLOW_LITE_KERNELS_CPU_BACKEND_THREADPOOL_H_
 
 #include "tensorflow/lite/kernels/cpu_backend_context.h"
+#include "tensorflow/lite/kernels/cpu_backend_shared_threadpool.h"
 #include "tensorflow/lite/kernels/internal/compatibility.h"
 
 #ifdef TFLITE_WITH_RUY
@@ -29,6 +30,24 @@ limitations under the License.
 namespace tflite {
 namespace cpu_backend_threadpool {
 
+namespace detail {
+
+// Runs the tasks on the shared thread pool of `cpu_backend_context`, if it has
+// one. Returns false otherwise.
+template <typename TaskType>
+bool ExecuteOnSharedThreadPool(int tasks_count, TaskType* tasks,
+                               CpuBackendContext* cpu_backend_context) {
+  CpuBackendSharedThreadPool::Queue* queue =
+      cpu_backend_context->shared_thread_pool_queue();
+  if (queue == nullptr) {
+    return false;
+  }
+  queue->Execute(tasks_count, [tasks](int i) { tasks[i].Run(); });
+  return true;
+}
+
+}  // namespace detail
+
 #ifdef TFLITE_WITH_RUY
 
 using Task = ruy::Task;
@@ -37,6 +56,10 @@ template <typename TaskType>
 void Execute(int tasks_count, TaskType* tasks,
              CpuBackendContext* cpu_backend_context) {
   TFLITE_DCHECK_LE(tasks_count, cpu_backend_context->max_num_threads());
+  if (detail::ExecuteOnSharedThreadPool(tasks_count, tasks,
+                                        cpu_backend_context)) {
+    return;
+  }
   cpu_backend_context->ruy_context()->mutable_thread_pool()->Execute(
       tasks_count, tasks);
 }
@@ -49,6 +72,10 @@ template <typename TaskType>
 void Execute(int tasks_count, TaskType* tasks,
              CpuBackendContext* cpu_backend_context) {
   TFLITE_DCHECK_LE(tasks_count, cpu_backend_context->max_num_threads());
+  if (detail::ExecuteOnSharedThreadPool(tasks_count, tasks,
+                                        cpu_backend_context)) {
+    return;
+  }
   cpu_backend_context->gemmlowp_context()->workers_pool()->Execute(tasks_count,
                                                                    tasks);
 }
@@ -19,6 +19,7 @@ limitations under the License.
 
 #include <gtest/gtest.h>
 #include "tensorflow/lite/kernels/cpu_backend_context.h"
+#include "tensorflow/lite/kernels/cpu_backend_shared_threadpool.h"
 
 namespace tflite {
 
@@ -42,7 +43,9 @@ class TestGenerateArrayOfIncrementingIntsTask
   int end_;
 };
 
-void TestGenerateArrayOfIncrementingInts(int num_threads, int size) {
+void TestGenerateArrayOfIncrementingInts(
+    int num_threads, int size,
+    CpuBackendSharedThreadPool* shared_thread_pool = nullptr) {
   // The buffer that our threads will write to.
   std::vector<int> buffer(size);
 
@@ -63,6 +66,9 @@ void TestGenerateArrayOfIncrementingInts(int num_threads, int size) {
   ASSERT_EQ(num_threads, tasks.size());
 
   CpuBackendContext context;
+  if (shared_thread_pool) {
+    context.SetSharedThreadPool(shared_thread_pool);
+  }
   // This SetMaxNumThreads is only to satisfy an assertion in Execute.
   // What actually determines the number of threads used is the parameter
   // passed to Execute, since Execute does 1:1 mapping of tasks to threads.
@@ -89,6 +95,11 @@ TEST(CpuBackendThreadpoolTest, TenThreadsSize1234567) {
   TestGenerateArrayOfIncrementingInts(10, 1234567);
 }
 
+TEST(CpuBackendThreadpoolTest, TenThreadsSize1234567OnSharedThreadPool) {
+  CpuBackendSharedThreadPool shared_thread_pool(3);
+  TestGenerateArrayOfIncrementingInts(10, 1234567, &shared_thread_pool);
+}
+
 }  // namespace
 
 }  // namespace tflite
@@ -66,9 +66,14 @@ limitations under the License.
 
 #include <algorithm>
 #include <cmath>
+#include <cstddef>
+#include <vector>
 
 #include "tensorflow/lite/core/c/builtin_op_data.h"
 #include "tensorflow/lite/core/c/common.h"
+#include "tensorflow/lite/kernels/cpu_backend_context.h"
+#include "tensorflow/lite/kernels/cpu_backend_threadpool.h"
+#include "tensorflow/lite/kernels/internal/common.h"
 #include "tensorflow/lite/kernels/internal/tensor_ctypes.h"
 #include "tensorflow/lite/kernels/internal/tensor_utils.h"
 #include "tensorflow/lite/kernels/kernel_util.h"
@@ -80,6 +85,13 @@ namespace builtin {
 
 namespace {
 
+// The number of lookups ahead whose embedding rows are prefetched, since the
+// rows are gathered in a random order.
+constexpr int kPrefetchDistance = 4;
+
+// The minimum number of output values accumulated per thread.
+constexpr size_t kMinElementsPerTask = 16 * 1024;
+
 TfLiteStatus Prepare(TfLiteContext* context, TfLiteNode* node) {
   TF_LITE_ENSURE_EQ(context, NumInputs(node), 5);
   TF_LITE_ENSURE_EQ(context, NumOutputs(node), 1);
@@ -144,6 +156,63 @@ void FinalizeAggregation(TfLiteCombinerType combiner, int num_elements,
   }
 }
 
+// The consecutive lookups [begin, end) aggregated into the same output row at
+// output_offset, or skipped if output_offset is out of bounds.
+struct Segment {
+  int begin;
+  int end;
+  size_t output_offset;
+  bool in_bounds;
+};
+
+struct AggregationData {
+  TfLiteCombinerType combiner;
+  const int* ids;
+  const float* weights;
+  const float* values;
+  int num_lookups;
+  size_t embedding_size;
+  float* output;
+};
+
+void AggregateSegment(const AggregationData& data, const Segment& segment) {
+  if (!segment.in_bounds) return;
+  float* output = data.output + segment.output_offset;
+  float total_weight = 0.0;
+  float squares_weight = 0.0;
+  for (int i = segment.begin; i < segment.end; ++i) {
+    if (i + kPrefetchDistance < data.num_lookups) {
+      optimized_ops_preload_l1_keep(
+          data.values + data.ids[i + kPrefetchDistance] * data.embedding_size);
+    }
+    const float w = data.weights[i];
+    squares_weight += w * w;
+    total_weight += w;
+    tensor_utils::VectorScalarMultiplyAccumulate(
+        data.values + data.ids[i] * data.embedding_size, data.embedding_size,
+        w, output);
+  }
+  FinalizeAggregation(data.combiner, segment.end - segment.begin,
+                      total_weight, squares_weight, data.embedding_size,
+                      output);
+}
+
+struct AggregationTask : cpu_backend_threadpool::Task {
+  AggregationTask(const AggregationData* data, const Segment* begin,
+                  const Segment* end)
+      : data(data), begin(begin), end(end) {}
+  void Run() override {
+    for (const Segment* segment = begin; segment != end; ++segment) {
+      AggregateSegment(*data, *segment);
+    }
+  }
+
+ private:
+  const AggregationData* data;
+  const Segment* begin;
+  const Segment* end;
+};
+
 TfLiteStatus Eval(TfLiteContext* context, TfLiteNode* node) {
   auto* params =
       reinterpret_cast<TfLiteEmbeddingLookupSparseParams*>(node->builtin_data);
@@ -159,7 +228,6 @@ TfLiteStatus Eval(TfLiteContext* context, TfLiteNode* node) {
   TF_LITE_ENSURE_OK(context, GetInputSafe(context, node, 3, &weights));
   const TfLiteTensor* value;
   TF_LITE_ENSURE_OK(context, GetInputSafe(context, node, 4, &value));
-  const size_t values_size = NumElements(value);
 
   const int lookup_rank = SizeOfDimension(indices, 1);
   const int embedding_rank = NumDimensions(value);
@@ -207,12 +275,14 @@ TfLiteStatus Eval(TfLiteContext* context, TfLiteNode* node) {
 
   std::fill_n(output_ptr, output_size, 0.0f);
 
-  // Keep track of the current bucket for aggregation/combination.
-  int current_output_offset = 0;
-  float current_total_weight = 0.0;
-  float current_squares_weight = 0.0;
-  int num_elements = 0;
-
+  // Split the lookups into segments of consecutive lookups with the same
+  // output bucket for aggregation/combination.
+  std::vector<Segment> segments;
+  // Whether each output bucket is aggregated by at most one segment, so that
+  // the segments can be aggregated concurrently.
+  bool disjoint_segments = true;
+  // The output offset of the last segment within the output, or -1.
+  ptrdiff_t last_output_offset = -1;
   for (int i = 0; i < num_lookups; i++) {
     int idx = ids->data.i32[i];
     if (idx >= num_rows || idx < 0) {
@@ -231,43 +301,62 @@ TfLiteStatus Eval(TfLiteContext* context, TfLiteNode* node) {
       output_bucket += indices->data.i32[example_indices_offset + k] * stride;
       stride *= dense_shape->data.i32[k];
     }
-    const int output_offset = output_bucket * embedding_size;
-
-    // If we are in a new aggregation bucket and the combiner is not the sum,
-    // go back and finalize the result of the previous bucket.
-    if (output_offset != current_output_offset) {
-      FinalizeAggregation(params->combiner, num_elements, current_total_weight,
-                          current_squares_weight, embedding_size,
-                          &output_ptr[current_output_offset]);
-
-      // Track next bucket.
-      num_elements = 0;
-      current_total_weight = 0.0;
-      current_squares_weight = 0.0;
-      current_output_offset = output_offset;
+    // Only aggregate the buckets within the output.
+    const bool in_bounds = output_bucket >= 0 &&
+                           (output_bucket + 1) * embedding_size <= output_size;
+    const size_t output_offset = in_bounds ? output_bucket * embedding_size : 0;
+
+    if (!segments.empty() && segments.back().in_bounds == in_bounds &&
+        segments.back().output_offset == output_offset) {
+      segments.back().end = i + 1;
+      continue;
+    }
+    segments.push_back({i, i + 1, output_offset, in_bounds});
+    if (!in_bounds) continue;
+    if (static_cast<ptrdiff_t>(output_offset) <= last_output_offset) {
+      disjoint_segments = false;
     }
+    last_output_offset = output_offset;
+  }
 
-    // Add element to aggregation.
-    ++num_elements;
-    const int example_embedding_offset = idx * embedding_size;
-    const float w = weights_ptr[i];
-    current_squares_weight += w * w;
-    current_total_weight += w;
-    for (int k = 0; k < embedding_size; k++) {
-      // only index if indices are valid
-      if (current_output_offset + k < 0) continue;
-      if (current_output_offset + k >= output_size) continue;
-      if (example_embedding_offset + k < 0) continue;
-      if (example_embedding_offset + k >= values_size) continue;
-      output_ptr[current_output_offset + k] +=
-          value_ptr[example_embedding_offset + k] * w;
+  const AggregationData data = {params->combiner, ids->data.i32,
+                                weights_ptr,      value_ptr,
+                                num_lookups,      embedding_size,
+                                output_ptr};
+  CpuBackendContext* cpu_backend_context =
+      CpuBackendContext::GetFromContext(context);
+  const int thread_count =
+      disjoint_segments
+          ? std::min<size_t>({static_cast<size_t>(
+                                  cpu_backend_context->max_num_threads()),
+                              segments.size(),
+                              num_lookups * embedding_size /
+                                  kMinElementsPerTask})
+          : 1;
+  if (thread_count <= 1) {
+    // Segments aggregating the same bucket are aggregated in order.
+    for (const Segment& segment : segments) {
+      AggregateSegment(data, segment);
     }
+    return kTfLiteOk;
   }
 
-  // Finalize last bucket.
-  FinalizeAggregation(params->combiner, num_elements, current_total_weight,
-                      current_squares_weight, embedding_size,
-                      &GetTensorData<float>(output)[current_output_offset]);
+  // Split the segments between the threads with about as many lookups each.
+  std::vector<AggregationTask> tasks;
+  tasks.reserve(thread_count);
+  const Segment* task_begin = segments.data();
+  const Segment* const segments_end = segments.data() + segments.size();
+  for (int t = 0; t < thread_count; ++t) {
+    const int task_lookups_end = num_lookups * (t + 1LL) / thread_count;
+    const Segment* task_end = task_begin;
+    while (task_end != segments_end && task_end->begin < task_lookups_end) {
+      ++task_end;
+    }
+    tasks.emplace_back(&data, task_begin, task_end);
+    task_begin = task_end;
+  }
+  cpu_backend_threadpool::Execute(tasks.size(), tasks.data(),
+                                  cpu_backend_context);
 
   return kTfLiteOk;
 }
@@ -18,6 +18,7 @@ limitations under the License.
 #include <algorithm>
 #include <cstddef>
 #include <cstdint>
+#include <cstring>
 #include <memory>
 #include <vector>
 
@@ -118,6 +119,22 @@ TfLiteStatus VerifyPerChannelQuantization(TfLiteContext* context,
   return affine_quantization->scale->size > 1 ? kTfLiteOk : kTfLiteError;
 }
 
+// Returns the number of groups of consecutive input values sharing a filter
+// scale for each unit: `scale->size / units` when int4 filters have more
+// scales than units, stored unit-major, and 1 otherwise.
+int NumFilterScaleGroups(const TfLiteTensor* filter) {
+  const auto* affine_quantization =
+      reinterpret_cast<TfLiteAffineQuantization*>(filter->quantization.params);
+  if (filter->type != kTfLiteInt4 ||
+      filter->quantization.type != kTfLiteAffineQuantization ||
+      !affine_quantization || !affine_quantization->scale ||
+      NumDimensions(filter) != 2 ||
+      affine_quantization->scale->size <= filter->dims->data[0]) {
+    return 1;
+  }
+  return affine_quantization->scale->size / filter->dims->data[0];
+}
+
 TfLiteStatus VerifyQuantizationZeroPoint(const TfLiteTensor* tensor,
                                          int expected_value) {
   const auto* params =
@@ -511,6 +528,22 @@ TfLiteStatus PrepareImpl(TfLiteContext* context, TfLiteNode* node,
         filter->type == kTfLiteInt4));
   const bool is_sparse = filter->sparsity != nullptr;
   if (is_hybrid) {
+    // Group-wise filter scales split the input values of each unit in groups
+    // of whole filter blocks.
+    const int num_scale_groups = NumFilterScaleGroups(filter);
+    if (num_scale_groups > 1) {
+      const int filter_cols = filter->dims->data[1];
+      TF_LITE_ENSURE_EQ(
+          context,
+          reinterpret_cast<TfLiteAffineQuantization*>(
+              filter->quantization.params)
+              ->scale->size,
+          num_units * num_scale_groups);
+      TF_LITE_ENSURE_EQ(context, filter_cols % num_scale_groups, 0);
+      TF_LITE_ENSURE_EQ(
+          context, (filter_cols / num_scale_groups) % optimized_4bit::FilterDepth,
+          0);
+    }
     // Use optimized implementation for 4bit
     if (filter->type == kTfLiteInt4 && kernel_type == kGenericOptimized &&
         IsConstantTensor(filter) && batch_size &&
@@ -525,6 +558,7 @@ TfLiteStatus PrepareImpl(TfLiteContext* context, TfLiteNode* node,
         return kTfLiteOk;
       }
       data->op_data_4bit->batch_size = batch_size;
+      data->op_data_4bit->num_scale_groups = num_scale_groups;
       for (int packed_rows = optimized_4bit::GetMaxSupportedRows();
            packed_rows > 0; packed_rows /= 2) {
         if (batch_size >= packed_rows) {
@@ -537,6 +571,12 @@ TfLiteStatus PrepareImpl(TfLiteContext* context, TfLiteNode* node,
                              optimized_4bit::FilterDepth, batch_size, cols,
                              num_units);
     }
+    if (num_scale_groups > 1) {
+      TF_LITE_KERNEL_LOG(context,
+                         "Group-wise filter scales are only supported by the "
+                         "optimized kernel for constant int4 filters.");
+      return kTfLiteError;
+    }
     TfLiteIntArrayFree(node->temporaries);
     data->compute_row_sums = true;
     if (is_sparse) {
@@ -942,6 +982,78 @@ struct SparseHybridFullyConnectedTask : cpu_backend_threadpool::Task {
   TfLiteTensor* output;
 };
 
+// Same as the end of EvalHybridDense4Bit() for filters with group-wise scales,
+// which have each group of columns packed as a filter of its own. The input
+// values of each group are quantized, and their products with the filter
+// scaled, apart from the other groups.
+TfLiteStatus EvalHybridDense4BitGroupwise(
+    TfLiteContext* context, TfLiteFullyConnectedParams* params, OpData* data,
+    const TfLiteTensor* input, const TfLiteTensor* filter,
+    const TfLiteTensor* bias, TfLiteTensor* input_quantized,
+    TfLiteTensor* scaling_factors, TfLiteTensor* accum_scratch,
+    TfLiteTensor* input_offsets, TfLiteTensor* output) {
+  float* scaling_factors_ptr = GetTensorData<float>(scaling_factors);
+  int8_t* quant_data = GetTensorData<int8_t>(input_quantized);
+  int32_t* input_offset_ptr = GetTensorData<int32_t>(input_offsets);
+  int32_t* dst = GetTensorData<int32_t>(accum_scratch);
+  const int batch_size = data->op_data_4bit->batch_size;
+  const int output_depth = filter->dims->data[0];
+  const int cols = filter->dims->data[1];
+  const int num_scale_groups = data->op_data_4bit->num_scale_groups;
+  const int group_cols = cols / num_scale_groups;
+  const int rhs_width = data->op_data_4bit->rows_right;
+  const int depth = optimized_4bit::FilterDepth;
+  const int lhs_width = optimized_4bit::FilterWidth;
+  const int lhs_layout_rows =
+      (output_depth + (lhs_width - 1)) & ~(lhs_width - 1);
+  const int rhs_layout_rows = (batch_size + (rhs_width - 1)) & ~(rhs_width - 1);
+  const float* scales =
+      reinterpret_cast<TfLiteAffineQuantization*>(filter->quantization.params)
+          ->scale->data;
+  const float* input_ptr = GetTensorData<float>(input);
+  float* output_ptr = GetTensorData<float>(output);
+  const float* bias_ptr =
+      bias != nullptr ? GetTensorData<float>(bias) : nullptr;
+
+  std::vector<float> group_input(batch_size * group_cols);
+  std::vector<float> group_output(batch_size * output_depth);
+  std::vector<float> filter_scales(lhs_layout_rows, 0.0f);
+  for (int g = 0; g < num_scale_groups; ++g) {
+    for (int b = 0; b < batch_size; ++b) {
+      std::copy_n(input_ptr + b * cols + g * group_cols, group_cols,
+                  group_input.data() + b * group_cols);
+    }
+    for (int o = 0; o < output_depth; ++o) {
+      filter_scales[o] = scales[o * num_scale_groups + g];
+    }
+    optimized_4bit::api::BatchQuantizeFloats4Bit(
+        group_input.data(), batch_size, group_cols, quant_data,
+        scaling_factors_ptr, rhs_width, depth, input_offset_ptr);
+    // The first group writes the bias to the output, the others are
+    // accumulated to it.
+    float* group_output_ptr = g == 0 ? output_ptr : group_output.data();
+    optimized_4bit::api::AssignBiasAndComputeOffsets(
+        input_offset_ptr, scaling_factors_ptr, filter_scales.data(),
+        g == 0 ? bias_ptr : nullptr, group_output_ptr, output_depth,
+        batch_size);
+    const uint8_t* lhs = data->op_data_4bit->prepacked_cache +
+                         g * lhs_layout_rows * group_cols / 2;
+    optimized_4bit::api::RunAndUnpack(
+        rhs_width, lhs, quant_data, dst, output_depth, batch_size,
+        lhs_layout_rows, group_cols, rhs_layout_rows, group_cols,
+        rhs_layout_rows, lhs_layout_rows, group_output_ptr,
+        scaling_factors_ptr, filter_scales.data());
+    if (g > 0) {
+      for (int i = 0; i < batch_size * output_depth; ++i) {
+        output_ptr[i] += group_output[i];
+      }
+    }
+  }
+  tensor_utils::ApplyActivationToVector(output_ptr, batch_size * output_depth,
+                                        params->activation, output_ptr);
+  return kTfLiteOk;
+}
+
 TfLiteStatus EvalHybridDense4Bit(
     TfLiteContext* context, TfLiteNode* node,
     TfLiteFullyConnectedParams* params, OpData* data, const TfLiteTensor* input,
@@ -965,15 +1077,36 @@ TfLiteStatus EvalHybridDense4Bit(
   const int rhs_layout_cols = lhs_layout_cols;
   const int dst_layout_rows = rhs_layout_rows;
   const int dst_layout_cols = lhs_layout_rows;
+  const int num_scale_groups = data->op_data_4bit->num_scale_groups;
   if (data->op_data_4bit->needs_prepack) {
     const int weight_size = lhs_layout_rows * lhs_layout_cols / 2;
     const int required_size =
         optimized_4bit::kDefaultAlignmentPadding + weight_size;
     data->op_data_4bit->AllocatePackedRegion(required_size);
     const int8_t* weight_ptr = GetTensorData<int8_t>(filter);
-    optimized_4bit::api::Prepack(data->op_data_4bit->prepacked_cache,
-                                 weight_ptr, lhs_layout_rows, lhs_layout_cols,
-                                 output_depth, cols, lhs_width, depth);
+    if (num_scale_groups == 1) {
+      optimized_4bit::api::Prepack(data->op_data_4bit->prepacked_cache,
+                                   weight_ptr, lhs_layout_rows,
+                                   lhs_layout_cols, output_depth, cols,
+                                   lhs_width, depth);
+    } else {
+      // Each group of columns is packed as a filter of its own, so that its
+      // sums are accumulated apart from the other groups.
+      const int group_cols = cols / num_scale_groups;
+      std::vector<int8_t> group_weights(output_depth * group_cols / 2);
+      for (int g = 0; g < num_scale_groups; ++g) {
+        for (int o = 0; o < output_depth; ++o) {
+          std::memcpy(group_weights.data() + o * group_cols / 2,
+                      weight_ptr + (o * cols + g * group_cols) / 2,
+                      group_cols / 2);
+        }
+        optimized_4bit::api::Prepack(
+            data->op_data_4bit->prepacked_cache +
+                g * lhs_layout_rows * group_cols / 2,
+            group_weights.data(), lhs_layout_rows, group_cols, output_depth,
+            group_cols, lhs_width, depth);
+      }
+    }
     data->op_data_4bit->needs_prepack = false;
 #ifdef MADV_PAGEOUT
     // After prepacking, we will never use the weights from the model file. Mark
@@ -1000,6 +1133,12 @@ TfLiteStatus EvalHybridDense4Bit(
 #endif
   }
 
+  if (num_scale_groups > 1) {
+    return EvalHybridDense4BitGroupwise(
+        context, params, data, input, filter, bias, input_quantized,
+        scaling_factors, accum_scratch, input_offsets, output);
+  }
+
   std::vector<float> filter_scales(lhs_layout_rows, filter->params.scale);
   auto* filter_params =
       reinterpret_cast<TfLiteAffineQuantization*>(filter->quantization.params);
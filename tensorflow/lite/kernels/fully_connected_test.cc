@@ -24,6 +24,7 @@ limitations under the License.
 #include <limits>
 #include <map>
 #include <memory>
+#include <numeric>
 #include <random>
 #include <string>
 #include <vector>
@@ -1444,6 +1445,100 @@ TEST(HybridFullyConnectedOpTest, SimpleTestQuantizedInt4) {
                                  /*max_abs_error=*/1.3f)));
 }
 
+// A hybrid fully connected op with constant int4 weights, which have a scale
+// for each group of `cols / num_groups` consecutive values of each unit.
+class GroupwiseInt4FullyConnectedOpModel : public SingleOpModel {
+ public:
+  GroupwiseInt4FullyConnectedOpModel(int units, int batches, int cols,
+                                     int num_groups,
+                                     const std::vector<int8_t>& weights,
+                                     const std::vector<float>& scales)
+      : batches_(batches), units_(units) {
+    input_ = AddInput({TensorType_FLOAT32, {batches, cols}});
+    // Two int4 values are packed per byte, the first one in the low nibble.
+    std::vector<int8_t> packed_weights(weights.size() / 2);
+    for (size_t i = 0; i < packed_weights.size(); ++i) {
+      packed_weights[i] = static_cast<int8_t>((weights[2 * i] & 0x0F) |
+                                              (weights[2 * i + 1] << 4));
+    }
+    AddConstInput(TensorData{TensorType_INT4,
+                             {units, cols},
+                             0,
+                             0,
+                             0.0f,
+                             0,
+                             true,
+                             scales,
+                             std::vector<int64_t>(scales.size(), 0),
+                             0},
+                  packed_weights);
+    bias_ = AddInput({TensorType_FLOAT32, {units}});
+    output_ = AddOutput({TensorType_FLOAT32});
+    SetBuiltinOp(BuiltinOperator_FULLY_CONNECTED,
+                 BuiltinOptions_FullyConnectedOptions,
+                 CreateFullyConnectedOptions(builder_).Union());
+    resolver_ = std::make_unique<SingleOpResolver>(
+        BuiltinOperator_FULLY_CONNECTED,
+        ops::builtin::Register_FULLY_CONNECTED_GENERIC_OPT());
+    BuildInterpreter({GetShape(input_), {units, cols}, GetShape(bias_)});
+  }
+
+  void SetBias(const std::vector<float>& f) { PopulateTensor(bias_, f); }
+  void SetInput(const std::vector<float>& f) { PopulateTensor(input_, f); }
+  std::vector<float> GetOutput() { return ExtractVector<float>(output_); }
+
+ private:
+  int input_;
+  int bias_;
+  int output_;
+  int batches_;
+  int units_;
+};
+
+TEST(HybridFullyConnectedOpTest, GroupwiseScalesInt4) {
+  constexpr int kUnits = 8;
+  constexpr int kCols = 128;
+  constexpr int kGroups = 4;
+  constexpr int kGroupCols = kCols / kGroups;
+  for (const int batches : {1, 3}) {
+    std::vector<int8_t> weights(kUnits * kCols);
+    for (int o = 0; o < kUnits; ++o) {
+      for (int k = 0; k < kCols; ++k) {
+        weights[o * kCols + k] = (o * 3 + k * 5) % 15 - 7;
+      }
+    }
+    std::vector<float> scales(kUnits * kGroups);
+    for (int i = 0; i < scales.size(); ++i) {
+      scales[i] = 0.01f * (1 + i % 7);
+    }
+    std::vector<float> input(batches * kCols);
+    for (int i = 0; i < input.size(); ++i) {
+      input[i] = 0.25f * ((i * 7) % 11 - 5);
+    }
+    std::vector<float> bias(kUnits);
+    std::iota(bias.begin(), bias.end(), 1.0f);
+    std::vector<float> expected(batches * kUnits);
+    for (int b = 0; b < batches; ++b) {
+      for (int o = 0; o < kUnits; ++o) {
+        float sum = bias[o];
+        for (int k = 0; k < kCols; ++k) {
+          sum += input[b * kCols + k] * weights[o * kCols + k] *
+                 scales[o * kGroups + k / kGroupCols];
+        }
+        expected[b * kUnits + o] = sum;
+      }
+    }
+
+    GroupwiseInt4FullyConnectedOpModel m(kUnits, batches, kCols, kGroups,
+                                         weights, scales);
+    m.SetBias(bias);
+    m.SetInput(input);
+    ASSERT_EQ(m.Invoke(), kTfLiteOk);
+    EXPECT_THAT(m.GetOutput(), ElementsAreArray(ArrayFloatNear(
+                                   expected, /*max_abs_error=*/0.05f)));
+  }
+}
+
 TEST(HybridAsymmetricInputPerChannelWeightsFullyConnectedOpTest,
      SimpleTestQuantizedPerChannelInt8) {
   HybridFullyConnectedOpModel m(
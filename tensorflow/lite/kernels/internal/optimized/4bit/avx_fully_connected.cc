@@ -0,0 +1,271 @@
+/* Copyright 2024 The TensorFlow Authors. All Rights Reserved.
+
+Licensed under the Apache License, Version 2.0 (the "License");
+you may not use this file except in compliance with the License.
+You may obtain a copy of the License at
+
+    http://www.apache.org/licenses/LICENSE-2.0
+
+Unless required by applicable law or agreed to in writing, software
+distributed under the License is distributed on an "AS IS" BASIS,
+WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+See the License for the specific language governing permissions and
+limitations under the License.
+==============================================================================*/
+
+#if defined(FC_4BIT_SSE) && defined(__SSSE3__)
+
+#include <stdint.h>
+
+// NOLINTBEGIN
+#include <immintrin.h>
+
+#include <algorithm>
+
+#include "include/cpuinfo.h"
+#include "tensorflow/lite/kernels/internal/optimized/4bit/sse_fully_connected_impl.h"
+
+// The kernels below are compiled for their instruction set regardless of the
+// flags of the build, and are only called when the CPU supports it.
+#if defined(__GNUC__) || defined(__clang__)
+#define FC_4BIT_TARGET(isa) __attribute__((target(isa)))
+#else
+#define FC_4BIT_TARGET(isa)
+#endif
+#define FC_4BIT_TARGET_AVX2 FC_4BIT_TARGET("avx2")
+#define FC_4BIT_TARGET_AVX512VNNI \
+  FC_4BIT_TARGET("avx2,avx512f,avx512bw,avx512vl,avx512vnni")
+
+namespace tflite {
+namespace optimized_4bit {
+
+bool HasAvx2() {
+  static const bool has_avx2 = cpuinfo_initialize() && cpuinfo_has_x86_avx2();
+  return has_avx2;
+}
+
+bool HasAvx512Vnni() {
+  static const bool has_avx512vnni =
+      cpuinfo_initialize() && cpuinfo_has_x86_avx512f() &&
+      cpuinfo_has_x86_avx512bw() && cpuinfo_has_x86_avx512vl() &&
+      cpuinfo_has_x86_avx512vnni();
+  return has_avx512vnni;
+}
+
+namespace {
+
+// Unpacks the 32 4-bit values of a filter row of a depth block. The values of
+// the upper nibbles multiply the first 16 input values of the block, the ones
+// of the lower nibbles the last 16.
+FC_4BIT_TARGET_AVX2 inline __m256i UnpackInt4x32(const uint8_t* lhs) {
+  const __m128i packed = _mm_loadu_si128((const __m128i*)lhs);
+  const __m256i both = _mm256_inserti128_si256(
+      _mm256_castsi128_si256(_mm_srli_epi16(packed, 4)), packed, 1);
+  return _mm256_and_si256(both, _mm256_set1_epi8(15));
+}
+
+// Returns [sum(a), sum(b), sum(c), sum(d)].
+FC_4BIT_TARGET_AVX2 inline __m128i ReduceInt32x8x4(__m256i a, __m256i b,
+                                                   __m256i c, __m256i d) {
+  const __m256i a_b = _mm256_hadd_epi32(a, b);
+  const __m256i c_d = _mm256_hadd_epi32(c, d);
+  const __m256i a_b_c_d = _mm256_hadd_epi32(a_b, c_d);
+  return _mm_add_epi32(_mm256_castsi256_si128(a_b_c_d),
+                       _mm256_extracti128_si256(a_b_c_d, 1));
+}
+
+FC_4BIT_TARGET_AVX512VNNI inline __m256i ReduceInt32x16(__m512i a) {
+  return _mm256_add_epi32(_mm512_castsi512_si256(a),
+                          _mm512_extracti64x4_epi64(a, 1));
+}
+
+template <int RowsLeft, int RowsRight, int Cols>
+FC_4BIT_TARGET_AVX2 void Avx2RunKernelImpl(
+    const uint8_t* lhs, const int8_t* rhs, int32_t* dst, int lhs_layout_rows,
+    int lhs_layout_cols, int rhs_layout_rows, int rhs_layout_cols,
+    int dst_layout_rows, int dst_layout_cols) {
+  static_assert(RowsLeft == 4, "Rows are reduced by 4.");
+  const int clamped_end_row = std::min(lhs_layout_rows, dst_layout_cols);
+  const int clamped_end_col = std::min(rhs_layout_rows, dst_layout_rows);
+  int32_t* elementPtr = dst;
+  const int outer_rows = (clamped_end_row + RowsLeft - 1) / RowsLeft;
+  const int outer_cols = (clamped_end_col + RowsRight - 1) / RowsRight;
+  const int depth = std::min(lhs_layout_cols / Cols, rhs_layout_cols / Cols);
+  const __m256i ones = _mm256_set1_epi16(1);
+  for (int i = 0; i < outer_rows; ++i) {
+    const uint8_t* lhs_val_data = lhs + i * RowsLeft * lhs_layout_cols / 2;
+    for (int j = 0; j < outer_cols; ++j) {
+      const uint8_t* lhs_val = lhs_val_data;
+      const int8_t* rhs_val = rhs + j * RowsRight * rhs_layout_cols;
+      __m256i accum[RowsRight * RowsLeft];
+      for (int m = 0; m < (RowsLeft * RowsRight); ++m) {
+        accum[m] = _mm256_setzero_si256();
+      }
+      for (int k = 0; k < depth; ++k) {
+        __m256i lhs_row[RowsLeft];
+        for (int m = 0; m < RowsLeft; ++m) {
+          lhs_row[m] = UnpackInt4x32(lhs_val);
+          lhs_val += 16;
+        }
+        for (int r = 0; r < RowsRight; ++r) {
+          const __m256i rhs_row = _mm256_loadu_si256((const __m256i*)rhs_val);
+          rhs_val += 32;
+          for (int l = 0; l < RowsLeft; ++l) {
+            // The filter values are unsigned and at most 15, so the pairwise
+            // sums of products don't saturate.
+            const __m256i sumprod_16x16 =
+                _mm256_maddubs_epi16(lhs_row[l], rhs_row);
+            accum[r * RowsLeft + l] =
+                _mm256_add_epi32(accum[r * RowsLeft + l],
+                                 _mm256_madd_epi16(sumprod_16x16, ones));
+          }
+        }
+      }
+      for (int r = 0; r < RowsRight; ++r) {
+        const __m128i sum =
+            ReduceInt32x8x4(accum[r * RowsLeft], accum[r * RowsLeft + 1],
+                            accum[r * RowsLeft + 2], accum[r * RowsLeft + 3]);
+        _mm_storeu_si128((__m128i*)elementPtr, sum);
+        elementPtr += 4;
+      }
+    }
+  }
+}
+
+template <int RowsLeft, int RowsRight, int Cols>
+FC_4BIT_TARGET_AVX512VNNI void Avx512VnniRunKernelImpl(
+    const uint8_t* lhs, const int8_t* rhs, int32_t* dst, int lhs_layout_rows,
+    int lhs_layout_cols, int rhs_layout_rows, int rhs_layout_cols,
+    int dst_layout_rows, int dst_layout_cols) {
+  static_assert(RowsLeft == 4, "Rows are reduced by 4.");
+  const int clamped_end_row = std::min(lhs_layout_rows, dst_layout_cols);
+  const int clamped_end_col = std::min(rhs_layout_rows, dst_layout_rows);
+  int32_t* elementPtr = dst;
+  const int outer_rows = (clamped_end_row + RowsLeft - 1) / RowsLeft;
+  const int outer_cols = (clamped_end_col + RowsRight - 1) / RowsRight;
+  const int depth = std::min(lhs_layout_cols / Cols, rhs_layout_cols / Cols);
+  // Depth blocks of a filter row, and of an input row, are RowsLeft * 16 and
+  // RowsRight * 32 bytes apart.
+  const int lhs_block_stride = RowsLeft * 16;
+  const int rhs_block_stride = RowsRight * 32;
+  for (int i = 0; i < outer_rows; ++i) {
+    const uint8_t* lhs_val_data = lhs + i * RowsLeft * lhs_layout_cols / 2;
+    for (int j = 0; j < outer_cols; ++j) {
+      const uint8_t* lhs_val = lhs_val_data;
+      const int8_t* rhs_val = rhs + j * RowsRight * rhs_layout_cols;
+      __m512i accum[RowsRight * RowsLeft];
+      for (int m = 0; m < (RowsLeft * RowsRight); ++m) {
+        accum[m] = _mm512_setzero_si512();
+      }
+      // Two depth blocks are multiplied at once.
+      int k = 0;
+      for (; k + 1 < depth; k += 2) {
+        __m512i lhs_row[RowsLeft];
+        for (int m = 0; m < RowsLeft; ++m) {
+          lhs_row[m] = _mm512_inserti64x4(
+              _mm512_castsi256_si512(UnpackInt4x32(lhs_val + m * 16)),
+              UnpackInt4x32(lhs_val + lhs_block_stride + m * 16), 1);
+        }
+        for (int r = 0; r < RowsRight; ++r) {
+          const __m512i rhs_row = _mm512_inserti64x4(
+              _mm512_castsi256_si512(
+                  _mm256_loadu_si256((const __m256i*)(rhs_val + r * 32))),
+              _mm256_loadu_si256(
+                  (const __m256i*)(rhs_val + rhs_block_stride + r * 32)),
+              1);
+          for (int l = 0; l < RowsLeft; ++l) {
+            accum[r * RowsLeft + l] =
+                _mm512_dpbusd_epi32(accum[r * RowsLeft + l], lhs_row[l], rhs_row);
+          }
+        }
+        lhs_val += 2 * lhs_block_stride;
+        rhs_val += 2 * rhs_block_stride;
+      }
+      __m256i tail[RowsRight * RowsLeft];
+      for (int m = 0; m < (RowsLeft * RowsRight); ++m) {
+        tail[m] = ReduceInt32x16(accum[m]);
+      }
+      if (k < depth) {
+        __m256i lhs_row[RowsLeft];
+        for (int m = 0; m < RowsLeft; ++m) {
+          lhs_row[m] = UnpackInt4x32(lhs_val + m * 16);
+        }
+        for (int r = 0; r < RowsRight; ++r) {
+          const __m256i rhs_row =
+              _mm256_loadu_si256((const __m256i*)(rhs_val + r * 32));
+          for (int l = 0; l < RowsLeft; ++l) {
+            tail[r * RowsLeft + l] =
+                _mm256_dpbusd_epi32(tail[r * RowsLeft + l], lhs_row[l], rhs_row);
+          }
+        }
+      }
+      for (int r = 0; r < RowsRight; ++r) {
+        const __m128i sum =
+            ReduceInt32x8x4(tail[r * RowsLeft], tail[r * RowsLeft + 1],
+                            tail[r * RowsLeft + 2], tail[r * RowsLeft + 3]);
+        _mm_storeu_si128((__m128i*)elementPtr, sum);
+        elementPtr += 4;
+      }
+    }
+  }
+}
+
+}  // namespace
+// NOLINTEND
+
+// The kernels are called through functions without target attributes, which
+// would otherwise make separate versions of the declared functions.
+template <int RowsLeft, int RowsRight, int Cols>
+void Avx2RunKernel(const uint8_t* lhs, const int8_t* rhs, int32_t* dst,
+                   int lhs_layout_rows, int lhs_layout_cols,
+                   int rhs_layout_rows, int rhs_layout_cols,
+                   int dst_layout_rows, int dst_layout_cols) {
+  Avx2RunKernelImpl<RowsLeft, RowsRight, Cols>(
+      lhs, rhs, dst, lhs_layout_rows, lhs_layout_cols, rhs_layout_rows,
+      rhs_layout_cols, dst_layout_rows, dst_layout_cols);
+}
+
+template <int RowsLeft, int RowsRight, int Cols>
+void Avx512VnniRunKernel(const uint8_t* lhs, const int8_t* rhs, int32_t* dst,
+                         int lhs_layout_rows, int lhs_layout_cols,
+                         int rhs_layout_rows, int rhs_layout_cols,
+                         int dst_layout_rows, int dst_layout_cols) {
+  Avx512VnniRunKernelImpl<RowsLeft, RowsRight, Cols>(
+      lhs, rhs, dst, lhs_layout_rows, lhs_layout_cols, rhs_layout_rows,
+      rhs_layout_cols, dst_layout_rows, dst_layout_cols);
+}
+
+template void Avx2RunKernel<4, 1, 32>(
+    const uint8_t* lhs, const int8_t* rhs, int32_t* dst, int lhs_layout_rows,
+    int lhs_layout_cols, int rhs_layout_rows, int rhs_layout_cols,
+    int dst_layout_rows, int dst_layout_cols);
+
+template void Avx2RunKernel<4, 2, 32>(
+    const uint8_t* lhs, const int8_t* rhs, int32_t* dst, int lhs_layout_rows,
+    int lhs_layout_cols, int rhs_layout_rows, int rhs_layout_cols,
+    int dst_layout_rows, int dst_layout_cols);
+
+template void Avx2RunKernel<4, 4, 32>(
+    const uint8_t* lhs, const int8_t* rhs, int32_t* dst, int lhs_layout_rows,
+    int lhs_layout_cols, int rhs_layout_rows, int rhs_layout_cols,
+    int dst_layout_rows, int dst_layout_cols);
+
+template void Avx512VnniRunKernel<4, 1, 32>(
+    const uint8_t* lhs, const int8_t* rhs, int32_t* dst, int lhs_layout_rows,
+    int lhs_layout_cols, int rhs_layout_rows, int rhs_layout_cols,
+    int dst_layout_rows, int dst_layout_cols);
+
+template void Avx512VnniRunKernel<4, 2, 32>(
+    const uint8_t* lhs, const int8_t* rhs, int32_t* dst, int lhs_layout_rows,
+    int lhs_layout_cols, int rhs_layout_rows, int rhs_layout_cols,
+    int dst_layout_rows, int dst_layout_cols);
+
+template void Avx512VnniRunKernel<4, 4, 32>(
+    const uint8_t* lhs, const int8_t* rhs, int32_t* dst, int lhs_layout_rows,
+    int lhs_layout_cols, int rhs_layout_rows, int rhs_layout_cols,
+    int dst_layout_rows, int dst_layout_cols);
+
+}  // namespace optimized_4bit
+}  // namespace tflite
+
+#endif  // defined(FC_4BIT_SSE) && defined(__SSSE3__)
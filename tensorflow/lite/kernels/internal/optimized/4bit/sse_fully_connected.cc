@@ -315,6 +315,18 @@ void SseRunKernel(const uint8_t* lhs, const int8_t* rhs, int32_t* dst,
                   int lhs_layout_rows, int lhs_layout_cols, int rhs_layout_rows,
                   int rhs_layout_cols, int dst_layout_rows,
                   int dst_layout_cols) {
+  if (HasAvx512Vnni()) {
+    Avx512VnniRunKernel<RowsLeft, RowsRight, Cols>(
+        lhs, rhs, dst, lhs_layout_rows, lhs_layout_cols, rhs_layout_rows,
+        rhs_layout_cols, dst_layout_rows, dst_layout_cols);
+    return;
+  }
+  if (HasAvx2()) {
+    Avx2RunKernel<RowsLeft, RowsRight, Cols>(
+        lhs, rhs, dst, lhs_layout_rows, lhs_layout_cols, rhs_layout_rows,
+        rhs_layout_cols, dst_layout_rows, dst_layout_cols);
+    return;
+  }
   const int start_row = 0;
   const int start_col = 0;
   const int end_row = lhs_layout_rows;
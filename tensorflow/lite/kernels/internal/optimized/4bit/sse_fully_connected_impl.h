@@ -51,6 +51,26 @@ extern void SseUnpack(float* output_ptr, const int32_t* dst, int batch_size,
                       const float* filter_scales, int dst_layout_rows,
                       int dst_layout_cols);
 
+// True if the CPU supports the AVX2, or AVX-512 VNNI, kernels below.
+bool HasAvx2();
+bool HasAvx512Vnni();
+
+// Same as SseRunKernel, multiplying 32 values of a row at a time with AVX2.
+template <int RowsLeft, int RowsRight, int Cols>
+extern void Avx2RunKernel(const uint8_t* lhs, const int8_t* rhs, int32_t* dst,
+                          int lhs_layout_rows, int lhs_layout_cols,
+                          int rhs_layout_rows, int rhs_layout_cols,
+                          int dst_layout_rows, int dst_layout_cols);
+
+// Same as SseRunKernel, multiplying 64 values of a row at a time with the
+// VPDPBUSD dot product of AVX-512 VNNI.
+template <int RowsLeft, int RowsRight, int Cols>
+extern void Avx512VnniRunKernel(const uint8_t* lhs, const int8_t* rhs,
+                                int32_t* dst, int lhs_layout_rows,
+                                int lhs_layout_cols, int rhs_layout_rows,
+                                int rhs_layout_cols, int dst_layout_rows,
+                                int dst_layout_cols);
+
 template <int RowsLeft, int RowsRight, int Cols>
 extern void SseRunKernel(const uint8_t* lhs, const int8_t* rhs, int32_t* dst,
                          int lhs_layout_rows, int lhs_layout_cols,
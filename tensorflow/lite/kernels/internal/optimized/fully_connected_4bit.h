@@ -58,6 +58,9 @@ struct Deleter {
 struct OpData4Bit {
   int rows_right = 1;
   int batch_size = 0;
+  // Number of groups of consecutive input values with their own filter scale
+  // for each unit, or 1 if the scales are per-channel or per-tensor.
+  int num_scale_groups = 1;
   bool needs_prepack = true;
   uint8_t* prepacked_cache = nullptr;
   std::unique_ptr<uint8_t[], Deleter> prepacked_cache_buffer;
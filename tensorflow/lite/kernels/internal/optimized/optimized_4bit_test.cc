@@ -502,7 +502,8 @@ TEST_P(RunKernelTests, RunKernelTests) {
 
   index = 0;
   switch (rhs_width) {
-#if defined(FC_4BIT_NEON) && defined(__aarch64__)
+#if (defined(FC_4BIT_NEON) && defined(__aarch64__)) || \
+    defined(FC_4BIT_SSE)
     case 4:
       optimized_4bit::RunKernel<optimized_4bit::FilterWidth, 4,
                                 optimized_4bit::FilterDepth>(
@@ -542,8 +543,10 @@ INSTANTIATE_TEST_SUITE_P(
           std::make_tuple(1, 16, 1, 32), std::make_tuple(1, 4, 1, 64),
           std::make_tuple(1, 8, 1, 64), std::make_tuple(1, 16, 1, 64),
           std::make_tuple(1, 4, 5, 64), std::make_tuple(1, 8, 9, 64),
-          std::make_tuple(1, 16, 17, 64),
-#if defined(FC_4BIT_NEON) && defined(__aarch64__)
+          std::make_tuple(1, 16, 17, 64), std::make_tuple(1, 4, 1, 96),
+          std::make_tuple(1, 8, 3, 160),
+#if (defined(FC_4BIT_NEON) && defined(__aarch64__)) || \
+    defined(FC_4BIT_SSE)
           std::make_tuple(2, 8, 2, 32), std::make_tuple(2, 16, 2, 32),
           std::make_tuple(2, 4, 4, 64), std::make_tuple(2, 8, 4, 64),
           std::make_tuple(2, 16, 4, 64), std::make_tuple(2, 4, 4, 64),
@@ -552,7 +555,8 @@ INSTANTIATE_TEST_SUITE_P(
           std::make_tuple(4, 16, 4, 32), std::make_tuple(4, 4, 8, 64),
           std::make_tuple(4, 8, 8, 64), std::make_tuple(4, 16, 8, 64),
           std::make_tuple(4, 4, 8, 64), std::make_tuple(4, 8, 12, 64),
-          std::make_tuple(4, 16, 32, 64),
+          std::make_tuple(4, 16, 32, 64), std::make_tuple(2, 8, 4, 96),
+          std::make_tuple(4, 8, 8, 160),
 #endif
     }));
 }  // namespace
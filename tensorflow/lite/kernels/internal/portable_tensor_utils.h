@@ -97,6 +97,18 @@ inline void VectorVectorCwiseProductAccumulate(const T* __restrict__ vector1,
   }
 }
 
+// Multiplies a vector by a scalar and accumulates it into result. Since it's a
+// MAC operation, the assumption here is that result array is initialized to
+// valid values.
+template <typename T>
+inline void VectorScalarMultiplyAccumulate(const T* __restrict__ vector,
+                                           int v_size, T scale,
+                                           T* __restrict__ result) {
+  for (int v = 0; v < v_size; v++) {
+    *result++ += *vector++ * scale;
+  }
+}
+
 // Cwise product and accumulate of a vector and a batch-vector. Since it's a MAC
 // operation, the assumption here is that result array is initialized to valid
 // values.
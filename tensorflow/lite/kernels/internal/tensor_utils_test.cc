@@ -1671,6 +1671,18 @@ TEST(uKernels, VectorVectorCwiseProductAccumulateTest) {
                   {1.0, 1.05, 1.1, 1.15, 1.2, 1.25, 1.3, 1.35, 1.4, 1.45})));
 }
 
+TEST(uKernels, VectorScalarMultiplyAccumulateTest) {
+  constexpr int kVectorSize = 10;
+  static float input[kVectorSize] = {0.0,  -0.5, 1.0,  -1.5, 2.0,
+                                     -2.5, 3.0,  -3.5, 4.0,  -4.5};
+  std::vector<float> output(kVectorSize);
+  std::fill(output.begin(), output.end(), 1.0);
+  VectorScalarMultiplyAccumulate(input, kVectorSize, -0.1f, output.data());
+  EXPECT_THAT(output,
+              ElementsAreArray(ArrayFloatNear(
+                  {1.0, 1.05, 0.9, 1.15, 0.8, 1.25, 0.7, 1.35, 0.6, 1.45})));
+}
+
 TEST(uKernels, VectorBatchVectorAddTest) {
   constexpr int kVectorSize = 3;
   constexpr int kBatchSize = 2;
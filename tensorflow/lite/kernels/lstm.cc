@@ -1275,6 +1275,29 @@ TfLiteStatus PopulatePrecomputedZPTimesWeightsWithBias(TfLiteContext* context,
                     PrecomputeZeroPointTimesWeightWithBias(
                         context, hidden_zp, projection_weights, projection_bias,
                         &(integer_lstm_params->projection_effective_bias)));
+
+  // Stack the gate weights to compute the matmuls of all the gates with a GEMM
+  // per operand, which only constant weights can be copied for.
+  const bool use_cifg = (input_to_input_weights == nullptr);
+  if ((use_cifg || (IsConstantTensor(input_to_input_weights) &&
+                    IsConstantTensor(recurrent_to_input_weights))) &&
+      IsConstantTensor(input_to_forget_weights) &&
+      IsConstantTensor(input_to_cell_weights) &&
+      IsConstantTensor(input_to_output_weights) &&
+      IsConstantTensor(recurrent_to_forget_weights) &&
+      IsConstantTensor(recurrent_to_cell_weights) &&
+      IsConstantTensor(recurrent_to_output_weights)) {
+    lstm_eval::PopulateFusedGateWeightsInteger8x8_16(
+        input_to_input_weights, input_to_forget_weights, input_to_cell_weights,
+        input_to_output_weights, recurrent_to_input_weights,
+        recurrent_to_forget_weights, recurrent_to_cell_weights,
+        recurrent_to_output_weights, integer_lstm_params);
+  } else {
+    integer_lstm_params->fused_input_weights.reset();
+    integer_lstm_params->fused_input_effective_bias.reset();
+    integer_lstm_params->fused_recurrent_weights.reset();
+    integer_lstm_params->fused_recurrent_effective_bias.reset();
+  }
   return kTfLiteOk;
 }
 
@@ -1751,11 +1774,22 @@ TfLiteStatus Prepare(TfLiteContext* context, TfLiteNode* node) {
       PopulateQuantizedLstmParams8x8_16(context, node,
                                         &op_data->integer_lstm_param);
 
+      // Populate precomputed zp * weight.
+      TF_LITE_ENSURE_OK(context, PopulatePrecomputedZPTimesWeightsWithBias(
+                                     context, op_data, node));
+
       // Allocate scratch buffer. Need 6 16bit buffer with size n_batch * n_cell
       // and 1 8bit buffer with size n_batch * n_cell. We also need 1 32 bit
-      // buffer with size n_batch * n_cell.
+      // buffer with size n_batch * n_cell, or n_batch * n_gates * n_cell for
+      // the GEMMs of the fused gate weights.
       //
       // Handle cifg case as well, which might save one buffer.
+      const bool use_fused_gates =
+          op_data->integer_lstm_param.fused_input_weights != nullptr;
+      const bool use_cifg =
+          GetOptionalInputTensor(context, node, kInputToInputWeightsTensor) ==
+          nullptr;
+      const int n_gates = (use_cifg ? 3 : 4);
       for (int scratch_index = 0; scratch_index < 6; ++scratch_index) {
         node->temporaries->data[scratch_index] =
             op_data->scratch_tensor_index + scratch_index;
@@ -1770,21 +1804,19 @@ TfLiteStatus Prepare(TfLiteContext* context, TfLiteNode* node) {
           scratch_tensor->type = kTfLiteInt32;
         }
         scratch_tensor->allocation_type = kTfLiteArenaRw;
-        const int scratch_dimension[2] = {n_batch, n_cell};
+        const int scratch_dimension[2] = {
+            n_batch,
+            scratch_index == 5 && use_fused_gates ? n_gates * n_cell : n_cell};
         if (!TfLiteIntArrayEqualsArray(scratch_tensor->dims, 2,
                                        scratch_dimension)) {
           TfLiteIntArray* scratch_buffer_size = TfLiteIntArrayCreate(2);
-          scratch_buffer_size->data[0] = n_batch;
-          scratch_buffer_size->data[1] = n_cell;
+          scratch_buffer_size->data[0] = scratch_dimension[0];
+          scratch_buffer_size->data[1] = scratch_dimension[1];
           TF_LITE_ENSURE_OK(context,
                             context->ResizeTensor(context, scratch_tensor,
                                                   scratch_buffer_size));
         }
       }
-
-      // Populate precomputed zp * weight.
-      TF_LITE_ENSURE_OK(context, PopulatePrecomputedZPTimesWeightsWithBias(
-                                     context, op_data, node));
     } else {
       // Integer LSTM prepare function for 8x8->8.
       // This code path needs 12 intermediate tensors per Op.
@@ -19,6 +19,7 @@ limitations under the License.
 
 #include <algorithm>
 #include <cstdint>
+#include <limits>
 #include <memory>
 #include <vector>
 
@@ -29,6 +30,9 @@ limitations under the License.
 #include "tensorflow/lite/core/c/builtin_op_data.h"
 #include "tensorflow/lite/core/c/common.h"
 #include "tensorflow/lite/kernels/cpu_backend_context.h"
+#include "tensorflow/lite/kernels/cpu_backend_gemm.h"
+#include "tensorflow/lite/kernels/cpu_backend_gemm_params.h"
+#include "tensorflow/lite/kernels/internal/common.h"
 #include "tensorflow/lite/kernels/internal/compatibility.h"
 #include "tensorflow/lite/kernels/internal/kernel_utils.h"
 #include "tensorflow/lite/kernels/internal/optimized/optimized_ops.h"
@@ -549,6 +553,52 @@ void CalculateLstmOutputHybrid(
   }
 }
 
+// Applies the peephole, layer normalization and activation of an LSTM gate,
+// int8x8_16 version, to `gate`, which holds the results of its matmuls.
+void FinishLstmGateInteger8x8_16(
+    // Cell state and weights
+    const int16_t* cell_state, const int16_t* cell_to_gate_weights,
+    const int32_t cell_to_gate_scale_a, const int32_t cell_to_gate_scale_b,
+    // Layer normalization parameters (layer norm LSTM)
+    const int16_t* layer_norm_coefficients, const int32_t* layer_norm_bias,
+    const int32_t layer_norm_input_scale_a,
+    const int32_t layer_norm_input_scale_b,
+    const int32_t layer_norm_variance_guard,
+    // Array sizes
+    const int n_batch, const int n_output, const int n_cell,
+    const TfLiteFusedActivation activation,
+    // Input and output
+    int16_t* gate) {
+  const bool use_peephole = (cell_to_gate_weights != nullptr);
+  const bool use_layer_norm = (layer_norm_coefficients != nullptr);
+
+  // For each batch and cell: compute cell_weight * cell_state (peephole LSTM)
+  if (use_peephole) {
+    tensor_utils::VectorBatchVectorCwiseProductAccumulate(
+        cell_to_gate_weights, n_output, cell_state, n_batch,
+        cell_to_gate_scale_a, cell_to_gate_scale_b, gate);
+  }
+  // Do layer normalization (if layer norm LSTM)
+  if (use_layer_norm) {
+    tensor_utils::ApplyLayerNorm(
+        gate, layer_norm_coefficients, layer_norm_bias,
+        layer_norm_input_scale_a, layer_norm_input_scale_b,
+        layer_norm_variance_guard, n_batch, n_cell, gate);
+  }
+  // Apply activation
+  switch (activation) {
+    case kTfLiteActSigmoid:
+      tensor_utils::ApplySigmoid(gate, n_batch, n_cell, gate);
+      break;
+    case kTfLiteActTanh:
+      tensor_utils::ApplyTanh(3, gate, n_batch, n_cell, gate);
+      break;
+    default:
+      // Only Sigmoid or Tanh is used.
+      TFLITE_ASSERT_FALSE;
+  }
+}
+
 // Calculates a single LSTM gate, int8x8_16 version.
 // Implements the same functionality as CalculateLstmGateFloat.
 void CalculateLstmGateInteger8x8_16(
@@ -578,9 +628,6 @@ void CalculateLstmGateInteger8x8_16(
     CpuBackendContext* context,
     // Scratch arrays
     int32_t* scratch5) {
-  const bool use_peephole = (cell_to_gate_weights != nullptr);
-  const bool use_layer_norm = (layer_norm_coefficients != nullptr);
-
   // Initialize scratch buffers with zeros. Note that unlike float and hybrid
   // versions, bias is only used in layer normalization.
   std::fill_n(gate, n_batch * n_cell, 0);
@@ -596,31 +643,97 @@ void CalculateLstmGateInteger8x8_16(
       output_state, recurrent_to_gate_bias, recurrent_to_gate_weights,
       recurrent_to_gate_scale_a, recurrent_to_gate_scale_b, n_batch, n_output,
       n_cell, 0, scratch5, gate, context);
-  // For each batch and cell: compute cell_weight * cell_state (peephole LSTM)
-  if (use_peephole) {
-    tensor_utils::VectorBatchVectorCwiseProductAccumulate(
-        cell_to_gate_weights, n_output, cell_state, n_batch,
-        cell_to_gate_scale_a, cell_to_gate_scale_b, gate);
-  }
-  // Do layer normalization (if layer norm LSTM)
-  if (use_layer_norm) {
-    tensor_utils::ApplyLayerNorm(
-        gate, layer_norm_coefficients, layer_norm_bias,
-        layer_norm_input_scale_a, layer_norm_input_scale_b,
-        layer_norm_variance_guard, n_batch, n_cell, gate);
+  FinishLstmGateInteger8x8_16(
+      cell_state, cell_to_gate_weights, cell_to_gate_scale_a,
+      cell_to_gate_scale_b, layer_norm_coefficients, layer_norm_bias,
+      layer_norm_input_scale_a, layer_norm_input_scale_b,
+      layer_norm_variance_guard, n_batch, n_output, n_cell, activation, gate);
+}
+
+// Accumulates the products of `n_gates` stacked gate matrices of size
+// 'n_cell * n_cols' with `n_batch` vectors into the buffers of the gates,
+// rescaled by the effective scale of each gate. A single GEMM computes the
+// products of all the gates, instead of one per gate.
+void FusedMatrixBatchVectorMultiplyAccumulate(
+    const int8_t* vectors, const int8_t* fused_weights,
+    const int32_t* fused_bias, const int32_t* scale_a, const int32_t* scale_b,
+    int n_gates, int n_batch, int n_cols, int n_cell, int32_t* scratch,
+    int16_t* const* gates, CpuBackendContext* context) {
+  const int n_rows = n_gates * n_cell;
+  cpu_backend_gemm::MatrixParams<int8_t> lhs_params;
+  lhs_params.order = cpu_backend_gemm::Order::kRowMajor;
+  lhs_params.rows = n_rows;
+  lhs_params.cols = n_cols;
+  lhs_params.cache_policy = cpu_backend_gemm::CachePolicy::kCacheIfLargeSpeedup;
+
+  cpu_backend_gemm::MatrixParams<int8_t> rhs_params;
+  rhs_params.order = cpu_backend_gemm::Order::kColMajor;
+  rhs_params.rows = n_cols;
+  rhs_params.cols = n_batch;
+
+  cpu_backend_gemm::MatrixParams<int32_t> dst_params;
+  dst_params.order = cpu_backend_gemm::Order::kColMajor;
+  dst_params.rows = n_rows;
+  dst_params.cols = n_batch;
+
+  cpu_backend_gemm::GemmParams<int32_t, int32_t> gemm_params;
+  gemm_params.bias = fused_bias;
+  cpu_backend_gemm::Gemm(lhs_params, fused_weights, rhs_params, vectors,
+                         dst_params, scratch, gemm_params, context);
+
+  // Same rescaling and saturation as tensor_utils'
+  // MatrixBatchVectorMultiplyAccumulate, for bit exact results.
+  const int32_t output_max = std::numeric_limits<int16_t>::max();
+  const int32_t output_min = std::numeric_limits<int16_t>::min();
+  for (int batch = 0; batch < n_batch; ++batch) {
+    for (int g = 0; g < n_gates; ++g) {
+      const int32_t* acc = scratch + batch * n_rows + g * n_cell;
+      int16_t* gate = gates[g] + batch * n_cell;
+      for (int i = 0; i < n_cell; ++i) {
+        int32_t value =
+            MultiplyByQuantizedMultiplier(acc[i], scale_a[g], scale_b[g]);
+        value += gate[i];
+        gate[i] = static_cast<int16_t>(
+            std::min(std::max(value, output_min), output_max));
+      }
+    }
   }
-  // Apply activation
-  switch (activation) {
-    case kTfLiteActSigmoid:
-      tensor_utils::ApplySigmoid(gate, n_batch, n_cell, gate);
-      break;
-    case kTfLiteActTanh:
-      tensor_utils::ApplyTanh(3, gate, n_batch, n_cell, gate);
-      break;
-    default:
-      // Only Sigmoid or Tanh is used.
-      TFLITE_ASSERT_FALSE;
+}
+
+// Computes the matmuls of `n_gates` LSTM gates, int8x8_16 version, with one
+// GEMM of the fused input weights and one of the fused recurrent weights.
+// Leaves in `gates` the same as the matmuls of CalculateLstmGateInteger8x8_16
+// for each gate, to be finished with FinishLstmGateInteger8x8_16.
+//
+// Parameters:
+//  - fused_input_weights, fused_recurrent_weights: the weights of the gates,
+//      stacked in the order of `gates`.
+//  - fused_input_effective_bias, fused_recurrent_effective_bias: the
+//      effective biases of the gates, stacked in the same order.
+//  - input_scale_a, input_scale_b, recurrent_scale_a, recurrent_scale_b: the
+//      effective scales of each gate, of size n_gates.
+//  - gates: the output buffers of the gates, each of size n_batch*n_cell.
+//  - scratch: scratch area of size n_batch*n_gates*n_cell.
+void CalculateFusedLstmGateMatmulsInteger8x8_16(
+    const int8_t* input, const int8_t* fused_input_weights,
+    const int32_t* fused_input_effective_bias, const int32_t* input_scale_a,
+    const int32_t* input_scale_b, const int8_t* output_state,
+    const int8_t* fused_recurrent_weights,
+    const int32_t* fused_recurrent_effective_bias,
+    const int32_t* recurrent_scale_a, const int32_t* recurrent_scale_b,
+    int n_gates, int n_batch, int n_input, int n_output, int n_cell,
+    int16_t* const* gates, CpuBackendContext* context, int32_t* scratch) {
+  for (int g = 0; g < n_gates; ++g) {
+    std::fill_n(gates[g], n_batch * n_cell, 0);
   }
+  FusedMatrixBatchVectorMultiplyAccumulate(
+      input, fused_input_weights, fused_input_effective_bias, input_scale_a,
+      input_scale_b, n_gates, n_batch, n_input, n_cell, scratch, gates,
+      context);
+  FusedMatrixBatchVectorMultiplyAccumulate(
+      output_state, fused_recurrent_weights, fused_recurrent_effective_bias,
+      recurrent_scale_a, recurrent_scale_b, n_gates, n_batch, n_output, n_cell,
+      scratch, gates, context);
 }
 
 // Updates the LSTM cell state, used by both integer LSTM versions.
@@ -1476,7 +1589,11 @@ inline void LstmStepInteger8x8_16(
     const int32_t* recurrent_to_output_effective_bias,
     const int32_t* input_to_input_effective_bias,
     const int32_t* recurrent_to_input_effective_bias,
-    const int32_t* projection_effective_bias, int n_batch, int n_cell,
+    const int32_t* projection_effective_bias,
+    const int8_t* fused_input_weights,
+    const int32_t* fused_input_effective_bias,
+    const int8_t* fused_recurrent_weights,
+    const int32_t* fused_recurrent_effective_bias, int n_batch, int n_cell,
     int n_input, int n_output, int8_t* output_state_ptr,
     int32_t output_state_zp, int16_t* cell_state_ptr, int8_t* output_ptr,
     int16_t* scratch0, int16_t* scratch1, int16_t* scratch2, int16_t* scratch3,
@@ -1507,62 +1624,144 @@ inline void LstmStepInteger8x8_16(
   if (use_projection) {
     TFLITE_DCHECK(projection_effective_bias);
   }
-  if (!use_cifg) {
-    // Calculate the input gate. (If not CIFG.)
+  if (fused_input_weights != nullptr) {
+    // Compute the matmuls of all the gates with a GEMM per operand, then
+    // finish the gates in the same order as below: the output gate peephole
+    // reads the updated cell state.
+    int16_t* gates[4];
+    int32_t input_scale_a[4];
+    int32_t input_scale_b[4];
+    int32_t recurrent_scale_a[4];
+    int32_t recurrent_scale_b[4];
+    int n_gates = 0;
+    auto add_gate = [&](int16_t* gate, int32_t effective_input_scale_a,
+                        int32_t effective_input_scale_b,
+                        int32_t effective_recurrent_scale_a,
+                        int32_t effective_recurrent_scale_b) {
+      gates[n_gates] = gate;
+      input_scale_a[n_gates] = effective_input_scale_a;
+      input_scale_b[n_gates] = effective_input_scale_b;
+      recurrent_scale_a[n_gates] = effective_recurrent_scale_a;
+      recurrent_scale_b[n_gates] = effective_recurrent_scale_b;
+      ++n_gates;
+    };
+    if (!use_cifg) {
+      add_gate(input_gate_scratch, effective_input_to_input_scale_a,
+               effective_input_to_input_scale_b,
+               effective_recurrent_to_input_scale_a,
+               effective_recurrent_to_input_scale_b);
+    }
+    add_gate(forget_gate_scratch, effective_input_to_forget_scale_a,
+             effective_input_to_forget_scale_b,
+             effective_recurrent_to_forget_scale_a,
+             effective_recurrent_to_forget_scale_b);
+    add_gate(cell_gate_scratch, effective_input_to_cell_scale_a,
+             effective_input_to_cell_scale_b,
+             effective_recurrent_to_cell_scale_a,
+             effective_recurrent_to_cell_scale_b);
+    add_gate(output_gate_scratch, effective_input_to_output_scale_a,
+             effective_input_to_output_scale_b,
+             effective_recurrent_to_output_scale_a,
+             effective_recurrent_to_output_scale_b);
+    CalculateFusedLstmGateMatmulsInteger8x8_16(
+        input_ptr, fused_input_weights, fused_input_effective_bias,
+        input_scale_a, input_scale_b, output_state_ptr, fused_recurrent_weights,
+        fused_recurrent_effective_bias, recurrent_scale_a, recurrent_scale_b,
+        n_gates, n_batch, n_input, n_output, n_cell, gates, context, scratch5);
+    if (!use_cifg) {
+      FinishLstmGateInteger8x8_16(
+          cell_state_ptr, cell_to_input_weight_ptr,
+          effective_cell_to_input_scale_a, effective_cell_to_input_scale_b,
+          layer_norm_input_weight_ptr, input_gate_bias_ptr,
+          layer_norm_input_scale_a, layer_norm_input_scale_b,
+          input_variance_guard, n_batch, n_output, n_cell, kTfLiteActSigmoid,
+          input_gate_scratch);
+    }
+    FinishLstmGateInteger8x8_16(
+        cell_state_ptr, cell_to_forget_weight_ptr,
+        effective_cell_to_forget_scale_a, effective_cell_to_forget_scale_b,
+        layer_norm_forget_weight_ptr, forget_gate_bias_ptr,
+        layer_norm_forget_scale_a, layer_norm_forget_scale_b,
+        forget_variance_guard, n_batch, n_output, n_cell, kTfLiteActSigmoid,
+        forget_gate_scratch);
+    FinishLstmGateInteger8x8_16(
+        cell_state_ptr, /*cell_to_gate_weights=*/nullptr,
+        /*cell_to_gate_scale_a=*/0, /*cell_to_gate_scale_b=*/0,
+        layer_norm_cell_weight_ptr, cell_gate_bias_ptr,
+        layer_norm_cell_scale_a, layer_norm_cell_scale_b, cell_variance_guard,
+        n_batch, n_output, n_cell, kTfLiteActTanh, cell_gate_scratch);
+    UpdateLstmCellInteger(n_batch, n_cell, cell_state_ptr, cell_state_scale,
+                          input_gate_scratch, forget_gate_scratch,
+                          cell_gate_scratch, use_cifg, quantized_cell_clip);
+    FinishLstmGateInteger8x8_16(
+        cell_state_ptr, cell_to_output_weight_ptr,
+        effective_cell_to_output_scale_a, effective_cell_to_output_scale_b,
+        layer_norm_output_weight_ptr, output_gate_bias_ptr,
+        layer_norm_output_scale_a, layer_norm_output_scale_b,
+        output_variance_guard, n_batch, n_output, n_cell, kTfLiteActSigmoid,
+        output_gate_scratch);
+  } else {
+    if (!use_cifg) {
+      // Calculate the input gate. (If not CIFG.)
+      CalculateLstmGateInteger8x8_16(
+          input_ptr, input_to_input_weight_ptr, input_to_input_effective_bias,
+          effective_input_to_input_scale_a, effective_input_to_input_scale_b,
+          output_state_ptr, recurrent_to_input_weight_ptr,
+          recurrent_to_input_effective_bias,
+          effective_recurrent_to_input_scale_a,
+          effective_recurrent_to_input_scale_b, cell_state_ptr,
+          cell_to_input_weight_ptr, effective_cell_to_input_scale_a,
+          effective_cell_to_input_scale_b, layer_norm_input_weight_ptr,
+          input_gate_bias_ptr, layer_norm_input_scale_a,
+          layer_norm_input_scale_b, input_variance_guard, n_batch, n_input,
+          n_output, n_cell, kTfLiteActSigmoid, input_gate_scratch, context,
+          scratch5);
+    }
+    // Calculate the forget gate.
+    CalculateLstmGateInteger8x8_16(
+        input_ptr, input_to_forget_weight_ptr, input_to_forget_effective_bias,
+        effective_input_to_forget_scale_a, effective_input_to_forget_scale_b,
+        output_state_ptr, recurrent_to_forget_weight_ptr,
+        recurrent_to_forget_effective_bias,
+        effective_recurrent_to_forget_scale_a,
+        effective_recurrent_to_forget_scale_b, cell_state_ptr,
+        cell_to_forget_weight_ptr, effective_cell_to_forget_scale_a,
+        effective_cell_to_forget_scale_b, layer_norm_forget_weight_ptr,
+        forget_gate_bias_ptr, layer_norm_forget_scale_a,
+        layer_norm_forget_scale_b, forget_variance_guard, n_batch, n_input,
+        n_output, n_cell, kTfLiteActSigmoid, forget_gate_scratch, context,
+        scratch5);
+    // Calculate the cell update gate.
+    CalculateLstmGateInteger8x8_16(
+        input_ptr, input_to_cell_weight_ptr, input_to_cell_effective_bias,
+        effective_input_to_cell_scale_a, effective_input_to_cell_scale_b,
+        output_state_ptr, recurrent_to_cell_weight_ptr,
+        recurrent_to_cell_effective_bias, effective_recurrent_to_cell_scale_a,
+        effective_recurrent_to_cell_scale_b, cell_state_ptr,
+        /*cell_to_gate_weights=*/nullptr, /*cell_to_gate_scale_a=*/0,
+        /*cell_to_gate_scale_b=*/0, layer_norm_cell_weight_ptr,
+        cell_gate_bias_ptr, layer_norm_cell_scale_a, layer_norm_cell_scale_b,
+        cell_variance_guard, n_batch, n_input, n_output, n_cell, kTfLiteActTanh,
+        cell_gate_scratch, context, scratch5);
+    // Update the cell state.
+    UpdateLstmCellInteger(n_batch, n_cell, cell_state_ptr, cell_state_scale,
+                          input_gate_scratch, forget_gate_scratch,
+                          cell_gate_scratch, use_cifg, quantized_cell_clip);
+    // Calculate the output gate.
     CalculateLstmGateInteger8x8_16(
-        input_ptr, input_to_input_weight_ptr, input_to_input_effective_bias,
-        effective_input_to_input_scale_a, effective_input_to_input_scale_b,
-        output_state_ptr, recurrent_to_input_weight_ptr,
-        recurrent_to_input_effective_bias, effective_recurrent_to_input_scale_a,
-        effective_recurrent_to_input_scale_b, cell_state_ptr,
-        cell_to_input_weight_ptr, effective_cell_to_input_scale_a,
-        effective_cell_to_input_scale_b, layer_norm_input_weight_ptr,
-        input_gate_bias_ptr, layer_norm_input_scale_a, layer_norm_input_scale_b,
-        input_variance_guard, n_batch, n_input, n_output, n_cell,
-        kTfLiteActSigmoid, input_gate_scratch, context, scratch5);
+        input_ptr, input_to_output_weight_ptr, input_to_output_effective_bias,
+        effective_input_to_output_scale_a, effective_input_to_output_scale_b,
+        output_state_ptr, recurrent_to_output_weight_ptr,
+        recurrent_to_output_effective_bias,
+        effective_recurrent_to_output_scale_a,
+        effective_recurrent_to_output_scale_b, cell_state_ptr,
+        cell_to_output_weight_ptr, effective_cell_to_output_scale_a,
+        effective_cell_to_output_scale_b, layer_norm_output_weight_ptr,
+        output_gate_bias_ptr, layer_norm_output_scale_a,
+        layer_norm_output_scale_b, output_variance_guard, n_batch, n_input,
+        n_output, n_cell, kTfLiteActSigmoid, output_gate_scratch, context,
+        scratch5);
   }
-  // Calculate the forget gate.
-  CalculateLstmGateInteger8x8_16(
-      input_ptr, input_to_forget_weight_ptr, input_to_forget_effective_bias,
-      effective_input_to_forget_scale_a, effective_input_to_forget_scale_b,
-      output_state_ptr, recurrent_to_forget_weight_ptr,
-      recurrent_to_forget_effective_bias, effective_recurrent_to_forget_scale_a,
-      effective_recurrent_to_forget_scale_b, cell_state_ptr,
-      cell_to_forget_weight_ptr, effective_cell_to_forget_scale_a,
-      effective_cell_to_forget_scale_b, layer_norm_forget_weight_ptr,
-      forget_gate_bias_ptr, layer_norm_forget_scale_a,
-      layer_norm_forget_scale_b, forget_variance_guard, n_batch, n_input,
-      n_output, n_cell, kTfLiteActSigmoid, forget_gate_scratch, context,
-      scratch5);
-  // Calculate the cell update gate.
-  CalculateLstmGateInteger8x8_16(
-      input_ptr, input_to_cell_weight_ptr, input_to_cell_effective_bias,
-      effective_input_to_cell_scale_a, effective_input_to_cell_scale_b,
-      output_state_ptr, recurrent_to_cell_weight_ptr,
-      recurrent_to_cell_effective_bias, effective_recurrent_to_cell_scale_a,
-      effective_recurrent_to_cell_scale_b, cell_state_ptr,
-      /*cell_to_gate_weights=*/nullptr, /*cell_to_gate_scale_a=*/0,
-      /*cell_to_gate_scale_b=*/0, layer_norm_cell_weight_ptr,
-      cell_gate_bias_ptr, layer_norm_cell_scale_a, layer_norm_cell_scale_b,
-      cell_variance_guard, n_batch, n_input, n_output, n_cell, kTfLiteActTanh,
-      cell_gate_scratch, context, scratch5);
-  // Update the cell state.
-  UpdateLstmCellInteger(n_batch, n_cell, cell_state_ptr, cell_state_scale,
-                        input_gate_scratch, forget_gate_scratch,
-                        cell_gate_scratch, use_cifg, quantized_cell_clip);
-  // Calculate the output gate.
-  CalculateLstmGateInteger8x8_16(
-      input_ptr, input_to_output_weight_ptr, input_to_output_effective_bias,
-      effective_input_to_output_scale_a, effective_input_to_output_scale_b,
-      output_state_ptr, recurrent_to_output_weight_ptr,
-      recurrent_to_output_effective_bias, effective_recurrent_to_output_scale_a,
-      effective_recurrent_to_output_scale_b, cell_state_ptr,
-      cell_to_output_weight_ptr, effective_cell_to_output_scale_a,
-      effective_cell_to_output_scale_b, layer_norm_output_weight_ptr,
-      output_gate_bias_ptr, layer_norm_output_scale_a,
-      layer_norm_output_scale_b, output_variance_guard, n_batch, n_input,
-      n_output, n_cell, kTfLiteActSigmoid, output_gate_scratch, context,
-      scratch5);
   // Update the output state.
   CalculateLstmOutputInteger8x8_16(
       n_batch, n_cell, n_output, cell_state_ptr, cell_state_scale,
@@ -2281,6 +2480,63 @@ TfLiteStatus EvalHybrid(
   return kTfLiteOk;
 }
 
+void PopulateFusedGateWeightsInteger8x8_16(
+    const TfLiteTensor* input_to_input_weights,
+    const TfLiteTensor* input_to_forget_weights,
+    const TfLiteTensor* input_to_cell_weights,
+    const TfLiteTensor* input_to_output_weights,
+    const TfLiteTensor* recurrent_to_input_weights,
+    const TfLiteTensor* recurrent_to_forget_weights,
+    const TfLiteTensor* recurrent_to_cell_weights,
+    const TfLiteTensor* recurrent_to_output_weights,
+    IntegerLstmParameter* integer_lstm_param) {
+  const bool use_cifg = (input_to_input_weights == nullptr);
+  const int n_gates = use_cifg ? 3 : 4;
+  const int n_cell = input_to_output_weights->dims->data[0];
+  const int n_input = input_to_output_weights->dims->data[1];
+  const int n_output = recurrent_to_output_weights->dims->data[1];
+  const TfLiteTensor* input_weights[] = {
+      input_to_input_weights, input_to_forget_weights, input_to_cell_weights,
+      input_to_output_weights};
+  const TfLiteTensor* recurrent_weights[] = {
+      recurrent_to_input_weights, recurrent_to_forget_weights,
+      recurrent_to_cell_weights, recurrent_to_output_weights};
+  const int32_t* input_effective_biases[] = {
+      integer_lstm_param->input_to_input_effective_bias.get(),
+      integer_lstm_param->input_to_forget_effective_bias.get(),
+      integer_lstm_param->input_to_cell_effective_bias.get(),
+      integer_lstm_param->input_to_output_effective_bias.get()};
+  const int32_t* recurrent_effective_biases[] = {
+      integer_lstm_param->recurrent_to_input_effective_bias.get(),
+      integer_lstm_param->recurrent_to_forget_effective_bias.get(),
+      integer_lstm_param->recurrent_to_cell_effective_bias.get(),
+      integer_lstm_param->recurrent_to_output_effective_bias.get()};
+
+  integer_lstm_param->fused_input_weights.reset(
+      new int8_t[n_gates * n_cell * n_input]);
+  integer_lstm_param->fused_input_effective_bias.reset(
+      new int32_t[n_gates * n_cell]);
+  integer_lstm_param->fused_recurrent_weights.reset(
+      new int8_t[n_gates * n_cell * n_output]);
+  integer_lstm_param->fused_recurrent_effective_bias.reset(
+      new int32_t[n_gates * n_cell]);
+  for (int gate = use_cifg ? 1 : 0, g = 0; gate < 4; ++gate, ++g) {
+    std::copy_n(GetTensorData<int8_t>(input_weights[gate]), n_cell * n_input,
+                integer_lstm_param->fused_input_weights.get() +
+                    g * n_cell * n_input);
+    std::copy_n(input_effective_biases[gate], n_cell,
+                integer_lstm_param->fused_input_effective_bias.get() +
+                    g * n_cell);
+    std::copy_n(GetTensorData<int8_t>(recurrent_weights[gate]),
+                n_cell * n_output,
+                integer_lstm_param->fused_recurrent_weights.get() +
+                    g * n_cell * n_output);
+    std::copy_n(recurrent_effective_biases[gate], n_cell,
+                integer_lstm_param->fused_recurrent_effective_bias.get() +
+                    g * n_cell);
+  }
+}
+
 TfLiteStatus EvalInteger8x8_16(
     const TfLiteTensor* input, const TfLiteTensor* input_to_input_weights,
     const TfLiteTensor* input_to_forget_weights,
@@ -2328,7 +2584,10 @@ TfLiteStatus EvalInteger8x8_16(
   const int output_batch_leading_dim =
       output->dims->data[output->dims->size - 1];
 
-  if (time_major) {
+  // A batch-major input of a single time step has the layout of a time-major
+  // one: run its sequences, e.g. the streams of a server feeding a frame each,
+  // as one batch through the same GEMMs instead of one by one.
+  if (time_major || max_time == 1) {
     const int input_step = n_batch * n_input;
     const int output_step = n_batch * output_batch_leading_dim;
     for (int t = 0; t < max_time; t++) {
@@ -2407,8 +2666,12 @@ TfLiteStatus EvalInteger8x8_16(
           integer_lstm_param->recurrent_to_output_effective_bias.get(),
           integer_lstm_param->input_to_input_effective_bias.get(),
           integer_lstm_param->recurrent_to_input_effective_bias.get(),
-          integer_lstm_param->projection_effective_bias.get(), n_batch, n_cell,
-          n_input, n_output, GetTensorData<int8_t>(output_state),
+          integer_lstm_param->projection_effective_bias.get(),
+          integer_lstm_param->fused_input_weights.get(),
+          integer_lstm_param->fused_input_effective_bias.get(),
+          integer_lstm_param->fused_recurrent_weights.get(),
+          integer_lstm_param->fused_recurrent_effective_bias.get(), n_batch,
+          n_cell, n_input, n_output, GetTensorData<int8_t>(output_state),
           output_state_zp, GetTensorData<int16_t>(cell_state), output_ptr,
           GetTensorData<int16_t>(scratch0), GetTensorData<int16_t>(scratch1),
           GetTensorData<int16_t>(scratch2), GetTensorData<int16_t>(scratch3),
@@ -2506,9 +2769,14 @@ TfLiteStatus EvalInteger8x8_16(
             integer_lstm_param->recurrent_to_output_effective_bias.get(),
             integer_lstm_param->input_to_input_effective_bias.get(),
             integer_lstm_param->recurrent_to_input_effective_bias.get(),
-            integer_lstm_param->projection_effective_bias.get(), /*n_batch=*/1,
-            n_cell, n_input, n_output, output_state_ptr, output_state_zp,
-            cell_state_ptr, output_ptr, GetTensorData<int16_t>(scratch0),
+            integer_lstm_param->projection_effective_bias.get(),
+            integer_lstm_param->fused_input_weights.get(),
+            integer_lstm_param->fused_input_effective_bias.get(),
+            integer_lstm_param->fused_recurrent_weights.get(),
+            integer_lstm_param->fused_recurrent_effective_bias.get(),
+            /*n_batch=*/1, n_cell, n_input, n_output, output_state_ptr,
+            output_state_zp, cell_state_ptr, output_ptr,
+            GetTensorData<int16_t>(scratch0),
             GetTensorData<int16_t>(scratch1), GetTensorData<int16_t>(scratch2),
             GetTensorData<int16_t>(scratch3), GetTensorData<int8_t>(scratch4),
             GetTensorData<int32_t>(scratch5), context);
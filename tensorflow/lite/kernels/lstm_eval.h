@@ -88,6 +88,15 @@ struct IntegerLstmParameter {
   std::unique_ptr<int32_t[]> recurrent_to_input_effective_bias;
   std::unique_ptr<int32_t[]> projection_effective_bias;
 
+  // The input and recurrent weights of the gates and their effective biases,
+  // stacked in input (unless CIFG), forget, cell and output gate order, to
+  // compute the matmuls of all the gates of a step with one GEMM per operand.
+  // Used only in the 8x8_16 case, if not null.
+  std::unique_ptr<int8_t[]> fused_input_weights;
+  std::unique_ptr<int32_t[]> fused_input_effective_bias;
+  std::unique_ptr<int8_t[]> fused_recurrent_weights;
+  std::unique_ptr<int32_t[]> fused_recurrent_effective_bias;
+
   // Scale and zero point for intermediate tensors.
   // Used only in the 8x8_8 case.
   int32_t intermediate_scale_a[8];
@@ -174,6 +183,21 @@ TfLiteStatus EvalHybrid(
     bool recurrent_to_forget_is_diag, bool recurrent_to_cell_is_diag,
     bool recurrent_to_output_is_diag, CpuBackendContext* context);
 
+// Populates the fused_* fields of `integer_lstm_param` from the weights and
+// the effective biases, which must be computed already. EvalInteger8x8_16 then
+// needs a scratch5 of size n_batch * n_gates * n_cell, with n_gates 3 for CIFG
+// and 4 otherwise.
+void PopulateFusedGateWeightsInteger8x8_16(
+    const TfLiteTensor* input_to_input_weights,
+    const TfLiteTensor* input_to_forget_weights,
+    const TfLiteTensor* input_to_cell_weights,
+    const TfLiteTensor* input_to_output_weights,
+    const TfLiteTensor* recurrent_to_input_weights,
+    const TfLiteTensor* recurrent_to_forget_weights,
+    const TfLiteTensor* recurrent_to_cell_weights,
+    const TfLiteTensor* recurrent_to_output_weights,
+    IntegerLstmParameter* integer_lstm_param);
+
 TfLiteStatus EvalInteger8x8_16(
     const TfLiteTensor* input, const TfLiteTensor* input_to_input_weights,
     const TfLiteTensor* input_to_forget_weights,
@@ -461,6 +461,16 @@ class QuantizedLstmParam : public BaseLstmParam {
                 115);
     return &integer_lstm_param_;
   }
+  // Same as GetQuantParam, with the gate weights stacked for the fused matmuls,
+  // which need a larger scratch5. Call before GetScratch5.
+  ops::builtin::lstm_eval::IntegerLstmParameter* GetFusedQuantParam() {
+    GetQuantParam();
+    ops::builtin::lstm_eval::PopulateFusedGateWeightsInteger8x8_16(
+        Geti2i(), Geti2f(), Geti2c(), Geti2o(), Getr2i(), Getr2f(), Getr2c(),
+        Getr2o(), &integer_lstm_param_);
+    scratch5_size_ = {n_batch_, 4 * n_cell_};
+    return &integer_lstm_param_;
+  }
 
   // Create scratch buffers.
   TfLiteTensor* GetScratch0() {
@@ -601,13 +611,14 @@ class QuantizedLstmParam : public BaseLstmParam {
   TfLiteTensor scratch5_tensor_;
 };
 
-void TestOneFullyQuantizedLSTM() {
+void TestOneFullyQuantizedLSTM(bool fused_gates) {
   CpuBackendContext context;
   QuantizedLstmParam one_parameter;
   auto activation = one_parameter.GetActivation();
   auto output = one_parameter.GetOutput();
   auto cell = one_parameter.GetCell();
-  auto param = one_parameter.GetQuantParam();
+  auto param = fused_gates ? one_parameter.GetFusedQuantParam()
+                           : one_parameter.GetQuantParam();
   ops::builtin::lstm_eval::EvalInteger8x8_16(
       one_parameter.GetInput(), one_parameter.Geti2i(), one_parameter.Geti2f(),
       one_parameter.Geti2c(), one_parameter.Geti2o(), one_parameter.Getr2i(),
@@ -636,7 +647,11 @@ void TestOneFullyQuantizedLSTM() {
 }
 
 TEST(TestOneFullyQuantizedLSTM, TestOneFullyQuantizedLSTM) {
-  TestOneFullyQuantizedLSTM();
+  TestOneFullyQuantizedLSTM(/*fused_gates=*/false);
+}
+
+TEST(TestOneFullyQuantizedLSTM, TestOneFullyQuantizedLSTMFusedGates) {
+  TestOneFullyQuantizedLSTM(/*fused_gates=*/true);
 }
 
 class HybridLstmParam : public BaseLstmParam {
@@ -44,6 +44,17 @@ class MemoryPlanner {
   // Invalidates allocations after the given node execution.
   virtual TfLiteStatus ResetAllocationsAfter(int node) = 0;
 
+  // Updates the allocations of `tensors`, whose sizes changed since the last
+  // call to ExecuteAllocations(), without planning the other tensors again.
+  // Sets `updated` to false, leaving all allocations unchanged, if the memory
+  // planned for any of them can't hold it anymore; the allocations must then
+  // be reset and executed again.
+  virtual TfLiteStatus UpdateAllocations(const std::vector<int>& tensors,
+                                         bool* updated) {
+    *updated = false;
+    return kTfLiteOk;
+  }
+
   // NOTE: The following two methods modify the data pointers for all tensors on
   // the non-persistent arena (inputs, outputs, intermediates). If the user has
   // manually set the pointers for any of these, they would need to be set
@@ -66,6 +77,12 @@ class MemoryPlanner {
   // execution plan (i.e. `execution_plan`) for the purpose of debugging.
   virtual void DumpDebugInfo(const std::vector<int>& execution_plan) const = 0;
 
+  // Declares that the nodes of the execution plan with the same stage in
+  // `node_stages`, which is non-decreasing, may be executed concurrently.
+  // Planners that reuse the memory of a tensor for another one must then not
+  // reuse it within a stage.
+  virtual void SetNodeStages(const std::vector<int>& node_stages) {}
+
   // Returns a map of allocation information. It's only used for debugging.
   virtual void GetAllocInfo(size_t *arena_size,
                             size_t *arena_persist_size) const = 0;
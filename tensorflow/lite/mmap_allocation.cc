@@ -20,6 +20,7 @@ limitations under the License.
 #include <unistd.h>
 
 #include <cerrno>
+#include <cstdint>
 
 #include "tensorflow/lite/allocation.h"
 #include "tensorflow/lite/core/api/error_reporter.h"
@@ -27,6 +28,15 @@ limitations under the License.
 namespace tflite {
 namespace {
 
+size_t GetPageSize() {
+#ifdef __ANDROID__
+  static int pagesize = getpagesize();
+#else
+  static int pagesize = sysconf(_SC_PAGE_SIZE);
+#endif
+  return pagesize;
+}
+
 size_t GetFdSizeBytes(int fd) {
   if (fd < 0) {
     return 0;
@@ -44,14 +54,23 @@ size_t GetFdSizeBytes(int fd) {
 
 MMAPAllocation::MMAPAllocation(const char* filename,
                                ErrorReporter* error_reporter)
-    : MMAPAllocation(error_reporter, open(filename, O_RDONLY)) {
+    : MMAPAllocation(error_reporter, open(filename, O_RDONLY),
+                     /*populate=*/false) {
+  if (mmap_fd_ == -1) {
+    TF_LITE_REPORT_ERROR(error_reporter, "Could not open '%s'.", filename);
+  }
+}
+
+MMAPAllocation::MMAPAllocation(const char* filename, bool populate,
+                               ErrorReporter* error_reporter)
+    : MMAPAllocation(error_reporter, open(filename, O_RDONLY), populate) {
   if (mmap_fd_ == -1) {
     TF_LITE_REPORT_ERROR(error_reporter, "Could not open '%s'.", filename);
   }
 }
 
 MMAPAllocation::MMAPAllocation(int fd, ErrorReporter* error_reporter)
-    : MMAPAllocation(error_reporter, dup(fd)) {
+    : MMAPAllocation(error_reporter, dup(fd), /*populate=*/false) {
   if (mmap_fd_ == -1) {
     TF_LITE_REPORT_ERROR(error_reporter, "Failed to dup '%d' file descriptor.",
                          fd);
@@ -60,19 +79,21 @@ MMAPAllocation::MMAPAllocation(int fd, ErrorReporter* error_reporter)
 
 MMAPAllocation::MMAPAllocation(int fd, size_t offset, size_t length,
                                ErrorReporter* error_reporter)
-    : MMAPAllocation(error_reporter, dup(fd), offset, length) {
+    : MMAPAllocation(error_reporter, dup(fd), offset, length,
+                     /*populate=*/false) {
   if (mmap_fd_ == -1) {
     TF_LITE_REPORT_ERROR(error_reporter, "Failed to dup '%d' file descriptor.",
                          fd);
   }
 }
 
-MMAPAllocation::MMAPAllocation(ErrorReporter* error_reporter, int owned_fd)
+MMAPAllocation::MMAPAllocation(ErrorReporter* error_reporter, int owned_fd,
+                               bool populate)
     : MMAPAllocation(error_reporter, owned_fd, /*offset=*/0,
-                     /*length=*/GetFdSizeBytes(owned_fd)) {}
+                     /*length=*/GetFdSizeBytes(owned_fd), populate) {}
 
 MMAPAllocation::MMAPAllocation(ErrorReporter* error_reporter, int owned_fd,
-                               size_t offset, size_t length)
+                               size_t offset, size_t length, bool populate)
     : Allocation(error_reporter, Allocation::Type::kMMap),
       mmap_fd_(owned_fd),
       mmapped_buffer_(MAP_FAILED),
@@ -81,12 +102,7 @@ MMAPAllocation::MMAPAllocation(ErrorReporter* error_reporter, int owned_fd,
     return;
   }
 
-#ifdef __ANDROID__
-  static int pagesize = getpagesize();
-#else
-  static int pagesize = sysconf(_SC_PAGE_SIZE);
-#endif
-
+  const size_t pagesize = GetPageSize();
   offset_in_buffer_ = offset % pagesize;
   offset_of_buffer_in_file_ = offset - offset_in_buffer_;
 
@@ -99,8 +115,14 @@ MMAPAllocation::MMAPAllocation(ErrorReporter* error_reporter, int owned_fd,
     return;
   }
 
+  int flags = MAP_SHARED;
+#ifdef MAP_POPULATE
+  if (populate) {
+    flags |= MAP_POPULATE;
+  }
+#endif
   mmapped_buffer_ =
-      mmap(nullptr, /*__len=*/length + offset_in_buffer_, PROT_READ, MAP_SHARED,
+      mmap(nullptr, /*__len=*/length + offset_in_buffer_, PROT_READ, flags,
            mmap_fd_, /*__offset=*/offset - offset_in_buffer_);
   if (mmapped_buffer_ == MAP_FAILED) {
     TF_LITE_REPORT_ERROR(error_reporter,
@@ -108,6 +130,11 @@ MMAPAllocation::MMAPAllocation(ErrorReporter* error_reporter, int owned_fd,
                          mmap_fd_, offset, errno);
     return;
   }
+#ifndef MAP_POPULATE
+  if (populate) {
+    Advise(base(), bytes(), Advice::kWillNeed);
+  }
+#endif
 }
 
 MMAPAllocation::~MMAPAllocation() {
@@ -129,6 +156,50 @@ size_t MMAPAllocation::bytes() const { return buffer_size_bytes_; }
 
 bool MMAPAllocation::valid() const { return mmapped_buffer_ != MAP_FAILED; }
 
+bool MMAPAllocation::Advise(const void* data, size_t size,
+                            Advice advice) const {
+  if (!valid()) {
+    return false;
+  }
+  const uintptr_t buffer_begin = reinterpret_cast<uintptr_t>(mmapped_buffer_);
+  const uintptr_t buffer_end = buffer_begin + mmapped_buffer_size();
+  uintptr_t begin = reinterpret_cast<uintptr_t>(data);
+  uintptr_t end = begin + size;
+  if (begin < buffer_begin || end < begin || end > buffer_end) {
+    return false;
+  }
+  const uintptr_t pagesize = GetPageSize();
+  int madvise_advice;
+  switch (advice) {
+    case Advice::kNormal:
+      madvise_advice = MADV_NORMAL;
+      break;
+    case Advice::kSequential:
+      madvise_advice = MADV_SEQUENTIAL;
+      break;
+    case Advice::kWillNeed:
+      madvise_advice = MADV_WILLNEED;
+      break;
+    case Advice::kDontNeed:
+      madvise_advice = MADV_DONTNEED;
+      // Keep the pages shared with the data around the range.
+      begin = (begin + pagesize - 1) / pagesize * pagesize;
+      end = end / pagesize * pagesize;
+      if (begin >= end) {
+        return true;
+      }
+      break;
+  }
+  // The mapped buffer begins on a page boundary and covers its last page.
+  begin = begin / pagesize * pagesize;
+  end = (end + pagesize - 1) / pagesize * pagesize;
+  if (begin == end) {
+    return true;
+  }
+  return madvise(reinterpret_cast<void*>(begin), end - begin,
+                 madvise_advice) == 0;
+}
+
 bool MMAPAllocation::IsSupported() { return true; }
 
 }  // namespace tflite
@@ -21,16 +21,21 @@ namespace tflite {
 
 MMAPAllocation::MMAPAllocation(const char* filename,
                                ErrorReporter* error_reporter)
-    : MMAPAllocation(error_reporter, -1) {}
+    : MMAPAllocation(error_reporter, -1, /*populate=*/false) {}
+
+MMAPAllocation::MMAPAllocation(const char* filename, bool populate,
+                               ErrorReporter* error_reporter)
+    : MMAPAllocation(error_reporter, -1, /*populate=*/false) {}
 
 MMAPAllocation::MMAPAllocation(int fd, ErrorReporter* error_reporter)
-    : MMAPAllocation(error_reporter, -1) {}
+    : MMAPAllocation(error_reporter, -1, /*populate=*/false) {}
 
 MMAPAllocation::MMAPAllocation(int fd, size_t offset, size_t length,
                                ErrorReporter* error_reporter)
-    : MMAPAllocation(error_reporter, -1) {}
+    : MMAPAllocation(error_reporter, -1, /*populate=*/false) {}
 
-MMAPAllocation::MMAPAllocation(ErrorReporter* error_reporter, int owned_fd)
+MMAPAllocation::MMAPAllocation(ErrorReporter* error_reporter, int owned_fd,
+                               bool populate)
     : Allocation(error_reporter, Allocation::Type::kMMap),
       mmapped_buffer_(nullptr) {
   // The disabled variant should never be created.
@@ -45,6 +50,11 @@ size_t MMAPAllocation::bytes() const { return 0; }
 
 bool MMAPAllocation::valid() const { return false; }
 
+bool MMAPAllocation::Advise(const void* data, size_t size,
+                            Advice advice) const {
+  return false;
+}
+
 bool MMAPAllocation::IsSupported() { return false; }
 
 }  // namespace tflite
@@ -0,0 +1,180 @@
+/* Copyright 2024 The TensorFlow Authors. All Rights Reserved.
+
+Licensed under the Apache License, Version 2.0 (the "License");
+you may not use this file except in compliance with the License.
+You may obtain a copy of the License at
+
+    http://www.apache.org/licenses/LICENSE-2.0
+
+Unless required by applicable law or agreed to in writing, software
+distributed under the License is distributed on an "AS IS" BASIS,
+WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+See the License for the specific language governing permissions and
+limitations under the License.
+==============================================================================*/
+#include "tensorflow/lite/profiling/perf_event_profiler.h"
+
+#include <chrono>  // NOLINT(build/c++11)
+#include <cstdint>
+#include <cstring>
+#include <tuple>
+#include <vector>
+
+#if defined(__linux__)
+#include <linux/perf_event.h>
+#include <sys/ioctl.h>
+#include <sys/syscall.h>
+#include <unistd.h>
+#endif
+
+namespace tflite {
+namespace profiling {
+
+namespace {
+
+#if defined(__linux__)
+// Opens a counter of the calling thread in the group of `group_fd`, or as the
+// leader of a new group if -1. Returns -1 on failure.
+int OpenCounter(uint64_t config, int group_fd) {
+  perf_event_attr attr;
+  std::memset(&attr, 0, sizeof(attr));
+  attr.type = PERF_TYPE_HARDWARE;
+  attr.size = sizeof(attr);
+  attr.config = config;
+  attr.read_format = PERF_FORMAT_GROUP;
+  // The leader starts the group disabled, to enable all its counters at once.
+  attr.disabled = group_fd == -1 ? 1 : 0;
+  attr.exclude_kernel = 1;
+  attr.exclude_hv = 1;
+  return static_cast<int>(syscall(__NR_perf_event_open, &attr, /*pid=*/0,
+                                  /*cpu=*/-1, group_fd, /*flags=*/0));
+}
+#endif
+
+bool IsOperatorEvent(Profiler::EventType event_type) {
+  return event_type == Profiler::EventType::OPERATOR_INVOKE_EVENT ||
+         event_type == Profiler::EventType::DELEGATE_OPERATOR_INVOKE_EVENT ||
+         event_type ==
+             Profiler::EventType::DELEGATE_PROFILED_OPERATOR_INVOKE_EVENT;
+}
+
+}  // namespace
+
+PerfEventProfiler::PerfEventProfiler() {
+  for (int& index : counter_index_) {
+    index = -1;
+  }
+#if defined(__linux__)
+  const uint64_t configs[kNumCounters] = {PERF_COUNT_HW_CPU_CYCLES,
+                                          PERF_COUNT_HW_INSTRUCTIONS,
+                                          PERF_COUNT_HW_CACHE_MISSES};
+  for (int counter = 0; counter < kNumCounters; ++counter) {
+    const int group_fd = counter_fds_.empty() ? -1 : counter_fds_[0];
+    const int fd = OpenCounter(configs[counter], group_fd);
+    if (fd == -1) {
+      // Without cycles there is no group to add the other counters to.
+      if (counter == kCycles) return;
+      continue;
+    }
+    counter_index_[counter] = static_cast<int>(counter_fds_.size());
+    counter_fds_.push_back(fd);
+  }
+  ioctl(counter_fds_[0], PERF_EVENT_IOC_RESET, PERF_IOC_FLAG_GROUP);
+  ioctl(counter_fds_[0], PERF_EVENT_IOC_ENABLE, PERF_IOC_FLAG_GROUP);
+#endif
+}
+
+PerfEventProfiler::~PerfEventProfiler() {
+#if defined(__linux__)
+  for (int fd : counter_fds_) {
+    close(fd);
+  }
+#endif
+}
+
+uint32_t PerfEventProfiler::BeginEvent(const char* tag, EventType event_type,
+                                       int64_t event_metadata1,
+                                       int64_t event_metadata2) {
+  if (!enabled_ || !IsOperatorEvent(event_type)) return 0;
+  PendingEvent event{tag, event_type, event_metadata1, event_metadata2, {}};
+  if (!ReadCounters(&event.begin)) return 0;
+  pending_events_.push_back(event);
+  return static_cast<uint32_t>(pending_events_.size());
+}
+
+void PerfEventProfiler::EndEvent(uint32_t event_handle) {
+  if (event_handle == 0 || event_handle > pending_events_.size()) return;
+  Values end;
+  if (!ReadCounters(&end)) return;
+  const PendingEvent& event = pending_events_[event_handle - 1];
+  OpHardwareCounters& op = op_counters_[std::make_tuple(
+      event.subgraph_index, event.node_index, event.event_type)];
+  if (op.num_invocations == 0) {
+    op.tag = event.tag;
+    op.subgraph_index = event.subgraph_index;
+    op.node_index = event.node_index;
+    op.cycles = counter_index_[kCycles] == -1 ? -1 : 0;
+    op.instructions = counter_index_[kInstructions] == -1 ? -1 : 0;
+    op.llc_misses = counter_index_[kLlcMisses] == -1 ? -1 : 0;
+  }
+  ++op.num_invocations;
+  op.elapsed_time_ns += end.time_ns - event.begin.time_ns;
+  int64_t* const totals[kNumCounters] = {&op.cycles, &op.instructions,
+                                         &op.llc_misses};
+  for (int counter = 0; counter < kNumCounters; ++counter) {
+    if (counter_index_[counter] == -1) continue;
+    *totals[counter] +=
+        end.counters[counter] - event.begin.counters[counter];
+  }
+  // Events end in the reverse order they began, discard any event nested in
+  // this one and never ended.
+  pending_events_.resize(event_handle - 1);
+}
+
+void PerfEventProfiler::StartProfiling() { enabled_ = IsSupported(); }
+
+void PerfEventProfiler::StopProfiling() {
+  enabled_ = false;
+  pending_events_.clear();
+}
+
+void PerfEventProfiler::Reset() {
+  StopProfiling();
+  op_counters_.clear();
+}
+
+std::vector<OpHardwareCounters> PerfEventProfiler::GetOpHardwareCounters()
+    const {
+  std::vector<OpHardwareCounters> op_counters;
+  op_counters.reserve(op_counters_.size());
+  for (const auto& op : op_counters_) {
+    op_counters.push_back(op.second);
+  }
+  return op_counters;
+}
+
+bool PerfEventProfiler::ReadCounters(Values* values) const {
+#if defined(__linux__)
+  // The PERF_FORMAT_GROUP layout: the number of counters, then their values.
+  uint64_t buffer[1 + kNumCounters];
+  const ssize_t size = read(counter_fds_[0], buffer, sizeof(buffer));
+  if (size < static_cast<ssize_t>(sizeof(uint64_t)) ||
+      buffer[0] != counter_fds_.size()) {
+    return false;
+  }
+  for (int counter = 0; counter < kNumCounters; ++counter) {
+    const int index = counter_index_[counter];
+    values->counters[counter] =
+        index == -1 ? 0 : static_cast<int64_t>(buffer[1 + index]);
+  }
+  values->time_ns = std::chrono::duration_cast<std::chrono::nanoseconds>(
+                        std::chrono::steady_clock::now().time_since_epoch())
+                        .count();
+  return true;
+#else
+  return false;
+#endif
+}
+
+}  // namespace profiling
+}  // namespace tflite
@@ -0,0 +1,118 @@
+/* Copyright 2024 The TensorFlow Authors. All Rights Reserved.
+
+Licensed under the Apache License, Version 2.0 (the "License");
+you may not use this file except in compliance with the License.
+You may obtain a copy of the License at
+
+    http://www.apache.org/licenses/LICENSE-2.0
+
+Unless required by applicable law or agreed to in writing, software
+distributed under the License is distributed on an "AS IS" BASIS,
+WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+See the License for the specific language governing permissions and
+limitations under the License.
+==============================================================================*/
+#ifndef TENSORFLOW_LITE_PROFILING_PERF_EVENT_PROFILER_H_
+#define TENSORFLOW_LITE_PROFILING_PERF_EVENT_PROFILER_H_
+
+#include <cstdint>
+#include <map>
+#include <string>
+#include <tuple>
+#include <vector>
+
+#include "tensorflow/lite/core/api/profiler.h"
+
+namespace tflite {
+namespace profiling {
+
+// The hardware counters accumulated over all the invocations of an operator.
+// A counter the CPU or the kernel doesn't provide is -1.
+struct OpHardwareCounters {
+  // The tag of the operator events, i.e. the name of the op.
+  std::string tag;
+  int64_t subgraph_index = 0;
+  int64_t node_index = 0;
+  int64_t num_invocations = 0;
+  int64_t elapsed_time_ns = 0;
+  int64_t cycles = -1;
+  int64_t instructions = -1;
+  // Misses of the last level cache, each of which reads a cache line from
+  // memory.
+  int64_t llc_misses = -1;
+};
+
+// A profiler that records the cycles, instructions and last level cache misses
+// of each operator invocation with Linux perf_event counters, from which the
+// memory bandwidth of an op and whether it is compute or memory bound can be
+// estimated.
+//
+// The counters count the events of the thread that created the profiler only:
+// the invocations must happen on that thread, and the work an op runs on other
+// threads, e.g. those of the cpu backend thread pool, isn't counted. Profile
+// with a single thread to count all the work of the ops.
+//
+// Other platforms, or a kernel not allowing the counters to be opened (see
+// /proc/sys/kernel/perf_event_paranoid), make IsSupported() false and the
+// profiler record nothing.
+class PerfEventProfiler : public tflite::Profiler {
+ public:
+  PerfEventProfiler();
+  ~PerfEventProfiler() override;
+
+  PerfEventProfiler(const PerfEventProfiler&) = delete;
+  PerfEventProfiler& operator=(const PerfEventProfiler&) = delete;
+
+  // Returns whether the cycles counter, at least, could be opened.
+  bool IsSupported() const { return !counter_fds_.empty(); }
+
+  uint32_t BeginEvent(const char* tag, EventType event_type,
+                      int64_t event_metadata1,
+                      int64_t event_metadata2) override;
+
+  void EndEvent(uint32_t event_handle) override;
+
+  void StartProfiling();
+  void StopProfiling();
+  // Discards the counters recorded so far.
+  void Reset();
+
+  // Returns the counters of each operator, in subgraph and node order.
+  std::vector<OpHardwareCounters> GetOpHardwareCounters() const;
+
+ private:
+  // The counters opened, in the order `ReadCounters` returns their values.
+  enum Counter { kCycles, kInstructions, kLlcMisses, kNumCounters };
+
+  struct Values {
+    int64_t time_ns = 0;
+    int64_t counters[kNumCounters] = {};
+  };
+
+  // An event begun and not ended yet.
+  struct PendingEvent {
+    const char* tag;
+    EventType event_type;
+    int64_t node_index;
+    int64_t subgraph_index;
+    Values begin;
+  };
+
+  // Reads the time and counters, or returns false.
+  bool ReadCounters(Values* values) const;
+
+  bool enabled_ = false;
+  // The group leader, counting cycles, is the first.
+  std::vector<int> counter_fds_;
+  // Index in the values read of each Counter, or -1 if it couldn't be opened.
+  int counter_index_[kNumCounters];
+  std::vector<PendingEvent> pending_events_;
+  // Keyed by subgraph index, node index and event type.
+  std::map<std::tuple<int64_t, int64_t, EventType>, OpHardwareCounters>
+      op_counters_;
+};
+
+}  // namespace profiling
+}  // namespace tflite
+
+#endif  // TENSORFLOW_LITE_PROFILING_PERF_EVENT_PROFILER_H_
@@ -0,0 +1,125 @@
+/* Copyright 2024 The TensorFlow Authors. All Rights Reserved.
+
+Licensed under the Apache License, Version 2.0 (the "License");
+you may not use this file except in compliance with the License.
+You may obtain a copy of the License at
+
+    http://www.apache.org/licenses/LICENSE-2.0
+
+Unless required by applicable law or agreed to in writing, software
+distributed under the License is distributed on an "AS IS" BASIS,
+WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+See the License for the specific language governing permissions and
+limitations under the License.
+==============================================================================*/
+#include "tensorflow/lite/profiling/perf_event_profiler.h"
+
+#include <cstdint>
+#include <vector>
+
+#include <gtest/gtest.h>
+#include "tensorflow/lite/core/api/profiler.h"
+
+namespace tflite {
+namespace profiling {
+namespace {
+
+using EventType = Profiler::EventType;
+
+// Keeps the compiler from optimizing the loop away.
+volatile int64_t sink = 0;
+
+void Work() {
+  for (int i = 0; i < 100000; ++i) {
+    sink = sink + i;
+  }
+}
+
+TEST(PerfEventProfilerTest, RecordsOperatorEvents) {
+  PerfEventProfiler profiler;
+  if (!profiler.IsSupported()) {
+    GTEST_SKIP() << "perf_event counters aren't available.";
+  }
+  profiler.StartProfiling();
+  for (int run = 0; run < 2; ++run) {
+    for (int node = 0; node < 3; ++node) {
+      const uint32_t handle = profiler.BeginEvent(
+          "ADD", EventType::OPERATOR_INVOKE_EVENT, node, /*subgraph=*/0);
+      EXPECT_NE(handle, 0);
+      Work();
+      profiler.EndEvent(handle);
+    }
+  }
+  profiler.StopProfiling();
+
+  std::vector<OpHardwareCounters> op_counters =
+      profiler.GetOpHardwareCounters();
+  ASSERT_EQ(op_counters.size(), 3);
+  for (int node = 0; node < 3; ++node) {
+    const OpHardwareCounters& op = op_counters[node];
+    EXPECT_EQ(op.tag, "ADD");
+    EXPECT_EQ(op.subgraph_index, 0);
+    EXPECT_EQ(op.node_index, node);
+    EXPECT_EQ(op.num_invocations, 2);
+    EXPECT_GT(op.elapsed_time_ns, 0);
+    EXPECT_GT(op.cycles, 0);
+  }
+}
+
+TEST(PerfEventProfilerTest, RecordsNestedEvents) {
+  PerfEventProfiler profiler;
+  if (!profiler.IsSupported()) {
+    GTEST_SKIP() << "perf_event counters aren't available.";
+  }
+  profiler.StartProfiling();
+  const uint32_t outer = profiler.BeginEvent(
+      "DELEGATE", EventType::OPERATOR_INVOKE_EVENT, 0, 0);
+  const uint32_t inner = profiler.BeginEvent(
+      "CONV_2D", EventType::DELEGATE_OPERATOR_INVOKE_EVENT, 0, 0);
+  Work();
+  profiler.EndEvent(inner);
+  profiler.EndEvent(outer);
+
+  std::vector<OpHardwareCounters> op_counters =
+      profiler.GetOpHardwareCounters();
+  ASSERT_EQ(op_counters.size(), 2);
+  EXPECT_EQ(op_counters[0].tag, "DELEGATE");
+  EXPECT_EQ(op_counters[1].tag, "CONV_2D");
+  EXPECT_GE(op_counters[0].cycles, op_counters[1].cycles);
+}
+
+TEST(PerfEventProfilerTest, IgnoresEventsWhenNotProfiling) {
+  PerfEventProfiler profiler;
+  const uint32_t handle =
+      profiler.BeginEvent("ADD", EventType::OPERATOR_INVOKE_EVENT, 0, 0);
+  EXPECT_EQ(handle, 0);
+  profiler.EndEvent(handle);
+  EXPECT_TRUE(profiler.GetOpHardwareCounters().empty());
+}
+
+TEST(PerfEventProfilerTest, IgnoresNonOperatorEvents) {
+  PerfEventProfiler profiler;
+  profiler.StartProfiling();
+  const uint32_t handle =
+      profiler.BeginEvent("Invoke", EventType::DEFAULT, 0, 0);
+  EXPECT_EQ(handle, 0);
+  profiler.EndEvent(handle);
+  EXPECT_TRUE(profiler.GetOpHardwareCounters().empty());
+}
+
+TEST(PerfEventProfilerTest, Reset) {
+  PerfEventProfiler profiler;
+  if (!profiler.IsSupported()) {
+    GTEST_SKIP() << "perf_event counters aren't available.";
+  }
+  profiler.StartProfiling();
+  profiler.EndEvent(
+      profiler.BeginEvent("ADD", EventType::OPERATOR_INVOKE_EVENT, 0, 0));
+  EXPECT_EQ(profiler.GetOpHardwareCounters().size(), 1);
+  profiler.Reset();
+  EXPECT_TRUE(profiler.GetOpHardwareCounters().empty());
+}
+
+}  // namespace
+}  // namespace profiling
+}  // namespace tflite
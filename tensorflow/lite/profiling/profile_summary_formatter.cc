@@ -15,14 +15,78 @@ limitations under the License.
 
 #include "tensorflow/lite/profiling/profile_summary_formatter.h"
 
+#include <cstdint>
+#include <iomanip>
 #include <map>
 #include <memory>
 #include <sstream>
 #include <string>
+#include <vector>
+
+#include "tensorflow/lite/profiling/perf_event_profiler.h"
 
 namespace tflite {
 namespace profiling {
 
+namespace {
+
+// The hardware counters of an op and the metrics derived from them, as
+// formatted strings, "n/a" if their counters aren't available.
+struct HardwareCountersRow {
+  std::string node;
+  std::string count;
+  std::string avg_us;
+  std::string avg_cycles;
+  std::string avg_instructions;
+  std::string ipc;
+  std::string avg_llc_misses;
+  std::string mpki;
+  std::string bandwidth_gbps;
+};
+
+// Each last level cache miss is assumed to read a cache line of this many bytes
+// from memory.
+constexpr int64_t kCacheLineSize = 64;
+
+std::string FormatDouble(double value, int precision) {
+  std::stringstream stream;
+  stream << std::fixed << std::setprecision(precision) << value;
+  return stream.str();
+}
+
+HardwareCountersRow GetHardwareCountersRow(const OpHardwareCounters& op) {
+  const double count = op.num_invocations > 0 ? op.num_invocations : 1;
+  const auto average = [count](int64_t total) {
+    return total < 0 ? std::string("n/a") : FormatDouble(total / count, 0);
+  };
+  HardwareCountersRow row;
+  row.node = "[" + op.tag + "]:" + std::to_string(op.node_index);
+  if (op.subgraph_index != 0) {
+    row.node = std::to_string(op.subgraph_index) + "/" + row.node;
+  }
+  row.count = std::to_string(op.num_invocations);
+  row.avg_us = FormatDouble(op.elapsed_time_ns / count / 1e3, 3);
+  row.avg_cycles = average(op.cycles);
+  row.avg_instructions = average(op.instructions);
+  row.ipc = op.cycles > 0 && op.instructions >= 0
+                ? FormatDouble(static_cast<double>(op.instructions) / op.cycles,
+                               2)
+                : "n/a";
+  row.avg_llc_misses = average(op.llc_misses);
+  row.mpki = op.instructions > 0 && op.llc_misses >= 0
+                 ? FormatDouble(1e3 * op.llc_misses / op.instructions, 2)
+                 : "n/a";
+  row.bandwidth_gbps =
+      op.elapsed_time_ns > 0 && op.llc_misses >= 0
+          ? FormatDouble(static_cast<double>(op.llc_misses * kCacheLineSize) /
+                             op.elapsed_time_ns,
+                         3)
+          : "n/a";
+  return row;
+}
+
+}  // namespace
+
 std::string ProfileSummaryDefaultFormatter::GetOutputString(
     const std::map<uint32_t, std::unique_ptr<tensorflow::StatsCalculator>>&
         stats_calculator_map,
@@ -88,6 +152,47 @@ ProfileSummaryDefaultFormatter::GetStatSummarizerOptions() const {
   return options;
 }
 
+std::string ProfileSummaryDefaultFormatter::GetHardwareCountersString(
+    const std::vector<OpHardwareCounters>& op_counters) const {
+  if (op_counters.empty()) return "";
+  std::stringstream stream;
+  stream << "============================== Hardware counters by node "
+            "==============================\n";
+  const auto write_row = [&stream](const HardwareCountersRow& row) {
+    stream << "\t" << std::setw(24) << std::left << row.node << std::right
+           << std::setw(8) << row.count << std::setw(12) << row.avg_us
+           << std::setw(14) << row.avg_cycles << std::setw(14)
+           << row.avg_instructions << std::setw(8) << row.ipc << std::setw(12)
+           << row.avg_llc_misses << std::setw(10) << row.mpki << std::setw(14)
+           << row.bandwidth_gbps << "\n";
+  };
+  write_row({"[node type]:index", "count", "avg us", "avg cycles",
+             "avg instrs", "IPC", "avg LLC miss", "MPKI", "est. GB/s"});
+  for (const OpHardwareCounters& op : op_counters) {
+    write_row(GetHardwareCountersRow(op));
+  }
+  stream << "IPC is instructions per cycle, MPKI last level cache misses per "
+            "thousand instructions and est. GB/s the memory read bandwidth "
+            "assuming " << kCacheLineSize << " bytes per miss.\n";
+  return stream.str();
+}
+
+std::string ProfileSummaryCSVFormatter::GetHardwareCountersString(
+    const std::vector<OpHardwareCounters>& op_counters) const {
+  if (op_counters.empty()) return "";
+  std::stringstream stream;
+  stream << "node,count,avg_us,avg_cycles,avg_instructions,ipc,"
+            "avg_llc_misses,mpki,est_gbps\n";
+  for (const OpHardwareCounters& op : op_counters) {
+    const HardwareCountersRow row = GetHardwareCountersRow(op);
+    stream << "\"" << row.node << "\"," << row.count << "," << row.avg_us
+           << "," << row.avg_cycles << "," << row.avg_instructions << ","
+           << row.ipc << "," << row.avg_llc_misses << "," << row.mpki << ","
+           << row.bandwidth_gbps << "\n";
+  }
+  return stream.str();
+}
+
 tensorflow::StatSummarizerOptions
 ProfileSummaryCSVFormatter::GetStatSummarizerOptions() const {
   auto options = ProfileSummaryDefaultFormatter::GetStatSummarizerOptions();
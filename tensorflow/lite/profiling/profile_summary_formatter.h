@@ -24,6 +24,7 @@ limitations under the License.
 #include <vector>
 
 #include "tensorflow/core/util/stats_calculator.h"
+#include "tensorflow/lite/profiling/perf_event_profiler.h"
 
 namespace tflite {
 namespace profiling {
@@ -47,6 +48,12 @@ class ProfileSummaryFormatter {
       const tensorflow::StatsCalculator& delegate_stats_calculator) const = 0;
   virtual tensorflow::StatSummarizerOptions GetStatSummarizerOptions()
       const = 0;
+  // Returns a string detailing the hardware counters of each operator recorded
+  // by a PerfEventProfiler.
+  virtual std::string GetHardwareCountersString(
+      const std::vector<OpHardwareCounters>& op_counters) const {
+    return "";
+  }
 };
 
 class ProfileSummaryDefaultFormatter : public ProfileSummaryFormatter {
@@ -64,6 +71,8 @@ class ProfileSummaryDefaultFormatter : public ProfileSummaryFormatter {
       const tensorflow::StatsCalculator& delegate_stats_calculator)
       const override;
   tensorflow::StatSummarizerOptions GetStatSummarizerOptions() const override;
+  std::string GetHardwareCountersString(
+      const std::vector<OpHardwareCounters>& op_counters) const override;
 
  private:
   std::string GenerateReport(
@@ -77,6 +86,8 @@ class ProfileSummaryCSVFormatter : public ProfileSummaryDefaultFormatter {
  public:
   ProfileSummaryCSVFormatter() {}
   tensorflow::StatSummarizerOptions GetStatSummarizerOptions() const override;
+  std::string GetHardwareCountersString(
+      const std::vector<OpHardwareCounters>& op_counters) const override;
 };
 
 }  // namespace profiling
@@ -154,6 +154,47 @@ TEST(SummaryWriterTest, DelegationShortSummary) {
   ASSERT_TRUE(absl::StrContains(output, "Delegate internal"));
 }
 
+TEST(SummaryWriterTest, EmptyHardwareCountersString) {
+  ProfileSummaryDefaultFormatter writer;
+  EXPECT_EQ(writer.GetHardwareCountersString({}).size(), 0);
+}
+
+TEST(SummaryWriterTest, HardwareCountersString) {
+  ProfileSummaryDefaultFormatter writer;
+  OpHardwareCounters op;
+  op.tag = "CONV_2D";
+  op.node_index = 3;
+  op.num_invocations = 2;
+  op.elapsed_time_ns = 4000;
+  op.cycles = 8000;
+  op.instructions = 16000;
+  op.llc_misses = 32;
+  std::string output = writer.GetHardwareCountersString({op});
+  ASSERT_TRUE(absl::StrContains(output, "Hardware counters by node"));
+  ASSERT_TRUE(absl::StrContains(output, "[CONV_2D]:3"));
+  // 2 instructions per cycle, 2 misses per thousand instructions and 32 misses
+  // of 64 bytes in 4000 ns.
+  ASSERT_TRUE(absl::StrContains(output, "2.00"));
+  ASSERT_TRUE(absl::StrContains(output, "0.512"));
+  ASSERT_TRUE(!absl::StrContains(output, "n/a"));
+}
+
+TEST(SummaryWriterTest, HardwareCountersStringWithoutCacheMisses) {
+  ProfileSummaryCSVFormatter writer;
+  OpHardwareCounters op;
+  op.tag = "ADD";
+  op.subgraph_index = 1;
+  op.node_index = 0;
+  op.num_invocations = 1;
+  op.elapsed_time_ns = 1000;
+  op.cycles = 100;
+  op.instructions = 50;
+  std::string output = writer.GetHardwareCountersString({op});
+  ASSERT_TRUE(absl::StrContains(output, "node,count,avg_us"));
+  ASSERT_TRUE(absl::StrContains(
+      output, "\"1/[ADD]:0\",1,1.000,100,50,0.50,n/a,n/a,n/a"));
+}
+
 }  // namespace
 }  // namespace profiling
 }  // namespace tflite
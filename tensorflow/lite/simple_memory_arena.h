@@ -142,6 +142,10 @@ class SimpleMemoryArena {
                         int32_t tensor, int32_t first_node, int32_t last_node,
                         ArenaAllocWithUsageInterval* new_alloc);
 
+  // Adds allocs returned by earlier calls to Allocate() for the same active
+  // allocs, in the order of these calls, without searching for gaps again.
+  void AddAllocs(const std::vector<ArenaAllocWithUsageInterval>& allocs);
+
   TfLiteStatus Commit(bool* arena_reallocated);
 
   TfLiteStatus ResolveAlloc(TfLiteContext* context,
@@ -358,7 +358,10 @@ TfLiteStatus BenchmarkModel::Run() {
   listeners_.OnBenchmarkEnd({model_size_mb, startup_latency_us, input_bytes,
                              warmup_time_us, inference_time_us, init_mem_usage,
                              overall_mem_usage, peak_mem_mb});
-  return status;
+  if (status != kTfLiteOk) {
+    return status;
+  }
+  return RunThroughputBenchmarks();
 }
 
 TfLiteStatus BenchmarkModel::ParseFlags(int* argc, char** argv) {
@@ -226,6 +226,10 @@ class BenchmarkModel {
   virtual TfLiteStatus ResetInputsAndOutputs();
   virtual TfLiteStatus RunImpl() = 0;
 
+  // Runs the benchmarks of the throughput of concurrent inferences, if any,
+  // after the latency benchmark.
+  virtual TfLiteStatus RunThroughputBenchmarks() { return kTfLiteOk; }
+
   // Create a MemoryUsageMonitor to report peak memory footprint if specified.
   virtual std::unique_ptr<profiling::memory::MemoryUsageMonitor>
   MayCreateMemoryUsageMonitor() const;
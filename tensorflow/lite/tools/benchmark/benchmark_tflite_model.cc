@@ -15,6 +15,10 @@ limitations under the License.
 
 #include "tensorflow/lite/tools/benchmark/benchmark_tflite_model.h"
 
+#include <algorithm>
+#include <atomic>
+#include <cmath>
+#include <condition_variable>  // NOLINT(build/c++11)
 #include <cstdarg>
 #include <cstdint>
 #include <cstdlib>
@@ -22,9 +26,11 @@ limitations under the License.
 #include <functional>
 #include <iostream>
 #include <memory>
+#include <mutex>  // NOLINT(build/c++11)
 #include <random>
 #include <sstream>
 #include <string>
+#include <thread>  // NOLINT(build/c++11)
 #include <unordered_set>
 #include <utility>
 #include <vector>
@@ -43,9 +49,11 @@ limitations under the License.
 #include "tensorflow/lite/core/subgraph.h"
 #include "tensorflow/lite/interpreter.h"
 #include "tensorflow/lite/kernels/cpu_backend_context.h"
+#include "tensorflow/lite/kernels/cpu_backend_shared_threadpool.h"
 #include "tensorflow/lite/op_resolver.h"
 #include "tensorflow/lite/optional_debug_tools.h"
 #include "tensorflow/lite/profiling/profile_summary_formatter.h"
+#include "tensorflow/lite/profiling/time.h"
 #include "tensorflow/lite/string_util.h"
 #include "tensorflow/lite/tools/benchmark/benchmark_utils.h"
 #include "tensorflow/lite/tools/benchmark/profiling_listener.h"
@@ -363,6 +371,8 @@ BenchmarkParams BenchmarkTfLiteModel::DefaultParams() {
   default_params.AddParam(
       "enable_op_profiling",
       BenchmarkParam::Create<bool>(kOpProfilingEnabledDefault));
+  default_params.AddParam("enable_op_hardware_counters",
+                          BenchmarkParam::Create<bool>(false));
   default_params.AddParam("max_profiling_buffer_entries",
                           BenchmarkParam::Create<int32_t>(1024));
   default_params.AddParam("allow_dynamic_profiling_buffer_increase",
@@ -378,6 +388,8 @@ BenchmarkParams BenchmarkTfLiteModel::DefaultParams() {
                           BenchmarkParam::Create<bool>(false));
   default_params.AddParam("optimize_memory_for_large_tensors",
                           BenchmarkParam::Create<int32_t>(0));
+  default_params.AddParam("release_delegated_weights",
+                          BenchmarkParam::Create<bool>(false));
   default_params.AddParam("disable_delegate_clustering",
                           BenchmarkParam::Create<bool>(false));
   default_params.AddParam("enable_builtin_cast_constant_cache",
@@ -391,6 +403,18 @@ BenchmarkParams BenchmarkTfLiteModel::DefaultParams() {
                           BenchmarkParam::Create<int32_t>(15));
   default_params.AddParam("alloc_type_display_length",
                           BenchmarkParam::Create<int32_t>(18));
+  default_params.AddParam("use_shared_cpu_backend_thread_pool",
+                          BenchmarkParam::Create<bool>(false));
+  default_params.AddParam("throughput_num_interpreters",
+                          BenchmarkParam::Create<std::string>(""));
+  default_params.AddParam("throughput_num_client_threads",
+                          BenchmarkParam::Create<std::string>(""));
+  default_params.AddParam("throughput_arrival",
+                          BenchmarkParam::Create<std::string>("closed"));
+  default_params.AddParam("throughput_qps",
+                          BenchmarkParam::Create<float>(0.0f));
+  default_params.AddParam("throughput_secs",
+                          BenchmarkParam::Create<float>(5.0f));
 
   tools::ProvidedDelegateList delegate_providers(&default_params);
   delegate_providers.AddAllDelegateParams();
@@ -445,6 +469,9 @@ std::vector<Flag> BenchmarkTfLiteModel::GetFlags() {
       CreateFlag<bool>("require_full_delegation", &params_,
                        "require delegate to run the entire graph"),
       CreateFlag<bool>("enable_op_profiling", &params_, "enable op profiling"),
+      CreateFlag<bool>("enable_op_hardware_counters", &params_,
+                       "record the cycles, instructions and last level cache "
+                       "misses of each op with Linux perf_event counters"),
       CreateFlag<int32_t>("max_profiling_buffer_entries", &params_,
                           "max initial profiling buffer entries"),
       CreateFlag<bool>("allow_dynamic_profiling_buffer_increase", &params_,
@@ -468,6 +495,9 @@ std::vector<Flag> BenchmarkTfLiteModel::GetFlags() {
       CreateFlag<int32_t>(
           "optimize_memory_for_large_tensors", &params_,
           "Optimize memory usage for large tensors with sacrificing latency."),
+      CreateFlag<bool>("release_delegated_weights", &params_,
+                       "Release the memory of the weights only read by "
+                       "delegates after applying them."),
       CreateFlag<bool>("disable_delegate_clustering", &params_,
                        "Disable delegate clustering."),
       CreateFlag<bool>(
@@ -488,7 +518,38 @@ std::vector<Flag> BenchmarkTfLiteModel::GetFlags() {
       CreateFlag<int32_t>(
           "alloc_type_display_length", &params_,
           "The number of characters to show for the tensor's allocation type "
-          "when printing the interpeter's state, defaults to 18.")};
+          "when printing the interpeter's state, defaults to 18."),
+      CreateFlag<bool>(
+          "use_shared_cpu_backend_thread_pool", &params_,
+          "Run the parallel work of the builtin kernels of every interpreter "
+          "on worker threads shared by the whole process, instead of on "
+          "thread pools of each interpreter."),
+      CreateFlag<std::string>(
+          "throughput_num_interpreters", &params_,
+          "If set, after the latency benchmark, benchmark the throughput of "
+          "this number of interpreters of the model, sharing its weights, "
+          "invoked concurrently. A comma-separated list benchmarks each "
+          "number in turn, e.g. 1,2,4."),
+      CreateFlag<std::string>(
+          "throughput_num_client_threads", &params_,
+          "Comma-separated numbers of threads issuing the inferences of the "
+          "throughput benchmarks, each benchmarked with every number of "
+          "interpreters. Each inference waits for an idle interpreter. "
+          "Defaults to the number of interpreters."),
+      CreateFlag<std::string>(
+          "throughput_arrival", &params_,
+          "How the inferences of the throughput benchmarks arrive: 'closed' "
+          "for each thread to issue an inference as soon as its previous one "
+          "completes, 'fixed' or 'poisson' for inferences to arrive at "
+          "--throughput_qps overall, at a fixed interval or as a Poisson "
+          "process. The latency of the latter includes the time waiting for "
+          "a thread and an interpreter."),
+      CreateFlag<float>("throughput_qps", &params_,
+                        "The rate of arrival of the inferences per second of "
+                        "the 'fixed' and 'poisson' throughput benchmarks."),
+      CreateFlag<float>("throughput_secs", &params_,
+                        "The duration in seconds of each throughput "
+                        "benchmark.")};
 
   flags.insert(flags.end(), specific_flags.begin(), specific_flags.end());
 
@@ -516,6 +577,8 @@ void BenchmarkTfLiteModel::LogParams() {
                       "Require full delegation", verbose);
   LOG_BENCHMARK_PARAM(bool, "enable_op_profiling", "Enable op profiling",
                       verbose);
+  LOG_BENCHMARK_PARAM(bool, "enable_op_hardware_counters",
+                      "Enable op hardware counters", verbose);
   LOG_BENCHMARK_PARAM(int32_t, "max_profiling_buffer_entries",
                       "Max initial profiling buffer entries", verbose);
   LOG_BENCHMARK_PARAM(bool, "allow_dynamic_profiling_buffer_increase",
@@ -531,6 +594,8 @@ void BenchmarkTfLiteModel::LogParams() {
                       "Release dynamic tensor memory", verbose);
   LOG_BENCHMARK_PARAM(int32_t, "optimize_memory_for_large_tensors",
                       "Optimize memory usage for large tensors", verbose);
+  LOG_BENCHMARK_PARAM(bool, "release_delegated_weights",
+                      "Release delegated weights", verbose);
   LOG_BENCHMARK_PARAM(bool, "disable_delegate_clustering",
                       "Disable delegate clustering", verbose);
   LOG_BENCHMARK_PARAM(bool, "enable_builtin_cast_constant_cache",
@@ -543,6 +608,18 @@ void BenchmarkTfLiteModel::LogParams() {
                       "Tensor type display length", verbose);
   LOG_BENCHMARK_PARAM(int32_t, "alloc_type_display_length",
                       "Tensor allocation type display length", verbose);
+  LOG_BENCHMARK_PARAM(bool, "use_shared_cpu_backend_thread_pool",
+                      "Use shared CPU backend thread pool", verbose);
+  LOG_BENCHMARK_PARAM(std::string, "throughput_num_interpreters",
+                      "Throughput num interpreters", verbose);
+  LOG_BENCHMARK_PARAM(std::string, "throughput_num_client_threads",
+                      "Throughput num client threads", verbose);
+  LOG_BENCHMARK_PARAM(std::string, "throughput_arrival", "Throughput arrival",
+                      verbose);
+  LOG_BENCHMARK_PARAM(float, "throughput_qps", "Throughput arrival rate (QPS)",
+                      verbose);
+  LOG_BENCHMARK_PARAM(float, "throughput_secs",
+                      "Throughput duration (seconds)", verbose);
 
   for (const auto& delegate_provider :
        tools::GetRegisteredDelegateProviders()) {
@@ -559,6 +636,38 @@ TfLiteStatus BenchmarkTfLiteModel::ValidateParams() {
     return kTfLiteError;
   }
 
+  throughput_num_interpreters_.clear();
+  throughput_num_client_threads_.clear();
+  if (!util::SplitAndParse(
+          params_.Get<std::string>("throughput_num_interpreters"), ',',
+          &throughput_num_interpreters_) ||
+      !util::SplitAndParse(
+          params_.Get<std::string>("throughput_num_client_threads"), ',',
+          &throughput_num_client_threads_) ||
+      std::any_of(throughput_num_interpreters_.begin(),
+                  throughput_num_interpreters_.end(),
+                  [](int n) { return n <= 0; }) ||
+      std::any_of(throughput_num_client_threads_.begin(),
+                  throughput_num_client_threads_.end(),
+                  [](int n) { return n <= 0; })) {
+    TFLITE_LOG(ERROR) << "--throughput_num_interpreters and "
+                         "--throughput_num_client_threads must be "
+                         "comma-separated positive numbers.";
+    return kTfLiteError;
+  }
+  const std::string arrival = params_.Get<std::string>("throughput_arrival");
+  if (arrival != "closed" && arrival != "fixed" && arrival != "poisson") {
+    TFLITE_LOG(ERROR) << "Unknown --throughput_arrival: " << arrival;
+    return kTfLiteError;
+  }
+  if (!throughput_num_interpreters_.empty() && arrival != "closed" &&
+      params_.Get<float>("throughput_qps") <= 0.0f) {
+    TFLITE_LOG(ERROR) << "--throughput_qps must be positive with "
+                         "--throughput_arrival="
+                      << arrival;
+    return kTfLiteError;
+  }
+
   return PopulateInputLayerInfo(
       params_.Get<std::string>("input_layer"),
       params_.Get<std::string>("input_layer_shape"),
@@ -695,11 +804,16 @@ TfLiteStatus BenchmarkTfLiteModel::PrepareInputData() {
 }
 
 TfLiteStatus BenchmarkTfLiteModel::ResetInputsAndOutputs() {
-  auto interpreter_inputs = interpreter_->inputs();
+  SetInputs(interpreter_.get());
+  return kTfLiteOk;
+}
+
+void BenchmarkTfLiteModel::SetInputs(tflite::Interpreter* interpreter) {
+  auto interpreter_inputs = interpreter->inputs();
   // Set the values of the input tensors from inputs_data_.
   for (int j = 0; j < interpreter_inputs.size(); ++j) {
     int i = interpreter_inputs[j];
-    TfLiteTensor* t = interpreter_->tensor(i);
+    TfLiteTensor* t = interpreter->tensor(i);
     if (t->type == kTfLiteString) {
       if (inputs_data_[j].data) {
         static_cast<DynamicBuffer*>(inputs_data_[j].data.get())
@@ -717,11 +831,15 @@ TfLiteStatus BenchmarkTfLiteModel::ResetInputsAndOutputs() {
                   inputs_data_[j].bytes);
     }
   }
-
-  return kTfLiteOk;
 }
 
 TfLiteStatus BenchmarkTfLiteModel::InitInterpreter() {
+  return BuildInterpreter(&interpreter_, &external_context_);
+}
+
+TfLiteStatus BenchmarkTfLiteModel::BuildInterpreter(
+    std::unique_ptr<tflite::Interpreter>* interpreter,
+    std::unique_ptr<tflite::ExternalCpuBackendContext>* external_context) {
   auto resolver = GetOpResolver();
   const int32_t num_threads = params_.Get<int32_t>("num_threads");
   const bool use_caching = params_.Get<bool>("use_caching");
@@ -731,6 +849,8 @@ TfLiteStatus BenchmarkTfLiteModel::InitInterpreter() {
       params_.Get<bool>("release_dynamic_tensors"));
   options.OptimizeMemoryForLargeTensors(
       params_.Get<int32_t>("optimize_memory_for_large_tensors"));
+  options.SetReleaseDelegatedWeights(
+      params_.Get<bool>("release_delegated_weights"));
   options.SetDisableDelegateClustering(
       params_.Get<bool>("disable_delegate_clustering"));
   options.SetCacheConstantCastOp(
@@ -742,22 +862,29 @@ TfLiteStatus BenchmarkTfLiteModel::InitInterpreter() {
     return kTfLiteError;
   }
 
-  builder(&interpreter_);
-  if (!interpreter_) {
+  builder(interpreter);
+  if (!*interpreter) {
     TFLITE_LOG(ERROR) << "Failed to initialize the interpreter";
     return kTfLiteError;
   }
-  // Manually enable caching behavior in TF Lite interpreter.
-  if (use_caching) {
-    external_context_ = std::make_unique<tflite::ExternalCpuBackendContext>();
+  // Manually enable caching behavior or the shared thread pool in TF Lite
+  // interpreter.
+  const bool use_shared_thread_pool =
+      params_.Get<bool>("use_shared_cpu_backend_thread_pool");
+  if (use_caching || use_shared_thread_pool) {
+    *external_context = std::make_unique<tflite::ExternalCpuBackendContext>();
     std::unique_ptr<tflite::CpuBackendContext> cpu_backend_context(
         new tflite::CpuBackendContext());
-    cpu_backend_context->SetUseCaching(true);
+    if (use_shared_thread_pool) {
+      cpu_backend_context->SetSharedThreadPool(
+          tflite::CpuBackendSharedThreadPool::Global());
+    }
+    cpu_backend_context->SetUseCaching(use_caching);
     cpu_backend_context->SetMaxNumThreads(num_threads);
-    external_context_->set_internal_backend_context(
-        std::move(cpu_backend_context));
-    interpreter_->SetExternalContext(kTfLiteCpuBackendContext,
-                                     external_context_.get());
+    (*external_context)
+        ->set_internal_backend_context(std::move(cpu_backend_context));
+    (*interpreter)
+        ->SetExternalContext(kTfLiteCpuBackendContext, external_context->get());
   }
 
   return kTfLiteOk;
@@ -784,6 +911,7 @@ TfLiteStatus BenchmarkTfLiteModel::Init() {
   }
 
   AddOwnedListener(MayCreateProfilingListener());
+  AddOwnedListener(MayCreateHardwareCountersListener());
   AddOwnedListener(std::unique_ptr<BenchmarkListener>(
       new InterpreterStatePrinter(interpreter_.get())));
 
@@ -969,7 +1097,178 @@ BenchmarkTfLiteModel::MayCreateProfilingListener() const {
           !params_.Get<std::string>("profiling_output_csv_file").empty())));
 }
 
+std::unique_ptr<BenchmarkListener>
+BenchmarkTfLiteModel::MayCreateHardwareCountersListener() const {
+  if (!params_.Get<bool>("enable_op_hardware_counters")) return nullptr;
+
+  return std::unique_ptr<BenchmarkListener>(new HardwareCountersListener(
+      interpreter_.get(), params_.Get<std::string>("profiling_output_csv_file"),
+      CreateProfileSummaryFormatter(
+          !params_.Get<std::string>("profiling_output_csv_file").empty())));
+}
+
 TfLiteStatus BenchmarkTfLiteModel::RunImpl() { return interpreter_->Invoke(); }
 
+TfLiteStatus BenchmarkTfLiteModel::CreateThroughputInterpreter(
+    ThroughputInterpreter* t) {
+  TF_LITE_ENSURE_STATUS(
+      BuildInterpreter(&t->interpreter, &t->external_context));
+  Interpreter* interpreter = t->interpreter.get();
+  interpreter->SetAllowFp16PrecisionForFp32(params_.Get<bool>("allow_fp16"));
+  // Init() checked that the inputs match.
+  for (int j = 0; j < inputs_.size(); ++j) {
+    const int i = interpreter->inputs()[j];
+    if (interpreter->tensor(i)->type != kTfLiteString) {
+      interpreter->ResizeInputTensor(i, inputs_[j].shape);
+    }
+  }
+  tools::ProvidedDelegateList delegate_providers(&params_);
+  for (auto& created_delegate : delegate_providers.CreateAllRankedDelegates()) {
+    t->delegates.emplace_back(std::move(created_delegate.delegate));
+    if (interpreter->ModifyGraphWithDelegate(t->delegates.back().get()) !=
+        kTfLiteOk) {
+      TFLITE_LOG(ERROR) << "Failed to apply "
+                        << created_delegate.provider->GetName()
+                        << " delegate.";
+      return kTfLiteError;
+    }
+  }
+  if (interpreter->AllocateTensors() != kTfLiteOk) {
+    TFLITE_LOG(ERROR) << "Failed to allocate tensors!";
+    return kTfLiteError;
+  }
+  SetInputs(interpreter);
+  // Warm up the interpreter before it is benchmarked.
+  return interpreter->Invoke();
+}
+
+TfLiteStatus BenchmarkTfLiteModel::RunThroughputBenchmarks() {
+  if (throughput_num_interpreters_.empty() || params_.Get<bool>("dry_run")) {
+    return kTfLiteOk;
+  }
+  // The interpreter of the latency benchmark is benchmarked too.
+  const int max_num_interpreters =
+      *std::max_element(throughput_num_interpreters_.begin(),
+                        throughput_num_interpreters_.end());
+  std::vector<ThroughputInterpreter> other_interpreters(max_num_interpreters -
+                                                        1);
+  std::vector<Interpreter*> interpreters = {interpreter_.get()};
+  for (ThroughputInterpreter& t : other_interpreters) {
+    TF_LITE_ENSURE_STATUS(CreateThroughputInterpreter(&t));
+    interpreters.push_back(t.interpreter.get());
+  }
+  TfLiteStatus status = kTfLiteOk;
+  for (const int num_interpreters : throughput_num_interpreters_) {
+    std::vector<int> num_client_threads = throughput_num_client_threads_;
+    if (num_client_threads.empty()) {
+      num_client_threads.push_back(num_interpreters);
+    }
+    for (const int num_threads : num_client_threads) {
+      if (RunThroughputBenchmark(interpreters, num_interpreters,
+                                 num_threads) != kTfLiteOk) {
+        status = kTfLiteError;
+      }
+    }
+  }
+  return status;
+}
+
+TfLiteStatus BenchmarkTfLiteModel::RunThroughputBenchmark(
+    const std::vector<Interpreter*>& interpreters,
+    int num_interpreters, int num_client_threads) {
+  const std::string arrival = params_.Get<std::string>("throughput_arrival");
+  const float qps = params_.Get<float>("throughput_qps");
+  const float secs = params_.Get<float>("throughput_secs");
+  const bool closed_loop = arrival == "closed";
+  std::vector<int64_t> arrival_times_us;
+  if (!closed_loop) {
+    arrival_times_us = util::CreateArrivalTimesUs(
+        qps, static_cast<int>(std::ceil(qps * secs)), arrival == "poisson",
+        random_engine_());
+  }
+
+  std::mutex mutex;
+  std::condition_variable interpreter_released;
+  std::vector<Interpreter*> idle_interpreters(
+      interpreters.begin(), interpreters.begin() + num_interpreters);
+  std::atomic<int> next_request(0);
+  std::atomic<bool> failed(false);
+  std::vector<std::vector<int64_t>> latencies_us(num_client_threads);
+  const int64_t start_us = profiling::time::NowMicros();
+  const int64_t end_us = start_us + static_cast<int64_t>(secs * 1e6);
+  std::vector<std::thread> clients;
+  for (int c = 0; c < num_client_threads; ++c) {
+    clients.emplace_back([&, c] {
+      while (true) {
+        int64_t arrival_us;
+        if (closed_loop) {
+          arrival_us = profiling::time::NowMicros();
+          if (arrival_us >= end_us) break;
+        } else {
+          const int request = next_request++;
+          if (request >= arrival_times_us.size()) break;
+          arrival_us = start_us + arrival_times_us[request];
+          util::SleepForSeconds((arrival_us - profiling::time::NowMicros()) *
+                                1e-6);
+        }
+        Interpreter* interpreter;
+        {
+          std::unique_lock<std::mutex> lock(mutex);
+          interpreter_released.wait(
+              lock, [&] { return !idle_interpreters.empty(); });
+          interpreter = idle_interpreters.back();
+          idle_interpreters.pop_back();
+        }
+        if (interpreter->Invoke() != kTfLiteOk) {
+          failed = true;
+        }
+        {
+          std::lock_guard<std::mutex> lock(mutex);
+          idle_interpreters.push_back(interpreter);
+        }
+        interpreter_released.notify_one();
+        latencies_us[c].push_back(profiling::time::NowMicros() - arrival_us);
+      }
+    });
+  }
+  for (std::thread& client : clients) {
+    client.join();
+  }
+  const int64_t elapsed_us = profiling::time::NowMicros() - start_us;
+
+  if (failed) {
+    TFLITE_LOG(ERROR) << "Failed to invoke an interpreter of the throughput "
+                         "benchmark.";
+    return kTfLiteError;
+  }
+  std::vector<int64_t> all_latencies_us;
+  for (const std::vector<int64_t>& client_latencies_us : latencies_us) {
+    all_latencies_us.insert(all_latencies_us.end(),
+                            client_latencies_us.begin(),
+                            client_latencies_us.end());
+  }
+  if (all_latencies_us.empty()) {
+    TFLITE_LOG(WARN) << "No inference completed in the throughput benchmark.";
+    return kTfLiteOk;
+  }
+  std::sort(all_latencies_us.begin(), all_latencies_us.end());
+  int64_t total_latency_us = 0;
+  for (const int64_t latency_us : all_latencies_us) {
+    total_latency_us += latency_us;
+  }
+  TFLITE_LOG(INFO) << "Throughput of " << num_interpreters
+                   << " interpreters invoked from " << num_client_threads
+                   << " threads with " << arrival << " arrivals: "
+                   << all_latencies_us.size() * 1e6 / elapsed_us
+                   << " inferences/s over " << all_latencies_us.size()
+                   << " inferences. Latency (us): avg="
+                   << total_latency_us / all_latencies_us.size()
+                   << " p50=" << util::GetPercentile(all_latencies_us, 50)
+                   << " p90=" << util::GetPercentile(all_latencies_us, 90)
+                   << " p99=" << util::GetPercentile(all_latencies_us, 99)
+                   << " max=" << all_latencies_us.back();
+  return kTfLiteOk;
+}
+
 }  // namespace benchmark
 }  // namespace tflite
@@ -88,6 +88,7 @@ class BenchmarkTfLiteModel : public BenchmarkModel {
  protected:
   TfLiteStatus PrepareInputData() override;
   TfLiteStatus ResetInputsAndOutputs() override;
+  TfLiteStatus RunThroughputBenchmarks() override;
 
   int64_t MayGetModelFileSize() override;
 
@@ -102,6 +103,10 @@ class BenchmarkTfLiteModel : public BenchmarkModel {
   // Create a BenchmarkListener that's specifically for TFLite profiling if
   // necessary.
   virtual std::unique_ptr<BenchmarkListener> MayCreateProfilingListener() const;
+  // Create a BenchmarkListener recording the hardware counters of each op if
+  // necessary.
+  virtual std::unique_ptr<BenchmarkListener>
+  MayCreateHardwareCountersListener() const;
 
   void CleanUp();
 
@@ -115,9 +120,37 @@ class BenchmarkTfLiteModel : public BenchmarkModel {
   std::unique_ptr<tflite::ExternalCpuBackendContext> external_context_;
 
  private:
+  // An interpreter of the throughput benchmarks, declared after what it
+  // depends on so that it is destroyed first.
+  struct ThroughputInterpreter {
+    std::vector<Interpreter::TfLiteDelegatePtr> delegates;
+    std::unique_ptr<tflite::ExternalCpuBackendContext> external_context;
+    std::unique_ptr<tflite::Interpreter> interpreter;
+  };
+
   utils::InputTensorData CreateRandomTensorData(
       const TfLiteTensor& t, const InputLayerInfo* layer_info);
 
+  // Builds an interpreter of `model_` with the options of the params, and the
+  // cpu backend context they require, if any.
+  TfLiteStatus BuildInterpreter(
+      std::unique_ptr<tflite::Interpreter>* interpreter,
+      std::unique_ptr<tflite::ExternalCpuBackendContext>* external_context);
+
+  // Sets the input tensors of `interpreter` from `inputs_data_`.
+  void SetInputs(tflite::Interpreter* interpreter);
+
+  // Creates another interpreter of the model, with the delegates and inputs
+  // of `interpreter_`, sharing the model and so its weights.
+  TfLiteStatus CreateThroughputInterpreter(ThroughputInterpreter* t);
+
+  // Drives the first `num_interpreters` of `interpreters` from
+  // `num_client_threads` threads for --throughput_secs, and logs the overall
+  // throughput and the latency percentiles.
+  TfLiteStatus RunThroughputBenchmark(
+      const std::vector<tflite::Interpreter*>& interpreters,
+      int num_interpreters, int num_client_threads);
+
   void AddOwnedListener(std::unique_ptr<BenchmarkListener> listener) {
     if (listener == nullptr) return;
     owned_listeners_.emplace_back(std::move(listener));
@@ -130,6 +163,10 @@ class BenchmarkTfLiteModel : public BenchmarkModel {
   // Always TFLITE_LOG the benchmark result.
   BenchmarkLoggingListener log_output_;
   std::unique_ptr<tools::ModelLoader> model_loader_;
+  // Parsed from --throughput_num_interpreters and
+  // --throughput_num_client_threads.
+  std::vector<int> throughput_num_interpreters_;
+  std::vector<int> throughput_num_client_threads_;
 };
 
 }  // namespace benchmark
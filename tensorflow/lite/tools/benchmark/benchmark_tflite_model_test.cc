@@ -92,6 +92,44 @@ TEST(BenchmarkTfLiteModelTest, ResizeInputWithDelegate) {
   EXPECT_EQ(benchmark.Run(), kTfLiteOk);
 }
 
+TEST(BenchmarkTfLiteModelTest, RunClosedLoopThroughputBenchmarks) {
+  BenchmarkParams params = BenchmarkTfLiteModel::DefaultParams();
+  params.Set<std::string>("graph", kModelPath);
+  params.Set<int>("num_runs", 1);
+  params.Set<int>("warmup_runs", 0);
+  params.Set<bool>("use_shared_cpu_backend_thread_pool", true);
+  params.Set<std::string>("throughput_num_interpreters", "1,2");
+  params.Set<std::string>("throughput_num_client_threads", "1,3");
+  params.Set<float>("throughput_secs", 0.5f);
+  BenchmarkTfLiteModel benchmark = BenchmarkTfLiteModel(std::move(params));
+
+  EXPECT_EQ(benchmark.Run(), kTfLiteOk);
+}
+
+TEST(BenchmarkTfLiteModelTest, RunPoissonThroughputBenchmark) {
+  BenchmarkParams params = BenchmarkTfLiteModel::DefaultParams();
+  params.Set<std::string>("graph", kModelPath);
+  params.Set<int>("num_runs", 1);
+  params.Set<int>("warmup_runs", 0);
+  params.Set<std::string>("throughput_num_interpreters", "2");
+  params.Set<std::string>("throughput_arrival", "poisson");
+  params.Set<float>("throughput_qps", 20.0f);
+  params.Set<float>("throughput_secs", 0.5f);
+  BenchmarkTfLiteModel benchmark = BenchmarkTfLiteModel(std::move(params));
+
+  EXPECT_EQ(benchmark.Run(), kTfLiteOk);
+}
+
+TEST(BenchmarkTfLiteModelTest, OpenLoopThroughputBenchmarkRequiresQps) {
+  BenchmarkParams params = BenchmarkTfLiteModel::DefaultParams();
+  params.Set<std::string>("graph", kModelPath);
+  params.Set<std::string>("throughput_num_interpreters", "2");
+  params.Set<std::string>("throughput_arrival", "fixed");
+  BenchmarkTfLiteModel benchmark = BenchmarkTfLiteModel(std::move(params));
+
+  EXPECT_EQ(benchmark.Run(), kTfLiteError);
+}
+
 }  // namespace
 }  // namespace benchmark
 }  // namespace tflite
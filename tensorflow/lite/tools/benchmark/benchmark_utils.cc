@@ -15,6 +15,12 @@ limitations under the License.
 
 #include "tensorflow/lite/tools/benchmark/benchmark_utils.h"
 
+#include <algorithm>
+#include <cmath>
+#include <cstdint>
+#include <random>
+#include <vector>
+
 #include "tensorflow/lite/profiling/time.h"
 
 namespace tflite {
@@ -32,6 +38,33 @@ void SleepForSeconds(double sleep_seconds) {
       static_cast<uint64_t>(sleep_seconds * 1e6));
 }
 
+std::vector<int64_t> CreateArrivalTimesUs(double requests_per_second, int count,
+                                          bool poisson, uint32_t seed) {
+  std::vector<int64_t> arrival_times_us;
+  if (requests_per_second <= 0.0 || count <= 0) {
+    return arrival_times_us;
+  }
+  arrival_times_us.reserve(count);
+  const double mean_interval_us = 1e6 / requests_per_second;
+  std::mt19937 random_engine(seed);
+  std::exponential_distribution<double> intervals(1.0 / mean_interval_us);
+  // Accumulated as double so that rounding errors don't add up.
+  double arrival_time_us = 0.0;
+  for (int i = 0; i < count; ++i) {
+    arrival_times_us.push_back(static_cast<int64_t>(arrival_time_us));
+    arrival_time_us += poisson ? intervals(random_engine) : mean_interval_us;
+  }
+  return arrival_times_us;
+}
+
+int64_t GetPercentile(const std::vector<int64_t>& sorted_values,
+                      double percentile) {
+  const double rank =
+      std::ceil(percentile / 100.0 * static_cast<double>(sorted_values.size()));
+  const size_t index = static_cast<size_t>(std::max(rank, 1.0)) - 1;
+  return sorted_values[std::min(index, sorted_values.size() - 1)];
+}
+
 }  // namespace util
 }  // namespace benchmark
 }  // namespace tflite
@@ -16,6 +16,7 @@ limitations under the License.
 #ifndef TENSORFLOW_LITE_TOOLS_BENCHMARK_BENCHMARK_UTILS_H_
 #define TENSORFLOW_LITE_TOOLS_BENCHMARK_BENCHMARK_UTILS_H_
 
+#include <cstdint>
 #include <sstream>
 #include <string>
 #include <vector>
@@ -28,6 +29,18 @@ namespace util {
 // simply return if 'sleep_seconds' is negative.
 void SleepForSeconds(double sleep_seconds);
 
+// Returns the times, in microseconds from the start of a benchmark, at which
+// 'count' requests arrive at a rate of 'requests_per_second': at a fixed
+// interval, or at exponentially distributed intervals, i.e. as a Poisson
+// process, if 'poisson' is true. 'seed' seeds the intervals of the latter.
+std::vector<int64_t> CreateArrivalTimesUs(double requests_per_second, int count,
+                                          bool poisson, uint32_t seed);
+
+// Returns the 'percentile'-th percentile, in [0, 100], of the non-empty
+// 'sorted_values', using the nearest-rank method.
+int64_t GetPercentile(const std::vector<int64_t>& sorted_values,
+                      double percentile);
+
 // Split the 'str' according to 'delim', and store each splitted element into
 // 'values'.
 template <typename T>
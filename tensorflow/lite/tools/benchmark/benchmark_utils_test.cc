@@ -14,6 +14,8 @@ limitations under the License.
 ==============================================================================*/
 #include "tensorflow/lite/tools/benchmark/benchmark_utils.h"
 
+#include <algorithm>
+#include <cstdint>
 #include <string>
 #include <vector>
 
@@ -46,6 +48,33 @@ TEST(BenchmarkHelpersTest, SleepForSomeSeconds) {
   EXPECT_GT(end_ts - start_ts, 1900000);
 }
 
+TEST(BenchmarkHelpersTest, CreateFixedArrivalTimes) {
+  EXPECT_THAT(util::CreateArrivalTimesUs(/*requests_per_second=*/4.0,
+                                         /*count=*/4, /*poisson=*/false,
+                                         /*seed=*/0),
+              ::testing::ElementsAre(0, 250000, 500000, 750000));
+}
+
+TEST(BenchmarkHelpersTest, CreatePoissonArrivalTimes) {
+  constexpr int kCount = 10000;
+  const std::vector<int64_t> arrival_times_us = util::CreateArrivalTimesUs(
+      /*requests_per_second=*/1000.0, kCount, /*poisson=*/true, /*seed=*/1);
+  ASSERT_EQ(arrival_times_us.size(), kCount);
+  EXPECT_TRUE(
+      std::is_sorted(arrival_times_us.begin(), arrival_times_us.end()));
+  // The mean interval is 1 ms, so the last request arrives after roughly 10 s.
+  EXPECT_NEAR(arrival_times_us.back(), 10000000, 500000);
+}
+
+TEST(BenchmarkHelpersTest, GetPercentile) {
+  const std::vector<int64_t> values = {1, 2, 3, 4, 5, 6, 7, 8, 9, 10};
+  EXPECT_EQ(util::GetPercentile(values, 0), 1);
+  EXPECT_EQ(util::GetPercentile(values, 50), 5);
+  EXPECT_EQ(util::GetPercentile(values, 90), 9);
+  EXPECT_EQ(util::GetPercentile(values, 99), 10);
+  EXPECT_EQ(util::GetPercentile(values, 100), 10);
+}
+
 TEST(BenchmarkHelpersTest, SplitAndParseFailed) {
   std::vector<int> results;
   const bool splitted = util::SplitAndParse("hello;world", ';', &results);
@@ -89,5 +89,47 @@ void ProfilingListener::WriteOutput(const std::string& header,
   (*stream) << data << std::endl;
 }
 
+HardwareCountersListener::HardwareCountersListener(
+    Interpreter* interpreter, const std::string& csv_file_path,
+    std::shared_ptr<profiling::ProfileSummaryFormatter> summarizer_formatter)
+    : csv_file_path_(csv_file_path),
+      summarizer_formatter_(summarizer_formatter) {
+  TFLITE_TOOLS_CHECK(interpreter);
+  if (!profiler_.IsSupported()) {
+    TFLITE_LOG(WARN) << "Hardware counters aren't available on this system, "
+                        "check /proc/sys/kernel/perf_event_paranoid.";
+    return;
+  }
+  // Added, rather than set, to keep the op profiler if any.
+  interpreter->AddProfiler(&profiler_);
+}
+
+void HardwareCountersListener::OnSingleRunStart(RunType run_type) {
+  if (run_type == REGULAR) {
+    profiler_.StartProfiling();
+  }
+}
+
+void HardwareCountersListener::OnSingleRunEnd() { profiler_.StopProfiling(); }
+
+void HardwareCountersListener::OnBenchmarkEnd(
+    const BenchmarkResults& results) {
+  const std::string output = summarizer_formatter_->GetHardwareCountersString(
+      profiler_.GetOpHardwareCounters());
+  if (output.empty()) return;
+  const auto write_output = [&output](std::ostream& stream) {
+    stream << "Operator-wise Hardware Counters for Regular Benchmark Runs:"
+           << std::endl;
+    stream << output << std::endl;
+  };
+  // Appended to the output of the ProfilingListener if writing to a file.
+  std::ofstream output_file(csv_file_path_, std::ios::app);
+  if (output_file.good()) {
+    write_output(output_file);
+  } else {
+    write_output(TFLITE_LOG(INFO));
+  }
+}
+
 }  // namespace benchmark
 }  // namespace tflite
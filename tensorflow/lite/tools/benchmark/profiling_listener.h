@@ -20,6 +20,7 @@ limitations under the License.
 #include <string>
 
 #include "tensorflow/lite/profiling/buffered_profiler.h"
+#include "tensorflow/lite/profiling/perf_event_profiler.h"
 #include "tensorflow/lite/profiling/profile_summarizer.h"
 #include "tensorflow/lite/profiling/profile_summary_formatter.h"
 #include "tensorflow/lite/tools/benchmark/benchmark_model.h"
@@ -56,6 +57,27 @@ class ProfilingListener : public BenchmarkListener {
   profiling::BufferedProfiler profiler_;
 };
 
+// Dumps the hardware counters of each op over the regular benchmark runs.
+// Must be created, and the interpreter invoked, on the same thread.
+class HardwareCountersListener : public BenchmarkListener {
+ public:
+  HardwareCountersListener(
+      Interpreter* interpreter, const std::string& csv_file_path = "",
+      std::shared_ptr<profiling::ProfileSummaryFormatter> summarizer_formatter =
+          std::make_shared<profiling::ProfileSummaryDefaultFormatter>());
+
+  void OnSingleRunStart(RunType run_type) override;
+
+  void OnSingleRunEnd() override;
+
+  void OnBenchmarkEnd(const BenchmarkResults& results) override;
+
+ private:
+  std::string csv_file_path_;
+  std::shared_ptr<profiling::ProfileSummaryFormatter> summarizer_formatter_;
+  profiling::PerfEventProfiler profiler_;
+};
+
 }  // namespace benchmark
 }  // namespace tflite
 
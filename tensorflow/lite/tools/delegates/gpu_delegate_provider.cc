@@ -46,6 +46,8 @@ class GpuDelegateProvider : public DelegateProvider {
     default_params_.AddParam("gpu_inference_for_sustained_speed",
                              ToolParam::Create<bool>(false));
     default_params_.AddParam("gpu_backend", ToolParam::Create<std::string>(""));
+    default_params_.AddParam("gpu_share_environment",
+                             ToolParam::Create<bool>(false));
 #endif
 #if defined(REAL_IPHONE_DEVICE)
     default_params_.AddParam("gpu_wait_type",
@@ -86,6 +88,11 @@ std::vector<Flag> GpuDelegateProvider::CreateFlags(ToolParams* params) const {
         "gpu_backend", params,
         "Force the GPU delegate to use a particular backend for execution, and "
         "fail if unsuccessful. Should be one of: cl, gl"),
+    CreateFlag<bool>("gpu_share_environment", params,
+                     "Whether the GPU delegates created share one OpenCL "
+                     "environment instead of creating one each. Their "
+                     "interpreters must not be invoked concurrently. By "
+                     "default, it's disabled."),
 #endif
 #if defined(REAL_IPHONE_DEVICE)
     CreateFlag<std::string>(
@@ -110,6 +117,8 @@ void GpuDelegateProvider::LogParams(const ToolParams& params,
   LOG_TOOL_PARAM(params, bool, "gpu_inference_for_sustained_speed",
                  "Prefer maximizing the throughput in gpu", verbose);
   LOG_TOOL_PARAM(params, std::string, "gpu_backend", "GPU backend", verbose);
+  LOG_TOOL_PARAM(params, bool, "gpu_share_environment",
+                 "Share the OpenCL environment of gpu delegates", verbose);
 #endif
 #if defined(REAL_IPHONE_DEVICE)
   LOG_TOOL_PARAM(params, std::string, "gpu_wait_type", "GPU delegate wait type",
@@ -146,6 +155,10 @@ TfLiteDelegatePtr GpuDelegateProvider::CreateTfLiteDelegate(
         gpu_opts.experimental_flags |= TFLITE_GPU_EXPERIMENTAL_FLAGS_GL_ONLY;
       }
     }
+    if (params.Get<bool>("gpu_share_environment")) {
+      gpu_opts.experimental_flags |=
+          TFLITE_GPU_EXPERIMENTAL_FLAGS_SHARE_ENVIRONMENT;
+    }
     gpu_opts.max_delegated_partitions =
         params.Get<int>("max_delegated_partitions");
 #ifdef TFLITE_DEBUG_DELEGATE
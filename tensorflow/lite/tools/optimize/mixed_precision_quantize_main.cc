@@ -0,0 +1,124 @@
+/* Copyright 2024 The TensorFlow Authors. All Rights Reserved.
+
+Licensed under the Apache License, Version 2.0 (the "License");
+you may not use this file except in compliance with the License.
+You may obtain a copy of the License at
+
+    http://www.apache.org/licenses/LICENSE-2.0
+
+Unless required by applicable law or agreed to in writing, software
+distributed under the License is distributed on an "AS IS" BASIS,
+WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+See the License for the specific language governing permissions and
+limitations under the License.
+==============================================================================*/
+#include <cstdio>
+#include <cstdlib>
+#include <fstream>
+#include <memory>
+#include <sstream>
+#include <string>
+#include <unordered_set>
+#include <utility>
+#include <vector>
+
+#include "tensorflow/lite/schema/schema_generated.h"
+#include "tensorflow/lite/stderr_reporter.h"
+#include "tensorflow/lite/tools/optimize/mixed_precision_search.h"
+#include "tensorflow/lite/tools/optimize/model_utils.h"
+#include "tensorflow/lite/tools/optimize/quantize_model.h"
+#include "tensorflow/lite/tools/optimize/reduced_precision_support.h"
+
+// Quantizes a calibrated float model with the precision of each op searched
+// from the latency and error of the op in each precision, so that the total
+// error is within a budget.
+//
+// The op profiles are CSV lines "op_name,precision,latency_us,error", see
+// ParseOpProfiles, with the latencies measured on the target device, e.g. with
+// --enable_op_profiling of benchmark_model on the float32, float16, int8 and
+// int16x8 variants of the model, and the errors e.g. with the quantization
+// debugger.
+//
+// Note: This is a private API, subject to change.
+int main(int argc, char** argv) {
+  if (argc != 5) {
+    printf(
+        "Wrong number of arguments. Example: mixed_precision_quantize_main "
+        "${calibrated_model} ${op_profiles_csv} ${error_budget} ${output}\n");
+    return 1;
+  }
+  tflite::ErrorReporter* error_reporter = tflite::DefaultErrorReporter();
+
+  std::ifstream profiles_file(argv[2]);
+  if (!profiles_file) {
+    printf("Failed to read %s\n", argv[2]);
+    return 1;
+  }
+  std::stringstream profiles_csv;
+  profiles_csv << profiles_file.rdbuf();
+  std::vector<tflite::optimize::OpProfile> op_profiles;
+  if (tflite::optimize::ParseOpProfiles(profiles_csv.str(), &op_profiles,
+                                        error_reporter) != kTfLiteOk) {
+    return 1;
+  }
+
+  char* budget_end;
+  const double error_budget = std::strtod(argv[3], &budget_end);
+  if (*argv[3] == '\0' || *budget_end != '\0') {
+    printf("Invalid error budget %s\n", argv[3]);
+    return 1;
+  }
+
+  tflite::optimize::MixedPrecisionAssignment assignment;
+  if (tflite::optimize::SearchMixedPrecision(op_profiles, error_budget,
+                                             &assignment,
+                                             error_reporter) != kTfLiteOk) {
+    return 1;
+  }
+
+  std::unordered_set<std::string> quantized_op_names;
+  for (size_t i = 0; i < op_profiles.size(); ++i) {
+    const tflite::optimize::OpPrecision precision =
+        assignment.op_precisions[i];
+    printf("%s: %s\n", op_profiles[i].name.c_str(),
+           tflite::optimize::OpPrecisionName(precision));
+    if (precision == assignment.integer_precision) {
+      quantized_op_names.insert(op_profiles[i].name);
+    }
+  }
+  printf("Estimated latency: %g us, error: %g\n", assignment.latency_us,
+         assignment.error);
+
+  std::unique_ptr<tflite::ModelT> model =
+      tflite::optimize::utils::CreateMutableModelFromFile(argv[1]);
+  if (assignment.float_precision ==
+      tflite::optimize::OpPrecision::kFloat16) {
+    // Let the delegates run the float ops in float16.
+    const auto metadata =
+        tflite::optimize::MetadataForReducedPrecisionSupport(
+            tflite::optimize::ReducedPrecisionSupport::Float16Inference |
+            tflite::optimize::ReducedPrecisionSupport::Float32Accumulation);
+    auto buffer = std::make_unique<tflite::BufferT>();
+    buffer->data.assign(metadata.second.begin(), metadata.second.end());
+    model->buffers.push_back(std::move(buffer));
+    auto model_metadata = std::make_unique<tflite::MetadataT>();
+    model_metadata->name = metadata.first;
+    model_metadata->buffer = model->buffers.size() - 1;
+    model->metadata.push_back(std::move(model_metadata));
+  }
+
+  const bool int16x8 =
+      assignment.integer_precision == tflite::optimize::OpPrecision::kInt16x8;
+  flatbuffers::FlatBufferBuilder builder;
+  if (tflite::optimize::QuantizeModel(
+          &builder, model.get(), tflite::TensorType_FLOAT32,
+          tflite::TensorType_FLOAT32, /*allow_float=*/true, quantized_op_names,
+          int16x8 ? tflite::TensorType_INT16 : tflite::TensorType_INT8,
+          int16x8 ? tflite::TensorType_INT64 : tflite::TensorType_INT32,
+          /*disable_per_channel=*/false, error_reporter) != kTfLiteOk) {
+    return 1;
+  }
+  tflite::optimize::utils::WriteFile(argv[4], builder.GetBufferPointer(),
+                                     builder.GetSize());
+  return 0;
+}
@@ -0,0 +1,239 @@
+/* Copyright 2024 The TensorFlow Authors. All Rights Reserved.
+
+Licensed under the Apache License, Version 2.0 (the "License");
+you may not use this file except in compliance with the License.
+You may obtain a copy of the License at
+
+    http://www.apache.org/licenses/LICENSE-2.0
+
+Unless required by applicable law or agreed to in writing, software
+distributed under the License is distributed on an "AS IS" BASIS,
+WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+See the License for the specific language governing permissions and
+limitations under the License.
+==============================================================================*/
+#include "tensorflow/lite/tools/optimize/mixed_precision_search.h"
+
+#include <algorithm>
+#include <limits>
+#include <map>
+#include <string>
+#include <utility>
+#include <vector>
+
+#include "absl/strings/numbers.h"
+#include "absl/strings/str_split.h"
+#include "absl/strings/string_view.h"
+#include "tensorflow/lite/core/api/error_reporter.h"
+#include "tensorflow/lite/core/c/common.h"
+
+namespace tflite {
+namespace optimize {
+
+namespace {
+
+// The two precisions an op can be assigned for an integer and float precision
+// of the model, the faster first.
+struct OpChoice {
+  OpPrecision precisions[2];
+  const OpPrecisionMeasurement* measurements[2];
+  // Whether the op has the second precision.
+  bool has_slower = false;
+  // Index, 0 or 1, of the precision assigned.
+  int assigned = 0;
+};
+
+// Assigns the precisions of the ops for one integer and float precision of the
+// model, or returns false if no assignment is within the budget.
+bool SearchForModelPrecisions(const std::vector<OpProfile>& op_profiles,
+                              OpPrecision integer_precision,
+                              OpPrecision float_precision, double error_budget,
+                              MixedPrecisionAssignment* assignment) {
+  std::vector<OpChoice> choices(op_profiles.size());
+  double latency_us = 0;
+  double error = 0;
+  for (size_t i = 0; i < op_profiles.size(); ++i) {
+    const auto& measurements = op_profiles[i].measurements;
+    const auto float_it = measurements.find(float_precision);
+    if (float_it == measurements.end()) return false;
+    const auto integer_it = measurements.find(integer_precision);
+
+    OpChoice& choice = choices[i];
+    choice.precisions[0] = float_precision;
+    choice.measurements[0] = &float_it->second;
+    if (integer_it != measurements.end()) {
+      choice.precisions[1] = integer_precision;
+      choice.measurements[1] = &integer_it->second;
+      choice.has_slower = true;
+      const OpPrecisionMeasurement& f = float_it->second;
+      const OpPrecisionMeasurement& q = integer_it->second;
+      if (q.latency_us < f.latency_us ||
+          (q.latency_us == f.latency_us && q.error < f.error)) {
+        std::swap(choice.precisions[0], choice.precisions[1]);
+        std::swap(choice.measurements[0], choice.measurements[1]);
+      }
+    }
+    latency_us += choice.measurements[0]->latency_us;
+    error += choice.measurements[0]->error;
+  }
+
+  // Move the ops reducing the error the most per latency added to their slower
+  // precision until the error is within the budget.
+  while (error > error_budget) {
+    int best = -1;
+    double best_ratio = 0;
+    for (size_t i = 0; i < choices.size(); ++i) {
+      const OpChoice& choice = choices[i];
+      if (!choice.has_slower || choice.assigned == 1) continue;
+      const double error_reduction =
+          choice.measurements[0]->error - choice.measurements[1]->error;
+      if (error_reduction <= 0) continue;
+      const double latency_increase =
+          std::max(choice.measurements[1]->latency_us -
+                       choice.measurements[0]->latency_us,
+                   std::numeric_limits<double>::min());
+      const double ratio = error_reduction / latency_increase;
+      if (best == -1 || ratio > best_ratio) {
+        best = static_cast<int>(i);
+        best_ratio = ratio;
+      }
+    }
+    if (best == -1) return false;
+    OpChoice& choice = choices[best];
+    choice.assigned = 1;
+    latency_us +=
+        choice.measurements[1]->latency_us - choice.measurements[0]->latency_us;
+    error += choice.measurements[1]->error - choice.measurements[0]->error;
+  }
+
+  // The greedy moves may overshoot the budget: move back the ops saving the
+  // most latency that still fit in it.
+  std::vector<int> moved;
+  for (size_t i = 0; i < choices.size(); ++i) {
+    if (choices[i].assigned == 1) moved.push_back(static_cast<int>(i));
+  }
+  auto latency_saving = [&choices](int i) {
+    return choices[i].measurements[1]->latency_us -
+           choices[i].measurements[0]->latency_us;
+  };
+  std::stable_sort(moved.begin(), moved.end(), [&](int a, int b) {
+    return latency_saving(a) > latency_saving(b);
+  });
+  for (int i : moved) {
+    OpChoice& choice = choices[i];
+    const double moved_back_error =
+        error - choice.measurements[1]->error + choice.measurements[0]->error;
+    if (moved_back_error > error_budget) continue;
+    choice.assigned = 0;
+    latency_us -= latency_saving(i);
+    error = moved_back_error;
+  }
+
+  assignment->integer_precision = integer_precision;
+  assignment->float_precision = float_precision;
+  assignment->op_precisions.clear();
+  for (const OpChoice& choice : choices) {
+    assignment->op_precisions.push_back(choice.precisions[choice.assigned]);
+  }
+  assignment->latency_us = latency_us;
+  assignment->error = error;
+  return true;
+}
+
+}  // namespace
+
+const char* OpPrecisionName(OpPrecision precision) {
+  switch (precision) {
+    case OpPrecision::kFloat32:
+      return "float32";
+    case OpPrecision::kFloat16:
+      return "float16";
+    case OpPrecision::kInt8:
+      return "int8";
+    case OpPrecision::kInt16x8:
+      return "int16x8";
+  }
+  return "unknown";
+}
+
+bool ParseOpPrecision(const std::string& name, OpPrecision* precision) {
+  for (OpPrecision candidate :
+       {OpPrecision::kFloat32, OpPrecision::kFloat16, OpPrecision::kInt8,
+        OpPrecision::kInt16x8}) {
+    if (name == OpPrecisionName(candidate)) {
+      *precision = candidate;
+      return true;
+    }
+  }
+  return false;
+}
+
+TfLiteStatus SearchMixedPrecision(const std::vector<OpProfile>& op_profiles,
+                                  double error_budget,
+                                  MixedPrecisionAssignment* assignment,
+                                  ErrorReporter* error_reporter) {
+  bool found = false;
+  for (OpPrecision integer_precision :
+       {OpPrecision::kInt8, OpPrecision::kInt16x8}) {
+    for (OpPrecision float_precision :
+         {OpPrecision::kFloat32, OpPrecision::kFloat16}) {
+      MixedPrecisionAssignment candidate;
+      if (!SearchForModelPrecisions(op_profiles, integer_precision,
+                                    float_precision, error_budget,
+                                    &candidate)) {
+        continue;
+      }
+      if (!found || candidate.latency_us < assignment->latency_us ||
+          (candidate.latency_us == assignment->latency_us &&
+           candidate.error < assignment->error)) {
+        *assignment = std::move(candidate);
+        found = true;
+      }
+    }
+  }
+  if (!found) {
+    TF_LITE_REPORT_ERROR(error_reporter,
+                         "No assignment of the op precisions has an error "
+                         "within the budget %g.",
+                         error_budget);
+    return kTfLiteError;
+  }
+  return kTfLiteOk;
+}
+
+TfLiteStatus ParseOpProfiles(const std::string& csv,
+                             std::vector<OpProfile>* op_profiles,
+                             ErrorReporter* error_reporter) {
+  op_profiles->clear();
+  std::map<std::string, size_t> op_indices;
+  int line_number = 0;
+  for (absl::string_view line : absl::StrSplit(csv, '\n')) {
+    ++line_number;
+    if (!line.empty() && line.back() == '\r') line.remove_suffix(1);
+    if (line.empty() || line.front() == '#') continue;
+    const std::vector<std::string> fields = absl::StrSplit(line, ',');
+    OpPrecision precision;
+    OpPrecisionMeasurement measurement;
+    if (fields.size() != 4 || fields[0].empty() ||
+        !ParseOpPrecision(fields[1], &precision) ||
+        !absl::SimpleAtod(fields[2], &measurement.latency_us) ||
+        !absl::SimpleAtod(fields[3], &measurement.error)) {
+      TF_LITE_REPORT_ERROR(error_reporter,
+                           "Invalid op profile at line %d, expected "
+                           "op_name,precision,latency_us,error.",
+                           line_number);
+      return kTfLiteError;
+    }
+    auto inserted = op_indices.emplace(fields[0], op_profiles->size());
+    if (inserted.second) {
+      op_profiles->emplace_back();
+      op_profiles->back().name = fields[0];
+    }
+    (*op_profiles)[inserted.first->second].measurements[precision] =
+        measurement;
+  }
+  return kTfLiteOk;
+}
+
+}  // namespace optimize
+}  // namespace tflite
@@ -0,0 +1,106 @@
+/* Copyright 2024 The TensorFlow Authors. All Rights Reserved.
+
+Licensed under the Apache License, Version 2.0 (the "License");
+you may not use this file except in compliance with the License.
+You may obtain a copy of the License at
+
+    http://www.apache.org/licenses/LICENSE-2.0
+
+Unless required by applicable law or agreed to in writing, software
+distributed under the License is distributed on an "AS IS" BASIS,
+WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+See the License for the specific language governing permissions and
+limitations under the License.
+==============================================================================*/
+#ifndef TENSORFLOW_LITE_TOOLS_OPTIMIZE_MIXED_PRECISION_SEARCH_H_
+#define TENSORFLOW_LITE_TOOLS_OPTIMIZE_MIXED_PRECISION_SEARCH_H_
+
+#include <map>
+#include <string>
+#include <vector>
+
+#include "tensorflow/lite/core/api/error_reporter.h"
+#include "tensorflow/lite/core/c/common.h"
+
+namespace tflite {
+namespace optimize {
+
+// The precisions an operator can be run in.
+enum class OpPrecision {
+  kFloat32,
+  kFloat16,
+  // Int8 weights and activations.
+  kInt8,
+  // Int8 weights and int16 activations.
+  kInt16x8,
+};
+
+// Returns "float32", "float16", "int8" or "int16x8".
+const char* OpPrecisionName(OpPrecision precision);
+
+// Parses the name returned by OpPrecisionName, or returns false.
+bool ParseOpPrecision(const std::string& name, OpPrecision* precision);
+
+// The latency and output error of an operator run in some precision, measured
+// on the target device.
+struct OpPrecisionMeasurement {
+  double latency_us = 0;
+  // The error the precision adds to the output of the model, e.g. its mean
+  // squared error with this op in that precision and all the others in
+  // float32. Errors of the ops are assumed to add up.
+  double error = 0;
+};
+
+// The measurements of an operator in the precisions it supports.
+struct OpProfile {
+  // The name of the first output tensor of the op, which identifies the op in
+  // the operator names of QuantizeModel.
+  std::string name;
+  std::map<OpPrecision, OpPrecisionMeasurement> measurements;
+};
+
+// The precision of each op of a model, as the quantizer can produce it: the
+// quantized ops share the activations type of the model, and the float ops run
+// in float16 or not depending on the reduced precision support metadata of the
+// model, not per op.
+struct MixedPrecisionAssignment {
+  // kInt8 or kInt16x8.
+  OpPrecision integer_precision = OpPrecision::kInt8;
+  // kFloat32 or kFloat16.
+  OpPrecision float_precision = OpPrecision::kFloat32;
+  // The precision of each op, in the order of the profiles searched.
+  std::vector<OpPrecision> op_precisions;
+  double latency_us = 0;
+  double error = 0;
+};
+
+// Searches the precision of each op minimizing the latency of the model with
+// a total error not above `error_budget`.
+//
+// For each integer and float precision of the model, every op either is
+// quantized or stays float: starting from the fastest precision of each op,
+// the ops reducing the error the most per latency added are moved to their
+// other precision until the error is within the budget, then the ops that can
+// be moved back to their faster precision within the budget are. The fastest
+// of these assignments is returned.
+//
+// Returns an error if no assignment is within the budget, e.g. if some op
+// lacks a float32 measurement.
+TfLiteStatus SearchMixedPrecision(const std::vector<OpProfile>& op_profiles,
+                                  double error_budget,
+                                  MixedPrecisionAssignment* assignment,
+                                  ErrorReporter* error_reporter);
+
+// Parses the op profiles from CSV lines of the form
+//   op_name,precision,latency_us,error
+// e.g. "conv1,int8,120.5,0.0003". The lines of an op need not be adjacent,
+// the ops are returned in the order of their first line. Empty lines and
+// lines starting with '#' are skipped.
+TfLiteStatus ParseOpProfiles(const std::string& csv,
+                             std::vector<OpProfile>* op_profiles,
+                             ErrorReporter* error_reporter);
+
+}  // namespace optimize
+}  // namespace tflite
+
+#endif  // TENSORFLOW_LITE_TOOLS_OPTIMIZE_MIXED_PRECISION_SEARCH_H_
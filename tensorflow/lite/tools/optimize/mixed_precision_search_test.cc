@@ -0,0 +1,181 @@
+/* Copyright 2024 The TensorFlow Authors. All Rights Reserved.
+
+Licensed under the Apache License, Version 2.0 (the "License");
+you may not use this file except in compliance with the License.
+You may obtain a copy of the License at
+
+    http://www.apache.org/licenses/LICENSE-2.0
+
+Unless required by applicable law or agreed to in writing, software
+distributed under the License is distributed on an "AS IS" BASIS,
+WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+See the License for the specific language governing permissions and
+limitations under the License.
+==============================================================================*/
+#include "tensorflow/lite/tools/optimize/mixed_precision_search.h"
+
+#include <string>
+#include <vector>
+
+#include <gmock/gmock.h>
+#include <gtest/gtest.h>
+#include "tensorflow/lite/testing/util.h"
+
+namespace tflite {
+namespace optimize {
+namespace {
+
+using ::testing::ElementsAre;
+
+OpProfile Profile(const std::string& name, double float_latency_us,
+                  double int8_latency_us, double int8_error) {
+  OpProfile profile;
+  profile.name = name;
+  profile.measurements[OpPrecision::kFloat32] = {float_latency_us, 0};
+  profile.measurements[OpPrecision::kInt8] = {int8_latency_us, int8_error};
+  return profile;
+}
+
+class MixedPrecisionSearchTest : public testing::Test {
+ protected:
+  tflite::TestErrorReporter error_reporter_;
+};
+
+TEST_F(MixedPrecisionSearchTest, QuantizesAllOpsWithinBudget) {
+  const std::vector<OpProfile> ops = {Profile("a", 10, 4, 0.1),
+                                      Profile("b", 20, 5, 0.2)};
+  MixedPrecisionAssignment assignment;
+  ASSERT_EQ(SearchMixedPrecision(ops, 1.0, &assignment, &error_reporter_),
+            kTfLiteOk);
+  EXPECT_EQ(assignment.integer_precision, OpPrecision::kInt8);
+  EXPECT_EQ(assignment.float_precision, OpPrecision::kFloat32);
+  EXPECT_THAT(assignment.op_precisions,
+              ElementsAre(OpPrecision::kInt8, OpPrecision::kInt8));
+  EXPECT_DOUBLE_EQ(assignment.latency_us, 9);
+  EXPECT_DOUBLE_EQ(assignment.error, 0.3);
+}
+
+TEST_F(MixedPrecisionSearchTest, KeepsAllOpsFloatWithZeroBudget) {
+  const std::vector<OpProfile> ops = {Profile("a", 10, 4, 0.1),
+                                      Profile("b", 20, 5, 0.2)};
+  MixedPrecisionAssignment assignment;
+  ASSERT_EQ(SearchMixedPrecision(ops, 0, &assignment, &error_reporter_),
+            kTfLiteOk);
+  EXPECT_THAT(assignment.op_precisions,
+              ElementsAre(OpPrecision::kFloat32, OpPrecision::kFloat32));
+  EXPECT_DOUBLE_EQ(assignment.latency_us, 30);
+  EXPECT_DOUBLE_EQ(assignment.error, 0);
+}
+
+TEST_F(MixedPrecisionSearchTest, KeepsFloatTheOpsReducingErrorMostPerLatency) {
+  // Keeping "b" float removes the most error per microsecond.
+  const std::vector<OpProfile> ops = {Profile("a", 10, 4, 0.1),
+                                      Profile("b", 20, 15, 0.5),
+                                      Profile("c", 30, 10, 0.2)};
+  MixedPrecisionAssignment assignment;
+  ASSERT_EQ(SearchMixedPrecision(ops, 0.35, &assignment, &error_reporter_),
+            kTfLiteOk);
+  EXPECT_THAT(assignment.op_precisions,
+              ElementsAre(OpPrecision::kInt8, OpPrecision::kFloat32,
+                          OpPrecision::kInt8));
+  EXPECT_DOUBLE_EQ(assignment.latency_us, 34);
+  EXPECT_DOUBLE_EQ(assignment.error, 0.3);
+}
+
+TEST_F(MixedPrecisionSearchTest, QuantizesBackOpsTheBudgetAllows) {
+  // The search first keeps "a" float, then "b", after which "a" fits in the
+  // budget quantized.
+  const std::vector<OpProfile> ops = {Profile("a", 1.5, 1, 1),
+                                      Profile("b", 20, 10, 10)};
+  MixedPrecisionAssignment assignment;
+  ASSERT_EQ(SearchMixedPrecision(ops, 1.5, &assignment, &error_reporter_),
+            kTfLiteOk);
+  EXPECT_THAT(assignment.op_precisions,
+              ElementsAre(OpPrecision::kInt8, OpPrecision::kFloat32));
+  EXPECT_DOUBLE_EQ(assignment.latency_us, 21);
+  EXPECT_DOUBLE_EQ(assignment.error, 1);
+}
+
+TEST_F(MixedPrecisionSearchTest, PicksInt16x8WhenInt8IsTooLossy) {
+  std::vector<OpProfile> ops = {Profile("a", 10, 4, 1.0),
+                                Profile("b", 20, 5, 1.0)};
+  ops[0].measurements[OpPrecision::kInt16x8] = {6, 0.01};
+  ops[1].measurements[OpPrecision::kInt16x8] = {8, 0.02};
+  MixedPrecisionAssignment assignment;
+  ASSERT_EQ(SearchMixedPrecision(ops, 0.1, &assignment, &error_reporter_),
+            kTfLiteOk);
+  EXPECT_EQ(assignment.integer_precision, OpPrecision::kInt16x8);
+  EXPECT_THAT(assignment.op_precisions,
+              ElementsAre(OpPrecision::kInt16x8, OpPrecision::kInt16x8));
+  EXPECT_DOUBLE_EQ(assignment.latency_us, 14);
+}
+
+TEST_F(MixedPrecisionSearchTest, PicksFloat16ForTheFloatOps) {
+  std::vector<OpProfile> ops = {Profile("a", 10, 4, 0.1),
+                                Profile("b", 20, 5, 1.0)};
+  ops[0].measurements[OpPrecision::kFloat16] = {7, 0.001};
+  ops[1].measurements[OpPrecision::kFloat16] = {12, 0.001};
+  MixedPrecisionAssignment assignment;
+  ASSERT_EQ(SearchMixedPrecision(ops, 0.5, &assignment, &error_reporter_),
+            kTfLiteOk);
+  EXPECT_EQ(assignment.float_precision, OpPrecision::kFloat16);
+  EXPECT_THAT(assignment.op_precisions,
+              ElementsAre(OpPrecision::kInt8, OpPrecision::kFloat16));
+  EXPECT_DOUBLE_EQ(assignment.latency_us, 16);
+}
+
+TEST_F(MixedPrecisionSearchTest, KeepsOpsWithoutQuantizedMeasurementsFloat) {
+  OpProfile unquantizable;
+  unquantizable.name = "b";
+  unquantizable.measurements[OpPrecision::kFloat32] = {20, 0};
+  const std::vector<OpProfile> ops = {Profile("a", 10, 4, 0.1), unquantizable};
+  MixedPrecisionAssignment assignment;
+  ASSERT_EQ(SearchMixedPrecision(ops, 1.0, &assignment, &error_reporter_),
+            kTfLiteOk);
+  EXPECT_THAT(assignment.op_precisions,
+              ElementsAre(OpPrecision::kInt8, OpPrecision::kFloat32));
+}
+
+TEST_F(MixedPrecisionSearchTest, FailsWhenNoAssignmentIsWithinBudget) {
+  std::vector<OpProfile> ops = {Profile("a", 10, 4, 0.1)};
+  ops[0].measurements[OpPrecision::kFloat32].error = 0.5;
+  MixedPrecisionAssignment assignment;
+  EXPECT_EQ(SearchMixedPrecision(ops, 0.01, &assignment, &error_reporter_),
+            kTfLiteError);
+  ops[0].measurements.erase(OpPrecision::kFloat32);
+  EXPECT_EQ(SearchMixedPrecision(ops, 1.0, &assignment, &error_reporter_),
+            kTfLiteError);
+}
+
+TEST_F(MixedPrecisionSearchTest, ParsesOpProfiles) {
+  const std::string csv =
+      "# op_name,precision,latency_us,error\n"
+      "conv,float32,120.5,0\n"
+      "fc,float32,30,0\r\n"
+      "\n"
+      "conv,int8,40,0.0003\n";
+  std::vector<OpProfile> ops;
+  ASSERT_EQ(ParseOpProfiles(csv, &ops, &error_reporter_), kTfLiteOk);
+  ASSERT_EQ(ops.size(), 2);
+  EXPECT_EQ(ops[0].name, "conv");
+  ASSERT_EQ(ops[0].measurements.size(), 2);
+  EXPECT_DOUBLE_EQ(ops[0].measurements[OpPrecision::kFloat32].latency_us,
+                   120.5);
+  EXPECT_DOUBLE_EQ(ops[0].measurements[OpPrecision::kInt8].error, 0.0003);
+  EXPECT_EQ(ops[1].name, "fc");
+  EXPECT_EQ(ops[1].measurements.size(), 1);
+}
+
+TEST_F(MixedPrecisionSearchTest, RejectsInvalidOpProfiles) {
+  std::vector<OpProfile> ops;
+  EXPECT_EQ(ParseOpProfiles("conv,int4,10,0\n", &ops, &error_reporter_),
+            kTfLiteError);
+  EXPECT_EQ(ParseOpProfiles("conv,int8,fast,0\n", &ops, &error_reporter_),
+            kTfLiteError);
+  EXPECT_EQ(ParseOpProfiles("conv,int8,10\n", &ops, &error_reporter_),
+            kTfLiteError);
+}
+
+}  // namespace
+}  // namespace optimize
+}  // namespace tflite
@@ -0,0 +1,227 @@
+# Copyright 2024 The TensorFlow Authors. All Rights Reserved.
+#
+# Licensed under the Apache License, Version 2.0 (the "License");
+# you may not use this file except in compliance with the License.
+# You may obtain a copy of the License at
+#
+#     http://www.apache.org/licenses/LICENSE-2.0
+#
+# Unless required by applicable law or agreed to in writing, software
+# distributed under the License is distributed on an "AS IS" BASIS,
+# WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+# See the License for the specific language governing permissions and
+# limitations under the License.
+# =============================================================================
+"""Builds the TF-TRT engines of a SavedModel offline from recorded shapes.
+
+The input shapes of served requests are replayed through a TF-TRT converter in
+dynamic shape mode, so that the optimization profiles cover all of them, and
+the built engines are serialized into the assets of the output SavedModel. The
+converted model does not allow building engines at runtime: a TRTEngineOp
+loads its engines through its TRTEngineCacheResource when the model is loaded
+and falls back to the native segment for a shape no profile covers, instead
+of building an engine on the request path.
+
+The shapes file has one request per line. A request lists the shape of each
+input of the signature as `name=dims`, separated by whitespace, where `dims`
+are the dimension sizes joined by `x`, e.g.
+
+  images=8x224x224x3 lengths=8
+  images=1x224x224x3 lengths=1
+
+A scalar input is written with empty dimensions, e.g. `scale=`. Empty lines
+and lines starting with `#` are ignored.
+"""
+
+import argparse
+import sys
+
+from absl import app
+import numpy as np
+
+from tensorflow.python.compiler.tensorrt import trt_convert as trt
+from tensorflow.python.platform import gfile
+from tensorflow.python.platform import tf_logging as logging
+
+FLAGS = None
+
+
+def parse_shape_records(lines):
+  """Parses the recorded requests of a shapes file.
+
+  Args:
+    lines: an iterable of the lines of a shapes file.
+
+  Returns:
+    A list with a dict from input name to shape, as a tuple of ints, for each
+    request.
+
+  Raises:
+    ValueError: if a line is malformed, or if the requests do not all have the
+      same inputs.
+  """
+  records = []
+  for line_number, line in enumerate(lines, start=1):
+    line = line.strip()
+    if not line or line.startswith("#"):
+      continue
+    record = {}
+    for field in line.split():
+      name, sep, dims = field.partition("=")
+      if not sep or not name:
+        raise ValueError("Line %d: expected `name=dims`, got `%s`." %
+                         (line_number, field))
+      if name in record:
+        raise ValueError("Line %d: input `%s` is listed twice." %
+                         (line_number, name))
+      try:
+        shape = tuple(int(d) for d in dims.split("x")) if dims else ()
+      except ValueError:
+        raise ValueError("Line %d: bad dimensions `%s` for input `%s`." %
+                         (line_number, dims, name)) from None
+      if any(d < 0 for d in shape):
+        raise ValueError("Line %d: negative dimension for input `%s`." %
+                         (line_number, name))
+      record[name] = shape
+    if records and record.keys() != records[0].keys():
+      raise ValueError("Line %d: expected inputs %s, got %s." %
+                       (line_number, sorted(records[0]), sorted(record)))
+    records.append(record)
+  return records
+
+
+def make_input_fn(records, input_specs):
+  """Returns an input_fn for `TrtGraphConverterV2.build()`.
+
+  Args:
+    records: the requests returned by `parse_shape_records()`.
+    input_specs: a dict from input name to the `tf.TensorSpec` of the input of
+      the converted signature.
+
+  Raises:
+    ValueError: if the requests do not match the inputs of the signature.
+  """
+  if not records:
+    raise ValueError("The shapes file has no requests.")
+  if records[0].keys() != input_specs.keys():
+    raise ValueError("The shapes file has inputs %s but the signature has "
+                     "inputs %s." % (sorted(records[0]), sorted(input_specs)))
+  for record in records:
+    for name, shape in record.items():
+      if not input_specs[name].shape.is_compatible_with(shape):
+        raise ValueError("Shape %s of input `%s` is not compatible with %s." %
+                         (shape, name, input_specs[name].shape))
+
+  def input_fn():
+    for record in records:
+      yield {
+          name: np.zeros(shape, dtype=input_specs[name].dtype.as_numpy_dtype)
+          for name, shape in record.items()
+      }
+
+  return input_fn
+
+
+def build_engines(input_saved_model_dir,
+                  output_saved_model_dir,
+                  records,
+                  input_saved_model_tags=None,
+                  input_saved_model_signature_key=None,
+                  dynamic_shape_profile_strategy=None,
+                  precision_mode=trt.TrtPrecisionMode.FP32,
+                  maximum_cached_engines=1):
+  """Converts a SavedModel and builds its engines for the recorded requests.
+
+  Args:
+    input_saved_model_dir: the directory of the SavedModel to convert.
+    output_saved_model_dir: the directory to save the converted SavedModel to.
+    records: the requests returned by `parse_shape_records()`.
+    input_saved_model_tags: list of tags to load the SavedModel.
+    input_saved_model_signature_key: the key of the signature to convert.
+    dynamic_shape_profile_strategy: one of the strings in
+      `trt_convert.supported_profile_strategies()`.
+    precision_mode: one of the strings in
+      `TrtPrecisionMode.supported_precision_modes()`. INT8 requires
+      quantization nodes since no calibration data is available.
+    maximum_cached_engines: the maximum number of engines in the cache of each
+      TRTEngineOp.
+  """
+  converter = trt.TrtGraphConverterV2(
+      input_saved_model_dir=input_saved_model_dir,
+      input_saved_model_tags=input_saved_model_tags,
+      input_saved_model_signature_key=input_saved_model_signature_key,
+      use_dynamic_shape=True,
+      dynamic_shape_profile_strategy=dynamic_shape_profile_strategy,
+      precision_mode=precision_mode,
+      maximum_cached_engines=maximum_cached_engines,
+      use_calibration=False,
+      allow_build_at_runtime=False)
+  converter.convert()
+  # Signature functions only take keyword arguments.
+  _, input_specs = converter._converted_func.structured_input_signature  # pylint: disable=protected-access
+  converter.build(input_fn=make_input_fn(records, input_specs))
+  converter.save(output_saved_model_dir, save_gpu_specific_engines=True)
+  logging.info("Built TF-TRT engines for %d recorded requests into %s.",
+               len(records), output_saved_model_dir)
+
+
+def main(unused_args):
+  with gfile.GFile(FLAGS.shapes_file, "r") as f:
+    records = parse_shape_records(f)
+  build_engines(
+      FLAGS.input_saved_model_dir,
+      FLAGS.output_saved_model_dir,
+      records,
+      input_saved_model_tags=FLAGS.tags.split(",") if FLAGS.tags else None,
+      input_saved_model_signature_key=FLAGS.signature_key or None,
+      dynamic_shape_profile_strategy=FLAGS.profile_strategy or None,
+      precision_mode=FLAGS.precision_mode,
+      maximum_cached_engines=FLAGS.maximum_cached_engines)
+
+
+if __name__ == "__main__":
+  parser = argparse.ArgumentParser()
+  parser.add_argument(
+      "--input_saved_model_dir",
+      type=str,
+      required=True,
+      help="Directory of the SavedModel to convert.")
+  parser.add_argument(
+      "--output_saved_model_dir",
+      type=str,
+      required=True,
+      help="Directory to save the converted SavedModel with its engines to.")
+  parser.add_argument(
+      "--shapes_file",
+      type=str,
+      required=True,
+      help="File with the input shapes of the recorded requests.")
+  parser.add_argument(
+      "--tags",
+      type=str,
+      default="",
+      help="Comma separated tags of the MetaGraph to convert.")
+  parser.add_argument(
+      "--signature_key",
+      type=str,
+      default="",
+      help="Key of the signature to convert.")
+  parser.add_argument(
+      "--profile_strategy",
+      type=str,
+      default="",
+      help="Strategy to create optimization profiles from the shapes, one of "
+      "%s." % ", ".join(trt.supported_profile_strategies()))
+  parser.add_argument(
+      "--precision_mode",
+      type=str,
+      default=trt.TrtPrecisionMode.FP32,
+      help="Precision of the engines, one of %s." %
+      ", ".join(trt.TrtPrecisionMode.supported_precision_modes()))
+  parser.add_argument(
+      "--maximum_cached_engines",
+      type=int,
+      default=1,
+      help="Maximum number of engines cached by each TRTEngineOp.")
+  FLAGS, unparsed = parser.parse_known_args()
+  app.run(main=main, argv=[sys.argv[0]] + unparsed)
@@ -0,0 +1,76 @@
+# Copyright 2024 The TensorFlow Authors. All Rights Reserved.
+#
+# Licensed under the Apache License, Version 2.0 (the "License");
+# you may not use this file except in compliance with the License.
+# You may obtain a copy of the License at
+#
+#     http://www.apache.org/licenses/LICENSE-2.0
+#
+# Unless required by applicable law or agreed to in writing, software
+# distributed under the License is distributed on an "AS IS" BASIS,
+# WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+# See the License for the specific language governing permissions and
+# limitations under the License.
+# =============================================================================
+"""Tests for the offline TF-TRT engine building tool."""
+
+import numpy as np
+
+from tensorflow.python.compiler.tensorrt import build_engines
+from tensorflow.python.framework import dtypes
+from tensorflow.python.framework import tensor_spec
+from tensorflow.python.platform import test
+
+
+class BuildEnginesTest(test.TestCase):
+
+  def testParseShapeRecords(self):
+    records = build_engines.parse_shape_records([
+        "# Recorded requests.",
+        "x=8x16 scale=",
+        "",
+        "  scale= x=1x16  ",
+    ])
+    self.assertEqual(records, [{
+        "x": (8, 16),
+        "scale": ()
+    }, {
+        "x": (1, 16),
+        "scale": ()
+    }])
+
+  def testParseShapeRecordsErrors(self):
+    with self.assertRaisesRegex(ValueError, "expected `name=dims`"):
+      build_engines.parse_shape_records(["x:8x16"])
+    with self.assertRaisesRegex(ValueError, "bad dimensions"):
+      build_engines.parse_shape_records(["x=8xa"])
+    with self.assertRaisesRegex(ValueError, "listed twice"):
+      build_engines.parse_shape_records(["x=1 x=2"])
+    with self.assertRaisesRegex(ValueError, "Line 2: expected inputs"):
+      build_engines.parse_shape_records(["x=1 y=2", "x=1"])
+
+  def testMakeInputFn(self):
+    input_specs = {
+        "x": tensor_spec.TensorSpec([None, 16], dtypes.float16),
+        "ids": tensor_spec.TensorSpec([None], dtypes.int32),
+    }
+    records = [{"x": (8, 16), "ids": (8,)}, {"x": (1, 16), "ids": (1,)}]
+    inputs = list(build_engines.make_input_fn(records, input_specs)())
+    self.assertLen(inputs, 2)
+    self.assertEqual(inputs[0]["x"].shape, (8, 16))
+    self.assertEqual(inputs[0]["x"].dtype, np.float16)
+    self.assertEqual(inputs[1]["ids"].shape, (1,))
+    self.assertEqual(inputs[1]["ids"].dtype, np.int32)
+
+  def testMakeInputFnErrors(self):
+    input_specs = {"x": tensor_spec.TensorSpec([None, 16], dtypes.float32)}
+    with self.assertRaisesRegex(ValueError, "no requests"):
+      build_engines.make_input_fn([], input_specs)
+    with self.assertRaisesRegex(ValueError, "has inputs"):
+      build_engines.make_input_fn([{"y": (1, 16)}], input_specs)
+    with self.assertRaisesRegex(ValueError, "not compatible"):
+      build_engines.make_input_fn([{"x": (1, 8)}], input_specs)
+
+
+if __name__ == "__main__":
+  test.main()
@@ -534,6 +534,54 @@ class CsvDatasetTest(test_base.DatasetTestBase, parameterized.TestCase):
     self._test_dataset_on_buffer_sizes(
         inputs, expected, linebreak='\r\n', record_defaults=record_defaults)
 
+  def _test_dataset_on_block_boundaries(self, inputs, expected, linebreak,
+                                        **kwargs):
+    # The parser scans its buffer in blocks of 64 bytes. Test records that are
+    # longer than a block with buffers that are shorter than a record, and with
+    # buffers that end just before, on and just after a block boundary.
+    for buffer_size in [1, 7, 63, 64, 65, 100, 128, None]:
+      self._test_dataset(
+          inputs,
+          expected,
+          linebreak=linebreak,
+          buffer_size=buffer_size,
+          **kwargs)
+
+  @combinations.generate(test_base.default_test_combinations())
+  def testWithFieldsAcrossBlockBoundaries(self):
+    record_defaults = [['NA']] * 3
+    inputs = [['a' * 62 + ',b,' + 'c' * 70, ',' * 2, 'd' * 63 + ',' + 'e' * 64 +
+               ',f']]
+    expected = [['a' * 62, 'b', 'c' * 70], ['NA', 'NA', 'NA'],
+                ['d' * 63, 'e' * 64, 'f']]
+    for linebreak in ['\n', '\r', '\r\n']:
+      self._test_dataset_on_block_boundaries(
+          inputs, expected, linebreak, record_defaults=record_defaults)
+
+  @combinations.generate(test_base.default_test_combinations())
+  def testWithQuotedFieldsAcrossBlockBoundaries(self):
+    record_defaults = [['NA']] * 3
+    inputs = [['a' * 60 + ',"' + 'b' * 30 + '\r\n' + 'b' * 30 + '""",' +
+               '"c,c"', '"' + 'd' * 63 + '",,"' + '""' * 40 + '"']]
+    expected = [['a' * 60, 'b' * 30 + '\r\n' + 'b' * 30 + '"', 'c,c'],
+                ['d' * 63, 'NA', '"' * 40]]
+    for linebreak in ['\n', '\r\n']:
+      self._test_dataset_on_block_boundaries(
+          inputs, expected, linebreak, record_defaults=record_defaults)
+
+  @combinations.generate(test_base.default_test_combinations())
+  def testWithUseQuoteDelimFalseAcrossBlockBoundaries(self):
+    record_defaults = [['NA']] * 2
+    inputs = [['"' * 63 + ',' + 'a"' * 40, 'b' * 64 + ',"c"']]
+    expected = [['"' * 63, 'a"' * 40], ['b' * 64, '"c"']]
+    for linebreak in ['\n', '\r\n']:
+      self._test_dataset_on_block_boundaries(
+          inputs,
+          expected,
+          linebreak,
+          record_defaults=record_defaults,
+          use_quote_delim=False)
+
   @combinations.generate(test_base.default_test_combinations())
   def testWithGzipCompressionType(self):
     record_defaults = [['NA']] * 3
@@ -20,6 +20,7 @@ from tensorflow.core.lib.core import error_codes_pb2
 from tensorflow.python.data.kernel_tests import checkpoint_test_base
 from tensorflow.python.data.kernel_tests import test_base
 from tensorflow.python.data.ops import dataset_ops
+from tensorflow.python.data.ops import group_by_window_op
 from tensorflow.python.framework import combinations
 from tensorflow.python.framework import constant_op
 from tensorflow.python.framework import dtypes
@@ -341,6 +342,31 @@ class GroupByWindowTest(test_base.DatasetTestBase, parameterized.TestCase):
         window_size=4)
     self.assertEqual(self.evaluate(dataset.cardinality()), dataset_ops.INFINITE)
 
+  @combinations.generate(
+      combinations.times(
+          test_base.default_test_combinations(),
+          combinations.combine(
+              eviction_policy=["largest", "oldest"])))
+  def testMaxBufferedBytes(self, eviction_policy):
+    components = np.array([0, 1, 1, 1, 2, 2], dtype=np.int64)
+    dataset = dataset_ops.Dataset.from_tensor_slices(components)
+    # Each element takes 8 bytes, so three elements fit into the budget.
+    dataset = group_by_window_op._group_by_window(
+        dataset,
+        key_func=lambda x: x,
+        reduce_func=lambda _, xs: xs.batch(4),
+        window_size=4,
+        max_buffered_bytes=24,
+        eviction_policy=eviction_policy)
+    if eviction_policy == "largest":
+      # The fourth element evicts the group of 1s. The remaining groups are
+      # flushed in key order at the end of the input.
+      expected_output = [[1, 1, 1], [0], [2, 2]]
+    else:
+      # The fourth element evicts the group of 0s, the sixth the group of 1s.
+      expected_output = [[0], [1, 1, 1], [2, 2]]
+    self.assertDatasetProduces(dataset, expected_output=expected_output)
+
   @combinations.generate(test_base.default_test_combinations())
   def testName(self):
     dataset = dataset_ops.Dataset.from_tensors(np.int64(42)).group_by_window(
@@ -1547,6 +1547,10 @@ class DatasetV2(
       filename: A `tf.string` scalar `tf.Tensor`, representing the name of a
         directory on the filesystem to use for caching elements in this Dataset.
         If a filename is not provided, the dataset will be cached in memory.
+        If the filename is of the form `"mmap://<directory>"`, the elements
+        are cached in a file in `<directory>` named after the fingerprint of
+        the dataset, which is read through a memory mapping so that the
+        processes of a host that cache the same dataset share its memory.
       name: (Optional.) A name for the tf.data operation.
 
     Returns:
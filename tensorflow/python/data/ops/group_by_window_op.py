@@ -27,8 +27,28 @@ def _group_by_window(input_dataset,  # pylint: disable=unused-private-name
                      reduce_func,
                      window_size=None,
                      window_size_func=None,
+                     max_buffered_bytes=None,
+                     eviction_policy=None,
                      name=None):
-  """See `Dataset.group_by_window()` for details."""
+  """See `Dataset.group_by_window()` for details.
+
+  Args:
+    input_dataset: The input dataset.
+    key_func: See `Dataset.group_by_window()`.
+    reduce_func: See `Dataset.group_by_window()`.
+    window_size: See `Dataset.group_by_window()`.
+    window_size_func: See `Dataset.group_by_window()`.
+    max_buffered_bytes: (Optional.) The maximum number of bytes of incomplete
+      groups to buffer. When they exceed it, an incomplete group is passed to
+      `reduce_func` early. `tf.data.AUTOTUNE` uses a share of the RAM budget of
+      the input pipeline. Defaults to no limit.
+    eviction_policy: (Optional.) Which incomplete group to pass to
+      `reduce_func` early: "largest" (the default) or "oldest".
+    name: (Optional.) A name for the tf.data operation.
+
+  Returns:
+    A `Dataset`.
+  """
 
   if (window_size is not None and window_size_func or
       not (window_size is not None or window_size_func)):
@@ -45,7 +65,13 @@ def _group_by_window(input_dataset,  # pylint: disable=unused-private-name
   assert window_size_func is not None
 
   return _GroupByWindowDataset(
-      input_dataset, key_func, reduce_func, window_size_func, name=name)
+      input_dataset,
+      key_func,
+      reduce_func,
+      window_size_func,
+      max_buffered_bytes=max_buffered_bytes,
+      eviction_policy=eviction_policy,
+      name=name)
 
 
 class _GroupByWindowDataset(dataset_ops.UnaryDataset):
@@ -56,6 +82,8 @@ class _GroupByWindowDataset(dataset_ops.UnaryDataset):
                key_func,
                reduce_func,
                window_size_func,
+               max_buffered_bytes=None,
+               eviction_policy=None,
                name=None):
     """See `group_by_window()` for details."""
     self._input_dataset = input_dataset
@@ -63,6 +91,11 @@ class _GroupByWindowDataset(dataset_ops.UnaryDataset):
     self._make_reduce_func(reduce_func, input_dataset)
     self._make_window_size_func(window_size_func)
     self._name = name
+    memory_budget_args = {}
+    if max_buffered_bytes is not None:
+      memory_budget_args["max_buffered_bytes"] = max_buffered_bytes
+    if eviction_policy is not None:
+      memory_budget_args["eviction_policy"] = eviction_policy
     variant_tensor = ged_ops.group_by_window_dataset(
         self._input_dataset._variant_tensor,  # pylint: disable=protected-access
         self._key_func.function.captured_inputs,
@@ -71,6 +104,7 @@ class _GroupByWindowDataset(dataset_ops.UnaryDataset):
         key_func=self._key_func.function,
         reduce_func=self._reduce_func.function,
         window_size_func=self._window_size_func.function,
+        **memory_budget_args,
         **self._common_args)
     super().__init__(input_dataset, variant_tensor)
 
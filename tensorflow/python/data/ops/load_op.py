@@ -51,12 +51,6 @@ def _load(  # pylint: disable=unused-private-name
   if wait:
     return _load_with_retry(path, element_spec, compression, reader_func)
 
-  if reader_func is None:
-    reader_func = lambda datasets: datasets.interleave(  # pylint:disable=g-long-lambda
-        lambda x: x,
-        cycle_length=multiprocessing.cpu_count(),
-        num_parallel_calls=dataset_ops.AUTOTUNE)
-
   distributed_snapshot_metadata = _load_distributed_snapshot_metadata(path)
   if distributed_snapshot_metadata:
     _validate_snapshot(
@@ -64,6 +58,12 @@ def _load(  # pylint: disable=unused-private-name
     return _load_distributed_snapshot(
         path, distributed_snapshot_metadata, reader_func)
 
+  if reader_func is None:
+    reader_func = lambda datasets: datasets.interleave(  # pylint:disable=g-long-lambda
+        lambda x: x,
+        cycle_length=multiprocessing.cpu_count(),
+        num_parallel_calls=dataset_ops.AUTOTUNE)
+
   if element_spec is None:
     element_spec = _load_element_spec(path)
   return _LoadDataset(path, element_spec, compression, reader_func)
@@ -125,9 +125,19 @@ def _load_distributed_snapshot_metadata(
 def _load_distributed_snapshot(
     path: str,
     metadata: snapshot_pb2.DistributedSnapshotMetadata,
-    reader_func: Callable[[dataset_ops.Dataset], dataset_ops.Dataset],
+    reader_func: Optional[Callable[[dataset_ops.Dataset], dataset_ops.Dataset]],
 ) -> dataset_ops.Dataset:
-  """Loads a distributed snapshot."""
+  """Loads a distributed snapshot.
+
+  If `reader_func` is None, reads the chunks in order, prefetching the next
+  chunks in parallel.
+  """
+
+  if reader_func is None:
+    return _ReadSnapshotChunksDataset(
+        path,
+        element_spec=_parse_element_spec(metadata.element_spec),
+        compression=metadata.compression)
 
   dataset = _ListSnapshotChunksDataset(path)
   dataset = dataset.map(
@@ -223,6 +233,27 @@ class _SnapshotChunkDataset(dataset_ops.DatasetSource):
     return self._element_spec
 
 
+class _ReadSnapshotChunksDataset(dataset_ops.DatasetSource):
+  """A dataset for reading the chunk files of a tf.data distributed snapshot.
+
+  It reads the chunks in the order of `_ListSnapshotChunksDataset`, prefetching
+  and decompressing the next chunks in parallel.
+  """
+
+  def __init__(self, snapshot_path: str, element_spec: Any, compression: str):
+    self._snapshot_path = snapshot_path
+    self._element_spec = element_spec
+    variant_tensor = ged_ops.read_snapshot_chunks_dataset(
+        snapshot_path,
+        compression=compression,
+        **self._flat_structure)
+    super().__init__(variant_tensor)
+
+  @property
+  def element_spec(self) -> Any:
+    return self._element_spec
+
+
 class _ListSnapshotChunksDataset(dataset_ops.DatasetSource):
   """A dataset for listing snapshot chunk files.
 
@@ -594,6 +594,16 @@ class Options(options_lib.OptionsBase):
       "`tf.data.experimental.OptimizationOptions` for more details.",
       default_factory=OptimizationOptions)
 
+  experimental_reorder_buffer_bytes = options_lib.create_option(
+      name="experimental_reorder_buffer_bytes",
+      ty=int,
+      docstring="If positive, deterministic parallel `map` transformations "
+      "keep invoking the map function while a slow element blocks the output, "
+      "buffering elements that complete out of order in a reorder window of up "
+      "to this many bytes. The output order stays deterministic unless the "
+      "window fills up, in which case completed elements are produced out of "
+      "order. If None, defaults to 0, which disables the reorder window.")
+
   experimental_slack = options_lib.create_option(
       name="experimental_slack",
       ty=bool,
@@ -693,6 +703,8 @@ class Options(options_lib.OptionsBase):
           ExternalStatePolicy._to_proto(  # pylint: disable=protected-access
               self.experimental_external_state_policy))
     pb.optimization_options.CopyFrom(self.experimental_optimization._to_proto())  # pylint: disable=protected-access
+    if self.experimental_reorder_buffer_bytes is not None:
+      pb.reorder_buffer_bytes = self.experimental_reorder_buffer_bytes
     if self.experimental_slack is not None:
       pb.slack = self.experimental_slack
     if self.experimental_symbolic_checkpoint is not None:
@@ -717,6 +729,8 @@ class Options(options_lib.OptionsBase):
           ExternalStatePolicy._from_proto(  # pylint: disable=protected-access
               pb.external_state_policy))
     self.experimental_optimization._from_proto(pb.optimization_options)  # pylint: disable=protected-access
+    if pb.WhichOneof("optional_reorder_buffer_bytes") is not None:
+      self.experimental_reorder_buffer_bytes = pb.reorder_buffer_bytes
     if pb.WhichOneof("optional_slack") is not None:
       self.experimental_slack = pb.slack
     if pb.WhichOneof("optional_symbolic_checkpoint") is not None:
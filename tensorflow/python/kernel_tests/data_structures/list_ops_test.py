@@ -432,6 +432,65 @@ class ListOpsTest(test_util.TensorFlowTestCase, parameterized.TestCase):
     dl_length = list_ops.tensor_list_length(dl)
     self.assertAllEqual(self.evaluate(dl_length), 3)
 
+  def testStackAndGatherBufferedElements(self):
+    # Elements of 64 bytes are stored in the buffer of the list on CPU.
+    with context.device("cpu:0"):
+      elements = [
+          math_ops.range(16 * i, 16 * (i + 1), dtype=dtypes.int32)
+          for i in range(10)
+      ]
+      l = list_ops.empty_tensor_list(
+          element_dtype=dtypes.int32, element_shape=[16])
+      for e in elements:
+        l = list_ops.tensor_list_push_back(l, e)
+      # Both lists share the buffer of `l`, but only one can store its last
+      # element in it.
+      a = constant_op.constant(1, shape=[16])
+      b = constant_op.constant(2, shape=[16])
+      l_a = list_ops.tensor_list_push_back(l, a)
+      l_b = list_ops.tensor_list_push_back(l, b)
+      stacked = [
+          list_ops.tensor_list_stack(x, element_dtype=dtypes.int32)
+          for x in (l, l_a, l_b)
+      ]
+      gathered = [
+          list_ops.tensor_list_gather(l_a, indices, element_dtype=dtypes.int32)
+          for indices in ([3, 4, 5], [5, 3], [10])
+      ]
+      l_c = list_ops.tensor_list_set_item(l_a, 2, b)
+      stacked_c = list_ops.tensor_list_stack(l_c, element_dtype=dtypes.int32)
+
+      expected = self.evaluate(array_ops_stack.stack(elements))
+      stacked, gathered, stacked_c = self.evaluate(
+          (stacked, gathered, stacked_c))
+      self.assertAllEqual(stacked[0], expected)
+      self.assertAllEqual(stacked[1], np.concatenate([expected, [[1] * 16]]))
+      self.assertAllEqual(stacked[2], np.concatenate([expected, [[2] * 16]]))
+      self.assertAllEqual(gathered[0], expected[3:6])
+      self.assertAllEqual(gathered[1], expected[[5, 3]])
+      self.assertAllEqual(gathered[2], [[1] * 16])
+      expected[2] = 2
+      self.assertAllEqual(stacked_c, np.concatenate([expected, [[1] * 16]]))
+
+  def testSetItemInWhileLoopBufferedElements(self):
+    with context.device("cpu:0"):
+
+      @def_function.function
+      def f(n):
+        l = list_ops.tensor_list_reserve(
+            element_dtype=dtypes.float32, element_shape=[4, 4], num_elements=n)
+
+        def body(i, l):
+          e = array_ops.fill([4, 4], math_ops.cast(i, dtypes.float32))
+          return i + 1, list_ops.tensor_list_set_item(l, i, e)
+
+        _, l = while_loop.while_loop(lambda i, _: i < n, body, (0, l))
+        return list_ops.tensor_list_stack(l, element_dtype=dtypes.float32)
+
+      expected = np.tile(
+          np.arange(20, dtype=np.float32).reshape([20, 1, 1]), [1, 4, 4])
+      self.assertAllEqual(self.evaluate(f(20)), expected)
+
   def _testGatherWithUninitializedTensors(self):
     l = list_ops.tensor_list_reserve(
         element_dtype=dtypes.float32, element_shape=[], num_elements=3)
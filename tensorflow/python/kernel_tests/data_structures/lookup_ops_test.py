@@ -4228,8 +4228,54 @@ class MutableHashTableOpTest(test.TestCase):
 
 class MutableHashTableBenchmark(test.Benchmark):
 
-  def _create_table(self):
-    return lookup_ops.MutableHashTable(dtypes.int64, dtypes.float32, 0.0)
+  def _create_table(self, key_dtype=dtypes.int64):
+    return lookup_ops.MutableHashTable(key_dtype, dtypes.float32, 0.0)
+
+  def _benchmark_lookup(self, key_dtype, hit_rate, num_entries=1 << 20,
+                        batch_size=4096):
+    """Benchmarks batched lookups of random keys into a populated table."""
+    table = self._create_table(key_dtype)
+    rng = np.random.RandomState(0)
+    # Keys in [0, num_entries) are in the table, those above are misses.
+    present = rng.randint(0, num_entries, size=batch_size)
+    absent = rng.randint(num_entries, 2 * num_entries, size=batch_size)
+    keys = np.where(rng.uniform(size=batch_size) < hit_rate, present, absent)
+    all_keys = np.arange(num_entries)
+    if key_dtype == dtypes.string:
+      keys = keys.astype(np.str_).astype(object)
+      all_keys = all_keys.astype(np.str_).astype(object)
+    insert = table.insert(
+        constant_op.constant(all_keys, key_dtype),
+        constant_op.constant(np.ones(num_entries), dtypes.float32))
+    lookup = table.lookup(constant_op.constant(keys, key_dtype))
+    with session.Session() as sess:
+      sess.run(insert)
+      self.run_op_benchmark(
+          sess,
+          lookup.op,
+          burn_iters=10,
+          min_iters=100,
+          name="%s_lookup_%s_hit_rate_%d" %
+          (type(self).__name__, key_dtype.name, int(100 * hit_rate)),
+          extras={"batch_size": batch_size, "num_entries": num_entries})
+
+  def benchmark_lookup_int64_all_hits(self):
+    self._benchmark_lookup(dtypes.int64, hit_rate=1.0)
+
+  def benchmark_lookup_int64_half_hits(self):
+    self._benchmark_lookup(dtypes.int64, hit_rate=0.5)
+
+  def benchmark_lookup_int64_no_hits(self):
+    self._benchmark_lookup(dtypes.int64, hit_rate=0.0)
+
+  def benchmark_lookup_string_all_hits(self):
+    self._benchmark_lookup(dtypes.string, hit_rate=1.0)
+
+  def benchmark_lookup_string_half_hits(self):
+    self._benchmark_lookup(dtypes.string, hit_rate=0.5)
+
+  def benchmark_lookup_string_no_hits(self):
+    self._benchmark_lookup(dtypes.string, hit_rate=0.0)
 
   def benchmark_single_repeated_scalar_insert_scalar(self):
     table = self._create_table()
@@ -4276,9 +4322,16 @@ class MutableHashTableBenchmark(test.Benchmark):
 
 class DenseHashTableBenchmark(MutableHashTableBenchmark):
 
-  def _create_table(self):
+  def _create_table(self, key_dtype=dtypes.int64):
+    if key_dtype == dtypes.string:
+      return lookup_ops.DenseHashTable(
+          dtypes.string,
+          dtypes.float32,
+          default_value=0.0,
+          empty_key="",
+          deleted_key="$")
     return lookup_ops.DenseHashTable(
-        dtypes.int64,
+        key_dtype,
         dtypes.float32,
         default_value=0.0,
         empty_key=-1,
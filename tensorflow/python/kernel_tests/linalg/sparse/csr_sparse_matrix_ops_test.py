@@ -827,6 +827,34 @@ class CSRSparseMatrixOpsTest(test.TestCase, parameterized.TestCase):
 
             self.assertAllClose(c_sm_dense_value, c_dense_t_value)
 
+  @test_util.run_in_graph_and_eager_modes
+  def testLargeSparseMatrixSparseMatMul(self):
+    # A single matrix whose product has more rows than a batch, to exercise
+    # the multiplication parallelized across rows, with both dense and hashed
+    # row accumulators.
+    for a_dense_shape, b_dense_shape, density in (([513, 700], [700, 300],
+                                                   0.02),
+                                                  ([300, 200], [200, 20000],
+                                                   0.001)):
+      for dtype in (np.float32, np.complex64):
+        a_mat = sparse.random(*a_dense_shape, density=density, format="csr")
+        b_mat = sparse.random(*b_dense_shape, density=density, format="csr")
+        a_dense = a_mat.toarray().astype(dtype)
+        b_dense = b_mat.toarray().astype(dtype)
+        if dtype == np.complex64:
+          a_dense += 1j * a_dense[::-1]
+          b_dense -= 1j * b_dense[:, ::-1]
+
+        a_sm = dense_to_csr_sparse_matrix(a_dense)
+        b_sm = dense_to_csr_sparse_matrix(b_dense)
+        c_sm = sparse_csr_matrix_ops.sparse_matrix_sparse_mat_mul(
+            a_sm, b_sm, type=dtypes.as_dtype(dtype))
+        c_sm_dense = sparse_csr_matrix_ops.csr_sparse_matrix_to_dense(
+            c_sm, dtypes.as_dtype(dtype))
+        c_sm_dense_value = self.evaluate(c_sm_dense)
+
+        self.assertAllClose(c_sm_dense_value, np.matmul(a_dense, b_dense))
+
   @test_util.run_in_graph_and_eager_modes
   def testLargeBatchRegisteredAddN(self):
     if not self._gpu_available:
@@ -1574,6 +1602,34 @@ class CSRSparseMatrixOpsBenchmark(test.Benchmark):
                   },
                   min_iters=50)
 
+  def benchmark_large_sparse_matrix_sparse_matmul(self):
+    # With a single thread, the product is computed by Eigen's sparse-sparse
+    # matmul. With more threads, the rows of the product are computed in
+    # parallel.
+    for n, density in ((10000, 0.001), (100000, 0.0001)):
+      for num_threads in [1, 4, 12]:
+        with ops.Graph().as_default(), ops.device(CPU):
+          # The indices of a CSR matrix converted to COO are sorted.
+          x_mat = sparse.random(
+              n, n, density=density, format="csr", dtype=np.float32).tocoo()
+          indices = np.stack([x_mat.row, x_mat.col], axis=1).astype(np.int64)
+          x_sm = sparse_csr_matrix_ops.sparse_tensor_to_csr_sparse_matrix(
+              indices, x_mat.data, [n, n])
+
+          xx_sparse = sparse_csr_matrix_ops.sparse_matrix_sparse_mat_mul(
+              x_sm, x_sm, type=dtypes.float32)
+
+          with session.Session(
+              config=config_pb2.ConfigProto(
+                  intra_op_parallelism_threads=num_threads)) as sess:
+            self.run_op_benchmark(
+                sess,
+                xx_sparse.op,
+                name="large_sparse_matrix_sparse_matmul_cpu_N_%d_threads_%d" %
+                (n, num_threads),
+                extras={"num_nonzero": x_mat.nnz},
+                min_iters=10)
+
   def benchmark_sparse_dense_conversion(self):
     sparsity = 0.05
 
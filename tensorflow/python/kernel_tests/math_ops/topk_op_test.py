@@ -183,6 +183,26 @@ class TopKTest(test.TestCase):
     self._testMediumTopK(np.float16)
     self._testMediumTopK(dtypes.bfloat16.as_numpy_dtype)
 
+  def _testLongRowTopK(self, b, n, k, dtype):
+    # Few distinct values, so that the threshold of the filtered top-k of long
+    # rows is tied with many other values.
+    inputs = np.random.randint(0, 1000, size=(b, n)).astype(dtype)
+    indices = np.argsort(-inputs, axis=1, kind="mergesort")[:, :k]
+    values = -np.sort(-inputs, axis=1)[:, :k]
+    self._validateTopK(inputs, k, values, indices)
+
+  def testLongRowTopK(self):
+    for dtype in [np.int32, np.float32]:
+      # Fewer rows than threads split each row, more rows split the rows.
+      self._testLongRowTopK(2, 100000, 10, dtype)
+      self._testLongRowTopK(64, 8192, 100, dtype)
+
+  def testLongRowTopKAllEqual(self):
+    # Every value passes the threshold, the lowest indices win.
+    inputs = np.ones((3, 5000), dtype=np.float32)
+    self._validateTopK(inputs, 5, np.ones((3, 5)),
+                       np.tile(np.arange(5), (3, 1)))
+
   def testStableSort(self):
     b = 5
     n = 500
@@ -45,6 +45,18 @@ class StringToHashBucketOpTest(test.TestCase):
       # Fingerprint64('d') -> 4470636696479570465 -> mod 10 -> 5
       self.assertAllEqual([9, 2, 2, 5], result)
 
+  def testStringToHashBucketsFastLargeBatch(self):
+    with self.cached_session():
+      # Mixes strings stored inline in their tstring with heap allocated ones,
+      # over enough elements to be hashed in several shards.
+      long_string = 'x' * 100
+      expected = self.evaluate(
+          string_ops.string_to_hash_bucket_fast(
+              ['a', 'b', 'c', 'd', long_string], 10))
+      output = string_ops.string_to_hash_bucket_fast(
+          ['a', 'b', 'c', 'd', long_string] * 10000, 10)
+      self.assertAllEqual(list(expected) * 10000, self.evaluate(output))
+
   @test_util.run_deprecated_v1
   def testStringToOneHashBucketLegacyHash(self):
     with self.cached_session():
@@ -154,7 +154,10 @@ def _tf_repositories():
         strip_prefix = "XNNPACK-50037f8072731a2cc30a961b96e199ad691887e4",
         urls = tf_mirror_urls("https://github.com/google/XNNPACK/archive/50037f8072731a2cc30a961b96e199ad691887e4.zip"),
     )
-    # LINT.ThenChange(//tensorflow/lite/tools/cmake/modules/xnnpack.cmake)
+    # LINT.ThenChange(
+    #     //tensorflow/lite/tools/cmake/modules/xnnpack.cmake,
+    #     //tensorflow/lite/delegates/xnnpack/weight_cache.h
+    # )
 
     tf_http_archive(
         name = "FXdiv",
@@ -380,6 +380,30 @@ bool CPUAllocatorStatsEnabled();
 void EnableCPUAllocatorFullStats();
 bool CPUAllocatorFullStatsEnabled();
 
+// Serves allocations of at least `threshold_bytes` made by the default CPU
+// allocator implementation from memory that is backed by huge pages (see
+// `port::HugePageMalloc()`). A threshold of 0 disables huge pages. The initial
+// threshold is read from the TF_CPU_ALLOCATOR_HUGE_PAGE_THRESHOLD_BYTES
+// environment variable, and is 0 by default. If TF_CPU_ALLOCATOR_USE_HUGETLB
+// is set to 1, explicitly reserved huge pages are preferred over transparent
+// huge pages.
+void SetCPUAllocatorHugePageThreshold(size_t threshold_bytes);
+size_t CPUAllocatorHugePageThreshold();
+
+// Statistics about the live allocations that the default CPU allocator
+// implementation serves from huge pages.
+struct CPUAllocatorHugePageStats {
+  int64_t num_allocs = 0;
+  // The number of bytes mapped for these allocations, which are rounded up to
+  // a multiple of the huge page size.
+  int64_t bytes_in_use = 0;
+  // The part of `bytes_in_use` that was placed in, or marked as eligible for,
+  // huge pages. This is less than `bytes_in_use` if the platform does not
+  // support huge pages, or if they are disabled.
+  int64_t huge_page_bytes_in_use = 0;
+};
+CPUAllocatorHugePageStats GetCPUAllocatorHugePageStats();
+
 // An object that does the underlying suballoc/free of memory for a higher-level
 // allocator.  The expectation is that the higher-level allocator is doing some
 // kind of cache or pool management so that it will call SubAllocator::Alloc and
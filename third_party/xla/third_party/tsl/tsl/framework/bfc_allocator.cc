@@ -22,7 +22,9 @@ limitations under the License.
 
 #include "absl/strings/string_view.h"
 #include "tsl/framework/allocator_retry.h"
+#include "tsl/framework/metrics.h"
 #include "tsl/lib/core/bits.h"
+#include "tsl/platform/env.h"
 #include "tsl/platform/file_system.h"
 #include "tsl/platform/logging.h"
 #include "tsl/platform/mutex.h"
@@ -39,6 +41,60 @@ namespace tsl {
 
 constexpr BFCAllocator::ChunkHandle BFCAllocator::kInvalidChunkHandle;
 
+namespace {
+
+uint64 NextAllocatorId() {
+  static std::atomic<uint64> next_id{0};
+  return next_id.fetch_add(1, std::memory_order_relaxed);
+}
+
+}  // namespace
+
+// A cache of small free chunks, owned by one thread. Its lock is only
+// contended when the chunks of all caches are returned to the bins. The cache
+// is shared by the thread and the allocator, so that either may go away first.
+class BFCAllocator::ThreadCache {
+ public:
+  static_assert(kNumThreadCacheClasses * kMinAllocationSize ==
+                    kMaxThreadCachedChunkBytes,
+                "Thread cache classes must cover all cached chunk sizes");
+
+  mutex mu;
+  // The cached chunks of each class, from the least to the most recently
+  // freed.
+  std::vector<void*> chunks[kNumThreadCacheClasses] TF_GUARDED_BY(mu);
+  // The smallest number of chunks in each class since the last scavenge.
+  size_t low_water_mark[kNumThreadCacheClasses] TF_GUARDED_BY(mu) = {};
+  int64_t num_ops TF_GUARDED_BY(mu) = 0;
+  // Set when the owning thread exits. The allocator then returns the chunks to
+  // the bins and drops the cache.
+  bool orphaned TF_GUARDED_BY(mu) = false;
+
+  // Moves all the cached chunks to `*to_free`.
+  void TakeAll(std::vector<void*>* to_free) TF_EXCLUSIVE_LOCKS_REQUIRED(mu) {
+    for (int c = 0; c < kNumThreadCacheClasses; ++c) {
+      std::vector<void*>& cached = chunks[c];
+      to_free->insert(to_free->end(), cached.begin(), cached.end());
+      cached.clear();
+      low_water_mark[c] = 0;
+    }
+  }
+
+  // Every kThreadCacheScavengePeriod operations, moves the chunks that were
+  // not used since the previous scavenge to `*to_free`.
+  void MaybeScavenge(std::vector<void*>* to_free)
+      TF_EXCLUSIVE_LOCKS_REQUIRED(mu) {
+    if (++num_ops % kThreadCacheScavengePeriod != 0) return;
+    for (int c = 0; c < kNumThreadCacheClasses; ++c) {
+      std::vector<void*>& cached = chunks[c];
+      const size_t n = std::min(low_water_mark[c], cached.size());
+      to_free->insert(to_free->end(), cached.begin(), cached.begin() + n);
+      cached.erase(cached.begin(), cached.begin() + n);
+      low_water_mark[c] = cached.size();
+    }
+  }
+};
+
 BFCAllocator::BFCAllocator(std::unique_ptr<SubAllocator> sub_allocator,
                            size_t total_memory, const string& name,
                            const Options& opts)
@@ -46,8 +102,12 @@ BFCAllocator::BFCAllocator(std::unique_ptr<SubAllocator> sub_allocator,
       coalesce_regions_(sub_allocator->SupportsCoalescing()),
       sub_allocator_(std::move(sub_allocator)),
       name_(name),
+      id_(NextAllocatorId()),
       free_chunks_list_(kInvalidChunkHandle),
       next_allocation_id_(1) {
+  if (opts.thread_local_cache) {
+    small_chunk_shards_.reset(new SmallChunkShard[kNumSmallChunkShards]);
+  }
   if (opts.allow_growth) {
     // 2MiB smallest initial allocation, unless total memory available
     // is less.
@@ -66,6 +126,8 @@ BFCAllocator::BFCAllocator(std::unique_ptr<SubAllocator> sub_allocator,
   memory_limit_ = total_memory;
   stats_.bytes_limit = static_cast<int64_t>(total_memory);
 
+  MaybeLoadAllocationProfile(total_memory);
+
   // Create a bunch of bins of various good sizes.
 
   // We create bins to fit all possible ranges that cover the
@@ -328,26 +390,9 @@ bool BFCAllocator::DeallocateFreeRegions(size_t rounded_bytes)
   }
 
   // Searching for free regions.
-  absl::flat_hash_set<void*> free_region_ptrs;
   size_t total_free_bytes = 0;
-  for (const AllocationRegion& region : region_manager_.regions()) {
-    ChunkHandle h = region_manager_.get_handle(region.ptr());
-    bool any_use = false;
-    while (h != kInvalidChunkHandle) {
-      const Chunk* c = ChunkFromHandle(h);
-      if (c->in_use()) {
-        any_use = true;
-        break;
-      }
-      h = c->next;
-    }
-
-    if (!any_use) {
-      VLOG(2) << "Found free region with ptr = " << region.ptr();
-      free_region_ptrs.insert(region.ptr());
-      total_free_bytes += region.memory_size();
-    }
-  }
+  absl::flat_hash_set<void*> free_region_ptrs =
+      FindFreeRegions(&total_free_bytes);
 
   if (total_free_bytes == 0) {
     return false;
@@ -376,6 +421,156 @@ bool BFCAllocator::DeallocateFreeRegions(size_t rounded_bytes)
   return true;
 }
 
+absl::flat_hash_set<void*> BFCAllocator::FindFreeRegions(
+    size_t* total_free_bytes) {
+  absl::flat_hash_set<void*> free_region_ptrs;
+  *total_free_bytes = 0;
+  for (const AllocationRegion& region : region_manager_.regions()) {
+    ChunkHandle h = region_manager_.get_handle(region.ptr());
+    bool any_use = false;
+    while (h != kInvalidChunkHandle) {
+      const Chunk* c = ChunkFromHandle(h);
+      if (c->in_use()) {
+        any_use = true;
+        break;
+      }
+      h = c->next;
+    }
+
+    if (!any_use) {
+      VLOG(2) << "Found free region with ptr = " << region.ptr();
+      free_region_ptrs.insert(region.ptr());
+      *total_free_bytes += region.memory_size();
+    }
+  }
+  return free_region_ptrs;
+}
+
+void BFCAllocator::OnStepBoundary() {
+  const uint64 now_micros = Env::Default()->NowMicros();
+  uint64 next_micros =
+      next_step_boundary_micros_.load(std::memory_order_relaxed);
+  if (now_micros < next_micros ||
+      !next_step_boundary_micros_.compare_exchange_strong(
+          next_micros, now_micros + kStepBoundaryIntervalMicros)) {
+    return;
+  }
+  if (opts_.compact_free_regions) {
+    CompactFreeRegions();
+  }
+  ExportFragmentationMetrics();
+  MaybeWriteAllocationProfile();
+}
+
+void BFCAllocator::MaybeLoadAllocationProfile(size_t total_memory) {
+  const char* profile_prefix = std::getenv("TF_BFC_ALLOCATION_PROFILE");
+  if (profile_prefix == nullptr) return;
+  allocation_profile_path_ = strings::StrCat(profile_prefix, "_", Name());
+  if (!opts_.allow_growth ||
+      !Env::Default()->FileExists(allocation_profile_path_).ok()) {
+    return;
+  }
+
+  MemoryDump profile;
+  Status status =
+      ReadBinaryProto(Env::Default(), allocation_profile_path_, &profile);
+  if (!status.ok() || profile.allocator_name() != Name()) {
+    LOG(WARNING) << "Ignoring the allocation profile "
+                 << allocation_profile_path_ << ": " << status;
+    return;
+  }
+  const size_t peak_pool_bytes = std::min<size_t>(
+      std::max<int64_t>(profile.stats().peak_pool_bytes(), 0), total_memory);
+  if (peak_pool_bytes > curr_region_allocation_bytes_) {
+    VLOG(1) << "Sizing the first region of " << Name() << " to "
+            << strings::HumanReadableNumBytes(peak_pool_bytes)
+            << " from its allocation profile.";
+    curr_region_allocation_bytes_ = RoundedBytes(peak_pool_bytes);
+  }
+}
+
+void BFCAllocator::MaybeWriteAllocationProfile() {
+  if (allocation_profile_path_.empty()) return;
+  MemoryDump profile;
+  {
+    mutex_lock l(lock_);
+    if (*stats_.peak_pool_bytes <= profiled_peak_pool_bytes_) return;
+    profiled_peak_pool_bytes_ = *stats_.peak_pool_bytes;
+    profile = RecordAllocationProfileInternal();
+  }
+  // Write to a temporary file first, so that a job that is preempted while
+  // writing does not leave a truncated profile.
+  const string tmp_path = strings::StrCat(allocation_profile_path_, ".tmp");
+  Status status = WriteBinaryProto(Env::Default(), tmp_path, profile);
+  if (status.ok()) {
+    status = Env::Default()->RenameFile(tmp_path, allocation_profile_path_);
+  }
+  if (!status.ok()) {
+    LOG(ERROR) << "Failed to write the allocation profile to "
+               << allocation_profile_path_ << ": " << status;
+  }
+}
+
+bool BFCAllocator::CompactFreeRegions() {
+  mutex_lock l(lock_);
+  if (!timestamped_chunks_.empty()) {
+    return false;
+  }
+  FlushThreadCaches();
+  size_t total_free_bytes = 0;
+  absl::flat_hash_set<void*> free_region_ptrs =
+      FindFreeRegions(&total_free_bytes);
+  if (free_region_ptrs.size() < 2) {
+    return false;
+  }
+
+  VLOG(1) << "Compacting " << free_region_ptrs.size() << " free regions of "
+          << strings::HumanReadableNumBytes(total_free_bytes) << " in "
+          << Name();
+  DeallocateRegions(free_region_ptrs);
+  // Allocate a region of exactly the freed size, without changing the size of
+  // the regions that are allocated when the pool grows.
+  const size_t rounded_bytes = RoundedBytes(total_free_bytes);
+  const size_t region_allocation_bytes = curr_region_allocation_bytes_;
+  curr_region_allocation_bytes_ = rounded_bytes;
+  const bool extended = Extend(Allocator::kAllocatorAlignment, rounded_bytes);
+  curr_region_allocation_bytes_ = region_allocation_bytes;
+  if (!extended) {
+    // The memory is allocated again when it is needed.
+    VLOG(1) << "Could not allocate a region of "
+            << strings::HumanReadableNumBytes(rounded_bytes)
+            << " after compaction in " << Name();
+  }
+  metrics::RecordBfcAllocatorCompaction(name_);
+  return true;
+}
+
+void BFCAllocator::ExportFragmentationMetrics() {
+  int64_t largest_free_chunk_bytes;
+  double fragmentation = 0;
+  std::array<int64_t, kNumBins> free_bytes_in_bin;
+  {
+    mutex_lock l(lock_);
+    largest_free_chunk_bytes = LargestFreeChunk();
+    if (*stats_.pool_bytes > stats_.bytes_in_use) {
+      fragmentation = GetFragmentation();
+    }
+    for (BinNum b = 0; b < kNumBins; b++) {
+      int64_t free_bytes = 0;
+      for (ChunkHandle h : BinFromIndex(b)->free_chunks) {
+        free_bytes += ChunkFromHandle(h)->size;
+      }
+      free_bytes_in_bin[b] = free_bytes;
+    }
+  }
+  metrics::UpdateBfcAllocatorFragmentation(name_, largest_free_chunk_bytes,
+                                           fragmentation);
+  for (BinNum b = 0; b < kNumBins; b++) {
+    metrics::UpdateBfcAllocatorFreeBytesInBin(name_, BinNumToSize(b),
+                                              free_bytes_in_bin[b]);
+  }
+}
+
 void BFCAllocator::DeallocateRegions(
     const absl::flat_hash_set<void*>& region_ptrs)
     TF_EXCLUSIVE_LOCKS_REQUIRED(lock_) {
@@ -424,6 +619,12 @@ void* BFCAllocator::AllocateRawInternal(size_t unused_alignment,
   // so all memory addresses are nicely byte aligned.
   size_t rounded_bytes = RoundedBytes(num_bytes);
 
+  if (small_chunk_shards_ != nullptr && freed_before == 0 &&
+      rounded_bytes <= kMaxThreadCachedChunkBytes) {
+    void* ptr = AllocateFromThreadCache(rounded_bytes);
+    if (ptr != nullptr) return ptr;
+  }
+
   // The BFC allocator tries to find the best fit first.
   BinNum bin_num = BinNumForSize(rounded_bytes);
 
@@ -438,6 +639,15 @@ void* BFCAllocator::AllocateRawInternal(size_t unused_alignment,
     return ptr;
   }
 
+  // Return the chunks cached by threads to the bins before growing the pool.
+  if (FlushThreadCaches()) {
+    ptr = FindChunkPtr(bin_num, rounded_bytes, num_bytes, freed_before);
+    if (ptr != nullptr) {
+      AddTraceMe("MemoryAllocation", ptr);
+      return ptr;
+    }
+  }
+
   // Try to extend
   if (Extend(unused_alignment, rounded_bytes)) {
     ptr = FindChunkPtr(bin_num, rounded_bytes, num_bytes, freed_before);
@@ -628,6 +838,8 @@ void* BFCAllocator::FindChunkPtr(BinNum bin_num, size_t rounded_bytes,
         }
 #endif
 
+        RecordSmallChunk(chunk->ptr, chunk->size);
+
         VLOG(4) << "Returning: " << chunk->ptr;
         if (VLOG_IS_ON(4)) {
           LOG(INFO) << "A: " << RenderOccupancy();
@@ -678,12 +890,187 @@ void BFCAllocator::SplitChunk(BFCAllocator::ChunkHandle h, size_t num_bytes) {
   InsertFreeChunkIntoBin(h_new_chunk);
 }
 
+BFCAllocator::ThreadCache* BFCAllocator::GetThreadCache() {
+  // The caches of the calling thread, by allocator. When the thread exits, its
+  // caches are marked as orphaned, and their allocators reclaim them.
+  struct ThreadCaches {
+    ~ThreadCaches() {
+      for (auto& [id, cache] : caches) {
+        mutex_lock l(cache->mu);
+        cache->orphaned = true;
+      }
+    }
+    // NOTE: Allocator IDs are never reused, so entries for destroyed
+    // allocators are never looked up again.
+    absl::flat_hash_map<uint64, std::shared_ptr<ThreadCache>> caches;
+  };
+  thread_local ThreadCaches thread_caches;
+  auto it = thread_caches.caches.find(id_);
+  if (it != thread_caches.caches.end()) return it->second.get();
+
+  auto cache = std::make_shared<ThreadCache>();
+  std::vector<void*> to_free;
+  {
+    mutex_lock l(thread_caches_mu_);
+    // Threads are usually created as others exit, so reclaiming the caches of
+    // exited threads here bounds the number of caches by the number of live
+    // threads.
+    ReclaimOrphanedThreadCaches(&to_free);
+    thread_caches_.push_back(cache);
+  }
+  if (!to_free.empty()) ReturnChunksToBins(to_free);
+  return thread_caches.caches.emplace(id_, std::move(cache))
+      .first->second.get();
+}
+
+void BFCAllocator::ReclaimOrphanedThreadCaches(std::vector<void*>* to_free) {
+  auto orphaned = [to_free](const std::shared_ptr<ThreadCache>& cache) {
+    mutex_lock l(cache->mu);
+    if (!cache->orphaned) return false;
+    cache->TakeAll(to_free);
+    return true;
+  };
+  thread_caches_.erase(
+      std::remove_if(thread_caches_.begin(), thread_caches_.end(), orphaned),
+      thread_caches_.end());
+}
+
+void* BFCAllocator::AllocateFromThreadCache(size_t rounded_bytes) {
+  ThreadCache* cache = GetThreadCache();
+  const int c = rounded_bytes / kMinAllocationSize - 1;
+  void* ptr = nullptr;
+  std::vector<void*> to_free;
+  {
+    mutex_lock l(cache->mu);
+    std::vector<void*>& cached = cache->chunks[c];
+    if (!cached.empty()) {
+      ptr = cached.back();
+      cached.pop_back();
+      cache->low_water_mark[c] =
+          std::min(cache->low_water_mark[c], cached.size());
+    }
+    cache->MaybeScavenge(&to_free);
+  }
+  if (!to_free.empty()) ReturnChunksToBins(to_free);
+  if (ptr != nullptr) {
+    thread_cached_bytes_.fetch_sub(rounded_bytes, std::memory_order_relaxed);
+    num_thread_cache_allocs_.fetch_add(1, std::memory_order_relaxed);
+  }
+  return ptr;
+}
+
+void BFCAllocator::DeallocateToThreadCache(void* ptr, size_t chunk_bytes) {
+  if (timing_counter_ != nullptr) {
+    // Chunks must be timestamped when they are freed.
+    ReturnChunksToBins({ptr});
+    return;
+  }
+  ThreadCache* cache = GetThreadCache();
+  const int c = chunk_bytes / kMinAllocationSize - 1;
+  std::vector<void*> to_free;
+  {
+    mutex_lock l(cache->mu);
+    std::vector<void*>& cached = cache->chunks[c];
+    if (cached.size() < kMaxThreadCachedChunksPerClass) {
+      cached.push_back(ptr);
+      thread_cached_bytes_.fetch_add(chunk_bytes, std::memory_order_relaxed);
+    } else {
+      // Return the older half of the class, and this chunk, to the bins.
+      const size_t n = cached.size() / 2;
+      to_free.assign(cached.begin(), cached.begin() + n);
+      cached.erase(cached.begin(), cached.begin() + n);
+      cache->low_water_mark[c] = std::min(cache->low_water_mark[c], n);
+      to_free.push_back(ptr);
+      // `ptr` was never counted as cached.
+      thread_cached_bytes_.fetch_add(chunk_bytes, std::memory_order_relaxed);
+    }
+    cache->MaybeScavenge(&to_free);
+  }
+  if (!to_free.empty()) ReturnChunksToBins(to_free);
+}
+
+void BFCAllocator::RecordSmallChunk(const void* ptr, size_t chunk_bytes) {
+  if (small_chunk_shards_ == nullptr ||
+      chunk_bytes > kMaxThreadCachedChunkBytes) {
+    return;
+  }
+  SmallChunkShard& shard =
+      small_chunk_shards_[(reinterpret_cast<uintptr_t>(ptr) >>
+                           kMinAllocationBits) %
+                          kNumSmallChunkShards];
+  mutex_lock l(shard.mu);
+  shard.chunk_bytes[ptr] = chunk_bytes;
+}
+
+size_t BFCAllocator::SmallChunkSize(const void* ptr) {
+  SmallChunkShard& shard =
+      small_chunk_shards_[(reinterpret_cast<uintptr_t>(ptr) >>
+                           kMinAllocationBits) %
+                          kNumSmallChunkShards];
+  mutex_lock l(shard.mu);
+  auto it = shard.chunk_bytes.find(ptr);
+  return it == shard.chunk_bytes.end() ? 0 : it->second;
+}
+
+void BFCAllocator::ReturnChunksToBins(absl::Span<void* const> ptrs) {
+  {
+    mutex_lock l(lock_);
+    ReturnChunksToBinsLocked(ptrs);
+  }
+  retry_helper_.NotifyDealloc();
+}
+
+void BFCAllocator::ReturnChunksToBinsLocked(absl::Span<void* const> ptrs) {
+  int64_t bytes = 0;
+  for (void* ptr : ptrs) {
+    SmallChunkShard& shard =
+        small_chunk_shards_[(reinterpret_cast<uintptr_t>(ptr) >>
+                             kMinAllocationBits) %
+                            kNumSmallChunkShards];
+    {
+      mutex_lock l(shard.mu);
+      auto it = shard.chunk_bytes.find(ptr);
+      DCHECK(it != shard.chunk_bytes.end());
+      bytes += it->second;
+      shard.chunk_bytes.erase(it);
+    }
+    DeallocateRawLocked(ptr);
+  }
+  thread_cached_bytes_.fetch_sub(bytes, std::memory_order_relaxed);
+}
+
+bool BFCAllocator::FlushThreadCaches() {
+  if (small_chunk_shards_ == nullptr ||
+      thread_cached_bytes_.load(std::memory_order_relaxed) == 0) {
+    return false;
+  }
+  std::vector<void*> to_free;
+  {
+    mutex_lock l(thread_caches_mu_);
+    ReclaimOrphanedThreadCaches(&to_free);
+    for (const auto& cache : thread_caches_) {
+      mutex_lock cache_lock(cache->mu);
+      cache->TakeAll(&to_free);
+    }
+  }
+  ReturnChunksToBinsLocked(to_free);
+  return !to_free.empty();
+}
+
 void BFCAllocator::DeallocateRaw(void* ptr) {
   VLOG(3) << "DeallocateRaw " << Name() << " "
           << (ptr ? RequestedSize(ptr) : 0);
   VLOG(4) << "[mem-debug] DeallocateRaw," << Name() << ","
           << (ptr ? RequestedSize(ptr) : 0) << "," << ptr << ","
           << tsl::CurrentStackTrace();
+  if (small_chunk_shards_ != nullptr && ptr != nullptr) {
+    const size_t chunk_bytes = SmallChunkSize(ptr);
+    if (chunk_bytes > 0) {
+      // Waiters are notified if the chunk is returned to the bins.
+      DeallocateToThreadCache(ptr, chunk_bytes);
+      return;
+    }
+  }
   DeallocateRawInternal(ptr);
   retry_helper_.NotifyDealloc();
 }
@@ -694,7 +1081,10 @@ void BFCAllocator::DeallocateRawInternal(void* ptr) {
     return;
   }
   mutex_lock l(lock_);
+  DeallocateRawLocked(ptr);
+}
 
+void BFCAllocator::DeallocateRawLocked(void* ptr) {
   // Find the chunk from the ptr.
   BFCAllocator::ChunkHandle h = region_manager_.get_handle(ptr);
   CHECK(h != kInvalidChunkHandle);
@@ -1139,7 +1529,12 @@ MemoryDump BFCAllocator::RecordMemoryMap() {
   return RecordMemoryMapInternal();
 }
 
-MemoryDump BFCAllocator::RecordMemoryMapInternal() {
+MemoryDump BFCAllocator::RecordAllocationProfile() {
+  mutex_lock l(lock_);
+  return RecordAllocationProfileInternal();
+}
+
+MemoryDump BFCAllocator::RecordAllocationProfileInternal() {
   MemoryDump md;
   md.set_allocator_name(Name());
 
@@ -1149,6 +1544,7 @@ MemoryDump BFCAllocator::RecordMemoryMapInternal() {
   mas->set_bytes_in_use(stats_.bytes_in_use);
   mas->set_peak_bytes_in_use(stats_.peak_bytes_in_use);
   mas->set_largest_alloc_size(stats_.largest_alloc_size);
+  mas->set_peak_pool_bytes(*stats_.peak_pool_bytes);
 
   // Record summary data for every bin.
   const std::array<BinDebugInfo, kNumBins> bin_infos = get_bin_debug_info();
@@ -1165,6 +1561,13 @@ MemoryDump BFCAllocator::RecordMemoryMapInternal() {
     bs->set_total_chunks_in_bin(bin_info.total_chunks_in_bin);
   }
 
+  mas->set_fragmentation_metric(GetFragmentation());
+  return md;
+}
+
+MemoryDump BFCAllocator::RecordMemoryMapInternal() {
+  MemoryDump md = RecordAllocationProfileInternal();
+
   // Record state of every defined Chunk.
   for (const auto& region : region_manager_.regions()) {
     ChunkHandle h = region_manager_.get_handle(region.ptr());
@@ -1188,8 +1591,6 @@ MemoryDump BFCAllocator::RecordMemoryMapInternal() {
     }
   }
 
-  mas->set_fragmentation_metric(GetFragmentation());
-
 #ifdef TENSORFLOW_MEM_DEBUG
   // Record the recent size history
   int history_len = static_cast<int>(std::min(
@@ -1207,13 +1608,19 @@ MemoryDump BFCAllocator::RecordMemoryMapInternal() {
 
 absl::optional<AllocatorStats> BFCAllocator::GetStats() {
   mutex_lock l(lock_);
-  return stats_;
+  AllocatorStats stats = stats_;
+  stats.bytes_in_use -= thread_cached_bytes_.load(std::memory_order_relaxed);
+  stats.num_allocs += num_thread_cache_allocs_.load(std::memory_order_relaxed);
+  return stats;
 }
 
 bool BFCAllocator::ClearStats() {
   mutex_lock l(lock_);
   stats_.num_allocs = 0;
-  stats_.peak_bytes_in_use = stats_.bytes_in_use;
+  num_thread_cache_allocs_.store(0, std::memory_order_relaxed);
+  stats_.peak_bytes_in_use =
+      stats_.bytes_in_use -
+      thread_cached_bytes_.load(std::memory_order_relaxed);
   stats_.largest_alloc_size = 0;
   return true;
 }
@@ -23,7 +23,9 @@ limitations under the License.
 #include <unordered_map>
 #include <vector>
 
+#include "absl/container/flat_hash_map.h"
 #include "absl/container/flat_hash_set.h"
+#include "absl/types/span.h"
 #include "tsl/framework/allocator.h"
 #include "tsl/framework/allocator_retry.h"
 #include "tsl/framework/shared_counter.h"
@@ -68,6 +70,24 @@ class BFCAllocator : public Allocator {
     // Controls when a chunk should be split, if its size exceeds the requested
     // allocation size.
     double fragmentation_fraction = 0;
+
+    // If true, chunks of at most 4KiB are not returned to the bins when they
+    // are freed, but are kept in a cache owned by the freeing thread. Later
+    // allocations of the same size on that thread are served from the cache
+    // without taking the allocator lock. Cached chunks are returned to the
+    // bins periodically, whenever an allocation could not otherwise be
+    // satisfied, and after the thread exits.
+    //
+    // While a chunk is cached, it counts towards the peak bytes in use, and is
+    // reported as in use by RecordMemoryMap() and the memory logs.
+    // RequestedSize() and AllocationId() of a chunk that was served from a
+    // cache refer to the allocation that first took it from the bins. The
+    // cache is not used if a timing counter is set.
+    bool thread_local_cache = false;
+
+    // If true, OnStepBoundary() compacts the regions without live allocations
+    // (see CompactFreeRegions()).
+    bool compact_free_regions = false;
   };
   BFCAllocator(std::unique_ptr<SubAllocator> sub_allocator, size_t total_memory,
                const string& name, const Options& opts);
@@ -107,6 +127,32 @@ class BFCAllocator : public Allocator {
 
   MemoryDump RecordMemoryMap();
 
+  // Returns a compact profile of the memory use of the allocator: its stats
+  // and the summary of each bin, without the state of each chunk.
+  MemoryDump RecordAllocationProfile();
+
+  // Called by the runtime between steps. At most once every
+  // kStepBoundaryIntervalMicros, exports the fragmentation metrics of the
+  // allocator (see tsl/framework/metrics.h), compacts its free regions if
+  // Options::compact_free_regions is set, and saves its allocation profile if
+  // the peak pool size has grown since it was last saved.
+  //
+  // If the TF_BFC_ALLOCATION_PROFILE environment variable is set, the profile
+  // is saved to "<TF_BFC_ALLOCATION_PROFILE>_<Name()>". When an allocator
+  // with allow_growth is created and a profile with its name exists, the
+  // first region that it allocates is as large as the peak pool size in the
+  // profile, instead of growing through many smaller regions.
+  void OnStepBoundary();
+
+  // If at least two regions have no live allocations, returns their memory to
+  // the sub-allocator and allocates the same amount of memory again as a
+  // single region, so that it can be carved into larger chunks. Returns true
+  // if regions were compacted. Does nothing while freed chunks may still be
+  // in use by other streams (see SetTimingCounter()).
+  bool CompactFreeRegions();
+
+  static constexpr uint64 kStepBoundaryIntervalMicros = 10 * 1000 * 1000;
+
  private:
   struct Bin;
 
@@ -119,6 +165,52 @@ class BFCAllocator : public Allocator {
       const AllocationAttributes& allocation_attr);
 
   void DeallocateRawInternal(void* ptr);
+  void DeallocateRawLocked(void* ptr) TF_EXCLUSIVE_LOCKS_REQUIRED(lock_);
+
+  // The per-thread caches of small free chunks (see
+  // Options::thread_local_cache).
+  class ThreadCache;
+  static constexpr size_t kMaxThreadCachedChunkBytes = 4096;
+  // Chunks are cached by their size; class i holds chunks of
+  // (i + 1) * kMinAllocationSize bytes.
+  static constexpr int kNumThreadCacheClasses = 16;
+  static constexpr int kMaxThreadCachedChunksPerClass = 64;
+  // Every this many operations on a thread cache, the chunks that were not
+  // used since the previous period are returned to the bins.
+  static constexpr int kThreadCacheScavengePeriod = 4096;
+  static constexpr int kNumSmallChunkShards = 64;
+
+  // Returns the cache of the calling thread, creating it if necessary.
+  ThreadCache* GetThreadCache();
+
+  // Returns a cached chunk of exactly `rounded_bytes`, or nullptr.
+  void* AllocateFromThreadCache(size_t rounded_bytes);
+
+  // Caches the freed chunk `ptr` of `chunk_bytes`, returning chunks to the
+  // bins if the cache is full.
+  void DeallocateToThreadCache(void* ptr, size_t chunk_bytes);
+
+  // Records that the chunk at `ptr` of `chunk_bytes` was allocated from the
+  // bins, if it is small enough to be cached.
+  void RecordSmallChunk(const void* ptr, size_t chunk_bytes);
+
+  // Returns the size of the allocated chunk at `ptr` if it may be cached, or
+  // 0 otherwise.
+  size_t SmallChunkSize(const void* ptr);
+
+  // Returns the given cached chunks to the bins.
+  void ReturnChunksToBins(absl::Span<void* const> ptrs)
+      TF_LOCKS_EXCLUDED(lock_);
+  void ReturnChunksToBinsLocked(absl::Span<void* const> ptrs)
+      TF_EXCLUSIVE_LOCKS_REQUIRED(lock_);
+
+  // Returns the chunks of all thread caches to the bins. Returns true if any
+  // chunks were returned.
+  bool FlushThreadCaches() TF_EXCLUSIVE_LOCKS_REQUIRED(lock_);
+
+  // Removes the caches of exited threads, moving their chunks to `*to_free`.
+  void ReclaimOrphanedThreadCaches(std::vector<void*>* to_free)
+      TF_EXCLUSIVE_LOCKS_REQUIRED(thread_caches_mu_);
 
   // Chunks whose freed_at_count is later than the safe frontier value are kept
   // on a special list and not subject to merging immediately upon being freed.
@@ -462,6 +554,13 @@ class BFCAllocator : public Allocator {
   // found and freed; false otherwise.
   bool DeallocateFreeRegions(size_t rounded_bytes);
 
+  // Returns the regions without live allocations, and their total size.
+  absl::flat_hash_set<void*> FindFreeRegions(size_t* total_free_bytes)
+      TF_EXCLUSIVE_LOCKS_REQUIRED(lock_);
+
+  // Exports the fragmentation metrics of the allocator.
+  void ExportFragmentationMetrics() TF_LOCKS_EXCLUDED(lock_);
+
   // Helper function to deallocate regions.
   void DeallocateRegions(const absl::flat_hash_set<void*>& region_ptrs)
       TF_EXCLUSIVE_LOCKS_REQUIRED(lock_);
@@ -500,6 +599,11 @@ class BFCAllocator : public Allocator {
   void DumpMemoryLog(size_t num_bytes) TF_EXCLUSIVE_LOCKS_REQUIRED(lock_);
   tensorflow::MemoryDump RecordMemoryMapInternal()
       TF_EXCLUSIVE_LOCKS_REQUIRED(lock_);
+  tensorflow::MemoryDump RecordAllocationProfileInternal()
+      TF_EXCLUSIVE_LOCKS_REQUIRED(lock_);
+  // Sizes the first region from the saved allocation profile, if any.
+  void MaybeLoadAllocationProfile(size_t total_memory);
+  void MaybeWriteAllocationProfile() TF_LOCKS_EXCLUDED(lock_);
   void MaybeWriteMemoryMap() TF_EXCLUSIVE_LOCKS_REQUIRED(lock_);
 
   ChunkHandle AllocateChunk() TF_EXCLUSIVE_LOCKS_REQUIRED(lock_);
@@ -593,6 +697,30 @@ class BFCAllocator : public Allocator {
 
   std::atomic<uint64> safe_frontier_ = {0};
 
+  // The earliest time at which OnStepBoundary() will act again.
+  std::atomic<uint64> next_step_boundary_micros_{0};
+
+  // The file that the allocation profile is saved to, or empty.
+  string allocation_profile_path_;
+
+  // State for Options::thread_local_cache. `small_chunk_shards_` is only
+  // allocated if the cache is enabled, and maps each allocated chunk that may
+  // be cached (including chunks that are currently cached) to its size. It is
+  // sharded by address so that frees on different threads rarely contend.
+  struct SmallChunkShard {
+    mutex mu;
+    absl::flat_hash_map<const void*, size_t> chunk_bytes TF_GUARDED_BY(mu);
+  };
+  const uint64 id_;
+  std::unique_ptr<SmallChunkShard[]> small_chunk_shards_;
+  mutex thread_caches_mu_;
+  std::vector<std::shared_ptr<ThreadCache>> thread_caches_
+      TF_GUARDED_BY(thread_caches_mu_);
+  // The total size of the cached chunks, which are counted as in use in
+  // `stats_`, and the number of allocations served from thread caches.
+  std::atomic<int64_t> thread_cached_bytes_{0};
+  std::atomic<int64_t> num_thread_cache_allocs_{0};
+
   // Structures mutable after construction
   mutable mutex lock_;
   RegionManager region_manager_ TF_GUARDED_BY(lock_);
@@ -608,6 +736,8 @@ class BFCAllocator : public Allocator {
 
   // Stats.
   AllocatorStats stats_ TF_GUARDED_BY(lock_);
+  // The peak pool size in the last saved allocation profile.
+  int64_t profiled_peak_pool_bytes_ TF_GUARDED_BY(lock_) = 0;
 #ifdef TENSORFLOW_MEM_DEBUG
   int64 action_counter_ TF_GUARDED_BY(lock_) = 0;
 #define MEM_DEBUG_SIZE_HISTORY_SIZE 4096
@@ -15,7 +15,12 @@ limitations under the License.
 
 #include <algorithm>
 #include <atomic>
+#include <cstdint>
+#include <cstdlib>
+#include <string>
 
+#include "absl/container/flat_hash_map.h"
+#include "absl/strings/numbers.h"
 #include "tsl/framework/allocator.h"
 #include "tsl/framework/allocator_registry.h"
 #include "tsl/framework/tracking_allocator.h"
@@ -36,6 +41,128 @@ void EnableCPUAllocatorStats() { cpu_allocator_collect_stats = true; }
 void DisableCPUAllocatorStats() { cpu_allocator_collect_stats = false; }
 bool CPUAllocatorStatsEnabled() { return cpu_allocator_collect_stats; }
 
+namespace {
+
+// The live allocations of the default CPU allocators that are served by
+// `port::HugePageMalloc()`.
+class HugePageAllocations {
+ public:
+  static HugePageAllocations* Global() {
+    static HugePageAllocations* allocations = new HugePageAllocations;
+    return allocations;
+  }
+
+  size_t threshold() const {
+    return threshold_.load(std::memory_order_relaxed);
+  }
+  void set_threshold(size_t threshold) {
+    threshold_.store(threshold, std::memory_order_relaxed);
+  }
+
+  void* Allocate(size_t num_bytes) {
+    bool huge_pages = false;
+    void* ptr = port::HugePageMalloc(num_bytes, use_hugetlb_, &huge_pages);
+    if (ptr == nullptr) return nullptr;
+    const size_t size = RoundUpToHugePage(num_bytes);
+    mutex_lock l(mu_);
+    allocations_[ptr] = {size, huge_pages};
+    num_allocs_.fetch_add(1, std::memory_order_relaxed);
+    stats_.num_allocs++;
+    stats_.bytes_in_use += size;
+    if (huge_pages) stats_.huge_page_bytes_in_use += size;
+    return ptr;
+  }
+
+  // Returns the size of `ptr` if it was returned by `Allocate()`, or 0.
+  size_t AllocatedSize(const void* ptr) {
+    if (!MaybeAllocated(ptr)) return 0;
+    mutex_lock l(mu_);
+    auto it = allocations_.find(ptr);
+    return it == allocations_.end() ? 0 : it->second.num_bytes;
+  }
+
+  // Frees `ptr` and returns true if it was returned by `Allocate()`.
+  bool Free(void* ptr) {
+    if (!MaybeAllocated(ptr)) return false;
+    Allocation allocation;
+    {
+      mutex_lock l(mu_);
+      auto it = allocations_.find(ptr);
+      if (it == allocations_.end()) return false;
+      allocation = it->second;
+      allocations_.erase(it);
+      num_allocs_.fetch_sub(1, std::memory_order_relaxed);
+      stats_.num_allocs--;
+      stats_.bytes_in_use -= allocation.num_bytes;
+      if (allocation.huge_pages) {
+        stats_.huge_page_bytes_in_use -= allocation.num_bytes;
+      }
+    }
+    port::HugePageFree(ptr, allocation.num_bytes);
+    return true;
+  }
+
+  CPUAllocatorHugePageStats stats() {
+    mutex_lock l(mu_);
+    return stats_;
+  }
+
+ private:
+  struct Allocation {
+    size_t num_bytes;
+    bool huge_pages;
+  };
+
+  HugePageAllocations() {
+    const char* threshold =
+        std::getenv("TF_CPU_ALLOCATOR_HUGE_PAGE_THRESHOLD_BYTES");
+    uint64_t threshold_bytes = 0;
+    if (threshold != nullptr) {
+      if (absl::SimpleAtoi(threshold, &threshold_bytes)) {
+        threshold_.store(threshold_bytes, std::memory_order_relaxed);
+      } else {
+        LOG(ERROR) << "Invalid TF_CPU_ALLOCATOR_HUGE_PAGE_THRESHOLD_BYTES: "
+                   << threshold;
+      }
+    }
+    const char* use_hugetlb = std::getenv("TF_CPU_ALLOCATOR_USE_HUGETLB");
+    use_hugetlb_ = use_hugetlb != nullptr && std::string(use_hugetlb) == "1";
+  }
+
+  static size_t RoundUpToHugePage(size_t num_bytes) {
+    return (num_bytes + port::kHugePageSize - 1) & ~(port::kHugePageSize - 1);
+  }
+
+  // Allocations are aligned to the huge page size, so most other pointers are
+  // rejected without taking the lock.
+  bool MaybeAllocated(const void* ptr) const {
+    return num_allocs_.load(std::memory_order_relaxed) > 0 &&
+           (reinterpret_cast<uintptr_t>(ptr) & (port::kHugePageSize - 1)) == 0;
+  }
+
+  std::atomic<size_t> threshold_{0};
+  bool use_hugetlb_ = false;
+  std::atomic<int64_t> num_allocs_{0};
+
+  mutex mu_;
+  absl::flat_hash_map<const void*, Allocation> allocations_ TF_GUARDED_BY(mu_);
+  CPUAllocatorHugePageStats stats_ TF_GUARDED_BY(mu_);
+};
+
+}  // namespace
+
+void SetCPUAllocatorHugePageThreshold(size_t threshold_bytes) {
+  HugePageAllocations::Global()->set_threshold(threshold_bytes);
+}
+
+size_t CPUAllocatorHugePageThreshold() {
+  return HugePageAllocations::Global()->threshold();
+}
+
+CPUAllocatorHugePageStats GetCPUAllocatorHugePageStats() {
+  return HugePageAllocations::Global()->stats();
+}
+
 static const int kMaxTotalAllocationWarnings = 1;
 
 static const int kMaxSingleAllocationWarnings = 5;
@@ -85,9 +212,18 @@ class CPUAllocator : public Allocator {
                    << "% of free system memory.";
     }
 
-    void* p = port::AlignedMalloc(num_bytes, alignment);
+    void* p = nullptr;
+    const size_t huge_page_threshold =
+        HugePageAllocations::Global()->threshold();
+    if (huge_page_threshold > 0 && num_bytes >= huge_page_threshold &&
+        alignment <= port::kHugePageSize) {
+      p = HugePageAllocations::Global()->Allocate(num_bytes);
+    }
+    if (p == nullptr) {
+      p = port::AlignedMalloc(num_bytes, alignment);
+    }
     if (cpu_allocator_collect_stats) {
-      const std::size_t alloc_size = port::MallocExtension_GetAllocatedSize(p);
+      const std::size_t alloc_size = AllocationSize(p);
       mutex_lock l(mu_);
       ++stats_.num_allocs;
       stats_.bytes_in_use += alloc_size;
@@ -112,13 +248,14 @@ class CPUAllocator : public Allocator {
 
   void DeallocateRaw(void* ptr) override {
     if (cpu_allocator_collect_stats) {
-      const std::size_t alloc_size =
-          port::MallocExtension_GetAllocatedSize(ptr);
+      const std::size_t alloc_size = AllocationSize(ptr);
       mutex_lock l(mu_);
       stats_.bytes_in_use -= alloc_size;
       AddTraceMe("MemoryDeallocation", ptr, 0, alloc_size);
     }
-    port::AlignedFree(ptr);
+    if (!HugePageAllocations::Global()->Free(ptr)) {
+      port::AlignedFree(ptr);
+    }
   }
 
   void AddTraceMe(absl::string_view traceme_name, const void* chunk_ptr,
@@ -161,7 +298,7 @@ class CPUAllocator : public Allocator {
   }
 
   size_t AllocatedSizeSlow(const void* ptr) const override {
-    return port::MallocExtension_GetAllocatedSize(ptr);
+    return AllocationSize(ptr);
   }
 
   AllocatorMemoryType GetMemoryType() const override {
@@ -169,6 +306,13 @@ class CPUAllocator : public Allocator {
   }
 
  private:
+  static size_t AllocationSize(const void* ptr) {
+    const size_t huge_page_size =
+        HugePageAllocations::Global()->AllocatedSize(ptr);
+    return huge_page_size > 0 ? huge_page_size
+                              : port::MallocExtension_GetAllocatedSize(ptr);
+  }
+
   mutex mu_;
   AllocatorStats stats_ TF_GUARDED_BY(mu_);
 
@@ -17,7 +17,10 @@ limitations under the License.
 
 #include <cstdint>
 
+#include <string>
+
 #include "tsl/lib/monitoring/counter.h"
+#include "tsl/lib/monitoring/gauge.h"
 
 namespace tsl {
 namespace metrics {
@@ -28,6 +31,27 @@ auto* bfc_allocator_delay =
                                 "The total time spent running each graph "
                                 "optimization pass in microseconds.");
 
+auto* bfc_allocator_largest_free_chunk = monitoring::Gauge<int64_t, 1>::New(
+    "/tensorflow/core/bfc_allocator_largest_free_chunk_bytes",
+    "The size of the largest free chunk of a BFC allocator.", "allocator");
+
+auto* bfc_allocator_fragmentation = monitoring::Gauge<double, 1>::New(
+    "/tensorflow/core/bfc_allocator_fragmentation",
+    "The fraction of the free bytes of a BFC allocator that are not in its "
+    "largest free chunk.",
+    "allocator");
+
+auto* bfc_allocator_free_bytes_in_bin = monitoring::Gauge<int64_t, 2>::New(
+    "/tensorflow/core/bfc_allocator_free_bytes_in_bin",
+    "The total size of the free chunks in a bin of a BFC allocator, by the "
+    "minimum chunk size of the bin.",
+    "allocator", "bin_size");
+
+auto* bfc_allocator_compactions = monitoring::Counter<1>::New(
+    "/tensorflow/core/bfc_allocator_compactions",
+    "The number of times a BFC allocator compacted its free regions.",
+    "allocator");
+
 }  // namespace
 
 void UpdateBfcAllocatorDelayTime(const uint64_t delay_usecs) {
@@ -37,5 +61,23 @@ void UpdateBfcAllocatorDelayTime(const uint64_t delay_usecs) {
   }
 }
 
+void UpdateBfcAllocatorFragmentation(const std::string& allocator,
+                                     int64_t largest_free_chunk_bytes,
+                                     double fragmentation) {
+  bfc_allocator_largest_free_chunk->GetCell(allocator)->Set(
+      largest_free_chunk_bytes);
+  bfc_allocator_fragmentation->GetCell(allocator)->Set(fragmentation);
+}
+
+void UpdateBfcAllocatorFreeBytesInBin(const std::string& allocator,
+                                      int64_t bin_size, int64_t free_bytes) {
+  bfc_allocator_free_bytes_in_bin->GetCell(allocator, std::to_string(bin_size))
+      ->Set(free_bytes);
+}
+
+void RecordBfcAllocatorCompaction(const std::string& allocator) {
+  bfc_allocator_compactions->GetCell(allocator)->IncrementBy(1);
+}
+
 }  // namespace metrics
 }  // namespace tsl
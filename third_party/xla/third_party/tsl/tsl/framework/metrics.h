@@ -17,6 +17,7 @@ limitations under the License.
 #define TENSORFLOW_TSL_FRAMEWORK_METRICS_H_
 
 #include <cstdint>
+#include <string>
 
 namespace tsl {
 namespace metrics {
@@ -24,6 +25,21 @@ namespace metrics {
 // Updates the metrics stored about time BFC allocator spents during delay.
 void UpdateBfcAllocatorDelayTime(const uint64_t delay_usecs);
 
+// Updates the fragmentation metrics of the BFC allocator named `allocator`:
+// the size of its largest free chunk, and the fraction of its free bytes that
+// are not in the largest free chunk.
+void UpdateBfcAllocatorFragmentation(const std::string& allocator,
+                                     int64_t largest_free_chunk_bytes,
+                                     double fragmentation);
+
+// Updates the total size of the free chunks in the bin of the BFC allocator
+// named `allocator` that holds chunks of at least `bin_size` bytes.
+void UpdateBfcAllocatorFreeBytesInBin(const std::string& allocator,
+                                      int64_t bin_size, int64_t free_bytes);
+
+// Records that the BFC allocator named `allocator` compacted its free regions.
+void RecordBfcAllocatorCompaction(const std::string& allocator);
+
 }  // namespace metrics
 }  // namespace tsl
 
@@ -133,6 +133,10 @@ class ServingDeviceSelector {
   // Struct of all tracked device states, which will be passed to Policy.
   struct DeviceStates {
     absl::Span<const DeviceState> states;
+    // The current time and the smallest known program execution time, for
+    // policies that estimate the time until a device becomes idle.
+    int64_t now_ns = 0;
+    int64_t min_exec_time_ns = 0;
   };
 
   // Policy used to select a device.
@@ -152,6 +156,12 @@ class ServingDeviceSelector {
   virtual DeviceReservation ReserveDevice(
       absl::string_view program_fingerprint) = 0;
 
+  // Helper to estimate the time until the core becomes idle in nanoseconds.
+  // Only considers queues with priority at least as high as 'priority'.
+  static int64_t EstimateTimeTillIdleNs(const DeviceState& device_state,
+                                        int32_t priority, int64_t min_exec_time,
+                                        int64_t now_ns);
+
  protected:
   // A helper function for Enqueue. The EnqueueHelper does the following things.
   //  1. If there are programs in the scheduled_programs queue of the given
@@ -175,11 +185,6 @@ class ServingDeviceSelector {
                               int32_t priority,
                               std::optional<int64_t>& min_exec_time,
                               bool had_error, int64_t now_ns);
-  // Helper to estimate the time until the core becomes idle in nanoseconds.
-  // Only considers queues with priority at least as high as 'priority'.
-  static int64_t EstimateTimeTillIdleNs(const DeviceState& device_state,
-                                        int32_t priority, int64_t min_exec_time,
-                                        int64_t now_ns);
 
  private:
   friend DeviceReservation;
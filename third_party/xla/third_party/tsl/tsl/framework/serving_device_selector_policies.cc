@@ -15,6 +15,7 @@ limitations under the License.
 #include "tsl/framework/serving_device_selector_policies.h"
 
 #include <atomic>
+#include <cstdint>
 
 #include "absl/strings/string_view.h"
 #include "tsl/framework/serving_device_selector.h"
@@ -28,4 +29,74 @@ int RoundRobinPolicy::SelectDevice(
   return ordinal_.fetch_add(1, std::memory_order_relaxed) % num_devices;
 }
 
+namespace {
+
+int64_t EstimateTimeTillIdleNs(
+    const ServingDeviceSelector::DeviceState& state,
+    const ServingDeviceSelector::DeviceStates& device_states) {
+  // Work of any priority delays the program on this device.
+  return ServingDeviceSelector::EstimateTimeTillIdleNs(
+      state, state.enqueued_programs.size() - 1, device_states.min_exec_time_ns,
+      device_states.now_ns);
+}
+
+}  // namespace
+
+int EarliestCompletionPolicy::SelectDevice(
+    absl::string_view program_fingerprint,
+    const ServingDeviceSelector::DeviceStates& device_states) {
+  const int num_devices = device_states.states.size();
+  const int start = ordinal_.fetch_add(1, std::memory_order_relaxed) %
+                    num_devices;
+  int best_device = start;
+  int64_t best_time_till_idle_ns = -1;
+  for (int i = 0; i < num_devices; ++i) {
+    const int device = (start + i) % num_devices;
+    const int64_t time_till_idle_ns =
+        EstimateTimeTillIdleNs(device_states.states[device], device_states);
+    if (best_time_till_idle_ns < 0 ||
+        time_till_idle_ns < best_time_till_idle_ns) {
+      best_device = device;
+      best_time_till_idle_ns = time_till_idle_ns;
+    }
+  }
+  return best_device;
+}
+
+int AffinityEarliestCompletionPolicy::SelectDevice(
+    absl::string_view program_fingerprint,
+    const ServingDeviceSelector::DeviceStates& device_states) {
+  const int num_devices = device_states.states.size();
+  const int start = ordinal_.fetch_add(1, std::memory_order_relaxed) %
+                    num_devices;
+  int best_device = start;
+  int64_t best_time_till_idle_ns = -1;
+  int best_affine_device = -1;
+  int64_t best_affine_time_till_idle_ns = -1;
+  for (int i = 0; i < num_devices; ++i) {
+    const int device = (start + i) % num_devices;
+    const ServingDeviceSelector::DeviceState& state =
+        device_states.states[device];
+    const int64_t time_till_idle_ns =
+        EstimateTimeTillIdleNs(state, device_states);
+    if (best_time_till_idle_ns < 0 ||
+        time_till_idle_ns < best_time_till_idle_ns) {
+      best_device = device;
+      best_time_till_idle_ns = time_till_idle_ns;
+    }
+    if (state.last_fingerprint == program_fingerprint &&
+        (best_affine_time_till_idle_ns < 0 ||
+         time_till_idle_ns < best_affine_time_till_idle_ns)) {
+      best_affine_device = device;
+      best_affine_time_till_idle_ns = time_till_idle_ns;
+    }
+  }
+  if (best_affine_device >= 0 &&
+      best_affine_time_till_idle_ns - best_time_till_idle_ns <=
+          switch_cost_ns_) {
+    return best_affine_device;
+  }
+  return best_device;
+}
+
 }  // namespace tsl
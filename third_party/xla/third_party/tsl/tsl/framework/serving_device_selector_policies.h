@@ -16,6 +16,7 @@ limitations under the License.
 #define TENSORFLOW_TSL_FRAMEWORK_SERVING_DEVICE_SELECTOR_POLICIES_H_
 
 #include <atomic>
+#include <cstdint>
 
 #include "tsl/framework/serving_device_selector.h"
 
@@ -23,6 +24,7 @@ namespace tsl {
 
 enum class ServingDeviceSelectorPolicy {
   kRoundRobin,
+  kEarliestCompletion,
 };
 
 class RoundRobinPolicy : public ServingDeviceSelector::Policy {
@@ -37,6 +39,40 @@ class RoundRobinPolicy : public ServingDeviceSelector::Policy {
   std::atomic<uint64_t> ordinal_;
 };
 
+// Selects the device that is expected to become idle first, i.e. the one with
+// the least outstanding work as estimated from the average execution times of
+// the programs enqueued and scheduled on it. Ties, e.g. between idle devices,
+// are broken round-robin.
+class EarliestCompletionPolicy : public ServingDeviceSelector::Policy {
+ public:
+  EarliestCompletionPolicy() : ordinal_(0) {}
+
+  int SelectDevice(
+      absl::string_view program_fingerprint,
+      const ServingDeviceSelector::DeviceStates& device_states) override;
+
+ private:
+  std::atomic<uint64_t> ordinal_;
+};
+
+// Like `EarliestCompletionPolicy`, but keeps a program on the device that
+// last ran it, so that devices do not needlessly swap the programs they hold,
+// unless another device is expected to become idle earlier by more than
+// `switch_cost_ns`.
+class AffinityEarliestCompletionPolicy : public ServingDeviceSelector::Policy {
+ public:
+  explicit AffinityEarliestCompletionPolicy(int64_t switch_cost_ns)
+      : switch_cost_ns_(switch_cost_ns), ordinal_(0) {}
+
+  int SelectDevice(
+      absl::string_view program_fingerprint,
+      const ServingDeviceSelector::DeviceStates& device_states) override;
+
+ private:
+  const int64_t switch_cost_ns_;
+  std::atomic<uint64_t> ordinal_;
+};
+
 }  // namespace tsl
 
 #endif  // TENSORFLOW_TSL_FRAMEWORK_SERVING_DEVICE_SELECTOR_POLICIES_H_
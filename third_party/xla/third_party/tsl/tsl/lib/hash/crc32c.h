@@ -27,6 +27,9 @@ limitations under the License.
 namespace tsl {
 namespace crc32c {
 
+// The functions below use the SSE4.2 and ARMv8 CRC32 instructions, selected
+// at runtime, on processors that support them.
+
 // Return the crc32c of concat(A, buf[0,size-1]) where init_crc is the
 // crc32c of some string A.  Extend() is often used to maintain the
 // crc32c of a stream of data.
@@ -35,6 +38,14 @@ inline uint32 Extend(uint32 init_crc, const char* buf, size_t size) {
       static_cast<absl::crc32c_t>(init_crc), absl::string_view(buf, size)));
 }
 
+// Copies src[0,size-1] to dst and returns Extend(init_crc, src, size). This
+// is faster than a copy followed by Extend(), which reads the data twice.
+inline uint32 MemcpyExtend(uint32 init_crc, char* dst, const char* src,
+                           size_t size) {
+  return static_cast<uint32>(absl::MemcpyCrc32c(
+      dst, src, size, static_cast<absl::crc32c_t>(init_crc)));
+}
+
 #if defined(TF_CORD_SUPPORT)
 extern uint32 Extend(uint32 init_crc, const absl::Cord& cord);
 #endif
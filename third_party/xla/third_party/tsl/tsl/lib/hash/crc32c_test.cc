@@ -67,6 +67,13 @@ TEST(CRC, Extend) {
   ASSERT_EQ(Value("hello world", 11), Extend(Value("hello ", 6), "world", 5));
 }
 
+TEST(CRC, MemcpyExtend) {
+  char buf[6];
+  ASSERT_EQ(Value("hello world", 11),
+            MemcpyExtend(Value("hello ", 6), buf, "world", 5));
+  ASSERT_EQ("world", std::string(buf, 5));
+}
+
 TEST(CRC, Mask) {
   uint32 crc = Value("foo", 3);
   ASSERT_NE(crc, Mask(crc));
@@ -15,6 +15,8 @@ limitations under the License.
 
 #include "tsl/lib/io/buffered_inputstream.h"
 
+#include <cstring>
+
 #include "absl/status/status.h"
 #include "tsl/lib/io/random_inputstream.h"
 
@@ -56,37 +58,56 @@ Status BufferedInputStream::FillBuffer() {
   return s;
 }
 
+namespace {
+
+// Appends [`begin`, `end`) to `*result`, without the '\r' characters.
+template <typename StringType>
+void AppendWithoutCarriageReturns(const char* begin, const char* end,
+                                  StringType* result) {
+  while (begin < end) {
+    const char* cr =
+        static_cast<const char*>(memchr(begin, '\r', end - begin));
+    if (cr == nullptr) {
+      result->append(begin, end - begin);
+      return;
+    }
+    result->append(begin, cr - begin);
+    begin = cr + 1;
+  }
+}
+
+}  // namespace
+
 template <typename StringType>
 Status BufferedInputStream::ReadLineHelper(StringType* result,
                                            bool include_eol) {
   result->clear();
   Status s;
-  size_t start_pos = pos_;
   while (true) {
     if (pos_ == limit_) {
-      result->append(buf_.data() + start_pos, pos_ - start_pos);
       // Get more data into buffer
       s = FillBuffer();
       if (limit_ == 0) {
         break;
       }
-      start_pos = pos_;
     }
-    char c = buf_[pos_];
-    if (c == '\n') {
-      result->append(buf_.data() + start_pos, pos_ - start_pos);
+    // `memchr` scans many bytes at a time, so lines are found and copied one
+    // buffer at a time rather than one character at a time.
+    const char* begin = buf_.data() + pos_;
+    const char* end = buf_.data() + limit_;
+    const char* newline =
+        static_cast<const char*>(memchr(begin, '\n', end - begin));
+    if (newline != nullptr) {
+      // We don't append '\r' to *result
+      AppendWithoutCarriageReturns(begin, newline, result);
       if (include_eol) {
-        result->append(1, c);
+        result->append(1, '\n');
       }
-      pos_++;
+      pos_ += newline - begin + 1;
       return OkStatus();
     }
-    // We don't append '\r' to *result
-    if (c == '\r') {
-      result->append(buf_.data() + start_pos, pos_ - start_pos);
-      start_pos = pos_ + 1;
-    }
-    pos_++;
+    AppendWithoutCarriageReturns(begin, end, result);
+    pos_ = limit_;
   }
   if (absl::IsOutOfRange(s) && !result->empty()) {
     return OkStatus();
@@ -239,11 +260,15 @@ Status BufferedInputStream::SkipLine() {
         break;
       }
     }
-    char c = buf_[pos_++];
     skipped = true;
-    if (c == '\n') {
+    const char* begin = buf_.data() + pos_;
+    const char* newline =
+        static_cast<const char*>(memchr(begin, '\n', limit_ - pos_));
+    if (newline != nullptr) {
+      pos_ += newline - begin + 1;
       return OkStatus();
     }
+    pos_ = limit_;
   }
   if (absl::IsOutOfRange(s) && skipped) {
     return OkStatus();
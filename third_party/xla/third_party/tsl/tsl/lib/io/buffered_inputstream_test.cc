@@ -15,6 +15,7 @@ limitations under the License.
 
 #include "tsl/lib/io/buffered_inputstream.h"
 
+#include "absl/strings/str_cat.h"
 #include "tsl/lib/core/status_test_util.h"
 #include "tsl/lib/io/random_inputstream.h"
 #include "tsl/platform/env.h"
@@ -189,6 +190,33 @@ TEST(BufferedInputStream, ReadLine_CRLF) {
   }
 }
 
+TEST(BufferedInputStream, ReadLine_CarriageReturnsAndLongLines) {
+  Env* env = Env::Default();
+  string fname;
+  ASSERT_TRUE(env->LocalTempFilename(&fname));
+  const string long_line(100000, 'x');
+  TF_ASSERT_OK(WriteStringToFile(
+      env, fname, absl::StrCat("a\rb\r\rc\n", long_line, "\n\r\r\nend\r")));
+  std::unique_ptr<RandomAccessFile> file;
+  TF_ASSERT_OK(env->NewRandomAccessFile(fname, &file));
+
+  for (auto buf_size : BufferSizes()) {
+    std::unique_ptr<RandomAccessInputStream> input_stream(
+        new RandomAccessInputStream(file.get()));
+    BufferedInputStream in(input_stream.get(), buf_size);
+    tstring line;
+    TF_ASSERT_OK(in.ReadLine(&line));
+    EXPECT_EQ(line, "abc");
+    TF_ASSERT_OK(in.ReadLine(&line));
+    EXPECT_EQ(line, long_line);
+    TF_ASSERT_OK(in.ReadLine(&line));
+    EXPECT_EQ(line, "");
+    TF_ASSERT_OK(in.ReadLine(&line));
+    EXPECT_EQ(line, "end");
+    EXPECT_TRUE(errors::IsOutOfRange(in.ReadLine(&line)));
+  }
+}
+
 TEST(BufferedInputStream, SkipLine1) {
   Env* env = Env::Default();
   string fname;
@@ -0,0 +1,189 @@
+/* Copyright 2024 The TensorFlow Authors. All Rights Reserved.
+
+Licensed under the Apache License, Version 2.0 (the "License");
+you may not use this file except in compliance with the License.
+You may obtain a copy of the License at
+
+    http://www.apache.org/licenses/LICENSE-2.0
+
+Unless required by applicable law or agreed to in writing, software
+distributed under the License is distributed on an "AS IS" BASIS,
+WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+See the License for the specific language governing permissions and
+limitations under the License.
+==============================================================================*/
+#include "tsl/lib/io/read_ahead_inputstream.h"
+
+#include <algorithm>
+#include <cstring>
+#include <memory>
+
+#include "tsl/lib/hash/crc32c.h"
+#include "tsl/platform/env.h"
+#include "tsl/platform/errors.h"
+#include "tsl/platform/threadpool.h"
+
+namespace tsl {
+namespace io {
+namespace {
+
+// The number of reads that can be in flight at once in the process. This is
+// enough to keep the queues of local NVMe drives deep, while the reads of
+// remote file systems, which have their own read-ahead, are rarely limited by
+// it.
+constexpr int kNumReadThreads = 16;
+
+thread::ThreadPool* ReadThreadPool() {
+  static thread::ThreadPool* pool = new thread::ThreadPool(
+      Env::Default(), ThreadOptions(), "read_ahead", kNumReadThreads);
+  return pool;
+}
+
+}  // namespace
+
+ReadAheadInputStream::ReadAheadInputStream(RandomAccessFile* file,
+                                           size_t block_size, int num_blocks)
+    : file_(file),
+      block_size_(std::max<size_t>(block_size, 1)),
+      num_blocks_(std::max(num_blocks, 1)) {}
+
+ReadAheadInputStream::~ReadAheadInputStream() {
+  mutex_lock l(mu_);
+  while (num_in_flight_ > 0) {
+    cv_.wait(l);
+  }
+}
+
+void ReadAheadInputStream::IssueReads() {
+  while (blocks_.size() < static_cast<size_t>(num_blocks_) &&
+         next_offset_ < file_size_) {
+    auto block = std::make_shared<Block>(next_offset_, block_size_);
+    next_offset_ += block_size_;
+    blocks_.push_back(block);
+    ++num_in_flight_;
+    ReadThreadPool()->Schedule([this, block]() {
+      StringPiece data;
+      Status s = file_->Read(block->offset, block_size_, &data,
+                             block->scratch.get());
+      mutex_lock l(mu_);
+      block->data = data;
+      block->status = s;
+      block->done = true;
+      if ((s.ok() || errors::IsOutOfRange(s)) && data.size() < block_size_) {
+        file_size_ =
+            std::min<uint64_t>(file_size_, block->offset + data.size());
+      }
+      --num_in_flight_;
+      cv_.notify_all();
+    });
+  }
+}
+
+Status ReadAheadInputStream::Consume(int64_t bytes_to_read, tstring* result,
+                                     uint32* crc, mutex_lock& l) {
+  char* dst = nullptr;
+  if (result != nullptr) {
+    result->resize_uninitialized(bytes_to_read);
+    dst = &(*result)[0];
+  }
+  int64_t bytes_read = 0;
+  Status status = OkStatus();
+  while (bytes_read < bytes_to_read) {
+    IssueReads();
+    if (blocks_.empty()) {
+      break;
+    }
+    const Block* block = blocks_.front().get();
+    while (!block->done) {
+      cv_.wait(l);
+    }
+    if (!block->status.ok() && !errors::IsOutOfRange(block->status)) {
+      status = block->status;
+      break;
+    }
+    if (block_pos_ >= block->data.size()) {
+      break;
+    }
+    const size_t n = std::min<int64_t>(bytes_to_read - bytes_read,
+                                       block->data.size() - block_pos_);
+    const char* src = block->data.data() + block_pos_;
+    if (crc != nullptr) {
+      *crc = crc32c::MemcpyExtend(*crc, dst + bytes_read, src, n);
+    } else if (dst != nullptr) {
+      memcpy(dst + bytes_read, src, n);
+    }
+    block_pos_ += n;
+    pos_ += n;
+    bytes_read += n;
+    if (block_pos_ == block_size_) {
+      blocks_.pop_front();
+      block_pos_ = 0;
+    }
+  }
+  if (result != nullptr) {
+    result->resize(bytes_read);
+  }
+  if (status.ok() && bytes_read < bytes_to_read) {
+    return errors::OutOfRange("reached end of file");
+  }
+  return status;
+}
+
+void ReadAheadInputStream::DropBlocks() {
+  blocks_.clear();
+  block_pos_ = 0;
+  next_offset_ = pos_;
+}
+
+Status ReadAheadInputStream::ReadNBytes(int64_t bytes_to_read,
+                                        tstring* result) {
+  if (bytes_to_read < 0) {
+    return errors::InvalidArgument("Can't read a negative number of bytes: ",
+                                   bytes_to_read);
+  }
+  mutex_lock l(mu_);
+  return Consume(bytes_to_read, result, /*crc=*/nullptr, l);
+}
+
+Status ReadAheadInputStream::ReadNBytesWithCrc32c(int64_t bytes_to_read,
+                                                  tstring* result,
+                                                  uint32* crc) {
+  if (bytes_to_read < 0) {
+    return errors::InvalidArgument("Can't read a negative number of bytes: ",
+                                   bytes_to_read);
+  }
+  *crc = 0;
+  mutex_lock l(mu_);
+  return Consume(bytes_to_read, result, crc, l);
+}
+
+Status ReadAheadInputStream::SkipNBytes(int64_t bytes_to_skip) {
+  if (bytes_to_skip < 0) {
+    return errors::InvalidArgument("Can't skip a negative number of bytes: ",
+                                   bytes_to_skip);
+  }
+  const uint64_t target = pos_ + bytes_to_skip;
+  if (target > next_offset_) {
+    // Rather than reading up to the target, check that it is within the file
+    // and restart the reads there.
+    char scratch;
+    StringPiece data;
+    Status s = file_->Read(target - 1, 1, &data, &scratch);
+    if ((s.ok() || errors::IsOutOfRange(s)) && data.size() == 1) {
+      pos_ = target;
+      DropBlocks();
+      return OkStatus();
+    }
+  }
+  mutex_lock l(mu_);
+  return Consume(bytes_to_skip, /*result=*/nullptr, /*crc=*/nullptr, l);
+}
+
+Status ReadAheadInputStream::Reset() {
+  pos_ = 0;
+  DropBlocks();
+  return OkStatus();
+}
+
+}  // namespace io
+}  // namespace tsl
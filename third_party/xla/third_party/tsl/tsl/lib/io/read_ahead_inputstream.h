@@ -0,0 +1,117 @@
+/* Copyright 2024 The TensorFlow Authors. All Rights Reserved.
+
+Licensed under the Apache License, Version 2.0 (the "License");
+you may not use this file except in compliance with the License.
+You may obtain a copy of the License at
+
+    http://www.apache.org/licenses/LICENSE-2.0
+
+Unless required by applicable law or agreed to in writing, software
+distributed under the License is distributed on an "AS IS" BASIS,
+WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+See the License for the specific language governing permissions and
+limitations under the License.
+==============================================================================*/
+#ifndef TENSORFLOW_TSL_LIB_IO_READ_AHEAD_INPUTSTREAM_H_
+#define TENSORFLOW_TSL_LIB_IO_READ_AHEAD_INPUTSTREAM_H_
+
+#include <cstdint>
+#include <deque>
+#include <memory>
+
+#include "tsl/lib/io/inputstream_interface.h"
+#include "tsl/platform/file_system.h"
+#include "tsl/platform/mutex.h"
+#include "tsl/platform/stringpiece.h"
+#include "tsl/platform/thread_annotations.h"
+#include "tsl/platform/types.h"
+
+namespace tsl {
+namespace io {
+
+// Reads a RandomAccessFile sequentially, keeping the reads of the next
+// `num_blocks` blocks of `block_size` bytes in flight. The reads are issued
+// on a small thread pool that is shared by all the streams of the process, so
+// that many files can be read with a deep queue of outstanding reads without
+// dedicating a thread to each of them. A block is returned to the reader in
+// the buffer that it was read into.
+//
+// Skipping past the blocks in flight drops them and restarts the reads at the
+// new position. A single instance of ReadAheadInputStream is NOT safe for
+// concurrent use by multiple threads.
+class ReadAheadInputStream : public InputStreamInterface {
+ public:
+  // Does not take ownership of `file`, which must outlive *this.
+  ReadAheadInputStream(RandomAccessFile* file, size_t block_size,
+                       int num_blocks);
+
+  // Waits for the reads in flight to complete.
+  ~ReadAheadInputStream() override;
+
+  Status ReadNBytes(int64_t bytes_to_read, tstring* result) override;
+
+  // Like ReadNBytes(), but also sets `*crc` to the crc32c of the bytes read,
+  // which is computed while they are copied out of the read buffers.
+  Status ReadNBytesWithCrc32c(int64_t bytes_to_read, tstring* result,
+                              uint32* crc);
+
+  Status SkipNBytes(int64_t bytes_to_skip) override;
+
+  int64_t Tell() const override { return pos_; }
+
+  Status Reset() override;
+
+ private:
+  struct Block {
+    explicit Block(uint64_t offset, size_t size)
+        : offset(offset), scratch(new char[size]) {}
+
+    const uint64_t offset;
+    std::unique_ptr<char[]> scratch;
+    // The fields below are guarded by the `mu_` of the stream.
+    bool done = false;
+    Status status;
+    StringPiece data;
+  };
+
+  // Issues reads until `num_blocks_` blocks are queued or the end of the file
+  // is known to have been reached.
+  void IssueReads() TF_EXCLUSIVE_LOCKS_REQUIRED(mu_);
+
+  // Reads or, if `result` is null, skips `bytes_to_read` bytes from the
+  // queued blocks, waiting for their reads to complete. If `crc` is not null,
+  // extends `*crc` with the bytes read.
+  Status Consume(int64_t bytes_to_read, tstring* result, uint32* crc,
+                 mutex_lock& l)
+      TF_EXCLUSIVE_LOCKS_REQUIRED(mu_);
+
+  // Drops the queued blocks, whose reads may still be in flight, so that the
+  // next reads start at `pos_`.
+  void DropBlocks();
+
+  RandomAccessFile* const file_;
+  const size_t block_size_;
+  const int num_blocks_;
+
+  // The position of the reader in the file, the offset of the next block to
+  // read, and the position of the reader in the first queued block. These are
+  // only accessed by the reader.
+  int64_t pos_ = 0;
+  uint64_t next_offset_ = 0;
+  size_t block_pos_ = 0;
+  std::deque<std::shared_ptr<Block>> blocks_;
+
+  mutex mu_;
+  condition_variable cv_;
+  int num_in_flight_ TF_GUARDED_BY(mu_) = 0;
+  // The size of the file, once a read has reached its end.
+  uint64_t file_size_ TF_GUARDED_BY(mu_) = UINT64_MAX;
+
+  ReadAheadInputStream(const ReadAheadInputStream&) = delete;
+  void operator=(const ReadAheadInputStream&) = delete;
+};
+
+}  // namespace io
+}  // namespace tsl
+
+#endif  // TENSORFLOW_TSL_LIB_IO_READ_AHEAD_INPUTSTREAM_H_
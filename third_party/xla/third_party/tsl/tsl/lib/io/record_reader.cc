@@ -21,6 +21,7 @@ limitations under the License.
 #include "tsl/lib/io/buffered_inputstream.h"
 #include "tsl/lib/io/compression.h"
 #include "tsl/lib/io/random_inputstream.h"
+#include "tsl/lib/io/read_ahead_inputstream.h"
 #include "tsl/platform/env.h"
 #include "tsl/platform/errors.h"
 #include "tsl/platform/raw_coding.h"
@@ -59,7 +60,11 @@ RecordReader::RecordReader(RandomAccessFile* file,
     : options_(options),
       input_stream_(new RandomAccessInputStream(file)),
       last_read_failed_(false) {
-  if (options.buffer_size > 0) {
+  if (options.buffer_size > 0 && options.read_ahead_blocks > 0) {
+    read_ahead_stream_ = new ReadAheadInputStream(file, options.buffer_size,
+                                                  options.read_ahead_blocks);
+    input_stream_.reset(read_ahead_stream_);
+  } else if (options.buffer_size > 0) {
     input_stream_.reset(new BufferedInputStream(input_stream_.release(),
                                                 options.buffer_size, true));
   }
@@ -83,6 +88,9 @@ RecordReader::RecordReader(RandomAccessFile* file,
     LOG(FATAL) << "Unrecognized compression type :" << options.compression_type;
   }
 #endif
+  if (options.compression_type != RecordReaderOptions::NONE) {
+    read_ahead_stream_ = nullptr;
+  }
 }
 
 namespace {
@@ -101,17 +109,33 @@ inline const char* GetChecksumErrorSuffix(uint64 offset) {
 // and is used only in error messages. For failures at offset 0,
 // a reminder about the file format is added, because TFRecord files
 // contain no explicit format marker.
-Status RecordReader::ReadChecksummed(uint64 offset, size_t n, tstring* result) {
+Status RecordReader::ReadChecksummed(uint64 offset, size_t n, tstring* result,
+                                     bool verify_checksum) {
   if (n >= SIZE_MAX - sizeof(uint32)) {
     return errors::DataLoss("record size too large",
                             GetChecksumErrorSuffix(offset));
   }
 
   const size_t expected = n + sizeof(uint32);
-  TF_RETURN_IF_ERROR(input_stream_->ReadNBytes(expected, result));
+  size_t bytes_read;
+  uint32 crc = 0;
+  tstring footer;
+  if (verify_checksum && read_ahead_stream_ != nullptr) {
+    // Compute the checksum while copying the data out of the read buffers.
+    TF_RETURN_IF_ERROR(
+        read_ahead_stream_->ReadNBytesWithCrc32c(n, result, &crc));
+    if (result->size() == n) {
+      TF_RETURN_IF_ERROR(
+          read_ahead_stream_->ReadNBytes(sizeof(uint32), &footer));
+    }
+    bytes_read = result->size() + footer.size();
+  } else {
+    TF_RETURN_IF_ERROR(input_stream_->ReadNBytes(expected, result));
+    bytes_read = result->size();
+  }
 
-  if (result->size() != expected) {
-    if (result->empty()) {
+  if (bytes_read != expected) {
+    if (bytes_read == 0) {
       return errors::OutOfRange("eof", GetChecksumErrorSuffix(offset));
     } else {
       return errors::DataLoss("truncated record at ", offset,
@@ -119,10 +143,18 @@ Status RecordReader::ReadChecksummed(uint64 offset, size_t n, tstring* result) {
     }
   }
 
-  const uint32 masked_crc = core::DecodeFixed32(result->data() + n);
-  if (crc32c::Unmask(masked_crc) != crc32c::Value(result->data(), n)) {
-    return errors::DataLoss("corrupted record at ", offset,
-                            GetChecksumErrorSuffix(offset));
+  if (verify_checksum) {
+    uint32 masked_crc;
+    if (footer.empty()) {
+      masked_crc = core::DecodeFixed32(result->data() + n);
+      crc = crc32c::Value(result->data(), n);
+    } else {
+      masked_crc = core::DecodeFixed32(footer.data());
+    }
+    if (crc32c::Unmask(masked_crc) != crc) {
+      return errors::DataLoss("corrupted record at ", offset,
+                              GetChecksumErrorSuffix(offset));
+    }
   }
   result->resize(n);
   return OkStatus();
@@ -208,7 +240,10 @@ Status RecordReader::ReadRecord(uint64* offset, tstring* record) {
   const uint64 length = core::DecodeFixed64(record->data());
 
   // Read data
-  s = ReadChecksummed(*offset + kHeaderSize, length, record);
+  const int64_t interval = options_.payload_checksum_interval;
+  const bool verify_checksum =
+      interval > 0 && num_payloads_read_++ % interval == 0;
+  s = ReadChecksummed(*offset + kHeaderSize, length, record, verify_checksum);
   if (!s.ok()) {
     last_read_failed_ = true;
     if (errors::IsOutOfRange(s)) {
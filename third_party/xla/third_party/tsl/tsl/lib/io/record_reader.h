@@ -32,6 +32,7 @@ namespace tsl {
 class RandomAccessFile;
 
 namespace io {
+class ReadAheadInputStream;
 
 struct RecordReaderOptions {
   enum CompressionType {
@@ -46,6 +47,19 @@ struct RecordReaderOptions {
   // compressed files.) Consider using SequentialRecordReader.
   int64_t buffer_size = 0;
 
+  // If both buffer_size and read_ahead_blocks are non-zero, the reads of the
+  // next read_ahead_blocks blocks of buffer_size bytes are kept in flight in
+  // the background, instead of each buffer being filled when it is needed.
+  // The same restrictions on skipping around apply.
+  int read_ahead_blocks = 0;
+
+  // The checksum of the data of one in every payload_checksum_interval
+  // records is verified, or of none if it is 0. The checksums of the record
+  // headers, which hold the lengths of the records, are always verified.
+  // Values other than 1 are only suitable for storage that verifies the
+  // integrity of the data itself.
+  int64_t payload_checksum_interval = 1;
+
   static RecordReaderOptions CreateRecordReaderOptions(
       const string& compression_type);
 
@@ -115,12 +129,17 @@ class RecordReader {
   Status GetMetadata(Metadata* md);
 
  private:
-  Status ReadChecksummed(uint64 offset, size_t n, tstring* result);
+  Status ReadChecksummed(uint64 offset, size_t n, tstring* result,
+                         bool verify_checksum = true);
   Status PositionInputStream(uint64 offset);
 
   RecordReaderOptions options_;
   std::unique_ptr<InputStreamInterface> input_stream_;
+  // `input_stream_` if it reads uncompressed data ahead, or nullptr.
+  ReadAheadInputStream* read_ahead_stream_ = nullptr;
   bool last_read_failed_;
+  // The number of record payloads that have been read.
+  int64_t num_payloads_read_ = 0;
 
   std::unique_ptr<Metadata> cached_metadata_;
 
@@ -233,6 +233,46 @@ TEST(RecordReaderWriterTest, TestSkipOutOfRange) {
   }
 }
 
+TEST(RecordReaderWriterTest, TestReadAhead) {
+  Env* env = Env::Default();
+  string fname = testing::TmpDir() + "/record_reader_writer_read_ahead_test";
+
+  {
+    std::unique_ptr<WritableFile> file;
+    TF_CHECK_OK(env->NewWritableFile(fname, &file));
+    io::RecordWriter writer(file.get());
+    for (int i = 0; i < 100; ++i) {
+      TF_EXPECT_OK(writer.WriteRecord(strings::StrCat("record_", i)));
+    }
+    TF_CHECK_OK(writer.Flush());
+  }
+
+  for (auto buf_size : BufferSizes()) {
+    std::unique_ptr<RandomAccessFile> read_file;
+    TF_CHECK_OK(env->NewRandomAccessFile(fname, &read_file));
+    io::RecordReaderOptions options;
+    options.buffer_size = buf_size;
+    options.read_ahead_blocks = 3;
+    io::RecordReader reader(read_file.get(), options);
+    uint64 offset = 0;
+    int num_skipped;
+    tstring record;
+    for (int i = 0; i < 90; i += 10) {
+      TF_CHECK_OK(reader.ReadRecord(&offset, &record));
+      EXPECT_EQ(strings::StrCat("record_", i), record);
+      TF_CHECK_OK(reader.SkipRecords(&offset, 9, &num_skipped));
+      EXPECT_EQ(9, num_skipped);
+    }
+    Status s = reader.SkipRecords(&offset, 20, &num_skipped);
+    EXPECT_EQ(10, num_skipped);
+    EXPECT_EQ(error::OUT_OF_RANGE, s.code());
+
+    io::RecordReader::Metadata md;
+    TF_ASSERT_OK(reader.GetMetadata(&md));
+    EXPECT_EQ(100, md.stats.entries);
+  }
+}
+
 TEST(RecordReaderWriterTest, TestMalformedInput) {
   Env* env = Env::Default();
   string fname =
@@ -267,6 +307,57 @@ TEST(RecordReaderWriterTest, TestMalformedInput) {
   }
 }
 
+TEST(RecordReaderWriterTest, TestPayloadChecksumInterval) {
+  Env* env = Env::Default();
+  string fname =
+      testing::TmpDir() + "/record_reader_writer_payload_checksum_test";
+
+  {
+    std::unique_ptr<WritableFile> file;
+    TF_CHECK_OK(env->NewWritableFile(fname, &file));
+    io::RecordWriter writer(file.get());
+    for (int i = 0; i < 4; ++i) {
+      TF_EXPECT_OK(writer.WriteRecord("abc"));
+    }
+    TF_CHECK_OK(writer.Flush());
+  }
+  {
+    // Corrupt the data of the second and third records, which start at
+    // offsets 19 and 38.
+    string contents;
+    TF_CHECK_OK(ReadFileToString(env, fname, &contents));
+    contents[19 + io::RecordReader::kHeaderSize] = 'x';
+    contents[38 + io::RecordReader::kHeaderSize] = 'x';
+    TF_CHECK_OK(WriteStringToFile(env, fname, contents));
+  }
+
+  for (int read_ahead_blocks : {0, 2}) {
+    std::unique_ptr<RandomAccessFile> read_file;
+    TF_CHECK_OK(env->NewRandomAccessFile(fname, &read_file));
+    io::RecordReaderOptions options;
+    options.buffer_size = 8;
+    options.read_ahead_blocks = read_ahead_blocks;
+    options.payload_checksum_interval = 2;
+    io::RecordReader reader(read_file.get(), options);
+    uint64 offset = 0;
+    tstring record;
+    TF_CHECK_OK(reader.ReadRecord(&offset, &record));
+    EXPECT_EQ("abc", record);
+    TF_CHECK_OK(reader.ReadRecord(&offset, &record));
+    EXPECT_EQ("xbc", record);
+    Status s = reader.ReadRecord(&offset, &record);
+    EXPECT_EQ(error::DATA_LOSS, s.code());
+    EXPECT_EQ("corrupted record at 50", s.message());
+
+    options.payload_checksum_interval = 0;
+    io::RecordReader unverified_reader(read_file.get(), options);
+    offset = 0;
+    for (int i = 0; i < 4; ++i) {
+      TF_CHECK_OK(unverified_reader.ReadRecord(&offset, &record));
+    }
+  }
+}
+
 TEST(RecordReaderWriterTest, TestSnappy) {
   Env* env = Env::Default();
   string fname = testing::TmpDir() + "/record_reader_writer_snappy_test";
@@ -16,20 +16,126 @@ limitations under the License.
 #ifndef TENSORFLOW_TSL_PLATFORM_DEFAULT_CONTEXT_H_
 #define TENSORFLOW_TSL_PLATFORM_DEFAULT_CONTEXT_H_
 
+#include <time.h>
+
+#include <atomic>
+#include <cstdint>
+#include <memory>
+#include <utility>
+
 namespace tsl {
 
+// ContextCpuTime accumulates the CPU time of the threads while they run with
+// a Context that carries it, e.g. the CPU time used on behalf of a request by
+// the closures it schedules on the inter-op and intra-op thread pools.
+//
+// This class is thread-safe.
+class ContextCpuTime {
+ public:
+  ContextCpuTime() = default;
+
+  // Makes the current thread run with `cpu_time` until the end of the
+  // enclosing WithContext scope, so that the contexts captured by the thread
+  // carry it.
+  static void AttachToCurrentThread(std::shared_ptr<ContextCpuTime> cpu_time) {
+    ThreadState& state = CurrentThreadState();
+    if (state.cpu_time == cpu_time) return;
+    state.Switch(std::move(cpu_time));
+  }
+
+  // The CPU time accumulated so far, including the time of the current thread
+  // if it runs with this object.
+  int64_t nanos() const {
+    int64_t nanos = nanos_.load(std::memory_order_relaxed);
+    const ThreadState& state = CurrentThreadState();
+    if (state.cpu_time.get() == this) {
+      nanos += ThreadCpuTimeNanos() - state.start_nanos;
+    }
+    return nanos;
+  }
+
+ private:
+  friend class Context;
+  friend class WithContext;
+
+  // The object the current thread runs with, and the CPU time of the thread
+  // when it started to.
+  struct ThreadState {
+    // Charges the CPU time since `start_nanos` and runs with `next`.
+    void Switch(std::shared_ptr<ContextCpuTime> next) {
+      const int64_t now_nanos =
+          cpu_time != nullptr || next != nullptr ? ThreadCpuTimeNanos() : 0;
+      if (cpu_time != nullptr) {
+        cpu_time->nanos_.fetch_add(now_nanos - start_nanos,
+                                   std::memory_order_relaxed);
+      }
+      cpu_time = std::move(next);
+      start_nanos = now_nanos;
+    }
+
+    std::shared_ptr<ContextCpuTime> cpu_time;
+    int64_t start_nanos = 0;
+  };
+
+  static ThreadState& CurrentThreadState() {
+    static thread_local ThreadState state;
+    return state;
+  }
+
+  static int64_t ThreadCpuTimeNanos() {
+#if defined(CLOCK_THREAD_CPUTIME_ID)
+    struct timespec ts;
+    clock_gettime(CLOCK_THREAD_CPUTIME_ID, &ts);
+    return static_cast<int64_t>(ts.tv_sec) * 1000000000 + ts.tv_nsec;
+#else
+    return 0;
+#endif
+  }
+
+  std::atomic<int64_t> nanos_{0};
+
+  ContextCpuTime(const ContextCpuTime&) = delete;
+  void operator=(const ContextCpuTime&) = delete;
+};
+
 class Context {
  public:
   Context() {}
-  Context(const ContextKind kind) {}
+  Context(const ContextKind kind) {
+    if (kind == ContextKind::kThread) {
+      cpu_time_ = ContextCpuTime::CurrentThreadState().cpu_time;
+    }
+  }
+
+  bool operator==(const Context& other) const {
+    return cpu_time_ == other.cpu_time_;
+  }
 
-  bool operator==(const Context& other) const { return true; }
+ private:
+  friend class WithContext;
+
+  std::shared_ptr<ContextCpuTime> cpu_time_;
 };
 
 class WithContext {
  public:
-  explicit WithContext(const Context& x) {}
-  ~WithContext() {}
+  explicit WithContext(const Context& x)
+      : previous_cpu_time_(ContextCpuTime::CurrentThreadState().cpu_time) {
+    if (previous_cpu_time_ != x.cpu_time_) {
+      ContextCpuTime::CurrentThreadState().Switch(x.cpu_time_);
+    }
+  }
+  // Also undoes the ContextCpuTime::AttachToCurrentThread() calls of the
+  // scope.
+  ~WithContext() {
+    ContextCpuTime::ThreadState& state = ContextCpuTime::CurrentThreadState();
+    if (state.cpu_time != previous_cpu_time_) {
+      state.Switch(std::move(previous_cpu_time_));
+    }
+  }
+
+ private:
+  std::shared_ptr<ContextCpuTime> previous_cpu_time_;
 };
 
 }  // namespace tsl
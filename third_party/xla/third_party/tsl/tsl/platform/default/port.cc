@@ -25,6 +25,7 @@ limitations under the License.
 
 #if defined(__linux__)
 #include <sched.h>
+#include <sys/mman.h>
 #include <sys/sysinfo.h>
 #else
 #include <sys/syscall.h>
@@ -417,6 +418,57 @@ void* Realloc(void* ptr, size_t size) { return realloc(ptr, size); }
 
 void Free(void* ptr) { free(ptr); }
 
+#if defined(__linux__)
+static size_t RoundUpToHugePage(size_t size) {
+  return (size + kHugePageSize - 1) & ~(kHugePageSize - 1);
+}
+#endif
+
+void* HugePageMalloc(size_t size, bool use_hugetlb, bool* huge_pages) {
+  *huge_pages = false;
+#if defined(__linux__)
+  const size_t rounded_size = RoundUpToHugePage(size);
+#ifdef MAP_HUGETLB
+  if (use_hugetlb) {
+    void* ptr = mmap(nullptr, rounded_size, PROT_READ | PROT_WRITE,
+                     MAP_PRIVATE | MAP_ANONYMOUS | MAP_HUGETLB, -1, 0);
+    if (ptr != MAP_FAILED) {
+      *huge_pages = true;
+      return ptr;
+    }
+    // Fall back to transparent huge pages if the reserved pool is exhausted.
+  }
+#endif  // MAP_HUGETLB
+  // Over-allocate by one huge page, and unmap the unaligned head and tail.
+  void* mapped =
+      mmap(nullptr, rounded_size + kHugePageSize, PROT_READ | PROT_WRITE,
+           MAP_PRIVATE | MAP_ANONYMOUS, -1, 0);
+  if (mapped == MAP_FAILED) return nullptr;
+  char* base = static_cast<char*>(mapped);
+  const uintptr_t addr = reinterpret_cast<uintptr_t>(base);
+  char* ptr = reinterpret_cast<char*>((addr + kHugePageSize - 1) &
+                                      ~(kHugePageSize - 1));
+  const size_t head = ptr - base;
+  if (head > 0) munmap(base, head);
+  munmap(ptr + rounded_size, kHugePageSize - head);
+#ifdef MADV_HUGEPAGE
+  *huge_pages = madvise(ptr, rounded_size, MADV_HUGEPAGE) == 0;
+#endif  // MADV_HUGEPAGE
+  return ptr;
+#else
+  return AlignedMalloc(size, kHugePageSize);
+#endif  // defined(__linux__)
+}
+
+void HugePageFree(void* ptr, size_t size) {
+  if (ptr == nullptr) return;
+#if defined(__linux__)
+  munmap(ptr, RoundUpToHugePage(size));
+#else
+  AlignedFree(ptr);
+#endif  // defined(__linux__)
+}
+
 void MallocExtension_ReleaseToSystem(std::size_t num_bytes) {
   // No-op.
 }
@@ -33,6 +33,20 @@ void* Malloc(size_t size);
 void* Realloc(void* ptr, size_t size);
 void Free(void* ptr);
 
+// The size of the huge pages requested by `HugePageMalloc`.
+constexpr size_t kHugePageSize = 2 << 20;
+
+// Allocates at least `size` bytes aligned to `kHugePageSize`, and backed by
+// huge pages where the platform supports them. If `use_hugetlb` is true, the
+// memory is taken from the pool of explicitly reserved huge pages if possible;
+// otherwise, transparent huge pages are requested for it. Sets `*huge_pages`
+// to true iff the memory was placed in huge pages, or marked as eligible for
+// transparent huge pages. Returns nullptr on failure.
+//
+// The memory must be released by `HugePageFree` with the same `size`.
+void* HugePageMalloc(size_t size, bool use_hugetlb, bool* huge_pages);
+void HugePageFree(void* ptr, size_t size);
+
 // Tries to release num_bytes of free memory back to the operating
 // system for reuse.  Use this routine with caution -- to get this
 // memory back may require faulting pages back in by the OS, and
@@ -217,6 +217,15 @@ void* Realloc(void* ptr, size_t size) { return realloc(ptr, size); }
 
 void Free(void* ptr) { free(ptr); }
 
+void* HugePageMalloc(size_t size, bool use_hugetlb, bool* huge_pages) {
+  // Large pages require the SeLockMemoryPrivilege on Windows, so only the
+  // alignment is provided.
+  *huge_pages = false;
+  return AlignedMalloc(size, kHugePageSize);
+}
+
+void HugePageFree(void* ptr, size_t size) { AlignedFree(ptr); }
+
 void MallocExtension_ReleaseToSystem(std::size_t num_bytes) {
   // No-op.
 }
@@ -373,14 +373,23 @@ TraceMeRecorder::Events TraceMeRecorder::Consume() {
   return result;
 }
 
-bool TraceMeRecorder::StartRecording(int level) {
+bool TraceMeRecorder::StartRecording(int level, bool background) {
   level = std::max(0, level);
   mutex_lock lock(mutex_);
   // Change trace_level_ while holding mutex_.
   int expected = kTracingDisabled;
   bool started = internal::g_trace_level.compare_exchange_strong(
       expected, level, std::memory_order_acq_rel);
+  if (!started && background_ && !background) {
+    // Preempt the background recording and drop its events. Consume rather
+    // than Clear, since threads may have been destroyed while recording.
+    internal::g_trace_level.store(level, std::memory_order_release);
+    background_ = false;
+    Events dropped = Consume();
+    return true;
+  }
   if (started) {
+    background_ = background;
     // We may have old events in buffers because Record() raced with Stop().
     Clear();
   }
@@ -400,9 +409,20 @@ TraceMeRecorder::Events TraceMeRecorder::StopRecording() {
           kTracingDisabled, std::memory_order_acq_rel) != kTracingDisabled) {
     events = Consume();
   }
+  background_ = false;
   return events;
 }
 
+bool TraceMeRecorder::StopBackgroundRecording(Events* events) {
+  mutex_lock lock(mutex_);
+  // The recording was preempted, and maybe stopped, by a foreground one.
+  if (!background_) return false;
+  background_ = false;
+  internal::g_trace_level.store(kTracingDisabled, std::memory_order_release);
+  *events = Consume();
+  return true;
+}
+
 /*static*/ int64_t TraceMeRecorder::NewActivityId() {
   // Activity IDs: To avoid contention over a counter, the top 32 bits identify
   // the originating thread, the bottom 32 bits name the event within a thread.
@@ -89,6 +89,20 @@ class TraceMeRecorder {
   // Events passed to Record after Stop has started will be dropped.
   static Events Stop() { return Get()->StopRecording(); }
 
+  // Starts a background recording of TraceMe(), e.g. for continuous sampling.
+  // Unlike a recording started by Start(), it is preempted by a later Start(),
+  // which drops the events recorded so far.
+  // Returns false if a recording is already active.
+  static bool StartBackground(int level) {
+    return Get()->StartRecording(level, /*background=*/true);
+  }
+
+  // Stops a recording started by StartBackground() and returns true with its
+  // events, or returns false if it was preempted by Start().
+  static bool StopBackground(Events* events) {
+    return Get()->StopBackgroundRecording(events);
+  }
+
   // Returns whether we're currently recording. Racy, but cheap!
   static inline bool Active(int level = 1) {
     return internal::g_trace_level.load(std::memory_order_acquire) >= level;
@@ -118,8 +132,9 @@ class TraceMeRecorder {
   void RegisterThread(uint32 tid, std::shared_ptr<ThreadLocalRecorder> thread);
   void UnregisterThread(uint32 tid);
 
-  bool StartRecording(int level);
+  bool StartRecording(int level, bool background = false);
   Events StopRecording();
+  bool StopBackgroundRecording(Events* events);
 
   // Clears events from all active threads that were added due to Record
   // racing with StopRecording.
@@ -138,6 +153,8 @@ class TraceMeRecorder {
   // stops so the events can be retrieved.
   absl::flat_hash_map<uint32, std::shared_ptr<ThreadLocalRecorder>> threads_
       TF_GUARDED_BY(mutex_);
+  // Whether the active recording was started by StartBackground().
+  bool background_ TF_GUARDED_BY(mutex_) = false;
 };
 
 }  // namespace profiler
@@ -56,6 +56,40 @@ TEST(RecorderTest, SingleThreaded) {
               ElementsAre(Named("during1"), Named("during2")));
 }
 
+TEST(RecorderTest, BackgroundRecording) {
+  int64_t start_time = GetCurrentTimeNanos();
+  int64_t end_time = start_time + UniToNano(1);
+
+  ASSERT_TRUE(TraceMeRecorder::StartBackground(/*level=*/1));
+  TraceMeRecorder::Record({"background", start_time, end_time});
+  TraceMeRecorder::Events results;
+  ASSERT_TRUE(TraceMeRecorder::StopBackground(&results));
+  ASSERT_EQ(results.size(), 1);
+  EXPECT_THAT(results[0].events, ElementsAre(Named("background")));
+
+  // A background recording doesn't preempt an active recording.
+  ASSERT_TRUE(TraceMeRecorder::Start(/*level=*/1));
+  EXPECT_FALSE(TraceMeRecorder::StartBackground(/*level=*/1));
+  TraceMeRecorder::Stop();
+}
+
+TEST(RecorderTest, BackgroundRecordingIsPreempted) {
+  int64_t start_time = GetCurrentTimeNanos();
+  int64_t end_time = start_time + UniToNano(1);
+
+  ASSERT_TRUE(TraceMeRecorder::StartBackground(/*level=*/1));
+  TraceMeRecorder::Record({"background", start_time, end_time});
+  ASSERT_TRUE(TraceMeRecorder::Start(/*level=*/1));
+  TraceMeRecorder::Record({"foreground", start_time, end_time});
+
+  TraceMeRecorder::Events background_results;
+  EXPECT_FALSE(TraceMeRecorder::StopBackground(&background_results));
+  EXPECT_TRUE(TraceMeRecorder::Active());
+  auto results = TraceMeRecorder::Stop();
+  ASSERT_EQ(results.size(), 1);
+  EXPECT_THAT(results[0].events, ElementsAre(Named("foreground")));
+}
+
 // Checks the functional behavior of the recorder, when used from several
 // unsynchronized threads.
 //
@@ -0,0 +1,127 @@
+/* Copyright 2024 The TensorFlow Authors. All Rights Reserved.
+
+Licensed under the Apache License, Version 2.0 (the "License");
+you may not use this file except in compliance with the License.
+You may obtain a copy of the License at
+
+    http://www.apache.org/licenses/LICENSE-2.0
+
+Unless required by applicable law or agreed to in writing, software
+distributed under the License is distributed on an "AS IS" BASIS,
+WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+See the License for the specific language governing permissions and
+limitations under the License.
+==============================================================================*/
+#include "tsl/profiler/lib/continuous_profiler.h"
+
+#include <algorithm>
+#include <chrono>  // NOLINT(build/c++11)
+#include <cstdint>
+#include <string>
+#include <utility>
+
+#include "absl/strings/string_view.h"
+#include "absl/time/clock.h"
+#include "absl/time/time.h"
+#include "tsl/platform/env.h"
+#include "tsl/platform/mutex.h"
+#include "tsl/profiler/backends/cpu/traceme_recorder.h"
+#include "tsl/profiler/utils/time_utils.h"
+
+namespace tsl {
+namespace profiler {
+
+ContinuousProfiler::ContinuousProfiler(const ContinuousProfilerOptions& options,
+                                       Sink sink)
+    : options_(options), sink_(std::move(sink)) {
+  thread_.reset(Env::Default()->StartThread(
+      ThreadOptions(), "continuous_profiler", [this] { Run(); }));
+}
+
+ContinuousProfiler::~ContinuousProfiler() {
+  {
+    mutex_lock lock(mutex_);
+    stopping_ = true;
+  }
+  stop_cv_.notify_all();
+  // Joins the thread.
+  thread_.reset();
+}
+
+/*static*/ void ContinuousProfiler::AddEvents(
+    const TraceMeRecorder::Events& events, int64_t sampled_duration_ns,
+    int max_names, ContinuousProfileSummary* summary) {
+  summary->sampled_duration_ns += sampled_duration_ns;
+  for (const TraceMeRecorder::ThreadEvents& thread : events) {
+    for (const TraceMeRecorder::Event& event : thread.events) {
+      // Unpaired start or end events.
+      if (!event.IsComplete()) continue;
+      const absl::string_view name =
+          absl::string_view(event.name).substr(0, event.name.find('#'));
+      auto it = summary->stats.find(name);
+      if (it == summary->stats.end()) {
+        if (summary->stats.size() >= static_cast<size_t>(max_names)) {
+          ++summary->dropped_events;
+          continue;
+        }
+        it = summary->stats.emplace(std::string(name), TraceMeStats()).first;
+      }
+      TraceMeStats& stats = it->second;
+      const int64_t duration_ns =
+          std::max<int64_t>(event.end_time - event.start_time, 0);
+      if (stats.count == 0 || duration_ns < stats.min_duration_ns) {
+        stats.min_duration_ns = duration_ns;
+      }
+      stats.max_duration_ns = std::max(stats.max_duration_ns, duration_ns);
+      stats.total_duration_ns += duration_ns;
+      ++stats.count;
+    }
+  }
+}
+
+void ContinuousProfiler::Run() {
+  ContinuousProfileSummary summary;
+  summary.start_time_ns = GetCurrentTimeNanos();
+  const int64_t summary_period_ns =
+      absl::ToInt64Nanoseconds(options_.summary_period);
+  bool stopping = false;
+  while (!stopping) {
+    const int64_t window_start_ns = GetCurrentTimeNanos();
+    // Skips the window if a profiler session is recording.
+    if (TraceMeRecorder::StartBackground(options_.trace_level)) {
+      stopping = WaitFor(options_.sampling_window);
+      TraceMeRecorder::Events events;
+      if (TraceMeRecorder::StopBackground(&events)) {
+        AddEvents(events, GetCurrentTimeNanos() - window_start_ns,
+                  options_.max_names, &summary);
+      }
+    }
+    if (!stopping) {
+      stopping =
+          WaitFor(options_.sampling_period -
+                  absl::Nanoseconds(GetCurrentTimeNanos() - window_start_ns));
+    }
+    const int64_t now_ns = GetCurrentTimeNanos();
+    if (stopping || now_ns - summary.start_time_ns >= summary_period_ns) {
+      summary.end_time_ns = now_ns;
+      sink_(summary);
+      summary = ContinuousProfileSummary();
+      summary.start_time_ns = now_ns;
+    }
+  }
+}
+
+bool ContinuousProfiler::WaitFor(absl::Duration duration) {
+  const absl::Time deadline = absl::Now() + duration;
+  mutex_lock lock(mutex_);
+  while (!stopping_) {
+    const absl::Duration remaining = deadline - absl::Now();
+    if (remaining <= absl::ZeroDuration()) break;
+    stop_cv_.wait_for(
+        lock, std::chrono::nanoseconds(absl::ToInt64Nanoseconds(remaining)));
+  }
+  return stopping_;
+}
+
+}  // namespace profiler
+}  // namespace tsl
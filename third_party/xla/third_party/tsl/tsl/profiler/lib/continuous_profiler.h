@@ -0,0 +1,110 @@
+/* Copyright 2024 The TensorFlow Authors. All Rights Reserved.
+
+Licensed under the Apache License, Version 2.0 (the "License");
+you may not use this file except in compliance with the License.
+You may obtain a copy of the License at
+
+    http://www.apache.org/licenses/LICENSE-2.0
+
+Unless required by applicable law or agreed to in writing, software
+distributed under the License is distributed on an "AS IS" BASIS,
+WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+See the License for the specific language governing permissions and
+limitations under the License.
+==============================================================================*/
+#ifndef TENSORFLOW_TSL_PROFILER_LIB_CONTINUOUS_PROFILER_H_
+#define TENSORFLOW_TSL_PROFILER_LIB_CONTINUOUS_PROFILER_H_
+
+#include <cstdint>
+#include <functional>
+#include <memory>
+#include <string>
+
+#include "absl/container/flat_hash_map.h"
+#include "absl/time/time.h"
+#include "tsl/platform/env.h"
+#include "tsl/platform/mutex.h"
+#include "tsl/platform/thread_annotations.h"
+#include "tsl/profiler/backends/cpu/traceme_recorder.h"
+
+namespace tsl {
+namespace profiler {
+
+// The statistics of the TraceMe events with the same name.
+struct TraceMeStats {
+  int64_t count = 0;
+  int64_t total_duration_ns = 0;
+  int64_t min_duration_ns = 0;
+  int64_t max_duration_ns = 0;
+};
+
+// The statistics of the TraceMe events recorded over a summary period.
+struct ContinuousProfileSummary {
+  // The wall time covered by the summary, in ns since the Unix epoch.
+  int64_t start_time_ns = 0;
+  int64_t end_time_ns = 0;
+  // The time spent recording, of which the counts are a sample.
+  int64_t sampled_duration_ns = 0;
+  // The statistics by TraceMe name, without the metadata after '#'.
+  absl::flat_hash_map<std::string, TraceMeStats> stats;
+  // The number of events not in `stats` because of max_names.
+  int64_t dropped_events = 0;
+};
+
+struct ContinuousProfilerOptions {
+  // The level of the TraceMe events recorded, see TraceMeLevel.
+  int trace_level = 1;
+  // Events are recorded for sampling_window at the start of every
+  // sampling_period, which bounds both the overhead and the events buffered.
+  absl::Duration sampling_window = absl::Milliseconds(10);
+  absl::Duration sampling_period = absl::Seconds(1);
+  // The period at which the summaries are passed to the sink.
+  absl::Duration summary_period = absl::Seconds(60);
+  // The maximum number of distinct names in a summary.
+  int max_names = 1000;
+};
+
+// ContinuousProfiler keeps a low overhead profile of the TraceMe events of the
+// process without a client starting a capture: it periodically records the
+// events for a short window, aggregates them into per-name statistics and
+// passes a summary to a sink, e.g. to export it as metrics or logs.
+//
+// The windows are background recordings of TraceMeRecorder, which a profiler
+// session preempts: on-demand captures are not affected, and the windows that
+// overlap with them are skipped.
+class ContinuousProfiler {
+ public:
+  using Sink = std::function<void(const ContinuousProfileSummary&)>;
+
+  // Starts profiling. The sink is called on the profiler thread.
+  ContinuousProfiler(const ContinuousProfilerOptions& options, Sink sink);
+
+  // Stops profiling and passes the summary of the last period to the sink.
+  ~ContinuousProfiler();
+
+  ContinuousProfiler(const ContinuousProfiler&) = delete;
+  ContinuousProfiler& operator=(const ContinuousProfiler&) = delete;
+
+  // Adds the events of a recording of `sampled_duration_ns` to `summary`.
+  static void AddEvents(const TraceMeRecorder::Events& events,
+                        int64_t sampled_duration_ns, int max_names,
+                        ContinuousProfileSummary* summary);
+
+ private:
+  void Run();
+
+  // Waits for `duration` or until stopping, and returns whether stopping.
+  bool WaitFor(absl::Duration duration);
+
+  const ContinuousProfilerOptions options_;
+  const Sink sink_;
+  mutex mutex_;
+  condition_variable stop_cv_;
+  bool stopping_ TF_GUARDED_BY(mutex_) = false;
+  std::unique_ptr<Thread> thread_;
+};
+
+}  // namespace profiler
+}  // namespace tsl
+
+#endif  // TENSORFLOW_TSL_PROFILER_LIB_CONTINUOUS_PROFILER_H_
@@ -0,0 +1,122 @@
+/* Copyright 2024 The TensorFlow Authors. All Rights Reserved.
+
+Licensed under the Apache License, Version 2.0 (the "License");
+you may not use this file except in compliance with the License.
+You may obtain a copy of the License at
+
+    http://www.apache.org/licenses/LICENSE-2.0
+
+Unless required by applicable law or agreed to in writing, software
+distributed under the License is distributed on an "AS IS" BASIS,
+WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+See the License for the specific language governing permissions and
+limitations under the License.
+==============================================================================*/
+#include "tsl/profiler/lib/continuous_profiler.h"
+
+#include <vector>
+
+#include "absl/time/clock.h"
+#include "absl/time/time.h"
+#include "tsl/platform/mutex.h"
+#include "tsl/platform/test.h"
+#include "tsl/profiler/backends/cpu/traceme_recorder.h"
+#include "tsl/profiler/lib/traceme.h"
+
+namespace tsl {
+namespace profiler {
+namespace {
+
+TEST(ContinuousProfilerTest, AddEventsAggregatesByName) {
+  TraceMeRecorder::Events events(2);
+  events[0].events.push_back({"MatMul", 100, 300});
+  events[0].events.push_back({"MatMul#id=1#", 400, 450});
+  events[0].events.push_back({"Unpaired", 500, -1});
+  events[1].events.push_back({"Conv2D", 100, 1100});
+  events[1].events.push_back({"MatMul", 200, 300});
+
+  ContinuousProfileSummary summary;
+  ContinuousProfiler::AddEvents(events, /*sampled_duration_ns=*/1000,
+                                /*max_names=*/10, &summary);
+  EXPECT_EQ(summary.sampled_duration_ns, 1000);
+  EXPECT_EQ(summary.dropped_events, 0);
+  ASSERT_EQ(summary.stats.size(), 2);
+  const TraceMeStats& matmul = summary.stats["MatMul"];
+  EXPECT_EQ(matmul.count, 3);
+  EXPECT_EQ(matmul.total_duration_ns, 350);
+  EXPECT_EQ(matmul.min_duration_ns, 50);
+  EXPECT_EQ(matmul.max_duration_ns, 200);
+  EXPECT_EQ(summary.stats["Conv2D"].count, 1);
+}
+
+TEST(ContinuousProfilerTest, AddEventsBoundsTheNames) {
+  TraceMeRecorder::Events events(1);
+  events[0].events.push_back({"A", 100, 200});
+  events[0].events.push_back({"B", 100, 200});
+  events[0].events.push_back({"A", 100, 200});
+  events[0].events.push_back({"C", 100, 200});
+
+  ContinuousProfileSummary summary;
+  ContinuousProfiler::AddEvents(events, /*sampled_duration_ns=*/1000,
+                                /*max_names=*/1, &summary);
+  ASSERT_EQ(summary.stats.size(), 1);
+  EXPECT_EQ(summary.stats["A"].count, 2);
+  EXPECT_EQ(summary.dropped_events, 2);
+}
+
+TEST(ContinuousProfilerTest, SummarizesTraceMeEvents) {
+  mutex mu;
+  std::vector<ContinuousProfileSummary> summaries;
+  {
+    ContinuousProfilerOptions options;
+    options.sampling_window = absl::Milliseconds(20);
+    options.sampling_period = absl::Milliseconds(20);
+    ContinuousProfiler profiler(
+        options, [&](const ContinuousProfileSummary& summary) {
+          mutex_lock lock(mu);
+          summaries.push_back(summary);
+        });
+    const absl::Time end = absl::Now() + absl::Milliseconds(200);
+    while (absl::Now() < end) {
+      TraceMe trace_me("ContinuousProfilerTest");
+    }
+  }
+  // The summary period is longer than the test, so the only summary is the
+  // one passed when stopping.
+  mutex_lock lock(mu);
+  ASSERT_EQ(summaries.size(), 1);
+  EXPECT_GT(summaries[0].sampled_duration_ns, 0);
+  EXPECT_GT(summaries[0].stats["ContinuousProfilerTest"].count, 0);
+}
+
+TEST(ContinuousProfilerTest, YieldsToProfilerSessions) {
+  // A recording, e.g. of a profiler session, is active the whole time.
+  ASSERT_TRUE(TraceMeRecorder::Start(/*level=*/1));
+  mutex mu;
+  std::vector<ContinuousProfileSummary> summaries;
+  {
+    ContinuousProfilerOptions options;
+    options.sampling_window = absl::Milliseconds(5);
+    options.sampling_period = absl::Milliseconds(5);
+    ContinuousProfiler profiler(
+        options, [&](const ContinuousProfileSummary& summary) {
+          mutex_lock lock(mu);
+          summaries.push_back(summary);
+        });
+    absl::SleepFor(absl::Milliseconds(50));
+    TraceMe trace_me("ContinuousProfilerTest");
+  }
+  EXPECT_TRUE(TraceMeRecorder::Active());
+  TraceMeRecorder::Events events = TraceMeRecorder::Stop();
+  ASSERT_EQ(events.size(), 1);
+  EXPECT_EQ(events[0].events.size(), 1);
+
+  mutex_lock lock(mu);
+  ASSERT_EQ(summaries.size(), 1);
+  EXPECT_EQ(summaries[0].sampled_duration_ns, 0);
+  EXPECT_TRUE(summaries[0].stats.empty());
+}
+
+}  // namespace
+}  // namespace profiler
+}  // namespace tsl
@@ -175,6 +175,9 @@ DebugOptions DefaultDebugOptionsIgnoringFlags() {
 
   opts.set_xla_cpu_enable_mlir_tiling_and_fusion(true);
   opts.set_xla_cpu_enable_custom_matmul_tiling(false);
+  opts.set_xla_cpu_autotune_dot_tiling(false);
+  opts.set_xla_cpu_parallel_task_oversubscription(4);
+  opts.set_xla_cpu_parallel_task_measure_throughput(false);
   opts.set_xla_cpu_matmul_tiling_m_dim(8);
   opts.set_xla_cpu_matmul_tiling_n_dim(8);
   opts.set_xla_cpu_matmul_tiling_k_dim(8);
@@ -1306,6 +1309,33 @@ void MakeDebugOptionsFlags(std::vector<tsl::Flag>* flag_list,
       int64_setter_for(&DebugOptions::set_xla_cpu_matmul_tiling_k_dim),
       debug_options->xla_cpu_matmul_tiling_k_dim(),
       "Custom tile size for matmul's K dimension."));
+  flag_list->push_back(tsl::Flag(
+      "xla_cpu_autotune_dot_tiling",
+      bool_setter_for(&DebugOptions::set_xla_cpu_autotune_dot_tiling),
+      debug_options->xla_cpu_autotune_dot_tiling(),
+      "Benchmark candidate tilings of the dots lowered to tiled LLVM IR "
+      "kernels on the host at compile time, and emit the fastest."));
+  flag_list->push_back(tsl::Flag(
+      "xla_cpu_dot_autotune_results_file",
+      string_setter_for(&DebugOptions::set_xla_cpu_dot_autotune_results_file),
+      debug_options->xla_cpu_dot_autotune_results_file(),
+      "File from which the tilings chosen by xla_cpu_autotune_dot_tiling are "
+      "loaded, and to which new ones are saved."));
+  flag_list->push_back(tsl::Flag(
+      "xla_cpu_parallel_task_oversubscription",
+      int32_setter_for(
+          &DebugOptions::set_xla_cpu_parallel_task_oversubscription),
+      debug_options->xla_cpu_parallel_task_oversubscription(),
+      "Number of partitions per thread that a parallelized op is split into. "
+      "Threads claim partitions dynamically, so more partitions balance the "
+      "load better across threads that run at different speeds."));
+  flag_list->push_back(tsl::Flag(
+      "xla_cpu_parallel_task_measure_throughput",
+      bool_setter_for(
+          &DebugOptions::set_xla_cpu_parallel_task_measure_throughput),
+      debug_options->xla_cpu_parallel_task_measure_throughput(),
+      "Calibrate the cost model that partitions parallelized ops with the "
+      "measured throughput of the host instead of a fixed clock rate."));
   flag_list->push_back(tsl::Flag(
       "xla_cpu_enable_experimental_deallocation",
       bool_setter_for(
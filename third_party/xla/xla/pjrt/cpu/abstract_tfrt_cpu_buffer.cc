@@ -61,6 +61,7 @@ limitations under the License.
 #include "tsl/concurrency/async_value.h"
 #include "tsl/concurrency/async_value_ref.h"
 #include "tsl/concurrency/ref_count.h"
+#include "tsl/platform/cpu_info.h"
 #include "tsl/platform/errors.h"
 #include "tsl/platform/statusor.h"
 #include "tsl/profiler/lib/connected_traceme.h"
@@ -731,7 +732,6 @@ AbstractTfrtCpuBuffer::BufferFromHostBufferHelper(
       // into major-to-minor layout. Currently we choose to always do this
       // synchronously.
       // TODO(phawkins): consider performing the transpose asynchronously.
-      // TODO(phawkins): parallelize the transpose.
       std::shared_ptr<TransposePlan> transpose;
       {
         absl::InlinedVector<int64_t, 4> permutation(dims.size());
@@ -741,6 +741,7 @@ AbstractTfrtCpuBuffer::BufferFromHostBufferHelper(
         options.dims = dims;
         options.permutation = permutation;
         options.input_layout = TransposePlan::Striding{*byte_strides};
+        options.num_threads = tsl::port::MaxParallelism();
         absl::MutexLock lock(transpose_mu);
         TF_ASSIGN_OR_RETURN(transpose, transpose_cache->GetOrCreate(options));
       }
@@ -0,0 +1,73 @@
+/* Copyright 2024 The OpenXLA Authors.
+
+Licensed under the Apache License, Version 2.0 (the "License");
+you may not use this file except in compliance with the License.
+You may obtain a copy of the License at
+
+    http://www.apache.org/licenses/LICENSE-2.0
+
+Unless required by applicable law or agreed to in writing, software
+distributed under the License is distributed on an "AS IS" BASIS,
+WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+See the License for the specific language governing permissions and
+limitations under the License.
+==============================================================================*/
+
+#include "xla/pjrt/host_staging_buffer_pool.h"
+
+#include <cstdint>
+
+#include "absl/synchronization/mutex.h"
+#include "tsl/framework/allocator.h"
+#include "tsl/platform/logging.h"
+
+namespace xla {
+
+HostStagingBufferPool::HostStagingBufferPool(tsl::Allocator* allocator,
+                                             int64_t buffer_size,
+                                             int num_buffers)
+    : allocator_(allocator),
+      buffer_size_(buffer_size),
+      num_buffers_(num_buffers) {
+  CHECK_GT(buffer_size_, 0);
+  CHECK_GT(num_buffers_, 0);
+}
+
+HostStagingBufferPool::~HostStagingBufferPool() {
+  absl::MutexLock lock(&mu_);
+  CHECK_EQ(free_buffers_.size(), num_allocated_)
+      << "Staging buffers are still in use";
+  for (void* buffer : free_buffers_) {
+    allocator_->DeallocateRaw(buffer);
+  }
+}
+
+void* HostStagingBufferPool::Acquire() {
+  {
+    absl::MutexLock lock(&mu_);
+    auto buffer_available = [this]() ABSL_EXCLUSIVE_LOCKS_REQUIRED(mu_) {
+      return !free_buffers_.empty() || num_allocated_ < num_buffers_;
+    };
+    mu_.Await(absl::Condition(&buffer_available));
+    if (!free_buffers_.empty()) {
+      void* buffer = free_buffers_.back();
+      free_buffers_.pop_back();
+      return buffer;
+    }
+    ++num_allocated_;
+  }
+  // Allocating pinned memory can be slow, so do it without holding the lock
+  // that releases of other buffers need.
+  void* buffer = allocator_->AllocateRaw(tsl::Allocator::kAllocatorAlignment,
+                                         buffer_size_);
+  CHECK(buffer != nullptr) << "Failed to allocate a staging buffer of "
+                           << buffer_size_ << " bytes";
+  return buffer;
+}
+
+void HostStagingBufferPool::Release(void* buffer) {
+  absl::MutexLock lock(&mu_);
+  free_buffers_.push_back(buffer);
+}
+
+}  // namespace xla
@@ -0,0 +1,65 @@
+/* Copyright 2024 The OpenXLA Authors.
+
+Licensed under the Apache License, Version 2.0 (the "License");
+you may not use this file except in compliance with the License.
+You may obtain a copy of the License at
+
+    http://www.apache.org/licenses/LICENSE-2.0
+
+Unless required by applicable law or agreed to in writing, software
+distributed under the License is distributed on an "AS IS" BASIS,
+WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+See the License for the specific language governing permissions and
+limitations under the License.
+==============================================================================*/
+
+#ifndef XLA_PJRT_HOST_STAGING_BUFFER_POOL_H_
+#define XLA_PJRT_HOST_STAGING_BUFFER_POOL_H_
+
+#include <cstdint>
+#include <vector>
+
+#include "absl/base/thread_annotations.h"
+#include "absl/synchronization/mutex.h"
+#include "tsl/framework/allocator.h"
+
+namespace xla {
+
+// A fixed number of equally sized host buffers, e.g., in pinned memory, that
+// are reused to stage large transfers one chunk at a time. The buffers are
+// allocated on first use and freed when the pool is destroyed, at which point
+// all of them must have been released.
+class HostStagingBufferPool {
+ public:
+  // `allocator` must outlive the pool.
+  HostStagingBufferPool(tsl::Allocator* allocator, int64_t buffer_size,
+                        int num_buffers);
+  ~HostStagingBufferPool();
+
+  HostStagingBufferPool(const HostStagingBufferPool&) = delete;
+  HostStagingBufferPool& operator=(const HostStagingBufferPool&) = delete;
+
+  int64_t buffer_size() const { return buffer_size_; }
+  int num_buffers() const { return num_buffers_; }
+
+  // Returns a buffer of `buffer_size()` bytes, blocking until one is released
+  // if all of them are in use.
+  void* Acquire();
+
+  // Returns a buffer obtained from `Acquire()` to the pool. May be called from
+  // any thread.
+  void Release(void* buffer);
+
+ private:
+  tsl::Allocator* const allocator_;
+  const int64_t buffer_size_;
+  const int num_buffers_;
+
+  absl::Mutex mu_;
+  int num_allocated_ ABSL_GUARDED_BY(mu_) = 0;
+  std::vector<void*> free_buffers_ ABSL_GUARDED_BY(mu_);
+};
+
+}  // namespace xla
+
+#endif  // XLA_PJRT_HOST_STAGING_BUFFER_POOL_H_
@@ -0,0 +1,61 @@
+/* Copyright 2024 The OpenXLA Authors.
+
+Licensed under the Apache License, Version 2.0 (the "License");
+you may not use this file except in compliance with the License.
+You may obtain a copy of the License at
+
+    http://www.apache.org/licenses/LICENSE-2.0
+
+Unless required by applicable law or agreed to in writing, software
+distributed under the License is distributed on an "AS IS" BASIS,
+WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+See the License for the specific language governing permissions and
+limitations under the License.
+==============================================================================*/
+
+#include "xla/pjrt/host_staging_buffer_pool.h"
+
+#include <memory>
+
+#include "absl/synchronization/notification.h"
+#include "absl/time/time.h"
+#include "xla/test.h"
+#include "tsl/framework/allocator.h"
+#include "tsl/platform/env.h"
+
+namespace xla {
+namespace {
+
+TEST(HostStagingBufferPoolTest, ReusesReleasedBuffers) {
+  HostStagingBufferPool pool(tsl::cpu_allocator(), /*buffer_size=*/1024,
+                             /*num_buffers=*/2);
+  void* a = pool.Acquire();
+  void* b = pool.Acquire();
+  EXPECT_NE(a, b);
+  pool.Release(a);
+  EXPECT_EQ(pool.Acquire(), a);
+  pool.Release(a);
+  pool.Release(b);
+}
+
+TEST(HostStagingBufferPoolTest, AcquireBlocksUntilRelease) {
+  HostStagingBufferPool pool(tsl::cpu_allocator(), /*buffer_size=*/1024,
+                             /*num_buffers=*/1);
+  void* a = pool.Acquire();
+  absl::Notification acquired;
+  void* b = nullptr;
+  std::unique_ptr<tsl::Thread> thread(
+      tsl::Env::Default()->StartThread({}, "acquire", [&]() {
+        b = pool.Acquire();
+        acquired.Notify();
+      }));
+  EXPECT_FALSE(acquired.WaitForNotificationWithTimeout(absl::Milliseconds(50)));
+  pool.Release(a);
+  acquired.WaitForNotification();
+  EXPECT_EQ(b, a);
+  thread.reset();
+  pool.Release(b);
+}
+
+}  // namespace
+}  // namespace xla
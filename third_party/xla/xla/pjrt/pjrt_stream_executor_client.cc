@@ -137,6 +137,7 @@ limitations under the License.
 #include "xla/util.h"
 #include "xla/xla_data.pb.h"
 #include "tsl/framework/allocator.h"
+#include "tsl/platform/cpu_info.h"
 #include "tsl/platform/env.h"
 #include "tsl/platform/errors.h"
 #include "tsl/platform/fingerprint.h"
@@ -215,6 +216,14 @@ class CpuAllocator : public tsl::Allocator {
   void DeallocateRaw(void* ptr) override { return tsl::port::AlignedFree(ptr); }
 };
 
+// Host-to-device transfers larger than this are copied to the device through
+// a per-device pool of staging buffers of this size, so that copying one chunk
+// into a staging buffer overlaps with the DMA of the previous one.
+constexpr int64_t kHostToDeviceStagingChunkBytes = int64_t{16} << 20;
+// The number of staging buffers per device. With two or more, the staging
+// copy and the DMA of consecutive chunks run concurrently.
+constexpr int kNumHostToDeviceStagingBuffers = 3;
+
 PjRtStreamExecutorClient::PjRtStreamExecutorClient(
     std::string platform_name, LocalClient* client,
     std::vector<std::unique_ptr<PjRtStreamExecutorDevice>> devices,
@@ -267,6 +276,18 @@ PjRtStreamExecutorClient::PjRtStreamExecutorClient(
                });
 }
 
+HostStagingBufferPool* PjRtStreamExecutorClient::GetHostToDeviceStagingPool(
+    LocalDeviceState* local_device) {
+  absl::MutexLock lock(&staging_pools_mu_);
+  std::unique_ptr<HostStagingBufferPool>& pool = staging_pools_[local_device];
+  if (pool == nullptr) {
+    pool = std::make_unique<HostStagingBufferPool>(
+        host_memory_allocator(), kHostToDeviceStagingChunkBytes,
+        kNumHostToDeviceStagingBuffers);
+  }
+  return pool.get();
+}
+
 StatusOr<DeviceAssignment> PjRtStreamExecutorClient::GetDefaultDeviceAssignment(
     int num_replicas, int num_partitions) const {
   return client_->backend().computation_placer()->AssignDevices(num_replicas,
@@ -846,6 +867,7 @@ PjRtStreamExecutorClient::BufferFromHostBuffer(
     options.dims = dims;
     options.permutation = permutation;
     options.input_layout = TransposePlan::Striding{*byte_strides};
+    options.num_threads = tsl::port::MaxParallelism();
     absl::MutexLock lock(&transpose_mu_);
     TF_ASSIGN_OR_RETURN(transpose, transpose_cache_.GetOrCreate(options));
   }
@@ -866,11 +888,16 @@ PjRtStreamExecutorClient::BufferFromHostBuffer(
   bool must_use_staging_buffer =
       host_buffer_semantics == HostBufferSemantics::kImmutableOnlyDuringCall ||
       !host_and_device_strides_equal || packed_size != size;
-  // Allocating multigigabyte pinned buffers can be very slow. In that case,
-  // using a staging buffer is probably worse than not using one.
-  // TODO(phawkins): add chunking for transfers.
-  if (must_use_staging_buffer || (should_stage_host_to_device_transfers() &&
-                                  packed_size < (int64_t{1} << 30))) {
+  // Large transfers that need no staging copy of their own are copied through
+  // a pool of reusable staging buffers one chunk at a time instead: allocating
+  // multigigabyte pinned buffers can be very slow, and the staging copy of
+  // each chunk overlaps with the DMA of the previous one.
+  HostStagingBufferPool* staging_pool = nullptr;
+  if (!must_use_staging_buffer && should_stage_host_to_device_transfers() &&
+      packed_size > kHostToDeviceStagingChunkBytes) {
+    staging_pool = GetHostToDeviceStagingPool(local_device);
+  } else if (must_use_staging_buffer ||
+             should_stage_host_to_device_transfers()) {
     void* ptr = host_memory_allocator()->AllocateRaw(
         tsl::Allocator::kAllocatorAlignment, transpose ? size : packed_size);
     staging_buffer = std::shared_ptr<void>(
@@ -921,7 +948,7 @@ PjRtStreamExecutorClient::BufferFromHostBuffer(
        type, packed_size, movable_device_buffer{device_buffer.ToClosure()},
        device_shape, should_pack, py_buffer{py_buffer.get()},
        on_device_shape{py_buffer->on_device_shape()},
-       staging_buffer{std::move(staging_buffer)},
+       staging_buffer{std::move(staging_buffer)}, staging_pool,
        on_done_with_host_buffer =
            on_done_with_host_buffer
                ? std::make_shared<absl::AnyInvocable<void() &&>>(
@@ -970,6 +997,25 @@ PjRtStreamExecutorClient::BufferFromHostBuffer(
           }
           TF_CHECK_OK(local_device->host_to_device_stream()->Memcpy(
               &device_memory, staging_buffer.get(), packed_size));
+        } else if (staging_pool) {
+          se::Stream* stream = local_device->host_to_device_stream();
+          const int64_t chunk_bytes = staging_pool->buffer_size();
+          for (int64_t offset = 0; offset < packed_size;
+               offset += chunk_bytes) {
+            const int64_t chunk_size =
+                std::min(chunk_bytes, packed_size - offset);
+            // Blocks until the DMA from a staging buffer has finished if all
+            // of them are in use.
+            void* chunk = staging_pool->Acquire();
+            std::memcpy(chunk, static_cast<const char*>(data) + offset,
+                        chunk_size);
+            se::DeviceMemoryBase device_chunk =
+                device_memory.GetByteSlice(offset, chunk_size);
+            TF_CHECK_OK(stream->Memcpy(&device_chunk, chunk, chunk_size));
+            TF_CHECK_OK(local_device->ThenExecuteCallback(
+                stream,
+                [staging_pool, chunk]() { staging_pool->Release(chunk); }));
+          }
         } else {
           TF_CHECK_OK(local_device->host_to_device_stream()->Memcpy(
               &device_memory, data, packed_size));
@@ -40,6 +40,7 @@ limitations under the License.
 #include "xla/hlo/ir/hlo_module.h"
 #include "xla/layout.h"
 #include "xla/literal.h"
+#include "xla/pjrt/host_staging_buffer_pool.h"
 #include "xla/pjrt/local_device_state.h"
 #include "xla/pjrt/pjrt_client.h"
 #include "xla/pjrt/pjrt_future.h"
@@ -375,6 +376,11 @@ class PjRtStreamExecutorClient : public PjRtClient {
 
   tsl::thread::ThreadPool* thread_pool() { return &thread_pool_; }
 
+  // Returns the pool of staging buffers that large host-to-device transfers to
+  // `local_device` are copied through in chunks.
+  HostStagingBufferPool* GetHostToDeviceStagingPool(
+      LocalDeviceState* local_device);
+
  protected:
   friend class PjRtStreamExecutorBuffer;
 
@@ -426,6 +432,13 @@ class PjRtStreamExecutorClient : public PjRtClient {
   // Allocator to be used for staging memory transfers to devices.
   std::unique_ptr<tsl::Allocator> host_memory_allocator_;
 
+  // Staging buffers for chunked host-to-device transfers, allocated on
+  // host_memory_allocator_, by device. Declared before the devices so that
+  // the device destructors, which wait for outstanding transfers, run first.
+  absl::Mutex staging_pools_mu_;
+  absl::flat_hash_map<LocalDeviceState*, std::unique_ptr<HostStagingBufferPool>>
+      staging_pools_ ABSL_GUARDED_BY(staging_pools_mu_);
+
   // Device memory allocator. If owned, the allocator must outlive the devices,
   // because it is the device destructor that waits for any outstanding work to
   // complete.
@@ -98,19 +98,42 @@ limitations under the License.
 #include "xla/status.h"
 #include "xla/statusor.h"
 #include "xla/util.h"
+#include "tsl/platform/cpu_info.h"
+#include "tsl/platform/env.h"
 #include "tsl/platform/logging.h"
+#include "tsl/platform/threadpool.h"
 #include "tsl/profiler/lib/traceme.h"
 
 namespace xla {
 
 namespace {
-#ifdef __AVX__
-static constexpr int kMaxInnerBlockSizeBytes = sizeof(__m256i);
+// Returns the size in bytes of the rows of the largest square block that the
+// microkernels transpose efficiently for elements of `elem_size_in_bytes`.
+constexpr int MaxInnerBlockSizeBytes(int64_t elem_size_in_bytes) {
+#ifdef __AVX512F__
+  // The 512-bit kernel only beats the 256-bit one for 4-byte elements; for
+  // 8-byte elements it spends more shuffles on loads than it saves.
+  return elem_size_in_bytes == 4 ? sizeof(__m512i) : sizeof(__m256i);
+#elif defined(__AVX__)
+  return sizeof(__m256i);
+#elif defined(XLA_HAS_ARM_NEON)
+  // A block of 256-bit rows of 2-byte elements would take all 32 registers,
+  // so only larger elements use the 256-bit kernel.
+  return elem_size_in_bytes >= 4 ? 2 * sizeof(Vec128) : sizeof(Vec128);
 #elif defined(XLA_HAS_VEC128)
-static constexpr int kMaxInnerBlockSizeBytes = sizeof(Vec128);
+  return sizeof(Vec128);
 #else
-static constexpr int kMaxInnerBlockSizeBytes = 16;
+  return 16;
 #endif
+}
+
+// Returns the thread pool that runs the parallel work of plans executed
+// without a `schedule_work` function.
+tsl::thread::ThreadPool* DefaultTransposeThreadPool() {
+  static tsl::thread::ThreadPool* const pool = new tsl::thread::ThreadPool(
+      tsl::Env::Default(), "xla_transpose", tsl::port::MaxParallelism());
+  return pool;
+}
 }  // namespace
 
 // A plan is a data structure that describes a loop nest.
@@ -421,7 +444,8 @@ void TransposePlan::ExecuteTyped(const char* a, char* b,
     if (scratch_size_ > 0) {
       scratch.reset(new char[scratch_size_]);
     }
-    DCHECK_LE(sizeof(T) * inner_block_elems_, kMaxInnerBlockSizeBytes);
+    DCHECK_LE(sizeof(T) * inner_block_elems_,
+              MaxInnerBlockSizeBytes(sizeof(T)));
     auto handle_inner_block_elems = [&](auto const_inner_block_elems) {
       if (nodes.size() > 1) {
         Transpose<T, const_inner_block_elems, transformation>(
@@ -499,15 +523,21 @@ void TransposePlan::Execute(
     }
   };
 
-  if (!schedule_work || nodes_.size() <= 1) {
+  if (nodes_.size() <= 1) {
     for (const auto& nodes : nodes_) {
       execute_by_type(nodes);
     }
   } else {
+    std::function<void(std::function<void(void)>)> schedule = schedule_work;
+    if (!schedule) {
+      schedule = [](std::function<void(void)> fn) {
+        DefaultTransposeThreadPool()->Schedule(std::move(fn));
+      };
+    }
     absl::BlockingCounter counter(nodes_.size() - 1);
     for (size_t i = 1; i < nodes_.size(); ++i) {
       absl::Span<Node const> nodes = nodes_[i];
-      schedule_work([&, nodes]() {
+      schedule([&, nodes]() {
         execute_by_type(nodes);
         counter.DecrementCount();
       });
@@ -1125,7 +1155,8 @@ void TransposePlan::Initialize() {
       case 8:
         min_inner_block_elems = 1;
         max_inner_block_elems = std::min<int>(
-            kMaxOuterBlockElems, kMaxInnerBlockSizeBytes / elem_size_in_bytes_);
+            kMaxOuterBlockElems,
+            MaxInnerBlockSizeBytes(elem_size_in_bytes_) / elem_size_in_bytes_);
         break;
       case 16:
         min_inner_block_elems = 1;
@@ -1269,7 +1300,7 @@ std::vector<int> TransposePlan::ChooseParallelizationStrategy(
     const Loop& loop = loop_order_[i];
     CHECK_GE(available_parallelism, 1);
     int64_t iterations = loop_iterations(loop);
-    int kMinBytesPerThread = inner_kernel_is_memcpy_ ? (1 << 20) : (1 << 26);
+    int kMinBytesPerThread = inner_kernel_is_memcpy_ ? (1 << 20) : (1 << 22);
     int64_t min_iterations_per_thread =
         CeilOfRatio<int64_t>(kMinBytesPerThread, work_in_bytes[i]);
     int64_t parallel_work = CeilOfRatio(iterations, min_iterations_per_thread);
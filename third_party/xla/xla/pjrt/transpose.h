@@ -109,6 +109,9 @@ class TransposePlan {
   // arrays must not overlap.
   // Currently there are no alignment requirements on either `a` or `b`. However
   // performance may be better if either or both are aligned.
+  // `schedule_work` runs the items of parallel work of the plan other than the
+  // first, which runs on the calling thread. If it is empty, they run on a
+  // thread pool shared by all plans.
   void Execute(const void* a, void* b,
                const std::function<void(std::function<void(void)>)>&
                    schedule_work = {}) const;
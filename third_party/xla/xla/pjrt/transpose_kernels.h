@@ -96,6 +96,29 @@ namespace xla {
 
 enum class Extract { kLo, kHi };
 
+#ifdef __AVX512F__
+template <size_t element_size, Extract>
+__m512i Unpack(__m512i a, __m512i b);
+
+template <>
+inline __m512i Unpack<4, Extract::kLo>(__m512i a, __m512i b) {
+  return _mm512_unpacklo_epi32(a, b);
+}
+template <>
+inline __m512i Unpack<4, Extract::kHi>(__m512i a, __m512i b) {
+  return _mm512_unpackhi_epi32(a, b);
+}
+
+template <>
+inline __m512i Unpack<8, Extract::kLo>(__m512i a, __m512i b) {
+  return _mm512_unpacklo_epi64(a, b);
+}
+template <>
+inline __m512i Unpack<8, Extract::kHi>(__m512i a, __m512i b) {
+  return _mm512_unpackhi_epi64(a, b);
+}
+#endif  // __AVX512F__
+
 #ifdef __AVX__
 template <size_t element_size, Extract>
 __m256i Unpack(__m256i a, __m256i b);
@@ -471,6 +494,19 @@ inline void StoreElementFromVec128(void* p, uint64x2_t v) {
 #endif
 
 #ifdef XLA_HAS_VEC128
+// A pair of 128-bit vectors that is unpacked like a 256-bit AVX vector, i.e.,
+// independently in each of its two halves.
+struct Vec128x2 {
+  Vec128 lo;
+  Vec128 hi;
+};
+
+template <size_t element_size, Extract extract>
+inline Vec128x2 Unpack(const Vec128x2& a, const Vec128x2& b) {
+  return {Unpack<element_size, extract>(a.lo, b.lo),
+          Unpack<element_size, extract>(a.hi, b.hi)};
+}
+
 template <size_t element_size, size_t step_size, typename T, size_t N>
 inline std::array<T, N> UnpackStep(const std::array<T, N>& last_transpose) {
   static_assert(N % (step_size * 2) == 0);
@@ -567,6 +603,87 @@ struct Vec128RectangularTransposeMicroKernelImpl {
   }
 };
 
+// Transposes a square block whose rows fill a pair of 128-bit vectors, in the
+// same way as the AVX square kernel below. This is used on NEON, which has
+// enough registers to hold the whole block.
+template <typename T, int bs>
+struct Vec128x2SquareTransposeMicroKernelImpl {
+  XLA_FLATTEN static void Apply(const char* __restrict a, int64_t lda,
+                                char* __restrict b, int64_t ldb) {
+    constexpr size_t element_size = sizeof(T);
+    static_assert(sizeof(Vec128) % element_size == 0);
+    static_assert(bs % 2 == 0);
+    static_assert(element_size * bs == 2 * sizeof(Vec128));
+    std::array<Vec128x2, bs> last_transpose;
+    XLA_UNROLL
+    for (int i = 0; i < bs / 2; ++i) {
+      const char* row0 = a + lda * (i + 0);
+      const char* row1 = a + lda * (i + bs / 2);
+      last_transpose[i] = {LoadElementIntoVec128<sizeof(Vec128)>(row0),
+                           LoadElementIntoVec128<sizeof(Vec128)>(row1)};
+      last_transpose[i + bs / 2] = {
+          LoadElementIntoVec128<sizeof(Vec128)>(row0 + sizeof(Vec128)),
+          LoadElementIntoVec128<sizeof(Vec128)>(row1 + sizeof(Vec128))};
+    }
+
+    last_transpose =
+        UnpackSequence<element_size, /*step_size=*/1,
+                       /*unpack_limit=*/sizeof(Vec128)>(last_transpose);
+
+    XLA_UNROLL
+    for (int i = 0; i < bs; ++i) {
+      StoreElementFromVec128<sizeof(Vec128), 0>(b + ldb * i,
+                                                last_transpose[i].lo);
+      StoreElementFromVec128<sizeof(Vec128), 0>(b + ldb * i + sizeof(Vec128),
+                                                last_transpose[i].hi);
+    }
+  }
+};
+
+#endif
+
+#ifdef __AVX512F__
+// The AVX-512 analogue of the AVX square kernel below: the loads place the
+// same 128-bit column of rows i, i + bs / 4, i + bs / 2 and i + 3 * bs / 4 in
+// the four 128-bit lanes of a vector, so that the remaining steps of the
+// transpose are unpacks within 128-bit lanes.
+template <typename T, int bs>
+struct Avx512SquareTransposeMicroKernelImpl {
+  XLA_FLATTEN static void Apply(const char* __restrict a, int64_t lda,
+                                char* __restrict b, int64_t ldb) {
+    constexpr size_t element_size = sizeof(T);
+    static_assert(element_size >= sizeof(uint32_t));
+    static_assert(bs % 4 == 0);
+    static_assert(element_size * bs == sizeof(__m512i));
+    constexpr int kRowsPerLane = bs / 4;
+    std::array<__m512i, bs> last_transpose;
+    XLA_UNROLL
+    for (int i = 0; i < kRowsPerLane; ++i) {
+      auto* row0 = reinterpret_cast<const __m128i*>(a + lda * i);
+      auto* row1 = reinterpret_cast<const __m128i*>(a + lda * (i + bs / 4));
+      auto* row2 = reinterpret_cast<const __m128i*>(a + lda * (i + bs / 2));
+      auto* row3 = reinterpret_cast<const __m128i*>(a + lda * (i + 3 * bs / 4));
+      XLA_UNROLL
+      for (int j = 0; j < 4; ++j) {
+        __m512i v = _mm512_castsi128_si512(_mm_loadu_si128(row0 + j));
+        v = _mm512_inserti32x4(v, _mm_loadu_si128(row1 + j), 1);
+        v = _mm512_inserti32x4(v, _mm_loadu_si128(row2 + j), 2);
+        v = _mm512_inserti32x4(v, _mm_loadu_si128(row3 + j), 3);
+        last_transpose[i + j * kRowsPerLane] = v;
+      }
+    }
+
+    last_transpose =
+        UnpackSequence<element_size, /*step_size=*/1,
+                       /*unpack_limit=*/sizeof(__m128i)>(last_transpose);
+
+    XLA_UNROLL
+    for (int i = 0; i < bs; ++i) {
+      _mm512_storeu_si512(reinterpret_cast<void*>(b + ldb * i),
+                          last_transpose[i]);
+    }
+  }
+};
 #endif
 
 #ifdef __AVX__
@@ -667,6 +784,13 @@ struct TransposeMicroKernel {
   static void Apply(const char* __restrict a, int64_t lda, char* __restrict b,
                     int64_t ldb) {
     if constexpr (bs % 2 == 0) {
+#ifdef __AVX512F__
+      if constexpr (sizeof(T) == sizeof(uint32_t) &&
+                    sizeof(T) * bs == sizeof(__m512i)) {
+        return Avx512SquareTransposeMicroKernelImpl<T, bs>::Apply(a, lda, b,
+                                                                  ldb);
+      }
+#endif
 #ifdef __AVX__
       if constexpr (sizeof(T) * bs == sizeof(__m256i)) {
         return AvxSquareTransposeMicroKernelImpl<T, bs>::Apply(a, lda, b, ldb);
@@ -675,6 +799,12 @@ struct TransposeMicroKernel {
                                                                     ldb);
       }
 #endif
+#ifdef XLA_HAS_ARM_NEON
+      if constexpr (sizeof(T) * bs == 2 * sizeof(Vec128)) {
+        return Vec128x2SquareTransposeMicroKernelImpl<T, bs>::Apply(a, lda, b,
+                                                                    ldb);
+      }
+#endif
 #ifdef XLA_HAS_VEC128
       if constexpr (sizeof(T) * bs <= sizeof(Vec128)) {
         return Vec128RectangularTransposeMicroKernelImpl<T, bs>::Apply(a, lda,
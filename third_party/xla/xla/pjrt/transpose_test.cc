@@ -411,6 +411,27 @@ TEST_P(TransposeTest, ParallelTransposeInt32) { TestTranspose<int32_t>(16); }
 INSTANTIATE_TEST_SUITE_P(TransposeTestInstance, TransposeTest,
                          ::testing::ValuesIn(GetTransposeTestCases()));
 
+TEST(TransposeTest, ParallelTransposeWithoutScheduleWork) {
+  std::vector<int64_t> dims = {2048, 2048};
+  std::vector<int64_t> permutation = {1, 0};
+  TransposePlan::Options options;
+  options.elem_size_in_bytes = sizeof(float);
+  options.dims = dims;
+  options.permutation = permutation;
+  options.num_threads = 4;
+  TF_ASSERT_OK_AND_ASSIGN(auto plan, TransposePlan::Create(options));
+  EXPECT_GT(plan->Parallelism(), 1);
+
+  xla::Array<float> input(dims);
+  input.FillIota(0);
+  xla::Array<float> expected(Permute(dims, permutation));
+  TransposeUsingEigen(input.data(), expected.data(), dims,
+                      Permute(dims, permutation), permutation);
+  xla::Array<float> output(Permute(dims, permutation));
+  plan->Execute(input.data(), output.data());
+  EXPECT_EQ(expected, output);
+}
+
 TEST(TransposeTest, NegativeStrides1D) {
   int64_t n = 10;
   std::vector<int32_t> input(n);
@@ -41,6 +41,7 @@ limitations under the License.
 #include "absl/strings/str_cat.h"
 #include "absl/strings/str_format.h"
 #include "absl/strings/string_view.h"
+#include "absl/time/time.h"
 #include "absl/types/span.h"
 #include "llvm/ADT/ArrayRef.h"
 #include "llvm/ADT/STLExtras.h"
@@ -95,6 +96,7 @@ limitations under the License.
 #include "mlir/Transforms/DialectConversion.h"  // from @llvm-project
 #include "xla/cpu_function_runtime.h"
 #include "xla/debug_options_flags.h"
+#include "xla/executable_run_options.h"
 #include "xla/hlo/ir/dfs_hlo_visitor_with_default.h"
 #include "xla/hlo/ir/hlo_casting_utils.h"
 #include "xla/hlo/ir/hlo_computation.h"
@@ -144,7 +146,9 @@ limitations under the License.
 #include "xla/service/cpu/cpu_instruction_fusion.h"
 #include "xla/service/cpu/cpu_layout_assignment.h"
 #include "xla/service/cpu/cpu_options.h"
+#include "xla/service/cpu/backend_config.pb.h"
 #include "xla/service/cpu/dot_op_emitter.h"
+#include "xla/service/cpu/dot_tiling_autotuner.h"
 #include "xla/service/cpu/hlo_xla_runtime_pipeline.h"
 #include "xla/service/cpu/ir_emitter.h"
 #include "xla/service/cpu/parallel_task_assignment.h"
@@ -189,6 +193,7 @@ limitations under the License.
 #include "xla/service/llvm_ir/llvm_util.h"
 #include "xla/service/logical_buffer.h"
 #include "xla/service/logistic_expander.h"
+#include "xla/service/maybe_owning_device_memory.h"
 #include "xla/service/map_inliner.h"
 #include "xla/service/operand_upcaster.h"
 #include "xla/service/optimization_barrier_expander.h"
@@ -224,6 +229,7 @@ limitations under the License.
 #include "xla/status.h"
 #include "xla/status_macros.h"
 #include "xla/statusor.h"
+#include "xla/stream_executor/device_memory.h"
 #include "xla/stream_executor/host/host_platform_id.h"
 #include "xla/stream_executor/platform.h"
 #include "xla/stream_executor/stream_executor.h"
@@ -235,6 +241,7 @@ limitations under the License.
 #include "tsl/platform/cpu_info.h"
 #include "tsl/platform/errors.h"
 #include "tsl/platform/logging.h"  // IWYU pragma: keep
+#include "tsl/platform/mem.h"
 #include "tsl/platform/status.h"
 #include "tsl/platform/statusor.h"
 
@@ -873,6 +880,51 @@ Status CpuCompiler::RunHloPassesThroughLayoutAssn(
   return pipeline.Run(module).status();
 }
 
+namespace {
+
+// Returns the fastest of a few runs of `executable` on zero-initialized
+// buffers.  `executable` must not have constants.
+absl::StatusOr<absl::Duration> TimeCpuExecutable(CpuExecutable& executable) {
+  constexpr int kNumRuns = 10;
+  const BufferAssignment& assignment = executable.buffer_assignment();
+
+  std::vector<std::unique_ptr<void, decltype(&tsl::port::AlignedFree)>> storage;
+  std::vector<MaybeOwningDeviceMemory> buffers;
+  for (const BufferAllocation& allocation : assignment.Allocations()) {
+    if (allocation.is_constant()) {
+      return Unimplemented("Cannot time an executable with constants");
+    }
+    if (allocation.is_thread_local()) {
+      buffers.emplace_back(se::DeviceMemoryBase());
+      continue;
+    }
+    void* buffer = tsl::port::AlignedMalloc(
+        allocation.size(), cpu_function_runtime::MinAlign());
+    if (buffer == nullptr) {
+      return ResourceExhausted("Failed to allocate %d bytes",
+                               allocation.size());
+    }
+    storage.emplace_back(buffer, &tsl::port::AlignedFree);
+    std::memset(buffer, 0, allocation.size());
+    buffers.emplace_back(se::DeviceMemoryBase(buffer, allocation.size()));
+  }
+
+  ExecutableRunOptions run_options;
+  // Warm up the caches before timing.
+  TF_RETURN_IF_ERROR(executable.ExecuteComputeFunction(
+      &run_options, buffers, /*hlo_execution_profile=*/nullptr));
+  absl::Duration best_time = absl::InfiniteDuration();
+  for (int i = 0; i < kNumRuns; ++i) {
+    absl::Time start = absl::Now();
+    TF_RETURN_IF_ERROR(executable.ExecuteComputeFunction(
+        &run_options, buffers, /*hlo_execution_profile=*/nullptr));
+    best_time = std::min(best_time, absl::Now() - start);
+  }
+  return best_time;
+}
+
+}  // namespace
+
 Status CpuCompiler::RunHloPassesAfterLayoutAssn(
     HloModule* module, bool is_aot_compile,
     LLVMTargetMachineFeatures* target_machine_features,
@@ -960,6 +1012,25 @@ Status CpuCompiler::RunHloPassesAfterLayoutAssn(
     // and thread synchronization dependencies which would likely increase
     // binary size (and most AOT applications are single-threaded).
     // TODO(b/29630486) Support multi-threaded AOT.
+    if (module->config().debug_options().xla_cpu_autotune_dot_tiling()) {
+      // Autotuning times the dots on the host, so it is not run for AOT
+      // either.
+      llvm::TargetMachine* target_machine =
+          target_machine_features->target_machine();
+      pipeline.AddPass<DotTilingAutotuner>(
+          target_machine_features,
+          absl::StrCat(target_machine->getTargetTriple().str(), ";",
+                       target_machine->getTargetCPU().str(), ";",
+                       target_machine->getTargetFeatureString().str()),
+          [this](const HloInstruction& dot, const DotTilingConfig& tiling)
+              -> absl::StatusOr<absl::Duration> {
+            TF_ASSIGN_OR_RETURN(
+                std::unique_ptr<CpuExecutable> executable,
+                CompileLegacyCpuExecutable(
+                    DotTilingAutotuner::ExtractDot(dot, tiling)));
+            return TimeCpuExecutable(*executable);
+          });
+    }
     pipeline.AddPass<ParallelTaskAssigner>(
         max_parallelism, ShapeSizeBytesFunction(), target_machine_features);
   }
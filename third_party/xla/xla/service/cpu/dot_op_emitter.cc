@@ -72,6 +72,9 @@ struct DotInfo {
   Shape rhs_shape;
   Shape result_shape;
   DotDimensionNumbers dim_nums;
+  // Tile sizes picked by the DotTilingAutotuner.  Zero fields mean that the
+  // default tile size is used.
+  DotTilingConfig tiling_config;
 
   DotInfo() = default;
 
@@ -81,6 +84,10 @@ struct DotInfo {
     rhs_shape = instr.operand(1)->shape();
     result_shape = instr.shape();
     dim_nums = instr.dot_dimension_numbers();
+    if (auto backend_config = instr.backend_config<BackendConfig>();
+        backend_config.ok() && backend_config->has_dot_tiling_config()) {
+      tiling_config = backend_config->dot_tiling_config();
+    }
   }
 };
 
@@ -202,8 +209,11 @@ class DotOpEmitter {
   // registers.
   int64_t GetGemvTilingFactor() const {
     const int64_t kDefaultTilingFactor = 8;
+    const int64_t tuned_tiling_factor =
+        dot_info_.tiling_config.gemv_tiling_factor();
     return options::LlvmIrGemvTilingFactor(hlo_module_config_)
-        .value_or(kDefaultTilingFactor);
+        .value_or(tuned_tiling_factor > 0 ? tuned_tiling_factor
+                                          : kDefaultTilingFactor);
   }
 
   std::tuple<int64_t, int64_t, int64_t> GetGemmTileSize() const {
@@ -213,8 +223,17 @@ class DotOpEmitter {
     // information in one place.
     const std::tuple<int64_t, int64_t, int64_t> kDefaultTileSize =
         std::tuple<int64_t, int64_t, int64_t>(11, 9, 1);
+    const DotTilingConfig& tuned = dot_info_.tiling_config;
+    const std::tuple<int64_t, int64_t, int64_t> tile_size(
+        tuned.gemm_tile_size_m() > 0 ? tuned.gemm_tile_size_m()
+                                     : std::get<0>(kDefaultTileSize),
+        tuned.gemm_tile_size_k() > 0 ? tuned.gemm_tile_size_k()
+                                     : std::get<1>(kDefaultTileSize),
+        tuned.gemm_tile_size_n_in_vector_width() > 0
+            ? tuned.gemm_tile_size_n_in_vector_width()
+            : std::get<2>(kDefaultTileSize));
     return options::LlvmIrGemmTileSize(hlo_module_config_)
-        .value_or(kDefaultTileSize);
+        .value_or(tile_size);
   }
 
   std::array<int64_t, 3> GetMlirGemmTileSize() const {
@@ -1481,6 +1500,25 @@ bool DotOperandsAndResultMustHaveRowMajorLayout(
          impl_strategy == DotImplementationStrategy::kEigen;
 }
 
+std::optional<TunableDotKind> GetTunableDotKind(
+    const HloInstruction& dot_instr,
+    const TargetMachineFeatures& target_machine_features) {
+  if (dot_instr.opcode() != HloOpcode::kDot || IsBatchDot(dot_instr)) {
+    return std::nullopt;
+  }
+
+  switch (GetDotImplementationStrategy(dot_instr.GetModule()->config(),
+                                       DotInfo(dot_instr),
+                                       target_machine_features)) {
+    case DotImplementationStrategy::kTiledLlvmIrGemv:
+      return TunableDotKind::kGemv;
+    case DotImplementationStrategy::kTiledLlvmIrGemm:
+      return TunableDotKind::kGemm;
+    default:
+      return std::nullopt;
+  }
+}
+
 Status EmitDotOperation(const HloInstruction& dot,
                         const llvm_ir::IrArray& target_array,
                         const llvm_ir::IrArray& lhs_array,
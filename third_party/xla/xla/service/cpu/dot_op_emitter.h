@@ -16,6 +16,8 @@ limitations under the License.
 #ifndef XLA_SERVICE_CPU_DOT_OP_EMITTER_H_
 #define XLA_SERVICE_CPU_DOT_OP_EMITTER_H_
 
+#include <optional>
+
 #include "absl/strings/string_view.h"
 #include "llvm/IR/IRBuilder.h"
 #include "mlir/IR/MLIRContext.h"  // from @llvm-project
@@ -48,6 +50,21 @@ bool DotImplementationCanHandleTranspose(
 std::optional<int64_t> ProfitableToMakeDotOperandColumnMajor(
     const HloInstruction& hlo);
 
+// The dot implementations whose tile sizes can be picked by autotuning.
+enum class TunableDotKind {
+  // A tiled Matrix*Vector product emitted as LLVM IR.
+  kGemv,
+  // A tiled Matrix*Matrix product emitted as LLVM IR.
+  kGemm,
+};
+
+// Returns the kind of tiled implementation `dot_instr` is lowered to, or
+// nullopt if it is lowered to an implementation without tunable tile sizes,
+// e.g. a call into Eigen or a batch dot.
+std::optional<TunableDotKind> GetTunableDotKind(
+    const HloInstruction& dot_instr,
+    const TargetMachineFeatures& target_machine_features);
+
 // Emit LLVM IR to perform the dot operation on lhs_array and rhs_array and
 // place the result in target_array. IR is emitted at current insert point of
 // the builder. Upon completion of the method, the insert point is set to the
@@ -0,0 +1,276 @@
+/* Copyright 2024 The OpenXLA Authors.
+
+Licensed under the Apache License, Version 2.0 (the "License");
+you may not use this file except in compliance with the License.
+You may obtain a copy of the License at
+
+    http://www.apache.org/licenses/LICENSE-2.0
+
+Unless required by applicable law or agreed to in writing, software
+distributed under the License is distributed on an "AS IS" BASIS,
+WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+See the License for the specific language governing permissions and
+limitations under the License.
+==============================================================================*/
+
+#include "xla/service/cpu/dot_tiling_autotuner.h"
+
+#include <algorithm>
+#include <cstdint>
+#include <memory>
+#include <optional>
+#include <string>
+#include <vector>
+
+#include "absl/base/thread_annotations.h"
+#include "absl/container/btree_map.h"
+#include "absl/container/flat_hash_set.h"
+#include "absl/status/status.h"
+#include "absl/status/statusor.h"
+#include "absl/strings/str_cat.h"
+#include "absl/strings/string_view.h"
+#include "absl/synchronization/mutex.h"
+#include "absl/time/time.h"
+#include "xla/hlo/ir/hlo_computation.h"
+#include "xla/hlo/ir/hlo_instruction.h"
+#include "xla/hlo/ir/hlo_module.h"
+#include "xla/hlo/ir/hlo_opcode.h"
+#include "xla/service/cpu/backend_config.pb.h"
+#include "xla/service/cpu/dot_op_emitter.h"
+#include "xla/service/hlo_module_config.h"
+#include "xla/shape_util.h"
+#include "xla/xla.pb.h"
+#include "tsl/platform/env.h"
+#include "tsl/platform/errors.h"
+#include "tsl/platform/logging.h"
+#include "tsl/platform/statusor.h"
+
+namespace xla {
+namespace cpu {
+namespace {
+
+// The default tile sizes of DotOpEmitter.
+constexpr int64_t kDefaultGemvTilingFactor = 8;
+constexpr int64_t kDefaultGemmTileSizeM = 11;
+constexpr int64_t kDefaultGemmTileSizeK = 9;
+constexpr int64_t kDefaultGemmTileSizeNInVectorWidth = 1;
+
+// The tuned tilings of all the dots seen by this process, ordered by key so
+// that the results file is deterministic.
+struct AutotuneCache {
+  absl::Mutex mu;
+  absl::btree_map<std::string, DotTilingConfig> results ABSL_GUARDED_BY(mu);
+  absl::flat_hash_set<std::string> loaded_files ABSL_GUARDED_BY(mu);
+};
+
+AutotuneCache& GetAutotuneCache() {
+  static auto* cache = new AutotuneCache();
+  return *cache;
+}
+
+std::string CacheKey(const HloInstruction& dot, TunableDotKind kind,
+                     absl::string_view target) {
+  return absl::StrCat(
+      kind == TunableDotKind::kGemv ? "gemv" : "gemm", ";",
+      ShapeUtil::HumanStringWithLayout(dot.operand(0)->shape()), ";",
+      ShapeUtil::HumanStringWithLayout(dot.operand(1)->shape()), ";",
+      ShapeUtil::HumanStringWithLayout(dot.shape()), ";",
+      dot.dot_dimension_numbers().ShortDebugString(), ";", target);
+}
+
+// Adds the results in `filename` to the cache, unless the file was already
+// read by this process or does not exist yet.
+absl::Status LoadResults(const std::string& filename) {
+  AutotuneCache& cache = GetAutotuneCache();
+  absl::MutexLock lock(&cache.mu);
+  if (!cache.loaded_files.insert(filename).second) {
+    return absl::OkStatus();
+  }
+  tsl::Env* env = tsl::Env::Default();
+  if (!env->FileExists(filename).ok()) {
+    return absl::OkStatus();
+  }
+  DotAutotuneResults results;
+  TF_RETURN_IF_ERROR(tsl::ReadTextProto(env, filename, &results));
+  for (const DotAutotuneResults::Entry& entry : results.entries()) {
+    cache.results.emplace(entry.key(), entry.config());
+  }
+  VLOG(1) << "Loaded " << results.entries_size()
+          << " dot autotuning results from " << filename;
+  return absl::OkStatus();
+}
+
+// Writes all the cached results to `filename`.  The results are written to a
+// temporary file first, so that concurrent readers never see a partial file.
+absl::Status SaveResults(const std::string& filename) {
+  DotAutotuneResults results;
+  {
+    AutotuneCache& cache = GetAutotuneCache();
+    absl::MutexLock lock(&cache.mu);
+    for (const auto& [key, config] : cache.results) {
+      DotAutotuneResults::Entry* entry = results.add_entries();
+      entry->set_key(key);
+      *entry->mutable_config() = config;
+    }
+  }
+  tsl::Env* env = tsl::Env::Default();
+  std::string temp_filename =
+      absl::StrCat(filename, ".tmp.", env->NowMicros());
+  TF_RETURN_IF_ERROR(tsl::WriteTextProto(env, temp_filename, results));
+  return env->RenameFile(temp_filename, filename);
+}
+
+std::optional<DotTilingConfig> LookUpResult(const std::string& key) {
+  AutotuneCache& cache = GetAutotuneCache();
+  absl::MutexLock lock(&cache.mu);
+  auto it = cache.results.find(key);
+  if (it == cache.results.end()) {
+    return std::nullopt;
+  }
+  return it->second;
+}
+
+void AddResult(const std::string& key, const DotTilingConfig& config) {
+  AutotuneCache& cache = GetAutotuneCache();
+  absl::MutexLock lock(&cache.mu);
+  cache.results.insert_or_assign(key, config);
+}
+
+}  // namespace
+
+std::vector<DotTilingConfig> DotTilingAutotuner::GetCandidateTilings(
+    TunableDotKind kind) {
+  std::vector<DotTilingConfig> candidates;
+  switch (kind) {
+    case TunableDotKind::kGemv: {
+      for (int64_t factor : {kDefaultGemvTilingFactor, int64_t{2}, int64_t{4},
+                             int64_t{16}}) {
+        candidates.emplace_back().set_gemv_tiling_factor(factor);
+      }
+      break;
+    }
+    case TunableDotKind::kGemm: {
+      DotTilingConfig& default_tiling = candidates.emplace_back();
+      default_tiling.set_gemm_tile_size_m(kDefaultGemmTileSizeM);
+      default_tiling.set_gemm_tile_size_k(kDefaultGemmTileSizeK);
+      default_tiling.set_gemm_tile_size_n_in_vector_width(
+          kDefaultGemmTileSizeNInVectorWidth);
+      for (int64_t m : {4, 8, 11}) {
+        for (int64_t k : {4, 9, 16}) {
+          for (int64_t n : {1, 2}) {
+            if (m == kDefaultGemmTileSizeM && k == kDefaultGemmTileSizeK &&
+                n == kDefaultGemmTileSizeNInVectorWidth) {
+              continue;
+            }
+            DotTilingConfig& tiling = candidates.emplace_back();
+            tiling.set_gemm_tile_size_m(m);
+            tiling.set_gemm_tile_size_k(k);
+            tiling.set_gemm_tile_size_n_in_vector_width(n);
+          }
+        }
+      }
+      break;
+    }
+  }
+  return candidates;
+}
+
+std::unique_ptr<HloModule> DotTilingAutotuner::ExtractDot(
+    const HloInstruction& dot, const DotTilingConfig& tiling) {
+  HloComputation::Builder builder(absl::StrCat(dot.name(), "_autotune"));
+  HloInstruction* lhs = builder.AddInstruction(
+      HloInstruction::CreateParameter(0, dot.operand(0)->shape(), "lhs"));
+  HloInstruction* rhs = builder.AddInstruction(
+      HloInstruction::CreateParameter(1, dot.operand(1)->shape(), "rhs"));
+  HloInstruction* new_dot = builder.AddInstruction(
+      dot.CloneWithNewOperands(dot.shape(), {lhs, rhs}));
+  BackendConfig backend_config;
+  *backend_config.mutable_dot_tiling_config() = tiling;
+  TF_CHECK_OK(new_dot->set_backend_config(backend_config));
+
+  auto module = std::make_unique<HloModule>(
+      absl::StrCat(dot.GetModule()->name(), "_", dot.name()),
+      dot.GetModule()->config());
+  HloComputation* computation = module->AddEntryComputation(builder.Build());
+  HloModuleConfig& config = module->mutable_config();
+  config.SetComputationLayoutIfExists(computation->ComputeProgramShape());
+  DebugOptions debug_options = config.debug_options();
+  debug_options.set_xla_cpu_autotune_dot_tiling(false);
+  config.set_debug_options(debug_options);
+  return module;
+}
+
+void DotTilingAutotuner::ClearCache() {
+  AutotuneCache& cache = GetAutotuneCache();
+  absl::MutexLock lock(&cache.mu);
+  cache.results.clear();
+  cache.loaded_files.clear();
+}
+
+absl::StatusOr<bool> DotTilingAutotuner::Run(
+    HloModule* module,
+    const absl::flat_hash_set<absl::string_view>& execution_threads) {
+  const std::string& results_file =
+      module->config().debug_options().xla_cpu_dot_autotune_results_file();
+  if (!results_file.empty()) {
+    TF_RETURN_IF_ERROR(LoadResults(results_file));
+  }
+
+  bool changed = false;
+  bool has_new_results = false;
+  for (HloComputation* computation : module->computations(execution_threads)) {
+    for (HloInstruction* instruction : computation->instructions()) {
+      if (instruction->opcode() != HloOpcode::kDot) {
+        continue;
+      }
+      std::optional<TunableDotKind> kind =
+          GetTunableDotKind(*instruction, target_machine_features_);
+      if (!kind.has_value()) {
+        continue;
+      }
+
+      const std::string key = CacheKey(*instruction, *kind, target_);
+      std::optional<DotTilingConfig> best = LookUpResult(key);
+      if (!best.has_value()) {
+        absl::Duration best_time = absl::InfiniteDuration();
+        for (const DotTilingConfig& tiling : GetCandidateTilings(*kind)) {
+          absl::StatusOr<absl::Duration> time =
+              benchmark_(*instruction, tiling);
+          if (!time.ok()) {
+            VLOG(1) << "Failed to time " << instruction->name() << " with "
+                    << tiling.ShortDebugString() << ": " << time.status();
+            continue;
+          }
+          VLOG(2) << instruction->name() << " with "
+                  << tiling.ShortDebugString() << " takes " << *time;
+          if (!best.has_value() || *time < best_time) {
+            best = tiling;
+            best_time = *time;
+          }
+        }
+        if (!best.has_value()) {
+          // Keep the default tiling, and try again in the next compilation.
+          continue;
+        }
+        VLOG(1) << "Picked " << best->ShortDebugString() << " for "
+                << instruction->name() << " (" << key << ")";
+        AddResult(key, *best);
+        has_new_results = true;
+      }
+
+      TF_ASSIGN_OR_RETURN(BackendConfig backend_config,
+                          instruction->backend_config<BackendConfig>());
+      *backend_config.mutable_dot_tiling_config() = *best;
+      TF_RETURN_IF_ERROR(instruction->set_backend_config(backend_config));
+      changed = true;
+    }
+  }
+
+  if (has_new_results && !results_file.empty()) {
+    TF_RETURN_IF_ERROR(SaveResults(results_file));
+  }
+  return changed;
+}
+
+}  // namespace cpu
+}  // namespace xla
@@ -0,0 +1,88 @@
+/* Copyright 2024 The OpenXLA Authors.
+
+Licensed under the Apache License, Version 2.0 (the "License");
+you may not use this file except in compliance with the License.
+You may obtain a copy of the License at
+
+    http://www.apache.org/licenses/LICENSE-2.0
+
+Unless required by applicable law or agreed to in writing, software
+distributed under the License is distributed on an "AS IS" BASIS,
+WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+See the License for the specific language governing permissions and
+limitations under the License.
+==============================================================================*/
+
+#ifndef XLA_SERVICE_CPU_DOT_TILING_AUTOTUNER_H_
+#define XLA_SERVICE_CPU_DOT_TILING_AUTOTUNER_H_
+
+#include <functional>
+#include <memory>
+#include <string>
+#include <utility>
+#include <vector>
+
+#include "absl/container/flat_hash_set.h"
+#include "absl/status/statusor.h"
+#include "absl/strings/string_view.h"
+#include "absl/time/time.h"
+#include "xla/hlo/ir/hlo_instruction.h"
+#include "xla/hlo/ir/hlo_module.h"
+#include "xla/service/cpu/backend_config.pb.h"
+#include "xla/service/cpu/dot_op_emitter.h"
+#include "xla/service/cpu/target_machine_features.h"
+#include "xla/service/hlo_pass_interface.h"
+
+namespace xla {
+namespace cpu {
+
+// Picks the tile sizes of the dots that are lowered to tiled LLVM IR by
+// timing a few candidate tilings of each of them, and records the fastest one
+// in the dot's backend config, where DotOpEmitter picks it up.
+//
+// Results are cached for the lifetime of the process, keyed by the shapes and
+// dimension numbers of the dot and by `target`, which should identify the
+// host CPU.  If `xla_cpu_dot_autotune_results_file` is set, the cache is also
+// loaded from and saved to that file, so that later processes do not have to
+// time the same dots again.
+class DotTilingAutotuner : public HloModulePass {
+ public:
+  // Returns the run time of `dot` lowered with the tile sizes in `tiling`.
+  using BenchmarkFn = std::function<absl::StatusOr<absl::Duration>(
+      const HloInstruction& dot, const DotTilingConfig& tiling)>;
+
+  DotTilingAutotuner(const TargetMachineFeatures* target_machine_features,
+                     std::string target, BenchmarkFn benchmark)
+      : target_machine_features_(*target_machine_features),
+        target_(std::move(target)),
+        benchmark_(std::move(benchmark)) {}
+
+  absl::string_view name() const override { return "dot-tiling-autotuner"; }
+
+  using HloPassInterface::Run;
+  absl::StatusOr<bool> Run(
+      HloModule* module,
+      const absl::flat_hash_set<absl::string_view>& execution_threads) override;
+
+  // Returns the tilings that are timed for a dot of kind `kind`.  The first
+  // one is the default tiling.
+  static std::vector<DotTilingConfig> GetCandidateTilings(TunableDotKind kind);
+
+  // Returns a module whose entry computation computes `dot` on its parameters,
+  // lowered with the tile sizes in `tiling`.
+  static std::unique_ptr<HloModule> ExtractDot(const HloInstruction& dot,
+                                               const DotTilingConfig& tiling);
+
+  // Forgets all the cached results.  Only meant for tests.
+  static void ClearCache();
+
+ private:
+  const TargetMachineFeatures& target_machine_features_;
+  const std::string target_;
+  const BenchmarkFn benchmark_;
+};
+
+}  // namespace cpu
+}  // namespace xla
+
+#endif  // XLA_SERVICE_CPU_DOT_TILING_AUTOTUNER_H_
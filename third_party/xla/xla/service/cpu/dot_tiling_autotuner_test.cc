@@ -0,0 +1,179 @@
+/* Copyright 2024 The OpenXLA Authors.
+
+Licensed under the Apache License, Version 2.0 (the "License");
+you may not use this file except in compliance with the License.
+You may obtain a copy of the License at
+
+    http://www.apache.org/licenses/LICENSE-2.0
+
+Unless required by applicable law or agreed to in writing, software
+distributed under the License is distributed on an "AS IS" BASIS,
+WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+See the License for the specific language governing permissions and
+limitations under the License.
+==============================================================================*/
+
+#include "xla/service/cpu/dot_tiling_autotuner.h"
+
+#include <cstddef>
+#include <cstdint>
+#include <memory>
+#include <string>
+#include <utility>
+
+#include "absl/status/status.h"
+#include "absl/status/statusor.h"
+#include "absl/time/time.h"
+#include "xla/hlo/ir/hlo_instruction.h"
+#include "xla/hlo/ir/hlo_module.h"
+#include "xla/service/cpu/backend_config.pb.h"
+#include "xla/service/cpu/dot_op_emitter.h"
+#include "xla/service/cpu/target_machine_features.h"
+#include "xla/service/cpu/target_machine_features_fake.h"
+#include "xla/test.h"
+#include "xla/tests/hlo_test_base.h"
+#include "xla/xla.pb.h"
+#include "tsl/lib/core/status_test_util.h"
+#include "tsl/platform/path.h"
+#include "tsl/platform/statusor.h"
+
+namespace xla {
+namespace cpu {
+namespace {
+
+// A matrix-vector product, which is lowered to a tiled GEMV.
+constexpr char kGemvHlo[] = R"(
+  HloModule Gemv
+  ENTRY Gemv {
+    lhs = f32[64,32]{1,0} parameter(0)
+    rhs = f32[32,1]{1,0} parameter(1)
+    ROOT dot = f32[64,1]{1,0} dot(lhs, rhs),
+      lhs_contracting_dims={1}, rhs_contracting_dims={0}
+  }
+)";
+
+class DotTilingAutotunerTest : public HloTestBase {
+ protected:
+  DotTilingAutotunerTest()
+      : target_machine_features_([](int64_t shape_size) {
+          return TargetMachineFeatures::kEigenExpectedTensorAlignment;
+        }) {}
+
+  void SetUp() override { DotTilingAutotuner::ClearCache(); }
+
+  absl::StatusOr<bool> RunAutotuner(
+      HloModule* module, DotTilingAutotuner::BenchmarkFn benchmark) {
+    return DotTilingAutotuner(&target_machine_features_, "test-cpu",
+                              std::move(benchmark))
+        .Run(module);
+  }
+
+  // Pretends that a GEMV tiling factor of 4 is the fastest, and counts the
+  // timed tilings in `num_benchmarks_`.
+  DotTilingAutotuner::BenchmarkFn FakeBenchmark() {
+    return [this](const HloInstruction& dot, const DotTilingConfig& tiling)
+               -> absl::StatusOr<absl::Duration> {
+      ++num_benchmarks_;
+      return tiling.gemv_tiling_factor() == 4 ? absl::Microseconds(1)
+                                              : absl::Microseconds(2);
+    };
+  }
+
+  static int64_t GetGemvTilingFactor(const HloModule& module) {
+    auto backend_config = module.entry_computation()
+                              ->root_instruction()
+                              ->backend_config<BackendConfig>();
+    CHECK_OK(backend_config.status());
+    return backend_config->dot_tiling_config().gemv_tiling_factor();
+  }
+
+  TargetMachineFeaturesWithFakeAlignmentLogic target_machine_features_;
+  size_t num_benchmarks_ = 0;
+};
+
+TEST_F(DotTilingAutotunerTest, PicksFastestTiling) {
+  TF_ASSERT_OK_AND_ASSIGN(std::unique_ptr<HloModule> module,
+                          ParseAndReturnVerifiedModule(kGemvHlo));
+  TF_ASSERT_OK_AND_ASSIGN(bool changed,
+                          RunAutotuner(module.get(), FakeBenchmark()));
+  EXPECT_TRUE(changed);
+  EXPECT_EQ(GetGemvTilingFactor(*module), 4);
+  EXPECT_EQ(num_benchmarks_,
+            DotTilingAutotuner::GetCandidateTilings(TunableDotKind::kGemv)
+                .size());
+}
+
+TEST_F(DotTilingAutotunerTest, ReusesCachedResults) {
+  TF_ASSERT_OK_AND_ASSIGN(std::unique_ptr<HloModule> module,
+                          ParseAndReturnVerifiedModule(kGemvHlo));
+  TF_ASSERT_OK(RunAutotuner(module.get(), FakeBenchmark()).status());
+  const size_t num_benchmarks = num_benchmarks_;
+
+  TF_ASSERT_OK_AND_ASSIGN(std::unique_ptr<HloModule> other_module,
+                          ParseAndReturnVerifiedModule(kGemvHlo));
+  TF_ASSERT_OK_AND_ASSIGN(bool changed,
+                          RunAutotuner(other_module.get(), FakeBenchmark()));
+  EXPECT_TRUE(changed);
+  EXPECT_EQ(GetGemvTilingFactor(*other_module), 4);
+  EXPECT_EQ(num_benchmarks_, num_benchmarks);
+}
+
+TEST_F(DotTilingAutotunerTest, KeepsDefaultTilingIfTimingFails) {
+  TF_ASSERT_OK_AND_ASSIGN(std::unique_ptr<HloModule> module,
+                          ParseAndReturnVerifiedModule(kGemvHlo));
+  TF_ASSERT_OK_AND_ASSIGN(
+      bool changed,
+      RunAutotuner(module.get(),
+                   [](const HloInstruction& dot, const DotTilingConfig& tiling)
+                       -> absl::StatusOr<absl::Duration> {
+                     return absl::InternalError("timing failed");
+                   }));
+  EXPECT_FALSE(changed);
+  EXPECT_EQ(GetGemvTilingFactor(*module), 0);
+}
+
+TEST_F(DotTilingAutotunerTest, DoesNotTuneEigenDots) {
+  const std::string hlo_string = R"(
+    HloModule Gemm
+    ENTRY Gemm {
+      lhs = f32[256,256]{1,0} parameter(0)
+      rhs = f32[256,256]{1,0} parameter(1)
+      ROOT dot = f32[256,256]{1,0} dot(lhs, rhs),
+        lhs_contracting_dims={1}, rhs_contracting_dims={0}
+    }
+  )";
+  TF_ASSERT_OK_AND_ASSIGN(std::unique_ptr<HloModule> module,
+                          ParseAndReturnVerifiedModule(hlo_string));
+  TF_ASSERT_OK_AND_ASSIGN(bool changed,
+                          RunAutotuner(module.get(), FakeBenchmark()));
+  EXPECT_FALSE(changed);
+  EXPECT_EQ(num_benchmarks_, 0u);
+}
+
+TEST_F(DotTilingAutotunerTest, LoadsResultsFromFile) {
+  const std::string results_file =
+      tsl::io::JoinPath(::testing::TempDir(), "dot_autotune_results.pbtxt");
+  DebugOptions debug_options = GetDebugOptionsForTest();
+  debug_options.set_xla_cpu_dot_autotune_results_file(results_file);
+
+  TF_ASSERT_OK_AND_ASSIGN(std::unique_ptr<HloModule> module,
+                          ParseAndReturnVerifiedModule(kGemvHlo));
+  module->mutable_config().set_debug_options(debug_options);
+  TF_ASSERT_OK(RunAutotuner(module.get(), FakeBenchmark()).status());
+
+  // A fresh process reads the results back instead of timing the dot again.
+  DotTilingAutotuner::ClearCache();
+  const size_t num_benchmarks = num_benchmarks_;
+  TF_ASSERT_OK_AND_ASSIGN(std::unique_ptr<HloModule> other_module,
+                          ParseAndReturnVerifiedModule(kGemvHlo));
+  other_module->mutable_config().set_debug_options(debug_options);
+  TF_ASSERT_OK_AND_ASSIGN(bool changed,
+                          RunAutotuner(other_module.get(), FakeBenchmark()));
+  EXPECT_TRUE(changed);
+  EXPECT_EQ(GetGemvTilingFactor(*other_module), 4);
+  EXPECT_EQ(num_benchmarks_, num_benchmarks);
+}
+
+}  // namespace
+}  // namespace cpu
+}  // namespace xla
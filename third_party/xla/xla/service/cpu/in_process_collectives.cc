@@ -16,20 +16,20 @@ limitations under the License.
 #include "xla/service/cpu/in_process_collectives.h"
 
 #include <algorithm>
+#include <atomic>
 #include <cstddef>
 #include <cstdint>
 #include <cstring>
-#include <limits>
 #include <memory>
 #include <optional>
-#include <string>
 #include <vector>
 
+#include "absl/functional/function_ref.h"
 #include "absl/status/status.h"
 #include "absl/status/statusor.h"
 #include "absl/strings/str_cat.h"
-#include "absl/strings/str_format.h"
-#include "absl/strings/str_join.h"
+#include "absl/synchronization/mutex.h"
+#include "absl/time/clock.h"
 #include "absl/time/time.h"
 #include "absl/types/span.h"
 #include "xla/primitive_util.h"
@@ -41,50 +41,200 @@ limitations under the License.
 #include "xla/util.h"
 #include "xla/xla_data.pb.h"
 #include "tsl/platform/errors.h"
+#include "tsl/platform/status.h"
 
 namespace xla {
 namespace cpu {
 namespace runtime {
 namespace {
 
-void FormatGlobalId(std::string* out, const GlobalDeviceId& device) {
-  absl::StrAppend(out, device.value());
-}
+// Reductions are computed one tile at a time, so that the accumulated tile
+// stays in L1 cache while the inputs of all participants are added to it.
+constexpr size_t kReductionTileBytes = 16 * 1024;
 
-struct AllReduceParticipantData : ParticipantData {
-  explicit AllReduceParticipantData(const RendezvousKey& rendezvous_key_p,
-                                    int rank)
-      : ParticipantData(rendezvous_key_p, rank) {}
+// Waiters spin this many times before sleeping until the barrier completes.
+constexpr int kNumSpinsBeforeSleep = 4096;
 
-  int64_t element_count;
-  const void* source_data;
-  void* destination_data;
-  PrimitiveType primitive_type;
+// A reusable barrier for the participants of a collective operation. Unlike a
+// `tsl::BlockingCounter`, arriving does not take a mutex and waiters spin
+// before sleeping, since the participants of CPU collectives usually arrive
+// within microseconds of each other. The barrier can be reused immediately
+// after `Wait` returns, e.g. by the next iteration of a loop running the same
+// collective operation.
+class SpinBarrier {
+ public:
+  explicit SpinBarrier(int num_participants)
+      : num_participants_(num_participants) {}
+
+  // Waits until all participants have called `Wait` for the current
+  // generation. Memory writes before `Wait` are visible to all participants
+  // after `Wait` returns OK.
+  //
+  // If the participants do not all arrive before `deadline`, the barrier is
+  // aborted: `Wait` fails for all the participants waiting for it and for the
+  // ones arriving later, so that none of them proceeds without the others.
+  absl::Status Wait(absl::Time deadline) {
+    uint64_t state = state_.fetch_add(1, std::memory_order_acq_rel);
+    if (state & kAborted) {
+      return AbortedError();
+    }
+    uint64_t generation = state >> kGenerationShift;
+    if ((state & kCountMask) + 1 == num_participants_) {
+      // Nothing else updates the state of a complete generation, as an abort
+      // requires a missing participant.
+      state_.store((generation + 1) << kGenerationShift);
+      if (num_sleepers_.load() > 0) {
+        absl::MutexLock lock(&mu_);
+        cv_.SignalAll();
+      }
+      return absl::OkStatus();
+    }
 
-  ReductionKind reduction_kind;
+    for (int i = 0; i < kNumSpinsBeforeSleep; ++i) {
+      state = state_.load(std::memory_order_acquire);
+      if (IsDone(state, generation)) {
+        return state & kAborted ? AbortedError() : absl::OkStatus();
+      }
+    }
+    return Sleep(generation, deadline);
+  }
+
+ private:
+  // The state packs the generation, whether the barrier is aborted and the
+  // number of participants that arrived in the current generation.
+  static constexpr int kGenerationShift = 32;
+  static constexpr uint64_t kAborted = uint64_t{1} << 31;
+  static constexpr uint64_t kCountMask = kAborted - 1;
+
+  static bool IsDone(uint64_t state, uint64_t generation) {
+    return (state >> kGenerationShift) != generation || (state & kAborted);
+  }
+
+  static absl::Status AbortedError() {
+    return absl::DeadlineExceededError(
+        "Timed out waiting for the participants of a collective operation.");
+  }
+
+  absl::Status Sleep(uint64_t generation, absl::Time deadline) {
+    // The participant completing the generation signals `cv_` if it observes
+    // a sleeper, and a sleeper observes the completed generation otherwise.
+    num_sleepers_.fetch_add(1);
+    absl::MutexLock lock(&mu_);
+    uint64_t state = state_.load();
+    while (!IsDone(state, generation)) {
+      if (cv_.WaitWithDeadline(&mu_, deadline)) {
+        if (TryAbort(generation)) {
+          cv_.SignalAll();
+        } else {
+          // All the participants arrived, and the last one is completing the
+          // generation.
+          deadline = absl::InfiniteFuture();
+        }
+      }
+      state = state_.load(std::memory_order_acquire);
+    }
+    num_sleepers_.fetch_sub(1, std::memory_order_relaxed);
+    return state & kAborted ? AbortedError() : absl::OkStatus();
+  }
 
-  std::string ToString() const override {
-    return absl::StrFormat(
-        "AllReduceParticipantData{rank=%d, element_count=%d, type=%s, "
-        "rendezvous_key=%s}",
-        local_rank, element_count, PrimitiveType_Name(primitive_type),
-        rendezvous_key.ToString());
+  // Aborts the barrier if `generation` is still missing participants.
+  bool TryAbort(uint64_t generation) {
+    uint64_t state = state_.load(std::memory_order_acquire);
+    while (!IsDone(state, generation) &&
+           (state & kCountMask) < num_participants_) {
+      if (state_.compare_exchange_weak(state, state | kAborted,
+                                       std::memory_order_acq_rel)) {
+        return true;
+      }
+    }
+    return false;
   }
+
+  const uint64_t num_participants_;
+  std::atomic<uint64_t> state_{0};
+
+  std::atomic<int> num_sleepers_{0};
+  absl::Mutex mu_;
+  absl::CondVar cv_;
 };
 
-template <typename T>
-T GetInitialValue(ReductionKind reduction_kind) {
-  switch (reduction_kind) {
-    case ReductionKind::SUM:
-      return static_cast<T>(0);
-    case ReductionKind::PRODUCT:
-      return static_cast<T>(1);
-    case ReductionKind::MIN:
-      return std::numeric_limits<T>::max();
-    case ReductionKind::MAX:
-      return std::numeric_limits<T>::min();
+// The state shared by the participants of a collective operation: the data of
+// each participant, published before the first barrier and read by the other
+// participants until the second barrier.
+template <typename ParticipantData>
+class CollectiveState {
+ public:
+  explicit CollectiveState(const RendezvousKey& key)
+      : key_(key),
+        participants_(key.num_local_participants),
+        barrier_(key.num_local_participants) {}
+
+  // Publishes the data of the participant with `rank`, waits for all the
+  // participants to arrive, runs `fn` and waits for all the participants to
+  // finish. `fn` takes the data of all the participants indexed by rank. If
+  // the participants do not all arrive within `timeout`, the collective
+  // operation fails for all of them without running `fn`.
+  absl::Status Run(
+      int rank, const ParticipantData& participant, absl::Duration timeout,
+      absl::FunctionRef<absl::Status(absl::Span<const ParticipantData* const>)>
+          fn) {
+    participants_[rank] = &participant;
+    if (!barrier_.Wait(absl::Now() + timeout).ok()) {
+      return absl::DeadlineExceededError(
+          absl::StrCat("Timed out waiting for all participants to arrive at "
+                       "the collective operation ",
+                       key_.ToString()));
+    }
+    absl::Status status = fn(participants_);
+    // The other participants may still read this participant's buffers, so
+    // wait for them even if `fn` failed. They have all arrived, so they finish
+    // without a deadline.
+    TF_CHECK_OK(barrier_.Wait(absl::InfiniteFuture()));
+    return status;
   }
-}
+
+ private:
+  const RendezvousKey key_;
+  std::vector<const ParticipantData*> participants_;
+  SpinBarrier barrier_;
+};
+
+struct AllReduceParticipantData {
+  ReductionKind reduction_kind;
+  PrimitiveType element_type;
+  size_t num_elements;
+  const void* source_buffer;
+  void* destination_buffer;
+};
+
+struct CollectivePermuteParticipantData {
+  size_t num_bytes;
+  const void* source_buffer;
+  void* destination_buffer;
+  // From which rank is this participant receiving its data? Optional; if
+  // absent fill with zeros.
+  std::optional<int> source_rank;
+};
+
+struct AllToAllParticipantData {
+  size_t chunk_bytes;
+  absl::Span<const void* const> source_buffers;
+  absl::Span<void* const> destination_buffers;
+};
+
+struct AllGatherParticipantData {
+  size_t chunk_bytes;
+  const void* source_buffer;
+  void* destination_buffer;
+};
+
+struct ReduceScatterParticipantData {
+  ReductionKind reduction_kind;
+  PrimitiveType element_type;
+  size_t chunk_elems;
+  const void* source_buffer;
+  void* destination_buffer;
+};
 
 // We cannot use static_assert(false), because the C++ standard (prior to
 // CWG2518) does not allow the statement discarded by a constexpr if to
@@ -93,63 +243,73 @@ T GetInitialValue(ReductionKind reduction_kind) {
 template <ReductionKind>
 constexpr bool always_false_v = false;
 
+// Computes `acc[i] = acc[i] <reduction> input[i]`. The loops are simple
+// element-wise loops, so that the compiler vectorizes them.
 template <ReductionKind reduction_kind, typename T>
-void ReduceHelper(absl::Span<T> acc, absl::Span<T const* const> inputs) {
-  // TODO(penporn): make sure this gets vectorized.
+void ReduceTile(T* acc, const T* input, size_t num_elems) {
   if constexpr (reduction_kind == ReductionKind::SUM) {
-    for (size_t j = 0; j < inputs.size(); ++j) {
-      for (size_t i = 0; i < acc.size(); ++i) {
-        acc[i] += inputs[j][i];
-      }
+    for (size_t i = 0; i < num_elems; ++i) {
+      acc[i] += input[i];
     }
   } else if constexpr (reduction_kind == ReductionKind::PRODUCT) {
-    for (size_t j = 0; j < inputs.size(); ++j) {
-      for (size_t i = 0; i < acc.size(); ++i) {
-        acc[i] *= inputs[j][i];
-      }
+    for (size_t i = 0; i < num_elems; ++i) {
+      acc[i] *= input[i];
     }
   } else if constexpr (reduction_kind == ReductionKind::MIN) {
-    for (size_t j = 0; j < inputs.size(); ++j) {
-      for (size_t i = 0; i < acc.size(); ++i) {
-        acc[i] = std::min(acc[i], inputs[j][i]);
-      }
+    for (size_t i = 0; i < num_elems; ++i) {
+      acc[i] = std::min(acc[i], input[i]);
     }
   } else if constexpr (reduction_kind == ReductionKind::MAX) {
-    for (size_t j = 0; j < inputs.size(); ++j) {
-      for (size_t i = 0; i < acc.size(); ++i) {
-        acc[i] = std::max(acc[i], inputs[j][i]);
-      }
+    for (size_t i = 0; i < num_elems; ++i) {
+      acc[i] = std::max(acc[i], input[i]);
     }
   } else {
     static_assert(always_false_v<reduction_kind>, "Unsupported reduction kind");
   }
 }
 
-template <PrimitiveType PT>
-absl::Status ReduceScatter(ReductionKind reduction_kind,
-                           absl::Span<const void* const> inputs, void* output,
-                           int64_t num_elems) {
-  using T = typename primitive_util::PrimitiveTypeToNative<PT>::type;
-  T initial_value = GetInitialValue<T>(reduction_kind);
-
-  absl::Span<T> out_chunk =
-      absl::MakeSpan(reinterpret_cast<T*>(output), num_elems);
-  for (int64_t i = 0; i < num_elems; ++i) {
-    out_chunk[i] = initial_value;
+// Reduces `num_elems` elements of `inputs` into `output`, and copies the
+// result to `copies`. `inputs[0]` may alias `output`; the other inputs and
+// copies may alias the buffers of other participants, which only the caller
+// reads and writes at these offsets.
+template <ReductionKind reduction_kind, typename T>
+void Reduce(absl::Span<const void* const> inputs, void* output,
+            absl::Span<void* const> copies, size_t num_elems) {
+  constexpr size_t kTileElems = std::max<size_t>(
+      1, kReductionTileBytes / sizeof(T));
+  T* out = static_cast<T*>(output);
+  for (size_t start = 0; start < num_elems; start += kTileElems) {
+    size_t tile_elems = std::min(kTileElems, num_elems - start);
+    const T* first = static_cast<const T*>(inputs[0]) + start;
+    if (first != out + start) {
+      std::memcpy(out + start, first, tile_elems * sizeof(T));
+    }
+    for (size_t j = 1; j < inputs.size(); ++j) {
+      ReduceTile<reduction_kind>(
+          out + start, static_cast<const T*>(inputs[j]) + start, tile_elems);
+    }
+    for (void* copy : copies) {
+      std::memcpy(static_cast<T*>(copy) + start, out + start,
+                  tile_elems * sizeof(T));
+    }
   }
+}
 
-  absl::Span<T const* const> input_chunks(
-      reinterpret_cast<T const* const*>(inputs.data()), inputs.size());
+template <PrimitiveType PT>
+absl::Status Reduce(ReductionKind reduction_kind,
+                    absl::Span<const void* const> inputs, void* output,
+                    absl::Span<void* const> copies, size_t num_elems) {
+  using T = typename primitive_util::PrimitiveTypeToNative<PT>::type;
   switch (reduction_kind) {
     case ReductionKind::SUM:
-      ReduceHelper<ReductionKind::SUM, T>(out_chunk, input_chunks);
+      Reduce<ReductionKind::SUM, T>(inputs, output, copies, num_elems);
       break;
     case ReductionKind::PRODUCT:
-      ReduceHelper<ReductionKind::PRODUCT, T>(out_chunk, input_chunks);
+      Reduce<ReductionKind::PRODUCT, T>(inputs, output, copies, num_elems);
       break;
     case ReductionKind::MIN:
       if constexpr (!is_complex_v<T>) {
-        ReduceHelper<ReductionKind::MIN, T>(out_chunk, input_chunks);
+        Reduce<ReductionKind::MIN, T>(inputs, output, copies, num_elems);
       } else {
         return absl::InvalidArgumentError(
             "Min reductions not supported for complex types");
@@ -157,365 +317,98 @@ absl::Status ReduceScatter(ReductionKind reduction_kind,
       break;
     case ReductionKind::MAX:
       if constexpr (!is_complex_v<T>) {
-        ReduceHelper<ReductionKind::MAX, T>(out_chunk, input_chunks);
+        Reduce<ReductionKind::MAX, T>(inputs, output, copies, num_elems);
       } else {
         return absl::InvalidArgumentError(
             "Max reductions not supported for complex types");
       }
       break;
   }
-
   return absl::OkStatus();
 }
 
-class CpuAllReduceRendezvous
-    : public Rendezvous<AllReduceParticipantData, std::nullptr_t> {
- public:
-  explicit CpuAllReduceRendezvous(const RendezvousKey& k)
-      : Rendezvous<AllReduceParticipantData, std::nullptr_t>(k) {}
-
- protected:
-  absl::StatusOr<std::nullptr_t> RunCollectiveOp(
-      const AllReduceParticipantData& me) override {
-    VLOG(3) << me.ToString();
-    int64_t world_size = participants_.size();
-    // Divide the buffer up into equal(ish) chunks. Rank r computes the r-th
-    // chunk of the output.
-    int64_t chunk_elems = CeilOfRatio(me.element_count, world_size);
-
-    int64_t start_elem = me.local_rank * chunk_elems;
-    int64_t end_elem = std::min(start_elem + chunk_elems, me.element_count);
-    chunk_elems = std::max(int64_t{0}, end_elem - start_elem);
-    if (chunk_elems == 0) {
-      return nullptr;
-    }
-
-    auto bytes_per_elem = primitive_util::ByteWidth(me.primitive_type);
-    int64_t chunk_offset = start_elem * bytes_per_elem;
-    int64_t chunk_bytes = chunk_elems * bytes_per_elem;
-    void* reduce_output =
-        reinterpret_cast<char*>(me.destination_data) + chunk_offset;
-
-    std::vector<const void*> inputs;
-    inputs.reserve(world_size);
-    for (const auto& p : participants_) {
-      inputs.push_back(reinterpret_cast<const char*>(p->source_data) +
-                       chunk_offset);
-    }
-
-    switch (me.primitive_type) {
-      case S8:
-        TF_RETURN_IF_ERROR(ReduceScatter<S8>(me.reduction_kind, inputs,
-                                             reduce_output, chunk_elems));
-        break;
-      case PRED:
-      case U8:
-        TF_RETURN_IF_ERROR(ReduceScatter<U8>(me.reduction_kind, inputs,
-                                             reduce_output, chunk_elems));
-        break;
-      case S16:
-        TF_RETURN_IF_ERROR(ReduceScatter<S16>(me.reduction_kind, inputs,
-                                              reduce_output, chunk_elems));
-        break;
-      case U16:
-        TF_RETURN_IF_ERROR(ReduceScatter<U16>(me.reduction_kind, inputs,
-                                              reduce_output, chunk_elems));
-        break;
-      case S32:
-        TF_RETURN_IF_ERROR(ReduceScatter<S32>(me.reduction_kind, inputs,
-                                              reduce_output, chunk_elems));
-        break;
-      case U32:
-        TF_RETURN_IF_ERROR(ReduceScatter<U32>(me.reduction_kind, inputs,
-                                              reduce_output, chunk_elems));
-        break;
-      case S64:
-        TF_RETURN_IF_ERROR(ReduceScatter<S64>(me.reduction_kind, inputs,
-                                              reduce_output, chunk_elems));
-        break;
-      case U64:
-        TF_RETURN_IF_ERROR(ReduceScatter<U64>(me.reduction_kind, inputs,
-                                              reduce_output, chunk_elems));
-        break;
-      case F16:
-        TF_RETURN_IF_ERROR(ReduceScatter<F16>(me.reduction_kind, inputs,
-                                              reduce_output, chunk_elems));
-        break;
-      case F32:
-        TF_RETURN_IF_ERROR(ReduceScatter<F32>(me.reduction_kind, inputs,
-                                              reduce_output, chunk_elems));
-        break;
-      case F64:
-        TF_RETURN_IF_ERROR(ReduceScatter<F64>(me.reduction_kind, inputs,
-                                              reduce_output, chunk_elems));
-        break;
-      case C64:
-        TF_RETURN_IF_ERROR(ReduceScatter<C64>(me.reduction_kind, inputs,
-                                              reduce_output, chunk_elems));
-        break;
-      case C128:
-        TF_RETURN_IF_ERROR(ReduceScatter<C128>(me.reduction_kind, inputs,
-                                               reduce_output, chunk_elems));
-        break;
-      default:
-        return absl::UnimplementedError("Unexpected datatype");
-    }
-
-    // All-gather the reduced chunks.
-    for (const auto& p : participants_) {
-      if (p->local_rank != me.local_rank) {
-        std::memcpy(reinterpret_cast<char*>(p->destination_data) + chunk_offset,
-                    reduce_output, chunk_bytes);
-      }
-    }
-    return nullptr;
-  }
-};
-
-struct CollectivePermuteParticipantData : ParticipantData {
-  CollectivePermuteParticipantData(const RendezvousKey& rendezvous_key_p,
-                                   int rank)
-      : ParticipantData(rendezvous_key_p, rank) {}
-  const void* source_buffer;
-  void* destination_buffer;
-  size_t num_bytes;
-
-  // From which rank is this participant receiving its data? Optional; if
-  // absent fill with zeros.
-  std::optional<int> source_rank;
-
-  std::string ToString() const override {
-    return absl::StrFormat(
-        "CollectivePermuteParticipantData{rank=%d, "
-        "source_buffer=%p, destination_buffer=%p, num_bytes=%d, "
-        "source_replica_id=%d, "
-        "devices=[%s]}",
-        local_rank, source_buffer, destination_buffer, num_bytes,
-        source_rank.value_or(-1),
-        absl::StrJoin(rendezvous_key.global_devices, ", ", FormatGlobalId));
-  }
-};
-
-class CpuCollectivePermuteRendezvous
-    : public Rendezvous<CollectivePermuteParticipantData, std::nullptr_t> {
- public:
-  explicit CpuCollectivePermuteRendezvous(const RendezvousKey& k)
-      : Rendezvous<CollectivePermuteParticipantData, std::nullptr_t>(k) {}
-
- protected:
-  CollectivesInterface* collectives_;
-
-  absl::StatusOr<std::nullptr_t> RunCollectiveOp(
-      const CollectivePermuteParticipantData& p) override {
-    VLOG(3) << p.ToString();
-    if (p.source_rank) {
-      std::memcpy(p.destination_buffer,
-                  participants_[*p.source_rank]->source_buffer, p.num_bytes);
-    } else {
-      std::memset(p.destination_buffer, 0, p.num_bytes);
-    }
-    return nullptr;
-  }
-};
-
-struct AllToAllParticipantData : ParticipantData {
-  AllToAllParticipantData(const RendezvousKey& rendezvous_key_p, int rank)
-      : ParticipantData(rendezvous_key_p, rank) {}
-
-  std::vector<const void*> source_buffers;
-  std::vector<void*> destination_buffers;
-  size_t chunk_size;
-
-  std::string ToString() const override {
-    auto addr_formatter = [](std::string* out, const void* mem) {
-      absl::StrAppend(out, absl::StrFormat("%p", mem));
-    };
-    return absl::StrFormat(
-        "AllToAllParticipantData{rank=%d, "
-        "devices=[%s], source_buffers=[%s], "
-        "destination_buffers=[%s], chunk_size=%d}",
-        local_rank,
-        absl::StrJoin(rendezvous_key.global_devices, ", ", FormatGlobalId),
-        absl::StrJoin(source_buffers, ", ", addr_formatter),
-        absl::StrJoin(destination_buffers, ", ", addr_formatter), chunk_size);
-  }
-};
-
-class CpuAllToAllRendezvous
-    : public Rendezvous<AllToAllParticipantData, std::nullptr_t> {
- public:
-  explicit CpuAllToAllRendezvous(const RendezvousKey& k)
-      : Rendezvous<AllToAllParticipantData, std::nullptr_t>(k) {}
-
- protected:
-  CollectivesInterface* collectives_;
-  absl::StatusOr<std::nullptr_t> RunCollectiveOp(
-      const AllToAllParticipantData& p) override {
-    int world_size = p.rendezvous_key.global_devices.size();
-    for (int i = 0; i < world_size; ++i) {
-      std::memcpy(participants_[i]->destination_buffers[p.local_rank],
-                  p.source_buffers[i], p.chunk_size);
-    }
-    return nullptr;
+absl::Status Reduce(ReductionKind reduction_kind, PrimitiveType element_type,
+                    absl::Span<const void* const> inputs, void* output,
+                    absl::Span<void* const> copies, size_t num_elems) {
+  switch (element_type) {
+    case S8:
+      return Reduce<S8>(reduction_kind, inputs, output, copies, num_elems);
+    case PRED:
+    case U8:
+      return Reduce<U8>(reduction_kind, inputs, output, copies, num_elems);
+    case S16:
+      return Reduce<S16>(reduction_kind, inputs, output, copies, num_elems);
+    case U16:
+      return Reduce<U16>(reduction_kind, inputs, output, copies, num_elems);
+    case S32:
+      return Reduce<S32>(reduction_kind, inputs, output, copies, num_elems);
+    case U32:
+      return Reduce<U32>(reduction_kind, inputs, output, copies, num_elems);
+    case S64:
+      return Reduce<S64>(reduction_kind, inputs, output, copies, num_elems);
+    case U64:
+      return Reduce<U64>(reduction_kind, inputs, output, copies, num_elems);
+    case F16:
+      return Reduce<F16>(reduction_kind, inputs, output, copies, num_elems);
+    case F32:
+      return Reduce<F32>(reduction_kind, inputs, output, copies, num_elems);
+    case F64:
+      return Reduce<F64>(reduction_kind, inputs, output, copies, num_elems);
+    case C64:
+      return Reduce<C64>(reduction_kind, inputs, output, copies, num_elems);
+    case C128:
+      return Reduce<C128>(reduction_kind, inputs, output, copies, num_elems);
+    default:
+      return absl::UnimplementedError("Unexpected datatype");
   }
-};
-
-struct AllGatherParticipantData : ParticipantData {
-  AllGatherParticipantData(const RendezvousKey& rendezvous_key_p, int rank)
-      : ParticipantData(rendezvous_key_p, rank) {}
-
-  const void* source_buffer;
-  void* destination_buffer;
-  size_t chunk_size;
-
-  std::string ToString() const override {
-    return absl::StrFormat(
-        "AllGatherParticipantData{rank=%d, "
-        "devices=[%s], source_buffer=%p, "
-        "destination_buffer=%p, chunk_size=%d}",
-        local_rank,
-        absl::StrJoin(rendezvous_key.global_devices, ", ", FormatGlobalId),
-        source_buffer, destination_buffer, chunk_size);
-  }
-};
+}
 
-class CpuAllGatherRendezvous
-    : public Rendezvous<AllGatherParticipantData, std::nullptr_t> {
- public:
-  explicit CpuAllGatherRendezvous(const RendezvousKey& k)
-      : Rendezvous<AllGatherParticipantData, std::nullptr_t>(k) {}
-
- protected:
-  CollectivesInterface* collectives_;
-  absl::StatusOr<std::nullptr_t> RunCollectiveOp(
-      const AllGatherParticipantData& p) override {
-    int world_size = p.rendezvous_key.global_devices.size();
-    char* out = static_cast<char*>(p.destination_buffer);
-    for (int i = 0; i < world_size; ++i, out += p.chunk_size) {
-      std::memcpy(out, participants_[i]->source_buffer, p.chunk_size);
-    }
-    return nullptr;
+// Returns the inputs of a reduction at `offset` bytes, starting with the input
+// of `rank`, so that the reduction starts from the caller's own buffer, which
+// may alias its output.
+template <typename ParticipantData>
+std::vector<const void*> ReductionInputs(
+    int rank, absl::Span<const ParticipantData* const> participants,
+    size_t offset) {
+  std::vector<const void*> inputs;
+  inputs.reserve(participants.size());
+  for (size_t i = 0; i < participants.size(); ++i) {
+    const ParticipantData* p = participants[(rank + i) % participants.size()];
+    inputs.push_back(static_cast<const char*>(p->source_buffer) + offset);
   }
-};
-
-struct ReduceScatterParticipantData : ParticipantData {
-  ReduceScatterParticipantData(const RendezvousKey& rendezvous_key_p, int rank)
-      : ParticipantData(rendezvous_key_p, rank) {}
+  return inputs;
+}
 
-  ReductionKind reduction_kind;
-  PrimitiveType element_type;
-  const void* source_buffer;
-  void* destination_buffer;
-  size_t chunk_elems;
+}  // namespace
 
-  std::string ToString() const override {
-    return absl::StrFormat(
-        "ReduceScatterParticipantData{rank=%d, "
-        "devices=[%s], source_buffer=%p, "
-        "destination_buffer=%p, chunk_elems=%d}",
-        local_rank,
-        absl::StrJoin(rendezvous_key.global_devices, ", ", FormatGlobalId),
-        source_buffer, destination_buffer, chunk_elems);
-  }
+struct InProcessCollectivesState {
+  RefcountingHashMap<RendezvousKey, CollectiveState<AllReduceParticipantData>>
+      all_reduce_state_map;
+  RefcountingHashMap<RendezvousKey,
+                     CollectiveState<CollectivePermuteParticipantData>>
+      collective_permute_state_map;
+  RefcountingHashMap<RendezvousKey, CollectiveState<AllToAllParticipantData>>
+      all_to_all_state_map;
+  RefcountingHashMap<RendezvousKey, CollectiveState<AllGatherParticipantData>>
+      all_gather_state_map;
+  RefcountingHashMap<RendezvousKey,
+                     CollectiveState<ReduceScatterParticipantData>>
+      reduce_scatter_state_map;
 };
 
-class CpuReduceScatterRendezvous
-    : public Rendezvous<ReduceScatterParticipantData, std::nullptr_t> {
- public:
-  explicit CpuReduceScatterRendezvous(const RendezvousKey& k)
-      : Rendezvous<ReduceScatterParticipantData, std::nullptr_t>(k) {}
-
- protected:
-  CollectivesInterface* collectives_;
-  absl::StatusOr<std::nullptr_t> RunCollectiveOp(
-      const ReduceScatterParticipantData& me) override {
-    auto bytes_per_elem = primitive_util::ByteWidth(me.element_type);
-    int64_t chunk_offset = me.local_rank * me.chunk_elems * bytes_per_elem;
-
-    std::vector<const void*> inputs;
-    inputs.reserve(participants_.size());
-    for (const auto& p : participants_) {
-      inputs.push_back(reinterpret_cast<const char*>(p->source_buffer) +
-                       chunk_offset);
-    }
-
-    switch (me.element_type) {
-      case S8:
-        TF_RETURN_IF_ERROR(ReduceScatter<S8>(
-            me.reduction_kind, inputs, me.destination_buffer, me.chunk_elems));
-        break;
-      case PRED:
-      case U8:
-        TF_RETURN_IF_ERROR(ReduceScatter<U8>(
-            me.reduction_kind, inputs, me.destination_buffer, me.chunk_elems));
-        break;
-      case S16:
-        TF_RETURN_IF_ERROR(ReduceScatter<S16>(
-            me.reduction_kind, inputs, me.destination_buffer, me.chunk_elems));
-        break;
-      case U16:
-        TF_RETURN_IF_ERROR(ReduceScatter<U16>(
-            me.reduction_kind, inputs, me.destination_buffer, me.chunk_elems));
-        break;
-      case S32:
-        TF_RETURN_IF_ERROR(ReduceScatter<S32>(
-            me.reduction_kind, inputs, me.destination_buffer, me.chunk_elems));
-        break;
-      case U32:
-        TF_RETURN_IF_ERROR(ReduceScatter<U32>(
-            me.reduction_kind, inputs, me.destination_buffer, me.chunk_elems));
-        break;
-      case S64:
-        TF_RETURN_IF_ERROR(ReduceScatter<S64>(
-            me.reduction_kind, inputs, me.destination_buffer, me.chunk_elems));
-        break;
-      case U64:
-        TF_RETURN_IF_ERROR(ReduceScatter<U64>(
-            me.reduction_kind, inputs, me.destination_buffer, me.chunk_elems));
-        break;
-      case F16:
-        TF_RETURN_IF_ERROR(ReduceScatter<F16>(
-            me.reduction_kind, inputs, me.destination_buffer, me.chunk_elems));
-        break;
-      case F32:
-        TF_RETURN_IF_ERROR(ReduceScatter<F32>(
-            me.reduction_kind, inputs, me.destination_buffer, me.chunk_elems));
-        break;
-      case F64:
-        TF_RETURN_IF_ERROR(ReduceScatter<F64>(
-            me.reduction_kind, inputs, me.destination_buffer, me.chunk_elems));
-        break;
-      case C64:
-        TF_RETURN_IF_ERROR(ReduceScatter<C64>(
-            me.reduction_kind, inputs, me.destination_buffer, me.chunk_elems));
-        break;
-      case C128:
-        TF_RETURN_IF_ERROR(ReduceScatter<C128>(
-            me.reduction_kind, inputs, me.destination_buffer, me.chunk_elems));
-        break;
-      default:
-        return absl::UnimplementedError("Unexpected datatype");
-    }
+namespace {
 
-    return nullptr;
-  }
-};
+template <typename ParticipantData>
+std::shared_ptr<CollectiveState<ParticipantData>> GetCollectiveState(
+    RefcountingHashMap<RendezvousKey, CollectiveState<ParticipantData>>& map,
+    const RendezvousKey& key) {
+  return map.GetOrCreateIfAbsent(key, [](const RendezvousKey& k) {
+    return std::make_unique<CollectiveState<ParticipantData>>(k);
+  });
+}
 
 }  // namespace
 
-struct InProcessCollectivesState {
-  RefcountingHashMap<RendezvousKey, CpuAllReduceRendezvous>
-      all_reduce_rendezvous_map;
-  RefcountingHashMap<RendezvousKey, CpuCollectivePermuteRendezvous>
-      collective_permute_rendezvous_map;
-  RefcountingHashMap<RendezvousKey, CpuAllToAllRendezvous>
-      all_to_all_rendezvous_map;
-  RefcountingHashMap<RendezvousKey, CpuAllGatherRendezvous>
-      all_gather_rendezvous_map;
-  RefcountingHashMap<RendezvousKey, CpuReduceScatterRendezvous>
-      reduce_scatter_rendezvous_map;
-};
-
 InProcessCollectivesCommunicator::InProcessCollectivesCommunicator(
     InProcessCollectivesState* state, int rank, int size)
     : state_(state), rank_(rank) {}
@@ -526,114 +419,121 @@ absl::Status InProcessCollectivesCommunicator::AllReduce(
     PrimitiveType element_type, size_t num_elements,
     const void* const input_buffer, void* const output_buffer,
     absl::Duration timeout) {
-  AllReduceParticipantData participant(key, rank_);
-  participant.element_count = num_elements;
-  participant.primitive_type = element_type;
-  participant.source_data = input_buffer;
-  participant.destination_data = output_buffer;
-  participant.reduction_kind = reduction_kind;
-
-  auto make_cpu_rendezvous = [](const RendezvousKey& k) {
-    return std::make_unique<CpuAllReduceRendezvous>(k);
-  };
-
-  return CpuAllReduceRendezvous::SubmitParticipant(
-             [&] {
-               return state_->all_reduce_rendezvous_map.GetOrCreateIfAbsent(
-                   key, make_cpu_rendezvous);
-             },
-             participant)
-      .status();
+  AllReduceParticipantData participant{reduction_kind, element_type,
+                                       num_elements, input_buffer,
+                                       output_buffer};
+  auto state = GetCollectiveState(state_->all_reduce_state_map, key);
+  return state->Run(
+      rank_, participant, timeout,
+      [&](absl::Span<const AllReduceParticipantData* const> participants) {
+        // Reduce-scatter, then all-gather: rank r reduces the r-th chunk of
+        // the inputs and copies the result to the outputs of all the
+        // participants.
+        int64_t world_size = participants.size();
+        int64_t chunk_elems = CeilOfRatio<int64_t>(num_elements, world_size);
+        int64_t start_elem = rank_ * chunk_elems;
+        int64_t end_elem =
+            std::min<int64_t>(start_elem + chunk_elems, num_elements);
+        if (start_elem >= end_elem) {
+          return absl::OkStatus();
+        }
+
+        size_t chunk_offset =
+            start_elem * primitive_util::ByteWidth(element_type);
+        std::vector<const void*> inputs =
+            ReductionInputs(rank_, participants, chunk_offset);
+        std::vector<void*> copies;
+        copies.reserve(world_size - 1);
+        for (int64_t i = 0; i < world_size; ++i) {
+          if (i != rank_) {
+            copies.push_back(
+                static_cast<char*>(participants[i]->destination_buffer) +
+                chunk_offset);
+          }
+        }
+        return Reduce(reduction_kind, element_type, inputs,
+                      static_cast<char*>(output_buffer) + chunk_offset, copies,
+                      end_elem - start_elem);
+      });
 }
 
 absl::Status InProcessCollectivesCommunicator::CollectivePermute(
     const RendezvousKey& key, size_t num_bytes, std::optional<int> source_rank,
     absl::Span<int const> target_ranks, const void* input_buffer,
     void* output_buffer, absl::Duration timeout) {
-  CollectivePermuteParticipantData participant(key, rank_);
-  participant.source_buffer = input_buffer;
-  participant.destination_buffer = output_buffer;
-  participant.num_bytes = num_bytes;
-  participant.source_rank = source_rank;
-  auto make_cpu_rendezvous = [](const RendezvousKey& k) {
-    return std::make_unique<CpuCollectivePermuteRendezvous>(k);
-  };
-  return CpuCollectivePermuteRendezvous::SubmitParticipant(
-             [&] {
-               return state_->collective_permute_rendezvous_map
-                   .GetOrCreateIfAbsent(key, make_cpu_rendezvous);
-             },
-             participant)
-      .status();
+  CollectivePermuteParticipantData participant{num_bytes, input_buffer,
+                                               output_buffer, source_rank};
+  auto state = GetCollectiveState(state_->collective_permute_state_map, key);
+  return state->Run(
+      rank_, participant, timeout,
+      [&](absl::Span<const CollectivePermuteParticipantData* const>
+              participants) {
+        if (source_rank) {
+          std::memcpy(output_buffer,
+                      participants[*source_rank]->source_buffer, num_bytes);
+        } else {
+          std::memset(output_buffer, 0, num_bytes);
+        }
+        return absl::OkStatus();
+      });
 }
 
 absl::Status InProcessCollectivesCommunicator::AllToAll(
     const RendezvousKey& key, size_t chunk_bytes,
     absl::Span<const void* const> input_buffers,
     absl::Span<void* const> output_buffers, absl::Duration timeout) {
-  AllToAllParticipantData participant(key, rank_);
   TF_RET_CHECK(input_buffers.size() == output_buffers.size());
-  participant.chunk_size = chunk_bytes;
-  participant.source_buffers.reserve(input_buffers.size());
-  participant.destination_buffers.reserve(output_buffers.size());
-  for (const void* input_buffer : input_buffers) {
-    participant.source_buffers.push_back(input_buffer);
-  }
-  for (void* output_buffer : output_buffers) {
-    participant.destination_buffers.push_back(output_buffer);
-  }
-  auto make_cpu_rendezvous = [](const RendezvousKey& k) {
-    return std::make_unique<CpuAllToAllRendezvous>(k);
-  };
-  return CpuAllToAllRendezvous::SubmitParticipant(
-             [&] {
-               return state_->all_to_all_rendezvous_map.GetOrCreateIfAbsent(
-                   key, make_cpu_rendezvous);
-             },
-             participant)
-      .status();
+  AllToAllParticipantData participant{chunk_bytes, input_buffers,
+                                      output_buffers};
+  auto state = GetCollectiveState(state_->all_to_all_state_map, key);
+  return state->Run(
+      rank_, participant, timeout,
+      [&](absl::Span<const AllToAllParticipantData* const> participants) {
+        for (size_t i = 0; i < participants.size(); ++i) {
+          std::memcpy(participants[i]->destination_buffers[rank_],
+                      input_buffers[i], chunk_bytes);
+        }
+        return absl::OkStatus();
+      });
 }
 
 absl::Status InProcessCollectivesCommunicator::AllGather(
     const RendezvousKey& key, size_t chunk_bytes, const void* input_buffer,
     void* output_buffer, absl::Duration timeout) {
-  AllGatherParticipantData participant(key, rank_);
-  participant.chunk_size = chunk_bytes;
-  participant.source_buffer = input_buffer;
-  participant.destination_buffer = output_buffer;
-  auto make_cpu_rendezvous = [](const RendezvousKey& k) {
-    return std::make_unique<CpuAllGatherRendezvous>(k);
-  };
-  return CpuAllGatherRendezvous::SubmitParticipant(
-             [&] {
-               return state_->all_gather_rendezvous_map.GetOrCreateIfAbsent(
-                   key, make_cpu_rendezvous);
-             },
-             participant)
-      .status();
+  AllGatherParticipantData participant{chunk_bytes, input_buffer,
+                                       output_buffer};
+  auto state = GetCollectiveState(state_->all_gather_state_map, key);
+  return state->Run(
+      rank_, participant, timeout,
+      [&](absl::Span<const AllGatherParticipantData* const> participants) {
+        char* out = static_cast<char*>(output_buffer);
+        for (size_t i = 0; i < participants.size(); ++i, out += chunk_bytes) {
+          std::memcpy(out, participants[i]->source_buffer, chunk_bytes);
+        }
+        return absl::OkStatus();
+      });
 }
 
 absl::Status InProcessCollectivesCommunicator::ReduceScatter(
     const RendezvousKey& key, ReductionKind reduction_kind,
     PrimitiveType element_type, size_t chunk_elems, const void* input_buffer,
     void* output_buffer, absl::Duration timeout) {
-  ReduceScatterParticipantData participant(key, rank_);
-  participant.element_type = element_type;
-  participant.reduction_kind = reduction_kind;
-  participant.chunk_elems = chunk_elems;
-  participant.source_buffer = input_buffer;
-  participant.destination_buffer = output_buffer;
-  auto make_cpu_rendezvous = [](const RendezvousKey& k) {
-    return std::make_unique<CpuReduceScatterRendezvous>(k);
-  };
-  return CpuReduceScatterRendezvous::SubmitParticipant(
-             [&] {
-               return state_->reduce_scatter_rendezvous_map.GetOrCreateIfAbsent(
-                   key, make_cpu_rendezvous);
-             },
-             participant)
-      .status();
+  ReduceScatterParticipantData participant{reduction_kind, element_type,
+                                           chunk_elems, input_buffer,
+                                           output_buffer};
+  auto state = GetCollectiveState(state_->reduce_scatter_state_map, key);
+  return state->Run(
+      rank_, participant, timeout,
+      [&](absl::Span<const ReduceScatterParticipantData* const> participants) {
+        size_t chunk_offset =
+            rank_ * chunk_elems * primitive_util::ByteWidth(element_type);
+        std::vector<const void*> inputs =
+            ReductionInputs(rank_, participants, chunk_offset);
+        return Reduce(reduction_kind, element_type, inputs, output_buffer,
+                      /*copies=*/{}, chunk_elems);
+      });
 }
+
 InProcessCollectives::InProcessCollectives()
     : state_(std::make_unique<InProcessCollectivesState>()) {}
 InProcessCollectives::~InProcessCollectives() = default;
@@ -641,7 +541,7 @@ InProcessCollectives::~InProcessCollectives() = default;
 absl::StatusOr<std::shared_ptr<CollectivesCommunicator>>
 InProcessCollectives::GetCommunicator(absl::Span<GlobalDeviceId const> devices,
                                       int rank) {
-  // We don't care about devices here: we share rendezvous state globally.
+  // We don't care about devices here: we share collective state globally.
   return std::make_shared<InProcessCollectivesCommunicator>(state_.get(), rank,
                                                             devices.size());
 }
@@ -0,0 +1,203 @@
+/* Copyright 2024 The OpenXLA Authors.
+
+Licensed under the Apache License, Version 2.0 (the "License");
+you may not use this file except in compliance with the License.
+You may obtain a copy of the License at
+
+    http://www.apache.org/licenses/LICENSE-2.0
+
+Unless required by applicable law or agreed to in writing, software
+distributed under the License is distributed on an "AS IS" BASIS,
+WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+See the License for the specific language governing permissions and
+limitations under the License.
+==============================================================================*/
+
+#include "xla/service/cpu/in_process_collectives.h"
+
+#include <cstddef>
+#include <cstdint>
+#include <memory>
+#include <vector>
+
+#include "absl/functional/function_ref.h"
+#include "absl/status/status.h"
+#include "absl/time/time.h"
+#include "xla/executable_run_options.h"
+#include "xla/service/collective_ops_utils.h"
+#include "xla/service/cpu/collectives_interface.h"
+#include "xla/service/global_device_id.h"
+#include "xla/xla_data.pb.h"
+#include "tsl/lib/core/status_test_util.h"
+#include "tsl/platform/env.h"
+#include "tsl/platform/test.h"
+#include "tsl/platform/threadpool.h"
+
+namespace xla::cpu::runtime {
+namespace {
+
+using ::testing::Each;
+using ::testing::ElementsAreArray;
+using ::testing::Eq;
+
+constexpr int kNumParticipants = 3;
+constexpr absl::Duration kTimeout = absl::Seconds(30);
+
+std::vector<GlobalDeviceId> GlobalDevices(int num_participants) {
+  std::vector<GlobalDeviceId> global_devices;
+  global_devices.reserve(num_participants);
+  for (int rank = 0; rank < num_participants; ++rank) {
+    global_devices.push_back(GlobalDeviceId(rank));
+  }
+  return global_devices;
+}
+
+RendezvousKey MakeRendezvousKey(int num_participants, int64_t op_id = 0) {
+  return RendezvousKey(RunId(0), GlobalDevices(num_participants),
+                       num_participants,
+                       RendezvousKey::CollectiveOpKind::kCrossModule, op_id);
+}
+
+// Runs `fn` for each rank in a separate thread, with the rank's communicator.
+void RunParticipants(
+    int num_participants,
+    absl::FunctionRef<void(int rank, CollectivesCommunicator& communicator)>
+        fn) {
+  InProcessCollectives collectives;
+  std::vector<GlobalDeviceId> global_devices = GlobalDevices(num_participants);
+  tsl::thread::ThreadPool thread_pool(tsl::Env::Default(), "Participants",
+                                      num_participants);
+  for (int rank = 0; rank < num_participants; ++rank) {
+    thread_pool.Schedule([&, rank]() {
+      std::shared_ptr<CollectivesCommunicator> communicator =
+          collectives.GetCommunicator(global_devices, rank).value();
+      fn(rank, *communicator);
+    });
+  }
+}
+
+TEST(InProcessCollectivesTest, AllReduce) {
+  // Not a multiple of the number of participants or of the reduction tile.
+  constexpr size_t kNumElements = 10007;
+  std::vector<std::vector<float>> outputs(kNumParticipants);
+  RunParticipants(kNumParticipants, [&](int rank,
+                                        CollectivesCommunicator& communicator) {
+    std::vector<float> input(kNumElements, rank + 1);
+    outputs[rank].resize(kNumElements);
+    TF_EXPECT_OK(communicator.AllReduce(
+        MakeRendezvousKey(kNumParticipants), ReductionKind::SUM, F32,
+        kNumElements, input.data(), outputs[rank].data(), kTimeout));
+  });
+  for (int rank = 0; rank < kNumParticipants; ++rank) {
+    EXPECT_THAT(outputs[rank],
+                Each(Eq(kNumParticipants * (kNumParticipants + 1) / 2)));
+  }
+}
+
+TEST(InProcessCollectivesTest, AllReduceInPlaceRepeatedly) {
+  // Runs the same collective operation repeatedly, as in a loop, so that the
+  // participants reuse the collective state.
+  constexpr size_t kNumElements = 100;
+  constexpr int kNumIterations = 100;
+  std::vector<std::vector<int32_t>> buffers(kNumParticipants);
+  RunParticipants(kNumParticipants, [&](int rank,
+                                        CollectivesCommunicator& communicator) {
+    buffers[rank].assign(kNumElements, rank);
+    for (int i = 0; i < kNumIterations; ++i) {
+      TF_EXPECT_OK(communicator.AllReduce(
+          MakeRendezvousKey(kNumParticipants), ReductionKind::MAX, S32,
+          kNumElements, buffers[rank].data(), buffers[rank].data(), kTimeout));
+      buffers[rank][0] += rank;
+    }
+  });
+  for (int rank = 0; rank < kNumParticipants; ++rank) {
+    EXPECT_EQ(buffers[rank][0],
+              (kNumParticipants - 1) * kNumIterations + rank);
+    for (size_t i = 1; i < kNumElements; ++i) {
+      EXPECT_EQ(buffers[rank][i], kNumParticipants - 1);
+    }
+  }
+}
+
+TEST(InProcessCollectivesTest, ReduceScatter) {
+  constexpr size_t kChunkElems = 5;
+  std::vector<std::vector<double>> outputs(kNumParticipants);
+  RunParticipants(kNumParticipants, [&](int rank,
+                                        CollectivesCommunicator& communicator) {
+    std::vector<double> input(kChunkElems * kNumParticipants);
+    for (size_t i = 0; i < input.size(); ++i) {
+      input[i] = rank + i;
+    }
+    outputs[rank].resize(kChunkElems);
+    TF_EXPECT_OK(communicator.ReduceScatter(
+        MakeRendezvousKey(kNumParticipants), ReductionKind::SUM, F64,
+        kChunkElems, input.data(), outputs[rank].data(), kTimeout));
+  });
+  for (int rank = 0; rank < kNumParticipants; ++rank) {
+    std::vector<double> expected(kChunkElems);
+    for (size_t i = 0; i < kChunkElems; ++i) {
+      for (int other = 0; other < kNumParticipants; ++other) {
+        expected[i] += other + rank * kChunkElems + i;
+      }
+    }
+    EXPECT_THAT(outputs[rank], ElementsAreArray(expected));
+  }
+}
+
+TEST(InProcessCollectivesTest, AllGather) {
+  std::vector<std::vector<int32_t>> outputs(kNumParticipants);
+  RunParticipants(kNumParticipants, [&](int rank,
+                                        CollectivesCommunicator& communicator) {
+    int32_t input = rank;
+    outputs[rank].resize(kNumParticipants);
+    TF_EXPECT_OK(communicator.AllGather(MakeRendezvousKey(kNumParticipants),
+                                        sizeof(int32_t), &input,
+                                        outputs[rank].data(), kTimeout));
+  });
+  for (int rank = 0; rank < kNumParticipants; ++rank) {
+    EXPECT_THAT(outputs[rank], ElementsAreArray({0, 1, 2}));
+  }
+}
+
+TEST(InProcessCollectivesTest, Timeout) {
+  InProcessCollectives collectives;
+  std::shared_ptr<CollectivesCommunicator> communicator =
+      collectives.GetCommunicator(GlobalDevices(2), /*rank=*/0).value();
+  float buffer = 0;
+  EXPECT_EQ(communicator
+                ->AllReduce(MakeRendezvousKey(2), ReductionKind::SUM, F32,
+                            /*num_elements=*/1, &buffer, &buffer,
+                            absl::Milliseconds(10))
+                .code(),
+            absl::StatusCode::kDeadlineExceeded);
+}
+
+TEST(InProcessCollectivesTest, TimeoutFailsWaitingParticipants) {
+  // Rank 2 never arrives. Once rank 0 times out, rank 1 fails too instead of
+  // waiting for its own, much longer, timeout.
+  InProcessCollectives collectives;
+  std::vector<GlobalDeviceId> global_devices = GlobalDevices(kNumParticipants);
+  std::vector<absl::StatusCode> codes(2);
+  {
+    tsl::thread::ThreadPool thread_pool(tsl::Env::Default(), "Participants",
+                                        2);
+    for (int rank = 0; rank < 2; ++rank) {
+      thread_pool.Schedule([&, rank]() {
+        std::shared_ptr<CollectivesCommunicator> communicator =
+            collectives.GetCommunicator(global_devices, rank).value();
+        float buffer = 0;
+        codes[rank] =
+            communicator
+                ->AllReduce(MakeRendezvousKey(kNumParticipants),
+                            ReductionKind::SUM, F32, /*num_elements=*/1,
+                            &buffer, &buffer,
+                            rank == 0 ? absl::Milliseconds(10) : kTimeout)
+                .code();
+      });
+    }
+  }
+  EXPECT_THAT(codes, Each(Eq(absl::StatusCode::kDeadlineExceeded)));
+}
+
+}  // namespace
+}  // namespace xla::cpu::runtime
@@ -2506,7 +2506,8 @@ Status IrEmitter::HandleTopK(HloInstruction* hlo) {
   llvm::Value* out_indices_ptr =
       EmitBufferPointer(out_indices_slice, hlo->shape().tuple_shapes(1));
   EmitCallToFunc(runtime::kTopKF32SymbolName,
-                 {b_.getInt64(has_batch ? input->shape().dimensions(0) : 1),
+                 {GetExecutableRunOptionsArgument(),
+                  b_.getInt64(has_batch ? input->shape().dimensions(0) : 1),
                   b_.getInt64(input->shape().dimensions().back()),
                   b_.getInt64(k), values_ptr, out_values_ptr, out_indices_ptr},
                  b_.getVoidTy());
@@ -26,6 +26,8 @@ limitations under the License.
 #include "absl/container/flat_hash_set.h"
 #include "absl/strings/str_cat.h"
 #include "absl/strings/string_view.h"
+#include "absl/time/clock.h"
+#include "absl/time/time.h"
 #include "xla/hlo/ir/hlo_computation.h"
 #include "xla/hlo/ir/hlo_instruction.h"
 #include "xla/hlo/ir/hlo_opcode.h"
@@ -38,12 +40,47 @@ limitations under the License.
 #include "xla/status.h"
 #include "xla/statusor.h"
 #include "xla/util.h"
+#include "xla/xla.pb.h"
 #include "tsl/platform/cpu_info.h"
 #include "tsl/platform/logging.h"  // IWYU pragma: keep
 #include "tsl/platform/status.h"
 
 namespace xla {
 namespace cpu {
+namespace {
+
+// The cost, in the units of DefaultCostModel, of one element of the loop timed
+// by MeasuredCostUnitsPerSecond: two flops and twelve bytes accessed.
+constexpr int64_t kCalibrationCostPerElement = 2 + 10 * 12;
+
+// Returns how many units of DefaultCostModel cost a core of the host runs per
+// second, measured once per process by timing a simple elementwise loop.
+double MeasuredCostUnitsPerSecond() {
+  static const double cost_units_per_second = [] {
+    constexpr int64_t kNumElements = 1 << 14;
+    constexpr int kNumRepetitions = 64;
+    std::vector<float> x(kNumElements, 1.0f);
+    std::vector<float> y(kNumElements, 0.0f);
+    const absl::Time start = absl::Now();
+    for (int r = 0; r < kNumRepetitions; ++r) {
+      for (int64_t i = 0; i < kNumElements; ++i) {
+        y[i] = 0.5f * y[i] + x[i];
+      }
+    }
+    const double seconds =
+        std::max(absl::ToDoubleSeconds(absl::Now() - start), 1e-9);
+    // Keep the loop from being optimized away.
+    volatile float sink = y[kNumElements - 1];
+    (void)sink;
+    const double result =
+        kCalibrationCostPerElement * kNumElements * kNumRepetitions / seconds;
+    VLOG(1) << "Measured " << result << " cost units per second";
+    return result;
+  }();
+  return cost_units_per_second;
+}
+
+}  // namespace
 
 class SimpleCostModel : public ParallelCostModel {
  public:
@@ -69,12 +106,16 @@ class SimpleCostModel : public ParallelCostModel {
 
 class DefaultCostModel : public ParallelCostModel {
  public:
+  // 'min_compute_cost_per_thread': the minimum cost of the work per thread
+  //                                 for compute bound instructions.
   DefaultCostModel(const int64_t max_parallelism,
                    const HloCostAnalysis::ShapeSizeFunction& shape_size,
-                   std::unique_ptr<HloCostAnalysis> cost_analysis)
+                   std::unique_ptr<HloCostAnalysis> cost_analysis,
+                   const int64_t min_compute_cost_per_thread)
       : max_parallelism_(max_parallelism),
         shape_size_(shape_size),
-        cost_analysis_(std::move(cost_analysis)) {}
+        cost_analysis_(std::move(cost_analysis)),
+        min_compute_cost_per_thread_(min_compute_cost_per_thread) {}
   ~DefaultCostModel() override {}
 
   int64_t GetParallelTaskCount(HloInstruction* instruction) override {
@@ -109,8 +150,7 @@ class DefaultCostModel : public ParallelCostModel {
           1 * cost_analysis_->flop_count(*instruction) +
           2 * cost_analysis_->transcendental_count(*instruction) +
           10 * cost_analysis_->bytes_accessed(*instruction);
-      // Minimum per-thread cost is 100us of work on a 2GHz core.
-      min_cost_per_thread = 100000;
+      min_cost_per_thread = min_compute_cost_per_thread_;
     }
     // Return target parallel task count in [1, max_parallelism_].
     return std::min(
@@ -122,6 +162,7 @@ class DefaultCostModel : public ParallelCostModel {
   const int64_t max_parallelism_;
   const HloCostAnalysis::ShapeSizeFunction shape_size_;
   const std::unique_ptr<HloCostAnalysis> cost_analysis_;
+  const int64_t min_compute_cost_per_thread_;
 };
 
 ParallelTaskAssignment::ParallelTaskAssignment(
@@ -130,6 +171,16 @@ ParallelTaskAssignment::ParallelTaskAssignment(
     const TargetMachineFeatures* target_machine_features)
     : target_machine_features_(*target_machine_features) {
   VLOG(1) << "ParallelTaskAssignment max_parallelism: " << max_parallelism;
+  const DebugOptions& debug_options = module->config().debug_options();
+  oversubscription_ = std::max<int64_t>(
+      1, debug_options.xla_cpu_parallel_task_oversubscription());
+  // Minimum per-thread cost of compute bound instructions is 100us of work on
+  // a 2GHz core, unless the throughput of the host is measured.
+  int64_t min_compute_cost_per_thread = 100000;
+  if (debug_options.xla_cpu_parallel_task_measure_throughput()) {
+    min_compute_cost_per_thread = std::max<int64_t>(
+        1, static_cast<int64_t>(100e-6 * MeasuredCostUnitsPerSecond()));
+  }
   // Run cost analysis on 'module'.
   auto cost_analysis = std::make_unique<HloCostAnalysis>(shape_size);
   HloComputation* computation = module->entry_computation();
@@ -137,7 +188,8 @@ ParallelTaskAssignment::ParallelTaskAssignment(
   if (status.ok()) {
     // Set default cost model based on 'cost_analysis'.
     cost_model_ = std::make_unique<DefaultCostModel>(
-        max_parallelism, shape_size, std::move(cost_analysis));
+        max_parallelism, shape_size, std::move(cost_analysis),
+        min_compute_cost_per_thread);
   } else {
     // Fall back to a simple cost model based on hlo size and L2 cache size.
     // Note that HloCostAnalysis can returns an error status (likely because
@@ -181,8 +233,12 @@ int64_t ParallelTaskAssignment::GetTargetParallelTaskCount(
       (opcode == HloOpcode::kConvolution &&
        !PotentiallyImplementedAsEigenConvolution(*instruction,
                                                  target_machine_features_))) {
-    // Consult 'cost_model_' to compute target parallel task count.
-    return cost_model_->GetParallelTaskCount(instruction);
+    // Consult 'cost_model_' to compute target parallel task count, and
+    // oversubscribe the threads if the instruction is parallelized at all.
+    const int64_t parallel_task_count =
+        cost_model_->GetParallelTaskCount(instruction);
+    return parallel_task_count > 1 ? parallel_task_count * oversubscription_
+                                   : parallel_task_count;
   }
 
   return 1;
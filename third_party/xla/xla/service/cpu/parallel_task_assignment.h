@@ -59,6 +59,9 @@ class ParallelTaskAssignment {
 
  private:
   std::unique_ptr<ParallelCostModel> cost_model_;
+  // The number of partitions per thread that the cost model asks for, from
+  // 'xla_cpu_parallel_task_oversubscription'.
+  int64_t oversubscription_ = 1;
   const TargetMachineFeatures& target_machine_features_;
 };
 
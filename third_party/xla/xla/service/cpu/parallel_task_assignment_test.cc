@@ -206,5 +206,43 @@ TEST_F(ParallelTaskAssignmentTest, ConstantNotParallelized) {
   EXPECT_FALSE(changed);
 }
 
+TEST_F(ParallelTaskAssignmentTest, ParallelizedInstructionIsOversubscribed) {
+  constexpr char hlo_string[] = R"(
+  HloModule TestTaskParallel_oversubscription
+    add {
+      lhs = f32[] parameter(0)
+      rhs = f32[] parameter(1)
+      ROOT add = f32[] add(lhs, rhs)
+    }
+
+    ENTRY ReduceWindow {
+      input = f32[1024,1024] parameter(0)
+      zero = f32[] constant(0)
+      ROOT reduce-window = f32[993,993] reduce-window(input, zero),
+        window={size=32x32}, to_apply=add
+    }
+  )";
+
+  TF_ASSERT_OK_AND_ASSIGN(std::unique_ptr<HloModule> m,
+                          ParseAndReturnVerifiedModule(hlo_string));
+  HloInstruction* reduce_window = m->entry_computation()->root_instruction();
+  DebugOptions debug_options = m->config().debug_options();
+
+  debug_options.set_xla_cpu_parallel_task_oversubscription(1);
+  m->mutable_config().set_debug_options(debug_options);
+  const int64_t parallel_task_count =
+      cpu::ParallelTaskAssignment(max_parallelism_, shape_size_func_, m.get(),
+                                  &target_machine_features_)
+          .GetTargetParallelTaskCount(reduce_window);
+  EXPECT_EQ(parallel_task_count, max_parallelism_);
+
+  debug_options.set_xla_cpu_parallel_task_oversubscription(3);
+  m->mutable_config().set_debug_options(debug_options);
+  EXPECT_EQ(cpu::ParallelTaskAssignment(max_parallelism_, shape_size_func_,
+                                        m.get(), &target_machine_features_)
+                .GetTargetParallelTaskCount(reduce_window),
+            3 * parallel_task_count);
+}
+
 }  // namespace
 }  // namespace xla
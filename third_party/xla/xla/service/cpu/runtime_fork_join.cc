@@ -17,6 +17,11 @@ limitations under the License.
 
 #define EIGEN_USE_THREADS
 
+#include <algorithm>
+#include <atomic>
+#include <memory>
+#include <vector>
+
 #include "absl/base/dynamic_annotations.h"
 #include "absl/strings/str_format.h"
 #include "absl/strings/str_join.h"
@@ -29,9 +34,32 @@ limitations under the License.
 using ComputeFunctionType = void (*)(void*, const void*, const void**, void**,
                                      void*, int64_t*, uint64_t*);
 
-// Dispatches 'num_partitions - 1' calls to 'function_ptr' in parallel.
-// Calls 'function_ptr' for first partition inline.
-// Uses blocking counter to synchronize threads after parallel calls complete.
+namespace {
+
+// The state of a fork-join that is shared by the threads running it. It is
+// reference counted because a pool thread may only start after all the
+// partitions are done and the fork-join has returned.
+struct ForkJoinState {
+  explicit ForkJoinState(int32_t num_partitions)
+      : statuses(num_partitions), num_pending_partitions(num_partitions) {}
+
+  // The index of the next partition to be claimed by a thread.
+  std::atomic<int32_t> next_partition{0};
+  std::vector<XlaCustomCallStatus> statuses;
+  tsl::BlockingCounter num_pending_partitions;
+};
+
+}  // namespace
+
+// Calls 'function_ptr' for each of the 'num_partitions' partitions, in
+// parallel on the intra-op thread pool and on the calling thread, and returns
+// when all the partitions are done.
+//
+// Partitions are not assigned to threads up front: each thread repeatedly
+// claims the next partition that has not been claimed yet. When the
+// partitions outnumber the threads, a thread that is slowed down, e.g. by
+// another process running on its core, runs fewer partitions instead of
+// delaying the whole fork-join.
 //
 // The 'partitions' array has a total number of elements equal to
 // 'num_partitions * num_partitioned_dims * 2' (the '2' is necessary to specify
@@ -79,27 +107,38 @@ ABSL_ATTRIBUTE_NO_SANITIZE_MEMORY void __xla_cpu_runtime_ParallelForkJoin(
   // Compute partition stride in 'partitions' array.
   const int64_t stride = 2 * num_partitioned_dims;
 
-  std::vector<XlaCustomCallStatus> statuses(num_partitions);
-
-  // Dispatch 'num_partitions - 1' compute functions to run in parallel.
-  tsl::BlockingCounter bc(num_partitions - 1);
-  for (int32_t i = 1; i < num_partitions; ++i) {
-    const int64_t offset = i * stride;
-    run_options->intra_op_thread_pool()->enqueueNoNotification(
-        [i, function, result_ptr, run_options_ptr, buffer_table, prof_counters,
-         partitions, offset, &bc, &statuses]() {
-          function(result_ptr, run_options_ptr, nullptr, buffer_table,
-                   &statuses[i], &partitions[offset], prof_counters);
-          bc.DecrementCount();
-          VLOG(3) << "ParallelForkJoin partition " << i << " done.";
-        });
+  auto state = std::make_shared<ForkJoinState>(num_partitions);
+
+  // Runs partitions until all of them have been claimed. Only the state is
+  // touched once the last partition is claimed, as the other captured pointers
+  // may be dangling by then.
+  auto run_partitions = [function, result_ptr, run_options_ptr, buffer_table,
+                         prof_counters, partitions, stride,
+                         num_partitions](ForkJoinState& fork_join) {
+    for (int32_t i = fork_join.next_partition.fetch_add(1); i < num_partitions;
+         i = fork_join.next_partition.fetch_add(1)) {
+      function(result_ptr, run_options_ptr, nullptr, buffer_table,
+               &fork_join.statuses[i], &partitions[i * stride], prof_counters);
+      VLOG(3) << "ParallelForkJoin partition " << i << " done.";
+      fork_join.num_pending_partitions.DecrementCount();
+    }
+  };
+
+  // Dispatch one runner per pool thread, up to one per extra partition.
+  const Eigen::ThreadPoolDevice* thread_pool =
+      run_options->intra_op_thread_pool();
+  const int32_t num_runners =
+      std::min<int32_t>(num_partitions - 1, thread_pool->numThreads());
+  for (int32_t i = 0; i < num_runners; ++i) {
+    thread_pool->enqueueNoNotification(
+        [run_partitions, state]() { run_partitions(*state); });
   }
 
-  // Call first compute function inline.
-  function(result_ptr, run_options_ptr, params, buffer_table, statuses.data(),
-           partitions, prof_counters);
-  VLOG(3) << "ParallelForkJoin partition 0 done.";
-  bc.Wait();
+  // The calling thread runs partitions too, then waits for the partitions
+  // claimed by pool threads, but not for pool threads that did not start.
+  run_partitions(*state);
+  state->num_pending_partitions.Wait();
+  std::vector<XlaCustomCallStatus>& statuses = state->statuses;
 
   // Collect all error messages (if any).
   std::vector<std::pair<int32_t, absl::string_view>> error_messages;
@@ -0,0 +1,112 @@
+/* Copyright 2024 The OpenXLA Authors.
+
+Licensed under the Apache License, Version 2.0 (the "License");
+you may not use this file except in compliance with the License.
+You may obtain a copy of the License at
+
+    http://www.apache.org/licenses/LICENSE-2.0
+
+Unless required by applicable law or agreed to in writing, software
+distributed under the License is distributed on an "AS IS" BASIS,
+WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+See the License for the specific language governing permissions and
+limitations under the License.
+==============================================================================*/
+
+#define EIGEN_USE_THREADS
+#include "xla/service/cpu/runtime_fork_join.h"
+
+#include <atomic>
+#include <cstdint>
+#include <cstring>
+#include <optional>
+#include <vector>
+
+#include "absl/strings/string_view.h"
+#include "unsupported/Eigen/CXX11/Tensor"  // from @eigen_archive
+#include "xla/executable_run_options.h"
+#include "xla/service/custom_call_status.h"
+#include "xla/service/custom_call_status_internal.h"
+#include "tsl/platform/env.h"
+#include "tsl/platform/test.h"
+#include "tsl/platform/threadpool.h"
+
+namespace xla {
+namespace {
+
+// A compute function that counts the runs of each partition of a single
+// dimension in the vector of counters in 'buffer_table[0]', and fails the
+// partitions that start at 13.
+void CountPartition(void* result, const void* run_options,
+                    const void** params, void** buffer_table, void* status,
+                    int64_t* partition, uint64_t* prof_counters) {
+  auto* counters =
+      static_cast<std::vector<std::atomic<int>>*>(buffer_table[0]);
+  (*counters)[partition[0]].fetch_add(1);
+  if (partition[0] == 13) {
+    constexpr absl::string_view kMessage = "unlucky partition";
+    XlaCustomCallStatusSetFailure(static_cast<XlaCustomCallStatus*>(status),
+                                  kMessage.data(), kMessage.size());
+  }
+}
+
+class RuntimeForkJoinTest : public ::testing::Test {
+ protected:
+  RuntimeForkJoinTest()
+      : thread_pool_(tsl::Env::Default(), "fork_join_test", 4),
+        device_(thread_pool_.AsEigenThreadPool(), 4) {
+    run_options_.set_intra_op_thread_pool(&device_);
+  }
+
+  // Runs a fork-join of 'num_partitions' partitions [i, i + 1) and returns the
+  // number of runs of each partition, and the error message in 'message'.
+  std::vector<int> ForkJoin(int32_t num_partitions,
+                            std::optional<absl::string_view>* message) {
+    std::vector<std::atomic<int>> counters(num_partitions);
+    std::vector<int64_t> partitions;
+    for (int64_t i = 0; i < num_partitions; ++i) {
+      partitions.push_back(i);
+      partitions.push_back(i + 1);
+    }
+    void* buffer_table[] = {&counters};
+    __xla_cpu_runtime_ParallelForkJoin(
+        /*result_ptr=*/nullptr, &run_options_, /*params=*/nullptr,
+        buffer_table, &status_, /*prof_counters=*/nullptr, num_partitions,
+        partitions.data(), /*num_partitioned_dims=*/1,
+        reinterpret_cast<void*>(&CountPartition));
+    *message = CustomCallStatusGetMessage(&status_);
+    std::vector<int> num_runs;
+    for (const std::atomic<int>& counter : counters) {
+      num_runs.push_back(counter.load());
+    }
+    return num_runs;
+  }
+
+  tsl::thread::ThreadPool thread_pool_;
+  Eigen::ThreadPoolDevice device_;
+  ExecutableRunOptions run_options_;
+  XlaCustomCallStatus status_;
+};
+
+TEST_F(RuntimeForkJoinTest, RunsEachPartitionOnce) {
+  std::optional<absl::string_view> message;
+  std::vector<int> num_runs = ForkJoin(/*num_partitions=*/3, &message);
+  EXPECT_EQ(num_runs, std::vector<int>(3, 1));
+  EXPECT_FALSE(message.has_value());
+
+  // Many more partitions than threads, so that threads claim several each.
+  num_runs = ForkJoin(/*num_partitions=*/12, &message);
+  EXPECT_EQ(num_runs, std::vector<int>(12, 1));
+  EXPECT_FALSE(message.has_value());
+}
+
+TEST_F(RuntimeForkJoinTest, ReportsFailedPartitions) {
+  std::optional<absl::string_view> message;
+  std::vector<int> num_runs = ForkJoin(/*num_partitions=*/100, &message);
+  EXPECT_EQ(num_runs, std::vector<int>(100, 1));
+  ASSERT_TRUE(message.has_value());
+  EXPECT_EQ(*message, "Partition 13 error: unlucky partition");
+}
+
+}  // namespace
+}  // namespace xla
@@ -14,50 +14,158 @@ limitations under the License.
 ==============================================================================*/
 #include "xla/service/cpu/runtime_key_value_sort.h"
 
+#define EIGEN_USE_THREADS
+
 #include <algorithm>
+#include <cmath>
+#include <cstdint>
 #include <cstring>
 #include <memory>
 #include <numeric>
-#include <string>
+#include <utility>
+#include <vector>
 
 #include "absl/base/dynamic_annotations.h"
 #include "unsupported/Eigen/CXX11/Tensor"  // from @eigen_archive
+#include "xla/executable_run_options.h"
 
-ABSL_ATTRIBUTE_NO_SANITIZE_MEMORY void __xla_cpu_runtime_KeyValueSort(
-    int64_t a, int64_t b, int64_t c, char** values, int32_t values_count,
-    int32_t* values_primitive_type_size_in_bytes, bool is_stable,
-    char* run_options, int64_t* prof_counters,
-    void (*less_than)(char*, char*, char**, char**, int64_t*)) {
-  // 'values' and 'values_primitive_type_size_in_bytes' are managed by the JIT
-  // code, so msan can't tell they are initialized.
-  ABSL_ANNOTATE_MEMORY_IS_INITIALIZED(values, values_count * sizeof(char*));
-  ABSL_ANNOTATE_MEMORY_IS_INITIALIZED(values_primitive_type_size_in_bytes,
-                                      values_count * sizeof(int32_t));
+namespace {
 
-  // High-level idea of the iteration/sorting logic:
-  // Conceptually we have a 3-dimensional shape [a, b, c]. b corresponds to the
-  // dimension to sort, c is the product of the more minor dimensions (set to 1
-  // if b is the most minor dimension), and a is the product of the more major
-  // dimensions (set to 1 if b is the most major dimension). There are a * c
-  // many rows that we need to sort. We iterate through these, calculate a
-  // 'base_offset' value which points to the first element in that row, and add
-  // i * c for accessing the 'i'-th element in that row.
+using LessThanFunction = void (*)(char*, char*, char**, char**, int64_t*);
 
-  int64_t sort_dimension_elements = b;
-  int64_t num_iteration_elements = a * c;
-  int64_t sort_dimension_offset = c;
+// Rows with at least this many elements are sorted in parallel.
+constexpr int64_t kMinParallelSortSize = 1 << 14;
 
-  std::unique_ptr<int64_t[]> indices(new int64_t[sort_dimension_elements]);
-  std::unique_ptr<char*[]> comparison_values(new char*[2 * values_count]);
-  std::iota(indices.get(), indices.get() + sort_dimension_elements, 0);
-  std::unique_ptr<std::string[]> reordered_values(
-      new std::string[sort_dimension_elements]);
-  for (int64_t index = 0; index < num_iteration_elements; ++index) {
-    // If the sort should be stable, we have to reinitialize indices to iota to
-    // guarantee that we still keep the relative order in case of ties.
-    if (is_stable && index > 0) {
-      std::iota(indices.get(), indices.get() + sort_dimension_elements, 0);
+// A rough cost of a call to the less-than function, used to decide how to
+// split the work between threads.
+constexpr double kCyclesPerComparison = 20;
+
+struct SortArgs {
+  int64_t sort_dimension_elements;
+  int64_t sort_dimension_offset;
+  char** values;
+  int32_t values_count;
+  int32_t* values_primitive_type_size_in_bytes;
+  bool is_stable;
+  char* run_options;
+  int64_t* prof_counters;
+  LessThanFunction less_than;
+};
+
+// Returns a comparator of the indices of the elements of the row that starts at
+// 'base_offset'. 'comparison_values' must have room for 2 * 'values_count'
+// pointers, and must not be shared with comparators used by other threads.
+auto MakeCompareFunction(const SortArgs& args, int64_t base_offset,
+                         char** comparison_values) {
+  return [&args, base_offset, comparison_values](int64_t a, int64_t b) -> bool {
+    for (int32_t i = 0; i < args.values_count; ++i) {
+      int64_t memory_index_lhs =
+          (base_offset + a * args.sort_dimension_offset) *
+          args.values_primitive_type_size_in_bytes[i];
+      int64_t memory_index_rhs =
+          (base_offset + b * args.sort_dimension_offset) *
+          args.values_primitive_type_size_in_bytes[i];
+      comparison_values[i * 2] = args.values[i] + memory_index_lhs;
+      comparison_values[i * 2 + 1] = args.values[i] + memory_index_rhs;
     }
+    char result = 0;  // Overwritten by less_than.
+    args.less_than(&result, args.run_options, comparison_values, nullptr,
+                   args.prof_counters);
+    return result != 0u;
+  };
+}
+
+template <typename Compare>
+void SortIndices(bool is_stable, int64_t* begin, int64_t* end,
+                 Compare compare) {
+  if (is_stable) {
+    std::stable_sort(begin, end, compare);
+  } else {
+    std::sort(begin, end, compare);
+  }
+}
+
+// Sorts the 'indices' of the row that starts at 'base_offset' with a parallel
+// merge sort: chunks of the row are sorted in parallel, then pairs of sorted
+// runs are merged in parallel until one run is left. Merging is stable, so the
+// result is stable if the chunks are sorted stably.
+void ParallelSortIndices(const SortArgs& args, int64_t base_offset,
+                         int64_t* indices,
+                         const Eigen::ThreadPoolDevice& thread_pool) {
+  const int64_t n = args.sort_dimension_elements;
+  const int64_t num_chunks = std::max<int64_t>(
+      1, std::min<int64_t>(thread_pool.numThreads(), n / kMinParallelSortSize));
+  std::vector<int64_t> bounds(num_chunks + 1);
+  for (int64_t i = 0; i <= num_chunks; ++i) {
+    bounds[i] = n * i / num_chunks;
+  }
+
+  const double chunk_size = static_cast<double>(n) / num_chunks;
+  thread_pool.parallelFor(
+      num_chunks,
+      Eigen::TensorOpCost(
+          0, 0, kCyclesPerComparison * chunk_size * std::log2(chunk_size)),
+      [&](Eigen::Index first, Eigen::Index last) {
+        std::vector<char*> comparison_values(2 * args.values_count);
+        auto compare = MakeCompareFunction(args, base_offset,
+                                           comparison_values.data());
+        for (Eigen::Index i = first; i < last; ++i) {
+          SortIndices(args.is_stable, indices + bounds[i],
+                      indices + bounds[i + 1], compare);
+        }
+      });
+
+  std::vector<int64_t> buffer(n);
+  int64_t* src = indices;
+  int64_t* dst = buffer.data();
+  for (int64_t width = 1; width < num_chunks; width *= 2) {
+    const int64_t num_merges = (num_chunks + 2 * width - 1) / (2 * width);
+    thread_pool.parallelFor(
+        num_merges,
+        Eigen::TensorOpCost(2 * width * chunk_size * sizeof(int64_t),
+                            2 * width * chunk_size * sizeof(int64_t),
+                            kCyclesPerComparison * 2 * width * chunk_size),
+        [&](Eigen::Index first, Eigen::Index last) {
+          std::vector<char*> comparison_values(2 * args.values_count);
+          auto compare = MakeCompareFunction(args, base_offset,
+                                             comparison_values.data());
+          for (Eigen::Index i = first; i < last; ++i) {
+            int64_t lo = bounds[2 * i * width];
+            int64_t mid = bounds[std::min(num_chunks, (2 * i + 1) * width)];
+            int64_t hi = bounds[std::min(num_chunks, (2 * i + 2) * width)];
+            std::merge(src + lo, src + mid, src + mid, src + hi, dst + lo,
+                       compare);
+          }
+        });
+    std::swap(src, dst);
+  }
+  if (src != indices) {
+    std::copy(src, src + n, indices);
+  }
+}
+
+// Sorts the rows ['first_row', 'last_row') of the 'a * c' rows. Each row is
+// sorted in parallel on 'thread_pool', if it is not null.
+void SortRows(const SortArgs& args, int64_t first_row, int64_t last_row,
+              const Eigen::ThreadPoolDevice* thread_pool) {
+  const int64_t sort_dimension_elements = args.sort_dimension_elements;
+  const int64_t sort_dimension_offset = args.sort_dimension_offset;
+
+  int32_t max_primitive_type_size_in_bytes = 0;
+  for (int32_t i = 0; i < args.values_count; ++i) {
+    max_primitive_type_size_in_bytes =
+        std::max(max_primitive_type_size_in_bytes,
+                 args.values_primitive_type_size_in_bytes[i]);
+  }
+
+  std::unique_ptr<int64_t[]> indices(new int64_t[sort_dimension_elements]);
+  std::unique_ptr<char*[]> comparison_values(new char*[2 * args.values_count]);
+  std::unique_ptr<char[]> reordered_values(
+      new char[sort_dimension_elements * max_primitive_type_size_in_bytes]);
+  for (int64_t index = first_row; index < last_row; ++index) {
+    // The indices are reinitialized to iota for every row, so that a stable
+    // sort keeps the relative order of ties.
+    std::iota(indices.get(), indices.get() + sort_dimension_elements, 0);
     // 'index' can be split into two values which index into the 'c' dimension
     // and the 'a' dimension, respectively. 'index' % 'c' is the index into the
     // 'c' dimension, 'index' / 'c' is the index into the 'a' dimension. When
@@ -67,45 +175,88 @@ ABSL_ATTRIBUTE_NO_SANITIZE_MEMORY void __xla_cpu_runtime_KeyValueSort(
     int64_t base_offset =
         index % sort_dimension_offset +
         (index - index % sort_dimension_offset) * sort_dimension_elements;
-    auto compare_function = [&](int64_t a, int64_t b) -> bool {
-      for (int32_t i = 0; i < values_count; ++i) {
-        int64_t memory_index_lhs = (base_offset + a * sort_dimension_offset) *
-                                   values_primitive_type_size_in_bytes[i];
-        int64_t memory_index_rhs = (base_offset + b * sort_dimension_offset) *
-                                   values_primitive_type_size_in_bytes[i];
-        comparison_values[i * 2] = values[i] + memory_index_lhs;
-        comparison_values[i * 2 + 1] = values[i] + memory_index_rhs;
-      }
-      char result = 0;  // Overwritten by less_than.
-      less_than(&result, run_options, comparison_values.get(), nullptr,
-                prof_counters);
-      return result != 0u;
-    };
-    if (is_stable) {
-      std::stable_sort(indices.get(), indices.get() + sort_dimension_elements,
-                       compare_function);
+    if (thread_pool != nullptr &&
+        sort_dimension_elements >= 2 * kMinParallelSortSize) {
+      ParallelSortIndices(args, base_offset, indices.get(), *thread_pool);
     } else {
-      std::sort(indices.get(), indices.get() + sort_dimension_elements,
-                compare_function);
+      SortIndices(args.is_stable, indices.get(),
+                  indices.get() + sort_dimension_elements,
+                  MakeCompareFunction(args, base_offset,
+                                      comparison_values.get()));
     }
 
     // Reorder the values according to the order defined by 'indices'.
-    for (int32_t idx = 0; idx < values_count; ++idx) {
+    for (int32_t idx = 0; idx < args.values_count; ++idx) {
+      const int32_t size = args.values_primitive_type_size_in_bytes[idx];
       for (int64_t i = 0; i < sort_dimension_elements; ++i) {
         int64_t memory_index =
-            (base_offset + indices[i] * sort_dimension_offset) *
-            values_primitive_type_size_in_bytes[idx];
-
-        reordered_values[i] =
-            std::string(values[idx] + memory_index,
-                        values_primitive_type_size_in_bytes[idx]);
+            (base_offset + indices[i] * sort_dimension_offset) * size;
+        memcpy(reordered_values.get() + i * size,
+               args.values[idx] + memory_index, size);
       }
       for (int64_t i = 0; i < sort_dimension_elements; ++i) {
-        int64_t memory_index = (base_offset + i * sort_dimension_offset) *
-                               values_primitive_type_size_in_bytes[idx];
-        memcpy(values[idx] + memory_index, reordered_values[i].c_str(),
-               values_primitive_type_size_in_bytes[idx]);
+        int64_t memory_index = (base_offset + i * sort_dimension_offset) * size;
+        memcpy(args.values[idx] + memory_index,
+               reordered_values.get() + i * size, size);
       }
     }
   }
 }
+
+}  // namespace
+
+ABSL_ATTRIBUTE_NO_SANITIZE_MEMORY void __xla_cpu_runtime_KeyValueSort(
+    int64_t a, int64_t b, int64_t c, char** values, int32_t values_count,
+    int32_t* values_primitive_type_size_in_bytes, bool is_stable,
+    char* run_options, int64_t* prof_counters,
+    void (*less_than)(char*, char*, char**, char**, int64_t*)) {
+  // 'values' and 'values_primitive_type_size_in_bytes' are managed by the JIT
+  // code, so msan can't tell they are initialized.
+  ABSL_ANNOTATE_MEMORY_IS_INITIALIZED(values, values_count * sizeof(char*));
+  ABSL_ANNOTATE_MEMORY_IS_INITIALIZED(values_primitive_type_size_in_bytes,
+                                      values_count * sizeof(int32_t));
+
+  // High-level idea of the iteration/sorting logic:
+  // Conceptually we have a 3-dimensional shape [a, b, c]. b corresponds to the
+  // dimension to sort, c is the product of the more minor dimensions (set to 1
+  // if b is the most minor dimension), and a is the product of the more major
+  // dimensions (set to 1 if b is the most major dimension). There are a * c
+  // many rows that we need to sort. We iterate through these, calculate a
+  // 'base_offset' value which points to the first element in that row, and add
+  // i * c for accessing the 'i'-th element in that row.
+  const SortArgs args = {/*sort_dimension_elements=*/b,
+                         /*sort_dimension_offset=*/c,
+                         values,
+                         values_count,
+                         values_primitive_type_size_in_bytes,
+                         is_stable,
+                         run_options,
+                         prof_counters,
+                         less_than};
+  const int64_t num_iteration_elements = a * c;
+
+  // The less-than function can be called concurrently, but only if it does not
+  // update profile counters.
+  const Eigen::ThreadPoolDevice* thread_pool = nullptr;
+  if (run_options != nullptr && prof_counters == nullptr) {
+    thread_pool =
+        reinterpret_cast<const xla::ExecutableRunOptions*>(run_options)
+            ->intra_op_thread_pool();
+  }
+
+  if (thread_pool == nullptr ||
+      num_iteration_elements < thread_pool->numThreads()) {
+    // Sort the rows one after another, each of them in parallel if it is
+    // large enough.
+    SortRows(args, 0, num_iteration_elements, thread_pool);
+    return;
+  }
+  // There are enough rows to keep all threads busy sorting whole rows.
+  thread_pool->parallelFor(
+      num_iteration_elements,
+      Eigen::TensorOpCost(b * sizeof(int64_t), b * sizeof(int64_t),
+                          kCyclesPerComparison * b * std::log2(b + 1)),
+      [&](Eigen::Index first, Eigen::Index last) {
+        SortRows(args, first, last, /*thread_pool=*/nullptr);
+      });
+}
@@ -29,6 +29,8 @@ extern "C" {
 // 'values' and 'values_primitive_type_size_in_bytes'. The size of the primitive
 // type of the i-th shape has exactly 'values_primitive_type_size_in_bytes[i]'
 // bytes. 'is_stable' specifies whether the sorting should be stable.
+// Rows are sorted in parallel on the intra-op thread pool of 'run_options', if
+// it has one and 'prof_counters' is null.
 // 'run_options' and 'prof_counters' are passed through to the less-than
 // function, which expects the following arguments:
 // - pointer to the return value buffer (char*)
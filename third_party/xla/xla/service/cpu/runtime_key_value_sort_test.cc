@@ -0,0 +1,153 @@
+/* Copyright 2024 The OpenXLA Authors.
+
+Licensed under the Apache License, Version 2.0 (the "License");
+you may not use this file except in compliance with the License.
+You may obtain a copy of the License at
+
+    http://www.apache.org/licenses/LICENSE-2.0
+
+Unless required by applicable law or agreed to in writing, software
+distributed under the License is distributed on an "AS IS" BASIS,
+WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+See the License for the specific language governing permissions and
+limitations under the License.
+==============================================================================*/
+
+#define EIGEN_USE_THREADS
+#include "xla/service/cpu/runtime_key_value_sort.h"
+
+#include <algorithm>
+#include <cstdint>
+#include <numeric>
+#include <random>
+#include <vector>
+
+#include "unsupported/Eigen/CXX11/Tensor"  // from @eigen_archive
+#include "xla/executable_run_options.h"
+#include "tsl/platform/env.h"
+#include "tsl/platform/test.h"
+#include "tsl/platform/test_benchmark.h"
+#include "tsl/platform/threadpool.h"
+
+namespace xla {
+namespace {
+
+// Compares the float keys of two elements.
+void LessThanF32(char* result, char* run_options, char** values, char** params,
+                 int64_t* prof_counters) {
+  *result = *reinterpret_cast<const float*>(values[0]) <
+            *reinterpret_cast<const float*>(values[1]);
+}
+
+// Returns 'size' keys with many ties.
+std::vector<float> RandomKeys(int64_t size) {
+  std::minstd_rand0 engine;
+  std::uniform_int_distribution<int> distribution(-1000, 1000);
+  std::vector<float> keys(size);
+  for (float& key : keys) {
+    key = distribution(engine);
+  }
+  return keys;
+}
+
+struct SortedRows {
+  std::vector<float> keys;
+  std::vector<int32_t> payload;
+};
+
+// Stably sorts the [a, b, c] keys along the b dimension, together with a
+// payload of the original positions of the keys.
+SortedRows ReferenceSort(int64_t a, int64_t b, int64_t c,
+                         const std::vector<float>& keys) {
+  SortedRows result{keys, std::vector<int32_t>(keys.size())};
+  std::iota(result.payload.begin(), result.payload.end(), 0);
+  for (int64_t i = 0; i < a; ++i) {
+    for (int64_t j = 0; j < c; ++j) {
+      int64_t base = i * b * c + j;
+      std::vector<int32_t> row(b);
+      for (int64_t k = 0; k < b; ++k) row[k] = base + k * c;
+      std::stable_sort(row.begin(), row.end(), [&](int32_t x, int32_t y) {
+        return keys[x] < keys[y];
+      });
+      for (int64_t k = 0; k < b; ++k) {
+        result.keys[base + k * c] = keys[row[k]];
+        result.payload[base + k * c] = row[k];
+      }
+    }
+  }
+  return result;
+}
+
+SortedRows RunSort(ExecutableRunOptions* run_options, int64_t a, int64_t b,
+                   int64_t c, const std::vector<float>& keys) {
+  SortedRows result{keys, std::vector<int32_t>(keys.size())};
+  std::iota(result.payload.begin(), result.payload.end(), 0);
+  char* values[] = {reinterpret_cast<char*>(result.keys.data()),
+                    reinterpret_cast<char*>(result.payload.data())};
+  int32_t sizes[] = {sizeof(float), sizeof(int32_t)};
+  __xla_cpu_runtime_KeyValueSort(a, b, c, values, /*values_count=*/2, sizes,
+                                 /*is_stable=*/true,
+                                 reinterpret_cast<char*>(run_options),
+                                 /*prof_counters=*/nullptr, LessThanF32);
+  return result;
+}
+
+class KeyValueSortTest : public ::testing::TestWithParam<bool> {
+ protected:
+  KeyValueSortTest()
+      : thread_pool_(tsl::Env::Default(), "sort_test", 4),
+        device_(thread_pool_.AsEigenThreadPool(), 4) {
+    run_options_.set_intra_op_thread_pool(&device_);
+  }
+
+  void ExpectMatchesReference(int64_t a, int64_t b, int64_t c) {
+    std::vector<float> keys = RandomKeys(a * b * c);
+    SortedRows expected = ReferenceSort(a, b, c, keys);
+    SortedRows actual =
+        RunSort(GetParam() ? &run_options_ : nullptr, a, b, c, keys);
+    EXPECT_EQ(actual.keys, expected.keys);
+    EXPECT_EQ(actual.payload, expected.payload);
+  }
+
+  tsl::thread::ThreadPool thread_pool_;
+  Eigen::ThreadPoolDevice device_;
+  ExecutableRunOptions run_options_;
+};
+
+TEST_P(KeyValueSortTest, ManySmallRows) { ExpectMatchesReference(16, 100, 3); }
+
+TEST_P(KeyValueSortTest, FewSmallRows) { ExpectMatchesReference(1, 100, 2); }
+
+// A row that is large enough to be sorted by a parallel merge sort.
+TEST_P(KeyValueSortTest, LargeRow) { ExpectMatchesReference(1, 100000, 1); }
+
+TEST_P(KeyValueSortTest, LargeStridedRows) {
+  ExpectMatchesReference(1, 50000, 2);
+}
+
+INSTANTIATE_TEST_SUITE_P(KeyValueSortTestInstantiation, KeyValueSortTest,
+                         ::testing::Bool());
+
+void BM_KeyValueSort(::testing::benchmark::State& state) {
+  const int64_t a = state.range(0);
+  const int64_t b = state.range(1);
+  std::vector<float> keys = RandomKeys(a * b);
+
+  tsl::thread::ThreadPool thread_pool(tsl::Env::Default(), "bm_sort", 8);
+  Eigen::ThreadPoolDevice device(thread_pool.AsEigenThreadPool(), 8);
+  ExecutableRunOptions run_options;
+  run_options.set_intra_op_thread_pool(&device);
+
+  for (auto s : state) {
+    RunSort(&run_options, a, b, /*c=*/1, keys);
+  }
+  state.SetItemsProcessed(state.iterations() * a * b);
+}
+
+BENCHMARK(BM_KeyValueSort)
+    ->Args({1, 1 << 20})
+    ->Args({64, 16384})
+    ->Args({4096, 256});
+
+}  // namespace
+}  // namespace xla
@@ -15,7 +15,10 @@ limitations under the License.
 
 #include "xla/service/cpu/runtime_topk.h"
 
+#define EIGEN_USE_THREADS
+
 #include <algorithm>
+#include <cstdint>
 #include <cstring>
 #include <limits>
 #include <memory>
@@ -23,53 +26,153 @@ limitations under the License.
 #include <vector>
 
 #include "absl/base/dynamic_annotations.h"
+#include "unsupported/Eigen/CXX11/Tensor"  // from @eigen_archive
+#include "xla/executable_run_options.h"
+
+namespace {
+
+// Rows are rejected against the smallest of the top k values found so far a
+// block of this many values at a time.
+constexpr int64_t kBlockSize = 64;
+
+template <typename T>
+int32_t ConvertToInt(T value) {
+  uint32_t x;
+  std::memcpy(&x, &value, sizeof(x));
+  return static_cast<int32_t>(x) < 0 ? std::numeric_limits<int32_t>::max() - x
+                                     : x;
+}
+
+// A value of a row, in the integer total order of ConvertToInt.
+struct Candidate {
+  int32_t key;
+  int32_t index;
+};
+
+// Returns true if 'a' goes before 'b' in the output.
+bool Precedes(const Candidate& a, const Candidate& b) {
+  // Do the comparison in integers to enforce a total order of
+  // -NaN < -Inf < -0 < +0 < +Inf < +NaN, and stabilize sorting with the index.
+  return a.key > b.key || (a.key == b.key && a.index < b.index);
+}
+
+// Computes the top k of a row by sorting the indices of all of its values.
+// This is used when k is a large fraction of the row.
+template <typename T>
+void PartialSortRow(int64_t input_size, int64_t k, const T* values_batch,
+                    T* out_values_batch, int32_t* out_indices_batch,
+                    std::vector<int32_t>& temp_indices) {
+  temp_indices.resize(input_size);
+  std::iota(temp_indices.begin(), temp_indices.end(), 0);
+
+  auto kth_element = temp_indices.begin() + k;
+  std::partial_sort(temp_indices.begin(), kth_element, temp_indices.end(),
+                    [&](int32_t i1, int32_t i2) {
+                      return Precedes({ConvertToInt(values_batch[i1]), i1},
+                                      {ConvertToInt(values_batch[i2]), i2});
+                    });
+
+  std::copy(temp_indices.begin(), kth_element, out_indices_batch);
+  for (int64_t i = 0; i < k; i++) {
+    out_values_batch[i] = values_batch[temp_indices[i]];
+  }
+}
 
+// Computes the top k of a row with a heap of the k values that precede all the
+// others seen so far, whose top is the last of them. Values can only enter the
+// heap if they are larger than its top, since a later value that is equal
+// goes after it. Blocks of values that are all too small, which are most of
+// them in a long row, are rejected by a loop that the compiler vectorizes.
 template <typename T>
-static void TopK(int64_t batch_size, int64_t input_size, int64_t k,
-                 const T* values, T* out_values, int32_t* out_indices) {
+void HeapSelectRow(int64_t input_size, int64_t k, const T* values_batch,
+                   T* out_values_batch, int32_t* out_indices_batch,
+                   std::vector<Candidate>& heap) {
+  heap.clear();
+  for (int32_t i = 0; i < k; ++i) {
+    heap.push_back({ConvertToInt(values_batch[i]), i});
+  }
+  std::make_heap(heap.begin(), heap.end(), Precedes);
+
+  auto push = [&](int32_t i) {
+    const int32_t key = ConvertToInt(values_batch[i]);
+    if (key > heap.front().key) {
+      std::pop_heap(heap.begin(), heap.end(), Precedes);
+      heap.back() = {key, i};
+      std::push_heap(heap.begin(), heap.end(), Precedes);
+    }
+  };
+
+  int64_t i = k;
+  for (; i + kBlockSize <= input_size; i += kBlockSize) {
+    const int32_t threshold = heap.front().key;
+    bool has_candidates = false;
+    for (int64_t j = i; j < i + kBlockSize; ++j) {
+      has_candidates |= ConvertToInt(values_batch[j]) > threshold;
+    }
+    if (has_candidates) {
+      for (int64_t j = i; j < i + kBlockSize; ++j) {
+        push(j);
+      }
+    }
+  }
+  for (; i < input_size; ++i) {
+    push(i);
+  }
+
+  std::sort_heap(heap.begin(), heap.end(), Precedes);
+  for (int64_t j = 0; j < k; ++j) {
+    out_indices_batch[j] = heap[j].index;
+    out_values_batch[j] = values_batch[heap[j].index];
+  }
+}
+
+template <typename T>
+void TopK(const xla::ExecutableRunOptions* run_options, int64_t batch_size,
+          int64_t input_size, int64_t k, const T* values, T* out_values,
+          int32_t* out_indices) {
   // 'values' is managed by the JIT code, so msan can't tell they are
   // initialized.
   ABSL_ANNOTATE_MEMORY_IS_INITIALIZED(values,
                                       input_size * batch_size * sizeof(T));
 
-  std::vector<int32_t> temp_indices(input_size);
-  for (int64_t batch = 0; batch != batch_size; ++batch) {
-    std::iota(temp_indices.begin(), temp_indices.end(), 0);
-
-    const T* values_batch = values + batch * input_size;
-
-    auto convert_to_int = [](T value) {
-      uint32_t x;
-      std::memcpy(&x, &value, sizeof(x));
-      return static_cast<int32_t>(x) < 0
-                 ? std::numeric_limits<int32_t>::max() - x
-                 : x;
-    };
-
-    auto kth_element = temp_indices.begin() + k;
-    std::partial_sort(temp_indices.begin(), kth_element, temp_indices.end(),
-                      [&](size_t i1, size_t i2) {
-                        // Do the comparison in integers to enforce a total
-                        // order of -NaN < -Inf < -0 < +0 < +Inf < +NaN.
-                        int32_t v1 = convert_to_int(values_batch[i1]);
-                        int32_t v2 = convert_to_int(values_batch[i2]);
-                        if (v1 == v2) {
-                          return i1 < i2;  // Stabilize sorting.
-                        }
-                        return v1 > v2;
-                      });
-
-    T* out_values_batch = out_values + batch * k;
-    int32_t* out_indices_batch = out_indices + batch * k;
-    std::copy(temp_indices.begin(), kth_element, out_indices_batch);
-    for (int64_t i = 0; i < k; i++) {
-      out_values_batch[i] = values_batch[temp_indices[i]];
+  // The heap is faster unless most of the values end up in it.
+  const bool use_heap = k > 0 && 4 * k <= input_size;
+  auto top_k_rows = [&](int64_t first_batch, int64_t last_batch) {
+    std::vector<int32_t> temp_indices;
+    std::vector<Candidate> heap;
+    for (int64_t batch = first_batch; batch != last_batch; ++batch) {
+      const T* values_batch = values + batch * input_size;
+      T* out_values_batch = out_values + batch * k;
+      int32_t* out_indices_batch = out_indices + batch * k;
+      if (use_heap) {
+        HeapSelectRow(input_size, k, values_batch, out_values_batch,
+                      out_indices_batch, heap);
+      } else {
+        PartialSortRow(input_size, k, values_batch, out_values_batch,
+                       out_indices_batch, temp_indices);
+      }
     }
+  };
+
+  const Eigen::ThreadPoolDevice* thread_pool =
+      run_options != nullptr ? run_options->intra_op_thread_pool() : nullptr;
+  if (thread_pool == nullptr || batch_size == 1) {
+    top_k_rows(0, batch_size);
+    return;
   }
+  // Each row reads all of its values, and compares and converts each of them.
+  const Eigen::TensorOpCost cost_per_row(
+      /*bytes_loaded=*/input_size * sizeof(T),
+      /*bytes_stored=*/k * (sizeof(T) + sizeof(int32_t)),
+      /*compute_cycles=*/input_size * 4);
+  thread_pool->parallelFor(batch_size, cost_per_row, top_k_rows);
 }
 
+}  // namespace
+
 ABSL_ATTRIBUTE_NO_SANITIZE_MEMORY void __xla_cpu_runtime_TopKF32(
-    int64_t batch_size, int64_t input_size, int64_t k, const float* values,
-    float* out_values, int32_t* out_indices) {
-  TopK(batch_size, input_size, k, values, out_values, out_indices);
+    const void* run_options_ptr, int64_t batch_size, int64_t input_size,
+    int64_t k, const float* values, float* out_values, int32_t* out_indices) {
+  TopK(static_cast<const xla::ExecutableRunOptions*>(run_options_ptr),
+       batch_size, input_size, k, values, out_values, out_indices);
 }
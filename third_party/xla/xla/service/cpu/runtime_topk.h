@@ -21,8 +21,11 @@ limitations under the License.
 extern "C" {
 
 // Calculates `batch_size` topk operations with `input_size` inputs each. The
-// outputs are written to `out_values` and `out_indices`.
-extern void __xla_cpu_runtime_TopKF32(int64_t batch_size, int64_t input_size,
+// outputs are written to `out_values` and `out_indices`. The batches are
+// processed in parallel on the intra-op thread pool of `run_options_ptr`, if
+// it has one.
+extern void __xla_cpu_runtime_TopKF32(const void* run_options_ptr,
+                                      int64_t batch_size, int64_t input_size,
                                       int64_t k, const float* values,
                                       float* out_values, int32_t* out_indices);
 }
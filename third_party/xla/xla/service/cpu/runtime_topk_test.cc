@@ -0,0 +1,161 @@
+/* Copyright 2024 The OpenXLA Authors.
+
+Licensed under the Apache License, Version 2.0 (the "License");
+you may not use this file except in compliance with the License.
+You may obtain a copy of the License at
+
+    http://www.apache.org/licenses/LICENSE-2.0
+
+Unless required by applicable law or agreed to in writing, software
+distributed under the License is distributed on an "AS IS" BASIS,
+WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+See the License for the specific language governing permissions and
+limitations under the License.
+==============================================================================*/
+
+#define EIGEN_USE_THREADS
+#include "xla/service/cpu/runtime_topk.h"
+
+#include <algorithm>
+#include <cstdint>
+#include <limits>
+#include <numeric>
+#include <random>
+#include <vector>
+
+#include "unsupported/Eigen/CXX11/Tensor"  // from @eigen_archive
+#include "xla/executable_run_options.h"
+#include "tsl/platform/env.h"
+#include "tsl/platform/test.h"
+#include "tsl/platform/test_benchmark.h"
+#include "tsl/platform/threadpool.h"
+
+namespace xla {
+namespace {
+
+struct TopKResult {
+  std::vector<float> values;
+  std::vector<int32_t> indices;
+};
+
+// Computes the top k of each row by a full stable sort of the row.
+TopKResult ReferenceTopK(int64_t batch_size, int64_t input_size, int64_t k,
+                         const std::vector<float>& values) {
+  TopKResult result;
+  for (int64_t row = 0; row < batch_size; ++row) {
+    const float* row_values = values.data() + row * input_size;
+    std::vector<int32_t> indices(input_size);
+    std::iota(indices.begin(), indices.end(), 0);
+    std::stable_sort(indices.begin(), indices.end(), [&](int32_t a, int32_t b) {
+      return row_values[a] > row_values[b];
+    });
+    for (int64_t i = 0; i < k; ++i) {
+      result.values.push_back(row_values[indices[i]]);
+      result.indices.push_back(indices[i]);
+    }
+  }
+  return result;
+}
+
+// Returns 'size' values with many ties.
+std::vector<float> RandomValues(int64_t size) {
+  std::minstd_rand0 engine;
+  std::uniform_int_distribution<int> distribution(-100, 100);
+  std::vector<float> values(size);
+  for (float& value : values) {
+    value = distribution(engine) / 4.0f;
+  }
+  return values;
+}
+
+TopKResult RunTopK(const ExecutableRunOptions* run_options,
+                   int64_t batch_size, int64_t input_size, int64_t k,
+                   const std::vector<float>& values) {
+  TopKResult result;
+  result.values.resize(batch_size * k);
+  result.indices.resize(batch_size * k);
+  __xla_cpu_runtime_TopKF32(run_options, batch_size, input_size, k,
+                            values.data(), result.values.data(),
+                            result.indices.data());
+  return result;
+}
+
+class TopKTest : public ::testing::TestWithParam<bool> {
+ protected:
+  TopKTest()
+      : thread_pool_(tsl::Env::Default(), "topk_test", 4),
+        device_(thread_pool_.AsEigenThreadPool(), 4) {
+    run_options_.set_intra_op_thread_pool(&device_);
+  }
+
+  // Returns the run options to use: with a thread pool if the test is
+  // parameterized to run in parallel, and none otherwise.
+  const ExecutableRunOptions* run_options() const {
+    return GetParam() ? &run_options_ : nullptr;
+  }
+
+  void ExpectMatchesReference(int64_t batch_size, int64_t input_size,
+                              int64_t k) {
+    std::vector<float> values = RandomValues(batch_size * input_size);
+    TopKResult expected = ReferenceTopK(batch_size, input_size, k, values);
+    TopKResult actual =
+        RunTopK(run_options(), batch_size, input_size, k, values);
+    EXPECT_EQ(actual.values, expected.values);
+    EXPECT_EQ(actual.indices, expected.indices);
+  }
+
+  tsl::thread::ThreadPool thread_pool_;
+  Eigen::ThreadPoolDevice device_;
+  ExecutableRunOptions run_options_;
+};
+
+TEST_P(TopKTest, SmallKOfLargeRows) { ExpectMatchesReference(7, 1000, 5); }
+
+TEST_P(TopKTest, LargeKOfSmallRows) { ExpectMatchesReference(7, 20, 10); }
+
+TEST_P(TopKTest, KEqualsRowSize) { ExpectMatchesReference(3, 16, 16); }
+
+TEST_P(TopKTest, SingleRow) { ExpectMatchesReference(1, 4096, 8); }
+
+TEST_P(TopKTest, ZeroK) { ExpectMatchesReference(3, 16, 0); }
+
+TEST_P(TopKTest, OrdersSpecialValues) {
+  const float inf = std::numeric_limits<float>::infinity();
+  const float nan = std::numeric_limits<float>::quiet_NaN();
+  std::vector<float> values = {1.0f, -inf, nan, 0.0f, -0.0f, inf, -nan, 2.0f};
+  values.resize(64, -1.0f);
+  TopKResult result = RunTopK(run_options(), 1, values.size(), 6, values);
+  EXPECT_EQ(result.indices, (std::vector<int32_t>{2, 5, 7, 0, 3, 4}));
+}
+
+INSTANTIATE_TEST_SUITE_P(TopKTestInstantiation, TopKTest, ::testing::Bool());
+
+void BM_TopK(::testing::benchmark::State& state) {
+  const int64_t batch_size = state.range(0);
+  const int64_t input_size = state.range(1);
+  const int64_t k = state.range(2);
+  std::vector<float> values = RandomValues(batch_size * input_size);
+  std::vector<float> out_values(batch_size * k);
+  std::vector<int32_t> out_indices(batch_size * k);
+
+  tsl::thread::ThreadPool thread_pool(tsl::Env::Default(), "bm_topk", 8);
+  Eigen::ThreadPoolDevice device(thread_pool.AsEigenThreadPool(), 8);
+  ExecutableRunOptions run_options;
+  run_options.set_intra_op_thread_pool(&device);
+
+  for (auto s : state) {
+    __xla_cpu_runtime_TopKF32(&run_options, batch_size, input_size, k,
+                              values.data(), out_values.data(),
+                              out_indices.data());
+  }
+  state.SetItemsProcessed(state.iterations() * batch_size * input_size);
+}
+
+BENCHMARK(BM_TopK)
+    ->Args({1, 1 << 20, 10})
+    ->Args({64, 32000, 5})
+    ->Args({64, 32000, 100})
+    ->Args({256, 1024, 512});
+
+}  // namespace
+}  // namespace xla
@@ -23,11 +23,14 @@ limitations under the License.
 
 #include "absl/base/thread_annotations.h"
 #include "absl/container/flat_hash_map.h"
+#include "absl/status/statusor.h"
 #include "absl/synchronization/mutex.h"
 #include "xla/stream_executor/memory_allocation.h"
 #include "xla/stream_executor/stream_executor.h"
 #include "tsl/framework/allocator.h"
+#include "tsl/platform/env.h"
 #include "tsl/platform/logging.h"
+#include "tsl/platform/numa.h"
 #include "tsl/profiler/lib/traceme.h"
 
 namespace stream_executor {
@@ -56,7 +59,20 @@ class DeviceHostAllocator : public tsl::SubAllocator {
     *bytes_received = num_bytes;
 
     if (num_bytes > 0) {
-      auto allocation = stream_exec_->HostMemoryAllocate(num_bytes);
+      absl::StatusOr<std::unique_ptr<MemoryAllocation>> allocation;
+      if (numa_node_ != tsl::port::kNUMANoAffinity &&
+          tsl::port::NUMAEnabled()) {
+        // Pinned pages are placed on the node of the thread that allocates
+        // them, so allocate on a thread bound to `numa_node_`, rather than
+        // change the affinity of the calling thread.
+        std::unique_ptr<tsl::Thread> thread(tsl::Env::Default()->StartThread(
+            tsl::ThreadOptions(), "numa_host_alloc", [&]() {
+              tsl::port::NUMASetThreadNodeAffinity(numa_node_);
+              allocation = stream_exec_->HostMemoryAllocate(num_bytes);
+            }));
+      } else {
+        allocation = stream_exec_->HostMemoryAllocate(num_bytes);
+      }
       if (!allocation.ok()) {
         LOG(WARNING) << "could not allocate pinned host memory of size: "
                      << num_bytes;
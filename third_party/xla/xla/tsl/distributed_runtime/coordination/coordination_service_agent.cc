@@ -28,6 +28,7 @@ limitations under the License.
 #include <utility>
 #include <vector>
 
+#include "absl/container/flat_hash_map.h"
 #include "absl/container/flat_hash_set.h"
 #include "absl/log/log.h"
 #include "absl/status/status.h"
@@ -51,6 +52,7 @@ limitations under the License.
 #include "tsl/protobuf/coordination_service.pb.h"
 
 namespace tsl {
+using tensorflow::AggregatedHeartbeat;
 using tensorflow::CoordinatedTask;
 using tensorflow::CoordinatedTaskState;
 using tensorflow::CoordinatedTaskStateInfo;
@@ -68,6 +70,11 @@ constexpr absl::Duration kDefaultHeartbeatTimeout = absl::Seconds(10);
 constexpr absl::Duration kDefaultShutdownTimeout = absl::Seconds(10);
 constexpr char kHeartbeatThread[] = "CoordinationServiceHeartbeatLoop";
 
+std::string GetTaskName(const CoordinatedTask& task) {
+  return absl::StrCat("/job:", task.job_name(), "/replica:", 0,
+                      "/task:", task.task_id());
+}
+
 class CoordinationServiceAgentImpl : public CoordinationServiceAgent {
  public:
   CoordinationServiceAgentImpl() = default;
@@ -83,6 +90,8 @@ class CoordinationServiceAgentImpl : public CoordinationServiceAgent {
                           const CoordinationServiceConfig& configs,
                           std::unique_ptr<CoordinationClient> leader_client,
                           StatusCallback error_fn) override;
+  absl::Status SetHeartbeatAggregatorClient(
+      std::unique_ptr<CoordinationClient> aggregator_client) override;
   bool IsInitialized() override;
   bool IsConnected() override;
   bool IsError() override;
@@ -132,10 +141,22 @@ class CoordinationServiceAgentImpl : public CoordinationServiceAgent {
   void SetError(const absl::Status& error) override;
   absl::Status ActivateWatch(
       std::string_view key, const std::map<std::string, std::string>&) override;
+  absl::StatusOr<uint64_t> AggregateHeartbeat(const CoordinatedTask& task,
+                                              uint64_t incarnation) override;
   // Returns an error if agent is not running. If `allow_disconnected` is true,
   // returns OK even if the agent is in DISCONNECTED state.
   absl::Status ValidateRunningAgent(bool allow_disconnected = false);
   void StopHeartbeat();
+  // Sends a heartbeat to the aggregator of this task, if there is one, or to
+  // the service.
+  absl::Status SendHeartbeat(int64_t timeout_ms,
+                             const HeartbeatRequest& request,
+                             HeartbeatResponse* response);
+  // Moves the heartbeats queued by AggregateHeartbeat() to `request`.
+  void TakeAggregatedHeartbeats(HeartbeatRequest* request);
+  // Records the errors of the forwarded heartbeats in `response`.
+  void RecordAggregatedHeartbeatErrors(
+      const HeartbeatResponse& response);
 
  private:
   Env* env_ = nullptr;  // Not owned.
@@ -164,6 +185,18 @@ class CoordinationServiceAgentImpl : public CoordinationServiceAgent {
   // GetKeyValueAsync() callbacks.
   CancellationManager cancellation_manager_;
   std::unique_ptr<CoordinationClient> leader_client_;
+  std::unique_ptr<CoordinationClient> aggregator_client_;
+
+  // The heartbeats of the other tasks of the group if this task aggregates
+  // heartbeats, keyed by task name.
+  bool is_heartbeat_aggregator_ = false;
+  mutex aggregation_mu_;
+  absl::flat_hash_map<std::string, AggregatedHeartbeat>
+      aggregated_heartbeats_ TF_GUARDED_BY(aggregation_mu_);
+  absl::flat_hash_map<std::string, absl::Status> aggregated_heartbeat_errors_
+      TF_GUARDED_BY(aggregation_mu_);
+  // The leader incarnation in the last response to a heartbeat.
+  uint64_t last_leader_incarnation_ TF_GUARDED_BY(aggregation_mu_) = 0;
 
   CoordinationServiceAgentImpl(const CoordinationServiceAgentImpl&) = delete;
   void operator=(const CoordinationServiceAgentImpl&) = delete;
@@ -205,10 +238,26 @@ absl::Status CoordinationServiceAgentImpl::Initialize(
         "CoordinationServiceAgent must have a valid leader client."));
   }
   error_fn_ = error_fn;
+  const std::optional<CoordinatedTask> aggregator =
+      GetHeartbeatAggregator(configs_, task_);
+  is_heartbeat_aggregator_ =
+      aggregator.has_value() && aggregator->task_id() == task_.task_id();
   state_ = CoordinatedTaskState::TASKSTATE_DISCONNECTED;
   return absl::OkStatus();
 }
 
+absl::Status CoordinationServiceAgentImpl::SetHeartbeatAggregatorClient(
+    std::unique_ptr<CoordinationClient> aggregator_client) {
+  mutex_lock l(state_mu_);
+  if (state_ != CoordinatedTaskState::TASKSTATE_DISCONNECTED) {
+    return MakeCoordinationError(absl::FailedPreconditionError(
+        "The heartbeat aggregator must be set after Initialize() and before "
+        "Connect()."));
+  }
+  aggregator_client_ = std::move(aggregator_client);
+  return absl::OkStatus();
+}
+
 bool CoordinationServiceAgentImpl::IsInitialized() {
   mutex_lock l(state_mu_);
   return state_ != CoordinatedTaskState::TASKSTATE_UNINITIALIZED;
@@ -311,25 +360,29 @@ absl::Status CoordinationServiceAgentImpl::Connect() {
         *request.mutable_source_task() = task_;
         request.set_incarnation(incarnation_id_);
         HeartbeatResponse response;
+        // An aggregator forwards the heartbeats of its group with its own, so
+        // it sends them twice as often to keep the delay of the forwarded
+        // heartbeats within the timeout.
         const int64_t heartbeat_interval_ms =
-            configs_.heartbeat_timeout_in_ms() > 0
-                ? configs_.heartbeat_timeout_in_ms() / 2
-                : absl::ToInt64Milliseconds(kDefaultHeartbeatTimeout) / 2;
-        CallOptions call_opts;
-        call_opts.SetTimeout(heartbeat_interval_ms);
+            (configs_.heartbeat_timeout_in_ms() > 0
+                 ? configs_.heartbeat_timeout_in_ms()
+                 : absl::ToInt64Milliseconds(kDefaultHeartbeatTimeout)) /
+            (is_heartbeat_aggregator_ ? 4 : 2);
+        {
+          mutex_lock l(aggregation_mu_);
+          last_leader_incarnation_ = leader_incarnation_;
+        }
 
         while (true) {
-          absl::Status status;
-          absl::Notification n;
+          if (is_heartbeat_aggregator_) {
+            TakeAggregatedHeartbeats(&request);
+          }
+          response.Clear();
           // Heartbeat RPC implementation automatically retries to tolerate
           // transient network failures.
           VLOG(10) << "HeartbeatRequest: " << request.DebugString();
-          leader_client_->HeartbeatAsync(&call_opts, &request, &response,
-                                         [&](absl::Status s) {
-                                           status = s;
-                                           n.Notify();
-                                         });
-          n.WaitForNotification();
+          absl::Status status =
+              SendHeartbeat(heartbeat_interval_ms, request, &response);
           VLOG(10) << "HeartbeatResponse: " << status;
           {
             mutex_lock l(heartbeat_thread_shutdown_mu_);
@@ -347,6 +400,8 @@ absl::Status CoordinationServiceAgentImpl::Connect() {
             SetError(MakeCoordinationError(
                 absl::AbortedError("Leader incarnation ID mismatch: the "
                                    "coordination leader has restarted.")));
+          } else {
+            RecordAggregatedHeartbeatErrors(response);
           }
           // Send next heartbeat after an interval.
           {
@@ -362,6 +417,84 @@ absl::Status CoordinationServiceAgentImpl::Connect() {
   return absl::OkStatus();
 }
 
+absl::Status CoordinationServiceAgentImpl::SendHeartbeat(
+    int64_t timeout_ms, const HeartbeatRequest& request,
+    HeartbeatResponse* response) {
+  auto send = [&](CoordinationClient* client) {
+    CallOptions call_opts;
+    call_opts.SetTimeout(timeout_ms);
+    absl::Status status;
+    absl::Notification n;
+    client->HeartbeatAsync(&call_opts, &request, response,
+                           [&](absl::Status s) {
+                             status = s;
+                             n.Notify();
+                           });
+    n.WaitForNotification();
+    return status;
+  };
+  if (aggregator_client_ != nullptr) {
+    absl::Status status = send(aggregator_client_.get());
+    // Errors of the service carry a payload. Any other error means that the
+    // aggregator cannot forward heartbeats, so send them to the service.
+    if (status.ok() ||
+        status.GetPayload(CoordinationErrorPayloadKey()).has_value()) {
+      return status;
+    }
+    VLOG(2) << "Heartbeat aggregator is unavailable, sending the heartbeat "
+               "to the service: "
+            << status;
+    response->Clear();
+  }
+  return send(leader_client_.get());
+}
+
+void CoordinationServiceAgentImpl::TakeAggregatedHeartbeats(
+    HeartbeatRequest* request) {
+  request->clear_aggregated_heartbeats();
+  mutex_lock l(aggregation_mu_);
+  for (auto& [name, heartbeat] : aggregated_heartbeats_) {
+    request->add_aggregated_heartbeats()->Swap(&heartbeat);
+  }
+  aggregated_heartbeats_.clear();
+}
+
+void CoordinationServiceAgentImpl::RecordAggregatedHeartbeatErrors(
+    const HeartbeatResponse& response) {
+  mutex_lock l(aggregation_mu_);
+  last_leader_incarnation_ = response.leader_incarnation();
+  for (const auto& error : response.aggregated_errors()) {
+    aggregated_heartbeat_errors_[GetTaskName(error.task())] =
+        MakeCoordinationError(
+            absl::Status(static_cast<absl::StatusCode>(error.error_code()),
+                         error.error_message()));
+  }
+}
+
+absl::StatusOr<uint64_t> CoordinationServiceAgentImpl::AggregateHeartbeat(
+    const CoordinatedTask& task, uint64_t incarnation) {
+  {
+    mutex_lock l(state_mu_);
+    // No payload, so that the task sends its heartbeats to the service.
+    if (state_ != CoordinatedTaskState::TASKSTATE_CONNECTED) {
+      return absl::UnavailableError(
+          "The heartbeat aggregator is not connected to the service.");
+    }
+  }
+  const std::string name = GetTaskName(task);
+  mutex_lock l(aggregation_mu_);
+  auto error = aggregated_heartbeat_errors_.find(name);
+  if (error != aggregated_heartbeat_errors_.end()) {
+    absl::Status status = error->second;
+    aggregated_heartbeat_errors_.erase(error);
+    return status;
+  }
+  AggregatedHeartbeat& heartbeat = aggregated_heartbeats_[name];
+  *heartbeat.mutable_task() = task;
+  heartbeat.set_incarnation(incarnation);
+  return last_leader_incarnation_;
+}
+
 absl::Status CoordinationServiceAgentImpl::WaitForAllTasks(
     const DeviceInfo& local_devices) {
   absl::Status agent_running_status = ValidateRunningAgent();
@@ -897,4 +1030,13 @@ std::unique_ptr<CoordinationServiceAgent> CreateCoordinationServiceAgent() {
   return std::make_unique<CoordinationServiceAgentImpl>();
 }
 
+std::optional<CoordinatedTask> GetHeartbeatAggregator(
+    const CoordinationServiceConfig& configs, const CoordinatedTask& task) {
+  const int group_size = configs.heartbeat_aggregation_group_size();
+  if (group_size <= 1) return std::nullopt;
+  CoordinatedTask aggregator = task;
+  aggregator.set_task_id(task.task_id() / group_size * group_size);
+  return aggregator;
+}
+
 }  // namespace tsl
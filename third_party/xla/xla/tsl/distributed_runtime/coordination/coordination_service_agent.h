@@ -19,6 +19,7 @@ limitations under the License.
 #include <cstdint>
 #include <functional>
 #include <map>
+#include <optional>
 #include <memory>
 #include <string>
 #include <string_view>
@@ -86,6 +87,12 @@ class CoordinationServiceAgent {
       std::unique_ptr<CoordinationClient> leader_client,
       StatusCallback error_fn) = 0;
 
+  // Sends the heartbeats of this agent to the aggregator of its group through
+  // `aggregator_client` instead of to the service, see
+  // `GetHeartbeatAggregator()`. Must be called before Connect().
+  virtual absl::Status SetHeartbeatAggregatorClient(
+      std::unique_ptr<CoordinationClient> aggregator_client) = 0;
+
   // Return true if the coordination service agent has been initialized.
   virtual bool IsInitialized() = 0;
 
@@ -272,12 +279,26 @@ class CoordinationServiceAgent {
   virtual absl::Status ActivateWatch(
       std::string_view, const std::map<std::string, std::string>&) = 0;
 
+  // Queues a heartbeat of another task of the group of this agent, to be
+  // forwarded to the service with the next heartbeat of this agent. Returns
+  // the leader incarnation, or the error that the service returned for the
+  // previous heartbeat of `task`.
+  virtual absl::StatusOr<uint64_t> AggregateHeartbeat(
+      const tensorflow::CoordinatedTask& task, uint64_t incarnation) = 0;
+
  private:
   friend class CoordinationServiceRpcHandler;
 };
 
 std::unique_ptr<CoordinationServiceAgent> CreateCoordinationServiceAgent();
 
+// Returns the task that aggregates the heartbeats of `task`, which may be
+// `task` itself, or nullopt if heartbeats are not aggregated. See
+// CoordinationServiceConfig.heartbeat_aggregation_group_size.
+std::optional<tensorflow::CoordinatedTask> GetHeartbeatAggregator(
+    const tensorflow::CoordinationServiceConfig& configs,
+    const tensorflow::CoordinatedTask& task);
+
 }  // namespace tsl
 
 #endif  // XLA_TSL_DISTRIBUTED_RUNTIME_COORDINATION_COORDINATION_SERVICE_AGENT_H_
@@ -16,6 +16,7 @@ limitations under the License.
 #include "xla/tsl/distributed_runtime/coordination/coordination_service_agent.h"
 
 #include <memory>
+#include <optional>
 #include <ostream>
 #include <string>
 #include <utility>
@@ -25,10 +26,12 @@ limitations under the License.
 #include "absl/log/log.h"
 #include "absl/memory/memory.h"
 #include "absl/status/status.h"
+#include "absl/synchronization/notification.h"
 #include "absl/time/clock.h"
 #include "absl/time/time.h"
 #include "xla/tsl/distributed_runtime/call_options.h"
 #include "xla/tsl/distributed_runtime/coordination/coordination_client.h"
+#include "xla/tsl/distributed_runtime/coordination/coordination_service_rpc_handler.h"
 #include "tsl/lib/core/status_test_util.h"
 #include "tsl/platform/env.h"
 #include "tsl/platform/errors.h"
@@ -532,5 +535,128 @@ TEST_F(CoordinationServiceAgentTest, Connect_InternalErrorShouldBeRetried) {
   TF_EXPECT_OK(agent_->Connect());
 }
 
+TEST(GetHeartbeatAggregatorTest, GroupsConsecutiveTasks) {
+  CoordinationServiceConfig config;
+  CoordinatedTask task;
+  task.set_job_name("worker");
+  task.set_task_id(5);
+  EXPECT_FALSE(GetHeartbeatAggregator(config, task).has_value());
+
+  config.set_heartbeat_aggregation_group_size(4);
+  std::optional<CoordinatedTask> aggregator =
+      GetHeartbeatAggregator(config, task);
+  ASSERT_TRUE(aggregator.has_value());
+  EXPECT_EQ(aggregator->job_name(), "worker");
+  EXPECT_EQ(aggregator->task_id(), 4);
+}
+
+CoordinationServiceConfig HeartbeatAggregationConfig() {
+  CoordinationServiceConfig config;
+  config.set_service_leader("test_leader");
+  config.set_heartbeat_timeout_in_ms(200);
+  config.set_heartbeat_aggregation_group_size(2);
+  return config;
+}
+
+TEST_F(CoordinationServiceAgentTest, HeartbeatsAreSentToAggregator) {
+  absl::Notification heartbeat_received;
+  auto aggregator_client = std::make_unique<TestCoordinationClient>();
+  ON_CALL(*aggregator_client, HeartbeatAsync(_, _, _, _))
+      .WillByDefault(WithArgs<3>([&](StatusCallback done) {
+        if (!heartbeat_received.HasBeenNotified()) heartbeat_received.Notify();
+        done(absl::OkStatus());
+      }));
+  EXPECT_CALL(*GetClient(), HeartbeatAsync(_, _, _, _)).Times(0);
+  TF_ASSERT_OK(agent_->Initialize(Env::Default(), "test_job", /*task_id=*/1,
+                                  HeartbeatAggregationConfig(),
+                                  std::move(client_),
+                                  /*error_fn=*/[](absl::Status s) {}));
+  TF_ASSERT_OK(
+      agent_->SetHeartbeatAggregatorClient(std::move(aggregator_client)));
+
+  TF_ASSERT_OK(agent_->Connect());
+
+  heartbeat_received.WaitForNotification();
+  TF_EXPECT_OK(agent_->Shutdown());
+}
+
+TEST_F(CoordinationServiceAgentTest,
+       HeartbeatsAreSentToServiceIfAggregatorIsUnavailable) {
+  absl::Notification heartbeat_received;
+  auto aggregator_client = std::make_unique<TestCoordinationClient>();
+  ON_CALL(*aggregator_client, HeartbeatAsync(_, _, _, _))
+      .WillByDefault(
+          InvokeArgument<3>(absl::UnavailableError("aggregator is down")));
+  ON_CALL(*GetClient(), HeartbeatAsync(_, _, _, _))
+      .WillByDefault(WithArgs<3>([&](StatusCallback done) {
+        if (!heartbeat_received.HasBeenNotified()) heartbeat_received.Notify();
+        done(absl::OkStatus());
+      }));
+  TF_ASSERT_OK(agent_->Initialize(Env::Default(), "test_job", /*task_id=*/1,
+                                  HeartbeatAggregationConfig(),
+                                  std::move(client_),
+                                  /*error_fn=*/[](absl::Status s) {}));
+  TF_ASSERT_OK(
+      agent_->SetHeartbeatAggregatorClient(std::move(aggregator_client)));
+
+  TF_ASSERT_OK(agent_->Connect());
+
+  heartbeat_received.WaitForNotification();
+  EXPECT_FALSE(agent_->IsError());
+  TF_EXPECT_OK(agent_->Shutdown());
+}
+
+TEST_F(CoordinationServiceAgentTest, AggregatorForwardsHeartbeats) {
+  absl::Notification heartbeat_forwarded;
+  ON_CALL(*GetClient(), HeartbeatAsync(_, _, _, _))
+      .WillByDefault(WithArgs<1, 2, 3>([&](const HeartbeatRequest* request,
+                                           HeartbeatResponse* response,
+                                           StatusCallback done) {
+        for (const auto& heartbeat : request->aggregated_heartbeats()) {
+          tensorflow::AggregatedHeartbeatError* error =
+              response->add_aggregated_errors();
+          *error->mutable_task() = heartbeat.task();
+          error->set_error_code(static_cast<int>(absl::StatusCode::kAborted));
+          error->set_error_message("incarnation mismatch");
+          if (!heartbeat_forwarded.HasBeenNotified()) {
+            heartbeat_forwarded.Notify();
+          }
+        }
+        done(absl::OkStatus());
+      }));
+  TF_ASSERT_OK(agent_->Initialize(Env::Default(), "test_job", /*task_id=*/0,
+                                  HeartbeatAggregationConfig(),
+                                  std::move(client_),
+                                  /*error_fn=*/[](absl::Status s) {}));
+  TF_ASSERT_OK(agent_->Connect());
+  CoordinationServiceRpcHandler handler;
+  handler.SetAgentInstance(agent_.get());
+  HeartbeatRequest request;
+  request.mutable_source_task()->set_job_name("test_job");
+  request.mutable_source_task()->set_task_id(1);
+  request.set_incarnation(1234);
+  auto send_heartbeat = [&]() {
+    HeartbeatResponse response;
+    absl::Status status;
+    handler.HeartbeatAsync(&request, &response,
+                           [&](absl::Status s) { status = s; });
+    return status;
+  };
+
+  TF_ASSERT_OK(send_heartbeat());
+  heartbeat_forwarded.WaitForNotification();
+
+  // The error that the service returned for the forwarded heartbeat is
+  // returned for the next heartbeat of the task.
+  absl::Status status;
+  for (int i = 0; i < 100 && status.ok(); ++i) {
+    absl::SleepFor(absl::Milliseconds(10));
+    status = send_heartbeat();
+  }
+  EXPECT_TRUE(absl::IsAborted(status)) << status;
+  handler.SetAgentInstance(nullptr);
+  TF_EXPECT_OK(agent_->Shutdown());
+}
+
 }  // namespace
 }  // namespace tsl
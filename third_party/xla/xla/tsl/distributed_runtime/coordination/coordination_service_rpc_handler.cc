@@ -70,19 +70,42 @@ void CoordinationServiceRpcHandler::HeartbeatAsync(
     const HeartbeatRequest* request, HeartbeatResponse* response,
     StatusCallback done) {
   tf_shared_lock l(mu_);
+  const CoordinatedTask& task = request->source_task();
+  const uint64_t incarnation = request->incarnation();
+  if (service_ == nullptr && agent_ != nullptr) {
+    // This task aggregates the heartbeats of its group.
+    absl::StatusOr<uint64_t> leader_incarnation =
+        agent_->AggregateHeartbeat(task, incarnation);
+    if (!leader_incarnation.ok()) {
+      done(leader_incarnation.status());
+      return;
+    }
+    response->set_leader_incarnation(*leader_incarnation);
+    done(absl::OkStatus());
+    return;
+  }
   if (service_ == nullptr) {
     done(MakeCoordinationError(
         errors::Internal("Coordination service is not enabled.")));
     return;
   }
-  const CoordinatedTask& task = request->source_task();
-  const uint64_t incarnation = request->incarnation();
   const uint64_t leader_incarnation = service_->GetServiceIncarnation();
   absl::Status s = service_->RecordHeartbeat(task, incarnation);
   if (!s.ok()) {
     done(s);
     return;
   }
+  for (const auto& heartbeat : request->aggregated_heartbeats()) {
+    absl::Status status =
+        service_->RecordHeartbeat(heartbeat.task(), heartbeat.incarnation());
+    if (!status.ok()) {
+      tensorflow::AggregatedHeartbeatError* error =
+          response->add_aggregated_errors();
+      *error->mutable_task() = heartbeat.task();
+      error->set_error_code(static_cast<int>(status.code()));
+      error->set_error_message(std::string(status.message()));
+    }
+  }
   response->set_leader_incarnation(leader_incarnation);
   done(absl::OkStatus());
 }
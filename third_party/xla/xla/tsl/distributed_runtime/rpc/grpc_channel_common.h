@@ -30,8 +30,11 @@ namespace tsl {
 // To use instantiate with the type of channel cache needed.
 // GenericCachingChannelCache allows using multiple channels to communiate with
 // same target to provide throughput gains. When multiple channels exist for
-// the same target they are chosen in a simple round robin fashion on each call
-// to FindWorkerChannel.
+// the same target, each call to FindWorkerChannel returns the channel held by
+// the fewest callers: the callers (e.g. the remote workers) hold their channel
+// while they issue RPCs on it, so that this is the channel with the fewest
+// outstanding RPCs, and a large transfer in flight moves the following RPCs to
+// the other channels. Ties are broken in a round robin fashion.
 template <typename ChannelCacheT>
 class GenericCachingChannelCache : public ChannelCacheT {
  public:
@@ -87,9 +90,20 @@ class GenericCachingChannelCache : public ChannelCacheT {
     // Following statement is marked as Crash OK as this is an invariant of
     // code flow in this class.
     CHECK_EQ(chan_state.channels.size(), num_channels_per_target_);  // Crash OK
-    chan_state.last_used =
-        (chan_state.last_used + 1) % num_channels_per_target_;
-    return chan_state.channels[chan_state.last_used];
+    // The use counts also include the references of this cache, which are the
+    // same for all the channels.
+    int next = -1;
+    long next_use_count = 0;
+    for (int i = 1; i <= num_channels_per_target_; ++i) {
+      const int indx = (chan_state.last_used + i) % num_channels_per_target_;
+      const long use_count = chan_state.channels[indx].use_count();
+      if (next < 0 || use_count < next_use_count) {
+        next = indx;
+        next_use_count = use_count;
+      }
+    }
+    chan_state.last_used = next;
+    return chan_state.channels[next];
   }
 
   const int num_channels_per_target_;
@@ -15,6 +15,8 @@ limitations under the License.
 
 #include "xla/tsl/distributed_runtime/rpc/grpc_channel.h"
 
+#include <memory>
+#include <set>
 #include <string>
 #include <vector>
 
@@ -203,6 +205,34 @@ TEST(GrpcChannelTest, HostPortsMultiChannelPerTarget) {
   }
 }
 
+TEST(GrpcChannelTest, MultiChannelPerTargetSkipsTheHeldChannels) {
+  GrpcChannelSpec spec;
+  TF_EXPECT_OK(spec.AddHostPortsJob("mnist", {{0, "a:1"}}));
+  ChannelCreationFunction channel_func =
+      ConvertToChannelCreationFunction(NewHostPortGrpcChannel);
+  tensorflow::RPCOptions rpc_options;
+  rpc_options.set_num_channels_per_target(4);
+  std::unique_ptr<GrpcChannelCache> cc(
+      NewGrpcChannelCache(spec, channel_func, rpc_options));
+
+  // The callers release the other channels as soon as they get them.
+  SharedGrpcChannelPtr held =
+      cc->FindWorkerChannel("/job:mnist/replica:0/task:0");
+  ASSERT_NE(nullptr, held);
+  for (int i = 0; i < 10; i++) {
+    EXPECT_NE(held.get(),
+              cc->FindWorkerChannel("/job:mnist/replica:0/task:0").get());
+  }
+
+  // Once released, the channel is used again.
+  held.reset();
+  std::set<::grpc::Channel*> channels;
+  for (int i = 0; i < 4; i++) {
+    channels.insert(cc->FindWorkerChannel("/job:mnist/replica:0/task:0").get());
+  }
+  EXPECT_EQ(channels.size(), 4);
+}
+
 TEST(GrpcChannelTest, HostPortsMultiGrpcMultiChannelPerTarget) {
   GrpcChannelSpec spec;
   TF_EXPECT_OK(